@@ -30,6 +30,7 @@
 #include <math.h>
 #include <stdint.h>
 #include <pios_math.h>
+#include <fastmath.h>
 #include "CoordinateConversions.h"
 
 #define MIN_ALLOWABLE_MAGNITUDE 1e-30f
@@ -141,9 +142,9 @@ void Quaternion2RPY(const float q[4], float rpy[3])
     R23    = 2.0f * (q[2] * q[3] + q[0] * q[1]);
     R33    = q0s - q1s - q2s + q3s;
 
-    rpy[1] = RAD2DEG(asinf(-R13)); // pitch always between -pi/2 to pi/2
-    rpy[2] = RAD2DEG(atan2f(R12, R11));
-    rpy[0] = RAD2DEG(atan2f(R23, R33));
+    rpy[1] = RAD2DEG(fast_asinf(-R13)); // pitch always between -pi/2 to pi/2
+    rpy[2] = RAD2DEG(fast_atan2f(R12, R11));
+    rpy[0] = RAD2DEG(fast_atan2f(R23, R33));
 
     // TODO: consider the cases where |R13| ~= 1, |pitch| ~= pi/2
 }
@@ -157,12 +158,9 @@ void RPY2Quaternion(const float rpy[3], float q[4])
     phi    = DEG2RAD(rpy[0] / 2);
     theta  = DEG2RAD(rpy[1] / 2);
     psi    = DEG2RAD(rpy[2] / 2);
-    cphi   = cosf(phi);
-    sphi   = sinf(phi);
-    ctheta = cosf(theta);
-    stheta = sinf(theta);
-    cpsi   = cosf(psi);
-    spsi   = sinf(psi);
+    fast_sincosf(phi, &sphi, &cphi);
+    fast_sincosf(theta, &stheta, &ctheta);
+    fast_sincosf(psi, &spsi, &cpsi);
 
     q[0]   = cphi * ctheta * cpsi + sphi * stheta * spsi;
     q[1]   = sphi * ctheta * cpsi - cphi * stheta * spsi;
@@ -180,16 +178,18 @@ void RPY2Quaternion(const float rpy[3], float q[4])
 // ** Find Rbe, that rotates a vector from earth fixed to body frame, from quaternion **
 void Quaternion2R(float q[4], float Rbe[3][3])
 {
-    const float q0s = q[0] * q[0], q1s = q[1] * q[1], q2s = q[2] * q[2], q3s = q[3] * q[3];
+    // load q once, the stores to Rbe could otherwise alias it and force reloads
+    const float q0  = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    const float q0s = q0 * q0, q1s = q1 * q1, q2s = q2 * q2, q3s = q3 * q3;
 
     Rbe[0][0] = q0s + q1s - q2s - q3s;
-    Rbe[0][1] = 2 * (q[1] * q[2] + q[0] * q[3]);
-    Rbe[0][2] = 2 * (q[1] * q[3] - q[0] * q[2]);
-    Rbe[1][0] = 2 * (q[1] * q[2] - q[0] * q[3]);
+    Rbe[0][1] = 2 * (q1 * q2 + q0 * q3);
+    Rbe[0][2] = 2 * (q1 * q3 - q0 * q2);
+    Rbe[1][0] = 2 * (q1 * q2 - q0 * q3);
     Rbe[1][1] = q0s - q1s + q2s - q3s;
-    Rbe[1][2] = 2 * (q[2] * q[3] + q[0] * q[1]);
-    Rbe[2][0] = 2 * (q[1] * q[3] + q[0] * q[2]);
-    Rbe[2][1] = 2 * (q[2] * q[3] - q[0] * q[1]);
+    Rbe[1][2] = 2 * (q2 * q3 + q0 * q1);
+    Rbe[2][0] = 2 * (q1 * q3 + q0 * q2);
+    Rbe[2][1] = 2 * (q2 * q3 - q0 * q1);
     Rbe[2][2] = q0s - q1s - q2s + q3s;
 }
 
@@ -265,6 +265,53 @@ void LLA2Base(int32_t LLAi[3], double BaseECEF[3], float Rne[3][3], float NED[3]
     NED[2]  = Rne[2][0] * diff[0] + Rne[2][1] * diff[1] + Rne[2][2] * diff[2];
 }
 
+// ****** Local tangent plane around a base, LLA to NED in single precision ********
+void LTPFromLLA(int32_t BaseLLAi[3], LocalTangentPlane *ltp)
+{
+    const double a    = 6378137.0d; // Equatorial Radius
+    const double e    = 8.1819190842622e-2d; // Eccentricity
+    const double e2   = e * e; // Eccentricity squared
+    const double unit = DEG2RAD_D(1e-7d); // radians per LLAi degree unit
+    const double lat  = DEG2RAD_D((double)BaseLLAi[0] * 1e-7d);
+    const double alt  = (double)BaseLLAi[2] * 1e-4d;
+    const double sinLat = sin(lat);
+    const double w    = 1.0d - e2 * sinLat * sinLat;
+    const double N    = a / sqrt(w); // prime vertical radius of curvature
+    const double M    = a * (1.0d - e2) / (w * sqrt(w)); // meridian radius of curvature
+
+    ltp->LLAi[0]    = BaseLLAi[0];
+    ltp->LLAi[1]    = BaseLLAi[1];
+    ltp->LLAi[2]    = BaseLLAi[2];
+    ltp->northScale = (float)((M + alt) * unit);
+    ltp->eastScale  = (float)((N + alt) * cos(lat) * unit);
+    ltp->tanLat     = (float)tan(lat);
+    ltp->invM = (float)(1.0d / (M + alt));
+    ltp->invN = (float)(1.0d / (N + alt));
+}
+
+void LLA2LTP(const int32_t LLAi[3], const LocalTangentPlane *ltp, float NED[3])
+{
+    // the differences are exact in float up to 2^24 units, 180 km
+    const float dAlt  = (float)(LLAi[2] - ltp->LLAi[2]) * 1e-4f;
+    int64_t dLon = (int64_t)LLAi[1] - ltp->LLAi[1];
+
+    // across the antimeridian
+    if (dLon > 1800000000LL) {
+        dLon -= 3600000000LL;
+    } else if (dLon < -1800000000LL) {
+        dLon += 3600000000LL;
+    }
+    // arcs at the base altitude scaled to the point altitude
+    const float x = (float)(LLAi[0] - ltp->LLAi[0]) * ltp->northScale * (1.0f + dAlt * ltp->invM);
+    const float y = (float)dLon * ltp->eastScale * (1.0f + dAlt * ltp->invN);
+
+    // second order terms: the parallels bend towards the pole and the surface
+    // drops below the tangent plane
+    NED[0] = x + 0.5f * y * y * ltp->tanLat * ltp->invN;
+    NED[1] = y - x * y * ltp->tanLat * ltp->invM;
+    NED[2] = 0.5f * (x * x * ltp->invM + y * y * ltp->invN) - dAlt;
+}
+
 // ****** Express ECEF in a local NED Base Frame ********
 void ECEF2Base(double ECEF[3], double BaseECEF[3], float Rne[3][3], float NED[3])
 {
@@ -421,8 +468,9 @@ void Rv2Rot(float Rv[3], float R[3][3])
         q[3] = 0.5f * Rv[2];
         // This prevents division by zero, while retaining full accuracy
     } else {
-        q[0] = cosf(angle * 0.5f);
-        float scale = sinf(angle * 0.5f) / angle;
+        float sine;
+        fast_sincosf(angle * 0.5f, &sine, &q[0]);
+        float scale = sine / angle;
         q[1] = scale * Rv[0];
         q[2] = scale * Rv[1];
         q[3] = scale * Rv[2];
@@ -491,7 +539,10 @@ void quat_mult(const float q1[4], const float q2[4], float qout[4])
  */
 void rot_mult(float R[3][3], const float vec[3], float vec_out[3])
 {
-    vec_out[0] = R[0][0] * vec[0] + R[0][1] * vec[1] + R[0][2] * vec[2];
-    vec_out[1] = R[1][0] * vec[0] + R[1][1] * vec[1] + R[1][2] * vec[2];
-    vec_out[2] = R[2][0] * vec[0] + R[2][1] * vec[1] + R[2][2] * vec[2];
+    // load vec once, so the multiply-adds are not serialized by reloads around the stores
+    const float x = vec[0], y = vec[1], z = vec[2];
+
+    vec_out[0] = R[0][0] * x + R[0][1] * y + R[0][2] * z;
+    vec_out[1] = R[1][0] * x + R[1][1] * y + R[1][2] * z;
+    vec_out[2] = R[2][0] * x + R[2][1] * y + R[2][2] * z;
 }
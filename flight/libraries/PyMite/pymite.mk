@@ -15,6 +15,8 @@ PYMITEINC	+= $(OUTDIR)
 # Flight plans
 FLIGHTPLANLIB	?= $(OPMODULEDIR)/FlightPlan/lib
 FLIGHTPLANS	?= $(OPMODULEDIR)/FlightPlan/flightplans
+# Script run on start, e.g. FLIGHTPLAN=benchmark for the interpreter benchmark
+FLIGHTPLAN	?= test
 
 # Extra modules
 PYMODULES	?= FlightPlan
@@ -66,9 +68,10 @@ $(OUTDIR)/pmlibusr_nat.c: $(PYSCRIPTS)
 			-f $(PYMITEPLAT)/pmfeatures.py \
 			-o $(OUTDIR)/pmlibusr_img.c \
 			--native-file=$(OUTDIR)/pmlibusr_nat.c \
-			$(FLIGHTPLANS)/test.py
+			$(FLIGHTPLANS)/$(FLIGHTPLAN).py
 
 # Add to the source and include lists
+CDEFS		+= -DFLIGHTPLAN_SCRIPT=\"$(FLIGHTPLAN)\"
 SRC		+= $(PYSRC)
 SRC		+= $(PYLIB)
 EXTRAINCDIRS	+= $(PYMITEINC)
@@ -28,6 +28,97 @@
 #include "pm.h"
 
 
+/**
+ * Number of sets in the key index cache, as a power of two
+ */
+#define DICT_CACHE_BITS 4
+#define DICT_CACHE_SETS (1 << DICT_CACHE_BITS)
+
+/**
+ * Key index cache.
+ *
+ * Globals and attributes are looked up with the same name objects
+ * (the string cache makes equal names the same object) on every pass
+ * of a loop, so most lookups find the key where it was found before.
+ * An entry is only used while the dict still holds that very key object
+ * at that index. That check keeps the cache correct across inserts,
+ * deletes and garbage collection without ever flushing it.
+ *
+ * Two ways per set, the most recently found entry first.
+ */
+typedef struct PmDictCacheEntry_s
+{
+    pPmDict_t pdict;
+    pPmObj_t pkey;
+    int16_t indx;
+} PmDictCacheEntry_t, *pPmDictCacheEntry_t;
+
+static PmDictCacheEntry_t dict_cache[DICT_CACHE_SETS][2];
+
+
+/**
+ * Checks a cache entry, returns C_TRUE if it holds the index of the key
+ */
+static uint8_t
+dict_cacheHit(pPmDictCacheEntry_t pentry, pPmDict_t pdict, pPmObj_t pkey)
+{
+    pPmObj_t pcached;
+
+    return (pentry->pdict == pdict)
+        && (pentry->pkey == pkey)
+        && (pentry->indx < pdict->length)
+        && (seglist_getItem(pdict->d_keys, pentry->indx, &pcached)
+            == PM_RET_OK)
+        && (pcached == pkey);
+}
+
+
+/**
+ * Finds the index of the key in the keys seglist of a non-empty dict
+ *
+ * @param pdict Ptr to the dict
+ * @param pkey Ptr to the key
+ * @param r_indx Return by reference; index of the key
+ * @return Return status; PM_RET_NO if the key is not in the dict
+ */
+static PmReturn_t
+dict_findKey(pPmDict_t pdict, pPmObj_t pkey, int16_t *r_indx)
+{
+    PmReturn_t retval;
+    pPmDictCacheEntry_t pset;
+    PmDictCacheEntry_t entry;
+
+    /* Fibonacci hash, the low bits of heap addresses are mostly the same */
+    pset = dict_cache[((uint32_t)((uintptr_t)pdict ^ (uintptr_t)pkey)
+                       * 2654435769u) >> (32 - DICT_CACHE_BITS)];
+
+    if (dict_cacheHit(&pset[0], pdict, pkey))
+    {
+        *r_indx = pset[0].indx;
+        return PM_RET_OK;
+    }
+    if (dict_cacheHit(&pset[1], pdict, pkey))
+    {
+        *r_indx = pset[1].indx;
+        entry = pset[1];
+        pset[1] = pset[0];
+        pset[0] = entry;
+        return PM_RET_OK;
+    }
+
+    *r_indx = 0;
+    retval = seglist_findEqual(pdict->d_keys, pkey, r_indx);
+    if (retval == PM_RET_OK)
+    {
+        pset[1] = pset[0];
+        pset[0].pdict = pdict;
+        pset[0].pkey = pkey;
+        pset[0].indx = *r_indx;
+    }
+    return retval;
+}
+
+
 PmReturn_t
 dict_new(pPmObj_t *r_pdict)
 {
@@ -141,8 +232,7 @@ dict_setItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t pval)
     else
     {
         /* Check for matching key */
-        indx = 0;
-        retval = seglist_findEqual(((pPmDict_t)pdict)->d_keys, pkey, &indx);
+        retval = dict_findKey((pPmDict_t)pdict, pkey, &indx);
 
         /* If found a matching key, replace val obj */
         if (retval == PM_RET_OK)
@@ -195,7 +285,7 @@ dict_getItem(pPmObj_t pdict, pPmObj_t pkey, pPmObj_t *r_pobj)
     }
 
     /* check for matching key */
-    retval = seglist_findEqual(((pPmDict_t)pdict)->d_keys, pkey, &indx);
+    retval = dict_findKey((pPmDict_t)pdict, pkey, &indx);
     /* if key not found, raise KeyError */
     if (retval == PM_RET_NO)
     {
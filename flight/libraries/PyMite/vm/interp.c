@@ -71,8 +71,8 @@ interpret(const uint8_t returnOnNoThreads)
             PM_BREAK_IF_ERROR(retval);
         }
 
-        /* Get byte; the func post-incrs PM_IP */
-        bc = mem_getByte(PM_FP->fo_memspace, &PM_IP);
+        /* Get byte; post-increments PM_IP */
+        bc = GET_BYTE();
         switch (bc)
         {
             case POP_TOP:
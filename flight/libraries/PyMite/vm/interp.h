@@ -53,8 +53,22 @@
 #define PM_POP()        (*(--PM_SP))
 /** pushes an obj on the stack */
 #define PM_PUSH(pobj)   (*(PM_SP++) = (pobj))
+#ifdef PM_PLAT_PROG_DIRECT
+/*
+ * The platform maps every memspace the images live in into the address
+ * space, so the bytecode is read directly rather than a byte at a time
+ * through plat_memGetByte().
+ */
+/** gets the next bytecode from the instruction stream */
+#define GET_BYTE()      (*PM_IP++)
+/** gets the argument (S16) from the instruction stream */
+#define GET_ARG()       (PM_IP += 2, (uint16_t)(PM_IP[-2] | (PM_IP[-1] << 8)))
+#else
+/** gets the next bytecode from the instruction stream */
+#define GET_BYTE()      mem_getByte(PM_FP->fo_memspace, &PM_IP)
 /** gets the argument (S16) from the instruction stream */
 #define GET_ARG()       mem_getWord(PM_FP->fo_memspace, &PM_IP)
+#endif /* PM_PLAT_PROG_DIRECT */
 
 /** pushes an obj in the only stack slot of the native frame */
 #define NATIVE_SET_TOS(pobj) (gVmGlobal.nativeframe.nf_stack = \
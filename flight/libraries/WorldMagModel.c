@@ -152,6 +152,8 @@ static const float CoeffFile[91][6] = {
     { 12.0f, 12.0f, 0.0f,      0.9f,     0.1f,   0.0f   }
 };
 
+// allocated on the first call and kept, so later calls neither allocate nor redo the fixed work
+static WMMtype_Context *Context = NULL;
 static WMMtype_Ellipsoid *Ellip = NULL;
 static WMMtype_MagneticModel *MagneticModel = NULL;
 static float decimal_date;
@@ -171,11 +173,16 @@ int WMM_Initialize()
 // Sets default values for WMM subroutines.
 // UPDATES : Ellip and MagneticModel
 {
-    if (!Ellip) {
-        return -1; // invalid pointer
-    }
-    if (!MagneticModel) {
-        return -2; // invalid pointer
+    if (!Context) {
+        Context = (WMMtype_Context *)MALLOC(sizeof(WMMtype_Context));
+        if (!Context) {
+            return -1; // memory allocation error
+        }
+        memset(Context, 0, sizeof(WMMtype_Context));
+        Ellip = &Context->Ellip;
+        MagneticModel = &Context->MagneticModel;
+    } else if (Context->Initialized) {
+        return 0; // OK, nothing depends on the call arguments
     }
     // Sets WGS-84 parameters
     Ellip->a     = 6378.137f;   // semi-major axis of the ellipsoid in km
@@ -195,6 +202,15 @@ int WMM_Initialize()
     MagneticModel->epoch = 2010.0f;
     sprintf(MagneticModel->ModelName, "WMM-2010");
 
+    WMM_SchmidtQuasiNorm(Context->schmidtQuasiNorm, MagneticModel->nMax);
+
+    // nothing is cached yet, NAN never compares equal
+    Context->CoeffDate       = NAN;
+    Context->LegendrePhig    = NAN;
+    Context->SphLambda       = NAN;
+    Context->SphRadius       = NAN;
+    Context->Initialized     = true;
+
     return 0; // OK
 }
 
@@ -203,8 +219,6 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     // return '0' if all appears to be OK
     // return < 0 if error
 
-    int returned = 0; // default to OK
-
     // ***********
     // range check supplied params
 
@@ -220,93 +234,39 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     if (Lon > 180.0f) {
         return -4; // error
     }
-    // ***********
-    // allocated required memory
-
-// Ellip = NULL;
-// MagneticModel = NULL;
-
-// MagneticModel = NULL;
-// CoordGeodetic = NULL;
-// GeoMagneticElements = NULL;
-
-    Ellip = (WMMtype_Ellipsoid *)MALLOC(sizeof(WMMtype_Ellipsoid));
-    MagneticModel = (WMMtype_MagneticModel *)MALLOC(sizeof(WMMtype_MagneticModel));
-
-    WMMtype_CoordSpherical *CoordSpherical = (WMMtype_CoordSpherical *)MALLOC(sizeof(WMMtype_CoordSpherical));
-    WMMtype_CoordGeodetic *CoordGeodetic   = (WMMtype_CoordGeodetic *)MALLOC(sizeof(WMMtype_CoordGeodetic));
-    WMMtype_GeoMagneticElements *GeoMagneticElements = (WMMtype_GeoMagneticElements *)MALLOC(sizeof(WMMtype_GeoMagneticElements));
-
-    if (!Ellip || !MagneticModel || !CoordSpherical || !CoordGeodetic || !GeoMagneticElements) {
-        returned = -5; // error
-    }
-    // ***********
-
-    if (returned >= 0) {
-        if (WMM_Initialize() < 0) {
-            returned = -6; // error
-        }
-    }
-
-    if (returned >= 0) {
-        CoordGeodetic->lambda = Lon;
-        CoordGeodetic->phi    = Lat;
-        CoordGeodetic->HeightAboveEllipsoid = AltEllipsoid / 1000.0f; // convert to km
-
-        // Convert from geodetic to Spherical Equations: 17-18, WMM Technical report
-        if (WMM_GeodeticToSpherical(CoordGeodetic, CoordSpherical) < 0) {
-            returned = -7; // error
-        }
-    }
-
-
-    if (returned >= 0) {
-        if (WMM_DateToYear(Month, Day, Year) < 0) {
-            returned = -8; // error
-        }
-    }
-
-    if (returned >= 0) {
-        // Compute the geoMagnetic field elements and their time change
-        if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0) {
-            returned = -9; // error
-        } else { // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
-        }
-    }
 
-    // ***********
-    // free allocated memory
+    WMMtype_CoordSpherical CoordSpherical;
+    WMMtype_CoordGeodetic CoordGeodetic;
+    WMMtype_GeoMagneticElements GeoMagneticElements;
 
-    if (GeoMagneticElements) {
-        FREE(GeoMagneticElements);
+    if (WMM_Initialize() < 0) {
+        return -6; // error
     }
 
-    if (CoordGeodetic) {
-        FREE(CoordGeodetic);
-    }
+    CoordGeodetic.lambda = Lon;
+    CoordGeodetic.phi    = Lat;
+    CoordGeodetic.HeightAboveEllipsoid = AltEllipsoid / 1000.0f; // convert to km
 
-    if (CoordSpherical) {
-        FREE(CoordSpherical);
+    // Convert from geodetic to Spherical Equations: 17-18, WMM Technical report
+    if (WMM_GeodeticToSpherical(&CoordGeodetic, &CoordSpherical) < 0) {
+        return -7; // error
     }
 
-    if (MagneticModel) {
-        FREE(MagneticModel);
-        MagneticModel = NULL;
+    if (WMM_DateToYear(Month, Day, Year) < 0) {
+        return -8; // error
     }
+    WMM_TimelyModifyMagneticModel();
 
-    if (Ellip) {
-        FREE(Ellip);
-        Ellip = NULL;
+    // Compute the geoMagnetic field elements and their time change
+    if (WMM_Geomag(&CoordSpherical, &CoordGeodetic, &GeoMagneticElements) < 0) {
+        return -9; // error
     }
 
-    B[0] = GeoMagneticElements->X * 1e-2f;
-    B[1] = GeoMagneticElements->Y * 1e-2f;
-    B[2] = GeoMagneticElements->Z * 1e-2f;
+    B[0] = GeoMagneticElements.X * 1e-2f;
+    B[1] = GeoMagneticElements.Y * 1e-2f;
+    B[2] = GeoMagneticElements.Z * 1e-2f;
 
-    return returned;
+    return 0; // OK
 }
 
 int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements)
@@ -341,26 +301,29 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
     WMMtype_MagneticResults MagneticResultsSphVar;
     WMMtype_MagneticResults MagneticResultsGeoVar;
 
-    // ********
-    // allocate required memory
-
-    WMMtype_LegendreFunction *LegendreFunction = (WMMtype_LegendreFunction *)MALLOC(sizeof(WMMtype_LegendreFunction));
-    WMMtype_SphericalHarmonicVariables *SphVariables = (WMMtype_SphericalHarmonicVariables *)MALLOC(sizeof(WMMtype_SphericalHarmonicVariables));
+    // The recursions only depend on part of the position, each result is
+    // reused as long as its inputs do not change
+    WMMtype_LegendreFunction *LegendreFunction = &Context->LegendreFunction;
+    WMMtype_SphericalHarmonicVariables *SphVariables = &Context->SphVariables;
 
-    if (!LegendreFunction || !SphVariables) {
-        returned = -1; // memory allocation error
-    }
-    // ********
-
-    if (returned >= 0) { // Compute Spherical Harmonic variables
+    if (CoordSpherical->lambda != Context->SphLambda || CoordSpherical->r != Context->SphRadius) {
+        // Compute Spherical Harmonic variables
+        Context->SphLambda = NAN;
         if (WMM_ComputeSphericalHarmonicVariables(CoordSpherical, MagneticModel->nMax, SphVariables) < 0) {
             returned = -2; // error
+        } else {
+            Context->SphLambda = CoordSpherical->lambda;
+            Context->SphRadius = CoordSpherical->r;
         }
     }
 
-    if (returned >= 0) { // Compute ALF
+    if (returned >= 0 && CoordSpherical->phig != Context->LegendrePhig) {
+        // Compute ALF
+        Context->LegendrePhig = NAN;
         if (WMM_AssociatedLegendreFunction(CoordSpherical, MagneticModel->nMax, LegendreFunction) < 0) {
             returned = -3; // error
+        } else {
+            Context->LegendrePhig = CoordSpherical->phig;
         }
     }
 
@@ -400,19 +363,6 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
         }
     }
 
-    // ********
-    // free allocated memory
-
-    if (SphVariables) {
-        FREE(SphVariables);
-    }
-
-    if (LegendreFunction) {
-        FREE(LegendreFunction);
-    }
-
-    // ********
-
     return returned;
 }
 
@@ -967,11 +917,7 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
     uint16_t n, m, index, index1, index2;
     float k, z;
 
-    float *schmidtQuasiNorm = (float *)MALLOC(sizeof(float) * NUMPCUP);
-
-    if (!schmidtQuasiNorm) { // memory allocation error
-        return -1;
-    }
+    const float *schmidtQuasiNorm = Context->schmidtQuasiNorm;
 
     Pcup[0]  = 1.0f;
     dPcup[0] = 0.0f;
@@ -1006,6 +952,29 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
             }
         }
     }
+/* Converts the  Gauss-normalized associated Legendre
+          functions to the Schmidt quasi-normalized version using pre-computed
+          relation stored in the variable schmidtQuasiNorm, see WMM_SchmidtQuasiNorm() */
+
+    for (n = 1; n <= nMax; n++) {
+        for (m = 0; m <= n; m++) {
+            index = (n * (n + 1) / 2 + m);
+            Pcup[index]  = Pcup[index] * schmidtQuasiNorm[index];
+            dPcup[index] = -dPcup[index] * schmidtQuasiNorm[index];
+            /* The sign is changed since the new WMM routines use derivative with respect to latitude
+               insted of co-latitude */
+        }
+    }
+
+    return 0; // OK
+}
+
+void WMM_SchmidtQuasiNorm(float *schmidtQuasiNorm, uint16_t nMax)
+// Fills the Gauss to Schmidt quasi-normalization ratios used by WMM_PcupLow,
+// they only depend on nMax so this is done once in WMM_Initialize
+{
+    uint16_t n, m, index, index1;
+
 /*Compute the ration between the Gauss-normalized associated Legendre
    functions and the Schmidt quasi-normalized version. This is equivalent to
    sqrt((m==0?1:2)*(n-m)!/(n+m!))*(2n-1)!!/(n-m)!  */
@@ -1023,24 +992,6 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
             schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * sqrtf((float)((n - m + 1) * (m == 1 ? 2 : 1)) / (float)(n + m));
         }
     }
-
-/* Converts the  Gauss-normalized associated Legendre
-          functions to the Schmidt quasi-normalized version using pre-computed
-          relation stored in the variable schmidtQuasiNorm */
-
-    for (n = 1; n <= nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            index = (n * (n + 1) / 2 + m);
-            Pcup[index]  = Pcup[index] * schmidtQuasiNorm[index];
-            dPcup[index] = -dPcup[index] * schmidtQuasiNorm[index];
-            /* The sign is changed since the new WMM routines use derivative with respect to latitude
-               insted of co-latitude */
-        }
-    }
-
-    FREE(schmidtQuasiNorm);
-
-    return 0; // OK
 }
 
 int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
@@ -1062,11 +1013,8 @@ int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
     float schmidtQuasiNorm2;
     float schmidtQuasiNorm3;
 
-    float *PcupS = (float *)MALLOC(sizeof(float) * NUMPCUPS);
+    float PcupS[NUMPCUPS];
 
-    if (!PcupS) {
-        return -1; // memory allocation error
-    }
     PcupS[0] = 1;
     schmidtQuasiNorm1   = 1.0f;
 
@@ -1101,8 +1049,6 @@ int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
             * PcupS[n] * schmidtQuasiNorm3;
     }
 
-    FREE(PcupS);
-
     return 0; // OK
 }
 
@@ -1124,11 +1070,8 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
     float schmidtQuasiNorm2;
     float schmidtQuasiNorm3;
 
-    float *PcupS = (float *)MALLOC(sizeof(float) * NUMPCUPS);
+    float PcupS[NUMPCUPS];
 
-    if (!PcupS) {
-        return -1; // memory allocation error
-    }
     PcupS[0] = 1;
     schmidtQuasiNorm1   = 1.0f;
 
@@ -1159,71 +1102,57 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
             * PcupS[n] * schmidtQuasiNorm3;
     }
 
-    FREE(PcupS);
-
     return 0; // OK
 }
 
 /**
- * @brief Comput the MainFieldCoeffH accounting for the date
+ * @brief Updates the main field coefficients for decimal_date
+ * The secular variation is applied to every term up to nMaxSecVar, the summations
+ * then read the timed coefficients instead of extrapolating each term per use.
  */
-float WMM_get_main_field_coeff_g(uint16_t index)
+void WMM_TimelyModifyMagneticModel()
 {
-    if (index >= NUMTERMS) {
-        return 0;
+    if (decimal_date == Context->CoeffDate) {
+        return;
     }
 
-    uint16_t n, m, sum_index, a, b;
-
-    float coeff = CoeffFile[index][2];
+    uint16_t index, a, b;
+    float dt = decimal_date - MagneticModel->epoch;
 
     a = MagneticModel->nMaxSecVar;
     b = (a * (a + 1) / 2 + a);
-    for (n = 1; n <= MagneticModel->nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_g(sum_index);
-            }
+    Context->TimedCoeffG[0] = CoeffFile[0][2];
+    Context->TimedCoeffH[0] = CoeffFile[0][3];
+    for (index = 1; index < NUMTERMS; index++) {
+        Context->TimedCoeffG[index] = CoeffFile[index][2];
+        Context->TimedCoeffH[index] = CoeffFile[index][3];
+        if (index <= b) {
+            Context->TimedCoeffG[index] += dt * CoeffFile[index][4];
+            Context->TimedCoeffH[index] += dt * CoeffFile[index][5];
         }
     }
-
-    return coeff;
+    Context->CoeffDate = decimal_date;
 }
 
-float WMM_get_main_field_coeff_h(uint16_t index)
+/**
+ * @brief Comput the MainFieldCoeffG accounting for the date
+ */
+float WMM_get_main_field_coeff_g(uint16_t index)
 {
     if (index >= NUMTERMS) {
         return 0;
     }
 
-    uint16_t n, m, sum_index, a, b;
-    float coeff = CoeffFile[index][3];
-
-    a = MagneticModel->nMaxSecVar;
-    b = (a * (a + 1) / 2 + a);
-    for (n = 1; n <= MagneticModel->nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
+    return Context->TimedCoeffG[index];
+}
 
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_h(sum_index);
-            }
-        }
+float WMM_get_main_field_coeff_h(uint16_t index)
+{
+    if (index >= NUMTERMS) {
+        return 0;
     }
 
-    return coeff;
+    return Context->TimedCoeffH[index];
 }
 
 float WMM_get_secular_var_coeff_g(uint16_t index)
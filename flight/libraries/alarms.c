@@ -42,9 +42,14 @@
 // Private variables
 static xSemaphoreHandle lock;
 static volatile uint16_t lastAlarmChange[SYSTEMALARMS_ALARM_NUMELEM] = { 0 }; // this deliberately overflows every 2^16 milliseconds to save memory
+// copy of the Alarm field, most calls set an alarm to the severity it already
+// has and are answered from here without the lock or an object read
+static volatile uint8_t severityShadow[SYSTEMALARMS_ALARM_NUMELEM];
 
 // Private functions
 static int32_t hasSeverity(SystemAlarmsAlarmOptions severity);
+static void updateShadow(SystemAlarmsAlarmData *alarms);
+static void alarmsUpdatedCb(UAVObjEvent *ev);
 
 /**
  * Initialize the alarms library
@@ -54,6 +59,12 @@ int32_t AlarmsInitialize(void)
     SystemAlarmsInitialize();
 
     lock = xSemaphoreCreateRecursiveMutex();
+
+    SystemAlarmsAlarmData alarms;
+    SystemAlarmsAlarmGet(&alarms);
+    updateShadow(&alarms);
+    // keep the shadow in sync with writes that do not go through this library
+    SystemAlarmsConnectCallback(&alarmsUpdatedCb);
     // do not change the default states of the alarms, let the init code generated by the uavobjectgenerator handle that
     // AlarmsClearAll();
     // AlarmsDefaultAll();
@@ -75,6 +86,10 @@ int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity
         return -1;
     }
 
+    if (severityShadow[alarm] == severity) {
+        return 0;
+    }
+
     // Lock
     xSemaphoreTakeRecursive(lock, portMAX_DELAY);
 
@@ -88,6 +103,7 @@ int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity
         lastAlarmChange[alarm] = flightTime;
         SystemAlarmsAlarmSet(&alarms);
     }
+    updateShadow(&alarms);
 
     // Release lock
     xSemaphoreGiveRecursive(lock);
@@ -114,6 +130,11 @@ int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
         return -1;
     }
 
+    // status only changes along with the severity
+    if (severityShadow[alarm] == severity) {
+        return 0;
+    }
+
     // Lock
     xSemaphoreTakeRecursive(lock, portMAX_DELAY);
 
@@ -129,6 +150,7 @@ int32_t ExtendedAlarmsSet(SystemAlarmsAlarmElem alarm,
         lastAlarmChange[alarm] = flightTime;
         SystemAlarmsSet(&alarms);
     }
+    updateShadow(&alarms.Alarm);
 
     // Release lock
     xSemaphoreGiveRecursive(lock);
@@ -281,6 +303,27 @@ SystemAlarmsAlarmOptions AlarmsGetHighestSeverity()
     return highest;
 }
 
+/**
+ * Copy the Alarm field into the shadow, called with the lock held or before
+ * any alarm is set
+ */
+static void updateShadow(SystemAlarmsAlarmData *alarms)
+{
+    for (uint32_t n = 0; n < SYSTEMALARMS_ALARM_NUMELEM; ++n) {
+        severityShadow[n] = SystemAlarmsAlarmToArray(*alarms)[n];
+    }
+}
+
+static void alarmsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    SystemAlarmsAlarmData alarms;
+
+    xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+    SystemAlarmsAlarmGet(&alarms);
+    updateShadow(&alarms);
+    xSemaphoreGiveRecursive(lock);
+}
+
 /**
  * @}
  * @}
@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ *
+ * @file       fastloop.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Direct call path for gyro samples, from the sensor driver
+ *             through state estimation to the stabilization inner loop.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+#include <gyrostate.h>
+#include "inc/fastloop.h"
+
+static fastloop_gyro_handler stages[FASTLOOP_STAGE_COUNT];
+static volatile bool enabled;
+static uint8_t publish_divider = 1;
+static uint8_t publish_count;
+static volatile uint32_t sample_time;
+
+void fastloop_register(fastloop_stage_t stage, fastloop_gyro_handler handler)
+{
+    PIOS_Assert(stage < FASTLOOP_STAGE_COUNT);
+    stages[stage] = handler;
+}
+
+void fastloop_configure(bool enable, uint8_t divider)
+{
+    publish_divider = divider ? divider : 1;
+    enabled = enable;
+}
+
+bool fastloop_active()
+{
+    return enabled && stages[FASTLOOP_STAGE_CONTROL];
+}
+
+bool fastloop_gyro(const float gyro[3])
+{
+    sample_time = PIOS_DELAY_GetRaw();
+    if (!fastloop_active()) {
+        return false;
+    }
+
+    float rates[3] = { gyro[0], gyro[1], gyro[2] };
+    for (uint8_t i = 0; i < FASTLOOP_STAGE_COUNT; i++) {
+        fastloop_gyro_handler handler = stages[i];
+        if (handler) {
+            handler(rates);
+        }
+    }
+
+    // the UAVObject only serves telemetry and logging now, the stages above got every sample
+    if (++publish_count >= publish_divider) {
+        GyroStateData gyroState;
+        publish_count = 0;
+        gyroState.x   = rates[0];
+        gyroState.y   = rates[1];
+        gyroState.z   = rates[2];
+        GyroStateSet(&gyroState);
+    }
+    return true;
+}
+
+uint32_t fastloop_sample_time()
+{
+    return sample_time;
+}
@@ -27,6 +27,14 @@
 
 #include "fifo_buffer.h"
 
+/*
+ * The buffer is safe without locking for one producer and one consumer, e.g.
+ * an ISR and a task: only the producer writes wr and only the consumer writes
+ * rd. The data access must complete before the index moving past it is
+ * stored, which on the single core targets only needs a compiler barrier.
+ */
+#define FIFO_BUF_PUBLISH() __asm__ volatile ("" ::: "memory")
+
 // *****************************************************************************
 // circular buffer functions
 
@@ -90,6 +98,7 @@ void fifoBuf_removeData(t_fifo_buffer *buf, uint16_t len)
         rd -= buf_size;
     }
 
+    FIFO_BUF_PUBLISH();
     buf->rd = rd;
 }
 
@@ -123,6 +132,7 @@ int16_t fifoBuf_getByte(t_fifo_buffer *buf)
         rd = 0;
     }
 
+    FIFO_BUF_PUBLISH();
     buf->rd = rd;
 
     return b; // return the byte
@@ -144,70 +154,42 @@ uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len)
     if (num_bytes < 1) {
         return 0; // return number of bytes copied
     }
-    uint8_t *p = (uint8_t *)data;
-    uint16_t i = 0;
-
-    while (num_bytes > 0) {
-        uint16_t block_len = buf_size - rd;
-        if (block_len > num_bytes) {
-            block_len = num_bytes;
-        }
-        if (block_len == 1) {
-            *((uint8_t *)(p + i)) = *((uint8_t *)(buff + rd));
-        } else {
-            memcpy(p + i, buff + rd, block_len);
-        }
-        i  += block_len;
-        num_bytes -= block_len;
-        rd += block_len;
-        if (rd >= buf_size) {
-            rd = 0;
-        }
+
+    // the data is at most split in two blocks by the end of the buffer
+    uint16_t block_len = buf_size - rd;
+    if (block_len > num_bytes) {
+        block_len = num_bytes;
     }
+    memcpy(data, buff + rd, block_len);
+    memcpy((uint8_t *)data + block_len, buff, num_bytes - block_len);
 
-    return i; // return number of bytes copied
+    return num_bytes; // return number of bytes copied
 }
 
 uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len)
 { // get data from our rx buffer
+    uint16_t num_bytes = fifoBuf_getDataPeek(buf, data, len);
+
+    fifoBuf_removeData(buf, num_bytes);
+
+    return num_bytes; // return number of bytes copied
+}
+
+uint16_t fifoBuf_getReadSpan(t_fifo_buffer *buf, uint8_t **data)
+{ // get the data readable in place up to the end of the buffer
     uint16_t rd        = buf->rd;
     uint16_t buf_size  = buf->buf_size;
-    uint8_t *buff      = buf->buf_ptr;
 
     // get number of bytes available
     uint16_t num_bytes = fifoBuf_getUsed(buf);
 
-    if (num_bytes > len) {
-        num_bytes = len;
-    }
-
-    if (num_bytes < 1) {
-        return 0; // return number of bytes copied
-    }
-    uint8_t *p = (uint8_t *)data;
-    uint16_t i = 0;
-
-    while (num_bytes > 0) {
-        uint16_t block_len = buf_size - rd;
-        if (block_len > num_bytes) {
-            block_len = num_bytes;
-        }
-        if (block_len == 1) {
-            *((uint8_t *)(p + i)) = *((uint8_t *)(buff + rd));
-        } else {
-            memcpy(p + i, buff + rd, block_len);
-        }
-        i  += block_len;
-        num_bytes -= block_len;
-        rd += block_len;
-        if (rd >= buf_size) {
-            rd = 0;
-        }
+    if (num_bytes > buf_size - rd) {
+        num_bytes = buf_size - rd;
     }
 
-    buf->rd = rd;
+    *data = buf->buf_ptr + rd;
 
-    return i; // return number of bytes copied
+    return num_bytes; // release them with fifoBuf_removeData()
 }
 
 uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b)
@@ -227,6 +209,7 @@ uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b)
         wr = 0;
     }
 
+    FIFO_BUF_PUBLISH();
     buf->wr = wr;
 
     return 1; // return number of bytes copied
@@ -244,33 +227,56 @@ uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len)
         num_bytes = len;
     }
 
+    // the free space is at most split in two blocks by the end of the buffer
+    uint16_t block_len = buf_size - wr;
+    if (block_len > num_bytes) {
+        block_len = num_bytes;
+    }
+    memcpy(buff + wr, data, block_len);
+    memcpy(buff, (const uint8_t *)data + block_len, num_bytes - block_len);
+
+    fifoBuf_commitWrite(buf, num_bytes);
+
+    return num_bytes; // return number of bytes copied
+}
+
+uint16_t fifoBuf_getWriteSpan(t_fifo_buffer *buf, uint8_t **data)
+{ // get the free space writable in place up to the end of the buffer
+    uint16_t wr        = buf->wr;
+    uint16_t buf_size  = buf->buf_size;
+
+    uint16_t num_bytes = fifoBuf_getFree(buf);
+
+    if (num_bytes > buf_size - wr) {
+        num_bytes = buf_size - wr;
+    }
+
+    *data = buf->buf_ptr + wr;
+
+    return num_bytes; // publish them with fifoBuf_commitWrite()
+}
+
+void fifoBuf_commitWrite(t_fifo_buffer *buf, uint16_t len)
+{ // add a number of bytes already written in place to the buffer
+    uint16_t wr        = buf->wr;
+    uint16_t buf_size  = buf->buf_size;
+
+    uint16_t num_bytes = fifoBuf_getFree(buf);
+
+    if (num_bytes > len) {
+        num_bytes = len;
+    }
+
     if (num_bytes < 1) {
-        return 0; // return number of bytes copied
+        return; // nothing to add
     }
-    uint8_t *p = (uint8_t *)data;
-    uint16_t i = 0;
-
-    while (num_bytes > 0) {
-        uint16_t block_len = buf_size - wr;
-        if (block_len > num_bytes) {
-            block_len = num_bytes;
-        }
-        if (block_len == 1) {
-            *((uint8_t *)(buff + wr)) = *((uint8_t *)(p + i));
-        } else {
-            memcpy(buff + wr, p + i, block_len);
-        }
-        i  += block_len;
-        num_bytes -= block_len;
-        wr += block_len;
-        if (wr >= buf_size) {
-            wr = 0;
-        }
+    wr += num_bytes;
+    if (wr >= buf_size) {
+        wr -= buf_size;
     }
 
+    FIFO_BUF_PUBLISH();
     buf->wr = wr;
-
-    return i; // return number of bytes copied
 }
 
 void fifoBuf_init(t_fifo_buffer *buf, const void *buffer, const uint16_t buffer_size)
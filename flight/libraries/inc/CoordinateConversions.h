@@ -68,6 +68,24 @@ void Quaternion2zB(const float q[4], float z[3]);
 // ****** Express LLA in a local NED Base Frame ********
 void LLA2Base(int32_t LLAi[3], double BaseECEF[3], float Rne[3][3], float NED[3]);
 
+// ****** Local tangent plane around a base, LLA to NED in single precision ********
+// The scales are computed once in double precision, the conversion itself works on
+// the fixed point differences to the base and is accurate to centimeters within
+// about ten kilometers, the distances of a mission.
+typedef struct {
+    int32_t LLAi[3];
+    // meters per 1e-7 degree of latitude and of longitude at the base
+    float   northScale;
+    float   eastScale;
+    float   tanLat;
+    // 1 / (radius of curvature + altitude), along the meridian and the prime vertical
+    float   invM;
+    float   invN;
+} LocalTangentPlane;
+
+void LTPFromLLA(int32_t BaseLLAi[3], LocalTangentPlane *ltp);
+void LLA2LTP(const int32_t LLAi[3], const LocalTangentPlane *ltp, float NED[3]);
+
 // ****** Express ECEF in a local NED Base Frame ********
 void ECEF2Base(double ECEF[3], double BaseECEF[3], float Rne[3][3], float NED[3]);
 
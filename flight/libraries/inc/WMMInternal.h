@@ -115,6 +115,22 @@ typedef struct {
     float GVdot; /*16. Yearly rate of chnage in grid variation */
 } WMMtype_GeoMagneticElements;
 
+// state kept across WMM_GetMagVector calls, every stage is only redone when its inputs change
+typedef struct {
+    WMMtype_Ellipsoid Ellip;
+    WMMtype_MagneticModel MagneticModel;
+    float schmidtQuasiNorm[NUMPCUP]; // Gauss to Schmidt ratios, fixed for nMax
+    float TimedCoeffG[NUMTERMS]; // main field coefficients at CoeffDate
+    float TimedCoeffH[NUMTERMS];
+    float CoeffDate;
+    WMMtype_LegendreFunction LegendreFunction; // valid for LegendrePhig
+    float LegendrePhig;
+    WMMtype_SphericalHarmonicVariables SphVariables; // valid for SphLambda and SphRadius
+    float SphLambda;
+    float SphRadius;
+    bool  Initialized;
+} WMMtype_Context;
+
 // Internal Function Prototypes
 void WMM_Set_Coeff_Array();
 int WMM_GeodeticToSpherical(WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_CoordSpherical *CoordSpherical);
@@ -135,6 +151,8 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax);
 
 int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax);
 
+void WMM_SchmidtQuasiNorm(float *schmidtQuasiNorm, uint16_t nMax);
+
 int WMM_RotateMagneticVector(WMMtype_CoordSpherical *,
                              WMMtype_CoordGeodetic *CoordGeodetic,
                              WMMtype_MagneticResults *MagneticResultsSph, WMMtype_MagneticResults *MagneticResultsGeo);
@@ -153,6 +171,7 @@ int WMM_Summation(WMMtype_LegendreFunction *LegendreFunction,
 int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
                          SphVariables, WMMtype_CoordSpherical *CoordSpherical, WMMtype_MagneticResults *MagneticResults);
 
+void WMM_TimelyModifyMagneticModel();
 float WMM_get_main_field_coeff_g(uint16_t index);
 float WMM_get_main_field_coeff_h(uint16_t index);
 float WMM_get_secular_var_coeff_g(uint16_t index);
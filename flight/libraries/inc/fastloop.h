@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ *
+ * @file       fastloop.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Direct call path for gyro samples, from the sensor driver
+ *             through state estimation to the stabilization inner loop.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FASTLOOP_H_
+#define FASTLOOP_H_
+#include <openpilot.h>
+
+/**
+ * Stages of the gyro fast loop, called in this order
+ */
+typedef enum {
+    FASTLOOP_STAGE_ESTIMATION = 0,
+    FASTLOOP_STAGE_CONTROL,
+    // only records the rates, after they went through estimation and control
+    FASTLOOP_STAGE_MONITOR,
+    FASTLOOP_STAGE_COUNT
+} fastloop_stage_t;
+
+/**
+ * A stage may modify the gyro rates in deg/s passed to the stages after it
+ */
+typedef void (*fastloop_gyro_handler)(float gyro[3]);
+
+/**
+ * @brief register the handler of a stage
+ * @param[in] stage stage to set
+ * @param[in] handler handler, NULL removes the stage
+ */
+void fastloop_register(fastloop_stage_t stage, fastloop_gyro_handler handler);
+
+/**
+ * @brief enable or disable the fast loop
+ * @param[in] enable true runs the stages straight from fastloop_gyro()
+ * @param[in] divider GyroState is published once every divider samples
+ */
+void fastloop_configure(bool enable, uint8_t divider);
+
+/**
+ * @brief tell whether gyro samples go through the fast loop
+ * @return true if enabled and a control stage is registered
+ */
+bool fastloop_active();
+
+/**
+ * @brief feed a gyro sample, called by the module producing GyroState data
+ * @param[in] gyro rates in deg/s
+ * @return true if the sample went through the fast loop, false if the
+ *         caller must publish GyroState itself
+ */
+bool fastloop_gyro(const float gyro[3]);
+
+/**
+ * @brief time the last gyro sample was fed, to measure the sensor to actuator latency
+ * @return raw PIOS_DELAY time
+ */
+uint32_t fastloop_sample_time();
+
+#endif /* FASTLOOP_H_ */
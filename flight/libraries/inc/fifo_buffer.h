@@ -53,10 +53,17 @@ int16_t fifoBuf_getByte(t_fifo_buffer *buf);
 uint16_t fifoBuf_getDataPeek(t_fifo_buffer *buf, void *data, uint16_t len);
 uint16_t fifoBuf_getData(t_fifo_buffer *buf, void *data, uint16_t len);
 
+// data can be parsed in place, at most up to the end of the buffer, then released with fifoBuf_removeData()
+uint16_t fifoBuf_getReadSpan(t_fifo_buffer *buf, uint8_t **data);
+
 uint16_t fifoBuf_putByte(t_fifo_buffer *buf, const uint8_t b);
 
 uint16_t fifoBuf_putData(t_fifo_buffer *buf, const void *data, uint16_t len);
 
+// free space can be filled in place, at most up to the end of the buffer, then published with fifoBuf_commitWrite()
+uint16_t fifoBuf_getWriteSpan(t_fifo_buffer *buf, uint8_t **data);
+void fifoBuf_commitWrite(t_fifo_buffer *buf, uint16_t len);
+
 void fifoBuf_init(t_fifo_buffer *buf, const void *buffer, const uint16_t buffer_size);
 
 // *********************
@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       insgps16state.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Include file of the 16 state INSGPS, which adds accel bias
+ *             states to the 13 state filter declared in insgps.h.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef INSGPS16STATE_H
+#define INSGPS16STATE_H
+
+#include "insgps.h"
+
+// Both filters are linked into the firmware, so the 16 state one uses its own
+// names. Sensor masks and the Nav structure are shared with insgps.h.
+void INS16GPSInit();
+void INS16StatePrediction(float gyro_data[3], float accel_data[3], float dT);
+void INS16CovariancePrediction(float dT);
+void INS16Correction(float mag_data[3], float Pos[3], float Vel[3], float BaroAlt, uint16_t SensorsUsed);
+
+void INS16ResetP(float PDiag[16]);
+void INS16GetP(float PDiag[16]);
+void INS16SetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3]);
+void INS16SetPosVelVar(float PosVar[3], float VelVar[3]);
+void INS16SetGyroBias(float gyro_bias[3]);
+void INS16SetAccelVar(float accel_var[3]);
+void INS16SetGyroVar(float gyro_var[3]);
+void INS16SetGyroBiasVar(float gyro_bias_var[3]);
+void INS16SetAccelBiasVar(float accel_bias_var[3]);
+void INS16SetMagNorth(float B[3]);
+void INS16SetMagVar(float scaled_mag_var[3]);
+void INS16SetBaroVar(float baro_var);
+void INS16PosVelReset(float pos[3], float vel[3]);
+
+uint16_t ins16_get_num_states();
+
+// Nav structure containing current solution of the 16 state filter
+extern struct NavStruct Nav16;
+
+#endif /* INSGPS16STATE_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -34,6 +34,27 @@ struct path_status {
     float correction_vector[3];
 };
 
+// Segment geometry, only depends on PathDesired. Compute it once whenever
+// PathDesired changes and use path_geometry_progress() in the loop.
+struct path_geometry {
+    uint8_t kind;
+    bool    mode3D;
+    bool    clockwise;
+    float   start[3];
+    float   end[3];
+    float   vector[3]; // end - start, no Down component in 2D modes
+    float   unit[3]; // vector normalized, zero for a degenerate segment
+    float   length;
+    float   inv_length_sq;
+    float   inv_progress_length; // 1 / max(length, 1m) for endpoint progress
+    float   radius; // circles only
+    float   radius_angle; // circles only, direction of the radius in 0..2pi
+    float   starting_velocity;
+    float   ending_velocity;
+};
+
+void path_geometry_update(const PathDesiredData *path, struct path_geometry *geometry);
+void path_geometry_progress(const struct path_geometry *geometry, const float *cur_point, struct path_status *status);
 void path_progress(PathDesiredData *path, float *cur_point, struct path_status *status);
 
 #endif
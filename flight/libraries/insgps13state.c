@@ -75,11 +75,7 @@ void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
 // b.............  .......X.
 // c.............  ........X
 
-static const int8_t FrowMin[NUMX] = { 3, 4, 5, 6, 6, 6, 7, 6, 6, 6, 13, 13, 13 };
-static const int8_t FrowMax[NUMX] = { 3, 4, 5, 9, 9, 9, 12, 12, 12, 12, -1, -1, -1 };
-
-static const int8_t GrowMin[NUMX] = { 9, 9, 9, 3, 3, 3, 0, 0, 0, 0, 6, 7, 8 };
-static const int8_t GrowMax[NUMX] = { -1, -1, -1, 5, 5, 5, 2, 2, 2, 2, 6, 7, 8 };
+// The sparsity of F and G is built into CovariancePrediction()
 
 static const int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
 static const int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
@@ -434,64 +430,102 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
 // The first Method is very specific to this implementation
 // ************************************************
 
+// Running sums over a span of columns known at compile time. Terms are added
+// one by one, in the same order as a plain loop, and the compiler unrolls
+// each call since every caller passes constant bounds.
+static inline __attribute__((always_inline)) float AccRowCol(float acc, const float *row, float M[NUMX][NUMX], int8_t col, int8_t start, int8_t end)
+{
+    for (int8_t k = start; k <= end; k++) {
+        acc += row[k] * M[k][col];
+    }
+    return acc;
+}
+
+static inline __attribute__((always_inline)) float AccRowRow(float acc, const float *a, const float *b, int8_t start, int8_t end)
+{
+    for (int8_t k = start; k <= end; k++) {
+        acc += a[k] * b[k];
+    }
+    return acc;
+}
+
+static inline __attribute__((always_inline)) float AccGQG(float acc, const float *Q, const float *Gi, const float *Gj, int8_t start, int8_t end)
+{
+    for (int8_t k = start; k <= end; k++) {
+        acc += Q[k] * Gi[k] * Gj[k];
+    }
+    return acc;
+}
+
 __attribute__((optimize("O3")))
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
                           float Q[NUMW], float dT, float P[NUMX][NUMX])
 {
     // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = (T^2)[(P/T + F*P)*(I/T + F') + G*Q*G')]
+    //
+    // The loops below are split along the row blocks of F and G drawn above
+    // (position, velocity, quaternion, gyro bias), so that every inner loop
+    // has fixed bounds and the blocks that are known to be zero are skipped.
 
     float dT1  = 1.0f / dT; // multiplication is faster than division on fpu.
     float dTsq = dT * dT;
 
     float Dummy[NUMX][NUMX];
-    int8_t i;
-
-    for (i = 0; i < NUMX; i++) { // Calculate Dummy = (P/T +F*P)
-        float *Firow   = F[i];
-        float *Pirow   = P[i];
-        float *Dirow   = Dummy[i];
-        int8_t Fistart = FrowMin[i];
-        int8_t Fiend   = FrowMax[i];
-        int8_t j;
-        for (j = 0; j < NUMX; j++) {
-            Dirow[j] = Pirow[j] * dT1; // Dummy = P / T ...
-            int8_t k;
-            for (k = Fistart; k <= Fiend; k++) {
-                Dirow[j] += Firow[k] * P[k][j]; // [] + F * P
-            }
+    int8_t i, j;
+
+    for (j = 0; j < NUMX; j++) { // Calculate Dummy = (P/T +F*P)
+        for (i = 0; i < 3; i++) { // dPos/dVel
+            Dummy[i][j] = P[i][j] * dT1 + F[i][i + 3] * P[i + 3][j];
+        }
+        for (i = 3; i < 6; i++) { // dVel/dq
+            Dummy[i][j] = AccRowCol(P[i][j] * dT1, F[i], P, j, 6, 9);
+        }
+        Dummy[6][j] = AccRowCol(P[6][j] * dT1, F[6], P, j, 7, 12); // dq/dq, dq/dgyrobias
+        for (i = 7; i < 10; i++) {
+            Dummy[i][j] = AccRowCol(P[i][j] * dT1, F[i], P, j, 6, 12);
+        }
+        for (i = 10; i < NUMX; i++) { // gyro bias is a random walk
+            Dummy[i][j] = P[i][j] * dT1;
         }
     }
     for (i = 0; i < NUMX; i++) { // Calculate Pnew = (T^2) [Dummy/T + Dummy*F' + G*Qw*G']
-        float *Dirow   = Dummy[i];
-        float *Girow   = G[i];
-        float *Pirow   = P[i];
-        int8_t Gistart = GrowMin[i];
-        int8_t Giend   = GrowMax[i];
-        int8_t j;
-        for (j = i; j < NUMX; j++) { // Use symmetry, ie only find upper triangular
-            float Ptmp = Dirow[j] * dT1; // Pnew = Dummy / T ...
-
-            {
-                float *Fjrow   = F[j];
-                int8_t Fjstart = FrowMin[j];
-                int8_t Fjend   = FrowMax[j];
-                int8_t k;
-                for (k = Fjstart; k <= Fjend; k++) {
-                    Ptmp += Dirow[k] * Fjrow[k]; // [] + Dummy*F' ...
-                }
+        float *Dirow = Dummy[i];
+        float *Girow = G[i];
+        float *Pirow = P[i];
+        float Ptmp;
+
+        // Use symmetry, ie only find upper triangular, one block of F rows at a time
+        for (j = i; j < 3; j++) {
+            Ptmp    = Dirow[j] * dT1 + Dirow[j + 3] * F[j][j + 3];
+            P[j][i] = Pirow[j] = Ptmp * dTsq;
+        }
+        for (j = MAX(i, 3); j < 6; j++) {
+            Ptmp = AccRowRow(Dirow[j] * dT1, Dirow, F[j], 6, 9);
+            if (i >= 3) { // G*Q*G' of the velocity block
+                Ptmp = AccGQG(Ptmp, Q, Girow, G[j], 3, 5);
             }
-
-            {
-                float *Gjrow   = G[j];
-                int8_t Gjstart = MAX(Gistart, GrowMin[j]);
-                int8_t Gjend   = MIN(Giend, GrowMax[j]);
-                int8_t k;
-                for (k = Gjstart; k <= Gjend; k++) {
-                    Ptmp += Q[k] * Girow[k] * Gjrow[k]; // [] + G*Q*G' ...
-                }
+            P[j][i] = Pirow[j] = Ptmp * dTsq;
+        }
+        if (i <= 6) {
+            Ptmp = AccRowRow(Dirow[6] * dT1, Dirow, F[6], 7, 12);
+            if (i == 6) { // G*Q*G' of the quaternion block
+                Ptmp = AccGQG(Ptmp, Q, Girow, G[6], 0, 2);
             }
-
-            P[j][i] = Pirow[j] = Ptmp * dTsq; // [] * (T^2)
+            P[6][i] = Pirow[6] = Ptmp * dTsq;
+        }
+        for (j = MAX(i, 7); j < 10; j++) {
+            Ptmp = AccRowRow(Dirow[j] * dT1, Dirow, F[j], 6, 12);
+            if (i >= 6) {
+                Ptmp = AccGQG(Ptmp, Q, Girow, G[j], 0, 2);
+            }
+            P[j][i] = Pirow[j] = Ptmp * dTsq;
+        }
+        for (j = MAX(i, 10); j < NUMX; j++) {
+            Ptmp = Dirow[j] * dT1;
+            if (j == i) { // each gyro bias has its own noise input
+                Ptmp += Q[j - 4] * Girow[j - 4] * G[j][j - 4];
+            }
+            P[j][i] = Pirow[j] = Ptmp * dTsq;
         }
     }
 }
@@ -522,19 +556,25 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
 
     for (m = 0; m < NUMV; m++) {
         if (SensorsUsed & (0x01 << m)) { // use this sensor for update
-            for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                HP[j] = 0;
-                for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                    HP[j] += H[m][k] * P[k][j];
+            if (HrowMin[m] == HrowMax[m]) {
+                // position, velocity and altitude measure a single state
+                k = HrowMin[m];
+                float Hmk = H[m][k];
+                for (j = 0; j < NUMX; j++) { // Find Hp = H*P
+                    HP[j] = Hmk * P[k][j];
                 }
-            }
-            HPHR = R[m]; // Find  HPHR = H*P*H' + R
-            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                HPHR += HP[k] * H[m][k];
+                HPHR = R[m] + HP[k] * Hmk; // Find  HPHR = H*P*H' + R
+            } else {
+                // magnetometer rows depend on the quaternion only
+                for (j = 0; j < NUMX; j++) { // Find Hp = H*P
+                    HP[j] = AccRowCol(0.0f, H[m], P, j, 6, 9);
+                }
+                HPHR = AccRowRow(R[m], HP, H[m], 6, 9); // Find  HPHR = H*P*H' + R
             }
 
+            float HPHR1 = 1.0f / HPHR;
             for (k = 0; k < NUMX; k++) {
-                Km[k] = HP[k] / HPHR; // find K = HP/HPHR
+                Km[k] = HP[k] * HPHR1; // find K = HP/HPHR
             }
             for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
                 for (j = i; j < NUMX; j++) {
@@ -29,7 +29,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
-#include "insgps.h"
+#include "insgps16state.h"
 #include <math.h>
 #include <stdint.h>
 
@@ -46,35 +46,37 @@
 #endif
 
 // Private functions
-void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX]);
-void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
-                  uint16_t SensorsUsed);
-void RungeKutta(float X[NUMX], float U[NUMU], float dT);
-void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
-void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
-                 float G[NUMX][NUMW]);
-void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV]);
-void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
+static void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                 float Q[NUMW], float dT, float P[NUMX][NUMX]);
+static void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                         float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                         uint16_t SensorsUsed);
+static void RungeKutta(float X[NUMX], float U[NUMU], float dT);
+static void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
+static void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
+                        float G[NUMX][NUMW]);
+static void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV]);
+static void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
 
 // Private variables
-float F[NUMX][NUMX], G[NUMX][NUMW], H[NUMV][NUMX]; // linearized system matrices
+static float F[NUMX][NUMX], G[NUMX][NUMW], H[NUMV][NUMX]; // linearized system matrices
 // global to init to zero and maintain zero elements
-float Be[3]; // local magnetic unit vector in NED frame
-float P[NUMX][NUMX], X[NUMX]; // covariance matrix and state vector
-float Q[NUMW], R[NUMV]; // input noise and measurement noise variances
-float K[NUMX][NUMV]; // feedback gain matrix
+static float Be[3]; // local magnetic unit vector in NED frame
+static float P[NUMX][NUMX], X[NUMX]; // covariance matrix and state vector
+static float Q[NUMW], R[NUMV]; // input noise and measurement noise variances
+
+// Global variables
+struct NavStruct Nav16;
 
 // *************  Exposed Functions ****************
 // *************************************************
 
-uint16_t ins_get_num_states()
+uint16_t ins16_get_num_states()
 {
     return NUMX;
 }
 
-void INSGPSInit() // pretty much just a place holder for now
+void INS16GPSInit() // pretty much just a place holder for now
 {
     Be[0] = 1.0f;
     Be[1] = 0;
@@ -90,11 +92,13 @@ void INSGPSInit() // pretty much just a place holder for now
     P[3][3]   = P[4][4] = P[5][5] = 5.0f;     // initial velocity variance (m/s)^2
     P[6][6]   = P[7][7] = P[8][8] = P[9][9] = 1e-5f;  // initial quaternion variance
     P[10][10] = P[11][11] = P[12][12] = 1e-5f; // initial gyro bias variance (rad/s)^2
+    P[13][13] = P[14][14] = P[15][15] = 1e-5f; // initial accel bias variance (m/s^2)^2
 
     X[0]  = X[1] = X[2] = X[3] = X[4] = X[5] = 0.0f; // initial pos and vel (m)
     X[6]  = 1.0f;
     X[7]  = X[8] = X[9] = 0.0f;      // initial quaternion (level and North) (m/s)
     X[10] = X[11] = X[12] = 0.0f; // initial gyro bias (rad/s)
+    X[13] = X[14] = X[15] = 0.0f; // initial accel bias (m/s^2)
 
     Q[0]  = Q[1] = Q[2] = 50e-8f;    // gyro noise variance (rad/s)^2
     Q[3]  = Q[4] = Q[5] = 0.01f;     // accelerometer noise variance (m/s^2)^2
@@ -109,7 +113,7 @@ void INSGPSInit() // pretty much just a place holder for now
     R[9]  = .05f;            // High freq altimeter noise variance (m^2)
 }
 
-void INSResetP(float PDiag[NUMX])
+void INS16ResetP(float PDiag[NUMX])
 {
     uint8_t i, j;
 
@@ -124,27 +128,39 @@ void INSResetP(float PDiag[NUMX])
     }
 }
 
-void INSSetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3])
+void INS16GetP(float PDiag[NUMX])
+{
+    uint8_t i;
+
+    // retrieve diagonal elements (aka state variance)
+    for (i = 0; i < NUMX; i++) {
+        if (PDiag != 0) {
+            PDiag[i] = P[i][i];
+        }
+    }
+}
+
+void INS16SetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3])
 {
-    Nav.Pos[0] = X[0] = pos[0];
-    Nav.Pos[1] = X[1] = pos[1];
-    Nav.Pos[2] = X[2] = pos[2];
-    Nav.Vel[0] = X[3] = vel[0];
-    Nav.Vel[1] = X[4] = vel[1];
-    Nav.Vel[2] = X[5] = vel[2];
-    Nav.q[0]   = X[6] = q[0];
-    Nav.q[1]   = X[7] = q[1];
-    Nav.q[2]   = X[8] = q[2];
-    Nav.q[3]   = X[9] = q[3];
-    Nav.gyro_bias[0]  = X[10] = gyro_bias[0];
-    Nav.gyro_bias[1]  = X[11] = gyro_bias[1];
-    Nav.gyro_bias[2]  = X[12] = gyro_bias[2];
-    Nav.accel_bias[0] = X[13] = accel_bias[0];
-    Nav.accel_bias[1] = X[14] = accel_bias[1];
-    Nav.accel_bias[2] = X[15] = accel_bias[2];
+    Nav16.Pos[0] = X[0] = pos[0];
+    Nav16.Pos[1] = X[1] = pos[1];
+    Nav16.Pos[2] = X[2] = pos[2];
+    Nav16.Vel[0] = X[3] = vel[0];
+    Nav16.Vel[1] = X[4] = vel[1];
+    Nav16.Vel[2] = X[5] = vel[2];
+    Nav16.q[0]   = X[6] = q[0];
+    Nav16.q[1]   = X[7] = q[1];
+    Nav16.q[2]   = X[8] = q[2];
+    Nav16.q[3]   = X[9] = q[3];
+    Nav16.gyro_bias[0]  = X[10] = gyro_bias[0];
+    Nav16.gyro_bias[1]  = X[11] = gyro_bias[1];
+    Nav16.gyro_bias[2]  = X[12] = gyro_bias[2];
+    Nav16.accel_bias[0] = X[13] = accel_bias[0];
+    Nav16.accel_bias[1] = X[14] = accel_bias[1];
+    Nav16.accel_bias[2] = X[15] = accel_bias[2];
 }
 
-void INSPosVelReset(float pos[3], float vel[3])
+void INS16PosVelReset(float pos[3], float vel[3])
 {
     for (int i = 0; i < 6; i++) {
         for (int j = i; j < NUMX; j++) {
@@ -164,55 +180,76 @@ void INSPosVelReset(float pos[3], float vel[3])
     X[5]    = vel[2];
 }
 
-void INSSetPosVelVar(float PosVar, float VelVar)
+void INS16SetPosVelVar(float PosVar[3], float VelVar[3])
 {
-    R[0] = PosVar;
-    R[1] = PosVar;
-    R[2] = PosVar;
-    R[3] = VelVar;
-    R[4] = VelVar;
-    R[5] = PosVar; // Don't change vertical velocity, not measured
+    R[0] = PosVar[0];
+    R[1] = PosVar[1];
+    R[2] = PosVar[2];
+    R[3] = VelVar[0];
+    R[4] = VelVar[1];
+    R[5] = VelVar[2];
 }
 
-void INSSetGyroBias(float gyro_bias[3])
+void INS16SetGyroBias(float gyro_bias[3])
 {
     X[10] = gyro_bias[0];
     X[11] = gyro_bias[1];
     X[12] = gyro_bias[2];
 }
 
-void INSSetAccelVar(float accel_var[3])
+void INS16SetAccelVar(float accel_var[3])
 {
     Q[3] = accel_var[0];
     Q[4] = accel_var[1];
     Q[5] = accel_var[2];
 }
 
-void INSSetGyroVar(float gyro_var[3])
+void INS16SetGyroVar(float gyro_var[3])
 {
     Q[0] = gyro_var[0];
     Q[1] = gyro_var[1];
     Q[2] = gyro_var[2];
 }
 
-void INSSetMagVar(float scaled_mag_var[3])
+void INS16SetGyroBiasVar(float gyro_bias_var[3])
+{
+    Q[6] = gyro_bias_var[0];
+    Q[7] = gyro_bias_var[1];
+    Q[8] = gyro_bias_var[2];
+}
+
+void INS16SetAccelBiasVar(float accel_bias_var[3])
+{
+    Q[9]  = accel_bias_var[0];
+    Q[10] = accel_bias_var[1];
+    Q[11] = accel_bias_var[2];
+}
+
+void INS16SetMagVar(float scaled_mag_var[3])
 {
     R[6] = scaled_mag_var[0];
     R[7] = scaled_mag_var[1];
     R[8] = scaled_mag_var[2];
 }
 
-void INSSetMagNorth(float B[3])
+void INS16SetBaroVar(float baro_var)
 {
-    Be[0] = B[0];
-    Be[1] = B[1];
-    Be[2] = B[2];
+    R[9] = baro_var;
 }
 
-void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT)
+void INS16SetMagNorth(float B[3])
+{
+    float invmag = 1.0f / sqrtf(B[0] * B[0] + B[1] * B[1] + B[2] * B[2]);
+
+    Be[0] = B[0] * invmag;
+    Be[1] = B[1] * invmag;
+    Be[2] = B[2] * invmag;
+}
+
+void INS16StatePrediction(float gyro_data[3], float accel_data[3], float dT)
 {
     float U[6];
-    float qmag;
+    float invqmag;
 
     // rate gyro inputs in units of rad/s
     U[0] = gyro_data[0];
@@ -227,77 +264,42 @@ void INSStatePrediction(float gyro_data[3], float accel_data[3], float dT)
     // EKF prediction step
     LinearizeFG(X, U, F, G);
     RungeKutta(X, U, dT);
-    qmag  = sqrt(X[6] * X[6] + X[7] * X[7] + X[8] * X[8] + X[9] * X[9]);
-    X[6] /= qmag;
-    X[7] /= qmag;
-    X[8] /= qmag;
-    X[9] /= qmag;
+    invqmag = 1.0f / sqrtf(X[6] * X[6] + X[7] * X[7] + X[8] * X[8] + X[9] * X[9]);
+    X[6]   *= invqmag;
+    X[7]   *= invqmag;
+    X[8]   *= invqmag;
+    X[9]   *= invqmag;
     // CovariancePrediction(F,G,Q,dT,P);
 
     // Update Nav solution structure
-    Nav.Pos[0] = X[0];
-    Nav.Pos[1] = X[1];
-    Nav.Pos[2] = X[2];
-    Nav.Vel[0] = X[3];
-    Nav.Vel[1] = X[4];
-    Nav.Vel[2] = X[5];
-    Nav.q[0]   = X[6];
-    Nav.q[1]   = X[7];
-    Nav.q[2]   = X[8];
-    Nav.q[3]   = X[9];
-    Nav.gyro_bias[0] = X[10];
-    Nav.gyro_bias[1] = X[11];
-    Nav.gyro_bias[2] = X[12];
+    Nav16.Pos[0] = X[0];
+    Nav16.Pos[1] = X[1];
+    Nav16.Pos[2] = X[2];
+    Nav16.Vel[0] = X[3];
+    Nav16.Vel[1] = X[4];
+    Nav16.Vel[2] = X[5];
+    Nav16.q[0]   = X[6];
+    Nav16.q[1]   = X[7];
+    Nav16.q[2]   = X[8];
+    Nav16.q[3]   = X[9];
+    Nav16.gyro_bias[0]  = X[10];
+    Nav16.gyro_bias[1]  = X[11];
+    Nav16.gyro_bias[2]  = X[12];
+    Nav16.accel_bias[0] = X[13];
+    Nav16.accel_bias[1] = X[14];
+    Nav16.accel_bias[2] = X[15];
 }
 
-void INSCovariancePrediction(float dT)
+void INS16CovariancePrediction(float dT)
 {
     CovariancePrediction(F, G, Q, dT, P);
 }
 
-float zeros[3] = { 0.0f, 0.0f, 0.0f };
-
-void MagCorrection(float mag_data[3])
-{
-    INSCorrection(mag_data, zeros, zeros, zeros[0], MAG_SENSORS);
-}
-
-void MagVelBaroCorrection(float mag_data[3], float Vel[3], float BaroAlt)
-{
-    INSCorrection(mag_data, zeros, Vel, BaroAlt,
-                  MAG_SENSORS | HORIZ_SENSORS | VERT_SENSORS |
-                  BARO_SENSOR);
-}
-
-void GpsBaroCorrection(float Pos[3], float Vel[3], float BaroAlt)
-{
-    INSCorrection(zeros, Pos, Vel, BaroAlt,
-                  HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR);
-}
-
-void FullCorrection(float mag_data[3], float Pos[3], float Vel[3],
-                    float BaroAlt)
-{
-    INSCorrection(mag_data, Pos, Vel, BaroAlt, FULL_SENSORS);
-}
-
-void GpsMagCorrection(float mag_data[3], float Pos[3], float Vel[3])
-{
-    INSCorrection(mag_data, Pos, Vel, zeros[0],
-                  POS_SENSORS | HORIZ_SENSORS | MAG_SENSORS);
-}
-
-void VelBaroCorrection(float Vel[3], float BaroAlt)
-{
-    INSCorrection(zeros, zeros, Vel, BaroAlt,
-                  HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR);
-}
-
-void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
-                   float BaroAlt, uint16_t SensorsUsed)
+void INS16Correction(float mag_data[3], float Pos[3], float Vel[3],
+                     float BaroAlt, uint16_t SensorsUsed)
 {
     float Z[10], Y[10];
-    float Bmag, qmag;
+    float invBmag, invqmag;
 
     // GPS Position in meters and in local NED frame
     Z[0] = Pos[0];
@@ -310,12 +312,13 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
     Z[5] = Vel[2];
 
     // magnetometer data in any units (use unit vector) and in body frame
-    Bmag =
-        sqrt(mag_data[0] * mag_data[0] + mag_data[1] * mag_data[1] +
-             mag_data[2] * mag_data[2]);
-    Z[6] = mag_data[0] / Bmag;
-    Z[7] = mag_data[1] / Bmag;
-    Z[8] = mag_data[2] / Bmag;
+    if (SensorsUsed & MAG_SENSORS) {
+        invBmag = 1.0f / sqrtf(mag_data[0] * mag_data[0] + mag_data[1] * mag_data[1] +
+                               mag_data[2] * mag_data[2]);
+        Z[6]    = mag_data[0] * invBmag;
+        Z[7]    = mag_data[1] * invBmag;
+        Z[8]    = mag_data[2] * invBmag;
+    }
 
     // barometric altimeter in meters and in local NED frame
     Z[9] = BaroAlt;
@@ -324,29 +327,29 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
     LinearizeH(X, Be, H);
     MeasurementEq(X, Be, Y);
     SerialUpdate(H, R, Z, Y, P, X, SensorsUsed);
-    qmag  = sqrt(X[6] * X[6] + X[7] * X[7] + X[8] * X[8] + X[9] * X[9]);
-    X[6] /= qmag;
-    X[7] /= qmag;
-    X[8] /= qmag;
-    X[9] /= qmag;
+    invqmag = 1.0f / sqrtf(X[6] * X[6] + X[7] * X[7] + X[8] * X[8] + X[9] * X[9]);
+    X[6]   *= invqmag;
+    X[7]   *= invqmag;
+    X[8]   *= invqmag;
+    X[9]   *= invqmag;
 
     // Update Nav solution structure
-    Nav.Pos[0] = X[0];
-    Nav.Pos[1] = X[1];
-    Nav.Pos[2] = X[2];
-    Nav.Vel[0] = X[3];
-    Nav.Vel[1] = X[4];
-    Nav.Vel[2] = X[5];
-    Nav.q[0]   = X[6];
-    Nav.q[1]   = X[7];
-    Nav.q[2]   = X[8];
-    Nav.q[3]   = X[9];
-    Nav.gyro_bias[0]  = X[10];
-    Nav.gyro_bias[1]  = X[11];
-    Nav.gyro_bias[2]  = X[12];
-    Nav.accel_bias[0] = X[13];
-    Nav.accel_bias[1] = X[14];
-    Nav.accel_bias[2] = X[15];
+    Nav16.Pos[0] = X[0];
+    Nav16.Pos[1] = X[1];
+    Nav16.Pos[2] = X[2];
+    Nav16.Vel[0] = X[3];
+    Nav16.Vel[1] = X[4];
+    Nav16.Vel[2] = X[5];
+    Nav16.q[0]   = X[6];
+    Nav16.q[1]   = X[7];
+    Nav16.q[2]   = X[8];
+    Nav16.q[3]   = X[9];
+    Nav16.gyro_bias[0]  = X[10];
+    Nav16.gyro_bias[1]  = X[11];
+    Nav16.gyro_bias[2]  = X[12];
+    Nav16.accel_bias[0] = X[13];
+    Nav16.accel_bias[1] = X[14];
+    Nav16.accel_bias[2] = X[15];
 }
 
 // *************  CovariancePrediction *************
@@ -362,8 +365,8 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
 
 #ifdef COVARIANCE_PREDICTION_GENERAL
 
-void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+static void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                 float Q[NUMW], float dT, float P[NUMX][NUMX])
 {
     float Dummy[NUMX][NUMX], dTsq;
     uint8_t i, j, k;
@@ -396,8 +399,8 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 
 #else /* ifdef COVARIANCE_PREDICTION_GENERAL */
 
-void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+static void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                                 float Q[NUMW], float dT, float P[NUMX][NUMX])
 {
     float D[NUMX][NUMX], T, Tsq;
     uint8_t i, j;
@@ -557,7 +560,7 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 // Does the update step of the Kalman filter for the covariance and estimate
 // Outputs are Xnew & Pnew, and are written over P and X
 // Z is actual measurement, Y is predicted measurement
-// Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P,
+// Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P*(I-K*H)' + K*R*K',
 // where K=P*H'*inv[H*P*H'+R]
 // NOTE the algorithm assumes R (measurement covariance matrix) is diagonal
 // i.e. the measurment noises are uncorrelated.
@@ -569,42 +572,72 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 // should be used in the update.
 // ************************************************
 
-void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
-                  uint16_t SensorsUsed)
+// One measurement of the serial update. H[m] is zero outside of the columns
+// start..end (see LinearizeH()), every caller passes them as constants so the
+// H*P and H*P*H' sums are unrolled over those columns only.
+// The covariance is updated in Joseph form, for a single measurement it is
+// P - K*HP - HP'*K' + K*K'*HPHR, which keeps P symmetric positive definite
+// in single precision where P - K*HP slowly loses it.
+static inline __attribute__((always_inline)) void SerialUpdateRow(float Hm[NUMX], float Rm, float Error,
+                                                                  float P[NUMX][NUMX], float X[NUMX],
+                                                                  int8_t start, int8_t end)
 {
-    float HP[NUMX], HPHR, Error;
-    uint8_t i, j, k, m;
-
-    for (m = 0; m < NUMV; m++) {
-        if (SensorsUsed & (0x01 << m)) { // use this sensor for update
-            for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                HP[j] = 0.0f;
-                for (k = 0; k < NUMX; k++) {
-                    HP[j] += H[m][k] * P[k][j];
-                }
-            }
-            HPHR = R[m]; // Find  HPHR = H*P*H' + R
-            for (k = 0; k < NUMX; k++) {
-                HPHR += HP[k] * H[m][k];
-            }
+    float HP[NUMX], Km[NUMX], HPHR;
+    int8_t i, j, k;
 
-            for (k = 0; k < NUMX; k++) {
-                K[k][m] = HP[k] / HPHR; // find K = HP/HPHR
-            }
-            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
-                for (j = i; j < NUMX; j++) {
-                    P[i][j] = P[j][i] =
-                                  P[i][j] - K[i][m] * HP[j];
-                }
-            }
+    for (j = 0; j < NUMX; j++) { // Find Hp = H*P
+        HP[j] = 0.0f;
+        for (k = start; k <= end; k++) {
+            HP[j] += Hm[k] * P[k][j];
+        }
+    }
+    HPHR = Rm; // Find  HPHR = H*P*H' + R
+    for (k = start; k <= end; k++) {
+        HPHR += HP[k] * Hm[k];
+    }
+
+    float HPHR1 = 1.0f / HPHR;
+    for (k = 0; k < NUMX; k++) {
+        Km[k] = HP[k] * HPHR1; // find K = HP/HPHR
+    }
+    for (i = 0; i < NUMX; i++) { // Find P(m)= (I-K*H)*P(m-1)*(I-K*H)' + K*R*K'
+        float Kih = Km[i] * HPHR - HP[i];
+        for (j = i; j < NUMX; j++) {
+            P[i][j] = P[j][i] = P[i][j] - Km[i] * HP[j] + Kih * Km[j];
+        }
+    }
 
-            Error = Z[m] - Y[m];
-            for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
-                X[i] = X[i] + K[i][m] * Error;
+    for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
+        X[i] = X[i] + Km[i] * Error;
+    }
+}
+
+static void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                         float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                         uint16_t SensorsUsed)
+{
+    uint8_t m;
+
+    // position and velocity, each measures a single state
+    if (SensorsUsed & (POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS)) {
+        for (m = 0; m < 6; m++) {
+            if (SensorsUsed & (0x01 << m)) {
+                SerialUpdateRow(H[m], R[m], Z[m] - Y[m], P, X, m, m);
             }
         }
     }
+    // magnetometer, depends on the quaternion only
+    if (SensorsUsed & MAG_SENSORS) {
+        for (m = 6; m < 9; m++) {
+            if (SensorsUsed & (0x01 << m)) {
+                SerialUpdateRow(H[m], R[m], Z[m] - Y[m], P, X, 6, 9);
+            }
+        }
+    }
+    // altimeter, measures the down position
+    if (SensorsUsed & BARO_SENSOR) {
+        SerialUpdateRow(H[9], R[9], Z[9] - Y[9], P, X, 2, 2);
+    }
 }
 
 // *************  RungeKutta **********************
@@ -614,7 +647,7 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
 // constant inputs over integration step
 // ************************************************
 
-void RungeKutta(float X[NUMX], float U[NUMU], float dT)
+static void RungeKutta(float X[NUMX], float U[NUMU], float dT)
 {
     float dT2 =
         dT / 2.0f, K1[NUMX], K2[NUMX], K3[NUMX], K4[NUMX], Xlast[NUMX];
@@ -664,7 +697,7 @@ void RungeKutta(float X[NUMX], float U[NUMU], float dT)
 // H is output of LinearizeH(), all elements not set should be zero
 // ************************************************
 
-void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX])
+static void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX])
 {
     float ax, ay, az, wx, wy, wz, q0, q1, q2, q3;
 
@@ -709,8 +742,8 @@ void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX])
     Xdot[13] = Xdot[14] = Xdot[15] = 0;
 }
 
-void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
-                 float G[NUMX][NUMW])
+static void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
+                        float G[NUMX][NUMW])
 {
     float ax, ay, az, wx, wy, wz, q0, q1, q2, q3;
 
@@ -805,7 +838,7 @@ void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
     G[13][9] = G[14][10] = G[15][11] = 1.0f;
 }
 
-void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV])
+static void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV])
 {
     float q0, q1, q2, q3;
 
@@ -840,7 +873,7 @@ void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV])
     Y[9] = X[2] * -1.0f;
 }
 
-void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX])
+static void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX])
 {
     float q0, q1, q2, q3;
 
@@ -28,6 +28,10 @@
 #include <instrumentation.h>
 #include <pios_instrumentation.h>
 
+#if PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS != PERFCOUNTER_HISTOGRAM_NUMELEM
+#error PerfCounter Histogram does not match the instrumentation histogram buckets
+#endif
+
 static uint8_t publishedCountersInstances = 0;
 static void counterCallback(const pios_perf_counter_t *counter, const int8_t index, void *context);
 static xSemaphoreHandle sem;
@@ -58,5 +62,7 @@ void counterCallback(const pios_perf_counter_t *counter, const int8_t index, __a
     data.Counter.Max   = counter->max;
     data.Counter.Min   = counter->min;
     data.Counter.Value = counter->value;
+    // log2 buckets of the samples, @see PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS
+    memcpy(data.Histogram, counter->histogram, sizeof(data.Histogram));
     PerfCounterInstSet(index, &data);
 }
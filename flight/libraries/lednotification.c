@@ -49,10 +49,12 @@ typedef struct {
     LedSequence_t queued_sequences[MAX_BACKGROUND_NOTIFICATIONS]; // slot 0 is reserved for background
     uint32_t next_run_time;
     uint32_t sequence_starting_time;
+    Color_t  shown_color; // color last sent to the led set
 
     int8_t   active_sequence_num; // active queued sequence or BACKGROUND_SEQUENCE
     bool     running; // is this led running?
     bool     step_phase_on; // true = step on phase, false = step off phase
+    bool     shown_valid; // shown_color holds what the leds display
     uint8_t  next_sequence_step; // (step number to be executed) << 1 || (0x00 = on phase, 0x01 = off phase)
     uint8_t  next_step_rep; // next repetition number for next step (valid if step.repeats >1)
     uint8_t  next_sequence_rep; // next sequence repetition counter (valid if sequence.repeats > 1)
@@ -232,10 +234,17 @@ static void run_led(NotifierLedStatus_t *status)
     LedSequence_t *activeSequence = &status->queued_sequences[status->active_sequence_num];
     const Color_t color = status->step_phase_on ? activeSequence->steps[step].color : Color_Off;
 
-    for (uint8_t i = status->led_set_start; i <= status->led_set_end; i++) {
-        PIOS_WS2811_setColorRGB(color, i, false);
+    // blinking sequences mostly repeat the same color, a refresh is only
+    // needed when the leds are to show something different
+    if (!status->shown_valid || color.R != status->shown_color.R ||
+        color.G != status->shown_color.G || color.B != status->shown_color.B) {
+        for (uint8_t i = status->led_set_start; i <= status->led_set_end; i++) {
+            PIOS_WS2811_setColorRGB(color, i, false);
+        }
+        PIOS_WS2811_Update();
+        status->shown_color = color;
+        status->shown_valid = true;
     }
-    PIOS_WS2811_Update();
     advance_sequence(status);
 }
 
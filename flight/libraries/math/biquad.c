@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Cascaded second order filters applied to three axes at once
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include <math.h>
+#include <string.h>
+#include <pios_math.h>
+#include "biquad.h"
+
+/**
+ * Second order Butterworth low pass, from the bilinear transform
+ * @param[out] c coefficients
+ * @param[in] ff cut-off frequency ratio, cut-off over sample rate, below 0.5
+ */
+void biquad_lowpass(struct biquad_coeffs *c, float ff)
+{
+    const float K    = tanf(M_PI_F * ff);
+    const float norm = 1.0f / (1.0f + M_SQRT2_F * K + K * K);
+
+    c->b0 = K * K * norm;
+    c->b1 = 2.0f * c->b0;
+    c->b2 = c->b0;
+    c->a1 = 2.0f * (K * K - 1.0f) * norm;
+    c->a2 = (1.0f - M_SQRT2_F * K + K * K) * norm;
+}
+
+/**
+ * Second order notch, unity gain away from the notch
+ * @param[out] c coefficients
+ * @param[in] ff centre frequency ratio, centre over sample rate, below 0.5
+ * @param[in] bw bandwidth ratio, -3dB bandwidth over sample rate
+ */
+void biquad_notch(struct biquad_coeffs *c, float ff, float bw)
+{
+    const float K    = tanf(M_PI_F * ff);
+    const float KQ   = K * bw / ff;
+    const float norm = 1.0f / (1.0f + KQ + K * K);
+
+    c->b0 = (1.0f + K * K) * norm;
+    c->b1 = 2.0f * (K * K - 1.0f) * norm;
+    c->b2 = c->b0;
+    c->a1 = c->b1;
+    c->a2 = (1.0f - KQ + K * K) * norm;
+}
+
+/**
+ * Remove all stages, the bank then passes samples through unchanged
+ */
+void biquad_bank_clear(struct biquad_bank *bank)
+{
+    memset(bank, 0, sizeof(*bank));
+}
+
+/**
+ * Append a stage to the cascade, its state starts at zero
+ * @returns false if the bank is full
+ */
+bool biquad_bank_add(struct biquad_bank *bank, const struct biquad_coeffs *c)
+{
+    if (bank->stages >= BIQUAD_MAX_STAGES) {
+        return false;
+    }
+    uint8_t s = bank->stages++;
+    bank->c[s] = *c;
+    for (uint8_t i = 0; i < BIQUAD_CHANNELS; i++) {
+        bank->z1[s][i] = 0.0f;
+        bank->z2[s][i] = 0.0f;
+    }
+    return true;
+}
+
+/**
+ * Set the state of all stages as if x had been applied for a long time,
+ * so the output starts at the DC response instead of ramping up from zero
+ */
+void biquad_bank_reset(struct biquad_bank *bank, const float x[BIQUAD_CHANNELS])
+{
+    float in[BIQUAD_CHANNELS];
+
+    memcpy(in, x, sizeof(in));
+    for (uint8_t s = 0; s < bank->stages; s++) {
+        const struct biquad_coeffs *c = &bank->c[s];
+        const float gain = (c->b0 + c->b1 + c->b2) / (1.0f + c->a1 + c->a2);
+        for (uint8_t i = 0; i < BIQUAD_CHANNELS; i++) {
+            const float y = gain * in[i];
+            bank->z1[s][i] = y - c->b0 * in[i];
+            bank->z2[s][i] = c->b2 * in[i] - c->a2 * y;
+            in[i] = y;
+        }
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Biquad filter bank
+ * @{
+ *
+ * @file       biquad.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Cascaded second order filters applied to three axes at once
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BIQUAD_CHANNELS   3
+#define BIQUAD_MAX_STAGES 2
+
+// Coefficients of H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2).
+// Note the sign of a1 and a2 is the opposite of struct ButterWorthDF2Filter.
+struct biquad_coeffs {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+};
+
+// A cascade of biquads run over the x, y and z axis of a sensor. The state
+// is kept per stage as struct of arrays so each stage filters the three axes
+// with its coefficients loaded once.
+struct biquad_bank {
+    uint8_t stages;
+    struct biquad_coeffs c[BIQUAD_MAX_STAGES];
+    float   z1[BIQUAD_MAX_STAGES][BIQUAD_CHANNELS];
+    float   z2[BIQUAD_MAX_STAGES][BIQUAD_CHANNELS];
+};
+
+void biquad_lowpass(struct biquad_coeffs *c, float ff);
+void biquad_notch(struct biquad_coeffs *c, float ff, float bw);
+
+void biquad_bank_clear(struct biquad_bank *bank);
+bool biquad_bank_add(struct biquad_bank *bank, const struct biquad_coeffs *c);
+void biquad_bank_reset(struct biquad_bank *bank, const float x[BIQUAD_CHANNELS]);
+
+/**
+ * Filter one sample of each axis in place, through all stages of the bank
+ * @param[in,out] bank filter bank
+ * @param[in,out] x sample, replaced by the filtered value
+ */
+static inline void biquad_bank_apply(struct biquad_bank *bank, float x[BIQUAD_CHANNELS])
+{
+    for (uint8_t s = 0; s < bank->stages; s++) {
+        const float b0 = bank->c[s].b0, b1 = bank->c[s].b1, b2 = bank->c[s].b2;
+        const float a1 = bank->c[s].a1, a2 = bank->c[s].a2;
+        float *z1 = bank->z1[s];
+        float *z2 = bank->z2[s];
+
+        // transposed direct form two
+        for (uint8_t i = 0; i < BIQUAD_CHANNELS; i++) {
+            const float in = x[i];
+            const float y  = b0 * in + z1[i];
+            z1[i] = b1 * in - a1 * y + z2[i];
+            z2[i] = b2 * in - a2 * y;
+            x[i]  = y;
+        }
+    }
+}
+
+#endif /* BIQUAD_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Complementary filter kernel
+ * @{
+ *
+ * @file       complementaryfilter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      One attitude update of the accel/mag complementary filter,
+ *             with the settings dependent gains computed ahead of time
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef COMPLEMENTARYFILTER_H
+#define COMPLEMENTARYFILTER_H
+
+#include <stdbool.h>
+#include <pios_math.h>
+#include <fastmath.h>
+
+#define CF_RESULT_OK                    0
+// accel or filtered gravity vector too short to give a direction
+#define CF_RESULT_VECTOR_TOO_SHORT      -1
+// quaternion collapsed or became nan, the filter must be reinitialized
+#define CF_RESULT_QUATERNION_DEGENERATE -2
+
+// Gains, updated only when the settings or the calibration phase change
+struct cf_gains {
+    float accelKp;
+    float accelKi;
+    float magKp;
+    float magKi;
+    float rollPitchBiasRate;
+    // accel low pass, filtered = filtered * accelAlpha + raw * accelBeta
+    float accelAlpha;
+    float accelBeta;
+    bool  accelFilter;
+};
+
+struct cf_state {
+    float q[4];
+    float gyroBias[3];
+    float accelsFiltered[3];
+    float grotFiltered[3];
+};
+
+static inline void cf_lowpass(const struct cf_gains *g, const float raw[3], float filtered[3])
+{
+    if (g->accelFilter) {
+        filtered[0] = filtered[0] * g->accelAlpha + raw[0] * g->accelBeta;
+        filtered[1] = filtered[1] * g->accelAlpha + raw[1] * g->accelBeta;
+        filtered[2] = filtered[2] * g->accelAlpha + raw[2] * g->accelBeta;
+    } else {
+        filtered[0] = raw[0];
+        filtered[1] = raw[1];
+        filtered[2] = raw[2];
+    }
+}
+
+/**
+ * Propagate the attitude by one gyro sample and correct it towards the accel
+ * and mag measurements
+ * @param[in,out] s filter state
+ * @param[in] g gains
+ * @param[in,out] gyro rates in deg/s, returned with the bias removed
+ * @param[in] accel accelerations
+ * @param[in] mag magnetometer measurement, NULL when there is no new one
+ * @param[in] Be unit length earth magnetic field, NULL when unknown
+ * @param[in] dT time since the previous update in s
+ * @returns CF_RESULT_OK or one of the CF_RESULT_ errors
+ */
+static inline int8_t cf_update(struct cf_state *s, const struct cf_gains *g, float gyro[3],
+                               const float accel[3], const float mag[3], const float Be[3], float dT)
+{
+    const float q0 = s->q[0], q1 = s->q[1], q2 = s->q[2], q3 = s->q[3];
+
+    cf_lowpass(g, accel, s->accelsFiltered);
+
+    // Rotate gravity to body frame and cross with accels
+    float grot[3];
+    grot[0] = -(2.0f * (q1 * q3 - q0 * q2));
+    grot[1] = -(2.0f * (q2 * q3 + q0 * q1));
+    grot[2] = -(q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3);
+    cf_lowpass(g, grot, s->grotFiltered);
+
+    const float *af = s->accelsFiltered;
+    const float *gf = s->grotFiltered;
+    float accel_mag2 = af[0] * af[0] + af[1] * af[1] + af[2] * af[2];
+    float grot_mag2  = g->accelFilter ? gf[0] * gf[0] + gf[1] * gf[1] + gf[2] * gf[2] : 1.0f;
+    if (accel_mag2 < 1.0e-6f || grot_mag2 < 1.0e-6f) {
+        return CF_RESULT_VECTOR_TOO_SHORT;
+    }
+    // one inverse square root normalizes the cross product for both lengths
+    float err_scale = fast_invsqrtf_accurate(accel_mag2 * grot_mag2);
+    float accel_err[3];
+    accel_err[0] = (af[1] * gf[2] - af[2] * gf[1]) * err_scale;
+    accel_err[1] = (af[2] * gf[0] - af[0] * gf[2]) * err_scale;
+    accel_err[2] = (af[0] * gf[1] - af[1] * gf[0]) * err_scale;
+
+    // Only the yaw component of the mag error is used, it needs the first two
+    // rows of Rbe applied to Be
+    float mag_err2 = 0.0f;
+    if (mag && Be) {
+        float mag_len2 = mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2];
+        if (mag_len2 >= 1.0f) {
+            float brot0 = (q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3) * Be[0] + 2.0f * (q1 * q2 + q0 * q3) * Be[1] + 2.0f * (q1 * q3 - q0 * q2) * Be[2];
+            float brot1 = 2.0f * (q1 * q2 - q0 * q3) * Be[0] + (q0 * q0 - q1 * q1 + q2 * q2 - q3 * q3) * Be[1] + 2.0f * (q2 * q3 + q0 * q1) * Be[2];
+            mag_err2 = (mag[0] * brot1 - mag[1] * brot0) * fast_invsqrtf_accurate(mag_len2);
+        }
+    }
+
+    // Correct rates based on integral coefficient
+    gyro[0] -= s->gyroBias[0];
+    gyro[1] -= s->gyroBias[1];
+    gyro[2] -= s->gyroBias[2];
+
+    // Accumulate integral of error.  Scale here so that units are (deg/s) but Ki has units of s
+    s->gyroBias[0] -= accel_err[0] * g->accelKi - gyro[0] * g->rollPitchBiasRate;
+    s->gyroBias[1] -= accel_err[1] * g->accelKi - gyro[1] * g->rollPitchBiasRate;
+    s->gyroBias[2] -= -mag_err2 * g->magKi - gyro[2] * g->rollPitchBiasRate;
+
+    // Correct rates based on proportional coefficient
+    float invdT   = 1.0f / dT;
+    float accelKp = g->accelKp * invdT;
+    float rate0   = gyro[0] + accel_err[0] * accelKp;
+    float rate1   = gyro[1] + accel_err[1] * accelKp;
+    float rate2   = gyro[2] + accel_err[2] * accelKp + mag_err2 * g->magKp * invdT;
+
+    // Take a time step, gyros are in deg/s
+    const float h = DEG2RAD(0.5f) * dT;
+    float qn[4];
+    qn[0] = q0 + (-q1 * rate0 - q2 * rate1 - q3 * rate2) * h;
+    qn[1] = q1 + (q0 * rate0 - q3 * rate1 + q2 * rate2) * h;
+    qn[2] = q2 + (q3 * rate0 + q0 * rate1 - q1 * rate2) * h;
+    qn[3] = q3 + (-q2 * rate0 + q1 * rate1 + q0 * rate2) * h;
+
+    // Renormalize, keeping q0 positive
+    float qmag2    = qn[0] * qn[0] + qn[1] * qn[1] + qn[2] * qn[2] + qn[3] * qn[3];
+    float inv_qmag = fast_invsqrtf_accurate(qmag2);
+    float qmag     = qmag2 * inv_qmag;
+    if (qn[0] < 0.0f) {
+        inv_qmag = -inv_qmag;
+    }
+    s->q[0] = qn[0] * inv_qmag;
+    s->q[1] = qn[1] * inv_qmag;
+    s->q[2] = qn[2] * inv_qmag;
+    s->q[3] = qn[3] * inv_qmag;
+
+    // If quaternion has become inappropriately short or is nan reinit.
+    // THIS SHOULD NEVER ACTUALLY HAPPEN
+    if ((fabsf(qmag) < 1.0e-3f) || isnan(qmag)) {
+        return CF_RESULT_QUATERNION_DEGENERATE;
+    }
+    return CF_RESULT_OK;
+}
+
+#endif /* COMPLEMENTARYFILTER_H */
+
+/**
+ * @}
+ * @}
+ */
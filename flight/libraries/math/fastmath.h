@@ -0,0 +1,198 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fast math functions
+ * @{
+ *
+ * @file       fastmath.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Polynomial approximations of the trigonometric functions for the FPU
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * The functions below only use single precision multiply-adds, so they run
+ * on the Cortex-M4 FPU without the argument handling and double precision
+ * fallbacks of newlib. The errors are bounds over the stated ranges:
+ * - fast_sincosf() / fast_sinf() / fast_cosf(): 1e-7 absolute for |x| < 2000 rad,
+ *   beyond that the range reduction loses accuracy
+ * - fast_atan2f() / fast_asinf(): 3e-7 rad, about one float ulp of pi
+ * - fast_invsqrtf_accurate(): 5e-6 relative
+ */
+
+// pi/2 split in three floats for the Cody-Waite range reduction, the products
+// with the quadrant number are exact for the first two parts
+#define FASTMATH_PIO2_1 1.5703125f
+#define FASTMATH_PIO2_2 4.837512969970703125e-4f
+#define FASTMATH_PIO2_3 7.54978995489188216e-8f
+#define FASTMATH_2OPI   0.636619772367581343f
+
+/**
+ * Sine and cosine of the same angle
+ * @param[in] x angle in radians
+ * @param[out] s sin(x)
+ * @param[out] c cos(x)
+ */
+static inline void fast_sincosf(float x, float *s, float *c)
+{
+    // reduce to r in [-pi/4, pi/4] and the quadrant j
+    int32_t j = (int32_t)(x * FASTMATH_2OPI + (x >= 0.0f ? 0.5f : -0.5f));
+    float r   = ((x - (float)j * FASTMATH_PIO2_1) - (float)j * FASTMATH_PIO2_2) - (float)j * FASTMATH_PIO2_3;
+    float r2  = r * r;
+
+    // minimax polynomials from the Cephes library
+    float sr  = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    float cr  = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+    switch (j & 3) {
+    case 0:
+        *s = sr;
+        *c = cr;
+        break;
+    case 1:
+        *s = cr;
+        *c = -sr;
+        break;
+    case 2:
+        *s = -sr;
+        *c = -cr;
+        break;
+    default:
+        *s = -cr;
+        *c = sr;
+        break;
+    }
+}
+
+static inline float fast_sinf(float x)
+{
+    float s, c;
+
+    fast_sincosf(x, &s, &c);
+    return s;
+}
+
+static inline float fast_cosf(float x)
+{
+    float s, c;
+
+    fast_sincosf(x, &s, &c);
+    return c;
+}
+
+/**
+ * Four quadrant arc tangent
+ * @param[in] y
+ * @param[in] x
+ * @returns atan(y/x) in radians, in [-pi, pi]
+ */
+static inline float fast_atan2f(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float mx = ax > ay ? ax : ay;
+
+    if (mx == 0.0f) {
+        return 0.0f;
+    }
+    // z in [0, 1], polynomial from Abramowitz & Stegun 4.4.49
+    float z  = (ax > ay ? ay : ax) / mx;
+    float z2 = z * z;
+    float a  = z * (1.0f + z2 * (-0.3333314528f + z2 * (0.1999355085f + z2 * (-0.1420889944f + z2 * (0.1065626393f
+                                                                                            + z2 * (-0.0752896400f + z2 * (0.0429096138f + z2 * (-0.0161657367f + z2 * 0.0028662257f))))))));
+
+    if (ay > ax) {
+        a = 1.57079632679489662f - a;
+    }
+    if (x < 0.0f) {
+        a = 3.14159265358979324f - a;
+    }
+    return y < 0.0f ? -a : a;
+}
+
+/**
+ * Arc sine, the argument is clamped to [-1, 1]
+ * @param[in] x
+ * @returns asin(x) in radians, in [-pi/2, pi/2]
+ */
+static inline float fast_asinf(float x)
+{
+    if (x > 1.0f) {
+        x = 1.0f;
+    } else if (x < -1.0f) {
+        x = -1.0f;
+    }
+    return fast_atan2f(x, sqrtf((1.0f - x) * (1.0f + x)));
+}
+
+/**
+ * Inverse square root with two Newton iterations, relative error below 5e-6,
+ * accurate enough to keep a quaternion normalized.
+ * @see fast_invsqrtf() in mathmisc.h for the single iteration version
+ */
+static inline float fast_invsqrtf_accurate(float number)
+{
+    union {
+        float    f;
+        uint32_t u;
+    } i;
+    float x2 = number * 0.5f;
+
+    i.f = number;
+    i.u = 0x5f3759df - (i.u >> 1);
+    float y = i.f;
+    y = y * (1.5f - (x2 * y * y));
+    y = y * (1.5f - (x2 * y * y));
+
+    return y;
+}
+
+/**
+ * Normalize a quaternion in place
+ * @param[in,out] q the quaternion, left untouched when its norm is zero
+ */
+static inline void fast_quat_normalizef(float q[4])
+{
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float n2 = q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3;
+
+    if (!(n2 > 0.0f)) {
+        return;
+    }
+    float inv = fast_invsqrtf_accurate(n2);
+    q[0] = q0 * inv;
+    q[1] = q1 * inv;
+    q[2] = q2 * inv;
+    q[3] = q3 * inv;
+}
+
+#endif /* FASTMATH_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fast Fourier transform
+ * @{
+ *
+ * @file       fft.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      In place radix-2 FFT, sized for spectra computed on board
+ *             outside of the control loop
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <math.h>
+#include <pios_math.h>
+#include "fft.h"
+
+void fft_complex(float *re, float *im, uint16_t n)
+{
+    uint16_t i, j, k, len;
+
+    // bit reversed reordering
+    for (i = 1, j = 0; i < n; i++) {
+        uint16_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float t_re = re[i];
+            float t_im = im[i];
+            re[i] = re[j];
+            im[i] = im[j];
+            re[j] = t_re;
+            im[j] = t_im;
+        }
+    }
+
+    // butterflies, the twiddle factors of a stage are generated by rotation
+    // so that there is only one sinf/cosf pair per stage
+    for (len = 2; len <= n; len <<= 1) {
+        uint16_t half  = len >> 1;
+        float angle    = -2.0f * M_PI_F / len;
+        float wstep_re = cosf(angle);
+        float wstep_im = sinf(angle);
+        float w_re     = 1.0f;
+        float w_im     = 0.0f;
+        for (k = 0; k < half; k++) {
+            for (i = k; i < n; i += len) {
+                j = i + half;
+
+                float t_re = re[j] * w_re - im[j] * w_im;
+                float t_im = re[j] * w_im + im[j] * w_re;
+                re[j] = re[i] - t_re;
+                im[j] = im[i] - t_im;
+                re[i] = re[i] + t_re;
+                im[i] = im[i] + t_im;
+            }
+            float w = w_re * wstep_re - w_im * wstep_im;
+            w_im    = w_re * wstep_im + w_im * wstep_re;
+            w_re    = w;
+        }
+    }
+}
+
+void fft_split_real_pair(const float *re, const float *im, uint16_t n, uint16_t k, float X[2], float Y[2])
+{
+    // bin 0 is its own mirror
+    uint16_t m = (n - k) & (n - 1);
+
+    X[0] = 0.5f * (re[k] + re[m]);
+    X[1] = 0.5f * (im[k] - im[m]);
+    Y[0] = 0.5f * (im[k] + im[m]);
+    Y[1] = -0.5f * (re[k] - re[m]);
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Fast Fourier transform
+ * @{
+ *
+ * @file       fft.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      In place radix-2 FFT, sized for spectra computed on board
+ *             outside of the control loop
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+
+/**
+ * In place complex FFT of n samples, n a power of two
+ * @param[in,out] re real parts, replaced by the real part of the spectrum
+ * @param[in,out] im imaginary parts, replaced by the imaginary part of the spectrum
+ * @param[in] n number of samples
+ */
+void fft_complex(float *re, float *im, uint16_t n);
+
+/**
+ * Bin k of the spectra of two real signals transformed together, x in re
+ * and y in im before fft_complex(), using X = (Z[k] + Z*[n-k]) / 2 and
+ * Y = (Z[k] - Z*[n-k]) / 2j
+ * @param[in] re real part of the spectrum
+ * @param[in] im imaginary part of the spectrum
+ * @param[in] n number of samples
+ * @param[in] k bin, 0 <= k < n
+ * @param[out] X bin k of the spectrum of x, real and imaginary part
+ * @param[out] Y bin k of the spectrum of y, real and imaginary part
+ */
+void fft_split_real_pair(const float *re, const float *im, uint16_t n, uint16_t k, float X[2], float Y[2]);
+
+#endif /* FFT_H */
+
+/**
+ * @}
+ * @}
+ */
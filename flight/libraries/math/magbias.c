@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Magnetometer bias estimator
+ * @{
+ *
+ * @file       magbias.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Online hard iron estimation, a recursive least squares fit of
+ *             the magnetometer samples to a sphere
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <math.h>
+#include <string.h>
+#include "magbias.h"
+
+// minimal distance between two samples used, relative to the field strength
+#define MIN_SPACING      0.1f
+// fastest forgetting, beyond it the covariance never gets below P_CONVERGED
+#define MAX_RATE         0.002f
+// initial covariance, and the bound keeping it from growing without new directions
+#define P_INITIAL        100.0f
+#define P_MAX_TRACE      400.0f
+// the bias is published once its covariance is below P_CONVERGED and it moved
+// less than STABLE_STEP (relative to the field) over STABLE_SAMPLES samples
+#define P_CONVERGED      0.05f
+#define STABLE_STEP      0.01f
+#define STABLE_SAMPLES   30
+// accepted radius of the fitted sphere, relative to the field strength
+#define MIN_RADIUS2      0.25f
+#define MAX_RADIUS2      2.25f
+
+/**
+ * Start a new fit, the published bias is cleared too
+ * @param[out] fit estimator state
+ * @param[in] fieldStrength expected length of the field, in sensor units
+ * @param[in] rate how fast the past samples are forgotten, 0 keeps them all
+ */
+void magbias_init(struct magbias_fit *fit, float fieldStrength, float rate)
+{
+    memset(fit, 0, sizeof(*fit));
+    for (int i = 0; i < 4; i++) {
+        fit->P[i][i] = P_INITIAL;
+    }
+    // r^2 - |b|^2 of a centered unit sphere
+    fit->theta[3]   = 1.0f;
+    fit->forgetting = 1.0f - ((rate < MAX_RATE) ? rate : MAX_RATE);
+    fit->invField   = 1.0f / fieldStrength;
+}
+
+/**
+ * Update the fit with a magnetometer sample, uncorrected by the published bias
+ * @param[in,out] fit estimator state
+ * @param[in] mag sample in sensor units
+ * @return true when a new bias was published in stableBias
+ */
+bool magbias_update(struct magbias_fit *fit, const float mag[3])
+{
+    const float phi[4] = { mag[0] * fit->invField, mag[1] * fit->invField, mag[2] * fit->invField, 1.0f };
+    const float d[3]   = { phi[0] - fit->last[0], phi[1] - fit->last[1], phi[2] - fit->last[2] };
+
+    // decimation, most samples stop here
+    if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] < MIN_SPACING * MIN_SPACING) {
+        return false;
+    }
+    if (!isfinite(phi[0]) || !isfinite(phi[1]) || !isfinite(phi[2])) {
+        return false;
+    }
+    fit->last[0] = phi[0];
+    fit->last[1] = phi[1];
+    fit->last[2] = phi[2];
+
+    // K = P phi / (lambda + phi' P phi), theta += K e, P = (P - K phi' P) / lambda
+    float Pphi[4];
+    float denom = fit->forgetting;
+    for (int i = 0; i < 4; i++) {
+        Pphi[i] = fit->P[i][0] * phi[0] + fit->P[i][1] * phi[1] + fit->P[i][2] * phi[2] + fit->P[i][3];
+        denom  += phi[i] * Pphi[i];
+    }
+    const float y   = phi[0] * phi[0] + phi[1] * phi[1] + phi[2] * phi[2];
+    const float err = y - (fit->theta[0] * phi[0] + fit->theta[1] * phi[1] + fit->theta[2] * phi[2] + fit->theta[3]);
+    const float invDenom = 1.0f / denom;
+
+    float trace = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        fit->theta[i] += Pphi[i] * invDenom * err;
+        for (int j = i; j < 4; j++) {
+            fit->P[i][j] -= Pphi[i] * Pphi[j] * invDenom;
+        }
+        trace += fit->P[i][i];
+    }
+    // P is symmetric, the lower half is mirrored; forgetting only while it stays bounded
+    const float scale = (trace < P_MAX_TRACE) ? 1.0f / fit->forgetting : 1.0f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = i; j < 4; j++) {
+            fit->P[i][j] *= scale;
+            fit->P[j][i]  = fit->P[i][j];
+        }
+    }
+
+    const float b[3] = { 0.5f * fit->theta[0], 0.5f * fit->theta[1], 0.5f * fit->theta[2] };
+    const float r2   = fit->theta[3] + b[0] * b[0] + b[1] * b[1] + b[2] * b[2];
+    const float field = 1.0f / fit->invField;
+    const float step[3] = { b[0] * field - fit->bias[0], b[1] * field - fit->bias[1], b[2] * field - fit->bias[2] };
+    fit->bias[0] = b[0] * field;
+    fit->bias[1] = b[1] * field;
+    fit->bias[2] = b[2] * field;
+
+    const float maxStep = STABLE_STEP * field;
+    if (r2 < MIN_RADIUS2 || r2 > MAX_RADIUS2 ||
+        fit->P[0][0] + fit->P[1][1] + fit->P[2][2] > P_CONVERGED ||
+        step[0] * step[0] + step[1] * step[1] + step[2] * step[2] > maxStep * maxStep) {
+        fit->stableCount = 0;
+        return false;
+    }
+    if (++fit->stableCount < STABLE_SAMPLES) {
+        return false;
+    }
+    fit->stableCount   = 0;
+    fit->stableBias[0] = fit->bias[0];
+    fit->stableBias[1] = fit->bias[1];
+    fit->stableBias[2] = fit->bias[2];
+    fit->published     = true;
+    return true;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Magnetometer bias estimator
+ * @{
+ *
+ * @file       magbias.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Online hard iron estimation, a recursive least squares fit of
+ *             the magnetometer samples to a sphere
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MAGBIAS_H
+#define MAGBIAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The samples m, in units of the expected field strength, lie on the sphere
+// |m - b|^2 = r^2. Written as |m|^2 = 2 b.m + (r^2 - |b|^2) that is linear in
+// theta = { 2 bx, 2 by, 2 bz, r^2 - |b|^2 }, which is fitted by recursive least
+// squares. Only samples far enough from the previous one are used, so holding
+// still neither costs time nor skews the fit towards one direction.
+struct magbias_fit {
+    float   theta[4];
+    float   P[4][4];
+    float   forgetting;
+    float   invField;
+    // last sample used, normalized
+    float   last[3];
+    // current estimate, and the one published, in sensor units
+    float   bias[3];
+    float   stableBias[3];
+    uint16_t stableCount;
+    bool    published;
+};
+
+void magbias_init(struct magbias_fit *fit, float fieldStrength, float rate);
+bool magbias_update(struct magbias_fit *fit, const float mag[3]);
+
+#endif /* MAGBIAS_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -61,6 +61,10 @@ uint8_t Data1;
 uint8_t Data2;
 uint8_t Data3;
 uint32_t Opt[3];
+// firmware CRC accumulated in the CRC unit while the image is programmed,
+// valid as long as nothing else resets the unit in between
+bool fwCrcRunning = false;
+uint32_t fwCrcWords = 0;
 
 // Download vars
 uint32_t downSizeOfLastPacket = 0;
@@ -79,6 +83,7 @@ bool flash_read(uint8_t *buffer, uint32_t adr, DFUProgType type);
 /* Private functions ---------------------------------------------------------*/
 void sendData(uint8_t *buf, uint16_t size);
 uint32_t CalcFirmCRC(void);
+uint32_t FinishFirmCRC(void);
 
 void DataDownload(__attribute__((unused)) DownloadAction action)
 {
@@ -204,6 +209,10 @@ void processComand(uint8_t *xReceive_Buffer)
                         switch (currentProgrammingDestination) {
                         case Self_flash:
                             result = PIOS_BL_HELPER_FLASH_Start();
+                            PIOS_BL_HELPER_CRC_Ini();
+                            CRC_ResetDR();
+                            fwCrcRunning = (result == 1);
+                            fwCrcWords   = 0;
                             break;
                         case Remote_flash_via_spi:
                             result = false;
@@ -230,22 +239,28 @@ void processComand(uint8_t *xReceive_Buffer)
                     }
                     uint8_t result = 0;
                     uint32_t offset;
-                    uint32_t aux;;
+                    uint32_t aux;
+                    const uint32_t packetBase = baseOfAdressType(TransferType) + Count * 14 * 4;
                     switch (currentProgrammingDestination) {
                     case Self_flash:
-                        for (uint8_t x = 0; x < numberOfWords; ++x) {
+                        result = 1;
+                        for (uint8_t x = 0; x < numberOfWords && result == 1; ++x) {
                             offset = 4 * x;
                             Data   = unpack_uint32(&xReceive_Buffer[DATA + offset]);
-                            aux    = baseOfAdressType(TransferType) + (uint32_t)(
-                                Count * 14 * 4 + x * 4);
+                            aux    = packetBase + offset;
                             result = 0;
-                            for (int retry = 0; retry < MAX_WRI_RETRYS; ++retry) {
-                                if (result == 0) {
-                                    result = (FLASH_ProgramWord(aux, Data)
-                                              == FLASH_COMPLETE) ? 1 : 0;
-                                }
+                            for (int retry = 0; retry < MAX_WRI_RETRYS && result == 0; ++retry) {
+                                result = (FLASH_ProgramWord(aux, Data)
+                                          == FLASH_COMPLETE) ? 1 : 0;
                             }
                         }
+                        // packets arrive in order from the start of the image, so the
+                        // words just written continue the CRC. Reading them back from
+                        // flash keeps this a verification of what was programmed
+                        if (TransferType == FW && fwCrcRunning && result == 1) {
+                            CRC_CalcBlockCRC((uint32_t *)packetBase, numberOfWords);
+                            fwCrcWords += numberOfWords;
+                        }
                         break;
                     case Remote_flash_via_spi:
                         result = false; // No support for this for the OPLink Mini
@@ -317,7 +332,8 @@ void processComand(uint8_t *xReceive_Buffer)
         PIOS_SYS_Reset();
         break;
     case Abort_Operation:
-        Next_Packet = 0;
+        Next_Packet  = 0;
+        fwCrcRunning = false;
         DeviceState = DFUidle;
         break;
 
@@ -325,7 +341,7 @@ void processComand(uint8_t *xReceive_Buffer)
         if (DeviceState == uploading) {
             if (Next_Packet - 1 == SizeOfTransfer) {
                 Next_Packet = 0;
-                if ((TransferType != FW) || (Expected_CRC == CalcFirmCRC())) {
+                if ((TransferType != FW) || (Expected_CRC == FinishFirmCRC())) {
                     DeviceState = Last_operation_Success;
                 } else {
                     DeviceState = CRC_Fail;
@@ -441,6 +457,8 @@ uint32_t CalcFirmCRC()
 {
     switch (currentProgrammingDestination) {
     case Self_flash:
+        // this resets the CRC unit
+        fwCrcRunning = false;
         return PIOS_BL_HELPER_CRC_Memory_Calc();
 
         break;
@@ -454,6 +472,21 @@ uint32_t CalcFirmCRC()
         break;
     }
 }
+/**
+ * CRC of the firmware partition after an upload. Only the part past the
+ * uploaded image is still read when the CRC was accumulated while programming
+ */
+uint32_t FinishFirmCRC()
+{
+    const uint32_t totalWords = currentDevice.sizeOfCode >> 2;
+
+    if (!fwCrcRunning || fwCrcWords > totalWords) {
+        return CalcFirmCRC();
+    }
+    fwCrcRunning = false;
+    CRC_CalcBlockCRC((uint32_t *)(currentDevice.startOfUserCode + fwCrcWords * 4), totalWords - fwCrcWords);
+    return CRC_GetCRC();
+}
 void sendData(uint8_t *buf, uint16_t size)
 {
     platform_senddata(buf, size);
@@ -33,10 +33,14 @@
 #include "paths.h"
 // no direct UAVObject usage allowed in this file
 
+#define PATH_KIND_ENDPOINT 0
+#define PATH_KIND_VECTOR   1
+#define PATH_KIND_CIRCLE   2
+
 // private functions
-static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode);
-static void path_vector(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode);
-static void path_circle(PathDesiredData *path, float *cur_point, struct path_status *status, bool clockwise);
+static void path_endpoint(const struct path_geometry *geometry, const float *cur_point, struct path_status *status);
+static void path_vector(const struct path_geometry *geometry, const float *cur_point, struct path_status *status);
+static void path_circle(const struct path_geometry *geometry, const float *cur_point, struct path_status *status);
 
 /**
  * @brief Compute progress along path and deviation from it
@@ -46,63 +50,129 @@ static void path_circle(PathDesiredData *path, float *cur_point, struct path_sta
  */
 void path_progress(PathDesiredData *path, float *cur_point, struct path_status *status)
 {
+    struct path_geometry geometry;
+
+    path_geometry_update(path, &geometry);
+    path_geometry_progress(&geometry, cur_point, status);
+}
+
+/**
+ * @brief Precompute everything about a path segment that does not depend on the current location
+ * @param[in] path PathDesired structure
+ * @param[out] geometry Segment geometry
+ */
+void path_geometry_update(const PathDesiredData *path, struct path_geometry *geometry)
+{
+    geometry->mode3D    = false;
+    geometry->clockwise = false;
     switch (path->Mode) {
     case PATHDESIRED_MODE_BRAKE: // should never get here...
     case PATHDESIRED_MODE_FLYVECTOR:
-        return path_vector(path, cur_point, status, true);
-
+        geometry->kind   = PATH_KIND_VECTOR;
+        geometry->mode3D = true;
         break;
     case PATHDESIRED_MODE_DRIVEVECTOR:
-        return path_vector(path, cur_point, status, false);
-
+        geometry->kind   = PATH_KIND_VECTOR;
+        geometry->mode3D = false;
         break;
     case PATHDESIRED_MODE_FLYCIRCLERIGHT:
     case PATHDESIRED_MODE_DRIVECIRCLERIGHT:
-        return path_circle(path, cur_point, status, 1);
-
+        geometry->kind      = PATH_KIND_CIRCLE;
+        geometry->clockwise = true;
         break;
     case PATHDESIRED_MODE_FLYCIRCLELEFT:
     case PATHDESIRED_MODE_DRIVECIRCLELEFT:
-        return path_circle(path, cur_point, status, 0);
-
+        geometry->kind      = PATH_KIND_CIRCLE;
+        geometry->clockwise = false;
         break;
     case PATHDESIRED_MODE_FLYENDPOINT:
-        return path_endpoint(path, cur_point, status, true);
-
+        geometry->kind   = PATH_KIND_ENDPOINT;
+        geometry->mode3D = true;
         break;
     case PATHDESIRED_MODE_DRIVEENDPOINT:
     default:
         // use the endpoint as default failsafe if called in unknown modes
-        return path_endpoint(path, cur_point, status, false);
+        geometry->kind   = PATH_KIND_ENDPOINT;
+        geometry->mode3D = false;
+        break;
+    }
+    geometry->start[0]  = path->Start.North;
+    geometry->start[1]  = path->Start.East;
+    geometry->start[2]  = path->Start.Down;
+    geometry->end[0]    = path->End.North;
+    geometry->end[1]    = path->End.East;
+    geometry->end[2]    = path->End.Down;
+    geometry->starting_velocity = path->StartingVelocity;
+    geometry->ending_velocity   = path->EndingVelocity;
+
+    // Distance to go
+    geometry->vector[0] = geometry->end[0] - geometry->start[0];
+    geometry->vector[1] = geometry->end[1] - geometry->start[1];
+    geometry->vector[2] = geometry->mode3D ? geometry->end[2] - geometry->start[2] : 0.0f;
+    geometry->length    = vector_lengthf(geometry->vector, 3);
+
+    if (geometry->length > 1e-6f) {
+        float inv_length = 1.0f / geometry->length;
+        geometry->unit[0]       = geometry->vector[0] * inv_length;
+        geometry->unit[1]       = geometry->vector[1] * inv_length;
+        geometry->unit[2]       = geometry->vector[2] * inv_length;
+        geometry->inv_length_sq = inv_length * inv_length;
+    } else {
+        geometry->unit[0]       = geometry->unit[1] = geometry->unit[2] = 0.0f;
+        geometry->inv_length_sq = 0.0f;
+    }
+    geometry->inv_progress_length = 1.0f / fmaxf(geometry->length, 1.0f);
+
+    // for circles the segment is the radius, the center is the end point
+    geometry->radius       = sqrtf(squaref(geometry->vector[0]) + squaref(geometry->vector[1]));
+    geometry->radius_angle = 0.0f;
+    if (geometry->kind == PATH_KIND_CIRCLE) {
+        geometry->radius_angle = atan2f(geometry->vector[0], geometry->vector[1]);
+        if (geometry->radius_angle < 0) {
+            geometry->radius_angle += 2.0f * M_PI_F;
+        }
+    }
+}
 
+/**
+ * @brief Compute progress along a precomputed path segment and deviation from it
+ * @param[in] geometry Segment geometry from path_geometry_update()
+ * @param[in] cur_point Current location
+ * @param[out] status Structure containing progress along path and deviation
+ */
+void path_geometry_progress(const struct path_geometry *geometry, const float *cur_point, struct path_status *status)
+{
+    switch (geometry->kind) {
+    case PATH_KIND_VECTOR:
+        path_vector(geometry, cur_point, status);
+        break;
+    case PATH_KIND_CIRCLE:
+        path_circle(geometry, cur_point, status);
+        break;
+    case PATH_KIND_ENDPOINT:
+    default:
+        path_endpoint(geometry, cur_point, status);
         break;
     }
 }
 
 /**
  * @brief Compute progress towards endpoint. Deviation equals distance
- * @param[in] path PathDesired
+ * @param[in] geometry Segment geometry, mode3D includes altitude in distance and progress calculation
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
- * @param[in] mode3D set true to include altitude in distance and progress calculation
  */
-static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode3D)
+static void path_endpoint(const struct path_geometry *geometry, const float *cur_point, struct path_status *status)
 {
     float diff[3];
-    float dist_path, dist_diff;
-
-    // Distance to go
-    status->path_vector[0] = path->End.North - path->Start.North;
-    status->path_vector[1] = path->End.East - path->Start.East;
-    status->path_vector[2] = mode3D ? path->End.Down - path->Start.Down : 0.0f;
+    float dist_diff;
 
     // Current progress location relative to end
-    diff[0]   = path->End.North - cur_point[0];
-    diff[1]   = path->End.East - cur_point[1];
-    diff[2]   = mode3D ? path->End.Down - cur_point[2] : 0.0f;
+    diff[0]   = geometry->end[0] - cur_point[0];
+    diff[1]   = geometry->end[1] - cur_point[1];
+    diff[2]   = geometry->mode3D ? geometry->end[2] - cur_point[2] : 0.0f;
 
     dist_diff = vector_lengthf(diff, 3);
-    dist_path = vector_lengthf(status->path_vector, 3);
 
     if (dist_diff < 1e-6f) {
         status->fractional_progress  = 1;
@@ -114,11 +184,8 @@ static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_s
         return;
     }
 
-    if (fmaxf(dist_path, 1.0f) > dist_diff) {
-        status->fractional_progress = 1 - dist_diff / fmaxf(dist_path, 1.0f);
-    } else {
-        status->fractional_progress = 0; // we don't want fractional_progress to become negative
-    }
+    // we don't want fractional_progress to become negative
+    status->fractional_progress = fmaxf(1.0f - dist_diff * geometry->inv_progress_length, 0.0f);
     status->error = dist_diff;
 
     // Compute correction vector
@@ -127,129 +194,107 @@ static void path_endpoint(PathDesiredData *path, float *cur_point, struct path_s
     status->correction_vector[2] = diff[2];
 
     // base movement direction in this mode is a constant velocity offset on top of correction in the same direction
-    status->path_vector[0] = path->EndingVelocity * status->correction_vector[0] / dist_diff;
-    status->path_vector[1] = path->EndingVelocity * status->correction_vector[1] / dist_diff;
-    status->path_vector[2] = path->EndingVelocity * status->correction_vector[2] / dist_diff;
+    float scale = geometry->ending_velocity / dist_diff;
+    status->path_vector[0] = scale * diff[0];
+    status->path_vector[1] = scale * diff[1];
+    status->path_vector[2] = scale * diff[2];
 }
 
 /**
  * @brief Compute progress along path and deviation from it
- * @param[in] path PathDesired
+ * @param[in] geometry Segment geometry, mode3D includes altitude in distance and progress calculation
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
- * @param[in] mode3D set true to include altitude in distance and progress calculation
  */
-static void path_vector(PathDesiredData *path, float *cur_point, struct path_status *status, bool mode3D)
+static void path_vector(const struct path_geometry *geometry, const float *cur_point, struct path_status *status)
 {
     float diff[3];
-    float dist_path;
-    float dot;
     float velocity;
-    float track_point[3];
 
-    // Distance to go
-    status->path_vector[0] = path->End.North - path->Start.North;
-    status->path_vector[1] = path->End.East - path->Start.East;
-    status->path_vector[2] = mode3D ? path->End.Down - path->Start.Down : 0.0f;
-
-    // Current progress location relative to start
-    diff[0]   = cur_point[0] - path->Start.North;
-    diff[1]   = cur_point[1] - path->Start.East;
-    diff[2]   = mode3D ? cur_point[2] - path->Start.Down : 0.0f;
-
-    dot       = status->path_vector[0] * diff[0] + status->path_vector[1] * diff[1] + status->path_vector[2] * diff[2];
-    dist_path = vector_lengthf(status->path_vector, 3);
-
-    if (dist_path > 1e-6f) {
-        // Compute direction to travel & progress
-        status->fractional_progress = dot / (dist_path * dist_path);
-    } else {
+    if (geometry->length <= 1e-6f) {
         // Fly towards the endpoint to prevent flying away,
         // but assume progress=1 either way.
-        path_endpoint(path, cur_point, status, mode3D);
+        path_endpoint(geometry, cur_point, status);
         status->fractional_progress = 1;
         return;
     }
-    // Compute point on track that is closest to our current position.
-    track_point[0] = status->fractional_progress * status->path_vector[0] + path->Start.North;
-    track_point[1] = status->fractional_progress * status->path_vector[1] + path->Start.East;
-    track_point[2] = status->fractional_progress * status->path_vector[2] + path->Start.Down;
 
-    status->correction_vector[0] = track_point[0] - cur_point[0];
-    status->correction_vector[1] = track_point[1] - cur_point[1];
-    status->correction_vector[2] = track_point[2] - cur_point[2];
+    // Current progress location relative to start
+    diff[0] = cur_point[0] - geometry->start[0];
+    diff[1] = cur_point[1] - geometry->start[1];
+    diff[2] = geometry->mode3D ? cur_point[2] - geometry->start[2] : 0.0f;
+
+    // Compute direction to travel & progress
+    float progress = (geometry->vector[0] * diff[0] + geometry->vector[1] * diff[1] + geometry->vector[2] * diff[2]) * geometry->inv_length_sq;
+    status->fractional_progress = progress;
+
+    // Compute point on track that is closest to our current position.
+    status->correction_vector[0] = progress * geometry->vector[0] + geometry->start[0] - cur_point[0];
+    status->correction_vector[1] = progress * geometry->vector[1] + geometry->start[1] - cur_point[1];
+    status->correction_vector[2] = progress * geometry->vector[2] + geometry->start[2] - cur_point[2];
 
     status->error = vector_lengthf(status->correction_vector, 3);
 
     // correct movement vector to current velocity
-    velocity = path->StartingVelocity + boundf(status->fractional_progress, 0.0f, 1.0f) * (path->EndingVelocity - path->StartingVelocity);
-    status->path_vector[0] = velocity * status->path_vector[0] / dist_path;
-    status->path_vector[1] = velocity * status->path_vector[1] / dist_path;
-    status->path_vector[2] = velocity * status->path_vector[2] / dist_path;
+    velocity = geometry->starting_velocity + boundf(progress, 0.0f, 1.0f) * (geometry->ending_velocity - geometry->starting_velocity);
+    status->path_vector[0] = velocity * geometry->unit[0];
+    status->path_vector[1] = velocity * geometry->unit[1];
+    status->path_vector[2] = velocity * geometry->unit[2];
 }
 
 /**
  * @brief Compute progress along circular path and deviation from it
- * @param[in] path PathDesired
+ * @param[in] geometry Segment geometry, End is the center and Start a point on the circle
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_circle(PathDesiredData *path, float *cur_point, struct path_status *status, bool clockwise)
+static void path_circle(const struct path_geometry *geometry, const float *cur_point, struct path_status *status)
 {
-    float radius_north, radius_east, diff_north, diff_east, diff_down;
-    float radius, cradius;
+    float diff_north, diff_east, diff_down;
+    float cradius;
     float normal[2];
     float progress;
-    float a_diff, a_radius;
-
-    // Radius
-    radius_north = path->End.North - path->Start.North;
-    radius_east  = path->End.East - path->Start.East;
+    float a_diff;
 
     // Current location relative to center
-    diff_north   = cur_point[0] - path->End.North;
-    diff_east    = cur_point[1] - path->End.East;
-    diff_down    = cur_point[2] - path->End.Down;
+    diff_north = cur_point[0] - geometry->end[0];
+    diff_east  = cur_point[1] - geometry->end[1];
+    diff_down  = cur_point[2] - geometry->end[2];
 
-    radius  = sqrtf(squaref(radius_north) + squaref(radius_east));
-    cradius = sqrtf(squaref(diff_north) + squaref(diff_east));
+    cradius    = sqrtf(squaref(diff_north) + squaref(diff_east));
 
     // circles are always horizontal (for now - TODO: allow 3d circles - problem: clockwise/counterclockwise does no longer apply)
     status->path_vector[2] = 0.0f;
 
     // error is current radius minus wanted radius - positive if too close
-    status->error = radius - cradius;
+    status->error = geometry->radius - cradius;
 
     if (cradius < 1e-6f) {
         // cradius is zero, just fly somewhere
         status->fractional_progress  = 1;
         status->correction_vector[0] = 0;
         status->correction_vector[1] = 0;
-        status->path_vector[0] = path->EndingVelocity;
+        status->path_vector[0] = geometry->ending_velocity;
         status->path_vector[1] = 0;
     } else {
-        if (clockwise) {
+        float inv_cradius = 1.0f / cradius;
+        if (geometry->clockwise) {
             // Compute the normal to the radius clockwise
-            normal[0] = -diff_east / cradius;
-            normal[1] = diff_north / cradius;
+            normal[0] = -diff_east * inv_cradius;
+            normal[1] = diff_north * inv_cradius;
         } else {
             // Compute the normal to the radius counter clockwise
-            normal[0] = diff_east / cradius;
-            normal[1] = -diff_north / cradius;
+            normal[0] = diff_east * inv_cradius;
+            normal[1] = -diff_north * inv_cradius;
         }
 
         // normalize progress to 0..1
-        a_diff   = atan2f(diff_north, diff_east);
-        a_radius = atan2f(radius_north, radius_east);
-
+        a_diff = atan2f(diff_north, diff_east);
         if (a_diff < 0) {
             a_diff += 2.0f * M_PI_F;
         }
-        if (a_radius < 0) {
-            a_radius += 2.0f * M_PI_F;
-        }
 
-        progress = (a_diff - a_radius + M_PI_F) / (2.0f * M_PI_F);
+        progress = (a_diff - geometry->radius_angle + M_PI_F) / (2.0f * M_PI_F);
 
         if (progress < 0.0f) {
             progress += 1.0f;
@@ -257,22 +302,22 @@ static void path_circle(PathDesiredData *path, float *cur_point, struct path_sta
             progress -= 1.0f;
         }
 
-        if (clockwise) {
+        if (geometry->clockwise) {
             progress = 1.0f - progress;
         }
 
         status->fractional_progress = progress;
 
         // Compute direction to travel
-        status->path_vector[0] = normal[0] * path->EndingVelocity;
-        status->path_vector[1] = normal[1] * path->EndingVelocity;
+        status->path_vector[0] = normal[0] * geometry->ending_velocity;
+        status->path_vector[1] = normal[1] * geometry->ending_velocity;
 
         // Compute direction to correct error
-        status->correction_vector[0] = status->error * diff_north / cradius;
-        status->correction_vector[1] = status->error * diff_east / cradius;
+        status->correction_vector[0] = status->error * diff_north * inv_cradius;
+        status->correction_vector[1] = status->error * diff_east * inv_cradius;
     }
 
     status->correction_vector[2] = -diff_down;
 
-    status->error = fabs(status->error);
+    status->error = fabsf(status->error);
 }
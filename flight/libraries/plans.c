@@ -41,17 +41,30 @@
 #include <attitudestate.h>
 #include <vtolpathfollowersettings.h>
 #include <sin_lookup.h>
+#include <fastmath.h>
 
 #define UPDATE_EXPECTED 0.02f
 #define UPDATE_MIN      1.0e-6f
 #define UPDATE_MAX      1.0f
 #define UPDATE_ALPHA    1.0e-2f
 
+// FlightModeSettings used by the assisted flight plans, updated on change
+static FlightModeSettingsPositionHoldOffsetData planOffset;
+static float planVarioAlpha;
+
+static void plan_settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    FlightModeSettingsPositionHoldOffsetGet(&planOffset);
+    FlightModeSettingsVarioControlLowPassAlphaGet(&planVarioAlpha);
+}
+
 /**
  * @brief initialize UAVOs and structs used by this library
  */
 void plan_initialize()
 {
+    static bool initialized = false;
+
     TakeOffLocationInitialize();
     PositionStateInitialize();
     PathDesiredInitialize();
@@ -61,6 +74,13 @@ void plan_initialize()
     ManualControlCommandInitialize();
     VelocityStateInitialize();
     VtolPathFollowerSettingsInitialize();
+
+    // both PathPlanner and ManualControl initialize the library
+    if (!initialized) {
+        FlightModeSettingsConnectCallback(plan_settingsUpdatedCb);
+        plan_settingsUpdatedCb(NULL);
+        initialized = true;
+    }
 }
 
 /**
@@ -175,15 +195,20 @@ void plan_run_land()
 static bool vario_hold    = true;
 static float hold_position[3];
 static float vario_control_lowpass[3];
-static float vario_course = 0.0f;
+// course is fixed while in the mode, keep its sine and cosine
+static float vario_course_sin = 0.0f;
+static float vario_course_cos = 1.0f;
 
 static void plan_setup_PositionVario()
 {
+    float vario_course;
+
     vario_hold = true;
     vario_control_lowpass[0] = 0.0f;
     vario_control_lowpass[1] = 0.0f;
     vario_control_lowpass[2] = 0.0f;
     AttitudeStateYawGet(&vario_course);
+    fast_sincosf(DEG2RAD(vario_course), &vario_course_sin, &vario_course_cos);
     plan_setup_positionHold();
 }
 
@@ -238,14 +263,10 @@ static bool normalizeDeadband(float controlVector[4])
 
 typedef enum { COURSE, FPV, LOS, NSEW } vario_type;
 
-static void getVector(float controlVector[4], vario_type type)
+static void getVector(float controlVector[4], vario_type type, const PositionStateData *positionState)
 {
-    FlightModeSettingsPositionHoldOffsetData offset;
-
-    FlightModeSettingsPositionHoldOffsetGet(&offset);
-
     // scale controlVector[3] (thrust) by vertical/horizontal to have vertical plane less sensitive
-    controlVector[3] *= offset.Vertical / offset.Horizontal;
+    controlVector[3] *= planOffset.Vertical / planOffset.Horizontal;
 
     float length = sqrtf(controlVector[0] * controlVector[0] + controlVector[1] * controlVector[1] + controlVector[3] * controlVector[3]);
 
@@ -262,38 +283,50 @@ static void getVector(float controlVector[4], vario_type type)
         controlVector[1] = direction[1];
         controlVector[2] = direction[2];
     }
-    controlVector[3] = length * offset.Horizontal;
+    controlVector[3] = length * planOffset.Horizontal;
 
     // rotate north and east - rotation angle based on type
-    float angle;
+    float sin_angle, cos_angle;
     switch (type) {
     case COURSE:
-        angle = vario_course;
-        break;
-    case NSEW:
-        angle = 0.0f;
-        // NSEW no rotation takes place
+        sin_angle = vario_course_sin;
+        cos_angle = vario_course_cos;
         break;
     case FPV:
         // local rotation, using current yaw
-        AttitudeStateYawGet(&angle);
-        break;
+    {
+        float yaw;
+        AttitudeStateYawGet(&yaw);
+        fast_sincosf(DEG2RAD(yaw), &sin_angle, &cos_angle);
+    }
+    break;
     case LOS:
         // determine location based on vector from takeoff to current location
     {
-        PositionStateData positionState;
-        PositionStateGet(&positionState);
         TakeOffLocationData takeoffLocation;
         TakeOffLocationGet(&takeoffLocation);
-        angle = RAD2DEG(atan2f(positionState.East - takeoffLocation.East, positionState.North - takeoffLocation.North));
+        float north = positionState->North - takeoffLocation.North;
+        float east  = positionState->East - takeoffLocation.East;
+        float dist  = sqrtf(north * north + east * east);
+        if (dist > 1e-6f) {
+            cos_angle = north / dist;
+            sin_angle = east / dist;
+        } else {
+            cos_angle = 1.0f;
+            sin_angle = 0.0f;
+        }
     }
     break;
+    case NSEW:
+    default:
+        // NSEW no rotation takes place
+        return;
     }
     // rotate horizontally by angle
     {
         float rotated[2] = {
-            controlVector[0] * cos_lookup_deg(angle) - controlVector[1] * sin_lookup_deg(angle),
-            controlVector[0] * sin_lookup_deg(angle) + controlVector[1] * cos_lookup_deg(angle)
+            controlVector[0] * cos_angle - controlVector[1] * sin_angle,
+            controlVector[0] * sin_angle + controlVector[1] * cos_angle
         };
         controlVector[0] = rotated[0];
         controlVector[1] = rotated[1];
@@ -304,21 +337,17 @@ static void getVector(float controlVector[4], vario_type type)
 static void plan_run_PositionVario(vario_type type)
 {
     float controlVector[4];
-    float alpha;
     PathDesiredData pathDesired;
+    ManualControlCommandData cmd;
 
     PathDesiredGet(&pathDesired);
-    FlightModeSettingsPositionHoldOffsetData offset;
-    FlightModeSettingsPositionHoldOffsetGet(&offset);
-
-
-    ManualControlCommandRollGet(&controlVector[0]);
-    ManualControlCommandPitchGet(&controlVector[1]);
-    ManualControlCommandYawGet(&controlVector[2]);
-    ManualControlCommandThrustGet(&controlVector[3]);
-
+    ManualControlCommandGet(&cmd);
+    controlVector[0] = cmd.Roll;
+    controlVector[1] = cmd.Pitch;
+    controlVector[2] = cmd.Yaw;
+    controlVector[3] = cmd.Thrust;
 
-    FlightModeSettingsVarioControlLowPassAlphaGet(&alpha);
+    const float alpha = planVarioAlpha;
     vario_control_lowpass[0] = alpha * vario_control_lowpass[0] + (1.0f - alpha) * controlVector[0];
     vario_control_lowpass[1] = alpha * vario_control_lowpass[1] + (1.0f - alpha) * controlVector[1];
     vario_control_lowpass[2] = alpha * vario_control_lowpass[2] + (1.0f - alpha) * controlVector[2];
@@ -337,7 +366,7 @@ static void plan_run_PositionVario(vario_type type)
             pathDesired.End.East    = hold_position[1];
             pathDesired.End.Down    = hold_position[2];
             // while the new start position has the same offset as in position hold
-            pathDesired.Start.North = pathDesired.End.North + offset.Horizontal; // in FlyEndPoint the direction of this vector does not matter
+            pathDesired.Start.North = pathDesired.End.North + planOffset.Horizontal; // in FlyEndPoint the direction of this vector does not matter
             pathDesired.Start.East  = pathDesired.End.East;
             pathDesired.Start.Down  = pathDesired.End.Down;
             PathDesiredSet(&pathDesired);
@@ -348,7 +377,7 @@ static void plan_run_PositionVario(vario_type type)
 
         // flip pitch to have pitch down (away) point north
         controlVector[1] = -controlVector[1];
-        getVector(controlVector, type);
+        getVector(controlVector, type, &positionState);
 
         // layout of control Vector : unitVector in movement direction {0,1,2} vector length {3} velocity {4}
         if (vario_hold) {
@@ -374,7 +403,7 @@ static void plan_run_PositionVario(vario_type type)
         pathDesired.End.East    = hold_position[1] + controlVector[1] * controlVector[3];
         pathDesired.End.Down    = hold_position[2] - controlVector[2] * controlVector[3];
         // the new start position has the same offset as in position hold
-        pathDesired.Start.North = pathDesired.End.North + offset.Horizontal; // in FlyEndPoint the direction of this vector does not matter
+        pathDesired.Start.North = pathDesired.End.North + planOffset.Horizontal; // in FlyEndPoint the direction of this vector does not matter
         pathDesired.Start.East  = pathDesired.End.East;
         pathDesired.Start.Down  = pathDesired.End.Down;
         PathDesiredSet(&pathDesired);
@@ -456,17 +485,17 @@ void plan_run_AutoCruise()
     PositionStateGet(&positionState);
     PathDesiredData pathDesired;
     PathDesiredGet(&pathDesired);
-    FlightModeSettingsPositionHoldOffsetData offset;
-    FlightModeSettingsPositionHoldOffsetGet(&offset);
+    ManualControlCommandData cmd;
+    ManualControlCommandGet(&cmd);
 
     float controlVector[4];
-    ManualControlCommandRollGet(&controlVector[0]);
-    ManualControlCommandPitchGet(&controlVector[1]);
-    ManualControlCommandYawGet(&controlVector[2]);
+    controlVector[0] = cmd.Roll;
+    controlVector[1] = cmd.Pitch;
+    controlVector[2] = cmd.Yaw;
     controlVector[3] = 0.5f; // dummy, thrust is normalized separately
     normalizeDeadband(controlVector); // return value ignored
-    ManualControlCommandThrustGet(&controlVector[3]); // no deadband as we are using thrust for velocity
-    controlVector[3] = boundf(controlVector[3], 1e-6f, 1.0f); // bound to above zero, to prevent loss of vector direction
+    // no deadband as we are using thrust for velocity
+    controlVector[3] = boundf(cmd.Thrust, 1e-6f, 1.0f); // bound to above zero, to prevent loss of vector direction
 
     // normalize old desired movement vector
     float vector[3] = { pathDesired.End.North - hold_position[0],
@@ -491,22 +520,33 @@ void plan_run_AutoCruise()
         hold_position[2] += kp * vector[2];
     }
 
-    // new angle is equal to old angle plus offset depending on yaw input and time
+    // new direction is the old horizontal direction turned depending on yaw input and time
     // (controlVector is normalized with a deadband, change is zero within deadband)
-    float angle = RAD2DEG(atan2f(vector[1], vector[0]));
-    float dT    = PIOS_DELTATIME_GetAverageSeconds(&actimeval);
-    angle    += 10.0f * controlVector[2] * dT; // TODO magic value could eventually end up in a to be created settings
+    float horizontal = sqrtf(vector[0] * vector[0] + vector[1] * vector[1]);
+    float heading[2] = { 1.0f, 0.0f };
+    if (horizontal > 1e-9f) {
+        heading[0] = vector[0] / horizontal;
+        heading[1] = vector[1] / horizontal;
+    }
+    float dT = PIOS_DELTATIME_GetAverageSeconds(&actimeval);
+    if (controlVector[2] != 0.0f) {
+        float sin_turn, cos_turn;
+        fast_sincosf(DEG2RAD(10.0f * controlVector[2] * dT), &sin_turn, &cos_turn); // TODO magic value could eventually end up in a to be created settings
+        float turned = heading[0] * cos_turn - heading[1] * sin_turn;
+        heading[1] = heading[0] * sin_turn + heading[1] * cos_turn;
+        heading[0] = turned;
+    }
 
     // resulting movement vector is scaled by velocity demand in controlvector[3] [0.0-1.0]
-    vector[0] = cosf(DEG2RAD(angle)) * offset.Horizontal * controlVector[3];
-    vector[1] = sinf(DEG2RAD(angle)) * offset.Horizontal * controlVector[3];
-    vector[2] = -controlVector[1] * offset.Vertical * controlVector[3];
+    vector[0] = heading[0] * planOffset.Horizontal * controlVector[3];
+    vector[1] = heading[1] * planOffset.Horizontal * controlVector[3];
+    vector[2] = -controlVector[1] * planOffset.Vertical * controlVector[3];
 
     pathDesired.End.North   = hold_position[0] + vector[0];
     pathDesired.End.East    = hold_position[1] + vector[1];
     pathDesired.End.Down    = hold_position[2] + vector[2];
     // start position has the same offset as in position hold
-    pathDesired.Start.North = pathDesired.End.North + offset.Horizontal; // in FlyEndPoint the direction of this vector does not matter
+    pathDesired.Start.North = pathDesired.End.North + planOffset.Horizontal; // in FlyEndPoint the direction of this vector does not matter
     pathDesired.Start.East  = pathDesired.End.East;
     pathDesired.Start.Down  = pathDesired.End.Down;
     PathDesiredSet(&pathDesired);
@@ -237,13 +237,24 @@ void
 Find_Roots (void)
 {
   int sum, r, k;	
+  /* log of Lambda[k]*a^(k*r), updated incrementally for each r,
+     or -1 for the zero coefficients */
+  int term[RS_ECC_NPARITY+1];
+
   NErrors = 0;
+  for (k = 0; k < RS_ECC_NPARITY+1; k++) {
+    term[k] = Lambda[k] ? glog[Lambda[k]] : -1;
+  }
   
   for (r = 1; r < 256; r++) {
     sum = 0;
     /* evaluate lambda at r */
     for (k = 0; k < RS_ECC_NPARITY+1; k++) {
-      sum ^= gmult(gexp[(k*r)%255], Lambda[k]);
+      if (term[k] >= 0) {
+        term[k] += k;
+        if (term[k] >= 255) term[k] -= 255;
+        sum ^= gexp[term[k]];
+      }
     }
     if (sum == 0) 
       { 
@@ -280,6 +291,9 @@ correct_errors_erasures (unsigned char codeword[],
   NErasures = nerasures;
   for (i = 0; i < NErasures; i++) ErasureLocs[i] = erasures[i];
 
+  /* Nothing to locate in a valid codeword, skip Berlekamp-Massey and the root search */
+  if (NErasures == 0 && !check_syndrome()) return(0);
+
   Modified_Berlekamp_Massey();
   Find_Roots();
   
@@ -77,13 +77,23 @@ void encode_data (unsigned char msg[], int nbytes, unsigned char dst[]);
 /* CRC-CCITT checksum generator */
 BIT16 crc_ccitt(unsigned char *msg, int len);
 
-/* galois arithmetic tables */
-extern const int gexp[];
-extern const int glog[];
+/* galois arithmetic tables, bytes so they take 768 bytes of flash */
+extern const uint8_t gexp[];
+extern const uint8_t glog[];
 
 void init_galois_tables (void);
-int ginv(int elt); 
-int gmult(int a, int b);
+
+/* multiplication using logarithms, inlined as it is in every inner loop */
+static inline int gmult(int a, int b)
+{
+  if (a == 0 || b == 0) return (0);
+  return (gexp[glog[a] + glog[b]]);
+}
+
+static inline int ginv (int elt)
+{
+  return (gexp[255 - glog[elt]]);
+}
 
 
 /* Error location routines */
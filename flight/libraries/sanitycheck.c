@@ -55,9 +55,27 @@ typedef struct SANITYCHECK_CustomHookInstance {
 
 // ! Check a stabilization mode switch position for safety
 static bool check_stabilization_settings(int index, bool multirotor, bool coptercontrol, bool gpsassisted);
+static void update_settings_checks();
+static void settingsUpdatedCb(UAVObjEvent *ev);
 
 SANITYCHECK_CustomHookInstance *hooks = 0;
 
+// Results of the checks that only depend on settings. They are recomputed
+// when one of the settings objects changed, the parts that depend on the
+// vehicle state are applied on every call.
+#define MODE_CHECK_OK             0x01
+#define MODE_CHECK_NEEDS_NAV      0x02
+#define MODE_CHECK_NEEDS_PATHPLAN 0x04
+static uint8_t modeChecks[FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_NUMELEM];
+static uint8_t numModes;
+static bool thrustRangeOk;
+static bool checksDisabled;
+#ifdef REVOLUTION
+static bool navCapableAlgorithm;
+#endif
+static volatile bool settingsUpdated = true;
+static bool callbacksConnected = false;
+
 /**
  * Run a preflight check over the hardware configuration
  * and currently active modules
@@ -67,40 +85,122 @@ int32_t configuration_check()
     int32_t severity = SYSTEMALARMS_ALARM_OK;
     SystemAlarmsExtendedAlarmStatusOptions alarmstatus = SYSTEMALARMS_EXTENDEDALARMSTATUS_NONE;
     uint8_t alarmsubstatus = 0;
+
+    if (!callbacksConnected) {
+#ifdef REVOLUTION
+        RevoSettingsInitialize();
+        RevoSettingsConnectCallback(settingsUpdatedCb);
+#endif
+        SystemSettingsConnectCallback(settingsUpdatedCb);
+        ManualControlSettingsConnectCallback(settingsUpdatedCb);
+        StabilizationSettingsConnectCallback(settingsUpdatedCb);
+        FlightModeSettingsConnectCallback(settingsUpdatedCb);
+        callbacksConnected = true;
+    }
+    if (settingsUpdated) {
+        // cleared first so an update arriving meanwhile triggers another pass
+        settingsUpdated = false;
+        update_settings_checks();
+    }
+
+    // Classify navigation capability
+#ifdef REVOLUTION
+    // check for hitl.  hitl allows to feed position and velocity state via
+    // telemetry, this makes nav possible even with an unsuited algorithm
+    bool navCapableFusion = navCapableAlgorithm || (PositionStateHandle() && PositionStateReadOnly());
+#else
+    const bool navCapableFusion = false;
+#endif /* ifdef REVOLUTION */
+
+    // PathPlan alarm is only read when a flight mode position needs it
+    bool pathPlanRead = false;
+    bool pathPlanOk   = false;
+
+    for (uint32_t i = 0; i < numModes; i++) {
+        uint8_t check = modeChecks[i];
+        if ((check & MODE_CHECK_NEEDS_PATHPLAN) && !pathPlanRead) {
+            // Revo supports PathPlanner and that must be OK or we are not sane
+            // PathPlan alarm is uninitialized if not running
+            // PathPlan alarm is warning or error if the flightplan is invalid
+            SystemAlarmsAlarmData alarms;
+            SystemAlarmsAlarmGet(&alarms);
+            pathPlanOk   = (alarms.PathPlan == SYSTEMALARMS_ALARM_OK);
+            pathPlanRead = true;
+        }
+        ADDSEVERITY(check & MODE_CHECK_OK);
+        ADDSEVERITY(!(check & MODE_CHECK_NEEDS_NAV) || navCapableFusion);
+        ADDSEVERITY(!(check & MODE_CHECK_NEEDS_PATHPLAN) || pathPlanOk);
+        // mark the first encountered erroneous setting in status and substatus
+        if ((severity != SYSTEMALARMS_ALARM_OK) && (alarmstatus == SYSTEMALARMS_EXTENDEDALARMSTATUS_NONE)) {
+            alarmstatus    = SYSTEMALARMS_EXTENDEDALARMSTATUS_FLIGHTMODE;
+            alarmsubstatus = i;
+            break;
+        }
+    }
+
+    // Check throttle/collective channel range for valid configuration of input for critical control
+    ADDSEVERITY(thrustRangeOk);
+    ADDEXTENDEDALARMSTATUS(SYSTEMALARMS_EXTENDEDALARMSTATUS_BADTHROTTLEORCOLLECTIVEINPUTRANGE, 0);
+
+    // query sanity check hooks
+    if (severity < SYSTEMALARMS_ALARM_CRITICAL) {
+        SANITYCHECK_CustomHookInstance *instance = NULL;
+        LL_FOREACH(hooks, instance) {
+            if (instance->enabled) {
+                alarmstatus = instance->hook();
+                if (alarmstatus != SYSTEMALARMS_EXTENDEDALARMSTATUS_NONE) {
+                    severity = SYSTEMALARMS_ALARM_CRITICAL;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (checksDisabled) {
+        severity = SYSTEMALARMS_ALARM_WARNING;
+    }
+
+    if (severity != SYSTEMALARMS_ALARM_OK) {
+        ExtendedAlarmsSet(SYSTEMALARMS_ALARM_SYSTEMCONFIGURATION, severity, alarmstatus, alarmsubstatus);
+    } else {
+        AlarmsClear(SYSTEMALARMS_ALARM_SYSTEMCONFIGURATION);
+    }
+
+    return 0;
+}
+
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    settingsUpdated = true;
+}
+
+/**
+ * Evaluate everything that only depends on settings: the per flight mode
+ * position checks, the thrust channel range and the sanity check override
+ */
+static void update_settings_checks()
+{
     // Get board type
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
     bool coptercontrol     = bdinfo->board_type == 0x04;
 
-    // Classify navigation capability
 #ifdef REVOLUTION
-    RevoSettingsInitialize();
     uint8_t revoFusion;
     RevoSettingsFusionAlgorithmGet(&revoFusion);
-    bool navCapableFusion;
     switch (revoFusion) {
     case REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAGGPSOUTDOOR:
     case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13:
-        navCapableFusion = true;
+    case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS16:
+        navCapableAlgorithm = true;
         break;
     default:
-        navCapableFusion = false;
-        // check for hitl.  hitl allows to feed position and velocity state via
-        // telemetry, this makes nav possible even with an unsuited algorithm
-        if (PositionStateHandle()) {
-            if (PositionStateReadOnly()) {
-                navCapableFusion = true;
-            }
-        }
+        navCapableAlgorithm = false;
     }
-#else
-    const bool navCapableFusion = false;
 #endif /* ifdef REVOLUTION */
 
-
     // Classify airframe type
     bool multirotor = (GetCurrentFrameType() == FRAME_TYPE_MULTIROTOR);
 
-
     // For each available flight mode position sanity check the available
     // modes
     uint8_t num_modes;
@@ -109,51 +209,48 @@ int32_t configuration_check()
     ManualControlSettingsFlightModeNumberGet(&num_modes);
     StabilizationSettingsFlightModeAssistMapGet(FlightModeAssistMap);
     FlightModeSettingsFlightModePositionGet(modes);
+    if (num_modes > FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_NUMELEM) {
+        num_modes = FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_NUMELEM;
+    }
 
     for (uint32_t i = 0; i < num_modes; i++) {
         uint8_t gps_assisted = FlightModeAssistMap[i];
+        uint8_t check = 0;
+        bool ok = true;
         if (gps_assisted) {
-            ADDSEVERITY(!coptercontrol);
-            ADDSEVERITY(multirotor);
-            ADDSEVERITY(navCapableFusion);
+            ok    &= !coptercontrol && multirotor;
+            check |= MODE_CHECK_NEEDS_NAV;
         }
 
         switch (modes[i]) {
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_MANUAL:
-            ADDSEVERITY(!gps_assisted);
-            ADDSEVERITY(!multirotor);
+            ok &= !gps_assisted && !multirotor;
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_STABILIZED1:
-            ADDSEVERITY(check_stabilization_settings(1, multirotor, coptercontrol, gps_assisted));
+            ok &= check_stabilization_settings(1, multirotor, coptercontrol, gps_assisted);
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_STABILIZED2:
-            ADDSEVERITY(check_stabilization_settings(2, multirotor, coptercontrol, gps_assisted));
+            ok &= check_stabilization_settings(2, multirotor, coptercontrol, gps_assisted);
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_STABILIZED3:
-            ADDSEVERITY(check_stabilization_settings(3, multirotor, coptercontrol, gps_assisted));
+            ok &= check_stabilization_settings(3, multirotor, coptercontrol, gps_assisted);
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_STABILIZED4:
-            ADDSEVERITY(check_stabilization_settings(4, multirotor, coptercontrol, gps_assisted));
+            ok &= check_stabilization_settings(4, multirotor, coptercontrol, gps_assisted);
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_STABILIZED5:
-            ADDSEVERITY(check_stabilization_settings(5, multirotor, coptercontrol, gps_assisted));
+            ok &= check_stabilization_settings(5, multirotor, coptercontrol, gps_assisted);
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_STABILIZED6:
-            ADDSEVERITY(check_stabilization_settings(6, multirotor, coptercontrol, gps_assisted));
+            ok &= check_stabilization_settings(6, multirotor, coptercontrol, gps_assisted);
             break;
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_PATHPLANNER:
-        {
-            // Revo supports PathPlanner and that must be OK or we are not sane
-            // PathPlan alarm is uninitialized if not running
-            // PathPlan alarm is warning or error if the flightplan is invalid
-            SystemAlarmsAlarmData alarms;
-            SystemAlarmsAlarmGet(&alarms);
-            ADDSEVERITY(alarms.PathPlan == SYSTEMALARMS_ALARM_OK);
-            ADDSEVERITY(!gps_assisted);
-        }
+            check |= MODE_CHECK_NEEDS_PATHPLAN;
+            ok    &= !gps_assisted;
+        // fall through
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_POSITIONHOLD:
-            ADDSEVERITY(!coptercontrol);
-            ADDSEVERITY(navCapableFusion);
+            ok    &= !coptercontrol;
+            check |= MODE_CHECK_NEEDS_NAV;
             break;
 
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_COURSELOCK:
@@ -164,21 +261,16 @@ int32_t configuration_check()
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_POI:
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_RETURNTOBASE:
         case FLIGHTMODESETTINGS_FLIGHTMODEPOSITION_AUTOCRUISE:
-            ADDSEVERITY(!gps_assisted);
-            ADDSEVERITY(!coptercontrol);
-            ADDSEVERITY(navCapableFusion);
+            ok    &= !gps_assisted && !coptercontrol;
+            check |= MODE_CHECK_NEEDS_NAV;
             break;
         default:
             // Uncovered modes are automatically an error
-            ADDSEVERITY(false);
-        }
-        // mark the first encountered erroneous setting in status and substatus
-        if ((severity != SYSTEMALARMS_ALARM_OK) && (alarmstatus == SYSTEMALARMS_EXTENDEDALARMSTATUS_NONE)) {
-            alarmstatus    = SYSTEMALARMS_EXTENDEDALARMSTATUS_FLIGHTMODE;
-            alarmsubstatus = i;
+            ok = false;
         }
+        modeChecks[i] = check | (ok ? MODE_CHECK_OK : 0);
     }
-
+    numModes = num_modes;
 
     // Check throttle/collective channel range for valid configuration of input for critical control
     SystemSettingsThrustControlOptions thrustType;
@@ -189,44 +281,19 @@ int32_t configuration_check()
     ManualControlSettingsChannelMaxGet(&channelMax);
     switch (thrustType) {
     case SYSTEMSETTINGS_THRUSTCONTROL_THROTTLE:
-        ADDSEVERITY(fabsf(channelMax.Throttle - channelMin.Throttle) > 300.0f);
-        ADDEXTENDEDALARMSTATUS(SYSTEMALARMS_EXTENDEDALARMSTATUS_BADTHROTTLEORCOLLECTIVEINPUTRANGE, 0);
+        thrustRangeOk = fabsf(channelMax.Throttle - channelMin.Throttle) > 300.0f;
         break;
     case SYSTEMSETTINGS_THRUSTCONTROL_COLLECTIVE:
-        ADDSEVERITY(fabsf(channelMax.Collective - channelMin.Collective) > 300.0f);
-        ADDEXTENDEDALARMSTATUS(SYSTEMALARMS_EXTENDEDALARMSTATUS_BADTHROTTLEORCOLLECTIVEINPUTRANGE, 0);
+        thrustRangeOk = fabsf(channelMax.Collective - channelMin.Collective) > 300.0f;
         break;
     default:
+        thrustRangeOk = true;
         break;
     }
 
-    // query sanity check hooks
-    if (severity < SYSTEMALARMS_ALARM_CRITICAL) {
-        SANITYCHECK_CustomHookInstance *instance = NULL;
-        LL_FOREACH(hooks, instance) {
-            if (instance->enabled) {
-                alarmstatus = instance->hook();
-                if (alarmstatus != SYSTEMALARMS_EXTENDEDALARMSTATUS_NONE) {
-                    severity = SYSTEMALARMS_ALARM_CRITICAL;
-                    break;
-                }
-            }
-        }
-    }
-
     uint8_t checks_disabled;
     FlightModeSettingsDisableSanityChecksGet(&checks_disabled);
-    if (checks_disabled == FLIGHTMODESETTINGS_DISABLESANITYCHECKS_TRUE) {
-        severity = SYSTEMALARMS_ALARM_WARNING;
-    }
-
-    if (severity != SYSTEMALARMS_ALARM_OK) {
-        ExtendedAlarmsSet(SYSTEMALARMS_ALARM_SYSTEMCONFIGURATION, severity, alarmstatus, alarmsubstatus);
-    } else {
-        AlarmsClear(SYSTEMALARMS_ALARM_SYSTEMCONFIGURATION);
-    }
-
-    return 0;
+    checksDisabled = (checks_disabled == FLIGHTMODESETTINGS_DISABLESANITYCHECKS_TRUE);
 }
 
 /**
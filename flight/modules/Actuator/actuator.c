@@ -45,6 +45,7 @@
 #include "cameradesired.h"
 #include "manualcontrolcommand.h"
 #include "taskinfo.h"
+#include <fastloop.h>
 #undef PIOS_INCLUDE_INSTRUMENTATION
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
 #include <pios_instrumentation.h>
@@ -70,13 +71,58 @@ static int8_t counter;
 #define ACTUATOR_ONESHOT125_CLOCK       2000000
 #define ACTUATOR_ONESHOT125_PULSE_SCALE 4
 #define ACTUATOR_PWM_CLOCK              1000000
+
+#define MIXER_INPUTS                    MIXERSETTINGS_MIXER1VECTOR_NUMELEM
+#define MIXER_CURVE_NUMELEM             MIXERSETTINGS_THROTTLECURVE1_NUMELEM
+#if MIXERSETTINGS_THROTTLECURVE2_NUMELEM != MIXER_CURVE_NUMELEM
+#error "Both throttle curves must have the same number of points"
+#endif
 // Private types
 
+// this structure is equivalent to the UAVObjects for one mixer.
+typedef struct {
+    uint8_t type;
+    int8_t  matrix[5];
+} __attribute__((packed)) Mixer_t;
+
+// throttle curve as one linear segment per point, the last one is flat
+typedef struct {
+    float base[MIXER_CURVE_NUMELEM];
+    float slope[MIXER_CURVE_NUMELEM];
+    bool  passthrough;
+} MixerCurve_t;
+
+// output scaling of one channel, the clamp limits are ordered for reversed channels
+typedef struct {
+    float   positive;
+    float   negative;
+    int16_t neutral;
+    int16_t low;
+    int16_t high;
+} ChannelScale_t;
+
+// MixerSettings and ActuatorSettings compiled for the actuator loop, rebuilt
+// only when the settings change
+typedef struct {
+    float  matrix[MAX_MIX_ACTUATORS][MIXER_INPUTS]; // mixer vectors, already divided by 128
+    uint8_t type[MAX_MIX_ACTUATORS];
+    uint8_t nMixers;
+    uint8_t curve2Source;
+    MixerCurve_t   curve1;
+    MixerCurve_t   curve2;
+    ChannelScale_t scale[MAX_MIX_ACTUATORS];
+    float  feedForward;
+    float  invAccelTime;
+    float  invDecelTime;
+    float  maxAccel;
+} CompiledMixer_t;
+
 
 // Private variables
 static xQueueHandle queue;
 static xTaskHandle taskHandle;
 
+static CompiledMixer_t mixer;
 static float lastResult[MAX_MIX_ACTUATORS] = { 0 };
 static float filterAccumulator[MAX_MIX_ACTUATORS] = { 0 };
 static uint8_t pinsMode[MAX_MIX_ACTUATORS];
@@ -87,22 +133,16 @@ static volatile bool mixer_settings_updated;
 
 // Private functions
 static void actuatorTask(void *parameters);
-static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
+static int16_t scaleChannel(float value, const ChannelScale_t *scale);
 static void setFailsafe(const ActuatorSettingsData *actuatorSettings, const MixerSettingsData *mixerSettings);
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements);
+static void compileMixer(const MixerSettingsData *mixerSettings, const ActuatorSettingsData *actuatorSettings);
+static void compileCurve(const float *curve, MixerCurve_t *compiled);
+static float MixerCurve(const float throttle, const MixerCurve_t *curve);
 static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSettingsData *actuatorSettings);
 static void actuator_update_rate_if_changed(const ActuatorSettingsData *actuatorSettings, bool force_update);
 static void MixerSettingsUpdatedCb(UAVObjEvent *ev);
 static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired,
-                   const float period);
-
-// this structure is equivalent to the UAVObjects for one mixer.
-typedef struct {
-    uint8_t type;
-    int8_t  matrix[5];
-} __attribute__((packed)) Mixer_t;
+static float ProcessMixer(const int index, const float *input, const float period);
 
 /**
  * @brief Module initialization
@@ -179,6 +219,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     MixerStatusData mixerStatus;
     FlightStatusData flightStatus;
     SystemSettingsThrustControlOptions thrustType;
+    uint32_t systemSettingsChange = 0;
     float throttleDesired;
     float collectiveDesired;
 
@@ -195,6 +236,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     MixerSettingsData mixerSettings;
     mixer_settings_updated = false;
     MixerSettingsGet(&mixerSettings);
+    compileMixer(&mixerSettings, &actuatorSettings);
 
     /* Force an initial configuration of the actuator update rates */
     actuator_update_rate_if_changed(&actuatorSettings, true);
@@ -215,14 +257,17 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         PIOS_Instrumentation_TimeStart(counter);
 #endif
         /* Process settings updated events even in timeout case so we always act on the latest settings */
-        if (actuator_settings_updated) {
-            actuator_settings_updated = false;
-            ActuatorSettingsGet(&actuatorSettings);
-            actuator_update_rate_if_changed(&actuatorSettings, false);
-        }
-        if (mixer_settings_updated) {
-            mixer_settings_updated = false;
-            MixerSettingsGet(&mixerSettings);
+        if (actuator_settings_updated || mixer_settings_updated) {
+            if (actuator_settings_updated) {
+                actuator_settings_updated = false;
+                ActuatorSettingsGet(&actuatorSettings);
+                actuator_update_rate_if_changed(&actuatorSettings, false);
+            }
+            if (mixer_settings_updated) {
+                mixer_settings_updated = false;
+                MixerSettingsGet(&mixerSettings);
+            }
+            compileMixer(&mixerSettings, &actuatorSettings);
         }
 
         if (rc != pdTRUE) {
@@ -240,7 +285,9 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         FlightStatusGet(&flightStatus);
         ActuatorDesiredGet(&desired);
         ActuatorCommandGet(&command);
-        SystemSettingsThrustControlGet(&thrustType);
+        if (SystemSettingsChanged(&systemSettingsChange)) {
+            SystemSettingsThrustControlGet(&thrustType);
+        }
 
         // read in throttle and collective -demultiplex thrust
         switch (thrustType) {
@@ -279,14 +326,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 #ifdef DIAG_MIXERSTATUS
         MixerStatusGet(&mixerStatus);
 #endif
-        int nMixers     = 0;
-        Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-            if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                nMixers++;
-            }
-        }
-        if ((nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
+        if ((mixer.nMixers < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
             setFailsafe(&actuatorSettings, &mixerSettings); // So that channels like PWM buzzer keep working
             continue;
         }
@@ -297,28 +337,26 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         bool positiveThrottle = (throttleDesired > 0.00f);
         bool spinWhileArmed   = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
 
-        float curve1 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM);
+        float curve1 = MixerCurve(throttleDesired, &mixer.curve1);
 
         // The source for the secondary curve is selectable
         float curve2 = 0;
         AccessoryDesiredData accessory;
-        switch (mixerSettings.Curve2Source) {
+        switch (mixer.curve2Source) {
         case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
-            curve2 = MixerCurve(throttleDesired, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(throttleDesired, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ROLL:
-            curve2 = MixerCurve(desired.Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Roll, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_PITCH:
-            curve2 = MixerCurve(desired.Pitch, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Pitch, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_YAW:
-            curve2 = MixerCurve(desired.Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(desired.Yaw, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE:
-            curve2 = MixerCurve(collectiveDesired, mixerSettings.ThrottleCurve2,
-                                MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            curve2 = MixerCurve(collectiveDesired, &mixer.curve2);
             break;
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
@@ -326,14 +364,23 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY3:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
         case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
-            if (AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
-                curve2 = MixerCurve(accessory.AccessoryVal, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM);
+            if (AccessoryDesiredInstGet(mixer.curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
+                curve2 = MixerCurve(accessory.AccessoryVal, &mixer.curve2);
             } else {
                 curve2 = 0;
             }
             break;
         }
 
+        // input vector in the order of the mixer vector elements
+        const float input[MIXER_INPUTS] = {
+            [MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1,
+            [MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2,
+            [MIXERSETTINGS_MIXER1VECTOR_ROLL]  = desired.Roll,
+            [MIXERSETTINGS_MIXER1VECTOR_PITCH] = desired.Pitch,
+            [MIXERSETTINGS_MIXER1VECTOR_YAW]   = desired.Yaw,
+        };
+
         float *status = (float *)&mixerStatus; // access status objects as an array of floats
 
         for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
@@ -343,20 +390,20 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             // Setting it to 1 by default means "Rescale this channel and enable PWM on its output".
             command.Channel[ct] = 1;
 
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            if (mixer.type[ct] == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
                 // Set to minimum if disabled.  This is not the same as saying PWM pulse = 0 us
                 status[ct] = -1;
                 continue;
             }
 
-            if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
-                status[ct] = ProcessMixer(ct, curve1, curve2, &mixerSettings, &desired, dTSeconds);
+            if ((mixer.type[ct] == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixer.type[ct] == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) || (mixer.type[ct] == MIXERSETTINGS_MIXER1TYPE_SERVO)) {
+                status[ct] = ProcessMixer(ct, input, dTSeconds);
             } else {
                 status[ct] = -1;
             }
 
             // Motors have additional protection for when to be on
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+            if (mixer.type[ct] == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
                 // If not armed or motors aren't meant to spin all the time
                 if (!armed ||
                     (!spinWhileArmed && !positiveThrottle)) {
@@ -372,7 +419,7 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             }
 
             // Reversable Motors are like Motors but go to neutral instead of minimum
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
+            if (mixer.type[ct] == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
                 // If not armed or motor is inactive - no "spinwhilearmed" for this engine type
                 if (!armed || !activeThrottle) {
                     filterAccumulator[ct] = 0;
@@ -387,20 +434,20 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
             // these also will not be updated in failsafe mode.  I'm not sure what
             // the correct behavior is since it seems domain specific.  I don't love
             // this code
-            if ((mixers[ct].type >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
-                (mixers[ct].type <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
-                if (AccessoryDesiredInstGet(mixers[ct].type - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
+            if ((mixer.type[ct] >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
+                (mixer.type[ct] <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
+                if (AccessoryDesiredInstGet(mixer.type[ct] - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
                     status[ct] = accessory.AccessoryVal;
                 } else {
                     status[ct] = -1;
                 }
             }
 
-            if ((mixers[ct].type >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
-                (mixers[ct].type <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
+            if ((mixer.type[ct] >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
+                (mixer.type[ct] <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
                 CameraDesiredData cameraDesired;
                 if (CameraDesiredGet(&cameraDesired) == 0) {
-                    switch (mixers[ct].type) {
+                    switch (mixer.type[ct]) {
                     case MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1:
                         status[ct] = cameraDesired.RollOrServo1;
                         break;
@@ -428,29 +475,17 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
         // will be set except explicitly disabled (which will have PWM pulse = 0).
         for (int i = 0; i < MAX_MIX_ACTUATORS; i++) {
             if (command.Channel[i]) {
-                command.Channel[i] = scaleChannel(status[i],
-                                                  actuatorSettings.ChannelMax[i],
-                                                  actuatorSettings.ChannelMin[i],
-                                                  actuatorSettings.ChannelNeutral[i]);
+                command.Channel[i] = scaleChannel(status[i], &mixer.scale[i]);
             }
         }
 
-        // Store update time
-        command.UpdateTime = dTMilliseconds;
-        if (command.UpdateTime > command.MaxUpdateTime) {
-            command.MaxUpdateTime = command.UpdateTime;
+        // Use the channels set by the GCS when read only (eg. during servo configuration)
+        if (ActuatorCommandReadOnly()) {
+            ActuatorCommandChannelGet(command.Channel);
         }
-        // Update output object
-        ActuatorCommandSet(&command);
-        // Update in case read only (eg. during servo configuration)
-        ActuatorCommandGet(&command);
-
-#ifdef DIAG_MIXERSTATUS
-        MixerStatusSet(&mixerStatus);
-#endif
 
-
-        // Update servo outputs
+        // Update servo outputs before the object updates, the synchronous
+        // bank modes emit their pulses right from PIOS_Servo_Update()
         bool success = true;
 
         for (int n = 0; n < ACTUATORCOMMAND_CHANNEL_NUMELEM; ++n) {
@@ -459,11 +494,29 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
         PIOS_Servo_Update();
 
+        // from the gyro sample to the outputs
+        uint32_t latency = PIOS_DELAY_DiffuS(fastloop_sample_time());
+        command.Latency = latency > UINT16_MAX ? UINT16_MAX : latency;
+        if (command.Latency > command.MaxLatency) {
+            command.MaxLatency = command.Latency;
+        }
+
+        // Store update time
+        command.UpdateTime = dTMilliseconds;
+        if (command.UpdateTime > command.MaxUpdateTime) {
+            command.MaxUpdateTime = command.UpdateTime;
+        }
+
         if (!success) {
             command.NumFailedUpdates++;
-            ActuatorCommandSet(&command);
             AlarmsSet(SYSTEMALARMS_ALARM_ACTUATOR, SYSTEMALARMS_ALARM_CRITICAL);
         }
+        // Update output object
+        ActuatorCommandSet(&command);
+
+#ifdef DIAG_MIXERSTATUS
+        MixerStatusSet(&mixerStatus);
+#endif
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
         PIOS_Instrumentation_TimeEnd(counter);
 #endif
@@ -471,54 +524,80 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 }
 
 
+/**
+ * Compile the mixer settings into the matrix, curve tables and channel scales
+ * used by the actuator loop
+ */
+static void compileMixer(const MixerSettingsData *mixerSettings, const ActuatorSettingsData *actuatorSettings)
+{
+    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
+
+    mixer.nMixers = 0;
+    for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+        mixer.type[ct] = mixers[ct].type;
+        if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            mixer.nMixers++;
+        }
+        for (int i = 0; i < MIXER_INPUTS; i++) {
+            mixer.matrix[ct][i] = (float)mixers[ct].matrix[i] * (1.0f / 128.0f);
+        }
+
+        int16_t max     = actuatorSettings->ChannelMax[ct];
+        int16_t min     = actuatorSettings->ChannelMin[ct];
+        int16_t neutral = actuatorSettings->ChannelNeutral[ct];
+        mixer.scale[ct].positive = (float)(max - neutral);
+        mixer.scale[ct].negative = (float)(neutral - min);
+        mixer.scale[ct].neutral  = neutral;
+        mixer.scale[ct].low  = max > min ? min : max;
+        mixer.scale[ct].high = max > min ? max : min;
+    }
+
+    mixer.curve2Source = mixerSettings->Curve2Source;
+    compileCurve(mixerSettings->ThrottleCurve1, &mixer.curve1);
+    compileCurve(mixerSettings->ThrottleCurve2, &mixer.curve2);
+
+    // a zero time gives an infinite inverse, the filter then settles within one period as before
+    mixer.feedForward  = mixerSettings->FeedForward;
+    mixer.invAccelTime = 1.0f / mixerSettings->AccelTime;
+    mixer.invDecelTime = 1.0f / mixerSettings->DecelTime;
+    mixer.maxAccel     = mixerSettings->MaxAccel;
+}
+
+
 /**
  * Process mixing for one actuator
  */
-float ProcessMixer(const int index, const float curve1, const float curve2,
-                   const MixerSettingsData *mixerSettings, ActuatorDesiredData *desired, const float period)
+static float ProcessMixer(const int index, const float *input, const float period)
 {
     static float lastFilteredResult[MAX_MIX_ACTUATORS];
-    const Mixer_t *mixers = (Mixer_t *)&mixerSettings->Mixer1Type; // pointer to array of mixers in UAVObjects
-    const Mixer_t *mixer  = &mixers[index];
+    const float *row = mixer.matrix[index];
 
-    float result = ((((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1]) * curve1) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2]) * curve2) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL]) * desired->Roll) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH]) * desired->Pitch) +
-                    (((float)mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW]) * desired->Yaw)) / 128.0f;
+    float result = row[0] * input[0] + row[1] * input[1] + row[2] * input[2] + row[3] * input[3] + row[4] * input[4];
 
     // note: no feedforward for reversable motors yet for safety reasons
-    if (mixer->type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+    if (mixer.type[index] == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
         if (result < 0.0f) { // idle throttle
             result = 0.0f;
         }
 
         // feed forward
         float accumulator = filterAccumulator[index];
-        accumulator += (result - lastResult[index]) * mixerSettings->FeedForward;
+        accumulator += (result - lastResult[index]) * mixer.feedForward;
         lastResult[index] = result;
         result += accumulator;
         if (period > 0.0f) {
-            if (accumulator > 0.0f) {
-                float invFilter = period / mixerSettings->AccelTime;
-                if (invFilter > 1) {
-                    invFilter = 1;
-                }
-                accumulator -= accumulator * invFilter;
-            } else {
-                float invFilter = period / mixerSettings->DecelTime;
-                if (invFilter > 1) {
-                    invFilter = 1;
-                }
-                accumulator -= accumulator * invFilter;
+            float invFilter = period * (accumulator > 0.0f ? mixer.invAccelTime : mixer.invDecelTime);
+            if (invFilter > 1) {
+                invFilter = 1;
             }
+            accumulator -= accumulator * invFilter;
         }
         filterAccumulator[index] = accumulator;
         result += accumulator;
 
         // acceleration limit
         float dt    = result - lastFilteredResult[index];
-        float maxDt = mixerSettings->MaxAccel * period;
+        float maxDt = mixer.maxAccel * period;
         if (dt > maxDt) { // we are accelerating too hard
             result = lastFilteredResult[index] + maxDt;
         }
@@ -529,62 +608,56 @@ float ProcessMixer(const int index, const float curve1, const float curve2,
 }
 
 
+/**
+ * Turn the curve points into segments, curve[i] * (1 - s) + curve[i + 1] * s
+ * becomes base[i] + slope[i] * s
+ */
+static void compileCurve(const float *curve, MixerCurve_t *compiled)
+{
+    compiled->passthrough = curve[0] < -1;
+    for (int i = 0; i < MIXER_CURVE_NUMELEM - 1; i++) {
+        compiled->base[i]  = curve[i];
+        compiled->slope[i] = curve[i + 1] - curve[i];
+    }
+    compiled->base[MIXER_CURVE_NUMELEM - 1]  = curve[MIXER_CURVE_NUMELEM - 1];
+    compiled->slope[MIXER_CURVE_NUMELEM - 1] = 0.0f;
+}
+
+
 /**
  * Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
  * Output is in the range 0 to 1.
  */
-static float MixerCurve(const float throttle, const float *curve, uint8_t elements)
+static float MixerCurve(const float throttle, const MixerCurve_t *curve)
 {
-    float scale = throttle * (float)(elements - 1);
-    int idx1    = scale;
-
-    scale -= (float)idx1; // remainder
-    if (curve[0] < -1) {
+    if (curve->passthrough) {
         return throttle;
     }
-    if (idx1 < 0) {
-        idx1  = 0; // clamp to lowest entry in table
-        scale = 0;
+    float scale = throttle * (float)(MIXER_CURVE_NUMELEM - 1);
+    int idx     = scale;
+
+    if (idx < 0) {
+        return curve->base[0]; // clamp to lowest entry in table
     }
-    int idx2 = idx1 + 1;
-    if (idx2 >= elements) {
-        idx2 = elements - 1; // clamp to highest entry in table
-        if (idx1 >= elements) {
-            idx1 = elements - 1;
-        }
+    if (idx > MIXER_CURVE_NUMELEM - 1) {
+        idx = MIXER_CURVE_NUMELEM - 1; // clamp to highest entry in table
     }
-    return curve[idx1] * (1.0f - scale) + curve[idx2] * scale;
+    return curve->base[idx] + curve->slope[idx] * (scale - (float)idx);
 }
 
 
 /**
  * Convert channel from -1/+1 to servo pulse duration in microseconds
  */
-static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral)
+static int16_t scaleChannel(float value, const ChannelScale_t *scale)
 {
-    int16_t valueScaled;
+    int16_t valueScaled = (int16_t)(value * (value >= 0.0f ? scale->positive : scale->negative)) + scale->neutral;
 
-    // Scale
-    if (value >= 0.0f) {
-        valueScaled = (int16_t)(value * ((float)(max - neutral))) + neutral;
-    } else {
-        valueScaled = (int16_t)(value * ((float)(neutral - min))) + neutral;
+    if (valueScaled > scale->high) {
+        valueScaled = scale->high;
     }
-
-    if (max > min) {
-        if (valueScaled > max) {
-            valueScaled = max;
-        }
-        if (valueScaled < min) {
-            valueScaled = min;
-        }
-    } else {
-        if (valueScaled < max) {
-            valueScaled = max;
-        }
-        if (valueScaled > min) {
-            valueScaled = min;
-        }
+    if (valueScaled < scale->low) {
+        valueScaled = scale->low;
     }
 
     return valueScaled;
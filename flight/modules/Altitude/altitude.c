@@ -34,6 +34,12 @@
  *
  * This module will periodically update the value of the BaroSensor object.
  *
+ * There is no task, a callback walks through the BMP085 conversions and is
+ * scheduled again for when the running one completes. Pressure is converted
+ * back to back, the temperature (only needed for compensation) every
+ * BARO_TEMP_INTERLEAVE pressure conversions, so samples come at the sensor
+ * rate and evenly spaced.
+ *
  */
 
 #include <openpilot.h>
@@ -46,31 +52,58 @@
 #if defined(PIOS_INCLUDE_HCSR04)
 #include "sonaraltitude.h" // object that will be updated by the module
 #endif
-#include "taskinfo.h"
+#include "callbackinfo.h"
 
 // Private constants
-#define STACK_SIZE_BYTES 500
-#define TASK_PRIORITY    (tskIDLE_PRIORITY + 1)
-#define UPDATE_PERIOD    50
+#define STACK_SIZE_BYTES     500
+#define CALLBACK_PRIORITY    CALLBACK_PRIORITY_REGULAR
+#define CBTASK_PRIORITY      CALLBACK_TASK_AUXILIARY
+#define UPDATE_PERIOD        50
+
+// BMP085 conversion times (datasheet 4.5ms and 25.5ms at the oversampling used)
+#define BARO_TEMP_CONV_MS    5
+#define BARO_PRES_CONV_MS    26
+// pressure conversions per temperature conversion
+#define BARO_TEMP_INTERLEAVE 10
 
 // Private types
+#if defined(PIOS_INCLUDE_BMP085)
+typedef enum {
+    BARO_STATE_START,
+    BARO_STATE_TEMPERATURE,
+    BARO_STATE_PRESSURE,
+} BaroState;
+#endif
 
 // Private variables
-static xTaskHandle taskHandle;
+static DelayedCallbackInfo *callbackHandle;
 
 // down sampling variables
 #if defined(PIOS_INCLUDE_BMP085)
 #define alt_ds_size 4
-static int32_t alt_ds_temp = 0;
 static int32_t alt_ds_pres = 0;
 static int alt_ds_count    = 0;
+static BaroState baro_state;
+static uint8_t baro_temp_countdown;
+#endif
+
+#if defined(PIOS_INCLUDE_HCSR04)
+static uint32_t sonar_last_update;
+static int32_t sonar_timeout;
+static float sonar_height;
 #endif
 
 static bool altitudeEnabled;
 static uint8_t hwsettings_rcvrport;;
 
 // Private functions
-static void altitudeTask(void *parameters);
+static void altitudeCb(void);
+#if defined(PIOS_INCLUDE_BMP085)
+static uint32_t updateBaro(void);
+#endif
+#if defined(PIOS_INCLUDE_HCSR04)
+static void updateSonar(void);
+#endif
 
 /**
  * Initialise the module, called on startup
@@ -81,14 +114,18 @@ int32_t AltitudeStart()
     if (altitudeEnabled) {
 #if defined(PIOS_INCLUDE_BMP085)
         BaroSensorInitialize();
+        PIOS_BMP085_Init();
 #endif
 #if defined(PIOS_INCLUDE_HCSR04)
         SonarAltitudeInitialize();
+        if (hwsettings_rcvrport == HWSETTINGS_CC_RCVRPORT_DISABLED) {
+            PIOS_HCSR04_Trigger();
+        }
+        sonar_last_update = PIOS_DELAY_GetRaw();
 #endif
 
-        // Start main task
-        xTaskCreate(altitudeTask, (signed char *)"Altitude", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &taskHandle);
-        PIOS_TASK_MONITOR_RegisterTask(TASKINFO_RUNNING_ALTITUDE, taskHandle);
+        callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&altitudeCb, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_ALTITUDE, STACK_SIZE_BYTES);
+        PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
         return 0;
     }
     return -1;
@@ -115,105 +152,136 @@ int32_t AltitudeInitialize()
 
 #if defined(PIOS_INCLUDE_BMP085)
     // init down-sampling data
-    alt_ds_temp  = 0;
     alt_ds_pres  = 0;
     alt_ds_count = 0;
+    baro_state   = BARO_STATE_START;
+    baro_temp_countdown = 0;
+#endif
+#if defined(PIOS_INCLUDE_HCSR04)
+    sonar_timeout = 5;
+    sonar_height  = 0;
 #endif
     HwSettingsCC_RcvrPortGet(&hwsettings_rcvrport);
     return 0;
 }
 MODULE_INITCALL(AltitudeInitialize, AltitudeStart);
+
 /**
- * Module thread, should not return.
+ * Module callback, runs when the conversion started last time completes
  */
-static void altitudeTask(__attribute__((unused)) void *parameters)
+static void altitudeCb(void)
 {
-    portTickType lastSysTime;
+    uint32_t delay = UPDATE_PERIOD;
 
 #if defined(PIOS_INCLUDE_HCSR04)
-    SonarAltitudeData sonardata;
-    int32_t value = 0, timeout = 5;
-    float coeff   = 0.25, height_out = 0, height_in = 0;
-    if (hwsettings_rcvrport == HWSETTINGS_CC_RCVRPORT_DISABLED) {
-        PIOS_HCSR04_Trigger();
+    if (PIOS_DELAY_DiffuS(sonar_last_update) >= UPDATE_PERIOD * 1000) {
+        sonar_last_update = PIOS_DELAY_GetRaw();
+        updateSonar();
     }
 #endif
 #if defined(PIOS_INCLUDE_BMP085)
-    BaroSensorData data;
-    PIOS_BMP085_Init();
+    delay = updateBaro();
 #endif
 
-    // Main task loop
-    lastSysTime = xTaskGetTickCount();
-    while (1) {
+    PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, delay, CALLBACK_UPDATEMODE_OVERRIDE);
+}
+
 #if defined(PIOS_INCLUDE_HCSR04)
-        // Compute the current altitude
-        if (hwsettings_rcvrport == HWSETTINGS_CC_RCVRPORT_DISABLED) {
-            if (PIOS_HCSR04_Completed()) {
-                value = PIOS_HCSR04_Get();
-                // from 3.4cm to 5.1m
-                if ((value > 100) && (value < 15000)) {
-                    height_in  = value * 0.00034f / 2.0f;
-                    height_out = (height_out * (1 - coeff)) + (height_in * coeff);
-                    sonardata.Altitude = height_out; // m/us
-                }
-
-                // Update the AltitudeActual UAVObject
-                SonarAltitudeSet(&sonardata);
-                timeout = 5;
-                PIOS_HCSR04_Trigger();
-            }
-            if (!(timeout--)) {
-                // retrigger
-                timeout = 5;
-                PIOS_HCSR04_Trigger();
-            }
+/**
+ * Read the sonar if its measurement completed and trigger the next one
+ */
+static void updateSonar(void)
+{
+    SonarAltitudeData sonardata;
+    const float coeff = 0.25f;
+
+    // Compute the current altitude
+    if (hwsettings_rcvrport != HWSETTINGS_CC_RCVRPORT_DISABLED) {
+        return;
+    }
+    if (PIOS_HCSR04_Completed()) {
+        int32_t value = PIOS_HCSR04_Get();
+        // from 3.4cm to 5.1m
+        if ((value > 100) && (value < 15000)) {
+            float height_in = value * 0.00034f / 2.0f;
+            sonar_height = (sonar_height * (1 - coeff)) + (height_in * coeff);
         }
+        sonardata.Altitude = sonar_height; // m/us
+
+        // Update the AltitudeActual UAVObject
+        SonarAltitudeSet(&sonardata);
+        sonar_timeout = 5;
+        PIOS_HCSR04_Trigger();
+    }
+    if (!(sonar_timeout--)) {
+        // retrigger
+        sonar_timeout = 5;
+        PIOS_HCSR04_Trigger();
+    }
+}
 #endif /* if defined(PIOS_INCLUDE_HCSR04) */
+
 #if defined(PIOS_INCLUDE_BMP085)
-        // Update the temperature data
-        PIOS_BMP085_StartADC(TemperatureConv);
+/**
+ * Collect the conversion that completed and start the next one
+ * \returns time in ms until the next conversion completes
+ */
+static uint32_t updateBaro(void)
+{
 #ifdef PIOS_BMP085_HAS_GPIOS
-        xSemaphoreTake(PIOS_BMP085_EOC, portMAX_DELAY);
-#else
-        vTaskDelay(5 / portTICK_RATE_MS);
+    // the datasheet time is a maximum, the EOC line tells when it is done
+    if (baro_state != BARO_STATE_START && xSemaphoreTake(PIOS_BMP085_EOC, 0) != pdTRUE) {
+        return 1;
+    }
 #endif
+
+    switch (baro_state) {
+    case BARO_STATE_START:
+        break;
+
+    case BARO_STATE_TEMPERATURE:
+        // Update the temperature data
         PIOS_BMP085_ReadADC();
-        alt_ds_temp += PIOS_BMP085_GetTemperature();
+        break;
 
+    case BARO_STATE_PRESSURE:
         // Update the pressure data
-        PIOS_BMP085_StartADC(PressureConv);
-#ifdef PIOS_BMP085_HAS_GPIOS
-        xSemaphoreTake(PIOS_BMP085_EOC, portMAX_DELAY);
-#else
-        vTaskDelay(26 / portTICK_RATE_MS);
-#endif
         PIOS_BMP085_ReadADC();
         alt_ds_pres += PIOS_BMP085_GetPressure();
 
         if (++alt_ds_count >= alt_ds_size) {
-            alt_ds_count     = 0;
+            BaroSensorData data;
 
             // Convert from 1/10ths of degC to degC
-            data.Temperature = alt_ds_temp / (10.0 * alt_ds_size);
-            alt_ds_temp   = 0;
+            data.Temperature = PIOS_BMP085_GetTemperature() / 10.0f;
 
             // Convert from Pa to kPa
-            data.Pressure = alt_ds_pres / (1000.0f * alt_ds_size);
-            alt_ds_pres   = 0;
+            data.Pressure    = alt_ds_pres / (1000.0f * alt_ds_size);
+            alt_ds_count     = 0;
+            alt_ds_pres      = 0;
 
             // Compute the current altitude (all pressures in kPa)
-            data.Altitude = 44330.0 * (1.0 - powf((data.Pressure / (BMP085_P0 / 1000.0)), (1.0 / 5.255)));
+            data.Altitude    = 44330.0f * (1.0f - powf((data.Pressure / (BMP085_P0 / 1000.0f)), (1.0f / 5.255f)));
 
             // Update the AltitudeActual UAVObject
             BaroSensorSet(&data);
         }
-#endif /* if defined(PIOS_INCLUDE_BMP085) */
+        break;
+    }
 
-        // Delay until it is time to read the next sample
-        vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD / portTICK_RATE_MS);
+    // Temperature only feeds the pressure compensation, it changes slowly
+    if (baro_temp_countdown == 0) {
+        baro_temp_countdown = BARO_TEMP_INTERLEAVE;
+        baro_state = BARO_STATE_TEMPERATURE;
+        PIOS_BMP085_StartADC(TemperatureConv);
+        return BARO_TEMP_CONV_MS;
     }
+    baro_temp_countdown--;
+    baro_state = BARO_STATE_PRESSURE;
+    PIOS_BMP085_StartADC(PressureConv);
+    return BARO_PRES_CONV_MS;
 }
+#endif /* if defined(PIOS_INCLUDE_BMP085) */
 
 /**
  * @}
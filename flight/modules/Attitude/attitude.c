@@ -71,6 +71,7 @@
 #include <mathmisc.h>
 #include <pios_constants.h>
 #include <pios_instrumentation_helper.h>
+#include <fastloop.h>
 
 PERF_DEFINE_COUNTER(counterUpd);
 PERF_DEFINE_COUNTER(counterAccelSamples);
@@ -164,7 +165,6 @@ int32_t const MAX_TRIM_FLIGHT_SAMPLES = 65535;
 #define STD_CC_ANALOG_GYRO_NEUTRAL 1665
 #define STD_CC_ANALOG_GYRO_GAIN    0.42f
 
-static struct PIOS_SENSORS_3Axis_SensorsWithTemp *mpu6000_data = NULL;
 
 // Used to detect CC vs CC3D
 static const struct pios_board_info *bdinfo = &pios_board_info_blob;
@@ -246,8 +246,7 @@ static void AttitudeTask(__attribute__((unused)) void *parameters)
     if (cc3d) {
 #if defined(PIOS_INCLUDE_MPU6000)
 
-        gyro_test    = PIOS_MPU6000_Driver.test(0);
-        mpu6000_data = pios_malloc(sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16) * 2);
+        gyro_test = PIOS_MPU6000_Driver.test(0);
 #endif
     } else {
 #if defined(PIOS_INCLUDE_ADXL345)
@@ -455,7 +454,9 @@ static int32_t updateSensors(AccelStateData *accelState, GyroStateData *gyros)
     gyro_correct_int[2] += -gyros->z * yawBiasRate;
     PERF_TIMED_SECTION_END(counterUpd);
 
-    GyroStateSet(gyros);
+    if (!fastloop_gyro(&gyros->x)) {
+        GyroStateSet(gyros);
+    }
     AccelStateSet(accelState);
 
     return 0;
@@ -475,9 +476,10 @@ static int32_t updateSensorsCC3D(AccelStateData *accelStateData, GyroStateData *
 
 #if defined(PIOS_INCLUDE_MPU6000)
 
-    xQueueHandle queue = PIOS_MPU6000_Driver.get_queue(0);
-    BaseType_t ret     = xQueueReceive(queue, (void *)mpu6000_data, sensor_period_ms);
-    while (ret == pdTRUE) {
+    PIOS_SENSORS_Ring *ring = PIOS_MPU6000_Driver.get_ring(0);
+    const PIOS_SENSORS_3Axis_SensorsWithTemp *mpu6000_data;
+    PIOS_SENSORS_RingWait(ring, sensor_period_ms / portTICK_PERIOD_MS);
+    while ((mpu6000_data = PIOS_SENSORS_RingPeek(ring)) != NULL) {
         gyros[0]  += mpu6000_data->sample[1].x;
         gyros[1]  += mpu6000_data->sample[1].y;
         gyros[2]  += mpu6000_data->sample[1].z;
@@ -489,8 +491,7 @@ static int32_t updateSensorsCC3D(AccelStateData *accelStateData, GyroStateData *
         temp += mpu6000_data->temperature;
 
         count++;
-        // check if further samples are already in queue
-        ret = xQueueReceive(queue, (void *)mpu6000_data, 0);
+        PIOS_SENSORS_RingRelease(ring);
     }
     PERF_TRACK_VALUE(counterAccelSamples, count);
 
@@ -585,7 +586,9 @@ static int32_t updateSensorsCC3D(AccelStateData *accelStateData, GyroStateData *
     // and make it average zero (weakly)
     gyro_correct_int[2] += -gyrosData->z * yawBiasRate;
     PERF_TIMED_SECTION_END(counterUpd);
-    GyroStateSet(gyrosData);
+    if (!fastloop_gyro(&gyrosData->x)) {
+        GyroStateSet(gyrosData);
+    }
     AccelStateSet(accelStateData);
 
     return 0;
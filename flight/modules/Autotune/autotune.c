@@ -49,8 +49,12 @@
  */
 
 #include <openpilot.h>
+#include <fastloop.h>
+#include <fft.h>
 
+#include "actuatordesired.h"
 #include "flightstatus.h"
+#include "gyrostate.h"
 #include "hwsettings.h"
 #include "manualcontrolcommand.h"
 #include "manualcontrolsettings.h"
@@ -64,6 +68,14 @@
 #define STACK_SIZE_BYTES 1024
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 2)
 
+// Samples of one analysis window, a power of two for the FFT. About one
+// second at the loop rate, which sets the frequency resolution.
+#define AT_SAMPLES       512
+// Windows averaged for each axis
+#define AT_WINDOWS       8
+// Lowest bin considered for the relay oscillation, below is drift
+#define AT_MIN_BIN       2
+
 // Private types
 enum AUTOTUNE_STATE { AT_INIT, AT_START, AT_ROLL, AT_PITCH, AT_FINISHED, AT_SET };
 
@@ -71,9 +83,21 @@ enum AUTOTUNE_STATE { AT_INIT, AT_START, AT_ROLL, AT_PITCH, AT_FINISHED, AT_SET
 static xTaskHandle taskHandle;
 static bool autotuneEnabled;
 
+// Capture buffers, filled by the fast loop and handed to the task once full
+static float *captureGyro;
+static float *captureActuator;
+static volatile int8_t captureAxis = -1;
+static volatile uint16_t captureCount;
+static uint32_t captureStart;
+static uint32_t captureEnd;
+
 // Private functions
 static void AutotuneTask(void *parameters);
 static void update_stabilization_settings();
+static void autotuneSample(float gyro[3]);
+static void GyroStateUpdatedCb(UAVObjEvent *ev);
+static void capture_start(int8_t axis);
+static bool analyse_window(float *period, float *gain);
 
 /**
  * Initialise the module, called on startup
@@ -108,6 +132,13 @@ int32_t AutotuneStart(void)
 {
     // Start main task if it is enabled
     if (autotuneEnabled) {
+        captureGyro     = (float *)pios_malloc(AT_SAMPLES * sizeof(float));
+        captureActuator = (float *)pios_malloc(AT_SAMPLES * sizeof(float));
+        PIOS_Assert(captureGyro && captureActuator);
+
+        fastloop_register(FASTLOOP_STAGE_MONITOR, &autotuneSample);
+        GyroStateConnectCallback(&GyroStateUpdatedCb);
+
         xTaskCreate(AutotuneTask, (signed char *)"Autotune", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &taskHandle);
 
         PIOS_TASK_MONITOR_RegisterTask(TASKINFO_RUNNING_AUTOTUNE, taskHandle);
@@ -129,6 +160,11 @@ static void AutotuneTask(__attribute__((unused)) void *parameters)
 
     portTickType lastUpdateTime = xTaskGetTickCount();
 
+    // Relay oscillation period (ms) and plant gain, accumulated over the windows of an axis
+    float periodSum = 0.0f;
+    float gainSum   = 0.0f;
+    uint8_t windows = 0;
+
     while (1) {
         PIOS_WDG_UpdateFlag(PIOS_WDG_AUTOTUNE);
         // TODO:
@@ -145,6 +181,7 @@ static void AutotuneTask(__attribute__((unused)) void *parameters)
 
         // Only allow this module to run when autotuning
         if (flightStatus.FlightMode != FLIGHTSTATUS_FLIGHTMODE_AUTOTUNE) {
+            capture_start(-1);
             state = AT_INIT;
             vTaskDelay(50);
             continue;
@@ -205,34 +242,52 @@ static void AutotuneTask(__attribute__((unused)) void *parameters)
             if (diffTime > PREPARE_TIME) {
                 state = AT_ROLL;
                 lastUpdateTime = xTaskGetTickCount();
+                periodSum = gainSum = 0.0f;
+                windows   = 0;
+                capture_start(0);
             }
             break;
 
         case AT_ROLL:
-
-            diffTime = xTaskGetTickCount() - lastUpdateTime;
-
-            // Run relay mode on the roll axis for the measurement time
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_ROLL] = rate ? STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYRATE :
-                                                                                         STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYATTITUDE;
-            if (diffTime > MEAURE_TIME) { // Move on to next state
-                state = AT_PITCH;
-                lastUpdateTime = xTaskGetTickCount();
-            }
-            break;
-
         case AT_PITCH:
+        {
+            uint8_t axis = (state == AT_ROLL) ? 0 : 1;
 
             diffTime = xTaskGetTickCount() - lastUpdateTime;
 
-            // Run relay mode on the pitch axis for the measurement time
-            stabDesired.StabilizationMode[STABILIZATIONDESIRED_STABILIZATIONMODE_PITCH] = rate ? STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYRATE :
-                                                                                          STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYATTITUDE;
-            if (diffTime > MEAURE_TIME) { // Move on to next state
-                state = AT_FINISHED;
+            // Run relay mode on the axis until enough windows are analysed or the measurement time is over
+            stabDesired.StabilizationMode[axis] = rate ? STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYRATE :
+                                                  STABILIZATIONDESIRED_STABILIZATIONMODE_RELAYATTITUDE;
+            if (captureCount >= AT_SAMPLES) {
+                float period, gain;
+                if (analyse_window(&period, &gain)) {
+                    periodSum += period;
+                    gainSum   += gain;
+                    windows++;
+                }
+                capture_start(axis);
+            }
+            if (windows >= AT_WINDOWS || diffTime > MEAURE_TIME) { // Move on to next state
+                if (windows > 0) {
+                    RelayTuningData relayTuning;
+                    RelayTuningGet(&relayTuning);
+                    relayTuning.Period[axis] = periodSum / windows;
+                    relayTuning.Gain[axis]   = gainSum / windows;
+                    RelayTuningSet(&relayTuning);
+                }
+                periodSum = gainSum = 0.0f;
+                windows   = 0;
+                if (state == AT_ROLL) {
+                    state = AT_PITCH;
+                    capture_start(1);
+                } else {
+                    state = AT_FINISHED;
+                    capture_start(-1);
+                }
                 lastUpdateTime = xTaskGetTickCount();
             }
             break;
+        }
 
         case AT_FINISHED:
 
@@ -259,6 +314,120 @@ static void AutotuneTask(__attribute__((unused)) void *parameters)
     }
 }
 
+/**
+ * Record one gyro sample and the actuator command of the axis under test,
+ * called from the fast loop after the control stage
+ */
+static void autotuneSample(float gyro[3])
+{
+    int8_t axis = captureAxis;
+
+    if (axis < 0 || captureCount >= AT_SAMPLES) {
+        return;
+    }
+
+    // the control stage only dispatched its callback, this is the command of the previous sample
+    ActuatorDesiredData actuator;
+    ActuatorDesiredGetLockless(&actuator);
+
+    uint16_t n = captureCount;
+    if (n == 0) {
+        captureStart = PIOS_DELAY_GetuS();
+    }
+    captureGyro[n]     = gyro[axis];
+    captureActuator[n] = (&actuator.Roll)[axis];
+    if (n == AT_SAMPLES - 1) {
+        captureEnd = PIOS_DELAY_GetuS();
+    }
+    captureCount = n + 1;
+}
+
+static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    GyroStateData gyroState;
+
+    // the fast loop calls autotuneSample() for every sample
+    if (fastloop_active()) {
+        return;
+    }
+    GyroStateGetLockless(&gyroState);
+    autotuneSample(&gyroState.x);
+}
+
+/**
+ * Restart the capture on an axis, -1 stops it
+ */
+static void capture_start(int8_t axis)
+{
+    captureAxis  = -1;
+    captureCount = 0;
+    captureAxis  = axis;
+}
+
+/**
+ * Find the relay oscillation in a full capture window
+ * @param[out] period oscillation period in ms
+ * @param[out] gain plant gain at the oscillation frequency, gyro over actuator amplitude
+ * @returns false if there is no oscillation in the window
+ */
+static bool analyse_window(float *period, float *gain)
+{
+    float dT = (captureEnd - captureStart) * 1e-6f / (AT_SAMPLES - 1);
+    float meanGyro = 0.0f;
+    float meanActuator = 0.0f;
+    uint16_t k;
+
+    if (dT <= 0.0f) {
+        return false;
+    }
+
+    // remove the offsets and apply a Hann window, the same to both signals so it drops out of the gain
+    for (k = 0; k < AT_SAMPLES; k++) {
+        meanGyro     += captureGyro[k];
+        meanActuator += captureActuator[k];
+    }
+    meanGyro     /= AT_SAMPLES;
+    meanActuator /= AT_SAMPLES;
+    for (k = 0; k < AT_SAMPLES; k++) {
+        float w = 0.5f - 0.5f * cosf(2.0f * M_PI_F * k / (AT_SAMPLES - 1));
+        captureGyro[k]     = (captureGyro[k] - meanGyro) * w;
+        captureActuator[k] = (captureActuator[k] - meanActuator) * w;
+    }
+
+    // both real signals go through one complex transform, gyro as real and actuator as imaginary part
+    fft_complex(captureGyro, captureActuator, AT_SAMPLES);
+
+    // the relay switches the actuator, its fundamental is the strongest bin of the actuator spectrum
+    float G[2], A[2];
+    float power[3] = { 0.0f, 0.0f, 0.0f };
+    float peakPower = 0.0f;
+    uint16_t peak   = 0;
+    for (k = AT_MIN_BIN; k < AT_SAMPLES / 2; k++) {
+        fft_split_real_pair(captureGyro, captureActuator, AT_SAMPLES, k, G, A);
+        float p = A[0] * A[0] + A[1] * A[1];
+        if (p > peakPower) {
+            peakPower = p;
+            peak = k;
+        }
+    }
+    if (peak == 0 || peak + 1 >= AT_SAMPLES / 2) {
+        return false;
+    }
+
+    // refine the frequency between the bins with a parabola through the peak and its neighbours
+    for (k = 0; k < 3; k++) {
+        fft_split_real_pair(captureGyro, captureActuator, AT_SAMPLES, peak - 1 + k, G, A);
+        power[k] = sqrtf(A[0] * A[0] + A[1] * A[1]);
+    }
+    float curvature = power[0] - 2.0f * power[1] + power[2];
+    float offset    = (curvature < 0.0f) ? 0.5f * (power[0] - power[2]) / curvature : 0.0f;
+
+    fft_split_real_pair(captureGyro, captureActuator, AT_SAMPLES, peak, G, A);
+    *period = 1000.0f * AT_SAMPLES * dT / (peak + offset);
+    *gain   = sqrtf((G[0] * G[0] + G[1] * G[1]) / peakPower);
+    return true;
+}
+
 /**
  * Called after measuring roll and pitch to update the
  * stabilization settings
@@ -55,7 +55,16 @@
 //
 // Configuration
 //
-#define SAMPLE_PERIOD_MS 500
+// Samples are integrated at SAMPLE_PERIOD_MS, the state and alarms are
+// updated every PUBLISH_SAMPLES samples
+#define SAMPLE_PERIOD_MS 50
+#define PUBLISH_SAMPLES  10
+// A current step larger than this gives an internal resistance measurement
+#define IR_MIN_CURRENT_STEP   2.0f
+#define IR_MAX_RESISTANCE     1.0f
+#define IR_FILTER_GAIN        0.05f
+// Time constant of the open circuit voltage slope used for the time prediction
+#define VOLTAGE_SLOPE_TAU     30.0f
 // Private types
 
 // Private variables
@@ -68,8 +77,26 @@ static bool batteryEnabled = false;
 static int8_t voltageADCPin = -1; // ADC pin for voltage
 static int8_t currentADCPin = -1; // ADC pin for current
 
+static FlightBatterySettingsData batterySettings;
+static FlightBatteryStateData flightBatteryData;
+static volatile bool settingsUpdated = true;
+
+// Integration state
+static uint32_t lastSampleTime;
+static uint8_t samplesToPublish;
+static float lastVoltage;
+static float lastCurrent;
+// open circuit voltage slope in V/s, negative while discharging
+static float voltageSlope;
+static float lastOpenCircuitVoltage;
+static float slopeTime;
+
 // Private functions
 static void onTimer(UAVObjEvent *ev);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static void updateInternalResistance(float voltage, float current);
+static float predictFlightTime(void);
+static void updateAlarms(void);
 static int8_t GetNbCells(const FlightBatterySettingsData *batterySettings, FlightBatteryStateData *flightBatteryData);
 
 /**
@@ -115,7 +142,9 @@ int32_t BatteryInitialize(void)
         FlightBatteryStateInitialize();
         FlightBatterySettingsInitialize();
 
-        // FlightBatterySettingsConnectCallback(FlightBatterySettingsUpdatedCb);
+        FlightBatterySettingsConnectCallback(settingsUpdatedCb);
+        FlightBatteryStateGet(&flightBatteryData);
+        lastSampleTime = PIOS_DELAY_GetRaw();
 
         static UAVObjEvent ev;
 
@@ -127,16 +156,25 @@ int32_t BatteryInitialize(void)
 }
 
 MODULE_INITCALL(BatteryInitialize, 0);
-static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
+
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
-    static FlightBatterySettingsData batterySettings;
-    static FlightBatteryStateData flightBatteryData;
+    settingsUpdated = true;
+}
 
-    FlightBatterySettingsGet(&batterySettings);
-    FlightBatteryStateGet(&flightBatteryData);
+static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
+{
+    if (settingsUpdated) {
+        settingsUpdated = false;
+        FlightBatterySettingsGet(&batterySettings);
+    }
 
-    const float dT = SAMPLE_PERIOD_MS / 1000.0f;
-    float energyRemaining;
+    // integrate over the time that really passed, the event queue may be late
+    float dT = PIOS_DELAY_DiffuS(lastSampleTime) * 1.0e-6f;
+    lastSampleTime = PIOS_DELAY_GetRaw();
+    if (dT <= 0.0f || dT > 1.0f) {
+        dT = SAMPLE_PERIOD_MS / 1000.0f;
+    }
 
     // calculate the battery parameters
     if (voltageADCPin >= 0) {
@@ -145,9 +183,6 @@ static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
         flightBatteryData.Voltage = 0; // Dummy placeholder value. This is in case we get another source of battery current which is not from the ADC
     }
 
-    // voltage available: get the number of cells if possible, desired and not armed
-    GetNbCells(&batterySettings, &flightBatteryData);
-
     // ad a plausibility check: zero voltage => zero current
     if (currentADCPin >= 0 && flightBatteryData.Voltage > 0.f) {
         flightBatteryData.Current = (PIOS_ADC_PinGetVolt(currentADCPin) - batterySettings.SensorCalibrations.CurrentZero) * batterySettings.SensorCalibrations.CurrentFactor; // in Amps
@@ -160,25 +195,105 @@ static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
 
     // For safety reasons consider only positive currents in energy comsumption, i.e. no charging up.
     // necesary when sensor are not perfectly calibrated
-    if (flightBatteryData.Current > 0) {
-        flightBatteryData.ConsumedEnergy += (flightBatteryData.Current * dT * 1000.0f / 3600.0f); // in mAh
+    // Trapezoidal rule, the current is taken as linear between two samples
+    float current = (flightBatteryData.Current + lastCurrent) * 0.5f;
+    if (current > 0) {
+        flightBatteryData.ConsumedEnergy += (current * dT * 1000.0f / 3600.0f); // in mAh
     }
 
     // Apply a 2 second rise time low-pass filter to average the current
     float alpha = 1.0f - dT / (dT + 2.0f);
     flightBatteryData.AvgCurrent = alpha * flightBatteryData.AvgCurrent + (1 - alpha) * flightBatteryData.Current; // in Amps
 
+    if (currentADCPin >= 0 && voltageADCPin >= 0) {
+        updateInternalResistance(flightBatteryData.Voltage, flightBatteryData.Current);
+    }
+    lastVoltage = flightBatteryData.Voltage;
+    lastCurrent = flightBatteryData.Current;
+
+    // the voltage the pack would show without load, the sag is I * R
+    flightBatteryData.OpenCircuitVoltage = flightBatteryData.Voltage + flightBatteryData.AvgCurrent * flightBatteryData.InternalResistance;
+
+    // follow its slope over a long time, load changes do not show up in it
+    slopeTime += dT;
+    if (samplesToPublish > 0 && --samplesToPublish > 0) {
+        return;
+    }
+    samplesToPublish = PUBLISH_SAMPLES;
+
+    if (lastOpenCircuitVoltage > 0.0f && flightBatteryData.OpenCircuitVoltage > 0.0f) {
+        float slope = (flightBatteryData.OpenCircuitVoltage - lastOpenCircuitVoltage) / slopeTime;
+        voltageSlope += (slope - voltageSlope) * slopeTime / (slopeTime + VOLTAGE_SLOPE_TAU);
+    }
+    lastOpenCircuitVoltage = flightBatteryData.OpenCircuitVoltage;
+    slopeTime = 0.0f;
+
+    // voltage available: get the number of cells if possible, desired and not armed
+    GetNbCells(&batterySettings, &flightBatteryData);
+
+    flightBatteryData.EstimatedFlightTime = predictFlightTime();
+
+    updateAlarms();
+
+    FlightBatteryStateSet(&flightBatteryData);
+}
+
+/**
+ * Measure the internal resistance from the voltage drop across a current step
+ */
+static void updateInternalResistance(float voltage, float current)
+{
+    float currentStep = current - lastCurrent;
+
+    if (fabsf(currentStep) < IR_MIN_CURRENT_STEP || lastVoltage <= 0.0f) {
+        return;
+    }
+
+    float resistance = (lastVoltage - voltage) / currentStep;
+    if (resistance <= 0.0f || resistance > IR_MAX_RESISTANCE) {
+        // noise or a step that was not the load changing
+        return;
+    }
+    if (flightBatteryData.InternalResistance <= 0.0f) {
+        flightBatteryData.InternalResistance = resistance;
+    } else {
+        flightBatteryData.InternalResistance += (resistance - flightBatteryData.InternalResistance) * IR_FILTER_GAIN;
+    }
+}
+
+/**
+ * Remaining flight time in seconds, 0 when unknown. The lower of two
+ * predictions: the capacity left at the average current, and the time until
+ * the voltage under average load, open circuit voltage less the sag, reaches
+ * the alarm threshold with the open circuit voltage falling as it does now.
+ */
+static float predictFlightTime(void)
+{
     /*The motor could regenerate power. Or we could have solar cells.
        In short, is there any likelihood of measuring negative current? If it's a bad current reading we want to check, then
        it makes sense to saturate at max and min values, because a misreading could as easily be very large, as negative. The simple
        sign check doesn't catch this.*/
-    energyRemaining = batterySettings.Capacity - flightBatteryData.ConsumedEnergy; // in mAh
+    float flightTime = 0.0f;
+
     if (batterySettings.Capacity > 0 && flightBatteryData.AvgCurrent > 0) {
-        flightBatteryData.EstimatedFlightTime = (energyRemaining / (flightBatteryData.AvgCurrent * 1000.0f)) * 3600.0f; // in Sec
-    } else {
-        flightBatteryData.EstimatedFlightTime = 0;
+        float energyRemaining = batterySettings.Capacity - flightBatteryData.ConsumedEnergy; // in mAh
+        flightTime = (energyRemaining / (flightBatteryData.AvgCurrent * 1000.0f)) * 3600.0f; // in Sec
+    }
+
+    if (voltageSlope < 0.0f && flightBatteryData.InternalResistance > 0.0f && flightBatteryData.NbCells > 0) {
+        float loadedVoltage = flightBatteryData.OpenCircuitVoltage - flightBatteryData.AvgCurrent * flightBatteryData.InternalResistance;
+        float headroom = loadedVoltage - batterySettings.CellVoltageThresholds.Alarm * flightBatteryData.NbCells;
+        float voltageTime = (headroom > 0.0f) ? headroom / -voltageSlope : 0.0f;
+        if (flightTime <= 0.0f || voltageTime < flightTime) {
+            flightTime = voltageTime;
+        }
     }
 
+    return flightTime;
+}
+
+static void updateAlarms(void)
+{
     // generate alarms where needed...
     if ((flightBatteryData.Voltage <= 0) && (flightBatteryData.Current <= 0)) {
         // FIXME: There's no guarantee that a floating ADC will give 0. So this
@@ -205,8 +320,6 @@ static void onTimer(__attribute__((unused)) UAVObjEvent *ev)
             AlarmsClear(SYSTEMALARMS_ALARM_BATTERY);
         }
     }
-
-    FlightBatteryStateSet(&flightBatteryData);
 }
 
 
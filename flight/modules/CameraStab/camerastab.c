@@ -49,6 +49,7 @@
 
 #include "accessorydesired.h"
 #include "attitudestate.h"
+#include "gyrostate.h"
 #include "camerastabsettings.h"
 #include "cameradesired.h"
 #include "hwsettings.h"
@@ -56,13 +57,17 @@
 //
 // Configuration
 //
-#define SAMPLE_PERIOD_MS 10
+// outputs are computed on every attitude update, but not more often than this
+#define MIN_UPDATE_PERIOD_US 2000
+// longer gaps, e.g. while the attitude estimation restarts, count as this
+#define MAX_UPDATE_PERIOD_MS 100.0f
 
 // Private types
 
 // Private variables
 static struct CameraStab_data {
-    portTickType lastSysTime;
+    uint32_t lastSysTime;
+    CameraStabSettingsData settings;
     float inputs[CAMERASTABSETTINGS_INPUT_NUMELEM];
 
 #ifdef USE_GIMBAL_LPF
@@ -78,9 +83,10 @@ static struct CameraStab_data {
 
 // Private functions
 static void attitudeUpdated(UAVObjEvent *ev);
+static void settingsUpdated(UAVObjEvent *ev);
 
 #ifdef USE_GIMBAL_FF
-static void applyFeedForward(uint8_t index, float dT, float *attitude, CameraStabSettingsData *cameraStab);
+static void applyFeedForward(uint8_t index, float dT_millis, float attitudeDelta, float *attitude, const float *rollPitch, CameraStabSettingsData *cameraStab);
 #endif
 
 
@@ -116,19 +122,19 @@ int32_t CameraStabInitialize(void)
 
         // initialize camera state variables
         memset(csd, 0, sizeof(struct CameraStab_data));
-        csd->lastSysTime = xTaskGetTickCount();
+        csd->lastSysTime = PIOS_DELAY_GetuS();
 
         AttitudeStateInitialize();
+        GyroStateInitialize();
         CameraStabSettingsInitialize();
         CameraDesiredInitialize();
 
-        UAVObjEvent ev = {
-            .obj    = AttitudeStateHandle(),
-            .instId = 0,
-            .event  = 0,
-            .lowPriority = false,
-        };
-        EventPeriodicCallbackCreate(&ev, attitudeUpdated, SAMPLE_PERIOD_MS / portTICK_RATE_MS);
+        CameraStabSettingsConnectCallback(&settingsUpdated);
+        settingsUpdated(NULL);
+
+        // run from the attitude updates rather than a timer, the outputs follow the
+        // estimate without waiting up to a whole sample period
+        AttitudeStateConnectCallback(&attitudeUpdated);
 
         return 0;
     }
@@ -144,23 +150,45 @@ int32_t CameraStabStart(void)
 
 MODULE_INITCALL(CameraStabInitialize, CameraStabStart);
 
-static void attitudeUpdated(UAVObjEvent *ev)
+static void settingsUpdated(__attribute__((unused)) UAVObjEvent *ev)
+{
+    CameraStabSettingsGet(&csd->settings);
+}
+
+static void attitudeUpdated(__attribute__((unused)) UAVObjEvent *ev)
 {
-    if (ev->obj != AttitudeStateHandle()) {
+    // time delta between calls in ms, with microsecond resolution
+    uint32_t thisSysTime = PIOS_DELAY_GetuS();
+    uint32_t dT_us = thisSysTime - csd->lastSysTime;
+
+    if (dT_us < MIN_UPDATE_PERIOD_US) {
         return;
     }
+    csd->lastSysTime = thisSysTime;
+    float dT_millis = (float)dT_us * 0.001f;
+    if (dT_millis > MAX_UPDATE_PERIOD_MS) {
+        dT_millis = MAX_UPDATE_PERIOD_MS;
+    }
 
     AccessoryDesiredData accessory;
+    CameraStabSettingsData *cameraStab = &csd->settings;
 
-    CameraStabSettingsData cameraStab;
-    CameraStabSettingsGet(&cameraStab);
+    AttitudeStateData attitudeState;
+    AttitudeStateGet(&attitudeState);
+    const float rollPitchYaw[CAMERASTABSETTINGS_INPUT_NUMELEM] = {
+        attitudeState.Roll, attitudeState.Pitch, attitudeState.Yaw
+    };
 
-    // check how long since last update, time delta between calls in ms
-    portTickType thisSysTime = xTaskGetTickCount();
-    float dT_millis = (thisSysTime > csd->lastSysTime) ?
-                      (float)((thisSysTime - csd->lastSysTime) * portTICK_RATE_MS) :
-                      (float)SAMPLE_PERIOD_MS;
-    csd->lastSysTime = thisSysTime;
+#ifdef USE_GIMBAL_FF
+    float gyro[CAMERASTABSETTINGS_INPUT_NUMELEM] = { 0 };
+    if (cameraStab->FeedForwardSource == CAMERASTABSETTINGS_FEEDFORWARDSOURCE_GYRORATE) {
+        GyroStateData gyroState;
+        GyroStateGet(&gyroState);
+        gyro[0] = gyroState.x;
+        gyro[1] = gyroState.y;
+        gyro[2] = gyroState.z;
+    }
+#endif
 
     // storage for elevon roll component before the pitch component has been generated
     // we are guaranteed that the iteration order of i is roll pitch yaw
@@ -171,22 +199,22 @@ static void attitudeUpdated(UAVObjEvent *ev)
     // process axes
     for (uint8_t i = 0; i < CAMERASTABSETTINGS_INPUT_NUMELEM; i++) {
         // read and process control input
-        if (CameraStabSettingsInputToArray(cameraStab.Input)[i] != CAMERASTABSETTINGS_INPUT_NONE) {
-            if (AccessoryDesiredInstGet(CameraStabSettingsInputToArray(cameraStab.Input)[i] -
+        if (CameraStabSettingsInputToArray(cameraStab->Input)[i] != CAMERASTABSETTINGS_INPUT_NONE) {
+            if (AccessoryDesiredInstGet(CameraStabSettingsInputToArray(cameraStab->Input)[i] -
                                         CAMERASTABSETTINGS_INPUT_ACCESSORY0, &accessory) == 0) {
                 float input_rate;
-                switch (CameraStabSettingsStabilizationModeToArray(cameraStab.StabilizationMode)[i]) {
+                switch (CameraStabSettingsStabilizationModeToArray(cameraStab->StabilizationMode)[i]) {
                 case CAMERASTABSETTINGS_STABILIZATIONMODE_ATTITUDE:
                     csd->inputs[i] = accessory.AccessoryVal *
-                                     CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i];
+                                     CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i];
                     break;
                 case CAMERASTABSETTINGS_STABILIZATIONMODE_AXISLOCK:
                     input_rate = accessory.AccessoryVal *
-                                 CameraStabSettingsInputRateToArray(cameraStab.InputRate)[i];
-                    if (fabsf(input_rate) > cameraStab.MaxAxisLockRate) {
+                                 CameraStabSettingsInputRateToArray(cameraStab->InputRate)[i];
+                    if (fabsf(input_rate) > cameraStab->MaxAxisLockRate) {
                         csd->inputs[i] = boundf(csd->inputs[i] + input_rate * 0.001f * dT_millis,
-                                                -CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i],
-                                                CameraStabSettingsInputRangeToArray(cameraStab.InputRange)[i]);
+                                                -CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i],
+                                                CameraStabSettingsInputRangeToArray(cameraStab->InputRange)[i]);
                     }
                     break;
                 default:
@@ -196,46 +224,37 @@ static void attitudeUpdated(UAVObjEvent *ev)
         }
 
         // calculate servo output
-        float attitude;
-
-        switch (i) {
-        case CAMERASTABSETTINGS_INPUT_ROLL:
-            AttitudeStateRollGet(&attitude);
-            break;
-        case CAMERASTABSETTINGS_INPUT_PITCH:
-            AttitudeStatePitchGet(&attitude);
-            break;
-        case CAMERASTABSETTINGS_INPUT_YAW:
-            AttitudeStateYawGet(&attitude);
-            break;
-        default:
-            PIOS_Assert(0);
-        }
+        float attitude = rollPitchYaw[i];
 
 #ifdef USE_GIMBAL_LPF
-        if (CameraStabSettingsResponseTimeToArray(cameraStab.ResponseTime)[i]) {
-            float rt = (float)CameraStabSettingsResponseTimeToArray(cameraStab.ResponseTime)[i];
+        if (CameraStabSettingsResponseTimeToArray(cameraStab->ResponseTime)[i]) {
+            float rt = (float)CameraStabSettingsResponseTimeToArray(cameraStab->ResponseTime)[i];
             attitude = csd->attitudeFiltered[i] = ((rt * csd->attitudeFiltered[i]) + (dT_millis * attitude)) / (rt + dT_millis);
         }
 #endif
 
 #ifdef USE_GIMBAL_FF
-        if (CameraStabSettingsFeedForwardToArray(cameraStab.FeedForward)[i]) {
-            applyFeedForward(i, dT_millis, &attitude, &cameraStab);
+        if (CameraStabSettingsFeedForwardToArray(cameraStab->FeedForward)[i]) {
+            // the gyro gives the rate directly, the attitude has to be differentiated
+            float attitudeDelta = (cameraStab->FeedForwardSource == CAMERASTABSETTINGS_FEEDFORWARDSOURCE_GYRORATE) ?
+                                  gyro[i] * 0.001f * dT_millis :
+                                  attitude - csd->ffLastAttitude[i];
+            csd->ffLastAttitude[i] = attitude;
+            applyFeedForward(i, dT_millis, attitudeDelta, &attitude, rollPitchYaw, cameraStab);
         }
 #endif
 
         // bounding for elevon mixing occurs on the unmixed output
         // to limit the range of the mixed output you must limit the range
         // of both the unmixed pitch and unmixed roll
-        float output = boundf((attitude + csd->inputs[i]) / CameraStabSettingsOutputRangeToArray(cameraStab.OutputRange)[i], -1.0f, 1.0f);
+        float output = boundf((attitude + csd->inputs[i]) / CameraStabSettingsOutputRangeToArray(cameraStab->OutputRange)[i], -1.0f, 1.0f);
 
         // set output channels
         switch (i) {
         case CAMERASTABSETTINGS_INPUT_ROLL:
             // we are guaranteed that the iteration order of i is roll pitch yaw
             // for elevon mixing we simply grab the value for later use
-            if (cameraStab.GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
+            if (cameraStab->GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
                 elevon_roll = output;
             } else {
                 CameraDesiredRollOrServo1Set(&output);
@@ -244,14 +263,14 @@ static void attitudeUpdated(UAVObjEvent *ev)
         case CAMERASTABSETTINGS_INPUT_PITCH:
             // we are guaranteed that the iteration order of i is roll pitch yaw
             // for elevon mixing we use the value we previously grabbed and set both s1 and s2
-            if (cameraStab.GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
+            if (cameraStab->GimbalType == CAMERASTABSETTINGS_GIMBALTYPE_ROLLPITCHMIXED) {
                 float elevon_pitch = output;
                 // elevon reversing works like this:
                 // first use the normal reversing facilities to get servo 1 roll working in the correct direction
                 // then use the normal reversing facilities to get servo 2 roll working in the correct direction
                 // then use these new reversing switches to reverse servo 1 and/or 2 pitch as needed
                 // if servo 1 pitch is reversed
-                if (cameraStab.Servo1PitchReverse == CAMERASTABSETTINGS_SERVO1PITCHREVERSE_TRUE) {
+                if (cameraStab->Servo1PitchReverse == CAMERASTABSETTINGS_SERVO1PITCHREVERSE_TRUE) {
                     // use (reversed pitch) + roll
                     output = ((1.0f - elevon_pitch) + elevon_roll) / 2.0f;
                 } else {
@@ -260,7 +279,7 @@ static void attitudeUpdated(UAVObjEvent *ev)
                 }
                 CameraDesiredRollOrServo1Set(&output);
                 // if servo 2 pitch is reversed
-                if (cameraStab.Servo2PitchReverse == CAMERASTABSETTINGS_SERVO2PITCHREVERSE_TRUE) {
+                if (cameraStab->Servo2PitchReverse == CAMERASTABSETTINGS_SERVO2PITCHREVERSE_TRUE) {
                     // use (reversed pitch) - roll
                     output = ((1.0f - elevon_pitch) - elevon_roll) / 2.0f;
                 } else {
@@ -282,7 +301,7 @@ static void attitudeUpdated(UAVObjEvent *ev)
 }
 
 #ifdef USE_GIMBAL_FF
-void applyFeedForward(uint8_t index, float dT_millis, float *attitude, CameraStabSettingsData *cameraStab)
+void applyFeedForward(uint8_t index, float dT_millis, float attitudeDelta, float *attitude, const float *rollPitch, CameraStabSettingsData *cameraStab)
 {
     // compensate high feed forward values depending on gimbal type
     float gimbalTypeCorrection = 1.0f;
@@ -294,16 +313,14 @@ void applyFeedForward(uint8_t index, float dT_millis, float *attitude, CameraSta
         break;
     case CAMERASTABSETTINGS_GIMBALTYPE_YAWROLLPITCH:
         if (index == CAMERASTABSETTINGS_INPUT_ROLL) {
-            float pitch;
-            AttitudeStatePitchGet(&pitch);
+            float pitch = rollPitch[CAMERASTABSETTINGS_INPUT_PITCH];
             gimbalTypeCorrection = (cameraStab->OutputRange.Pitch - fabsf(pitch))
                                    / cameraStab->OutputRange.Pitch;
         }
         break;
     case CAMERASTABSETTINGS_GIMBALTYPE_YAWPITCHROLL:
         if (index == CAMERASTABSETTINGS_INPUT_PITCH) {
-            float roll;
-            AttitudeStateRollGet(&roll);
+            float roll = rollPitch[CAMERASTABSETTINGS_INPUT_ROLL];
             gimbalTypeCorrection = (cameraStab->OutputRange.Roll - fabsf(roll))
                                    / cameraStab->OutputRange.Roll;
         }
@@ -314,9 +331,8 @@ void applyFeedForward(uint8_t index, float dT_millis, float *attitude, CameraSta
 
     // apply feed forward
     float accumulator = csd->ffFilterAccumulator[index];
-    accumulator += (*attitude - csd->ffLastAttitude[index]) *
+    accumulator += attitudeDelta *
                    (float)CameraStabSettingsFeedForwardToArray(cameraStab->FeedForward)[index] * gimbalTypeCorrection;
-    csd->ffLastAttitude[index] = *attitude;
     *attitude   += accumulator;
 
     float filter = (float)((accumulator > 0.0f) ? CameraStabSettingsAccelTimeToArray(cameraStab->AccelTime)[index] :
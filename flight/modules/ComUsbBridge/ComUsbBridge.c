@@ -42,6 +42,7 @@
 
 static void com2UsbBridgeTask(void *parameters);
 static void usb2ComBridgeTask(void *parameters);
+static void forward(uint32_t from_port, uint32_t to_port, volatile uint32_t *tx_errors);
 static void updateSettings(UAVObjEvent *ev);
 
 // ****************
@@ -52,17 +53,12 @@ static void updateSettings(UAVObjEvent *ev);
 
 #define TASK_PRIORITY        (tskIDLE_PRIORITY + 1)
 
-#define BRIDGE_BUF_LEN       10
-
 // ****************
 // Private variables
 
 static xTaskHandle com2UsbBridgeTaskHandle;
 static xTaskHandle usb2ComBridgeTaskHandle;
 
-static uint8_t *com2usb_buf;
-static uint8_t *usb2com_buf;
-
 static uint32_t usart_port;
 static uint32_t vcp_port;
 
@@ -114,10 +110,6 @@ static int32_t comUsbBridgeInitialize(void)
 #endif
 
     if (bridge_enabled) {
-        com2usb_buf = pios_malloc(BRIDGE_BUF_LEN);
-        PIOS_Assert(com2usb_buf);
-        usb2com_buf = pios_malloc(BRIDGE_BUF_LEN);
-        PIOS_Assert(usb2com_buf);
         HwSettingsConnectCallback(&updateSettings);
         updateSettings(0);
     }
@@ -136,16 +128,7 @@ static void com2UsbBridgeTask(__attribute__((unused)) void *parameters)
     volatile uint32_t tx_errors = 0;
 
     while (1) {
-        uint32_t rx_bytes;
-
-        rx_bytes = PIOS_COM_ReceiveBuffer(usart_port, com2usb_buf, BRIDGE_BUF_LEN, 500);
-        if (rx_bytes > 0) {
-            /* Bytes available to transfer */
-            if (PIOS_COM_SendBuffer(vcp_port, com2usb_buf, rx_bytes) != (int32_t)rx_bytes) {
-                /* Error on transmit */
-                tx_errors++;
-            }
-        }
+        forward(usart_port, vcp_port, &tx_errors);
     }
 }
 
@@ -155,16 +138,28 @@ static void usb2ComBridgeTask(__attribute__((unused)) void *parameters)
     volatile uint32_t tx_errors = 0;
 
     while (1) {
-        uint32_t rx_bytes;
-
-        rx_bytes = PIOS_COM_ReceiveBuffer(vcp_port, usb2com_buf, BRIDGE_BUF_LEN, 500);
-        if (rx_bytes > 0) {
-            /* Bytes available to transfer */
-            if (PIOS_COM_SendBuffer(usart_port, usb2com_buf, rx_bytes) != (int32_t)rx_bytes) {
-                /* Error on transmit */
-                tx_errors++;
-            }
+        forward(vcp_port, usart_port, &tx_errors);
+    }
+}
+
+/**
+ * Move the received bytes of one port straight from its receive buffer into
+ * the transmit buffer of the other. They are released only once sent, so a
+ * slow receiver backs up into the sender's receive buffer and the USB side
+ * stops accepting packets instead of dropping bytes.
+ */
+static void forward(uint32_t from_port, uint32_t to_port, volatile uint32_t *tx_errors)
+{
+    const uint8_t *data;
+    uint16_t rx_bytes = PIOS_COM_ReceiveSpan(from_port, &data, 500);
+
+    if (rx_bytes > 0) {
+        /* Bytes available to transfer */
+        if (PIOS_COM_SendBuffer(to_port, data, rx_bytes) != (int32_t)rx_bytes) {
+            /* Error on transmit */
+            (*tx_errors)++;
         }
+        PIOS_COM_ReceiveRelease(from_port, rx_bytes);
     }
 }
 
@@ -34,9 +34,41 @@
 #include <stdbool.h>
 #include "hwsettings.h"
 #include "faultsettings.h"
+#include "faultstatus.h"
+#include "taskinfo.h"
 
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
+
+// Private constants
+#define STRESS_STACK_SIZE_BYTES 512
+#define BURN_STACK_SIZE_BYTES   256
+// above every module, the injected load must not be delayed by what it measures
+#define STRESS_TASK_PRIORITY    (configMAX_PRIORITIES - 1)
+#define STATUS_PERIOD_MS        1000
+// below the 250ms watchdog of the sensor task
+#define SENSOR_DELAY_MAX_MS     100
+#define I2C_READ_LEN            8
+
+// Private variables
 static bool module_enabled;
 static uint8_t active_fault;
+static FaultSettingsData stress;
+static FaultStatusData status;
+static volatile uint32_t burnTimeUs;
+
+PERF_DEFINE_COUNTER(counterBurnTime);
+PERF_DEFINE_COUNTER(counterBusHold);
+PERF_DEFINE_COUNTER(counterSensorDelay);
+PERF_DEFINE_COUNTER(counterTelemetryUpdates);
+
+// Private functions
+static void fault_task(void *parameters);
+static void burn_task(void *parameters);
+static void stress_task(void *parameters);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static void stressBus(void);
+static void delaySensors(void);
 
 static int32_t fault_initialize(void)
 {
@@ -64,7 +96,10 @@ static int32_t fault_initialize(void)
     FaultSettingsInitialize();
 
     if (module_enabled) {
-        FaultSettingsActivateFaultGet(&active_fault);
+        FaultStatusInitialize();
+        FaultSettingsConnectCallback(&settingsUpdatedCb);
+        settingsUpdatedCb(NULL);
+        active_fault = stress.ActivateFault;
 
         switch (active_fault) {
         case FAULTSETTINGS_ACTIVATEFAULT_MODULEINITASSERT:
@@ -90,14 +125,33 @@ static int32_t fault_initialize(void)
     return 0;
 }
 
-static void fault_task(void *parameters);
-
 static int32_t fault_start(void)
 {
     xTaskHandle fault_task_handle;
 
     if (module_enabled) {
         switch (active_fault) {
+        case FAULTSETTINGS_ACTIVATEFAULT_NOFAULT:
+            /* The stress tasks idle until a Stress setting is changed */
+            PERF_INIT_COUNTER(counterBurnTime, 0x46000001);
+            PERF_INIT_COUNTER(counterBusHold, 0x46000002);
+            PERF_INIT_COUNTER(counterSensorDelay, 0x46000003);
+            PERF_INIT_COUNTER(counterTelemetryUpdates, 0x46000004);
+            xTaskCreate(stress_task,
+                        (signed char *)"FaultStress",
+                        STRESS_STACK_SIZE_BYTES / 4,
+                        NULL,
+                        STRESS_TASK_PRIORITY,
+                        &fault_task_handle);
+            xTaskCreate(burn_task,
+                        (signed char *)"FaultBurn",
+                        BURN_STACK_SIZE_BYTES / 4,
+                        NULL,
+                        tskIDLE_PRIORITY,
+                        &fault_task_handle);
+            return 0;
+
+            break;
         case FAULTSETTINGS_ACTIVATEFAULT_RUNAWAYTASK:
         case FAULTSETTINGS_ACTIVATEFAULT_TASKOUTOFMEMORY:
             xTaskCreate(fault_task,
@@ -136,6 +190,199 @@ static void fault_task(__attribute__((unused)) void *parameters)
     }
 }
 
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    FaultSettingsGet(&stress);
+}
+
+/**
+ * Busy waits StressCpuLoad % of every StressCpuPeriod at StressCpuPriority.
+ * The burn is wall time, the tasks of higher priority preempting it shorten
+ * the CPU time it actually takes from the ones of its priority and below.
+ */
+static void burn_task(__attribute__((unused)) void *parameters)
+{
+    portTickType lastWake = xTaskGetTickCount();
+    uint8_t priority = tskIDLE_PRIORITY;
+
+    while (1) {
+        uint32_t period = MAX(stress.StressCpuPeriod / portTICK_RATE_MS, 1);
+        uint8_t load    = MIN(stress.StressCpuLoad, 100);
+        uint8_t wanted  = MIN(stress.StressCpuPriority, configMAX_PRIORITIES - 1);
+
+        if (wanted != priority) {
+            vTaskPrioritySet(NULL, wanted);
+            priority = wanted;
+        }
+        if (load) {
+            uint32_t burn_us = period * portTICK_RATE_MS * load * 10;
+            uint32_t start   = PIOS_DELAY_GetRaw();
+            PERF_TIMED_SECTION_START(counterBurnTime);
+            while (PIOS_DELAY_DiffuS(start) < burn_us) {
+                ;
+            }
+            PERF_TIMED_SECTION_END(counterBurnTime);
+            burnTimeUs += burn_us;
+        }
+        vTaskDelayUntil(&lastWake, period);
+    }
+}
+
+/**
+ * Runs the bus contention, the telemetry flood and the sensor delays at their
+ * own rates, and publishes FaultStatus every STATUS_PERIOD_MS
+ */
+static void stress_task(__attribute__((unused)) void *parameters)
+{
+    portTickType now = xTaskGetTickCount();
+    portTickType nextBus    = now;
+    portTickType nextSensor = now;
+    portTickType nextUpdate = now;
+    portTickType nextStatus = now;
+
+    while (1) {
+        now = xTaskGetTickCount();
+
+        if ((int32_t)(now - nextBus) >= 0) {
+            if (stress.StressBus != FAULTSETTINGS_STRESSBUS_NONE) {
+                stressBus();
+            }
+            nextBus = now + MAX(stress.StressBusPeriod / portTICK_RATE_MS, 1);
+        }
+
+        if ((int32_t)(now - nextUpdate) >= 0) {
+            uint32_t rate     = stress.StressTelemetryRate;
+            uint32_t interval = STATUS_PERIOD_MS / portTICK_RATE_MS;
+            uint32_t batch    = 0;
+            if (rate) {
+                // rates above the tick rate are sent in batches every tick
+                interval = 1000 / (rate * portTICK_RATE_MS);
+                batch    = 1;
+                if (!interval) {
+                    interval = 1;
+                    batch    = rate * portTICK_RATE_MS / 1000;
+                }
+            }
+            // every update is queued by the telemetry, the queue overflows are in FlightTelemetryStats
+            for (uint32_t i = 0; i < batch; i++) {
+                status.TelemetryUpdates++;
+                FaultStatusSet(&status);
+            }
+            if (batch) {
+                PERF_TRACK_VALUE(counterTelemetryUpdates, status.TelemetryUpdates);
+            }
+            nextUpdate = now + interval;
+        }
+
+        if ((int32_t)(now - nextSensor) >= 0) {
+            if (stress.StressSensorDelay) {
+                delaySensors();
+            }
+            nextSensor = now + MAX(stress.StressSensorPeriod / portTICK_RATE_MS, 1);
+        }
+
+        if ((int32_t)(now - nextStatus) >= 0) {
+            status.CpuBurnTime = burnTimeUs / 1000;
+            FaultStatusSet(&status);
+            nextStatus = now + STATUS_PERIOD_MS / portTICK_RATE_MS;
+        }
+
+        // sleep until the first stressor is due
+        now = xTaskGetTickCount();
+        int32_t wait = (int32_t)(nextStatus - now);
+        wait = MIN(wait, (int32_t)(nextBus - now));
+        wait = MIN(wait, (int32_t)(nextUpdate - now));
+        wait = MIN(wait, (int32_t)(nextSensor - now));
+        if (wait > 0) {
+            vTaskDelay(wait);
+        }
+    }
+}
+
+/**
+ * Keeps the bus of the sensors busy for StressBusHold us, their transfers
+ * wait or fail meanwhile
+ */
+static void stressBus(void)
+{
+    int32_t ret = -1;
+
+    PERF_TIMED_SECTION_START(counterBusHold);
+    switch (stress.StressBus) {
+#if defined(PIOS_INCLUDE_SPI) && defined(PIOS_SPI_GYRO_ADAPTER)
+    case FAULTSETTINGS_STRESSBUS_SPI:
+        ret = PIOS_SPI_ClaimBus(PIOS_SPI_GYRO_ADAPTER);
+        if (ret == 0) {
+            PIOS_DELAY_WaituS(stress.StressBusHold);
+            PIOS_SPI_ReleaseBus(PIOS_SPI_GYRO_ADAPTER);
+        }
+        break;
+#endif
+#if defined(PIOS_INCLUDE_I2C) && defined(PIOS_I2C_MAIN_ADAPTER)
+    case FAULTSETTINGS_STRESSBUS_I2C:
+    {
+        // the I2C bus can't be claimed, back to back reads take it for the hold time
+        uint8_t reg = 0;
+        uint8_t buf[I2C_READ_LEN];
+        const struct pios_i2c_txn txn_list[] = {
+            {
+                .info = __func__,
+                .addr = stress.StressBusI2CAddress,
+                .rw   = PIOS_I2C_TXN_WRITE,
+                .len  = 1,
+                .buf  = &reg,
+            },
+            {
+                .info = __func__,
+                .addr = stress.StressBusI2CAddress,
+                .rw   = PIOS_I2C_TXN_READ,
+                .len  = sizeof(buf),
+                .buf  = buf,
+            },
+        };
+        uint32_t start = PIOS_DELAY_GetRaw();
+        do {
+            ret = PIOS_I2C_Transfer(PIOS_I2C_MAIN_ADAPTER, txn_list, NELEMENTS(txn_list));
+        } while (ret == 0 && PIOS_DELAY_DiffuS(start) < stress.StressBusHold);
+    }
+    break;
+#endif
+    default:
+        break;
+    }
+    PERF_TIMED_SECTION_END(counterBusHold);
+
+    if (ret == 0) {
+        status.BusHolds++;
+    } else {
+        status.BusErrors++;
+    }
+}
+
+/**
+ * Holds the task reading the sensors for StressSensorDelay ms, the samples
+ * of that time are processed late and at once
+ */
+static void delaySensors(void)
+{
+    xTaskHandle sensors = PIOS_TASK_MONITOR_GetTaskHandle(TASKINFO_RUNNING_SENSORS);
+
+    if (!sensors) {
+        // the boards without a Sensors module read them in Attitude
+        sensors = PIOS_TASK_MONITOR_GetTaskHandle(TASKINFO_RUNNING_ATTITUDE);
+    }
+    if (!sensors) {
+        return;
+    }
+
+    PERF_TIMED_SECTION_START(counterSensorDelay);
+    vTaskSuspend(sensors);
+    vTaskDelay(MIN(stress.StressSensorDelay, SENSOR_DELAY_MAX_MS) / portTICK_RATE_MS);
+    vTaskResume(sensors);
+    PERF_TIMED_SECTION_END(counterSensorDelay);
+    status.SensorDelays++;
+}
+
 /**
  * @}
  * @}
@@ -42,6 +42,9 @@
 #define STACK_SIZE_BYTES 1500
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 1)
 #define MAX_QUEUE_SIZE   2
+#ifndef FLIGHTPLAN_SCRIPT
+#define FLIGHTPLAN_SCRIPT "test"
+#endif
 
 // Private types
 
@@ -129,8 +132,8 @@ static void flightPlanTask(__attribute__((unused)) void *parameters)
                 FlightPlanStatusGet(&status);
                 status.Status = FLIGHTPLANSTATUS_STATUS_RUNNING;
                 FlightPlanStatusSet(&status);
-                // Run the test script (TODO: load from SD card)
-                retval = pm_run((uint8_t *)"test");
+                // Run the script (TODO: load from SD card)
+                retval = pm_run((uint8_t *)FLIGHTPLAN_SCRIPT);
                 // Check if an error or exception was thrown
                 if (retval == PM_RET_OK || retval == PM_RET_EX_EXIT) {
                     status.Status    = FLIGHTPLANSTATUS_STATUS_STOPPED;
@@ -0,0 +1,42 @@
+# Interpreter benchmark, build it in place of the test plan with
+#   make FLIGHTPLAN=benchmark ...
+# Debug[0] reports the Python loop iterations per second, each iteration
+# executes 32 bytecodes with global, attribute and builtin lookups.
+# Debug[1] reports the UAVObject reads per second.
+import sys
+import openpilot
+import flightplanstatus
+
+limit = 7
+gain = 3
+offset = 1
+fpStatus = flightplanstatus.FlightPlanStatus()
+
+def step(i):
+	return i * gain + offset
+
+def loops(n):
+	i = 0
+	acc = 0
+	while i < n:
+		acc = acc + step(i) % limit
+		fpStatus.Status.value = abs(acc - i) % 3
+		i = i + 1
+	return acc
+
+def reads(n):
+	i = 0
+	while i < n:
+		fpStatus.read()
+		i = i + 1
+
+while 1:
+	start = sys.time()
+	loops(2000)
+	loopRate = 2000000 / (sys.time() - start + 1)
+	start = sys.time()
+	reads(200)
+	readRate = 200000 / (sys.time() - start + 1)
+	openpilot.debug(loopRate, readRate)
+	if openpilot.hasStopRequest():
+		sys.exit()
@@ -170,7 +170,8 @@ class UAVObject:
 		uint8_t const *tmpStr;
 		int16_t *tmpInt16;
 		int32_t *tmpInt32;
-		float *tmpFloat;
+		float *tmpFloat = 0;
+		int32_t newInt = 0;
 
 		// Get dictionary of class attributes                
 		self = NATIVE_GET_LOCAL(0);
@@ -225,44 +226,68 @@ class UAVObject:
 			retval = dict_getItem(attrs, fieldName, &field); PM_RETURN_IF_ERROR(retval); 
 			// Set value for each element
 			for (valueIdx = 0; valueIdx < numElements; ++valueIdx)
-			{		
-				// Update value based on type    	
-				switch (type)  
+			{
+				// Get the current value
+				if ( OBJ_GET_TYPE(field) == OBJ_TYPE_LST )
 				{
-					case TYPE_INT8: 
+					retval = list_getItem(field, valueIdx, &value); PM_RETURN_IF_ERROR(retval);
+				}
+				else
+					value = field;
+				// Unpack the new value based on type
+				switch (type)
+				{
+					case TYPE_INT8:
 					case TYPE_UINT8:
-					case TYPE_ENUM: 
-						retval = int_new(data[dataIdx], &value); PM_RETURN_IF_ERROR(retval);                       
+					case TYPE_ENUM:
+						newInt = data[dataIdx];
 						dataIdx = dataIdx + 1;
 						break;
 					case TYPE_INT16:
 					case TYPE_UINT16:
 						tmpInt16 = (int16_t*)(&data[dataIdx]);
-						retval = int_new(*tmpInt16, &value); PM_RETURN_IF_ERROR(retval);    
+						newInt = *tmpInt16;
 						dataIdx = dataIdx + 2;
-						break;       
+						break;
 					case TYPE_INT32:
 					case TYPE_UINT32:
 						tmpInt32 = (int32_t*)(&data[dataIdx]);
-						retval = int_new(*tmpInt32, &value); PM_RETURN_IF_ERROR(retval);    
+						newInt = *tmpInt32;
 						dataIdx = dataIdx + 4;
-						break;  
+						break;
 					case TYPE_FLOAT32:
 						tmpFloat = (float*)(&data[dataIdx]);
-						retval = float_new(*tmpFloat, &value); PM_RETURN_IF_ERROR(retval);    
 						dataIdx = dataIdx + 4;
-						break;    
+						break;
+				}
+				// Keep the current object if it already holds the value, most
+				// fields do not change between reads and every new object is
+				// garbage for the collector once replaced
+				if ( type == TYPE_FLOAT32 )
+				{
+					if ( OBJ_GET_TYPE(value) == OBJ_TYPE_FLT && memcmp(&((pPmFloat_t)value)->val, tmpFloat, 4) == 0 )
+					{
+						continue;
+					}
+					retval = float_new(*tmpFloat, &value); PM_RETURN_IF_ERROR(retval);
+				}
+				else
+				{
+					if ( OBJ_GET_TYPE(value) == OBJ_TYPE_INT && ((pPmInt_t)value)->val == newInt )
+					{
+						continue;
+					}
+					retval = int_new(newInt, &value); PM_RETURN_IF_ERROR(retval);
 				}
-				// Set value 
+				// Set value
 				if ( OBJ_GET_TYPE(field) == OBJ_TYPE_LST )
 				{
-					retval = list_setItem(field, valueIdx, value); PM_RETURN_IF_ERROR(retval); 
+					retval = list_setItem(field, valueIdx, value); PM_RETURN_IF_ERROR(retval);
 				}
 				else
 				{
-					tmpStr = (uint8_t const *)"value";
-					retval = string_new(&tmpStr, &fieldName); PM_RETURN_IF_ERROR(retval); 
-					retval = dict_setItem(attrs, fieldName, value); PM_RETURN_IF_ERROR(retval); 
+					// fieldName still holds "value"
+					retval = dict_setItem(attrs, fieldName, value); PM_RETURN_IF_ERROR(retval);
 				}
 			}
 		}
@@ -90,8 +90,6 @@ void updateGpsSettings(UAVObjEvent *ev);
         #define STACK_SIZE_BYTES   1024
 #else
 #if defined(PIOS_GPS_MINIMAL)
-        #define GPS_READ_BUFFER    32
-
 #ifdef PIOS_INCLUDE_GPS_NMEA_PARSER
         #define STACK_SIZE_BYTES   580 // NMEA
 #else
@@ -102,10 +100,6 @@ void updateGpsSettings(UAVObjEvent *ev);
 #endif // PIOS_GPS_MINIMAL
 #endif // PIOS_GPS_SETS_HOMELOCATION
 
-#ifndef GPS_READ_BUFFER
-#define GPS_READ_BUFFER            128
-#endif
-
 #define TASK_PRIORITY              (tskIDLE_PRIORITY + 1)
 
 // ****************
@@ -262,7 +256,6 @@ static void gpsTask(__attribute__((unused)) void *parameters)
     PERF_INIT_COUNTER(counterBytesIn, 0x97510001);
     PERF_INIT_COUNTER(counterRate, 0x97510002);
     PERF_INIT_COUNTER(counterParse, 0x97510003);
-    uint8_t c[GPS_READ_BUFFER];
 
     // Loop forever
     while (1) {
@@ -280,8 +273,10 @@ static void gpsTask(__attribute__((unused)) void *parameters)
         }
 #endif
         // This blocks the task until there is something on the buffer
+        // The received bytes are parsed in place in the COM buffer
+        const uint8_t *c;
         uint16_t cnt;
-        while ((cnt = PIOS_COM_ReceiveBuffer(gpsPort, c, GPS_READ_BUFFER, xDelay)) > 0) {
+        while ((cnt = PIOS_COM_ReceiveSpan(gpsPort, &c, xDelay)) > 0) {
             PERF_TIMED_SECTION_START(counterParse);
             PERF_TRACK_VALUE(counterBytesIn, cnt);
             PERF_MEASURE_PERIOD(counterRate);
@@ -318,7 +313,8 @@ static void gpsTask(__attribute__((unused)) void *parameters)
                 break;
             }
 
-            PERF_TIMED_SECTION_END(counterParse);
+            PIOS_COM_ReceiveRelease(gpsPort, cnt);
+            PERF_TIMED_SECTION_END_RATE(counterParse, cnt);
             if (res == PARSER_COMPLETE) {
                 timeNowMs = xTaskGetTickCount() * portTICK_RATE_MS;
                 timeOfLastUpdateMs = timeNowMs;
@@ -102,102 +102,129 @@ int32_t ubxHwVersion = -1;
 // Last received Ack/Nak
 struct UBX_ACK_ACK ubxLastAck;
 struct UBX_ACK_NAK ubxLastNak;
+// Number of Ack/Nak received for CFG messages, wrapping
+uint16_t ubxCfgAckCount;
+uint16_t ubxCfgNakCount;
 
 // If a PVT sentence is received in the last UBX_PVT_TIMEOUT (ms) timeframe it disables VELNED/POSLLH/SOL/TIMEUTC
 #define UBX_PVT_TIMEOUT (1000)
-// parse incoming character stream for messages in UBX binary format
+// update the 8-bit Fletcher checksum used by UBX over a block of bytes
+static void checksum_ubx_update(uint8_t *ck_a, uint8_t *ck_b, const uint8_t *data, uint16_t len)
+{
+    uint8_t a = *ck_a;
+    uint8_t b = *ck_b;
+
+    for (uint16_t i = 0; i < len; i++) {
+        a += data[i];
+        b += a;
+    }
+    *ck_a = a;
+    *ck_b = b;
+}
 
-int parse_ubx_stream(uint8_t *rx, uint8_t len, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
+// parse incoming character stream for messages in UBX binary format
+// frames are handled a block at a time: the sync pair is searched with memchr(), then the
+// header, payload and checksum are taken in as large pieces as the received span allows
+int parse_ubx_stream(const uint8_t *rx, uint16_t len, char *gps_rx_buffer, GPSPositionSensorData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
     int ret = PARSER_INCOMPLETE; // message not (yet) complete
     enum proto_states {
         START,
         UBX_SY2,
-        UBX_CLASS,
-        UBX_ID,
-        UBX_LEN1,
-        UBX_LEN2,
+        UBX_HEADER,
         UBX_PAYLOAD,
-        UBX_CHK1,
-        UBX_CHK2,
-        FINISHED
+        UBX_CHK
     };
-    uint8_t c;
     static enum proto_states proto_state = START;
-    static uint8_t rx_count = 0;
-    struct UBXPacket *ubx   = (struct UBXPacket *)gps_rx_buffer;
-
-    for (int i = 0; i < len; i++) {
-        c = rx[i];
+    static uint8_t header[4]; // class, id, length (little endian)
+    static uint8_t chk[2];
+    static uint16_t rx_count = 0;
+    static uint8_t ck_a, ck_b;
+    struct UBXPacket *ubx    = (struct UBXPacket *)gps_rx_buffer;
+    uint16_t i = 0;
+
+    while (i < len) {
+        uint16_t count;
         switch (proto_state) {
         case START: // detect protocol
-            if (c == UBX_SYNC1) { // first UBX sync char found
-                proto_state = UBX_SY2;
+        {
+            const uint8_t *sync = memchr(&rx[i], UBX_SYNC1, len - i);
+            if (sync != &rx[i]) {
+                ret = (ret != PARSER_COMPLETE) ? PARSER_ERROR : PARSER_COMPLETE; // parser couldn't use these bytes
+            }
+            if (!sync) {
+                return ret;
             }
+            i = sync - rx + 1;
+            proto_state = UBX_SY2;
             break;
+        }
         case UBX_SY2:
-            if (c == UBX_SYNC2) { // second UBX sync char found
-                proto_state = UBX_CLASS;
+            if (rx[i] == UBX_SYNC2) { // second UBX sync char found
+                i++;
+                rx_count    = 0;
+                proto_state = UBX_HEADER;
             } else {
-                proto_state = START; // reset state
+                // reset state, the byte may be the start of a new sync pair
+                ret = (ret != PARSER_COMPLETE) ? PARSER_ERROR : PARSER_COMPLETE;
+                proto_state = START;
             }
             break;
-        case UBX_CLASS:
-            ubx->header.class = c;
-            proto_state      = UBX_ID;
-            break;
-        case UBX_ID:
-            ubx->header.id   = c;
-            proto_state      = UBX_LEN1;
-            break;
-        case UBX_LEN1:
-            ubx->header.len  = c;
-            proto_state      = UBX_LEN2;
-            break;
-        case UBX_LEN2:
-            ubx->header.len += (c << 8);
+        case UBX_HEADER:
+            count = MIN(len - i, (uint16_t)(sizeof(header) - rx_count));
+            memcpy(&header[rx_count], &rx[i], count);
+            rx_count += count;
+            i += count;
+            if (rx_count < sizeof(header)) {
+                break;
+            }
+            ubx->header.class = header[0];
+            ubx->header.id    = header[1];
+            ubx->header.len   = header[2] | (header[3] << 8);
             if (ubx->header.len > sizeof(UBXPayload)) {
                 gpsRxStats->gpsRxOverflow++;
+                ret = (ret != PARSER_COMPLETE) ? PARSER_ERROR : PARSER_COMPLETE;
                 proto_state = START;
             } else {
+                ck_a = 0;
+                ck_b = 0;
+                checksum_ubx_update(&ck_a, &ck_b, header, sizeof(header));
                 rx_count    = 0;
-                proto_state = UBX_PAYLOAD;
+                proto_state = ubx->header.len ? UBX_PAYLOAD : UBX_CHK;
             }
             break;
         case UBX_PAYLOAD:
-            if (rx_count < ubx->header.len) {
-                ubx->payload.payload[rx_count] = c;
-                if (++rx_count == ubx->header.len) {
-                    proto_state = UBX_CHK1;
-                }
-            } else {
-                gpsRxStats->gpsRxOverflow++;
-                proto_state = START;
+            // the handlers need the payload aligned, so it is copied once, still a block at a time
+            count = MIN(len - i, ubx->header.len - rx_count);
+            checksum_ubx_update(&ck_a, &ck_b, &rx[i], count);
+            memcpy(&ubx->payload.payload[rx_count], &rx[i], count);
+            rx_count += count;
+            i += count;
+            if (rx_count == ubx->header.len) {
+                rx_count    = 0;
+                proto_state = UBX_CHK;
             }
             break;
-        case UBX_CHK1:
-            ubx->header.ck_a = c;
-            proto_state = UBX_CHK2;
-            break;
-        case UBX_CHK2:
-            ubx->header.ck_b = c;
-            if (checksum_ubx_message(ubx)) { // message complete and valid
+        case UBX_CHK:
+            count = MIN(len - i, (uint16_t)(sizeof(chk) - rx_count));
+            memcpy(&chk[rx_count], &rx[i], count);
+            rx_count += count;
+            i += count;
+            if (rx_count < sizeof(chk)) {
+                break;
+            }
+            ubx->header.ck_a = chk[0];
+            ubx->header.ck_b = chk[1];
+            proto_state = START;
+            if (ck_a == chk[0] && ck_b == chk[1]) { // message complete and valid
                 parse_ubx_message(ubx, GpsData);
-                proto_state = FINISHED;
+                gpsRxStats->gpsRxReceived++;
+                ret = PARSER_COMPLETE; // message complete & processed
             } else {
                 gpsRxStats->gpsRxChkSumError++;
-                proto_state = START;
+                ret = (ret != PARSER_COMPLETE) ? PARSER_ERROR : PARSER_COMPLETE;
             }
             break;
-        default: break;
-        }
-
-        if (proto_state == START) {
-            ret = (ret != PARSER_COMPLETE) ? PARSER_ERROR : PARSER_COMPLETE; // parser couldn't use this byte
-        } else if (proto_state == FINISHED) {
-            gpsRxStats->gpsRxReceived++;
-            proto_state = START;
-            ret = PARSER_COMPLETE; // message complete & processed
         }
     }
     return ret;
@@ -237,32 +264,13 @@ bool check_msgtracker(uint32_t tow, uint8_t msg_flag)
 
 bool checksum_ubx_message(struct UBXPacket *ubx)
 {
-    int i;
-    uint8_t ck_a, ck_b;
-
-    ck_a  = ubx->header.class;
-    ck_b  = ck_a;
+    uint8_t header[4] = { ubx->header.class, ubx->header.id, ubx->header.len & 0xff, ubx->header.len >> 8 };
+    uint8_t ck_a = 0, ck_b = 0;
 
-    ck_a += ubx->header.id;
-    ck_b += ck_a;
+    checksum_ubx_update(&ck_a, &ck_b, header, sizeof(header));
+    checksum_ubx_update(&ck_a, &ck_b, ubx->payload.payload, ubx->header.len);
 
-    ck_a += ubx->header.len & 0xff;
-    ck_b += ck_a;
-
-    ck_a += ubx->header.len >> 8;
-    ck_b += ck_a;
-
-    for (i = 0; i < ubx->header.len; i++) {
-        ck_a += ubx->payload.payload[i];
-        ck_b += ck_a;
-    }
-
-    if (ubx->header.ck_a == ck_a &&
-        ubx->header.ck_b == ck_b) {
-        return true;
-    } else {
-        return false;
-    }
+    return ubx->header.ck_a == ck_a && ubx->header.ck_b == ck_b;
 }
 
 static void parse_ubx_nav_posllh(struct UBXPacket *ubx, GPSPositionSensorData *GpsPosition)
@@ -438,6 +446,9 @@ static void parse_ubx_ack_ack(struct UBXPacket *ubx, __attribute__((unused)) GPS
     struct UBX_ACK_ACK *ack_ack = &ubx->payload.ack_ack;
 
     ubxLastAck = *ack_ack;
+    if (ack_ack->clsID == UBX_CLASS_CFG) {
+        ubxCfgAckCount++;
+    }
 }
 
 static void parse_ubx_ack_nak(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
@@ -445,6 +456,9 @@ static void parse_ubx_ack_nak(struct UBXPacket *ubx, __attribute__((unused)) GPS
     struct UBX_ACK_NAK *ack_nak = &ubx->payload.ack_nak;
 
     ubxLastNak = *ack_nak;
+    if (ack_nak->clsID == UBX_CLASS_CFG) {
+        ubxCfgNakCount++;
+    }
 }
 
 static void parse_ubx_mon_ver(struct UBXPacket *ubx, __attribute__((unused)) GPSPositionSensorData *GpsPosition)
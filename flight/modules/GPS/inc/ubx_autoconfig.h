@@ -47,6 +47,8 @@
 #define UBX_MAX_RETRIES         5
 // pause between each configuration step
 #define UBX_STEP_WAIT_TIME      (10 * 1000)
+// configuration packets sent ahead of their acks
+#define UBX_CONFIG_WINDOW       4
 // types
 typedef enum {
     UBX_AUTOCONFIG_STATUS_DISABLED = 0,
@@ -35,23 +35,29 @@ typedef enum {
     INIT_STEP_START,
     INIT_STEP_ASK_VER,
     INIT_STEP_WAIT_VER,
-    INIT_STEP_ENABLE_SENTENCES,
-    INIT_STEP_ENABLE_SENTENCES_WAIT_ACK,
     INIT_STEP_CONFIGURE,
-    INIT_STEP_CONFIGURE_WAIT_ACK,
     INIT_STEP_DONE,
     INIT_STEP_ERROR,
 } initSteps_t;
 
+// the whole configuration is serialized once and streamed from here
+#define UBX_CONFIG_MAX_PACKETS 32
+#define UBX_CONFIG_BUFFER_SIZE 512
+
 typedef struct {
     initSteps_t        currentStep; // Current configuration "fsm" status
     uint32_t           lastStepTimestampRaw; // timestamp of last operation
     uint32_t           lastConnectedRaw; // timestamp of last time gps was connected
-    UBXSentPacket_t    working_packet; // outbound "buffer"
+    UBXSentPacket_t    working_packet; // outbound "buffer" for requests
     ubx_autoconfig_settings_t currentSettings;
-    int8_t lastConfigSent; // index of last configuration string sent
-    struct UBX_ACK_ACK requiredAck; // Class and id of the message we are waiting for an ACK from GPS
-    uint8_t retryCount;
+    uint8_t  configBuffer[UBX_CONFIG_BUFFER_SIZE]; // all configuration packets, back to back
+    uint16_t packetEnd[UBX_CONFIG_MAX_PACKETS]; // end offset of each packet in configBuffer
+    uint8_t  packetCount;
+    uint8_t  packetsSent;
+    uint8_t  packetsAcked;
+    uint16_t ackBase; // ubxCfgAckCount when packet 0 was sent
+    uint16_t nakBase;
+    uint8_t  retryCount;
 } status_t;
 
 ubx_cfg_msg_t msg_config_ubx6[] = {
@@ -113,10 +119,6 @@ ubx_cfg_msg_t msg_config_ubx7[] = {
     { .msgClass = UBX_CLASS_NAV, .msgID = UBX_ID_NAV_SVINFO,    .rate = 10 },
 };
 
-// private defines
-#define LAST_CONFIG_SENT_START     (-1)
-#define LAST_CONFIG_SENT_COMPLETED (-2)
-
 // private variables
 
 // enable the autoconfiguration system
@@ -159,9 +161,9 @@ static void build_request(UBXSentPacket_t *packet, uint8_t classID, uint8_t mess
     *bytes_to_send = prepare_packet(packet, classID, messageID, 0);
 }
 
-void config_rate(uint16_t *bytes_to_send)
+static uint16_t config_rate(UBXSentPacket_t *packet)
 {
-    memset(status->working_packet.buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_rate_t));
+    memset(packet->buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_rate_t));
     // if rate is less than 1 uses the highest rate for current hardware
     uint16_t rate = status->currentSettings.navRate > 0 ? status->currentSettings.navRate : 99;
     if (ubxHwVersion < UBX_HW_VERSION_7 && rate > UBX_MAX_RATE) {
@@ -173,111 +175,158 @@ void config_rate(uint16_t *bytes_to_send)
     }
     uint16_t period = 1000 / rate;
 
-    status->working_packet.message.payload.cfg_rate.measRate = period;
-    status->working_packet.message.payload.cfg_rate.navRate  = 1; // must be set to 1
-    status->working_packet.message.payload.cfg_rate.timeRef  = 1; // 0 = UTC Time, 1 = GPS Time
-    *bytes_to_send = prepare_packet(&status->working_packet, UBX_CLASS_CFG, UBX_ID_CFG_RATE, sizeof(ubx_cfg_rate_t));
-    status->requiredAck.clsID = UBX_CLASS_CFG;
-    status->requiredAck.msgID = UBX_ID_CFG_RATE;
+    packet->message.payload.cfg_rate.measRate = period;
+    packet->message.payload.cfg_rate.navRate  = 1; // must be set to 1
+    packet->message.payload.cfg_rate.timeRef  = 1; // 0 = UTC Time, 1 = GPS Time
+    return prepare_packet(packet, UBX_CLASS_CFG, UBX_ID_CFG_RATE, sizeof(ubx_cfg_rate_t));
 }
 
-void config_nav(uint16_t *bytes_to_send)
+static uint16_t config_nav(UBXSentPacket_t *packet)
 {
-    memset(status->working_packet.buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_nav5_t));
+    memset(packet->buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_nav5_t));
 
-    status->working_packet.message.payload.cfg_nav5.dynModel = status->currentSettings.dynamicModel;
-    status->working_packet.message.payload.cfg_nav5.fixMode  = 2; // 1=2D only, 2=3D only, 3=Auto 2D/3D
+    packet->message.payload.cfg_nav5.dynModel = status->currentSettings.dynamicModel;
+    packet->message.payload.cfg_nav5.fixMode  = 2; // 1=2D only, 2=3D only, 3=Auto 2D/3D
     // mask LSB=dyn|minEl|posFixMode|drLim|posMask|statisticHoldMask|dgpsMask|......|reservedBit0 = MSB
 
-    status->working_packet.message.payload.cfg_nav5.mask     = 0x01 + 0x04; // Dyn Model | posFixMode configuration
-    *bytes_to_send = prepare_packet(&status->working_packet, UBX_CLASS_CFG, UBX_ID_CFG_NAV5, sizeof(ubx_cfg_nav5_t));
-    status->requiredAck.clsID = UBX_CLASS_CFG;
-    status->requiredAck.msgID = UBX_ID_CFG_NAV5;
+    packet->message.payload.cfg_nav5.mask     = 0x01 + 0x04; // Dyn Model | posFixMode configuration
+    return prepare_packet(packet, UBX_CLASS_CFG, UBX_ID_CFG_NAV5, sizeof(ubx_cfg_nav5_t));
 }
 
-void config_sbas(uint16_t *bytes_to_send)
+static uint16_t config_sbas(UBXSentPacket_t *packet)
 {
-    memset(status->working_packet.buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_sbas_t));
+    memset(packet->buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_sbas_t));
 
-    status->working_packet.message.payload.cfg_sbas.maxSBAS = status->currentSettings.SBASChannelsUsed < 4 ?
-                                                              status->currentSettings.SBASChannelsUsed : 3;
+    packet->message.payload.cfg_sbas.maxSBAS = status->currentSettings.SBASChannelsUsed < 4 ?
+                                               status->currentSettings.SBASChannelsUsed : 3;
 
-    status->working_packet.message.payload.cfg_sbas.usage   =
+    packet->message.payload.cfg_sbas.usage   =
         (status->currentSettings.SBASCorrection ? UBX_CFG_SBAS_USAGE_DIFFCORR : 0) |
         (status->currentSettings.SBASIntegrity ? UBX_CFG_SBAS_USAGE_INTEGRITY : 0) |
         (status->currentSettings.SBASRanging ? UBX_CFG_SBAS_USAGE_RANGE : 0);
     // If sbas is used for anything then set mode as enabled
-    status->working_packet.message.payload.cfg_sbas.mode =
-        status->working_packet.message.payload.cfg_sbas.usage != 0 ? UBX_CFG_SBAS_MODE_ENABLED : 0;
+    packet->message.payload.cfg_sbas.mode =
+        packet->message.payload.cfg_sbas.usage != 0 ? UBX_CFG_SBAS_MODE_ENABLED : 0;
 
-    status->working_packet.message.payload.cfg_sbas.scanmode1 =
+    packet->message.payload.cfg_sbas.scanmode1 =
         status->currentSettings.SBASSats == UBX_SBAS_SATS_WAAS ? UBX_CFG_SBAS_SCANMODE1_WAAS :
         status->currentSettings.SBASSats == UBX_SBAS_SATS_EGNOS ? UBX_CFG_SBAS_SCANMODE1_EGNOS :
         status->currentSettings.SBASSats == UBX_SBAS_SATS_MSAS ? UBX_CFG_SBAS_SCANMODE1_MSAS :
         status->currentSettings.SBASSats == UBX_SBAS_SATS_GAGAN ? UBX_CFG_SBAS_SCANMODE1_GAGAN :
         status->currentSettings.SBASSats == UBX_SBAS_SATS_SDCM ? UBX_CFG_SBAS_SCANMODE1_SDCM : UBX_SBAS_SATS_AUTOSCAN;
 
-    status->working_packet.message.payload.cfg_sbas.scanmode2 = UBX_CFG_SBAS_SCANMODE2;
+    packet->message.payload.cfg_sbas.scanmode2 = UBX_CFG_SBAS_SCANMODE2;
 
-    *bytes_to_send = prepare_packet(&status->working_packet, UBX_CLASS_CFG, UBX_ID_CFG_SBAS, sizeof(ubx_cfg_sbas_t));
-    status->requiredAck.clsID = UBX_CLASS_CFG;
-    status->requiredAck.msgID = UBX_ID_CFG_SBAS;
+    return prepare_packet(packet, UBX_CLASS_CFG, UBX_ID_CFG_SBAS, sizeof(ubx_cfg_sbas_t));
 }
 
-void config_save(uint16_t *bytes_to_send)
+static uint16_t config_save(UBXSentPacket_t *packet)
 {
-    memset(status->working_packet.buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_cfg_t));
+    memset(packet->buffer, 0, sizeof(UBXSentHeader_t) + sizeof(ubx_cfg_cfg_t));
     // mask LSB=ioPort|msgConf|infMsg|navConf|rxmConf|||||rinvConf|antConf|....|= MSB
-    status->working_packet.message.payload.cfg_cfg.saveMask   = 0x02 | 0x08; // msgConf + navConf
-    status->working_packet.message.payload.cfg_cfg.deviceMask = UBX_CFG_CFG_ALL_DEVICES_MASK;
-    *bytes_to_send = prepare_packet(&status->working_packet, UBX_CLASS_CFG, UBX_ID_CFG_CFG, sizeof(ubx_cfg_cfg_t));
-    status->requiredAck.clsID = UBX_CLASS_CFG;
-    status->requiredAck.msgID = UBX_ID_CFG_CFG;
+    packet->message.payload.cfg_cfg.saveMask   = 0x02 | 0x08; // msgConf + navConf
+    packet->message.payload.cfg_cfg.deviceMask = UBX_CFG_CFG_ALL_DEVICES_MASK;
+    return prepare_packet(packet, UBX_CLASS_CFG, UBX_ID_CFG_CFG, sizeof(ubx_cfg_cfg_t));
 }
-static void configure(uint16_t *bytes_to_send)
-{
-    switch (status->lastConfigSent) {
-    case LAST_CONFIG_SENT_START:
-        config_rate(bytes_to_send);
-        break;
-    case LAST_CONFIG_SENT_START + 1:
-        config_nav(bytes_to_send);
-        break;
-    case LAST_CONFIG_SENT_START + 2:
-        config_sbas(bytes_to_send);
-        if (!status->currentSettings.storeSettings) {
-            // skips saving
-            status->lastConfigSent = LAST_CONFIG_SENT_COMPLETED;
-        }
-        break;
-    case LAST_CONFIG_SENT_START + 3:
-        config_save(bytes_to_send);
-        status->lastConfigSent = LAST_CONFIG_SENT_COMPLETED;
-        return;
 
-    default:
-        status->lastConfigSent = LAST_CONFIG_SENT_COMPLETED;
-        return;
-    }
+static uint16_t config_msg(UBXSentPacket_t *packet, const ubx_cfg_msg_t *msg)
+{
+    packet->message.payload.cfg_msg = *msg;
+    return prepare_packet(packet, UBX_CLASS_CFG, UBX_ID_CFG_MSG, sizeof(ubx_cfg_msg_t));
 }
 
-static void enable_sentences(__attribute__((unused)) uint16_t *bytes_to_send)
+/**
+ * Serialize the whole configuration for the detected hardware: sentence
+ * rates first, then navigation rate, model and SBAS, then the optional save.
+ * Every packet is a CFG message acked by the receiver in order.
+ */
+static void build_configuration()
 {
-    int8_t msg = status->lastConfigSent + 1;
     uint8_t msg_count = (ubxHwVersion >= UBX_HW_VERSION_7) ?
                         NELEMENTS(msg_config_ubx7) : NELEMENTS(msg_config_ubx6);
-    ubx_cfg_msg_t *msg_config = (ubxHwVersion >= UBX_HW_VERSION_7) ?
-                                &msg_config_ubx7[0] : &msg_config_ubx6[0];
+    const ubx_cfg_msg_t *msg_config = (ubxHwVersion >= UBX_HW_VERSION_7) ?
+                                      &msg_config_ubx7[0] : &msg_config_ubx6[0];
+    uint16_t offset = 0;
+    uint8_t count   = 0;
 
-    if (msg >= 0 && msg < msg_count) {
-        status->working_packet.message.payload.cfg_msg = msg_config[msg];
+#define ADD_PACKET(builder) \
+    { offset += builder; status->packetEnd[count++] = offset; }
 
-        *bytes_to_send = prepare_packet(&status->working_packet, UBX_CLASS_CFG, UBX_ID_CFG_MSG, sizeof(ubx_cfg_msg_t));
-        status->requiredAck.clsID = UBX_CLASS_CFG;
-        status->requiredAck.msgID = UBX_ID_CFG_MSG;
-    } else {
-        status->lastConfigSent = LAST_CONFIG_SENT_COMPLETED;
+    for (uint8_t i = 0; i < msg_count; i++) {
+        ADD_PACKET(config_msg((UBXSentPacket_t *)&status->configBuffer[offset], &msg_config[i]));
     }
+    ADD_PACKET(config_rate((UBXSentPacket_t *)&status->configBuffer[offset]));
+    ADD_PACKET(config_nav((UBXSentPacket_t *)&status->configBuffer[offset]));
+    ADD_PACKET(config_sbas((UBXSentPacket_t *)&status->configBuffer[offset]));
+    if (status->currentSettings.storeSettings) {
+        ADD_PACKET(config_save((UBXSentPacket_t *)&status->configBuffer[offset]));
+    }
+#undef ADD_PACKET
+    PIOS_Assert(count <= UBX_CONFIG_MAX_PACKETS && offset <= UBX_CONFIG_BUFFER_SIZE);
+
+    status->packetCount  = count;
+    status->packetsSent  = 0;
+    status->packetsAcked = 0;
+    status->retryCount   = 0;
+    status->ackBase = ubxCfgAckCount;
+    status->nakBase = ubxCfgNakCount;
+}
+
+/**
+ * Stream the configuration, keeping up to UBX_CONFIG_WINDOW packets in
+ * flight. Acks are counted as they are parsed, the receiver answers CFG
+ * messages in order so the count tells how far it got.
+ * \return true when all packets are acked
+ */
+static bool stream_configuration(char * *buffer, uint16_t *bytes_to_send)
+{
+    uint8_t acked = (uint8_t)(ubxCfgAckCount - status->ackBase);
+
+    if (ubxCfgNakCount != status->nakBase) {
+        // a rejected setting is not going to be accepted on a resend
+        status->currentStep = INIT_STEP_ERROR;
+        status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
+        return false;
+    }
+    if (acked > status->packetsSent) {
+        // late acks of a resent window
+        acked = status->packetsSent;
+        status->ackBase = ubxCfgAckCount - acked;
+    }
+    if (acked != status->packetsAcked) {
+        status->packetsAcked = acked;
+        status->retryCount   = 0;
+        status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
+    }
+    if (acked >= status->packetCount) {
+        return true;
+    }
+
+    if (PIOS_DELAY_DiffuS(status->lastStepTimestampRaw) > UBX_REPLY_TIMEOUT) {
+        // timeout, resend from the first packet not acked or abort
+        if (++status->retryCount > UBX_MAX_RETRIES) {
+            status->currentStep = INIT_STEP_ERROR;
+            status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
+            return false;
+        }
+        status->packetsSent = status->packetsAcked;
+        status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
+    }
+
+    uint8_t last = status->packetsAcked + UBX_CONFIG_WINDOW;
+    if (last > status->packetCount) {
+        last = status->packetCount;
+    }
+    if (status->packetsSent < last) {
+        uint16_t start = status->packetsSent ? status->packetEnd[status->packetsSent - 1] : 0;
+        *buffer        = (char *)&status->configBuffer[start];
+        *bytes_to_send = status->packetEnd[last - 1] - start;
+        if (status->packetsSent == status->packetsAcked) {
+            status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
+        }
+        status->packetsSent = last;
+    }
+    return false;
 }
 
 void ubx_autoconfig_run(char * *buffer, uint16_t *bytes_to_send, bool gps_connected)
@@ -320,10 +369,6 @@ void ubx_autoconfig_run(char * *buffer, uint16_t *bytes_to_send, bool gps_connec
 
     case INIT_STEP_START:
     case INIT_STEP_ASK_VER:
-        // clear ack
-        ubxLastAck.clsID = 0x00;
-        ubxLastAck.msgID = 0x00;
-
         status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
         build_request(&status->working_packet, UBX_CLASS_MON, UBX_ID_MON_VER, bytes_to_send);
         status->currentStep = INIT_STEP_WAIT_VER;
@@ -331,8 +376,8 @@ void ubx_autoconfig_run(char * *buffer, uint16_t *bytes_to_send, bool gps_connec
 
     case INIT_STEP_WAIT_VER:
         if (ubxHwVersion > 0) {
-            status->lastConfigSent = LAST_CONFIG_SENT_START;
-            status->currentStep    = INIT_STEP_ENABLE_SENTENCES;
+            build_configuration();
+            status->currentStep = INIT_STEP_CONFIGURE;
             status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
             return;
         }
@@ -342,55 +387,12 @@ void ubx_autoconfig_run(char * *buffer, uint16_t *bytes_to_send, bool gps_connec
         }
         return;
 
-    case INIT_STEP_ENABLE_SENTENCES:
     case INIT_STEP_CONFIGURE:
-    {
-        bool step_configure = (status->currentStep == INIT_STEP_CONFIGURE);
-        if (step_configure) {
-            configure(bytes_to_send);
-        } else {
-            enable_sentences(bytes_to_send);
-        }
-
-        status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
-        if (status->lastConfigSent == LAST_CONFIG_SENT_COMPLETED) {
-            status->lastConfigSent = LAST_CONFIG_SENT_START;
-            status->currentStep    = step_configure ? INIT_STEP_DONE : INIT_STEP_CONFIGURE;
-        } else {
-            status->currentStep = step_configure ? INIT_STEP_CONFIGURE_WAIT_ACK : INIT_STEP_ENABLE_SENTENCES_WAIT_ACK;
-        }
-        return;
-    }
-    case INIT_STEP_ENABLE_SENTENCES_WAIT_ACK:
-    case INIT_STEP_CONFIGURE_WAIT_ACK: // Wait for an ack from GPS
-    {
-        bool step_configure = (status->currentStep == INIT_STEP_CONFIGURE_WAIT_ACK);
-        if (ubxLastAck.clsID == status->requiredAck.clsID && ubxLastAck.msgID == status->requiredAck.msgID) {
-            // clear ack
-            ubxLastAck.clsID   = 0x00;
-            ubxLastAck.msgID   = 0x00;
-
-            // Continue with next configuration option
-            status->retryCount = 0;
-            status->lastConfigSent++;
-        } else if (PIOS_DELAY_DiffuS(status->lastStepTimestampRaw) > UBX_REPLY_TIMEOUT) {
-            // timeout, resend the message or abort
-            status->retryCount++;
-            if (status->retryCount > UBX_MAX_RETRIES) {
-                status->currentStep = INIT_STEP_ERROR;
-                status->lastStepTimestampRaw = PIOS_DELAY_GetRaw();
-                return;
-            }
-        }
-        // no abort condition, continue or retries.,
-        if (step_configure) {
-            status->currentStep = INIT_STEP_CONFIGURE;
-        } else {
-            status->currentStep = INIT_STEP_ENABLE_SENTENCES;
+        if (stream_configuration(buffer, bytes_to_send)) {
+            status->currentStep = INIT_STEP_DONE;
         }
         return;
     }
-    }
 }
 
 void ubx_autoconfig_set(ubx_autoconfig_settings_t config)
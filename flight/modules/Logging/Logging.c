@@ -37,18 +37,43 @@
 #include "debuglogentry.h"
 #include "flightstatus.h"
 
+// most DebugLogEntry instances a stream keeps in flight, each one is overwritten once acknowledged
+#define STREAM_MAX_WINDOW 8
+// log position ordered by flight then entry
+#define STREAM_POSITION(flight, entry) (((uint32_t)(flight) << 16) | (entry))
+#define STREAM_END    0xFFFFFFFF
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+// trace records saved per DebugLogEntry, and entries saved per drain
+#define TRACE_RECORDS_PER_ENTRY  (sizeof(((DebugLogEntryData *)0)->Data) / sizeof(struct pios_trace_record))
+#define TRACE_ENTRIES_PER_DRAIN  2
+#define TRACE_DRAIN_PERIOD_MS    50
+#endif
+
 // private variables
 static DebugLogSettingsData settings;
 static DebugLogControlData control;
 static DebugLogStatusData status;
 static FlightStatusData flightstatus;
 static DebugLogEntryData *entry; // would be better on stack but event dispatcher stack might be insufficient
+// positions of the streamed entries not acknowledged yet, oldest first
+static uint32_t stream_pending[STREAM_MAX_WINDOW];
+static uint8_t stream_pending_count = 0;
+static uint8_t stream_window   = 1;
+static uint8_t stream_instance = 0;
+static uint32_t stream_next    = STREAM_END;
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+static struct pios_trace_record *trace_records;
+#endif
 
 // private functions
 static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void ControlUpdatedCb(UAVObjEvent *ev);
 static void StatusUpdatedCb(UAVObjEvent *ev);
 static void FlightStatusUpdatedCb(UAVObjEvent *ev);
+static void StreamAck(uint32_t position, uint8_t window, uint8_t instance);
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+static void TraceDrainCb(UAVObjEvent *ev);
+#endif
 
 int32_t LoggingInitialize(void)
 {
@@ -62,6 +87,12 @@ int32_t LoggingInitialize(void)
     if (!entry) {
         return -1;
     }
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+    trace_records = pios_malloc(TRACE_RECORDS_PER_ENTRY * sizeof(struct pios_trace_record));
+    if (!trace_records) {
+        return -1;
+    }
+#endif
 
     return 0;
 }
@@ -82,6 +113,9 @@ int32_t LoggingStart(void)
     EventPeriodicCallbackCreate(&ev, StatusUpdatedCb, 1000);
     // invoke a periodic dispatcher callback - the event struct is a dummy, it could be filled with anything!
     StatusUpdatedCb(&ev);
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+    EventPeriodicCallbackCreate(&ev, TraceDrainCb, TRACE_DRAIN_PERIOD_MS);
+#endif
 
     return 0;
 }
@@ -90,6 +124,10 @@ MODULE_INITCALL(LoggingInitialize, LoggingStart);
 static void StatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     PIOS_DEBUGLOG_Info(&status.Flight, &status.Entry, &status.FreeSlots, &status.UsedSlots);
+    PIOS_DEBUGLOG_Stats(&status.DroppedEntries, &status.Backpressure);
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+    PIOS_TRACE_GetStats(NULL, &status.TraceLost);
+#endif
     DebugLogStatusSet(&status);
 }
 
@@ -110,6 +148,16 @@ static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     DebugLogSettingsGet(&settings);
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+    // the Trace elements are in the order of the trace categories
+    uint32_t categories = 0;
+    for (uint8_t i = 0; i < DEBUGLOGSETTINGS_TRACE_NUMELEM; i++) {
+        if (DebugLogSettingsTraceToArray(settings.Trace)[i] == DEBUGLOGSETTINGS_TRACE_ENABLED) {
+            categories |= 1 << i;
+        }
+    }
+    PIOS_TRACE_SetCategories(categories);
+#endif
     if (settings.LoggingEnabled == DEBUGLOGSETTINGS_LOGGINGENABLED_ALWAYS) {
         PIOS_DEBUGLOG_Enable(1);
         PIOS_DEBUGLOG_Printf("On board logging enabled.");
@@ -133,6 +181,11 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
             entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
         }
         DebugLogEntrySet(entry);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_STREAM) {
+        StreamAck(STREAM_POSITION(control.Flight, control.Entry), control.Window, control.Instance);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_NONE) {
+        stream_pending_count = 0;
+        stream_next = STREAM_END;
     } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_FORMATFLASH) {
         uint8_t armed;
         FlightStatusArmedGet(&armed);
@@ -143,6 +196,83 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     StatusUpdatedCb(ev);
 }
 
+/**
+ * Everything before position was received by the GCS, refill the window.
+ * When the oldest pending entry is not acknowledged the window is sent again
+ * from position, starting with the instance the GCS expects it in. Entries are
+ * read in the same order again, so an instance holds the same entry whether
+ * the GCS receives it from the old window or the new one.
+ */
+static void StreamAck(uint32_t position, uint8_t window, uint8_t instance)
+{
+    uint8_t acked = 0;
+
+    while (acked < stream_pending_count && stream_pending[acked] < position) {
+        acked++;
+    }
+    if (acked == 0) {
+        // a new download or lost entries
+        if (window < 1 || window > STREAM_MAX_WINDOW) {
+            return;
+        }
+        stream_pending_count = 0;
+        stream_window   = window;
+        stream_instance = instance % window;
+        stream_next     = position;
+        // instances are only created once a stream is requested
+        while (UAVObjGetNumInstances(DebugLogEntryHandle()) < stream_window) {
+            if (DebugLogEntryCreateInstance() == 0) {
+                return;
+            }
+        }
+    } else {
+        stream_pending_count -= acked;
+        memmove(stream_pending, &stream_pending[acked], stream_pending_count * sizeof(stream_pending[0]));
+    }
+
+    while (stream_pending_count < stream_window && stream_next != STREAM_END) {
+        uint16_t flight = stream_next >> 16;
+        uint16_t inst   = stream_next & 0xFFFF;
+        memset(entry, 0, sizeof(DebugLogEntryData));
+        if (PIOS_DEBUGLOG_ReadNext(entry, &flight, &inst) == 0) {
+            stream_next = STREAM_POSITION(flight, inst) + 1;
+            stream_pending[stream_pending_count++] = STREAM_POSITION(flight, inst);
+        } else {
+            // an empty entry marks the end of the log
+            entry->Flight = 0xFFFF;
+            entry->Entry  = 0xFFFF;
+            entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
+            stream_next   = STREAM_END;
+            stream_pending[stream_pending_count++] = STREAM_END;
+        }
+        DebugLogEntryInstSet(stream_instance, entry);
+        DebugLogEntryInstUpdated(stream_instance);
+        stream_instance = (stream_instance + 1) % stream_window;
+    }
+}
+
+#if defined(PIOS_INCLUDE_TRACE_BUFFER)
+/**
+ * Save the trace records to the log, task switches are saved with the id of
+ * the task in TaskInfo, 0xFFFFFFFF for the tasks not monitored.
+ * The records left in the buffer are saved by the next drain.
+ */
+static void TraceDrainCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    for (uint8_t n = 0; n < TRACE_ENTRIES_PER_DRAIN; n++) {
+        uint16_t count = PIOS_TRACE_Read(trace_records, TRACE_RECORDS_PER_ENTRY);
+        if (count == 0) {
+            return;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            if (trace_records[i].category == PIOS_TRACE_CATEGORY_TASK) {
+                trace_records[i].data = (uint32_t)PIOS_TASK_MONITOR_GetTaskId((xTaskHandle)trace_records[i].data);
+            }
+        }
+        PIOS_DEBUGLOG_Trace(trace_records, count * sizeof(struct pios_trace_record));
+    }
+}
+#endif /* PIOS_INCLUDE_TRACE_BUFFER */
 
 /**
  * @}
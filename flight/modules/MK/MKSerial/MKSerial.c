@@ -32,7 +32,7 @@
 #include "MkSerial.h"
 
 #include "attitudestate.h" // object that will be updated by the module
-#include "positionstate.h"
+#include "gpspositionsensor.h"
 #include "flightbatterystate.h"
 
 //
@@ -43,6 +43,7 @@
 #define STACK_SIZE    1024
 #define TASK_PRIORITY (tskIDLE_PRIORITY + 3)
 #define MAX_NB_PARS   100
+#define RX_BLOCK_SIZE 32
 // #define ENABLE_DEBUG_MSG
 // #define GENERATE_BATTERY_INFO         // The MK can report battery voltage, but normally the current sensor will be used, so this module should not report battery state
 
@@ -73,6 +74,16 @@
 #define OSD_MSG_NICK_IDX        64
 #define OSD_MSG_ROLL_IDX        65
 
+// Encoded characters between the address and the '\r', 4 per 3 parameter bytes and 2 check characters
+#define MAX_FRAME_CHARS         (MAX_NB_PARS / 3 * 4 + 2)
+
+// The boards stream the subscribed message every interval (in 10ms) for about 4 seconds,
+// the subscription is renewed before it lapses without waiting for the stream to stop
+#define REPORT_INTERVAL         2
+#define SUBSCRIPTION_RENEW_MS   2000
+#define LINK_TIMEOUT_MS         500
+#define VERSION_RETRY_MS        250
+
 #ifdef ENABLE_DEBUG_MSG
 #define DEBUG_MSG(format, ...) PIOS_COM_SendFormattedString(DEBUG_PORT, format,##__VA_ARGS__)
 #else
@@ -96,6 +107,22 @@ typedef struct {
     uint8_t status;
 } GpsPosition_t;
 
+// Frame decoder state, fed with whatever block of bytes the port received
+typedef struct {
+    enum { MK_WAIT_START, MK_ADDRESS, MK_CMD, MK_DATA } state;
+    uint8_t  address;
+    uint8_t  cmd;
+    uint8_t  nbChars;
+    uint16_t checkVal;
+    uint8_t  chars[MAX_FRAME_CHARS];
+} MkDecoder_t;
+
+typedef enum {
+    MK_LINK_DISCONNECTED,
+    MK_LINK_FC,
+    MK_LINK_NC,
+} MkLink_t;
+
 enum {
     MK_ADDR_ALL = 0,
     MK_ADDR_FC  = 1,
@@ -116,8 +143,9 @@ static int16_t Par2Int16(const MkMsg_t *msg, uint8_t index);
 static int32_t Par2Int32(const MkMsg_t *msg, uint8_t index);
 static int8_t Par2Int8(const MkMsg_t *msg, uint8_t index);
 static void GetGpsPos(const MkMsg_t *msg, uint8_t index, GpsPosition_t *pos);
-static uint8_t WaitForBytes(uint8_t *buf, uint8_t nbBytes, portTickType xTicksToWait);
-static bool WaitForMsg(uint8_t cmd, MkMsg_t *msg, portTickType xTicksToWait);
+static bool DecodeByte(MkDecoder_t *decoder, uint8_t c, MkMsg_t *msg);
+static bool DecodeFrame(const MkDecoder_t *decoder, MkMsg_t *msg);
+static void OnMsg(const MkMsg_t *msg);
 static void SendMsg(const MkMsg_t *msg);
 static void SendMsgParNone(uint8_t address, uint8_t cmd);
 static void SendMsgPar8(uint8_t address, uint8_t cmd, uint8_t par0);
@@ -198,131 +226,86 @@ static void GetGpsPos(const MkMsg_t *msg, uint8_t index, GpsPosition_t *pos)
     pos->status    = msg->pars[index + 12];
 }
 
-static uint8_t WaitForBytes(uint8_t *buf, uint8_t nbBytes, portTickType xTicksToWait)
+/**
+ * Feed one received byte to the frame decoder. The characters of a frame are only
+ * stored and summed here, they are decoded once the whole frame is in.
+ * \return true when msg holds a new valid frame
+ */
+static bool DecodeByte(MkDecoder_t *decoder, uint8_t c, MkMsg_t *msg)
 {
-    uint8_t nbBytesLeft = nbBytes;
-    xTimeOutType xTimeOut;
-
-    vTaskSetTimeOutState(&xTimeOut);
-
-    // Loop until
-    // - all bytes are received
-    // - \r is seen
-    // - Timeout occurs
-    do {
-        // Check if timeout occured
-        if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait)) {
-            break;
+    // a start always begins a new frame, the one in progress was cut
+    if (c == '#') {
+        if (decoder->state != MK_WAIT_START) {
+            OnError(__LINE__);
         }
+        decoder->state    = MK_ADDRESS;
+        decoder->checkVal = c;
+        return false;
+    }
 
-        // Check if there are some bytes
-        if (PIOS_COM_ReceiveBufferUsed(PORT)) {
-            *buf = PIOS_COM_ReceiveBuffer(PORT);
-
-            nbBytesLeft--;
-            if (buf[0] == '\r') {
-                break;
-            }
-            buf++;
-        } else {
-            // Avoid tight loop
-            // FIXME: should be blocking
-            vTaskDelay(5);
+    switch (decoder->state) {
+    case MK_WAIT_START:
+        break;
+    case MK_ADDRESS:
+        decoder->address   = c;
+        decoder->checkVal += c;
+        decoder->state     = MK_CMD;
+        break;
+    case MK_CMD:
+        decoder->cmd       = c;
+        decoder->checkVal += c;
+        decoder->nbChars   = 0;
+        decoder->state     = MK_DATA;
+        break;
+    case MK_DATA:
+        if (c == '\r') {
+            decoder->state = MK_WAIT_START;
+            return DecodeFrame(decoder, msg);
         }
-    } while (nbBytesLeft);
-
-    return nbBytes - nbBytesLeft;
+        if (decoder->nbChars >= MAX_FRAME_CHARS) {
+            OnError(__LINE__);
+            decoder->state = MK_WAIT_START;
+            break;
+        }
+        // the check characters are summed too, they are taken back out in DecodeFrame()
+        decoder->chars[decoder->nbChars++] = c;
+        decoder->checkVal += c;
+        break;
+    }
+    return false;
 }
 
-static bool WaitForMsg(uint8_t cmd, MkMsg_t *msg, portTickType xTicksToWait)
+/**
+ * Check and decode a complete frame
+ */
+static bool DecodeFrame(const MkDecoder_t *decoder, MkMsg_t *msg)
 {
-    uint8_t buf[10];
-    uint8_t n;
-    bool done  = FALSE;
-    bool error = FALSE;
-    unsigned int checkVal;
-    xTimeOutType xTimeOut;
-
-    vTaskSetTimeOutState(&xTimeOut);
-
-    while (!done && !error) {
-        // When we are here, it means we did not encounter the message we are waiting for
-        // Check if we did not timeout yet.
-
-        // Wait for start
-        buf[0] = 0;
-        do {
-            if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait)) {
-                return FALSE;
-            }
-            WaitForBytes(buf, 1, 100 / portTICK_RATE_MS);
-        } while (buf[0] != '#');
+    uint8_t n = decoder->nbChars;
 
-        // Wait for cmd and address
-        if (WaitForBytes(buf, 2, 10 / portTICK_RATE_MS) != 2) {
-            OnError(__LINE__);
-            continue;
-        }
-        // Is this the command we are waiting for?
-        if (cmd == 0 || cmd == buf[1]) {
-            // OK follow this message to the end
-            msg->address = buf[0] - 'a';
-            msg->cmd     = buf[1];
-
-            checkVal     = '#' + buf[0] + buf[1];
-
-            // Parse parameters
-            msg->nbPars  = 0;
-            while (!done && !error) {
-                n = WaitForBytes(buf, 4, 10 / portTICK_RATE_MS);
-                if (n > 0 && buf[n - 1] == '\r') {
-                    n--;
-                    // This is the end of the message
-                    // Get check bytes
-                    if (n >= 2) {
-                        unsigned int msgCeckVal;
-                        msgCeckVal = (buf[n - 1] - '=') + (buf[n - 2] - '=') * 64;
-                        // printf("%x %x\n", msgCeckVal, checkVal&0xFFF);
-                        n -= 2;
-
-                        if (msgCeckVal == (checkVal & 0xFFF)) {
-                            done = TRUE;
-                        } else {
-                            OnError(__LINE__);
-                            error = TRUE;
-                        }
-                    } else {
-                        OnError(__LINE__);
-                        error = TRUE;
-                    }
-                } else if (n == 4) {
-                    // Parse parameters
-                    int i;
-                    for (i = 0; i < 4; i++) {
-                        checkVal += buf[i];
-                        buf[i]   -= '=';
-                    }
-                    if (msg->nbPars < MAX_NB_PARS) {
-                        msg->pars[msg->nbPars] = (((buf[0] << 2) & 0xFF) | ((buf[1] >> 4)));
-                        msg->nbPars++;
-                    }
-                    if (msg->nbPars < MAX_NB_PARS) {
-                        msg->pars[msg->nbPars] = ((buf[1] & 0x0F) << 4 | (buf[2] >> 2));
-                        msg->nbPars++;
-                    }
-                    if (msg->nbPars < MAX_NB_PARS) {
-                        msg->pars[msg->nbPars] = ((buf[2] & 0x03) << 6 | buf[3]);
-                        msg->nbPars++;
-                    }
-                } else {
-                    OnError(__LINE__);
-                    error = TRUE;
-                }
-            }
-        }
+    if (n < 2 || (n - 2) % 4) {
+        OnError(__LINE__);
+        return false;
+    }
+    uint16_t checkVal   = decoder->checkVal - decoder->chars[n - 1] - decoder->chars[n - 2];
+    uint16_t msgCeckVal = (decoder->chars[n - 1] - '=') + (decoder->chars[n - 2] - '=') * 64;
+    if (msgCeckVal != (checkVal & 0xFFF)) {
+        OnError(__LINE__);
+        return false;
     }
 
-    return done && !error;
+    msg->address = decoder->address - 'a';
+    msg->cmd     = decoder->cmd;
+    msg->nbPars  = 0;
+    for (uint8_t i = 0; i + 2 < n; i += 4) {
+        const uint8_t a = decoder->chars[i] - '=';
+        const uint8_t b = decoder->chars[i + 1] - '=';
+        const uint8_t c = decoder->chars[i + 2] - '=';
+        const uint8_t d = decoder->chars[i + 3] - '=';
+        msg->pars[msg->nbPars++] = ((a << 2) & 0xFF) | (b >> 4);
+        msg->pars[msg->nbPars++] = ((b & 0x0F) << 4) | (c >> 2);
+        msg->pars[msg->nbPars++] = ((c & 0x03) << 6) | d;
+    }
+    return true;
 }
 
 static void SendMsg(const MkMsg_t *msg)
@@ -409,140 +392,154 @@ static uint16_t VersionMsg_GetVersion(const MkMsg_t *msg)
     return msg->pars[0] * 100 + msg->pars[1];
 }
 
-static void DoConnectedToFC(void)
+static MkLink_t mkLink = MK_LINK_DISCONNECTED;
+static portTickType lastMsgTime;
+
+static void OnDebugMsg(const MkMsg_t *msg)
 {
     AttitudeStateData attitudeData;
-    MkMsg_t msg;
+    int16_t nick;
+    int16_t roll;
 
-    DEBUG_MSG("FC\n\r");
+    nick = Par2Int16(msg, DEBUG_MSG_NICK_IDX);
+    roll = Par2Int16(msg, DEBUG_MSG_ROLL_IDX);
 
-    memset(&attitudeData, 0, sizeof(attitudeData));
+    DEBUG_MSG("Att: Nick=%5d Roll=%5d\n\r", nick, roll);
 
-    // Configure FC for fast reporting of the debug-message
-    SendMsgPar8(MK_ADDR_ALL, MSGCMD_GET_DEBUG, 10);
-
-    while (TRUE) {
-        if (WaitForMsg(MSGCMD_DEBUG, &msg, 500 / portTICK_RATE_MS)) {
-            int16_t nick;
-            int16_t roll;
-
-            // PrintMsg(&msg);
-            nick = Par2Int16(&msg, DEBUG_MSG_NICK_IDX);
-            roll = Par2Int16(&msg, DEBUG_MSG_ROLL_IDX);
-
-            DEBUG_MSG("Att: Nick=%5d Roll=%5d\n\r", nick, roll);
-
-            attitudeData.Pitch = -(float)nick / 10;
-            attitudeData.Roll  = -(float)roll / 10;
-            AttitudeStateSet(&attitudeData);
-        } else {
-            DEBUG_MSG("TO\n\r");
-            break;
-        }
-    }
+    AttitudeStateGet(&attitudeData);
+    attitudeData.Pitch = -(float)nick / 10;
+    attitudeData.Roll  = -(float)roll / 10;
+    AttitudeStateSet(&attitudeData);
 }
 
-static void DoConnectedToNC(void)
+static void OnOsdMsg(const MkMsg_t *msg)
 {
-    MkMsg_t msg;
     GpsPosition_t pos;
     AttitudeStateData attitudeData;
-    PositionStateData positionData;
-    FlightBatteryStateData flightBatteryData;
+    GPSPositionSensorData positionData;
 
 #ifdef GENERATE_BATTERY_INFO
-    uint8_t battStateCnt = 0;
+    static uint8_t battStateCnt = 0;
 #endif
 
-    DEBUG_MSG("NC\n\r");
-
-    memset(&attitudeData, 0, sizeof(attitudeData));
-    memset(&positionData, 0, sizeof(positionData));
-    memset(&flightBatteryData, 0, sizeof(flightBatteryData));
-
-    // Configure NC for fast reporting of the osd-message
-    SendMsgPar8(MK_ADDR_ALL, MSGCMD_GET_OSD, 10);
-
-    while (TRUE) {
-        if (WaitForMsg(MSGCMD_OSD, &msg, 500 / portTICK_RATE_MS)) {
-            // PrintMsg(&msg);
-            GetGpsPos(&msg, OSD_MSG_CURRPOS_IDX, &pos);
+    GetGpsPos(msg, OSD_MSG_CURRPOS_IDX, &pos);
+    DEBUG_MSG(".");
+
+    AttitudeStateGet(&attitudeData);
+    attitudeData.Pitch       = -Par2Int8(msg, OSD_MSG_NICK_IDX);
+    attitudeData.Roll        = -Par2Int8(msg, OSD_MSG_ROLL_IDX);
+    AttitudeStateSet(&attitudeData);
+
+    GPSPositionSensorGet(&positionData);
+    positionData.Longitude   = Par2Int32(msg, OSD_MSG_CURRPOS_IDX);
+    positionData.Latitude    = Par2Int32(msg, OSD_MSG_CURRPOS_IDX + 4);
+    positionData.Altitude    = pos.altitude;
+    positionData.Satellites  = msg->pars[OSD_MSG_NB_SATS_IDX];
+    positionData.Heading     = Par2Int16(msg, OSD_MSG_COMPHEADING_IDX);
+    positionData.Groundspeed = ((float)Par2Int16(msg, OSD_MSG_GNDSPEED_IDX)) / 100 /* cm/s => m/s */;
+    if (positionData.Satellites < 5) {
+        positionData.Status = GPSPOSITIONSENSOR_STATUS_NOFIX;
+    } else {
+        positionData.Status = GPSPOSITIONSENSOR_STATUS_FIX3D;
+    }
+    GPSPositionSensorSet(&positionData);
 
-#if 0
-            DEBUG_MSG("Bat=%d\n\r", msg.pars[OSD_MSG_BATT_IDX]);
-            DEBUG_MSG("Nick=%d Roll=%d\n\r", Par2Int8(&msg, OSD_MSG_NICK_IDX), Par2Int8(&msg, OSD_MSG_ROLL_IDX));
-            DEBUG_MSG("POS #Sats=%d stat=%d lat=%d lon=%d alt=%d\n\r", msg.pars[OSD_MSG_NB_SATS_IDX], pos.status, (int)pos.latitude,
-                      (int)pos.longitute, (int)pos.altitude);
-#else
-            DEBUG_MSG(".");
+#ifdef GENERATE_BATTERY_INFO
+    if (++battStateCnt > 2) {
+        FlightBatteryStateData flightBatteryData;
+        FlightBatteryStateGet(&flightBatteryData);
+        flightBatteryData.Voltage = (float)msg->pars[OSD_MSG_BATT_IDX] / 10;
+        FlightBatteryStateSet(&flightBatteryData);
+        battStateCnt = 0;
+    }
 #endif
-            attitudeData.Pitch       = -Par2Int8(&msg, OSD_MSG_NICK_IDX);
-            attitudeData.Roll        = -Par2Int8(&msg, OSD_MSG_ROLL_IDX);
-            AttitudeStateSet(&attitudeData);
-
-            positionData.Longitude   = pos.longitute;
-            positionData.Latitude    = pos.latitude;
-            positionData.Altitude    = pos.altitude;
-            positionData.Satellites  = msg.pars[OSD_MSG_NB_SATS_IDX];
-            positionData.Heading     = Par2Int16(&msg, OSD_MSG_COMPHEADING_IDX);
-            positionData.Groundspeed = ((float)Par2Int16(&msg, OSD_MSG_GNDSPEED_IDX)) / 100 /* cm/s => m/s */;
-            if (positionData.Satellites < 5) {
-                positionData.Status = POSITIONACTUAL_STATUS_NOFIX;
-            } else {
-                positionData.Status = POSITIONACTUAL_STATUS_FIX3D;
-            }
-            PositionStateSet(&positionData);
+}
 
-#if GENERATE_BATTERY_INFO
-            if (++battStateCnt > 2) {
-                flightBatteryData.Voltage = (float)msg.pars[OSD_MSG_BATT_IDX] / 10;
-                FlightBatteryStateSet(&flightBatteryData);
-                battStateCnt = 0;
-            }
-#endif
-        } else {
-            DEBUG_MSG("TO\n\r");
-            break;
+// Dispatch a decoded message, the subscribed ones keep the link up
+static void OnMsg(const MkMsg_t *msg)
+{
+    switch (msg->cmd) {
+    case MSGCMD_VERSION:
+        if (mkLink == MK_LINK_DISCONNECTED && msg->nbPars >= 2) {
+            uint16_t version = VersionMsg_GetVersion(msg);
+            DEBUG_MSG("Version %d\n\r", version);
+            // Dependent on version, decide it we are connected to NC or FC
+            // TODO: use slave-addr to distinguish FC/NC -> much safer
+            mkLink = (version < 60) ? MK_LINK_NC : MK_LINK_FC;
+            lastMsgTime = xTaskGetTickCount();
         }
+        break;
+    case MSGCMD_DEBUG:
+        if (mkLink == MK_LINK_FC && msg->nbPars > DEBUG_MSG_ROLL_IDX + 1) {
+            OnDebugMsg(msg);
+            lastMsgTime = xTaskGetTickCount();
+        }
+        break;
+    case MSGCMD_OSD:
+        if (mkLink == MK_LINK_NC && msg->nbPars > OSD_MSG_ROLL_IDX) {
+            OnOsdMsg(msg);
+            lastMsgTime = xTaskGetTickCount();
+        }
+        break;
+    default:
+        break;
     }
 }
 
+/**
+ * The task only sleeps in the port receive. The bytes are decoded as blocks arrive,
+ * the requests are sent on schedule whatever the replies, and the data goes to the
+ * UAVObjects as soon as a frame is complete, at the rate the board streams it.
+ */
 static void MkSerialTask(__attribute__((unused)) void *parameters)
 {
-    MkMsg_t msg;
-    uint32_t version;
-    bool connectionOk = FALSE;
+    static MkDecoder_t decoder;
+    static MkMsg_t msg;
+    uint8_t rxBlock[RX_BLOCK_SIZE];
+    portTickType lastRequestTime;
+    MkLink_t requestedLink = MK_LINK_DISCONNECTED;
 
     PIOS_COM_ChangeBaud(PORT, 57600);
     PIOS_COM_ChangeBaud(DEBUG_PORT, 57600);
 
     DEBUG_MSG("MKSerial Started\n\r");
 
+    memset(&decoder, 0, sizeof(decoder));
+    decoder.state   = MK_WAIT_START;
+    lastRequestTime = xTaskGetTickCount() - SUBSCRIPTION_RENEW_MS / portTICK_RATE_MS;
+
     while (1) {
-        // Wait until we get version from MK
-        while (!connectionOk) {
-            SendMsgParNone(MK_ADDR_ALL, MSGCMD_GET_VERSION);
-            DEBUG_MSG("Version... ");
-            if (WaitForMsg(MSGCMD_VERSION, &msg, 250 / portTICK_RATE_MS)) {
-                version = VersionMsg_GetVersion(&msg);
-                DEBUG_MSG("%d\n\r", version);
-                connectionOk = TRUE;
-            } else {
-                DEBUG_MSG("TO\n\r");
+        uint16_t n = PIOS_COM_ReceiveBuffer(PORT, rxBlock, sizeof(rxBlock), VERSION_RETRY_MS / 2);
+
+        for (uint16_t i = 0; i < n; i++) {
+            if (DecodeByte(&decoder, rxBlock[i], &msg)) {
+                OnMsg(&msg);
             }
         }
 
-        // Dependent on version, decide it we are connected to NC or FC
-        // TODO: use slave-addr to distinguish FC/NC -> much safer
-        if (version < 60) {
-            DoConnectedToNC(); // Will only return after an error
-        } else {
-            DoConnectedToFC(); // Will only return after an error
+        portTickType now = xTaskGetTickCount();
+        if (mkLink != MK_LINK_DISCONNECTED && (now - lastMsgTime) >= LINK_TIMEOUT_MS / portTICK_RATE_MS) {
+            DEBUG_MSG("TO\n\r");
+            mkLink = MK_LINK_DISCONNECTED;
         }
 
-        connectionOk = FALSE;
-
-        vTaskDelay(250 / portTICK_RATE_MS);
+        // A new link is subscribed at once, then the request is repeated on schedule
+        uint32_t period = (mkLink == MK_LINK_DISCONNECTED) ? VERSION_RETRY_MS : SUBSCRIPTION_RENEW_MS;
+        if (mkLink != requestedLink || (now - lastRequestTime) >= period / portTICK_RATE_MS) {
+            switch (mkLink) {
+            case MK_LINK_DISCONNECTED:
+                SendMsgParNone(MK_ADDR_ALL, MSGCMD_GET_VERSION);
+                break;
+            case MK_LINK_FC:
+                SendMsgPar8(MK_ADDR_ALL, MSGCMD_GET_DEBUG, REPORT_INTERVAL);
+                break;
+            case MK_LINK_NC:
+                SendMsgPar8(MK_ADDR_ALL, MSGCMD_GET_OSD, REPORT_INTERVAL);
+                break;
+            }
+            requestedLink   = mkLink;
+            lastRequestTime = now;
+        }
     }
 }
 
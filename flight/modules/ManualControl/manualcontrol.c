@@ -57,6 +57,8 @@
 
 #define CALLBACK_PRIORITY                              CALLBACK_PRIORITY_REGULAR
 #define CBTASK_PRIORITY                                CALLBACK_TASK_FLIGHTCONTROL
+// settings uploads arrive as a burst of updates, check once they settled
+#define CONFIGURATION_CHECK_DELAY_MS                   100
 
 #define ASSISTEDCONTROL_NEUTRALTHROTTLERANGE_FACTOR    0.2f
 #define ASSISTEDCONTROL_BRAKETHRUST_DEADBAND_FACTOR_LO 0.92f
@@ -108,9 +110,11 @@ static float thrustHi = 0.0f;
 #endif /* ifndef PIOS_EXCLUDE_ADVANCED_FEATURES */
 // Private variables
 static DelayedCallbackInfo *callbackHandle;
+static DelayedCallbackInfo *configurationCheckHandle;
 
 // Private functions
 static void configurationUpdatedCb(UAVObjEvent *ev);
+static void configurationCheckTask(void);
 static void commandUpdatedCb(UAVObjEvent *ev);
 static void manualControlTask(void);
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
@@ -130,6 +134,8 @@ int32_t ManualControlStart()
     // Whenever the configuration changes, make sure it is safe to fly
     SystemSettingsConnectCallback(configurationUpdatedCb);
     ManualControlSettingsConnectCallback(configurationUpdatedCb);
+    FlightModeSettingsConnectCallback(configurationUpdatedCb);
+    StabilizationSettingsConnectCallback(configurationUpdatedCb);
     ManualControlCommandConnectCallback(commandUpdatedCb);
 
     // clear alarms
@@ -166,6 +172,7 @@ int32_t ManualControlInitialize()
     VtolPathFollowerSettingsInitialize();
 #endif
     callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&manualControlTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_MANUALCONTROL, STACK_SIZE_BYTES);
+    configurationCheckHandle = PIOS_CALLBACKSCHEDULER_Create(&configurationCheckTask, CALLBACK_PRIORITY_LOW, CALLBACK_TASK_AUXILIARY, CALLBACKINFO_RUNNING_CONFIGURATIONCHECK, STACK_SIZE_BYTES);
 
     return 0;
 }
@@ -187,13 +194,18 @@ static void manualControlTask(void)
     FlightStatusGet(&flightStatus);
     ManualControlCommandData cmd;
     ManualControlCommandGet(&cmd);
+    // the settings are only read again after they changed
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
-    VtolPathFollowerSettingsThrustLimitsData thrustLimits;
-    VtolPathFollowerSettingsThrustLimitsGet(&thrustLimits);
+    static VtolPathFollowerSettingsThrustLimitsData thrustLimits;
+    static uint32_t vtolPathFollowerSettingsChange = 0;
+    if (VtolPathFollowerSettingsChanged(&vtolPathFollowerSettingsChange)) {
+        VtolPathFollowerSettingsThrustLimitsGet(&thrustLimits);
+    }
 #endif
 
-    FlightModeSettingsData modeSettings;
-    FlightModeSettingsGet(&modeSettings);
+    static FlightModeSettingsData modeSettings;
+    static uint32_t modeSettingsChange = 0;
+    FlightModeSettingsGetIfChanged(&modeSettings, &modeSettingsChange);
 
     uint8_t position = cmd.FlightModeSwitchPosition;
     uint8_t newMode  = flightStatus.FlightMode;
@@ -441,6 +453,12 @@ static void manualControlTask(void)
  * Called whenever a critical configuration component changes
  */
 static void configurationUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    // every update pushes the check back, so a bulk upload runs it once
+    PIOS_CALLBACKSCHEDULER_Schedule(configurationCheckHandle, CONFIGURATION_CHECK_DELAY_MS, CALLBACK_UPDATEMODE_LATER);
+}
+
+static void configurationCheckTask(void)
 {
     configuration_check();
 }
@@ -39,7 +39,9 @@
 #include <pios_mem.h>
 #include <hwsettings.h>
 
-#define SAMPLE_PERIOD_MS 250
+// alarm changes are handled as they happen, the timer only repeats notifications
+// for alarms that stay active
+#define REPEAT_PERIOD_MS 1000
 // private types
 typedef struct {
     uint32_t lastAlarmTime;
@@ -47,7 +49,7 @@ typedef struct {
 } AlarmStatus_t;
 // function declarations
 static void updatedCb(UAVObjEvent *ev);
-static void onTimerCb(UAVObjEvent *ev);
+static void alarmsUpdatedCb(UAVObjEvent *ev);
 static void checkAlarm(uint8_t alarm, uint8_t *last_alarm, uint32_t *last_alm_time,
                        uint8_t warn_sequence, uint8_t error_sequence,
                        uint32_t timeBetweenNotifications);
@@ -68,11 +70,13 @@ int32_t NotifyInitialize(void)
         }
 
         FlightStatusConnectCallback(&updatedCb);
+        SystemAlarmsConnectCallback(&alarmsUpdatedCb);
         static UAVObjEvent ev;
         memset(&ev, 0, sizeof(UAVObjEvent));
-        EventPeriodicCallbackCreate(&ev, onTimerCb, SAMPLE_PERIOD_MS / portTICK_RATE_MS);
+        EventPeriodicCallbackCreate(&ev, alarmsUpdatedCb, REPEAT_PERIOD_MS / portTICK_RATE_MS);
 
         updatedCb(0);
+        alarmsUpdatedCb(0);
     }
     return 0;
 }
@@ -100,7 +104,7 @@ void updatedCb(UAVObjEvent *ev)
     }
 }
 
-void onTimerCb(__attribute__((unused)) UAVObjEvent *ev)
+void alarmsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     static SystemAlarmsAlarmData alarms;
 
@@ -120,7 +124,7 @@ void checkAlarm(uint8_t alarm, uint8_t *last_alarm, uint32_t *last_alm_time, uin
 {
     if (alarm > SYSTEMALARMS_ALARM_OK) {
         uint32_t current_time = PIOS_DELAY_GetuS();
-        if (*last_alarm < alarm || *last_alm_time + timeBetweenNotifications * 1000 < current_time) {
+        if (*last_alarm < alarm || PIOS_DELAY_GetuSSince(*last_alm_time) > timeBetweenNotifications * 1000) {
             uint8_t sequence = (alarm == SYSTEMALARMS_ALARM_WARNING) ? warn_sequence : error_sequence;
             if (sequence != NOTIFY_SEQUENCE_NULL) {
                 PIOS_NOTIFICATION_Default_Ext_Led_Play(
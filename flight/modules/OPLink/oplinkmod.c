@@ -44,6 +44,7 @@
 #include <openpilot.h>
 
 #include <oplinkstatus.h>
+#include <oplinksettings.h>
 #include <taskinfo.h>
 
 #include <pios_rfm22b.h>
@@ -51,6 +52,7 @@
 
 // Private constants
 #define SYSTEM_UPDATE_PERIOD_MS 1000
+#define MIN_STATUS_PERIOD_MS    100
 
 #if defined(PIOS_SYSTEM_STACK_SIZE)
 #define STACK_SIZE_BYTES        PIOS_SYSTEM_STACK_SIZE
@@ -69,6 +71,7 @@ static bool mallocFailed;
 
 // Private functions
 static void systemTask(void *parameters);
+static void updateLinkSummary(OPLinkStatusData *oplinkStatus, bool logSamples);
 
 /**
  * Create the module task.
@@ -104,13 +107,19 @@ int32_t OPLinkModInitialize(void)
 MODULE_INITCALL(OPLinkModInitialize, 0);
 
 /**
- * System task, periodically executes every SYSTEM_UPDATE_PERIOD_MS
+ * System task, periodically executes every OPLinkSettings.StatusPeriod
  */
 static void systemTask(__attribute__((unused)) void *parameters)
 {
     portTickType lastSysTime;
+    portTickType lastStatusTime;
+    uint32_t settingsChange = 0;
+    uint16_t period_ms = SYSTEM_UPDATE_PERIOD_MS;
+    bool logSamples    = false;
     uint16_t prev_tx_count = 0;
     uint16_t prev_rx_count = 0;
+    uint16_t prev_payload_count = 0;
+    uint16_t prev_airtime_ms    = 0;
     bool first_time = true;
 
     /* create all modules thread */
@@ -128,10 +137,22 @@ static void systemTask(__attribute__((unused)) void *parameters)
     }
 
     // Initialize vars
-    lastSysTime = xTaskGetTickCount();
+    lastSysTime    = xTaskGetTickCount();
+    lastStatusTime = lastSysTime;
 
     // Main system loop
     while (1) {
+        OPLinkSettingsData oplinkSettings;
+        if (OPLinkSettingsGetIfChanged(&oplinkSettings, &settingsChange)) {
+            period_ms  = (oplinkSettings.StatusPeriod) ? MAX(MIN_STATUS_PERIOD_MS, oplinkSettings.StatusPeriod) : SYSTEM_UPDATE_PERIOD_MS;
+            logSamples = (oplinkSettings.LogPacketSamples == OPLINKSETTINGS_LOGPACKETSAMPLES_TRUE);
+        }
+
+        // The rates are computed over the time actually elapsed, the period may just have changed
+        portTickType now    = xTaskGetTickCount();
+        uint32_t elapsed_ms = MAX(1, (now - lastStatusTime) * portTICK_RATE_MS);
+        lastStatusTime = now;
+
         // Flash the heartbeat LED
 #if defined(PIOS_LED_HEARTBEAT)
         PIOS_LED_Toggle(PIOS_LED_HEARTBEAT);
@@ -170,14 +191,23 @@ static void systemTask(__attribute__((unused)) void *parameters)
                 uint16_t rx_count = radio_stats.rx_byte_count;
                 uint16_t tx_bytes = (tx_count < prev_tx_count) ? (0xffff - prev_tx_count + tx_count) : (tx_count - prev_tx_count);
                 uint16_t rx_bytes = (rx_count < prev_rx_count) ? (0xffff - prev_rx_count + rx_count) : (rx_count - prev_rx_count);
-                oplinkStatus.TXRate = (uint16_t)((float)(tx_bytes * 1000) / SYSTEM_UPDATE_PERIOD_MS);
-                oplinkStatus.RXRate = (uint16_t)((float)(rx_bytes * 1000) / SYSTEM_UPDATE_PERIOD_MS);
+                oplinkStatus.TXRate = (uint16_t)((float)(tx_bytes * 1000) / elapsed_ms);
+                oplinkStatus.RXRate = (uint16_t)((float)(rx_bytes * 1000) / elapsed_ms);
+                // Goodput only counts the com data, airtime is the share of the period spent transmitting
+                uint16_t payload_bytes = radio_stats.tx_payload_count - prev_payload_count;
+                uint16_t airtime_ms    = radio_stats.tx_airtime_ms - prev_airtime_ms;
+                oplinkStatus.TXGoodput = (uint16_t)((float)(payload_bytes * 1000) / elapsed_ms);
+                oplinkStatus.TXAirtime = (uint8_t)MIN(100, (uint32_t)airtime_ms * 100 / elapsed_ms);
                 prev_tx_count = tx_count;
                 prev_rx_count = rx_count;
             }
+            prev_payload_count = radio_stats.tx_payload_count;
+            prev_airtime_ms    = radio_stats.tx_airtime_ms;
+            oplinkStatus.TXPacketLength = radio_stats.tx_packet_len;
             oplinkStatus.TXSeq     = radio_stats.tx_seq;
             oplinkStatus.RXSeq     = radio_stats.rx_seq;
             oplinkStatus.LinkState = radio_stats.link_state;
+            updateLinkSummary(&oplinkStatus, logSamples);
         } else {
             oplinkStatus.LinkState = OPLINKSTATUS_LINKSTATE_DISABLED;
         }
@@ -192,7 +222,46 @@ static void systemTask(__attribute__((unused)) void *parameters)
         OPLinkStatusSet(&oplinkStatus);
 
         // Wait until next period
-        vTaskDelayUntil(&lastSysTime, SYSTEM_UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        vTaskDelayUntil(&lastSysTime, period_ms / portTICK_RATE_MS);
+    }
+}
+
+/**
+ * Publish the packet counters of the last period, and log the samples of the packets
+ * received since when enabled.
+ */
+static void updateLinkSummary(OPLinkStatusData *oplinkStatus, bool logSamples)
+{
+    struct rfm22b_link_summary summary;
+
+    PIOS_RFM22B_GetLinkSummary(pios_rfm22b_id, &summary);
+    oplinkStatus->RxPackets.Good      = summary.rx_packets[0];
+    oplinkStatus->RxPackets.Corrected = summary.rx_packets[1];
+    oplinkStatus->RxPackets.Error     = summary.rx_packets[2];
+    oplinkStatus->RxPackets.Failure   = summary.rx_packets[3];
+    oplinkStatus->TxPackets.Sent   = summary.tx_packets;
+    oplinkStatus->TxPackets.Failed = summary.tx_failures;
+
+    uint32_t rssi_packets = 0;
+    for (uint8_t i = 0; i < RFM22B_RSSI_BUCKETS; ++i) {
+        rssi_packets += summary.rx_rssi_histogram[i];
+    }
+    for (uint8_t i = 0; i < RFM22B_RSSI_BUCKETS; ++i) {
+        oplinkStatus->RSSIHistogram[i] = (rssi_packets) ? (uint8_t)((uint32_t)summary.rx_rssi_histogram[i] * 100 / rssi_packets) : 0;
+    }
+    if (rssi_packets) {
+        oplinkStatus->RSSIMin     = summary.rx_rssi_min;
+        oplinkStatus->RSSIMax     = summary.rx_rssi_max;
+        oplinkStatus->RSSIAverage = (int8_t)(summary.rx_rssi_sum / (int32_t)rssi_packets);
+    }
+
+    // Drained even when not logged, the ring would hold stale samples otherwise
+    static struct rfm22b_packet_sample samples[8];
+    uint8_t n;
+    while ((n = PIOS_RFM22B_GetPacketSamples(pios_rfm22b_id, samples, NELEMENTS(samples))) > 0) {
+        for (uint8_t i = 0; logSamples && i < n; ++i) {
+            PIOS_DEBUGLOG_PRINTF("RFM22B packet %u rssi %d status %u", samples[i].time_ms, samples[i].rssi, samples[i].status);
+        }
     }
 }
 
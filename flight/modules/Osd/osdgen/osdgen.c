@@ -50,6 +50,13 @@
 #include "WMMInternal.h"
 
 #include "splash.h"
+
+#include <pios_instrumentation_helper.h>
+PERF_DEFINE_COUNTER(counterRender);
+PERF_DEFINE_COUNTER(counterPeriod);
+PERF_DEFINE_COUNTER(counterLineMax);
+PERF_DEFINE_COUNTER(counterLineAvg);
+PERF_DEFINE_COUNTER(counterLateFrames);
 /*
    static uint16_t angleA=0;
    static int16_t angleB=90;
@@ -379,6 +386,43 @@ void write_pixel_lm(unsigned int x, unsigned int y, int mmode, int lmode)
     WRITE_WORD_MODE(draw_buffer_level, wordnum, mask, lmode);
 }
 
+/**
+ * write_span: write whole bytes addr0 to addr1 (inclusive) of a buffer.
+ * Set and clear go through memset, toggle runs a word at a time once the
+ * pointer is word aligned.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       addr0   first byte
+ * @param       addr1   last byte
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+static void write_span(uint8_t *buff, unsigned int addr0, unsigned int addr1, int mode)
+{
+    uint8_t *p   = &buff[addr0];
+    uint8_t *end = &buff[addr1 + 1];
+
+    switch (mode) {
+    case 0:
+        memset(p, 0x00, end - p);
+        break;
+    case 1:
+        memset(p, 0xff, end - p);
+        break;
+    case 2:
+        while (p < end && ((uintptr_t)p & 3)) {
+            *p++ ^= 0xff;
+        }
+        while (p + 4 <= end) {
+            *(uint32_t *)p ^= 0xffffffff;
+            p += 4;
+        }
+        while (p < end) {
+            *p++ ^= 0xff;
+        }
+        break;
+    }
+}
+
 /**
  * write_hline: optimised horizontal line writing algorithm
  *
@@ -404,7 +448,7 @@ void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y
     int addr1     = CALC_BUFF_ADDR(x1, y);
     int addr0_bit = CALC_BIT_IN_WORD(x0);
     int addr1_bit = CALC_BIT_IN_WORD(x1);
-    int mask, mask_l, mask_r, i;
+    int mask, mask_l, mask_r;
     /* If the addresses are equal, we only need to write one word
      * which is an island. */
     if (addr0 == addr1) {
@@ -416,10 +460,9 @@ void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y
         mask_r = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
         WRITE_WORD_MODE(buff, addr0, mask_l, mode);
         WRITE_WORD_MODE(buff, addr1, mask_r, mode);
-        // Now write 0xffff words from start+1 to end-1.
-        for (i = addr0 + 1; i <= addr1 - 1; i++) {
-            uint8_t m = 0xff;
-            WRITE_WORD_MODE(buff, i, m, mode);
+        // Now write 0xff bytes from start+1 to end-1.
+        if (addr1 > addr0 + 1) {
+            write_span(buff, addr0 + 1, addr1 - 1, mode);
         }
     }
 }
@@ -567,8 +610,6 @@ void write_vline_outlined(unsigned int x, unsigned int y0, unsigned int y1, int
  */
 void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsigned int width, unsigned int height, int mode)
 {
-    unsigned int yy, addr0_old, addr1_old;
-
     CHECK_COORDS(x, y);
     CHECK_COORD_X(x + width);
     CHECK_COORD_Y(y + height);
@@ -581,7 +622,7 @@ void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsig
     unsigned int addr1     = CALC_BUFF_ADDR(x + width, y);
     unsigned int addr0_bit = CALC_BIT_IN_WORD(x);
     unsigned int addr1_bit = CALC_BIT_IN_WORD(x + width);
-    unsigned int mask, mask_l, mask_r, i;
+    unsigned int mask, mask_l, mask_r;
     // If the addresses are equal, we need to write one word vertically.
     if (addr0 == addr1) {
         mask = COMPUTE_HLINE_ISLAND_MASK(addr0_bit, addr1_bit);
@@ -590,32 +631,17 @@ void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsig
             addr0 += GRAPHICS_WIDTH_REAL / 8;
         }
     } else {
-        // Otherwise we need to write the edges and then the middle repeatedly.
-        mask_l    = COMPUTE_HLINE_EDGE_L_MASK(addr0_bit);
-        mask_r    = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
-        // Write edges first.
-        yy        = 0;
-        addr0_old = addr0;
-        addr1_old = addr1;
-        while (yy < height) {
+        // Otherwise we need to write the edges and then the middle of each row.
+        mask_l = COMPUTE_HLINE_EDGE_L_MASK(addr0_bit);
+        mask_r = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
+        while (height--) {
             WRITE_WORD_MODE(buff, addr0, mask_l, mode);
             WRITE_WORD_MODE(buff, addr1, mask_r, mode);
-            addr0 += GRAPHICS_WIDTH_REAL / 8;
-            addr1 += GRAPHICS_WIDTH_REAL / 8;
-            yy++;
-        }
-        // Now write 0xffff words from start+1 to end-1 for each row.
-        yy    = 0;
-        addr0 = addr0_old;
-        addr1 = addr1_old;
-        while (yy < height) {
-            for (i = addr0 + 1; i <= addr1 - 1; i++) {
-                uint8_t m = 0xff;
-                WRITE_WORD_MODE(buff, i, m, mode);
+            if (addr1 > addr0 + 1) {
+                write_span(buff, addr0 + 1, addr1 - 1, mode);
             }
             addr0 += GRAPHICS_WIDTH_REAL / 8;
             addr1 += GRAPHICS_WIDTH_REAL / 8;
-            yy++;
         }
     }
 }
@@ -957,7 +983,7 @@ void write_word_misaligned(uint8_t *buff, uint16_t word, unsigned int addr, unsi
     int16_t firstmask = word >> xoff;
     int16_t lastmask  = word << (16 - xoff);
 
-    WRITE_WORD_MODE(buff, addr + 1, firstmask && 0x00ff, mode);
+    WRITE_WORD_MODE(buff, addr + 1, firstmask & 0x00ff, mode);
     WRITE_WORD_MODE(buff, addr, (firstmask & 0xff00) >> 8, mode);
     if (xoff > 0) {
         WRITE_WORD_MODE(buff, addr + 2, (lastmask & 0xff00) >> 8, mode);
@@ -1036,6 +1062,33 @@ void write_word_misaligned_lm(uint16_t wordl, uint16_t wordm, unsigned int addr,
     write_word_misaligned(draw_buffer_mask, wordm, addr, xoff, mmode);
 }
 
+/**
+ * write_glyph_row: Write one row of a character on both draw buffers.
+ * Sets the mask bits, sets the level bits under the mask and clears the
+ * level bits in nand. This does what write_word_misaligned_OR on the mask
+ * and write_word_misaligned_OR/_NAND on the level do, but touches each
+ * byte once.
+ *
+ * @param       addr    address of first word
+ * @param       xoff    x offset (0-7)
+ * @param       mask    mask bits (16 bits)
+ * @param       nand    level bits to clear (16 bits)
+ */
+static inline void write_glyph_row(unsigned int addr, unsigned int xoff, uint16_t mask, uint16_t nand)
+{
+    uint32_t m = ((uint32_t)mask << 8) >> xoff;
+    uint32_t n = ((uint32_t)nand << 8) >> xoff;
+
+    draw_buffer_mask[addr]      |= m >> 16;
+    draw_buffer_level[addr]      = (draw_buffer_level[addr] | (m >> 16)) & ~(n >> 16);
+    draw_buffer_mask[addr + 1]  |= m >> 8;
+    draw_buffer_level[addr + 1]  = (draw_buffer_level[addr + 1] | (m >> 8)) & ~(n >> 8);
+    if (xoff > 0) {
+        draw_buffer_mask[addr + 2]  |= m;
+        draw_buffer_level[addr + 2]  = (draw_buffer_level[addr + 2] | m) & ~n;
+    }
+}
+
 /**
  * fetch_font_info: Fetch font info structs.
  *
@@ -1073,7 +1126,7 @@ int fetch_font_info(uint8_t ch, int font, struct FontEntry *font_info, char *loo
  */
 void write_char16(char ch, unsigned int x, unsigned int y, int font)
 {
-    unsigned int yy, addr_temp, row, row_temp, xshift;
+    unsigned int yy, row, xshift;
     uint16_t and_mask, or_mask, levels;
     struct FontEntry font_info;
 
@@ -1093,26 +1146,12 @@ void write_char16(char ch, unsigned int x, unsigned int y, int font)
             return;
         }
         // Load data pointer.
-        row       = ch * font_info.height;
-        row_temp  = row;
-        addr_temp = addr;
-        xshift    = 16 - font_info.width;
-        // We can write mask words easily.
-        for (yy = y; yy < y + font_info.height; yy++) {
-            if (font == 3) {
-                write_word_misaligned_OR(draw_buffer_mask, font_mask12x18[row] << xshift, addr, wbit);
-            } else {
-                write_word_misaligned_OR(draw_buffer_mask, font_mask8x10[row] << xshift, addr, wbit);
-            }
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-        // Level bits are more complicated. We need to set or clear
-        // level bits, but only where the mask bit is set; otherwise,
-        // we need to leave them alone. To do this, for each word, we
-        // construct an AND mask and an OR mask, and apply each individually.
-        row  = row_temp;
-        addr = addr_temp;
+        row    = ch * font_info.height;
+        xshift = 16 - font_info.width;
+        // Mask words are written as they are. Level bits are more complicated.
+        // We need to set or clear level bits, but only where the mask bit is
+        // set; otherwise, we need to leave them alone. To do this, for each
+        // word, we construct an AND mask and an OR mask, and apply both.
         for (yy = y; yy < y + font_info.height; yy++) {
             if (font == 3) {
                 levels   = font_frame12x18[row];
@@ -1127,10 +1166,9 @@ void write_char16(char ch, unsigned int x, unsigned int y, int font)
                 or_mask  = font_mask8x10[row] << xshift;
                 and_mask = (font_mask8x10[row] & levels) << xshift;
             }
-            write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
             // If we're not bold write the AND mask.
             // if(!(flags & FONT_BOLD))
-            write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
+            write_glyph_row(addr, wbit, or_mask, and_mask);
             addr += GRAPHICS_WIDTH_REAL / 8;
             row++;
         }
@@ -1150,7 +1188,7 @@ void write_char16(char ch, unsigned int x, unsigned int y, int font)
  */
 void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
 {
-    unsigned int yy, addr_temp, row, row_temp, xshift;
+    unsigned int yy, row, xshift;
     uint16_t and_mask, or_mask, levels;
     struct FontEntry font_info;
     char lookup = 0;
@@ -1174,22 +1212,12 @@ void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
             return;
         }
         // Load data pointer.
-        row       = lookup * font_info.height * 2;
-        row_temp  = row;
-        addr_temp = addr;
-        xshift    = 16 - font_info.width;
-        // We can write mask words easily.
-        for (yy = y; yy < y + font_info.height; yy++) {
-            write_word_misaligned_OR(draw_buffer_mask, font_info.data[row] << xshift, addr, wbit);
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-        // Level bits are more complicated. We need to set or clear
-        // level bits, but only where the mask bit is set; otherwise,
-        // we need to leave them alone. To do this, for each word, we
-        // construct an AND mask and an OR mask, and apply each individually.
-        row  = row_temp;
-        addr = addr_temp;
+        row    = lookup * font_info.height * 2;
+        xshift = 16 - font_info.width;
+        // Mask words are written as they are. Level bits are more complicated.
+        // We need to set or clear level bits, but only where the mask bit is
+        // set; otherwise, we need to leave them alone. To do this, for each
+        // word, we construct an AND mask and an OR mask, and apply both.
         for (yy = y; yy < y + font_info.height; yy++) {
             levels = font_info.data[row + font_info.height];
             if (!(flags & FONT_INVERT)) {
@@ -1198,10 +1226,9 @@ void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
             }
             or_mask  = font_info.data[row] << xshift;
             and_mask = (font_info.data[row] & levels) << xshift;
-            write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
             // If we're not bold write the AND mask.
             // if(!(flags & FONT_BOLD))
-            write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
+            write_glyph_row(addr, wbit, or_mask, and_mask);
             addr += GRAPHICS_WIDTH_REAL / 8;
             row++;
         }
@@ -2404,6 +2431,11 @@ int32_t osdgenStart(void)
 {
     // Start gps task
     vSemaphoreCreateBinary(osdSemaphore);
+    PERF_INIT_COUNTER(counterRender, 0x05D00001);
+    PERF_INIT_COUNTER(counterPeriod, 0x05D00002);
+    PERF_INIT_COUNTER(counterLineMax, 0x05D00003);
+    PERF_INIT_COUNTER(counterLineAvg, 0x05D00004);
+    PERF_INIT_COUNTER(counterLateFrames, 0x05D00005);
     xTaskCreate(osdgenTask, "OSDGEN", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &osdgenTaskHandle);
     PIOS_TASK_MONITOR_RegisterTask(TASKINFO_RUNNING_OSDGEN, osdgenTaskHandle);
 #ifdef PIOS_INCLUDE_WDG
@@ -2463,6 +2495,7 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
 #endif
             clearGraphics();
             introGraphics();
+            PIOS_Video_SetFrameReady();
         }
     }
     for (int i = 0; i < 63; i++) {
@@ -2473,6 +2506,7 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
             clearGraphics();
             introGraphics();
             introText();
+            PIOS_Video_SetFrameReady();
         }
     }
 
@@ -2481,7 +2515,20 @@ static void osdgenTask(__attribute__((unused)) void *parameters)
 #ifdef PIOS_INCLUDE_WDG
             PIOS_WDG_UpdateFlag(PIOS_WDG_OSDGEN);
 #endif
+            // time to render a field against the field period, the render
+            // time has to stay below the period to keep up with the video
+            PERF_MEASURE_PERIOD(counterPeriod);
+            PERF_TIMED_SECTION_START(counterRender);
             updateOnceEveryFrame();
+            PERF_TIMED_SECTION_END(counterRender);
+            PIOS_Video_SetFrameReady();
+
+            // line interrupt cost of the last field, in cycles
+            struct pios_video_line_stats lineStats;
+            PIOS_Video_GetLineStats(&lineStats);
+            PERF_TRACK_VALUE(counterLineMax, lineStats.max_cycles);
+            PERF_TRACK_VALUE(counterLineAvg, lineStats.avg_cycles);
+            PERF_TRACK_VALUE(counterLateFrames, lineStats.late_frames);
         }
         // xSemaphoreTake(osdSemaphore, portMAX_DELAY);
         // vTaskDelayUntil(&lastSysTime, 10 / portTICK_RATE_MS);
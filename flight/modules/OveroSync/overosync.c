@@ -43,6 +43,10 @@
 #define MAX_QUEUE_SIZE   200
 #define STACK_SIZE_BYTES 512
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 0)
+// Frames are packed into batches of that size before going to the COM fifo, half a DMA packet
+#define BATCH_SIZE       512
+#define BATCH_MAX_FRAMES 32
+#define DROPPED_OBJECTS  OVEROSYNCSTATS_DROPPEDOBJECTID_NUMELEM
 
 // Private types
 
@@ -55,6 +59,8 @@ static bool overoEnabled;
 // Private functions
 static void overoSyncTask(void *parameters);
 static int32_t packData(uint8_t *data, int32_t length);
+static void flushBatch();
+static void countDropped(uint32_t objId);
 static void registerObject(UAVObjHandle obj);
 
 // External variables
@@ -66,6 +72,18 @@ struct overosync {
     uint32_t sent_objects;
     uint32_t failed_objects;
     uint32_t received_objects;
+
+    // frames waiting to be sent in one COM write, and the object of each one
+    uint8_t  batch[BATCH_SIZE];
+    uint16_t batch_length;
+    uint8_t  batch_frames;
+    uint32_t batch_objects[BATCH_MAX_FRAMES];
+    // object of the frame being packed
+    uint32_t current_object;
+
+    // the most dropped objects of the current period (space saving counters)
+    uint32_t dropped_ids[DROPPED_OBJECTS];
+    uint32_t dropped_counts[DROPPED_OBJECTS];
 };
 
 struct overosync *overosync;
@@ -123,7 +141,7 @@ int32_t OveroSyncStart(void)
         return -1;
     }
 
-    overosync->sent_bytes = 0;
+    memset(overosync, 0, sizeof(*overosync));
 
     // Process all registered objects and connect queue for updates
     UAVObjIterate(&registerObject);
@@ -157,70 +175,129 @@ static void registerObject(UAVObjHandle obj)
 /**
  * Telemetry transmit task, regular priority
  *
- * Logic: We need to double buffer the DMA transfers.  Pack the buffer until either
- * 1) it is full (and then we should record the number of missed events then)
- * 2) the current transaction is done (we should immediately schedule since we are slave)
- * when done packing the buffer we should call PIOS_SPI_TransferBlock, change the active buffer
- * and then take the semaphrore
+ * The driver double buffers the DMA transfers and refills the idle buffer from the COM
+ * fifo at every transfer. The task keeps that fifo fed: it drains the queued events in
+ * bursts and packs their frames into a batch which goes to the fifo in one write when
+ * it is full or when the queue is empty. A batch that does not fit in the fifo is dropped
+ * and its objects are counted in the statistics.
  */
 static void overoSyncTask(__attribute__((unused)) void *parameters)
 {
     UAVObjEvent ev;
 
-    // Kick off SPI transfers (once one is completed another will automatically transmit)
-    overosync->sent_objects     = 0;
-    overosync->failed_objects   = 0;
-    overosync->received_objects = 0;
-
     portTickType lastUpdateTime = xTaskGetTickCount();
     portTickType updateTime;
 
     // Loop forever
     while (1) {
-        // Wait for queue message
-        if (xQueueReceive(queue, &ev, portMAX_DELAY) == pdTRUE) {
-            // Process event.  This calls transmitData
+        // Wait for the first event of a burst, then take the queued ones without blocking
+        if (xQueueReceive(queue, &ev, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        do {
+            // Process event.  This calls packData
+            overosync->current_object = UAVObjGetID(ev.obj);
             UAVTalkSendObjectTimestamped(uavTalkCon, ev.obj, ev.instId, false, 0);
-
-            updateTime = xTaskGetTickCount();
-            if (((portTickType)(updateTime - lastUpdateTime)) > 1000) {
-                // Update stats.  This will trigger a local send event too
-                OveroSyncStatsData syncStats;
-                syncStats.Send            = overosync->sent_bytes;
-                syncStats.Connected       = syncStats.Send > 500 ? OVEROSYNCSTATS_CONNECTED_TRUE : OVEROSYNCSTATS_CONNECTED_FALSE;
-                syncStats.DroppedUpdates  = overosync->failed_objects;
-                syncStats.Packets         = PIOS_OVERO_GetPacketCount(pios_overo_id);
-                OveroSyncStatsSet(&syncStats);
-                overosync->failed_objects = 0;
-                overosync->sent_bytes     = 0;
-                lastUpdateTime            = updateTime;
+        } while (xQueueReceive(queue, &ev, 0) == pdTRUE);
+        flushBatch();
+
+        updateTime = xTaskGetTickCount();
+        if (((portTickType)(updateTime - lastUpdateTime)) > 1000) {
+            // Update stats.  This will trigger a local send event too
+            OveroSyncStatsData syncStats;
+            OveroSyncStatsGet(&syncStats);
+            syncStats.Send           = overosync->sent_bytes;
+            syncStats.Connected      = syncStats.Send > 500 ? OVEROSYNCSTATS_CONNECTED_TRUE : OVEROSYNCSTATS_CONNECTED_FALSE;
+            syncStats.DroppedUpdates = overosync->failed_objects;
+            syncStats.Packets        = PIOS_OVERO_GetPacketCount(pios_overo_id);
+            for (uint8_t i = 0; i < DROPPED_OBJECTS; i++) {
+                syncStats.DroppedObjectID[i]    = overosync->dropped_ids[i];
+                syncStats.DroppedObjectCount[i] = overosync->dropped_counts[i];
             }
-
-            // TODO: Check the receive buffer
+            OveroSyncStatsSet(&syncStats);
+            overosync->failed_objects = 0;
+            overosync->sent_bytes     = 0;
+            memset(overosync->dropped_ids, 0, sizeof(overosync->dropped_ids));
+            memset(overosync->dropped_counts, 0, sizeof(overosync->dropped_counts));
+            lastUpdateTime = updateTime;
         }
+
+        // TODO: Check the receive buffer
     }
 }
 
 /**
- * Transmit data buffer to the modem or USB port.
+ * Add a UAVTalk frame to the current batch, the batch is sent first if the frame does not fit.
  * \param[in] data Data buffer to send
  * \param[in] length Length of buffer
- * \return -1 on failure
- * \return number of bytes transmitted on success
+ * \return number of bytes packed
  */
 static int32_t packData(uint8_t *data, int32_t length)
 {
-    if (PIOS_COM_SendBufferNonBlocking(pios_com_overo_id, data, length) < 0) {
-        goto fail;
+    if (overosync->batch_length + length > BATCH_SIZE || overosync->batch_frames == BATCH_MAX_FRAMES) {
+        flushBatch();
+    }
+    if (length > BATCH_SIZE) {
+        // never happens with the current objects, but keep them going out
+        if (PIOS_COM_SendBufferNonBlocking(pios_com_overo_id, data, length) < 0) {
+            overosync->failed_objects++;
+            countDropped(overosync->current_object);
+            return -1;
+        }
+        overosync->sent_bytes += length;
+        return length;
     }
 
-    overosync->sent_bytes += length;
+    memcpy(&overosync->batch[overosync->batch_length], data, length);
+    overosync->batch_length += length;
+    overosync->batch_objects[overosync->batch_frames++] = overosync->current_object;
 
     return length;
+}
+
+/**
+ * Send the current batch to the COM fifo in one write, or drop it when there is no room.
+ */
+static void flushBatch()
+{
+    if (overosync->batch_length == 0) {
+        return;
+    }
 
-fail:
-    overosync->failed_objects++;
-    return -1;
+    if (PIOS_COM_SendBufferNonBlocking(pios_com_overo_id, overosync->batch, overosync->batch_length) < 0) {
+        overosync->failed_objects += overosync->batch_frames;
+        for (uint8_t i = 0; i < overosync->batch_frames; i++) {
+            countDropped(overosync->batch_objects[i]);
+        }
+    } else {
+        overosync->sent_bytes += overosync->batch_length;
+    }
+
+    overosync->batch_length = 0;
+    overosync->batch_frames = 0;
+}
+
+/**
+ * Count a dropped update of an object. Only the most dropped objects are kept: an
+ * object which is not in the table takes the place of the least dropped one and
+ * inherits its count, so the counts are upper bounds.
+ * \param[in] objId Object whose update was dropped
+ */
+static void countDropped(uint32_t objId)
+{
+    uint8_t least = 0;
+
+    for (uint8_t i = 0; i < DROPPED_OBJECTS; i++) {
+        if (overosync->dropped_ids[i] == objId && overosync->dropped_counts[i] > 0) {
+            overosync->dropped_counts[i]++;
+            return;
+        }
+        if (overosync->dropped_counts[i] < overosync->dropped_counts[least]) {
+            least = i;
+        }
+    }
+    overosync->dropped_ids[least] = objId;
+    overosync->dropped_counts[least]++;
 }
 
 /**
@@ -52,6 +52,7 @@
 #include <pid.h>
 #include <CoordinateConversions.h>
 #include <sin_lookup.h>
+#include <fastmath.h>
 #include <pathdesired.h>
 #include <paths.h>
 #include "plans.h"
@@ -78,6 +79,7 @@
 #include <vtolselftuningstats.h>
 #include <pathsummary.h>
 
+#include <pios_instrumentation_helper.h>
 
 // Private constants
 
@@ -132,13 +134,32 @@ struct NeutralThrustEstimation {
 };
 static struct NeutralThrustEstimation neutralThrustEst;
 
+// state objects read once per cycle, the controllers only work on this copy
+struct Inputs {
+    PositionStateData position;
+    VelocityStateData velocity;
+    AttitudeStateData attitude;
+};
+
+// settings derived values, refreshed by SettingsUpdatedCb
+struct Config {
+    uint8_t (*updateAutoPilot)();
+    uint32_t updatePeriod;
+    float    airSpeedMax;
+    float    airSpeedMin;
+};
+
 
 // Private variables
 static DelayedCallbackInfo *pathFollowerCBInfo;
 static uint32_t updatePeriod = PF_IDLE_UPDATE_RATE_MS;
 static struct Globals global;
+static struct Inputs inputs;
+static struct Config config;
+static VelocityDesiredData velocityDesired;
 static PathStatusData pathStatus;
 static PathDesiredData pathDesired;
+static struct path_geometry pathGeometry;
 static FixedWingPathFollowerSettingsData fixedWingPathFollowerSettings;
 static VtolPathFollowerSettingsData vtolPathFollowerSettings;
 static FlightStatusData flightStatus;
@@ -147,12 +168,16 @@ static PathSummaryData pathSummary;
 // correct speed by measured airspeed
 static float indicatedAirspeedStateBias = 0.0f;
 
+PERF_DEFINE_COUNTER(counterUpd);
+PERF_DEFINE_COUNTER(counterPeriod);
 
 // Private functions
 static void pathFollowerTask(void);
 static void resetGlobals();
 static void SettingsUpdatedCb(UAVObjEvent *ev);
-static uint8_t updateAutoPilotByFrameType();
+static void pathDesiredUpdatedCb(UAVObjEvent *ev);
+static void selectController();
+static void configureVtolPositionControl(bool fallback);
 static uint8_t updateAutoPilotFixedWing();
 static uint8_t updateAutoPilotVtol();
 static float updateTailInBearing();
@@ -178,6 +203,9 @@ int32_t PathFollowerStart()
     // Start main task
     PathStatusGet(&pathStatus);
     SettingsUpdatedCb(NULL);
+    pathDesiredUpdatedCb(NULL);
+    PERF_INIT_COUNTER(counterUpd, 0x9A7F0001);
+    PERF_INIT_COUNTER(counterPeriod, 0x9A7F0002);
     PIOS_CALLBACKSCHEDULER_Dispatch(pathFollowerCBInfo);
 
     return 0;
@@ -219,7 +247,8 @@ int32_t PathFollowerInitialize()
     pathFollowerCBInfo = PIOS_CALLBACKSCHEDULER_Create(&pathFollowerTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_PATHFOLLOWER, STACK_SIZE_BYTES);
     FixedWingPathFollowerSettingsConnectCallback(&SettingsUpdatedCb);
     VtolPathFollowerSettingsConnectCallback(&SettingsUpdatedCb);
-    PathDesiredConnectCallback(SettingsUpdatedCb);
+    SystemSettingsConnectCallback(&SettingsUpdatedCb);
+    PathDesiredConnectCallback(pathDesiredUpdatedCb);
     AirspeedStateConnectCallback(airspeedStateUpdatedCb);
 
     return 0;
@@ -241,6 +270,13 @@ static void pathFollowerTask(void)
         return;
     }
 
+    PERF_MEASURE_PERIOD(counterPeriod);
+    PERF_TIMED_SECTION_START(counterUpd);
+
+    PositionStateGet(&inputs.position);
+    VelocityStateGet(&inputs.velocity);
+    AttitudeStateGet(&inputs.attitude);
+
     if (flightStatus.FlightMode == FLIGHTSTATUS_FLIGHTMODE_POI) { // TODO Hack from vtolpathfollower, move into manualcontrol!
         processPOI();
     }
@@ -263,7 +299,8 @@ static void pathFollowerTask(void)
     case PATHDESIRED_MODE_FLYCIRCLERIGHT:
     case PATHDESIRED_MODE_FLYCIRCLELEFT:
     {
-        uint8_t result = updateAutoPilotByFrameType();
+        updatePeriod = config.updatePeriod;
+        uint8_t result = config.updateAutoPilot();
         if (result) {
             AlarmsSet(SYSTEMALARMS_ALARM_GUIDANCE, SYSTEMALARMS_ALARM_OK);
         } else {
@@ -286,6 +323,7 @@ static void pathFollowerTask(void)
     }
     PathStatusSet(&pathStatus);
 
+    PERF_TIMED_SECTION_END(counterUpd);
 
     PIOS_CALLBACKSCHEDULER_Schedule(pathFollowerCBInfo, updatePeriod, CALLBACK_UPDATEMODE_SOONER);
 }
@@ -309,7 +347,17 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     pid_configure(&global.BrakePIDvel[0], vtolPathFollowerSettings.BrakeHorizontalVelPID.Kp, vtolPathFollowerSettings.BrakeHorizontalVelPID.Ki, vtolPathFollowerSettings.BrakeHorizontalVelPID.Kd, vtolPathFollowerSettings.BrakeHorizontalVelPID.ILimit);
     pid_configure(&global.BrakePIDvel[1], vtolPathFollowerSettings.BrakeHorizontalVelPID.Kp, vtolPathFollowerSettings.BrakeHorizontalVelPID.Ki, vtolPathFollowerSettings.BrakeHorizontalVelPID.Kd, vtolPathFollowerSettings.BrakeHorizontalVelPID.ILimit);
 
+    SystemSettingsAirSpeedMaxGet(&config.airSpeedMax);
+    SystemSettingsAirSpeedMinGet(&config.airSpeedMin);
+
+    selectController();
+}
+
+
+static void pathDesiredUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
     PathDesiredGet(&pathDesired);
+    path_geometry_update(&pathDesired, &pathGeometry);
 }
 
 
@@ -355,7 +403,11 @@ static void resetGlobals()
     pid_zero(&global.PIDpower);
     global.poiRadius = 0.0f;
     global.vtolEmergencyFallback = 0;
-    global.vtolEmergencyFallbackSwitch = false;
+    // back from the emergency fallback, restore the regular position gains
+    if (global.vtolEmergencyFallbackSwitch) {
+        global.vtolEmergencyFallbackSwitch = false;
+        selectController();
+    }
 
     // reset neutral thrust assessment. We restart this process
     // and do once for each position hold engagement
@@ -371,7 +423,11 @@ static void resetGlobals()
     pathStatus.path_time = 0.0f;
 }
 
-static uint8_t updateAutoPilotByFrameType()
+/**
+ * Pick the controller for the frame type and set up the gains that only
+ * depend on the settings, so the cycle does not redo this every time
+ */
+static void selectController()
 {
     FrameType_t frameType = GetCurrentFrameType();
 
@@ -388,19 +444,35 @@ static uint8_t updateAutoPilotByFrameType()
     switch (frameType) {
     case FRAME_TYPE_MULTIROTOR:
     case FRAME_TYPE_HELI:
-        updatePeriod = vtolPathFollowerSettings.UpdatePeriod;
-        return updateAutoPilotVtol();
-
+        configureVtolPositionControl(global.vtolEmergencyFallbackSwitch ||
+                                     vtolPathFollowerSettings.FlyawayEmergencyFallback == VTOLPATHFOLLOWERSETTINGS_FLYAWAYEMERGENCYFALLBACK_ALWAYS);
+        config.updatePeriod    = vtolPathFollowerSettings.UpdatePeriod;
+        config.updateAutoPilot = updateAutoPilotVtol;
         break;
     case FRAME_TYPE_FIXED_WING:
     default:
-        updatePeriod = fixedWingPathFollowerSettings.UpdatePeriod;
-        return updateAutoPilotFixedWing();
-
+        pid_configure(&global.PIDposH[0], fixedWingPathFollowerSettings.HorizontalPosP, 0.0f, 0.0f, 0.0f);
+        pid_configure(&global.PIDposH[1], fixedWingPathFollowerSettings.HorizontalPosP, 0.0f, 0.0f, 0.0f);
+        pid_configure(&global.PIDposV, fixedWingPathFollowerSettings.VerticalPosP, 0.0f, 0.0f, 0.0f);
+        config.updatePeriod    = fixedWingPathFollowerSettings.UpdatePeriod;
+        config.updateAutoPilot = updateAutoPilotFixedWing;
         break;
     }
 }
 
+/**
+ * vtol position control gains, the emergency fallback only cares about the
+ * intended horizontal flight direction and uses a unity gain
+ */
+static void configureVtolPositionControl(bool fallback)
+{
+    float kp = fallback ? 1.0f : vtolPathFollowerSettings.HorizontalPosP;
+
+    pid_configure(&global.PIDposH[0], kp, 0.0f, 0.0f, 0.0f);
+    pid_configure(&global.PIDposH[1], kp, 0.0f, 0.0f, 0.0f);
+    pid_configure(&global.PIDposV, vtolPathFollowerSettings.VerticalPosP, 0.0f, 0.0f, 0.0f);
+}
+
 /**
  * fixed wing autopilot:
  * straight forward:
@@ -409,9 +481,6 @@ static uint8_t updateAutoPilotByFrameType()
  */
 static uint8_t updateAutoPilotFixedWing()
 {
-    pid_configure(&global.PIDposH[0], fixedWingPathFollowerSettings.HorizontalPosP, 0.0f, 0.0f, 0.0f);
-    pid_configure(&global.PIDposH[1], fixedWingPathFollowerSettings.HorizontalPosP, 0.0f, 0.0f, 0.0f);
-    pid_configure(&global.PIDposV, fixedWingPathFollowerSettings.VerticalPosP, 0.0f, 0.0f, 0.0f);
     updatePathVelocity(fixedWingPathFollowerSettings.CourseFeedForward, true);
     return updateFixedDesiredAttitude();
 }
@@ -441,15 +510,10 @@ static uint8_t updateAutoPilotVtol()
         }
     }
 
-    // vertical positon control PID loops works the same in both regular and fallback modes, setup according to settings
-    pid_configure(&global.PIDposV, vtolPathFollowerSettings.VerticalPosP, 0.0f, 0.0f, 0.0f);
-
+    // position control gains are set up by configureVtolPositionControl() for the follower mode
     switch (followermode) {
     case FOLLOWER_REGULAR:
     {
-        // horizontal position control PID loop works according to settings in regular mode, allowing integral terms
-        pid_configure(&global.PIDposH[0], vtolPathFollowerSettings.HorizontalPosP, 0.0f, 0.0f, 0.0f);
-        pid_configure(&global.PIDposH[1], vtolPathFollowerSettings.HorizontalPosP, 0.0f, 0.0f, 0.0f);
         updatePathVelocity(vtolPathFollowerSettings.CourseFeedForward, false);
 
         // yaw behaviour is configurable in vtolpathfollower, select yaw control algorithm
@@ -485,15 +549,13 @@ static uint8_t updateAutoPilotVtol()
             } else if (vtolPathFollowerSettings.FlyawayEmergencyFallback != VTOLPATHFOLLOWERSETTINGS_FLYAWAYEMERGENCYFALLBACK_DISABLED) {
                 // switch to emergency follower if follower indicates problems
                 global.vtolEmergencyFallbackSwitch = true;
+                configureVtolPositionControl(true);
             }
         }
     }
     break;
     case FOLLOWER_FALLBACK:
     {
-        // fallback loop only cares about intended horizontal flight direction, simplify control behaviour accordingly
-        pid_configure(&global.PIDposH[0], 1.0f, 0.0f, 0.0f, 0.0f);
-        pid_configure(&global.PIDposH[1], 1.0f, 0.0f, 0.0f, 0.0f);
         updatePathVelocity(vtolPathFollowerSettings.CourseFeedForward, true);
 
         // emergency follower has no return value
@@ -506,13 +568,12 @@ static uint8_t updateAutoPilotVtol()
     // Brake mode end condition checks
     if (pathDesired.Mode == PATHDESIRED_MODE_BRAKE) {
         bool exit_brake = false;
-        VelocityStateData velocityState;
+        const VelocityStateData *velocityState = &inputs.velocity;
         if (pathStatus.path_time > pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_TIMEOUT]) { // enter hold on timeout
             pathSummary.brake_exit_reason = PATHSUMMARY_BRAKE_EXIT_REASON_TIMEOUT;
             exit_brake = true;
         } else if (pathStatus.fractional_progress > BRAKE_FRACTIONALPROGRESS_STARTVELOCITYCHECK) {
-            VelocityStateGet(&velocityState);
-            if (fabsf(velocityState.East) < BRAKE_EXIT_VELOCITY_LIMIT && fabsf(velocityState.North) < BRAKE_EXIT_VELOCITY_LIMIT) {
+            if (fabsf(velocityState->East) < BRAKE_EXIT_VELOCITY_LIMIT && fabsf(velocityState->North) < BRAKE_EXIT_VELOCITY_LIMIT) {
                 pathSummary.brake_exit_reason = PATHSUMMARY_BRAKE_EXIT_REASON_PATHCOMPLETED;
                 exit_brake = true;
             }
@@ -522,15 +583,13 @@ static uint8_t updateAutoPilotVtol()
             // Calculate the distance error between the originally desired
             // stopping point and the actual brake-exit point.
 
-            PositionStateData p;
-            PositionStateGet(&p);
-            float north_offset = pathDesired.End.North - p.North;
-            float east_offset  = pathDesired.End.East - p.East;
-            float down_offset  = pathDesired.End.Down - p.Down;
+            float north_offset = pathDesired.End.North - inputs.position.North;
+            float east_offset  = pathDesired.End.East - inputs.position.East;
+            float down_offset  = pathDesired.End.Down - inputs.position.Down;
             pathSummary.brake_distance_offset = sqrtf(north_offset * north_offset + east_offset * east_offset + down_offset * down_offset);
             pathSummary.time_remaining = pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_TIMEOUT] - pathStatus.path_time;
             pathSummary.fractional_progress   = pathStatus.fractional_progress;
-            float cur_velocity = velocityState.North * velocityState.North + velocityState.East * velocityState.East + velocityState.Down * velocityState.Down;
+            float cur_velocity = velocityState->North * velocityState->North + velocityState->East * velocityState->East + velocityState->Down * velocityState->Down;
             cur_velocity = sqrtf(cur_velocity);
             pathSummary.decelrate = (pathDesired.StartingVelocity - cur_velocity) / pathStatus.path_time;
             pathSummary.brakeRateActualDesiredRatio = pathSummary.decelrate / vtolPathFollowerSettings.BrakeRate;
@@ -560,13 +619,11 @@ static uint8_t updateAutoPilotVtol()
  */
 static float updateTailInBearing()
 {
-    PositionStateData p;
-
-    PositionStateGet(&p);
     TakeOffLocationData t;
+
     TakeOffLocationGet(&t);
-    // atan2f always returns in between + and - 180 degrees
-    return RAD2DEG(atan2f(p.East - t.East, p.North - t.North));
+    // fast_atan2f always returns in between + and - 180 degrees
+    return RAD2DEG(fast_atan2f(inputs.position.East - t.East, inputs.position.North - t.North));
 }
 
 /**
@@ -574,11 +631,8 @@ static float updateTailInBearing()
  */
 static float updateCourseBearing()
 {
-    VelocityStateData v;
-
-    VelocityStateGet(&v);
-    // atan2f always returns in between + and - 180 degrees
-    return RAD2DEG(atan2f(v.East, v.North));
+    // fast_atan2f always returns in between + and - 180 degrees
+    return RAD2DEG(fast_atan2f(inputs.velocity.East, inputs.velocity.North));
 }
 
 /**
@@ -586,19 +640,15 @@ static float updateCourseBearing()
  */
 static float updatePathBearing()
 {
-    PositionStateData positionState;
-
-    PositionStateGet(&positionState);
-
-    float cur[3] = { positionState.North,
-                     positionState.East,
-                     positionState.Down };
+    float cur[3] = { inputs.position.North,
+                     inputs.position.East,
+                     inputs.position.Down };
     struct path_status progress;
 
-    path_progress(&pathDesired, cur, &progress);
+    path_geometry_progress(&pathGeometry, cur, &progress);
 
-    // atan2f always returns in between + and - 180 degrees
-    return RAD2DEG(atan2f(progress.path_vector[1], progress.path_vector[0]));
+    // fast_atan2f always returns in between + and - 180 degrees
+    return RAD2DEG(fast_atan2f(progress.path_vector[1], progress.path_vector[0]));
 }
 
 /**
@@ -609,22 +659,20 @@ static float updatePOIBearing()
     PoiLocationData poi;
 
     PoiLocationGet(&poi);
-    PositionStateData positionState;
-    PositionStateGet(&positionState);
 
     const float dT = updatePeriod / 1000.0f;
     float dLoc[3];
     float yaw = 0;
     /*float elevation = 0;*/
 
-    dLoc[0] = positionState.North - poi.North;
-    dLoc[1] = positionState.East - poi.East;
-    dLoc[2] = positionState.Down - poi.Down;
+    dLoc[0] = inputs.position.North - poi.North;
+    dLoc[1] = inputs.position.East - poi.East;
+    dLoc[2] = inputs.position.Down - poi.Down;
 
     if (dLoc[1] < 0) {
-        yaw = RAD2DEG(atan2f(dLoc[1], dLoc[0])) + 180.0f;
+        yaw = RAD2DEG(fast_atan2f(dLoc[1], dLoc[0])) + 180.0f;
     } else {
-        yaw = RAD2DEG(atan2f(dLoc[1], dLoc[0])) - 180.0f;
+        yaw = RAD2DEG(fast_atan2f(dLoc[1], dLoc[0])) - 180.0f;
     }
     ManualControlCommandData manualControlData;
     ManualControlCommandGet(&manualControlData);
@@ -648,15 +696,10 @@ static void processPOI()
     const float dT = updatePeriod / 1000.0f;
 
 
-    PositionStateData positionState;
-
-    PositionStateGet(&positionState);
     // TODO put commented out camera feature code back in place either
     // permanently or optionally or remove it
     // CameraDesiredData cameraDesired;
     // CameraDesiredGet(&cameraDesired);
-    StabilizationDesiredData stabDesired;
-    StabilizationDesiredGet(&stabDesired);
     PoiLocationData poi;
     PoiLocationGet(&poi);
 
@@ -665,18 +708,18 @@ static void processPOI()
     // TODO camera feature
     /*float elevation = 0;*/
 
-    dLoc[0] = positionState.North - poi.North;
-    dLoc[1] = positionState.East - poi.East;
-    dLoc[2] = positionState.Down - poi.Down;
+    dLoc[0] = inputs.position.North - poi.North;
+    dLoc[1] = inputs.position.East - poi.East;
+    dLoc[2] = inputs.position.Down - poi.Down;
 
     if (dLoc[1] < 0) {
-        yaw = RAD2DEG(atan2f(dLoc[1], dLoc[0])) + 180.0f;
+        yaw = RAD2DEG(fast_atan2f(dLoc[1], dLoc[0])) + 180.0f;
     } else {
-        yaw = RAD2DEG(atan2f(dLoc[1], dLoc[0])) - 180.0f;
+        yaw = RAD2DEG(fast_atan2f(dLoc[1], dLoc[0])) - 180.0f;
     }
 
     // distance
-    float distance = sqrtf(powf(dLoc[0], 2.0f) + powf(dLoc[1], 2.0f));
+    float distance = sqrtf(dLoc[0] * dLoc[0] + dLoc[1] * dLoc[1]);
 
     ManualControlCommandData manualControlData;
     ManualControlCommandGet(&manualControlData);
@@ -703,8 +746,10 @@ static void processPOI()
     // don't try to move any closer
     if (global.poiRadius >= 3.0f || changeRadius > 0) {
         if (fabsf(pathAngle) > 0.0f || fabsf(changeRadius) > 0.0f) {
-            pathDesired.End.North = poi.North + (global.poiRadius * cosf(DEG2RAD(pathAngle + yaw - 180.0f)));
-            pathDesired.End.East  = poi.East + (global.poiRadius * sinf(DEG2RAD(pathAngle + yaw - 180.0f)));
+            float sinAngle, cosAngle;
+            fast_sincosf(DEG2RAD(pathAngle + yaw - 180.0f), &sinAngle, &cosAngle);
+            pathDesired.End.North = poi.North + (global.poiRadius * cosAngle);
+            pathDesired.End.East  = poi.East + (global.poiRadius * sinAngle);
             pathDesired.StartingVelocity = 1.0f;
             pathDesired.EndingVelocity   = 0.0f;
             pathDesired.Mode = PATHDESIRED_MODE_FLYENDPOINT;
@@ -751,12 +796,8 @@ static void updateBrakeVelocity(float startingVelocity, float dT, float brakeRat
  */
 static void updatePathVelocity(float kFF, bool limited)
 {
-    PositionStateData positionState;
-
-    PositionStateGet(&positionState);
-    VelocityStateData velocityState;
-    VelocityStateGet(&velocityState);
-    VelocityDesiredData velocityDesired;
+    const PositionStateData *positionState = &inputs.position;
+    const VelocityStateData *velocityState = &inputs.velocity;
 
     const float dT = updatePeriod / 1000.0f;
 
@@ -765,11 +806,11 @@ static void updatePathVelocity(float kFF, bool limited)
         if (brakeRate < BRAKE_RATE_MINIMUM) {
             brakeRate = BRAKE_RATE_MINIMUM; // set a minimum to avoid a divide by zero potential below
         }
-        updateBrakeVelocity(pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_STARTVELOCITYVECTOR_NORTH], pathStatus.path_time, brakeRate, velocityState.North, &velocityDesired.North);
-        updateBrakeVelocity(pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_STARTVELOCITYVECTOR_EAST], pathStatus.path_time, brakeRate, velocityState.East, &velocityDesired.East);
-        updateBrakeVelocity(pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_STARTVELOCITYVECTOR_DOWN], pathStatus.path_time, brakeRate, velocityState.Down, &velocityDesired.Down);
+        updateBrakeVelocity(pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_STARTVELOCITYVECTOR_NORTH], pathStatus.path_time, brakeRate, velocityState->North, &velocityDesired.North);
+        updateBrakeVelocity(pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_STARTVELOCITYVECTOR_EAST], pathStatus.path_time, brakeRate, velocityState->East, &velocityDesired.East);
+        updateBrakeVelocity(pathDesired.ModeParameters[PATHDESIRED_MODEPARAMETER_BRAKE_STARTVELOCITYVECTOR_DOWN], pathStatus.path_time, brakeRate, velocityState->Down, &velocityDesired.Down);
 
-        float cur_velocity     = velocityState.North * velocityState.North + velocityState.East * velocityState.East + velocityState.Down * velocityState.Down;
+        float cur_velocity     = velocityState->North * velocityState->North + velocityState->East * velocityState->East + velocityState->Down * velocityState->Down;
         cur_velocity     = sqrtf(cur_velocity);
         float desired_velocity = velocityDesired.North * velocityDesired.North + velocityDesired.East * velocityDesired.East + velocityDesired.Down * velocityDesired.Down;
         desired_velocity = sqrtf(desired_velocity);
@@ -789,16 +830,16 @@ static void updatePathVelocity(float kFF, bool limited)
         pathStatus.path_direction_east  = velocityDesired.East;
         pathStatus.path_direction_down  = velocityDesired.Down;
 
-        pathStatus.correction_direction_north = velocityDesired.North - velocityState.North;
-        pathStatus.correction_direction_east  = velocityDesired.East - velocityState.East;
-        pathStatus.correction_direction_down  = velocityDesired.Down - velocityState.Down;
+        pathStatus.correction_direction_north = velocityDesired.North - velocityState->North;
+        pathStatus.correction_direction_east  = velocityDesired.East - velocityState->East;
+        pathStatus.correction_direction_down  = velocityDesired.Down - velocityState->Down;
     } else {
         // look ahead kFF seconds
-        float cur[3] = { positionState.North + (velocityState.North * kFF),
-                         positionState.East + (velocityState.East * kFF),
-                         positionState.Down + (velocityState.Down * kFF) };
+        float cur[3] = { positionState->North + (velocityState->North * kFF),
+                         positionState->East + (velocityState->East * kFF),
+                         positionState->Down + (velocityState->Down * kFF) };
         struct path_status progress;
-        path_progress(&pathDesired, cur, &progress);
+        path_geometry_progress(&pathGeometry, cur, &progress);
 
         // calculate velocity - can be zero if waypoints are too close
         velocityDesired.North = progress.path_vector[0];
@@ -819,8 +860,8 @@ static void updatePathVelocity(float kFF, bool limited)
             // fix: ignore correction, steer in path direction until the situation has become better (condition doesn't apply anymore)
             // calculating angles < 90 degrees through dot products
             (vector_lengthf(progress.path_vector, 2) > 1e-6f) &&
-            ((progress.path_vector[0] * velocityState.North + progress.path_vector[1] * velocityState.East) < 0.0f) &&
-            ((progress.correction_vector[0] * velocityState.North + progress.correction_vector[1] * velocityState.East) < 0.0f)) {
+            ((progress.path_vector[0] * velocityState->North + progress.path_vector[1] * velocityState->East) < 0.0f) &&
+            ((progress.correction_vector[0] * velocityState->North + progress.correction_vector[1] * velocityState->East) < 0.0f)) {
             ;
         } else {
             // calculate correction
@@ -855,13 +896,10 @@ static uint8_t updateFixedDesiredAttitude()
 
     const float dT = updatePeriod / 1000.0f; // Convert from [ms] to [s]
 
-    VelocityDesiredData velocityDesired;
-    VelocityStateData velocityState;
+    const VelocityStateData *velocityState = &inputs.velocity;
+    const AttitudeStateData *attitudeState = &inputs.attitude;
     StabilizationDesiredData stabDesired;
-    AttitudeStateData attitudeState;
     FixedWingPathFollowerStatusData fixedWingPathFollowerStatus;
-    AirspeedStateData airspeedState;
-    SystemSettingsData systemSettings;
 
     float groundspeedProjection;
     float indicatedAirspeedState;
@@ -882,13 +920,6 @@ static uint8_t updateFixedDesiredAttitude()
 
     FixedWingPathFollowerStatusGet(&fixedWingPathFollowerStatus);
 
-    VelocityStateGet(&velocityState);
-    StabilizationDesiredGet(&stabDesired);
-    VelocityDesiredGet(&velocityDesired);
-    AttitudeStateGet(&attitudeState);
-    AirspeedStateGet(&airspeedState);
-    SystemSettingsGet(&systemSettings);
-
     /**
      * Compute speed error and course
      */
@@ -896,11 +927,11 @@ static uint8_t updateFixedDesiredAttitude()
     // reasonable error that measured airspeed is actually the airspeed
     // component in forward pointing direction
     // airspeedVector is normalized
-    airspeedVector[0]     = cos_lookup_deg(attitudeState.Yaw);
-    airspeedVector[1]     = sin_lookup_deg(attitudeState.Yaw);
+    airspeedVector[0]     = cos_lookup_deg(attitudeState->Yaw);
+    airspeedVector[1]     = sin_lookup_deg(attitudeState->Yaw);
 
     // current ground speed projected in forward direction
-    groundspeedProjection = velocityState.North * airspeedVector[0] + velocityState.East * airspeedVector[1];
+    groundspeedProjection = velocityState->North * airspeedVector[0] + velocityState->East * airspeedVector[1];
 
     // note that airspeedStateBias is ( calibratedAirspeed - groundspeedProjection ) at the time of measurement,
     // but thanks to accelerometers,  groundspeedProjection reacts faster to changes in direction
@@ -909,8 +940,8 @@ static uint8_t updateFixedDesiredAttitude()
 
     // fluidMovement is a vector describing the aproximate movement vector of
     // the surrounding fluid in 2d space (aka wind vector)
-    fluidMovement[0] = velocityState.North - (indicatedAirspeedState * airspeedVector[0]);
-    fluidMovement[1] = velocityState.East - (indicatedAirspeedState * airspeedVector[1]);
+    fluidMovement[0] = velocityState->North - (indicatedAirspeedState * airspeedVector[0]);
+    fluidMovement[1] = velocityState->East - (indicatedAirspeedState * airspeedVector[1]);
 
     // calculate the movement vector we need to fly to reach velocityDesired -
     // taking fluidMovement into account
@@ -945,12 +976,12 @@ static uint8_t updateFixedDesiredAttitude()
         velocityDesired.Down,
         -fixedWingPathFollowerSettings.VerticalVelMax,
         fixedWingPathFollowerSettings.VerticalVelMax);
-    descentspeedError = descentspeedDesired - velocityState.Down;
+    descentspeedError = descentspeedDesired - velocityState->Down;
 
     // Error condition: plane too slow or too fast
     fixedWingPathFollowerStatus.Errors.Highspeed = 0;
     fixedWingPathFollowerStatus.Errors.Lowspeed  = 0;
-    if (indicatedAirspeedState > systemSettings.AirSpeedMax * fixedWingPathFollowerSettings.Safetymargins.Overspeed) {
+    if (indicatedAirspeedState > config.airSpeedMax * fixedWingPathFollowerSettings.Safetymargins.Overspeed) {
         fixedWingPathFollowerStatus.Errors.Overspeed = 1;
         result = 0;
     }
@@ -962,7 +993,7 @@ static uint8_t updateFixedDesiredAttitude()
         fixedWingPathFollowerStatus.Errors.Lowspeed = 1;
         result = 0;
     }
-    if (indicatedAirspeedState < systemSettings.AirSpeedMin * fixedWingPathFollowerSettings.Safetymargins.Stallspeed) {
+    if (indicatedAirspeedState < config.airSpeedMin * fixedWingPathFollowerSettings.Safetymargins.Stallspeed) {
         fixedWingPathFollowerStatus.Errors.Stallspeed = 1;
         result = 0;
     }
@@ -995,7 +1026,7 @@ static uint8_t updateFixedDesiredAttitude()
     // Error condition: plane cannot hold altitude at current speed.
     fixedWingPathFollowerStatus.Errors.Lowpower = 0;
     if (fixedWingPathFollowerSettings.ThrustLimit.Neutral + powerCommand >= fixedWingPathFollowerSettings.ThrustLimit.Max && // thrust at maximum
-        velocityState.Down > 0.0f && // we ARE going down
+        velocityState->Down > 0.0f && // we ARE going down
         descentspeedDesired < 0.0f && // we WANT to go up
         airspeedError > 0.0f && // we are too slow already
         fixedWingPathFollowerSettings.Safetymargins.Lowpower > 0.5f) { // alarm switched on
@@ -1005,7 +1036,7 @@ static uint8_t updateFixedDesiredAttitude()
     // Error condition: plane keeps climbing despite minimum thrust (opposite of above)
     fixedWingPathFollowerStatus.Errors.Highpower = 0;
     if (fixedWingPathFollowerSettings.ThrustLimit.Neutral + powerCommand <= fixedWingPathFollowerSettings.ThrustLimit.Min && // thrust at minimum
-        velocityState.Down < 0.0f && // we ARE going up
+        velocityState->Down < 0.0f && // we ARE going up
         descentspeedDesired > 0.0f && // we WANT to go down
         airspeedError < 0.0f && // we are too fast already
         fixedWingPathFollowerSettings.Safetymargins.Highpower > 0.5f) { // alarm switched on
@@ -1036,7 +1067,7 @@ static uint8_t updateFixedDesiredAttitude()
     // Error condition: high speed dive
     fixedWingPathFollowerStatus.Errors.Pitchcontrol = 0;
     if (fixedWingPathFollowerSettings.PitchLimit.Neutral + pitchCommand >= fixedWingPathFollowerSettings.PitchLimit.Max && // pitch demand is full up
-        velocityState.Down > 0.0f && // we ARE going down
+        velocityState->Down > 0.0f && // we ARE going down
         descentspeedDesired < 0.0f && // we WANT to go up
         airspeedError < 0.0f && // we are too fast already
         fixedWingPathFollowerSettings.Safetymargins.Pitchcontrol > 0.5f) { // alarm switched on
@@ -1047,7 +1078,7 @@ static uint8_t updateFixedDesiredAttitude()
     /**
      * Compute desired roll command
      */
-    courseError = RAD2DEG(atan2f(courseComponent[1], courseComponent[0])) - attitudeState.Yaw;
+    courseError = RAD2DEG(fast_atan2f(courseComponent[1], courseComponent[0])) - attitudeState->Yaw;
 
     if (courseError < -180.0f) {
         courseError += 360.0f;
@@ -1061,11 +1092,11 @@ static uint8_t updateFixedDesiredAttitude()
     // turn into a desired left turn. Making the turn direction based on
     // current roll angle keeps the plane committed to a direction once chosen
     if (courseError < -180.0f + (fixedWingPathFollowerSettings.ReverseCourseOverlap * 0.5f)
-        && attitudeState.Roll > 0.0f) {
+        && attitudeState->Roll > 0.0f) {
         courseError += 360.0f;
     }
     if (courseError > 180.0f - (fixedWingPathFollowerSettings.ReverseCourseOverlap * 0.5f)
-        && attitudeState.Roll < 0.0f) {
+        && attitudeState->Roll < 0.0f) {
         courseError -= 360.0f;
     }
 
@@ -1172,7 +1203,7 @@ static bool correctCourse(float *C, float *V, float *F, float s)
     // which one is better? two criteria:
     // 1. we MUST move in the right direction, if any k leads to -v its invalid
     // 2. we should minimize the speed error
-    float k     = sqrt(k2);
+    float k     = sqrtf(k2);
     float C1[2] = { -k * Vn[0] - Fo[0], -k * Vn[1] - Fo[1] };
     float C2[2] = { k *Vn[0] - Fo[0], k * Vn[1] - Fo[1] };
     // project C+F on Vn to find signed resulting movement vector length
@@ -1213,13 +1244,12 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
     uint8_t result     = 1;
     bool manual_thrust = false;
 
-    VelocityDesiredData velocityDesired;
-    VelocityStateData velocityState;
+    const VelocityStateData *velocityState = &inputs.velocity;
     StabilizationDesiredData stabDesired;
-    AttitudeStateData attitudeState;
-    StabilizationBankData stabSettings;
-    SystemSettingsData systemSettings;
+    StabilizationBankMaximumRateData maximumRate;
     VtolSelfTuningStatsData vtolSelfTuningStats;
+    // local copy, the debug test below skews the yaw
+    float yaw = inputs.attitude.Yaw;
 
     float northError;
     float northCommand;
@@ -1230,14 +1260,8 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
     float downError;
     float downCommand;
 
-    SystemSettingsGet(&systemSettings);
-    VelocityStateGet(&velocityState);
-    VelocityDesiredGet(&velocityDesired);
-    StabilizationDesiredGet(&stabDesired);
-    VelocityDesiredGet(&velocityDesired);
-    AttitudeStateGet(&attitudeState);
-    StabilizationBankGet(&stabSettings);
-    VtolSelfTuningStatsGet(&vtolSelfTuningStats);
+    StabilizationBankMaximumRateGet(&maximumRate);
+    VtolSelfTuningStatsNeutralThrustOffsetGet(&vtolSelfTuningStats.NeutralThrustOffset);
 
 
     if (pathDesired.Mode != PATHDESIRED_MODE_BRAKE) {
@@ -1254,9 +1278,9 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
     }
 
     // calculate the velocity errors between desired and actual
-    northError = velocityDesired.North - velocityState.North;
-    eastError  = velocityDesired.East - velocityState.East;
-    downError  = velocityDesired.Down - velocityState.Down;
+    northError = velocityDesired.North - velocityState->North;
+    eastError  = velocityDesired.East - velocityState->East;
+    downError  = velocityDesired.Down - velocityState->Down;
 
     // Must flip this sign
     downError  = -downError;
@@ -1296,7 +1320,7 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
 
         bool stable = (fabsf(pathStatus.correction_direction_down) < NEUTRALTHRUST_PH_POSITIONAL_ERROR_LIMIT &&
                        fabsf(velocityDesired.Down) < NEUTRALTHRUST_PH_VEL_DESIRED_LIMIT &&
-                       fabsf(velocityState.Down) < NEUTRALTHRUST_PH_VEL_STATE_LIMIT &&
+                       fabsf(velocityState->Down) < NEUTRALTHRUST_PH_VEL_STATE_LIMIT &&
                        fabsf(downError) < NEUTRALTHRUST_PH_VEL_ERROR_LIMIT);
 
         if (ph_active && stable) {
@@ -1356,9 +1380,9 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
 
     // DEBUG HACK: allow user to skew compass on purpose to see if emergency failsafe kicks in
     if (vtolPathFollowerSettings.FlyawayEmergencyFallback == VTOLPATHFOLLOWERSETTINGS_FLYAWAYEMERGENCYFALLBACK_DEBUGTEST) {
-        attitudeState.Yaw += 120.0f;
-        if (attitudeState.Yaw > 180.0f) {
-            attitudeState.Yaw -= 360.0f;
+        yaw += 120.0f;
+        if (yaw > 180.0f) {
+            yaw -= 360.0f;
         }
     }
 
@@ -1369,9 +1393,9 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
             vtolPathFollowerSettings.HorizontalVelPID.ILimit - fabsf(global.PIDvel[1].iAccumulator) < 1e-6f
         ) &&
         // angle between desired and actual velocity >90 degrees (by dot product)
-        (velocityDesired.North * velocityState.North + velocityDesired.East * velocityState.East < 0.0f) &&
+        (velocityDesired.North * velocityState->North + velocityDesired.East * velocityState->East < 0.0f) &&
         // quad is moving at significant speed (during flyaway it would keep speeding up)
-        squaref(velocityState.North) + squaref(velocityState.East) > 1.0f
+        squaref(velocityState->North) + squaref(velocityState->East) > 1.0f
         ) {
         global.vtolEmergencyFallback += dT;
         if (global.vtolEmergencyFallback >= vtolPathFollowerSettings.FlyawayEmergencyFallbackTriggerTime) {
@@ -1391,11 +1415,14 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
         maxPitch = vtolPathFollowerSettings.BrakeMaxPitch;
     }
 
-    stabDesired.Pitch = boundf(-northCommand * cosf(DEG2RAD(attitudeState.Yaw)) +
-                               -eastCommand * sinf(DEG2RAD(attitudeState.Yaw)),
+    float sinYaw, cosYaw;
+    fast_sincosf(DEG2RAD(yaw), &sinYaw, &cosYaw);
+
+    stabDesired.Pitch = boundf(-northCommand * cosYaw +
+                               -eastCommand * sinYaw,
                                -maxPitch, maxPitch);
-    stabDesired.Roll  = boundf(-northCommand * sinf(DEG2RAD(attitudeState.Yaw)) +
-                               eastCommand * cosf(DEG2RAD(attitudeState.Yaw)),
+    stabDesired.Roll  = boundf(-northCommand * sinYaw +
+                               eastCommand * cosYaw,
                                -maxPitch, maxPitch);
 
     ManualControlCommandData manualControl;
@@ -1409,7 +1436,7 @@ static int8_t updateVtolDesiredAttitude(bool yaw_attitude, float yaw_direction)
         stabDesired.Yaw = yaw_direction;
     } else {
         stabDesired.StabilizationMode.Yaw = STABILIZATIONDESIRED_STABILIZATIONMODE_AXISLOCK;
-        stabDesired.Yaw = stabSettings.MaximumRate.Yaw * manualControl.Yaw;
+        stabDesired.Yaw = maximumRate.Yaw * manualControl.Yaw;
     }
 
     // default thrust mode to cruise control
@@ -1466,8 +1493,7 @@ static void updateVtolDesiredAttitudeEmergencyFallback()
 {
     const float dT = updatePeriod / 1000.0f;
 
-    VelocityDesiredData velocityDesired;
-    VelocityStateData velocityState;
+    const VelocityStateData *velocityState = &inputs.velocity;
     StabilizationDesiredData stabDesired;
 
     float courseError;
@@ -1476,13 +1502,7 @@ static void updateVtolDesiredAttitudeEmergencyFallback()
     float downError;
     float downCommand;
 
-    VelocityStateGet(&velocityState);
-    VelocityDesiredGet(&velocityDesired);
-
-    ManualControlCommandData manualControlData;
-    ManualControlCommandGet(&manualControlData);
-
-    courseError = RAD2DEG(atan2f(velocityDesired.East, velocityDesired.North) - atan2f(velocityState.East, velocityState.North));
+    courseError = RAD2DEG(fast_atan2f(velocityDesired.East, velocityDesired.North) - fast_atan2f(velocityState->East, velocityState->North));
 
     if (courseError < -180.0f) {
         courseError += 360.0f;
@@ -1497,7 +1517,7 @@ static void updateVtolDesiredAttitudeEmergencyFallback()
     stabDesired.Yaw = boundf(courseCommand, -vtolPathFollowerSettings.EmergencyFallbackYawRate.Max, vtolPathFollowerSettings.EmergencyFallbackYawRate.Max);
 
     // Compute desired down command
-    downError   = velocityDesired.Down - velocityState.Down;
+    downError   = velocityDesired.Down - velocityState->Down;
     // Must flip this sign
     downError   = -downError;
     downCommand = pid_apply(&global.PIDvel[2], downError, dT);
@@ -50,27 +50,49 @@
 #define STACK_SIZE_BYTES            1024
 #define TASK_PRIORITY               CALLBACK_TASK_NAVIGATION
 #define MAX_QUEUE_SIZE              2
-#define PATH_PLANNER_UPDATE_RATE_MS 100 // can be slow, since we listen to status updates as well
+#define PATH_PLANNER_UPDATE_RATE_MS 50 // the conditions only read the navigation snapshot, we listen to status updates as well
+
+#define PLAN_CLEAN                  0xFFFF
 
 // Private types
 
+// Validation cache of the path plan, the CRC of every instance is chained from the previous one
+struct waypointCache {
+    uint8_t crc; // plan CRC up to and including this waypoint
+    uint8_t action;
+};
+struct pathActionCache {
+    uint8_t crc; // plan CRC up to and including this path action
+    int16_t errorDestination;
+    int16_t jumpDestination;
+};
+
+// The navigation state the end conditions of a tick are evaluated on, read once per tick
+struct navigationSnapshot {
+    PathDesiredData   pathDesired;
+    PositionStateData position;
+    VelocityStateData velocity;
+};
+
 // Private functions
 static void pathPlannerTask();
 static void commandUpdated(UAVObjEvent *ev);
 static void statusUpdated(UAVObjEvent *ev);
+static void planUpdated(UAVObjEvent *ev);
 static void updatePathDesired();
 static void setWaypoint(uint16_t num);
+static void refreshActiveWaypoint();
 
 static uint8_t checkPathPlan();
-static uint8_t pathConditionCheck();
+static uint8_t pathConditionCheck(const struct navigationSnapshot *nav);
 static uint8_t conditionNone();
 static uint8_t conditionTimeOut();
-static uint8_t conditionDistanceToTarget();
-static uint8_t conditionLegRemaining();
-static uint8_t conditionBelowError();
-static uint8_t conditionAboveAltitude();
-static uint8_t conditionAboveSpeed();
-static uint8_t conditionPointingTowardsNext();
+static uint8_t conditionDistanceToTarget(const struct navigationSnapshot *nav);
+static uint8_t conditionLegRemaining(const struct navigationSnapshot *nav);
+static uint8_t conditionBelowError(const struct navigationSnapshot *nav);
+static uint8_t conditionAboveAltitude(const struct navigationSnapshot *nav);
+static uint8_t conditionAboveSpeed(const struct navigationSnapshot *nav);
+static uint8_t conditionPointingTowardsNext(const struct navigationSnapshot *nav);
 static uint8_t conditionPythonScript();
 static uint8_t conditionImmediate();
 
@@ -78,11 +100,29 @@ static uint8_t conditionImmediate();
 // Private variables
 static DelayedCallbackInfo *pathPlannerHandle;
 static DelayedCallbackInfo *pathDesiredUpdaterHandle;
+// the active waypoint, the one after it and its path action, decoded again only when changed
 static WaypointActiveData waypointActive;
 static WaypointData waypoint;
+static WaypointData nextWaypoint;
 static PathActionData pathAction;
+static uint32_t waypointActiveChange = 0;
+static uint32_t waypointChange = 0;
+static uint32_t pathActionChange = 0;
 static bool pathplanner_active = false;
 
+static struct waypointCache *waypointCache;
+static struct pathActionCache *pathActionCache;
+static uint16_t waypointCacheSize   = 0;
+static uint16_t pathActionCacheSize = 0;
+// number of leading cache entries up to date
+static uint16_t waypointCached      = 0;
+static uint16_t pathActionCached    = 0;
+// waypoint CRC the path action entries are chained from
+static uint8_t pathActionBaseCrc    = 0;
+// first instances changed since the last check, set by the event callbacks
+static uint16_t waypointChanged     = PLAN_CLEAN;
+static uint16_t pathActionChanged   = PLAN_CLEAN;
+
 
 /**
  * Module initialization
@@ -91,9 +131,9 @@ int32_t PathPlannerStart()
 {
     plan_initialize();
     // when the active waypoint changes, update pathDesired
-    WaypointConnectCallback(commandUpdated);
+    WaypointConnectCallback(planUpdated);
     WaypointActiveConnectCallback(commandUpdated);
-    PathActionConnectCallback(commandUpdated);
+    PathActionConnectCallback(planUpdated);
     PathStatusConnectCallback(statusUpdated);
 
     // Start main task callback
@@ -155,8 +195,8 @@ static void pathPlannerTask()
         return;
     }
 
-    PathDesiredData pathDesired;
-    PathDesiredGet(&pathDesired);
+    struct navigationSnapshot nav;
+    PathDesiredGet(&nav.pathDesired);
 
     static uint8_t failsafeRTHset = 0;
     if (!validPathPlan) {
@@ -179,7 +219,7 @@ static void pathPlannerTask()
     failsafeRTHset = 0;
     AlarmsClear(SYSTEMALARMS_ALARM_PATHPLAN);
 
-    WaypointActiveGet(&waypointActive);
+    refreshActiveWaypoint();
 
     if (pathplanner_active == false) {
         pathplanner_active   = true;
@@ -191,13 +231,11 @@ static void pathPlannerTask()
         return;
     }
 
-    WaypointInstGet(waypointActive.Index, &waypoint);
-    PathActionInstGet(waypoint.Action, &pathAction);
     PathStatusData pathStatus;
     PathStatusGet(&pathStatus);
 
     // delay next step until path follower has acknowledged the path mode
-    if (pathStatus.UID != pathDesired.UID) {
+    if (pathStatus.UID != nav.pathDesired.UID) {
         return;
     }
 
@@ -208,7 +246,9 @@ static void pathPlannerTask()
     }
 
     // check if condition has been met
-    endCondition = pathConditionCheck();
+    PositionStateGet(&nav.position);
+    VelocityStateGet(&nav.velocity);
+    endCondition = pathConditionCheck(&nav);
     // decide what to do
     switch (pathAction.Command) {
     case PATHACTION_COMMAND_ONNOTCONDITIONNEXTWAYPOINT:
@@ -245,7 +285,30 @@ static void pathPlannerTask()
     }
 }
 
+// make room for count entries of size bytes in a cache, keeping its content
+static bool growCache(void **cache, uint16_t *cacheSize, uint16_t count, size_t size)
+{
+    if (count <= *cacheSize) {
+        return true;
+    }
+    // grow by blocks, the instances are uploaded one by one
+    uint16_t newSize = (count + 31) & ~31;
+    void *newCache   = pios_malloc(newSize * size);
+    if (!newCache) {
+        return false;
+    }
+    if (*cache) {
+        memcpy(newCache, *cache, *cacheSize * size);
+        pios_free(*cache);
+    }
+    *cache     = newCache;
+    *cacheSize = newSize;
+    return true;
+}
+
 // safety checks for path plan integrity
+// Only the instances changed since the last check are read again, the CRC is chained
+// from the cached CRC of the instance before the first changed one.
 static uint8_t checkPathPlan()
 {
     uint16_t i;
@@ -257,6 +320,18 @@ static uint8_t checkPathPlan()
     // WaypointData waypoint; // using global instead (?)
     // PathActionData action; // using global instead (?)
 
+    // take the changes, later ones are seen by the next check
+    portENTER_CRITICAL();
+    if (waypointChanged < waypointCached) {
+        waypointCached = waypointChanged;
+    }
+    if (pathActionChanged < pathActionCached) {
+        pathActionCached = pathActionChanged;
+    }
+    waypointChanged   = PLAN_CLEAN;
+    pathActionChanged = PLAN_CLEAN;
+    portEXIT_CRITICAL();
+
     PathPlanGet(&pathPlan);
 
     waypointCount = pathPlan.WaypointCount;
@@ -276,14 +351,42 @@ static uint8_t checkPathPlan()
         return false;
     }
 
-    // check CRC
-    pathCrc = 0;
-    for (i = 0; i < waypointCount; i++) {
-        pathCrc = UAVObjUpdateCRC(WaypointHandle(), i, pathCrc);
+    if (!growCache((void **)&waypointCache, &waypointCacheSize, waypointCount, sizeof(struct waypointCache)) ||
+        !growCache((void **)&pathActionCache, &pathActionCacheSize, actionCount, sizeof(struct pathActionCache))) {
+        return false;
     }
-    for (i = 0; i < actionCount; i++) {
-        pathCrc = UAVObjUpdateCRC(PathActionHandle(), i, pathCrc);
+
+    // update the cache from the first changed instance
+    if (waypointCached > waypointCount) {
+        waypointCached = waypointCount;
+    }
+    for (i = waypointCached; i < waypointCount; i++) {
+        pathCrc = i ? waypointCache[i - 1].crc : 0;
+        WaypointInstGet(i, &waypoint);
+        waypointCache[i].crc    = PIOS_CRC_updateCRC(pathCrc, (uint8_t *)&waypoint, UAVObjGetNumBytes(WaypointHandle()));
+        waypointCache[i].action = waypoint.Action;
+    }
+    waypointCached = waypointCount;
+
+    // the path actions are chained from the last waypoint
+    if (waypointCache[waypointCount - 1].crc != pathActionBaseCrc) {
+        pathActionBaseCrc = waypointCache[waypointCount - 1].crc;
+        pathActionCached  = 0;
+    }
+    if (pathActionCached > actionCount) {
+        pathActionCached = actionCount;
     }
+    for (i = pathActionCached; i < actionCount; i++) {
+        pathCrc = i ? pathActionCache[i - 1].crc : pathActionBaseCrc;
+        PathActionInstGet(i, &pathAction);
+        pathActionCache[i].crc = PIOS_CRC_updateCRC(pathCrc, (uint8_t *)&pathAction, UAVObjGetNumBytes(PathActionHandle()));
+        pathActionCache[i].errorDestination = pathAction.ErrorDestination;
+        pathActionCache[i].jumpDestination  = pathAction.JumpDestination;
+    }
+    pathActionCached = actionCount;
+
+    // check CRC
+    pathCrc = actionCount ? pathActionCache[actionCount - 1].crc : pathActionBaseCrc;
     if (pathCrc != pathPlan.Crc) {
         // failed crc check
         // PIOS_DEBUGLOG_Printf("PathPlan : bad CRC (%d / %d)!", pathCrc, pathPlan.Crc);
@@ -292,8 +395,7 @@ static uint8_t checkPathPlan()
 
     // waypoint consistency
     for (i = 0; i < waypointCount; i++) {
-        WaypointInstGet(i, &waypoint);
-        if (waypoint.Action >= actionCount) {
+        if (waypointCache[i].action >= actionCount) {
             // path action id is out of range
             return false;
         }
@@ -301,12 +403,11 @@ static uint8_t checkPathPlan()
 
     // path action consistency
     for (i = 0; i < actionCount; i++) {
-        PathActionInstGet(i, &pathAction);
-        if (pathAction.ErrorDestination >= waypointCount) {
+        if (pathActionCache[i].errorDestination >= waypointCount) {
             // waypoint id is out of range
             return false;
         }
-        if (pathAction.JumpDestination >= waypointCount) {
+        if (pathActionCache[i].jumpDestination >= waypointCount) {
             // waypoint id is out of range
             return false;
         }
@@ -317,6 +418,22 @@ static uint8_t checkPathPlan()
     return true;
 }
 
+// callback function when a waypoint or a path action changed, invalidate its cache entry
+void planUpdated(UAVObjEvent *ev)
+{
+    portENTER_CRITICAL();
+    if (ev->obj == WaypointHandle()) {
+        if (ev->instId < waypointChanged) {
+            waypointChanged = ev->instId;
+        }
+    } else if (ev->instId < pathActionChanged) {
+        pathActionChanged = ev->instId;
+    }
+    portEXIT_CRITICAL();
+
+    commandUpdated(ev);
+}
+
 // callback function when status changed, issue execution of state machine
 void commandUpdated(__attribute__((unused)) UAVObjEvent *ev)
 {
@@ -341,10 +458,7 @@ void updatePathDesired()
     PathDesiredData pathDesired;
 
     // find out current waypoint
-    WaypointActiveGet(&waypointActive);
-
-    WaypointInstGet(waypointActive.Index, &waypoint);
-    PathActionInstGet(waypoint.Action, &pathAction);
+    refreshActiveWaypoint();
 
     pathDesired.End.North = waypoint.Position.North;
     pathDesired.End.East  = waypoint.Position.East;
@@ -382,6 +496,29 @@ void updatePathDesired()
     PathDesiredSet(&pathDesired);
 }
 
+// decode the active waypoint, the next one and the path action again if any of them changed
+static void refreshActiveWaypoint()
+{
+    // evaluated separately, every change count must be taken
+    bool changed = WaypointActiveChanged(&waypointActiveChange);
+
+    changed |= WaypointChanged(&waypointChange);
+    changed |= PathActionChanged(&pathActionChange);
+    if (!changed) {
+        return;
+    }
+
+    WaypointActiveGet(&waypointActive);
+    WaypointInstGet(waypointActive.Index, &waypoint);
+    PathActionInstGet(waypoint.Action, &pathAction);
+
+    uint16_t nextWaypointId = waypointActive.Index + 1;
+    if (nextWaypointId >= UAVObjGetNumInstances(WaypointHandle())) {
+        nextWaypointId = 0;
+    }
+    WaypointInstGet(nextWaypointId, &nextWaypoint);
+}
+
 // helper function to go to a specific waypoint
 static void setWaypoint(uint16_t num)
 {
@@ -400,7 +537,7 @@ static void setWaypoint(uint16_t num)
 }
 
 // execute the appropriate condition and report result
-static uint8_t pathConditionCheck()
+static uint8_t pathConditionCheck(const struct navigationSnapshot *nav)
 {
     // i thought about a lookup table, but a switch is safer considering there could be invalid EndCondition ID's
     switch (pathAction.EndCondition) {
@@ -413,27 +550,27 @@ static uint8_t pathConditionCheck()
 
         break;
     case PATHACTION_ENDCONDITION_DISTANCETOTARGET:
-        return conditionDistanceToTarget();
+        return conditionDistanceToTarget(nav);
 
         break;
     case PATHACTION_ENDCONDITION_LEGREMAINING:
-        return conditionLegRemaining();
+        return conditionLegRemaining(nav);
 
         break;
     case PATHACTION_ENDCONDITION_BELOWERROR:
-        return conditionBelowError();
+        return conditionBelowError(nav);
 
         break;
     case PATHACTION_ENDCONDITION_ABOVEALTITUDE:
-        return conditionAboveAltitude();
+        return conditionAboveAltitude(nav);
 
         break;
     case PATHACTION_ENDCONDITION_ABOVESPEED:
-        return conditionAboveSpeed();
+        return conditionAboveSpeed(nav);
 
         break;
     case PATHACTION_ENDCONDITION_POINTINGTOWARDSNEXT:
-        return conditionPointingTowardsNext();
+        return conditionPointingTowardsNext(nav);
 
         break;
     case PATHACTION_ENDCONDITION_PYTHONSCRIPT:
@@ -486,19 +623,18 @@ static uint8_t conditionTimeOut()
  * Parameter 0:  distance in meters
  * Parameter 1:  flag: 0=2d 1=3d
  */
-static uint8_t conditionDistanceToTarget()
+static uint8_t conditionDistanceToTarget(const struct navigationSnapshot *nav)
 {
+    const PositionStateData *positionState = &nav->position;
     float distance;
-    PositionStateData positionState;
 
-    PositionStateGet(&positionState);
     if (pathAction.ConditionParameters[1] > 0.5f) {
-        distance = sqrtf(powf(waypoint.Position.North - positionState.North, 2)
-                         + powf(waypoint.Position.East - positionState.East, 2)
-                         + powf(waypoint.Position.Down - positionState.Down, 2));
+        distance = sqrtf(powf(waypoint.Position.North - positionState->North, 2)
+                         + powf(waypoint.Position.East - positionState->East, 2)
+                         + powf(waypoint.Position.Down - positionState->Down, 2));
     } else {
-        distance = sqrtf(powf(waypoint.Position.North - positionState.North, 2)
-                         + powf(waypoint.Position.East - positionState.East, 2));
+        distance = sqrtf(powf(waypoint.Position.North - positionState->North, 2)
+                         + powf(waypoint.Position.East - positionState->East, 2));
     }
 
     if (distance <= pathAction.ConditionParameters[0]) {
@@ -513,18 +649,12 @@ static uint8_t conditionDistanceToTarget()
  * returns true if closer to destination (path more complete)
  * Parameter 0:  relative distance (0= complete, 1= just starting)
  */
-static uint8_t conditionLegRemaining()
+static uint8_t conditionLegRemaining(const struct navigationSnapshot *nav)
 {
-    PathDesiredData pathDesired;
-    PositionStateData positionState;
-
-    PathDesiredGet(&pathDesired);
-    PositionStateGet(&positionState);
-
-    float cur[3] = { positionState.North, positionState.East, positionState.Down };
+    float cur[3] = { nav->position.North, nav->position.East, nav->position.Down };
     struct path_status progress;
 
-    path_progress(&pathDesired,
+    path_progress(&nav->pathDesired,
                   cur, &progress);
     if (progress.fractional_progress >= 1.0f - pathAction.ConditionParameters[0]) {
         return true;
@@ -537,18 +667,12 @@ static uint8_t conditionLegRemaining()
  * returns true if error is below margin
  * Parameter 0: error margin (in m)
  */
-static uint8_t conditionBelowError()
+static uint8_t conditionBelowError(const struct navigationSnapshot *nav)
 {
-    PathDesiredData pathDesired;
-    PositionStateData positionState;
-
-    PathDesiredGet(&pathDesired);
-    PositionStateGet(&positionState);
-
-    float cur[3] = { positionState.North, positionState.East, positionState.Down };
+    float cur[3] = { nav->position.North, nav->position.East, nav->position.Down };
     struct path_status progress;
 
-    path_progress(&pathDesired,
+    path_progress(&nav->pathDesired,
                   cur, &progress);
     if (progress.error <= pathAction.ConditionParameters[0]) {
         return true;
@@ -562,13 +686,9 @@ static uint8_t conditionBelowError()
  * WARNING! Altitudes are always negative (down coordinate)
  * Parameter 0:  altitude in meters (negative!)
  */
-static uint8_t conditionAboveAltitude()
+static uint8_t conditionAboveAltitude(const struct navigationSnapshot *nav)
 {
-    PositionStateData positionState;
-
-    PositionStateGet(&positionState);
-
-    if (positionState.Down <= pathAction.ConditionParameters[0]) {
+    if (nav->position.Down <= pathAction.ConditionParameters[0]) {
         return true;
     }
     return false;
@@ -580,12 +700,10 @@ static uint8_t conditionAboveAltitude()
  * Parameter 0:  speed in m/s
  * Parameter 1:  flag: 0=groundspeed 1=airspeed
  */
-static uint8_t conditionAboveSpeed()
+static uint8_t conditionAboveSpeed(const struct navigationSnapshot *nav)
 {
-    VelocityStateData velocityState;
-
-    VelocityStateGet(&velocityState);
-    float velocity = sqrtf(velocityState.North * velocityState.North + velocityState.East * velocityState.East + velocityState.Down * velocityState.Down);
+    const VelocityStateData *velocityState = &nav->velocity;
+    float velocity = sqrtf(velocityState->North * velocityState->North + velocityState->East * velocityState->East + velocityState->Down * velocityState->Down);
 
     // use airspeed if requested and available
     if (pathAction.ConditionParameters[1] > 0.5f) {
@@ -608,21 +726,11 @@ static uint8_t conditionAboveSpeed()
  * returns true if within a certain angular margin
  * Parameter 0:  degrees variation allowed
  */
-static uint8_t conditionPointingTowardsNext()
+static uint8_t conditionPointingTowardsNext(const struct navigationSnapshot *nav)
 {
-    uint16_t nextWaypointId = waypointActive.Index + 1;
-
-    if (nextWaypointId >= UAVObjGetNumInstances(WaypointHandle())) {
-        nextWaypointId = 0;
-    }
-    WaypointData nextWaypoint;
-    WaypointInstGet(nextWaypointId, &nextWaypoint);
-
     float angle1 = atan2f((nextWaypoint.Position.North - waypoint.Position.North), (nextWaypoint.Position.East - waypoint.Position.East));
 
-    VelocityStateData velocity;
-    VelocityStateGet(&velocity);
-    float angle2 = atan2f(velocity.North, velocity.East);
+    float angle2 = atan2f(nav->velocity.North, nav->velocity.East);
 
     // calculate the absolute angular difference
     angle1 = fabsf(RAD2DEG(angle1 - angle2));
@@ -108,8 +108,10 @@ static void radioRxTask(void *parameters);
 static void PPMInputTask(void *parameters);
 static int32_t UAVTalkSendHandler(uint8_t *buf, int32_t length);
 static int32_t RadioSendHandler(uint8_t *buf, int32_t length);
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte);
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length);
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length);
+static bool RelayTelemetryObject(uint32_t objId);
+static bool RelayRadioObject(uint32_t objId);
 static void objectPersistenceUpdatedCb(UAVObjEvent *objEv);
 static void registerObject(UAVObjHandle obj);
 
@@ -403,14 +405,13 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
         PIOS_WDG_UpdateFlag(PIOS_WDG_RADIORX);
 #endif
         if (PIOS_COM_RADIO) {
-            uint8_t serial_data[1];
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
+            // Block until data are available, then relay them in place from the COM fifo
+            const uint8_t *serial_data;
+            uint16_t bytes_to_process = PIOS_COM_ReceiveSpan(PIOS_COM_RADIO, &serial_data, MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
                 if (data->parseUAVTalk) {
-                    // Pass the data through the UAVTalk parser.
-                    for (uint8_t i = 0; i < bytes_to_process; i++) {
-                        ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data[i]);
-                    }
+                    // Pass the data through the UAVTalk relay.
+                    ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data, bytes_to_process);
                 } else if (PIOS_COM_TELEMETRY) {
                     // Send the data straight to the telemetry port.
                     // Following call can fail with -2 error code (buffer full) or -3 error code (could not acquire send mutex)
@@ -421,6 +422,7 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
                         ret = PIOS_COM_SendBufferNonBlocking(PIOS_COM_TELEMETRY, serial_data, bytes_to_process);
                     }
                 }
+                PIOS_COM_ReceiveRelease(PIOS_COM_RADIO, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -448,12 +450,12 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
         }
 #endif /* PIOS_INCLUDE_USB */
         if (inputPort) {
-            uint8_t serial_data[1];
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
+            // Block until data are available, then relay them in place from the COM fifo
+            const uint8_t *serial_data;
+            uint16_t bytes_to_process = PIOS_COM_ReceiveSpan(inputPort, &serial_data, MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, serial_data[i]);
-                }
+                ProcessTelemetryStream(data->telemUAVTalkCon, data->radioUAVTalkCon, serial_data, bytes_to_process);
+                PIOS_COM_ReceiveRelease(inputPort, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -591,18 +593,73 @@ static int32_t RadioSendHandler(uint8_t *buf, int32_t length)
 }
 
 /**
- * @brief Process a byte of data received on the telemetry stream
+ * @brief Tells which telemetry objects are cut through to the radio without being parsed
+ *
+ * @param[in] objId  The object ID from the packet header.
+ * @return false for the objects the modem handles itself
+ */
+static bool RelayTelemetryObject(uint32_t objId)
+{
+    switch (objId) {
+    case OPLINKSTATUS_OBJID:
+    case OPLINKSETTINGS_OBJID:
+    case OPLINKRECEIVER_OBJID:
+    case OBJECTPERSISTENCE_OBJID:
+    case MetaObjectId(OPLINKSTATUS_OBJID):
+    case MetaObjectId(OPLINKSETTINGS_OBJID):
+    case MetaObjectId(OPLINKRECEIVER_OBJID):
+    case MetaObjectId(OBJECTPERSISTENCE_OBJID):
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Tells which radio objects are cut through to the telemetry port without being parsed
+ *
+ * @param[in] objId  The object ID from the packet header.
+ * @return false for the objects the modem shadows or handles itself
+ */
+static bool RelayRadioObject(uint32_t objId)
+{
+    switch (objId) {
+    case OPLINKSTATUS_OBJID:
+    case OPLINKSETTINGS_OBJID:
+    case OPLINKRECEIVER_OBJID:
+    case MetaObjectId(OPLINKSTATUS_OBJID):
+    case MetaObjectId(OPLINKSETTINGS_OBJID):
+    case MetaObjectId(OPLINKRECEIVER_OBJID):
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Process data received on the telemetry stream
+ *
+ * Packets are cut through to the remote modem unless RelayTelemetryObject() claims them,
+ * those are parsed completely and handled here.
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the telemetry port
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the radio port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] rxbuffer  The received bytes.
+ * @param[in] length  The number of received bytes.
  */
-static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
+    uint16_t position = 0;
+
+    while (position < length) {
+        UAVTalkRxState state;
+        position += UAVTalkRelayInputBuffer(inConnectionHandle, outConnectionHandle, &rxbuffer[position], length - position, &RelayTelemetryObject, &state);
+        if (state != UAVTALK_STATE_COMPLETE) {
+            continue;
+        }
 
-    if (state == UAVTALK_STATE_COMPLETE) {
         // We only want to unpack certain telemetry objects
         uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
         switch (objId) {
@@ -638,18 +695,27 @@ static void ProcessTelemetryStream(UAVTalkConnection inConnectionHandle, UAVTalk
 }
 
 /**
- * @brief Process a byte of data received on the radio data stream.
+ * @brief Process data received on the radio data stream.
+ *
+ * Packets are cut through to the telemetry port unless RelayRadioObject() claims them,
+ * those are parsed completely and handled here.
  *
  * @param[in] inConnectionHandle  The UAVTalk connection handle on the radio port.
  * @param[in] outConnectionHandle  The UAVTalk connection handle on the telemetry port.
- * @param[in] rxbyte  The received byte.
+ * @param[in] rxbuffer  The received bytes.
+ * @param[in] length  The number of received bytes.
  */
-static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, uint8_t rxbyte)
+static void ProcessRadioStream(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length)
 {
-    // Keep reading until we receive a completed packet.
-    UAVTalkRxState state = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbyte);
+    uint16_t position = 0;
+
+    while (position < length) {
+        UAVTalkRxState state;
+        position += UAVTalkRelayInputBuffer(inConnectionHandle, outConnectionHandle, &rxbuffer[position], length - position, &RelayRadioObject, &state);
+        if (state != UAVTALK_STATE_COMPLETE) {
+            continue;
+        }
 
-    if (state == UAVTALK_STATE_COMPLETE) {
         // We only want to unpack certain objects from the remote modem
         // Similarly we only want to relay certain objects to the telemetry port
         uint32_t objId = UAVTalkGetPacketObjId(inConnectionHandle);
@@ -45,6 +45,9 @@
 #include <flightmodesettings.h>
 #include <systemsettings.h>
 #include <taskinfo.h>
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+#include <receiverstats.h>
+#endif
 
 
 #if defined(PIOS_INCLUDE_USB_RCTX)
@@ -60,6 +63,8 @@
 
 #define TASK_PRIORITY                    (tskIDLE_PRIORITY + 3) // 3 = flight control
 #define UPDATE_PERIOD_MS                 20
+#define CONNECTION_HYSTERESIS_MS         (10 * UPDATE_PERIOD_MS)
+#define STATS_PERIOD_MS                  1000
 #define THROTTLE_FAILSAFE                -0.1f
 #define ARMED_THRESHOLD                  0.50f
 // safe band to allow a bit of calibration error or trim offset (in microseconds)
@@ -72,6 +77,7 @@
 // Private variables
 static xTaskHandle taskHandle;
 static portTickType lastSysTime;
+static volatile bool settingsUpdated = true;
 
 #ifdef USE_INPUT_LPF
 static portTickType lastSysTimeLPF;
@@ -84,6 +90,8 @@ static float scaleChannel(int16_t value, int16_t max, int16_t min, int16_t neutr
 static uint32_t timeDifferenceMs(portTickType start_time, portTickType end_time);
 static bool validInputRange(int16_t min, int16_t max, uint16_t value);
 static void applyDeadband(float *value, float deadband);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static xSemaphoreHandle getFrameSemaphore(ManualControlSettingsData *settings, uint32_t *rcvr_id);
 
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
 static uint8_t isAssistedFlightMode(uint8_t position);
@@ -141,6 +149,7 @@ int32_t ReceiverInitialize()
     ManualControlSettingsInitialize();
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
     StabilizationSettingsInitialize();
+    ReceiverStatsInitialize();
 #endif
 
 
@@ -157,8 +166,8 @@ static void receiverTask(__attribute__((unused)) void *parameters)
     ManualControlCommandData cmd;
     FlightStatusData flightStatus;
 
-    uint8_t disconnected_count = 0;
-    uint8_t connected_count    = 0;
+    uint32_t disconnected_ms = 0;
+    uint32_t connected_ms    = 0;
 
     // For now manual instantiate extra instances of Accessory Desired.  In future should be done dynamically
     // this includes not even registering it if not used
@@ -170,29 +179,58 @@ static void receiverTask(__attribute__((unused)) void *parameters)
     ManualControlCommandGet(&cmd);
     FlightStatusGet(&flightStatus);
 
+    // Settings are only read again after they changed
+    ManualControlSettingsConnectCallback(settingsUpdatedCb);
+    SystemSettingsConnectCallback(settingsUpdatedCb);
+
     /* Initialize the RcvrActivty FSM */
-    portTickType lastActivityTime = xTaskGetTickCount();
+    portTickType lastActivityTime   = xTaskGetTickCount();
+    portTickType lastActivitySample = lastActivityTime;
     resetRcvrActivity(&activity_fsm);
 
     // Main task loop
     lastSysTime = xTaskGetTickCount();
+    portTickType prevSysTime = lastSysTime;
 
     float scaledChannel[MANUALCONTROLSETTINGS_CHANNELGROUPS_NUMELEM] = { 0 };
     SystemSettingsThrustControlOptions thrustType;
+    xSemaphoreHandle frameSemaphore = NULL;
+    uint32_t frameRcvr       = 0;
+
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+    portTickType lastStatsTime = lastSysTime;
+    uint32_t latencySum    = 0;
+    uint32_t latencyMax    = 0;
+    uint16_t frameCount    = 0;
+#endif
 
     while (1) {
-        // Wait until next update
-        vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        // Wait for the next frame of the stick receiver, or until next update if it can't signal one
+        bool newFrame = false;
+        if (frameSemaphore) {
+            newFrame    = xSemaphoreTake(frameSemaphore, UPDATE_PERIOD_MS / portTICK_RATE_MS) == pdTRUE;
+            lastSysTime = xTaskGetTickCount();
+        } else {
+            vTaskDelayUntil(&lastSysTime, UPDATE_PERIOD_MS / portTICK_RATE_MS);
+        }
+        uint32_t cycleMs = timeDifferenceMs(prevSysTime, lastSysTime);
+        prevSysTime = lastSysTime;
 #ifdef PIOS_INCLUDE_WDG
         PIOS_WDG_UpdateFlag(PIOS_WDG_MANUAL);
 #endif
 
         // Read settings
-        ManualControlSettingsGet(&settings);
-        SystemSettingsThrustControlGet(&thrustType);
+        if (settingsUpdated) {
+            settingsUpdated = false;
+            ManualControlSettingsGet(&settings);
+            SystemSettingsThrustControlGet(&thrustType);
+            frameSemaphore = getFrameSemaphore(&settings, &frameRcvr);
+        }
 
-        /* Update channel activity monitor */
-        if (flightStatus.Armed == FLIGHTSTATUS_ARMED_DISARMED) {
+        /* Update channel activity monitor, it compares samples taken one update period apart */
+        if (flightStatus.Armed == FLIGHTSTATUS_ARMED_DISARMED
+            && timeDifferenceMs(lastActivitySample, lastSysTime) >= UPDATE_PERIOD_MS) {
+            lastActivitySample = lastSysTime;
             if (updateRcvrActivity(&activity_fsm)) {
                 /* Reset the aging timer because activity was detected */
                 lastActivityTime = lastSysTime;
@@ -309,15 +347,15 @@ static void receiverTask(__attribute__((unused)) void *parameters)
                                                     settings.ChannelMax.Accessory2, cmd.Channel[MANUALCONTROLSETTINGS_CHANNELGROUPS_ACCESSORY2]);
         }
 
-        // Implement hysteresis loop on connection status
-        if (valid_input_detected && (++connected_count > 10)) {
-            cmd.Connected      = MANUALCONTROLCOMMAND_CONNECTED_TRUE;
-            connected_count    = 0;
-            disconnected_count = 0;
-        } else if (!valid_input_detected && (++disconnected_count > 10)) {
-            cmd.Connected      = MANUALCONTROLCOMMAND_CONNECTED_FALSE;
-            connected_count    = 0;
-            disconnected_count = 0;
+        // Implement hysteresis loop on connection status, in time as the update rate follows the receiver
+        if (valid_input_detected && ((connected_ms += cycleMs) > CONNECTION_HYSTERESIS_MS)) {
+            cmd.Connected   = MANUALCONTROLCOMMAND_CONNECTED_TRUE;
+            connected_ms    = 0;
+            disconnected_ms = 0;
+        } else if (!valid_input_detected && ((disconnected_ms += cycleMs) > CONNECTION_HYSTERESIS_MS)) {
+            cmd.Connected   = MANUALCONTROLCOMMAND_CONNECTED_FALSE;
+            connected_ms    = 0;
+            disconnected_ms = 0;
         }
 
         if (cmd.Connected == MANUALCONTROLCOMMAND_CONNECTED_FALSE) {
@@ -474,6 +512,31 @@ static void receiverTask(__attribute__((unused)) void *parameters)
         // Update cmd object
         ManualControlCommandSet(&cmd);
 
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+        // Input latency from the end of the frame to the command update
+        uint32_t frameTime = newFrame ? PIOS_RCVR_GetFrameTime(frameRcvr) : 0;
+        if (frameTime) {
+            uint32_t latency = PIOS_DELAY_DiffuS(frameTime);
+            latencySum += latency;
+            if (latency > latencyMax) {
+                latencyMax = latency;
+            }
+            frameCount++;
+        }
+        if (timeDifferenceMs(lastStatsTime, lastSysTime) >= STATS_PERIOD_MS) {
+            ReceiverStatsData stats;
+            stats.Latency    = frameCount ? latencySum / frameCount : 0;
+            stats.LatencyMax = latencyMax;
+            stats.FrameRate  = frameCount * 1000 / timeDifferenceMs(lastStatsTime, lastSysTime);
+            ReceiverStatsSet(&stats);
+            lastStatsTime = lastSysTime;
+            latencySum    = 0;
+            latencyMax    = 0;
+            frameCount    = 0;
+        }
+#else
+        (void)newFrame;
+#endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
 
 #if defined(PIOS_INCLUDE_USB_RCTX)
         if (pios_usb_rctx_id) {
@@ -487,6 +550,33 @@ static void receiverTask(__attribute__((unused)) void *parameters)
     }
 }
 
+/**
+ * Settings changed, they are read again on the next update
+ */
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    settingsUpdated = true;
+}
+
+/**
+ * Get the semaphore the receiver of the roll channel gives on each frame.
+ * A frame updates all the channels of its group, so the first channel is used.
+ * \param[out] rcvr_id the receiver, to query its frame time
+ * \return the semaphore or NULL if the receiver doesn't signal its frames
+ */
+static xSemaphoreHandle getFrameSemaphore(ManualControlSettingsData *settings, uint32_t *rcvr_id)
+{
+    extern uint32_t pios_rcvr_group_map[];
+
+    *rcvr_id = 0;
+    if (settings->ChannelGroups.Roll >= MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE) {
+        return NULL;
+    }
+
+    *rcvr_id = pios_rcvr_group_map[settings->ChannelGroups.Roll];
+    return PIOS_RCVR_GetSemaphore(*rcvr_id, 1);
+}
+
 static void resetRcvrActivity(struct rcvr_activity_fsm *fsm)
 {
     ReceiverActivityData data;
@@ -61,11 +61,13 @@
 #include <revosettings.h>
 
 #include <mathmisc.h>
+#include <biquad.h>
 #include <taskinfo.h>
 #include <pios_math.h>
 #include <pios_constants.h>
 #include <CoordinateConversions.h>
 #include <pios_board_info.h>
+#include <fastloop.h>
 #include <string.h>
 
 // Private constants
@@ -101,6 +103,8 @@ static const float temp_alpha_baro = TEMP_DT_BARO / (TEMP_DT_BARO + 1.0f / (2.0f
 
 
 #define ZERO_ROT_ANGLE           0.00001f
+// Prefilter cut-offs are kept below this fraction of the sensor rate
+#define MAX_PREFILTER_RATIO      0.45f
 // Private types
 typedef struct {
     // used to accumulate all samples in a task iteration
@@ -129,11 +133,13 @@ PERF_DEFINE_COUNTER(counterSensorResets);
 static void SensorsTask(void *parameters);
 static void settingsUpdatedCb(UAVObjEvent *objEv);
 
-static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample);
+static void accumulateSamples(sensor_fetch_context *sensor_context, const PIOS_SENSORS_3Axis_SensorsWithTemp *sample);
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor);
 static void processSamples1d(PIOS_SENSORS_1Axis_SensorsWithTemp *sample, const PIOS_SENSORS_Instance *sensor);
 
 static void clearContext(sensor_fetch_context *sensor_context);
+static bool isEventDriven(const PIOS_SENSORS_Instance *sensor);
+static TickType_t pollDelayTicks(const PIOS_SENSORS_Instance *sensor);
 
 static void handleAccel(float *samples, float temperature);
 static void handleGyro(float *samples, float temperature);
@@ -143,6 +149,8 @@ static void handleBaro(float sample, float temperature);
 static void updateAccelTempBias(float temperature);
 static void updateGyroTempBias(float temperature);
 static void updateBaroTempBias(float temperature);
+static void updateGyroPrefilter(const float samples[3]);
+static void updateAccelPrefilter(const float samples[3]);
 
 // Private variables
 static sensor_data *source_data;
@@ -181,6 +189,12 @@ static uint8_t baro_temp_calibration_count = 0;
 
 static int8_t rotate = 0;
 
+// Gyro and accel prefilters, rebuilt by the sensor task when the settings changed
+static struct biquad_bank gyro_prefilter;
+static struct biquad_bank accel_prefilter;
+static volatile bool gyro_prefilter_changed;
+static volatile bool accel_prefilter_changed;
+
 /**
  * Initialise the module.  Called before the start function
  * \returns 0 on success or -1 if initialisation failed
@@ -229,7 +243,8 @@ int32_t mag_test;
 
 
 /**
- * The sensor task.  This polls the gyros at 500 Hz and pumps that data to
+ * The sensor task.  It sleeps until a sensor raises its ready event or a
+ * polled sensor is due, and pumps the gyro data at up to 500 Hz to
  * stabilization and to the attitude loop
  *
  */
@@ -237,7 +252,6 @@ int32_t mag_test;
 uint32_t sensor_dt_us;
 static void SensorsTask(__attribute__((unused)) void *parameters)
 {
-    portTickType lastSysTime;
     sensor_fetch_context sensor_context;
     bool error = false;
     const PIOS_SENSORS_Instance *sensors_list = PIOS_SENSORS_GetList();
@@ -272,63 +286,121 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
     }
 
     // Main task loop
-    lastSysTime = xTaskGetTickCount();
     uint32_t reset_counter = 0;
+    TickType_t now = xTaskGetTickCount();
+    LL_FOREACH((PIOS_SENSORS_Instance *)sensors_list, sensor) {
+        sensor->next_poll = now;
+    }
 
     while (1) {
         // TODO: add timeouts to the sensor reads and set an error if the fail
         if (error) {
             RELOAD_WDG();
-            lastSysTime = xTaskGetTickCount();
-            vTaskDelayUntil(&lastSysTime, sensor_period_ticks);
+            vTaskDelay(sensor_period_ticks);
             AlarmsSet(SYSTEMALARMS_ALARM_SENSORS, SYSTEMALARMS_ALARM_CRITICAL);
             error = false;
         } else {
             AlarmsClear(SYSTEMALARMS_ALARM_SENSORS);
         }
 
+        // sleep until a due sensor raises its ready event or the next poll is scheduled,
+        // the period bounds the wait so a silent primary sensor is noticed
+        uint32_t wait_mask = 0;
+        TickType_t wait    = sensor_period_ticks;
+        now = xTaskGetTickCount();
+        LL_FOREACH((PIOS_SENSORS_Instance *)sensors_list, sensor) {
+            int32_t due_in = (int32_t)(sensor->next_poll - now);
+            if (due_in > 0) {
+                wait = MIN(wait, (TickType_t)due_in);
+            } else if (isEventDriven(sensor)) {
+                wait_mask |= sensor->event;
+            } else {
+                wait = 0;
+            }
+        }
+        uint32_t events = PIOS_SENSORS_WaitEvents(wait_mask, wait);
+        now = xTaskGetTickCount();
 
         // reset the fetch context
         clearContext(&sensor_context);
         LL_FOREACH((PIOS_SENSORS_Instance *)sensors_list, sensor) {
-            // we will wait on the sensor that's marked as primary( that means the sensor with higher sample rate)
+            int32_t late = (int32_t)(now - sensor->next_poll);
+            if (late < 0) {
+                continue;
+            }
+            // the primary sensor is the one with higher sample rate
             bool is_primary = (sensor->type & PIOS_SENSORS_TYPE_3AXIS_ACCEL);
 
+            if (isEventDriven(sensor) && !(events & sensor->event)) {
+                if (is_primary && late >= (int32_t)sensor_period_ticks) {
+                    PIOS_SENSOR_Reset(sensor);
+                    reset_counter++;
+                    PERF_TRACK_VALUE(counterSensorResets, reset_counter);
+                    error = true;
+                    sensor->next_poll = now;
+                }
+                continue;
+            }
+
             if (!sensor->driver->is_polled) {
-                const QueueHandle_t queue = PIOS_SENSORS_GetQueue(sensor);
-                while (xQueueReceive(queue,
-                                     (void *)source_data,
-                                     (is_primary && !sensor_context.count) ? sensor_period_ticks : 0) == pdTRUE) {
-                    accumulateSamples(&sensor_context, source_data);
+                // samples are accumulated in place from the driver ring
+                PIOS_SENSORS_Ring *ring = PIOS_SENSORS_GetRing(sensor);
+                const PIOS_SENSORS_3Axis_SensorsWithTemp *sample;
+                while ((sample = PIOS_SENSORS_RingPeek(ring)) != NULL) {
+                    accumulateSamples(&sensor_context, sample);
+                    PIOS_SENSORS_RingRelease(ring);
                 }
                 if (sensor_context.count) {
                     processSamples3d(&sensor_context, sensor);
                     clearContext(&sensor_context);
-                } else if (is_primary) {
-                    PIOS_SENSOR_Reset(sensor);
-                    reset_counter++;
-                    PERF_TRACK_VALUE(counterSensorResets, reset_counter);
-                    error = true;
                 }
+                // the filters downstream run at PIOS_SENSOR_RATE, samples arriving earlier are averaged in the ring
+                sensor->next_poll = now + sensor_period_ticks;
             } else {
                 if (PIOS_SENSORS_Poll(sensor)) {
                     PIOS_SENSOR_Fetch(sensor, (void *)source_data, MAX_SENSORS_PER_INSTANCE);
                     if (sensor->type & PIOS_SENSORS_TYPE_3D) {
-                        accumulateSamples(&sensor_context, source_data);
+                        accumulateSamples(&sensor_context, &source_data->sensorSample3Axis);
                         processSamples3d(&sensor_context, sensor);
                     } else {
                         processSamples1d(&source_data->sensorSample1Axis, sensor);
                     }
                     clearContext(&sensor_context);
                 }
+                sensor->next_poll = now + pollDelayTicks(sensor);
             }
         }
         PERF_MEASURE_PERIOD(counterSensorPeriod);
         RELOAD_WDG();
-        vTaskDelayUntil(&lastSysTime, sensor_period_ticks);
     }
 }
 
+/**
+ * Interrupt driven sensors and those raising a ready event are only
+ * serviced once the event was raised, instead of being polled every period
+ */
+static bool isEventDriven(const PIOS_SENSORS_Instance *sensor)
+{
+    return !sensor->driver->is_polled || sensor->driver->signals_ready;
+}
+
+/**
+ * Delay until a polled sensor is serviced again
+ */
+static TickType_t pollDelayTicks(const PIOS_SENSORS_Instance *sensor)
+{
+    if (isEventDriven(sensor)) {
+        // serviced again as soon as the next event is raised
+        return 0;
+    }
+    uint32_t delay_us = PIOS_SENSORS_GetPollDelay(sensor);
+    if (!delay_us) {
+        return sensor_period_ticks;
+    }
+    // round up, polling before the driver is ready is wasted
+    return delay_us / (1000 * portTICK_RATE_MS) + 1;
+}
+
 static void clearContext(sensor_fetch_context *sensor_context)
 {
     // clear the context once it has finished
@@ -341,14 +413,14 @@ static void clearContext(sensor_fetch_context *sensor_context)
     sensor_context->count = 0;
 }
 
-static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample)
+static void accumulateSamples(sensor_fetch_context *sensor_context, const PIOS_SENSORS_3Axis_SensorsWithTemp *sample)
 {
-    for (uint32_t i = 0; (i < MAX_SENSORS_PER_INSTANCE) && (i < sample->sensorSample3Axis.count); i++) {
-        sensor_context->accum[i].x += sample->sensorSample3Axis.sample[i].x;
-        sensor_context->accum[i].y += sample->sensorSample3Axis.sample[i].y;
-        sensor_context->accum[i].z += sample->sensorSample3Axis.sample[i].z;
+    for (uint32_t i = 0; (i < MAX_SENSORS_PER_INSTANCE) && (i < sample->count); i++) {
+        sensor_context->accum[i].x += sample->sample[i].x;
+        sensor_context->accum[i].y += sample->sample[i].y;
+        sensor_context->accum[i].z += sample->sample[i].z;
     }
-    sensor_context->temperature += sample->sensorSample3Axis.temperature;
+    sensor_context->temperature += sample->temperature;
     sensor_context->count++;
 }
 
@@ -416,6 +488,11 @@ static void handleAccel(float *samples, float temperature)
                             samples[2] * agcal.accel_scale.Z - agcal.accel_bias.Z - accel_temp_bias[2] };
 
     rot_mult(R, accels_out, samples);
+    if (accel_prefilter_changed) {
+        accel_prefilter_changed = false;
+        updateAccelPrefilter(samples);
+    }
+    biquad_bank_apply(&accel_prefilter, samples);
     accelSensorData.x = samples[0];
     accelSensorData.y = samples[1];
     accelSensorData.z = samples[2];
@@ -433,11 +510,18 @@ static void handleGyro(float *samples, float temperature)
                            samples[2] * agcal.gyro_scale.Z - agcal.gyro_bias.Z - gyro_temp_bias[2] };
 
     rot_mult(R, gyros_out, samples);
+    if (gyro_prefilter_changed) {
+        gyro_prefilter_changed = false;
+        updateGyroPrefilter(samples);
+    }
+    biquad_bank_apply(&gyro_prefilter, samples);
     gyroSensorData.temperature = temperature;
     gyroSensorData.x = samples[0];
     gyroSensorData.y = samples[1];
     gyroSensorData.z = samples[2];
 
+    // stabilization gets the sample first, the attitude filters still read it from GyroSensor
+    fastloop_gyro(samples);
     GyroSensorSet(&gyroSensorData);
 }
 
@@ -590,6 +674,49 @@ static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *objEv)
     RevoSettingsBaroTempCorrectionExtentGet(&baroCorrectionExtent);
     baro_temp_correction_enabled = !(baroCorrectionExtent.max - baroCorrectionExtent.min < 0.1f ||
                                      (baroCorrection.a < 1e-9f && baroCorrection.b < 1e-9f && baroCorrection.c < 1e-9f && baroCorrection.d < 1e-9f));
+
+    gyro_prefilter_changed  = true;
+    accel_prefilter_changed = true;
+}
+
+/**
+ * Rebuild the gyro prefilter from RevoSettings, starting at the current sample
+ */
+static void updateGyroPrefilter(const float samples[3])
+{
+    struct biquad_coeffs coeffs;
+    RevoSettingsGyroNotchData notch;
+    float cutoff;
+
+    biquad_bank_clear(&gyro_prefilter);
+    RevoSettingsGyroNotchGet(&notch);
+    if (notch.Frequency > 0.0f && notch.Bandwidth > 0.0f) {
+        biquad_notch(&coeffs, MIN(notch.Frequency / PIOS_SENSOR_RATE, MAX_PREFILTER_RATIO), notch.Bandwidth / PIOS_SENSOR_RATE);
+        biquad_bank_add(&gyro_prefilter, &coeffs);
+    }
+    RevoSettingsGyroLowPassCutoffGet(&cutoff);
+    if (cutoff > 0.0f) {
+        biquad_lowpass(&coeffs, MIN(cutoff / PIOS_SENSOR_RATE, MAX_PREFILTER_RATIO));
+        biquad_bank_add(&gyro_prefilter, &coeffs);
+    }
+    biquad_bank_reset(&gyro_prefilter, samples);
+}
+
+/**
+ * Rebuild the accel prefilter from RevoSettings, starting at the current sample
+ */
+static void updateAccelPrefilter(const float samples[3])
+{
+    struct biquad_coeffs coeffs;
+    float cutoff;
+
+    biquad_bank_clear(&accel_prefilter);
+    RevoSettingsAccelLowPassCutoffGet(&cutoff);
+    if (cutoff > 0.0f) {
+        biquad_lowpass(&coeffs, MIN(cutoff / PIOS_SENSOR_RATE, MAX_PREFILTER_RATIO));
+        biquad_bank_add(&accel_prefilter, &coeffs);
+    }
+    biquad_bank_reset(&accel_prefilter, samples);
 }
 /**
  * @}
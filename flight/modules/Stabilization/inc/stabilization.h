@@ -61,6 +61,12 @@ typedef struct {
     struct pid innerPids[3], outerPids[3];
     // TPS [Roll,Pitch,Yaw][P,I,D]
     bool  thrust_pid_scaling_enabled[3][3];
+    bool  thrust_pid_scaling_used;
+    // ThrustPIDScaleCurve as lines y = slope * x + offset between its points
+    struct {
+        float slope[4];
+        float offset[4];
+    }     thrust_pid_scale_curve;
 } StabilizationData;
 
 
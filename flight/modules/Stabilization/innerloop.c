@@ -49,6 +49,10 @@
 #include <stabilization.h>
 #include <virtualflybar.h>
 #include <cruisecontrol.h>
+#include <fastloop.h>
+
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
 
 // Private constants
 
@@ -66,10 +70,20 @@ static float axis_lock_accum[3] = { 0, 0, 0 };
 static uint8_t previous_mode[AXES] = { 255, 255, 255, 255 };
 static PiOSDeltatimeConfig timeval;
 static float speedScaleFactor = 1.0f;
+// updated by their object callbacks, which run in the same critical priority
+// task as this loop, so the loop reads them without locking the objects
+static StabilizationStatusInnerLoopData innerLoopMode;
+static FlightStatusControlChainData controlChain;
+static uint8_t armed;
+PERF_DEFINE_COUNTER(counterLatency);
+PERF_DEFINE_COUNTER(counterPeriod);
 
 // Private functions
 static void stabilizationInnerloopTask();
 static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
+static void gyroUpdated(float gyro[3]);
+static void StabilizationStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
+static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
 #ifdef REVOLUTION
 static void AirSpeedUpdatedCb(__attribute__((unused)) UAVObjEvent *ev);
 #endif
@@ -92,12 +106,20 @@ void stabilizationInnerloopInit()
 
     callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&stabilizationInnerloopTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION1, STACK_SIZE_BYTES);
     GyroStateConnectCallback(GyroStateUpdatedCb);
+    StabilizationStatusConnectCallback(StabilizationStatusUpdatedCb);
+    FlightStatusConnectCallback(FlightStatusUpdatedCb);
+    StabilizationStatusUpdatedCb(NULL);
+    FlightStatusUpdatedCb(NULL);
+    fastloop_register(FASTLOOP_STAGE_CONTROL, &gyroUpdated);
+    // from the gyro sample fed to the fast loop, or to GyroState, to the actuator command
+    PERF_INIT_COUNTER(counterLatency, 0x5A000001);
+    PERF_INIT_COUNTER(counterPeriod, 0x5A000002);
 
     // schedule dead calls every FAILSAFE_TIMEOUT_MS to have the watchdog cleared
     PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, FAILSAFE_TIMEOUT_MS, CALLBACK_UPDATEMODE_LATER);
 }
 
-static float get_pid_scale_source_value()
+static float get_pid_scale_source_value(const ActuatorDesiredData *actuator)
 {
     float value;
 
@@ -109,10 +131,8 @@ static float get_pid_scale_source_value()
         StabilizationDesiredThrustGet(&value);
         break;
     case STABILIZATIONBANK_THRUSTPIDSCALESOURCE_ACTUATORDESIREDTHRUST:
-        ActuatorDesiredThrustGet(&value);
-        break;
     default:
-        ActuatorDesiredThrustGet(&value);
+        value = actuator->Thrust;
         break;
     }
 
@@ -123,50 +143,38 @@ static float get_pid_scale_source_value()
     return value;
 }
 
-typedef struct pid_curve_scaler {
-    float  x;
-    pointf points[5];
-} pid_curve_scaler;
-
-static float pid_curve_value(const pid_curve_scaler *scaler)
+/**
+ * Thrust PID scale factor, evaluated once per iteration and shared by all axes
+ */
+static float pid_curve_value(const ActuatorDesiredData *actuator)
 {
-    float y = y_on_curve(scaler->x, scaler->points, sizeof(scaler->points) / sizeof(scaler->points[0]));
+    const float x = get_pid_scale_source_value(actuator);
+
+    if (!IS_REAL(x)) {
+        return 1.0f;
+    }
+    // same segment choice as y_on_curve(), the outer lines extend past the ends
+    const int i = x < 0.75f ? (int)(x * 4.0f) : 3;
+    float y = stabSettings.thrust_pid_scale_curve.slope[i] * x + stabSettings.thrust_pid_scale_curve.offset[i];
 
     return 1.0f + (IS_REAL(y) ? y : 0.0f);
 }
 
-static pid_scaler create_pid_scaler(int axis)
+static pid_scaler create_pid_scaler(int axis, float curve_value)
 {
     pid_scaler scaler;
 
     // Always scaled with the this.
     scaler.p = scaler.i = scaler.d = speedScaleFactor;
 
-    if (stabSettings.thrust_pid_scaling_enabled[axis][0]
-        || stabSettings.thrust_pid_scaling_enabled[axis][1]
-        || stabSettings.thrust_pid_scaling_enabled[axis][2]) {
-        const pid_curve_scaler curve_scaler = {
-            .x      = get_pid_scale_source_value(),
-            .points = {
-                { 0.00f, stabSettings.stabBank.ThrustPIDScaleCurve[0] },
-                { 0.25f, stabSettings.stabBank.ThrustPIDScaleCurve[1] },
-                { 0.50f, stabSettings.stabBank.ThrustPIDScaleCurve[2] },
-                { 0.75f, stabSettings.stabBank.ThrustPIDScaleCurve[3] },
-                { 1.00f, stabSettings.stabBank.ThrustPIDScaleCurve[4] }
-            }
-        };
-
-        float curve_value = pid_curve_value(&curve_scaler);
-
-        if (stabSettings.thrust_pid_scaling_enabled[axis][0]) {
-            scaler.p *= curve_value;
-        }
-        if (stabSettings.thrust_pid_scaling_enabled[axis][1]) {
-            scaler.i *= curve_value;
-        }
-        if (stabSettings.thrust_pid_scaling_enabled[axis][2]) {
-            scaler.d *= curve_value;
-        }
+    if (stabSettings.thrust_pid_scaling_enabled[axis][0]) {
+        scaler.p *= curve_value;
+    }
+    if (stabSettings.thrust_pid_scaling_enabled[axis][1]) {
+        scaler.i *= curve_value;
+    }
+    if (stabSettings.thrust_pid_scaling_enabled[axis][2]) {
+        scaler.d *= curve_value;
     }
 
     return scaler;
@@ -228,18 +236,16 @@ static void stabilizationInnerloopTask()
 
     RateDesiredData rateDesired;
     ActuatorDesiredData actuator;
-    StabilizationStatusInnerLoopData enabled;
-    FlightStatusControlChainData cchain;
+    const StabilizationStatusInnerLoopData enabled = innerLoopMode;
 
-    RateDesiredGet(&rateDesired);
-    ActuatorDesiredGet(&actuator);
-    StabilizationStatusInnerLoopGet(&enabled);
-    FlightStatusControlChainGet(&cchain);
+    RateDesiredGetLockless(&rateDesired);
+    ActuatorDesiredGetLockless(&actuator);
     float *rate = &rateDesired.Roll;
     float *actuatorDesiredAxis = &actuator.Roll;
     int t;
     float dT;
     dT = PIOS_DELTATIME_GetAverageSeconds(&timeval);
+    const float curve_value = stabSettings.thrust_pid_scaling_used ? pid_curve_value(&actuator) : 1.0f;
 
     for (t = 0; t < AXES; t++) {
         bool reinit = (StabilizationStatusInnerLoopToArray(enabled)[t] != previous_mode[t]);
@@ -271,7 +277,7 @@ static void stabilizationInnerloopTask()
                                  -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
                                  StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
                                  );
-                pid_scaler scaler = create_pid_scaler(t);
+                pid_scaler scaler = create_pid_scaler(t, curve_value);
                 actuatorDesiredAxis[t] = pid_apply_setpoint(&stabSettings.innerPids[t], &scaler, rate[t], gyro_filtered[t], dT);
                 break;
             case STABILIZATIONSTATUS_INNERLOOP_ACRO:
@@ -284,7 +290,7 @@ static void stabilizationInnerloopTask()
                                  -StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t],
                                  StabilizationBankMaximumRateToArray(stabSettings.stabBank.MaximumRate)[t]
                                  );
-                pid_scaler ascaler = create_pid_scaler(t);
+                pid_scaler ascaler = create_pid_scaler(t, curve_value);
                 ascaler.i *= boundf(1.0f - (1.5f * fabsf(stickinput[t])), 0.0f, 1.0f); // this prevents Integral from getting too high while controlled manually
                 float arate  = pid_apply_setpoint(&stabSettings.innerPids[t], &ascaler, rate[t], gyro_filtered[t], dT);
                 float factor = fabsf(stickinput[t]) * stabSettings.stabBank.AcroInsanityFactor;
@@ -313,8 +319,10 @@ static void stabilizationInnerloopTask()
 
     actuator.UpdateTime = dT * 1000;
 
-    if (cchain.Stabilization == FLIGHTSTATUS_CONTROLCHAIN_TRUE) {
+    if (controlChain.Stabilization == FLIGHTSTATUS_CONTROLCHAIN_TRUE) {
         ActuatorDesiredSet(&actuator);
+        PERF_TRACK_VALUE(counterLatency, PIOS_DELAY_DiffuS(fastloop_sample_time()));
+        PERF_MEASURE_PERIOD(counterPeriod);
     } else {
         // Force all axes to reinitialize when engaged
         for (t = 0; t < AXES; t++) {
@@ -334,12 +342,13 @@ static void stabilizationInnerloopTask()
     }
 
     {
-        uint8_t armed;
-        FlightStatusArmedGet(&armed);
-        float throttleDesired;
-        ManualControlCommandThrottleGet(&throttleDesired);
-        if (armed != FLIGHTSTATUS_ARMED_ARMED ||
-            ((stabSettings.settings.LowThrottleZeroIntegral == STABILIZATIONSETTINGS_LOWTHROTTLEZEROINTEGRAL_TRUE) && throttleDesired < 0)) {
+        bool reset = (armed != FLIGHTSTATUS_ARMED_ARMED);
+        if (!reset && stabSettings.settings.LowThrottleZeroIntegral == STABILIZATIONSETTINGS_LOWTHROTTLEZEROINTEGRAL_TRUE) {
+            float throttleDesired;
+            ManualControlCommandThrottleGet(&throttleDesired);
+            reset = throttleDesired < 0;
+        }
+        if (reset) {
             // Force all axes to reinitialize when engaged
             for (t = 0; t < AXES; t++) {
                 previous_mode[t] = 255;
@@ -354,16 +363,38 @@ static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     GyroStateData gyroState;
 
-    GyroStateGet(&gyroState);
+    // the fast loop calls gyroUpdated() for every sample and publishes GyroState decimated
+    if (fastloop_active()) {
+        return;
+    }
+    GyroStateGetLockless(&gyroState);
+    gyroUpdated(&gyroState.x);
+}
 
-    gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyroState.x * (1 - stabSettings.gyro_alpha);
-    gyro_filtered[1] = gyro_filtered[1] * stabSettings.gyro_alpha + gyroState.y * (1 - stabSettings.gyro_alpha);
-    gyro_filtered[2] = gyro_filtered[2] * stabSettings.gyro_alpha + gyroState.z * (1 - stabSettings.gyro_alpha);
+/**
+ * New gyro rates, from GyroState or straight from the fast loop
+ */
+static void gyroUpdated(float gyro[3])
+{
+    gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyro[0] * (1 - stabSettings.gyro_alpha);
+    gyro_filtered[1] = gyro_filtered[1] * stabSettings.gyro_alpha + gyro[1] * (1 - stabSettings.gyro_alpha);
+    gyro_filtered[2] = gyro_filtered[2] * stabSettings.gyro_alpha + gyro[2] * (1 - stabSettings.gyro_alpha);
 
     PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
     stabSettings.monitor.gyroupdates++;
 }
 
+static void StabilizationStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    StabilizationStatusInnerLoopGet(&innerLoopMode);
+}
+
+static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    FlightStatusControlChainGet(&controlChain);
+    FlightStatusArmedGet(&armed);
+}
+
 #ifdef REVOLUTION
 static void AirSpeedUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
@@ -96,9 +96,9 @@ static void stabilizationOuterloopTask()
     StabilizationDesiredData stabilizationDesired;
     StabilizationStatusOuterLoopData enabled;
 
-    AttitudeStateGet(&attitudeState);
-    StabilizationDesiredGet(&stabilizationDesired);
-    RateDesiredGet(&rateDesired);
+    AttitudeStateGetLockless(&attitudeState);
+    StabilizationDesiredGetLockless(&stabilizationDesired);
+    RateDesiredGetLockless(&rateDesired);
     StabilizationStatusOuterLoopGet(&enabled);
     float *stabilizationDesiredAxis = &stabilizationDesired.Roll;
     float *rateDesiredAxis = &rateDesired.Roll;
@@ -290,7 +290,7 @@ static void AttitudeStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 
     if ((cpusaver++ % OUTERLOOP_SKIPCOUNT) == 0) {
         // this does not need mutex protection as both eventdispatcher and stabi run in same callback task!
-        AttitudeStateGet(&attitude);
+        AttitudeStateGetLockless(&attitude);
         PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
     }
 }
@@ -49,6 +49,7 @@
 #include <innerloop.h>
 #include <outerloop.h>
 #include <altitudeloop.h>
+#include <fastloop.h>
 
 
 // Public variables
@@ -330,13 +331,24 @@ static void BankUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
         use_tps_for_i(),
         use_tps_for_d()
     };
+    stabSettings.thrust_pid_scaling_used = false;
     for (int axis = 0; axis < 3; axis++) {
         for (int pid = 0; pid < 3; pid++) {
             stabSettings.thrust_pid_scaling_enabled[axis][pid] = stabSettings.stabBank.EnableThrustPIDScaling
                                                                  && tps_for_axis[axis]
                                                                  && tps_for_pid[pid];
+            stabSettings.thrust_pid_scaling_used |= stabSettings.thrust_pid_scaling_enabled[axis][pid];
         }
     }
+
+    // the curve points are 0.25 apart on the thrust axis
+    for (int i = 0; i < 4; i++) {
+        const float y0    = stabSettings.stabBank.ThrustPIDScaleCurve[i];
+        const float y1    = stabSettings.stabBank.ThrustPIDScaleCurve[i + 1];
+        const float slope = (y1 - y0) * 4.0f;
+        stabSettings.thrust_pid_scale_curve.slope[i]  = slope;
+        stabSettings.thrust_pid_scale_curve.offset[i] = y0 - slope * (0.25f * i);
+    }
 }
 
 
@@ -360,6 +372,8 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
         stabSettings.gyro_alpha = expf(-fakeDt / stabSettings.settings.GyroTau);
     }
 
+    fastloop_configure(stabSettings.settings.FastLoop == STABILIZATIONSETTINGS_FASTLOOP_TRUE, stabSettings.settings.FastLoopPublishDivider);
+
     // force flight mode update
     cur_flight_mode = -1;
 
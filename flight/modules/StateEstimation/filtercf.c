@@ -42,6 +42,7 @@
 #include <revocalibration.h>
 
 #include <CoordinateConversions.h>
+#include <complementaryfilter.h>
 #include <pios_notify.h>
 // Private constants
 
@@ -54,18 +55,18 @@
 struct data {
     AttitudeSettingsData attitudeSettings;
     HomeLocationData     homeLocation;
+    struct cf_state      cf;
+    struct cf_gains      gains;
     bool    first_run;
     bool    useMag;
     float   currentAccel[3];
     float   currentMag[3];
-    float   accels_filtered[3];
-    float   grot_filtered[3];
-    float   gyroBias[3];
+    // unit length HomeLocation.Be, valid when Be is long enough to be trusted
+    float   Be[3];
+    bool    BeValid;
     bool    accelUpdated;
     bool    magUpdated;
     float   accel_alpha;
-    bool    accel_filter_enabled;
-    float   rollPitchBiasRate;
     int32_t timeval;
     int32_t starttime;
     uint8_t init;
@@ -83,6 +84,8 @@ static int32_t initwithoutmag(stateFilter *self);
 static int32_t maininit(stateFilter *self);
 static filterResult filter(stateFilter *self, stateEstimation *state);
 static filterResult complementaryFilter(struct data *this, float gyro[3], float accel[3], float mag[3], float attitude[4]);
+static void loadGains(struct data *this);
+static void calibrationGains(struct data *this);
 
 static void flightStatusUpdatedCb(UAVObjEvent *ev);
 
@@ -148,20 +151,55 @@ static int32_t maininit(stateFilter *self)
     const float fakeDt = 0.0025f;
     if (this->attitudeSettings.AccelTau < 0.0001f) {
         this->accel_alpha = 0; // not trusting this to resolve to 0
-        this->accel_filter_enabled = false;
     } else {
         this->accel_alpha = expf(-fakeDt / this->attitudeSettings.AccelTau);
-        this->accel_filter_enabled = true;
+    }
+    loadGains(this);
+
+    float bmag = VectorMagnitude(this->homeLocation.Be);
+    this->BeValid = (bmag >= 1.0f);
+    if (this->BeValid) {
+        this->Be[0] = this->homeLocation.Be[0] / bmag;
+        this->Be[1] = this->homeLocation.Be[1] / bmag;
+        this->Be[2] = this->homeLocation.Be[2] / bmag;
     }
 
     // reset gyro Bias
-    this->gyroBias[0] = 0.0f;
-    this->gyroBias[1] = 0.0f;
-    this->gyroBias[2] = 0.0f;
+    this->cf.gyroBias[0] = 0.0f;
+    this->cf.gyroBias[1] = 0.0f;
+    this->cf.gyroBias[2] = 0.0f;
 
     return 0;
 }
 
+/**
+ * Gains for normal operation, from the AttitudeSettings
+ */
+static void loadGains(struct data *this)
+{
+    this->gains.accelKp           = this->attitudeSettings.AccelKp;
+    this->gains.accelKi           = this->attitudeSettings.AccelKi;
+    this->gains.magKp             = this->attitudeSettings.MagKp;
+    this->gains.magKi             = this->attitudeSettings.MagKi;
+    this->gains.rollPitchBiasRate = 0.0f;
+    this->gains.accelAlpha        = this->accel_alpha;
+    this->gains.accelBeta         = 1.0f - this->accel_alpha;
+    this->gains.accelFilter       = (this->accel_alpha > 0.0f);
+}
+
+/**
+ * Gains while the gyro bias is estimated from the accels
+ */
+static void calibrationGains(struct data *this)
+{
+    this->gains.accelKp           = 1.0f;
+    this->gains.accelKi           = 0.0f;
+    this->gains.magKp             = this->magCalibrated ? 1.0f : 0.0f;
+    this->gains.magKi             = this->attitudeSettings.MagKi;
+    this->gains.rollPitchBiasRate = 0.01f;
+    this->gains.accelFilter       = false;
+}
+
 /**
  * Collect all required state variables, then run complementary filter
  */
@@ -202,19 +240,6 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 }
 
 
-static inline void apply_accel_filter(const struct data *this, const float *raw, float *filtered)
-{
-    if (this->accel_filter_enabled) {
-        filtered[0] = filtered[0] * this->accel_alpha + raw[0] * (1 - this->accel_alpha);
-        filtered[1] = filtered[1] * this->accel_alpha + raw[1] * (1 - this->accel_alpha);
-        filtered[2] = filtered[2] * this->accel_alpha + raw[2] * (1 - this->accel_alpha);
-    } else {
-        filtered[0] = raw[0];
-        filtered[1] = raw[1];
-        filtered[2] = raw[2];
-    }
-}
-
 static filterResult complementaryFilter(struct data *this, float gyro[3], float accel[3], float mag[3], float attitude[4])
 {
     float dT;
@@ -241,8 +266,7 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
             mag[2] = 0.0f;
         }
 
-        AttitudeStateData attitudeState; // base on previous state
-        AttitudeStateGet(&attitudeState);
+        AttitudeStateData attitudeState;
         this->init = 0;
 
         // Set initial attitude. Use accels to determine roll and pitch, rotate magnetic measurement accordingly,
@@ -268,15 +292,16 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
         attitudeState.Pitch = RAD2DEG(attitudeState.Pitch);
         attitudeState.Yaw   = RAD2DEG(attitudeState.Yaw);
 
-        RPY2Quaternion(&attitudeState.Roll, attitude);
+        RPY2Quaternion(&attitudeState.Roll, this->cf.q);
+        quat_copy(this->cf.q, attitude);
 
         this->first_run = 0;
-        this->accels_filtered[0] = 0.0f;
-        this->accels_filtered[1] = 0.0f;
-        this->accels_filtered[2] = 0.0f;
-        this->grot_filtered[0]   = 0.0f;
-        this->grot_filtered[1]   = 0.0f;
-        this->grot_filtered[2]   = 0.0f;
+        this->cf.accelsFiltered[0] = 0.0f;
+        this->cf.accelsFiltered[1] = 0.0f;
+        this->cf.accelsFiltered[2] = 0.0f;
+        this->cf.grotFiltered[0]   = 0.0f;
+        this->cf.grotFiltered[1]   = 0.0f;
+        this->cf.grotFiltered[2]   = 0.0f;
         this->timeval   = PIOS_DELAY_GetRaw(); // Cycle counter used for precise timing
         this->starttime = xTaskGetTickCount(); // Tick counter used for long time intervals
 
@@ -289,29 +314,16 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
         return FILTERRESULT_ERROR;
     } else if (this->init == 0 && xTaskGetTickCount() - this->starttime < (CALIBRATION_DELAY_MS + CALIBRATION_DURATION_MS) / portTICK_RATE_MS) {
         // For first 6 seconds use accels to get gyro bias
-        this->attitudeSettings.AccelKp     = 1.0f;
-        this->attitudeSettings.AccelKi     = 0.0f;
-        this->attitudeSettings.YawBiasRate = 0.23f;
-        this->accel_filter_enabled   = false;
-        this->rollPitchBiasRate      = 0.01f;
-        this->attitudeSettings.MagKp = this->magCalibrated ? 1.0f : 0.0f;
+        calibrationGains(this);
         PIOS_NOTIFY_StartNotification(NOTIFY_DRAW_ATTENTION, NOTIFY_PRIORITY_REGULAR);
     } else if ((this->attitudeSettings.ZeroDuringArming == ATTITUDESETTINGS_ZERODURINGARMING_TRUE) && (flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMING)) {
-        this->attitudeSettings.AccelKp     = 1.0f;
-        this->attitudeSettings.AccelKi     = 0.0f;
-        this->attitudeSettings.YawBiasRate = 0.23f;
-        this->accel_filter_enabled   = false;
-        this->rollPitchBiasRate      = 0.01f;
-        this->attitudeSettings.MagKp = this->magCalibrated ? 1.0f : 0.0f;
+        calibrationGains(this);
         this->init = 0;
         PIOS_NOTIFY_StartNotification(NOTIFY_DRAW_ATTENTION, NOTIFY_PRIORITY_REGULAR);
     } else if (this->init == 0) {
         // Reload settings (all the rates)
         AttitudeSettingsGet(&this->attitudeSettings);
-        this->rollPitchBiasRate = 0.0f;
-        if (this->accel_alpha > 0.0f) {
-            this->accel_filter_enabled = true;
-        }
+        loadGains(this);
         this->init = 1;
     }
 
@@ -322,135 +334,20 @@ static filterResult complementaryFilter(struct data *this, float gyro[3], float
         dT = 0.001f;
     }
 
-    AttitudeStateData attitudeState; // base on previous state
-    AttitudeStateGet(&attitudeState);
-
-    // Get the current attitude estimate
-    quat_copy(&attitudeState.q1, attitude);
-
-    // Apply smoothing to accel values, to reduce vibration noise before main calculations.
-    apply_accel_filter(this, accel, this->accels_filtered);
-
-    // Rotate gravity to body frame and cross with accels
-    float grot[3];
-    grot[0] = -(2.0f * (attitude[1] * attitude[3] - attitude[0] * attitude[2]));
-    grot[1] = -(2.0f * (attitude[2] * attitude[3] + attitude[0] * attitude[1]));
-    grot[2] = -(attitude[0] * attitude[0] - attitude[1] * attitude[1] - attitude[2] * attitude[2] + attitude[3] * attitude[3]);
-
-    float accel_err[3];
-    apply_accel_filter(this, grot, this->grot_filtered);
-
-    CrossProduct((const float *)this->accels_filtered, (const float *)this->grot_filtered, accel_err);
-
-    // Account for accel magnitude
-    float accel_mag = sqrtf(this->accels_filtered[0] * this->accels_filtered[0] + this->accels_filtered[1] * this->accels_filtered[1] + this->accels_filtered[2] * this->accels_filtered[2]);
-    if (accel_mag < 1.0e-3f) {
+    switch (cf_update(&this->cf, &this->gains, gyro, accel,
+                      (this->magUpdated && this->useMag) ? mag : NULL,
+                      this->BeValid ? this->Be : NULL, dT)) {
+    case CF_RESULT_VECTOR_TOO_SHORT:
         return FILTERRESULT_CRITICAL; // safety feature copied from CC
-    }
 
-    // Account for filtered gravity vector magnitude
-    float grot_mag;
-    if (this->accel_filter_enabled) {
-        grot_mag = sqrtf(this->grot_filtered[0] * this->grot_filtered[0] + this->grot_filtered[1] * this->grot_filtered[1] + this->grot_filtered[2] * this->grot_filtered[2]);
-    } else {
-        grot_mag = 1.0f;
-    }
-    if (grot_mag < 1.0e-3f) {
-        return FILTERRESULT_CRITICAL;
-    }
-
-    accel_err[0] /= (accel_mag * grot_mag);
-    accel_err[1] /= (accel_mag * grot_mag);
-    accel_err[2] /= (accel_mag * grot_mag);
-
-    float mag_err[3] = { 0.0f };
-    if (this->magUpdated && this->useMag) {
-        // Rotate gravity to body frame and cross with accels
-        float brot[3];
-        float Rbe[3][3];
-
-        Quaternion2R(attitude, Rbe);
-
-        rot_mult(Rbe, this->homeLocation.Be, brot);
-
-        float mag_len = sqrtf(mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2]);
-        mag[0]  /= mag_len;
-        mag[1]  /= mag_len;
-        mag[2]  /= mag_len;
-
-        float bmag = sqrtf(brot[0] * brot[0] + brot[1] * brot[1] + brot[2] * brot[2]);
-        brot[0] /= bmag;
-        brot[1] /= bmag;
-        brot[2] /= bmag;
-
-        // Only compute if neither vector is null
-        if (bmag < 1.0f || mag_len < 1.0f) {
-            mag_err[0] = mag_err[1] = mag_err[2] = 0.0f;
-        } else {
-            CrossProduct((const float *)mag, (const float *)brot, mag_err);
-        }
-    } else {
-        mag_err[0] = mag_err[1] = mag_err[2] = 0.0f;
-    }
-
-    // Correct rates based on integral coefficient
-    gyro[0] -= this->gyroBias[0];
-    gyro[1] -= this->gyroBias[1];
-    gyro[2] -= this->gyroBias[2];
-
-    // Accumulate integral of error.  Scale here so that units are (deg/s) but Ki has units of s
-    this->gyroBias[0] -= accel_err[0] * this->attitudeSettings.AccelKi - gyro[0] * this->rollPitchBiasRate;
-    this->gyroBias[1] -= accel_err[1] * this->attitudeSettings.AccelKi - gyro[1] * this->rollPitchBiasRate;
-    if (this->useMag) {
-        this->gyroBias[2] -= -mag_err[2] * this->attitudeSettings.MagKi - gyro[2] * this->rollPitchBiasRate;
-    } else {
-        this->gyroBias[2] -= -gyro[2] * this->rollPitchBiasRate;
-    }
-
-    float gyrotmp[3] = { gyro[0], gyro[1], gyro[2] };
-    // Correct rates based on proportional coefficient
-    gyrotmp[0] += accel_err[0] * this->attitudeSettings.AccelKp / dT;
-    gyrotmp[1] += accel_err[1] * this->attitudeSettings.AccelKp / dT;
-    if (this->useMag) {
-        gyrotmp[2] += accel_err[2] * this->attitudeSettings.AccelKp / dT + mag_err[2] * this->attitudeSettings.MagKp / dT;
-    } else {
-        gyrotmp[2] += accel_err[2] * this->attitudeSettings.AccelKp / dT;
-    }
-
-    // Work out time derivative from INSAlgo writeup
-    // Also accounts for the fact that gyros are in deg/s
-    float qdot[4];
-    qdot[0]     = DEG2RAD(-attitude[1] * gyrotmp[0] - attitude[2] * gyrotmp[1] - attitude[3] * gyrotmp[2]) * dT / 2;
-    qdot[1]     = DEG2RAD(attitude[0] * gyrotmp[0] - attitude[3] * gyrotmp[1] + attitude[2] * gyrotmp[2]) * dT / 2;
-    qdot[2]     = DEG2RAD(attitude[3] * gyrotmp[0] + attitude[0] * gyrotmp[1] - attitude[1] * gyrotmp[2]) * dT / 2;
-    qdot[3]     = DEG2RAD(-attitude[2] * gyrotmp[0] + attitude[1] * gyrotmp[1] + attitude[0] * gyrotmp[2]) * dT / 2;
-
-    // Take a time step
-    attitude[0] = attitude[0] + qdot[0];
-    attitude[1] = attitude[1] + qdot[1];
-    attitude[2] = attitude[2] + qdot[2];
-    attitude[3] = attitude[3] + qdot[3];
-
-    if (attitude[0] < 0.0f) {
-        attitude[0] = -attitude[0];
-        attitude[1] = -attitude[1];
-        attitude[2] = -attitude[2];
-        attitude[3] = -attitude[3];
-    }
-
-    // Renomalize
-    float qmag = sqrtf(attitude[0] * attitude[0] + attitude[1] * attitude[1] + attitude[2] * attitude[2] + attitude[3] * attitude[3]);
-    attitude[0] = attitude[0] / qmag;
-    attitude[1] = attitude[1] / qmag;
-    attitude[2] = attitude[2] / qmag;
-    attitude[3] = attitude[3] / qmag;
-
-    // If quaternion has become inappropriately short or is nan reinit.
-    // THIS SHOULD NEVER ACTUALLY HAPPEN
-    if ((fabsf(qmag) < 1.0e-3f) || isnan(qmag)) {
+    case CF_RESULT_QUATERNION_DEGENERATE:
         this->first_run = 1;
         return FILTERRESULT_WARNING;
+
+    default:
+        break;
     }
+    quat_copy(this->cf.q, attitude);
 
     if (this->init) {
         return FILTERRESULT_OK;
@@ -39,11 +39,13 @@
 #include <homelocation.h>
 
 #include <insgps.h>
+#include <insgps16state.h>
 #include <CoordinateConversions.h>
 
 // Private constants
 
-#define STACK_REQUIRED 2048
+#define STACK_REQUIRED   2048
+#define STACK_REQUIRED16 2560
 #define DT_ALPHA       1e-3f
 #define DT_MIN         1e-6f
 #define DT_MAX         1.0f
@@ -58,10 +60,75 @@
     }
 
 // Private types
+
+// The 13 and 16 state filters share one interface, each filter instance
+// picks one of them
+struct insgps {
+    void (*Init)();
+    void (*StatePrediction)(float gyro_data[3], float accel_data[3], float dT);
+    void (*CovariancePrediction)(float dT);
+    void (*Correction)(float mag_data[3], float Pos[3], float Vel[3], float BaroAlt, uint16_t SensorsUsed);
+    void (*ResetP)(float *PDiag);
+    void (*GetP)(float *PDiag);
+    void (*SetState)(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3]);
+    void (*SetPosVelVar)(float PosVar[3], float VelVar[3]);
+    void (*SetGyroBias)(float gyro_bias[3]);
+    void (*SetAccelVar)(float accel_var[3]);
+    void (*SetGyroVar)(float gyro_var[3]);
+    void (*SetGyroBiasVar)(float gyro_bias_var[3]);
+    void (*SetMagNorth)(float B[3]);
+    void (*SetMagVar)(float scaled_mag_var[3]);
+    void (*SetBaroVar)(float baro_var);
+    struct NavStruct *nav;
+    uint8_t numStates;
+};
+
+static const struct insgps ins13 = {
+    .Init                 = &INSGPSInit,
+    .StatePrediction      = &INSStatePrediction,
+    .CovariancePrediction = &INSCovariancePrediction,
+    .Correction           = &INSCorrection,
+    .ResetP               = &INSResetP,
+    .GetP                 = &INSGetP,
+    .SetState             = &INSSetState,
+    .SetPosVelVar         = &INSSetPosVelVar,
+    .SetGyroBias          = &INSSetGyroBias,
+    .SetAccelVar          = &INSSetAccelVar,
+    .SetGyroVar           = &INSSetGyroVar,
+    .SetGyroBiasVar       = &INSSetGyroBiasVar,
+    .SetMagNorth          = &INSSetMagNorth,
+    .SetMagVar            = &INSSetMagVar,
+    .SetBaroVar           = &INSSetBaroVar,
+    .nav                  = &Nav,
+    .numStates            = 13,
+};
+
+static const struct insgps ins16 = {
+    .Init                 = &INS16GPSInit,
+    .StatePrediction      = &INS16StatePrediction,
+    .CovariancePrediction = &INS16CovariancePrediction,
+    .Correction           = &INS16Correction,
+    .ResetP               = &INS16ResetP,
+    .GetP                 = &INS16GetP,
+    .SetState             = &INS16SetState,
+    .SetPosVelVar         = &INS16SetPosVelVar,
+    .SetGyroBias          = &INS16SetGyroBias,
+    .SetAccelVar          = &INS16SetAccelVar,
+    .SetGyroVar           = &INS16SetGyroVar,
+    .SetGyroBiasVar       = &INS16SetGyroBiasVar,
+    .SetMagNorth          = &INS16SetMagNorth,
+    .SetMagVar            = &INS16SetMagVar,
+    .SetBaroVar           = &INS16SetBaroVar,
+    .nav                  = &Nav16,
+    .numStates            = 16,
+};
+
 struct data {
     EKFConfigurationData ekfConfiguration;
     HomeLocationData     homeLocation;
 
+    const struct insgps  *ins;
+
     bool    usePos;
 
     int32_t init_stage;
@@ -81,8 +148,11 @@ static bool initialized = 0;
 
 static int32_t init13i(stateFilter *self);
 static int32_t init13(stateFilter *self);
+static int32_t init16i(stateFilter *self);
+static int32_t init16(stateFilter *self);
 static int32_t maininit(stateFilter *self);
 static filterResult filter(stateFilter *self, stateEstimation *state);
+static void resetP(struct data *this);
 static inline bool invalid_var(float data);
 
 static void globalInit(void);
@@ -114,24 +184,21 @@ int32_t filterEKF13Initialize(stateFilter *handle)
     handle->localdata = pios_malloc(sizeof(struct data));
     return STACK_REQUIRED;
 }
-// XXX
-// TODO: Until the 16 state EKF is implemented, run 13 state, so compilation runs through
-// XXX
 int32_t filterEKF16iInitialize(stateFilter *handle)
 {
     globalInit();
-    handle->init      = &init13i;
+    handle->init      = &init16i;
     handle->filter    = &filter;
     handle->localdata = pios_malloc(sizeof(struct data));
-    return STACK_REQUIRED;
+    return STACK_REQUIRED16;
 }
 int32_t filterEKF16Initialize(stateFilter *handle)
 {
     globalInit();
-    handle->init      = &init13;
+    handle->init      = &init16;
     handle->filter    = &filter;
     handle->localdata = pios_malloc(sizeof(struct data));
-    return STACK_REQUIRED;
+    return STACK_REQUIRED16;
 }
 
 
@@ -139,6 +206,7 @@ static int32_t init13i(stateFilter *self)
 {
     struct data *this = (struct data *)self->localdata;
 
+    this->ins    = &ins13;
     this->usePos = 0;
     return maininit(self);
 }
@@ -147,6 +215,25 @@ static int32_t init13(stateFilter *self)
 {
     struct data *this = (struct data *)self->localdata;
 
+    this->ins    = &ins13;
+    this->usePos = 1;
+    return maininit(self);
+}
+
+static int32_t init16i(stateFilter *self)
+{
+    struct data *this = (struct data *)self->localdata;
+
+    this->ins    = &ins16;
+    this->usePos = 0;
+    return maininit(self);
+}
+
+static int32_t init16(stateFilter *self)
+{
+    struct data *this = (struct data *)self->localdata;
+
+    this->ins    = &ins16;
     this->usePos = 1;
     return maininit(self);
 }
@@ -178,6 +265,13 @@ static int32_t maininit(stateFilter *self)
             return 2;
         }
     }
+    if (this->ins->numStates > EKFCONFIGURATION_P_NUMELEM) {
+        for (t = 0; t < EKFCONFIGURATION_ACCELDRIFT_NUMELEM; t++) {
+            if (invalid_var(EKFConfigurationAccelDriftToArray(this->ekfConfiguration.AccelDrift)[t])) {
+                return 2;
+            }
+        }
+    }
     HomeLocationGet(&this->homeLocation);
     // Don't require HomeLocation.Set to be true but at least require a mag configuration (allows easily
     // switching between indoor and outdoor mode with Set = false)
@@ -194,7 +288,8 @@ static int32_t maininit(stateFilter *self)
  */
 static filterResult filter(stateFilter *self, stateEstimation *state)
 {
-    struct data *this    = (struct data *)self->localdata;
+    struct data *this     = (struct data *)self->localdata;
+    struct NavStruct *nav = this->ins->nav;
 
     const float zeros[3] = { 0.0f, 0.0f, 0.0f };
 
@@ -239,30 +334,34 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         // Don't initialize until all sensors are read
         if (this->init_stage == 0) {
             // Reset the INS algorithm
-            INSGPSInit();
+            this->ins->Init();
             // variance is measured in mGaus, but internally the EKF works with a normalized  vector. Scale down by Be^2
             float Be2 = this->homeLocation.Be[0] * this->homeLocation.Be[0] + this->homeLocation.Be[1] * this->homeLocation.Be[1] + this->homeLocation.Be[2] * this->homeLocation.Be[2];
-            INSSetMagVar((float[3]) { this->ekfConfiguration.R.MagX / Be2,
-                                      this->ekfConfiguration.R.MagY / Be2,
-                                      this->ekfConfiguration.R.MagZ / Be2 }
-                         );
-            INSSetAccelVar((float[3]) { this->ekfConfiguration.Q.AccelX,
-                                        this->ekfConfiguration.Q.AccelY,
-                                        this->ekfConfiguration.Q.AccelZ }
-                           );
-            INSSetGyroVar((float[3]) { this->ekfConfiguration.Q.GyroX,
-                                       this->ekfConfiguration.Q.GyroY,
-                                       this->ekfConfiguration.Q.GyroZ }
-                          );
-            INSSetGyroBiasVar((float[3]) { this->ekfConfiguration.Q.GyroDriftX,
-                                           this->ekfConfiguration.Q.GyroDriftY,
-                                           this->ekfConfiguration.Q.GyroDriftZ }
-                              );
-            INSSetBaroVar(this->ekfConfiguration.R.BaroZ);
+            this->ins->SetMagVar((float[3]) { this->ekfConfiguration.R.MagX / Be2,
+                                              this->ekfConfiguration.R.MagY / Be2,
+                                              this->ekfConfiguration.R.MagZ / Be2 }
+                                 );
+            this->ins->SetAccelVar((float[3]) { this->ekfConfiguration.Q.AccelX,
+                                                this->ekfConfiguration.Q.AccelY,
+                                                this->ekfConfiguration.Q.AccelZ }
+                                   );
+            this->ins->SetGyroVar((float[3]) { this->ekfConfiguration.Q.GyroX,
+                                               this->ekfConfiguration.Q.GyroY,
+                                               this->ekfConfiguration.Q.GyroZ }
+                                  );
+            this->ins->SetGyroBiasVar((float[3]) { this->ekfConfiguration.Q.GyroDriftX,
+                                                   this->ekfConfiguration.Q.GyroDriftY,
+                                                   this->ekfConfiguration.Q.GyroDriftZ }
+                                      );
+            this->ins->SetBaroVar(this->ekfConfiguration.R.BaroZ);
+            if (this->ins == &ins16) {
+                float accelDriftQ = this->ekfConfiguration.AccelDrift.Q;
+                INS16SetAccelBiasVar((float[3]) { accelDriftQ, accelDriftQ, accelDriftQ });
+            }
 
             // Initialize the gyro bias
             float gyro_bias[3] = { 0.0f, 0.0f, 0.0f };
-            INSSetGyroBias(gyro_bias);
+            this->ins->SetGyroBias(gyro_bias);
 
             AttitudeStateData attitudeState;
             AttitudeStateGet(&attitudeState);
@@ -292,30 +391,30 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
             RPY2Quaternion(&attitudeState.Roll, this->work.attitude);
 
-            INSSetState(this->work.pos, (float *)zeros, this->work.attitude, (float *)zeros, (float *)zeros);
+            this->ins->SetState(this->work.pos, (float *)zeros, this->work.attitude, (float *)zeros, (float *)zeros);
 
-            INSResetP(EKFConfigurationPToArray(this->ekfConfiguration.P));
+            resetP(this);
         } else {
             // Run prediction a bit before any corrections
 
             float gyros[3] = { DEG2RAD(this->work.gyro[0]), DEG2RAD(this->work.gyro[1]), DEG2RAD(this->work.gyro[2]) };
-            INSStatePrediction(gyros, this->work.accel, dT);
+            this->ins->StatePrediction(gyros, this->work.accel, dT);
 
             // Copy the attitude into the state
             // NOTE: updating gyr correctly is valid, because this code is reached only when SENSORUPDATES_gyro is already true
-            state->attitude[0] = Nav.q[0];
-            state->attitude[1] = Nav.q[1];
-            state->attitude[2] = Nav.q[2];
-            state->attitude[3] = Nav.q[3];
-            state->gyro[0]    -= RAD2DEG(Nav.gyro_bias[0]);
-            state->gyro[1]    -= RAD2DEG(Nav.gyro_bias[1]);
-            state->gyro[2]    -= RAD2DEG(Nav.gyro_bias[2]);
-            state->pos[0]   = Nav.Pos[0];
-            state->pos[1]   = Nav.Pos[1];
-            state->pos[2]   = Nav.Pos[2];
-            state->vel[0]   = Nav.Vel[0];
-            state->vel[1]   = Nav.Vel[1];
-            state->vel[2]   = Nav.Vel[2];
+            state->attitude[0] = nav->q[0];
+            state->attitude[1] = nav->q[1];
+            state->attitude[2] = nav->q[2];
+            state->attitude[3] = nav->q[3];
+            state->gyro[0]    -= RAD2DEG(nav->gyro_bias[0]);
+            state->gyro[1]    -= RAD2DEG(nav->gyro_bias[1]);
+            state->gyro[2]    -= RAD2DEG(nav->gyro_bias[2]);
+            state->pos[0]   = nav->Pos[0];
+            state->pos[1]   = nav->Pos[1];
+            state->pos[2]   = nav->Pos[2];
+            state->vel[0]   = nav->Vel[0];
+            state->vel[1]   = nav->Vel[1];
+            state->vel[2]   = nav->Vel[2];
             state->updated |= SENSORUPDATES_attitude | SENSORUPDATES_pos | SENSORUPDATES_vel;
         }
 
@@ -334,27 +433,27 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     float gyros[3] = { DEG2RAD(this->work.gyro[0]), DEG2RAD(this->work.gyro[1]), DEG2RAD(this->work.gyro[2]) };
 
     // Advance the state estimate
-    INSStatePrediction(gyros, this->work.accel, dT);
+    this->ins->StatePrediction(gyros, this->work.accel, dT);
 
     // Copy the attitude into the state
     // NOTE: updating gyr correctly is valid, because this code is reached only when SENSORUPDATES_gyro is already true
-    state->attitude[0] = Nav.q[0];
-    state->attitude[1] = Nav.q[1];
-    state->attitude[2] = Nav.q[2];
-    state->attitude[3] = Nav.q[3];
-    state->gyro[0]    -= RAD2DEG(Nav.gyro_bias[0]);
-    state->gyro[1]    -= RAD2DEG(Nav.gyro_bias[1]);
-    state->gyro[2]    -= RAD2DEG(Nav.gyro_bias[2]);
-    state->pos[0]   = Nav.Pos[0];
-    state->pos[1]   = Nav.Pos[1];
-    state->pos[2]   = Nav.Pos[2];
-    state->vel[0]   = Nav.Vel[0];
-    state->vel[1]   = Nav.Vel[1];
-    state->vel[2]   = Nav.Vel[2];
+    state->attitude[0] = nav->q[0];
+    state->attitude[1] = nav->q[1];
+    state->attitude[2] = nav->q[2];
+    state->attitude[3] = nav->q[3];
+    state->gyro[0]    -= RAD2DEG(nav->gyro_bias[0]);
+    state->gyro[1]    -= RAD2DEG(nav->gyro_bias[1]);
+    state->gyro[2]    -= RAD2DEG(nav->gyro_bias[2]);
+    state->pos[0]   = nav->Pos[0];
+    state->pos[1]   = nav->Pos[1];
+    state->pos[2]   = nav->Pos[2];
+    state->vel[0]   = nav->Vel[0];
+    state->vel[1]   = nav->Vel[1];
+    state->vel[2]   = nav->Vel[2];
     state->updated |= SENSORUPDATES_attitude | SENSORUPDATES_pos | SENSORUPDATES_vel;
 
     // Advance the covariance estimate
-    INSCovariancePrediction(dT);
+    this->ins->CovariancePrediction(dT);
 
     if (IS_SET(this->work.updated, SENSORUPDATES_mag)) {
         sensors |= MAG_SENSORS;
@@ -364,26 +463,26 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
         sensors |= BARO_SENSOR;
     }
 
-    INSSetMagNorth(this->homeLocation.Be);
+    this->ins->SetMagNorth(this->homeLocation.Be);
 
     if (!this->usePos) {
         // position and velocity variance used in indoor mode
-        INSSetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
-                        (float[3]) { this->ekfConfiguration.FakeR.FakeGPSVelIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSVelIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSVelIndoor }
-                        );
+        this->ins->SetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                             this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                             this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
+                                (float[3]) { this->ekfConfiguration.FakeR.FakeGPSVelIndoor,
+                                             this->ekfConfiguration.FakeR.FakeGPSVelIndoor,
+                                             this->ekfConfiguration.FakeR.FakeGPSVelIndoor }
+                                );
     } else {
         // position and velocity variance used in outdoor mode
-        INSSetPosVelVar((float[3]) { this->ekfConfiguration.R.GPSPosNorth,
-                                     this->ekfConfiguration.R.GPSPosEast,
-                                     this->ekfConfiguration.R.GPSPosDown },
-                        (float[3]) { this->ekfConfiguration.R.GPSVelNorth,
-                                     this->ekfConfiguration.R.GPSVelEast,
-                                     this->ekfConfiguration.R.GPSVelDown }
-                        );
+        this->ins->SetPosVelVar((float[3]) { this->ekfConfiguration.R.GPSPosNorth,
+                                             this->ekfConfiguration.R.GPSPosEast,
+                                             this->ekfConfiguration.R.GPSPosDown },
+                                (float[3]) { this->ekfConfiguration.R.GPSVelNorth,
+                                             this->ekfConfiguration.R.GPSVelEast,
+                                             this->ekfConfiguration.R.GPSVelDown }
+                                );
     }
 
     if (IS_SET(this->work.updated, SENSORUPDATES_pos)) {
@@ -397,16 +496,16 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     if (IS_SET(this->work.updated, SENSORUPDATES_airspeed) && ((!IS_SET(this->work.updated, SENSORUPDATES_vel) && !IS_SET(this->work.updated, SENSORUPDATES_pos)) | !this->usePos)) {
         // HACK: feed airspeed into EKF as velocity, treat wind as 1e2 variance
         sensors |= HORIZ_SENSORS | VERT_SENSORS;
-        INSSetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
-                                     this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
-                        (float[3]) { this->ekfConfiguration.FakeR.FakeGPSVelAirspeed,
-                                     this->ekfConfiguration.FakeR.FakeGPSVelAirspeed,
-                                     this->ekfConfiguration.FakeR.FakeGPSVelAirspeed }
-                        );
+        this->ins->SetPosVelVar((float[3]) { this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                             this->ekfConfiguration.FakeR.FakeGPSPosIndoor,
+                                             this->ekfConfiguration.FakeR.FakeGPSPosIndoor },
+                                (float[3]) { this->ekfConfiguration.FakeR.FakeGPSVelAirspeed,
+                                             this->ekfConfiguration.FakeR.FakeGPSVelAirspeed,
+                                             this->ekfConfiguration.FakeR.FakeGPSVelAirspeed }
+                                );
         // rotate airspeed vector into NED frame - airspeed is measured in X axis only
         float R[3][3];
-        Quaternion2R(Nav.q, R);
+        Quaternion2R(nav->q, R);
         float vtas[3] = { this->work.airspeed[1], 0.0f, 0.0f };
         rot_mult(R, vtas, this->work.vel);
     }
@@ -416,17 +515,21 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
      * although probably should occur within INS itself
      */
     if (sensors) {
-        INSCorrection(this->work.mag, this->work.pos, this->work.vel, this->work.baro[0], sensors);
+        this->ins->Correction(this->work.mag, this->work.pos, this->work.vel, this->work.baro[0], sensors);
     }
 
     EKFStateVarianceData vardata;
-    EKFStateVarianceGet(&vardata);
-    INSGetP(EKFStateVariancePToArray(vardata.P));
-    EKFStateVarianceSet(&vardata);
+    float PDiag[16];
     int t;
+    this->ins->GetP(PDiag);
+    EKFStateVarianceGet(&vardata);
     for (t = 0; t < EKFSTATEVARIANCE_P_NUMELEM; t++) {
-        if (!IS_REAL(EKFStateVariancePToArray(vardata.P)[t]) || EKFStateVariancePToArray(vardata.P)[t] <= 0.0f) {
-            INSResetP(EKFConfigurationPToArray(this->ekfConfiguration.P));
+        EKFStateVariancePToArray(vardata.P)[t] = PDiag[t];
+    }
+    EKFStateVarianceSet(&vardata);
+    for (t = 0; t < this->ins->numStates; t++) {
+        if (!IS_REAL(PDiag[t]) || PDiag[t] <= 0.0f) {
+            resetP(this);
             this->init_stage = -1;
             break;
         }
@@ -442,6 +545,22 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     }
 }
 
+// reset the covariance to the configured initial variances, the accel bias
+// states of the 16 state filter start with AccelDrift.P
+static void resetP(struct data *this)
+{
+    float PDiag[16];
+    uint8_t t;
+
+    for (t = 0; t < EKFCONFIGURATION_P_NUMELEM; t++) {
+        PDiag[t] = EKFConfigurationPToArray(this->ekfConfiguration.P)[t];
+    }
+    for (; t < this->ins->numStates; t++) {
+        PDiag[t] = this->ekfConfiguration.AccelDrift.P;
+    }
+    this->ins->ResetP(PDiag);
+}
+
 // check for invalid variance values
 static inline bool invalid_var(float data)
 {
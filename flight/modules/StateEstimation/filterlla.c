@@ -44,8 +44,7 @@
 struct data {
     GPSSettingsData  settings;
     HomeLocationData home;
-    double HomeECEF[3];
-    float HomeRne[3][3];
+    LocalTangentPlane homeLTP;
 };
 
 // Private variables
@@ -80,8 +79,7 @@ static int32_t init(__attribute__((unused)) stateFilter *self)
             this->home.Longitude,
             (int32_t)(this->home.Altitude * 1e4f),
         };
-        LLA2ECEF(LLAi, this->HomeECEF);
-        RneFromLLA(LLAi, this->HomeRne);
+        LTPFromLLA(LLAi, &this->homeLTP);
     }
     return 0;
 }
@@ -97,21 +95,19 @@ static filterResult filter(__attribute__((unused)) stateFilter *self, stateEstim
 
     // only do stuff if we have a valid GPS update
     if (IS_SET(state->updated, SENSORUPDATES_lla)) {
-        // LLA information is not part of the state blob, due to its non standard layout (fixed point representation, quality of signal, ...)
+        // the fixed point position and fix quality are copied into the state blob as they are,
         // this filter deals with the gory details of interpreting it and storing it in a standard Cartesian position state
-        GPSPositionSensorData gpsdata;
-        GPSPositionSensorGet(&gpsdata);
 
         // check if we have a valid GPS signal (not checked by StateEstimation istelf)
-        if ((gpsdata.PDOP < this->settings.MaxPDOP) && (gpsdata.Satellites >= this->settings.MinSatellites) &&
-            (gpsdata.Status == GPSPOSITIONSENSOR_STATUS_FIX3D) &&
-            (gpsdata.Latitude != 0 || gpsdata.Longitude != 0)) {
+        if ((state->lla.PDOP < this->settings.MaxPDOP) && (state->lla.Satellites >= this->settings.MinSatellites) &&
+            (state->lla.Status == GPSPOSITIONSENSOR_STATUS_FIX3D) &&
+            (state->lla.Latitude != 0 || state->lla.Longitude != 0)) {
             int32_t LLAi[3] = {
-                gpsdata.Latitude,
-                gpsdata.Longitude,
-                (int32_t)((gpsdata.Altitude + gpsdata.GeoidSeparation) * 1e4f),
+                state->lla.Latitude,
+                state->lla.Longitude,
+                (int32_t)(state->lla.Altitude * 1e4f),
             };
-            LLA2Base(LLAi, this->HomeECEF, this->HomeRne, state->pos);
+            LLA2LTP(LLAi, &this->homeLTP, state->pos);
             state->updated |= SENSORUPDATES_pos;
         }
     }
@@ -31,7 +31,6 @@
  */
 
 #include "inc/stateestimation.h"
-#include <attitudestate.h>
 #include <revocalibration.h>
 #include <revosettings.h>
 #include <systemalarms.h>
@@ -39,6 +38,7 @@
 #include <auxmagsettings.h>
 #include <CoordinateConversions.h>
 #include <mathmisc.h>
+#include <magbias.h>
 
 // Private constants
 //
@@ -49,12 +49,15 @@ struct data {
     RevoCalibrationData revoCalibration;
     RevoSettingsData    revoSettings;
     AuxMagSettingsUsageOptions auxMagUsage;
+    float   auxMagBiasNullingRate;
     uint8_t warningcount;
     uint8_t errorcount;
     float   homeLocationBe[3];
     float   magBe;
     float   invMagBe;
-    float   magBias[3];
+    // hard iron estimation of each mag
+    struct magbias_fit boardMagBias;
+    struct magbias_fit auxMagBias;
 };
 
 // Private variables
@@ -64,7 +67,7 @@ struct data {
 static int32_t init(stateFilter *self);
 static filterResult filter(stateFilter *self, stateEstimation *state);
 static bool checkMagValidity(struct data *this, float error, bool setAlarms);
-static void magOffsetEstimation(struct data *this, float mag[3]);
+static void magOffsetEstimation(struct magbias_fit *fit, float mag[3]);
 static float getMagError(struct data *this, float mag[3]);
 
 int32_t filterMagInitialize(stateFilter *handle)
@@ -80,7 +83,6 @@ static int32_t init(stateFilter *self)
 {
     struct data *this = (struct data *)self->localdata;
 
-    this->magBias[0]   = this->magBias[1] = this->magBias[2] = 0.0f;
     this->warningcount = this->errorcount = 0;
     HomeLocationBeGet(this->homeLocationBe);
     // magBe holds the magnetic vector length (expected)
@@ -89,6 +91,9 @@ static int32_t init(stateFilter *self)
     RevoCalibrationGet(&this->revoCalibration);
     RevoSettingsGet(&this->revoSettings);
     AuxMagSettingsUsageGet(&this->auxMagUsage);
+    AuxMagSettingsMagBiasNullingRateGet(&this->auxMagBiasNullingRate);
+    magbias_init(&this->boardMagBias, this->magBe, this->revoCalibration.MagBiasNullingRate);
+    magbias_init(&this->auxMagBias, this->magBe, this->auxMagBiasNullingRate);
     return 0;
 }
 
@@ -104,6 +109,9 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
     // Uses the external mag when available
     if ((this->auxMagUsage != AUXMAGSETTINGS_USAGE_ONBOARDONLY) &&
         IS_SET(state->updated, SENSORUPDATES_auxMag)) {
+        if (this->auxMagBiasNullingRate > 0) {
+            magOffsetEstimation(&this->auxMagBias, state->auxMag);
+        }
         auxMagError = getMagError(this, state->auxMag);
         // Handles alarms only if it will rely on aux mag only
         bool auxMagValid = checkMagValidity(this, auxMagError, (this->auxMagUsage == AUXMAGSETTINGS_USAGE_AUXONLY));
@@ -119,9 +127,8 @@ static filterResult filter(stateFilter *self, stateEstimation *state)
 
     if ((this->auxMagUsage != AUXMAGSETTINGS_USAGE_AUXONLY) &&
         IS_SET(state->updated, SENSORUPDATES_boardMag)) {
-        // TODO:mag Offset estimation works with onboard mag only right now.
         if (this->revoCalibration.MagBiasNullingRate > 0) {
-            magOffsetEstimation(this, state->boardMag);
+            magOffsetEstimation(&this->boardMagBias, state->boardMag);
         }
         boardMagError = getMagError(this, state->boardMag);
         // sets warning only if no mag data are available (aux is invalid or missing)
@@ -204,99 +211,18 @@ static float getMagError(struct data *this, float mag[3])
 }
 
 /**
- * Perform an update of the @ref MagBias based on
- * Magmeter Offset Cancellation: Theory and Implementation,
- * revisited William Premerlani, October 14, 2011
+ * Update the hard iron estimation with a mag sample and remove the last
+ * bias published. The bias is only published once the fit is stable, the
+ * sample is left as it is until then.
  */
-void magOffsetEstimation(struct data *this, float mag[3])
+static void magOffsetEstimation(struct magbias_fit *fit, float mag[3])
 {
-#if 0
-    // Constants, to possibly go into a UAVO
-    static const float MIN_NORM_DIFFERENCE = 50;
-
-    static float B2[3] = { 0, 0, 0 };
-
-    MagBiasData magBias;
-    MagBiasGet(&magBias);
-
-    // Remove the current estimate of the bias
-    mag->x -= magBias.x;
-    mag->y -= magBias.y;
-    mag->z -= magBias.z;
-
-    // First call
-    if (B2[0] == 0 && B2[1] == 0 && B2[2] == 0) {
-        B2[0] = mag->x;
-        B2[1] = mag->y;
-        B2[2] = mag->z;
-        return;
-    }
-
-    float B1[3]     = { mag->x, mag->y, mag->z };
-    float norm_diff = sqrtf(powf(B2[0] - B1[0], 2) + powf(B2[1] - B1[1], 2) + powf(B2[2] - B1[2], 2));
-    if (norm_diff > MIN_NORM_DIFFERENCE) {
-        float norm_b1    = sqrtf(B1[0] * B1[0] + B1[1] * B1[1] + B1[2] * B1[2]);
-        float norm_b2    = sqrtf(B2[0] * B2[0] + B2[1] * B2[1] + B2[2] * B2[2]);
-        float scale      = cal.MagBiasNullingRate * (norm_b2 - norm_b1) / norm_diff;
-        float b_error[3] = { (B2[0] - B1[0]) * scale, (B2[1] - B1[1]) * scale, (B2[2] - B1[2]) * scale };
-
-        magBias.x += b_error[0];
-        magBias.y += b_error[1];
-        magBias.z += b_error[2];
-
-        MagBiasSet(&magBias);
-
-        // Store this value to compare against next update
-        B2[0] = B1[0]; B2[1] = B1[1]; B2[2] = B1[2];
+    magbias_update(fit, mag);
+    if (fit->published) {
+        mag[0] -= fit->stableBias[0];
+        mag[1] -= fit->stableBias[1];
+        mag[2] -= fit->stableBias[2];
     }
-#else // if 0
-
-    const float Rxy  = sqrtf(this->homeLocationBe[0] * this->homeLocationBe[0] + this->homeLocationBe[1] * this->homeLocationBe[1]);
-    const float Rz   = this->homeLocationBe[2];
-
-    const float rate = this->revoCalibration.MagBiasNullingRate;
-    float Rot[3][3];
-    float B_e[3];
-    float xy[2];
-    float delta[3];
-
-    AttitudeStateData attitude;
-    AttitudeStateGet(&attitude);
-
-    // Get the rotation matrix
-    Quaternion2R(&attitude.q1, Rot);
-
-    // Rotate the mag into the NED frame
-    B_e[0] = Rot[0][0] * mag[0] + Rot[1][0] * mag[1] + Rot[2][0] * mag[2];
-    B_e[1] = Rot[0][1] * mag[0] + Rot[1][1] * mag[1] + Rot[2][1] * mag[2];
-    B_e[2] = Rot[0][2] * mag[0] + Rot[1][2] * mag[1] + Rot[2][2] * mag[2];
-
-    float cy = cosf(DEG2RAD(attitude.Yaw));
-    float sy = sinf(DEG2RAD(attitude.Yaw));
-
-    xy[0] = cy * B_e[0] + sy * B_e[1];
-    xy[1] = -sy * B_e[0] + cy * B_e[1];
-
-    float xy_norm = sqrtf(xy[0] * xy[0] + xy[1] * xy[1]);
-
-    delta[0] = -rate * (xy[0] / xy_norm * Rxy - xy[0]);
-    delta[1] = -rate * (xy[1] / xy_norm * Rxy - xy[1]);
-    delta[2] = -rate * (Rz - B_e[2]);
-
-    if (!isnan(delta[0]) && !isinf(delta[0]) &&
-        !isnan(delta[1]) && !isinf(delta[1]) &&
-        !isnan(delta[2]) && !isinf(delta[2])) {
-        this->magBias[0] += delta[0];
-        this->magBias[1] += delta[1];
-        this->magBias[2] += delta[2];
-    }
-
-    // Add bias to state estimation
-    mag[0] += this->magBias[0];
-    mag[1] += this->magBias[1];
-    mag[2] += this->magBias[2];
-
-#endif // if 0
 }
 
 /**
@@ -72,6 +72,16 @@ typedef struct {
     float   auxMag[3];
     uint8_t magStatus;
     float   boardMag[3];
+    // GPS position in the fixed point of GPSPositionSensor, with the fix quality,
+    // checked and converted by the LLA filter
+    struct {
+        int32_t Latitude;
+        int32_t Longitude;
+        float   Altitude; // above the ellipsoid
+        float   PDOP;
+        int8_t  Satellites;
+        uint8_t Status;
+    } lla;
     sensorUpdates updated;
 } stateEstimation;
 
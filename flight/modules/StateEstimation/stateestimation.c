@@ -55,6 +55,10 @@
 #include "flightstatus.h"
 
 #include "CoordinateConversions.h"
+#include <fastloop.h>
+
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
 
 // Private constants
 #define STACK_SIZE_BYTES        256
@@ -132,16 +136,55 @@ struct filterPipelineStruct;
 
 typedef const struct filterPipelineStruct {
     const stateFilter *filter;
+    // sensor updates the filter consumes, it is skipped when none of them is set
+    uint16_t inputs;
+    uint8_t  slot;
+    // with only gyro and accel updates, run once every RevoSettings.EKFPredictionDivider times
+    bool     decimate;
     const struct filterPipelineStruct *next;
 } filterPipeline;
 
+// one slot per filter, for its runtime counter, last result and decimation count
+enum filterSlot {
+    FILTERSLOT_MAG = 0,
+    FILTERSLOT_BARO,
+    FILTERSLOT_BAROI,
+    FILTERSLOT_VELOCITY,
+    FILTERSLOT_ALTITUDE,
+    FILTERSLOT_AIR,
+    FILTERSLOT_STATIONARY,
+    FILTERSLOT_LLA,
+    FILTERSLOT_CF,
+    FILTERSLOT_CFM,
+    FILTERSLOT_EKF13I,
+    FILTERSLOT_EKF13,
+    FILTERSLOT_EKF16I,
+    FILTERSLOT_EKF16,
+    FILTERSLOT_NUM,
+};
+
+#define INPUTS_ALL       0xFFFF
+#define INPUTS_MAG       (SENSORUPDATES_auxMag | SENSORUPDATES_boardMag)
+#define INPUTS_AIR       (SENSORUPDATES_baro | SENSORUPDATES_airspeed)
+#define INPUTS_LLA       (SENSORUPDATES_lla)
+#define INPUTS_BARO      (SENSORUPDATES_baro | SENSORUPDATES_pos)
+#define INPUTS_ALTITUDE  (SENSORUPDATES_baro | SENSORUPDATES_pos | SENSORUPDATES_vel | SENSORUPDATES_accel)
+#define INPUTS_VELOCITY  (SENSORUPDATES_pos | SENSORUPDATES_vel)
+#define INPUTS_CF        (SENSORUPDATES_gyro | SENSORUPDATES_accel | SENSORUPDATES_mag)
+#define INPUTS_INERTIAL  (SENSORUPDATES_gyro | SENSORUPDATES_accel)
+
 // Private variables
 static DelayedCallbackInfo *stateEstimationCallback;
+PERF_DEFINE_COUNTER(counterPeriod);
+PERF_DEFINE_COUNTER(counterFilter[FILTERSLOT_NUM]);
 
 static volatile RevoSettingsData revoSettings;
 static volatile sensorUpdates updatedSensors;
 static volatile int32_t fusionAlgorithm  = -1;
 static const filterPipeline *filterChain = NULL;
+// result of the last run of each filter, reported again while it is skipped
+static filterResult filterResults[FILTERSLOT_NUM];
+static uint8_t filterDecimation[FILTERSLOT_NUM];
 
 // different filters available to state estimation
 static stateFilter magFilter;
@@ -156,6 +199,8 @@ static stateFilter cfFilter;
 static stateFilter cfmFilter;
 static stateFilter ekf13iFilter;
 static stateFilter ekf13Filter;
+static stateFilter ekf16iFilter;
+static stateFilter ekf16Filter;
 
 // this is a hack to provide a computational shortcut for faster gyro state progression
 static float gyroRaw[3];
@@ -164,12 +209,20 @@ static float gyroDelta[3];
 // preconfigured filter chains selectable via revoSettings.FusionAlgorithm
 static const filterPipeline *cfQueue = &(filterPipeline) {
     .filter = &airFilter,
+    .inputs = INPUTS_AIR,
+    .slot   = FILTERSLOT_AIR,
     .next   = &(filterPipeline) {
         .filter = &baroiFilter,
+        .inputs = INPUTS_BARO,
+        .slot   = FILTERSLOT_BAROI,
         .next   = &(filterPipeline) {
             .filter = &altitudeFilter,
+            .inputs = INPUTS_ALTITUDE,
+            .slot   = FILTERSLOT_ALTITUDE,
             .next   = &(filterPipeline) {
                 .filter = &cfFilter,
+                .inputs = INPUTS_CF,
+                .slot   = FILTERSLOT_CF,
                 .next   = NULL,
             }
         }
@@ -177,14 +230,24 @@ static const filterPipeline *cfQueue = &(filterPipeline) {
 };
 static const filterPipeline *cfmiQueue = &(filterPipeline) {
     .filter = &magFilter,
+    .inputs = INPUTS_MAG,
+    .slot   = FILTERSLOT_MAG,
     .next   = &(filterPipeline) {
         .filter = &airFilter,
+        .inputs = INPUTS_AIR,
+        .slot   = FILTERSLOT_AIR,
         .next   = &(filterPipeline) {
             .filter = &baroiFilter,
+            .inputs = INPUTS_BARO,
+            .slot   = FILTERSLOT_BAROI,
             .next   = &(filterPipeline) {
                 .filter = &altitudeFilter,
+                .inputs = INPUTS_ALTITUDE,
+                .slot   = FILTERSLOT_ALTITUDE,
                 .next   = &(filterPipeline) {
                     .filter = &cfmFilter,
+                    .inputs = INPUTS_CF,
+                    .slot   = FILTERSLOT_CFM,
                     .next   = NULL,
                 }
             }
@@ -193,16 +256,28 @@ static const filterPipeline *cfmiQueue = &(filterPipeline) {
 };
 static const filterPipeline *cfmQueue = &(filterPipeline) {
     .filter = &magFilter,
+    .inputs = INPUTS_MAG,
+    .slot   = FILTERSLOT_MAG,
     .next   = &(filterPipeline) {
         .filter = &airFilter,
+        .inputs = INPUTS_AIR,
+        .slot   = FILTERSLOT_AIR,
         .next   = &(filterPipeline) {
             .filter = &llaFilter,
+            .inputs = INPUTS_LLA,
+            .slot   = FILTERSLOT_LLA,
             .next   = &(filterPipeline) {
                 .filter = &baroFilter,
+                .inputs = INPUTS_BARO,
+                .slot   = FILTERSLOT_BARO,
                 .next   = &(filterPipeline) {
                     .filter = &altitudeFilter,
+                    .inputs = INPUTS_ALTITUDE,
+                    .slot   = FILTERSLOT_ALTITUDE,
                     .next   = &(filterPipeline) {
                         .filter = &cfmFilter,
+                        .inputs = INPUTS_CF,
+                        .slot   = FILTERSLOT_CFM,
                         .next   = NULL,
                     }
                 }
@@ -212,16 +287,29 @@ static const filterPipeline *cfmQueue = &(filterPipeline) {
 };
 static const filterPipeline *ekf13iQueue = &(filterPipeline) {
     .filter = &magFilter,
+    .inputs = INPUTS_MAG,
+    .slot   = FILTERSLOT_MAG,
     .next   = &(filterPipeline) {
         .filter = &airFilter,
+        .inputs = INPUTS_AIR,
+        .slot   = FILTERSLOT_AIR,
         .next   = &(filterPipeline) {
             .filter = &baroiFilter,
+            .inputs = INPUTS_BARO,
+            .slot   = FILTERSLOT_BAROI,
             .next   = &(filterPipeline) {
                 .filter = &stationaryFilter,
+                .inputs = INPUTS_ALL,
+                .slot   = FILTERSLOT_STATIONARY,
                 .next   = &(filterPipeline) {
-                    .filter = &ekf13iFilter,
-                    .next   = &(filterPipeline) {
+                    .filter   = &ekf13iFilter,
+                    .inputs   = INPUTS_ALL,
+                    .slot     = FILTERSLOT_EKF13I,
+                    .decimate = true,
+                    .next     = &(filterPipeline) {
                         .filter = &velocityFilter,
+                        .inputs = INPUTS_VELOCITY,
+                        .slot   = FILTERSLOT_VELOCITY,
                         .next   = NULL,
                     }
                 }
@@ -232,16 +320,95 @@ static const filterPipeline *ekf13iQueue = &(filterPipeline) {
 
 static const filterPipeline *ekf13Queue = &(filterPipeline) {
     .filter = &magFilter,
+    .inputs = INPUTS_MAG,
+    .slot   = FILTERSLOT_MAG,
     .next   = &(filterPipeline) {
         .filter = &airFilter,
+        .inputs = INPUTS_AIR,
+        .slot   = FILTERSLOT_AIR,
         .next   = &(filterPipeline) {
             .filter = &llaFilter,
+            .inputs = INPUTS_LLA,
+            .slot   = FILTERSLOT_LLA,
             .next   = &(filterPipeline) {
                 .filter = &baroFilter,
+                .inputs = INPUTS_BARO,
+                .slot   = FILTERSLOT_BARO,
                 .next   = &(filterPipeline) {
-                    .filter = &ekf13Filter,
-                    .next   = &(filterPipeline) {
+                    .filter   = &ekf13Filter,
+                    .inputs   = INPUTS_ALL,
+                    .slot     = FILTERSLOT_EKF13,
+                    .decimate = true,
+                    .next     = &(filterPipeline) {
+                        .filter = &velocityFilter,
+                        .inputs = INPUTS_VELOCITY,
+                        .slot   = FILTERSLOT_VELOCITY,
+                        .next   = NULL,
+                    }
+                }
+            }
+        }
+    }
+};
+
+static const filterPipeline *ekf16iQueue = &(filterPipeline) {
+    .filter = &magFilter,
+    .inputs = INPUTS_MAG,
+    .slot   = FILTERSLOT_MAG,
+    .next   = &(filterPipeline) {
+        .filter = &airFilter,
+        .inputs = INPUTS_AIR,
+        .slot   = FILTERSLOT_AIR,
+        .next   = &(filterPipeline) {
+            .filter = &baroiFilter,
+            .inputs = INPUTS_BARO,
+            .slot   = FILTERSLOT_BAROI,
+            .next   = &(filterPipeline) {
+                .filter = &stationaryFilter,
+                .inputs = INPUTS_ALL,
+                .slot   = FILTERSLOT_STATIONARY,
+                .next   = &(filterPipeline) {
+                    .filter   = &ekf16iFilter,
+                    .inputs   = INPUTS_ALL,
+                    .slot     = FILTERSLOT_EKF16I,
+                    .decimate = true,
+                    .next     = &(filterPipeline) {
+                        .filter = &velocityFilter,
+                        .inputs = INPUTS_VELOCITY,
+                        .slot   = FILTERSLOT_VELOCITY,
+                        .next   = NULL,
+                    }
+                }
+            }
+        }
+    }
+};
+
+static const filterPipeline *ekf16Queue = &(filterPipeline) {
+    .filter = &magFilter,
+    .inputs = INPUTS_MAG,
+    .slot   = FILTERSLOT_MAG,
+    .next   = &(filterPipeline) {
+        .filter = &airFilter,
+        .inputs = INPUTS_AIR,
+        .slot   = FILTERSLOT_AIR,
+        .next   = &(filterPipeline) {
+            .filter = &llaFilter,
+            .inputs = INPUTS_LLA,
+            .slot   = FILTERSLOT_LLA,
+            .next   = &(filterPipeline) {
+                .filter = &baroFilter,
+                .inputs = INPUTS_BARO,
+                .slot   = FILTERSLOT_BARO,
+                .next   = &(filterPipeline) {
+                    .filter   = &ekf16Filter,
+                    .inputs   = INPUTS_ALL,
+                    .slot     = FILTERSLOT_EKF16,
+                    .decimate = true,
+                    .next     = &(filterPipeline) {
                         .filter = &velocityFilter,
+                        .inputs = INPUTS_VELOCITY,
+                        .slot   = FILTERSLOT_VELOCITY,
                         .next   = NULL,
                     }
                 }
@@ -256,6 +423,8 @@ static void settingsUpdatedCb(UAVObjEvent *objEv);
 static void sensorUpdatedCb(UAVObjEvent *objEv);
 static void homeLocationUpdatedCb(UAVObjEvent *objEv);
 static void StateEstimationCb(void);
+static void fastloopGyroCb(float gyro[3]);
+static bool filterShouldRun(const filterPipeline *stage, uint16_t updated);
 
 static inline int32_t maxint32_t(int32_t a, int32_t b)
 {
@@ -302,6 +471,7 @@ int32_t StateEstimationInitialize(void)
     AuxMagSensorConnectCallback(&sensorUpdatedCb);
     GPSVelocitySensorConnectCallback(&sensorUpdatedCb);
     GPSPositionSensorConnectCallback(&sensorUpdatedCb);
+    fastloop_register(FASTLOOP_STAGE_ESTIMATION, &fastloopGyroCb);
 
     uint32_t stack_required = STACK_SIZE_BYTES;
     // Initialize Filters
@@ -317,8 +487,16 @@ int32_t StateEstimationInitialize(void)
     stack_required = maxint32_t(stack_required, filterCFMInitialize(&cfmFilter));
     stack_required = maxint32_t(stack_required, filterEKF13iInitialize(&ekf13iFilter));
     stack_required = maxint32_t(stack_required, filterEKF13Initialize(&ekf13Filter));
+    stack_required = maxint32_t(stack_required, filterEKF16iInitialize(&ekf16iFilter));
+    stack_required = maxint32_t(stack_required, filterEKF16Initialize(&ekf16Filter));
 
     stateEstimationCallback = PIOS_CALLBACKSCHEDULER_Create(&StateEstimationCb, CALLBACK_PRIORITY, TASK_PRIORITY, CALLBACKINFO_RUNNING_STATEESTIMATION, stack_required);
+    // period of the filter runs triggered by sensor updates
+    PERF_INIT_COUNTER(counterPeriod, 0x5E570001);
+    // runtime of each filter
+    for (uint8_t i = 0; i < FILTERSLOT_NUM; i++) {
+        PERF_INIT_COUNTER(counterFilter[i], 0x5E570010 + i);
+    }
 
     return 0;
 }
@@ -353,6 +531,7 @@ static void StateEstimationCb(void)
     static stateEstimation states;
     static uint32_t last_time;
     static uint16_t bootDelay = 64;
+    static bool gyroFilterSkipped;
 
     // after system startup, first few sensor readings might be messed up, delay until everything has settled
     if (bootDelay) {
@@ -373,6 +552,7 @@ static void StateEstimationCb(void)
             }
         } else {
             last_time = PIOS_DELAY_GetRaw();
+            PERF_MEASURE_PERIOD(counterPeriod);
         }
 
         // check if a new filter chain should be initialized
@@ -397,6 +577,12 @@ static void StateEstimationCb(void)
                 case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13:
                     newFilterChain = ekf13Queue;
                     break;
+                case REVOSETTINGS_FUSIONALGORITHM_INS16INDOOR:
+                    newFilterChain = ekf16iQueue;
+                    break;
+                case REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS16:
+                    newFilterChain = ekf16Queue;
+                    break;
                 default:
                     newFilterChain = NULL;
                 }
@@ -409,6 +595,8 @@ static void StateEstimationCb(void)
                         error = 1;
                         break;
                     }
+                    filterResults[current->slot]    = FILTERRESULT_OK;
+                    filterDecimation[current->slot] = 0;
                     current = current->next;
                 }
                 if (error) {
@@ -440,12 +628,23 @@ static void StateEstimationCb(void)
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_1_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(BaroSensor, baro, Altitude, true);
         FETCH_SENSOR_FROM_UAVOBJECT_CHECK_AND_LOAD_TO_STATE_2_DIMENSION_WITH_CUSTOM_EXTRA_CHECK(AirspeedSensor, airspeed, CalibratedAirspeed, TrueAirspeed, s.SensorConnected == AIRSPEEDSENSOR_SENSORCONNECTED_TRUE);
 
-        // GPS position data (LLA) is not fetched here since it does not contain floats. The filter must do all checks itself
+        // GPS position data (LLA) is fixed point, only copied here. The filter must do all checks itself
+        if (IS_SET(states.updated, SENSORUPDATES_lla)) {
+            GPSPositionSensorData s;
+            GPSPositionSensorGet(&s);
+            states.lla.Latitude   = s.Latitude;
+            states.lla.Longitude  = s.Longitude;
+            states.lla.Altitude   = s.Altitude + s.GeoidSeparation;
+            states.lla.PDOP       = s.PDOP;
+            states.lla.Satellites = s.Satellites;
+            states.lla.Status     = s.Status;
+        }
 
         // at this point sensor state is stored in "states" with some rudimentary filtering applied
 
         // apply all filters in the current filter chain
         current  = filterChain;
+        gyroFilterSkipped = false;
 
         // we are not done, re-dispatch self execution
         runState = RUNSTATE_FILTER;
@@ -455,9 +654,17 @@ static void StateEstimationCb(void)
     case RUNSTATE_FILTER:
 
         if (current != NULL) {
-            filterResult result = current->filter->filter((stateFilter *)current->filter, &states);
-            if (result > alarm) {
-                alarm = result;
+            uint8_t slot = current->slot;
+            if (filterShouldRun(current, states.updated)) {
+                PERF_TIMED_SECTION_START(counterFilter[slot]);
+                filterResults[slot] = current->filter->filter((stateFilter *)current->filter, &states);
+                PERF_TIMED_SECTION_END(counterFilter[slot]);
+            } else if (IS_SET(states.updated, SENSORUPDATES_gyro) && IS_SET(current->inputs, SENSORUPDATES_gyro)) {
+                // gyro bias correction of this cycle is missing, keep the previous one
+                gyroFilterSkipped = true;
+            }
+            if (filterResults[slot] > alarm) {
+                alarm = filterResults[slot];
             }
             current = current->next;
         }
@@ -473,7 +680,7 @@ static void StateEstimationCb(void)
 
         // the final output of filters is saved in state variables
         // EXPORT_STATE_TO_UAVOBJECT_IF_UPDATED_3_DIMENSIONS(GyroState, gyro, x, y, z) // replaced by performance shortcut
-        if (IS_SET(states.updated, SENSORUPDATES_gyro)) {
+        if (IS_SET(states.updated, SENSORUPDATES_gyro) && !gyroFilterSkipped) {
             gyroDelta[0] = states.gyro[0] - gyroRaw[0];
             gyroDelta[1] = states.gyro[1] - gyroRaw[1];
             gyroDelta[2] = states.gyro[2] - gyroRaw[2];
@@ -552,6 +759,26 @@ static void StateEstimationCb(void)
 }
 
 
+/**
+ * Check whether a filter of the chain has to run on this update
+ */
+static bool filterShouldRun(const filterPipeline *stage, uint16_t updated)
+{
+    if (!(updated & stage->inputs)) {
+        return false;
+    }
+    // aiding measurements always run the filter, which also predicts up to now
+    if (!stage->decimate || (updated & stage->inputs & ~INPUTS_INERTIAL)) {
+        filterDecimation[stage->slot] = 0;
+        return true;
+    }
+    if (++filterDecimation[stage->slot] >= revoSettings.EKFPredictionDivider) {
+        filterDecimation[stage->slot] = 0;
+        return true;
+    }
+    return false;
+}
+
 /**
  * Callback for eventdispatcher when RevoSettings has been updated
  */
@@ -583,14 +810,16 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
 
     if (ev->obj == GyroSensorHandle()) {
         updatedSensors |= SENSORUPDATES_gyro;
-        // shortcut - update GyroState right away
-        GyroSensorData s;
-        GyroStateData t;
-        GyroSensorGet(&s);
-        t.x = s.x + gyroDelta[0];
-        t.y = s.y + gyroDelta[1];
-        t.z = s.z + gyroDelta[2];
-        GyroStateSet(&t);
+        // shortcut - update GyroState right away, unless the fast loop already did
+        if (!fastloop_active()) {
+            GyroSensorData s;
+            GyroStateData t;
+            GyroSensorGet(&s);
+            t.x = s.x + gyroDelta[0];
+            t.y = s.y + gyroDelta[1];
+            t.z = s.z + gyroDelta[2];
+            GyroStateSet(&t);
+        }
     }
 
     if (ev->obj == AccelSensorHandle()) {
@@ -624,6 +853,17 @@ static void sensorUpdatedCb(UAVObjEvent *ev)
     PIOS_CALLBACKSCHEDULER_Dispatch(stateEstimationCallback);
 }
 
+/**
+ * Fast loop stage, applies the gyro bias estimated by the filters, same
+ * as the GyroState shortcut in sensorUpdatedCb
+ */
+static void fastloopGyroCb(float gyro[3])
+{
+    gyro[0] += gyroDelta[0];
+    gyro[1] += gyroDelta[1];
+    gyro[2] += gyroDelta[2];
+}
+
 
 /**
  * @}
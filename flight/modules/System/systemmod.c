@@ -67,6 +67,7 @@
 
 #if defined(PIOS_INCLUDE_RFM22B)
 #include <oplinkstatus.h>
+#include <oplinksettings.h>
 #endif
 
 // Flight Libraries
@@ -83,6 +84,7 @@
 
 // Private constants
 #define SYSTEM_UPDATE_PERIOD_MS 250
+#define OPLINK_STATUS_PERIOD_MS 1000
 
 #if defined(PIOS_SYSTEM_STACK_SIZE)
 #define STACK_SIZE_BYTES        PIOS_SYSTEM_STACK_SIZE
@@ -105,6 +107,7 @@ static struct PIOS_FLASHFS_Stats fsStats;
 
 // Private functions
 static void objectUpdatedCb(UAVObjEvent *ev);
+static int32_t objectListOperation(ObjectPersistenceData *objper);
 static void checkSettingsUpdatedCb(UAVObjEvent *ev);
 #ifdef DIAG_TASKS
 static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_info *task_info, void *context);
@@ -117,6 +120,10 @@ static void systemTask(void *parameters);
 static void updateI2Cstats();
 static void updateWDGstats();
 #endif
+#if defined(PIOS_INCLUDE_RFM22B)
+static void updateOPLinkStatus();
+static void updateLinkSummary(OPLinkStatusData *oplinkStatus, bool logSamples);
+#endif
 
 extern uintptr_t pios_uavo_settings_fs_id;
 extern uintptr_t pios_user_fs_id;
@@ -242,58 +249,8 @@ static void systemTask(__attribute__((unused)) void *parameters)
         int delayTime = SYSTEM_UPDATE_PERIOD_MS;
 
 #if defined(PIOS_INCLUDE_RFM22B)
-
-        // Update the OPLinkStatus UAVO
-        OPLinkStatusData oplinkStatus;
-        OPLinkStatusGet(&oplinkStatus);
-
-        if (pios_rfm22b_id) {
-            // Get the other device stats.
-            PIOS_RFM2B_GetPairStats(pios_rfm22b_id, oplinkStatus.PairIDs, oplinkStatus.PairSignalStrengths, OPLINKSTATUS_PAIRIDS_NUMELEM);
-
-            // Get the stats from the radio device
-            struct rfm22b_stats radio_stats;
-            PIOS_RFM22B_GetStats(pios_rfm22b_id, &radio_stats);
-
-            // Update the OPLInk status
-            static bool first_time = true;
-            static uint16_t prev_tx_count = 0;
-            static uint16_t prev_rx_count = 0;
-            oplinkStatus.HeapRemaining = xPortGetFreeHeapSize();
-            oplinkStatus.DeviceID = PIOS_RFM22B_DeviceID(pios_rfm22b_id);
-            oplinkStatus.RxGood = radio_stats.rx_good;
-            oplinkStatus.RxCorrected   = radio_stats.rx_corrected;
-            oplinkStatus.RxErrors = radio_stats.rx_error;
-            oplinkStatus.RxMissed = radio_stats.rx_missed;
-            oplinkStatus.RxFailure     = radio_stats.rx_failure;
-            oplinkStatus.TxDropped     = radio_stats.tx_dropped;
-            oplinkStatus.TxFailure     = radio_stats.tx_failure;
-            oplinkStatus.Resets      = radio_stats.resets;
-            oplinkStatus.Timeouts    = radio_stats.timeouts;
-            oplinkStatus.RSSI        = radio_stats.rssi;
-            oplinkStatus.LinkQuality = radio_stats.link_quality;
-            if (first_time) {
-                first_time = false;
-            } else {
-                uint16_t tx_count = radio_stats.tx_byte_count;
-                uint16_t rx_count = radio_stats.rx_byte_count;
-                uint16_t tx_bytes = (tx_count < prev_tx_count) ? (0xffff - prev_tx_count + tx_count) : (tx_count - prev_tx_count);
-                uint16_t rx_bytes = (rx_count < prev_rx_count) ? (0xffff - prev_rx_count + rx_count) : (rx_count - prev_rx_count);
-                oplinkStatus.TXRate = (uint16_t)((float)(tx_bytes * 1000) / SYSTEM_UPDATE_PERIOD_MS);
-                oplinkStatus.RXRate = (uint16_t)((float)(rx_bytes * 1000) / SYSTEM_UPDATE_PERIOD_MS);
-                prev_tx_count = tx_count;
-                prev_rx_count = rx_count;
-            }
-            oplinkStatus.TXSeq     = radio_stats.tx_seq;
-            oplinkStatus.RXSeq     = radio_stats.rx_seq;
-
-            oplinkStatus.LinkState = radio_stats.link_state;
-        } else {
-            oplinkStatus.LinkState = OPLINKSTATUS_LINKSTATE_DISABLED;
-        }
-        OPLinkStatusSet(&oplinkStatus);
-
-#endif /* if defined(PIOS_INCLUDE_RFM22B) */
+        updateOPLinkStatus();
+#endif
 
         if (xQueueReceive(objectPersistenceQueue, &ev, delayTime) == pdTRUE) {
             // If object persistence is updated call the callback
@@ -327,6 +284,8 @@ static void objectUpdatedCb(UAVObjEvent *ev)
         // Execute action if disarmed
         if (flightStatus.Armed != FLIGHTSTATUS_ARMED_DISARMED) {
             retval = -1;
+        } else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_OBJECTLIST) {
+            retval = objectListOperation(&objper);
         } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_LOAD) {
             if (objper.Selection == OBJECTPERSISTENCE_SELECTION_SINGLEOBJECT) {
                 // Get selected object
@@ -399,6 +358,53 @@ static void objectUpdatedCb(UAVObjEvent *ev)
     }
 }
 
+/**
+ * Load, save or delete each of the objects listed, in one pass
+ * \param[in,out] objper The request, ListFailed is set to the objects that failed
+ * \return 0 if the operation was run, -1 if it does not apply to a list
+ */
+static int32_t objectListOperation(ObjectPersistenceData *objper)
+{
+    uint8_t count = objper->ListCount;
+
+    if (count > OBJECTPERSISTENCE_LISTOBJECTID_NUMELEM) {
+        count = OBJECTPERSISTENCE_LISTOBJECTID_NUMELEM;
+    }
+    if (objper->Operation != OBJECTPERSISTENCE_OPERATION_LOAD && objper->Operation != OBJECTPERSISTENCE_OPERATION_SAVE &&
+        objper->Operation != OBJECTPERSISTENCE_OPERATION_DELETE) {
+        return -1;
+    }
+
+    objper->ListFailed = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        UAVObjHandle obj = UAVObjGetByID(objper->ListObjectID[i]);
+        uint16_t instId  = objper->ListInstanceID[i];
+        int32_t retval   = -1;
+
+        if (obj != 0) {
+            switch (objper->Operation) {
+            case OBJECTPERSISTENCE_OPERATION_LOAD:
+                retval = UAVObjLoad(obj, instId);
+                break;
+            case OBJECTPERSISTENCE_OPERATION_SAVE:
+                retval = UAVObjSave(obj, instId);
+                // Verify saving worked
+                if (retval == 0) {
+                    retval = UAVObjLoad(obj, instId);
+                }
+                break;
+            default:
+                retval = UAVObjDelete(obj, instId);
+                break;
+            }
+        }
+        if (retval != 0) {
+            objper->ListFailed |= 1 << i;
+        }
+    }
+    return 0;
+}
+
 /**
  * Called whenever hardware settings changed
  */
@@ -426,6 +432,8 @@ static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_
     TaskInfoRunningToArray(taskData->Running)[task_id] = task_info->is_running ? TASKINFO_RUNNING_TRUE : TASKINFO_RUNNING_FALSE;
     ((uint16_t *)&taskData->StackRemaining)[task_id]   = task_info->stack_remaining;
     ((uint8_t *)&taskData->RunningTime)[task_id] = task_info->running_time_percentage;
+    ((uint16_t *)&taskData->MaxRunTime)[task_id] = MIN(task_info->max_running_time, UINT16_MAX);
+    ((uint16_t *)&taskData->ContextSwitches)[task_id] = MIN(task_info->context_switches, UINT16_MAX);
 }
 
 static void callbackSchedulerForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context)
@@ -445,6 +453,9 @@ static void callbackSchedulerForEachCallback(int16_t callback_id, const struct p
     ((uint8_t *)&callbackData->Running)[callback_id] = callback_info->is_running;
     ((uint32_t *)&callbackData->RunningTime)[callback_id]   = callback_info->running_time_count;
     ((int16_t *)&callbackData->StackRemaining)[callback_id] = callback_info->stack_remaining;
+    ((uint32_t *)&callbackData->MaxLatency)[callback_id]    = callback_info->max_latency;
+    ((uint8_t *)&callbackData->CPUTime)[callback_id]        = callback_info->running_time_percentage;
+    ((uint32_t *)&callbackData->MaxRunTime)[callback_id]    = callback_info->max_running_time;
 }
 #endif /* ifdef DIAG_TASKS */
 
@@ -468,6 +479,22 @@ static void updateI2Cstats()
         i2cStats.state_log[i] = history.state[i];
     }
     i2cStats.last_error_type = history.type;
+
+    static uint32_t lastBusyUs[I2CSTATS_BUS_UTILIZATION_NUMELEM];
+    static uint32_t lastTime;
+    uint32_t elapsedUs = PIOS_DELAY_DiffuS(lastTime);
+    lastTime = PIOS_DELAY_GetRaw();
+
+    for (uint8_t i = 0; i < I2CSTATS_BUS_UTILIZATION_NUMELEM; i++) {
+        struct pios_i2c_bus_stats busStats;
+        if (PIOS_I2C_GetBusStats(i, &busStats) != 0) {
+            break;
+        }
+        i2cStats.bus_transfers[i]   = busStats.transfers;
+        i2cStats.bus_errors[i]      = busStats.errors + busStats.timeouts + busStats.nacks + busStats.queue_full;
+        i2cStats.bus_utilization[i] = (elapsedUs > 0) ? MIN(100, (uint64_t)(busStats.busy_us - lastBusyUs[i]) * 100 / elapsedUs) : 0;
+        lastBusyUs[i] = busStats.busy_us;
+    }
     I2CStatsSet(&i2cStats);
 #endif
 }
@@ -553,6 +580,16 @@ static void updateStats()
 #endif
     stats.CPULoad = 100 - PIOS_TASK_MONITOR_GetIdlePercentage();
 
+#if defined(PIOS_INCLUDE_USART) && !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+    for (uint8_t i = 0; i < SYSTEMSTATS_USARTIRQS_NUMELEM; i++) {
+        SystemStatsUsartIrqsToArray(stats.UsartIrqs)[i] = PIOS_USART_GetIrqCount(i + 1);
+    }
+#endif
+
+    for (uint8_t i = 0; i < SYSTEMSTATS_MEMORYUSAGE_NUMELEM; i++) {
+        SystemStatsMemoryUsageToArray(stats.MemoryUsage)[i] = pios_mem_get_usage(i);
+    }
+
 #if defined(PIOS_INCLUDE_ADC) && defined(PIOS_ADC_USE_TEMP_SENSOR)
     float temp_voltage = PIOS_ADC_PinGetVolt(PIOS_ADC_TEMPERATURE_PIN);
     stats.CPUTemp = PIOS_CONVERT_VOLT_TO_CPU_TEMP(temp_voltage);;
@@ -630,6 +667,134 @@ static void updateSystemAlarms()
     }
 }
 
+#if defined(PIOS_INCLUDE_RFM22B)
+/**
+ * Update the OPLinkStatus every OPLinkSettings.StatusPeriod, the rates are computed
+ * over the time actually elapsed since the previous update.
+ */
+static void updateOPLinkStatus()
+{
+    static uint32_t settingsChange = 0;
+    static uint16_t period_ms = OPLINK_STATUS_PERIOD_MS;
+    static bool logSamples    = false;
+    static portTickType lastStatusTime = 0;
+
+    OPLinkSettingsData oplinkSettings;
+
+    if (OPLinkSettingsGetIfChanged(&oplinkSettings, &settingsChange)) {
+        period_ms  = (oplinkSettings.StatusPeriod) ? MAX(SYSTEM_UPDATE_PERIOD_MS, oplinkSettings.StatusPeriod) : OPLINK_STATUS_PERIOD_MS;
+        logSamples = (oplinkSettings.LogPacketSamples == OPLINKSETTINGS_LOGPACKETSAMPLES_TRUE);
+    }
+
+    portTickType now    = xTaskGetTickCount();
+    uint32_t elapsed_ms = (now - lastStatusTime) * portTICK_RATE_MS;
+    if (elapsed_ms < period_ms) {
+        return;
+    }
+    lastStatusTime = now;
+
+    // Update the OPLinkStatus UAVO
+    OPLinkStatusData oplinkStatus;
+    OPLinkStatusGet(&oplinkStatus);
+
+    if (pios_rfm22b_id) {
+        // Get the other device stats.
+        PIOS_RFM2B_GetPairStats(pios_rfm22b_id, oplinkStatus.PairIDs, oplinkStatus.PairSignalStrengths, OPLINKSTATUS_PAIRIDS_NUMELEM);
+
+        // Get the stats from the radio device
+        struct rfm22b_stats radio_stats;
+        PIOS_RFM22B_GetStats(pios_rfm22b_id, &radio_stats);
+
+        // Update the OPLInk status
+        static bool first_time = true;
+        static uint16_t prev_tx_count = 0;
+        static uint16_t prev_rx_count = 0;
+        static uint16_t prev_payload_count = 0;
+        static uint16_t prev_airtime_ms    = 0;
+        oplinkStatus.HeapRemaining = xPortGetFreeHeapSize();
+        oplinkStatus.DeviceID = PIOS_RFM22B_DeviceID(pios_rfm22b_id);
+        oplinkStatus.RxGood = radio_stats.rx_good;
+        oplinkStatus.RxCorrected   = radio_stats.rx_corrected;
+        oplinkStatus.RxErrors = radio_stats.rx_error;
+        oplinkStatus.RxMissed = radio_stats.rx_missed;
+        oplinkStatus.RxFailure     = radio_stats.rx_failure;
+        oplinkStatus.TxDropped     = radio_stats.tx_dropped;
+        oplinkStatus.TxFailure     = radio_stats.tx_failure;
+        oplinkStatus.Resets      = radio_stats.resets;
+        oplinkStatus.Timeouts    = radio_stats.timeouts;
+        oplinkStatus.RSSI        = radio_stats.rssi;
+        oplinkStatus.LinkQuality = radio_stats.link_quality;
+        if (first_time) {
+            first_time = false;
+        } else {
+            uint16_t tx_count = radio_stats.tx_byte_count;
+            uint16_t rx_count = radio_stats.rx_byte_count;
+            uint16_t tx_bytes = (tx_count < prev_tx_count) ? (0xffff - prev_tx_count + tx_count) : (tx_count - prev_tx_count);
+            uint16_t rx_bytes = (rx_count < prev_rx_count) ? (0xffff - prev_rx_count + rx_count) : (rx_count - prev_rx_count);
+            oplinkStatus.TXRate = (uint16_t)((float)(tx_bytes * 1000) / elapsed_ms);
+            oplinkStatus.RXRate = (uint16_t)((float)(rx_bytes * 1000) / elapsed_ms);
+            // Goodput only counts the com data, airtime is the share of the period spent transmitting
+            uint16_t payload_bytes = radio_stats.tx_payload_count - prev_payload_count;
+            uint16_t airtime_ms    = radio_stats.tx_airtime_ms - prev_airtime_ms;
+            oplinkStatus.TXGoodput = (uint16_t)((float)(payload_bytes * 1000) / elapsed_ms);
+            oplinkStatus.TXAirtime = (uint8_t)MIN(100, (uint32_t)airtime_ms * 100 / elapsed_ms);
+            prev_tx_count = tx_count;
+            prev_rx_count = rx_count;
+        }
+        prev_payload_count = radio_stats.tx_payload_count;
+        prev_airtime_ms    = radio_stats.tx_airtime_ms;
+        oplinkStatus.TXPacketLength = radio_stats.tx_packet_len;
+        oplinkStatus.TXSeq     = radio_stats.tx_seq;
+        oplinkStatus.RXSeq     = radio_stats.rx_seq;
+
+        oplinkStatus.LinkState = radio_stats.link_state;
+        updateLinkSummary(&oplinkStatus, logSamples);
+    } else {
+        oplinkStatus.LinkState = OPLINKSTATUS_LINKSTATE_DISABLED;
+    }
+    OPLinkStatusSet(&oplinkStatus);
+}
+
+/**
+ * Publish the packet counters of the last period, and log the samples of the packets
+ * received since when enabled.
+ */
+static void updateLinkSummary(OPLinkStatusData *oplinkStatus, bool logSamples)
+{
+    struct rfm22b_link_summary summary;
+
+    PIOS_RFM22B_GetLinkSummary(pios_rfm22b_id, &summary);
+    oplinkStatus->RxPackets.Good      = summary.rx_packets[0];
+    oplinkStatus->RxPackets.Corrected = summary.rx_packets[1];
+    oplinkStatus->RxPackets.Error     = summary.rx_packets[2];
+    oplinkStatus->RxPackets.Failure   = summary.rx_packets[3];
+    oplinkStatus->TxPackets.Sent   = summary.tx_packets;
+    oplinkStatus->TxPackets.Failed = summary.tx_failures;
+
+    uint32_t rssi_packets = 0;
+    for (uint8_t i = 0; i < RFM22B_RSSI_BUCKETS; ++i) {
+        rssi_packets += summary.rx_rssi_histogram[i];
+    }
+    for (uint8_t i = 0; i < RFM22B_RSSI_BUCKETS; ++i) {
+        oplinkStatus->RSSIHistogram[i] = (rssi_packets) ? (uint8_t)((uint32_t)summary.rx_rssi_histogram[i] * 100 / rssi_packets) : 0;
+    }
+    if (rssi_packets) {
+        oplinkStatus->RSSIMin     = summary.rx_rssi_min;
+        oplinkStatus->RSSIMax     = summary.rx_rssi_max;
+        oplinkStatus->RSSIAverage = (int8_t)(summary.rx_rssi_sum / (int32_t)rssi_packets);
+    }
+
+    // Drained even when not logged, the ring would hold stale samples otherwise
+    static struct rfm22b_packet_sample samples[8];
+    uint8_t n;
+    while ((n = PIOS_RFM22B_GetPacketSamples(pios_rfm22b_id, samples, NELEMENTS(samples))) > 0) {
+        for (uint8_t i = 0; logSamples && i < n; ++i) {
+            PIOS_DEBUGLOG_PRINTF("RFM22B packet %u rssi %d status %u", samples[i].time_ms, samples[i].rssi, samples[i].status);
+        }
+    }
+}
+#endif /* if defined(PIOS_INCLUDE_RFM22B) */
+
 /**
  * Called by the RTOS when the CPU is idle,
  */
@@ -676,4 +841,4 @@ void vApplicationMallocFailedHook(void)
 /**
  * @}
  * @}
- */
+ */
\ No newline at end of file
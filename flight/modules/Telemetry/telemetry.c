@@ -4,8 +4,8 @@
  * @{
  * @addtogroup TelemetryModule Telemetry Module
  * @brief Main telemetry module
- * Starts three tasks (RX, TX, and priority TX) that watch event queues
- * and handle all the telemetry of the UAVobjects
+ * Starts the RX and TX tasks, the TX task sends the latest pending update
+ * of each object and handles all the telemetry of the UAVobjects
  * @{
  *
  * @file       telemetry.c
@@ -33,14 +33,30 @@
 #include <openpilot.h>
 
 #include "telemetry.h"
+#include <mathmisc.h>
 
 #include "flighttelemetrystats.h"
 #include "gcstelemetrystats.h"
+#include "objectdatacrc.h"
 #include "hwsettings.h"
 #include "taskinfo.h"
+#if defined(PIOS_TELEM_HITL_SENSORS)
+#include "hitlsensors.h"
+#include "hitlsensorsack.h"
+#include "gyrostate.h"
+#include "accelstate.h"
+#include "attitudestate.h"
+#include "barosensor.h"
+#include "gpspositionsensor.h"
+#include "gpsvelocitysensor.h"
+#include "positionstate.h"
+#include "velocitystate.h"
+#include "airspeedstate.h"
+#include "flightbatterystate.h"
+#include "CoordinateConversions.h"
+#endif
 
 // Private constants
-#define MAX_QUEUE_SIZE            TELEM_QUEUE_SIZE
 // Three different stack size parameter are accepted for Telemetry(RX PIOS_TELEM_RX_STACK_SIZE)
 // Tx(PIOS_TELEM_TX_STACK_SIZE) and Radio RX(PIOS_TELEM_RADIO_RX_STACK_SIZE)
 #ifdef PIOS_TELEM_RX_STACK_SIZE
@@ -63,21 +79,38 @@
 #define MAX_RETRIES               2
 #define STATS_UPDATE_PERIOD_MS    4000
 #define CONNECTION_TIMEOUT_MS     8000
+// Bandwidth budget: UAVTalk frame overhead, link rates and scaling of the non priority update periods
+#define FRAME_OVERHEAD_BYTES      11
+#define USB_BYTES_PER_SEC         64000
+#define MIN_CAPACITY_BYTES_PER_SEC 100
+#define BUDGET_PERCENT            75
+#define MIN_PERIOD_SCALE          0.5f
+#define MAX_PERIOD_SCALE          16.0f
+#define MIN_SCALED_PERIOD_MS      10
 
 // Private types
 
+// Latest pending telemetry events of an object, the mailboxes are sorted by handle
+struct ObjMailbox {
+    UAVObjHandle obj;
+    uint16_t     instId;
+    uint8_t      events;
+};
+
 // Private variables
 static uint32_t telemetryPort;
 #ifdef PIOS_INCLUDE_RFM22B
 static uint32_t radioPort;
 #endif
-static xQueueHandle queue;
-
-#if defined(PIOS_TELEM_PRIORITY_QUEUE)
-static xQueueHandle priorityQueue;
-#else
-#define priorityQueue queue
-#endif
+static struct ObjMailbox *mailboxes;
+static uint16_t numMailboxes;
+static uint32_t *dirtyObjects;
+static uint32_t *priorityObjects;
+static uint16_t nextPriorityObject;
+static uint16_t nextNormalObject;
+static volatile bool statsDue;
+static volatile bool gcsStatsDue;
+static xSemaphoreHandle txSemaphore;
 
 static xTaskHandle telemetryTxTaskHandle;
 static xTaskHandle telemetryRxTaskHandle;
@@ -86,7 +119,16 @@ static xTaskHandle radioRxTaskHandle;
 #endif
 static uint32_t txErrors;
 static uint32_t txRetries;
+static uint32_t txCoalesced;
+static uint32_t periodicCoalesced;
 static uint32_t timeOfLastObjectUpdate;
+static uint32_t telemetryBytesPerSec;
+static uint32_t linkPort;
+static uint32_t linkCapacity;
+static uint32_t demandPriority;
+static uint32_t demandNormal;
+static uint8_t rateScaling;
+static float periodScale;
 static UAVTalkConnection uavTalkCon;
 #ifdef PIOS_INCLUDE_RFM22B
 static UAVTalkConnection radioUavTalkCon;
@@ -100,13 +142,28 @@ static void radioRxTask(void *parameters);
 static int32_t transmitRadioData(uint8_t *data, int32_t length);
 #endif
 static int32_t transmitData(uint8_t *data, int32_t length);
+static void countObject(UAVObjHandle obj);
+static void addMailbox(UAVObjHandle obj);
+static struct ObjMailbox *findMailbox(UAVObjHandle obj);
+static void postObjEvent(UAVObjEvent *ev);
+static void postStatsEvent(UAVObjEvent *ev);
+static void postGCSStatsEvent(UAVObjEvent *ev);
+static bool takeObjEvent(const uint32_t *classMask, uint16_t *cursor, UAVObjEvent *ev);
 static void registerObject(UAVObjHandle obj);
 static void updateObject(UAVObjHandle obj, int32_t eventType);
 static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs);
 static int32_t setLoggingPeriod(UAVObjHandle obj, int32_t updatePeriodMs);
 static void processObjEvent(UAVObjEvent *ev);
 static void updateTelemetryStats();
+static void updateBandwidthBudget(UAVTalkStats *utalkStats, FlightTelemetryStatsData *flightStats);
+static void addObjectDemand(UAVObjHandle obj);
+static void applyScaledPeriod(UAVObjHandle obj);
+static uint16_t scaledUpdatePeriod(UAVObjHandle obj, uint16_t updatePeriodMs);
 static void gcsTelemetryStatsUpdated();
+static void objectDataCRCRequested(UAVObjEvent *ev);
+#if defined(PIOS_TELEM_HITL_SENSORS)
+static void hitlSensorsReceived(UAVObjEvent *ev);
+#endif
 static void updateSettings();
 static uint32_t getComPort(bool input);
 
@@ -117,11 +174,36 @@ static uint32_t getComPort(bool input);
  */
 int32_t TelemetryStart(void)
 {
-    // Process all registered objects and connect queue for updates
+    // One mailbox per object, it holds the events of the object until the TX task gets to it
+    numMailboxes = 0;
+    UAVObjIterate(&countObject);
+    uint16_t words = (numMailboxes + 31) / 32;
+    mailboxes       = (struct ObjMailbox *)pios_malloc(numMailboxes * sizeof(struct ObjMailbox));
+    dirtyObjects    = (uint32_t *)pios_malloc(words * sizeof(uint32_t));
+    priorityObjects = (uint32_t *)pios_malloc(words * sizeof(uint32_t));
+    PIOS_Assert(mailboxes && dirtyObjects && priorityObjects);
+    memset(dirtyObjects, 0, words * sizeof(uint32_t));
+    memset(priorityObjects, 0, words * sizeof(uint32_t));
+    numMailboxes = 0;
+    UAVObjIterate(&addMailbox);
+    for (uint16_t i = 0; i < numMailboxes; i++) {
+        UAVObjHandle obj = mailboxes[i].obj;
+        // note that all setting objects have implicitly IsPriority=true
+        if (UAVObjIsMetaobject(obj) || UAVObjIsPriority(obj) || obj == GCSTelemetryStatsHandle()) {
+            priorityObjects[i / 32] |= 1u << (i % 32);
+        }
+    }
+
+    // Process all registered objects and connect them to their mailbox
     UAVObjIterate(&registerObject);
 
     // Listen to objects of interest
-    GCSTelemetryStatsConnectQueue(priorityQueue);
+    UAVObjConnectFastCallback(GCSTelemetryStatsHandle(), &postGCSStatsEvent, EV_MASK_ALL_UPDATES);
+    // only the requests of the GCS, not the answer set here
+    UAVObjConnectCallback(ObjectDataCRCHandle(), &objectDataCRCRequested, EV_UNPACKED);
+#if defined(PIOS_TELEM_HITL_SENSORS)
+    UAVObjConnectCallback(HITLSensorsHandle(), &hitlSensorsReceived, EV_UNPACKED);
+#endif
 
     // Start telemetry tasks
     xTaskCreate(telemetryTxTask, "TelTx", STACK_SIZE_TX_BYTES / 4, NULL, TASK_PRIORITY_TX, &telemetryTxTaskHandle);
@@ -146,15 +228,18 @@ int32_t TelemetryInitialize(void)
 {
     FlightTelemetryStatsInitialize();
     GCSTelemetryStatsInitialize();
+    ObjectDataCRCInitialize();
+#if defined(PIOS_TELEM_HITL_SENSORS)
+    HITLSensorsInitialize();
+    HITLSensorsAckInitialize();
+#endif
 
     // Initialize vars
     timeOfLastObjectUpdate = 0;
+    periodScale = 1.0f;
 
-    // Create object queues
-    queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
-#if defined(PIOS_TELEM_PRIORITY_QUEUE)
-    priorityQueue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
-#endif
+    // Wakes the TX task when an event is posted to a mailbox
+    vSemaphoreCreateBinary(txSemaphore);
 
     // Update telemetry settings
     telemetryPort = PIOS_COM_TELEM_RF;
@@ -176,13 +261,157 @@ int32_t TelemetryInitialize(void)
     txRetries = 0;
     UAVObjEvent ev;
     memset(&ev, 0, sizeof(UAVObjEvent));
-    EventPeriodicQueueCreate(&ev, priorityQueue, STATS_UPDATE_PERIOD_MS);
+    EventPeriodicCallbackCreate(&ev, &postStatsEvent, STATS_UPDATE_PERIOD_MS);
 
     return 0;
 }
 
 MODULE_INITCALL(TelemetryInitialize, TelemetryStart);
 
+/**
+ * Count the objects needing a mailbox
+ */
+static void countObject(__attribute__((unused)) UAVObjHandle obj)
+{
+    numMailboxes++;
+}
+
+/**
+ * Add the mailbox of an object, keeping them sorted by handle
+ */
+static void addMailbox(UAVObjHandle obj)
+{
+    uint16_t i = numMailboxes++;
+
+    while (i > 0 && (uintptr_t)mailboxes[i - 1].obj > (uintptr_t)obj) {
+        mailboxes[i] = mailboxes[i - 1];
+        i--;
+    }
+    mailboxes[i].obj    = obj;
+    mailboxes[i].instId = 0;
+    mailboxes[i].events = 0;
+}
+
+/**
+ * Find the mailbox of an object
+ * \return the mailbox or NULL if the object was registered after the telemetry started
+ */
+static struct ObjMailbox *findMailbox(UAVObjHandle obj)
+{
+    int32_t low  = 0;
+    int32_t high = numMailboxes - 1;
+
+    while (low <= high) {
+        int32_t mid = (low + high) / 2;
+        if (mailboxes[mid].obj == obj) {
+            return &mailboxes[mid];
+        } else if ((uintptr_t)mailboxes[mid].obj < (uintptr_t)obj) {
+            low  = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Post an object event to the mailbox of the object, called from the context updating the object.
+ * An event already pending is not queued again, the TX task will send the latest data once.
+ * Pending events of different instances are merged into an update of all instances.
+ */
+static void postObjEvent(UAVObjEvent *ev)
+{
+    struct ObjMailbox *box = findMailbox(ev->obj);
+
+    if (box == NULL) {
+        return;
+    }
+    uint16_t i = box - mailboxes;
+
+    portENTER_CRITICAL();
+    if (box->events & ev->event) {
+        ++txCoalesced;
+        if (ev->event == EV_UPDATED_PERIODIC) {
+            ++periodicCoalesced;
+        }
+    }
+    box->instId = (box->events && box->instId != ev->instId) ? UAVOBJ_ALL_INSTANCES : ev->instId;
+    box->events |= ev->event;
+    dirtyObjects[i / 32] |= 1u << (i % 32);
+    portEXIT_CRITICAL();
+
+    xSemaphoreGive(txSemaphore);
+}
+
+/**
+ * Periodic event of the telemetry stats
+ */
+static void postStatsEvent(__attribute__((unused)) UAVObjEvent *ev)
+{
+    statsDue = true;
+    xSemaphoreGive(txSemaphore);
+}
+
+/**
+ * GCS telemetry stats updated, handled before any object update
+ */
+static void postGCSStatsEvent(__attribute__((unused)) UAVObjEvent *ev)
+{
+    gcsStatsDue = true;
+    xSemaphoreGive(txSemaphore);
+}
+
+/**
+ * Take the lowest pending event of the first dirty object from the cursor on, the objects
+ * are served round robin as the cursor then moves past the object
+ * \param[in] classMask Restrict the search to these objects, NULL for all of them
+ * \param[in,out] cursor Index of the mailbox the search starts from, it wraps around
+ * \param[out] ev The event taken
+ * \return true if an event was taken
+ */
+static bool takeObjEvent(const uint32_t *classMask, uint16_t *cursor, UAVObjEvent *ev)
+{
+    uint16_t words = (numMailboxes + 31) / 32;
+    uint16_t start = *cursor;
+
+    if (numMailboxes == 0) {
+        return false;
+    }
+    for (uint16_t n = 0; n <= words; n++) {
+        uint16_t w    = (start / 32 + n) % words;
+        uint32_t bits = dirtyObjects[w];
+        if (classMask) {
+            bits &= classMask[w];
+        }
+        if (n == 0) {
+            // first word, skip the objects before start
+            bits &= ~((1u << (start % 32)) - 1);
+        } else if (n == words) {
+            // back to the first word, only the objects before start are left
+            bits &= (1u << (start % 32)) - 1;
+        }
+        if (bits == 0) {
+            continue;
+        }
+
+        uint16_t i = w * 32 + __builtin_ctz(bits);
+        struct ObjMailbox *box = &mailboxes[i];
+        portENTER_CRITICAL();
+        ev->obj     = box->obj;
+        ev->instId  = box->instId;
+        ev->event   = (UAVObjEventType)(box->events & -box->events);
+        ev->lowPriority = true;
+        box->events &= ~ev->event;
+        if (box->events == 0) {
+            dirtyObjects[w] &= ~(1u << (i % 32));
+        }
+        portEXIT_CRITICAL();
+        *cursor = (i + 1) % numMailboxes;
+        return true;
+    }
+    return false;
+}
+
 /**
  * Register a new object, adds object to local list and connects the queue depending on the object's
  * telemetry settings.
@@ -192,7 +421,7 @@ static void registerObject(UAVObjHandle obj)
 {
     if (UAVObjIsMetaobject(obj)) {
         // Only connect change notifications for meta objects.  No periodic updates
-        UAVObjConnectQueue(obj, priorityQueue, EV_MASK_ALL_UPDATES);
+        UAVObjConnectFastCallback(obj, &postObjEvent, EV_MASK_ALL_UPDATES);
     } else {
         // Setup object for periodic updates
         updateObject(obj, EV_NONE);
@@ -226,7 +455,7 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
     switch (updateMode) {
     case UPDATEMODE_PERIODIC:
         // Set update period
-        setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+        setUpdatePeriod(obj, scaledUpdatePeriod(obj, metadata.telemetryUpdatePeriod));
         // Connect queue
         eventMask |= EV_UPDATED_PERIODIC | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
         break;
@@ -242,7 +471,7 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
             eventMask |= EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
             // Set update period on initialization and metadata change
             if (eventType == EV_NONE) {
-                setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+                setUpdatePeriod(obj, scaledUpdatePeriod(obj, metadata.telemetryUpdatePeriod));
             }
         } else {
             // Otherwise, we just received an object update, so switch to periodic for the timeout period to prevent more updates
@@ -289,12 +518,7 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
         eventMask |= EV_LOGGING_MANUAL;
         break;
     }
-    // note that all setting objects have implicitly IsPriority=true
-    if (UAVObjIsPriority(obj)) {
-        UAVObjConnectQueue(obj, priorityQueue, eventMask);
-    } else {
-        UAVObjConnectQueue(obj, queue, eventMask);
-    }
+    UAVObjConnectFastCallback(obj, &postObjEvent, eventMask);
 }
 
 /**
@@ -307,9 +531,7 @@ static void processObjEvent(UAVObjEvent *ev)
     int32_t retries;
     int32_t success;
 
-    if (ev->obj == 0) {
-        updateTelemetryStats();
-    } else if (ev->obj == GCSTelemetryStatsHandle()) {
+    if (ev->obj == GCSTelemetryStatsHandle()) {
         gcsTelemetryStatsUpdated();
     } else {
         // Get object metadata
@@ -393,30 +615,23 @@ static void telemetryTxTask(__attribute__((unused)) void *parameters)
     // Loop forever
     while (1) {
         /**
-         * Tries to empty the high priority queue before handling any standard priority item
+         * The stats come first, then the priority objects and the others after them.
+         * Only one event is taken at a time so that a new priority update goes next.
          */
-#if defined(PIOS_TELEM_PRIORITY_QUEUE)
-        // empty priority queue, non-blocking
-        while (xQueueReceive(priorityQueue, &ev, 0) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
-        }
-        // check regular queue and process update - non-blocking
-        if (xQueueReceive(queue, &ev, 0) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
-            // if both queues are empty, wait on priority queue for updates (1 tick) then repeat cycle
-        } else if (xQueueReceive(priorityQueue, &ev, 1) == pdTRUE) {
-            // Process event
-            processObjEvent(&ev);
-        }
-#else
-        // wait on queue for updates (1 tick) then repeat cycle
-        if (xQueueReceive(queue, &ev, 1) == pdTRUE) {
-            // Process event
+        if (statsDue) {
+            statsDue = false;
+            updateTelemetryStats();
+        } else if (gcsStatsDue) {
+            gcsStatsDue = false;
+            gcsTelemetryStatsUpdated();
+        } else if (takeObjEvent(priorityObjects, &nextPriorityObject, &ev)
+                   || takeObjEvent(NULL, &nextNormalObject, &ev)) {
             processObjEvent(&ev);
+        } else {
+            // Send the bundled updates once there is nothing more to add to them, then wait for the next event
+            UAVTalkFlushBundle(uavTalkCon);
+            xSemaphoreTake(txSemaphore, portMAX_DELAY);
         }
-#endif /* if defined(PIOS_TELEM_PRIORITY_QUEUE) */
     }
 }
 
@@ -431,15 +646,14 @@ static void telemetryRxTask(__attribute__((unused)) void *parameters)
         uint32_t inputPort = getComPort(true);
 
         if (inputPort) {
-            // Block until data are available
-            uint8_t serial_data[1];
+            // Block until data are available, then parse them in place in the COM fifo
+            const uint8_t *serial_data;
             uint16_t bytes_to_process;
 
-            bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), 500);
+            bytes_to_process = PIOS_COM_ReceiveSpan(inputPort, &serial_data, 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(uavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputBuffer(uavTalkCon, serial_data, bytes_to_process);
+                PIOS_COM_ReceiveRelease(inputPort, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -456,15 +670,14 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
     // Task loop
     while (1) {
         if (radioPort) {
-            // Block until data are available
-            uint8_t serial_data[1];
+            // Block until data are available, then parse them in place in the COM fifo
+            const uint8_t *serial_data;
             uint16_t bytes_to_process;
 
-            bytes_to_process = PIOS_COM_ReceiveBuffer(radioPort, serial_data, sizeof(serial_data), 500);
+            bytes_to_process = PIOS_COM_ReceiveSpan(radioPort, &serial_data, 500);
             if (bytes_to_process > 0) {
-                for (uint8_t i = 0; i < bytes_to_process; i++) {
-                    UAVTalkProcessInputStream(radioUavTalkCon, serial_data[i]);
-                }
+                UAVTalkProcessInputBuffer(radioUavTalkCon, serial_data, bytes_to_process);
+                PIOS_COM_ReceiveRelease(radioPort, bytes_to_process);
             }
         } else {
             vTaskDelay(5);
@@ -524,11 +737,9 @@ static int32_t setUpdatePeriod(UAVObjHandle obj, int32_t updatePeriodMs)
     ev.event  = EV_UPDATED_PERIODIC;
     ev.lowPriority = true;
 
-    xQueueHandle targetQueue = UAVObjIsPriority(obj) ? priorityQueue : queue;
-
-    ret = EventPeriodicQueueUpdate(&ev, targetQueue, updatePeriodMs);
+    ret = EventPeriodicCallbackUpdate(&ev, &postObjEvent, updatePeriodMs);
     if (ret == -1) {
-        ret = EventPeriodicQueueCreate(&ev, targetQueue, updatePeriodMs);
+        ret = EventPeriodicCallbackCreate(&ev, &postObjEvent, updatePeriodMs);
     }
     return ret;
 }
@@ -551,11 +762,9 @@ static int32_t setLoggingPeriod(UAVObjHandle obj, int32_t updatePeriodMs)
     ev.event  = EV_LOGGING_PERIODIC;
     ev.lowPriority = true;
 
-    xQueueHandle targetQueue = UAVObjIsPriority(obj) ? priorityQueue : queue;
-
-    ret = EventPeriodicQueueUpdate(&ev, targetQueue, updatePeriodMs);
+    ret = EventPeriodicCallbackUpdate(&ev, &postObjEvent, updatePeriodMs);
     if (ret == -1) {
-        ret = EventPeriodicQueueCreate(&ev, targetQueue, updatePeriodMs);
+        ret = EventPeriodicCallbackCreate(&ev, &postObjEvent, updatePeriodMs);
     }
     return ret;
 }
@@ -577,6 +786,107 @@ static void gcsTelemetryStatsUpdated()
     }
 }
 
+/**
+ * Called when the GCS sends the objects it has cached on connection,
+ * answer with the CRC of their data so it can skip the unchanged ones.
+ */
+static void objectDataCRCRequested(__attribute__((unused)) UAVObjEvent *ev)
+{
+    static ObjectDataCRCData crcs;
+
+    ObjectDataCRCGet(&crcs);
+    for (uint8_t i = 0; i < OBJECTDATACRC_OBJECTID_NUMELEM; i++) {
+        UAVObjHandle obj = crcs.ObjectID[i] ? UAVObjGetByID(crcs.ObjectID[i]) : 0;
+        uint32_t crc     = 0;
+
+        if (obj) {
+            // starts from all ones, data left at zero does not give 0 as an unknown object does
+            crc = 0xFFFFFFFF;
+            for (uint16_t instId = 0; instId < UAVObjGetNumInstances(obj); instId++) {
+                crc = UAVObjUpdateCRC32(obj, instId, crc);
+            }
+        }
+        crcs.CRC[i] = crc;
+    }
+    ObjectDataCRCSet(&crcs);
+}
+
+#if defined(PIOS_TELEM_HITL_SENSORS)
+/**
+ * Called when the GCS sends the simulated sensor set of a HITL step. Each part
+ * is unpacked into its own object as if that had been received on its own, the
+ * modules get the same events without a transaction per object. The step is
+ * sent back once all parts are handed on.
+ */
+static void hitlSensorsReceived(__attribute__((unused)) UAVObjEvent *ev)
+{
+    static HITLSensorsData frame;
+
+    HITLSensorsGet(&frame);
+
+    if (frame.Updated.Gyro == HITLSENSORS_UPDATED_TRUE) {
+        GyroStateData gyro = { .x = frame.Gyro.X, .y = frame.Gyro.Y, .z = frame.Gyro.Z };
+        UAVObjUnpack(GyroStateHandle(), 0, (uint8_t *)&gyro);
+    }
+    if (frame.Updated.Accel == HITLSENSORS_UPDATED_TRUE) {
+        AccelStateData accel = { .x = frame.Accel.X, .y = frame.Accel.Y, .z = frame.Accel.Z };
+        UAVObjUnpack(AccelStateHandle(), 0, (uint8_t *)&accel);
+    }
+    if (frame.Updated.Attitude == HITLSENSORS_UPDATED_TRUE) {
+        AttitudeStateData attitude = { .q1 = frame.Attitude.q1, .q2 = frame.Attitude.q2, .q3 = frame.Attitude.q3, .q4 = frame.Attitude.q4 };
+        Quaternion2RPY(&attitude.q1, &attitude.Roll);
+        UAVObjUnpack(AttitudeStateHandle(), 0, (uint8_t *)&attitude);
+    }
+    if (frame.Updated.Baro == HITLSENSORS_UPDATED_TRUE) {
+        BaroSensorData baro = { .Altitude = frame.Baro.Altitude, .Temperature = frame.Baro.Temperature, .Pressure = frame.Baro.Pressure };
+        UAVObjUnpack(BaroSensorHandle(), 0, (uint8_t *)&baro);
+    }
+    if (frame.Updated.GPS == HITLSENSORS_UPDATED_TRUE) {
+        // a good 3D fix, as the simulator reported it with the objects
+        GPSPositionSensorData gpsPosition;
+        GPSPositionSensorGet(&gpsPosition);
+        gpsPosition.Status      = GPSPOSITIONSENSOR_STATUS_FIX3D;
+        gpsPosition.Latitude    = frame.GPSPosition.Latitude;
+        gpsPosition.Longitude   = frame.GPSPosition.Longitude;
+        gpsPosition.Altitude    = frame.GPS.Altitude;
+        gpsPosition.Heading     = frame.GPS.Heading;
+        gpsPosition.Groundspeed = frame.GPS.Groundspeed;
+        gpsPosition.GeoidSeparation = 0.0f;
+        gpsPosition.Satellites  = 10;
+        gpsPosition.PDOP = 3.0f;
+        gpsPosition.VDOP = gpsPosition.PDOP * 1.5f;
+        UAVObjUnpack(GPSPositionSensorHandle(), 0, (uint8_t *)&gpsPosition);
+
+        GPSVelocitySensorData gpsVelocity = { .North = frame.GPSVelocity.North, .East = frame.GPSVelocity.East, .Down = frame.GPSVelocity.Down };
+        UAVObjUnpack(GPSVelocitySensorHandle(), 0, (uint8_t *)&gpsVelocity);
+    }
+    if (frame.Updated.Position == HITLSENSORS_UPDATED_TRUE) {
+        PositionStateData position = { .North = frame.Position.North, .East = frame.Position.East, .Down = frame.Position.Down };
+        UAVObjUnpack(PositionStateHandle(), 0, (uint8_t *)&position);
+
+        VelocityStateData velocity = { .North = frame.Velocity.North, .East = frame.Velocity.East, .Down = frame.Velocity.Down };
+        UAVObjUnpack(VelocityStateHandle(), 0, (uint8_t *)&velocity);
+    }
+    if (frame.Updated.Airspeed == HITLSENSORS_UPDATED_TRUE) {
+        AirspeedStateData airspeed;
+        AirspeedStateGet(&airspeed);
+        airspeed.CalibratedAirspeed = frame.Airspeed.Calibrated;
+        airspeed.TrueAirspeed = frame.Airspeed.True;
+        UAVObjUnpack(AirspeedStateHandle(), 0, (uint8_t *)&airspeed);
+    }
+    if (frame.Updated.Battery == HITLSENSORS_UPDATED_TRUE) {
+        FlightBatteryStateData battery;
+        FlightBatteryStateGet(&battery);
+        battery.Voltage = frame.Battery.Voltage;
+        battery.Current = frame.Battery.Current;
+        battery.ConsumedEnergy = frame.Battery.ConsumedEnergy;
+        UAVObjUnpack(FlightBatteryStateHandle(), 0, (uint8_t *)&battery);
+    }
+
+    HITLSensorsAckStepSet(&frame.Step);
+}
+#endif /* PIOS_TELEM_HITL_SENSORS */
+
 /**
  * Update telemetry statistics and handle connection handshake
  */
@@ -605,26 +915,34 @@ static void updateTelemetryStats()
         flightStats.TxBytes      += utalkStats.txBytes;
         flightStats.TxFailures   += txErrors;
         flightStats.TxRetries    += txRetries;
+        flightStats.TxCoalesced  += txCoalesced;
 
         flightStats.RxDataRate    = (float)utalkStats.rxBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
         flightStats.RxBytes      += utalkStats.rxBytes;
         flightStats.RxFailures   += utalkStats.rxErrors;
         flightStats.RxSyncErrors += utalkStats.rxSyncErrors;
         flightStats.RxCrcErrors  += utalkStats.rxCrcErrors;
+
+        flightStats.TxObjectRate  = (float)utalkStats.txObjects / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
     } else {
         flightStats.TxDataRate   = 0;
         flightStats.TxBytes      = 0;
         flightStats.TxFailures   = 0;
         flightStats.TxRetries    = 0;
+        flightStats.TxCoalesced  = 0;
 
         flightStats.RxDataRate   = 0;
         flightStats.RxBytes      = 0;
         flightStats.RxFailures   = 0;
         flightStats.RxSyncErrors = 0;
         flightStats.RxCrcErrors  = 0;
+
+        flightStats.TxObjectRate = 0;
     }
-    txErrors  = 0;
-    txRetries = 0;
+    updateBandwidthBudget(&utalkStats, &flightStats);
+    txErrors    = 0;
+    txRetries   = 0;
+    txCoalesced = 0;
 
     // Check for connection timeout
     timeNow   = xTaskGetTickCount() * portTICK_RATE_MS;
@@ -667,6 +985,12 @@ static void updateTelemetryStats()
         AlarmsClear(SYSTEMALARMS_ALARM_TELEMETRY);
     }
 
+    // Bundle object updates and delta encode periodic ones only if the GCS supports it
+    UAVTalkSetBundling(uavTalkCon, flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED &&
+                       gcsStats.Bundling == GCSTELEMETRYSTATS_BUNDLING_TRUE);
+    UAVTalkSetDeltaEncoding(uavTalkCon, flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED &&
+                            gcsStats.DeltaEncoding == GCSTELEMETRYSTATS_DELTAENCODING_TRUE);
+
     // Update object
     FlightTelemetryStatsSet(&flightStats);
 
@@ -676,6 +1000,120 @@ static void updateTelemetryStats()
     }
 }
 
+/**
+ * Fit the periodic telemetry to the capacity of the link, called with the stats every STATS_UPDATE_PERIOD_MS.
+ * The capacity starts at the nominal rate of the port in use. While sends fail or periodic updates are still
+ * pending at their next period it drops
+ * to the rate the link actually carried, otherwise it is probed up again by a quarter per period. The update
+ * periods of the non priority objects are then scaled so that the demand at the metadata periods fits
+ * BUDGET_PERCENT of it, the rest being left to the priority objects, acks and on change updates.
+ */
+static void updateBandwidthBudget(UAVTalkStats *utalkStats, FlightTelemetryStatsData *flightStats)
+{
+    uint32_t port    = getComPort(false);
+    uint32_t txRate  = utalkStats->txBytes * 1000 / STATS_UPDATE_PERIOD_MS;
+    uint32_t nominal = telemetryBytesPerSec;
+    bool congested   = txErrors > 0 || periodicCoalesced > 0;
+
+    periodicCoalesced = 0;
+
+#if defined(PIOS_INCLUDE_USB)
+    if (port == PIOS_COM_TELEM_USB) {
+        nominal = USB_BYTES_PER_SEC;
+    }
+#endif
+#ifdef PIOS_INCLUDE_RFM22B
+    if (port == PIOS_COM_RF) {
+        // The radio rate depends on the modem settings, probe it from the USB rate down
+        nominal = USB_BYTES_PER_SEC;
+    }
+#endif
+    if (port != linkPort) {
+        // Another link took over, start again from its nominal rate
+        linkPort     = port;
+        linkCapacity = nominal;
+    } else if (congested) {
+        linkCapacity = MAX(txRate, MIN_CAPACITY_BYTES_PER_SEC);
+    } else {
+        linkCapacity = MIN(linkCapacity + linkCapacity / 4, nominal);
+    }
+
+    // Bytes per second of the periodic updates at their metadata periods
+    demandPriority = 0;
+    demandNormal   = 0;
+    UAVObjIterate(&addObjectDemand);
+
+    float scale = 1.0f;
+    if (rateScaling != HWSETTINGS_TELEMETRYRATESCALING_FIXED && port) {
+        int32_t budget = (int32_t)(linkCapacity * BUDGET_PERCENT / 100) - (int32_t)demandPriority;
+        scale = (budget > 0) ? (float)demandNormal / (float)budget : MAX_PERIOD_SCALE;
+        scale = boundf(scale, (rateScaling == HWSETTINGS_TELEMETRYRATESCALING_FILL) ? MIN_PERIOD_SCALE : 1.0f, MAX_PERIOD_SCALE);
+    }
+
+    // Only move the periodic events when the rates change noticeably
+    if (scale > periodScale * 1.1f || scale < periodScale * 0.9f || (scale == 1.0f && periodScale != 1.0f)) {
+        periodScale = scale;
+        UAVObjIterate(&applyScaledPeriod);
+    }
+
+    flightStats->TxCapacity  = linkCapacity;
+    flightStats->PeriodScale = periodScale;
+}
+
+/**
+ * Add the periodic telemetry of an object to the demand of its priority class
+ */
+static void addObjectDemand(UAVObjHandle obj)
+{
+    UAVObjMetadata metadata;
+
+    if (UAVObjIsMetaobject(obj)) {
+        return;
+    }
+    UAVObjGetMetadata(obj, &metadata);
+    if (UAVObjGetTelemetryUpdateMode(&metadata) != UPDATEMODE_PERIODIC || metadata.telemetryUpdatePeriod == 0) {
+        return;
+    }
+
+    uint32_t bytes = (UAVObjGetNumBytes(obj) + FRAME_OVERHEAD_BYTES) * UAVObjGetNumInstances(obj);
+    if (UAVObjIsPriority(obj)) {
+        demandPriority += bytes * 1000 / metadata.telemetryUpdatePeriod;
+    } else {
+        demandNormal   += bytes * 1000 / metadata.telemetryUpdatePeriod;
+    }
+}
+
+/**
+ * Move the periodic event of an object to its scaled update period
+ */
+static void applyScaledPeriod(UAVObjHandle obj)
+{
+    UAVObjMetadata metadata;
+    UAVObjUpdateMode updateMode;
+
+    if (UAVObjIsMetaobject(obj) || UAVObjIsPriority(obj)) {
+        return;
+    }
+    UAVObjGetMetadata(obj, &metadata);
+    updateMode = UAVObjGetTelemetryUpdateMode(&metadata);
+    if (updateMode == UPDATEMODE_PERIODIC || updateMode == UPDATEMODE_THROTTLED) {
+        setUpdatePeriod(obj, scaledUpdatePeriod(obj, metadata.telemetryUpdatePeriod));
+    }
+}
+
+/**
+ * Telemetry update period of an object once the bandwidth budget is applied,
+ * priority objects and disabled periodic updates are left alone
+ */
+static uint16_t scaledUpdatePeriod(UAVObjHandle obj, uint16_t updatePeriodMs)
+{
+    if (updatePeriodMs == 0 || periodScale == 1.0f || UAVObjIsPriority(obj)) {
+        return updatePeriodMs;
+    }
+    float period = (float)updatePeriodMs * periodScale;
+    return (uint16_t)boundf(period, MIN(MIN_SCALED_PERIOD_MS, updatePeriodMs), 65535.0f);
+}
+
 /**
  * Update the telemetry settings, called on startup.
  * FIXME: This should be in the TelemetrySettings object. But objects
@@ -685,6 +1123,8 @@ static void updateTelemetryStats()
  */
 static void updateSettings()
 {
+    HwSettingsTelemetryRateScalingGet(&rateScaling);
+
     if (telemetryPort) {
         // Retrieve settings
         uint8_t speed;
@@ -694,24 +1134,31 @@ static void updateSettings()
         switch (speed) {
         case HWSETTINGS_TELEMETRYSPEED_2400:
             PIOS_COM_ChangeBaud(telemetryPort, 2400);
+            telemetryBytesPerSec = 2400 / 10;
             break;
         case HWSETTINGS_TELEMETRYSPEED_4800:
             PIOS_COM_ChangeBaud(telemetryPort, 4800);
+            telemetryBytesPerSec = 4800 / 10;
             break;
         case HWSETTINGS_TELEMETRYSPEED_9600:
             PIOS_COM_ChangeBaud(telemetryPort, 9600);
+            telemetryBytesPerSec = 9600 / 10;
             break;
         case HWSETTINGS_TELEMETRYSPEED_19200:
             PIOS_COM_ChangeBaud(telemetryPort, 19200);
+            telemetryBytesPerSec = 19200 / 10;
             break;
         case HWSETTINGS_TELEMETRYSPEED_38400:
             PIOS_COM_ChangeBaud(telemetryPort, 38400);
+            telemetryBytesPerSec = 38400 / 10;
             break;
         case HWSETTINGS_TELEMETRYSPEED_57600:
             PIOS_COM_ChangeBaud(telemetryPort, 57600);
+            telemetryBytesPerSec = 57600 / 10;
             break;
         case HWSETTINGS_TELEMETRYSPEED_115200:
             PIOS_COM_ChangeBaud(telemetryPort, 115200);
+            telemetryBytesPerSec = 115200 / 10;
             break;
         }
     }
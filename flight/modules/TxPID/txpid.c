@@ -35,7 +35,9 @@
  *
  * This module will periodically update values of stabilization PID settings
  * depending on configured input control channels. New values of stabilization
- * settings are not saved to flash, but updated in RAM. It is expected that the
+ * settings are not saved to flash, but updated in RAM. While armed the tuned
+ * gains only go to the active StabilizationBank, the settings bank is written
+ * back once disarmed. It is expected that the
  * module will be enabled only for tuning. When desired values are found, they
  * can be read via GCS and saved permanently. Then this module should be
  * disabled again.
@@ -65,7 +67,8 @@
 //
 // Configuration
 //
-#define SAMPLE_PERIOD_MS           200
+#define SAMPLE_PERIOD_MS           50
+#define PERSIST_PERIOD_MS          200 // settings bank update rate while disarmed
 #define TELEMETRY_UPDATE_PERIOD_MS 0 // 0 = update on change (default)
 
 // Sanity checks
@@ -78,9 +81,22 @@
 // Private types
 
 // Private variables
+static TxPIDSettingsData inst;
+// tuned copy of the selected settings bank
+static StabilizationBankData bank;
+static volatile bool settingsUpdated = true;
+static volatile bool bankUpdated     = true;
+// bank holds gains not written back to the settings bank yet
+static bool bankPending = false;
+static uint8_t persistCounter = 0;
 
 // Private functions
 static void updatePIDs(UAVObjEvent *ev);
+static void settingsUpdatedCb(UAVObjEvent *ev);
+static void bankUpdatedCb(UAVObjEvent *ev);
+static bool loadBank();
+static void persistBank();
+static void pushActiveBank();
 static uint8_t update(float *var, float val);
 static uint8_t updateUint8(uint8_t *var, float val);
 static uint8_t updateInt8(int8_t *var, float val);
@@ -107,6 +123,16 @@ int32_t TxPIDInitialize(void)
     if (txPIDEnabled) {
         TxPIDSettingsInitialize();
         AccessoryDesiredInitialize();
+        StabilizationSettingsInitialize();
+        StabilizationBankInitialize();
+        StabilizationSettingsBank1Initialize();
+        StabilizationSettingsBank2Initialize();
+        StabilizationSettingsBank3Initialize();
+
+        TxPIDSettingsConnectCallback(settingsUpdatedCb);
+        StabilizationSettingsBank1ConnectCallback(bankUpdatedCb);
+        StabilizationSettingsBank2ConnectCallback(bankUpdatedCb);
+        StabilizationSettingsBank3ConnectCallback(bankUpdatedCb);
 
         UAVObjEvent ev = {
             .obj    = AccessoryDesiredHandle(),
@@ -155,43 +181,45 @@ static void updatePIDs(UAVObjEvent *ev)
         return;
     }
 
-    TxPIDSettingsData inst;
-    TxPIDSettingsGet(&inst);
+    if (settingsUpdated) {
+        settingsUpdated = false;
+        // gains tuned for the previous bank go to that bank
+        if (bankPending) {
+            persistBank();
+        }
+        TxPIDSettingsGet(&inst);
+        // the bank number may have changed
+        bankUpdated     = true;
+    }
 
     if (inst.UpdateMode == TXPIDSETTINGS_UPDATEMODE_NEVER) {
         return;
     }
 
+    // tuned gains take precedence over changes to the settings bank
+    if (bankUpdated && !bankPending) {
+        if (!loadBank()) {
+            return;
+        }
+        bankUpdated = false;
+    }
+
     uint8_t armed;
     FlightStatusArmedGet(&armed);
     if ((inst.UpdateMode == TXPIDSETTINGS_UPDATEMODE_WHENARMED) &&
         (armed == FLIGHTSTATUS_ARMED_DISARMED)) {
+        if (bankPending) {
+            persistBank();
+        }
         return;
     }
 
-    StabilizationBankData bank;
-    switch (inst.BankNumber) {
-    case 0:
-        StabilizationSettingsBank1Get((StabilizationSettingsBank1Data *)&bank);
-        break;
-
-    case 1:
-        StabilizationSettingsBank2Get((StabilizationSettingsBank2Data *)&bank);
-        break;
-
-    case 2:
-        StabilizationSettingsBank3Get((StabilizationSettingsBank3Data *)&bank);
-        break;
-
-    default:
-        return;
-    }
-    StabilizationSettingsData stab;
-    StabilizationSettingsGet(&stab);
     AccessoryDesiredData accessory;
 
     uint8_t needsUpdateBank = 0;
     uint8_t needsUpdateStab = 0;
+    float gyroTau;
+    StabilizationSettingsGyroTauGet(&gyroTau);
 
     // Loop through every enabled instance
     for (uint8_t i = 0; i < TXPIDSETTINGS_PIDS_NUMELEM; i++) {
@@ -346,7 +374,7 @@ static void updatePIDs(UAVObjEvent *ev)
                 needsUpdateBank |= updateInt8(&bank.StickExpo.Yaw, value);
                 break;
             case TXPIDSETTINGS_PIDS_GYROTAU:
-                needsUpdateStab |= update(&stab.GyroTau, value);
+                needsUpdateStab |= update(&gyroTau, value);
                 break;
             case TXPIDSETTINGS_PIDS_ACROPLUSFACTOR:
                 needsUpdateBank |= update(&bank.AcroInsanityFactor, value);
@@ -357,25 +385,99 @@ static void updatePIDs(UAVObjEvent *ev)
         }
     }
     if (needsUpdateStab) {
-        StabilizationSettingsSet(&stab);
+        StabilizationSettingsGyroTauSet(&gyroTau);
     }
     if (needsUpdateBank) {
-        switch (inst.BankNumber) {
-        case 0:
-            StabilizationSettingsBank1Set((StabilizationSettingsBank1Data *)&bank);
-            break;
+        bankPending = true;
+    }
 
-        case 1:
-            StabilizationSettingsBank2Set((StabilizationSettingsBank2Data *)&bank);
-            break;
+    if (armed != FLIGHTSTATUS_ARMED_DISARMED) {
+        // the stabilization loop picks the gains up from the active bank
+        pushActiveBank();
+    } else if (bankPending && ++persistCounter >= PERSIST_PERIOD_MS / SAMPLE_PERIOD_MS) {
+        persistBank();
+    }
+}
 
-        case 2:
-            StabilizationSettingsBank3Set((StabilizationSettingsBank3Data *)&bank);
-            break;
+static void settingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    settingsUpdated = true;
+}
 
-        default:
-            return;
-        }
+static void bankUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    bankUpdated = true;
+}
+
+/**
+ * Reads the settings bank selected in TxPIDSettings into bank
+ * \returns false if the bank number is invalid
+ */
+static bool loadBank()
+{
+    switch (inst.BankNumber) {
+    case 0:
+        StabilizationSettingsBank1Get((StabilizationSettingsBank1Data *)&bank);
+        break;
+
+    case 1:
+        StabilizationSettingsBank2Get((StabilizationSettingsBank2Data *)&bank);
+        break;
+
+    case 2:
+        StabilizationSettingsBank3Get((StabilizationSettingsBank3Data *)&bank);
+        break;
+
+    default:
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Writes the tuned gains back to the settings bank
+ */
+static void persistBank()
+{
+    persistCounter = 0;
+    bankPending    = false;
+    switch (inst.BankNumber) {
+    case 0:
+        StabilizationSettingsBank1Set((StabilizationSettingsBank1Data *)&bank);
+        break;
+
+    case 1:
+        StabilizationSettingsBank2Set((StabilizationSettingsBank2Data *)&bank);
+        break;
+
+    case 2:
+        StabilizationSettingsBank3Set((StabilizationSettingsBank3Data *)&bank);
+        break;
+    }
+}
+
+/**
+ * Hands the tuned gains to the stabilization loop if the tuned bank is the
+ * one in use. StabilizationBank is not acked and only sent periodically,
+ * and it is written in one piece so all gains change at once.
+ * Stabilization reloads it from the settings bank on a flight mode change,
+ * it is compared on every run to restore the tuned gains after that.
+ */
+static void pushActiveBank()
+{
+    uint8_t flightModeMap[STABILIZATIONSETTINGS_FLIGHTMODEMAP_NUMELEM];
+    uint8_t position;
+
+    ManualControlCommandFlightModeSwitchPositionGet(&position);
+    StabilizationSettingsFlightModeMapGet(flightModeMap);
+    if (position >= STABILIZATIONSETTINGS_FLIGHTMODEMAP_NUMELEM || flightModeMap[position] != inst.BankNumber) {
+        return;
+    }
+
+    StabilizationBankData active;
+    StabilizationBankGet(&active);
+    if (memcmp(&active, &bank, sizeof(bank)) != 0) {
+        StabilizationBankSet(&bank);
     }
 }
 
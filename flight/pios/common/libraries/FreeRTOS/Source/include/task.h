@@ -1108,6 +1108,13 @@ char *pcTaskGetTaskName( TaskHandle_t xTaskToQuery ) PRIVILEGED_FUNCTION; /*lint
  */
 UBaseType_t uxTaskGetStackHighWaterMark( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
 
+/* Same as uxTaskGetStackHighWaterMark(), but updates a mark returned by a
+ * previous call. Unless xFullScan is set only the words just below the previous
+ * mark are checked, a deeper use of the stack which left a gap of untouched
+ * words is only seen by the next full scan. The stack is compared a word at a
+ * time. */
+UBaseType_t uxTaskUpdateStackHighWaterMark( TaskHandle_t xTask, UBaseType_t uxPreviousMark, BaseType_t xFullScan ) PRIVILEGED_FUNCTION;
+
 /* When using trace macros it is sometimes necessary to include task.h before
 FreeRTOS.h.  When this is done TaskHookFunction_t will not yet have been defined,
 so the following two prototypes will cause a compilation error.  This can be
@@ -1553,6 +1560,9 @@ void vTaskStepTick( const TickType_t xTicksToJump ) PRIVILEGED_FUNCTION;
 eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
 
 UBaseType_t uxTaskGetRunTime( TaskHandle_t xTask );
+/* Same as uxTaskGetRunTime(), also returns and resets the longest single
+ * run time slice and the number of times the task was switched in. */
+UBaseType_t uxTaskGetRunTimeInfo( TaskHandle_t xTask, uint32_t *pulMaxRunTimeSlice, uint32_t *pulSwitchInCount );
 #ifdef __cplusplus
 }
 #endif
@@ -178,12 +178,18 @@ static void prvPortYield();
  * Exception handlers.
  */
 void vPortYield( void );
-void vPortSystemTickHandler( void );
+portBASE_TYPE vPortSystemTickHandler( void );
 
 /*
  * Start first task is a separate function so it can be tested in isolation.
  */
 void vPortStartFirstTask( void );
+
+/*
+ * Lock step: the ticks are granted by an external clock instead of the wall clock.
+ */
+static void ( *pxLockStepTickSource )( void ) = NULL;
+static void prvWaitForIdle( void );
 /*-----------------------------------------------------------*/
 
 /**
@@ -291,6 +297,20 @@ portBASE_TYPE xPortStartScheduler( void )
 	/* Start the first task. This gives up the RunningThreadMutex*/
 	vPortStartFirstTask();
 
+	/**
+	 * Lock step loop. The tick source blocks until the next tick is granted,
+	 * each tick is counted and the tasks run until only the idle task is left
+	 */
+	while ( pdTRUE != xSchedulerEnd && NULL != pxLockStepTickSource )
+	{
+		pxLockStepTickSource();
+
+		/* a tick may not be counted while a task is in a critical section */
+		while ( pdTRUE != vPortSystemTickHandler() ) sched_yield();
+
+		prvWaitForIdle();
+	}
+
 	/**
 	 * Main scheduling loop. Call the tick handler every
 	 * portTICK_RATE_MICROSECONDS
@@ -346,6 +366,37 @@ portBASE_TYPE xPortStartScheduler( void )
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * Hands the ticks over to an external clock, has to be called before the scheduler starts.
+ * pxTickSource is called from the supervisor thread and returns when the next tick is due.
+ */
+void vPortSetLockStepTickSource( void ( *pxTickSource )( void ) )
+{
+	pxLockStepTickSource = pxTickSource;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Waits until the tasks woken by the last tick are done, a task that does not give up
+ * the cpu within a few wall clock ticks is preempted by the next tick
+ */
+static void prvWaitForIdle( void )
+{
+struct timeval xStart, xNow;
+	gettimeofday( &xStart, NULL );
+	do
+	{
+		if ( xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle()
+			&& prvGetThreadHandle( xTaskGetCurrentTaskHandle() )->threadStatus == THREAD_RUNNING )
+		{
+			return;
+		}
+		sched_yield();
+		gettimeofday( &xNow, NULL );
+	} while ( 1000000 * ( xNow.tv_sec - xStart.tv_sec ) + ( xNow.tv_usec - xStart.tv_usec ) < 10 * portTICK_RATE_MICROSECONDS );
+}
+/*-----------------------------------------------------------*/
+
 /**
  * quickly clean up all running threads, without asking them first
  */
@@ -583,8 +634,9 @@ void vPortClearInterruptMask( portBASE_TYPE xMask )
 
 /**
  * the tick handler is just an ordinary function, called by the supervisor thread periodically
+ * returns pdFALSE if the tick could not be counted
  */
-void vPortSystemTickHandler()
+portBASE_TYPE vPortSystemTickHandler()
 {
 	/**
 	 * the problem with the tick handler is, that it runs outside of the schedulers domain - worse,
@@ -597,14 +649,14 @@ void vPortSystemTickHandler()
 	if ( prvGetThreadHandle(xTaskGetCurrentTaskHandle())->threadStatus!=THREAD_RUNNING ) {
 		xPendYield = pdTRUE;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* interrupts MUST be enabled */
 	if ( xInterruptsEnabled != pdTRUE ) {
 		xPendYield = pdTRUE;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* this should always be true, but it can't harm to check */
@@ -670,6 +722,8 @@ void vPortSystemTickHandler()
 
 	/* finish up */
 	PORT_UNLOCK( xGuardMutex );
+
+	return pdTRUE;
 }
 /*-----------------------------------------------------------*/
 
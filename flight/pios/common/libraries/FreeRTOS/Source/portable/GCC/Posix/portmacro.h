@@ -161,6 +161,9 @@ extern void vPortAddTaskHandle( void *pxTaskHandle );
 /* Posix Signal definitions that can be changed or read as appropriate. */
 #define SIG_SUSPEND					SIGUSR1
 
+/* Lock step simulation, the ticks are granted by pxTickSource instead of the wall clock. */
+extern void vPortSetLockStepTickSource( void ( *pxTickSource )( void ) );
+
 /* Make use of times(man 2) to gather run-time statistics on the tasks. */
 extern void vPortFindTicksPerSecond( void );
 #undef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
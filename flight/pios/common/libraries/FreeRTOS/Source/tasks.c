@@ -154,6 +154,8 @@ typedef struct tskTaskControlBlock
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 		uint32_t		ulRunTimeCounter;	/*< Stores the amount of time the task has spent in the Running state. */
+		uint32_t		ulMaxRunTimeSlice;	/*< Stores the longest time the task has stayed in the Running state at once. */
+		uint32_t		ulSwitchInCount;	/*< Stores the number of times the task has been switched in. */
 	#endif
 
 	#if ( configUSE_NEWLIB_REENTRANT == 1 )
@@ -1827,6 +1829,24 @@ UBaseType_t uxTaskGetNumberOfTasks( void )
         return runTime;
     }
 
+    UBaseType_t uxTaskGetRunTimeInfo( TaskHandle_t xTask, uint32_t *pulMaxRunTimeSlice, uint32_t *pulSwitchInCount )
+    {
+        unsigned long runTime;
+
+        tskTCB *pxTCB;
+        pxTCB = prvGetTCBFromHandle( xTask );
+        /* the counters are updated by the context switch, read and reset them together */
+        taskENTER_CRITICAL();
+        runTime = pxTCB->ulRunTimeCounter;
+        *pulMaxRunTimeSlice = pxTCB->ulMaxRunTimeSlice;
+        *pulSwitchInCount = pxTCB->ulSwitchInCount;
+        pxTCB->ulRunTimeCounter = 0;
+        pxTCB->ulMaxRunTimeSlice = 0;
+        pxTCB->ulSwitchInCount = 0;
+        taskEXIT_CRITICAL();
+        return runTime;
+    }
+
 #endif
 
 #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
@@ -2155,7 +2175,12 @@ void vTaskSwitchContext( void )
 				are provided by the application, not the kernel. */
 				if( ulTotalRunTime > ulTaskSwitchedInTime )
 				{
-					pxCurrentTCB->ulRunTimeCounter += ( ulTotalRunTime - ulTaskSwitchedInTime );
+					uint32_t ulSlice = ulTotalRunTime - ulTaskSwitchedInTime;
+					pxCurrentTCB->ulRunTimeCounter += ulSlice;
+					if( ulSlice > pxCurrentTCB->ulMaxRunTimeSlice )
+					{
+						pxCurrentTCB->ulMaxRunTimeSlice = ulSlice;
+					}
 				}
 				else
 				{
@@ -2168,7 +2193,23 @@ void vTaskSwitchContext( void )
 		taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 
-		taskSELECT_HIGHEST_PRIORITY_TASK();
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		{
+			TCB_t * const pxPreviousTCB = pxCurrentTCB;
+
+			taskSELECT_HIGHEST_PRIORITY_TASK();
+
+			/* Only count real switches, a yield may select the same task again. */
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				pxCurrentTCB->ulSwitchInCount++;
+			}
+		}
+		#else
+		{
+			taskSELECT_HIGHEST_PRIORITY_TASK();
+		}
+		#endif /* configGENERATE_RUN_TIME_STATS */
 
 		traceTASK_SWITCHED_IN();
 
@@ -2781,6 +2822,8 @@ UBaseType_t x;
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		pxTCB->ulRunTimeCounter = 0UL;
+		pxTCB->ulMaxRunTimeSlice = 0UL;
+		pxTCB->ulSwitchInCount = 0UL;
 	}
 	#endif /* configGENERATE_RUN_TIME_STATS */
 
@@ -3089,6 +3132,49 @@ TCB_t *pxNewTCB;
 		return uxReturn;
 	}
 
+	UBaseType_t uxTaskUpdateStackHighWaterMark( TaskHandle_t xTask, UBaseType_t uxPreviousMark, BaseType_t xFullScan )
+	{
+	TCB_t *pxTCB;
+	UBaseType_t uxReturn;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		#if portSTACK_GROWTH < 0
+		{
+		/* the fill byte repeated in every byte of a stack word */
+		const StackType_t xFillWord = ( ( StackType_t ) ~( StackType_t ) 0 / 0xffU ) * tskSTACK_FILL_BYTE;
+		const StackType_t *pxStack = pxTCB->pxStack;
+
+			if( xFullScan != pdFALSE )
+			{
+				uxReturn = 0;
+				while( pxStack[ uxReturn ] == xFillWord )
+				{
+					uxReturn++;
+				}
+			}
+			else
+			{
+				/* The used part grows down from the previous mark, only the
+				words it has taken since then are visited. */
+				uxReturn = uxPreviousMark;
+				while( ( uxReturn > 0 ) && ( pxStack[ uxReturn - 1 ] != xFillWord ) )
+				{
+					uxReturn--;
+				}
+			}
+		}
+		#else
+		{
+			( void ) uxPreviousMark;
+			( void ) xFullScan;
+			uxReturn = ( UBaseType_t ) prvTaskCheckFreeStackSpace( ( uint8_t * ) pxTCB->pxEndOfStack );
+		}
+		#endif
+
+		return uxReturn;
+	}
+
 #endif /* INCLUDE_uxTaskGetStackHighWaterMark */
 /*-----------------------------------------------------------*/
 
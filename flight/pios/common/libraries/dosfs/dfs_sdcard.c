@@ -87,11 +87,16 @@ uint32_t DFS_ReadSector(uint8_t unit, uint8_t *buffer, uint32_t sector, uint32_t
 		return 1;
 	}
 
-	/* According to README.txt, count is always 1 - check this! */
-	if(count != 1) {
+	/* DFS_ReadFile() reads up to one cluster at once */
+	if(count == 0) {
 		return 2;
 	}
 
+	if(count > 1) {
+		last_sector = 0xffffffff;
+		return PIOS_SDCARD_SectorsRead(sector, buffer, count) ? 3 : 0;
+	}
+
 	/* Cache: */
 	if(caching_enabled && sector == last_sector) {
 		/* we assume that sector is already in *buffer */
@@ -124,8 +129,8 @@ uint32_t DFS_WriteSector(uint8_t unit, uint8_t *buffer, uint32_t sector, uint32_
 		return 1;
 	}
 
-	/* According to README.txt, count is always 1 - check this! */
-	if(count != 1) {
+	/* DFS_WriteFile() writes up to one cluster at once */
+	if(count == 0) {
 		return 2;
 	}
 
@@ -134,7 +139,7 @@ uint32_t DFS_WriteSector(uint8_t unit, uint8_t *buffer, uint32_t sector, uint32_
 
 	/* Forward to PIOS */
 	int32_t status;
-	if((status = PIOS_SDCARD_SectorWrite(sector, buffer)) < 0) {
+	if((status = PIOS_SDCARD_SectorsWrite(sector, buffer, count)) < 0) {
 		/* Cannot access SD Card */
 		return 3;
 	}
@@ -992,12 +992,18 @@ uint32_t DFS_ReadFile(PFILEINFO fileinfo, uint8_t *scratch, uint8_t *buffer, uin
                         // be advantageous to have code similar to case 1A above that would round the
                         // pointer to a cluster boundary the first pass through, so all subsequent
                         // [large] read requests would be able to go a cluster at a time).
+                        // TK: all whole sectors up to the end of the cluster are read at once
                         if (remain >= SECTOR_SIZE) {
-                                result = DFS_ReadSector(fileinfo->volinfo->unit, buffer, sector, 1);
-                                remain -= SECTOR_SIZE;
-                                buffer += SECTOR_SIZE;
-                                fileinfo->pointer += SECTOR_SIZE;
-                                bytesread = SECTOR_SIZE;
+                                uint32_t count = fileinfo->volinfo->secperclus -
+                                  div(div(fileinfo->pointer,fileinfo->volinfo->secperclus * SECTOR_SIZE).rem, SECTOR_SIZE).quot;
+                                if (count > remain / SECTOR_SIZE)
+                                        count = remain / SECTOR_SIZE;
+
+                                result = DFS_ReadSector(fileinfo->volinfo->unit, buffer, sector, count);
+                                remain -= count * SECTOR_SIZE;
+                                buffer += count * SECTOR_SIZE;
+                                fileinfo->pointer += count * SECTOR_SIZE;
+                                bytesread = count * SECTOR_SIZE;
                         }
                         // Case 2B - We are only reading a partial sector
                         else {
@@ -1228,15 +1234,21 @@ uint32_t DFS_WriteFile(PFILEINFO fileinfo, uint8_t *scratch, uint8_t *buffer, ui
                         // to go through the scratch buffer. You could insert optimizations here to
                         // write multiple sectors at a time, if you were thus inclined. Refer to
                         // similar notes in DFS_ReadFile.
+                        // TK: all whole sectors up to the end of the cluster are written at once
                         if (remain >= SECTOR_SIZE) {
-                                result = DFS_WriteSector(fileinfo->volinfo->unit, buffer, sector, 1);
-                                remain -= SECTOR_SIZE;
-                                buffer += SECTOR_SIZE;
-                                fileinfo->pointer += SECTOR_SIZE;
+                                uint32_t count = fileinfo->volinfo->secperclus -
+                                  div(div(fileinfo->pointer,fileinfo->volinfo->secperclus * SECTOR_SIZE).rem, SECTOR_SIZE).quot;
+                                if (count > remain / SECTOR_SIZE)
+                                        count = remain / SECTOR_SIZE;
+
+                                result = DFS_WriteSector(fileinfo->volinfo->unit, buffer, sector, count);
+                                remain -= count * SECTOR_SIZE;
+                                buffer += count * SECTOR_SIZE;
+                                fileinfo->pointer += count * SECTOR_SIZE;
                                 if (fileinfo->filelen < fileinfo->pointer) {
                                         fileinfo->filelen = fileinfo->pointer;
                                 }
-                                byteswritten = SECTOR_SIZE;
+                                byteswritten = count * SECTOR_SIZE;
                         }
                         // Case 2B - We are only writing a partial sector and potentially need to
                         // go through the scratch buffer.
@@ -36,6 +36,7 @@
 #define STACK_SIZE        (190 + STACK_SAFETYSIZE)
 #define STACK_SAFETYSIZE  8
 #define MAX_SLEEP         1000
+#define TIMERHEAP_GROWTH  8
 
 // Private types
 /**
@@ -43,7 +44,15 @@
  */
 struct DelayedCallbackTaskStruct {
     DelayedCallbackInfo *callbackQueue[CALLBACK_PRIORITY_LOW + 1];
-    DelayedCallbackInfo *queueCursor[CALLBACK_PRIORITY_LOW + 1];
+    // dispatched callbacks in dispatch order, guarded by masking interrupts since ISRs dispatch too
+    DelayedCallbackInfo *readyHead[CALLBACK_PRIORITY_LOW + 1];
+    DelayedCallbackInfo *readyTail[CALLBACK_PRIORITY_LOW + 1];
+    uint16_t callbackCount[CALLBACK_PRIORITY_LOW + 1];
+    uint16_t roundCount[CALLBACK_PRIORITY_LOW + 1];
+    // scheduled callbacks, a binary min heap on scheduletime guarded by the mutex
+    DelayedCallbackInfo **timerHeap;
+    uint16_t    timerCount;
+    uint16_t    timerSize;
     xTaskHandle callbackSchedulerTaskHandle;
     char name[3];
     uint32_t    stackSize;
@@ -58,8 +67,14 @@ struct DelayedCallbackTaskStruct {
 struct DelayedCallbackInfoStruct {
     DelayedCallback   cb;
     int16_t callbackID;
+    DelayedCallbackPriority priority;
     bool volatile     waiting;
     uint32_t volatile scheduletime;
+    int16_t  timerIndex; // position in the timer heap, -1 if not in there
+    uint32_t readyTime; // PIOS_DELAY raw time the callback was made ready
+    uint32_t maxLatency; // longest time from ready to invocation in us
+    uint32_t runTime; // time spent in the callback since the last report in us
+    uint32_t maxRunTime; // longest single execution since the last report in us
     uint32_t stackSize;
     int32_t  stackFree;
     int32_t  stackNotFree;
@@ -68,6 +83,7 @@ struct DelayedCallbackInfoStruct {
     uint32_t runCount;
     struct DelayedCallbackTaskStruct *task;
     struct DelayedCallbackInfoStruct *next;
+    struct DelayedCallbackInfoStruct *readyNext;
 };
 
 
@@ -75,10 +91,15 @@ struct DelayedCallbackInfoStruct {
 static struct DelayedCallbackTaskStruct *schedulerTasks;
 static xSemaphoreHandle mutex;
 static bool schedulerStarted;
+static uint32_t lastReportTime;
 
 // Private functions
 static void CallbackSchedulerTask(void *task);
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority);
+static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task);
+static void makeReady(DelayedCallbackInfo *cbinfo);
+static void timerInsert(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo);
+static void timerRemove(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo);
+static void timerUpdate(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo);
 
 /**
  * Initialize the scheduler
@@ -136,6 +157,7 @@ int32_t PIOS_CALLBACKSCHEDULER_Start()
         t++;
     }
 
+    lastReportTime   = PIOS_DELAY_GetRaw();
     schedulerStarted = true;
 
     xSemaphoreGiveRecursive(mutex);
@@ -187,6 +209,11 @@ int32_t PIOS_CALLBACKSCHEDULER_Schedule(
             result = 2;
         }
         cbinfo->scheduletime = new;
+        if (cbinfo->timerIndex < 0) {
+            timerInsert(cbinfo->task, cbinfo);
+        } else {
+            timerUpdate(cbinfo->task, cbinfo);
+        }
 
         // scheduler needs to be notified to adapt sleep times
         xSemaphoreGive(cbinfo->task->signal);
@@ -207,8 +234,8 @@ int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
 {
     PIOS_Assert(cbinfo);
 
-    // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    // no semaphore needed for the callback, only the ready list needs protection against ISRs
+    makeReady(cbinfo);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGive(cbinfo->task->signal);
 }
@@ -232,7 +259,7 @@ int32_t PIOS_CALLBACKSCHEDULER_DispatchFromISR(DelayedCallbackInfo *cbinfo, long
     PIOS_Assert(cbinfo);
 
     // no semaphore needed for the callback
-    cbinfo->waiting = true;
+    makeReady(cbinfo);
     // but the scheduler as a whole needs to be notified
     return xSemaphoreGiveFromISR(cbinfo->task->signal, pxHigherPriorityTaskWoken);
 }
@@ -273,7 +300,7 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
     // if given priorityTask does not exist, create it
     if (!task) {
         // allocate memory if possible
-        task = (struct DelayedCallbackTaskStruct *)pios_malloc(sizeof(struct DelayedCallbackTaskStruct));
+        task = (struct DelayedCallbackTaskStruct *)pios_malloc_tagged(sizeof(struct DelayedCallbackTaskStruct), PIOS_MEM_TAG_CALLBACK);
         if (!task) {
             xSemaphoreGiveRecursive(mutex);
             return NULL;
@@ -282,8 +309,14 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
         // initialize structure
         for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
             task->callbackQueue[p] = NULL;
-            task->queueCursor[p]   = NULL;
+            task->readyHead[p]     = NULL;
+            task->readyTail[p]     = NULL;
+            task->callbackCount[p] = 0;
+            task->roundCount[p]    = 0;
         }
+        task->timerHeap    = NULL;
+        task->timerCount   = 0;
+        task->timerSize    = 0;
         task->name[0]      = 'C';
         task->name[1]      = 'a' + t;
         task->name[2]      = 0;
@@ -328,15 +361,43 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
         return NULL; // error - not enough memory
     }
 
+    // make room for this callback in the timer heap, so scheduling never allocates
+    uint16_t callbackCount = 0;
+    for (DelayedCallbackPriority p = 0; p <= CALLBACK_PRIORITY_LOW; p++) {
+        callbackCount += task->callbackCount[p];
+    }
+    if (callbackCount >= task->timerSize) {
+        DelayedCallbackInfo **heap = (DelayedCallbackInfo **)pios_malloc((task->timerSize + TIMERHEAP_GROWTH) * sizeof(DelayedCallbackInfo *));
+        if (!heap) {
+            xSemaphoreGiveRecursive(mutex);
+            return NULL; // error - not enough memory
+        }
+        for (uint16_t i = 0; i < task->timerCount; i++) {
+            heap[i] = task->timerHeap[i];
+        }
+        if (task->timerHeap) {
+            pios_free(task->timerHeap);
+        }
+        task->timerHeap  = heap;
+        task->timerSize += TIMERHEAP_GROWTH;
+    }
+
     // initialize callback scheduling info
-    DelayedCallbackInfo *info = (DelayedCallbackInfo *)pios_malloc(sizeof(DelayedCallbackInfo));
+    DelayedCallbackInfo *info = (DelayedCallbackInfo *)pios_pool_malloc(sizeof(DelayedCallbackInfo), PIOS_MEM_TAG_CALLBACK);
     if (!info) {
         xSemaphoreGiveRecursive(mutex);
         return NULL; // error - not enough memory
     }
     info->next               = NULL;
+    info->readyNext          = NULL;
+    info->priority           = priority;
     info->waiting            = false;
     info->scheduletime       = 0;
+    info->timerIndex         = -1;
+    info->readyTime          = 0;
+    info->maxLatency         = 0;
+    info->runTime            = 0;
+    info->maxRunTime         = 0;
     info->task               = task;
     info->cb = cb;
     info->callbackID         = callbackID;
@@ -349,6 +410,7 @@ DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
 
     // add to scheduling queue
     LL_APPEND(task->callbackQueue[priority], info);
+    task->callbackCount[priority]++;
 
     xSemaphoreGiveRecursive(mutex);
 
@@ -369,6 +431,10 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
 
     struct pios_callback_info info;
 
+    // scale so that run times in us convert directly to percentages
+    uint32_t deltaTime = (PIOS_DELAY_DiffuS(lastReportTime) / 100) ? : 1;
+    lastReportTime = PIOS_DELAY_GetRaw();
+
     struct DelayedCallbackTaskStruct *task = NULL;
     LL_FOREACH(schedulerTasks, task) {
         int prio;
@@ -380,6 +446,11 @@ void PIOS_CALLBACKSCHEDULER_ForEachCallback(CallbackSchedulerCallbackInfoCallbac
                 info.is_running = true;
                 info.stack_remaining    = cbinfo->stackNotFree;
                 info.running_time_count = cbinfo->runCount;
+                info.max_latency        = cbinfo->maxLatency;
+                info.running_time_percentage = cbinfo->runTime / deltaTime;
+                info.max_running_time   = cbinfo->maxRunTime;
+                cbinfo->runTime         = 0;
+                cbinfo->maxRunTime      = 0;
                 xSemaphoreGiveRecursive(mutex);
                 callback(cbinfo->callbackID, &info, context);
             }
@@ -458,75 +529,230 @@ static void checkStack(DelayedCallbackInfo *current)
 }
 
 /**
- * Scheduler subtask
+ * Append a callback to the ready list of its priority, unless it is in there already.
+ * Safe to call from tasks and ISRs.
+ * \param[in] cbinfo the callback handle
+ */
+static void makeReady(DelayedCallbackInfo *cbinfo)
+{
+    struct DelayedCallbackTaskStruct *task = cbinfo->task;
+    uint32_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    if (!cbinfo->waiting) {
+        cbinfo->waiting   = true;
+        cbinfo->readyTime = PIOS_DELAY_GetRaw();
+        cbinfo->readyNext = NULL;
+        if (task->readyTail[cbinfo->priority]) {
+            task->readyTail[cbinfo->priority]->readyNext = cbinfo;
+        } else {
+            task->readyHead[cbinfo->priority] = cbinfo;
+        }
+        task->readyTail[cbinfo->priority] = cbinfo;
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+/**
+ * Take the first callback off a ready list
  * \param[in] task The scheduler task in question
- * \param[in] priority The scheduling priority of the callback to search for
- * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ * \param[in] priority The ready list, which must not be empty
+ * \return the callback, its waiting flag is reset so it can be dispatched again while it runs
  */
-static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+static DelayedCallbackInfo *takeReady(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
 {
-    int32_t result = MAX_SLEEP;
-    int32_t diff   = 0;
+    uint32_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
 
-    // no such queue
-    if (priority > CALLBACK_PRIORITY_LOW) {
-        return result;
+    DelayedCallbackInfo *current = task->readyHead[priority];
+
+    task->readyHead[priority] = current->readyNext;
+    if (!task->readyHead[priority]) {
+        task->readyTail[priority] = NULL;
+    }
+    current->readyNext = NULL;
+    current->waiting   = false;
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return current;
+}
+
+/**
+ * Timer heap helpers, all called with the mutex held.
+ * Deadlines are compared through their difference to survive the tick count wraparound.
+ */
+static inline bool timerBefore(DelayedCallbackInfo *a, DelayedCallbackInfo *b)
+{
+    return (int32_t)(a->scheduletime - b->scheduletime) < 0;
+}
+
+static inline void timerPlace(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo, int16_t index)
+{
+    task->timerHeap[index] = cbinfo;
+    cbinfo->timerIndex     = index;
+}
+
+static void timerSiftUp(struct DelayedCallbackTaskStruct *task, int16_t index)
+{
+    DelayedCallbackInfo *cbinfo = task->timerHeap[index];
+
+    while (index > 0) {
+        int16_t parent = (index - 1) / 2;
+        if (!timerBefore(cbinfo, task->timerHeap[parent])) {
+            break;
+        }
+        timerPlace(task, task->timerHeap[parent], index);
+        index = parent;
+    }
+    timerPlace(task, cbinfo, index);
+}
+
+static void timerSiftDown(struct DelayedCallbackTaskStruct *task, int16_t index)
+{
+    DelayedCallbackInfo *cbinfo = task->timerHeap[index];
+
+    while (1) {
+        int16_t child = 2 * index + 1;
+        if (child >= task->timerCount) {
+            break;
+        }
+        if (child + 1 < task->timerCount && timerBefore(task->timerHeap[child + 1], task->timerHeap[child])) {
+            child++;
+        }
+        if (!timerBefore(task->timerHeap[child], cbinfo)) {
+            break;
+        }
+        timerPlace(task, task->timerHeap[child], index);
+        index = child;
+    }
+    timerPlace(task, cbinfo, index);
+}
+
+static void timerInsert(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo)
+{
+    // PIOS_CALLBACKSCHEDULER_Create() reserves one slot per callback
+    PIOS_Assert(task->timerCount < task->timerSize);
+    timerPlace(task, cbinfo, task->timerCount++);
+    timerSiftUp(task, cbinfo->timerIndex);
+}
+
+static void timerRemove(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo)
+{
+    int16_t index = cbinfo->timerIndex;
+
+    cbinfo->timerIndex = -1;
+    if (index != --task->timerCount) {
+        timerPlace(task, task->timerHeap[task->timerCount], index);
+        timerUpdate(task, task->timerHeap[index]);
     }
+}
 
-    // queue is empty, search a lower priority queue
-    if (task->callbackQueue[priority] == NULL) {
-        return runNextCallback(task, priority + 1);
+static void timerUpdate(struct DelayedCallbackTaskStruct *task, DelayedCallbackInfo *cbinfo)
+{
+    int16_t index = cbinfo->timerIndex;
+
+    if (index > 0 && timerBefore(cbinfo, task->timerHeap[(index - 1) / 2])) {
+        timerSiftUp(task, index);
+    } else {
+        timerSiftDown(task, index);
     }
+}
 
-    DelayedCallbackInfo *current = task->queueCursor[priority];
-    DelayedCallbackInfo *next;
-    do {
-        if (current == NULL) {
-            next = task->callbackQueue[priority]; // loop around the end of the list
-            // also attempt to run a callback that has lower priority
-            // every time the queue is completely traversed
-            diff = runNextCallback(task, priority + 1);
-            if (!diff) {
-                task->queueCursor[priority] = next; // the recursive call has executed a callback
-                return 0;
+/**
+ * Pick the next callback to run, highest priority first. Every time a priority
+ * has run as many callbacks as it holds, the lower priorities get one chance to
+ * run, so a busy priority can not starve them entirely.
+ * \param[in] task The scheduler task in question
+ * \param[in] priority The highest priority to search
+ * \return the callback to run, NULL if none is ready
+ */
+static DelayedCallbackInfo *nextReady(struct DelayedCallbackTaskStruct *task, DelayedCallbackPriority priority)
+{
+    for (DelayedCallbackPriority p = priority; p <= CALLBACK_PRIORITY_LOW; p++) {
+        if (!task->readyHead[p]) {
+            task->roundCount[p] = 0; // an idle priority starves nobody, start a new round
+            continue;
+        }
+        if (task->roundCount[p] >= task->callbackCount[p]) {
+            task->roundCount[p] = 0;
+            if (p < CALLBACK_PRIORITY_LOW) {
+                DelayedCallbackInfo *lower = nextReady(task, p + 1);
+                if (lower) {
+                    return lower;
+                }
             }
+        }
+        task->roundCount[p]++;
+        return takeReady(task, p);
+    }
+    return NULL;
+}
+
+/**
+ * Scheduler subtask
+ * \param[in] task The scheduler task in question
+ * \return wait time until next scheduled callback is due - 0 if a callback has just been executed
+ */
+static int32_t runNextCallback(struct DelayedCallbackTaskStruct *task)
+{
+    int32_t result = MAX_SLEEP;
+
+    // move the callbacks whose schedule expired to their ready lists
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    uint32_t now = xTaskGetTickCount();
+    while (task->timerCount) {
+        DelayedCallbackInfo *first = task->timerHeap[0];
+        int32_t diff = first->scheduletime - now;
+        if (diff > 0) {
             if (diff < result) {
                 result = diff; // adjust sleep time
             }
-        } else {
-            next = current->next;
-            xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
-            if (current->scheduletime) {
-                diff = current->scheduletime - xTaskGetTickCount();
-                if (diff <= 0) {
-                    current->waiting = true;
-                } else if (diff < result) {
-                    result = diff; // adjust sleep time
-                }
-            }
-            if (current->waiting) {
-                task->queueCursor[priority] = next;
-                current->scheduletime = 0; // any schedules are reset
-                current->waiting = false; // the flag is reset just before execution.
-                xSemaphoreGiveRecursive(mutex);
+            break;
+        }
+        timerRemove(task, first);
+        makeReady(first);
+    }
+    xSemaphoreGiveRecursive(mutex);
+
+    DelayedCallbackInfo *current = nextReady(task, CALLBACK_PRIORITY_CRITICAL);
+    if (!current) {
+        return result;
+    }
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY); // access to scheduletime should be mutex protected
+    if (current->timerIndex >= 0) {
+        timerRemove(task, current);
+    }
+    current->scheduletime = 0; // any schedules are reset
+    xSemaphoreGiveRecursive(mutex);
 
-                /* callback gets invoked here - check stack sizes */
-                markStack(current);
+    uint32_t latency = PIOS_DELAY_DiffuS(current->readyTime);
+    if (latency > current->maxLatency) {
+        current->maxLatency = latency;
+    }
 
-                current->cb(); // call the callback
+    /* callback gets invoked here - check stack sizes */
+    markStack(current);
 
-                checkStack(current);
+    uint32_t start = PIOS_DELAY_GetRaw();
 
-                current->runCount++;
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_CALLBACK, PIOS_TRACE_BEGIN, (uint32_t)current->callbackID);
+    current->cb(); // call the callback
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_CALLBACK, PIOS_TRACE_END, (uint32_t)current->callbackID);
 
-                return 0;
-            }
-            xSemaphoreGiveRecursive(mutex);
-        }
-        current = next;
-    } while (current != task->queueCursor[priority]);
-    // once the list has been traversed entirely without finding any to be executed task, abort (nothing to do)
-    return result;
+    uint32_t runTime = PIOS_DELAY_DiffuS(start);
+
+    checkStack(current);
+
+    // statistics only, like runCount these are updated without the mutex
+    current->runTime += runTime;
+    if (runTime > current->maxRunTime) {
+        current->maxRunTime = runTime;
+    }
+
+    current->runCount++;
+
+    return 0;
 }
 
 /**
@@ -538,7 +764,7 @@ static void CallbackSchedulerTask(void *task)
     uint32_t delay = 0;
 
     while (1) {
-        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task, CALLBACK_PRIORITY_CRITICAL);
+        delay = runNextCallback((struct DelayedCallbackTaskStruct *)task);
         if (delay) {
             // nothing to do but sleep
             xSemaphoreTake(((struct DelayedCallbackTaskStruct *)task)->signal, delay);
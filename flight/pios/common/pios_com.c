@@ -71,7 +71,7 @@ static struct pios_com_dev *PIOS_COM_alloc(void)
 {
     struct pios_com_dev *com_dev;
 
-    com_dev = (struct pios_com_dev *)pios_malloc(sizeof(struct pios_com_dev));
+    com_dev = (struct pios_com_dev *)pios_malloc_tagged(sizeof(struct pios_com_dev), PIOS_MEM_TAG_COM);
     if (!com_dev) {
         return NULL;
     }
@@ -570,6 +570,76 @@ check_again:
     return bytes_from_fifo;
 }
 
+/**
+ * Wait for received bytes and return them in place, without copying
+ * \param[in] port COM port
+ * \param[out] data Set to the first received byte
+ * \param[in] timeout_ms Time to wait for data when the buffer is empty
+ * \returns Number of contiguous bytes at data, release them with PIOS_COM_ReceiveRelease()
+ */
+uint16_t PIOS_COM_ReceiveSpan(uint32_t com_id, const uint8_t **data, uint32_t timeout_ms)
+{
+    PIOS_Assert(data);
+    uint16_t bytes_in_fifo;
+
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+    PIOS_Assert(com_dev->has_rx);
+
+check_again:
+    bytes_in_fifo = fifoBuf_getReadSpan(&com_dev->rx, (uint8_t **)data);
+
+    if (bytes_in_fifo == 0) {
+        /* Make sure the receiver is running while we wait */
+        if (com_dev->driver->rx_start) {
+            (com_dev->driver->rx_start)(com_dev->lower_id,
+                                        fifoBuf_getFree(&com_dev->rx));
+        }
+        if (timeout_ms > 0) {
+#if defined(PIOS_INCLUDE_FREERTOS)
+            if (xSemaphoreTake(com_dev->rx_sem, timeout_ms / portTICK_RATE_MS) == pdTRUE) {
+                /* Make sure we don't come back here again */
+                timeout_ms = 0;
+                goto check_again;
+            }
+#else
+            PIOS_DELAY_WaitmS(1);
+            timeout_ms--;
+            goto check_again;
+#endif
+        }
+    }
+
+    return bytes_in_fifo;
+}
+
+/**
+ * Release bytes returned by PIOS_COM_ReceiveSpan() once they are parsed
+ * \param[in] port COM port
+ * \param[in] len Number of bytes consumed
+ */
+void PIOS_COM_ReceiveRelease(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+
+    fifoBuf_removeData(&com_dev->rx, len);
+
+    /* Notify the lower layer that there is now room in the rx buffer */
+    if (com_dev->driver->rx_start) {
+        (com_dev->driver->rx_start)(com_dev->lower_id,
+                                    fifoBuf_getFree(&com_dev->rx));
+    }
+}
+
 /**
  * Query if a com port is available for use.  That can be
  * used to check a link is established even if the device
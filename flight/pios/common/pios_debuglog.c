@@ -34,10 +34,24 @@
 #include "debuglogentry.h"
 
 // global definitions
+#if defined(PIOS_INCLUDE_FREERTOS)
+#define LOG_BUFFER_COUNT 3
+#else
+#define LOG_BUFFER_COUNT 2
+#endif
+#define LOG_WRITER_STACK_SIZE 512
 
 
 // Global variables
 extern uintptr_t pios_user_fs_id; // flash filesystem for logging
+#if defined(PIOS_INCLUDE_FLASH_STREAMFS)
+extern uintptr_t pios_user_streamfs_id; // append-only log partition, used instead of the filesystem when present
+
+// position following the last entry handed out by PIOS_DEBUGLOG_Read(), downloads are sequential
+static uint32_t read_cursor = PIOS_STREAMFS_CURSOR_START;
+static uint16_t read_flight = 0;
+static uint16_t read_entry  = 0;
+#endif
 
 #if defined(PIOS_INCLUDE_FREERTOS)
 static xSemaphoreHandle mutex = 0;
@@ -54,9 +68,21 @@ static bool log_is_full     = false;
 static uint8_t fails_count  = 0;
 static uint16_t flightnum   = 0;
 static uint16_t lognum = 0;
+
+// Ring of log blocks: producers fill buffers[fill_index], the writer saves
+// the pending blocks starting at buffers[write_index] to flash
+static DebugLogEntryData *buffers[LOG_BUFFER_COUNT];
 static DebugLogEntryData *buffer = 0;
+static uint8_t fill_index    = 0;
+static uint8_t write_index   = 0;
+static uint8_t pending_count = 0;
+static uint32_t dropped_entries    = 0;
+static uint32_t backpressure_count = 0;
+#if defined(PIOS_INCLUDE_CALLBACKSCHEDULER)
+static DelayedCallbackInfo *writer_callback = 0;
+#endif
 #if !defined(PIOS_INCLUDE_FREERTOS)
-static DebugLogEntryData staticbuffer;
+static DebugLogEntryData staticbuffers[LOG_BUFFER_COUNT];
 #endif
 
 #define LOG_ENTRY_MAX_DATA_SIZE (sizeof(((DebugLogEntryData *)0)->Data))
@@ -64,11 +90,27 @@ static DebugLogEntryData staticbuffer;
 // build the obj_id as a DEBUGLOGENTRY ID with least significant byte zeroed and filled with flight number
 #define LOG_GET_FLIGHT_OBJID(x) ((DEBUGLOGENTRY_OBJID & ~0xFF) | (x & 0xFF))
 
+#if defined(PIOS_INCLUDE_DEBUGLOG_FORMATS)
+// deferred messages are packed in entries of their own, each one is the time
+// (uint32_t us), the offset of the format (uint16_t), the number of arguments
+// (uint8_t), a padding byte and the arguments (uint32_t)
+#define LOG_DEFERRED_HEADER_SIZE 8
+extern const char __debuglog_formats_start[];
+#endif
+
 static uint32_t used_buffer_space = 0;
 
 /* Private Function Prototypes */
 static void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
-static bool write_current_buffer();
+static bool queue_current_buffer();
+static void reset_pipeline();
+static void start_writer();
+static void write_pending_buffers();
+static int32_t log_save(DebugLogEntryData *block);
+static int32_t log_load(DebugLogEntryData *block, uint16_t flight, uint16_t inst);
+static int32_t log_load_next(DebugLogEntryData *block, uint16_t *flight, uint16_t *inst);
+static void log_idle();
+static void log_format();
 /**
  * @brief Initialize the log facility
  */
@@ -76,24 +118,42 @@ void PIOS_DEBUGLOG_Initialize()
 {
 #if defined(PIOS_INCLUDE_FREERTOS)
     if (!mutex) {
-        mutex  = xSemaphoreCreateRecursiveMutex();
-        buffer = pios_malloc(sizeof(DebugLogEntryData));
+        mutex = xSemaphoreCreateRecursiveMutex();
+        for (uint8_t i = 0; i < LOG_BUFFER_COUNT; i++) {
+            buffers[i] = pios_malloc(sizeof(DebugLogEntryData));
+            if (!buffers[i]) {
+                return;
+            }
+        }
+#if defined(PIOS_INCLUDE_CALLBACKSCHEDULER)
+        writer_callback = PIOS_CALLBACKSCHEDULER_Create(&write_pending_buffers, CALLBACK_PRIORITY_LOW, CALLBACK_TASK_AUXILIARY, -1, LOG_WRITER_STACK_SIZE);
+#endif
     }
 #else
-    buffer = &staticbuffer;
+    for (uint8_t i = 0; i < LOG_BUFFER_COUNT; i++) {
+        buffers[i] = &staticbuffers[i];
+    }
 #endif
-    if (!buffer) {
+    if (!buffers[LOG_BUFFER_COUNT - 1]) {
         return;
     }
     mutexlock();
+    reset_pipeline();
     lognum      = 0;
     flightnum   = 0;
     fails_count = 0;
-    used_buffer_space = 0;
     log_is_full = false;
-    while (PIOS_FLASHFS_ObjLoad(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
+#if defined(PIOS_INCLUDE_FLASH_STREAMFS)
+    // continue after the flight of the last entry in the stream
+    uint32_t cursor = PIOS_STREAMFS_CURSOR_START;
+    while (PIOS_STREAMFS_ReadRecord(pios_user_streamfs_id, &cursor, (uint8_t *)buffer, LOG_ENTRY_HEADER_SIZE) >= 0) {
+        flightnum = buffer->Flight + 1;
+    }
+#else
+    while (log_load(buffer, flightnum, lognum) == 0) {
         flightnum++;
     }
+#endif
     mutexunlock();
 }
 
@@ -106,8 +166,15 @@ void PIOS_DEBUGLOG_Enable(uint8_t enabled)
 {
     // increase the flight num as soon as logging is disabled
     if (logging_enabled && !enabled) {
+        mutexlock();
+        // hand the last partial block of this flight to the writer
+        if (buffer && used_buffer_space && !queue_current_buffer()) {
+            dropped_entries++;
+            used_buffer_space = 0;
+        }
         flightnum++;
         lognum = 0;
+        mutexunlock();
     }
     logging_enabled = enabled;
 }
@@ -147,8 +214,11 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
     va_start(args, format);
     mutexlock();
     // flush any pending buffer before writing debug text
-    if (used_buffer_space) {
-        write_current_buffer();
+    if (used_buffer_space && !queue_current_buffer()) {
+        dropped_entries++;
+        mutexunlock();
+        va_end(args);
+        return;
     }
     memset(buffer->Data, 0xff, sizeof(buffer->Data));
     vsnprintf((char *)buffer->Data, sizeof(buffer->Data), (char *)format, args);
@@ -162,12 +232,104 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
     buffer->InstanceID = 0;
     buffer->Size       = strlen((const char *)buffer->Data);
 
-    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
-        lognum++;
+    used_buffer_space  = buffer->Size;
+    if (!queue_current_buffer()) {
+        dropped_entries++;
+        used_buffer_space = 0;
     }
     mutexunlock();
+    va_end(args);
 }
 
+#if defined(PIOS_INCLUDE_DEBUGLOG_FORMATS)
+/**
+ * @brief Write a deferred debug log message, use PIOS_DEBUGLOG_PRINTF()
+ * @param[in] format, in the .debuglogformats section
+ * @param[in] number of arguments, at most PIOS_DEBUGLOG_MAX_ARGS
+ * @param[in] arguments as raw 32 bit words
+ */
+void PIOS_DEBUGLOG_Deferred(const char *format, uint8_t argc, const uint32_t *argv)
+{
+    if (!logging_enabled || !buffer || log_is_full) {
+        return;
+    }
+    if (argc > PIOS_DEBUGLOG_MAX_ARGS) {
+        argc = PIOS_DEBUGLOG_MAX_ARGS;
+    }
+    uint32_t time    = PIOS_DELAY_GetuS();
+    uint16_t offset  = format - __debuglog_formats_start;
+    size_t size = LOG_DEFERRED_HEADER_SIZE + argc * sizeof(uint32_t);
+
+    mutexlock();
+    // hand the block to the writer if it holds something else or is full
+    if (used_buffer_space && (buffer->Type != DEBUGLOGENTRY_TYPE_FORMATTED || used_buffer_space + size > LOG_ENTRY_MAX_DATA_SIZE)) {
+        if (!queue_current_buffer()) {
+            dropped_entries++;
+            mutexunlock();
+            return;
+        }
+    }
+    if (!used_buffer_space) {
+        memset(buffer->Data, 0xff, sizeof(buffer->Data));
+        buffer->Flight     = flightnum;
+        buffer->FlightTime = time;
+        buffer->Entry      = lognum;
+        buffer->Type       = DEBUGLOGENTRY_TYPE_FORMATTED;
+        buffer->ObjectID   = 0;
+        buffer->InstanceID = 0;
+    }
+
+    uint8_t *record = &buffer->Data[used_buffer_space];
+    memcpy(record, &time, sizeof(time));
+    memcpy(record + 4, &offset, sizeof(offset));
+    record[6] = argc;
+    record[7] = 0;
+    memcpy(record + LOG_DEFERRED_HEADER_SIZE, argv, argc * sizeof(uint32_t));
+
+    used_buffer_space += size;
+    buffer->Size = used_buffer_space;
+    mutexunlock();
+}
+#endif /* PIOS_INCLUDE_DEBUGLOG_FORMATS */
+
+/**
+ * @brief Write a debug log entry with binary trace records
+ * @param[in] records, struct pios_trace_record
+ * @param[in] size of the records in bytes, at most the size of an entry
+ */
+void PIOS_DEBUGLOG_Trace(const void *records, size_t size)
+{
+    if (!logging_enabled || !buffer || log_is_full) {
+        return;
+    }
+    if (size > LOG_ENTRY_MAX_DATA_SIZE) {
+        size = LOG_ENTRY_MAX_DATA_SIZE;
+    }
+
+    mutexlock();
+    // the records fill an entry of their own
+    if (used_buffer_space && !queue_current_buffer()) {
+        dropped_entries++;
+        mutexunlock();
+        return;
+    }
+    memset(buffer->Data, 0xff, sizeof(buffer->Data));
+    memcpy(buffer->Data, records, size);
+    buffer->Flight     = flightnum;
+    buffer->FlightTime = PIOS_DELAY_GetuS();
+    buffer->Entry      = lognum;
+    buffer->Type       = DEBUGLOGENTRY_TYPE_TRACE;
+    buffer->ObjectID   = 0;
+    buffer->InstanceID = 0;
+    buffer->Size       = size;
+
+    used_buffer_space  = size;
+    if (!queue_current_buffer()) {
+        dropped_entries++;
+        used_buffer_space = 0;
+    }
+    mutexunlock();
+}
 
 /**
  * @brief Load one object instance from the filesystem
@@ -184,7 +346,20 @@ void PIOS_DEBUGLOG_Printf(char *format, ...)
 int32_t PIOS_DEBUGLOG_Read(void *mybuffer, uint16_t flight, uint16_t inst)
 {
     PIOS_Assert(mybuffer);
-    return PIOS_FLASHFS_ObjLoad(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flight), inst, (uint8_t *)mybuffer, sizeof(DebugLogEntryData));
+    return log_load((DebugLogEntryData *)mybuffer, flight, inst);
+}
+
+/**
+ * @brief Load the first entry at or after a position, for sequential downloads
+ * @param[out] buffer where to store the entry
+ * @param[in,out] flight to start from, set to the flight of the loaded entry
+ * @param[in,out] inst entry to start from, set to the loaded entry
+ * @return 0 if success, -3 if there is no entry at or after the position
+ */
+int32_t PIOS_DEBUGLOG_ReadNext(void *mybuffer, uint16_t *flight, uint16_t *inst)
+{
+    PIOS_Assert(mybuffer && flight && inst);
+    return log_load_next((DebugLogEntryData *)mybuffer, flight, inst);
 }
 
 /**
@@ -202,6 +377,17 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
     if (entry) {
         *entry = lognum;
     }
+#if defined(PIOS_INCLUDE_FLASH_STREAMFS)
+    // report the stream in units of log entries
+    struct PIOS_STREAMFS_Stats stats = { 0, 0 };
+    PIOS_STREAMFS_GetStats(pios_user_streamfs_id, &stats);
+    if (free) {
+        *free = stats.free_bytes / (sizeof(DebugLogEntryData) + sizeof(uint16_t));
+    }
+    if (used) {
+        *used = stats.used_bytes / (sizeof(DebugLogEntryData) + sizeof(uint16_t));
+    }
+#else
     struct PIOS_FLASHFS_Stats stats = { 0, 0 };
     PIOS_FLASHFS_GetStats(pios_user_fs_id, &stats);
     if (free) {
@@ -210,6 +396,22 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
     if (used) {
         *used = stats.num_active_slots;
     }
+#endif
+}
+
+/**
+ * @brief Retrieve run time statistics of the logging pipeline
+ * @param[out] entries dropped because no log buffer was free
+ * @param[out] blocks queued while the flash writer was still busy with older ones
+ */
+void PIOS_DEBUGLOG_Stats(uint32_t *dropped, uint32_t *backpressure)
+{
+    if (dropped) {
+        *dropped = dropped_entries;
+    }
+    if (backpressure) {
+        *backpressure = backpressure_count;
+    }
 }
 
 /**
@@ -218,12 +420,12 @@ void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint1
 void PIOS_DEBUGLOG_Format(void)
 {
     mutexlock();
-    PIOS_FLASHFS_Format(pios_user_fs_id);
+    log_format();
+    reset_pipeline();
     lognum      = 0;
     flightnum   = 0;
     log_is_full = false;
     fails_count = 0;
-    used_buffer_space = 0;
     mutexunlock();
 }
 
@@ -231,25 +433,36 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
 {
     DebugLogEntryData *entry;
 
+    if (size > LOG_ENTRY_MAX_DATA_SIZE) {
+        size = LOG_ENTRY_MAX_DATA_SIZE;
+    }
+
+    // deferred messages are not mixed with objects
+    if (used_buffer_space && buffer->Type == DEBUGLOGENTRY_TYPE_FORMATTED) {
+        if (!queue_current_buffer()) {
+            dropped_entries++;
+            return;
+        }
+    }
+
+    // if an instance is being filled and there is not enough space left, hand it to the writer
+    if (used_buffer_space && used_buffer_space + size + LOG_ENTRY_HEADER_SIZE > LOG_ENTRY_MAX_DATA_SIZE) {
+        buffer->Type = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
+        if (!queue_current_buffer()) {
+            // all blocks are waiting for flash, this entry is lost
+            dropped_entries++;
+            return;
+        }
+    }
+
     // start a new block
     if (!used_buffer_space) {
         entry = buffer;
         memset(buffer->Data, 0xff, sizeof(buffer->Data));
         used_buffer_space += size;
     } else {
-        // if an instance is being filled and there is enough space, does enqueues new data.
-        if (used_buffer_space + size + LOG_ENTRY_HEADER_SIZE > LOG_ENTRY_MAX_DATA_SIZE) {
-            buffer->Type = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
-            if (!write_current_buffer()) {
-                return;
-            }
-            entry = buffer;
-            memset(buffer->Data, 0xff, sizeof(buffer->Data));
-            used_buffer_space += size;
-        } else {
-            entry = (DebugLogEntryData *)&buffer->Data[used_buffer_space];
-            used_buffer_space += size + LOG_ENTRY_HEADER_SIZE;
-        }
+        entry = (DebugLogEntryData *)&buffer->Data[used_buffer_space];
+        used_buffer_space += size + LOG_ENTRY_HEADER_SIZE;
     }
 
     entry->Flight     = flightnum;
@@ -258,29 +471,211 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
     entry->Type = DEBUGLOGENTRY_TYPE_UAVOBJECT;
     entry->ObjectID   = objid;
     entry->InstanceID = instid;
-    if (size > sizeof(buffer->Data)) {
-        size = sizeof(buffer->Data);
-    }
     entry->Size = size;
 
     memcpy(entry->Data, data, size);
 }
 
-bool write_current_buffer()
+/**
+ * Pass the block being filled on to the flash writer and start filling the next one.
+ * Must be called with the lock held.
+ * \return false if every other block is still waiting to be written
+ */
+bool queue_current_buffer()
 {
-    // not enough space, write the block and start a new one
-    if (PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)buffer, sizeof(DebugLogEntryData)) == 0) {
-        lognum++;
-        fails_count = 0;
-        used_buffer_space = 0;
-    } else {
-        if (fails_count++ > MAX_CONSECUTIVE_FAILS_COUNT) {
-            log_is_full = true;
-        }
+    if (pending_count >= LOG_BUFFER_COUNT - 1) {
+        // make sure a failed write is retried
+        start_writer();
         return false;
     }
+    if (pending_count) {
+        // the writer has not caught up with the previous block yet
+        backpressure_count++;
+    }
+    pending_count++;
+    fill_index = (fill_index + 1) % LOG_BUFFER_COUNT;
+    buffer     = buffers[fill_index];
+    used_buffer_space = 0;
+    lognum++;
+
+    start_writer();
     return true;
 }
+
+/**
+ * Run the flash writer, deferred to its callback when the scheduler is available.
+ */
+void start_writer()
+{
+#if defined(PIOS_INCLUDE_CALLBACKSCHEDULER)
+    if (writer_callback) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(writer_callback);
+        return;
+    }
+#endif
+    write_pending_buffers();
+}
+
+/**
+ * Discard all queued blocks and restart filling from the first buffer.
+ * Must be called with the lock held.
+ */
+void reset_pipeline()
+{
+    fill_index    = 0;
+    write_index   = 0;
+    pending_count = 0;
+    buffer = buffers[0];
+    used_buffer_space = 0;
+}
+
+/**
+ * Save the queued blocks to flash, runs from a low priority callback so that
+ * producers never wait for the flash. The lock is not held during the save.
+ */
+void write_pending_buffers()
+{
+    for (;;) {
+        mutexlock();
+        if (!pending_count) {
+            mutexunlock();
+            log_idle();
+            return;
+        }
+        DebugLogEntryData *block = buffers[write_index];
+        mutexunlock();
+
+        int32_t rc = log_save(block);
+
+        mutexlock();
+        // the pipeline may have been reset by a format while saving
+        if (!pending_count || buffers[write_index] != block) {
+            mutexunlock();
+            continue;
+        }
+        if (rc == 0) {
+            fails_count = 0;
+            write_index = (write_index + 1) % LOG_BUFFER_COUNT;
+            pending_count--;
+        } else {
+            if (fails_count++ > MAX_CONSECUTIVE_FAILS_COUNT) {
+                log_is_full = true;
+                reset_pipeline();
+            }
+            // keep the block, it is retried when the next one is queued
+            mutexunlock();
+            return;
+        }
+        mutexunlock();
+    }
+}
+
+#if defined(PIOS_INCLUDE_FLASH_STREAMFS)
+
+/**
+ * Append a block to the log stream.
+ */
+int32_t log_save(DebugLogEntryData *block)
+{
+    return PIOS_STREAMFS_Append(pios_user_streamfs_id, (uint8_t *)block, sizeof(DebugLogEntryData));
+}
+
+/**
+ * Find a block in the log stream. Entries are stored in order, so a download
+ * asking for one entry after the other continues from the previous position.
+ * \return 0 if success, -3 if there is no such entry
+ */
+int32_t log_load(DebugLogEntryData *block, uint16_t flight, uint16_t inst)
+{
+    uint32_t cursor = read_cursor;
+
+    if (cursor == PIOS_STREAMFS_CURSOR_START || flight < read_flight || (flight == read_flight && inst <= read_entry)) {
+        cursor = PIOS_STREAMFS_CURSOR_START;
+    }
+    while (PIOS_STREAMFS_ReadRecord(pios_user_streamfs_id, &cursor, (uint8_t *)block, sizeof(DebugLogEntryData)) >= 0) {
+        if (block->Flight == flight && block->Entry == inst) {
+            read_cursor = cursor;
+            read_flight = flight;
+            read_entry  = inst;
+            return 0;
+        }
+    }
+    return -3;
+}
+
+/**
+ * Continue reading the stream from the previous position, only a position
+ * before the last one read starts over from the beginning.
+ */
+int32_t log_load_next(DebugLogEntryData *block, uint16_t *flight, uint16_t *inst)
+{
+    uint32_t cursor = read_cursor;
+
+    if (cursor == PIOS_STREAMFS_CURSOR_START || *flight < read_flight || (*flight == read_flight && *inst <= read_entry)) {
+        cursor = PIOS_STREAMFS_CURSOR_START;
+    }
+    while (PIOS_STREAMFS_ReadRecord(pios_user_streamfs_id, &cursor, (uint8_t *)block, sizeof(DebugLogEntryData)) >= 0) {
+        if (block->Flight > *flight || (block->Flight == *flight && block->Entry >= *inst)) {
+            read_cursor = cursor;
+            read_flight = block->Flight;
+            read_entry  = block->Entry;
+            *flight     = block->Flight;
+            *inst = block->Entry;
+            return 0;
+        }
+    }
+    return -3;
+}
+
+/**
+ * Called by the writer once everything queued is saved, programs the
+ * last partial page and erases the next sector while there is time.
+ */
+void log_idle()
+{
+    PIOS_STREAMFS_Flush(pios_user_streamfs_id);
+}
+
+void log_format()
+{
+    PIOS_STREAMFS_Format(pios_user_streamfs_id);
+    read_cursor = PIOS_STREAMFS_CURSOR_START;
+}
+
+#else /* if defined(PIOS_INCLUDE_FLASH_STREAMFS) */
+
+int32_t log_save(DebugLogEntryData *block)
+{
+    return PIOS_FLASHFS_ObjSave(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(block->Flight), block->Entry, (uint8_t *)block, sizeof(DebugLogEntryData));
+}
+
+int32_t log_load(DebugLogEntryData *block, uint16_t flight, uint16_t inst)
+{
+    return PIOS_FLASHFS_ObjLoad(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flight), inst, (uint8_t *)block, sizeof(DebugLogEntryData));
+}
+
+int32_t log_load_next(DebugLogEntryData *block, uint16_t *flight, uint16_t *inst)
+{
+    // the entries of a flight are numbered without gaps, a missing one starts the next flight
+    for (uint32_t f = *flight, e = *inst; f <= flightnum; f++, e = 0) {
+        if (log_load(block, f, e) == 0) {
+            *flight = f;
+            *inst   = e;
+            return 0;
+        }
+    }
+    return -3;
+}
+
+void log_idle()
+{}
+
+void log_format()
+{
+    PIOS_FLASHFS_Format(pios_user_fs_id);
+}
+
+#endif /* if defined(PIOS_INCLUDE_FLASH_STREAMFS) */
 /**
  * @}
  * @}
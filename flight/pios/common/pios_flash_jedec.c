@@ -63,6 +63,8 @@ struct jedec_flash_dev {
     uint32_t spi_id;
     uint32_t slave_num;
     bool     claimed;
+    bool     busy;
+    uint8_t  busy_poll_ticks;
 
     uint8_t  manufacturer;
     uint8_t  memorytype;
@@ -88,6 +90,7 @@ static int32_t PIOS_Flash_Jedec_ClaimBus(struct jedec_flash_dev *flash_dev, bool
 static int32_t PIOS_Flash_Jedec_ReleaseBus(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_WriteEnable(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev);
+static int32_t PIOS_Flash_Jedec_WaitReady(struct jedec_flash_dev *flash_dev);
 
 /**
  * @brief Allocate a new device
@@ -102,6 +105,7 @@ static struct jedec_flash_dev *PIOS_Flash_Jedec_alloc(void)
     }
 
     flash_dev->claimed = false;
+    flash_dev->busy    = false;
     flash_dev->magic   = PIOS_JEDEC_DEV_MAGIC;
 #if defined(FLASH_FREERTOS)
     flash_dev->transaction_lock = xSemaphoreCreateMutex();
@@ -141,6 +145,11 @@ int32_t PIOS_Flash_Jedec_Init(uintptr_t *flash_id, uint32_t spi_id, uint32_t sla
     flash_dev->slave_num = slave_num;
     flash_dev->cfg = NULL;
 
+    /* An erase left running before a reset would hide the ID */
+    while (PIOS_Flash_Jedec_Busy(flash_dev) > 0) {
+        ;
+    }
+
     (void)PIOS_Flash_Jedec_ReadID(flash_dev);
 
     for (uint32_t i = 0; i < pios_flash_jedec_catalog_size; ++i) {
@@ -206,6 +215,41 @@ static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev)
     return status & JEDEC_STATUS_BUSY;
 }
 
+/**
+ * @brief Wait for the program or erase left running by the previous operation.
+ * Writes and erases return as soon as the chip has the command, the next operation
+ * waits for it here so that the caller can go on with other work meanwhile.
+ * @returns 0 when the chip is ready, -1 if unable to claim bus
+ */
+static int32_t PIOS_Flash_Jedec_WaitReady(struct jedec_flash_dev *flash_dev)
+{
+    if (!flash_dev->busy) {
+        return 0;
+    }
+
+#if defined(FLASH_FREERTOS)
+    // Keep polling when bus is busy too, the bus is released between polls
+    while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
+        vTaskDelay(flash_dev->busy_poll_ticks);
+    }
+#else
+    // Query status this way to prevent accel chip locking us out
+    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
+        return -1;
+    }
+
+    PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS);
+    while (PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS) & JEDEC_STATUS_BUSY) {
+        ;
+    }
+
+    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
+#endif /* defined(FLASH_FREERTOS) */
+
+    flash_dev->busy = false;
+    return 0;
+}
+
 /**
  * @brief Execute the write enable instruction and returns the status
  * @returns 0 if successful, -1 if unable to claim bus
@@ -353,6 +397,10 @@ static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t flash_id, uint32_t addr)
     uint8_t ret;
     uint8_t out[] = { flash_dev->cfg->sector_erase, (addr >> 16) & 0xff, (addr >> 8) & 0xff, addr & 0xff };
 
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
+
     if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0) {
         return ret;
     }
@@ -368,12 +416,9 @@ static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t flash_id, uint32_t addr)
 
     PIOS_Flash_Jedec_ReleaseBus(flash_dev);
 
-    // Keep polling when bus is busy too
-    while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
-#if defined(FLASH_FREERTOS)
-        vTaskDelay(2);
-#endif
-    }
+    // A sector erase takes tens of ms, the next operation waits for it
+    flash_dev->busy = true;
+    flash_dev->busy_poll_ticks = 2;
 
     return 0;
 }
@@ -393,6 +438,10 @@ static int32_t PIOS_Flash_Jedec_EraseChip(uintptr_t flash_id)
     uint8_t ret;
     uint8_t out[] = { flash_dev->cfg->chip_erase };
 
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
+
     if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0) {
         return ret;
     }
@@ -458,6 +507,9 @@ static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t flash_id, uint32_t addr, uin
     if (((addr & 0xff) + len) > 0x100) {
         return -3;
     }
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
     if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0) {
         return ret;
     }
@@ -479,26 +531,10 @@ static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t flash_id, uint32_t addr, uin
 
     PIOS_Flash_Jedec_ReleaseBus(flash_dev);
 
-    // Keep polling when bus is busy too
-#if defined(FLASH_FREERTOS)
-    while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
-        vTaskDelay(1);
-    }
-#else
+    // The page is programmed while the caller goes on, the next operation waits for it
+    flash_dev->busy = true;
+    flash_dev->busy_poll_ticks = 1;
 
-    // Query status this way to prevent accel chip locking us out
-    if (PIOS_Flash_Jedec_ClaimBus(flash_dev, true) < 0) {
-        return -1;
-    }
-
-    PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS);
-    while (PIOS_SPI_TransferByte(flash_dev->spi_id, JEDEC_READ_STATUS) & JEDEC_STATUS_BUSY) {
-        ;
-    }
-
-    PIOS_Flash_Jedec_ReleaseBus(flash_dev);
-
-#endif
     return 0;
 }
 
@@ -537,6 +573,9 @@ static int32_t PIOS_Flash_Jedec_WriteChunks(uintptr_t flash_id, uint32_t addr, s
     if (((addr & 0xff) + len) > 0x100) {
         return -3;
     }
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
     if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0) {
         return ret;
     }
@@ -562,7 +601,9 @@ static int32_t PIOS_Flash_Jedec_WriteChunks(uintptr_t flash_id, uint32_t addr, s
     }
     PIOS_Flash_Jedec_ReleaseBus(flash_dev);
 
-    // Skip checking for busy with this to get OS running again fast
+    // Skip checking for busy with this to get OS running again fast, the next operation waits for it
+    flash_dev->busy = true;
+    flash_dev->busy_poll_ticks = 1;
 
     return 0;
 }
@@ -582,6 +623,9 @@ static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t flash_id, uint32_t addr, uint
     if (PIOS_Flash_Jedec_Validate(flash_dev) != 0) {
         return -1;
     }
+    if (PIOS_Flash_Jedec_WaitReady(flash_dev) != 0) {
+        return -1;
+    }
     bool fast_read = flash_dev->cfg->fast_read != 0;
     if (PIOS_Flash_Jedec_ClaimBus(flash_dev, fast_read) == -1) {
         return -1;
@@ -30,6 +30,7 @@
 #ifdef PIOS_INCLUDE_FLASH
 
 #include <stdbool.h>
+#include <string.h>
 #include <openpilot.h>
 #include <pios_math.h>
 #include <pios_wdg.h>
@@ -43,6 +44,13 @@ enum pios_flashfs_logfs_dev_magic {
     PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+/* Location of the active slot of one object instance, kept sorted by obj_id and obj_inst_id */
+struct logfs_index_entry {
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint16_t slot_id;
+};
+
 struct logfs_state {
     enum pios_flashfs_logfs_dev_magic magic;
     const struct flashfs_logfs_cfg    *cfg;
@@ -56,6 +64,11 @@ struct logfs_state {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
 
+    /* Optional RAM index of the active slots, saves scanning slot headers on every lookup */
+    struct logfs_index_entry *index;
+    uint16_t index_count;
+    bool     index_complete; /* every active slot is in the index */
+
     /* Underlying flash driver glue */
     const struct pios_flash_driver *driver;
     uintptr_t flash_id;
@@ -416,6 +429,73 @@ static bool logfs_log_is_full(const struct logfs_state *logfs)
     return logfs->num_free_slots == 0;
 }
 
+/**
+ * @brief Binary search the slot index
+ * @return position of the entry, or where it would have to be inserted
+ */
+static uint16_t logfs_index_search(const struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, bool *found)
+{
+    uint16_t lo = 0;
+    uint16_t hi = logfs->index_count;
+
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        const struct logfs_index_entry *entry = &logfs->index[mid];
+        if (entry->obj_id < obj_id || (entry->obj_id == obj_id && entry->obj_inst_id < obj_inst_id)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *found = (lo < logfs->index_count &&
+              logfs->index[lo].obj_id == obj_id &&
+              logfs->index[lo].obj_inst_id == obj_inst_id);
+    return lo;
+}
+
+/**
+ * @brief Record the active slot of an object instance in the index
+ * @note Once an entry does not fit the index is incomplete and lookups fall back to scanning the arena
+ */
+static void logfs_index_insert(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint16_t slot_id)
+{
+    if (!logfs->index) {
+        return;
+    }
+
+    bool found;
+    uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+    if (found) {
+        logfs->index[pos].slot_id = slot_id;
+        return;
+    }
+    if (logfs->index_count >= logfs->cfg->index_size) {
+        logfs->index_complete = false;
+        return;
+    }
+
+    memmove(&logfs->index[pos + 1], &logfs->index[pos], (logfs->index_count - pos) * sizeof(*logfs->index));
+    logfs->index[pos].obj_id      = obj_id;
+    logfs->index[pos].obj_inst_id = obj_inst_id;
+    logfs->index[pos].slot_id     = slot_id;
+    logfs->index_count++;
+}
+
+static void logfs_index_remove(struct logfs_state *logfs, uint16_t pos)
+{
+    PIOS_Assert(pos < logfs->index_count);
+
+    logfs->index_count--;
+    memmove(&logfs->index[pos], &logfs->index[pos + 1], (logfs->index_count - pos) * sizeof(*logfs->index));
+}
+
+static void logfs_index_clear(struct logfs_state *logfs)
+{
+    logfs->index_count    = 0;
+    logfs->index_complete = (logfs->index != NULL);
+}
+
 static int32_t logfs_unmount_log(struct logfs_state *logfs)
 {
     PIOS_Assert(logfs->mounted);
@@ -423,6 +503,7 @@ static int32_t logfs_unmount_log(struct logfs_state *logfs)
     logfs->num_active_slots = 0;
     logfs->num_free_slots   = 0;
     logfs->mounted = false;
+    logfs_index_clear(logfs);
 
     return 0;
 }
@@ -434,8 +515,9 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
     logfs->num_active_slots = 0;
     logfs->num_free_slots   = 0;
     logfs->active_arena_id  = arena_id;
+    logfs_index_clear(logfs);
 
-    /* Scan the log to find out how full it is */
+    /* Scan the log to find out how full it is, indexing the active slots on the way */
     for (uint16_t slot_id = 1;
          slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
          slot_id++) {
@@ -461,6 +543,7 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
             break;
         case SLOT_STATE_ACTIVE:
             logfs->num_active_slots++;
+            logfs_index_insert(logfs, slot_hdr.obj_id, slot_hdr.obj_inst_id, slot_id);
             break;
         case SLOT_STATE_RESERVED:
         case SLOT_STATE_OBSOLETE:
@@ -481,7 +564,7 @@ static bool PIOS_FLASHFS_Logfs_validate(const struct logfs_state *logfs)
 }
 
 #if defined(PIOS_INCLUDE_FREERTOS)
-static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
+static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(const struct flashfs_logfs_cfg *cfg)
 {
     struct logfs_state *logfs;
 
@@ -490,6 +573,12 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
         return NULL;
     }
 
+    /* Without room for the index the filesystem still works, just slower */
+    logfs->index = NULL;
+    if (cfg->index_size) {
+        logfs->index = (struct logfs_index_entry *)pios_malloc(cfg->index_size * sizeof(*logfs->index));
+    }
+
     logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
     return logfs;
 }
@@ -497,12 +586,15 @@ static void PIOS_FLASHFS_Logfs_free(struct logfs_state *logfs)
 {
     /* Invalidate the magic */
     logfs->magic = ~PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    if (logfs->index) {
+        vPortFree(logfs->index);
+    }
     vPortFree(logfs);
 }
 #else
 static struct logfs_state pios_flashfs_logfs_devs[PIOS_FLASHFS_LOGFS_MAX_DEVS];
 static uint8_t pios_flashfs_logfs_num_devs;
-static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
+static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(__attribute__((unused)) const struct flashfs_logfs_cfg *cfg)
 {
     struct logfs_state *logfs;
 
@@ -512,6 +604,8 @@ static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
 
     logfs = &pios_flashfs_logfs_devs[pios_flashfs_logfs_num_devs++];
     logfs->magic = PIOS_FLASHFS_LOGFS_DEV_MAGIC;
+    /* The simple allocator has no room for the slot index */
+    logfs->index = NULL;
 
     return logfs;
 }
@@ -548,7 +642,7 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 
     struct logfs_state *logfs;
 
-    logfs = (struct logfs_state *)PIOS_FLASHFS_Logfs_alloc();
+    logfs = (struct logfs_state *)PIOS_FLASHFS_Logfs_alloc(cfg);
     if (!logfs) {
         rc = -1;
         goto out_exit;
@@ -745,6 +839,41 @@ static int16_t logfs_object_find_next(const struct logfs_state *logfs, struct sl
     return -1;
 }
 
+/**
+ * @brief Find the active slot of an object, using the slot index when it can answer
+ * @return 0 if found, -1 if not found, < -1 on error
+ * @note Must be called while holding the flash transaction lock
+ */
+static int16_t logfs_object_find(const struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *slot_id, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    if (logfs->index) {
+        bool found;
+        uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+        if (found) {
+            uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, logfs->index[pos].slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         slot_addr,
+                                         (uint8_t *)slot_hdr,
+                                         sizeof(*slot_hdr)) != 0) {
+                return -2;
+            }
+            if (slot_hdr->state == SLOT_STATE_ACTIVE &&
+                slot_hdr->obj_id == obj_id &&
+                slot_hdr->obj_inst_id == obj_inst_id) {
+                *slot_id = logfs->index[pos].slot_id;
+                return 0;
+            }
+            /* Stale entry, should never happen. Scan for it below. */
+            PIOS_DEBUG_Assert(0);
+        } else if (logfs->index_complete) {
+            return -1;
+        }
+    }
+
+    *slot_id = 0;
+    return logfs_object_find_next(logfs, slot_hdr, slot_id, obj_id, obj_inst_id);
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 /* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
 static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
@@ -754,6 +883,32 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
     bool more = true;
     uint16_t curr_slot_id = 0;
 
+    /* With a complete index there is at most one active slot to obsolete */
+    if (logfs->index_complete) {
+        struct slot_header slot_hdr;
+        switch (logfs_object_find(logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
+        case 0:
+            slot_hdr.state = SLOT_STATE_OBSOLETE;
+            if (logfs->driver->write_data(logfs->flash_id,
+                                          logfs_get_addr(logfs, logfs->active_arena_id, curr_slot_id),
+                                          (uint8_t *)&slot_hdr,
+                                          sizeof(slot_hdr)) != 0) {
+                return -2;
+            }
+            logfs->num_active_slots--;
+            bool found;
+            uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+            if (found) {
+                logfs_index_remove(logfs, pos);
+            }
+            return 0;
+        case -1:
+            return 0;
+        default:
+            return -1;
+        }
+    }
+
     do {
         struct slot_header slot_hdr;
         switch (logfs_object_find_next(logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
@@ -771,6 +926,13 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
             }
             /* Object has been successfully obsoleted and is no longer active */
             logfs->num_active_slots--;
+            if (logfs->index) {
+                bool found;
+                uint16_t pos = logfs_index_search(logfs, obj_id, obj_inst_id, &found);
+                if (found && logfs->index[pos].slot_id == curr_slot_id) {
+                    logfs_index_remove(logfs, pos);
+                }
+            }
             break;
         case -1:
             /* Search completed, object not found */
@@ -891,6 +1053,7 @@ static int8_t logfs_append_to_log(struct logfs_state *logfs, uint32_t obj_id, ui
 
     /* Object has been successfully written to the slot */
     logfs->num_active_slots++;
+    logfs_index_insert(logfs, obj_id, obj_inst_id, free_slot_id);
     return 0;
 }
 
@@ -1025,7 +1188,7 @@ int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
     /* Find the object in the log */
     uint16_t slot_id = 0;
     struct slot_header slot_hdr;
-    if (logfs_object_find_next(logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
+    if (logfs_object_find(logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
         /* Object does not exist in fs */
         rc = -3;
         goto out_end_trans;
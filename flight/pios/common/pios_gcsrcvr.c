@@ -40,10 +40,18 @@ static GCSReceiverData gcsreceiverdata;
 
 /* Provide a RCVR driver */
 static int32_t PIOS_GCSRCVR_Get(uint32_t rcvr_id, uint8_t channel);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_GCSRCVR_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
+static uint32_t PIOS_GCSRCVR_Get_Frame_Time(uint32_t rcvr_id);
 static void PIOS_gcsrcvr_Supervisor(uint32_t ppm_id);
 
 const struct pios_rcvr_driver pios_gcsrcvr_rcvr_driver = {
-    .read = PIOS_GCSRCVR_Get,
+    .read           = PIOS_GCSRCVR_Get,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore  = PIOS_GCSRCVR_Get_Semaphore,
+#endif
+    .get_frame_time = PIOS_GCSRCVR_Get_Frame_Time,
 };
 
 /* Local Variables */
@@ -54,8 +62,12 @@ enum pios_gcsrcvr_dev_magic {
 struct pios_gcsrcvr_dev {
     enum pios_gcsrcvr_dev_magic magic;
 
-    uint8_t supv_timer;
-    bool    Fresh;
+    /* Raw PIOS_DELAY time of the last GCSReceiver update */
+    uint32_t frame_time;
+    bool     timed_out;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreHandle new_frame_semaphore;
+#endif
 };
 
 static struct pios_gcsrcvr_dev *global_gcsrcvr_dev;
@@ -76,8 +88,9 @@ static struct pios_gcsrcvr_dev *PIOS_gcsrcvr_alloc(void)
     }
 
     gcsrcvr_dev->magic = PIOS_GCSRCVR_DEV_MAGIC;
-    gcsrcvr_dev->Fresh = false;
-    gcsrcvr_dev->supv_timer = 0;
+    gcsrcvr_dev->frame_time = 0;
+    gcsrcvr_dev->timed_out  = true;
+    gcsrcvr_dev->new_frame_semaphore = NULL;
 
     /* The update callback cannot receive the device pointer, so set it in a global */
     global_gcsrcvr_dev = gcsrcvr_dev;
@@ -97,8 +110,8 @@ static struct pios_gcsrcvr_dev *PIOS_gcsrcvr_alloc(void)
 
     gcsrcvr_dev = &pios_gcsrcvr_devs[pios_gcsrcvr_num_devs++];
     gcsrcvr_dev->magic = PIOS_GCSRCVR_DEV_MAGIC;
-    gcsrcvr_dev->Fresh = false;
-    gcsrcvr_dev->supv_timer = 0;
+    gcsrcvr_dev->frame_time = 0;
+    gcsrcvr_dev->timed_out  = true;
 
     global_gcsrcvr_dev = gcsrcvr_dev;
 
@@ -106,13 +119,21 @@ static struct pios_gcsrcvr_dev *PIOS_gcsrcvr_alloc(void)
 }
 #endif /* if defined(PIOS_INCLUDE_FREERTOS) */
 
+/* Called from the telemetry task unpacking the object, not from the event task */
 static void gcsreceiver_updated(UAVObjEvent *ev)
 {
     struct pios_gcsrcvr_dev *gcsrcvr_dev = global_gcsrcvr_dev;
 
     if (ev->obj == GCSReceiverHandle()) {
         GCSReceiverGet(&gcsreceiverdata);
-        gcsrcvr_dev->Fresh = true;
+        gcsrcvr_dev->frame_time = PIOS_DELAY_GetRaw();
+        gcsrcvr_dev->timed_out  = false;
+#if defined(PIOS_INCLUDE_FREERTOS)
+        /* Wake up the receiver task right away with the new frame */
+        if (gcsrcvr_dev->new_frame_semaphore != NULL) {
+            xSemaphoreGive(gcsrcvr_dev->new_frame_semaphore);
+        }
+#endif
     }
 }
 
@@ -131,8 +152,8 @@ extern int32_t PIOS_GCSRCVR_Init(__attribute__((unused)) uint32_t *gcsrcvr_id)
         gcsreceiverdata.Channel[i] = PIOS_RCVR_TIMEOUT;
     }
 
-    /* Register uavobj callback */
-    GCSReceiverConnectCallback(gcsreceiver_updated);
+    /* Register uavobj callback, invoked as soon as the object is received */
+    UAVObjConnectFastCallback(GCSReceiverHandle(), gcsreceiver_updated, EV_MASK_ALL_UPDATES);
 
     /* Register the failsafe timer callback. */
     if (!PIOS_RTC_RegisterTickCallback(PIOS_gcsrcvr_Supervisor, (uint32_t)gcsrcvr_dev)) {
@@ -159,6 +180,28 @@ static int32_t PIOS_GCSRCVR_Get(__attribute__((unused)) uint32_t rcvr_id, uint8_
     return gcsreceiverdata.Channel[channel];
 }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Get the semaphore given on each GCSReceiver update. An update carries
+ * all channels at once so the channel is ignored.
+ */
+static xSemaphoreHandle PIOS_GCSRCVR_Get_Semaphore(__attribute__((unused)) uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_gcsrcvr_dev *gcsrcvr_dev = global_gcsrcvr_dev;
+
+    if (gcsrcvr_dev->new_frame_semaphore == NULL) {
+        vSemaphoreCreateBinary(gcsrcvr_dev->new_frame_semaphore);
+    }
+    return gcsrcvr_dev->new_frame_semaphore;
+}
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+/* Raw PIOS_DELAY time of the last GCSReceiver update */
+static uint32_t PIOS_GCSRCVR_Get_Frame_Time(__attribute__((unused)) uint32_t rcvr_id)
+{
+    return global_gcsrcvr_dev->frame_time;
+}
+
 static void PIOS_gcsrcvr_Supervisor(uint32_t gcsrcvr_id)
 {
     /* Recover our device context */
@@ -170,20 +213,17 @@ static void PIOS_gcsrcvr_Supervisor(uint32_t gcsrcvr_id)
     }
 
     /*
-     * RTC runs at 625Hz.
+     * RTC runs at 625Hz, the channels time out PIOS_GCSRCVR_TIMEOUT_MS after the
+     * last update within one tick.
      */
-    if (++(gcsrcvr_dev->supv_timer) < (PIOS_GCSRCVR_TIMEOUT_MS * 1000 / 625)) {
+    if (gcsrcvr_dev->timed_out || PIOS_DELAY_DiffuS(gcsrcvr_dev->frame_time) < PIOS_GCSRCVR_TIMEOUT_MS * 1000) {
         return;
     }
-    gcsrcvr_dev->supv_timer = 0;
+    gcsrcvr_dev->timed_out = true;
 
-    if (!gcsrcvr_dev->Fresh) {
-        for (int32_t i = 0; i < GCSRECEIVER_CHANNEL_NUMELEM; i++) {
-            gcsreceiverdata.Channel[i] = PIOS_RCVR_TIMEOUT;
-        }
+    for (int32_t i = 0; i < GCSRECEIVER_CHANNEL_NUMELEM; i++) {
+        gcsreceiverdata.Channel[i] = PIOS_RCVR_TIMEOUT;
     }
-
-    gcsrcvr_dev->Fresh = false;
 }
 
 #endif /* PIOS_INCLUDE_GCSRCVR */
@@ -46,6 +46,7 @@ typedef struct {
     uint8_t  slave_num;
     uint8_t  CTRLB;
     volatile bool data_ready;
+    const PIOS_SENSORS_Instance *sensor; // raises the sensors task event, NULL until registered
 } pios_hmc5x83_dev_data_t;
 
 static int32_t PIOS_HMC5x83_Config(pios_hmc5x83_dev_data_t *dev);
@@ -58,13 +59,20 @@ void PIOS_HMC5x83_driver_fetch(void *, uint8_t size, uintptr_t context);
 bool PIOS_HMC5x83_driver_poll(uintptr_t context);
 
 const PIOS_SENSORS_Driver PIOS_HMC5x83_Driver = {
-    .test      = PIOS_HMC5x83_driver_Test,
-    .poll      = PIOS_HMC5x83_driver_poll,
-    .fetch     = PIOS_HMC5x83_driver_fetch,
-    .reset     = PIOS_HMC5x83_driver_Reset,
-    .get_queue = NULL,
-    .get_scale = PIOS_HMC5x83_driver_get_scale,
-    .is_polled = true,
+    .test           = PIOS_HMC5x83_driver_Test,
+    .poll           = PIOS_HMC5x83_driver_poll,
+    .fetch          = PIOS_HMC5x83_driver_fetch,
+    .reset          = PIOS_HMC5x83_driver_Reset,
+    .get_ring       = NULL,
+    .get_scale      = PIOS_HMC5x83_driver_get_scale,
+    .get_poll_delay = NULL,
+    .is_polled      = true,
+#ifdef PIOS_HMC5X83_HAS_GPIOS
+    // data ready interrupt
+    .signals_ready  = true,
+#else
+    .signals_ready  = false,
+#endif
 };
 /**
  * Allocate the device setting structure
@@ -117,7 +125,9 @@ pios_hmc5x83_dev_t PIOS_HMC5x83_Init(const struct pios_hmc5x83_cfg *cfg, uint32_
 
 void PIOS_HMC5x83_Register(pios_hmc5x83_dev_t handler)
 {
-    PIOS_SENSORS_Register(&PIOS_HMC5x83_Driver, PIOS_SENSORS_TYPE_3AXIS_MAG, handler);
+    pios_hmc5x83_dev_data_t *dev = dev_validate(handler);
+
+    dev->sensor = PIOS_SENSORS_Register(&PIOS_HMC5x83_Driver, PIOS_SENSORS_TYPE_3AXIS_MAG, handler);
 }
 
 /**
@@ -443,7 +453,7 @@ bool PIOS_HMC5x83_IRQHandler(pios_hmc5x83_dev_t handler)
     pios_hmc5x83_dev_data_t *dev = dev_validate(handler);
 
     dev->data_ready = true;
-    return false;
+    return PIOS_SENSORS_RaiseEventFromISR(dev->sensor);
 }
 
 #ifdef PIOS_INCLUDE_SPI
@@ -30,6 +30,19 @@ pios_perf_counter_t *pios_instrumentation_perf_counters = NULL;
 int8_t pios_instrumentation_max_counters = -1;
 int8_t pios_instrumentation_last_used_counter = -1;
 
+// open addressing hash table from counter id to counter index, -1 marks a free slot.
+// It is kept at most half full so the linear probing stays short.
+static int8_t *slots = NULL;
+static uint8_t slotMask;
+
+static inline uint8_t hashId(uint32_t id)
+{
+    // the module id is in the upper half word, fold it into the counter number
+    id ^= id >> 16;
+    id *= 0x45d9f3bu;
+    return (uint8_t)((id ^ (id >> 16)) & slotMask);
+}
+
 void PIOS_Instrumentation_Init(int8_t maxCounters)
 {
     PIOS_Assert(maxCounters >= 0);
@@ -38,6 +51,15 @@ void PIOS_Instrumentation_Init(int8_t maxCounters)
         PIOS_Assert(pios_instrumentation_perf_counters);
         memset(pios_instrumentation_perf_counters, 0, sizeof(pios_perf_counter_t) * maxCounters);
         pios_instrumentation_max_counters  = maxCounters;
+
+        uint16_t numSlots = 2;
+        while (numSlots < 2 * (uint16_t)maxCounters) {
+            numSlots <<= 1;
+        }
+        slots    = (int8_t *)pvPortMalloc(numSlots);
+        PIOS_Assert(slots);
+        memset(slots, -1, numSlots);
+        slotMask = numSlots - 1;
     } else {
         pios_instrumentation_perf_counters = NULL;
         pios_instrumentation_max_counters  = -1;
@@ -50,11 +72,18 @@ pios_counter_t PIOS_Instrumentation_CreateCounter(uint32_t id)
 
     pios_counter_t counter_handle = PIOS_Instrumentation_SearchCounter(id);
     if (!counter_handle) {
-        pios_perf_counter_t *newcounter = &pios_instrumentation_perf_counters[++pios_instrumentation_last_used_counter];
+        int8_t index = ++pios_instrumentation_last_used_counter;
+        pios_perf_counter_t *newcounter = &pios_instrumentation_perf_counters[index];
         newcounter->id  = id;
         newcounter->max = INT32_MIN + 1;
         newcounter->min = INT32_MAX - 1;
         counter_handle  = (pios_counter_t)newcounter;
+
+        uint8_t slot = hashId(id);
+        while (slots[slot] >= 0) {
+            slot = (slot + 1) & slotMask;
+        }
+        slots[slot] = index;
     }
     return counter_handle;
 }
@@ -62,14 +91,13 @@ pios_counter_t PIOS_Instrumentation_CreateCounter(uint32_t id)
 pios_counter_t PIOS_Instrumentation_SearchCounter(uint32_t id)
 {
     PIOS_Assert(pios_instrumentation_perf_counters);
-    uint8_t i = 0;
-    while (i < pios_instrumentation_last_used_counter && pios_instrumentation_perf_counters[i].id != id) {
-        i++;
-    }
-    if (pios_instrumentation_perf_counters[i].id != id) {
-        return NULL;
+    for (uint8_t slot = hashId(id); slots[slot] >= 0; slot = (slot + 1) & slotMask) {
+        pios_perf_counter_t *counter = &pios_instrumentation_perf_counters[slots[slot]];
+        if (counter->id == id) {
+            return (pios_counter_t)counter;
+        }
     }
-    return (pios_counter_t)&pios_instrumentation_perf_counters[i];
+    return NULL;
 }
 
 void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback, void *context)
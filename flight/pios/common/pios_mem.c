@@ -66,3 +66,122 @@ void pios_free(void *p)
 }
 
 #endif /* ifdef PIOS_TARGET_PROVIDES_FAST_HEAP */
+
+/* Block sizes served by pios_pool_malloc, larger requests go to the fast heap */
+#ifndef PIOS_MEM_POOL_BLOCK_SIZES
+#define PIOS_MEM_POOL_BLOCK_SIZES { 16, 32, 64 }
+#endif
+/* Blocks carved from the fast heap each time a pool runs empty */
+#define PIOS_MEM_POOL_CHUNK_BLOCKS 8
+
+static const uint16_t pool_block_sizes[] = PIOS_MEM_POOL_BLOCK_SIZES;
+#define PIOS_MEM_POOL_NUM          NELEMENTS(pool_block_sizes)
+
+static void *pool_free_list[PIOS_MEM_POOL_NUM];
+static uint32_t mem_usage[PIOS_MEM_TAG_NUM];
+
+static void account(enum pios_mem_tag tag, int32_t bytes)
+{
+    PIOS_IRQ_Disable();
+    mem_usage[tag] += bytes;
+    PIOS_IRQ_Enable();
+}
+
+void *pios_fastheapmalloc_tagged(size_t size, enum pios_mem_tag tag)
+{
+    void *p = pios_fastheapmalloc(size);
+
+    if (p) {
+        account(tag, size);
+    }
+    return p;
+}
+
+void *pios_malloc_tagged(size_t size, enum pios_mem_tag tag)
+{
+    void *p = pios_malloc(size);
+
+    if (p) {
+        account(tag, size);
+    }
+    return p;
+}
+
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+static int8_t pool_index(size_t size)
+{
+    for (uint8_t i = 0; i < PIOS_MEM_POOL_NUM; i++) {
+        if (size <= pool_block_sizes[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+#endif
+
+void *pios_pool_malloc(size_t size, enum pios_mem_tag tag)
+{
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+    int8_t pool = pool_index(size);
+
+    if (pool >= 0) {
+        uint16_t block_size = pool_block_sizes[pool];
+
+        PIOS_IRQ_Disable();
+        void *p = pool_free_list[pool];
+        if (p) {
+            pool_free_list[pool] = *(void **)p;
+            mem_usage[tag] += block_size;
+        }
+        PIOS_IRQ_Enable();
+        if (p) {
+            return p;
+        }
+
+        // pool is empty, carve a new chunk and hand out its first block
+        uint8_t *chunk = (uint8_t *)pios_fastheapmalloc(block_size * PIOS_MEM_POOL_CHUNK_BLOCKS);
+        if (!chunk) {
+            return NULL;
+        }
+        PIOS_IRQ_Disable();
+        for (uint8_t i = 1; i < PIOS_MEM_POOL_CHUNK_BLOCKS; i++) {
+            void **block = (void **)(chunk + i * block_size);
+            *block = pool_free_list[pool];
+            pool_free_list[pool] = block;
+        }
+        mem_usage[tag] += block_size;
+        PIOS_IRQ_Enable();
+        return chunk;
+    }
+#endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
+    return pios_fastheapmalloc_tagged(size, tag);
+}
+
+void pios_pool_free(void *p, size_t size, enum pios_mem_tag tag)
+{
+    if (!p) {
+        return;
+    }
+#ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
+    int8_t pool = pool_index(size);
+
+    if (pool >= 0) {
+        PIOS_IRQ_Disable();
+        *(void **)p = pool_free_list[pool];
+        pool_free_list[pool] = p;
+        mem_usage[tag] -= pool_block_sizes[pool];
+        PIOS_IRQ_Enable();
+        return;
+    }
+#endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
+    pios_free(p);
+    account(tag, -(int32_t)size);
+}
+
+uint32_t pios_mem_get_usage(enum pios_mem_tag tag)
+{
+    if (tag >= PIOS_MEM_TAG_NUM) {
+        return 0;
+    }
+    return mem_usage[tag];
+}
@@ -46,24 +46,50 @@ enum pios_mpu6000_dev_magic {
 bool PIOS_MPU6000_driver_Test(uintptr_t context);
 void PIOS_MPU6000_driver_Reset(uintptr_t context);
 void PIOS_MPU6000_driver_get_scale(float *scales, uint8_t size, uintptr_t context);
-QueueHandle_t PIOS_MPU6000_driver_get_queue(uintptr_t context);
+PIOS_SENSORS_Ring *PIOS_MPU6000_driver_get_ring(uintptr_t context);
 
 const PIOS_SENSORS_Driver PIOS_MPU6000_Driver = {
-    .test      = PIOS_MPU6000_driver_Test,
-    .poll      = NULL,
-    .fetch     = NULL,
-    .reset     = PIOS_MPU6000_driver_Reset,
-    .get_queue = PIOS_MPU6000_driver_get_queue,
-    .get_scale = PIOS_MPU6000_driver_get_scale,
-    .is_polled = false,
+    .test           = PIOS_MPU6000_driver_Test,
+    .poll           = NULL,
+    .fetch          = NULL,
+    .reset          = PIOS_MPU6000_driver_Reset,
+    .get_ring       = PIOS_MPU6000_driver_get_ring,
+    .get_scale      = PIOS_MPU6000_driver_get_scale,
+    .get_poll_delay = NULL,
+    .is_polled      = false,
+    .signals_ready  = false,
 };
 //
 
 
+/**
+ * Rotation to OP convention. The datasheet defines X as towards the right and
+ * Y as forward, OP convention transposes this, and Z is defined negatively.
+ * OP X and Y take the chip axis given by *_axis, complemented when *_flip is -1:
+ * ~v == -1 - v negates within the -32768 +32767 range without a branch.
+ */
+struct mpu6000_rotation {
+    uint8_t x_axis;
+    int16_t x_flip;
+    uint8_t y_axis;
+    int16_t y_flip;
+};
+
+// Currently we only support rotations on top
+static const struct mpu6000_rotation mpu6000_rotations[] = {
+    [PIOS_MPU6000_TOP_0DEG]   = { .x_axis = 1, .x_flip = 0,  .y_axis = 0, .y_flip = 0  },
+    [PIOS_MPU6000_TOP_90DEG]  = { .x_axis = 0, .x_flip = 0,  .y_axis = 1, .y_flip = -1 },
+    [PIOS_MPU6000_TOP_180DEG] = { .x_axis = 1, .x_flip = -1, .y_axis = 0, .y_flip = -1 },
+    [PIOS_MPU6000_TOP_270DEG] = { .x_axis = 0, .x_flip = -1, .y_axis = 1, .y_flip = 0  },
+};
+
 struct mpu6000_dev {
     uint32_t spi_id;
     uint32_t slave_num;
-    QueueHandle_t queue;
+    PIOS_SENSORS_Ring *ring;
+    const PIOS_SENSORS_Instance *sensor; // raises the sensors task event, NULL until registered
+    const struct mpu6000_rotation *rotation;
+    uint8_t fifo_pending; // data ready interrupts since the last FIFO read
     const struct pios_mpu6000_cfg *cfg;
     enum pios_mpu6000_range gyro_range;
     enum pios_mpu6000_accel_range accel_range;
@@ -74,34 +100,43 @@ struct mpu6000_dev {
 #define PIOS_MPU6000_SAMPLES_BYTES    14
 #define PIOS_MPU6000_SENSOR_FIRST_REG PIOS_MPU6000_ACCEL_X_OUT_MSB
 
+// one sample as laid out in the registers from ACCEL_X_OUT on, and in the FIFO
+typedef struct {
+    uint8_t Accel_X_h;
+    uint8_t Accel_X_l;
+    uint8_t Accel_Y_h;
+    uint8_t Accel_Y_l;
+    uint8_t Accel_Z_h;
+    uint8_t Accel_Z_l;
+    uint8_t Temperature_h;
+    uint8_t Temperature_l;
+    uint8_t Gyro_X_h;
+    uint8_t Gyro_X_l;
+    uint8_t Gyro_Y_h;
+    uint8_t Gyro_Y_l;
+    uint8_t Gyro_Z_h;
+    uint8_t Gyro_Z_l;
+} mpu6000_sample_t;
+
 typedef union {
     uint8_t buffer[1 + PIOS_MPU6000_SAMPLES_BYTES];
     struct {
         uint8_t dummy;
-        uint8_t Accel_X_h;
-        uint8_t Accel_X_l;
-        uint8_t Accel_Y_h;
-        uint8_t Accel_Y_l;
-        uint8_t Accel_Z_h;
-        uint8_t Accel_Z_l;
-        uint8_t Temperature_h;
-        uint8_t Temperature_l;
-        uint8_t Gyro_X_h;
-        uint8_t Gyro_X_l;
-        uint8_t Gyro_Y_h;
-        uint8_t Gyro_Y_l;
-        uint8_t Gyro_Z_h;
-        uint8_t Gyro_Z_l;
+        mpu6000_sample_t sample;
     } data;
 } mpu6000_data_t;
 
-#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr.data.sensor##_h << 8 | mpudataptr.data.sensor##_l)
+#define GET_SENSOR_DATA(sampleptr, sensor) ((sampleptr)->sensor##_h << 8 | (sampleptr)->sensor##_l)
 
 // ! Global structure for this device device
 static struct mpu6000_dev *dev;
 volatile bool mpu6000_configured = false;
 static mpu6000_data_t mpu6000_data;
-static PIOS_SENSORS_3Axis_SensorsWithTemp *queue_data = 0;
+static mpu6000_sample_t mpu6000_fifo_data[PIOS_MPU6000_MAX_FIFO_BATCH];
+static const uint8_t mpu6000_send_buf[1 + PIOS_MPU6000_SAMPLES_BYTES] = { PIOS_MPU6000_SENSOR_FIRST_REG | 0x80 };
+// sample read queued on the bus while another device holds it
+static struct pios_spi_txn mpu6000_read_txn;
+static volatile bool mpu6000_read_queued;
 #define SENSOR_COUNT     2
 #define SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16) * SENSOR_COUNT)
 // ! Private functions
@@ -111,14 +146,19 @@ static void PIOS_MPU6000_Config(struct pios_mpu6000_cfg const *cfg);
 static int32_t PIOS_MPU6000_SetReg(uint8_t address, uint8_t buffer);
 static int32_t PIOS_MPU6000_GetReg(uint8_t address);
 static void PIOS_MPU6000_SetSpeed(const bool fast);
-static bool PIOS_MPU6000_HandleData();
+static bool PIOS_MPU6000_StoreSample(const mpu6000_sample_t *raw);
 static bool PIOS_MPU6000_ReadSensor(bool *woken);
+static bool PIOS_MPU6000_ReadFifo(bool *woken);
+static void PIOS_MPU6000_QueueRead();
+static void PIOS_MPU6000_ReadDone(int32_t result, void *context);
+static bool PIOS_MPU6000_FifoMode();
 
 static int32_t PIOS_MPU6000_Test(void);
 
 void PIOS_MPU6000_Register()
 {
-    PIOS_SENSORS_Register(&PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    PIOS_Assert(dev);
+    dev->sensor = PIOS_SENSORS_Register(&PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
 }
 /**
  * @brief Allocate a new device
@@ -132,12 +172,12 @@ static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg
 
     mpu6000_dev->magic = PIOS_MPU6000_DEV_MAGIC;
 
-    mpu6000_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
-    PIOS_Assert(mpu6000_dev->queue);
-
-    queue_data = (PIOS_SENSORS_3Axis_SensorsWithTemp *)pios_malloc(SENSOR_DATA_SIZE);
-    PIOS_Assert(queue_data);
-    queue_data->count = SENSOR_COUNT;
+    PIOS_Assert(cfg->orientation < NELEMENTS(mpu6000_rotations));
+    mpu6000_dev->rotation = &mpu6000_rotations[cfg->orientation];
+    // room for whole FIFO batches on top of what the consumer may leave between two reads
+    uint16_t batch = MIN(cfg->fifo_batch, PIOS_MPU6000_MAX_FIFO_BATCH);
+    mpu6000_dev->fifo_pending = 0;
+    mpu6000_dev->ring = PIOS_SENSORS_RingCreate(cfg->max_downsample + 1 + batch, SENSOR_DATA_SIZE);
     return mpu6000_dev;
 }
 
@@ -174,6 +214,12 @@ int32_t PIOS_MPU6000_Init(uint32_t spi_id, uint32_t slave_num, const struct pios
     dev->slave_num = slave_num;
     dev->cfg = cfg;
 
+    mpu6000_read_txn.slave_id      = slave_num;
+    mpu6000_read_txn.send_buf      = mpu6000_send_buf;
+    mpu6000_read_txn.recv_buf      = mpu6000_data.buffer;
+    mpu6000_read_txn.len           = sizeof(mpu6000_data_t);
+    mpu6000_read_txn.keep_selected = false;
+
     /* Configure the MPU6000 Sensor */
     PIOS_MPU6000_Config(cfg);
 
@@ -229,13 +275,17 @@ static void PIOS_MPU6000_Config(struct pios_mpu6000_cfg const *cfg)
         ;
     }
 
-    // FIFO storage
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, cfg->Fifo_store) != 0) {
+    // FIFO storage, the FIFO mode needs full samples in register order
+    const uint8_t fifo_store = PIOS_MPU6000_FifoMode() ?
+                               PIOS_MPU6000_ACCEL_OUT | PIOS_MPU6000_FIFO_TEMP_OUT | PIOS_MPU6000_FIFO_GYRO_X_OUT |
+                               PIOS_MPU6000_FIFO_GYRO_Y_OUT | PIOS_MPU6000_FIFO_GYRO_Z_OUT : cfg->Fifo_store;
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, fifo_store) != 0) {
         ;
     }
     PIOS_MPU6000_ConfigureRanges(cfg->gyro_range, cfg->accel_range, cfg->filter);
     // Interrupt configuration
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, cfg->User_ctl) != 0) {
+    const uint8_t user_ctl = PIOS_MPU6000_FifoMode() ? cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST : cfg->User_ctl;
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, user_ctl) != 0) {
         ;
     }
 
@@ -461,19 +511,6 @@ int32_t PIOS_MPU6000_ReadID()
     return mpu6000_id;
 }
 
-/**
- * \brief Reads the queue handle
- * \return Handle to the queue or null if invalid device
- */
-xQueueHandle PIOS_MPU6000_GetQueue()
-{
-    if (PIOS_MPU6000_Validate(dev) != 0) {
-        return (xQueueHandle)NULL;
-    }
-
-    return dev->queue;
-}
-
 
 static float PIOS_MPU6000_GetScale()
 {
@@ -546,70 +583,76 @@ bool PIOS_MPU6000_IRQHandler(void)
         return false;
     }
 
+    if (!dev->ring) {
+        return false;
+    }
+
     bool read_ok = false;
-    read_ok = PIOS_MPU6000_ReadSensor(&woken);
+    if (PIOS_MPU6000_FifoMode()) {
+        // the chip has no FIFO threshold interrupt, so data ready is only counted until a batch is due
+        if (++dev->fifo_pending < dev->cfg->fifo_batch) {
+            return false;
+        }
+        dev->fifo_pending = 0;
+        read_ok = PIOS_MPU6000_ReadFifo(&woken);
+    } else {
+        read_ok = PIOS_MPU6000_ReadSensor(&woken) && PIOS_MPU6000_StoreSample(&mpu6000_data.data.sample);
+    }
 
     if (read_ok) {
-        bool woken2 = PIOS_MPU6000_HandleData();
-        woken |= woken2;
+        woken |= PIOS_SENSORS_RingNotifyFromISR(dev->ring);
+        woken |= PIOS_SENSORS_RaiseEventFromISR(dev->sensor);
     }
 
     return woken;
 }
 
-static bool PIOS_MPU6000_HandleData()
+static bool PIOS_MPU6000_FifoMode()
+{
+    return dev->cfg->fifo_batch > 1;
+}
+
+/**
+ * @brief Rotate a raw sample to OP convention and add it to the ring
+ * @return false if the ring is full and the sample was dropped
+ */
+static bool PIOS_MPU6000_StoreSample(const mpu6000_sample_t *raw)
 {
-    if (!queue_data) {
+    // the sample is built in place in the ring, when the consumer is behind it is dropped
+    PIOS_SENSORS_3Axis_SensorsWithTemp *data = PIOS_SENSORS_RingWriteSlot(dev->ring);
+
+    if (!data) {
         return false;
     }
 
-    // Rotate the sensor to OP convention.  The datasheet defines X as towards the right
-    // and Y as forward.  OP convention transposes this.  Also the Z is defined negatively
-    // to our convention
-
-    // Currently we only support rotations on top so switch X/Y accordingly
-    switch (dev->cfg->orientation) {
-    case PIOS_MPU6000_TOP_0DEG:
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
-        break;
-    case PIOS_MPU6000_TOP_90DEG:
-        // -1 to bring it back to -32768 +32767 range
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
-        break;
-    case PIOS_MPU6000_TOP_180DEG:
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
-        break;
-    case PIOS_MPU6000_TOP_270DEG:
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
-        break;
-    }
-    queue_data->sample[0].z = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Z));
-    queue_data->sample[1].z = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Z));
-    const int16_t temp = GET_SENSOR_DATA(mpu6000_data, Temperature);
-    queue_data->temperature = 3500 + ((float)(temp + 512)) * (1.0f / 3.4f);
-
-    BaseType_t higherPriorityTaskWoken;
-    xQueueSendToBackFromISR(dev->queue, (void *)queue_data, &higherPriorityTaskWoken);
-    return higherPriorityTaskWoken == pdTRUE;
+    const struct mpu6000_rotation *rotation = dev->rotation;
+    const int16_t accel[2] = { GET_SENSOR_DATA(raw, Accel_X), GET_SENSOR_DATA(raw, Accel_Y) };
+    const int16_t gyro[2]  = { GET_SENSOR_DATA(raw, Gyro_X), GET_SENSOR_DATA(raw, Gyro_Y) };
+
+    data->count = SENSOR_COUNT;
+    data->sample[0].x = accel[rotation->x_axis] ^ rotation->x_flip;
+    data->sample[0].y = accel[rotation->y_axis] ^ rotation->y_flip;
+    data->sample[1].x = gyro[rotation->x_axis] ^ rotation->x_flip;
+    data->sample[1].y = gyro[rotation->y_axis] ^ rotation->y_flip;
+    data->sample[0].z = -1 - (GET_SENSOR_DATA(raw, Accel_Z));
+    data->sample[1].z = -1 - (GET_SENSOR_DATA(raw, Gyro_Z));
+    const int16_t temp = GET_SENSOR_DATA(raw, Temperature);
+    data->temperature = 3500 + ((float)(temp + 512)) * (1.0f / 3.4f);
+
+    PIOS_SENSORS_RingCommit(dev->ring);
+    return true;
 }
 
 static bool PIOS_MPU6000_ReadSensor(bool *woken)
 {
-    const uint8_t mpu6000_send_buf[1 + PIOS_MPU6000_SAMPLES_BYTES] = { PIOS_MPU6000_SENSOR_FIRST_REG | 0x80 };
+    int32_t claimed = PIOS_MPU6000_ClaimBusISR(woken, true);
 
-    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+    if (claimed == -2) {
+        // another device holds the bus, read at the end of its transfer instead of dropping the sample
+        PIOS_MPU6000_QueueRead();
+        return false;
+    }
+    if (claimed != 0) {
         return false;
     }
     if (PIOS_SPI_TransferBlock(dev->spi_id, &mpu6000_send_buf[0], &mpu6000_data.buffer[0], sizeof(mpu6000_data_t), NULL) < 0) {
@@ -620,6 +663,83 @@ static bool PIOS_MPU6000_ReadSensor(bool *woken)
     return true;
 }
 
+/**
+ * @brief Queue a high priority sample read, it runs before the other devices get the bus again
+ */
+static void PIOS_MPU6000_QueueRead()
+{
+    if (mpu6000_read_queued) {
+        return;
+    }
+    mpu6000_read_queued = true;
+    if (PIOS_SPI_TransferAsync(dev->spi_id, &mpu6000_read_txn, 1, dev->cfg->fast_prescaler,
+                               PIOS_SPI_PRIORITY_HIGH, PIOS_MPU6000_ReadDone, NULL) != 0) {
+        mpu6000_read_queued = false;
+    }
+}
+
+/**
+ * @brief Queued sample read done, called from the SPI DMA interrupt
+ */
+static void PIOS_MPU6000_ReadDone(int32_t result, __attribute__((unused)) void *context)
+{
+    mpu6000_read_queued = false;
+    if (result < 0 || !PIOS_MPU6000_StoreSample(&mpu6000_data.data.sample)) {
+        return;
+    }
+
+    bool woken = PIOS_SENSORS_RingNotifyFromISR(dev->ring);
+    woken |= PIOS_SENSORS_RaiseEventFromISR(dev->sensor);
+    portEND_SWITCHING_ISR(woken ? pdTRUE : pdFALSE);
+}
+
+/**
+ * @brief Read the samples queued in the chip FIFO with a single bus claim, in one DMA block
+ * @return true if at least one sample was added to the ring
+ */
+static bool PIOS_MPU6000_ReadFifo(bool *woken)
+{
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return false;
+    }
+
+    PIOS_SPI_TransferByte(dev->spi_id, 0x80 | PIOS_MPU6000_FIFO_CNT_MSB);
+    uint16_t fifo_count = PIOS_SPI_TransferByte(dev->spi_id, 0) << 8;
+    fifo_count |= PIOS_SPI_TransferByte(dev->spi_id, 0);
+    PIOS_SPI_RC_PinSet(dev->spi_id, dev->slave_num, 1);
+
+    uint16_t samples = fifo_count / PIOS_MPU6000_SAMPLES_BYTES;
+    if (fifo_count % PIOS_MPU6000_SAMPLES_BYTES || fifo_count > PIOS_MPU6000_FIFO_SIZE - PIOS_MPU6000_SAMPLES_BYTES) {
+        // overflowed, the samples are no longer aligned, start over
+        PIOS_SPI_RC_PinSet(dev->spi_id, dev->slave_num, 0);
+        PIOS_SPI_TransferByte(dev->spi_id, 0x7f & PIOS_MPU6000_USER_CTRL_REG);
+        PIOS_SPI_TransferByte(dev->spi_id, dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST);
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+    if (samples > PIOS_MPU6000_MAX_FIFO_BATCH) {
+        samples = PIOS_MPU6000_MAX_FIFO_BATCH; // the rest is read next time
+    }
+    if (!samples) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+
+    PIOS_SPI_RC_PinSet(dev->spi_id, dev->slave_num, 0);
+    PIOS_SPI_TransferByte(dev->spi_id, 0x80 | PIOS_MPU6000_FIFO_REG);
+    if (PIOS_SPI_TransferBlock(dev->spi_id, NULL, (uint8_t *)mpu6000_fifo_data, samples * PIOS_MPU6000_SAMPLES_BYTES, NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return false;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+
+    bool stored = false;
+    for (uint16_t i = 0; i < samples; i++) {
+        stored |= PIOS_MPU6000_StoreSample(&mpu6000_fifo_data[i]);
+    }
+    return stored;
+}
+
 // Sensor driver implementation
 bool PIOS_MPU6000_driver_Test(__attribute__((unused)) uintptr_t context)
 {
@@ -628,6 +748,10 @@ bool PIOS_MPU6000_driver_Test(__attribute__((unused)) uintptr_t context)
 
 void PIOS_MPU6000_driver_Reset(__attribute__((unused)) uintptr_t context)
 {
+    if (PIOS_MPU6000_FifoMode()) {
+        dev->fifo_pending = 0;
+        PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST);
+    }
     PIOS_MPU6000_DummyReadGyros();
 }
 
@@ -638,9 +762,9 @@ void PIOS_MPU6000_driver_get_scale(float *scales, uint8_t size, __attribute__((u
     scales[1] = PIOS_MPU6000_GetScale();
 }
 
-QueueHandle_t PIOS_MPU6000_driver_get_queue(__attribute__((unused)) uintptr_t context)
+PIOS_SENSORS_Ring *PIOS_MPU6000_driver_get_ring(__attribute__((unused)) uintptr_t context)
 {
-    return dev->queue;
+    return dev->ring;
 }
 #endif /* PIOS_INCLUDE_MPU6000 */
 
@@ -97,15 +97,18 @@ void PIOS_MS5611_driver_Reset(uintptr_t context);
 void PIOS_MS5611_driver_get_scale(float *scales, uint8_t size, uintptr_t context);
 void PIOS_MS5611_driver_fetch(void *, uint8_t size, uintptr_t context);
 bool PIOS_MS5611_driver_poll(uintptr_t context);
+uint32_t PIOS_MS5611_driver_get_poll_delay(uintptr_t context);
 
 const PIOS_SENSORS_Driver PIOS_MS5611_Driver = {
-    .test      = PIOS_MS5611_driver_Test,
-    .poll      = PIOS_MS5611_driver_poll,
-    .fetch     = PIOS_MS5611_driver_fetch,
-    .reset     = PIOS_MS5611_driver_Reset,
-    .get_queue = NULL,
-    .get_scale = PIOS_MS5611_driver_get_scale,
-    .is_polled = true,
+    .test           = PIOS_MS5611_driver_Test,
+    .poll           = PIOS_MS5611_driver_poll,
+    .fetch          = PIOS_MS5611_driver_fetch,
+    .reset          = PIOS_MS5611_driver_Reset,
+    .get_ring       = NULL,
+    .get_scale      = PIOS_MS5611_driver_get_scale,
+    .get_poll_delay = PIOS_MS5611_driver_get_poll_delay,
+    .is_polled      = true,
+    .signals_ready  = false,
 };
 /**
  * Initialise the MS5611 sensor
@@ -468,6 +471,13 @@ bool PIOS_MS5611_driver_poll(__attribute__((unused)) uintptr_t context)
     return false;
 }
 
+uint32_t PIOS_MS5611_driver_get_poll_delay(__attribute__((unused)) uintptr_t context)
+{
+    // the conversion started by the last poll completes after conversionDelayUs
+    uint32_t elapsed = PIOS_DELAY_DiffuS(lastConversionStart);
+
+    return (elapsed < conversionDelayUs) ? conversionDelayUs - elapsed : 0;
+}
 
 #endif /* PIOS_INCLUDE_MS5611 */
 
@@ -145,6 +145,30 @@ xSemaphoreHandle PIOS_RCVR_GetSemaphore(uint32_t rcvr_id, uint8_t channel)
     return NULL;
 }
 
+/**
+ * @brief Get the time the driver decoded its last complete frame.
+ * @param[in] rcvr_id driver to query
+ * @returns PIOS_DELAY raw timestamp of the frame, or 0 if not supported.
+ */
+uint32_t PIOS_RCVR_GetFrameTime(uint32_t rcvr_id)
+{
+    if (rcvr_id == 0) {
+        return 0;
+    }
+
+    struct pios_rcvr_dev *rcvr_dev = (struct pios_rcvr_dev *)rcvr_id;
+
+    if (!PIOS_RCVR_validate(rcvr_dev)) {
+        /* Undefined RCVR port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+
+    if (rcvr_dev->driver->get_frame_time) {
+        return rcvr_dev->driver->get_frame_time(rcvr_dev->lower_id);
+    }
+    return 0;
+}
+
 #endif /* PIOS_INCLUDE_RCVR */
 
 /**
@@ -185,6 +185,8 @@ static enum pios_radio_event rfm22_timeout(struct pios_rfm22b_dev *rfm22b_dev);
 static enum pios_radio_event rfm22_error(struct pios_rfm22b_dev *rfm22b_dev);
 static enum pios_radio_event rfm22_fatal_error(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22b_add_rx_status(struct pios_rfm22b_dev *rfm22b_dev, enum pios_rfm22b_rx_packet_status status);
+static void rfm22_addPacketSample(struct pios_rfm22b_dev *rfm22b_dev, enum pios_rfm22b_rx_packet_status status);
+static void rfm22_adaptPacketLength(struct pios_rfm22b_dev *rfm22b_dev, enum pios_rfm22b_rx_packet_status status);
 static void rfm22_setNominalCarrierFrequency(struct pios_rfm22b_dev *rfm22b_dev, uint8_t init_chan);
 static bool rfm22_setFreqHopChannel(struct pios_rfm22b_dev *rfm22b_dev, uint8_t channel);
 static void rfm22_updatePairStatus(struct pios_rfm22b_dev *radio_dev);
@@ -419,6 +421,8 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
 
     // Initialize the stats.
     rfm22b_dev->stats.packets_per_sec = 0;
+    rfm22b_dev->stats.tx_payload_count = 0;
+    rfm22b_dev->tx_airtime_us = 0;
     rfm22b_dev->stats.rx_good = 0;
     rfm22b_dev->stats.rx_corrected    = 0;
     rfm22b_dev->stats.rx_error     = 0;
@@ -431,6 +435,9 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
     rfm22b_dev->stats.tx_seq       = 0;
     rfm22b_dev->stats.rx_seq       = 0;
     rfm22b_dev->stats.tx_failure   = 0;
+    memset(&rfm22b_dev->link_summary, 0, sizeof(rfm22b_dev->link_summary));
+    rfm22b_dev->packet_samples_wr  = 0;
+    rfm22b_dev->packet_samples_rd  = 0;
 
     // Initialize the channels.
     PIOS_RFM22B_SetChannelConfig(*rfm22b_id, RFM22B_DEFAULT_RX_DATARATE, RFM22B_DEFAULT_MIN_CHANNEL,
@@ -620,6 +627,8 @@ void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarate datar
     if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
         rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
     }
+    // Start with full packets, rfm22_adaptPacketLength() shortens them on a poor link
+    rfm22b_dev->tx_data_len = rfm22b_dev->max_packet_len;
 }
 
 /**
@@ -668,11 +677,64 @@ void PIOS_RFM22B_GetStats(uint32_t rfm22b_id, struct rfm22b_stats *stats)
 
     // Calculate the current link quality
     rfm22_calculateLinkQuality(rfm22b_dev);
+    rfm22b_dev->stats.tx_airtime_ms = (uint16_t)(rfm22b_dev->tx_airtime_us / 1000);
+    rfm22b_dev->stats.tx_packet_len = rfm22b_dev->tx_data_len;
 
     // Return the stats.
     *stats = rfm22b_dev->stats;
 }
 
+/**
+ * Returns the packet counters accumulated since the previous call and restarts them.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @param[out] summary The counters are returned in this structure
+ */
+void PIOS_RFM22B_GetLinkSummary(uint32_t rfm22b_id, struct rfm22b_link_summary *summary)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (!PIOS_RFM22B_Validate(rfm22b_dev)) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+
+    // The radio task counts the packets, none must be lost between the copy and the reset
+    PIOS_IRQ_Disable();
+    *summary = rfm22b_dev->link_summary;
+    memset(&rfm22b_dev->link_summary, 0, sizeof(rfm22b_dev->link_summary));
+    PIOS_IRQ_Enable();
+}
+
+/**
+ * Takes the oldest samples of the received packets out of the driver ring.
+ * The ring keeps the last RFM22B_PACKET_SAMPLES packets not taken yet, the
+ * newer packets are not sampled while it is full.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @param[out] samples The array to store the samples in.
+ * @param[in] max_samples The length of the samples array.
+ * @return The number of samples returned.
+ */
+uint8_t PIOS_RFM22B_GetPacketSamples(uint32_t rfm22b_id, struct rfm22b_packet_sample *samples, uint8_t max_samples)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (!PIOS_RFM22B_Validate(rfm22b_dev)) {
+        return 0;
+    }
+
+    // Only the radio task moves the write index and only the caller the read index
+    uint8_t n = 0;
+    uint8_t rd = rfm22b_dev->packet_samples_rd;
+    while (n < max_samples && rd != rfm22b_dev->packet_samples_wr) {
+        samples[n++] = rfm22b_dev->packet_samples[rd & (RFM22B_PACKET_SAMPLES - 1)];
+        rfm22b_dev->packet_samples_rd = ++rd;
+    }
+
+    return n;
+}
+
 /**
  * Get the stats of the oter radio devices that are in range.
  *
@@ -790,6 +852,8 @@ bool PIOS_RFM22B_TransmitPacket(uint32_t rfm22b_id, uint8_t *p, uint8_t len)
 
     rfm22b_dev->tx_packet_handle     = p;
     rfm22b_dev->stats.tx_byte_count += len;
+    rfm22b_dev->link_summary.tx_packets++;
+    rfm22b_dev->tx_airtime_us += (uint32_t)(TX_PREAMBLE_NIBBLES / 2 + SYNC_BYTES + HEADER_BYTES + LENGTH_BYTES + len) * 8000000 / data_rate[rfm22b_dev->datarate];
     rfm22b_dev->packet_start_ticks   = xTaskGetTickCount();
     if (rfm22b_dev->packet_start_ticks == 0) {
         rfm22b_dev->packet_start_ticks = 1;
@@ -1753,7 +1817,7 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
 {
     uint8_t *p  = radio_dev->tx_packet;
     uint8_t len = 0;
-    uint8_t max_data_len = radio_dev->max_packet_len - (radio_dev->ppm_only_mode ? 0 : RS_ECC_NPARITY);
+    uint8_t max_data_len = (radio_dev->ppm_only_mode ? radio_dev->max_packet_len : radio_dev->tx_data_len - RS_ECC_NPARITY);
 
     // Don't send if it's not our turn, or if we're receiving a packet.
     if (!rfm22_timeToSend(radio_dev) || !PIOS_RFM22B_InRxWait((uint32_t)radio_dev)) {
@@ -1813,9 +1877,19 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
 
     // Append data from the com interface if applicable.
     if (!radio_dev->ppm_only_mode && radio_dev->tx_out_cb) {
-        // Try to get some data to send
+        // Fill the packet with everything queued, a callback may return less than available
+        // when its buffer wraps or when more is queued meanwhile
         bool need_yield = false;
-        len += (radio_dev->tx_out_cb)(radio_dev->tx_out_context, p + len, max_data_len - len, NULL, &need_yield);
+        uint8_t com_len = 0;
+        while (len < max_data_len) {
+            uint16_t bytes = (radio_dev->tx_out_cb)(radio_dev->tx_out_context, p + len, max_data_len - len, NULL, &need_yield);
+            if (bytes == 0) {
+                break;
+            }
+            len     += bytes;
+            com_len += bytes;
+        }
+        radio_dev->stats.tx_payload_count += com_len;
     }
 
     // Always send a packet if this modem is a coordinator.
@@ -2135,6 +2209,85 @@ static void rfm22b_add_rx_status(struct pios_rfm22b_dev *rfm22b_dev, enum pios_r
         rfm22b_dev->rx_packet_stats[i] = (rfm22b_dev->rx_packet_stats[i] << 2) | (rfm22b_dev->rx_packet_stats[i - 1] >> 30);
     }
     rfm22b_dev->rx_packet_stats[0] = (rfm22b_dev->rx_packet_stats[0] << 2) | status;
+
+    rfm22_addPacketSample(rfm22b_dev, status);
+    rfm22_adaptPacketLength(rfm22b_dev, status);
+}
+
+/**
+ * Count a received packet in the link summary and keep its sample.
+ * The RSSI of a failed packet is the one of the previous packet, it is left out.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] status  The status of the packet just received
+ */
+static void rfm22_addPacketSample(struct pios_rfm22b_dev *rfm22b_dev, enum pios_rfm22b_rx_packet_status status)
+{
+    struct rfm22b_link_summary *summary = &rfm22b_dev->link_summary;
+    int8_t rssi = rfm22b_dev->rssi_dBm;
+
+    if (status != RADIO_FAILURE_RX_PACKET) {
+        int16_t bucket = ((int16_t)rssi - RFM22B_RSSI_BUCKET_MIN) / RFM22B_RSSI_BUCKET_DB;
+        bucket = MAX(0, MIN(RFM22B_RSSI_BUCKETS - 1, bucket));
+        if (summary->rx_packets[RADIO_GOOD_RX_PACKET] + summary->rx_packets[RADIO_CORRECTED_RX_PACKET] + summary->rx_packets[RADIO_ERROR_RX_PACKET] == 0) {
+            summary->rx_rssi_min = summary->rx_rssi_max = rssi;
+        }
+        summary->rx_rssi_histogram[bucket]++;
+        summary->rx_rssi_sum += rssi;
+        summary->rx_rssi_min  = MIN(summary->rx_rssi_min, rssi);
+        summary->rx_rssi_max  = MAX(summary->rx_rssi_max, rssi);
+    }
+    summary->rx_packets[status]++;
+
+    uint8_t wr = rfm22b_dev->packet_samples_wr;
+    if ((uint8_t)(wr - rfm22b_dev->packet_samples_rd) < RFM22B_PACKET_SAMPLES) {
+        struct rfm22b_packet_sample *sample = &rfm22b_dev->packet_samples[wr & (RFM22B_PACKET_SAMPLES - 1)];
+        sample->time_ms = (uint16_t)(xTaskGetTickCount() * portTICK_RATE_MS);
+        sample->rssi    = rssi;
+        sample->status  = status;
+        rfm22b_dev->packet_samples_wr = wr + 1;
+    }
+}
+
+/**
+ * Adapt the packet length to the receive error history.
+ *
+ * The datarate can not follow the link quality: both modems derive their hop sequence and
+ * slot timing from it. The packet length is free, the receiver accepts anything up to
+ * max_packet_len, and a shorter packet is less likely to take more errors than the parity
+ * corrects. Both directions share the channels so the local receive errors stand for the
+ * errors of our packets: the length is cut by a quarter on every lost packet and grows back
+ * a byte per good one.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] status  The status of the packet just received
+ */
+static void rfm22_adaptPacketLength(struct pios_rfm22b_dev *rfm22b_dev, enum pios_rfm22b_rx_packet_status status)
+{
+    uint8_t min_len = RFM22B_MIN_ADAPTIVE_DATA_LEN;
+
+    // The PPM data must always fit
+    if (rfm22b_dev->ppm_send_mode) {
+        min_len = MAX(min_len, RFM22B_PPM_NUM_CHANNELS + 1 + RS_ECC_NPARITY);
+    }
+    if (min_len >= rfm22b_dev->max_packet_len) {
+        rfm22b_dev->tx_data_len = rfm22b_dev->max_packet_len;
+        return;
+    }
+
+    switch (status) {
+    case RADIO_ERROR_RX_PACKET:
+    case RADIO_FAILURE_RX_PACKET:
+        rfm22b_dev->tx_data_len = MAX(min_len, rfm22b_dev->tx_data_len - rfm22b_dev->tx_data_len / 4);
+        break;
+    case RADIO_GOOD_RX_PACKET:
+        if (rfm22b_dev->tx_data_len < rfm22b_dev->max_packet_len) {
+            rfm22b_dev->tx_data_len++;
+        }
+        break;
+    default:
+        break;
+    }
 }
 
 
@@ -2317,6 +2470,7 @@ static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev)
 static enum pios_radio_event rfm22_txFailure(struct pios_rfm22b_dev *rfm22b_dev)
 {
     rfm22b_dev->stats.tx_failure++;
+    rfm22b_dev->link_summary.tx_failures++;
     rfm22b_dev->packet_start_ticks = 0;
     rfm22b_dev->tx_data_wr = rfm22b_dev->tx_data_rd = 0;
     return RADIO_EVENT_TX_START;
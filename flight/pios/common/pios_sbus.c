@@ -42,11 +42,19 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
                                        uint16_t *headroom,
                                        bool *need_yield);
 static void PIOS_SBus_Supervisor(uint32_t sbus_id);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_SBus_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
+static uint32_t PIOS_SBus_Get_Frame_Time(uint32_t rcvr_id);
 
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_sbus_rcvr_driver = {
-    .read = PIOS_SBus_Get,
+    .read           = PIOS_SBus_Get,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore  = PIOS_SBus_Get_Semaphore,
+#endif
+    .get_frame_time = PIOS_SBus_Get_Frame_Time,
 };
 
 enum pios_sbus_dev_magic {
@@ -66,6 +74,10 @@ struct pios_sbus_dev {
     enum pios_sbus_dev_magic   magic;
     const struct pios_sbus_cfg *cfg;
     struct pios_sbus_state     state;
+    uint32_t                   frame_time;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreHandle           new_frame_semaphore;
+#endif
 };
 
 /* Allocate S.Bus device descriptor */
@@ -141,7 +153,11 @@ int32_t PIOS_SBus_Init(uint32_t *sbus_id,
     }
 
     /* Bind the configuration to the device instance */
-    sbus_dev->cfg = cfg;
+    sbus_dev->cfg        = cfg;
+    sbus_dev->frame_time = 0;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    sbus_dev->new_frame_semaphore = NULL;
+#endif
 
     PIOS_SBus_ResetState(&(sbus_dev->state));
 
@@ -225,12 +241,50 @@ static void PIOS_SBus_UnrollChannels(struct pios_sbus_state *state)
     *d++ = (s[22] & SBUS_FLAG_DC2) ? SBUS_VALUE_MAX : SBUS_VALUE_MIN;
 }
 
-/* Update decoder state processing input byte from the S.Bus stream */
-static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Get the semaphore given on each complete frame. A frame updates
+ * all channels at once so the channel is ignored.
+ */
+static xSemaphoreHandle PIOS_SBus_Get_Semaphore(uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)rcvr_id;
+
+    if (!PIOS_SBus_Validate(sbus_dev)) {
+        return NULL;
+    }
+
+    if (sbus_dev->new_frame_semaphore == NULL) {
+        vSemaphoreCreateBinary(sbus_dev->new_frame_semaphore);
+    }
+    return sbus_dev->new_frame_semaphore;
+}
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+/* Raw PIOS_DELAY time of the last complete frame */
+static uint32_t PIOS_SBus_Get_Frame_Time(uint32_t rcvr_id)
 {
+    struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)rcvr_id;
+
+    if (!PIOS_SBus_Validate(sbus_dev)) {
+        return 0;
+    }
+
+    return sbus_dev->frame_time;
+}
+
+/**
+ * Update decoder state processing input byte from the S.Bus stream
+ * 
+eturn true if the byte completed a frame which updated the channels
+ */
+static bool PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
+{
+    bool updated = false;
+
     /* should not process any data until new frame is found */
     if (!state->frame_found) {
-        return;
+        return false;
     }
 
     if (state->byte_count == 0) {
@@ -241,7 +295,7 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
             /* do not store the SOF byte */
             state->byte_count++;
         }
-        return;
+        return false;
     }
 
     /* do not store last frame byte as well */
@@ -258,10 +312,12 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
             } else if (flags & SBUS_FLAG_FS) {
                 /* failsafe flag active */
                 PIOS_SBus_ResetChannels(state);
+                updated = true;
             } else {
                 /* data looking good */
                 PIOS_SBus_UnrollChannels(state);
                 state->failsafe_timer = 0;
+                updated = true;
             }
         } else {
             /* discard whole frame */
@@ -270,6 +326,8 @@ static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
         /* prepare for the next frame */
         state->frame_found = 0;
     }
+
+    return updated;
 }
 
 /* Comm byte received callback */
@@ -286,10 +344,11 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
     PIOS_Assert(valid);
 
     struct pios_sbus_state *state = &(sbus_dev->state);
+    bool frame_complete = false;
 
     /* process byte(s) and clear receive timer */
     for (uint8_t i = 0; i < buf_len; i++) {
-        PIOS_SBus_UpdateState(state, buf[i]);
+        frame_complete |= PIOS_SBus_UpdateState(state, buf[i]);
         state->receive_timer = 0;
     }
 
@@ -298,9 +357,20 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
         *headroom = SBUS_FRAME_LENGTH;
     }
 
-    /* We never need a yield */
     *need_yield = false;
 
+    if (frame_complete) {
+        sbus_dev->frame_time = PIOS_DELAY_GetRaw();
+#if defined(PIOS_INCLUDE_FREERTOS)
+        /* Wake up the receiver task as soon as the frame is decoded */
+        if (sbus_dev->new_frame_semaphore != NULL) {
+            signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+            xSemaphoreGiveFromISR(sbus_dev->new_frame_semaphore, &xHigherPriorityTaskWoken);
+            *need_yield = (xHigherPriorityTaskWoken == pdTRUE);
+        }
+#endif
+    }
+
     /* Always indicate that all bytes were consumed */
     return buf_len;
 }
@@ -71,6 +71,9 @@ uint8_t PIOS_SDCARD_Sector[SECTOR_SIZE];
 #define SDCMD_SEND_STATUS            (0x40 + 13)
 #define SDCMD_SEND_STATUS_CRC        0xaf
 
+#define SDCMD_STOP_TRANSMISSION      (0x40 + 12)
+#define SDCMD_STOP_TRANSMISSION_CRC  0xff
+
 #define SDCMD_READ_SINGLE_BLOCK      (0x40 + 17)
 #define SDCMD_READ_SINGLE_BLOCK_CRC  0xff
 
@@ -80,6 +83,25 @@ uint8_t PIOS_SDCARD_Sector[SECTOR_SIZE];
 #define SDCMD_WRITE_SINGLE_BLOCK     (0x40 + 24)
 #define SDCMD_WRITE_SINGLE_BLOCK_CRC 0xff
 
+#define SDCMD_READ_MULTIPLE_BLOCK    (0x40 + 18)
+#define SDCMD_READ_MULTIPLE_BLOCK_CRC 0xff
+
+#define SDCMD_WRITE_MULTIPLE_BLOCK   (0x40 + 25)
+#define SDCMD_WRITE_MULTIPLE_BLOCK_CRC 0xff
+
+#define SDCMD_SET_WR_BLK_ERASE_COUNT (0xC0 + 23)
+#define SDCMD_SET_WR_BLK_ERASE_COUNT_CRC 0xff
+
+/* Data tokens */
+#define SDTOKEN_START_BLOCK          0xfe
+#define SDTOKEN_START_MULTI_WRITE    0xfc
+#define SDTOKEN_STOP_MULTI_WRITE     0xfd
+
+/* Token and busy waits poll this many bytes before giving the CPU to other tasks */
+#define SDCARD_POLL_BURST            64
+#define SDCARD_READ_TIMEOUT_US       100000
+#define SDCARD_WRITE_TIMEOUT_US      500000
+
 /* Card type flags (CardType) */
 #define CT_MMC                       0x01
 #define CT_SD1                       0x02
@@ -316,6 +338,37 @@ not_available:
     return (ret == 0) ? 1 : 0; /* 1 = available, 0 = not available. */
 }
 
+/**
+ * Clocks the card until it returns something else than idle. Short waits are
+ * polled, longer ones sleep a tick between bursts once the scheduler runs, so
+ * that a card busy programming its flash does not hold the CPU.
+ * \param[in] idle byte the card sends while not ready (0xff before a token, 0x00 while busy)
+ * \param[in] timeout_us give up after this time
+ * \return the first byte different from idle
+ * \return -1 on timeout
+ */
+static int32_t PIOS_SDCARD_WaitWhile(uint8_t idle, uint32_t timeout_us)
+{
+    uint32_t start = PIOS_DELAY_GetRaw();
+
+    for (;;) {
+        for (int i = 0; i < SDCARD_POLL_BURST; ++i) {
+            uint8_t ret = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+            if (ret != idle) {
+                return ret;
+            }
+        }
+        if (PIOS_DELAY_DiffuS(start) > timeout_us) {
+            return -1;
+        }
+#if defined(PIOS_INCLUDE_FREERTOS)
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+            vTaskDelay(1);
+        }
+#endif
+    }
+}
+
 /**
  * Sends command to SD card
  * \param[in] cmd SD card command
@@ -350,6 +403,11 @@ int32_t PIOS_SDCARD_SendSDCCmd(uint8_t cmd, uint32_t addr, uint8_t crc)
 
     uint8_t timeout = 0;
 
+    if (cmd == SDCMD_STOP_TRANSMISSION) {
+        /* Skip the stuff byte, it may still be data of the aborted read */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+    }
+
     if (cmd == SDCMD_SEND_STATUS) {
         /* One dummy read */
         PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
@@ -420,7 +478,6 @@ int32_t PIOS_SDCARD_SendSDCCmd(uint8_t cmd, uint32_t addr, uint8_t crc)
 int32_t PIOS_SDCARD_SectorRead(uint32_t sector, uint8_t *buffer)
 {
     int32_t status;
-    int i;
 
     if (!(CardType & CT_BLOCK)) {
         sector *= 512;
@@ -438,14 +495,7 @@ int32_t PIOS_SDCARD_SectorRead(uint32_t sector, uint8_t *buffer)
     }
 
     /* Wait for start token of the data block */
-    for (i = 0; i < 65536; ++i) { // TODO: check if sufficient
-        uint8_t ret = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
-        if (ret != 0xff) {
-            break;
-        }
-    }
-
-    if (i == 65536) {
+    if (PIOS_SDCARD_WaitWhile(0xff, SDCARD_READ_TIMEOUT_US) != SDTOKEN_START_BLOCK) {
         status = -257;
         goto error;
     }
@@ -493,7 +543,6 @@ error:
 int32_t PIOS_SDCARD_SectorWrite(uint32_t sector, uint8_t *buffer)
 {
     int32_t status;
-    int i;
 
     SDCARD_MUTEX_TAKE;
 
@@ -511,7 +560,7 @@ int32_t PIOS_SDCARD_SectorWrite(uint32_t sector, uint8_t *buffer)
     }
 
     /* Send start token */
-    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xfe);
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, SDTOKEN_START_BLOCK);
 
     /* Send 512 bytes of data via DMA */
     PIOS_SPI_TransferBlock(PIOS_SDCARD_SPI, buffer, NULL, 512, NULL);
@@ -528,17 +577,167 @@ int32_t PIOS_SDCARD_SectorWrite(uint32_t sector, uint8_t *buffer)
     }
 
     /* Wait for write completion */
-    for (i = 0; i < 32 * 65536; ++i) { /* TODO: check if sufficient */
-        uint8_t ret = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
-        if (ret != 0x00) {
+    if (PIOS_SDCARD_WaitWhile(0x00, SDCARD_WRITE_TIMEOUT_US) < 0) {
+        status = -258;
+        goto error;
+    }
+
+    /* Required for clocking (see spec) */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+error:
+    /* Deactivate chip select */
+    PIOS_SPI_RC_PinSet(PIOS_SDCARD_SPI, 0, 1); /* spi, pin_value */
+    /* Send dummy byte once deactivated to drop cards DO */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+    SDCARD_MUTEX_GIVE;
+
+    return status;
+}
+
+/**
+ * Reads consecutive sectors with one READ_MULTIPLE_BLOCK command, the card
+ * streams them without a new command and access time for each sector
+ * \param[in] sector 32bit first sector
+ * \param[in] *buffer pointer to a buffer of count * 512 bytes
+ * \param[in] count number of sectors
+ * \return 0 if all sectors have been successfully read
+ * \return -error flags as for PIOS_SDCARD_SectorRead()
+ * \return -256 if timeout during command has been sent
+ * \return -257 if timeout while waiting for start token
+ * \return -258 if the card did not acknowledge the end of the transfer
+ */
+int32_t PIOS_SDCARD_SectorsRead(uint32_t sector, uint8_t *buffer, uint32_t count)
+{
+    int32_t status;
+
+    if (count <= 1) {
+        return count ? PIOS_SDCARD_SectorRead(sector, buffer) : 0;
+    }
+
+    if (!(CardType & CT_BLOCK)) {
+        sector *= 512;
+    }
+
+    SDCARD_MUTEX_TAKE;
+
+    /* Init SPI port for fast frequency access (ca. 18 MBit/s) */
+    /* this is required for the case that the SPI port is shared with other devices */
+    PIOS_SPI_SetClockSpeed(PIOS_SDCARD_SPI, PIOS_SPI_PRESCALER_4);
+
+    if ((status = PIOS_SDCARD_SendSDCCmd(SDCMD_READ_MULTIPLE_BLOCK, sector, SDCMD_READ_MULTIPLE_BLOCK_CRC))) {
+        status = (status < 0) ? -256 : status; /* return timeout indicator or error flags */
+        goto error;
+    }
+
+    for (uint32_t n = 0; n < count; ++n) {
+        /* Wait for start token of the data block */
+        if (PIOS_SDCARD_WaitWhile(0xff, SDCARD_READ_TIMEOUT_US) != SDTOKEN_START_BLOCK) {
+            status = -257;
             break;
         }
+
+        /* Read 512 bytes via DMA */
+        PIOS_SPI_TransferBlock(PIOS_SDCARD_SPI, NULL, buffer, 512, NULL);
+        buffer += 512;
+
+        /* Read (and ignore) CRC */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+    }
+
+    /* Stop the transfer, also after an error, and wait until the card is ready again */
+    if (PIOS_SDCARD_SendSDCCmd(SDCMD_STOP_TRANSMISSION, 0, SDCMD_STOP_TRANSMISSION_CRC) < 0 ||
+        PIOS_SDCARD_WaitWhile(0x00, SDCARD_READ_TIMEOUT_US) < 0) {
+        if (status == 0) {
+            status = -258;
+        }
     }
-    if (i == 32 * 65536) {
-        status = -258;
+
+error:
+    /* Deactivate chip select */
+    PIOS_SPI_RC_PinSet(PIOS_SDCARD_SPI, 0, 1); // spi, pin_value
+
+    /* Send dummy byte once deactivated to drop cards DO */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+    SDCARD_MUTEX_GIVE;
+    return status;
+}
+
+/**
+ * Writes consecutive sectors with one WRITE_MULTIPLE_BLOCK command. SD cards
+ * are told the count first so that they can erase the whole range at once.
+ * \param[in] sector 32bit first sector
+ * \param[in] *buffer pointer to a buffer of count * 512 bytes
+ * \param[in] count number of sectors
+ * \return 0 if all sectors have been successfully written
+ * \return -error flags as for PIOS_SDCARD_SectorWrite()
+ * \return -256 if timeout during command has been sent
+ * \return -257 if write operation not accepted
+ * \return -258 if timeout during write operation
+ */
+int32_t PIOS_SDCARD_SectorsWrite(uint32_t sector, uint8_t *buffer, uint32_t count)
+{
+    int32_t status;
+
+    if (count <= 1) {
+        return count ? PIOS_SDCARD_SectorWrite(sector, buffer) : 0;
+    }
+
+    SDCARD_MUTEX_TAKE;
+
+    if (!(CardType & CT_BLOCK)) {
+        sector *= 512;
+    }
+
+    /* Init SPI port for fast frequency access (ca. 18 MBit/s) */
+    /* This is required for the case that the SPI port is shared with other devices */
+    PIOS_SPI_SetClockSpeed(PIOS_SDCARD_SPI, PIOS_SPI_PRESCALER_4);
+
+    if (CardType & CT_SDC) {
+        /* Only a hint to the card, errors are harmless */
+        PIOS_SDCARD_SendSDCCmd(SDCMD_SET_WR_BLK_ERASE_COUNT, count, SDCMD_SET_WR_BLK_ERASE_COUNT_CRC);
+    }
+
+    if ((status = PIOS_SDCARD_SendSDCCmd(SDCMD_WRITE_MULTIPLE_BLOCK, sector, SDCMD_WRITE_MULTIPLE_BLOCK_CRC))) {
+        status = (status < 0) ? -256 : status; /* Return timeout indicator or error flags */
         goto error;
     }
 
+    for (uint32_t n = 0; n < count; ++n) {
+        /* Send start token */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, SDTOKEN_START_MULTI_WRITE);
+
+        /* Send 512 bytes of data via DMA */
+        PIOS_SPI_TransferBlock(PIOS_SDCARD_SPI, buffer, NULL, 512, NULL);
+        buffer += 512;
+
+        /* Send CRC */
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+        PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+
+        /* Read response */
+        uint8_t response = PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+        if ((response & 0x0f) != 0x5) {
+            status = -257;
+            break;
+        }
+
+        /* Wait until the block is programmed */
+        if (PIOS_SDCARD_WaitWhile(0x00, SDCARD_WRITE_TIMEOUT_US) < 0) {
+            status = -258;
+            goto error;
+        }
+    }
+
+    /* Stop token, then wait for the card to finish programming */
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, SDTOKEN_STOP_MULTI_WRITE);
+    PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
+    if (PIOS_SDCARD_WaitWhile(0x00, SDCARD_WRITE_TIMEOUT_US) < 0 && status == 0) {
+        status = -258;
+    }
+
     /* Required for clocking (see spec) */
     PIOS_SPI_TransferByte(PIOS_SDCARD_SPI, 0xff);
 
@@ -1005,6 +1204,106 @@ int32_t PIOS_SDCARD_FileDelete(char *Filename)
     return 0;
 }
 
+/**
+ * Creates a file whose clusters follow each other on the card, so that it can
+ * be written with PIOS_SDCARD_SectorsWrite() at full speed without going
+ * through the FAT for every cluster. The file gets its full length at once,
+ * whatever the card held before is its content until overwritten.
+ * WARNING: This will overwrite the file if it exists
+ * param[in] *Filename File to create
+ * param[in] len Length of the file in bytes
+ * param[out] *first_sector First sector of the file on the card
+ * return 0 No errors
+ * return -1 Invalid length
+ * return -2 Failed to create the file
+ * return -3 Not enough contiguous free space
+ * return -4 Failed to update the directory entry
+ */
+int32_t PIOS_SDCARD_FileAllocate(char *Filename, uint32_t len, uint32_t *first_sector)
+{
+    FILEINFO File;
+    uint32_t ClusterSize = PIOS_SDCARD_VolInfo.secperclus * SECTOR_SIZE;
+    uint32_t Clusters    = (len + ClusterSize - 1) / ClusterSize;
+
+    if (Clusters == 0) {
+        return -1;
+    }
+
+    /* Disable caching to avoid file inconsistencies while using different sector buffers! */
+    DFS_CachingEnabledSet(0);
+
+    /* Delete the file if it already exists - ignore errors */
+    DFS_UnlinkFile(&PIOS_SDCARD_VolInfo, (uint8_t *)Filename, PIOS_SDCARD_Sector);
+
+    if (DFS_OpenFile(&PIOS_SDCARD_VolInfo, (uint8_t *)Filename, DFS_WRITE, PIOS_SDCARD_Sector, &File)) {
+        /* Failed to create the file */
+        return -2;
+    }
+
+    /* Find the first run of free clusters, the one just given to the empty file counts as free */
+    uint32_t ScratchCache = 0;
+    uint32_t Start = 0;
+    uint32_t Run   = 0;
+    for (uint32_t i = 2; i < PIOS_SDCARD_VolInfo.numclusters && Run < Clusters; ++i) {
+        if (i == File.firstcluster || !DFS_GetFAT(&PIOS_SDCARD_VolInfo, PIOS_SDCARD_Sector, &ScratchCache, i)) {
+            if (Run++ == 0) {
+                Start = i;
+            }
+        } else {
+            Run = 0;
+        }
+    }
+    if (Run < Clusters) {
+        DFS_UnlinkFile(&PIOS_SDCARD_VolInfo, (uint8_t *)Filename, PIOS_SDCARD_Sector);
+        return -3;
+    }
+
+    uint32_t EndOfChain;
+    switch (PIOS_SDCARD_VolInfo.filesystem) {
+    case FAT12:
+        EndOfChain = 0xff8;
+        break;
+    case FAT16:
+        EndOfChain = 0xfff8;
+        break;
+    default:
+        EndOfChain = 0x0ffffff8;
+        break;
+    }
+
+    /* Release the cluster of the empty file if the run does not include it, then chain the run */
+    ScratchCache = 0;
+    if (File.firstcluster < Start || File.firstcluster >= Start + Clusters) {
+        DFS_SetFAT(&PIOS_SDCARD_VolInfo, PIOS_SDCARD_Sector, &ScratchCache, File.firstcluster, 0);
+    }
+    for (uint32_t i = 0; i < Clusters; ++i) {
+        uint32_t Next = (i + 1 < Clusters) ? Start + i + 1 : EndOfChain;
+        DFS_SetFAT(&PIOS_SDCARD_VolInfo, PIOS_SDCARD_Sector, &ScratchCache, Start + i, Next);
+    }
+
+    /* Point the directory entry at the run and give the file its length */
+    if (DFS_ReadSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, File.dirsector, 1)) {
+        return -4;
+    }
+    PDIRENT Entry = &((PDIRENT)PIOS_SDCARD_Sector)[File.diroffset];
+    Entry->startclus_l_l = Start & 0xff;
+    Entry->startclus_l_h = (Start & 0xff00) >> 8;
+    Entry->startclus_h_l = (Start & 0xff0000) >> 16;
+    Entry->startclus_h_h = (Start & 0xff000000) >> 24;
+    Entry->filesize_0    = len & 0xff;
+    Entry->filesize_1    = (len & 0xff00) >> 8;
+    Entry->filesize_2    = (len & 0xff0000) >> 16;
+    Entry->filesize_3    = (len & 0xff000000) >> 24;
+    if (DFS_WriteSector(PIOS_SDCARD_VolInfo.unit, PIOS_SDCARD_Sector, File.dirsector, 1)) {
+        return -4;
+    }
+
+    *first_sector = PIOS_SDCARD_VolInfo.dataarea + (Start - 2) * PIOS_SDCARD_VolInfo.secperclus;
+
+    /* No errors */
+    return 0;
+}
+
 #endif /* PIOS_INCLUDE_SDCARD */
 
 /**
@@ -31,6 +31,12 @@
 // private variables
 
 static PIOS_SENSORS_Instance *sensor_list = 0;
+static uint8_t sensor_count = 0;
+
+// ready events raised by the drivers, and those the sensors task sleeps on
+static volatile uint32_t sensor_events;
+static volatile uint32_t sensor_wait_mask;
+static SemaphoreHandle_t sensor_event_signal;
 
 PIOS_SENSORS_Instance *PIOS_SENSORS_Register(const PIOS_SENSORS_Driver *driver, PIOS_SENSORS_TYPE type, uintptr_t context)
 {
@@ -40,10 +46,104 @@ PIOS_SENSORS_Instance *PIOS_SENSORS_Register(const PIOS_SENSORS_Driver *driver,
     instance->type    = type;
     instance->context = context;
     instance->next    = NULL;
+    PIOS_Assert(sensor_count < 32);
+    instance->event     = 1 << sensor_count++;
+    instance->next_poll = 0;
+    if (!sensor_event_signal) {
+        vSemaphoreCreateBinary(sensor_event_signal);
+        PIOS_Assert(sensor_event_signal);
+        // the binary semaphore starts given
+        xSemaphoreTake(sensor_event_signal, 0);
+    }
+    // serviced once at start, the sensor may have become ready before it was registered
+    sensor_events |= instance->event;
     LL_APPEND(sensor_list, instance);
     return instance;
 }
 
+bool PIOS_SENSORS_RaiseEventFromISR(const PIOS_SENSORS_Instance *sensor)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (!sensor) {
+        return false;
+    }
+    // sensors can raise events from interrupts of different priorities
+    UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    sensor_events |= sensor->event;
+    bool wake = (sensor_wait_mask & sensor->event) != 0;
+    if (wake) {
+        sensor_wait_mask = 0;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    if (wake) {
+        xSemaphoreGiveFromISR(sensor_event_signal, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+static uint32_t PIOS_SENSORS_TakeEvents(uint32_t mask, bool wait)
+{
+    portENTER_CRITICAL();
+    uint32_t events = sensor_events & mask;
+    sensor_events   &= ~events;
+    // an event raised before the wait mask is set gives no signal
+    sensor_wait_mask = (wait && !events) ? mask : 0;
+    portEXIT_CRITICAL();
+    return events;
+}
+
+uint32_t PIOS_SENSORS_WaitEvents(uint32_t mask, TickType_t timeout)
+{
+    uint32_t events = PIOS_SENSORS_TakeEvents(mask, timeout > 0);
+
+    if (!events && timeout > 0) {
+        // a signal left over from an earlier timeout can wake up early, the caller just runs once more
+        xSemaphoreTake(sensor_event_signal, timeout);
+        events = PIOS_SENSORS_TakeEvents(mask, false);
+    }
+    return events;
+}
+
+PIOS_SENSORS_Ring *PIOS_SENSORS_RingCreate(uint16_t samples, uint16_t sample_size)
+{
+    PIOS_SENSORS_Ring *ring = (PIOS_SENSORS_Ring *)pios_malloc(sizeof(PIOS_SENSORS_Ring));
+
+    PIOS_Assert(ring);
+    ring->size        = samples + 1;
+    ring->sample_size = sample_size;
+    ring->buffer      = (uint8_t *)pios_malloc(ring->size * sample_size);
+    PIOS_Assert(ring->buffer);
+    ring->head    = 0;
+    ring->tail    = 0;
+    ring->waiting = false;
+    vSemaphoreCreateBinary(ring->ready);
+    PIOS_Assert(ring->ready);
+    // the binary semaphore starts given
+    xSemaphoreTake(ring->ready, 0);
+    return ring;
+}
+
+bool PIOS_SENSORS_RingWait(PIOS_SENSORS_Ring *ring, TickType_t timeout)
+{
+    while (!PIOS_SENSORS_RingPeek(ring)) {
+        ring->waiting = true;
+        __sync_synchronize();
+        // a sample published before waiting was set gives no signal
+        if (PIOS_SENSORS_RingPeek(ring)) {
+            ring->waiting = false;
+            break;
+        }
+        if (xSemaphoreTake(ring->ready, timeout) != pdTRUE) {
+            ring->waiting = false;
+            return PIOS_SENSORS_RingPeek(ring) != NULL;
+        }
+        // a signal left over from an earlier timeout can wake up early, check again
+    }
+    return true;
+}
+
 PIOS_SENSORS_Instance *PIOS_SENSORS_GetList()
 {
     return sensor_list;
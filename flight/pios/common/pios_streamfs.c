@@ -0,0 +1,791 @@
+/**
+ ******************************************************************************
+ * @file       pios_streamfs.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_STREAMFS Append-only Flash Log Stream
+ * @{
+ * @brief Append-only record stream on raw flash sectors, used for flight logs
+ *
+ * The stream is a ring of flash sectors. Each sector in use starts with a
+ * header carrying a sequence number that increments from one sector to the
+ * next, followed by length prefixed records that never cross a sector.
+ * Writes are buffered and programmed one full page at a time, and the sector
+ * after the one being filled is erased ahead of time from PIOS_STREAMFS_Flush(),
+ * so appending does not normally wait for an erase cycle.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "pios.h"
+
+#ifdef PIOS_INCLUDE_FLASH
+
+#include <stdbool.h>
+#include <string.h>
+#include <openpilot.h>
+#include "pios_streamfs.h"
+
+/*
+ * Sector and record layout
+ */
+
+struct streamfs_sector_header {
+    uint32_t magic;
+    uint32_t sequence;
+} __attribute__((packed));
+
+#define STREAMFS_HEADER_SIZE      sizeof(struct streamfs_sector_header)
+/* Records are [uint16_t length][data] padded to an even size, so a length never straddles a page */
+#define STREAMFS_RECORD_SIZE(len) ((sizeof(uint16_t) + (len) + 1) & ~1)
+#define STREAMFS_BLANK_LENGTH     0xFFFF
+
+/*
+ * Stream state data tracked in RAM
+ */
+
+enum pios_streamfs_dev_magic {
+    PIOS_STREAMFS_DEV_MAGIC = 0x5f3a1c27,
+};
+
+struct streamfs_state {
+    enum pios_streamfs_dev_magic magic;
+    const struct streamfs_cfg *cfg;
+
+    uint16_t num_sectors;
+    uint16_t oldest_sector; /* first sector of the stream */
+    uint16_t active_sector; /* sector records are appended to */
+    uint32_t active_seq; /* sequence number of the active sector */
+    uint32_t write_offset; /* offset of the next record within the active sector */
+    bool     ahead_erased; /* the sector following the active one is erased */
+
+    /* RAM copy of the page holding write_offset */
+    uint8_t  *page;
+    uint32_t page_written; /* bytes of the page already programmed */
+
+    /* Underlying flash driver glue */
+    const struct pios_flash_driver *driver;
+    uintptr_t flash_id;
+};
+
+/*
+ * Internal Utility functions
+ */
+
+static bool PIOS_STREAMFS_validate(const struct streamfs_state *streamfs)
+{
+    return streamfs && (streamfs->magic == PIOS_STREAMFS_DEV_MAGIC);
+}
+
+/**
+ * @brief Return the offset in flash of a position within a sector
+ */
+static uintptr_t streamfs_get_addr(const struct streamfs_state *streamfs, uint16_t sector, uint32_t offset)
+{
+    PIOS_Assert(sector < streamfs->num_sectors);
+    PIOS_Assert(offset <= streamfs->cfg->sector_size);
+
+    return streamfs->cfg->start_offset + (sector * streamfs->cfg->sector_size) + offset;
+}
+
+static uint32_t streamfs_page_base(const struct streamfs_state *streamfs, uint32_t offset)
+{
+    return offset - (offset % streamfs->cfg->page_size);
+}
+
+/**
+ * @brief Read the header of a sector
+ * @return true if the sector belongs to this stream
+ * @note Must be called while holding the flash transaction lock
+ */
+static bool streamfs_read_header(const struct streamfs_state *streamfs, uint16_t sector, struct streamfs_sector_header *hdr)
+{
+    if (streamfs->driver->read_data(streamfs->flash_id, streamfs_get_addr(streamfs, sector, 0), (uint8_t *)hdr, sizeof(*hdr)) != 0) {
+        return false;
+    }
+    return hdr->magic == streamfs->cfg->fs_magic;
+}
+
+/**
+ * @brief Erase a sector, moving the start of the stream past it when needed
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_erase_sector(struct streamfs_state *streamfs, uint16_t sector)
+{
+    if (streamfs->driver->erase_sector(streamfs->flash_id, streamfs_get_addr(streamfs, sector, 0)) != 0) {
+        return -1;
+    }
+    if (sector == streamfs->oldest_sector && sector != streamfs->active_sector) {
+        streamfs->oldest_sector = (sector + 1) % streamfs->num_sectors;
+    }
+    return 0;
+}
+
+/**
+ * @brief Program the buffered part of the page that has not been written yet
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_program_page(struct streamfs_state *streamfs)
+{
+    uint32_t page_base = streamfs_page_base(streamfs, streamfs->write_offset);
+    uint32_t fill = streamfs->write_offset - page_base;
+
+    if (fill <= streamfs->page_written) {
+        return 0;
+    }
+
+    if (streamfs->driver->write_data(streamfs->flash_id,
+                                     streamfs_get_addr(streamfs, streamfs->active_sector, page_base + streamfs->page_written),
+                                     &streamfs->page[streamfs->page_written],
+                                     fill - streamfs->page_written) != 0) {
+        return -1;
+    }
+    streamfs->page_written = fill;
+    return 0;
+}
+
+/**
+ * @brief Start a fresh page buffer at write_offset, which must be page aligned
+ */
+static void streamfs_reset_page(struct streamfs_state *streamfs)
+{
+    memset(streamfs->page, 0xFF, streamfs->cfg->page_size);
+    streamfs->page_written = 0;
+}
+
+/**
+ * @brief Make a sector the active one and write its header
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_start_sector(struct streamfs_state *streamfs, uint16_t sector, uint32_t sequence)
+{
+    struct streamfs_sector_header hdr = {
+        .magic    = streamfs->cfg->fs_magic,
+        .sequence = sequence,
+    };
+
+    if (streamfs->driver->write_data(streamfs->flash_id, streamfs_get_addr(streamfs, sector, 0), (uint8_t *)&hdr, sizeof(hdr)) != 0) {
+        return -1;
+    }
+
+    streamfs->active_sector = sector;
+    streamfs->active_seq    = sequence;
+    streamfs->ahead_erased  = false;
+    streamfs->write_offset  = STREAMFS_HEADER_SIZE;
+    streamfs_reset_page(streamfs);
+    memcpy(streamfs->page, &hdr, sizeof(hdr));
+    streamfs->page_written  = STREAMFS_HEADER_SIZE;
+
+    return 0;
+}
+
+/**
+ * @brief Move on to the sector after the active one, erasing it first if that has not happened yet
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_next_sector(struct streamfs_state *streamfs)
+{
+    uint16_t next = (streamfs->active_sector + 1) % streamfs->num_sectors;
+
+    if (streamfs_program_page(streamfs) != 0) {
+        return -1;
+    }
+    if (!streamfs->ahead_erased && streamfs_erase_sector(streamfs, next) != 0) {
+        return -2;
+    }
+    if (streamfs_start_sector(streamfs, next, streamfs->active_seq + 1) != 0) {
+        return -3;
+    }
+    return 0;
+}
+
+/**
+ * @brief Find the end of the records in the active sector after a restart
+ * @return offset just past the last record
+ * @note Must be called while holding the flash transaction lock
+ */
+static uint32_t streamfs_find_end(const struct streamfs_state *streamfs)
+{
+    uint32_t offset = STREAMFS_HEADER_SIZE;
+
+    while (offset + sizeof(uint16_t) <= streamfs->cfg->sector_size) {
+        uint16_t len;
+        if (streamfs->driver->read_data(streamfs->flash_id, streamfs_get_addr(streamfs, streamfs->active_sector, offset), (uint8_t *)&len, sizeof(len)) != 0) {
+            break;
+        }
+        if (len == STREAMFS_BLANK_LENGTH) {
+            if (offset % streamfs->cfg->page_size == 0) {
+                break;
+            }
+            /* writing resumed on the next page after a restart */
+            offset = streamfs_page_base(streamfs, offset) + streamfs->cfg->page_size;
+            continue;
+        }
+        if (offset + STREAMFS_RECORD_SIZE(len) > streamfs->cfg->sector_size) {
+            /* corrupt record, do not trust anything after it */
+            break;
+        }
+        offset += STREAMFS_RECORD_SIZE(len);
+    }
+    return offset;
+}
+
+/**
+ * @brief Locate the stream on flash, or start a new one if there is none
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_mount(struct streamfs_state *streamfs)
+{
+    struct streamfs_sector_header hdr;
+    bool found = false;
+
+    /* The active sector is the one with the highest sequence number */
+    for (uint16_t sector = 0; sector < streamfs->num_sectors; sector++) {
+        if (streamfs_read_header(streamfs, sector, &hdr) && (!found || hdr.sequence > streamfs->active_seq)) {
+            found = true;
+            streamfs->active_sector = sector;
+            streamfs->active_seq    = hdr.sequence;
+        }
+    }
+
+    if (!found) {
+        streamfs->oldest_sector = 0;
+        streamfs->active_sector = 0;
+        if (streamfs_erase_sector(streamfs, 0) != 0) {
+            return -1;
+        }
+        return streamfs_start_sector(streamfs, 0, 1);
+    }
+
+    /* Walk back through the sectors with consecutive sequence numbers to find the start of the stream */
+    streamfs->oldest_sector = streamfs->active_sector;
+    for (uint16_t n = 1; n < streamfs->num_sectors; n++) {
+        uint16_t prev = (streamfs->active_sector + streamfs->num_sectors - n) % streamfs->num_sectors;
+        if (!streamfs_read_header(streamfs, prev, &hdr) || hdr.sequence != streamfs->active_seq - n) {
+            break;
+        }
+        streamfs->oldest_sector = prev;
+    }
+
+    /* Resume appending on a fresh page, a partially written page is never programmed twice */
+    uint32_t end = streamfs_find_end(streamfs);
+    if (end % streamfs->cfg->page_size) {
+        end = streamfs_page_base(streamfs, end) + streamfs->cfg->page_size;
+    }
+    if (end > streamfs->cfg->sector_size) {
+        end = streamfs->cfg->sector_size;
+    }
+    streamfs->write_offset = end;
+    streamfs->ahead_erased = false;
+    streamfs_reset_page(streamfs);
+
+    return 0;
+}
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+static struct streamfs_state *PIOS_STREAMFS_alloc(const struct streamfs_cfg *cfg)
+{
+    struct streamfs_state *streamfs;
+
+    streamfs = (struct streamfs_state *)pios_malloc(sizeof(*streamfs));
+    if (!streamfs) {
+        return NULL;
+    }
+    streamfs->page = (uint8_t *)pios_malloc(cfg->page_size);
+    if (!streamfs->page) {
+        vPortFree(streamfs);
+        return NULL;
+    }
+
+    streamfs->magic = PIOS_STREAMFS_DEV_MAGIC;
+    return streamfs;
+}
+static void PIOS_STREAMFS_free(struct streamfs_state *streamfs)
+{
+    /* Invalidate the magic */
+    streamfs->magic = ~PIOS_STREAMFS_DEV_MAGIC;
+    vPortFree(streamfs->page);
+    vPortFree(streamfs);
+}
+#else
+#ifndef PIOS_STREAMFS_MAX_DEVS
+#define PIOS_STREAMFS_MAX_DEVS      1
+#endif
+#ifndef PIOS_STREAMFS_MAX_PAGE_SIZE
+#define PIOS_STREAMFS_MAX_PAGE_SIZE 256
+#endif
+static struct streamfs_state pios_streamfs_devs[PIOS_STREAMFS_MAX_DEVS];
+static uint8_t pios_streamfs_pages[PIOS_STREAMFS_MAX_DEVS][PIOS_STREAMFS_MAX_PAGE_SIZE];
+static uint8_t pios_streamfs_num_devs;
+static struct streamfs_state *PIOS_STREAMFS_alloc(const struct streamfs_cfg *cfg)
+{
+    struct streamfs_state *streamfs;
+
+    if (pios_streamfs_num_devs >= PIOS_STREAMFS_MAX_DEVS || cfg->page_size > PIOS_STREAMFS_MAX_PAGE_SIZE) {
+        return NULL;
+    }
+
+    streamfs        = &pios_streamfs_devs[pios_streamfs_num_devs];
+    streamfs->page  = pios_streamfs_pages[pios_streamfs_num_devs++];
+    streamfs->magic = PIOS_STREAMFS_DEV_MAGIC;
+
+    return streamfs;
+}
+static void PIOS_STREAMFS_free(struct streamfs_state *streamfs)
+{
+    /* Invalidate the magic */
+    streamfs->magic = ~PIOS_STREAMFS_DEV_MAGIC;
+
+    /* Can't free the resources with this simple allocator */
+}
+#endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
+/**
+ * @brief Initialize a log stream on a flash partition
+ * @return 0 if success, < 0 on failure
+ */
+int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, const struct pios_flash_driver *driver, uintptr_t flash_id)
+{
+    PIOS_Assert(cfg);
+    PIOS_Assert(fs_id);
+    PIOS_Assert(driver);
+
+    /* The ring needs a sector to erase ahead while another one is filled */
+    PIOS_Assert(cfg->total_fs_size / cfg->sector_size > 1);
+    PIOS_Assert((cfg->sector_size % cfg->page_size) == 0);
+
+    /* Make sure the underlying flash driver provides the minimal set of required methods */
+    PIOS_Assert(driver->start_transaction);
+    PIOS_Assert(driver->end_transaction);
+    PIOS_Assert(driver->erase_sector);
+    PIOS_Assert(driver->write_data);
+    PIOS_Assert(driver->read_data);
+
+    int32_t rc;
+
+    struct streamfs_state *streamfs = PIOS_STREAMFS_alloc(cfg);
+    if (!streamfs) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    /* Bind configuration parameters to this stream instance */
+    streamfs->cfg         = cfg;
+    streamfs->driver      = driver;
+    streamfs->flash_id    = flash_id;
+    streamfs->num_sectors = cfg->total_fs_size / cfg->sector_size;
+
+    if (streamfs->driver->start_transaction(streamfs->flash_id) != 0) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (streamfs_mount(streamfs) != 0) {
+        rc = -2;
+        goto out_end_trans;
+    }
+
+    *fs_id = (uintptr_t)streamfs;
+    rc     = 0;
+
+out_end_trans:
+    streamfs->driver->end_transaction(streamfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+int32_t PIOS_STREAMFS_Destroy(uintptr_t fs_id)
+{
+    int32_t rc;
+
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    PIOS_STREAMFS_free(streamfs);
+    rc = 0;
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Erase all log data and start a new stream
+ * @param[in] fs_id The stream to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid stream instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if erase failed
+ * @retval -4 if the new stream could not be started
+ */
+int32_t PIOS_STREAMFS_Format(uintptr_t fs_id)
+{
+    int32_t rc;
+
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (streamfs->driver->start_transaction(streamfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    /* Only sectors that have been written to need an erase cycle */
+    for (uint16_t sector = 0; sector < streamfs->num_sectors; sector++) {
+        struct streamfs_sector_header hdr;
+        streamfs_read_header(streamfs, sector, &hdr);
+        if ((hdr.magic != 0xFFFFFFFF || hdr.sequence != 0xFFFFFFFF) &&
+            streamfs->driver->erase_sector(streamfs->flash_id, streamfs_get_addr(streamfs, sector, 0)) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+    }
+
+    streamfs->oldest_sector = 0;
+    if (streamfs_start_sector(streamfs, 0, 1) != 0) {
+        rc = -4;
+        goto out_end_trans;
+    }
+    /* Everything else is blank now */
+    streamfs->ahead_erased = true;
+
+    rc = 0;
+
+out_end_trans:
+    streamfs->driver->end_transaction(streamfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Append one record to the stream
+ * @param[in] fs_id The stream to use for this action
+ * @param[in] data The record contents
+ * @param[in] len The size of the record
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid stream instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if the record does not fit in a sector
+ * @retval -4 if moving to the next sector failed
+ * @retval -5 if writing to flash failed
+ * @note The record may stay buffered in RAM until the page is full or PIOS_STREAMFS_Flush() is called
+ */
+int32_t PIOS_STREAMFS_Append(uintptr_t fs_id, const uint8_t *data, uint16_t len)
+{
+    int32_t rc;
+
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    uint32_t record_size = STREAMFS_RECORD_SIZE(len);
+    if (len == STREAMFS_BLANK_LENGTH || record_size > streamfs->cfg->sector_size - STREAMFS_HEADER_SIZE) {
+        rc = -3;
+        goto out_exit;
+    }
+
+    if (streamfs->driver->start_transaction(streamfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    if (streamfs->write_offset + record_size > streamfs->cfg->sector_size) {
+        if (streamfs_next_sector(streamfs) != 0) {
+            rc = -4;
+            goto out_end_trans;
+        }
+    }
+
+    /* Copy length, data and padding into the page buffer, programming each page as it fills up */
+    uint8_t pad = 0xFF;
+    const struct {
+        const uint8_t *src;
+        uint32_t len;
+    } parts[] = {
+        { (const uint8_t *)&len, sizeof(len)                         },
+        { data,                  len                                 },
+        { &pad,                  record_size - sizeof(uint16_t) - len },
+    };
+    for (uint8_t p = 0; p < NELEMENTS(parts); p++) {
+        const uint8_t *src = parts[p].src;
+        uint32_t remaining = parts[p].len;
+        while (remaining) {
+            uint32_t page_offset = streamfs->write_offset % streamfs->cfg->page_size;
+            uint32_t chunk = streamfs->cfg->page_size - page_offset;
+            if (chunk > remaining) {
+                chunk = remaining;
+            }
+            memcpy(&streamfs->page[page_offset], src, chunk);
+            streamfs->write_offset += chunk;
+            src += chunk;
+            remaining -= chunk;
+
+            if (page_offset + chunk == streamfs->cfg->page_size) {
+                /* Page complete, program the rest of it in one burst */
+                if (streamfs->driver->write_data(streamfs->flash_id,
+                                                 streamfs_get_addr(streamfs, streamfs->active_sector, streamfs->write_offset - streamfs->cfg->page_size + streamfs->page_written),
+                                                 &streamfs->page[streamfs->page_written],
+                                                 streamfs->cfg->page_size - streamfs->page_written) != 0) {
+                    rc = -5;
+                    goto out_end_trans;
+                }
+                streamfs_reset_page(streamfs);
+            }
+        }
+    }
+
+    rc = 0;
+
+out_end_trans:
+    streamfs->driver->end_transaction(streamfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Program any buffered data and erase the next sector ahead of time
+ * @param[in] fs_id The stream to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid stream instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if writing to flash failed
+ * @retval -4 if the erase failed
+ * @note Call when the producer is idle, the erase may take a long time
+ */
+int32_t PIOS_STREAMFS_Flush(uintptr_t fs_id)
+{
+    int32_t rc;
+
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (streamfs->driver->start_transaction(streamfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    if (streamfs_program_page(streamfs) != 0) {
+        rc = -3;
+        goto out_end_trans;
+    }
+
+    if (!streamfs->ahead_erased) {
+        if (streamfs_erase_sector(streamfs, (streamfs->active_sector + 1) % streamfs->num_sectors) != 0) {
+            rc = -4;
+            goto out_end_trans;
+        }
+        streamfs->ahead_erased = true;
+    }
+
+    rc = 0;
+
+out_end_trans:
+    streamfs->driver->end_transaction(streamfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Read the record at a cursor and advance the cursor to the next one
+ * @param[in] fs_id The stream to use for this action
+ * @param[in,out] cursor position of the record, PIOS_STREAMFS_CURSOR_START for the oldest one
+ * @param[out] data buffer for the record, longer records are truncated
+ * @param[in] max_len The size of the buffer
+ * @return length of the record if success or error code
+ * @retval -1 if fs_id is not a valid stream instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if there are no more records
+ * @retval -4 if reading from flash failed
+ * @note Only records that have been programmed to flash are visible
+ */
+int32_t PIOS_STREAMFS_ReadRecord(uintptr_t fs_id, uint32_t *cursor, uint8_t *data, uint16_t max_len)
+{
+    PIOS_Assert(cursor);
+    PIOS_Assert(data);
+
+    int32_t rc;
+
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (streamfs->driver->start_transaction(streamfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    uint32_t sector_size = streamfs->cfg->sector_size;
+    uint32_t pos = (*cursor == PIOS_STREAMFS_CURSOR_START) ?
+                   streamfs->oldest_sector * sector_size + STREAMFS_HEADER_SIZE : *cursor;
+
+    for (;;) {
+        uint16_t sector = pos / sector_size;
+        uint32_t offset = pos % sector_size;
+        if (sector >= streamfs->num_sectors) {
+            rc = -3;
+            goto out_end_trans;
+        }
+
+        /* The active sector only holds data up to what has been programmed */
+        uint32_t limit = sector_size;
+        if (sector == streamfs->active_sector) {
+            limit = streamfs_page_base(streamfs, streamfs->write_offset) + streamfs->page_written;
+        }
+
+        uint16_t len = STREAMFS_BLANK_LENGTH;
+        if (offset + sizeof(len) <= limit &&
+            streamfs->driver->read_data(streamfs->flash_id, streamfs_get_addr(streamfs, sector, offset), (uint8_t *)&len, sizeof(len)) != 0) {
+            rc = -4;
+            goto out_end_trans;
+        }
+
+        if (len != STREAMFS_BLANK_LENGTH && offset + STREAMFS_RECORD_SIZE(len) <= limit) {
+            uint16_t copy = (len < max_len) ? len : max_len;
+            if (streamfs->driver->read_data(streamfs->flash_id, streamfs_get_addr(streamfs, sector, offset + sizeof(len)), data, copy) != 0) {
+                rc = -4;
+                goto out_end_trans;
+            }
+            *cursor = pos + STREAMFS_RECORD_SIZE(len);
+            rc = len;
+            goto out_end_trans;
+        }
+
+        uint32_t next_page = streamfs_page_base(streamfs, offset) + streamfs->cfg->page_size;
+        if (len == STREAMFS_BLANK_LENGTH && offset + sizeof(len) <= limit &&
+            offset % streamfs->cfg->page_size && next_page < limit) {
+            /* gap left by a restart, records continue on the next page */
+            pos = sector * sector_size + next_page;
+            continue;
+        }
+
+        /* End of this sector, continue with the next one of the stream */
+        if (sector == streamfs->active_sector) {
+            rc = -3;
+            goto out_end_trans;
+        }
+        pos = ((sector + 1) % streamfs->num_sectors) * sector_size + STREAMFS_HEADER_SIZE;
+    }
+
+out_end_trans:
+    streamfs->driver->end_transaction(streamfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Read raw bytes of a stream sector, for streaming whole sectors off the board
+ * @param[in] fs_id The stream to use for this action
+ * @param[in] sector index of the sector in the stream, 0 is the oldest
+ * @param[in] offset within the sector
+ * @param[out] data buffer for the sector contents
+ * @param[in] len number of bytes to read
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid stream instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if the sector is not part of the stream or the read crosses its end
+ * @retval -4 if reading from flash failed
+ */
+int32_t PIOS_STREAMFS_ReadSector(uintptr_t fs_id, uint16_t sector, uint32_t offset, uint8_t *data, uint16_t len)
+{
+    PIOS_Assert(data);
+
+    int32_t rc;
+
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    uint16_t used_sectors = (streamfs->active_sector + streamfs->num_sectors - streamfs->oldest_sector) % streamfs->num_sectors + 1;
+    if (sector >= used_sectors || offset + len > streamfs->cfg->sector_size) {
+        rc = -3;
+        goto out_exit;
+    }
+
+    if (streamfs->driver->start_transaction(streamfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    uint16_t physical = (streamfs->oldest_sector + sector) % streamfs->num_sectors;
+    if (streamfs->driver->read_data(streamfs->flash_id, streamfs_get_addr(streamfs, physical, offset), data, len) != 0) {
+        rc = -4;
+        goto out_end_trans;
+    }
+
+    rc = 0;
+
+out_end_trans:
+    streamfs->driver->end_transaction(streamfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+/**
+ * @brief Returns stats for the stream
+ * @param[in] fs_id The stream to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid stream instance
+ */
+int32_t PIOS_STREAMFS_GetStats(uintptr_t fs_id, struct PIOS_STREAMFS_Stats *stats)
+{
+    PIOS_Assert(stats);
+    struct streamfs_state *streamfs = (struct streamfs_state *)fs_id;
+
+    if (!PIOS_STREAMFS_validate(streamfs)) {
+        return -1;
+    }
+
+    uint16_t used_sectors = (streamfs->active_sector + streamfs->num_sectors - streamfs->oldest_sector) % streamfs->num_sectors + 1;
+    stats->used_bytes = (used_sectors - 1) * streamfs->cfg->sector_size + streamfs->write_offset;
+    stats->free_bytes = streamfs->cfg->total_fs_size - stats->used_bytes;
+
+    return 0;
+}
+
+#endif /* PIOS_INCLUDE_FLASH */
+
+/**
+ * @}
+ * @}
+ */
@@ -35,6 +35,12 @@ static xTaskHandle *mTaskHandles;
 static uint32_t mLastMonitorTime;
 static uint32_t mLastIdleMonitorTime;
 static uint16_t mMaxTasks;
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+// free stack words of every task at the last call, STACK_MARK_UNKNOWN until its first full scan
+static uint16_t *mStackMarks;
+static uint16_t mNextFullScan;
+#define STACK_MARK_UNKNOWN 0xFFFF
+#endif
 
 /**
  * Initialize the Task Monitor
@@ -52,6 +58,15 @@ int32_t PIOS_TASK_MONITOR_Initialize(uint16_t max_tasks)
     }
     memset(mTaskHandles, 0, max_tasks * sizeof(xTaskHandle));
 
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+    mStackMarks = (uint16_t *)pios_malloc(max_tasks * sizeof(uint16_t));
+    if (!mStackMarks) {
+        return -1;
+    }
+    memset(mStackMarks, 0xFF, max_tasks * sizeof(uint16_t));
+    mNextFullScan = 0;
+#endif
+
     mMaxTasks = max_tasks;
 #if (configGENERATE_RUN_TIME_STATS == 1)
     mLastMonitorTime     = portGET_RUN_TIME_COUNTER_VALUE();
@@ -71,6 +86,9 @@ int32_t PIOS_TASK_MONITOR_RegisterTask(uint16_t task_id, xTaskHandle handle)
     if (mTaskHandles && task_id < mMaxTasks) {
         xSemaphoreTakeRecursive(mLock, portMAX_DELAY);
         mTaskHandles[task_id] = handle;
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+        mStackMarks[task_id]  = STACK_MARK_UNKNOWN;
+#endif
         xSemaphoreGiveRecursive(mLock);
         return 0;
     } else {
@@ -101,8 +119,41 @@ bool PIOS_TASK_MONITOR_IsRunning(uint16_t task_id)
     return mTaskHandles && task_id <= mMaxTasks && mTaskHandles[task_id];
 }
 
+/**
+ * Find the id a task handle was registered with
+ * \return the task id or -1 if the handle is not registered
+ */
+int32_t PIOS_TASK_MONITOR_GetTaskId(xTaskHandle handle)
+{
+    if (!mTaskHandles || !handle) {
+        return -1;
+    }
+    for (uint16_t n = 0; n < mMaxTasks; n++) {
+        if (mTaskHandles[n] == handle) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Get the handle a task was registered with
+ * \return the task handle or NULL if the task is not running
+ */
+xTaskHandle PIOS_TASK_MONITOR_GetTaskHandle(uint16_t task_id)
+{
+    if (!mTaskHandles || task_id >= mMaxTasks) {
+        return NULL;
+    }
+    return mTaskHandles[task_id];
+}
+
 /**
  * Tell the caller the status of all tasks via a task-by-task callback
+ *
+ * The stack of a task is fully scanned on its first call and then for one task per
+ * call in turn, the others only check the words below their previous mark. The lock
+ * is only held while the information of a task is gathered, not during the callback.
  */
 void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *context)
 {
@@ -121,32 +172,50 @@ void PIOS_TASK_MONITOR_ForEachTask(TaskMonitorTaskInfoCallback callback, void *c
     uint32_t deltaTime   = ((currentTime - mLastMonitorTime) / 100) ? : 1;
     mLastMonitorTime = currentTime;
 #endif
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32)
+    uint16_t fullScan = mNextFullScan;
+    mNextFullScan = (mNextFullScan + 1) % mMaxTasks;
+#endif
+
+    xSemaphoreGiveRecursive(mLock);
+
     /* Update all task information */
     for (uint16_t n = 0; n < mMaxTasks; ++n) {
         struct pios_task_info info;
+
+        xSemaphoreTakeRecursive(mLock, portMAX_DELAY);
         if (mTaskHandles[n]) {
             info.is_running = true;
 #if defined(ARCH_POSIX) || defined(ARCH_WIN32)
             info.stack_remaining = 10000;
 #else
-            info.stack_remaining = uxTaskGetStackHighWaterMark(mTaskHandles[n]) * 4;
+            bool full = (n == fullScan || mStackMarks[n] == STACK_MARK_UNKNOWN);
+            mStackMarks[n] = uxTaskUpdateStackHighWaterMark(mTaskHandles[n], mStackMarks[n], full ? pdTRUE : pdFALSE);
+            info.stack_remaining = mStackMarks[n] * 4;
 #endif
 #if (configGENERATE_RUN_TIME_STATS == 1)
             /* Generate run time percentage stats */
-            info.running_time_percentage = uxTaskGetRunTime(mTaskHandles[n]) / deltaTime;
+            uint32_t maxSlice;
+            info.running_time_percentage = uxTaskGetRunTimeInfo(mTaskHandles[n], &maxSlice, &info.context_switches) / deltaTime;
+            /* the run time counter counts cpu cycles */
+            info.max_running_time = maxSlice / (configCPU_CLOCK_HZ / 1000000);
 #else
             info.running_time_percentage = 0;
+            info.max_running_time = 0;
+            info.context_switches = 0;
 #endif
         } else {
             info.is_running = false;
             info.stack_remaining = 0;
             info.running_time_percentage = 0;
+            info.max_running_time = 0;
+            info.context_switches = 0;
         }
+        xSemaphoreGiveRecursive(mLock);
+
         /* Pass the information for this task back to the caller */
         callback(n, &info, context);
     }
-
-    xSemaphoreGiveRecursive(mLock);
 }
 
 uint8_t PIOS_TASK_MONITOR_GetIdlePercentage()
@@ -7,7 +7,7 @@
  * @{
  * @addtogroup PiOS
  * @{
- * @brief PiOS trace debug function
+ * @brief PiOS trace debug function and binary trace buffer
  *****************************************************************************/
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -25,7 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
-
+#include "pios.h"
 #include "pios_trace.h"
 
 unsigned pios_trace_mask = 0;
@@ -41,3 +41,132 @@ unsigned pios_get_trace(void)
 {
     return pios_trace_mask;
 }
+
+#ifdef PIOS_INCLUDE_TRACE_BUFFER
+
+#ifndef PIOS_TRACE_BUFFER_RECORDS
+#define PIOS_TRACE_BUFFER_RECORDS 256
+#endif
+#if (PIOS_TRACE_BUFFER_RECORDS & (PIOS_TRACE_BUFFER_RECORDS - 1)) != 0
+#error PIOS_TRACE_BUFFER_RECORDS must be a power of two
+#endif
+#define RECORD_INDEX(n) ((n) & (PIOS_TRACE_BUFFER_RECORDS - 1))
+
+volatile uint32_t pios_trace_categories = 0;
+
+static struct pios_trace_record records[PIOS_TRACE_BUFFER_RECORDS];
+// number of the next record to write, reserved atomically by the writers
+static volatile uint32_t head = 0;
+// number of the next record to read, only used by the reader
+static uint32_t tail = 0;
+static uint32_t lost = 0;
+
+static inline uint32_t reserveRecord(void)
+{
+#if defined(__ARM_ARCH_6M__)
+    // no exclusive load and store on Cortex-M0
+    PIOS_IRQ_Disable();
+    uint32_t n = head++;
+    PIOS_IRQ_Enable();
+    return n;
+#else
+    return __sync_fetch_and_add(&head, 1);
+#endif
+}
+
+/**
+ * Write one record, from a task or an ISR.
+ * The record is published by writing its sequence last, a record whose sequence
+ * does not match its number is still being written.
+ */
+void PIOS_TRACE_Record(uint8_t category, uint8_t event, uint32_t data)
+{
+    uint32_t time = PIOS_DELAY_GetRaw();
+    uint32_t n    = reserveRecord();
+    struct pios_trace_record *record = &records[RECORD_INDEX(n)];
+
+    // matches neither the record being overwritten nor this one
+    record->sequence = (uint16_t)(n + 1);
+    __sync_synchronize();
+    record->time     = time;
+    record->data     = data;
+    record->category = category;
+    record->event    = event;
+    __sync_synchronize();
+    record->sequence = (uint16_t)n;
+}
+
+void PIOS_TRACE_SetCategories(uint32_t categories)
+{
+    pios_trace_categories = categories;
+}
+
+uint32_t PIOS_TRACE_GetCategories(void)
+{
+    return pios_trace_categories;
+}
+
+/**
+ * Read the oldest records, from a single task.
+ * Their time is converted to PIOS_DELAY_GetuS() time, so they must be read
+ * before the raw timer wraps.
+ * \param[out] out buffer for the records
+ * \param[in] max_records size of the buffer
+ * \return number of records read
+ */
+uint16_t PIOS_TRACE_Read(struct pios_trace_record *out, uint16_t max_records)
+{
+    uint16_t count = 0;
+
+    while (count < max_records) {
+        uint32_t written = head;
+        if (written == tail) {
+            break;
+        }
+        if (written - tail > PIOS_TRACE_BUFFER_RECORDS) {
+            // overwritten before being read
+            lost += written - tail - PIOS_TRACE_BUFFER_RECORDS;
+            tail  = written - PIOS_TRACE_BUFFER_RECORDS;
+        }
+
+        const struct pios_trace_record *record = &records[RECORD_INDEX(tail)];
+        uint16_t sequence = record->sequence;
+        __sync_synchronize();
+        out[count] = *record;
+        __sync_synchronize();
+        if (sequence != (uint16_t)tail || record->sequence != sequence) {
+            if (head - tail > PIOS_TRACE_BUFFER_RECORDS) {
+                // overwritten while being copied
+                continue;
+            }
+            // still being written, read it next time
+            break;
+        }
+
+        out[count].time = PIOS_DELAY_GetuS() - PIOS_DELAY_DiffuS(out[count].time);
+        count++;
+        tail++;
+    }
+    return count;
+}
+
+/**
+ * \param[out] recorded number of records written since boot
+ * \param[out] lost_records number of records overwritten before being read
+ */
+void PIOS_TRACE_GetStats(uint32_t *recorded, uint32_t *lost_records)
+{
+    if (recorded) {
+        *recorded = head;
+    }
+    if (lost_records) {
+        *lost_records = lost;
+    }
+}
+
+void PIOS_TRACE_TaskSwitchedIn(void *task)
+{
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_TASK, PIOS_TRACE_INSTANT, (uint32_t)(uintptr_t)task);
+}
+
+#endif /* PIOS_INCLUDE_TRACE_BUFFER */
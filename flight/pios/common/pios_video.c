@@ -51,12 +51,13 @@ static const struct pios_video_cfg *dev_cfg;
 // For 192x128 pixel mode, allocations are as the names are written.
 // divide by 8 because two bytes to a word.
 // Must be allocated in one block, so it is in a struct.
+// Word aligned so osdgen can fill spans 32 bits at a time.
 struct _buffers {
     uint8_t buffer0_level[GRAPHICS_HEIGHT * GRAPHICS_WIDTH];
     uint8_t buffer0_mask[GRAPHICS_HEIGHT * GRAPHICS_WIDTH];
     uint8_t buffer1_level[GRAPHICS_HEIGHT * GRAPHICS_WIDTH];
     uint8_t buffer1_mask[GRAPHICS_HEIGHT * GRAPHICS_WIDTH];
-} buffers;
+} __attribute__((aligned(4))) buffers;
 
 // Remove the struct definition (makes it easier to write for.)
 #define         buffer0_level (buffers.buffer0_level)
@@ -78,6 +79,16 @@ volatile uint16_t Vsync_update = 0;
 volatile uint16_t Hsync_update = 0;
 static int16_t m_osdLines = 0;
 
+// set by the renderer once the draw buffer holds a whole frame, cleared by the swap
+static volatile bool frame_ready = true;
+static uint16_t late_frames = 0;
+
+// cost of the line interrupts of the field being clocked out, and of the last whole field
+static uint32_t line_cycles_max   = 0;
+static uint32_t line_cycles_total = 0;
+static uint16_t line_count = 0;
+static struct pios_video_line_stats line_stats;
+
 /**
  * swap_buffers: Swaps the two buffers. Contents in the display
  * buffer is seen on the output and the display buffer becomes
@@ -112,6 +123,14 @@ bool PIOS_Vsync_ISR()
     xHigherPriorityTaskWoken = pdFALSE;
     m_osdLines = gActiveLine;
 
+    line_stats.max_cycles = line_cycles_max;
+    line_stats.avg_cycles = line_count ? line_cycles_total / line_count : 0;
+    line_stats.lines = line_count;
+    line_stats.late_frames = late_frames;
+    line_cycles_max   = 0;
+    line_cycles_total = 0;
+    line_count = 0;
+
     stop_hsync_timers();
 
     // Wait for previous word to clock out of each
@@ -123,12 +142,18 @@ bool PIOS_Vsync_ISR()
     Hsync_update = 0;
     Vsync_update++;
     if (Vsync_update >= 2) {
-        // load second image buffer
-        swap_buffers();
         Vsync_update = 0;
-
-        // trigger redraw every second field
-        xHigherPriorityTaskWoken = xSemaphoreGiveFromISR(osdSemaphore, &xHigherPriorityTaskWoken);
+        if (frame_ready) {
+            // load second image buffer, only once it is complete so a slow
+            // renderer repeats the previous frame instead of showing half of one
+            swap_buffers();
+            frame_ready = false;
+
+            // trigger redraw every second field
+            xHigherPriorityTaskWoken = xSemaphoreGiveFromISR(osdSemaphore, &xHigherPriorityTaskWoken);
+        } else {
+            late_frames++;
+        }
     }
 
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken); // portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
@@ -141,6 +166,26 @@ uint16_t PIOS_Video_GetOSDLines(void)
     return m_osdLines;
 }
 
+/**
+ * Mark the draw buffer as complete, it is shown from the next frame on.
+ * The draw buffer must not be touched again before osdSemaphore is given.
+ */
+void PIOS_Video_SetFrameReady(void)
+{
+    frame_ready = true;
+}
+
+/**
+ * Get the cost of the line interrupts during the last field
+ * \param[out] stats line interrupt statistics
+ */
+void PIOS_Video_GetLineStats(struct pios_video_line_stats *stats)
+{
+    PIOS_IRQ_Disable();
+    *stats = line_stats;
+    PIOS_IRQ_Enable();
+}
+
 /**
  * Stops the pixel clock and ensures it ignores the rising edge.  To be used after a
  * vsync until the first line is to be displayed
@@ -388,13 +433,11 @@ static void prepare_line(uint32_t line_num)
         DMA_SetCurrDataCounter(dev_cfg->level.dma.tx.channel, BUFFER_LINE_LENGTH);
         DMA_SetCurrDataCounter(dev_cfg->mask.dma.tx.channel, BUFFER_LINE_LENGTH);
 
+        // The SPI DMA requests enabled in PIOS_Video_Init() survive the SPI being
+        // disabled by flush_spi(), only the SPI has to be restarted
         SPI_Cmd(dev_cfg->level.regs, ENABLE);
         SPI_Cmd(dev_cfg->mask.regs, ENABLE);
 
-        /* Enable SPI interrupts to DMA */
-        SPI_I2S_DMACmd(dev_cfg->mask.regs, SPI_I2S_DMAReq_Tx, ENABLE);
-        SPI_I2S_DMACmd(dev_cfg->level.regs, SPI_I2S_DMAReq_Tx, ENABLE);
-
         DMA_Cmd(dev_cfg->level.dma.tx.channel, ENABLE);
         DMA_Cmd(dev_cfg->mask.dma.tx.channel, ENABLE);
     }
@@ -447,6 +490,8 @@ void PIOS_VIDEO_DMA_Handler(void)
 {
     // Handle flags from stream channel
     if (DMA_GetFlagStatus(dev_cfg->level.dma.tx.channel, DMA_FLAG_TCIF5)) { // whole double buffer filled
+        uint32_t start = PIOS_DELAY_GetRaw();
+
         DMA_ClearFlag(dev_cfg->level.dma.tx.channel, DMA_FLAG_TCIF5);
         if (gActiveLine < GRAPHICS_HEIGHT) {
             flush_spi();
@@ -465,6 +510,13 @@ void PIOS_VIDEO_DMA_Handler(void)
             DMA_Cmd(dev_cfg->level.dma.tx.channel, DISABLE);
         }
         gActiveLine++;
+
+        uint32_t cycles = PIOS_DELAY_GetRaw() - start;
+        if (cycles > line_cycles_max) {
+            line_cycles_max = cycles;
+        }
+        line_cycles_total += cycles;
+        line_count++;
     } else if (DMA_GetFlagStatus(dev_cfg->level.dma.tx.channel, DMA_FLAG_HTIF5)) {
         DMA_ClearFlag(dev_cfg->level.dma.tx.channel, DMA_FLAG_HTIF5);
     } else {}
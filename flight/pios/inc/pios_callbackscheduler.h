@@ -197,6 +197,14 @@ struct pios_callback_info {
     bool     is_running;
     /** Count of executions of the callback since system start */
     uint32_t running_time_count;
+    /** Longest time in microseconds from dispatch or schedule expiry to invocation */
+    uint32_t max_latency;
+    /** Percentage of time spent in the callback since the last call to
+     *  PIOS_CALLBACKSCHEDULER_ForEachCallback(), including preemption by higher priority tasks */
+    uint8_t  running_time_percentage;
+    /** Longest single execution of the callback in microseconds since the last call
+     *  to PIOS_CALLBACKSCHEDULER_ForEachCallback() */
+    uint32_t max_running_time;
 };
 
 /**
@@ -61,6 +61,58 @@ void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8
  */
 void PIOS_DEBUGLOG_Printf(char *format, ...);
 
+/**
+ * @brief Write a deferred debug log message, use PIOS_DEBUGLOG_PRINTF()
+ * @param[in] format, in the .debuglogformats section
+ * @param[in] number of arguments, at most PIOS_DEBUGLOG_MAX_ARGS
+ * @param[in] arguments as raw 32 bit words
+ */
+void PIOS_DEBUGLOG_Deferred(const char *format, uint8_t argc, const uint32_t *argv);
+
+#define PIOS_DEBUGLOG_MAX_ARGS 8
+
+/*
+ * PIOS_DEBUGLOG_PRINTF(format, ...) logs a message like PIOS_DEBUGLOG_Printf()
+ * but does not format it. Only the offset of the format string in the
+ * .debuglogformats section and the arguments are logged, which takes a constant
+ * time whatever the message. The GCS formats it with the table extracted from
+ * the firmware by the "formats" make target.
+ *
+ * The arguments are logged as 32 bit words: integers, characters and pointers
+ * are supported, floats must be passed through PIOS_DEBUGLOG_FLOAT(), strings
+ * are not. Without PIOS_INCLUDE_DEBUGLOG_FORMATS the message is formatted on
+ * the board instead.
+ */
+#if defined(PIOS_INCLUDE_DEBUGLOG_FORMATS)
+#define PIOS_DEBUGLOG_PRINTF(format, ...) \
+    do { \
+        static const char pios_debuglog_format[] __attribute__((section(".debuglogformats"))) = format; \
+        const uint32_t pios_debuglog_args[] = { 0, ## __VA_ARGS__ }; \
+        PIOS_DEBUGLOG_Deferred(pios_debuglog_format, sizeof(pios_debuglog_args) / sizeof(uint32_t) - 1, &pios_debuglog_args[1]); \
+    } while (0)
+#define PIOS_DEBUGLOG_FLOAT(x) PIOS_DEBUGLOG_FloatBits(x)
+#else
+#define PIOS_DEBUGLOG_PRINTF(format, ...) PIOS_DEBUGLOG_Printf(format, ## __VA_ARGS__)
+#define PIOS_DEBUGLOG_FLOAT(x)            ((double)(x))
+#endif
+
+static inline uint32_t PIOS_DEBUGLOG_FloatBits(float x)
+{
+    union {
+        float    f;
+        uint32_t u;
+    } bits = { .f = x };
+
+    return bits.u;
+}
+
+/**
+ * @brief Write a debug log entry with binary trace records
+ * @param[in] records, struct pios_trace_record
+ * @param[in] size of the records in bytes, at most the size of an entry
+ */
+void PIOS_DEBUGLOG_Trace(const void *records, size_t size);
+
 /**
  * @brief Load one object instance from the filesystem
  * @param[out] buffer where to store the uavobject
@@ -75,6 +127,15 @@ void PIOS_DEBUGLOG_Printf(char *format, ...);
  */
 int32_t PIOS_DEBUGLOG_Read(void *buffer, uint16_t flight, uint16_t inst);
 
+/**
+ * @brief Load the first entry at or after a position, for sequential downloads
+ * @param[out] buffer where to store the entry
+ * @param[in,out] flight to start from, set to the flight of the loaded entry
+ * @param[in,out] inst entry to start from, set to the loaded entry
+ * @return 0 if success, -3 if there is no entry at or after the position
+ */
+int32_t PIOS_DEBUGLOG_ReadNext(void *buffer, uint16_t *flight, uint16_t *inst);
+
 /**
  * @brief Retrieve run time info of logging system
  * @param[out] current flight number
@@ -84,6 +145,13 @@ int32_t PIOS_DEBUGLOG_Read(void *buffer, uint16_t flight, uint16_t inst);
  */
 void PIOS_DEBUGLOG_Info(uint16_t *flight, uint16_t *entry, uint16_t *free, uint16_t *used);
 
+/**
+ * @brief Retrieve run time statistics of the logging pipeline
+ * @param[out] entries dropped because no log buffer was free
+ * @param[out] blocks queued while the flash writer was still busy with older ones
+ */
+void PIOS_DEBUGLOG_Stats(uint32_t *dropped, uint32_t *backpressure);
+
 /**
  * @brief Format entire flash memory!!!
  */
@@ -40,6 +40,10 @@ extern uint32_t PIOS_DELAY_GetuSSince(uint32_t t);
 extern uint32_t PIOS_DELAY_GetRaw();
 extern uint32_t PIOS_DELAY_DiffuS(uint32_t raw);
 
+#if defined(ARCH_POSIX)
+extern int32_t PIOS_DELAY_InitLockStep(uint16_t port);
+#endif
+
 #endif /* PIOS_DELAY_H */
 
 /**
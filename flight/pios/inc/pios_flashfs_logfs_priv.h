@@ -39,6 +39,8 @@ struct flashfs_logfs_cfg {
     uint32_t start_offset; /* Offset into flash where this filesystem starts */
     uint32_t sector_size; /* Size of a flash erase block */
     uint32_t page_size; /* Maximum flash burst write size */
+
+    uint16_t index_size; /* Max number of active slots tracked by the RAM slot index, 0 disables it */
 };
 
 int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg *cfg, const struct pios_flash_driver *driver, uintptr_t flash_id);
@@ -63,9 +63,23 @@ struct pios_i2c_fault_history {
     uint8_t  state[I2C_LOG_DEPTH];
 };
 
+/* Completion of an asynchronous transfer, result as returned by PIOS_I2C_Transfer() */
+typedef void (*pios_i2c_callback)(int32_t result, void *context);
+
+/* Per bus statistics, the counters wrap around */
+struct pios_i2c_bus_stats {
+    uint32_t transfers;
+    uint32_t errors;
+    uint32_t nacks;
+    uint32_t timeouts;
+    uint32_t queue_full;
+    uint32_t busy_us;
+};
+
 /* Public Functions */
 extern int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns);
-extern int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, void *callback);
+extern int32_t PIOS_I2C_TransferAsync(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, pios_i2c_callback callback, void *context);
+extern int32_t PIOS_I2C_GetBusStats(uint8_t bus, struct pios_i2c_bus_stats *stats);
 extern void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id);
 extern void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id);
 extern void PIOS_I2C_IRQ_Handler(uint32_t i2c_id);
@@ -42,6 +42,17 @@ struct pios_i2c_adapter_cfg {
     struct stm32_irq  error;
 };
 
+#ifndef PIOS_I2C_ASYNC_QUEUE_LEN
+#define PIOS_I2C_ASYNC_QUEUE_LEN 4
+#endif
+
+struct pios_i2c_async_req {
+    const struct pios_i2c_txn *txn_list;
+    uint32_t num_txns;
+    pios_i2c_callback callback;
+    void *context;
+};
+
 enum pios_i2c_adapter_magic {
     PIOS_I2C_DEV_MAGIC = 0xa9a9b8b8,
 };
@@ -68,10 +79,24 @@ struct pios_i2c_adapter {
     const struct pios_i2c_txn *active_txn;
     const struct pios_i2c_txn *last_txn;
 
-    void    (*callback)();
-
     uint8_t *active_byte;
     uint8_t *last_byte;
+
+#if defined(STM32F4XX)
+    /* asynchronous requests, served in order while no blocking transfer waits for the bus */
+    struct pios_i2c_async_req async_queue[PIOS_I2C_ASYNC_QUEUE_LEN];
+    uint8_t  async_head;
+    uint8_t  async_count;
+    volatile bool bus_active;
+    volatile bool async_active;
+    volatile bool sync_waiting;
+#ifdef PIOS_INCLUDE_FREERTOS
+    xSemaphoreHandle sem_idle;
+#endif
+#endif /* defined(STM32F4XX) */
+
+    uint32_t transfer_start;
+    struct pios_i2c_bus_stats stats;
 };
 
 int32_t PIOS_I2C_Init(uint32_t *i2c_id, const struct pios_i2c_adapter_cfg *cfg);
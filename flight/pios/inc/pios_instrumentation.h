@@ -29,12 +29,20 @@
 #include <pios_debug.h>
 #include <pios_delay.h>
 #include <FreeRTOS.h>
+
+/**
+ * Number of log2 histogram buckets per counter. Bucket 0 counts the values <= 0,
+ * bucket n the values in [2^(n-1), 2^n) and the last one everything above.
+ */
+#define PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS 16
+
 typedef struct {
     uint32_t id;
     int32_t  max;
     int32_t  min;
     int32_t  value;
     uint32_t lastUpdateTS;
+    uint16_t histogram[PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS];
 } pios_perf_counter_t;
 
 typedef void *pios_counter_t;
@@ -42,6 +50,34 @@ typedef void *pios_counter_t;
 extern pios_perf_counter_t *pios_instrumentation_perf_counters;
 extern int8_t pios_instrumentation_last_used_counter;
 
+/**
+ * Update the min/max decay and the histogram of a counter with a new sample,
+ * called from within the critical section of the update functions below
+ * @param counter the counter to update
+ * @param sample the new sample
+ */
+inline void PIOS_Instrumentation_updateStats(pios_perf_counter_t *counter, int32_t sample)
+{
+    counter->max--;
+    if (sample > counter->max) {
+        counter->max = sample;
+    }
+    counter->min++;
+    if (sample < counter->min) {
+        counter->min = sample;
+    }
+    uint8_t bucket = sample > 0 ? 32 - __builtin_clz((uint32_t)sample) : 0;
+    if (bucket >= PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS) {
+        bucket = PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS - 1;
+    }
+    if (++counter->histogram[bucket] == UINT16_MAX) {
+        // halve all the buckets, the shape of the distribution is kept
+        for (uint8_t i = 0; i < PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS; i++) {
+            counter->histogram[i] >>= 1;
+        }
+    }
+}
+
 /**
  * Update a counter with a new value
  * @param counter_handle handle of the counter to update @see PIOS_Instrumentation_SearchCounter @see PIOS_Instrumentation_CreateCounter
@@ -53,14 +89,7 @@ inline void PIOS_Instrumentation_updateCounter(pios_counter_t counter_handle, in
     vPortEnterCritical();
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
     counter->value = newValue;
-    counter->max--;
-    if (counter->value > counter->max) {
-        counter->max = counter->value;
-    }
-    counter->min++;
-    if (counter->value < counter->min) {
-        counter->min = counter->value;
-    }
+    PIOS_Instrumentation_updateStats(counter, counter->value);
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
     vPortExitCritical();
 }
@@ -90,14 +119,25 @@ inline void PIOS_Instrumentation_TimeEnd(pios_counter_t counter_handle)
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
 
     counter->value = PIOS_DELAY_DiffuS(counter->lastUpdateTS);
-    counter->max--;
-    if (counter->value > counter->max) {
-        counter->max = counter->value;
-    }
-    counter->min++;
-    if (counter->value < counter->min) {
-        counter->min = counter->value;
-    }
+    PIOS_Instrumentation_updateStats(counter, counter->value);
+    counter->lastUpdateTS = PIOS_DELAY_GetRaw();
+    vPortExitCritical();
+}
+
+/**
+ * Used to determine the throughput of a code block, mark the end of the block. @see PIOS_Instrumentation_TimeStart
+ * @param counter_handle handle of the counter @see PIOS_Instrumentation_SearchCounter @see PIOS_Instrumentation_CreateCounter
+ * @param count number of items processed in the block, the counter stores items per ms
+ */
+inline void PIOS_Instrumentation_RateEnd(pios_counter_t counter_handle, uint32_t count)
+{
+    PIOS_Assert(pios_instrumentation_perf_counters && counter_handle);
+    vPortEnterCritical();
+    pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
+
+    uint32_t elapsed = PIOS_DELAY_DiffuS(counter->lastUpdateTS);
+    counter->value = (count * 1000) / (elapsed ? elapsed : 1);
+    PIOS_Instrumentation_updateStats(counter, counter->value);
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
     vPortExitCritical();
 }
@@ -114,14 +154,7 @@ inline void PIOS_Instrumentation_TrackPeriod(pios_counter_t counter_handle)
         vPortEnterCritical();
         uint32_t period = PIOS_DELAY_DiffuS(counter->lastUpdateTS);
         counter->value = (counter->value * 15 + period) / 16;
-        counter->max--;
-        if ((int32_t)period > counter->max) {
-            counter->max = period;
-        }
-        counter->min++;
-        if ((int32_t)period < counter->min) {
-            counter->min = period;
-        }
+        PIOS_Instrumentation_updateStats(counter, period);
         vPortExitCritical();
     }
     counter->lastUpdateTS = PIOS_DELAY_GetRaw();
@@ -141,10 +174,10 @@ void PIOS_Instrumentation_Init(int8_t maxCounters);
 pios_counter_t PIOS_Instrumentation_CreateCounter(uint32_t id);
 
 /**
- * search a counter index by its unique Id
+ * search a counter index by its unique Id, in constant time
  * @param id the unique id to assign to the counter.
  * If a counter with the same id exists, the previous instance is returned
- * @return the counter handle to be used to manage its content
+ * @return the counter handle to be used to manage its content, NULL if there is none
  */
 pios_counter_t PIOS_Instrumentation_SearchCounter(uint32_t id);
 
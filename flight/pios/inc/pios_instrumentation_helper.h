@@ -64,6 +64,11 @@
  * PERF_TIMED_SECTION_END(counterAtt);</pre>
  * PERF_TIMED_SECTION_[START!STOP] marks the beginning and the end of the code to monitor
  *
+ * Track the throughput of a certain function, in items per ms:
+ * <pre>PERF_TIMED_SECTION_START(counterParse);
+ * parse(buffer, len);
+ * PERF_TIMED_SECTION_END_RATE(counterParse, len);</pre>
+ *
  * Measure the mean of the period a certain point is reached:
  * <pre>PERF_MEASURE_PERIOD(counterPeriod);</pre>
  * Note that the value stored in the counter is a long running mean while max and min are single point values
@@ -96,6 +101,7 @@
  */
 #define PERF_TIMED_SECTION_START(x) PIOS_Instrumentation_TimeStart(x)
 #define PERF_TIMED_SECTION_END(x)   PIOS_Instrumentation_TimeEnd(x)
+#define PERF_TIMED_SECTION_END_RATE(x, n) PIOS_Instrumentation_RateEnd(x, n)
 #define PERF_MEASURE_PERIOD(x)      PIOS_Instrumentation_TrackPeriod(x)
 #define PERF_TRACK_VALUE(x, y)      PIOS_Instrumentation_updateCounter(x, y)
 
@@ -105,6 +111,7 @@
 #define PERF_INIT_COUNTER(x, id)
 #define PERF_TIMED_SECTION_START(x)
 #define PERF_TIMED_SECTION_END(x)
+#define PERF_TIMED_SECTION_END_RATE(x, n)
 #define PERF_MEASURE_PERIOD(x)
 #define PERF_TRACK_VALUE(x, y)
 #endif /* PIOS_INCLUDE_INSTRUMENTATION */
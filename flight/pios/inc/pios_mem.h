@@ -27,11 +27,36 @@
 #ifndef PIOS_MEM_H
 #define PIOS_MEM_H
 #include <strings.h>
+#include <stdint.h>
 
+/* Owners allocations are accounted to, order matches SystemStats.MemoryUsage */
+enum pios_mem_tag {
+    PIOS_MEM_TAG_UAVOBJECT = 0,
+    PIOS_MEM_TAG_EVENT,
+    PIOS_MEM_TAG_COM,
+    PIOS_MEM_TAG_CALLBACK,
+    PIOS_MEM_TAG_OTHER,
+    PIOS_MEM_TAG_NUM,
+};
+
+/* Fast heap (CCM on the F4), not reachable by DMA */
 void *pios_fastheapmalloc(size_t size);
 
+/* Main SRAM heap, safe to use as a DMA buffer */
 void *pios_malloc(size_t size);
 
 void pios_free(void *p);
 
+void *pios_fastheapmalloc_tagged(size_t size, enum pios_mem_tag tag);
+
+void *pios_malloc_tagged(size_t size, enum pios_mem_tag tag);
+
+/* Fixed size blocks from the fast heap for small and frequent allocations */
+void *pios_pool_malloc(size_t size, enum pios_mem_tag tag);
+
+void pios_pool_free(void *p, size_t size, enum pios_mem_tag tag);
+
+/* Bytes currently accounted to tag (heap allocations are not subtracted on pios_free) */
+uint32_t pios_mem_get_usage(enum pios_mem_tag tag);
+
 #endif /* PIOS_MEM_H */
@@ -61,6 +61,7 @@
 #define PIOS_MPU6000_FIFO_CNT_MSB             0x72
 #define PIOS_MPU6000_FIFO_CNT_LSB             0x73
 #define PIOS_MPU6000_FIFO_REG                 0x74
+#define PIOS_MPU6000_FIFO_SIZE                1024
 #define PIOS_MPU6000_WHOAMI                   0x75
 
 /* FIFO enable for storing different values */
@@ -151,8 +152,13 @@ struct pios_mpu6000_cfg {
     SPIPrescalerTypeDef fast_prescaler;
     SPIPrescalerTypeDef std_prescaler;
     uint8_t max_downsample;
+    /* FIFO mode when above 1: samples are queued in the chip FIFO and read in blocks of
+     * fifo_batch, up to PIOS_MPU6000_MAX_FIFO_BATCH, every fifo_batch data ready interrupts */
+    uint8_t fifo_batch;
 };
 
+#define PIOS_MPU6000_MAX_FIFO_BATCH 16
+
 /* Public Functions */
 extern int32_t PIOS_MPU6000_Init(uint32_t spi_id, uint32_t slave_num, const struct pios_mpu6000_cfg *new_cfg);
 extern int32_t PIOS_MPU6000_ConfigureRanges(enum pios_mpu6000_range gyroRange, enum pios_mpu6000_accel_range accelRange, enum pios_mpu6000_filter filterSetting);
@@ -35,11 +35,13 @@ struct pios_rcvr_driver {
     void    (*init)(uint32_t id);
     int32_t (*read)(uint32_t id, uint8_t channel);
     xSemaphoreHandle (*get_semaphore)(uint32_t id, uint8_t channel);
+    uint32_t (*get_frame_time)(uint32_t id);
 };
 
 /* Public Functions */
 extern int32_t PIOS_RCVR_Read(uint32_t rcvr_id, uint8_t channel);
 extern xSemaphoreHandle PIOS_RCVR_GetSemaphore(uint32_t rcvr_id, uint8_t channel);
+extern uint32_t PIOS_RCVR_GetFrameTime(uint32_t rcvr_id);
 
 /*! Define error codes for PIOS_RCVR_Get */
 enum PIOS_RCVR_errors {
@@ -82,6 +82,9 @@ struct rfm22b_stats {
     uint16_t packets_per_sec;
     uint16_t tx_byte_count;
     uint16_t rx_byte_count;
+    uint16_t tx_payload_count; // com bytes sent, without the PPM data and parity
+    uint16_t tx_airtime_ms;
+    uint8_t  tx_packet_len; // current adaptive packet data length
     uint16_t tx_seq;
     uint16_t rx_seq;
     uint8_t  rx_good;
@@ -99,6 +102,32 @@ struct rfm22b_stats {
     uint8_t  link_state;
 };
 
+// The RSSI histogram has buckets of RFM22B_RSSI_BUCKET_DB from RFM22B_RSSI_BUCKET_MIN dBm,
+// the first and last bucket also take the values below and above the range
+#define RFM22B_RSSI_BUCKETS     8
+#define RFM22B_RSSI_BUCKET_MIN  -120
+#define RFM22B_RSSI_BUCKET_DB   10
+#define RFM22B_RX_STATUS_NUM    4
+
+// Packet counters since the previous PIOS_RFM22B_GetLinkSummary()
+struct rfm22b_link_summary {
+    // received packets by status: good, corrected, error, failure
+    uint16_t rx_packets[RFM22B_RX_STATUS_NUM];
+    uint16_t rx_rssi_histogram[RFM22B_RSSI_BUCKETS];
+    int32_t  rx_rssi_sum; // of the packets counted in the histogram
+    int8_t   rx_rssi_min;
+    int8_t   rx_rssi_max;
+    uint16_t tx_packets;
+    uint16_t tx_failures;
+};
+
+// One received packet, as kept in the sample ring of the driver
+struct rfm22b_packet_sample {
+    uint16_t time_ms; // of the system time, wraps
+    int8_t   rssi;
+    uint8_t  status; // index of rx_packets
+};
+
 /* Public Functions */
 extern int32_t PIOS_RFM22B_Init(uint32_t *rfb22b_id, uint32_t spi_id, uint32_t slave_num, const struct pios_rfm22b_cfg *cfg);
 extern void PIOS_RFM22B_Reinit(uint32_t rfb22b_id);
@@ -107,6 +136,8 @@ extern void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarat
 extern void PIOS_RFM22B_SetCoordinatorID(uint32_t rfm22b_id, uint32_t coord_id);
 extern uint32_t PIOS_RFM22B_DeviceID(uint32_t rfb22b_id);
 extern void PIOS_RFM22B_GetStats(uint32_t rfm22b_id, struct rfm22b_stats *stats);
+extern void PIOS_RFM22B_GetLinkSummary(uint32_t rfm22b_id, struct rfm22b_link_summary *summary);
+extern uint8_t PIOS_RFM22B_GetPacketSamples(uint32_t rfm22b_id, struct rfm22b_packet_sample *samples, uint8_t max_samples);
 extern uint8_t PIOS_RFM2B_GetPairStats(uint32_t rfm22b_id, uint32_t *device_ids, int8_t *RSSIs, uint8_t max_pairs);
 extern bool PIOS_RFM22B_InRxWait(uint32_t rfb22b_id);
 extern bool PIOS_RFM22B_LinkStatus(uint32_t rfm22b_id);
@@ -574,6 +574,13 @@ enum pios_rfm22b_state {
 };
 
 #define RFM22B_RX_PACKET_STATS_LEN 4
+
+// Packets are shortened down to this data length while the receive errors persist
+#define RFM22B_MIN_ADAPTIVE_DATA_LEN 16
+
+// Length of the ring of the last received packets, must be a power of two
+#define RFM22B_PACKET_SAMPLES        16
+
 enum pios_rfm22b_rx_packet_status {
     RADIO_GOOD_RX_PACKET      = 0x00,
     RADIO_CORRECTED_RX_PACKET = 0x01,
@@ -716,6 +723,12 @@ struct pios_rfm22b_dev {
 
     // The packet statistics
     struct rfm22b_stats    stats;
+    // The packet counters since the last summary was read
+    struct rfm22b_link_summary link_summary;
+    // The last received packets, the indices run freely
+    struct rfm22b_packet_sample packet_samples[RFM22B_PACKET_SAMPLES];
+    uint8_t  packet_samples_wr;
+    uint8_t  packet_samples_rd;
 
     // Stats
     uint16_t errors;
@@ -752,6 +765,10 @@ struct pios_rfm22b_dev {
     uint32_t     rx_destination_id;
     // The maximum packet length (including header, etc.)
     uint8_t      max_packet_len;
+    // The adaptive limit of the data sent in a packet, between RFM22B_MIN_ADAPTIVE_DATA_LEN and max_packet_len
+    uint8_t      tx_data_len;
+    // Time spent transmitting in us, wraps
+    uint32_t     tx_airtime_us;
     // The packet transmit time in ms.
     uint8_t      packet_time;
     // Do all packets originate from the coordinator modem?
@@ -41,16 +41,40 @@ typedef void (*PIOS_SENSORS_fetch_function)(void *samples, uint8_t size, uintptr
  * order as they appear in PIOS_SENSORS_TYPE enums.
  */
 typedef void (*PIOS_SENSORS_get_scale_function)(float *, uint8_t size, uintptr_t context);
-typedef QueueHandle_t (*PIOS_SENSORS_get_queue_function)(uintptr_t context);
+/**
+ * return the time in microseconds before polling the sensor again makes sense,
+ * for example until a running conversion completes.
+ */
+typedef uint32_t (*PIOS_SENSORS_get_poll_delay_function)(uintptr_t context);
+
+/**
+ * Lock free single producer single consumer ring of samples, owned by an
+ * interrupt driven driver. The driver ISR fills the slot returned by
+ * PIOS_SENSORS_RingWriteSlot() and publishes it, the sensors task reads the
+ * samples in place and releases them, so samples are never copied.
+ */
+typedef struct PIOS_SENSORS_Ring {
+    uint8_t *buffer;
+    uint16_t sample_size;
+    uint16_t size; // slots, one is kept free to tell a full ring from an empty one
+    volatile uint16_t head; // written by the producer only
+    volatile uint16_t tail; // written by the consumer only
+    volatile bool waiting; // the consumer sleeps on ready
+    SemaphoreHandle_t ready;
+} PIOS_SENSORS_Ring;
+
+typedef PIOS_SENSORS_Ring *(*PIOS_SENSORS_get_ring_function)(uintptr_t context);
 
 typedef struct PIOS_SENSORS_Driver {
     PIOS_SENSORS_test_function      test; // called at startup to test the sensor
     PIOS_SENSORS_poll_function      poll; // called to check whether data are available for polled sensors
     PIOS_SENSORS_fetch_function     fetch; // called to fetch data for polled sensors
     PIOS_SENSORS_reset_function     reset; // reset sensor. for example if data are not received in the allotted time
-    PIOS_SENSORS_get_queue_function get_queue; // get the queue reference
+    PIOS_SENSORS_get_ring_function  get_ring; // get the sample ring of interrupt driven sensors
     PIOS_SENSORS_get_scale_function get_scale; // return scales for the sensors
+    PIOS_SENSORS_get_poll_delay_function get_poll_delay; // polled sensors without ready event, delay until the next poll. NULL polls every sensor period
     bool is_polled;
+    bool signals_ready; // polled sensor raising its ready event, it is only polled once the event was raised
 } PIOS_SENSORS_Driver;
 
 typedef enum PIOS_SENSORS_TYPE {
@@ -68,7 +92,9 @@ typedef struct PIOS_SENSORS_Instance {
     const PIOS_SENSORS_Driver    *driver;
     uintptr_t context;
     struct PIOS_SENSORS_Instance *next;
-    uint8_t type;
+    uint32_t   event; // ready event bit, unique to the instance
+    TickType_t next_poll; // used by the sensors task to schedule the instance
+    uint8_t    type;
 } PIOS_SENSORS_Instance;
 
 /**
@@ -100,6 +126,23 @@ PIOS_SENSORS_Instance *PIOS_SENSORS_Register(const PIOS_SENSORS_Driver *driver,
  */
 PIOS_SENSORS_Instance *PIOS_SENSORS_GetList();
 
+/**
+ * Raise the ready event of a sensor from interrupt context. Interrupt driven
+ * sensors raise it once new samples are available, so the sensors task does
+ * not have to poll them.
+ * @param sensor instance, NULL if the driver was not registered
+ * @return true if a higher priority task was woken
+ */
+bool PIOS_SENSORS_RaiseEventFromISR(const PIOS_SENSORS_Instance *sensor);
+
+/**
+ * Wait until one of the given ready events was raised. Task context only.
+ * @param mask events to wait for, other events stay pending
+ * @param timeout ticks to wait at most
+ * @return the raised events within mask, they are cleared
+ */
+uint32_t PIOS_SENSORS_WaitEvents(uint32_t mask, TickType_t timeout);
+
 /**
  * Perform sensor test and return true if passed
  * @param sensor instance to test
@@ -131,6 +174,21 @@ static inline bool PIOS_SENSORS_Poll(const PIOS_SENSORS_Instance *sensor)
         return sensor->driver->poll(sensor->context);
     }
 }
+/**
+ * Time until polling the sensor again makes sense
+ * @param sensor instance
+ * @return delay in microseconds, 0 if the sensor should be polled every sensor period
+ */
+static inline uint32_t PIOS_SENSORS_GetPollDelay(const PIOS_SENSORS_Instance *sensor)
+{
+    PIOS_Assert(sensor);
+
+    if (!sensor->driver->get_poll_delay) {
+        return 0;
+    }
+    return sensor->driver->get_poll_delay(sensor->context);
+}
+
 /**
  *
  * @param sensor
@@ -150,17 +208,102 @@ static inline void PIOS_SENSOR_Reset(const PIOS_SENSORS_Instance *sensor)
 }
 
 /**
- * retrieve the sensor queue
+ * retrieve the sensor sample ring
  * @param sensor
- * @return sensor queue or null if not supported
+ * @return sensor ring or null if not supported
  */
-static inline QueueHandle_t PIOS_SENSORS_GetQueue(const PIOS_SENSORS_Instance *sensor)
+static inline PIOS_SENSORS_Ring *PIOS_SENSORS_GetRing(const PIOS_SENSORS_Instance *sensor)
 {
     PIOS_Assert(sensor);
-    if (!sensor->driver->get_queue) {
+    if (!sensor->driver->get_ring) {
         return NULL;
     }
-    return sensor->driver->get_queue(sensor->context);
+    return sensor->driver->get_ring(sensor->context);
+}
+
+/**
+ * Allocate a sample ring
+ * @param samples number of samples the ring can hold
+ * @param sample_size size in bytes of a sample
+ * @return the new ring
+ */
+PIOS_SENSORS_Ring *PIOS_SENSORS_RingCreate(uint16_t samples, uint16_t sample_size);
+
+/**
+ * Wait until the ring holds a sample. Consumer side, task context only.
+ * @param ring
+ * @param timeout ticks to wait at most
+ * @return true if a sample is available
+ */
+bool PIOS_SENSORS_RingWait(PIOS_SENSORS_Ring *ring, TickType_t timeout);
+
+static inline uint16_t PIOS_SENSORS_RingNext(const PIOS_SENSORS_Ring *ring, uint16_t index)
+{
+    return (index + 1 == ring->size) ? 0 : index + 1;
+}
+
+/**
+ * Producer side, get the slot to fill with the next sample
+ * @param ring
+ * @return the slot or null if the ring is full and the sample should be dropped
+ */
+static inline void *PIOS_SENSORS_RingWriteSlot(PIOS_SENSORS_Ring *ring)
+{
+    if (PIOS_SENSORS_RingNext(ring, ring->head) == ring->tail) {
+        return NULL;
+    }
+    return ring->buffer + ring->head * ring->sample_size;
+}
+
+/**
+ * Producer side, make the filled slot visible to the consumer
+ * @param ring
+ */
+static inline void PIOS_SENSORS_RingCommit(PIOS_SENSORS_Ring *ring)
+{
+    // the sample must be complete in memory before the consumer can see it
+    __sync_synchronize();
+    ring->head = PIOS_SENSORS_RingNext(ring, ring->head);
+}
+
+/**
+ * Producer side, wake the consumer up after one or several commits
+ * @param ring
+ * @return true if a higher priority task was woken
+ */
+static inline bool PIOS_SENSORS_RingNotifyFromISR(PIOS_SENSORS_Ring *ring)
+{
+    BaseType_t woken = pdFALSE;
+    if (ring->waiting) {
+        ring->waiting = false;
+        xSemaphoreGiveFromISR(ring->ready, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+/**
+ * Consumer side, get the oldest sample without removing it
+ * @param ring
+ * @return the sample or null if the ring is empty
+ */
+static inline const void *PIOS_SENSORS_RingPeek(const PIOS_SENSORS_Ring *ring)
+{
+    if (ring->tail == ring->head) {
+        return NULL;
+    }
+    __sync_synchronize();
+    return ring->buffer + ring->tail * ring->sample_size;
+}
+
+/**
+ * Consumer side, hand the oldest sample slot back to the producer
+ * @param ring
+ */
+static inline void PIOS_SENSORS_RingRelease(PIOS_SENSORS_Ring *ring)
+{
+    // done reading before the producer may overwrite the slot
+    __sync_synchronize();
+    ring->tail = PIOS_SENSORS_RingNext(ring, ring->tail);
 }
 /**
  * Get the sensor scales.
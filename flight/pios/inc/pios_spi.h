@@ -42,6 +42,40 @@ typedef enum {
     PIOS_SPI_PRESCALER_256 = 7
 } SPIPrescalerTypeDef;
 
+/* One transfer of an asynchronous request. The slave is selected before it and
+ * released after it, unless keep_selected chains it into the next transfer. */
+struct pios_spi_txn {
+    uint32_t      slave_id;
+    const uint8_t *send_buf;
+    uint8_t       *recv_buf;
+    uint16_t      len;
+    bool keep_selected;
+};
+
+/* High priority requests are served first, at the end of the transfer in progress */
+enum pios_spi_priority {
+    PIOS_SPI_PRIORITY_NORMAL = 0,
+    PIOS_SPI_PRIORITY_HIGH   = 1,
+};
+
+/* Completion of an asynchronous request, result as returned by PIOS_SPI_TransferBlock() */
+typedef void (*pios_spi_callback)(int32_t result, void *context);
+
+/* Per bus statistics, the counters wrap around */
+struct pios_spi_bus_stats {
+    uint32_t claims;
+    uint32_t claim_wait_us;
+    uint32_t claim_wait_max_us;
+    uint32_t queue_full;
+};
+
+/* Per slave statistics of the asynchronous requests, wait is from queueing to start */
+struct pios_spi_slave_stats {
+    uint32_t requests;
+    uint32_t wait_us;
+    uint32_t wait_max_us;
+};
+
 /* Public Functions */
 extern int32_t PIOS_SPI_SetClockSpeed(uint32_t spi_id, SPIPrescalerTypeDef spi_prescaler);
 extern int32_t PIOS_SPI_RC_PinSet(uint32_t spi_id, uint32_t slave_id, uint8_t pin_value);
@@ -54,6 +88,10 @@ extern int32_t PIOS_SPI_ReleaseBus(uint32_t spi_id);
 extern int32_t PIOS_SPI_ReleaseBusISR(uint32_t spi_id, bool *woken);
 extern void    PIOS_SPI_IRQ_Handler(uint32_t spi_id);
 extern void    PIOS_SPI_SetPrescalar(uint32_t spi_id, uint32_t prescalar);
+extern int32_t PIOS_SPI_TransferAsync(uint32_t spi_id, const struct pios_spi_txn txn_list[], uint32_t num_txns, SPIPrescalerTypeDef spi_prescaler,
+                                      enum pios_spi_priority priority, pios_spi_callback callback, void *context);
+extern int32_t PIOS_SPI_GetBusStats(uint32_t spi_id, struct pios_spi_bus_stats *stats);
+extern int32_t PIOS_SPI_GetSlaveStats(uint32_t spi_id, uint32_t slave_id, struct pios_spi_slave_stats *stats);
 
 #endif /* PIOS_SPI_H */
 
@@ -47,6 +47,24 @@ struct pios_spi_cfg {
     struct stm32_gpio ssel[];
 };
 
+#ifndef PIOS_SPI_ASYNC_QUEUE_LEN
+#define PIOS_SPI_ASYNC_QUEUE_LEN 4
+#endif
+
+#ifndef PIOS_SPI_STATS_SLAVES
+#define PIOS_SPI_STATS_SLAVES    4
+#endif
+
+struct pios_spi_async_req {
+    const struct pios_spi_txn *txn_list;
+    uint32_t num_txns;
+    uint16_t prescaler;
+    enum pios_spi_priority    priority;
+    pios_spi_callback callback;
+    void     *context;
+    uint32_t queued;
+};
+
 struct pios_spi_dev {
     const struct pios_spi_cfg *cfg;
     void    (*callback)(uint8_t, uint8_t);
@@ -57,6 +75,18 @@ struct pios_spi_dev {
 #else
     uint8_t busy;
 #endif
+
+#if defined(STM32F4XX)
+    /* asynchronous requests by priority, the head is in progress while async_active owns the bus */
+    struct pios_spi_async_req async_queue[PIOS_SPI_ASYNC_QUEUE_LEN];
+    uint8_t  async_count;
+    uint8_t  async_txn;
+    uint16_t async_saved_br;
+    volatile bool async_active;
+#endif /* defined(STM32F4XX) */
+
+    struct pios_spi_bus_stats   stats;
+    struct pios_spi_slave_stats slave_stats[PIOS_SPI_STATS_SLAVES];
 };
 
 extern int32_t PIOS_SPI_Init(uint32_t *spi_id, const struct pios_spi_cfg *cfg);
@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ * @file       pios_streamfs.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_STREAMFS Append-only Flash Log Stream
+ * @{
+ * @brief Append-only record stream on raw flash sectors, used for flight logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_STREAMFS_H
+#define PIOS_STREAMFS_H
+
+#include <stdint.h>
+#include "pios_flash.h" /* struct pios_flash_driver */
+
+struct streamfs_cfg {
+    uint32_t fs_magic;
+    uint32_t total_fs_size; /* Total size of the stream, a multiple of sector_size */
+
+    uint32_t start_offset; /* Offset into flash where this stream starts */
+    uint32_t sector_size; /* Size of a flash erase block */
+    uint32_t page_size; /* Maximum flash burst write size */
+};
+
+struct PIOS_STREAMFS_Stats {
+    uint32_t used_bytes; /* bytes in sectors holding log data */
+    uint32_t free_bytes; /* bytes that can be appended before the oldest data is recycled */
+};
+
+/* Pass as cursor to PIOS_STREAMFS_ReadRecord() to start at the oldest record */
+#define PIOS_STREAMFS_CURSOR_START 0xFFFFFFFF
+
+int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, const struct pios_flash_driver *driver, uintptr_t flash_id);
+int32_t PIOS_STREAMFS_Destroy(uintptr_t fs_id);
+int32_t PIOS_STREAMFS_Format(uintptr_t fs_id);
+int32_t PIOS_STREAMFS_Append(uintptr_t fs_id, const uint8_t *data, uint16_t len);
+int32_t PIOS_STREAMFS_Flush(uintptr_t fs_id);
+int32_t PIOS_STREAMFS_ReadRecord(uintptr_t fs_id, uint32_t *cursor, uint8_t *data, uint16_t max_len);
+int32_t PIOS_STREAMFS_ReadSector(uintptr_t fs_id, uint16_t sector, uint32_t offset, uint8_t *data, uint16_t len);
+int32_t PIOS_STREAMFS_GetStats(uintptr_t fs_id, struct PIOS_STREAMFS_Stats *stats);
+
+#endif /* PIOS_STREAMFS_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -71,6 +71,20 @@ extern int32_t PIOS_TASK_MONITOR_UnregisterTask(uint16_t task_id);
  */
 extern bool PIOS_TASK_MONITOR_IsRunning(uint16_t task_id);
 
+/**
+ * Find the id a task handle was registered with.
+ * @param handle The FreeRTOS task handle
+ * @return the task id or -1 if the handle is not registered
+ */
+extern int32_t PIOS_TASK_MONITOR_GetTaskId(xTaskHandle handle);
+
+/**
+ * Get the handle a task was registered with.
+ * @param task_id The id of the task. Must be in the range [0, max_tasks-1].
+ * @return the FreeRTOS task handle or NULL if the task is not running
+ */
+extern xTaskHandle PIOS_TASK_MONITOR_GetTaskHandle(uint16_t task_id);
+
 /**
  * Information about a running task that has been registered
  * via a call to PIOS_TASK_MONITOR_Add().
@@ -84,6 +98,12 @@ struct pios_task_info {
      *  to PIOS_TASK_MONITOR_ForEachTask(). Low-load tasks may
      *  report 0% load even though they have run during the interval. */
     uint8_t running_time_percentage;
+    /** Longest time in microseconds the task ran without being switched
+     *  out since the last call to PIOS_TASK_MONITOR_ForEachTask(). */
+    uint32_t max_running_time;
+    /** Number of times the task was switched in since the last call
+     *  to PIOS_TASK_MONITOR_ForEachTask(). */
+    uint32_t context_switches;
 };
 
 /**
@@ -7,7 +7,7 @@
  * @{
  * @addtogroup PiOS
  * @{
- * @brief PiOS debug trace printing interface
+ * @brief PiOS debug trace printing interface and binary trace buffer
  *****************************************************************************/
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -27,6 +27,8 @@
 #ifndef PIOS_TRACE_H
 #define PIOS_TRACE_H
 
+#include <stdint.h>
+
 extern unsigned int pios_trace_mask;
 
 /*
@@ -80,5 +82,57 @@ extern unsigned int pios_trace_mask;
 unsigned  pios_set_trace(unsigned tm);
 unsigned  pios_get_trace(void);
 
+/*
+ * Binary trace buffer.
+ * A ring of compact time stamped records, written from tasks and ISRs without
+ * locks and read by a single task. Every category is enabled at run time with
+ * its bit (1 << category) in PIOS_TRACE_SetCategories(). The oldest records
+ * are overwritten when the reader does not keep up.
+ */
+
+/* Categories */
+#define PIOS_TRACE_CATEGORY_TASK     0 /* data: task switched in */
+#define PIOS_TRACE_CATEGORY_ISR      1 /* data: interrupt line */
+#define PIOS_TRACE_CATEGORY_CALLBACK 2 /* data: callback id */
+#define PIOS_TRACE_CATEGORY_UAVOBJ   3 /* data: object id */
+#define PIOS_TRACE_CATEGORY_USER     7 /* data: free */
+
+/* Events */
+#define PIOS_TRACE_INSTANT           0
+#define PIOS_TRACE_BEGIN             1
+#define PIOS_TRACE_END               2
+
+struct pios_trace_record {
+    uint32_t time; /* PIOS_DELAY_GetRaw() when written, PIOS_DELAY_GetuS() once read */
+    uint32_t data;
+    uint16_t sequence; /* low bits of the record number, written last */
+    uint8_t  category;
+    uint8_t  event;
+};
+
+#ifdef PIOS_INCLUDE_TRACE_BUFFER
+
+extern volatile uint32_t pios_trace_categories;
+
+#define PIOS_TRACE_EVENT(category, event, data) \
+    do { \
+        if (pios_trace_categories & (1 << (category))) { \
+            PIOS_TRACE_Record((category), (event), (data)); } \
+    } \
+    while (0)
+
+void PIOS_TRACE_Record(uint8_t category, uint8_t event, uint32_t data);
+void PIOS_TRACE_SetCategories(uint32_t categories);
+uint32_t PIOS_TRACE_GetCategories(void);
+uint16_t PIOS_TRACE_Read(struct pios_trace_record *records, uint16_t max_records);
+void PIOS_TRACE_GetStats(uint32_t *recorded, uint32_t *lost);
+
+/* Called by the FreeRTOS traceTASK_SWITCHED_IN() hook */
+void PIOS_TRACE_TaskSwitchedIn(void *task);
+
+#else
+#define PIOS_TRACE_EVENT(category, event, data)
+#endif /* PIOS_INCLUDE_TRACE_BUFFER */
+
 
 #endif // ifndef PIOS_TRACE_H
@@ -34,6 +34,13 @@
 /* Global Types */
 /* Public Functions */
 
+/**
+ * Number of interrupts serviced for a port since boot, USART and DMA
+ * \param[in] port USART number, 1 for USART1
+ * \return interrupt count, 0 for a port not initialised
+ */
+extern uint32_t PIOS_USART_GetIrqCount(uint8_t port);
+
 #endif /* PIOS_USART_H */
 
 /**
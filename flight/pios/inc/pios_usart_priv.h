@@ -38,6 +38,19 @@
 
 extern const struct pios_com_driver pios_usart_com_driver;
 
+/*
+ * Optional DMA streams of a port, STM32F4 only. Reception runs in circular
+ * mode and is drained on idle line and on half/full buffer, transmission
+ * sends blocks fetched from the COM layer. Both stream IRQs must have the
+ * priority of the USART IRQ, and call PIOS_USART_DMA_IRQHandler().
+ */
+struct pios_usart_dma_cfg {
+    struct stm32_dma_chan rx;
+    struct stm32_irq rx_irq; /* flags: every DMA_IT_* pending bit of the rx stream */
+    struct stm32_dma_chan tx;
+    struct stm32_irq tx_irq; /* flags: every DMA_IT_* pending bit of the tx stream */
+};
+
 struct pios_usart_cfg {
     USART_TypeDef     *regs;
     uint32_t remap; /* GPIO_Remap_* */
@@ -45,10 +58,12 @@ struct pios_usart_cfg {
     struct stm32_gpio rx;
     struct stm32_gpio tx;
     struct stm32_irq  irq;
+    const struct pios_usart_dma_cfg *dma; /* NULL interrupts once per byte */
 };
 
 extern int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg);
 extern const struct pios_usart_cfg *PIOS_USART_GetConfig(uint32_t usart_id);
+extern void PIOS_USART_DMA_IRQHandler(USART_TypeDef *regs);
 
 #endif /* PIOS_USART_PRIV_H */
 
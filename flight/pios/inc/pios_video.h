@@ -57,8 +57,18 @@ typedef struct {
 
 extern TTime timex;
 
+// Cost of the interrupt run at the end of every line, over the last field
+struct pios_video_line_stats {
+    uint32_t max_cycles; // longest line interrupt, in PIOS_DELAY_GetRaw() ticks
+    uint32_t avg_cycles;
+    uint16_t lines; // lines clocked out
+    uint16_t late_frames; // frames not ready in time since boot, the previous one was shown again
+};
+
 extern void PIOS_Video_Init(const struct pios_video_cfg *cfg);
 uint16_t PIOS_Video_GetOSDLines(void);
+void PIOS_Video_SetFrameReady(void);
+void PIOS_Video_GetLineStats(struct pios_video_line_stats *stats);
 extern bool PIOS_Hsync_ISR();
 extern bool PIOS_Vsync_ISR();
 
@@ -38,7 +38,9 @@
 #include <optypes.h>
 #include <pios_ws2811.h>
 
-#define PIOS_WS2811_BUFFER_SIZE        (((PIOS_WS2811_NUMLEDS) * 24))
+// streamCh1 runs in circular mode over two halves, each one holding the 24 bits of a single led
+#define PIOS_WS2811_DMA_HALF_SIZE      24
+#define PIOS_WS2811_DMA_BUFFER_SIZE    (2 * PIOS_WS2811_DMA_HALF_SIZE)
 #define PIOS_WS2811_MEMORYDATASIZE     DMA_MemoryDataSize_HalfWord
 #define PIOS_WS2811_PERIPHERALDATASIZE DMA_PeripheralDataSize_HalfWord
 #define PIOS_WS2811_TIM_PERIOD         20
@@ -50,7 +52,7 @@
 
 #define PIOS_WS2811_DMA_CH1_CONFIG(channel) \
     { \
-        .DMA_BufferSize         = PIOS_WS2811_BUFFER_SIZE, \
+        .DMA_BufferSize         = PIOS_WS2811_DMA_BUFFER_SIZE, \
         .DMA_Channel            = channel, \
         .DMA_DIR = DMA_DIR_MemoryToPeripheral, \
         .DMA_FIFOMode           = DMA_FIFOMode_Enable, \
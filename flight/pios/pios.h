@@ -79,6 +79,7 @@ extern "C" {
 /* #define PIOS_ENABLE_DEBUG_PINS */
 #include <pios_debug.h>
 #include <pios_debuglog.h>
+#include <pios_trace.h>
 
 /* PIOS common functions */
 #include <pios_crc.h>
@@ -266,6 +267,8 @@ extern "C" {
 /* #define FLASH_FREERTOS */
 #include <pios_flash.h>
 #include <pios_flashfs.h>
+/* #define PIOS_INCLUDE_FLASH_STREAMFS */
+#include <pios_streamfs.h>
 #endif
 
 /* driver for storage on internal flash */
@@ -305,7 +308,6 @@ extern "C" {
 /* #define PIOS_INCLUDE_COM_TELEM */
 /* #define PIOS_INCLUDE_COM_FLEXI */
 /* #define PIOS_INCLUDE_COM_AUX */
-/* #define PIOS_TELEM_PRIORITY_QUEUE */
 /* #define PIOS_INCLUDE_GPS */
 /* #define PIOS_GPS_MINIMAL */
 /* #define PIOS_INCLUDE_GPS_NMEA_PARSER */
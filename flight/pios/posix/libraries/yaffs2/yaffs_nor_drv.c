@@ -303,6 +303,12 @@ static int nor_drv_Deinitialise_flash_fn(struct yaffs_dev *dev)
 }
 
 
+/* Save the simulated flash image, see ynorsim_snapshot() */
+int yaffs_nor_snapshot(const char *fname)
+{
+    return nor_sim ? ynorsim_snapshot(nor_sim, fname) : -1;
+}
+
 struct yaffs_dev *yaffs_nor_install_drv(const char *name)
 {
     struct yaffs_dev *dev = malloc(sizeof(struct yaffs_dev));
@@ -19,5 +19,6 @@
 
 struct yaffs_dev;
 struct yaffs_dev *yaffs_nor_install_drv(const char *name);
+int yaffs_nor_snapshot(const char *fname);
 
 #endif
@@ -92,6 +92,10 @@ void yaffsSigHandler(int sig)
         pios_flash_device_count = 0;
         exit(1);
         break;
+    case SIGUSR1:
+        // snapshot of the flash image, restored at start up with YNORSIM_RESTORE
+        yaffs_nor_snapshot(getenv("YNORSIM_SNAPSHOT") ? getenv("YNORSIM_SNAPSHOT") : "emfile-nor.snapshot");
+        break;
     default:
         break;
     }
@@ -126,6 +130,13 @@ static void yaffsSigSetup(
         return;
     }
 
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags   = 0;
+    sa.sa_handler = sighandler;
+    if (sigaction(SIGUSR1, &sa, NULL)) {
+        return;
+    }
+
     sigemptyset(&sa.sa_mask);
     sa.sa_flags   = 0;
     sa.sa_handler = sighandler;
@@ -18,11 +18,20 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <time.h>
+#include <sys/mman.h>
 
 #include "pios_trace.h"
 
 #define YNORSIM_FNAME          "emfile-nor"
 
+/* Environment variables of the simulation:
+ * YNORSIM_IMAGE   name of the flash image file, instead of the name given by the driver
+ * YNORSIM_MMAP    when set the image file is mapped in memory, the writes reach it
+ *                 without waiting for the shutdown and are flushed by the host OS.
+ *                 Programming is a plain AND, without bit flips nor power failures.
+ * YNORSIM_RESTORE snapshot copied to the image at start up, see ynorsim_snapshot()
+ */
+
 /* Set YNORSIM_BIT_CHANGES to a a value from 1..30 to
  * simulate bit flipping as the programming happens.
  * A low value results in faster simulation with less chance of encountering a partially programmed
@@ -57,6 +66,7 @@ struct nor_sim {
     char *fname;
     int  remaining_ops;
     int  nops_so_far;
+    int  mapped;
 };
 
 int ops_multiplier = 500;
@@ -74,6 +84,11 @@ static void ynorsim_save_image(struct nor_sim *sim)
     int h;
 
     pios_trace(PIOS_TRACE_TEST, "ynorsim_save_image");
+    if (sim->mapped) {
+        /* already in the file, only schedule the write back */
+        msync(sim->word, sim->file_size, MS_ASYNC);
+        return;
+    }
     h = open(sim->fname, O_RDWR | O_CREAT | O_TRUNC, S_IREAD | S_IWRITE);
     write(h, sim->word, sim->file_size);
     close(h);
@@ -84,12 +99,61 @@ static void ynorsim_restore_image(struct nor_sim *sim)
     int h;
 
     pios_trace(PIOS_TRACE_TEST, "ynorsim_restore_image");
+    if (sim->mapped) {
+        /* the mapping is the image */
+        return;
+    }
     h = open(sim->fname, O_RDONLY, S_IREAD | S_IWRITE);
     memset(sim->word, 0xFF, sim->file_size);
     read(h, sim->word, sim->file_size);
     close(h);
 }
 
+/* Map the image file, the part of the file which did not exist yet is erased */
+static u32 *ynorsim_map_image(struct nor_sim *sim)
+{
+    struct stat st;
+    void *map;
+    int h;
+
+    pios_trace(PIOS_TRACE_TEST, "ynorsim_map_image");
+    h = open(sim->fname, O_RDWR | O_CREAT, S_IREAD | S_IWRITE);
+    if (h < 0 || fstat(h, &st) < 0) {
+        if (h >= 0) {
+            close(h);
+        }
+        return NULL;
+    }
+    if (st.st_size < sim->file_size && ftruncate(h, sim->file_size) < 0) {
+        close(h);
+        return NULL;
+    }
+    map = mmap(NULL, sim->file_size, PROT_READ | PROT_WRITE, MAP_SHARED, h, 0);
+    close(h);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    if (st.st_size < sim->file_size) {
+        memset((u8 *)map + st.st_size, 0xFF, sim->file_size - st.st_size);
+    }
+    return map;
+}
+
+/* Copy a whole image from one file to another */
+static int ynorsim_copy_image(struct nor_sim *sim, const u8 *from, const char *fname)
+{
+    int h;
+    int n;
+
+    h = open(fname, O_WRONLY | O_CREAT | O_TRUNC, S_IREAD | S_IWRITE);
+    if (h < 0) {
+        return -1;
+    }
+    n = write(h, from, sim->file_size);
+    close(h);
+    return n == sim->file_size ? 0 : -1;
+}
+
 static void ynorsim_power_fail(struct nor_sim *sim)
 {
     ynorsim_save_image(sim);
@@ -146,6 +210,11 @@ void ynorsim_wr_one_word32(struct nor_sim *sim, u32 *addr, u32 val)
         NorError(sim);
     }
 
+    if (sim->mapped) {
+        *addr = tmp & val;
+        return;
+    }
+
     for (i = 0; i < YNORSIM_BIT_CHANGES; i++) {
         m = 1 << (rand() & 31);
         if (!(m & val)) {
@@ -190,17 +259,50 @@ struct nor_sim *ynorsim_initialise(char *name, int n_blocks,
     sim->n_blocks  = n_blocks;
     sim->block_size_bytes = block_size_bytes;
     sim->file_size = n_blocks * block_size_bytes;
-    sim->word = malloc(sim->file_size);
-    sim->fname     = strdup(name);
+    sim->fname     = strdup(getenv("YNORSIM_IMAGE") ? getenv("YNORSIM_IMAGE") : name);
+
+    if (getenv("YNORSIM_MMAP")) {
+        sim->word   = ynorsim_map_image(sim);
+        sim->mapped = sim->word != NULL;
+    }
+    if (!sim->word) {
+        sim->word = malloc(sim->file_size);
+    }
 
     if (!sim->word) {
         return NULL;
     }
 
     ynorsim_ready(sim);
+
+    if (getenv("YNORSIM_RESTORE") && ynorsim_restore(sim, getenv("YNORSIM_RESTORE")) < 0) {
+        printf("Could not restore the flash snapshot %s\n", getenv("YNORSIM_RESTORE"));
+    }
     return sim;
 }
 
+int ynorsim_snapshot(struct nor_sim *sim, const char *fname)
+{
+    pios_trace(PIOS_TRACE_TEST, "ynorsim_snapshot %s", fname);
+    return ynorsim_copy_image(sim, (const u8 *)sim->word, fname);
+}
+
+int ynorsim_restore(struct nor_sim *sim, const char *fname)
+{
+    int h;
+    int n;
+
+    pios_trace(PIOS_TRACE_TEST, "ynorsim_restore %s", fname);
+    h = open(fname, O_RDONLY);
+    if (h < 0) {
+        return -1;
+    }
+    memset(sim->word, 0xFF, sim->file_size);
+    n = read(h, sim->word, sim->file_size);
+    close(h);
+    return n < 0 ? -1 : 0;
+}
+
 void ynorsim_shutdown(struct nor_sim *sim)
 {
     ynorsim_save_image(sim);
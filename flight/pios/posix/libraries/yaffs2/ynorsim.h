@@ -27,4 +27,9 @@ void ynorsim_shutdown(struct nor_sim *sim);
 struct nor_sim *ynorsim_initialise(char *name, int n_blocks, int block_size_bytes);
 u32 *ynorsim_get_base(struct nor_sim *sim);
 
+/* Save the whole flash image to a file, or load it back. To be used while the
+ * file system is idle, for example between two test runs. */
+int ynorsim_snapshot(struct nor_sim *sim, const char *fname);
+int ynorsim_restore(struct nor_sim *sim, const char *fname);
+
 #endif
@@ -40,6 +40,15 @@
  * \return < 0 if initialisation failed
  */
 #include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+/* lock step: the time stands still except for the ticks granted by the external clock */
+static bool lockstep;
+static volatile uint32_t lockstep_us;
+static uint32_t lockstep_granted;
+static int lockstep_socket;
+static struct sockaddr_in lockstep_engine;
 
 int32_t PIOS_DELAY_Init(void)
 {
@@ -49,6 +58,56 @@ int32_t PIOS_DELAY_Init(void)
     return 0;
 }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Called by the scheduler before each tick, returns once the tick is granted.
+ * When the ticks of a request are used up the time reached is sent back, the
+ * tasks woken by the ticks have all run by then.
+ */
+static void PIOS_DELAY_LockStepTick(void)
+{
+    while (lockstep_granted == 0) {
+        if (lockstep_engine.sin_port) {
+            uint32_t now = lockstep_us;
+            sendto(lockstep_socket, &now, sizeof(now), 0, (struct sockaddr *)&lockstep_engine, sizeof(lockstep_engine));
+        }
+        uint32_t ticks;
+        socklen_t len = sizeof(lockstep_engine);
+        if (recvfrom(lockstep_socket, &ticks, sizeof(ticks), 0, (struct sockaddr *)&lockstep_engine, &len) == sizeof(ticks)) {
+            lockstep_granted = ticks;
+        }
+    }
+    lockstep_granted--;
+    lockstep_us += portTICK_RATE_MICROSECONDS;
+}
+
+/**
+ * Runs the scheduler in lock step with an external clock on the UDP port given.
+ * Each datagram holds the number of ticks to advance as an uint32 in host byte
+ * order, the reply holds the simulated time in uS once they are done.
+ * Has to be called before the scheduler is started.
+ * \return < 0 if the port could not be opened
+ */
+int32_t PIOS_DELAY_InitLockStep(uint16_t port)
+{
+    struct sockaddr_in server;
+
+    lockstep_socket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_ANY);
+    server.sin_port = htons(port);
+    if (lockstep_socket < 0 || bind(lockstep_socket, (struct sockaddr *)&server, sizeof(server)) < 0) {
+        return -1;
+    }
+
+    lockstep = true;
+    vPortSetLockStepTickSource(PIOS_DELAY_LockStepTick);
+
+    return 0;
+}
+#endif /* PIOS_INCLUDE_FREERTOS */
+
 /**
  * Waits for a specific number of uS<BR>
  * Example:<BR>
@@ -63,6 +122,10 @@ int32_t PIOS_DELAY_WaituS(uint32_t uS)
 {
     static struct timespec wait, rest;
 
+    if (lockstep) {
+        return 0;
+    }
+
     wait.tv_sec  = 0;
     wait.tv_nsec = 1000 * uS;
     while (nanosleep(&wait, &rest) != 0) {
@@ -90,6 +153,10 @@ int32_t PIOS_DELAY_WaitmS(uint32_t mS)
     // PIOS_DELAY_WaituS(1000);
     static struct timespec wait, rest;
 
+    if (lockstep) {
+        return 0;
+    }
+
     wait.tv_sec  = mS / 1000;
     wait.tv_nsec = (mS % 1000) * 1000000;
     while (nanosleep(&wait, &rest) != 0) {
@@ -109,6 +176,10 @@ uint32_t PIOS_DELAY_GetuS()
 {
     static struct timespec current;
 
+    if (lockstep) {
+        return lockstep_us;
+    }
+
     clock_gettime(CLOCK_REALTIME, &current);
     return (current.tv_sec * 1000000) + (current.tv_nsec / 1000);
 }
@@ -125,6 +125,62 @@ int32_t PIOS_RCVR_Read(uint32_t rcvr_id, uint8_t channel)
     return rcvr_dev->driver->read(rcvr_dev->lower_id, channel);
 }
 
+/**
+ * @brief Get a semaphore that signals when a new sample is available.
+ * @param[in] rcvr_id driver to read from
+ * @param[in] channel channel to read
+ * @returns The semaphore, or NULL if not supported.
+ */
+xSemaphoreHandle PIOS_RCVR_GetSemaphore(uint32_t rcvr_id, uint8_t channel)
+{
+    // Publicly facing API uses channel 1 for first channel
+    if (channel == 0) {
+        return NULL;
+    } else {
+        channel--;
+    }
+
+    if (rcvr_id == 0) {
+        return NULL;
+    }
+
+    struct pios_rcvr_dev *rcvr_dev = PIOS_RCVR_find_dev(rcvr_id);
+
+    if (!PIOS_RCVR_validate(rcvr_dev)) {
+        /* Undefined RCVR port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+
+    if (rcvr_dev->driver->get_semaphore) {
+        return rcvr_dev->driver->get_semaphore(rcvr_dev->lower_id, channel);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get the time the driver decoded its last complete frame.
+ * @param[in] rcvr_id driver to query
+ * @returns PIOS_DELAY raw timestamp of the frame, or 0 if not supported.
+ */
+uint32_t PIOS_RCVR_GetFrameTime(uint32_t rcvr_id)
+{
+    if (rcvr_id == 0) {
+        return 0;
+    }
+
+    struct pios_rcvr_dev *rcvr_dev = PIOS_RCVR_find_dev(rcvr_id);
+
+    if (!PIOS_RCVR_validate(rcvr_dev)) {
+        /* Undefined RCVR port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+
+    if (rcvr_dev->driver->get_frame_time) {
+        return rcvr_dev->driver->get_frame_time(rcvr_dev->lower_id);
+    }
+    return 0;
+}
+
 #endif /* if defined(PIOS_INCLUDE_RCVR) */
 
 /**
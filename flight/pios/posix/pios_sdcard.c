@@ -286,6 +286,31 @@ int32_t PIOS_SDCARD_FileCopy(char *Source, char *Destination)
     return -2;
 }
 
+/**
+ * Reads consecutive sectors, see PIOS_SDCARD_SectorRead()
+ */
+int32_t PIOS_SDCARD_SectorsRead(uint32_t sector, uint8_t *buffer, uint32_t count)
+{
+    return -256;
+}
+
+/**
+ * Writes consecutive sectors, see PIOS_SDCARD_SectorWrite()
+ */
+int32_t PIOS_SDCARD_SectorsWrite(uint32_t sector, uint8_t *buffer, uint32_t count)
+{
+    return -256;
+}
+
+/**
+ * Creates a file of contiguous clusters
+ * return -2 Failed to create the file
+ */
+int32_t PIOS_SDCARD_FileAllocate(char *Filename, uint32_t len, uint32_t *first_sector)
+{
+    return -2;
+}
+
 /**
  * Delete a file
  * param[in] *Filename File to delete
@@ -1022,6 +1022,7 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     i2c_adapter->transfer_timeout_ticks <<= 3;
 
     i2c_adapter->bus_error = false;
+    i2c_adapter->transfer_start = PIOS_DELAY_GetRaw();
     i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
 
     /* Wait for the transfer to complete */
@@ -1053,6 +1054,18 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
         i2c_adapter_fsm_init(i2c_adapter);
     }
 
+    int32_t result = !semaphore_success ? -2 :
+                     i2c_adapter->bus_error ? -1 :
+                     0;
+
+    i2c_adapter->stats.transfers++;
+    i2c_adapter->stats.busy_us += PIOS_DELAY_DiffuS(i2c_adapter->transfer_start);
+    if (result == -2) {
+        i2c_adapter->stats.timeouts++;
+    } else if (result == -1) {
+        i2c_adapter->stats.errors++;
+    }
+
 #ifdef USE_FREERTOS
     /* Unlock the bus */
     xSemaphoreGive(i2c_adapter->sem_busy);
@@ -1061,9 +1074,44 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     }
 #endif /* USE_FREERTOS */
 
-    return !semaphore_success ? -2 :
-           i2c_adapter->bus_error ? -1 :
-           0;
+    return result;
+}
+
+/**
+ * @brief Perform a series of I2C transactions and report the result to a callback.
+ * There is no transfer queue on this target, the transfer is done before returning.
+ * @returns 0 once the callback was invoked, -1 for an invalid adapter
+ */
+int32_t PIOS_I2C_TransferAsync(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, pios_i2c_callback callback, void *context)
+{
+    struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
+
+    if (!PIOS_I2C_validate(i2c_adapter)) {
+        return -1;
+    }
+
+    PIOS_Assert(callback);
+
+    callback(PIOS_I2C_Transfer(i2c_id, txn_list, num_txns), context);
+
+    return 0;
+}
+
+/**
+ * @brief Get the statistics of a bus
+ * @param[in] bus the bus number, in the order the adapters were initialised
+ * @param[out] stats the counters
+ * @returns 0 on success, -1 if there is no such bus
+ */
+int32_t PIOS_I2C_GetBusStats(uint8_t bus, struct pios_i2c_bus_stats *stats)
+{
+    if (bus >= pios_i2c_num_adapters) {
+        return -1;
+    }
+
+    *stats = pios_i2c_adapters[bus].stats;
+
+    return 0;
 }
 
 
@@ -95,6 +95,9 @@ int32_t PIOS_SPI_Init(uint32_t *spi_id, const struct pios_spi_cfg *cfg)
     /* Disable callback function */
     spi_dev->callback = NULL;
 
+    memset(&spi_dev->stats, 0, sizeof(spi_dev->stats));
+    memset(spi_dev->slave_stats, 0, sizeof(spi_dev->slave_stats));
+
     /* Set rx/tx dummy bytes to a known value */
     spi_dev->rx_dummy_byte = 0xFF;
     spi_dev->tx_dummy_byte = 0xFF;
@@ -247,11 +250,13 @@ int32_t PIOS_SPI_ClaimBus(uint32_t spi_id)
     bool valid = PIOS_SPI_validate(spi_dev);
     PIOS_Assert(valid)
 
+    uint32_t start = PIOS_DELAY_GetRaw();
     if (xSemaphoreTake(spi_dev->busy, 0xffff) != pdTRUE) {
         return -1;
     }
 #else
     struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+    uint32_t start   = PIOS_DELAY_GetRaw();
     uint32_t timeout = 0xffff;
     while ((PIOS_SPI_Busy(spi_id) || spi_dev->busy) && --timeout) {
         ;
@@ -262,11 +267,19 @@ int32_t PIOS_SPI_ClaimBus(uint32_t spi_id)
 
     PIOS_IRQ_Disable();
     if (spi_dev->busy) {
+        PIOS_IRQ_Enable();
         return -1;
     }
     spi_dev->busy = 1;
     PIOS_IRQ_Enable();
 #endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
+    uint32_t wait = PIOS_DELAY_DiffuS(start);
+    spi_dev->stats.claims++;
+    spi_dev->stats.claim_wait_us += wait;
+    if (wait > spi_dev->stats.claim_wait_max_us) {
+        spi_dev->stats.claim_wait_max_us = wait;
+    }
     return 0;
 }
 
@@ -618,6 +631,60 @@ void PIOS_SPI_SetPrescalar(uint32_t spi_id, uint32_t prescaler)
     spi_dev->cfg->regs->CR1 = (spi_dev->cfg->regs->CR1 & ~0x0038) | prescaler;
 }
 
+/**
+ * There is no request queue on F1, asynchronous requests are refused and
+ * the callers keep to their blocking transfers.
+ * \return -2 as for a full queue
+ */
+int32_t PIOS_SPI_TransferAsync(__attribute__((unused)) uint32_t spi_id, __attribute__((unused)) const struct pios_spi_txn txn_list[],
+                               __attribute__((unused)) uint32_t num_txns, __attribute__((unused)) SPIPrescalerTypeDef spi_prescaler,
+                               __attribute__((unused)) enum pios_spi_priority priority, __attribute__((unused)) pios_spi_callback callback,
+                               __attribute__((unused)) void *context)
+{
+    return -2;
+}
+
+/**
+ * Get the statistics of the bus claims
+ * \param[in] spi_id SPI device handle
+ * \param[out] stats counters since the bus was initialised
+ * \return 0 if no error
+ */
+int32_t PIOS_SPI_GetBusStats(uint32_t spi_id, struct pios_spi_bus_stats *stats)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    PIOS_IRQ_Disable();
+    *stats = spi_dev->stats;
+    PIOS_IRQ_Enable();
+    return 0;
+}
+
+/**
+ * Get the statistics of the asynchronous requests of a slave, always empty on F1
+ * \return 0 if no error
+ * \return -1 if the slave isn't tracked
+ */
+int32_t PIOS_SPI_GetSlaveStats(uint32_t spi_id, uint32_t slave_id, struct pios_spi_slave_stats *stats)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    if (slave_id >= PIOS_SPI_STATS_SLAVES) {
+        return -1;
+    }
+
+    *stats = spi_dev->slave_stats[slave_id];
+    return 0;
+}
+
 void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
 {
     struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
@@ -63,6 +63,7 @@ struct pios_usart_dev {
     uint32_t tx_out_context;
 
     uint32_t rx_dropped;
+    volatile uint32_t irq_count;
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev *usart_dev)
@@ -203,6 +204,24 @@ out_fail:
     return -1;
 }
 
+uint32_t PIOS_USART_GetIrqCount(uint8_t port)
+{
+    struct pios_usart_dev *usart_dev = NULL;
+
+    switch (port) {
+    case 1:
+        usart_dev = (struct pios_usart_dev *)PIOS_USART_1_id;
+        break;
+    case 2:
+        usart_dev = (struct pios_usart_dev *)PIOS_USART_2_id;
+        break;
+    case 3:
+        usart_dev = (struct pios_usart_dev *)PIOS_USART_3_id;
+        break;
+    }
+    return usart_dev ? usart_dev->irq_count : 0;
+}
+
 static void PIOS_USART_RxStart(uint32_t usart_id, __attribute__((unused)) uint16_t rx_bytes_avail)
 {
     struct pios_usart_dev *usart_dev = (struct pios_usart_dev *)usart_id;
@@ -289,6 +308,8 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 
     PIOS_Assert(valid);
 
+    usart_dev->irq_count++;
+
     /* Force read of dr after sr to make sure to clear error flags */
     volatile uint16_t sr = usart_dev->cfg->regs->SR;
     volatile uint8_t dr  = usart_dev->cfg->regs->DR;
@@ -46,10 +46,18 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
                                       uint16_t *headroom,
                                       bool *need_yield);
 static void PIOS_DSM_Supervisor(uint32_t dsm_id);
+#if defined(PIOS_INCLUDE_FREERTOS)
+static xSemaphoreHandle PIOS_DSM_Get_Semaphore(uint32_t rcvr_id, uint8_t channel);
+#endif
+static uint32_t PIOS_DSM_Get_Frame_Time(uint32_t rcvr_id);
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_dsm_rcvr_driver = {
-    .read = PIOS_DSM_Get,
+    .read           = PIOS_DSM_Get,
+#if defined(PIOS_INCLUDE_FREERTOS)
+    .get_semaphore  = PIOS_DSM_Get_Semaphore,
+#endif
+    .get_frame_time = PIOS_DSM_Get_Frame_Time,
 };
 
 enum pios_dsm_dev_magic {
@@ -73,6 +81,10 @@ struct pios_dsm_dev {
     enum pios_dsm_dev_magic   magic;
     const struct pios_dsm_cfg *cfg;
     struct pios_dsm_state     state;
+    uint32_t                  frame_time;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreHandle          new_frame_semaphore;
+#endif
 };
 
 /* Allocate DSM device descriptor */
@@ -253,10 +265,14 @@ stream_error:
     return -1;
 }
 
-/* Update decoder state processing input byte from the DSMx stream */
-static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
+/**
+ * Update decoder state processing input byte from the DSMx stream
+ * \return true if the byte completed a frame which updated the channels
+ */
+static bool PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
 {
     struct pios_dsm_state *state = &(dsm_dev->state);
+    bool updated = false;
 
     if (state->frame_found) {
         /* receiving the data frame */
@@ -268,6 +284,7 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
                 if (!PIOS_DSM_UnrollChannels(dsm_dev)) {
                     /* data looking good */
                     state->failsafe_timer = 0;
+                    updated = true;
                 }
 
                 /* prepare for the next frame */
@@ -275,6 +292,8 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
             }
         }
     }
+
+    return updated;
 }
 
 /* Initialise DSM receiver interface */
@@ -296,7 +315,11 @@ int32_t PIOS_DSM_Init(uint32_t *dsm_id,
     }
 
     /* Bind the configuration to the device instance */
-    dsm_dev->cfg = cfg;
+    dsm_dev->cfg        = cfg;
+    dsm_dev->frame_time = 0;
+#if defined(PIOS_INCLUDE_FREERTOS)
+    dsm_dev->new_frame_semaphore = NULL;
+#endif
 
     /* Bind the receiver if requested */
     if (bind) {
@@ -330,9 +353,11 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
 
     PIOS_Assert(valid);
 
+    bool frame_complete = false;
+
     /* process byte(s) and clear receive timer */
     for (uint8_t i = 0; i < buf_len; i++) {
-        PIOS_DSM_UpdateState(dsm_dev, buf[i]);
+        frame_complete |= PIOS_DSM_UpdateState(dsm_dev, buf[i]);
         dsm_dev->state.receive_timer = 0;
     }
 
@@ -341,9 +366,20 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
         *headroom = DSM_FRAME_LENGTH;
     }
 
-    /* We never need a yield */
     *need_yield = false;
 
+    if (frame_complete) {
+        dsm_dev->frame_time = PIOS_DELAY_GetRaw();
+#if defined(PIOS_INCLUDE_FREERTOS)
+        /* Wake up the receiver task as soon as the frame is decoded */
+        if (dsm_dev->new_frame_semaphore != NULL) {
+            signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+            xSemaphoreGiveFromISR(dsm_dev->new_frame_semaphore, &xHigherPriorityTaskWoken);
+            *need_yield = (xHigherPriorityTaskWoken == pdTRUE);
+        }
+#endif
+    }
+
     /* Always indicate that all bytes were consumed */
     return buf_len;
 }
@@ -372,6 +408,38 @@ static int32_t PIOS_DSM_Get(uint32_t rcvr_id, uint8_t channel)
     return dsm_dev->state.channel_data[channel];
 }
 
+#if defined(PIOS_INCLUDE_FREERTOS)
+/**
+ * Get the semaphore given on each complete frame. A frame updates
+ * several channels at once so the channel is ignored.
+ */
+static xSemaphoreHandle PIOS_DSM_Get_Semaphore(uint32_t rcvr_id, __attribute__((unused)) uint8_t channel)
+{
+    struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)rcvr_id;
+
+    if (!PIOS_DSM_Validate(dsm_dev)) {
+        return NULL;
+    }
+
+    if (dsm_dev->new_frame_semaphore == NULL) {
+        vSemaphoreCreateBinary(dsm_dev->new_frame_semaphore);
+    }
+    return dsm_dev->new_frame_semaphore;
+}
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+/* Raw PIOS_DELAY time of the last complete frame */
+static uint32_t PIOS_DSM_Get_Frame_Time(uint32_t rcvr_id)
+{
+    struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)rcvr_id;
+
+    if (!PIOS_DSM_Validate(dsm_dev)) {
+        return 0;
+    }
+
+    return dsm_dev->frame_time;
+}
+
 /**
  * Input data supervisor is called periodically and provides
  * two functions: frame syncing and failsafe triggering.
@@ -197,7 +197,10 @@ static bool PIOS_EXTI_generic_irq_handler(uint8_t line_index)
     }
 
     struct pios_exti_cfg *cfg = &__start__exti + cfg_index;
-    return cfg->vector();
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_ISR, PIOS_TRACE_BEGIN, line_index);
+    bool woken = cfg->vector();
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_ISR, PIOS_TRACE_END, line_index);
+    return woken;
 }
 
 /* Bind Interrupt Handlers */
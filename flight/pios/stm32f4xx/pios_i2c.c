@@ -159,7 +159,12 @@ static bool i2c_adapter_wait_for_stopped(struct pios_i2c_adapter *i2c_adapter);
 static void i2c_adapter_reset_bus(struct pios_i2c_adapter *i2c_adapter);
 
 static void i2c_adapter_log_fault(enum pios_i2c_error_type type);
-static bool i2c_adapter_callback_handler(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_start_transfer(struct pios_i2c_adapter *i2c_adapter, const struct pios_i2c_txn txn_list[], uint32_t num_txns);
+static void i2c_adapter_account_transfer(struct pios_i2c_adapter *i2c_adapter, int32_t result);
+static void i2c_adapter_async_start_next(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_async_complete(struct pios_i2c_adapter *i2c_adapter, int32_t result);
+static void i2c_adapter_async_poll(struct pios_i2c_adapter *i2c_adapter);
+static void i2c_adapter_async_check_timeout(struct pios_i2c_adapter *i2c_adapter);
 
 static const struct i2c_adapter_transition i2c_adapter_transitions[I2C_STATE_NUM_STATES] = {
     [I2C_STATE_FSM_FAULT] =             {
@@ -417,6 +422,11 @@ static void go_stopping(struct pios_i2c_adapter *i2c_adapter)
 
     I2C_ITConfig(i2c_adapter->cfg->regs, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
 
+    /* Asynchronous transfers are completed by i2c_adapter_async_poll() once out of the FSM */
+    if (i2c_adapter->async_active) {
+        return;
+    }
+
 #ifdef USE_FREERTOS
     if (xSemaphoreGiveFromISR(i2c_adapter->sem_ready, &pxHigherPriorityTaskWoken) != pdTRUE) {
 #if defined(I2C_HALT_ON_ERRORS)
@@ -425,10 +435,6 @@ static void go_stopping(struct pios_i2c_adapter *i2c_adapter)
     }
     portEND_SWITCHING_ISR(pxHigherPriorityTaskWoken); /* FIXME: is this the right place for this? */
 #endif /* USE_FREERTOS */
-
-    if (i2c_adapter->callback) {
-        i2c_adapter_callback_handler(i2c_adapter);
-    }
 }
 
 static void go_stopped(struct pios_i2c_adapter *i2c_adapter)
@@ -816,58 +822,139 @@ static bool i2c_adapter_fsm_terminated(struct pios_i2c_adapter *i2c_adapter)
     }
 }
 
-uint32_t i2c_cb_count = 0;
-static bool i2c_adapter_callback_handler(struct pios_i2c_adapter *i2c_adapter)
+/* Start a transfer on a bus owned by the caller */
+static void i2c_adapter_start_transfer(struct pios_i2c_adapter *i2c_adapter, const struct pios_i2c_txn txn_list[], uint32_t num_txns)
 {
-    bool semaphore_success = true;
+    PIOS_DEBUG_Assert(i2c_adapter->curr_state == I2C_STATE_STOPPED);
 
-    /* Wait for the transfer to complete */
-#ifdef USE_FREERTOS
-    portTickType timeout;
-    timeout = i2c_adapter->cfg->transfer_timeout_ms / portTICK_RATE_MS;
-    semaphore_success &= (xSemaphoreTake(i2c_adapter->sem_ready, timeout) == pdTRUE);
-    xSemaphoreGive(i2c_adapter->sem_ready);
-#endif /* USE_FREERTOS */
+    i2c_adapter->first_txn  = &txn_list[0];
+    i2c_adapter->last_txn   = &txn_list[num_txns - 1];
+    i2c_adapter->active_txn = i2c_adapter->first_txn;
 
-    /* transfer_timeout_ticks is set by PIOS_I2C_Transfer_Callback */
-    /* Spin waiting for the transfer to finish */
-    while (!i2c_adapter_fsm_terminated(i2c_adapter)) {
-        // sleep 1 byte, as FSM can't be faster
-        // FIXME: clock stretching could make problems, but citing NPX: alsmost no slave device implements clock stretching
-        // three times the expected time should cover clock delay
-        PIOS_DELAY_WaituS(i2c_adapter->transfer_delay_uS);
+    // Estimate bytes of transmission. Per txns: 1 adress byte + length
+    i2c_adapter->transfer_timeout_ticks = num_txns;
+    for (uint32_t i = 0; i < num_txns; i++) {
+        i2c_adapter->transfer_timeout_ticks += txn_list[i].len;
+    }
+    // timeout if it takes eight times the expected time
+    i2c_adapter->transfer_timeout_ticks <<= 3;
 
-        i2c_adapter->transfer_timeout_ticks--;
-        if (i2c_adapter->transfer_timeout_ticks == 0) {
-            break;
-        }
+    i2c_adapter->bus_error      = false;
+    i2c_adapter->nack           = false;
+    i2c_adapter->transfer_start = PIOS_DELAY_GetRaw();
+    i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
+}
+
+/* Update the bus statistics with a finished transfer */
+static void i2c_adapter_account_transfer(struct pios_i2c_adapter *i2c_adapter, int32_t result)
+{
+    i2c_adapter->stats.transfers++;
+    i2c_adapter->stats.busy_us += PIOS_DELAY_DiffuS(i2c_adapter->transfer_start);
+    switch (result) {
+    case 0:
+        break;
+    case -2:
+        i2c_adapter->stats.timeouts++;
+        break;
+    case -3:
+        i2c_adapter->stats.nacks++;
+        break;
+    default:
+        i2c_adapter->stats.errors++;
+        break;
     }
+}
 
-    if (i2c_adapter_wait_for_stopped(i2c_adapter)) {
-        i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_STOPPED);
-    } else {
-        i2c_adapter_fsm_init(i2c_adapter);
+/* Start the next queued asynchronous request if the bus is free, a waiting blocking transfer goes first */
+static void i2c_adapter_async_start_next(struct pios_i2c_adapter *i2c_adapter)
+{
+    PIOS_IRQ_Disable();
+    if (!i2c_adapter->bus_active && !i2c_adapter->sync_waiting && i2c_adapter->async_count > 0) {
+        struct pios_i2c_async_req *req = &i2c_adapter->async_queue[i2c_adapter->async_head];
+        i2c_adapter->bus_active   = true;
+        i2c_adapter->async_active = true;
+        i2c_adapter_start_transfer(i2c_adapter, req->txn_list, req->num_txns);
     }
+    PIOS_IRQ_Enable();
+}
+
+/*
+ * Finish the asynchronous transfer in progress and hand the bus on, async_active is already cleared.
+ * The callback runs in the context completing the transfer, usually the I2C interrupt.
+ */
+static void i2c_adapter_async_complete(struct pios_i2c_adapter *i2c_adapter, int32_t result)
+{
+    struct pios_i2c_async_req req;
+
+    PIOS_IRQ_Disable();
+    req = i2c_adapter->async_queue[i2c_adapter->async_head];
+    i2c_adapter->async_head   = (i2c_adapter->async_head + 1) % PIOS_I2C_ASYNC_QUEUE_LEN;
+    i2c_adapter->async_count--;
+    i2c_adapter_account_transfer(i2c_adapter, result);
+    PIOS_IRQ_Enable();
 
-    // Execute user supplied function
-    i2c_adapter->callback();
+    // the bus is still held, a request queued by the callback is started below
+    req.callback(result, req.context);
 
-    i2c_cb_count++;
+    PIOS_IRQ_Disable();
+    i2c_adapter->bus_active = false;
+    bool wake_sync = i2c_adapter->sync_waiting;
+    PIOS_IRQ_Enable();
 
+    if (wake_sync) {
 #ifdef USE_FREERTOS
-    /* Unlock the bus */
-    xSemaphoreGive(i2c_adapter->sem_busy);
-    if (!semaphore_success) {
-        i2c_timeout_counter++;
+        if (__get_IPSR()) {
+            signed portBASE_TYPE pxHigherPriorityTaskWoken = pdFALSE;
+            xSemaphoreGiveFromISR(i2c_adapter->sem_idle, &pxHigherPriorityTaskWoken);
+            portEND_SWITCHING_ISR(pxHigherPriorityTaskWoken);
+        } else {
+            xSemaphoreGive(i2c_adapter->sem_idle);
+        }
+#endif /* USE_FREERTOS */
+    } else {
+        i2c_adapter_async_start_next(i2c_adapter);
     }
-#else
+}
+
+/* Complete the asynchronous transfer in progress once the FSM reached its end */
+static void i2c_adapter_async_poll(struct pios_i2c_adapter *i2c_adapter)
+{
+    int32_t result = 0;
+
     PIOS_IRQ_Disable();
-    i2c_adapter->busy = 0;
+    bool done = i2c_adapter->async_active && i2c_adapter->curr_state == I2C_STATE_STOPPING;
+    if (done) {
+        if (i2c_adapter_wait_for_stopped(i2c_adapter)) {
+            i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_STOPPED);
+        } else {
+            i2c_adapter_fsm_init(i2c_adapter);
+        }
+        result = i2c_adapter->bus_error ? -1 : i2c_adapter->nack ? -3 : 0;
+        i2c_adapter->async_active = false;
+    }
     PIOS_IRQ_Enable();
-#endif /* USE_FREERTOS */
 
+    if (done) {
+        i2c_adapter_async_complete(i2c_adapter, result);
+    }
+}
 
-    return (!i2c_adapter->bus_error) && semaphore_success;
+/* Abort an asynchronous transfer stuck for longer than the transfer timeout */
+static void i2c_adapter_async_check_timeout(struct pios_i2c_adapter *i2c_adapter)
+{
+    PIOS_IRQ_Disable();
+    bool stuck = i2c_adapter->async_active &&
+                 PIOS_DELAY_DiffuS(i2c_adapter->transfer_start) > i2c_adapter->cfg->transfer_timeout_ms * 1000;
+    if (stuck) {
+        i2c_adapter_fsm_init(i2c_adapter);
+        i2c_adapter->async_active = false;
+        i2c_timeout_counter++;
+    }
+    PIOS_IRQ_Enable();
+
+    if (stuck) {
+        i2c_adapter_async_complete(i2c_adapter, -2);
+    }
 }
 
 /**
@@ -993,6 +1080,9 @@ int32_t PIOS_I2C_Init(uint32_t *i2c_id, const struct pios_i2c_adapter_cfg *cfg)
      */
     vSemaphoreCreateBinary(i2c_adapter->sem_ready);
     i2c_adapter->sem_busy = xSemaphoreCreateMutex();
+    /* Given by asynchronous transfers handing the bus to a blocking one, starts empty */
+    vSemaphoreCreateBinary(i2c_adapter->sem_idle);
+    xSemaphoreTake(i2c_adapter->sem_idle, 0);
 #else
     i2c_adapter->busy     = 0;
 #endif // USE_FREERTOS
@@ -1014,6 +1104,13 @@ out_fail:
     return -1;
 }
 
+/**
+ * @brief Perform a series of I2C transactions, blocking until they are done
+ * @returns 0 if success or error code
+ * @retval -1 for failed transaction
+ * @retval -2 for failure to get semaphore or timeout
+ * @retval -3 for a NACK
+ */
 int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns)
 {
     struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
@@ -1034,39 +1131,37 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
     if (xSemaphoreTake(i2c_adapter->sem_busy, timeout) == pdFALSE) {
         return -2;
     }
+
+    /* Wait for the asynchronous transfer in progress, the queued ones wait for us */
+    PIOS_IRQ_Disable();
+    while (i2c_adapter->bus_active) {
+        i2c_adapter->sync_waiting = true;
+        PIOS_IRQ_Enable();
+        if (xSemaphoreTake(i2c_adapter->sem_idle, timeout) == pdFALSE) {
+            i2c_adapter_async_check_timeout(i2c_adapter);
+        }
+        PIOS_IRQ_Disable();
+    }
+    i2c_adapter->bus_active   = true;
+    i2c_adapter->sync_waiting = false;
+    PIOS_IRQ_Enable();
 #else
     PIOS_IRQ_Disable();
-    if (i2c_adapter->busy) {
+    if (i2c_adapter->busy || i2c_adapter->bus_active) {
         PIOS_IRQ_Enable();
         return -2;
     }
     i2c_adapter->busy = 1;
+    i2c_adapter->bus_active = true;
     PIOS_IRQ_Enable();
 #endif /* USE_FREERTOS */
 
-    PIOS_DEBUG_Assert(i2c_adapter->curr_state == I2C_STATE_STOPPED);
-
-    i2c_adapter->first_txn  = &txn_list[0];
-    i2c_adapter->last_txn   = &txn_list[num_txns - 1];
-    i2c_adapter->active_txn = i2c_adapter->first_txn;
-
 #ifdef USE_FREERTOS
     /* Make sure the done/ready semaphore is consumed before we start */
     semaphore_success &= (xSemaphoreTake(i2c_adapter->sem_ready, timeout) == pdTRUE);
 #endif
 
-    // Estimate bytes of transmission. Per txns: 1 adress byte + length
-    i2c_adapter->transfer_timeout_ticks = num_txns;
-    for (uint32_t i = 0; i < num_txns; i++) {
-        i2c_adapter->transfer_timeout_ticks += txn_list[i].len;
-    }
-    // timeout if it takes eight times the expected time
-    i2c_adapter->transfer_timeout_ticks <<= 3;
-
-    i2c_adapter->callback  = NULL;
-    i2c_adapter->bus_error = false;
-    i2c_adapter->nack = false;
-    i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
+    i2c_adapter_start_transfer(i2c_adapter, txn_list, num_txns);
 
     /* Wait for the transfer to complete */
 #ifdef USE_FREERTOS
@@ -1093,25 +1188,43 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
         i2c_adapter_fsm_init(i2c_adapter);
     }
 
+    int32_t result = !semaphore_success ? -2 :
+                     i2c_adapter->bus_error ? -1 :
+                     i2c_adapter->nack ? -3 :
+                     0;
+
+    PIOS_IRQ_Disable();
+    i2c_adapter_account_transfer(i2c_adapter, result);
+    i2c_adapter->bus_active = false;
+#ifndef USE_FREERTOS
+    i2c_adapter->busy = 0;
+#endif
+    PIOS_IRQ_Enable();
+
+    /* Hand the bus to the asynchronous requests queued meanwhile */
+    i2c_adapter_async_start_next(i2c_adapter);
+
 #ifdef USE_FREERTOS
     /* Unlock the bus */
     xSemaphoreGive(i2c_adapter->sem_busy);
     if (!semaphore_success) {
         i2c_timeout_counter++;
     }
-#else
-    PIOS_IRQ_Disable();
-    i2c_adapter->busy = 0;
-    PIOS_IRQ_Enable();
 #endif /* USE_FREERTOS */
 
-    return !semaphore_success ? -2 :
-           i2c_adapter->bus_error ? -1 :
-           i2c_adapter->nack ? -3 :
-           0;
+    return result;
 }
 
-int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, void *callback)
+/**
+ * @brief Queue a series of I2C transactions and return without waiting for them.
+ * The requests of a bus are served in order, a blocking transfer waits for the one in progress only.
+ * The transaction list and the buffers must stay valid until the callback is invoked. The callback
+ * runs in interrupt context and must not block, it may queue the next transfer.
+ * @returns 0 if queued or error code
+ * @retval -1 for an invalid adapter
+ * @retval -2 if the queue of the bus is full
+ */
+int32_t PIOS_I2C_TransferAsync(uint32_t i2c_id, const struct pios_i2c_txn txn_list[], uint32_t num_txns, pios_i2c_callback callback, void *context)
 {
     struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
@@ -1120,51 +1233,50 @@ int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn tx
     }
 
     PIOS_Assert(callback);
-
     PIOS_DEBUG_Assert(txn_list);
     PIOS_DEBUG_Assert(num_txns);
 
-    bool semaphore_success = true;
+    /* A transfer that never ended would block the queue for good */
+    i2c_adapter_async_check_timeout(i2c_adapter);
 
-#ifdef USE_FREERTOS
-    /* Lock the bus */
-    portTickType timeout;
-    timeout = i2c_adapter->cfg->transfer_timeout_ms / portTICK_RATE_MS;
-    if (xSemaphoreTake(i2c_adapter->sem_busy, timeout) == pdFALSE) {
-        return -2;
-    }
-#else
-    if (i2c_adapter->busy) {
+    PIOS_IRQ_Disable();
+    if (i2c_adapter->async_count >= PIOS_I2C_ASYNC_QUEUE_LEN) {
+        i2c_adapter->stats.queue_full++;
         PIOS_IRQ_Enable();
         return -2;
     }
-#endif /* USE_FREERTOS */
-
-    PIOS_DEBUG_Assert(i2c_adapter->curr_state == I2C_STATE_STOPPED);
+    struct pios_i2c_async_req *req = &i2c_adapter->async_queue[(i2c_adapter->async_head + i2c_adapter->async_count) % PIOS_I2C_ASYNC_QUEUE_LEN];
+    req->txn_list = txn_list;
+    req->num_txns = num_txns;
+    req->callback = callback;
+    req->context  = context;
+    i2c_adapter->async_count++;
+    PIOS_IRQ_Enable();
 
-    i2c_adapter->first_txn  = &txn_list[0];
-    i2c_adapter->last_txn   = &txn_list[num_txns - 1];
-    i2c_adapter->active_txn = i2c_adapter->first_txn;
+    i2c_adapter_async_start_next(i2c_adapter);
+    // the FSM may have failed right away
+    i2c_adapter_async_poll(i2c_adapter);
 
-#ifdef USE_FREERTOS
-    /* Make sure the done/ready semaphore is consumed before we start */
-    semaphore_success &= (xSemaphoreTake(i2c_adapter->sem_ready, timeout) == pdTRUE);
-#endif
+    return 0;
+}
 
-    // used in the i2c_adapter_callback_handler function
-    // Estimate bytes of transmission. Per txns: 1 adress byte + length
-    i2c_adapter->transfer_timeout_ticks = num_txns;
-    for (uint32_t i = 0; i < num_txns; i++) {
-        i2c_adapter->transfer_timeout_ticks += txn_list[i].len;
+/**
+ * @brief Get the statistics of a bus
+ * @param[in] bus the bus number, in the order the adapters were initialised
+ * @param[out] stats the counters
+ * @returns 0 on success, -1 if there is no such bus
+ */
+int32_t PIOS_I2C_GetBusStats(uint8_t bus, struct pios_i2c_bus_stats *stats)
+{
+    if (bus >= pios_i2c_num_adapters) {
+        return -1;
     }
-    // timeout if it takes eight times the expected time
-    i2c_adapter->transfer_timeout_ticks <<= 3;
 
-    i2c_adapter->callback  = callback;
-    i2c_adapter->bus_error = false;
-    i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_START);
+    PIOS_IRQ_Disable();
+    *stats = pios_i2c_adapters[bus].stats;
+    PIOS_IRQ_Enable();
 
-    return !semaphore_success ? -2 : 0;
+    return 0;
 }
 
 void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
@@ -1296,7 +1408,7 @@ void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
     }
 
 skip_event:
-    ;
+    i2c_adapter_async_poll(i2c_adapter);
 }
 
 
@@ -1327,6 +1439,8 @@ void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
         /* Fail hard on any errors for now */
         i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_BUS_ERROR);
     }
+
+    i2c_adapter_async_poll(i2c_adapter);
 }
 
 #endif /* PIOS_INCLUDE_I2C */
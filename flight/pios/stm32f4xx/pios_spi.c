@@ -44,6 +44,10 @@
 
 #define SPI_MAX_BLOCK_PIO 128
 
+static bool SPI_Async_Resume(struct pios_spi_dev *spi_dev);
+static void SPI_Async_StartTxn(struct pios_spi_dev *spi_dev, bool *woken);
+static void SPI_Async_TxnDone(struct pios_spi_dev *spi_dev, int32_t result, bool *woken);
+
 static bool PIOS_SPI_validate(__attribute__((unused)) struct pios_spi_dev *com_dev)
 {
     /* Should check device magic here */
@@ -98,6 +102,12 @@ int32_t PIOS_SPI_Init(uint32_t *spi_id, const struct pios_spi_cfg *cfg)
     /* Disable callback function */
     spi_dev->callback = NULL;
 
+    spi_dev->async_count  = 0;
+    spi_dev->async_txn    = 0;
+    spi_dev->async_active = false;
+    memset(&spi_dev->stats, 0, sizeof(spi_dev->stats));
+    memset(spi_dev->slave_stats, 0, sizeof(spi_dev->slave_stats));
+
     /* Set rx/tx dummy bytes to a known value */
     spi_dev->rx_dummy_byte = 0xFF;
     spi_dev->tx_dummy_byte = 0xFF;
@@ -258,11 +268,13 @@ int32_t PIOS_SPI_ClaimBus(uint32_t spi_id)
     bool valid = PIOS_SPI_validate(spi_dev);
     PIOS_Assert(valid)
 
+    uint32_t start = PIOS_DELAY_GetRaw();
     if (xSemaphoreTake(spi_dev->busy, 0xffff) != pdTRUE) {
         return -1;
     }
 #else
     struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+    uint32_t start   = PIOS_DELAY_GetRaw();
     uint32_t timeout = 0xffff;
     while ((PIOS_SPI_Busy(spi_id) || spi_dev->busy) && --timeout) {
         ;
@@ -273,11 +285,19 @@ int32_t PIOS_SPI_ClaimBus(uint32_t spi_id)
 
     PIOS_IRQ_Disable();
     if (spi_dev->busy) {
+        PIOS_IRQ_Enable();
         return -1;
     }
     spi_dev->busy = 1;
     PIOS_IRQ_Enable();
 #endif /* if defined(PIOS_INCLUDE_FREERTOS) */
+
+    uint32_t wait = PIOS_DELAY_DiffuS(start);
+    spi_dev->stats.claims++;
+    spi_dev->stats.claim_wait_us += wait;
+    if (wait > spi_dev->stats.claim_wait_max_us) {
+        spi_dev->stats.claim_wait_max_us = wait;
+    }
     return 0;
 }
 
@@ -328,12 +348,17 @@ int32_t PIOS_SPI_ReleaseBus(uint32_t spi_id)
     bool valid = PIOS_SPI_validate(spi_dev);
     PIOS_Assert(valid)
 
-    xSemaphoreGive(spi_dev->busy);
+    /* Queued requests get the bus before the tasks waiting for it */
+    if (!SPI_Async_Resume(spi_dev)) {
+        xSemaphoreGive(spi_dev->busy);
+    }
 #else
     struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
-    PIOS_IRQ_Disable();
-    spi_dev->busy = 0;
-    PIOS_IRQ_Enable();
+    if (!SPI_Async_Resume(spi_dev)) {
+        PIOS_IRQ_Disable();
+        spi_dev->busy = 0;
+        PIOS_IRQ_Enable();
+    }
 #endif
     return 0;
 }
@@ -354,6 +379,9 @@ int32_t PIOS_SPI_ReleaseBusISR(uint32_t spi_id, bool *woken)
     bool valid = PIOS_SPI_validate(spi_dev);
     PIOS_Assert(valid)
 
+    if (SPI_Async_Resume(spi_dev)) {
+        return 0;
+    }
     xSemaphoreGiveFromISR(spi_dev->busy, &higherPriorityTaskWoken);
     if (woken) {
         *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
@@ -486,9 +514,11 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
     }
 
     /* Disable the SPI peripheral */
-    /* Initialize the SPI block */
+    /* Initialize the SPI block, at the clock speed last set */
+    SPI_InitTypeDef spi_init = spi_dev->cfg->init;
+    spi_init.SPI_BaudRatePrescaler = spi_dev->cfg->regs->CR1 & SPI_BaudRatePrescaler_256;
     SPI_DeInit(spi_dev->cfg->regs);
-    SPI_Init(spi_dev->cfg->regs, (SPI_InitTypeDef *)&(spi_dev->cfg->init));
+    SPI_Init(spi_dev->cfg->regs, &spi_init);
     SPI_Cmd(spi_dev->cfg->regs, DISABLE);
     /* Configure CRC calculation */
     if (spi_dev->cfg->use_crc) {
@@ -555,8 +585,8 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
 
     DMA_Init(spi_dev->cfg->dma.tx.channel, &(dma_init));
 
-    /* Enable DMA interrupt if callback function active */
-    DMA_ITConfig(spi_dev->cfg->dma.rx.channel, DMA_IT_TC, (callback != NULL) ? ENABLE : DISABLE);
+    /* Enable DMA interrupt if callback function or asynchronous request active */
+    DMA_ITConfig(spi_dev->cfg->dma.rx.channel, DMA_IT_TC, (callback != NULL || spi_dev->async_active) ? ENABLE : DISABLE);
 
     /* Flush out the CRC registers */
     SPI_CalculateCRC(spi_dev->cfg->regs, DISABLE);
@@ -578,7 +608,7 @@ static int32_t SPI_DMA_TransferBlock(uint32_t spi_id, const uint8_t *send_buffer
     /* Reenable the SPI device */
     SPI_Cmd(spi_dev->cfg->regs, ENABLE);
 
-    if (callback) {
+    if (callback || spi_dev->async_active) {
         /* User has requested a callback, don't wait for the transfer to complete. */
         return 0;
     }
@@ -728,6 +758,262 @@ int32_t PIOS_SPI_Busy(uint32_t spi_id)
     return 0;
 }
 
+/*
+ * Asynchronous requests
+ *
+ * The engine owns the bus while async_active is set. It takes the bus when
+ * it is free, or gets it handed over by PIOS_SPI_ReleaseBus() when requests
+ * are queued, so they go before the tasks blocked in PIOS_SPI_ClaimBus().
+ * Requests are served by priority at the end of the request in progress.
+ */
+
+/* Take the bus for the engine if nobody holds it */
+static bool SPI_Async_TryClaim(struct pios_spi_dev *spi_dev)
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (__get_IPSR()) {
+        signed portBASE_TYPE higherPriorityTaskWoken = pdFALSE;
+        return xSemaphoreTakeFromISR(spi_dev->busy, &higherPriorityTaskWoken) == pdTRUE;
+    }
+    return xSemaphoreTake(spi_dev->busy, 0) == pdTRUE;
+
+#else
+    bool claimed;
+    PIOS_IRQ_Disable();
+    claimed = !spi_dev->busy;
+    spi_dev->busy = 1;
+    PIOS_IRQ_Enable();
+    return claimed;
+
+#endif
+}
+
+/* Give the bus back once the queue is empty */
+static void SPI_Async_Release(struct pios_spi_dev *spi_dev, bool *woken)
+{
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (__get_IPSR()) {
+        signed portBASE_TYPE higherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(spi_dev->busy, &higherPriorityTaskWoken);
+        if (woken) {
+            *woken = *woken || (higherPriorityTaskWoken == pdTRUE);
+        }
+    } else {
+        xSemaphoreGive(spi_dev->busy);
+    }
+#else
+    (void)woken;
+    PIOS_IRQ_Disable();
+    spi_dev->busy = 0;
+    PIOS_IRQ_Enable();
+#endif
+}
+
+/* Called by the bus holder on release, hands the bus to the engine if requests wait */
+static bool SPI_Async_Resume(struct pios_spi_dev *spi_dev)
+{
+    PIOS_IRQ_Disable();
+    bool start = spi_dev->async_count > 0 && !spi_dev->async_active;
+    if (start) {
+        spi_dev->async_active   = true;
+        spi_dev->async_txn      = 0;
+        spi_dev->async_saved_br = spi_dev->cfg->regs->CR1 & SPI_BaudRatePrescaler_256;
+    }
+    PIOS_IRQ_Enable();
+
+    if (start) {
+        SPI_Async_StartTxn(spi_dev, NULL);
+    }
+    return start;
+}
+
+/* Start the current transfer of the request at the head of the queue */
+static void SPI_Async_StartTxn(struct pios_spi_dev *spi_dev, bool *woken)
+{
+    struct pios_spi_async_req *req = &spi_dev->async_queue[0];
+    const struct pios_spi_txn *txn = &req->txn_list[spi_dev->async_txn];
+
+    if (spi_dev->async_txn == 0) {
+        uint32_t wait = PIOS_DELAY_DiffuS(req->queued);
+        if (txn->slave_id < PIOS_SPI_STATS_SLAVES) {
+            struct pios_spi_slave_stats *stats = &spi_dev->slave_stats[txn->slave_id];
+            stats->requests++;
+            stats->wait_us += wait;
+            if (wait > stats->wait_max_us) {
+                stats->wait_max_us = wait;
+            }
+        }
+
+        /* No transfer is going on, the clock can be changed */
+        spi_dev->cfg->regs->CR1 = (spi_dev->cfg->regs->CR1 & ~SPI_BaudRatePrescaler_256) | req->prescaler;
+    }
+
+    if (spi_dev->async_txn == 0 || !req->txn_list[spi_dev->async_txn - 1].keep_selected) {
+        PIOS_SPI_RC_PinSet((uint32_t)spi_dev, txn->slave_id, 0);
+    }
+
+    if (SPI_DMA_TransferBlock((uint32_t)spi_dev, txn->send_buf, txn->recv_buf, txn->len, NULL) < 0) {
+        SPI_Async_TxnDone(spi_dev, -3, woken);
+    }
+}
+
+/* A transfer of the head request ended, start the next one or complete the request */
+static void SPI_Async_TxnDone(struct pios_spi_dev *spi_dev, int32_t result, bool *woken)
+{
+    struct pios_spi_async_req *req = &spi_dev->async_queue[0];
+    const struct pios_spi_txn *txn = &req->txn_list[spi_dev->async_txn];
+
+    if (result >= 0 && spi_dev->async_txn + 1u < req->num_txns) {
+        if (!txn->keep_selected) {
+            PIOS_SPI_RC_PinSet((uint32_t)spi_dev, txn->slave_id, 1);
+        }
+        spi_dev->async_txn++;
+        SPI_Async_StartTxn(spi_dev, woken);
+        return;
+    }
+
+    /* The request ends here even if the transfer asked to keep the slave selected */
+    PIOS_SPI_RC_PinSet((uint32_t)spi_dev, txn->slave_id, 1);
+
+    PIOS_IRQ_Disable();
+    pios_spi_callback callback = req->callback;
+    void *context = req->context;
+    for (uint8_t i = 1; i < spi_dev->async_count; i++) {
+        spi_dev->async_queue[i - 1] = spi_dev->async_queue[i];
+    }
+    spi_dev->async_count--;
+    spi_dev->async_txn = 0;
+    bool next = spi_dev->async_count > 0;
+    if (!next) {
+        spi_dev->async_active = false;
+    }
+    PIOS_IRQ_Enable();
+
+    if (!next) {
+        /* Leave the clock as the bus holder before the engine set it */
+        spi_dev->cfg->regs->CR1 = (spi_dev->cfg->regs->CR1 & ~SPI_BaudRatePrescaler_256) | spi_dev->async_saved_br;
+        SPI_Async_Release(spi_dev, woken);
+    }
+
+    /* The callback may queue another request, it goes behind the one started next */
+    callback(result, context);
+
+    if (next) {
+        SPI_Async_StartTxn(spi_dev, woken);
+    }
+}
+
+/**
+ * Queue an asynchronous request on the bus and return at once.
+ * The transfers go by DMA with the chip selects handled per transfer, the
+ * callback runs from the DMA interrupt once the last one is done.
+ * Can be called from an ISR.
+ * \param[in] spi_id SPI device handle
+ * \param[in] txn_list transfers of the request, must stay valid until the callback
+ * \param[in] num_txns number of transfers
+ * \param[in] spi_prescaler clock of the request
+ * \param[in] priority high priority requests go before the queued normal ones
+ * \param[in] callback called with the result of the request
+ * \param[in] context passed to the callback
+ * \return 0 if queued
+ * \return -1 for an invalid request
+ * \return -2 if the queue is full
+ */
+int32_t PIOS_SPI_TransferAsync(uint32_t spi_id, const struct pios_spi_txn txn_list[], uint32_t num_txns, SPIPrescalerTypeDef spi_prescaler,
+                               enum pios_spi_priority priority, pios_spi_callback callback, void *context)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    if (!txn_list || !num_txns || !callback || spi_prescaler >= 8) {
+        return -1;
+    }
+
+    PIOS_IRQ_Disable();
+    if (spi_dev->async_count >= PIOS_SPI_ASYNC_QUEUE_LEN) {
+        spi_dev->stats.queue_full++;
+        PIOS_IRQ_Enable();
+        return -2;
+    }
+
+    /* Behind the requests of the same or a higher priority, never before the one in progress */
+    uint8_t pos = spi_dev->async_count;
+    while (pos > (spi_dev->async_active ? 1 : 0) && spi_dev->async_queue[pos - 1].priority < priority) {
+        spi_dev->async_queue[pos] = spi_dev->async_queue[pos - 1];
+        pos--;
+    }
+    struct pios_spi_async_req *req = &spi_dev->async_queue[pos];
+    req->txn_list  = txn_list;
+    req->num_txns  = num_txns;
+    req->prescaler = ((uint16_t)spi_prescaler & 7) << 3;
+    req->priority  = priority;
+    req->callback  = callback;
+    req->context   = context;
+    req->queued    = PIOS_DELAY_GetRaw();
+    spi_dev->async_count++;
+    bool idle = !spi_dev->async_active;
+    PIOS_IRQ_Enable();
+
+    /* Only the bus owner sets async_active, so the engine is idle if the bus could be taken */
+    if (idle && SPI_Async_TryClaim(spi_dev)) {
+        spi_dev->async_active   = true;
+        spi_dev->async_txn      = 0;
+        spi_dev->async_saved_br = spi_dev->cfg->regs->CR1 & SPI_BaudRatePrescaler_256;
+        SPI_Async_StartTxn(spi_dev, NULL);
+    }
+
+    return 0;
+}
+
+/**
+ * Get the statistics of the bus claims
+ * \param[in] spi_id SPI device handle
+ * \param[out] stats counters since the bus was initialised
+ * \return 0 if no error
+ */
+int32_t PIOS_SPI_GetBusStats(uint32_t spi_id, struct pios_spi_bus_stats *stats)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    PIOS_IRQ_Disable();
+    *stats = spi_dev->stats;
+    PIOS_IRQ_Enable();
+    return 0;
+}
+
+/**
+ * Get the statistics of the asynchronous requests of a slave
+ * \param[in] spi_id SPI device handle
+ * \param[in] slave_id slave select of the device
+ * \param[out] stats counters since the bus was initialised
+ * \return 0 if no error
+ * \return -1 if the slave isn't tracked
+ */
+int32_t PIOS_SPI_GetSlaveStats(uint32_t spi_id, uint32_t slave_id, struct pios_spi_slave_stats *stats)
+{
+    struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
+
+    bool valid = PIOS_SPI_validate(spi_dev);
+
+    PIOS_Assert(valid)
+
+    if (slave_id >= PIOS_SPI_STATS_SLAVES) {
+        return -1;
+    }
+
+    PIOS_IRQ_Disable();
+    *stats = spi_dev->slave_stats[slave_id];
+    PIOS_IRQ_Enable();
+    return 0;
+}
+
 void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
 {
     struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
@@ -751,6 +1037,21 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
         }
     }
 
+    if (spi_dev->async_active) {
+        int32_t result = 0;
+        bool woken     = false;
+
+        if (spi_dev->cfg->use_crc && SPI_I2S_GetFlagStatus(spi_dev->cfg->regs, SPI_FLAG_CRCERR)) {
+            SPI_I2S_ClearFlag(spi_dev->cfg->regs, SPI_FLAG_CRCERR);
+            result = -4;
+        }
+        SPI_Async_TxnDone(spi_dev, result, &woken);
+#if defined(PIOS_INCLUDE_FREERTOS)
+        portEND_SWITCHING_ISR(woken ? pdTRUE : pdFALSE);
+#endif
+        return;
+    }
+
     if (spi_dev->callback != NULL) {
         bool crc_ok = true;
         uint8_t crc_val;
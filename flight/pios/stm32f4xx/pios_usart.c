@@ -38,6 +38,13 @@
 
 #include <pios_usart_priv.h>
 
+#ifndef PIOS_USART_DMA_RX_BUFFER_SIZE
+#define PIOS_USART_DMA_RX_BUFFER_SIZE 128
+#endif
+#ifndef PIOS_USART_DMA_TX_BUFFER_SIZE
+#define PIOS_USART_DMA_TX_BUFFER_SIZE 64
+#endif
+
 /* Provide a COM driver */
 static void PIOS_USART_ChangeBaud(uint32_t usart_id, uint32_t baud);
 static void PIOS_USART_RegisterRxCallback(uint32_t usart_id, pios_com_callback rx_in_cb, uint32_t context);
@@ -65,6 +72,11 @@ struct pios_usart_dev {
     uint32_t rx_in_context;
     pios_com_callback tx_out_cb;
     uint32_t tx_out_context;
+
+    uint8_t  *rx_dma_buf;
+    uint16_t rx_dma_pos; /* next byte of the circular rx buffer to hand to the COM layer */
+    uint8_t  *tx_dma_buf;
+    volatile uint32_t irq_count;
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev *usart_dev)
@@ -113,6 +125,9 @@ static struct pios_usart_dev *PIOS_USART_alloc(void)
  * each physical IRQ to a specific registered device instance.
  */
 static void PIOS_USART_generic_irq_handler(uint32_t usart_id);
+static int32_t PIOS_USART_DMA_Init(struct pios_usart_dev *usart_dev);
+static void PIOS_USART_DMA_RxDrain(struct pios_usart_dev *usart_dev, bool *need_yield);
+static void PIOS_USART_DMA_TxNext(struct pios_usart_dev *usart_dev, bool *need_yield);
 
 static uint32_t PIOS_USART_1_id;
 void USART1_IRQHandler(void) __attribute__((alias("PIOS_USART_1_irq_handler")));
@@ -216,8 +231,16 @@ int32_t PIOS_USART_Init(uint32_t *usart_id, const struct pios_usart_cfg *cfg)
         break;
     }
     NVIC_Init((NVIC_InitTypeDef *)&(usart_dev->cfg->irq.init));
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
-    USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    if (usart_dev->cfg->dma) {
+        if (PIOS_USART_DMA_Init(usart_dev)) {
+            goto out_fail;
+        }
+        /* Data moves by DMA, the USART only signals the end of a burst */
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_IDLE, ENABLE);
+    } else {
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+        USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
+    }
 
     // FIXME XXX Clear / reset uart here - sends NUL char else
 
@@ -230,6 +253,77 @@ out_fail:
     return -1;
 }
 
+/**
+ * Set up circular reception and the transmit stream of a DMA enabled port
+ */
+static int32_t PIOS_USART_DMA_Init(struct pios_usart_dev *usart_dev)
+{
+    const struct pios_usart_dma_cfg *dma = usart_dev->cfg->dma;
+    DMA_InitTypeDef dma_init;
+
+    usart_dev->rx_dma_buf = (uint8_t *)pios_malloc(PIOS_USART_DMA_RX_BUFFER_SIZE);
+    usart_dev->tx_dma_buf = (uint8_t *)pios_malloc(PIOS_USART_DMA_TX_BUFFER_SIZE);
+    if (!usart_dev->rx_dma_buf || !usart_dev->tx_dma_buf) {
+        return -1;
+    }
+
+    /* Reception never stops, the buffer is drained behind the DMA write position */
+    DMA_DeInit(dma->rx.channel);
+    dma_init = dma->rx.init;
+    dma_init.DMA_Memory0BaseAddr = (uint32_t)usart_dev->rx_dma_buf;
+    dma_init.DMA_BufferSize = PIOS_USART_DMA_RX_BUFFER_SIZE;
+    dma_init.DMA_Mode = DMA_Mode_Circular;
+    DMA_Init(dma->rx.channel, &dma_init);
+    DMA_ITConfig(dma->rx.channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    NVIC_Init((NVIC_InitTypeDef *)&(dma->rx_irq.init));
+    USART_DMACmd(usart_dev->cfg->regs, USART_DMAReq_Rx, ENABLE);
+    DMA_Cmd(dma->rx.channel, ENABLE);
+
+    /* Each transmit block only sets the length and enables the stream */
+    DMA_DeInit(dma->tx.channel);
+    dma_init = dma->tx.init;
+    dma_init.DMA_Memory0BaseAddr = (uint32_t)usart_dev->tx_dma_buf;
+    dma_init.DMA_BufferSize = PIOS_USART_DMA_TX_BUFFER_SIZE;
+    dma_init.DMA_Mode = DMA_Mode_Normal;
+    DMA_Init(dma->tx.channel, &dma_init);
+    DMA_ITConfig(dma->tx.channel, DMA_IT_TC, ENABLE);
+    NVIC_Init((NVIC_InitTypeDef *)&(dma->tx_irq.init));
+    USART_DMACmd(usart_dev->cfg->regs, USART_DMAReq_Tx, ENABLE);
+
+    return 0;
+}
+
+static struct pios_usart_dev *PIOS_USART_GetDev(uint8_t port)
+{
+    switch (port) {
+    case 1:
+        return (struct pios_usart_dev *)PIOS_USART_1_id;
+
+    case 2:
+        return (struct pios_usart_dev *)PIOS_USART_2_id;
+
+    case 3:
+        return (struct pios_usart_dev *)PIOS_USART_3_id;
+
+    case 4:
+        return (struct pios_usart_dev *)PIOS_USART_4_id;
+
+    case 5:
+        return (struct pios_usart_dev *)PIOS_USART_5_id;
+
+    case 6:
+        return (struct pios_usart_dev *)PIOS_USART_6_id;
+    }
+    return NULL;
+}
+
+uint32_t PIOS_USART_GetIrqCount(uint8_t port)
+{
+    struct pios_usart_dev *usart_dev = PIOS_USART_GetDev(port);
+
+    return usart_dev ? usart_dev->irq_count : 0;
+}
+
 static void PIOS_USART_RxStart(uint32_t usart_id, __attribute__((unused)) uint16_t rx_bytes_avail)
 {
     struct pios_usart_dev *usart_dev = (struct pios_usart_dev *)usart_id;
@@ -238,6 +332,10 @@ static void PIOS_USART_RxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
+    if (usart_dev->cfg->dma) {
+        /* Reception never stops, bytes not fitting into the COM buffer are dropped */
+        return;
+    }
     USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
 }
 static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16_t tx_bytes_avail)
@@ -248,6 +346,11 @@ static void PIOS_USART_TxStart(uint32_t usart_id, __attribute__((unused)) uint16
 
     PIOS_Assert(valid);
 
+    if (usart_dev->cfg->dma) {
+        /* Blocks are only started from the DMA IRQ, so that a running transfer is never touched */
+        NVIC_SetPendingIRQ(usart_dev->cfg->dma->tx_irq.init.NVIC_IRQChannel);
+        return;
+    }
     USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE, ENABLE);
 }
 
@@ -316,6 +419,25 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 
     PIOS_Assert(valid);
 
+    usart_dev->irq_count++;
+
+    if (usart_dev->cfg->dma) {
+        /* Only the idle line interrupt is enabled, dr must not be read before sr says so or a byte is lost */
+        volatile uint16_t sr = usart_dev->cfg->regs->SR;
+        if (sr & USART_SR_IDLE) {
+            /* Reading dr after sr clears the flag */
+            (void)usart_dev->cfg->regs->DR;
+            bool need_yield = false;
+            PIOS_USART_DMA_RxDrain(usart_dev, &need_yield);
+#if defined(PIOS_INCLUDE_FREERTOS)
+            if (need_yield) {
+                vPortYield();
+            }
+#endif /* PIOS_INCLUDE_FREERTOS */
+        }
+        return;
+    }
+
     /* Force read of dr after sr to make sure to clear error flags */
     volatile uint16_t sr = usart_dev->cfg->regs->SR;
     volatile uint8_t dr  = usart_dev->cfg->regs->DR;
@@ -358,6 +480,94 @@ static void PIOS_USART_generic_irq_handler(uint32_t usart_id)
 #endif /* PIOS_INCLUDE_FREERTOS */
 }
 
+/**
+ * Hand the bytes received since the last call to the COM layer
+ */
+static void PIOS_USART_DMA_RxDrain(struct pios_usart_dev *usart_dev, bool *need_yield)
+{
+    uint16_t head = PIOS_USART_DMA_RX_BUFFER_SIZE - DMA_GetCurrDataCounter(usart_dev->cfg->dma->rx.channel);
+
+    if (head == PIOS_USART_DMA_RX_BUFFER_SIZE) {
+        head = 0;
+    }
+    uint16_t tail = usart_dev->rx_dma_pos;
+    if (head == tail) {
+        return;
+    }
+
+    if (usart_dev->rx_in_cb) {
+        if (head < tail) {
+            /* The DMA wrapped around */
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->rx_dma_buf[tail], PIOS_USART_DMA_RX_BUFFER_SIZE - tail, NULL, need_yield);
+            tail = 0;
+        }
+        if (head > tail) {
+            (void)(usart_dev->rx_in_cb)(usart_dev->rx_in_context, &usart_dev->rx_dma_buf[tail], head - tail, NULL, need_yield);
+        }
+    }
+    usart_dev->rx_dma_pos = head;
+}
+
+/**
+ * Start sending the next block if the stream is idle
+ */
+static void PIOS_USART_DMA_TxNext(struct pios_usart_dev *usart_dev, bool *need_yield)
+{
+    DMA_Stream_TypeDef *stream = usart_dev->cfg->dma->tx.channel;
+
+    if (DMA_GetCmdStatus(stream) == ENABLE || !usart_dev->tx_out_cb) {
+        return;
+    }
+    uint16_t bytes_to_send = (usart_dev->tx_out_cb)(usart_dev->tx_out_context, usart_dev->tx_dma_buf, PIOS_USART_DMA_TX_BUFFER_SIZE, NULL, need_yield);
+    if (bytes_to_send > 0) {
+        /* A stream only restarts with its flags cleared */
+        DMA_ClearITPendingBit(stream, usart_dev->cfg->dma->tx_irq.flags);
+        DMA_SetCurrDataCounter(stream, bytes_to_send);
+        DMA_Cmd(stream, ENABLE);
+    }
+}
+
+/**
+ * Common handler of both DMA streams of a port, and of a transmission
+ * requested by PIOS_USART_TxStart()
+ * \param[in] regs USART of the port
+ */
+void PIOS_USART_DMA_IRQHandler(USART_TypeDef *regs)
+{
+    struct pios_usart_dev *usart_dev = NULL;
+
+    for (uint8_t port = 1; port <= 6 && !usart_dev; port++) {
+        struct pios_usart_dev *dev = PIOS_USART_GetDev(port);
+        if (dev && dev->cfg->regs == regs) {
+            usart_dev = dev;
+        }
+    }
+    /* The port may be configured without DMA, e.g. as a receiver port */
+    if (!usart_dev || !usart_dev->cfg->dma) {
+        return;
+    }
+
+    const struct pios_usart_dma_cfg *dma = usart_dev->cfg->dma;
+    bool need_yield = false;
+
+    usart_dev->irq_count++;
+
+    /* Both streams are handled every time, the positions tell what is to be done */
+    DMA_ClearITPendingBit(dma->rx.channel, dma->rx_irq.flags);
+    PIOS_USART_DMA_RxDrain(usart_dev, &need_yield);
+
+    if (DMA_GetCmdStatus(dma->tx.channel) == DISABLE) {
+        DMA_ClearITPendingBit(dma->tx.channel, dma->tx_irq.flags);
+        PIOS_USART_DMA_TxNext(usart_dev, &need_yield);
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (need_yield) {
+        vPortYield();
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+}
+
 #endif /* PIOS_INCLUDE_USART */
 
 /**
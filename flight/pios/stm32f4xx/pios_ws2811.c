@@ -36,16 +36,25 @@
 #include "task.h"
 
 
-// framebuffer
-static ledbuf_t *fb = 0;
+// pixel store, three bytes (G, R, B) per led
+static uint8_t *fb = 0;
+// streamCh1 source, two halves of one led each refilled from fb while the other half is sent
+static ledbuf_t dmaBuffer[PIOS_WS2811_DMA_BUFFER_SIZE] __attribute__((aligned(4)));
+// dmaBuffer content for each nibble value, msb first
+static ledbuf_t nibbleLUT[16][4];
 // bitmask with pin to be set/reset using dma
 static ledbuf_t dmaSource[4];
 
+// halves of dmaBuffer sent during the current frame, last one is a trailing pad
+static volatile uint16_t halvesSent;
+#define PIOS_WS2811_FRAME_HALVES (PIOS_WS2811_NUMLEDS + 1)
+
 static const struct pios_ws2811_cfg *pios_ws2811_cfg;
 static const struct pios_ws2811_pin_cfg *pios_ws2811_pin_cfg;
 
 static void setupTimer();
 static void setupDMA();
+static void fillHalf(uint8_t half, uint16_t led);
 
 // generic wrapper around corresponding SPL functions
 static void genericTIM_OCxInit(TIM_TypeDef *TIMx, const TIM_OCInitTypeDef *TIM_OCInitStruct, uint8_t ch);
@@ -118,9 +127,9 @@ static void genericTIM_OCxPreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreloa
     .dmaItUpdate   = DMA_IT_TEIF5 | DMA_IT_TCIF5,
     .dmaSource     = TIM_DMA_CC1 | TIM_DMA_CC3 | TIM_DMA_Update,
 
-    // DMA streamCh1 interrupt vector, used to block timer at end of framebuffer transfer
+    // DMA streamCh1 interrupt vector, used to refill the led buffer halves and to stop the timer at end of frame
     .irq = {
-        .flags = (DMA_IT_TCIF1),
+        .flags = (DMA_IT_TCIF1 | DMA_IT_HTIF1),
         .init  = {
             .NVIC_IRQChannel    = DMA2_Stream1_IRQn,
             .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_HIGH,
@@ -150,7 +159,11 @@ static void genericTIM_OCxPreloadConfig(TIM_TypeDef *TIMx, uint16_t TIM_OCPreloa
  * - streamUpdate dma stream, triggered by update event will produce a logic 1 on the output pin
  * - streamCh1 will bring the pin to 0 if framebuffer location is set to dmaSource value to send a "0" bit to WS281x
  * - streamCh2 will bring pin to 0 once .8us are passed to send a "1" bit to ws281x
- * Once StreamCh1 has finished to send the buffer the IRQ handler will stop the timer.
+ * StreamCh1 cycles over a buffer holding two leds. Each time a half has been sent the
+ * IRQ handler refills it with the led after the one in the other half, expanding the
+ * pixel bytes through nibbleLUT. A trailing half is sent once the last led is out and
+ * its completion stops the timer. Ram use does not depend on the strip length apart
+ * from the three bytes per led pixel store.
  *
  */
 
@@ -175,12 +188,14 @@ void PIOS_WS2811_Init(const struct pios_ws2811_cfg *ws2811_cfg, const struct pio
         dmaSource[i] = (ledbuf_t)pios_ws2811_pin_cfg->gpioInit.GPIO_Pin;
     }
 
-    fb = (ledbuf_t *)pios_malloc(PIOS_WS2811_BUFFER_SIZE * sizeof(ledbuf_t));
-    memset(fb, 0, PIOS_WS2811_BUFFER_SIZE * sizeof(ledbuf_t));
-    const Color_t ledoff = Color_Off;
-    for (uint8_t i = 0; i < PIOS_WS2811_NUMLEDS; i++) {
-        PIOS_WS2811_setColorRGB(ledoff, i, false);
+    for (uint8_t i = 0; i < 16; i++) {
+        for (uint8_t j = 0; j < 4; j++) {
+            nibbleLUT[i][j] = ((i << j) & 0b1000 ? 0x0 : dmaSource[0]);
+        }
     }
+
+    fb = (uint8_t *)pios_malloc(PIOS_WS2811_NUMLEDS * 3);
+    memset(fb, 0, PIOS_WS2811_NUMLEDS * 3);
     // Setup timers
     setupTimer();
     setupDMA();
@@ -264,10 +279,10 @@ void setupDMA()
     // Configure Ch1
     DMA_Init(pios_ws2811_cfg->streamCh1, (DMA_InitTypeDef *)&pios_ws2811_cfg->dmaInitCh1);
     pios_ws2811_cfg->streamCh1->PAR  = (uint32_t)&pios_ws2811_pin_cfg->gpio->BSRRH;
-    pios_ws2811_cfg->streamCh1->M0AR = (uint32_t)fb;
+    pios_ws2811_cfg->streamCh1->M0AR = (uint32_t)dmaBuffer;
 
     NVIC_Init((NVIC_InitTypeDef *)&(pios_ws2811_cfg->irq.init));
-    DMA_ITConfig(pios_ws2811_cfg->streamCh1, DMA_IT_TC, ENABLE);
+    DMA_ITConfig(pios_ws2811_cfg->streamCh1, DMA_IT_TC | DMA_IT_HT, ENABLE);
 
 
     DMA_Init(pios_ws2811_cfg->streamCh2, (DMA_InitTypeDef *)&pios_ws2811_cfg->dmaInitCh2);
@@ -287,12 +302,28 @@ void setupDMA()
     DMA_Cmd(pios_ws2811_cfg->streamUpdate, ENABLE);
 }
 
-void setColor(uint8_t color, ledbuf_t *buf)
+static inline void setColor(uint8_t color, ledbuf_t *buf)
 {
-    uint8_t i;
+    memcpy(buf, nibbleLUT[color >> 4], sizeof(nibbleLUT[0]));
+    memcpy(buf + 4, nibbleLUT[color & 0x0f], sizeof(nibbleLUT[0]));
+}
 
-    for (i = 0; i < 8; i++) {
-        buf[i] = ((color << i) & 0b10000000 ? 0x0 : dmaSource[0]);
+/**
+ * Expand a led into one half of dmaBuffer, leds past the end of the strip are sent as off
+ */
+static void fillHalf(uint8_t half, uint16_t led)
+{
+    ledbuf_t *buf = dmaBuffer + half * PIOS_WS2811_DMA_HALF_SIZE;
+
+    if (led < PIOS_WS2811_NUMLEDS) {
+        const uint8_t *pixel = fb + led * 3;
+        setColor(pixel[0], buf);
+        setColor(pixel[1], buf + 8);
+        setColor(pixel[2], buf + 16);
+    } else {
+        setColor(0, buf);
+        setColor(0, buf + 8);
+        setColor(0, buf + 16);
     }
 }
 
@@ -307,9 +338,10 @@ void PIOS_WS2811_setColorRGB(Color_t c, uint8_t led, bool update)
     if (led >= PIOS_WS2811_NUMLEDS) {
         return;
     }
-    setColor(c.G, fb + (led * 24));
-    setColor(c.R, fb + 8 + (led * 24));
-    setColor(c.B, fb + 16 + (led * 24));
+    uint8_t *pixel = fb + (led * 3);
+    pixel[0] = c.G;
+    pixel[1] = c.R;
+    pixel[2] = c.B;
 
     if (update) {
         PIOS_WS2811_Update();
@@ -326,6 +358,17 @@ void PIOS_WS2811_Update()
         return;
     }
 
+    // preload both halves and restart streamCh1 from the beginning of dmaBuffer,
+    // the stream must be disabled to drop data prefetched in its fifo
+    DMA_Cmd(pios_ws2811_cfg->streamCh1, DISABLE);
+    while (DMA_GetCmdStatus(pios_ws2811_cfg->streamCh1) != DISABLE) {
+        ;
+    }
+    fillHalf(0, 0);
+    fillHalf(1, 1);
+    halvesSent = 0;
+    DMA_SetCurrDataCounter(pios_ws2811_cfg->streamCh1, PIOS_WS2811_DMA_BUFFER_SIZE);
+
     // reset counters for synchronization
     pios_ws2811_cfg->timer->CNT = PIOS_WS2811_TIM_PERIOD - 1;
 
@@ -337,14 +380,23 @@ void PIOS_WS2811_Update()
 }
 
 /**
- * Stop timer once the complete framebuffer has been sent
+ * Refill the half of dmaBuffer just sent, stop timer once the complete frame has been sent
  */
 
 void PIOS_WS2811_DMA_irq_handler()
 {
+    DMA_ClearFlag(pios_ws2811_cfg->streamCh1, pios_ws2811_cfg->irq.flags);
+
+    // halves complete alternately, first half-transfer then transfer complete
+    uint8_t half = halvesSent & 1;
+    halvesSent++;
+    if (halvesSent < PIOS_WS2811_FRAME_HALVES) {
+        fillHalf(half, halvesSent + 1);
+        return;
+    }
+
     pios_ws2811_pin_cfg->gpio->BSRRH = dmaSource[0];
     pios_ws2811_cfg->timer->CR1 &= (uint16_t) ~TIM_CR1_CEN;
-    DMA_ClearFlag(pios_ws2811_cfg->streamCh1, pios_ws2811_cfg->irq.flags);
     DMA_Cmd(pios_ws2811_cfg->streamCh2, DISABLE);
     DMA_Cmd(pios_ws2811_cfg->streamCh1, DISABLE);
     DMA_Cmd(pios_ws2811_cfg->streamUpdate, DISABLE);
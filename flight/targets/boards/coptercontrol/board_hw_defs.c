@@ -184,7 +184,7 @@ static const struct pios_spi_cfg pios_spi_gyro_cfg = {
     },
 };
 
-static uint32_t pios_spi_gyro_id;
+uint32_t pios_spi_gyro_id;
 void PIOS_SPI_gyro_irq_handler(void)
 {
     /* Call into the generic code to handle the IRQ for this specific device */
@@ -422,6 +422,8 @@ static const struct flashfs_logfs_cfg flashfs_w25x_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00001000, /* 4K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* slot index for the settings objects */
 };
 
 
@@ -434,6 +436,8 @@ static const struct flashfs_logfs_cfg flashfs_m25p_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 64,         /* slot index for the settings objects */
 };
 
 #include "pios_flash.h"
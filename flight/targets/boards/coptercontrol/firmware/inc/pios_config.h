@@ -58,6 +58,8 @@
 #define PIOS_INCLUDE_TASK_MONITOR
 // #define PIOS_INCLUDE_INSTRUMENTATION
 #define PIOS_INSTRUMENTATION_MAX_COUNTERS 5
+// #define PIOS_INCLUDE_TRACE_BUFFER
+#define PIOS_TRACE_BUFFER_RECORDS 256
 
 /* PIOS hardware peripherals */
 #define PIOS_INCLUDE_IRQ
@@ -139,7 +141,7 @@
 /* #define PIOS_INCLUDE_COM_TELEM */
 /* #define PIOS_INCLUDE_COM_FLEXI */
 /* #define PIOS_INCLUDE_COM_AUX */
-/* #define PIOS_TELEM_PRIORITY_QUEUE */
+/* #define PIOS_TELEM_HITL_SENSORS */
 #define PIOS_INCLUDE_GPS
 #define PIOS_GPS_MINIMAL
 /* #define PIOS_INCLUDE_GPS_NMEA_PARSER */
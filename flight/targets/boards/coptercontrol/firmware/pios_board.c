@@ -69,8 +69,8 @@ static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
 #define PIOS_COM_TELEM_USB_RX_BUF_LEN    65
 #define PIOS_COM_TELEM_USB_TX_BUF_LEN    65
 
-#define PIOS_COM_BRIDGE_RX_BUF_LEN       65
-#define PIOS_COM_BRIDGE_TX_BUF_LEN       12
+#define PIOS_COM_BRIDGE_RX_BUF_LEN       128
+#define PIOS_COM_BRIDGE_TX_BUF_LEN       128
 
 #define PIOS_COM_HKOSD_TX_BUF_LEN        22
 
@@ -72,11 +72,6 @@
 #define PIOS_WDG_MANUAL          0x0008
 #define PIOS_WDG_AUTOTUNE        0x0010
 
-// ------------------------
-// TELEMETRY
-// ------------------------
-#define TELEM_QUEUE_SIZE         10
-
 // ------------------------
 // PIOS_LED
 // ------------------------
@@ -116,6 +111,8 @@ extern uint32_t pios_i2c_flexi_adapter_id;
 // See also pios_board.c
 // -------------------------
 #define PIOS_SPI_MAX_DEVS   2
+extern uint32_t pios_spi_gyro_id;
+#define PIOS_SPI_GYRO_ADAPTER (pios_spi_gyro_id)
 
 // -------------------------
 // PIOS_USART
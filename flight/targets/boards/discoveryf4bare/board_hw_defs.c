@@ -1859,9 +1859,9 @@ const struct pios_ws2811_cfg pios_ws2811_cfg = {
     .dmaItUpdate   = DMA_IT_TEIF5 | DMA_IT_TCIF5,
     .dmaSource     = TIM_DMA_CC1 | TIM_DMA_CC3 | TIM_DMA_Update,
 
-    // DMA streamCh1 interrupt vector, used to block timer at end of framebuffer transfer
+    // DMA streamCh1 interrupt vector, used to refill the led buffer halves and to stop the timer at end of frame
     .irq                                       = {
-        .flags = (DMA_IT_TCIF1),
+        .flags = (DMA_IT_TCIF1 | DMA_IT_HTIF1),
         .init  = {
             .NVIC_IRQChannel    = DMA2_Stream1_IRQn,
             .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_HIGHEST,
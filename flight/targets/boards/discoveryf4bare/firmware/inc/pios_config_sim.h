@@ -59,7 +59,6 @@
 #define AUXUART_ENABLED        0
 #define AUXUART_BAUDRATE       19200
 
-#define TELEM_QUEUE_SIZE       20
 #define PIOS_TELEM_STACK_SIZE  2048
 
 /* Stabilization options */
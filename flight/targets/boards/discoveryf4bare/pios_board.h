@@ -159,7 +159,6 @@ extern uint32_t pios_packet_handler;
 // ------------------------
 // TELEMETRY
 // ------------------------
-#define TELEM_QUEUE_SIZE        80
 #define PIOS_TELEM_STACK_SIZE   800
 
 // -------------------------
@@ -70,11 +70,6 @@
 #define PIOS_WDG_GPS          0x0002
 #define PIOS_WDG_MAG          0x0004
 
-// ------------------------
-// TELEMETRY
-// ------------------------
-// #define TELEM_QUEUE_SIZE         20
-
 // ------------------------
 // PIOS_LED
 // ------------------------
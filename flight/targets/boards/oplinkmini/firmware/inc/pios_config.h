@@ -134,7 +134,6 @@
 /* #define PIOS_INCLUDE_COM_TELEM */
 /* #define PIOS_INCLUDE_COM_FLEXI */
 /* #define PIOS_INCLUDE_COM_AUX */
-/* #define PIOS_TELEM_PRIORITY_QUEUE */
 /* #define PIOS_INCLUDE_GPS */
 /* #define PIOS_GPS_MINIMAL */
 /* #define PIOS_INCLUDE_GPS_NMEA_PARSER */
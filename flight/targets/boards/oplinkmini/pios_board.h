@@ -78,11 +78,6 @@
 #define PIOS_WDG_PPMINPUT     0x0010
 #define PIOS_WDG_SERIALRX     0x0020
 
-// ------------------------
-// TELEMETRY
-// ------------------------
-#define TELEM_QUEUE_SIZE      20
-
 // ------------------------
 // PIOS_LED
 // ------------------------
@@ -101,7 +101,6 @@
 // ------------------------
 // TELEMETRY
 // ------------------------
-#define TELEM_QUEUE_SIZE           20
 #define PIOS_TELEM_STACK_SIZE      800
 
 // *****************************************************************
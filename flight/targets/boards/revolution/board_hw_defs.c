@@ -462,7 +462,7 @@ static const struct pios_spi_cfg pios_spi_gyro_cfg = {
     }
 };
 
-static uint32_t pios_spi_gyro_id;
+uint32_t pios_spi_gyro_id;
 void PIOS_SPI_gyro_irq_handler(void)
 {
     /* Call into the generic code to handle the IRQ for this specific device */
@@ -681,6 +681,16 @@ const struct pios_rfm22b_cfg *PIOS_BOARD_HW_DEFS_GetRfm22Cfg(uint32_t board_revi
 #include "pios_flash_jedec_priv.h"
 #include "pios_flash_internal_priv.h"
 
+#if defined(PIOS_INCLUDE_FLASH_STREAMFS)
+static const struct streamfs_cfg streamfs_external_user_cfg = {
+    .fs_magic      = 0x99abcf01,
+    .total_fs_size = 0x001C0000, /* 1.75M bytes (28 sectors) */
+
+    .start_offset  = 0x00040000, /* start offset */
+    .sector_size   = 0x00010000, /* 64K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+};
+#else
 static const struct flashfs_logfs_cfg flashfs_external_user_cfg = {
     .fs_magic      = 0x99abceff,
     .total_fs_size = 0x001C0000, /* 2M bytes (32 sectors = entire chip) */
@@ -691,6 +701,7 @@ static const struct flashfs_logfs_cfg flashfs_external_user_cfg = {
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
 };
+#endif /* if defined(PIOS_INCLUDE_FLASH_STREAMFS) */
 
 static const struct flashfs_logfs_cfg flashfs_external_system_cfg = {
     .fs_magic      = 0x99bbcdef,
@@ -701,6 +712,8 @@ static const struct flashfs_logfs_cfg flashfs_external_system_cfg = {
     .start_offset  = 0,          /* start at the beginning of the chip */
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 128,        /* slot index for the settings objects */
 };
 
 
@@ -725,7 +738,74 @@ static const struct flashfs_logfs_cfg flashfs_internal_cfg = {
 
 /*
  * MAIN USART
+ * DMA2 stream 2 receives and stream 7 transmits
  */
+void PIOS_USART_main_dma_irq_handler(void);
+void DMA2_Stream2_IRQHandler(void) __attribute__((alias("PIOS_USART_main_dma_irq_handler")));
+void DMA2_Stream7_IRQHandler(void) __attribute__((alias("PIOS_USART_main_dma_irq_handler")));
+void PIOS_USART_main_dma_irq_handler(void)
+{
+    PIOS_USART_DMA_IRQHandler(USART1);
+}
+
+static const struct pios_usart_dma_cfg pios_usart_main_dma_cfg = {
+    .rx     = {
+        .channel = DMA2_Stream2,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralBaseAddr = (uint32_t)&(USART1->DR),
+            .DMA_DIR                = DMA_DIR_PeripheralToMemory,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Mode               = DMA_Mode_Normal,
+            .DMA_Priority           = DMA_Priority_High,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            /* .DMA_FIFOThreshold */
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    /* same priority as the USART IRQ, both drain the rx buffer */
+    .rx_irq = {
+        .flags = (DMA_IT_TCIF2 | DMA_IT_TEIF2 | DMA_IT_HTIF2 | DMA_IT_DMEIF2 | DMA_IT_FEIF2),
+        .init  = {
+            .NVIC_IRQChannel    = DMA2_Stream2_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+    .tx     = {
+        .channel = DMA2_Stream7,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralBaseAddr = (uint32_t)&(USART1->DR),
+            .DMA_DIR                = DMA_DIR_MemoryToPeripheral,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Mode               = DMA_Mode_Normal,
+            .DMA_Priority           = DMA_Priority_Medium,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            /* .DMA_FIFOThreshold */
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    .tx_irq = {
+        .flags = (DMA_IT_TCIF7 | DMA_IT_TEIF7 | DMA_IT_HTIF7 | DMA_IT_DMEIF7 | DMA_IT_FEIF7),
+        .init  = {
+            .NVIC_IRQChannel    = DMA2_Stream7_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+};
+
 static const struct pios_usart_cfg pios_usart_main_cfg = {
     .regs  = USART1,
     .remap = GPIO_AF_USART1,
@@ -765,6 +845,7 @@ static const struct pios_usart_cfg pios_usart_main_cfg = {
             .GPIO_PuPd  = GPIO_PuPd_UP
         },
     },
+    .dma = &pios_usart_main_dma_cfg,
 };
 #endif /* PIOS_INCLUDE_COM_TELEM */
 
@@ -903,7 +984,74 @@ static const struct pios_sbus_cfg pios_sbus_cfg = {
 #ifdef PIOS_INCLUDE_COM_FLEXI
 /*
  * FLEXI PORT
+ * DMA1 stream 1 receives and stream 3 transmits
  */
+void PIOS_USART_flexi_dma_irq_handler(void);
+void DMA1_Stream1_IRQHandler(void) __attribute__((alias("PIOS_USART_flexi_dma_irq_handler")));
+void DMA1_Stream3_IRQHandler(void) __attribute__((alias("PIOS_USART_flexi_dma_irq_handler")));
+void PIOS_USART_flexi_dma_irq_handler(void)
+{
+    PIOS_USART_DMA_IRQHandler(USART3);
+}
+
+static const struct pios_usart_dma_cfg pios_usart_flexi_dma_cfg = {
+    .rx     = {
+        .channel = DMA1_Stream1,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralBaseAddr = (uint32_t)&(USART3->DR),
+            .DMA_DIR                = DMA_DIR_PeripheralToMemory,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Mode               = DMA_Mode_Normal,
+            .DMA_Priority           = DMA_Priority_High,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            /* .DMA_FIFOThreshold */
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    /* same priority as the USART IRQ, both drain the rx buffer */
+    .rx_irq = {
+        .flags = (DMA_IT_TCIF1 | DMA_IT_TEIF1 | DMA_IT_HTIF1 | DMA_IT_DMEIF1 | DMA_IT_FEIF1),
+        .init  = {
+            .NVIC_IRQChannel    = DMA1_Stream1_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+    .tx     = {
+        .channel = DMA1_Stream3,
+        .init    = {
+            .DMA_Channel            = DMA_Channel_4,
+            .DMA_PeripheralBaseAddr = (uint32_t)&(USART3->DR),
+            .DMA_DIR                = DMA_DIR_MemoryToPeripheral,
+            .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+            .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+            .DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+            .DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte,
+            .DMA_Mode               = DMA_Mode_Normal,
+            .DMA_Priority           = DMA_Priority_Medium,
+            .DMA_FIFOMode           = DMA_FIFOMode_Disable,
+            /* .DMA_FIFOThreshold */
+            .DMA_MemoryBurst        = DMA_MemoryBurst_Single,
+            .DMA_PeripheralBurst    = DMA_PeripheralBurst_Single,
+        },
+    },
+    .tx_irq = {
+        .flags = (DMA_IT_TCIF3 | DMA_IT_TEIF3 | DMA_IT_HTIF3 | DMA_IT_DMEIF3 | DMA_IT_FEIF3),
+        .init  = {
+            .NVIC_IRQChannel    = DMA1_Stream3_IRQn,
+            .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_MID,
+            .NVIC_IRQChannelSubPriority        = 0,
+            .NVIC_IRQChannelCmd = ENABLE,
+        },
+    },
+};
+
 static const struct pios_usart_cfg pios_usart_flexi_cfg = {
     .regs  = USART3,
     .remap = GPIO_AF_USART3,
@@ -944,6 +1092,7 @@ static const struct pios_usart_cfg pios_usart_flexi_cfg = {
             .GPIO_PuPd  = GPIO_PuPd_UP
         },
     },
+    .dma = &pios_usart_flexi_dma_cfg,
 };
 
 #endif /* PIOS_INCLUDE_COM_FLEXI */
@@ -2127,9 +2276,9 @@ const struct pios_ws2811_cfg pios_ws2811_cfg = {
     .dmaItUpdate   = DMA_IT_TEIF5 | DMA_IT_TCIF5,
     .dmaSource     = TIM_DMA_CC1 | TIM_DMA_CC3 | TIM_DMA_Update,
 
-    // DMAInitCh1 interrupt vector, used to block timer at end of framebuffer transfer
+    // DMAInitCh1 interrupt vector, used to refill the led buffer halves and to stop the timer at end of frame
     .irq                                       = {
-        .flags = (DMA_IT_TCIF1),
+        .flags = (DMA_IT_TCIF1 | DMA_IT_HTIF1),
         .init  = {
             .NVIC_IRQChannel    = DMA2_Stream1_IRQn,
             .NVIC_IRQChannelPreemptionPriority = PIOS_IRQ_PRIO_HIGHEST,
@@ -96,6 +96,13 @@
     while (0)
 #define portGET_RUN_TIME_COUNTER_VALUE() (*(unsigned long *)0xe0001004) /* DWT_CYCCNT */
 
+/* Record the task switches in the PIOS trace buffer, needs PIOS_INCLUDE_TRACE_BUFFER */
+#define configUSE_PIOS_TRACE_BUFFER                  1
+#if configUSE_PIOS_TRACE_BUFFER && !defined(__ASSEMBLER__)
+void PIOS_TRACE_TaskSwitchedIn(void *task);
+#define traceTASK_SWITCHED_IN() PIOS_TRACE_TaskSwitchedIn(pxCurrentTCB)
+#endif
+
 
 /**
  * @}
@@ -58,6 +58,9 @@
 
 #define PIOS_INCLUDE_INSTRUMENTATION
 #define PIOS_INSTRUMENTATION_MAX_COUNTERS 10
+#define PIOS_INCLUDE_TRACE_BUFFER
+#define PIOS_TRACE_BUFFER_RECORDS 256
+#define PIOS_INCLUDE_DEBUGLOG_FORMATS
 
 /* PIOS hardware peripherals */
 #define PIOS_INCLUDE_IRQ
@@ -121,6 +124,7 @@
 #define PIOS_INCLUDE_FLASH
 #define PIOS_INCLUDE_FLASH_INTERNAL
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
+#define PIOS_INCLUDE_FLASH_STREAMFS
 #define FLASH_FREERTOS
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 
@@ -142,7 +146,7 @@
 #define PIOS_INCLUDE_COM_TELEM
 #define PIOS_INCLUDE_COM_FLEXI
 /* #define PIOS_INCLUDE_COM_AUX */
-#define PIOS_TELEM_PRIORITY_QUEUE
+#define PIOS_TELEM_HITL_SENSORS
 #define PIOS_INCLUDE_GPS
 /* #define PIOS_GPS_MINIMAL */
 #define PIOS_INCLUDE_GPS_NMEA_PARSER
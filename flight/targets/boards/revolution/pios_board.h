@@ -103,6 +103,8 @@
 // See also pios_board.c
 // ------------------------
 #define PIOS_SPI_MAX_DEVS      3
+extern uint32_t pios_spi_gyro_id;
+#define PIOS_SPI_GYRO_ADAPTER  (pios_spi_gyro_id)
 
 // ------------------------
 // PIOS_WDG
@@ -179,7 +181,6 @@ extern uint32_t pios_packet_handler;
 // ------------------------
 // TELEMETRY
 // ------------------------
-#define TELEM_QUEUE_SIZE        80
 #define PIOS_TELEM_STACK_SIZE   800
 
 // -------------------------
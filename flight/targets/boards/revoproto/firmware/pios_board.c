@@ -298,8 +298,8 @@ uint32_t pios_rcvr_group_map[MANUALCONTROLSETTINGS_CHANNELGROUPS_NONE];
 #define PIOS_COM_TELEM_USB_RX_BUF_LEN 65
 #define PIOS_COM_TELEM_USB_TX_BUF_LEN 65
 
-#define PIOS_COM_BRIDGE_RX_BUF_LEN    65
-#define PIOS_COM_BRIDGE_TX_BUF_LEN    12
+#define PIOS_COM_BRIDGE_RX_BUF_LEN    512
+#define PIOS_COM_BRIDGE_TX_BUF_LEN    512
 
 #define PIOS_COM_AUX_RX_BUF_LEN       512
 #define PIOS_COM_AUX_TX_BUF_LEN       512
@@ -827,12 +827,13 @@ void PIOS_Board_Init(void)
             }
             const uint32_t PACKET_SIZE = 1024;
             uint8_t *rx_buffer = (uint8_t *)pios_malloc(PACKET_SIZE);
-            uint8_t *tx_buffer = (uint8_t *)pios_malloc(PACKET_SIZE);
+            // room for the next packet while the DMA sends the current one
+            uint8_t *tx_buffer = (uint8_t *)pios_malloc(2 * PACKET_SIZE);
             PIOS_Assert(rx_buffer);
             PIOS_Assert(tx_buffer);
             if (PIOS_COM_Init(&pios_com_overo_id, &pios_overo_com_driver, pios_overo_id,
                               rx_buffer, PACKET_SIZE,
-                              tx_buffer, PACKET_SIZE)) {
+                              tx_buffer, 2 * PACKET_SIZE)) {
                 PIOS_Assert(0);
             }
         }
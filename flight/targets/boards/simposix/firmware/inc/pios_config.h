@@ -104,7 +104,7 @@
 
 /* Flags that alter behaviors - mostly to lower resources for CC */
 #define PIOS_INCLUDE_INITCALL          /* Include init call structures */
-#define PIOS_TELEM_PRIORITY_QUEUE      /* Enable a priority queue in telemetry */
+#define PIOS_TELEM_HITL_SENSORS        /* Accept the HITL sensor set of a step in one object */
 #define PIOS_QUATERNION_STABILIZATION  /* Stabilization options */
 // #define PIOS_GPS_SETS_HOMELOCATION      /* GPS options */
 
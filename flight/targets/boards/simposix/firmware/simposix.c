@@ -34,6 +34,7 @@
 #include "inc/openpilot.h"
 #include <systemmod.h>
 #include <uavobjectsinit.h>
+#include <unistd.h>
 
 /* Task Priorities */
 #define PRIORITY_TASK_HOOKS (tskIDLE_PRIORITY + 3)
@@ -69,6 +70,9 @@ static void Stack_Change_Weak() __attribute__((weakref("Stack_Change")));
 #define INIT_TASK_STACK    (1024 / 4)                                                                              // XXX this seems excessive
 static xTaskHandle initTaskHandle;
 
+/* the external clock of the lock step simulation, next to the telemetry, gps and aux ports */
+#define LOCKSTEP_CLOCK_PORT 9003
+
 /* Function Prototypes */
 static void initTask(void *parameters);
 
@@ -83,10 +87,35 @@ extern void InitModules(void);
  * Start FreeRTOS Scheduler (vTaskStartScheduler)<BR>
  * If something goes wrong, blink LED1 and LED2 every 100ms
  *
+ * Options:
+ *  -p offset  added to all UDP ports, to run several instances side by side
+ *  -l         lock step, the ticks are granted through the clock port instead of the wall clock
  */
-int main()
+int main(int argc, char *argv[])
 {
     int result;
+    int opt;
+    uint16_t port_offset = 0;
+    bool lockstep = false;
+
+    while ((opt = getopt(argc, argv, "p:l")) != -1) {
+        switch (opt) {
+        case 'p':
+            port_offset = atoi(optarg);
+            break;
+        case 'l':
+            lockstep = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p port_offset] [-l]\n", argv[0]);
+            return 1;
+        }
+    }
+    PIOS_UDP_SetPortOffset(port_offset);
+    if (lockstep && PIOS_DELAY_InitLockStep(LOCKSTEP_CLOCK_PORT + port_offset) < 0) {
+        fprintf(stderr, "could not open the clock port %d\n", LOCKSTEP_CLOCK_PORT + port_offset);
+        return 1;
+    }
 
     /* NOTE: Do NOT modify the following start-up sequence */
     /* Any new initialization functions should be added in OpenPilotInit() */
@@ -133,7 +133,6 @@ extern uint32_t pios_com_vcp_id;
 // ------------------------
 // TELEMETRY
 // ------------------------
-#define TELEM_QUEUE_SIZE        20
 #define PIOS_TELEM_STACK_SIZE   624
 
 #define PIOS_COM_BUFFER_SIZE    1024
@@ -0,0 +1,290 @@
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* getenv */
+#include <string.h> /* memset */
+
+#include <chrono> /* steady_clock */
+#include <fstream>
+#include <map>
+#include <string>
+
+extern "C" {
+#include "pios_flash.h"
+#include "pios_flash_ut_priv.h"
+#include "pios_flashfs_logfs_priv.h"
+#include "pios_flashfs.h"
+#include "pios_crc.h"
+#include "fifo_buffer.h"
+#include "insgps.h"
+#include "CoordinateConversions.h"
+
+extern struct pios_flash_ut_cfg flash_config;
+extern struct flashfs_logfs_cfg flashfs_config_partition_a;
+}
+
+/*
+ * Micro-benchmarks of the hot paths of the flight libraries, run on the host.
+ *
+ * Every result is printed as "BENCHMARK <name> <value> <unit>". The times are the
+ * best of a few runs to keep them stable. The results are written to the file named
+ * by BENCHMARK_OUTPUT, and compared to the ones of the file named by BENCHMARK_BASELINE:
+ * a time more than BENCHMARK_TOLERANCE (default 1.25) times its baseline, or a flash
+ * operation count above its baseline, fails the test.
+ */
+
+#define RUNS 5
+
+class Benchmark : public testing::Test {
+protected:
+    // time of one call of fn, in ns, best of RUNS runs of iterations calls
+    template<typename F> static double measure(int iterations, F fn)
+    {
+        double best = 0;
+
+        for (int run = 0; run < RUNS; run++) {
+            auto start = std::chrono::steady_clock::now();
+            for (int n = 0; n < iterations; n++) {
+                fn(n);
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+            if (run == 0 || ns < best) {
+                best = ns;
+            }
+        }
+        return best;
+    }
+
+    static void reportTime(const char *name, double ns)
+    {
+        report(name, ns, "ns", true);
+    }
+
+    static void reportCount(const char *name, uint32_t count)
+    {
+        report(name, count, "ops", false);
+    }
+
+private:
+    static void report(const char *name, double value, const char *unit, bool isTime)
+    {
+        printf(isTime ? "BENCHMARK %s %.1f %s\n" : "BENCHMARK %s %.0f %s\n", name, value, unit);
+
+        const char *output = getenv("BENCHMARK_OUTPUT");
+        if (output) {
+            std::ofstream out(output, std::ios::app);
+            out << name << " " << value << "\n";
+        }
+
+        std::map<std::string, double>::const_iterator base = baseline().find(name);
+        if (base == baseline().end()) {
+            return;
+        }
+        if (isTime) {
+            const char *tolerance = getenv("BENCHMARK_TOLERANCE");
+            double limit = base->second * (tolerance ? atof(tolerance) : 1.25);
+            printf("          %.2fx the baseline\n", value / base->second);
+            EXPECT_LE(value, limit) << name << " is slower than its baseline";
+        } else {
+            EXPECT_LE(value, base->second) << name << " uses more flash operations than its baseline";
+        }
+    }
+
+    static const std::map<std::string, double> &baseline()
+    {
+        static std::map<std::string, double> values;
+        static bool loaded = false;
+
+        if (!loaded) {
+            loaded = true;
+            const char *file = getenv("BENCHMARK_BASELINE");
+            if (file) {
+                std::ifstream in(file);
+                std::string name;
+                double value;
+                while (in >> name >> value) {
+                    values[name] = value;
+                }
+            }
+        }
+        return values;
+    }
+};
+
+class LogfsBenchmark : public Benchmark {
+protected:
+    virtual void SetUp()
+    {
+        /* create an empty, appropriately sized flash filesystem */
+        FILE *theflash = fopen(FLASH_IMAGE_FILE, "wb");
+        uint8_t sector[flash_config.size_of_sector];
+
+        memset(sector, 0xFF, sizeof(sector));
+        for (uint32_t i = 0; i < flash_config.size_of_flash / flash_config.size_of_sector; i++) {
+            fwrite(sector, sizeof(sector), 1, theflash);
+        }
+        fclose(theflash);
+
+        EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_FLASHFS_Logfs_Destroy(fs_id);
+        PIOS_Flash_UT_Destroy(flash_id);
+    }
+
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+};
+
+TEST_F(LogfsBenchmark, ObjSaveLoad) {
+    // 16 objects of the size of a typical settings object saved over and over,
+    // enough to fill the arenas and go through compactions
+    const int objects    = 16;
+    const int iterations = 2000;
+    uint8_t obj[76];
+    struct pios_flash_ut_stats before, after;
+
+    for (uint32_t i = 0; i < sizeof(obj); i++) {
+        obj[i] = 0x10 + (i % 10);
+    }
+
+    PIOS_Flash_UT_GetStats(flash_id, &before);
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; n++) {
+        obj[0] = n;
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, 0x10000000 + (n % objects), 0, obj, sizeof(obj)));
+    }
+    double save = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    PIOS_Flash_UT_GetStats(flash_id, &after);
+
+    reportTime("logfs_objsave", save);
+    reportCount("logfs_objsave_reads", after.reads - before.reads);
+    reportCount("logfs_objsave_writes", after.writes - before.writes);
+    reportCount("logfs_objsave_bytes_written", after.bytes_written - before.bytes_written);
+    reportCount("logfs_objsave_erases", after.erases - before.erases);
+
+    PIOS_Flash_UT_GetStats(flash_id, &before);
+    double load = measure(iterations / RUNS, [&](int n) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, 0x10000000 + (n % objects), 0, obj, sizeof(obj)));
+    });
+    PIOS_Flash_UT_GetStats(flash_id, &after);
+
+    reportTime("logfs_objload", load);
+    reportCount("logfs_objload_reads", after.reads - before.reads);
+}
+
+TEST_F(Benchmark, FifoBuffer) {
+    const int iterations = 200000;
+    uint8_t storage[1024];
+    uint8_t frame[64];
+    t_fifo_buffer fifo;
+
+    memset(storage, 0, sizeof(storage));
+    memset(frame, 0x55, sizeof(frame));
+    fifoBuf_init(&fifo, storage, sizeof(storage));
+
+    // a telemetry sized frame in and out, and the same byte by byte
+    double block = measure(iterations, [&](int) {
+        fifoBuf_putData(&fifo, frame, sizeof(frame));
+        fifoBuf_getData(&fifo, frame, sizeof(frame));
+    });
+    double bytes = measure(iterations / 10, [&](int) {
+        for (uint32_t i = 0; i < sizeof(frame); i++) {
+            fifoBuf_putByte(&fifo, frame[i]);
+        }
+        for (uint32_t i = 0; i < sizeof(frame); i++) {
+            frame[i] = fifoBuf_getByte(&fifo);
+        }
+    });
+
+    reportTime("fifo_64b_block", block);
+    reportTime("fifo_64b_bytes", bytes);
+}
+
+TEST_F(Benchmark, UAVTalkChecksum) {
+    // The UAVTalk packer needs the generated objects, the checksum of the frames is
+    // the part of its cost that grows with their length
+    const int iterations = 200000;
+    uint8_t frame[256];
+    volatile uint8_t sink;
+
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = i * 7;
+    }
+
+    double block = measure(iterations, [&](int) {
+        sink = PIOS_CRC_updateCRC(0, frame, sizeof(frame));
+    });
+    double bytes = measure(iterations / 10, [&](int) {
+        uint8_t cs = 0;
+        for (uint32_t i = 0; i < sizeof(frame); i++) {
+            cs = PIOS_CRC_updateByte(cs, frame[i]);
+        }
+        sink = cs;
+    });
+    (void)sink;
+
+    reportTime("uavtalk_crc_256b", block);
+    reportTime("uavtalk_crc_256b_bytes", bytes);
+}
+
+TEST_F(Benchmark, InsgpsPrediction) {
+    const int iterations = 20000;
+    float gyro[3]  = { 0.01f, -0.02f, 0.005f };
+    float accel[3] = { 0.1f, -0.2f, -9.81f };
+    float pos[3]   = { 0, 0, 0 };
+    float vel[3]   = { 0, 0, 0 };
+    float q[4]     = { 1, 0, 0, 0 };
+    float gyro_bias[3]  = { 0, 0, 0 };
+    float accel_bias[3] = { 0, 0, 0 };
+
+    INSGPSInit();
+    INSSetState(pos, vel, q, gyro_bias, accel_bias);
+
+    double state = measure(iterations, [&](int) {
+        INSStatePrediction(gyro, accel, 0.002f);
+    });
+    double covariance = measure(iterations, [&](int) {
+        INSCovariancePrediction(0.002f);
+    });
+
+    reportTime("insgps_state_prediction", state);
+    reportTime("insgps_covariance_prediction", covariance);
+}
+
+TEST_F(Benchmark, CoordinateConversions) {
+    const int iterations = 200000;
+    int32_t home[3] = { 473977000, 85456000, 40000 };
+    float rpy[3] = { 10.0f, -5.0f, 45.0f };
+    float q[4];
+    float Rbe[3][3];
+    float NED[3];
+    LocalTangentPlane ltp;
+    volatile float sink;
+
+    LTPFromLLA(home, &ltp);
+
+    double rpy2q = measure(iterations, [&](int n) {
+        rpy[2] = n * 0.001f;
+        RPY2Quaternion(rpy, q);
+        sink   = q[0];
+    });
+    double q2r = measure(iterations, [&](int) {
+        Quaternion2R(q, Rbe);
+        sink = Rbe[0][0];
+    });
+    double lla2ltp = measure(iterations, [&](int n) {
+        const int32_t lla[3] = { home[0] + n % 1000, home[1] - n % 1000, home[2] };
+        LLA2LTP(lla, &ltp, NED);
+        sink = NED[0];
+    });
+    (void)sink;
+
+    reportTime("rpy2quaternion", rpy2q);
+    reportTime("quaternion2r", q2r);
+    reportTime("lla2ltp", lla2ltp);
+}
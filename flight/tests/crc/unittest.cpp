@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+
+extern "C" {
+#include "pios_crc.h"
+}
+
+// Bitwise reference implementation of the CRC8 (polynomial 0x07) used by UAVTalk
+static uint8_t crc8_reference(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    while (length--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class CrcTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(1234);
+        for (uint32_t i = 0; i < sizeof(buffer); i++) {
+            buffer[i] = rand() & 0xFF;
+        }
+    }
+
+    uint8_t buffer[512];
+};
+
+TEST_F(CrcTest, CheckValue) {
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+    EXPECT_EQ(0xF4, PIOS_CRC_updateCRC(0, check, sizeof(check)));
+}
+
+TEST_F(CrcTest, EmptyBuffer) {
+    EXPECT_EQ(0x00, PIOS_CRC_updateCRC(0x00, buffer, 0));
+    EXPECT_EQ(0x5A, PIOS_CRC_updateCRC(0x5A, buffer, 0));
+}
+
+TEST_F(CrcTest, MatchesReferenceAllLengthsAndOffsets) {
+    for (int32_t offset = 0; offset < 8; offset++) {
+        for (int32_t length = 0; length < 300; length++) {
+            EXPECT_EQ(crc8_reference(0, &buffer[offset], length), PIOS_CRC_updateCRC(0, &buffer[offset], length));
+        }
+    }
+}
+
+TEST_F(CrcTest, MatchesByteUpdate) {
+    uint8_t crc = 0x3C;
+
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+        crc = PIOS_CRC_updateByte(crc, buffer[i]);
+    }
+    EXPECT_EQ(crc, PIOS_CRC_updateCRC(0x3C, buffer, sizeof(buffer)));
+}
+
+TEST_F(CrcTest, SplitUpdates) {
+    uint8_t crc = PIOS_CRC_updateCRC(0, buffer, 7);
+
+    crc = PIOS_CRC_updateCRC(crc, &buffer[7], 13);
+    crc = PIOS_CRC_updateCRC(crc, &buffer[20], sizeof(buffer) - 20);
+    EXPECT_EQ(PIOS_CRC_updateCRC(0, buffer, sizeof(buffer)), crc);
+}
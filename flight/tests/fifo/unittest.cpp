@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+
+extern "C" {
+#include "fifo_buffer.h"
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class FifoTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(storage, 0, sizeof(storage));
+        fifoBuf_init(&fifo, storage, sizeof(storage));
+        for (uint32_t i = 0; i < sizeof(pattern); i++) {
+            pattern[i] = i * 7 + 3;
+        }
+    }
+
+    // moves rd and wr to offset in an empty buffer
+    void Rotate(uint16_t offset)
+    {
+        uint8_t scratch[sizeof(storage)];
+
+        EXPECT_EQ(offset, fifoBuf_putData(&fifo, pattern, offset));
+        EXPECT_EQ(offset, fifoBuf_getData(&fifo, scratch, offset));
+        EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+    }
+
+    t_fifo_buffer fifo;
+    uint8_t storage[17];
+    uint8_t pattern[64];
+};
+
+TEST_F(FifoTest, Empty) {
+    uint8_t out[4];
+
+    EXPECT_EQ(16, fifoBuf_getSize(&fifo));
+    EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+    EXPECT_EQ(16, fifoBuf_getFree(&fifo));
+    EXPECT_EQ(-1, fifoBuf_getByte(&fifo));
+    EXPECT_EQ(-1, fifoBuf_getBytePeek(&fifo));
+    EXPECT_EQ(0, fifoBuf_getData(&fifo, out, sizeof(out)));
+}
+
+TEST_F(FifoTest, Full) {
+    EXPECT_EQ(16, fifoBuf_putData(&fifo, pattern, sizeof(pattern)));
+    EXPECT_EQ(0, fifoBuf_getFree(&fifo));
+    EXPECT_EQ(0, fifoBuf_putByte(&fifo, 0x55));
+    EXPECT_EQ(0, fifoBuf_putData(&fifo, pattern, 1));
+}
+
+TEST_F(FifoTest, WrapAtEveryOffset) {
+    for (uint16_t offset = 0; offset < sizeof(storage); offset++) {
+        for (uint16_t len = 0; len <= 16; len++) {
+            uint8_t out[sizeof(storage)];
+            SetUp();
+            Rotate(offset);
+
+            EXPECT_EQ(len, fifoBuf_putData(&fifo, pattern, len));
+            EXPECT_EQ(len, fifoBuf_getUsed(&fifo));
+
+            memset(out, 0, sizeof(out));
+            EXPECT_EQ(len, fifoBuf_getDataPeek(&fifo, out, sizeof(out)));
+            EXPECT_EQ(0, memcmp(out, pattern, len));
+            EXPECT_EQ(len, fifoBuf_getUsed(&fifo));
+
+            memset(out, 0, sizeof(out));
+            EXPECT_EQ(len, fifoBuf_getData(&fifo, out, sizeof(out)));
+            EXPECT_EQ(0, memcmp(out, pattern, len));
+            EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+        }
+    }
+}
+
+TEST_F(FifoTest, ReadSpan) {
+    uint8_t *data;
+
+    Rotate(12);
+    EXPECT_EQ(10, fifoBuf_putData(&fifo, pattern, 10));
+
+    // the first span ends at the end of the buffer
+    EXPECT_EQ(5, fifoBuf_getReadSpan(&fifo, &data));
+    EXPECT_EQ(&storage[12], data);
+    EXPECT_EQ(0, memcmp(data, pattern, 5));
+    fifoBuf_removeData(&fifo, 5);
+
+    EXPECT_EQ(5, fifoBuf_getReadSpan(&fifo, &data));
+    EXPECT_EQ(&storage[0], data);
+    EXPECT_EQ(0, memcmp(data, &pattern[5], 5));
+    fifoBuf_removeData(&fifo, 5);
+
+    EXPECT_EQ(0, fifoBuf_getReadSpan(&fifo, &data));
+}
+
+TEST_F(FifoTest, WriteSpan) {
+    uint8_t *data;
+    uint8_t out[sizeof(storage)];
+
+    // the reserved slot keeps a full buffer distinct from an empty one
+    EXPECT_EQ(16, fifoBuf_getWriteSpan(&fifo, &data));
+
+    Rotate(12);
+    EXPECT_EQ(5, fifoBuf_getWriteSpan(&fifo, &data));
+    EXPECT_EQ(&storage[12], data);
+    memcpy(data, pattern, 5);
+    fifoBuf_commitWrite(&fifo, 5);
+
+    EXPECT_EQ(11, fifoBuf_getWriteSpan(&fifo, &data));
+    EXPECT_EQ(&storage[0], data);
+    memcpy(data, &pattern[5], 11);
+    fifoBuf_commitWrite(&fifo, 11);
+
+    EXPECT_EQ(0, fifoBuf_getWriteSpan(&fifo, &data));
+    EXPECT_EQ(16, fifoBuf_getData(&fifo, out, sizeof(out)));
+    EXPECT_EQ(0, memcmp(out, pattern, 16));
+}
+
+TEST_F(FifoTest, CommitIsLimitedToFreeSpace) {
+    fifoBuf_commitWrite(&fifo, 100);
+    EXPECT_EQ(16, fifoBuf_getUsed(&fifo));
+    fifoBuf_removeData(&fifo, 100);
+    EXPECT_EQ(0, fifoBuf_getUsed(&fifo));
+}
@@ -15,6 +15,10 @@ struct flash_ut_dev {
     const struct pios_flash_ut_cfg *cfg;
     bool transaction_in_progress;
     FILE *flash_file;
+    uint32_t num_reads;
+    uint32_t num_writes;
+    uint32_t num_erases;
+    uint32_t bytes_written;
 };
 
 static struct flash_ut_dev *PIOS_Flash_UT_Alloc(void)
@@ -40,6 +44,10 @@ int32_t PIOS_Flash_UT_Init(uintptr_t *flash_id, const struct pios_flash_ut_cfg *
 
     flash_dev->cfg = cfg;
     flash_dev->transaction_in_progress = false;
+    flash_dev->num_reads = 0;
+    flash_dev->num_writes    = 0;
+    flash_dev->num_erases    = 0;
+    flash_dev->bytes_written = 0;
 
     flash_dev->flash_file = fopen(FLASH_IMAGE_FILE, "rb+");
     if (flash_dev->flash_file == NULL) {
@@ -74,6 +82,23 @@ int32_t PIOS_Flash_UT_Destroy(uintptr_t flash_id)
     return 0;
 }
 
+uint32_t PIOS_Flash_UT_GetReadCount(uintptr_t flash_id)
+{
+    struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
+
+    return flash_dev->num_reads;
+}
+
+void PIOS_Flash_UT_GetStats(uintptr_t flash_id, struct pios_flash_ut_stats *stats)
+{
+    struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
+
+    stats->reads  = flash_dev->num_reads;
+    stats->writes = flash_dev->num_writes;
+    stats->erases = flash_dev->num_erases;
+    stats->bytes_written = flash_dev->bytes_written;
+}
+
 
 /**********************************
  *
@@ -109,6 +134,7 @@ static int32_t PIOS_Flash_UT_EraseSector(uintptr_t flash_id, uint32_t addr)
     struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
 
     assert(flash_dev->transaction_in_progress);
+    flash_dev->num_erases++;
 
     if (fseek(flash_dev->flash_file, addr, SEEK_SET) != 0) {
         assert(0);
@@ -134,6 +160,8 @@ static int32_t PIOS_Flash_UT_WriteData(uintptr_t flash_id, uint32_t addr, uint8_
     struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
 
     assert(flash_dev->transaction_in_progress);
+    flash_dev->num_writes++;
+    flash_dev->bytes_written += len;
 
     if (fseek(flash_dev->flash_file, addr, SEEK_SET) != 0) {
         assert(0);
@@ -155,6 +183,7 @@ static int32_t PIOS_Flash_UT_ReadData(uintptr_t flash_id, uint32_t addr, uint8_t
     struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
 
     assert(flash_dev->transaction_in_progress);
+    flash_dev->num_reads++;
 
     if (fseek(flash_dev->flash_file, addr, SEEK_SET) != 0) {
         assert(0);
@@ -8,6 +8,18 @@ struct pios_flash_ut_cfg {
 int32_t PIOS_Flash_UT_Init(uintptr_t *flash_id, const struct pios_flash_ut_cfg *cfg);
 
 int32_t PIOS_Flash_UT_Destroy(uintptr_t flash_id);
+
+/* Number of read_data calls since init, used for benchmarking */
+uint32_t PIOS_Flash_UT_GetReadCount(uintptr_t flash_id);
+
+/* Flash operations since init, used to compare the wear of the file systems */
+struct pios_flash_ut_stats {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t bytes_written;
+};
+void PIOS_Flash_UT_GetStats(uintptr_t flash_id, struct pios_flash_ut_stats *stats);
 extern const struct pios_flash_driver pios_ut_flash_driver;
 
 #if !defined(FLASH_IMAGE_FILE)
@@ -3,6 +3,7 @@
 #include <stdio.h> /* printf */
 #include <stdlib.h> /* abort */
 #include <string.h> /* memset */
+#include <time.h> /* clock_gettime */
 
 extern "C" {
 #include "pios_flash.h" /* PIOS_FLASH_* API */
@@ -14,6 +15,7 @@ extern struct pios_flash_ut_cfg flash_config;
 
 extern struct flashfs_logfs_cfg flashfs_config_partition_a;
 extern struct flashfs_logfs_cfg flashfs_config_partition_b;
+extern struct flashfs_logfs_cfg flashfs_config_partition_a_indexed;
 
 #include "pios_flashfs.h" /* PIOS_FLASHFS_* */
 }
@@ -392,3 +394,186 @@ TEST_F(LogfsTestCookedMultiPart, WriteLarge) {
     memset(obj4_check, 0, sizeof(obj4_check));
     EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id_b, OBJ4_ID, 0, obj4_check, sizeof(obj4_check)));
 }
+
+class LogfsTestIndexed : public LogfsTestRaw {
+protected:
+    virtual void SetUp()
+    {
+        /* First, we need to set up the super fixture (LogfsTestRaw) */
+        LogfsTestRaw::SetUp();
+
+        /* Init the flash and the flashfs with a slot index */
+        EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a_indexed, &pios_ut_flash_driver, flash_id));
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_FLASHFS_Logfs_Destroy(fs_id);
+        PIOS_Flash_UT_Destroy(flash_id);
+    }
+
+    void remount()
+    {
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a_indexed, &pios_ut_flash_driver, flash_id));
+    }
+
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+};
+
+TEST_F(LogfsTestIndexed, WriteVerifyDeleteVerifyOne) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 0));
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(0, stats.num_active_slots);
+}
+
+TEST_F(LogfsTestIndexed, WriteRemountVerify) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 123, obj1_alt, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ2_ID, 0));
+
+    remount();
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 123, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+}
+
+TEST_F(LogfsTestIndexed, FillFilesystemAndGarbageCollect) {
+    /* More instances than the index can hold */
+    for (uint32_t i = 0; i < (flashfs_config_partition_a_indexed.arena_size / flashfs_config_partition_a_indexed.slot_size) - 1; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+    }
+
+    /* Should fail to add a new object since the filesystem is full */
+    EXPECT_EQ(-4, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+
+    /* Now save a new version of an existing object which should trigger gc and succeed */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+
+    /* Save the last instance again, it is not in the index */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 200, obj1_alt, sizeof(obj1_alt)));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint32_t i = 0; i < (flashfs_config_partition_a_indexed.arena_size / flashfs_config_partition_a_indexed.slot_size) - 1; i++) {
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp((i == 0 || i == 200) ? obj1_alt : obj1, obj1_check, sizeof(obj1)));
+    }
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ((flashfs_config_partition_a_indexed.arena_size / flashfs_config_partition_a_indexed.slot_size) - 1, stats.num_active_slots);
+}
+
+TEST_F(LogfsTestIndexed, WriteManyVerify) {
+    for (uint32_t i = 0; i < 10000; i++) {
+        /* Write a collection of objects */
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ0_ID, 0, NULL, 0));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 123, obj1_alt, sizeof(obj1_alt)));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    }
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ0_ID, 0, NULL, 0));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(5, stats.num_active_slots);
+}
+
+/*
+ * Benchmark resembling UAVObjLoadSettings() at boot: mount the filesystem,
+ * then load a set of objects where some have never been saved.
+ */
+#define BENCH_NUM_SAVED  60
+#define BENCH_NUM_LOADED 90
+
+static double bench_now_ms()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void bench_mount_and_load(const struct flashfs_logfs_cfg *cfg, uint32_t *reads, double *ms)
+{
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+    unsigned char obj[OBJ1_SIZE];
+
+    EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+
+    /* Populate the filesystem, leaving some obsolete slots behind as settings updates do */
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, cfg, &pios_ut_flash_driver, flash_id));
+    memset(obj, 0x5a, sizeof(obj));
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < BENCH_NUM_SAVED; i++) {
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID + i, 0, obj, sizeof(obj)));
+        }
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+
+    uint32_t reads_before = PIOS_Flash_UT_GetReadCount(flash_id);
+    double start = bench_now_ms();
+
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, cfg, &pios_ut_flash_driver, flash_id));
+    for (uint32_t i = 0; i < BENCH_NUM_LOADED; i++) {
+        EXPECT_EQ(i < BENCH_NUM_SAVED ? 0 : -3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID + i, 0, obj, sizeof(obj)));
+    }
+
+    *ms    = bench_now_ms() - start;
+    *reads = PIOS_Flash_UT_GetReadCount(flash_id) - reads_before;
+
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Destroy(fs_id));
+    PIOS_Flash_UT_Destroy(flash_id);
+}
+
+TEST_F(LogfsTestRaw, BenchmarkMountAndLoad) {
+    uint32_t plain_reads, indexed_reads;
+    double plain_ms, indexed_ms;
+
+    bench_mount_and_load(&flashfs_config_partition_a, &plain_reads, &plain_ms);
+    SetUp();
+    bench_mount_and_load(&flashfs_config_partition_a_indexed, &indexed_reads, &indexed_ms);
+
+    printf("mount + %d loads: %u flash reads %.2f ms without index, %u flash reads %.2f ms with index\n",
+           BENCH_NUM_LOADED, plain_reads, plain_ms, indexed_reads, indexed_ms);
+
+    /* Mounting reads every slot header once, after that each load is one header and one data read */
+    EXPECT_GT(plain_reads, indexed_reads);
+    EXPECT_GE(indexed_reads, (flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) + 2 * BENCH_NUM_SAVED);
+    EXPECT_LE(indexed_reads, (flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) + 2 * BENCH_NUM_SAVED + 32);
+}
@@ -34,3 +34,16 @@ const struct flashfs_logfs_cfg flashfs_config_partition_b = {
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
 };
+
+const struct flashfs_logfs_cfg flashfs_config_partition_a_indexed = {
+    .fs_magic      = 0x89abceef,
+    .total_fs_size = 0x00200000, /* 2M bytes (32 sectors) */
+    .arena_size    = 0x00010000, /* 256 * slot size */
+    .slot_size     = 0x00000100, /* 256 bytes */
+
+    .start_offset  = 0,          /* start at the beginning of the chip */
+    .sector_size   = 0x00010000, /* 64K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+
+    .index_size    = 100,        /* less than the slots in an arena */
+};
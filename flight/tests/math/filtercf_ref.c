@@ -0,0 +1,161 @@
+/*
+ * Reference copy of the attitude update of flight/modules/StateEstimation/filtercf.c
+ * before it moved to cf_update() in complementaryfilter.h, with the UAVObject
+ * accesses taken out. Used to check the kernel gives the same attitude and to
+ * compare their speed.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pios_math.h>
+#include <fastmath.h>
+#include "CoordinateConversions.h"
+
+int8_t cf_update_ref(float attitude[4], float gyroBias[3], float accels_filtered[3], float grot_filtered[3],
+                     float gyro[3], float accel[3], float mag[3], bool useMag, float Be[3],
+                     float AccelKp, float AccelKi, float MagKp, float MagKi, float rollPitchBiasRate,
+                     float accel_alpha, bool accel_filter_enabled, float dT);
+
+static inline void apply_accel_filter(float accel_alpha, bool accel_filter_enabled, const float *raw, float *filtered)
+{
+    if (accel_filter_enabled) {
+        filtered[0] = filtered[0] * accel_alpha + raw[0] * (1 - accel_alpha);
+        filtered[1] = filtered[1] * accel_alpha + raw[1] * (1 - accel_alpha);
+        filtered[2] = filtered[2] * accel_alpha + raw[2] * (1 - accel_alpha);
+    } else {
+        filtered[0] = raw[0];
+        filtered[1] = raw[1];
+        filtered[2] = raw[2];
+    }
+}
+
+int8_t cf_update_ref(float attitude[4], float gyroBias[3], float accels_filtered[3], float grot_filtered[3],
+                     float gyro[3], float accel[3], float mag[3], bool useMag, float Be[3],
+                     float AccelKp, float AccelKi, float MagKp, float MagKi, float rollPitchBiasRate,
+                     float accel_alpha, bool accel_filter_enabled, float dT)
+{
+    // Apply smoothing to accel values, to reduce vibration noise before main calculations.
+    apply_accel_filter(accel_alpha, accel_filter_enabled, accel, accels_filtered);
+
+    // Rotate gravity to body frame and cross with accels
+    float grot[3];
+    grot[0] = -(2.0f * (attitude[1] * attitude[3] - attitude[0] * attitude[2]));
+    grot[1] = -(2.0f * (attitude[2] * attitude[3] + attitude[0] * attitude[1]));
+    grot[2] = -(attitude[0] * attitude[0] - attitude[1] * attitude[1] - attitude[2] * attitude[2] + attitude[3] * attitude[3]);
+
+    float accel_err[3];
+    apply_accel_filter(accel_alpha, accel_filter_enabled, grot, grot_filtered);
+
+    CrossProduct((const float *)accels_filtered, (const float *)grot_filtered, accel_err);
+
+    // Account for accel magnitude
+    float accel_mag = sqrtf(accels_filtered[0] * accels_filtered[0] + accels_filtered[1] * accels_filtered[1] + accels_filtered[2] * accels_filtered[2]);
+    if (accel_mag < 1.0e-3f) {
+        return -1;
+    }
+
+    // Account for filtered gravity vector magnitude
+    float grot_mag;
+    if (accel_filter_enabled) {
+        grot_mag = sqrtf(grot_filtered[0] * grot_filtered[0] + grot_filtered[1] * grot_filtered[1] + grot_filtered[2] * grot_filtered[2]);
+    } else {
+        grot_mag = 1.0f;
+    }
+    if (grot_mag < 1.0e-3f) {
+        return -1;
+    }
+
+    accel_err[0] /= (accel_mag * grot_mag);
+    accel_err[1] /= (accel_mag * grot_mag);
+    accel_err[2] /= (accel_mag * grot_mag);
+
+    float mag_err[3] = { 0.0f };
+    if (useMag) {
+        // Rotate gravity to body frame and cross with accels
+        float brot[3];
+        float Rbe[3][3];
+
+        Quaternion2R(attitude, Rbe);
+
+        rot_mult(Rbe, Be, brot);
+
+        float mag_len = sqrtf(mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2]);
+        mag[0]  /= mag_len;
+        mag[1]  /= mag_len;
+        mag[2]  /= mag_len;
+
+        float bmag = sqrtf(brot[0] * brot[0] + brot[1] * brot[1] + brot[2] * brot[2]);
+        brot[0] /= bmag;
+        brot[1] /= bmag;
+        brot[2] /= bmag;
+
+        // Only compute if neither vector is null
+        if (bmag < 1.0f || mag_len < 1.0f) {
+            mag_err[0] = mag_err[1] = mag_err[2] = 0.0f;
+        } else {
+            CrossProduct((const float *)mag, (const float *)brot, mag_err);
+        }
+    }
+
+    // Correct rates based on integral coefficient
+    gyro[0] -= gyroBias[0];
+    gyro[1] -= gyroBias[1];
+    gyro[2] -= gyroBias[2];
+
+    // Accumulate integral of error.  Scale here so that units are (deg/s) but Ki has units of s
+    gyroBias[0] -= accel_err[0] * AccelKi - gyro[0] * rollPitchBiasRate;
+    gyroBias[1] -= accel_err[1] * AccelKi - gyro[1] * rollPitchBiasRate;
+    if (useMag) {
+        gyroBias[2] -= -mag_err[2] * MagKi - gyro[2] * rollPitchBiasRate;
+    } else {
+        gyroBias[2] -= -gyro[2] * rollPitchBiasRate;
+    }
+
+    float gyrotmp[3] = { gyro[0], gyro[1], gyro[2] };
+    // Correct rates based on proportional coefficient
+    gyrotmp[0] += accel_err[0] * AccelKp / dT;
+    gyrotmp[1] += accel_err[1] * AccelKp / dT;
+    if (useMag) {
+        gyrotmp[2] += accel_err[2] * AccelKp / dT + mag_err[2] * MagKp / dT;
+    } else {
+        gyrotmp[2] += accel_err[2] * AccelKp / dT;
+    }
+
+    // Work out time derivative from INSAlgo writeup
+    // Also accounts for the fact that gyros are in deg/s
+    float qdot[4];
+    qdot[0]     = DEG2RAD(-attitude[1] * gyrotmp[0] - attitude[2] * gyrotmp[1] - attitude[3] * gyrotmp[2]) * dT / 2;
+    qdot[1]     = DEG2RAD(attitude[0] * gyrotmp[0] - attitude[3] * gyrotmp[1] + attitude[2] * gyrotmp[2]) * dT / 2;
+    qdot[2]     = DEG2RAD(attitude[3] * gyrotmp[0] + attitude[0] * gyrotmp[1] - attitude[1] * gyrotmp[2]) * dT / 2;
+    qdot[3]     = DEG2RAD(-attitude[2] * gyrotmp[0] + attitude[1] * gyrotmp[1] + attitude[0] * gyrotmp[2]) * dT / 2;
+
+    // Take a time step
+    attitude[0] = attitude[0] + qdot[0];
+    attitude[1] = attitude[1] + qdot[1];
+    attitude[2] = attitude[2] + qdot[2];
+    attitude[3] = attitude[3] + qdot[3];
+
+    if (attitude[0] < 0.0f) {
+        attitude[0] = -attitude[0];
+        attitude[1] = -attitude[1];
+        attitude[2] = -attitude[2];
+        attitude[3] = -attitude[3];
+    }
+
+    // Renomalize
+    float qmag2    = attitude[0] * attitude[0] + attitude[1] * attitude[1] + attitude[2] * attitude[2] + attitude[3] * attitude[3];
+    float inv_qmag = fast_invsqrtf_accurate(qmag2);
+    float qmag     = qmag2 * inv_qmag;
+    attitude[0] = attitude[0] * inv_qmag;
+    attitude[1] = attitude[1] * inv_qmag;
+    attitude[2] = attitude[2] * inv_qmag;
+    attitude[3] = attitude[3] * inv_qmag;
+
+    // If quaternion has become inappropriately short or is nan reinit.
+    // THIS SHOULD NEVER ACTUALLY HAPPEN
+    if ((fabsf(qmag) < 1.0e-3f) || isnan(qmag)) {
+        return -2;
+    }
+    return 0;
+}
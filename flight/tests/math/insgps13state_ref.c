@@ -0,0 +1,145 @@
+/*
+ * Reference copy of the generic covariance prediction and serial update of
+ * flight/libraries/insgps13state.c, before they were specialized for the
+ * sparsity of F, G and H. Used to check the specialized code gives the same
+ * results and to compare their speed.
+ */
+
+#include <stdint.h>
+#include <pios_math.h>
+
+#define NUMX 13 // number of states, X is the state vector
+#define NUMW 9 // number of plant noise inputs, w is disturbance noise vector
+#define NUMV 10 // number of measurements, v is the measurement noise vector
+
+void CovariancePredictionRef(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                             float Q[NUMW], float dT, float P[NUMX][NUMX]);
+void SerialUpdateRef(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                     float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                     uint16_t SensorsUsed);
+
+static const int8_t FrowMin[NUMX] = { 3, 4, 5, 6, 6, 6, 7, 6, 6, 6, 13, 13, 13 };
+static const int8_t FrowMax[NUMX] = { 3, 4, 5, 9, 9, 9, 12, 12, 12, 12, -1, -1, -1 };
+
+static const int8_t GrowMin[NUMX] = { 9, 9, 9, 3, 3, 3, 0, 0, 0, 0, 6, 7, 8 };
+static const int8_t GrowMax[NUMX] = { -1, -1, -1, 5, 5, 5, 2, 2, 2, 2, 6, 7, 8 };
+
+static const int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
+static const int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
+
+__attribute__((optimize("O3")))
+void CovariancePredictionRef(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMX][NUMX])
+{
+    // Pnew = (I+F*T)*P*(I+F*T)' + (T^2)*G*Q*G' = (T^2)[(P/T + F*P)*(I/T + F') + G*Q*G')]
+
+    float dT1  = 1.0f / dT; // multiplication is faster than division on fpu.
+    float dTsq = dT * dT;
+
+    float Dummy[NUMX][NUMX];
+    int8_t i;
+
+    for (i = 0; i < NUMX; i++) { // Calculate Dummy = (P/T +F*P)
+        float *Firow   = F[i];
+        float *Pirow   = P[i];
+        float *Dirow   = Dummy[i];
+        int8_t Fistart = FrowMin[i];
+        int8_t Fiend   = FrowMax[i];
+        int8_t j;
+        for (j = 0; j < NUMX; j++) {
+            Dirow[j] = Pirow[j] * dT1; // Dummy = P / T ...
+            int8_t k;
+            for (k = Fistart; k <= Fiend; k++) {
+                Dirow[j] += Firow[k] * P[k][j]; // [] + F * P
+            }
+        }
+    }
+    for (i = 0; i < NUMX; i++) { // Calculate Pnew = (T^2) [Dummy/T + Dummy*F' + G*Qw*G']
+        float *Dirow   = Dummy[i];
+        float *Girow   = G[i];
+        float *Pirow   = P[i];
+        int8_t Gistart = GrowMin[i];
+        int8_t Giend   = GrowMax[i];
+        int8_t j;
+        for (j = i; j < NUMX; j++) { // Use symmetry, ie only find upper triangular
+            float Ptmp = Dirow[j] * dT1; // Pnew = Dummy / T ...
+
+            {
+                float *Fjrow   = F[j];
+                int8_t Fjstart = FrowMin[j];
+                int8_t Fjend   = FrowMax[j];
+                int8_t k;
+                for (k = Fjstart; k <= Fjend; k++) {
+                    Ptmp += Dirow[k] * Fjrow[k]; // [] + Dummy*F' ...
+                }
+            }
+
+            {
+                float *Gjrow   = G[j];
+                int8_t Gjstart = MAX(Gistart, GrowMin[j]);
+                int8_t Gjend   = MIN(Giend, GrowMax[j]);
+                int8_t k;
+                for (k = Gjstart; k <= Gjend; k++) {
+                    Ptmp += Q[k] * Girow[k] * Gjrow[k]; // [] + G*Q*G' ...
+                }
+            }
+
+            P[j][i] = Pirow[j] = Ptmp * dTsq; // [] * (T^2)
+        }
+    }
+}
+
+// *************  SerialUpdate *******************
+// Does the update step of the Kalman filter for the covariance and estimate
+// Outputs are Xnew & Pnew, and are written over P and X
+// Z is actual measurement, Y is predicted measurement
+// Xnew = X + K*(Z-Y), Pnew=(I-K*H)*P,
+// where K=P*H'*inv[H*P*H'+R]
+// NOTE the algorithm assumes R (measurement covariance matrix) is diagonal
+// i.e. the measurment noises are uncorrelated.
+// It therefore uses a serial update that requires no matrix inversion by
+// processing the measurements one at a time.
+// Algorithm - see Grewal and Andrews, "Kalman Filtering,2nd Ed" p.121 & p.253
+// - or see Simon, "Optimal State Estimation," 1st Ed, p.150
+// The SensorsUsed variable is a bitwise mask indicating which sensors
+// should be used in the update.
+// ************************************************
+
+void SerialUpdateRef(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  uint16_t SensorsUsed)
+{
+    float HP[NUMX], HPHR, Error;
+    uint8_t i, j, k, m;
+    float Km[NUMX];
+
+    for (m = 0; m < NUMV; m++) {
+        if (SensorsUsed & (0x01 << m)) { // use this sensor for update
+            for (j = 0; j < NUMX; j++) { // Find Hp = H*P
+                HP[j] = 0;
+                for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                    HP[j] += H[m][k] * P[k][j];
+                }
+            }
+            HPHR = R[m]; // Find  HPHR = H*P*H' + R
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                HPHR += HP[k] * H[m][k];
+            }
+
+            for (k = 0; k < NUMX; k++) {
+                Km[k] = HP[k] / HPHR; // find K = HP/HPHR
+            }
+            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
+                for (j = i; j < NUMX; j++) {
+                    P[i][j] = P[j][i] =
+                                  P[i][j] - Km[i] * HP[j];
+                }
+            }
+
+            Error = Z[m] - Y[m];
+            for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
+                X[i] = X[i] + Km[i] * Error;
+            }
+        }
+    }
+}
@@ -4,8 +4,43 @@
 #include <stdlib.h> /* abort */
 #include <string.h> /* memset */
 
+#include <chrono> /* steady_clock */
+
 extern "C" {
 #include "mathmisc.h"
+#include "fastmath.h"
+#include "CoordinateConversions.h"
+#include "complementaryfilter.h"
+#include "insgps16state.h"
+#include "fft.h"
+#include "biquad.h"
+#include "magbias.h"
+
+#define NUMX 13
+#define NUMW 9
+#define NUMV 10
+#define NUMU 6
+
+/* Private functions of insgps13state.c and their reference versions */
+void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                          float Q[NUMW], float dT, float P[NUMX][NUMX]);
+void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                  uint16_t SensorsUsed);
+void LinearizeFG(float X[NUMX], float U[NUMU], float F[NUMX][NUMX],
+                 float G[NUMX][NUMW]);
+void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
+
+void CovariancePredictionRef(float F[NUMX][NUMX], float G[NUMX][NUMW],
+                             float Q[NUMW], float dT, float P[NUMX][NUMX]);
+void SerialUpdateRef(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+                     float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+                     uint16_t SensorsUsed);
+
+int8_t cf_update_ref(float attitude[4], float gyroBias[3], float accels_filtered[3], float grot_filtered[3],
+                     float gyro[3], float accel[3], float mag[3], bool useMag, float Be[3],
+                     float AccelKp, float AccelKi, float MagKp, float MagKi, float rollPitchBiasRate,
+                     float accel_alpha, bool accel_filter_enabled, float dT);
 }
 
 #define epsilon 0.00001f
@@ -108,3 +143,860 @@ TEST_F(MathTestRaw, y_on_curve1) {
     EXPECT_NEAR(-0.35f, y_on_curve(1.250f, points, length(points)), epsilon);
     EXPECT_NEAR(-0.50f, y_on_curve(2.000f, points, length(points)), epsilon);
 }
+
+// Filter matrices for a random but plausible state, P is symmetric positive definite
+class InsgpsTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(1234);
+        memset(F, 0, sizeof(F));
+        memset(G, 0, sizeof(G));
+        memset(H, 0, sizeof(H));
+
+        float U[NUMU];
+        for (int i = 0; i < NUMX; i++) {
+            X[i] = rnd(1.0f);
+        }
+        float qnorm = sqrtf(X[6] * X[6] + X[7] * X[7] + X[8] * X[8] + X[9] * X[9]);
+        for (int i = 6; i < 10; i++) {
+            X[i] /= qnorm;
+        }
+        for (int i = 10; i < NUMX; i++) {
+            X[i] *= 0.01f;
+        }
+        for (int i = 0; i < NUMU; i++) {
+            U[i] = rnd(i < 3 ? 2.0f : 10.0f);
+        }
+        float Be[3] = { 0.7f, 0.1f, 0.7f };
+        LinearizeFG(X, U, F, G);
+        LinearizeH(X, Be, H);
+
+        float A[NUMX][NUMX];
+        for (int i = 0; i < NUMX; i++) {
+            for (int j = 0; j < NUMX; j++) {
+                A[i][j] = rnd(0.1f);
+            }
+        }
+        for (int i = 0; i < NUMX; i++) {
+            for (int j = 0; j < NUMX; j++) {
+                P[i][j] = (i == j) ? 0.01f : 0.0f;
+                for (int k = 0; k < NUMX; k++) {
+                    P[i][j] += A[i][k] * A[j][k];
+                }
+            }
+        }
+
+        for (int i = 0; i < NUMW; i++) {
+            Q[i] = (i < 3) ? 50e-4f : (i < 6) ? 0.00001f : 2e-8f;
+        }
+        for (int i = 0; i < NUMV; i++) {
+            R[i] = 0.004f + rnd(0.002f);
+            Z[i] = rnd(1.0f);
+            Y[i] = Z[i] + rnd(0.1f);
+        }
+    }
+
+    static float rnd(float range)
+    {
+        return range * (2.0f * rand() / (float)RAND_MAX - 1.0f);
+    }
+
+    static void expect_near_matrix(float A[NUMX][NUMX], float B[NUMX][NUMX])
+    {
+        for (int i = 0; i < NUMX; i++) {
+            for (int j = 0; j < NUMX; j++) {
+                EXPECT_NEAR(A[i][j], B[i][j], 1e-5f * (fabsf(B[i][j]) + 1e-3f)) << "at " << i << "," << j;
+            }
+        }
+    }
+
+    float F[NUMX][NUMX];
+    float G[NUMX][NUMW];
+    float H[NUMV][NUMX];
+    float P[NUMX][NUMX];
+    float X[NUMX];
+    float Q[NUMW];
+    float R[NUMV];
+    float Z[NUMV];
+    float Y[NUMV];
+};
+
+TEST_F(InsgpsTest, CovariancePredictionMatchesReference) {
+    float Pref[NUMX][NUMX];
+
+    for (int step = 0; step < 100; step++) {
+        memcpy(Pref, P, sizeof(P));
+        CovariancePrediction(F, G, Q, 0.002f, P);
+        CovariancePredictionRef(F, G, Q, 0.002f, Pref);
+        expect_near_matrix(P, Pref);
+        memcpy(P, Pref, sizeof(P));
+    }
+}
+
+TEST_F(InsgpsTest, SerialUpdateMatchesReference) {
+    float Pref[NUMX][NUMX];
+    float Xref[NUMX];
+    const uint16_t sensors[] = { 0x3FF, 0x007, 0x018, 0x1C0, 0x200, 0x1F8 };
+
+    for (uint32_t n = 0; n < sizeof(sensors) / sizeof(sensors[0]); n++) {
+        SetUp();
+        memcpy(Pref, P, sizeof(P));
+        memcpy(Xref, X, sizeof(X));
+        SerialUpdate(H, R, Z, Y, P, X, sensors[n]);
+        SerialUpdateRef(H, R, Z, Y, Pref, Xref, sensors[n]);
+        expect_near_matrix(P, Pref);
+        for (int i = 0; i < NUMX; i++) {
+            EXPECT_NEAR(X[i], Xref[i], 1e-5f * (fabsf(Xref[i]) + 1e-3f)) << "sensors " << sensors[n] << " at " << i;
+        }
+    }
+}
+
+TEST_F(InsgpsTest, Benchmark) {
+    const int iterations = 20000;
+    float Pwork[NUMX][NUMX];
+    float Xwork[NUMX];
+    double ns[4];
+
+    for (int variant = 0; variant < 4; variant++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < iterations; n++) {
+            memcpy(Pwork, P, sizeof(P));
+            memcpy(Xwork, X, sizeof(X));
+            switch (variant) {
+            case 0:
+                CovariancePredictionRef(F, G, Q, 0.002f, Pwork);
+                break;
+            case 1:
+                CovariancePrediction(F, G, Q, 0.002f, Pwork);
+                break;
+            case 2:
+                SerialUpdateRef(H, R, Z, Y, Pwork, Xwork, 0x3FF);
+                break;
+            case 3:
+                SerialUpdate(H, R, Z, Y, Pwork, Xwork, 0x3FF);
+                break;
+            }
+        }
+        ns[variant] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+
+    printf("CovariancePrediction: %.0f ns reference, %.0f ns specialized\n", ns[0], ns[1]);
+    printf("SerialUpdate:         %.0f ns reference, %.0f ns specialized\n", ns[2], ns[3]);
+}
+
+// Accuracy bounds documented in fastmath.h, checked against the double precision libm
+class FastMathTest : public testing::Test {};
+
+TEST_F(FastMathTest, SinCos) {
+    double maxerr = 0;
+
+    for (float x = -2000.0f; x < 2000.0f; x += 0.00731f) {
+        float s, c;
+        fast_sincosf(x, &s, &c);
+        maxerr = fmax(maxerr, fabs(s - sin((double)x)));
+        maxerr = fmax(maxerr, fabs(c - cos((double)x)));
+        EXPECT_EQ(s, fast_sinf(x));
+        EXPECT_EQ(c, fast_cosf(x));
+    }
+    EXPECT_LT(maxerr, 1e-7);
+    EXPECT_EQ(0.0f, fast_sinf(0.0f));
+    EXPECT_EQ(1.0f, fast_cosf(0.0f));
+}
+
+TEST_F(FastMathTest, Atan2) {
+    double maxerr = 0;
+
+    for (float a = -3.2f; a < 3.2f; a += 0.0001f) {
+        for (float r = 0.001f; r < 1000.0f; r *= 11.0f) {
+            float y = r * sinf(a);
+            float x = r * cosf(a);
+            maxerr = fmax(maxerr, fabs(fast_atan2f(y, x) - atan2((double)y, (double)x)));
+        }
+    }
+    EXPECT_LT(maxerr, 3e-7);
+    EXPECT_EQ(0.0f, fast_atan2f(0.0f, 0.0f));
+    EXPECT_NEAR(M_PI / 2, fast_atan2f(1.0f, 0.0f), 1e-7);
+    EXPECT_NEAR(-M_PI / 2, fast_atan2f(-1.0f, 0.0f), 1e-7);
+    EXPECT_NEAR(M_PI, fast_atan2f(0.0f, -1.0f), 3e-7);
+}
+
+TEST_F(FastMathTest, Asin) {
+    double maxerr = 0;
+
+    for (float x = -1.0f; x <= 1.0f; x += 0.00001f) {
+        maxerr = fmax(maxerr, fabs(fast_asinf(x) - asin((double)x)));
+    }
+    EXPECT_LT(maxerr, 3e-7);
+    // rounding can push a rotation matrix element slightly out of range
+    EXPECT_NEAR(M_PI / 2, fast_asinf(1.0000001f), 1e-7);
+    EXPECT_NEAR(-M_PI / 2, fast_asinf(-1.0000001f), 1e-7);
+}
+
+TEST_F(FastMathTest, InvSqrt) {
+    for (float x = 1e-6f; x < 1e6f; x *= 1.001f) {
+        EXPECT_NEAR(1.0, fast_invsqrtf_accurate(x) * sqrt((double)x), 5e-6);
+    }
+
+    float q[4] = { 0.9f, -0.2f, 0.35f, 0.1f };
+    fast_quat_normalizef(q);
+    EXPECT_NEAR(1.0f, q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1e-5f);
+
+    float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    fast_quat_normalizef(zero);
+    EXPECT_EQ(0.0f, zero[0]);
+}
+
+TEST_F(FastMathTest, AttitudeRoundTrip) {
+    for (float roll = -179.0f; roll < 180.0f; roll += 13.0f) {
+        for (float pitch = -89.0f; pitch < 90.0f; pitch += 7.0f) {
+            for (float yaw = -179.0f; yaw < 180.0f; yaw += 17.0f) {
+                const float rpy[3] = { roll, pitch, yaw };
+                float q[4], R[3][3], rpyout[3];
+                RPY2Quaternion(rpy, q);
+                EXPECT_NEAR(1.0f, q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3], 1e-5f);
+
+                Quaternion2RPY(q, rpyout);
+                for (int i = 0; i < 3; i++) {
+                    EXPECT_NEAR(rpy[i], rpyout[i], 2e-3f);
+                }
+
+                // first row of Rbe is the body x axis in earth frame
+                const float ex[3] = { 1.0f, 0.0f, 0.0f };
+                float x[3], xb[3];
+                Quaternion2R(q, R);
+                rot_mult(R, ex, x);
+                Quaternion2xB(q, xb);
+                for (int i = 0; i < 3; i++) {
+                    EXPECT_NEAR(R[0][i], xb[i], 1e-6f);
+                    EXPECT_NEAR(R[i][0], x[i], 1e-6f);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(FastMathTest, Benchmark) {
+    const int iterations = 200000;
+    volatile float sink = 0;
+    double ns[6];
+
+    for (int variant = 0; variant < 6; variant++) {
+        float acc = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < iterations; n++) {
+            float x = (n - iterations / 2) * 0.0001f;
+            switch (variant) {
+            case 0:
+                acc += sinf(x) + cosf(x);
+                break;
+            case 1:
+            {
+                float s, c;
+                fast_sincosf(x, &s, &c);
+                acc += s + c;
+                break;
+            }
+            case 2:
+                acc += atan2f(x, 1.3f);
+                break;
+            case 3:
+                acc += fast_atan2f(x, 1.3f);
+                break;
+            case 4:
+                acc += 1.0f / sqrtf(x * x + 1.0f);
+                break;
+            case 5:
+                acc += fast_invsqrtf_accurate(x * x + 1.0f);
+                break;
+            }
+        }
+        sink = acc;
+        ns[variant] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+    (void)sink;
+
+    printf("sin+cos: %.1f ns libm, %.1f ns fast_sincosf\n", ns[0], ns[1]);
+    printf("atan2:   %.1f ns libm, %.1f ns fast_atan2f\n", ns[2], ns[3]);
+    printf("invsqrt: %.1f ns libm, %.1f ns fast_invsqrtf_accurate\n", ns[4], ns[5]);
+}
+
+// cf_update() against the filtercf.c code it replaced, on a board slowly
+// rotating with noisy sensors
+class ComplementaryFilterTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(4321);
+        memset(&state, 0, sizeof(state));
+        state.q[0] = 1.0f;
+        memcpy(refQ, state.q, sizeof(refQ));
+        memset(refBias, 0, sizeof(refBias));
+        memset(refAccels, 0, sizeof(refAccels));
+        memset(refGrot, 0, sizeof(refGrot));
+
+        float bmag = sqrtf(BeRaw[0] * BeRaw[0] + BeRaw[1] * BeRaw[1] + BeRaw[2] * BeRaw[2]);
+        for (int i = 0; i < 3; i++) {
+            Be[i] = BeRaw[i] / bmag;
+        }
+    }
+
+    static float rnd(float range)
+    {
+        return range * (2.0f * rand() / (float)RAND_MAX - 1.0f);
+    }
+
+    // sensor readings for step n of the test trajectory
+    void sample(int n, float gyro[3], float accel[3], float mag[3])
+    {
+        gyro[0] = 20.0f * sinf(n * 0.002f) + rnd(2.0f) + 1.5f;
+        gyro[1] = 15.0f * cosf(n * 0.003f) + rnd(2.0f) - 0.7f;
+        gyro[2] = 10.0f + rnd(2.0f);
+        float rpy[3] = { 10.0f * sinf(n * 0.002f), 5.0f * cosf(n * 0.003f), n * 0.025f };
+        float q[4];
+        float R[3][3];
+        float g[3] = { 0.0f, 0.0f, -9.81f };
+        RPY2Quaternion(rpy, q);
+        Quaternion2R(q, R);
+        rot_mult(R, g, accel);
+        rot_mult(R, BeRaw, mag);
+        for (int i = 0; i < 3; i++) {
+            accel[i] += rnd(0.5f);
+            mag[i]   += rnd(300.0f);
+        }
+    }
+
+    void run(const struct cf_gains *g, bool useMag, int steps)
+    {
+        for (int n = 0; n < steps; n++) {
+            float gyro[3], accel[3], mag[3];
+            sample(n, gyro, accel, mag);
+            bool magUpdated = useMag && (n % 4) == 0;
+
+            float gyroRef[3] = { gyro[0], gyro[1], gyro[2] };
+            float magRef[3]  = { mag[0], mag[1], mag[2] };
+            int8_t refResult = cf_update_ref(refQ, refBias, refAccels, refGrot, gyroRef, accel, magRef, magUpdated, BeRaw,
+                                             g->accelKp, g->accelKi, g->magKp, g->magKi, g->rollPitchBiasRate,
+                                             g->accelAlpha, g->accelFilter, 0.002f);
+            int8_t result    = cf_update(&state, g, gyro, accel, magUpdated ? mag : NULL, Be, 0.002f);
+
+            ASSERT_EQ(refResult, result) << "at step " << n;
+            for (int i = 0; i < 4; i++) {
+                ASSERT_NEAR(refQ[i], state.q[i], 1e-4f) << "q" << i << " at step " << n;
+            }
+            for (int i = 0; i < 3; i++) {
+                ASSERT_NEAR(refBias[i], state.gyroBias[i], 1e-3f) << "bias " << i << " at step " << n;
+                ASSERT_NEAR(gyroRef[i], gyro[i], 1e-3f) << "gyro " << i << " at step " << n;
+            }
+        }
+    }
+
+    struct cf_state state;
+    float refQ[4];
+    float refBias[3];
+    float refAccels[3];
+    float refGrot[3];
+    float BeRaw[3] = { 22000.0f, 1000.0f, 42000.0f };
+    float Be[3];
+};
+
+TEST_F(ComplementaryFilterTest, CalibrationGainsMatchReference) {
+    const struct cf_gains g = { 1.0f, 0.0f, 1.0f, 0.0f, 0.01f, 0.0f, 1.0f, false };
+
+    run(&g, true, 2000);
+}
+
+TEST_F(ComplementaryFilterTest, FlightGainsMatchReference) {
+    const struct cf_gains g = { 0.05f, 0.0001f, 0.01f, 0.0001f, 0.0f, 0.9f, 0.1f, true };
+
+    run(&g, true, 2000);
+}
+
+TEST_F(ComplementaryFilterTest, WithoutMagMatchesReference) {
+    const struct cf_gains g = { 0.05f, 0.0001f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, false };
+
+    run(&g, false, 2000);
+}
+
+TEST_F(ComplementaryFilterTest, ShortAccelIsRejected) {
+    const struct cf_gains g = { 0.05f, 0.0001f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, false };
+    float gyro[3]  = { 0.0f, 0.0f, 0.0f };
+    float accel[3] = { 0.0f, 0.0f, 0.0f };
+
+    EXPECT_EQ(CF_RESULT_VECTOR_TOO_SHORT, cf_update(&state, &g, gyro, accel, NULL, Be, 0.002f));
+    EXPECT_EQ(1.0f, state.q[0]);
+}
+
+TEST_F(ComplementaryFilterTest, Benchmark) {
+    const struct cf_gains g = { 0.05f, 0.0001f, 0.01f, 0.0001f, 0.0f, 0.9f, 0.1f, true };
+    const int iterations    = 200000;
+    const int samples = 64;
+    float gyro[samples][3], accel[samples][3], mag[samples][3];
+    double ns[2];
+
+    for (int n = 0; n < samples; n++) {
+        sample(n, gyro[n], accel[n], mag[n]);
+    }
+    for (int variant = 0; variant < 2; variant++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < iterations; n++) {
+            int k = n % samples;
+            float gyrotmp[3] = { gyro[k][0], gyro[k][1], gyro[k][2] };
+            float magtmp[3]  = { mag[k][0], mag[k][1], mag[k][2] };
+            if (variant == 0) {
+                cf_update_ref(refQ, refBias, refAccels, refGrot, gyrotmp, accel[k], magtmp, true, BeRaw,
+                              g.accelKp, g.accelKi, g.magKp, g.magKi, g.rollPitchBiasRate,
+                              g.accelAlpha, g.accelFilter, 0.002f);
+            } else {
+                cf_update(&state, &g, gyrotmp, accel[k], magtmp, Be, 0.002f);
+            }
+        }
+        ns[variant] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+
+    printf("complementary filter update: %.1f ns reference, %.1f ns cf_update\n", ns[0], ns[1]);
+}
+
+// The 13 and 16 state filters driven with the same sensor data of a vehicle
+// sitting still at a tilted attitude, as filterekf.c runs them
+class Insgps16Test : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        float rpy[3] = { 10.0f, -5.0f, 30.0f };
+        float R[3][3];
+        float g[3]   = { 0.0f, 0.0f, -9.81f };
+
+        RPY2Quaternion(rpy, q);
+        Quaternion2R(q, R);
+        rot_mult(R, g, accel);
+        rot_mult(R, Be, mag);
+
+        INSGPSInit();
+        INSSetMagNorth(Be);
+        INSSetState(zeros, zeros, q, zeros, zeros);
+        INS16GPSInit();
+        INS16SetMagNorth(Be);
+        INS16SetState(zeros, zeros, q, zeros, zeros);
+    }
+
+    void step13(uint16_t sensors)
+    {
+        INSStatePrediction(gyro, accel, 0.002f);
+        INSCovariancePrediction(0.002f);
+        INSCorrection(mag, zeros, zeros, 0.0f, sensors);
+    }
+
+    void step16(uint16_t sensors)
+    {
+        INS16StatePrediction(gyro, accel, 0.002f);
+        INS16CovariancePrediction(0.002f);
+        INS16Correction(mag, zeros, zeros, 0.0f, sensors);
+    }
+
+    float Be[3]    = { 22000.0f, 1000.0f, 42000.0f };
+    float zeros[3] = { 0.0f, 0.0f, 0.0f };
+    float gyro[3]  = { 0.0f, 0.0f, 0.0f };
+    float accel[3];
+    float mag[3];
+    float q[4];
+};
+
+TEST_F(Insgps16Test, HoldsAttitudeLikeIns13) {
+    const uint16_t sensors[] = { MAG_SENSORS, POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR, FULL_SENSORS };
+
+    for (uint32_t n = 0; n < sizeof(sensors) / sizeof(sensors[0]); n++) {
+        SetUp();
+        for (int i = 0; i < 2000; i++) {
+            step13(sensors[n]);
+            step16(sensors[n]);
+        }
+        for (int i = 0; i < 4; i++) {
+            EXPECT_NEAR(q[i], Nav16.q[i], 2e-3f) << "sensors " << sensors[n] << " q" << i;
+            EXPECT_NEAR(Nav.q[i], Nav16.q[i], 2e-3f) << "sensors " << sensors[n] << " q" << i;
+        }
+        for (int i = 0; i < 3; i++) {
+            EXPECT_NEAR(0.0f, Nav16.Pos[i], 0.05f) << "sensors " << sensors[n] << " pos" << i;
+        }
+
+        float P16[16];
+        INS16GetP(P16);
+        for (int i = 0; i < 16; i++) {
+            EXPECT_TRUE(IS_REAL(P16[i]) && P16[i] > 0.0f) << "sensors " << sensors[n] << " P" << i << " " << P16[i];
+        }
+    }
+}
+
+TEST_F(Insgps16Test, Benchmark) {
+    const int iterations     = 20000;
+    const uint16_t sensors[] = { MAG_SENSORS, POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS | BARO_SENSOR, FULL_SENSORS };
+    const char *names[]      = { "mag", "gps+baro", "full" };
+
+    for (uint32_t n = 0; n < sizeof(sensors) / sizeof(sensors[0]); n++) {
+        double ns[2];
+        for (int variant = 0; variant < 2; variant++) {
+            SetUp();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                if (variant == 0) {
+                    step13(sensors[n]);
+                } else {
+                    step16(sensors[n]);
+                }
+            }
+            ns[variant] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+        }
+        printf("INS step with %-8s correction: %.0f ns 13 state, %.0f ns 16 state\n", names[n], ns[0], ns[1]);
+    }
+}
+
+// The FFT against a direct DFT, and two real signals separated from one transform
+class FftTest : public testing::Test {
+protected:
+    static const uint16_t N = 512;
+
+    void dft(const float *x, uint16_t k, double X[2])
+    {
+        X[0] = X[1] = 0.0;
+        for (uint16_t t = 0; t < N; t++) {
+            double a = -2.0 * M_PI * k * t / N;
+            X[0] += x[t] * cos(a);
+            X[1] += x[t] * sin(a);
+        }
+    }
+
+    void fill(float *a, float *b)
+    {
+        for (uint16_t t = 0; t < N; t++) {
+            a[t] = sinf(2.0f * (float)M_PI * 12.3f * t / N) + 0.3f * cosf(2.0f * (float)M_PI * 70.0f * t / N) + 0.1f;
+            b[t] = (((t * 37) / 20) % 2) ? 0.5f : -0.5f;
+        }
+    }
+};
+
+TEST_F(FftTest, MatchesDft) {
+    float re[N], im[N];
+    float a[N];
+
+    fill(a, im);
+    memcpy(re, a, sizeof(re));
+    memset(im, 0, sizeof(im));
+    fft_complex(re, im, N);
+
+    for (uint16_t k = 0; k < N; k++) {
+        double X[2];
+        dft(a, k, X);
+        EXPECT_NEAR(X[0], re[k], 2e-3) << "bin " << k;
+        EXPECT_NEAR(X[1], im[k], 2e-3) << "bin " << k;
+    }
+}
+
+TEST_F(FftTest, SplitsRealPair) {
+    float re[N], im[N];
+    float a[N], b[N];
+
+    fill(a, b);
+    memcpy(re, a, sizeof(re));
+    memcpy(im, b, sizeof(im));
+    fft_complex(re, im, N);
+
+    for (uint16_t k = 0; k < N / 2; k++) {
+        float X[2], Y[2];
+        double Xr[2], Yr[2];
+        fft_split_real_pair(re, im, N, k, X, Y);
+        dft(a, k, Xr);
+        dft(b, k, Yr);
+        EXPECT_NEAR(Xr[0], X[0], 2e-3) << "bin " << k;
+        EXPECT_NEAR(Xr[1], X[1], 2e-3) << "bin " << k;
+        EXPECT_NEAR(Yr[0], Y[0], 2e-3) << "bin " << k;
+        EXPECT_NEAR(Yr[1], Y[1], 2e-3) << "bin " << k;
+    }
+}
+
+TEST_F(FftTest, Benchmark) {
+    const int iterations = 2000;
+    float re[N], im[N];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fill(re, im);
+        fft_complex(re, im, N);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("%u point FFT of two real signals (including fill): %.0f ns\n", N, ns);
+}
+
+// Frequency response of the filter bank, measured on a sine after settling
+class BiquadTest : public testing::Test {
+protected:
+    static constexpr float rate = 1000.0f;
+
+    // amplitude of the output over the input for a sine of frequency f on all axes
+    float response(struct biquad_bank *bank, float f)
+    {
+        float peak = 0.0f;
+        float x[3] = { 0.0f, 0.0f, 0.0f };
+
+        biquad_bank_reset(bank, x);
+        for (int t = 0; t < 4000; t++) {
+            float v = sinf(2.0f * (float)M_PI * f * t / rate);
+            x[0] = v;
+            x[1] = -v;
+            x[2] = 2.0f * v;
+            biquad_bank_apply(bank, x);
+            EXPECT_FLOAT_EQ(-x[0], x[1]);
+            EXPECT_FLOAT_EQ(2.0f * x[0], x[2]);
+            if (t >= 2000) {
+                peak = fmaxf(peak, fabsf(x[0]));
+            }
+        }
+        return peak;
+    }
+};
+
+TEST_F(BiquadTest, LowPass) {
+    struct biquad_bank bank;
+    struct biquad_coeffs c;
+
+    biquad_bank_clear(&bank);
+    biquad_lowpass(&c, 50.0f / rate);
+    ASSERT_TRUE(biquad_bank_add(&bank, &c));
+
+    EXPECT_NEAR(1.0f, response(&bank, 2.0f), 0.01f);
+    EXPECT_NEAR(M_SQRT1_2, response(&bank, 50.0f), 0.01f);
+    EXPECT_GT(0.03f, response(&bank, 300.0f));
+}
+
+TEST_F(BiquadTest, NotchAndLowPass) {
+    struct biquad_bank bank;
+    struct biquad_coeffs c;
+
+    biquad_bank_clear(&bank);
+    biquad_notch(&c, 120.0f / rate, 20.0f / rate);
+    ASSERT_TRUE(biquad_bank_add(&bank, &c));
+    biquad_lowpass(&c, 300.0f / rate);
+    ASSERT_TRUE(biquad_bank_add(&bank, &c));
+    EXPECT_FALSE(biquad_bank_add(&bank, &c));
+
+    EXPECT_GT(0.02f, response(&bank, 120.0f));
+    EXPECT_NEAR(1.0f, response(&bank, 20.0f), 0.02f);
+    EXPECT_NEAR(1.0f, response(&bank, 60.0f), 0.05f);
+}
+
+TEST_F(BiquadTest, ResetStartsAtSteadyState) {
+    struct biquad_bank bank;
+    struct biquad_coeffs c;
+    const float x0[3] = { 1.0f, -9.81f, 250.0f };
+
+    biquad_bank_clear(&bank);
+    biquad_notch(&c, 80.0f / rate, 10.0f / rate);
+    biquad_bank_add(&bank, &c);
+    biquad_lowpass(&c, 30.0f / rate);
+    biquad_bank_add(&bank, &c);
+    biquad_bank_reset(&bank, x0);
+
+    for (int t = 0; t < 100; t++) {
+        float x[3] = { x0[0], x0[1], x0[2] };
+        biquad_bank_apply(&bank, x);
+        for (int i = 0; i < 3; i++) {
+            EXPECT_NEAR(x0[i], x[i], 1e-4f * fabsf(x0[i]));
+        }
+    }
+}
+
+TEST_F(BiquadTest, Benchmark) {
+    const int iterations = 1000000;
+    struct biquad_bank bank;
+    struct biquad_coeffs c;
+    float x[3] = { 0.0f, 0.0f, 0.0f };
+
+    biquad_bank_clear(&bank);
+    biquad_notch(&c, 120.0f / rate, 20.0f / rate);
+    biquad_bank_add(&bank, &c);
+    biquad_lowpass(&c, 100.0f / rate);
+    biquad_bank_add(&bank, &c);
+    biquad_bank_reset(&bank, x);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        x[0] += 0.1f;
+        x[1] -= 0.1f;
+        x[2] += 0.2f;
+        biquad_bank_apply(&bank, x);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("Notch and low pass on three axes: %.1f ns per sample (%f)\n", ns, x[0]);
+}
+
+class MagBiasTest : public testing::Test {
+protected:
+    static constexpr float field = 500.0f;
+    unsigned int seed;
+
+    virtual void SetUp()
+    {
+        seed = 12345;
+    }
+
+    float uniform()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+    }
+
+    // a field sample in a random direction, offset by bias, with 1% noise
+    void sample(const float bias[3], float mag[3])
+    {
+        float v[3], len;
+
+        do {
+            v[0] = uniform();
+            v[1] = uniform();
+            v[2] = uniform();
+            len  = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        } while (len < 0.1f || len > 1.0f);
+        for (int i = 0; i < 3; i++) {
+            mag[i] = v[i] / len * field + bias[i] + 0.01f * field * uniform();
+        }
+    }
+};
+
+TEST_F(MagBiasTest, ConvergesToBias) {
+    struct magbias_fit fit;
+    const float bias[3] = { 60.0f, -35.0f, 120.0f };
+    float mag[3];
+    int published = -1;
+
+    magbias_init(&fit, field, 0.001f);
+    for (int t = 0; t < 5000 && published < 0; t++) {
+        sample(bias, mag);
+        if (magbias_update(&fit, mag)) {
+            published = t;
+        }
+    }
+    ASSERT_LE(0, published);
+    printf("Bias published after %d samples\n", published);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(bias[i], fit.stableBias[i], 0.02f * field);
+    }
+}
+
+TEST_F(MagBiasTest, StillSamplesAreNotPublished) {
+    struct magbias_fit fit;
+    const float mag[3] = { 300.0f, 0.0f, 400.0f };
+
+    magbias_init(&fit, field, 0.001f);
+    for (int t = 0; t < 10000; t++) {
+        EXPECT_FALSE(magbias_update(&fit, mag));
+    }
+    EXPECT_FALSE(fit.published);
+}
+
+TEST_F(MagBiasTest, Benchmark) {
+    const int iterations = 1000000;
+    struct magbias_fit fit;
+    const float bias[3] = { 60.0f, -35.0f, 120.0f };
+    float mags[64][3];
+
+    for (int i = 0; i < 64; i++) {
+        sample(bias, mags[i]);
+    }
+    magbias_init(&fit, field, 0.001f);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        magbias_update(&fit, mags[i & 63]);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("Sphere fit update: %.1f ns per sample (%f)\n", ns, fit.bias[0]);
+}
+
+// The single precision tangent plane against the double precision ECEF path
+class LocalTangentPlaneTest : public testing::Test {
+protected:
+    // worst horizontal and vertical difference over points up to range meters from the base
+    void compare(int32_t base[3], float range, float *horizontal, float *vertical)
+    {
+        LocalTangentPlane ltp;
+        double baseECEF[3];
+        float Rne[3][3];
+
+        LTPFromLLA(base, &ltp);
+        LLA2ECEF(base, baseECEF);
+        RneFromLLA(base, Rne);
+
+        *horizontal = 0.0f;
+        *vertical   = 0.0f;
+        // about 1e-7 degree of latitude per centimeter
+        const int32_t steps = (int32_t)(range * 9.0f);
+        for (int32_t i = -4; i <= 4; i++) {
+            for (int32_t j = -4; j <= 4; j++) {
+                int32_t LLAi[3] = { base[0] + i * steps / 4, base[1] + j * steps / 4, base[2] + (i - j) * 250000 };
+                float ref[3], ned[3];
+                LLA2Base(LLAi, baseECEF, Rne, ref);
+                LLA2LTP(LLAi, &ltp, ned);
+                *horizontal = fmaxf(*horizontal, sqrtf((ned[0] - ref[0]) * (ned[0] - ref[0]) + (ned[1] - ref[1]) * (ned[1] - ref[1])));
+                *vertical   = fmaxf(*vertical, fabsf(ned[2] - ref[2]));
+            }
+        }
+    }
+};
+
+TEST_F(LocalTangentPlaneTest, MatchesEcefWithinMissionRange) {
+    int32_t bases[][3] = {
+        { 0,          0,           0       },
+        { 475000000,  85000000,    4500000 },
+        { -338000000, 1512000000,  500000  },
+        { 650000000,  -1500000000, 1000000 },
+    };
+
+    for (unsigned int b = 0; b < sizeof(bases) / sizeof(bases[0]); b++) {
+        float horizontal, vertical;
+        compare(bases[b], 10000.0f, &horizontal, &vertical);
+        // the reference itself rounds the ECEF difference to float
+        EXPECT_GT(0.01f, horizontal) << "base " << b;
+        EXPECT_GT(0.01f, vertical) << "base " << b;
+    }
+}
+
+TEST_F(LocalTangentPlaneTest, AcrossTheAntimeridian) {
+    int32_t base[3] = { 200000000, 1799990000, 0 };
+    int32_t east[3] = { 200000000, -1799990000, 0 };
+    LocalTangentPlane ltp;
+    float ned[3];
+
+    LTPFromLLA(base, &ltp);
+    LLA2LTP(east, &ltp, ned);
+    EXPECT_NEAR(2.0f * 0.001f * 111320.0f * cosf(DEG2RAD(20.0f)), ned[1], 5.0f);
+}
+
+TEST_F(LocalTangentPlaneTest, Benchmark) {
+    const int iterations = 1000000;
+    int32_t base[3] = { 475000000, 85000000, 4500000 };
+    LocalTangentPlane ltp;
+    double baseECEF[3];
+    float Rne[3][3];
+    float ned[3] = { 0.0f, 0.0f, 0.0f };
+    float sum = 0.0f;
+
+    LTPFromLLA(base, &ltp);
+    LLA2ECEF(base, baseECEF);
+    RneFromLLA(base, Rne);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        int32_t LLAi[3] = { base[0] + (i & 1023), base[1] - (i & 511), base[2] + i };
+        LLA2Base(LLAi, baseECEF, Rne, ned);
+        sum += ned[0];
+    }
+    double nsEcef = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        int32_t LLAi[3] = { base[0] + (i & 1023), base[1] - (i & 511), base[2] + i };
+        LLA2LTP(LLAi, &ltp, ned);
+        sum += ned[0];
+    }
+    double nsLtp = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("LLA to NED: ECEF %.1f ns, tangent plane %.1f ns (%f)\n", nsEcef, nsLtp, sum);
+}
@@ -0,0 +1,9 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdint.h>
+
+/* Same code as the RFM22B boards */
+#define RS_ECC_NPARITY 4
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,136 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memcpy */
+#include <chrono>
+
+extern "C" {
+#include "ecc.h"
+
+extern int genPoly[];
+}
+
+// the RFM22B packets are at most 64 bytes, parity included
+#define PACKET_LEN 64
+#define DATA_LEN   (PACKET_LEN - RS_ECC_NPARITY)
+
+// To use a test fixture, derive a class from testing::Test.
+class RscodeTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        initialize_ecc();
+        srand(42);
+        for (int i = 0; i < DATA_LEN; i++) {
+            msg[i] = rand();
+        }
+    }
+
+    // the original bytewise LFSR with a multiplication per generator coefficient
+    void EncodeRef(const unsigned char *data, int nbytes, unsigned char *parity)
+    {
+        int LFSR[RS_ECC_NPARITY] = { 0 };
+
+        for (int i = 0; i < nbytes; i++) {
+            int dbyte = data[i] ^ LFSR[RS_ECC_NPARITY - 1];
+            for (int j = RS_ECC_NPARITY - 1; j > 0; j--) {
+                LFSR[j] = LFSR[j - 1] ^ gmult(genPoly[j], dbyte);
+            }
+            LFSR[0] = gmult(genPoly[0], dbyte);
+        }
+        for (int i = 0; i < RS_ECC_NPARITY; i++) {
+            parity[i] = LFSR[RS_ECC_NPARITY - 1 - i];
+        }
+    }
+
+    unsigned char msg[DATA_LEN];
+};
+
+TEST_F(RscodeTest, EncodeMatchesReference) {
+    unsigned char codeword[PACKET_LEN];
+    unsigned char parity[RS_ECC_NPARITY];
+
+    for (int len = 1; len <= DATA_LEN; len++) {
+        encode_data(msg, len, codeword);
+        EncodeRef(msg, len, parity);
+        EXPECT_EQ(0, memcmp(codeword, msg, len));
+        EXPECT_EQ(0, memcmp(&codeword[len], parity, RS_ECC_NPARITY)) << "length " << len;
+    }
+}
+
+TEST_F(RscodeTest, CleanCodeword) {
+    unsigned char codeword[PACKET_LEN];
+
+    encode_data(msg, DATA_LEN, codeword);
+    decode_data(codeword, PACKET_LEN);
+    EXPECT_EQ(0, check_syndrome());
+
+    // nothing to correct, the codeword is left untouched
+    EXPECT_EQ(0, correct_errors_erasures(codeword, PACKET_LEN, 0, 0));
+    EXPECT_EQ(0, memcmp(codeword, msg, DATA_LEN));
+}
+
+TEST_F(RscodeTest, CorrectOneError) {
+    unsigned char codeword[PACKET_LEN];
+    unsigned char received[PACKET_LEN];
+
+    encode_data(msg, DATA_LEN, codeword);
+    for (int pos = 0; pos < PACKET_LEN; pos++) {
+        memcpy(received, codeword, PACKET_LEN);
+        received[pos] ^= 1 + (pos * 37) % 255;
+        decode_data(received, PACKET_LEN);
+        EXPECT_NE(0, check_syndrome());
+        EXPECT_EQ(1, correct_errors_erasures(received, PACKET_LEN, 0, 0)) << "position " << pos;
+        EXPECT_EQ(0, memcmp(received, codeword, PACKET_LEN)) << "position " << pos;
+    }
+}
+
+TEST_F(RscodeTest, CorrectTwoErrors) {
+    unsigned char codeword[PACKET_LEN];
+    unsigned char received[PACKET_LEN];
+
+    encode_data(msg, DATA_LEN, codeword);
+    for (int pos1 = 0; pos1 < PACKET_LEN; pos1++) {
+        for (int pos2 = pos1 + 1; pos2 < PACKET_LEN; pos2 += 3) {
+            memcpy(received, codeword, PACKET_LEN);
+            received[pos1] ^= 0xA5;
+            received[pos2] ^= 1 + pos2;
+            decode_data(received, PACKET_LEN);
+            EXPECT_EQ(1, correct_errors_erasures(received, PACKET_LEN, 0, 0));
+            EXPECT_EQ(0, memcmp(received, codeword, PACKET_LEN)) << "positions " << pos1 << " " << pos2;
+        }
+    }
+}
+
+TEST_F(RscodeTest, Benchmark) {
+    const int iterations = 50000;
+    unsigned char codeword[PACKET_LEN];
+    unsigned char received[PACKET_LEN];
+    double rate[3];
+
+    encode_data(msg, DATA_LEN, codeword);
+    for (int variant = 0; variant < 3; variant++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int n = 0; n < iterations; n++) {
+            switch (variant) {
+            case 0:
+                encode_data(msg, DATA_LEN, received);
+                break;
+            case 1:
+                decode_data(codeword, PACKET_LEN);
+                ASSERT_EQ(0, check_syndrome());
+                break;
+            case 2:
+                memcpy(received, codeword, PACKET_LEN);
+                received[n % PACKET_LEN] ^= 0x5A;
+                decode_data(received, PACKET_LEN);
+                ASSERT_EQ(1, correct_errors_erasures(received, PACKET_LEN, 0, 0));
+                break;
+            }
+        }
+        rate[variant] = iterations / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    printf("%d byte packets: %.0f encoded/s, %.0f clean decoded/s, %.0f corrected/s\n", PACKET_LEN, rate[0], rate[1], rate[2]);
+}
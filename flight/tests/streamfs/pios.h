@@ -0,0 +1,18 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* PIOS Feature Selection */
+#include "pios_config.h"
+
+#ifdef PIOS_INCLUDE_FREERTOS
+/* FreeRTOS Includes */
+#include "FreeRTOS.h"
+#endif
+#include "pios_mem.h"
+#include <pios_helpers.h>
+#ifdef PIOS_INCLUDE_FLASH
+#include <pios_flash.h>
+#include <pios_streamfs.h>
+#endif
+
+#endif /* PIOS_H */
@@ -0,0 +1,9 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+/* Enable/Disable PiOS modules */
+#define PIOS_INCLUDE_FLASH
+// #define PIOS_STREAMFS_MAX_DEVS 5
+#define PIOS_INCLUDE_FREERTOS
+
+#endif /* PIOS_CONFIG_H */
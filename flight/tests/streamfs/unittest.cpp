@@ -0,0 +1,272 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+
+extern "C" {
+#include "pios_flash.h" /* PIOS_FLASH_* API */
+#include "pios_flash_ut_priv.h"
+
+extern struct pios_flash_ut_cfg flash_config;
+
+#include "pios_streamfs.h" /* PIOS_STREAMFS_* */
+
+extern struct streamfs_cfg streamfs_config;
+}
+
+#define REC_SIZE    211 // odd size, exercises the record padding
+#define REC_MAX     (0x00010000 - 8 - 2) // a whole sector minus headers
+
+// To use a test fixture, derive a class from testing::Test.
+class StreamfsTestRaw : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        /* create an empty, appropriately sized flash image */
+        FILE *theflash = fopen(FLASH_IMAGE_FILE, "wb");
+        uint8_t sector[flash_config.size_of_sector];
+
+        memset(sector, 0xFF, sizeof(sector));
+        for (uint32_t i = 0; i < flash_config.size_of_flash / flash_config.size_of_sector; i++) {
+            fwrite(sector, sizeof(sector), 1, theflash);
+        }
+        fclose(theflash);
+    }
+
+    virtual void TearDown()
+    {
+        unlink("theflash.bin");
+    }
+
+    /* Fill a record with a pattern that identifies it */
+    static void make_record(uint8_t *rec, uint32_t num)
+    {
+        memcpy(rec, &num, sizeof(num));
+        for (uint32_t i = sizeof(num); i < REC_SIZE; i++) {
+            rec[i] = (uint8_t)(num + i);
+        }
+    }
+};
+
+TEST_F(StreamfsTestRaw, StreamfsInit) {
+    uintptr_t flash_id;
+
+    EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+
+    uintptr_t fs_id;
+    EXPECT_EQ(0, PIOS_STREAMFS_Init(&fs_id, &streamfs_config, &pios_ut_flash_driver, flash_id));
+    EXPECT_EQ(0, PIOS_STREAMFS_Destroy(fs_id));
+    PIOS_Flash_UT_Destroy(flash_id);
+}
+
+class StreamfsTestCooked : public StreamfsTestRaw {
+protected:
+    virtual void SetUp()
+    {
+        /* First, we need to set up the super fixture (StreamfsTestRaw) */
+        StreamfsTestRaw::SetUp();
+
+        /* Init the flash and the stream so we don't need to repeat this in every test */
+        EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+        EXPECT_EQ(0, PIOS_STREAMFS_Init(&fs_id, &streamfs_config, &pios_ut_flash_driver, flash_id));
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_STREAMFS_Destroy(fs_id);
+        PIOS_Flash_UT_Destroy(flash_id);
+    }
+
+    void remount()
+    {
+        EXPECT_EQ(0, PIOS_STREAMFS_Destroy(fs_id));
+        EXPECT_EQ(0, PIOS_STREAMFS_Init(&fs_id, &streamfs_config, &pios_ut_flash_driver, flash_id));
+    }
+
+    void append(uint32_t first, uint32_t count)
+    {
+        uint8_t rec[REC_SIZE];
+
+        for (uint32_t num = first; num < first + count; num++) {
+            make_record(rec, num);
+            ASSERT_EQ(0, PIOS_STREAMFS_Append(fs_id, rec, sizeof(rec)));
+        }
+    }
+
+    /* Read records back from the oldest one, check they are consecutive and return how many there were */
+    uint32_t read_all(uint32_t *first)
+    {
+        uint8_t rec[REC_SIZE];
+        uint8_t check[REC_SIZE];
+        uint32_t cursor = PIOS_STREAMFS_CURSOR_START;
+        uint32_t count  = 0;
+        int32_t rc;
+
+        while ((rc = PIOS_STREAMFS_ReadRecord(fs_id, &cursor, rec, sizeof(rec))) >= 0) {
+            EXPECT_EQ(REC_SIZE, rc);
+            uint32_t num;
+            memcpy(&num, rec, sizeof(num));
+            if (count == 0) {
+                *first = num;
+            }
+            EXPECT_EQ(*first + count, num);
+            make_record(check, num);
+            EXPECT_EQ(0, memcmp(rec, check, sizeof(rec)));
+            count++;
+        }
+        EXPECT_EQ(-3, rc);
+        return count;
+    }
+
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+};
+
+TEST_F(StreamfsTestCooked, BadIdFormat) {
+    EXPECT_EQ(-1, PIOS_STREAMFS_Format(fs_id + 1));
+}
+
+TEST_F(StreamfsTestCooked, BadIdAppend) {
+    uint8_t rec[REC_SIZE];
+
+    make_record(rec, 0);
+    EXPECT_EQ(-1, PIOS_STREAMFS_Append(fs_id + 1, rec, sizeof(rec)));
+}
+
+TEST_F(StreamfsTestCooked, BadIdRead) {
+    uint8_t rec[REC_SIZE];
+    uint32_t cursor = PIOS_STREAMFS_CURSOR_START;
+
+    EXPECT_EQ(-1, PIOS_STREAMFS_ReadRecord(fs_id + 1, &cursor, rec, sizeof(rec)));
+}
+
+TEST_F(StreamfsTestCooked, EmptyStream) {
+    struct PIOS_STREAMFS_Stats stats;
+    uint8_t rec[REC_SIZE];
+    uint32_t cursor = PIOS_STREAMFS_CURSOR_START;
+
+    EXPECT_EQ(-3, PIOS_STREAMFS_ReadRecord(fs_id, &cursor, rec, sizeof(rec)));
+    EXPECT_EQ(0, PIOS_STREAMFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(streamfs_config.total_fs_size, stats.used_bytes + stats.free_bytes);
+    EXPECT_GT(0x100u, stats.used_bytes);
+}
+
+TEST_F(StreamfsTestCooked, RecordTooLarge) {
+    static uint8_t rec[REC_MAX + 1];
+
+    EXPECT_EQ(-3, PIOS_STREAMFS_Append(fs_id, rec, sizeof(rec)));
+    EXPECT_EQ(0, PIOS_STREAMFS_Append(fs_id, rec, REC_MAX));
+}
+
+TEST_F(StreamfsTestCooked, ReadVisibleAfterFlush) {
+    uint32_t first;
+
+    append(0, 1);
+    /* still buffered in RAM */
+    EXPECT_EQ(0u, read_all(&first));
+
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    EXPECT_EQ(1u, read_all(&first));
+    EXPECT_EQ(0u, first);
+}
+
+TEST_F(StreamfsTestCooked, AppendAndReadBack) {
+    uint32_t first;
+
+    /* spans several pages and the first sector boundary */
+    append(0, 400);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    EXPECT_EQ(400u, read_all(&first));
+    EXPECT_EQ(0u, first);
+}
+
+TEST_F(StreamfsTestCooked, ResumeAfterRemount) {
+    uint32_t first;
+
+    append(0, 10);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    remount();
+    EXPECT_EQ(10u, read_all(&first));
+
+    /* appending continues on the next page, in order */
+    append(10, 10);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    EXPECT_EQ(20u, read_all(&first));
+
+    /* interleave some more partial flushes */
+    append(20, 1);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    append(21, 1);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    remount();
+    append(22, 400);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    remount();
+    EXPECT_EQ(422u, read_all(&first));
+    EXPECT_EQ(0u, first);
+}
+
+TEST_F(StreamfsTestCooked, WrapAround) {
+    struct PIOS_STREAMFS_Stats stats;
+    uint32_t first;
+    uint32_t total = 5000; /* about four times the size of the stream */
+
+    /* write several times the size of the stream, with and without erase ahead */
+    for (uint32_t num = 0; num < total; num += 100) {
+        append(num, 100);
+        if (num % 300 == 0) {
+            EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+        }
+    }
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+
+    uint32_t count = read_all(&first);
+    EXPECT_EQ(total, first + count);
+    /* at least all but the recycled sector and the one erased ahead are kept */
+    EXPECT_LT(2 * streamfs_config.sector_size / (REC_SIZE + 1), count);
+
+    EXPECT_EQ(0, PIOS_STREAMFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(streamfs_config.total_fs_size, stats.used_bytes + stats.free_bytes);
+
+    remount();
+    uint32_t first_again;
+    EXPECT_EQ(count, read_all(&first_again));
+    EXPECT_EQ(first, first_again);
+}
+
+TEST_F(StreamfsTestCooked, FormatErasesStream) {
+    uint32_t first;
+
+    append(0, 400);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    EXPECT_EQ(0, PIOS_STREAMFS_Format(fs_id));
+    EXPECT_EQ(0u, read_all(&first));
+    remount();
+    EXPECT_EQ(0u, read_all(&first));
+
+    append(1000, 5);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+    EXPECT_EQ(5u, read_all(&first));
+    EXPECT_EQ(1000u, first);
+}
+
+TEST_F(StreamfsTestCooked, ReadSector) {
+    uint8_t rec[REC_SIZE];
+    uint8_t check[REC_SIZE];
+    uint16_t len;
+
+    append(0, 1);
+    EXPECT_EQ(0, PIOS_STREAMFS_Flush(fs_id));
+
+    /* first record follows the 8 byte sector header */
+    EXPECT_EQ(0, PIOS_STREAMFS_ReadSector(fs_id, 0, 8, (uint8_t *)&len, sizeof(len)));
+    EXPECT_EQ(REC_SIZE, len);
+    EXPECT_EQ(0, PIOS_STREAMFS_ReadSector(fs_id, 0, 10, rec, sizeof(rec)));
+    make_record(check, 0);
+    EXPECT_EQ(0, memcmp(rec, check, sizeof(rec)));
+
+    /* only one sector in use so far */
+    EXPECT_EQ(-3, PIOS_STREAMFS_ReadSector(fs_id, 1, 0, rec, sizeof(rec)));
+    EXPECT_EQ(-3, PIOS_STREAMFS_ReadSector(fs_id, 0, streamfs_config.sector_size - 1, rec, 2));
+}
@@ -0,0 +1,23 @@
+/*
+ * These need to be defined in a .c file so that we can use
+ * designated initializer syntax which c++ doesn't support (yet).
+ */
+
+#include "pios_flash_ut_priv.h"
+
+
+const struct pios_flash_ut_cfg flash_config = {
+    .size_of_flash  = 0x00080000,
+    .size_of_sector = 0x00010000,
+};
+
+#include "pios_streamfs.h"
+
+const struct streamfs_cfg streamfs_config = {
+    .fs_magic      = 0x3bb141cf,
+    .total_fs_size = 0x00040000, /* 256K bytes (4 sectors) */
+
+    .start_offset  = 0x00010000, /* leave the first sector alone */
+    .sector_size   = 0x00010000, /* 64K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+};
@@ -0,0 +1,14 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* PIOS Feature Selection */
+#define PIOS_INCLUDE_TRACE_BUFFER
+#define PIOS_TRACE_BUFFER_RECORDS 16
+
+#include <pios_delay.h>
+#include <pios_trace.h>
+
+#endif /* PIOS_H */
@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* abort */
+#include <string.h> /* memset */
+
+extern "C" {
+#include "pios.h"
+
+// raw time is 10 ticks per us
+static uint32_t raw_time;
+
+uint32_t PIOS_DELAY_GetRaw()
+{
+    return raw_time;
+}
+
+uint32_t PIOS_DELAY_GetuS()
+{
+    return raw_time / 10;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+    return (raw_time - raw) / 10;
+}
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class TraceTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        struct pios_trace_record out[PIOS_TRACE_BUFFER_RECORDS];
+
+        raw_time = 1000;
+        PIOS_TRACE_SetCategories(0xFFFFFFFF);
+        // empty what a previous test left
+        while (PIOS_TRACE_Read(out, PIOS_TRACE_BUFFER_RECORDS)) {}
+        PIOS_TRACE_GetStats(&recorded, &lost);
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_TRACE_SetCategories(0);
+    }
+
+    uint32_t recorded;
+    uint32_t lost;
+};
+
+TEST_F(TraceTest, Empty) {
+    struct pios_trace_record out[4];
+
+    EXPECT_EQ(0, PIOS_TRACE_Read(out, 4));
+}
+
+TEST_F(TraceTest, ReadInOrder) {
+    struct pios_trace_record out[4];
+
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_ISR, PIOS_TRACE_BEGIN, 3);
+    raw_time += 50;
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_ISR, PIOS_TRACE_END, 3);
+    raw_time += 100;
+
+    ASSERT_EQ(2, PIOS_TRACE_Read(out, 4));
+    EXPECT_EQ(PIOS_TRACE_CATEGORY_ISR, out[0].category);
+    EXPECT_EQ(PIOS_TRACE_BEGIN, out[0].event);
+    EXPECT_EQ(3U, out[0].data);
+    EXPECT_EQ(PIOS_TRACE_END, out[1].event);
+    // converted to PIOS_DELAY_GetuS() time
+    EXPECT_EQ(100U, out[0].time);
+    EXPECT_EQ(105U, out[1].time);
+    EXPECT_EQ(0, PIOS_TRACE_Read(out, 4));
+}
+
+TEST_F(TraceTest, PartialRead) {
+    struct pios_trace_record out[4];
+
+    for (uint32_t i = 0; i < 6; i++) {
+        PIOS_TRACE_Record(PIOS_TRACE_CATEGORY_USER, PIOS_TRACE_INSTANT, i);
+    }
+    ASSERT_EQ(4, PIOS_TRACE_Read(out, 4));
+    EXPECT_EQ(3U, out[3].data);
+    ASSERT_EQ(2, PIOS_TRACE_Read(out, 4));
+    EXPECT_EQ(4U, out[0].data);
+    EXPECT_EQ(5U, out[1].data);
+}
+
+TEST_F(TraceTest, DisabledCategory) {
+    struct pios_trace_record out[4];
+
+    PIOS_TRACE_SetCategories(1 << PIOS_TRACE_CATEGORY_TASK);
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_UAVOBJ, PIOS_TRACE_INSTANT, 0x1234);
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_TASK, PIOS_TRACE_INSTANT, 7);
+
+    ASSERT_EQ(1, PIOS_TRACE_Read(out, 4));
+    EXPECT_EQ(PIOS_TRACE_CATEGORY_TASK, out[0].category);
+    EXPECT_EQ(7U, out[0].data);
+}
+
+TEST_F(TraceTest, OverwriteOldest) {
+    struct pios_trace_record out[PIOS_TRACE_BUFFER_RECORDS];
+    uint32_t now_recorded, now_lost;
+
+    for (uint32_t i = 0; i < PIOS_TRACE_BUFFER_RECORDS + 5; i++) {
+        PIOS_TRACE_Record(PIOS_TRACE_CATEGORY_USER, PIOS_TRACE_INSTANT, i);
+    }
+
+    // the newest records are kept
+    ASSERT_EQ(PIOS_TRACE_BUFFER_RECORDS, PIOS_TRACE_Read(out, PIOS_TRACE_BUFFER_RECORDS));
+    EXPECT_EQ(5U, out[0].data);
+    EXPECT_EQ(PIOS_TRACE_BUFFER_RECORDS + 4U, out[PIOS_TRACE_BUFFER_RECORDS - 1].data);
+    EXPECT_EQ(0, PIOS_TRACE_Read(out, PIOS_TRACE_BUFFER_RECORDS));
+
+    PIOS_TRACE_GetStats(&now_recorded, &now_lost);
+    EXPECT_EQ(recorded + PIOS_TRACE_BUFFER_RECORDS + 5U, now_recorded);
+    EXPECT_EQ(lost + 5U, now_lost);
+}
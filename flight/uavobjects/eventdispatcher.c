@@ -44,6 +44,7 @@
 #define CALLBACK_PRIORITY    CALLBACK_PRIORITY_CRITICAL
 #define TASK_PRIORITY        CALLBACK_TASK_FLIGHTCONTROL
 #define MAX_UPDATE_PERIOD_MS 1000
+#define HEAP_INITIAL_SIZE    16
 
 // Private types
 
@@ -64,13 +65,17 @@ typedef struct {
 struct PeriodicObjectListStruct {
     EventCallbackInfo evInfo; /** Event callback information */
     uint16_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-    int32_t  timeToNextUpdateMs; /** Time delay to the next update */
+    int32_t  timeToNextUpdateMs; /** System time of the next update */
+    int16_t  heapIndex; /** Position in the update heap or -1 if not scheduled */
     struct PeriodicObjectListStruct *next; /** Needed by linked list library (utlist.h) */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
 static PeriodicObjectList *mObjList;
+static PeriodicObjectList * *mHeap; /** Scheduled entries, binary min-heap on timeToNextUpdateMs */
+static uint16_t mHeapSize;
+static uint16_t mHeapCapacity;
 static xQueueHandle mQueue;
 static DelayedCallbackInfo *eventSchedulerCallback;
 static xSemaphoreHandle mMutex;
@@ -82,6 +87,12 @@ static void eventTask();
 static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQueueHandle queue, uint16_t periodMs);
 static uint16_t randomizePeriod(uint16_t periodMs);
+static void heapSwap(uint16_t a, uint16_t b);
+static void heapSiftUp(uint16_t index);
+static void heapSiftDown(uint16_t index);
+static int32_t heapInsert(PeriodicObjectList *objEntry);
+static void heapRemove(PeriodicObjectList *objEntry);
+static void scheduleEntry(PeriodicObjectList *objEntry, uint16_t periodMs);
 
 
 /**
@@ -92,6 +103,9 @@ int32_t EventDispatcherInitialize()
 {
     // Initialize variables
     mObjList = NULL;
+    mHeap    = NULL;
+    mHeapSize     = 0;
+    mHeapCapacity = 0;
     memset(&mStats, 0, sizeof(EventStats));
 
     // Create mMutex
@@ -228,7 +242,7 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
         }
     }
     // Create handle
-    objEntry = (PeriodicObjectList *)pios_malloc(sizeof(PeriodicObjectList));
+    objEntry = (PeriodicObjectList *)pios_pool_malloc(sizeof(PeriodicObjectList), PIOS_MEM_TAG_EVENT);
     if (objEntry == NULL) {
         return -1;
     }
@@ -237,8 +251,8 @@ static int32_t eventPeriodicCreate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
     objEntry->evInfo.ev.event    = ev->event;
     objEntry->evInfo.cb = cb;
     objEntry->evInfo.queue       = queue;
-    objEntry->updatePeriodMs     = periodMs;
-    objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+    objEntry->heapIndex = -1;
+    scheduleEntry(objEntry, periodMs);
     // Add to list
     LL_APPEND(mObjList, objEntry);
     // Release lock
@@ -268,8 +282,7 @@ static int32_t eventPeriodicUpdate(UAVObjEvent *ev, UAVObjEventCallback cb, xQue
             objEntry->evInfo.ev.instId == ev->instId &&
             objEntry->evInfo.ev.event == ev->event) {
             // Object found, update period
-            objEntry->updatePeriodMs     = periodMs;
-            objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
+            scheduleEntry(objEntry, periodMs);
             // Release lock
             xSemaphoreGiveRecursive(mMutex);
             return 0;
@@ -312,6 +325,7 @@ static void eventTask()
 
 /**
  * Handle periodic updates for all objects.
+ * Only the entries that are due are visited, they are taken from the top of the update heap.
  * \return The system time until the next update (in ms) or -1 if failed
  */
 static int32_t processPeriodicUpdates()
@@ -319,49 +333,155 @@ static int32_t processPeriodicUpdates()
     PeriodicObjectList *objEntry;
     int32_t timeNow;
     int32_t timeToNextUpdate;
-    int32_t offset;
+    int32_t latency;
 
     // Get lock
     xSemaphoreTakeRecursive(mMutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount() * portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(mObjList, objEntry) {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0) {
-            // Check if time for the next update
-            timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow) {
-                // Reset timer
-                offset = (timeNow - objEntry->timeToNextUpdateMs) % objEntry->updatePeriodMs;
-                objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-                // Invoke callback, if one
-                if (objEntry->evInfo.cb != 0) {
-                    objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-                }
-                // Push event to queue, if one
-                if (objEntry->evInfo.queue != 0) {
-                    if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
-                        if (objEntry->evInfo.ev.obj != NULL) {
-                            mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
-                        }
-                        ++mStats.eventErrors;
-                    }
+    timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+    while (mHeapSize > 0 && mHeap[0]->timeToNextUpdateMs <= timeNow) {
+        objEntry = mHeap[0];
+
+        // Update stats
+        latency  = timeNow - objEntry->timeToNextUpdateMs;
+        ++mStats.periodicDispatches;
+        mStats.latencySumMs += latency;
+        if ((uint32_t)latency > mStats.latencyMaxMs) {
+            mStats.latencyMaxMs = latency;
+        }
+
+        // Reset timer, before invoking the callback as it may change the period
+        objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - (latency % objEntry->updatePeriodMs);
+        heapSiftDown(0);
+
+        // Invoke callback, if one
+        if (objEntry->evInfo.cb != 0) {
+            objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+        }
+        // Push event to queue, if one
+        if (objEntry->evInfo.queue != 0) {
+            if (xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE && !objEntry->evInfo.ev.lowPriority) { // do not block if queue is full
+                if (objEntry->evInfo.ev.obj != NULL) {
+                    mStats.lastErrorID = UAVObjGetID(objEntry->evInfo.ev.obj);
                 }
-            }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate) {
-                timeToNextUpdate = objEntry->timeToNextUpdateMs;
+                ++mStats.eventErrors;
             }
         }
     }
 
+    // Calculate delay to next update
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (mHeapSize > 0 && mHeap[0]->timeToNextUpdateMs < timeToNextUpdate) {
+        timeToNextUpdate = mHeap[0]->timeToNextUpdateMs;
+    }
+
     // Done
     xSemaphoreGiveRecursive(mMutex);
     return timeToNextUpdate;
 }
 
+/**
+ * Set the period of an entry and (re)schedule it, entries with a zero period are unscheduled.
+ * Must be called with the lock held.
+ */
+static void scheduleEntry(PeriodicObjectList *objEntry, uint16_t periodMs)
+{
+    heapRemove(objEntry);
+    objEntry->updatePeriodMs = periodMs;
+    if (periodMs > 0) {
+        // avoid bunching of updates
+        objEntry->timeToNextUpdateMs = xTaskGetTickCount() * portTICK_RATE_MS + randomizePeriod(periodMs);
+        heapInsert(objEntry);
+    }
+}
+
+static void heapSwap(uint16_t a, uint16_t b)
+{
+    PeriodicObjectList *tmp = mHeap[a];
+
+    mHeap[a] = mHeap[b];
+    mHeap[b] = tmp;
+    mHeap[a]->heapIndex = a;
+    mHeap[b]->heapIndex = b;
+}
+
+static void heapSiftUp(uint16_t index)
+{
+    while (index > 0) {
+        uint16_t parent = (index - 1) / 2;
+        if (mHeap[parent]->timeToNextUpdateMs <= mHeap[index]->timeToNextUpdateMs) {
+            break;
+        }
+        heapSwap(parent, index);
+        index = parent;
+    }
+}
+
+static void heapSiftDown(uint16_t index)
+{
+    while (1) {
+        uint16_t smallest = index;
+        uint16_t left     = 2 * index + 1;
+        uint16_t right    = left + 1;
+        if (left < mHeapSize && mHeap[left]->timeToNextUpdateMs < mHeap[smallest]->timeToNextUpdateMs) {
+            smallest = left;
+        }
+        if (right < mHeapSize && mHeap[right]->timeToNextUpdateMs < mHeap[smallest]->timeToNextUpdateMs) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        heapSwap(index, smallest);
+        index = smallest;
+    }
+}
+
+/**
+ * Add an entry to the update heap, the heap storage is doubled when full.
+ * \return Success (0), failure (-1)
+ */
+static int32_t heapInsert(PeriodicObjectList *objEntry)
+{
+    if (mHeapSize == mHeapCapacity) {
+        uint16_t capacity = mHeapCapacity ? 2 * mHeapCapacity : HEAP_INITIAL_SIZE;
+        PeriodicObjectList * *heap = (PeriodicObjectList * *)pios_malloc(capacity * sizeof(PeriodicObjectList *));
+        if (heap == NULL) {
+            return -1;
+        }
+        if (mHeap) {
+            memcpy(heap, mHeap, mHeapSize * sizeof(PeriodicObjectList *));
+            pios_free(mHeap);
+        }
+        mHeap = heap;
+        mHeapCapacity = capacity;
+    }
+    objEntry->heapIndex = mHeapSize;
+    mHeap[mHeapSize++]  = objEntry;
+    heapSiftUp(objEntry->heapIndex);
+    return 0;
+}
+
+/**
+ * Remove an entry from the update heap, if it is scheduled.
+ */
+static void heapRemove(PeriodicObjectList *objEntry)
+{
+    int16_t index = objEntry->heapIndex;
+
+    if (index < 0) {
+        return;
+    }
+    objEntry->heapIndex = -1;
+    if (--mHeapSize == index) {
+        return;
+    }
+    mHeap[index] = mHeap[mHeapSize];
+    mHeap[index]->heapIndex = index;
+    heapSiftUp(index);
+    heapSiftDown(mHeap[index]->heapIndex);
+}
+
 /**
  * Return a psedorandom integer from 0 to periodMs
  * Based on the Park-Miller-Carta Pseudo-Random Number Generator
@@ -33,6 +33,9 @@
 typedef struct {
     uint32_t lastErrorID;
     uint32_t eventErrors;
+    uint32_t periodicDispatches; /** Number of periodic events dispatched */
+    uint32_t latencySumMs; /** Sum of the delays between the due time and the dispatch of periodic events */
+    uint32_t latencyMaxMs; /** Largest of these delays, i.e. the worst jitter of the periodic events */
 } EventStats;
 
 // Public functions
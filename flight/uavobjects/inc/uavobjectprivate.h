@@ -73,6 +73,7 @@ struct ObjectEventEntry {
     xQueueHandle queue;
     UAVObjEventCallback     cb;
     uint8_t eventMask;
+    bool    fast;
 };
 
 /*
@@ -100,6 +101,7 @@ struct UAVOBase {
         bool isSingle      : 1;
         bool isSettings    : 1;
         bool isPriority    : 1;
+        bool isHighRate    : 1;
     } flags;
 } __attribute__((packed));
 
@@ -119,6 +121,8 @@ struct UAVOData {
      */
     struct UAVOMeta metaObj;
     uint16_t instance_size;
+    /* Bumped after the data of any instance changed, aligned for single load reads */
+    volatile uint32_t change_count __attribute__((aligned(4)));
 } __attribute__((packed, aligned(4)));
 
 /* Augmented type for Single Instance Data UAVO */
@@ -165,6 +169,10 @@ struct UAVOMulti {
 #define InstanceDataOffset(inst)         ((void *)&(((struct UAVOMultiInst *)inst)->instance))
 #define InstanceData(instance)           ((void *)instance)
 
+/** high rate objects carry a word aligned sequence counter after their single instance **/
+#define ObjSingleSeqPtr(obj)             ((volatile uint32_t *)(((uintptr_t)ObjSingleInstanceDataOffset(obj) + ((struct UAVOData *)(obj))->instance_size + 3) & ~(uintptr_t)3))
+#define ObjSeqExtraBytes                 (sizeof(uint32_t) + 3)
+
 // Private functions
 int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType event);
 InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId);
@@ -35,11 +35,16 @@
 #include "pios_struct_helper.h"
 #include "inc/uavobjectprivate.h"
 
+// Number of lockless read attempts before falling back to the mutex
+#define LOCKLESS_READ_RETRIES 3
+
 // Private functions
 static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
-static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask);
+static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask, bool fast);
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static inline void seqWriteBegin(struct UAVOData *obj);
+static inline void seqWriteEnd(struct UAVOData *obj);
 
 
 int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused))  uint16_t instId)
@@ -51,6 +56,10 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
 
 
+// Object ID table, generated in uavobjecttable.c, the object list is walked instead if it is not linked in
+extern const UAVObjIdTableEntry UAVObjIdTable[] __attribute__((weak));
+extern const uint16_t UAVObjIdTableSize __attribute__((weak));
+
 // Private variables
 static xSemaphoreHandle mutex;
 static const UAVObjMetadata defMetadata = {
@@ -147,7 +156,7 @@ static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
     uint32_t object_size = sizeof(struct UAVOSingle) + num_bytes;
 
     /* Allocate the object from the heap */
-    struct UAVOSingle *uavo_single = (struct UAVOSingle *)pios_malloc(object_size);
+    struct UAVOSingle *uavo_single = (struct UAVOSingle *)pios_malloc_tagged(object_size, PIOS_MEM_TAG_UAVOBJECT);
 
     if (!uavo_single) {
         return NULL;
@@ -172,7 +181,7 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
     uint32_t object_size = sizeof(struct UAVOMulti) + num_bytes;
 
     /* Allocate the object from the heap */
-    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)pios_malloc(object_size);
+    struct UAVOMulti *uavo_multi = (struct UAVOMulti *)pios_malloc_tagged(object_size, PIOS_MEM_TAG_UAVOBJECT);
 
     if (!uavo_multi) {
         return NULL;
@@ -203,6 +212,8 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
  * \param[in] id Unique object ID
  * \param[in] isSingleInstance Is this a single instance or multi-instance object
  * \param[in] isSettings Is this a settings object
+ * \param[in] isPriority Is this a priority object
+ * \param[in] isHighRate Does this object support lockless reads (single instance data objects only)
  * \param[in] numBytes Number of bytes of object data (for one instance)
  * \param[in] initCb Default field and metadata initialization function
  * \return Object handle, or NULL if failure.
@@ -210,7 +221,7 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
  */
 UAVObjHandle UAVObjRegister(uint32_t id,
                             bool isSingleInstance, bool isSettings, bool isPriority,
-                            uint32_t num_bytes,
+                            bool isHighRate, uint32_t num_bytes,
                             UAVObjInitializeCallback initCb)
 {
     struct UAVOData *uavo_data = NULL;
@@ -223,8 +234,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     }
 
     /* Map the various flags to one of the UAVO types we understand */
+    isHighRate = isHighRate && isSingleInstance && !isSettings;
     if (isSingleInstance) {
-        uavo_data = UAVObjAllocSingle(num_bytes);
+        uavo_data = UAVObjAllocSingle(num_bytes + (isHighRate ? ObjSeqExtraBytes : 0));
     } else {
         uavo_data = UAVObjAllocMulti(num_bytes);
     }
@@ -236,6 +248,8 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     /* Fill in the details about this UAVO */
     uavo_data->id = id;
     uavo_data->instance_size = num_bytes;
+    // readers start from 0, so they always see the first value as a change
+    uavo_data->change_count  = 1;
     if (isSettings) {
         uavo_data->base.flags.isSettings = true;
         // settings defaults to being sent with priority
@@ -243,6 +257,7 @@ UAVObjHandle UAVObjRegister(uint32_t id,
     } else {
         uavo_data->base.flags.isPriority = isPriority;
     }
+    uavo_data->base.flags.isHighRate = isHighRate;
     /* Initialize the embedded meta UAVO */
     UAVObjInitMetaData(&uavo_data->metaObj);
 
@@ -268,8 +283,34 @@ unlock_exit:
     return (UAVObjHandle)uavo_data;
 }
 
+/**
+ * Binary search of the generated object ID table
+ * \param[in] The object ID
+ * \return The table entry or NULL if not found.
+ */
+static const UAVObjIdTableEntry *findIdTableEntry(uint32_t id)
+{
+    uint16_t first = 0;
+    uint16_t last  = UAVObjIdTableSize;
+
+    while (first < last) {
+        uint16_t middle = (first + last) / 2;
+        if (UAVObjIdTable[middle].id < id) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    if (first < UAVObjIdTableSize && UAVObjIdTable[first].id == id && UAVObjIdTable[first].handle) {
+        return &UAVObjIdTable[first];
+    }
+    return NULL;
+}
+
 /**
  * Retrieve an object from the list given its id
+ * The lookup uses the generated object ID table and does not need the lock,
+ * object handles are only ever set once when the object is registered.
  * \param[in] The object ID
  * \return The object or NULL if not found.
  */
@@ -277,6 +318,22 @@ UAVObjHandle UAVObjGetByID(uint32_t id)
 {
     UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
 
+    if (&UAVObjIdTableSize != NULL) {
+        const UAVObjIdTableEntry *entry = findIdTableEntry(id);
+        if (entry) {
+            return entry->handle();
+        }
+        // Not a data object, check if this is the ID of a meta object
+        entry = findIdTableEntry(id - 1);
+        if (entry && MetaObjectId(entry->id) == id) {
+            struct UAVOData *uavo_data = (struct UAVOData *)entry->handle();
+            if (uavo_data) {
+                return (UAVObjHandle) & (uavo_data->metaObj);
+            }
+        }
+        return NULL;
+    }
+
     // Get lock
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
@@ -322,6 +379,22 @@ uint32_t UAVObjGetID(UAVObjHandle obj_handle)
     }
 }
 
+/**
+ * Get the change counter of an object, it is bumped every time the data of one of
+ * its instances is set, unpacked or loaded. Metaobjects have none.
+ * \param[in] obj The object handle
+ * \return The change counter, never 0
+ */
+uint32_t UAVObjGetChangeCount(UAVObjHandle obj_handle)
+{
+    PIOS_Assert(obj_handle);
+
+    if (UAVObjIsMetaobject(obj_handle)) {
+        return 1;
+    }
+    return ((struct UAVOData *)obj_handle)->change_count;
+}
+
 /**
  * Get the number of bytes of the object's data (for one instance)
  * \param[in] obj The object handle
@@ -533,15 +606,20 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
             }
         }
         // Set the data
+        seqWriteBegin(obj);
         memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        seqWriteEnd(obj);
     }
 
-    // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
     rc = 0;
 
 unlock_exit:
     xSemaphoreGiveRecursive(mutex);
+
+    // Fire event, the event lists do not need the lock
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UNPACKED);
+    }
     return rc;
 }
 
@@ -607,7 +685,7 @@ uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc)
         if (instId != 0) {
             goto unlock_exit;
         }
-        // TODO
+        crc = PIOS_CRC_updateCRC(crc, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
     } else {
         struct UAVOData *obj;
         InstanceHandle instEntry;
@@ -629,6 +707,47 @@ unlock_exit:
     return crc;
 }
 
+/**
+ * Update a CRC32 with an object data, for comparing the data with a copy
+ * where an 8 bit CRC would collide too often
+ * \param[in] obj The object handle
+ * \param[in] instId The instance ID
+ * \param[in] crc The crc to update
+ * \return the updated crc
+ */
+uint32_t UAVObjUpdateCRC32(UAVObjHandle obj_handle, uint16_t instId, uint32_t crc)
+{
+    PIOS_Assert(obj_handle);
+
+    // Lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    if (UAVObjIsMetaobject(obj_handle)) {
+        if (instId != 0) {
+            goto unlock_exit;
+        }
+        crc = PIOS_CRC32_updateCRC(crc, (uint8_t *)MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
+    } else {
+        struct UAVOData *obj;
+        InstanceHandle instEntry;
+
+        // Cast handle to object
+        obj = (struct UAVOData *)obj_handle;
+
+        // Get the instance
+        instEntry = getInstance(obj, instId);
+        if (instEntry == NULL) {
+            goto unlock_exit;
+        }
+        // Update crc
+        crc = PIOS_CRC32_updateCRC(crc, (uint8_t *)InstanceData(instEntry), (int32_t)obj->instance_size);
+    }
+
+unlock_exit:
+    xSemaphoreGiveRecursive(mutex);
+    return crc;
+}
+
 /**
  * Actually write the object's data to the logfile
  * \param[in] obj The object handle
@@ -920,15 +1039,20 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
             goto unlock_exit;
         }
         // Set data
+        seqWriteBegin(obj);
         memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+        seqWriteEnd(obj);
     }
 
-    // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
     rc = 0;
 
 unlock_exit:
     xSemaphoreGiveRecursive(mutex);
+
+    // Fire event, the event lists do not need the lock
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
+    }
     return rc;
 }
 
@@ -985,16 +1109,20 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
         }
 
         // Set data
+        seqWriteBegin(obj);
         memcpy(InstanceData(instEntry) + offset, dataIn, size);
+        seqWriteEnd(obj);
     }
 
-
-    // Fire event
-    sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
     rc = 0;
 
 unlock_exit:
     xSemaphoreGiveRecursive(mutex);
+
+    // Fire event, the event lists do not need the lock
+    if (rc == 0) {
+        sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
+    }
     return rc;
 }
 
@@ -1045,6 +1173,44 @@ unlock_exit:
     return rc;
 }
 
+/**
+ * Get the data of a specific object instance without taking the object manager lock.
+ * Only objects registered as high rate have a sequence counter, readers retry if a
+ * writer ran during the copy. All other objects, and reads that keep colliding with
+ * a (possibly preempted) writer, use UAVObjGetInstanceData().
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \param[out] dataOut The object's data structure
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjGetInstanceDataLockless(UAVObjHandle obj_handle, uint16_t instId,
+                                      void *dataOut)
+{
+    PIOS_Assert(obj_handle);
+
+    if (instId == 0 && ((struct UAVOBase *)obj_handle)->flags.isHighRate) {
+        struct UAVOData *obj   = (struct UAVOData *)obj_handle;
+        volatile uint32_t *seq = ObjSingleSeqPtr(obj);
+
+        for (uint8_t retry = 0; retry < LOCKLESS_READ_RETRIES; ++retry) {
+            uint32_t start = *seq;
+            if (start & 1) {
+                // A writer is in the middle of an update and can not finish while we spin,
+                // the mutex path lets priority inheritance run it to completion
+                break;
+            }
+            __sync_synchronize();
+            memcpy(dataOut, ObjSingleInstanceDataOffset(obj), obj->instance_size);
+            __sync_synchronize();
+            if (*seq == start) {
+                return 0;
+            }
+        }
+    }
+
+    return UAVObjGetInstanceData(obj_handle, instId, dataOut);
+}
+
 /**
  * Get the data of a specific object instance
  * \param[in] obj The object handle
@@ -1343,7 +1509,7 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue,
     PIOS_Assert(queue);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, queue, 0, eventMask);
+    res = connectObj(obj_handle, queue, 0, eventMask, false);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1379,7 +1545,27 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
     PIOS_Assert(obj_handle);
     int32_t res;
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-    res = connectObj(obj_handle, 0, cb, eventMask);
+    res = connectObj(obj_handle, 0, cb, eventMask, false);
+    xSemaphoreGiveRecursive(mutex);
+    return res;
+}
+
+/**
+ * Connect an event callback invoked directly from the context updating the object, instead of from the event task.
+ * The callback must be short and must not block, it is meant to hand the event over to a task without a queue.
+ * It is disconnected with UAVObjDisconnectCallback().
+ * \param[in] obj The object handle
+ * \param[in] cb The event callback
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectFastCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
+                                  uint8_t eventMask)
+{
+    PIOS_Assert(obj_handle);
+    int32_t res;
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    res = connectObj(obj_handle, 0, cb, eventMask, true);
     xSemaphoreGiveRecursive(mutex);
     return res;
 }
@@ -1419,9 +1605,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj_handle)
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATE_REQ);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1441,9 +1625,7 @@ void UAVObjUpdated(UAVObjHandle obj_handle)
 void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED_MANUAL);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1454,9 +1636,7 @@ void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /*
@@ -1476,9 +1656,7 @@ void UAVObjLogging(UAVObjHandle obj_handle)
 void UAVObjInstanceLogging(UAVObjHandle obj_handle, uint16_t instId)
 {
     PIOS_Assert(obj_handle);
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     sendEvent((struct UAVOBase *)obj_handle, instId, EV_LOGGING_MANUAL);
-    xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1505,6 +1683,9 @@ xSemaphoreGiveRecursive(mutex);
 
 /**
  * Send a triggered event to all event queues registered on the object.
+ * The event list is walked without taking the object manager lock: entries are
+ * only published fully initialised and are never freed (see connectObj() and
+ * disconnectObj()), so a concurrent connect or disconnect is safe.
  */
 int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType triggered_event)
 {
@@ -1516,24 +1697,39 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
         .lowPriority = false,
     };
 
+    PIOS_TRACE_EVENT(PIOS_TRACE_CATEGORY_UAVOBJ, PIOS_TRACE_INSTANT, UAVObjGetID(obj));
+
+    // the data is written before the event, readers seeing the new count get the new data
+    if (!obj->flags.isMeta && (triggered_event & (EV_UPDATED | EV_UNPACKED))) {
+        __sync_fetch_and_add(&((struct UAVOData *)obj)->change_count, 1);
+    }
+
     // Go through each object and push the event message in the queue (if event is activated for the queue)
     struct ObjectEventEntry *event;
 
     LL_FOREACH(obj->next_event, event) {
-        if (event->eventMask == 0 || (event->eventMask & triggered_event) != 0) {
+        // Sample the entry once, it may be updated concurrently
+        xQueueHandle queue     = event->queue;
+        UAVObjEventCallback cb = event->cb;
+        uint8_t eventMask      = event->eventMask;
+        bool fast              = event->fast;
+
+        if (eventMask == 0 || (eventMask & triggered_event) != 0) {
             // Send to queue if a valid queue is registered
-            if (event->queue) {
+            if (queue) {
                 // will not block
-                if (xQueueSend(event->queue, &msg, 0) != pdTRUE) {
+                if (xQueueSend(queue, &msg, 0) != pdTRUE) {
                     ++stats.eventQueueErrors;
                     stats.lastQueueErrorID = UAVObjGetID(obj);
                 }
             }
 
-            // Invoke callback (from event task) if a valid one is registered
-            if (event->cb) {
+            // Invoke callback (from event task, or right here if fast) if a valid one is registered
+            if (cb && fast) {
+                cb(&msg);
+            } else if (cb) {
                 // invoke callback from the event task, will not block
-                if (EventCallbackDispatch(&msg, event->cb) != pdTRUE) {
+                if (EventCallbackDispatch(&msg, cb) != pdTRUE) {
                     ++stats.eventCallbackErrors;
                     stats.lastCallbackErrorID = UAVObjGetID(obj);
                 }
@@ -1544,6 +1740,29 @@ int32_t sendEvent(struct UAVOBase *obj, uint16_t instId, UAVObjEventType trigger
     return 0;
 }
 
+/**
+ * Mark the start of a data update, lockless readers of high rate objects retry
+ * while the sequence counter is odd. Writers are serialised by the mutex.
+ */
+static inline void seqWriteBegin(struct UAVOData *obj)
+{
+    if (obj->base.flags.isHighRate) {
+        ++*ObjSingleSeqPtr(obj);
+        __sync_synchronize();
+    }
+}
+
+/**
+ * Mark the end of a data update started with seqWriteBegin().
+ */
+static inline void seqWriteEnd(struct UAVOData *obj)
+{
+    if (obj->base.flags.isHighRate) {
+        __sync_synchronize();
+        ++*ObjSingleSeqPtr(obj);
+    }
+}
+
 /**
  * Create a new object instance, return the instance info or NULL if failure.
  */
@@ -1576,7 +1795,7 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
 
     /* Create the actual instance */
     uint32_t size = sizeof(struct UAVOMultiInst) + obj->instance_size;
-    instEntry = (struct UAVOMultiInst *)pios_malloc(size);
+    instEntry = (struct UAVOMultiInst *)pios_malloc_tagged(size, PIOS_MEM_TAG_UAVOBJECT);
     if (!instEntry) {
         return NULL;
     }
@@ -1641,16 +1860,20 @@ InstanceHandle getInstance(struct UAVOData *obj, uint16_t instId)
 
 /**
  * Connect an event queue to the object, if the queue is already connected then the event mask is only updated.
+ * Must be called with the object manager lock held. sendEvent() walks the list
+ * concurrently, so entries are fully initialised before they become reachable.
  * \param[in] obj The object handle
  * \param[in] queue The event queue
  * \param[in] cb The event callback
  * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] fast Invoke the callback from sendEvent() rather than from the event task
  * \return 0 if success or -1 if failure
  */
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
-                          UAVObjEventCallback cb, uint8_t eventMask)
+                          UAVObjEventCallback cb, uint8_t eventMask, bool fast)
 {
     struct ObjectEventEntry *event;
+    struct ObjectEventEntry *unused = NULL;
     struct UAVOBase *obj;
 
     // Check that the queue is not already connected, if it is simply update event mask
@@ -1659,18 +1882,38 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
         if (event->queue == queue && event->cb == cb) {
             // Already connected, update event mask and return
             event->eventMask = eventMask;
+            event->fast      = fast;
             return 0;
         }
+        if (unused == NULL && event->queue == 0 && event->cb == 0) {
+            unused = event;
+        }
+    }
+
+    // Reuse an entry released by disconnectObj(), the listener is written last
+    if (unused != NULL) {
+        unused->eventMask = eventMask;
+        unused->fast      = fast;
+        __sync_synchronize();
+        if (queue) {
+            unused->queue = queue;
+        } else {
+            unused->cb = cb;
+        }
+        return 0;
     }
 
     // Add queue to list
-    event = (struct ObjectEventEntry *)pios_malloc(sizeof(struct ObjectEventEntry));
+    event = (struct ObjectEventEntry *)pios_pool_malloc(sizeof(struct ObjectEventEntry), PIOS_MEM_TAG_EVENT);
     if (event == NULL) {
         return -1;
     }
     event->queue     = queue;
     event->cb        = cb;
     event->eventMask = eventMask;
+    event->fast      = fast;
+    // Make the entry contents visible before it is linked in
+    __sync_synchronize();
     LL_APPEND(obj->next_event, event);
 
     // Done
@@ -1679,6 +1922,8 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
 
 /**
  * Disconnect an event queue from the object
+ * The entry stays on the list without a listener since sendEvent() may still be
+ * walking it, it is reused by the next connectObj() on this object.
  * \param[in] obj The object handle
  * \param[in] queue The event queue
  * \param[in] cb The event callback
@@ -1695,8 +1940,8 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
     LL_FOREACH(obj->next_event, event) {
         if ((event->queue == queue
              && event->cb == cb)) {
-            LL_DELETE(obj->next_event, event);
-            vPortFree(event);
+            event->queue = 0;
+            event->cb    = 0;
             return 0;
         }
     }
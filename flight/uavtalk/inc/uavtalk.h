@@ -48,6 +48,9 @@ typedef struct {
 
 typedef void *UAVTalkConnection;
 
+// Returns true when packets of the object should be relayed without being parsed
+typedef bool (*UAVTalkRelayFilter)(uint32_t objId);
+
 typedef enum { UAVTALK_STATE_ERROR = 0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE, UAVTALK_STATE_SIZE, UAVTALK_STATE_OBJID, UAVTALK_STATE_INSTID, UAVTALK_STATE_TIMESTAMP, UAVTALK_STATE_DATA, UAVTALK_STATE_CS, UAVTALK_STATE_COMPLETE } UAVTalkRxState;
 
 // Public functions
@@ -59,7 +62,13 @@ int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjH
 int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, int32_t timeoutMs);
 UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connection, uint8_t rxbyte);
 UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connection, uint8_t rxbyte);
+int32_t UAVTalkSetBundling(UAVTalkConnection connection, bool enable);
+int32_t UAVTalkFlushBundle(UAVTalkConnection connection);
+int32_t UAVTalkSetDeltaEncoding(UAVTalkConnection connection, bool enable);
+UAVTalkRxState UAVTalkProcessInputBuffer(UAVTalkConnection connection, const uint8_t *rxbuffer, uint16_t length);
 int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle);
+uint16_t UAVTalkRelayInputBuffer(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length,
+                                 UAVTalkRelayFilter relayFilter, UAVTalkRxState *state);
 int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats, bool reset);
 void UAVTalkAddStats(UAVTalkConnection connection, UAVTalkStats *stats, bool reset);
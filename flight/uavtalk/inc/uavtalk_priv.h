@@ -46,6 +46,26 @@
 #define UAVTALK_MIN_PACKET_LENGTH  UAVTALK_MAX_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH
 #define UAVTALK_MAX_PACKET_LENGTH  UAVTALK_MIN_PACKET_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH
 
+// bundle record header : object ID(4), instance ID(2), length(1)
+#define UAVTALK_BUNDLE_RECORD_HEADER_LENGTH 7
+
+// bundles must fit the payload buffer of every receiver, including the GCS
+#define UAVTALK_MAX_BUNDLE_LENGTH           MIN(UAVTALK_MAX_PAYLOAD_LENGTH - 1, 255)
+
+// delta encoding : shadow copies kept per connection and size range of the encoded objects,
+// a full update is sent every UAVTALK_DELTA_KEYFRAME_INTERVAL updates to resynchronize receivers that lost one
+#define UAVTALK_DELTA_SHADOWS           8
+#define UAVTALK_DELTA_KEYFRAME_INTERVAL 10
+#define UAVTALK_DELTA_MIN_LENGTH        16
+#define UAVTALK_DELTA_MAX_LENGTH        255
+
+typedef struct {
+    uint32_t objId;
+    uint16_t instId;
+    uint8_t  updates;
+    uint8_t  *data;
+} UAVTalkDeltaShadow;
+
 typedef struct {
     uint8_t  type;
     uint16_t packet_size;
@@ -58,6 +78,8 @@ typedef struct {
     uint32_t rxCount;
     UAVTalkRxState state;
     uint16_t rxPacketLength;
+    uint16_t relayCount; // raw bytes of the packet being cut through, staged in rxBuffer
+    uint16_t relayLength; // length of that packet, 0 when none is in transit
 } UAVTalkInputProcessor;
 
 typedef struct {
@@ -73,6 +95,12 @@ typedef struct {
     UAVTalkInputProcessor iproc;
     uint8_t      *rxBuffer;
     uint8_t      *txBuffer;
+    bool         bundling;
+    uint8_t      *bundleBuffer;
+    uint16_t     bundleLength;
+    uint16_t     bundleCount;
+    bool         deltas;
+    UAVTalkDeltaShadow *deltaShadows;
 } UAVTalkConnectionData;
 
 #define UAVTALK_CANARI          0xCA
@@ -86,6 +114,8 @@ typedef struct {
 #define UAVTALK_TYPE_OBJ_ACK    (UAVTALK_TYPE_VER | 0x02)
 #define UAVTALK_TYPE_ACK        (UAVTALK_TYPE_VER | 0x03)
 #define UAVTALK_TYPE_NACK       (UAVTALK_TYPE_VER | 0x04)
+#define UAVTALK_TYPE_BUNDLE     (UAVTALK_TYPE_VER | 0x05)
+#define UAVTALK_TYPE_OBJ_DELTA  (UAVTALK_TYPE_VER | 0x06)
 #define UAVTALK_TYPE_OBJ_TS     (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 #define UAVTALK_TYPE_OBJ_ACK_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_ACK)
 
@@ -35,7 +35,7 @@
 // #define UAV_DEBUGLOG 1
 
 #if defined UAV_DEBUGLOG && defined FLASH_FREERTOS
-#define UAVT_DEBUGLOG_PRINTF(...) PIOS_DEBUGLOG_Printf(__VA_ARGS__)
+#define UAVT_DEBUGLOG_PRINTF(...) PIOS_DEBUGLOG_PRINTF(__VA_ARGS__)
 // uncomment and adapt the following lines to filter verbose logging to include specific object(s) only
 // #include "flighttelemetrystats.h"
 // #define UAVT_DEBUGLOG_CPRINTF(objId, ...) if (objId == FLIGHTTELEMETRYSTATS_OBJID) { UAVT_DEBUGLOG_PRINTF(__VA_ARGS__); }
@@ -51,8 +51,13 @@
 static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type, UAVObjHandle obj, uint16_t instId, int32_t timeout);
 static int32_t sendObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
 static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t bundleObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj);
+static int32_t flushBundle(UAVTalkConnectionData *connection);
+static uint8_t deltaEncode(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, uint8_t *data, int32_t *length);
 static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t *data);
 static void updateAck(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId);
+static uint16_t receivePayloadSpan(UAVTalkConnectionData *connection, const uint8_t *rxbuffer, uint16_t length);
+static void relayRaw(UAVTalkConnectionData *connection, const uint8_t *head, uint16_t headLength, const uint8_t *tail, uint16_t tailLength);
 
 /**
  * Initialize the UAVTalk library
@@ -71,6 +76,7 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     }
     connection->canari      = UAVTALK_CANARI;
     connection->iproc.rxPacketLength = 0;
+    connection->iproc.relayLength    = 0;
     connection->iproc.state = UAVTALK_STATE_SYNC;
     connection->outStream   = outputStream;
     connection->lock = xSemaphoreCreateRecursiveMutex();
@@ -84,6 +90,13 @@ UAVTalkConnection UAVTalkInitialize(UAVTalkOutputStream outputStream)
     if (!connection->txBuffer) {
         return 0;
     }
+    // the bundle buffer is only allocated when bundling is enabled
+    connection->bundling     = false;
+    connection->bundleBuffer = NULL;
+    connection->bundleLength = 0;
+    connection->bundleCount  = 0;
+    connection->deltas       = false;
+    connection->deltaShadows = NULL;
     vSemaphoreCreateBinary(connection->respSema);
     xSemaphoreTake(connection->respSema, 0); // reset to zero
     UAVTalkResetStats((UAVTalkConnection)connection);
@@ -347,6 +360,88 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, uint8_t type
     return ret;
 }
 
+/**
+ * Enable or disable the bundling of object updates.
+ * Only enable it once the receiver has reported that it understands bundles.
+ * While enabled, unacked object updates are collected and sent as a single UAVTALK_TYPE_BUNDLE
+ * frame when the bundle is full, when another type of frame is sent or when UAVTalkFlushBundle() is called.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] enable Bundle object updates (true) or send each one in its own frame (false)
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetBundling(UAVTalkConnection connectionHandle, bool enable)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    if (enable && !connection->bundleBuffer) {
+        connection->bundleBuffer = pios_malloc(UAVTALK_MIN_HEADER_LENGTH + UAVTALK_MAX_BUNDLE_LENGTH + UAVTALK_CHECKSUM_LENGTH);
+    }
+    if (!enable) {
+        flushBundle(connection);
+    }
+    connection->bundling = enable && connection->bundleBuffer;
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return (connection->bundling == enable) ? 0 : -1;
+}
+
+/**
+ * Send the object updates collected in the current bundle, if any.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkFlushBundle(UAVTalkConnection connectionHandle)
+{
+    UAVTalkConnectionData *connection;
+    int32_t ret;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    ret = flushBundle(connection);
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return ret;
+}
+
+/**
+ * Enable or disable the delta encoding of periodic object updates.
+ * Only enable it once the receiver has reported that it understands deltas.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] enable Delta encode periodic updates (true) or always send them in full (false)
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSetDeltaEncoding(UAVTalkConnection connectionHandle, bool enable)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+    if (enable && !connection->deltaShadows) {
+        connection->deltaShadows = pios_malloc(UAVTALK_DELTA_SHADOWS * sizeof(UAVTalkDeltaShadow));
+        if (connection->deltaShadows) {
+            memset(connection->deltaShadows, 0, UAVTALK_DELTA_SHADOWS * sizeof(UAVTalkDeltaShadow));
+        }
+    }
+    if (!enable && connection->deltaShadows) {
+        // A new receiver has to start from full updates
+        for (uint8_t n = 0; n < UAVTALK_DELTA_SHADOWS; ++n) {
+            connection->deltaShadows[n].updates = UAVTALK_DELTA_KEYFRAME_INTERVAL;
+        }
+    }
+    connection->deltas = enable && connection->deltaShadows;
+    xSemaphoreGiveRecursive(connection->lock);
+
+    return (connection->deltas == enable) ? 0 : -1;
+}
+
 /**
  * Process an byte from the telemetry stream.
  * \param[in] connectionHandle UAVTalkConnection to be used
@@ -589,6 +684,178 @@ UAVTalkRxState UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uin
     return state;
 }
 
+/**
+ * Process a buffer of bytes from the telemetry stream.
+ * Completed packets are received as they are parsed, payloads are copied and checksummed
+ * in spans instead of one byte at a time.
+ * \param[in] connectionHandle UAVTalkConnection to be used
+ * \param[in] rxbuffer Received bytes
+ * \param[in] length Number of bytes in rxbuffer
+ * \return UAVTalkRxState after the last byte
+ */
+UAVTalkRxState UAVTalkProcessInputBuffer(UAVTalkConnection connectionHandle, const uint8_t *rxbuffer, uint16_t length)
+{
+    UAVTalkConnectionData *connection;
+
+    CHECKCONHANDLE(connectionHandle, connection, return -1);
+
+    UAVTalkInputProcessor *iproc = &connection->iproc;
+    UAVTalkRxState state = iproc->state;
+    uint16_t position    = 0;
+
+    while (position < length) {
+        if (iproc->state != UAVTALK_STATE_DATA) {
+            state = UAVTalkProcessInputStream(connectionHandle, rxbuffer[position++]);
+            continue;
+        }
+
+        position += receivePayloadSpan(connection, &rxbuffer[position], length - position);
+        state     = iproc->state;
+    }
+
+    return state;
+}
+
+/**
+ * Relay a buffer of bytes from one connection to another without reassembling the packets.
+ * Only the header is parsed, once the object and instance IDs are known relayFilter decides
+ * whether the packet is cut through: its raw bytes are forwarded as they are and the checksum
+ * is left to the final receiver. Other packets are parsed and checked as usual, processing
+ * stops after each of them completes so the caller can receive or relay it.
+ * \param[in] inConnectionHandle UAVTalkConnection the bytes were received on
+ * \param[in] outConnectionHandle UAVTalkConnection the packets are relayed to
+ * \param[in] rxbuffer Received bytes
+ * \param[in] length Number of bytes in rxbuffer
+ * \param[in] relayFilter Returns true for the object IDs to cut through
+ * \param[out] state UAVTalkRxState after the last byte consumed
+ * 
+eturn Number of bytes consumed
+ */
+uint16_t UAVTalkRelayInputBuffer(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle, const uint8_t *rxbuffer, uint16_t length,
+                                 UAVTalkRelayFilter relayFilter, UAVTalkRxState *state)
+{
+    UAVTalkConnectionData *inConnection;
+    UAVTalkConnectionData *outConnection;
+
+    *state = UAVTALK_STATE_ERROR;
+    CHECKCONHANDLE(inConnectionHandle, inConnection, return length);
+    CHECKCONHANDLE(outConnectionHandle, outConnection, return length);
+
+    UAVTalkInputProcessor *iproc = &inConnection->iproc;
+    uint16_t position = 0;
+
+    *state = iproc->state;
+    while (position < length) {
+        if (iproc->relayLength) {
+            // raw packet in transit, the header and any earlier part are staged in rxBuffer
+            uint16_t count = MIN(length - position, iproc->relayLength - iproc->relayCount);
+            inConnection->stats.rxBytes += count;
+            if (iproc->relayCount + count == iproc->relayLength) {
+                // the rest of the packet is in the buffer, send it from there
+                relayRaw(outConnection, inConnection->rxBuffer, iproc->relayCount, &rxbuffer[position], count);
+                iproc->relayLength = 0;
+                iproc->state = UAVTALK_STATE_SYNC;
+            } else {
+                memcpy(&inConnection->rxBuffer[iproc->relayCount], &rxbuffer[position], count);
+                iproc->relayCount += count;
+            }
+            position += count;
+            *state    = iproc->state;
+            continue;
+        }
+
+        UAVTalkRxState previous = iproc->state;
+        if (previous == UAVTALK_STATE_DATA) {
+            position += receivePayloadSpan(inConnection, &rxbuffer[position], length - position);
+            *state    = iproc->state;
+        } else {
+            *state    = UAVTalkProcessInputStreamQuiet(inConnectionHandle, rxbuffer[position++]);
+        }
+
+        if (*state == UAVTALK_STATE_COMPLETE) {
+            break;
+        }
+
+        // header parsed and checked, decide whether the rest is cut through
+        if (previous == UAVTALK_STATE_INSTID && *state != UAVTALK_STATE_INSTID && *state != UAVTALK_STATE_ERROR && relayFilter(iproc->objId)) {
+            uint8_t *header = inConnection->rxBuffer;
+            header[0] = UAVTALK_SYNC_VAL;
+            header[1] = iproc->type;
+            header[2] = (uint8_t)(iproc->packet_size & 0xFF);
+            header[3] = (uint8_t)((iproc->packet_size >> 8) & 0xFF);
+            header[4] = (uint8_t)(iproc->objId & 0xFF);
+            header[5] = (uint8_t)((iproc->objId >> 8) & 0xFF);
+            header[6] = (uint8_t)((iproc->objId >> 16) & 0xFF);
+            header[7] = (uint8_t)((iproc->objId >> 24) & 0xFF);
+            header[8] = (uint8_t)(iproc->instId & 0xFF);
+            header[9] = (uint8_t)((iproc->instId >> 8) & 0xFF);
+            iproc->relayCount  = UAVTALK_MIN_HEADER_LENGTH;
+            iproc->relayLength = iproc->packet_size + UAVTALK_CHECKSUM_LENGTH;
+            inConnection->stats.rxObjects++;
+            inConnection->stats.rxObjectBytes += iproc->length;
+        }
+    }
+
+    return position;
+}
+
+/**
+ * Copy and checksum as much of the current payload as the buffer holds.
+ * \param[in] connection UAVTalkConnectionData in the UAVTALK_STATE_DATA state
+ * \param[in] rxbuffer Received bytes
+ * \param[in] length Number of bytes in rxbuffer
+ * \return Number of bytes consumed
+ */
+static uint16_t receivePayloadSpan(UAVTalkConnectionData *connection, const uint8_t *rxbuffer, uint16_t length)
+{
+    UAVTalkInputProcessor *iproc = &connection->iproc;
+    uint16_t count = MIN(length, iproc->length - iproc->rxCount);
+
+    iproc->cs = PIOS_CRC_updateCRC(iproc->cs, rxbuffer, count);
+    memcpy(&connection->rxBuffer[iproc->rxCount], rxbuffer, count);
+    connection->stats.rxBytes += count;
+    iproc->rxPacketLength = MIN(0xffff, iproc->rxPacketLength + count);
+    iproc->rxCount += count;
+
+    if (iproc->rxCount >= iproc->length) {
+        iproc->rxCount = 0;
+        iproc->state   = UAVTALK_STATE_CS;
+    }
+    return count;
+}
+
+/**
+ * Send a raw packet given in two parts, the lock keeps other senders from interleaving
+ * \param[in] connection UAVTalkConnectionData to send on
+ * \param[in] head First part of the packet
+ * \param[in] headLength Length of the first part
+ * \param[in] tail Rest of the packet
+ * \param[in] tailLength Length of the rest
+ */
+static void relayRaw(UAVTalkConnectionData *connection, const uint8_t *head, uint16_t headLength, const uint8_t *tail, uint16_t tailLength)
+{
+    if (!connection->outStream) {
+        connection->stats.txErrors++;
+        return;
+    }
+
+    xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+
+    int32_t rc = (*connection->outStream)((uint8_t *)head, headLength);
+    if (rc == headLength && tailLength > 0) {
+        rc = (*connection->outStream)((uint8_t *)tail, tailLength);
+        if (rc == tailLength) {
+            rc += headLength;
+        }
+    }
+    connection->stats.txBytes += (rc > 0) ? rc : 0;
+    if (rc != headLength + tailLength) {
+        connection->stats.txErrors++;
+    }
+
+    xSemaphoreGiveRecursive(connection->lock);
+}
+
 /**
  * Send a parsed packet received on one connection handle out on a different connection handle.
  * The packet must be in a complete state, meaning it is completed parsing.
@@ -796,6 +1063,8 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
             // Object found, transmit it
             // The sent object will ack the object request on the receiver side
             ret = sendObject(connection, UAVTALK_TYPE_OBJ, objId, instId, obj);
+            // Do not hold the response back in a bundle
+            flushBundle(connection);
         } else {
             ret = -1;
         }
@@ -928,6 +1197,22 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         return -1;
     }
 
+    // Periodic updates are delta encoded instead of bundled
+    bool delta = false;
+    if (connection->deltas && type == UAVTALK_TYPE_OBJ && !UAVObjIsMetaobject(obj)) {
+        UAVObjMetadata metadata;
+        UAVObjGetMetadata(obj, &metadata);
+        delta = (UAVObjGetTelemetryUpdateMode(&metadata) == UPDATEMODE_PERIODIC);
+    }
+
+    if (connection->bundling) {
+        if (type == UAVTALK_TYPE_OBJ && !delta && bundleObject(connection, objId, instId, obj) == 0) {
+            return 0;
+        }
+        // Send pending updates first so that frames are not reordered
+        flushBundle(connection);
+    }
+
     // Setup sync byte
     connection->txBuffer[0] = UAVTALK_SYNC_VAL;
     // Setup type
@@ -973,6 +1258,11 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
         }
     }
 
+    // Replace the data by its delta to the previous update when it is smaller
+    if (delta) {
+        connection->txBuffer[1] = deltaEncode(connection, objId, instId, &connection->txBuffer[headerLength], &length);
+    }
+
     // Store the packet length
     connection->txBuffer[2] = (uint8_t)((headerLength + length) & 0xFF);
     connection->txBuffer[3] = (uint8_t)(((headerLength + length) >> 8) & 0xFF);
@@ -1000,6 +1290,200 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, uint8_t type,
     return 0;
 }
 
+/**
+ * Add an object update to the current bundle, the bundle is sent first if the update does not fit.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] obj Object handle to send
+ * \return 0 Success
+ * \return -1 The object can not be bundled
+ */
+static int32_t bundleObject(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, UAVObjHandle obj)
+{
+    int32_t length = UAVObjGetNumBytes(obj);
+
+    if (length + UAVTALK_BUNDLE_RECORD_HEADER_LENGTH > UAVTALK_MAX_BUNDLE_LENGTH) {
+        return -1;
+    }
+    if (connection->bundleLength + UAVTALK_BUNDLE_RECORD_HEADER_LENGTH + length > UAVTALK_MAX_BUNDLE_LENGTH) {
+        flushBundle(connection);
+    }
+
+    // Records follow the frame header : object ID(4), instance ID(2), length(1), data
+    uint8_t *record = &connection->bundleBuffer[UAVTALK_MIN_HEADER_LENGTH + connection->bundleLength];
+    record[0] = (uint8_t)(objId & 0xFF);
+    record[1] = (uint8_t)((objId >> 8) & 0xFF);
+    record[2] = (uint8_t)((objId >> 16) & 0xFF);
+    record[3] = (uint8_t)((objId >> 24) & 0xFF);
+    record[4] = (uint8_t)(instId & 0xFF);
+    record[5] = (uint8_t)((instId >> 8) & 0xFF);
+    record[6] = (uint8_t)length;
+    if (length > 0) {
+        if (UAVObjPack(obj, instId, &record[UAVTALK_BUNDLE_RECORD_HEADER_LENGTH]) == -1) {
+            return -1;
+        }
+    }
+
+    connection->bundleLength += UAVTALK_BUNDLE_RECORD_HEADER_LENGTH + length;
+    connection->bundleCount++;
+
+    // Done
+    return 0;
+}
+
+/**
+ * Send the current bundle. A bundle holding a single update is sent as a plain object frame.
+ * \param[in] connection UAVTalkConnection to be used
+ * \return 0 Success
+ * \return -1 Failure
+ */
+static int32_t flushBundle(UAVTalkConnectionData *connection)
+{
+    uint8_t *buffer = connection->bundleBuffer;
+    uint16_t count  = connection->bundleCount;
+    uint16_t length = connection->bundleLength;
+    uint16_t objectBytes;
+
+    if (count == 0) {
+        return 0;
+    }
+    connection->bundleLength = 0;
+    connection->bundleCount  = 0;
+
+    if (!connection->outStream) {
+        connection->stats.txErrors++;
+        return -1;
+    }
+
+    if (count == 1) {
+        // Turn the single record into a plain object frame
+        uint8_t *record = &buffer[UAVTALK_MIN_HEADER_LENGTH];
+        length    = record[6];
+        buffer[1] = UAVTALK_TYPE_OBJ;
+        memcpy(&buffer[4], record, 6);
+        memmove(&buffer[UAVTALK_MIN_HEADER_LENGTH], &record[UAVTALK_BUNDLE_RECORD_HEADER_LENGTH], length);
+        objectBytes = length;
+    } else {
+        // Object ID is zero for bundles, the instance ID holds the number of records
+        buffer[1] = UAVTALK_TYPE_BUNDLE;
+        buffer[4] = 0;
+        buffer[5] = 0;
+        buffer[6] = 0;
+        buffer[7] = 0;
+        buffer[8] = (uint8_t)(count & 0xFF);
+        buffer[9] = (uint8_t)((count >> 8) & 0xFF);
+        objectBytes = length - count * UAVTALK_BUNDLE_RECORD_HEADER_LENGTH;
+    }
+    buffer[0] = UAVTALK_SYNC_VAL;
+    buffer[2] = (uint8_t)((UAVTALK_MIN_HEADER_LENGTH + length) & 0xFF);
+    buffer[3] = (uint8_t)(((UAVTALK_MIN_HEADER_LENGTH + length) >> 8) & 0xFF);
+
+    // Calculate and store checksum
+    buffer[UAVTALK_MIN_HEADER_LENGTH + length] = PIOS_CRC_updateCRC(0, buffer, UAVTALK_MIN_HEADER_LENGTH + length);
+
+    // Send bundle
+    uint16_t tx_msg_len = UAVTALK_MIN_HEADER_LENGTH + length + UAVTALK_CHECKSUM_LENGTH;
+    int32_t rc = (*connection->outStream)(buffer, tx_msg_len);
+
+    // Update stats
+    if (rc == tx_msg_len) {
+        connection->stats.txObjects     += count;
+        connection->stats.txObjectBytes += objectBytes;
+        connection->stats.txBytes += tx_msg_len;
+    } else {
+        connection->stats.txErrors++;
+        connection->stats.txBytes += (rc > 0) ? rc : 0;
+        return -1;
+    }
+
+    // Done
+    return 0;
+}
+
+/**
+ * Delta encode a packed periodic object update against the copy last sent on this connection.
+ * The encoded data is the CRC of the complete object data(1), a bitmask of the changed bytes
+ * and the changed bytes. The receiver checks the CRC after applying the delta to its own copy.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] objId The object ID
+ * \param[in] instId The instance ID
+ * \param[in,out] data Packed object data, replaced by the encoded delta
+ * \param[in,out] length Length of the data
+ * \return UAVTALK_TYPE_OBJ_DELTA if the data was encoded, UAVTALK_TYPE_OBJ if it must be sent in full
+ */
+static uint8_t deltaEncode(UAVTalkConnectionData *connection, uint32_t objId, uint16_t instId, uint8_t *data, int32_t *length)
+{
+    UAVTalkDeltaShadow *shadow = NULL;
+    UAVTalkDeltaShadow *freeShadow = NULL;
+    uint8_t mask[(UAVTALK_DELTA_MAX_LENGTH + 7) / 8];
+    int32_t len = *length;
+    int32_t maskLength = (len + 7) / 8;
+    int32_t changed    = 0;
+    int32_t n;
+
+    if (len < UAVTALK_DELTA_MIN_LENGTH || len > UAVTALK_DELTA_MAX_LENGTH) {
+        return UAVTALK_TYPE_OBJ;
+    }
+
+    // Look for the shadow copy of this instance
+    for (n = 0; n < UAVTALK_DELTA_SHADOWS; ++n) {
+        UAVTalkDeltaShadow *s = &connection->deltaShadows[n];
+        if (s->data && s->objId == objId && s->instId == instId) {
+            shadow = s;
+            break;
+        }
+        if (!s->data && !freeShadow) {
+            freeShadow = s;
+        }
+    }
+    if (!shadow) {
+        // First update of this instance, it is sent in full and becomes the reference
+        if (freeShadow) {
+            freeShadow->data = pios_malloc(len);
+            if (freeShadow->data) {
+                freeShadow->objId   = objId;
+                freeShadow->instId  = instId;
+                freeShadow->updates = 0;
+                memcpy(freeShadow->data, data, len);
+            }
+        }
+        return UAVTALK_TYPE_OBJ;
+    }
+
+    memset(mask, 0, maskLength);
+    for (n = 0; n < len; ++n) {
+        if (data[n] != shadow->data[n]) {
+            mask[n / 8] |= 1 << (n % 8);
+            changed++;
+        }
+    }
+    memcpy(shadow->data, data, len);
+
+    // Send a full update when it is due or when the delta would not be smaller
+    if (shadow->updates >= UAVTALK_DELTA_KEYFRAME_INTERVAL || 1 + maskLength + changed >= len) {
+        shadow->updates = 0;
+        return UAVTALK_TYPE_OBJ;
+    }
+    shadow->updates++;
+
+    uint8_t crc = PIOS_CRC_updateCRC(0, data, len);
+
+    // Gather the changed bytes in place then make room for the CRC and the mask
+    changed = 0;
+    for (n = 0; n < len; ++n) {
+        if (mask[n / 8] & (1 << (n % 8))) {
+            data[changed++] = data[n];
+        }
+    }
+    memmove(&data[1 + maskLength], data, changed);
+    data[0] = crc;
+    memcpy(&data[1], mask, maskLength);
+    *length = 1 + maskLength + changed;
+
+    return UAVTALK_TYPE_OBJ_DELTA;
+}
+
 /**
  * @}
  * @}
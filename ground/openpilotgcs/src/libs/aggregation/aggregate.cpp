@@ -171,6 +171,23 @@ QHash<QObject *, Aggregate *> &Aggregate::aggregateMap()
     return map;
 }
 
+QAtomicInt &Aggregate::generationCounter()
+{
+    static QAtomicInt counter;
+
+    return counter;
+}
+
+/*!
+    \fn int Aggregate::generation()
+
+    Returns a number that changes whenever any aggregate gains or loses a component.
+ */
+int Aggregate::generation()
+{
+    return generationCounter().load();
+}
+
 /*!
     \fn QReadWriteLock &Aggregate::lock()
     \internal
@@ -195,6 +212,7 @@ Aggregate::Aggregate(QObject *parent)
     QWriteLocker locker(&lock());
 
     aggregateMap().insert(this, this);
+    generationCounter().ref();
 }
 
 /*!
@@ -213,6 +231,7 @@ Aggregate::~Aggregate()
     qDeleteAll(m_components);
     m_components.clear();
     aggregateMap().remove(this);
+    generationCounter().ref();
 }
 
 void Aggregate::deleteSelf(QObject *obj)
@@ -221,6 +240,7 @@ void Aggregate::deleteSelf(QObject *obj)
         QWriteLocker locker(&lock());
         aggregateMap().remove(obj);
         m_components.removeAll(obj);
+        generationCounter().ref();
     }
     delete this;
 }
@@ -248,6 +268,7 @@ void Aggregate::add(QObject *component)
     m_components.append(component);
     connect(component, SIGNAL(destroyed(QObject *)), this, SLOT(deleteSelf(QObject *)));
     aggregateMap().insert(component, this);
+    generationCounter().ref();
 }
 
 /*!
@@ -266,4 +287,5 @@ void Aggregate::remove(QObject *component)
     aggregateMap().remove(component);
     m_components.removeAll(component);
     disconnect(component, SIGNAL(destroyed(QObject *)), this, SLOT(deleteSelf(QObject *)));
+    generationCounter().ref();
 }
@@ -36,6 +36,7 @@
 #include <QtCore/QHash>
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QReadLocker>
+#include <QtCore/QAtomicInt>
 
 namespace Aggregation {
 class AGGREGATION_EXPORT Aggregate : public QObject {
@@ -50,7 +51,7 @@ public:
 
     template <typename T> T *component()
     {
-        QReadLocker(&lock());
+        QReadLocker locker(&lock());
         foreach(QObject * component, m_components) {
             if (T * result = qobject_cast<T *>(component)) {
                 return result;
@@ -61,7 +62,7 @@ public:
 
     template <typename T> QList<T *> components()
     {
-        QReadLocker(&lock());
+        QReadLocker locker(&lock());
         QList<T *> results;
         foreach(QObject * component, m_components) {
             if (T * result = qobject_cast<T *>(component)) {
@@ -73,12 +74,16 @@ public:
 
     static Aggregate *parentAggregate(QObject *obj);
     static QReadWriteLock &lock();
+    // changes whenever a component is added to or removed from any aggregate,
+    // lets callers cache query results
+    static int generation();
 
 private slots:
     void deleteSelf(QObject *obj);
 
 private:
     static QHash<QObject *, Aggregate *> &aggregateMap();
+    static QAtomicInt &generationCounter();
 
     QList<QObject *> m_components;
 };
@@ -8,7 +8,7 @@ unix:!macx:!freebsd*:LIBS += -ldl
 
 DEFINES += GCS_TEST_DIR=\\\"$$GCS_SOURCE_TREE\\\"
 
-QT += widgets
+QT += widgets concurrent
 
 HEADERS += pluginerrorview.h \
     plugindetailsview.h \
@@ -21,14 +21,16 @@ HEADERS += pluginerrorview.h \
     pluginspec_p.h \
     pluginview.h \
     pluginview_p.h \
-    optionsparser.h
+    optionsparser.h \
+    startuptrace.h
 SOURCES += pluginerrorview.cpp \
     plugindetailsview.cpp \
     iplugin.cpp \
     pluginmanager.cpp \
     pluginspec.cpp \
     pluginview.cpp \
-    optionsparser.cpp
+    optionsparser.cpp \
+    startuptrace.cpp
 FORMS += pluginview.ui \
     pluginerrorview.ui \
     plugindetailsview.ui
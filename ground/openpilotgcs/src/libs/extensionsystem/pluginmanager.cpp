@@ -32,11 +32,16 @@
 #include "pluginspec_p.h"
 #include "optionsparser.h"
 #include "iplugin.h"
+#include "startuptrace.h"
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
 #include <QtCore/QTextStream>
 #include <QtCore/QWriteLocker>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QHash>
+#include <QtCore/QElapsedTimer>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtDebug>
 #ifdef WITH_TESTS
 #include <QTest>
@@ -231,6 +236,36 @@ QList<QObject *> PluginManager::allObjects() const
     return d->allObjects;
 }
 
+/*!
+    \fn bool PluginManager::cachedQuery(const void *type, bool all, int aggregateGeneration, QList<void *> *objects) const
+    \internal
+ */
+bool PluginManager::cachedQuery(const void *type, bool all, int aggregateGeneration, QList<void *> *objects) const
+{
+    QMutexLocker locker(&d->queryCacheLock);
+    QHash<QPair<const void *, bool>, PluginManagerPrivate::CachedQuery>::const_iterator it =
+        d->queryCache.constFind(qMakePair(type, all));
+
+    if (it == d->queryCache.constEnd() || it->aggregateGeneration != aggregateGeneration) {
+        return false;
+    }
+    *objects = it->objects;
+    return true;
+}
+
+/*!
+    \fn void PluginManager::cacheQuery(const void *type, bool all, int aggregateGeneration, const QList<void *> &objects) const
+    \internal
+ */
+void PluginManager::cacheQuery(const void *type, bool all, int aggregateGeneration, const QList<void *> &objects) const
+{
+    QMutexLocker locker(&d->queryCacheLock);
+    PluginManagerPrivate::CachedQuery &entry = d->queryCache[qMakePair(type, all)];
+
+    entry.aggregateGeneration = aggregateGeneration;
+    entry.objects = objects;
+}
+
 /*!
     \fn void PluginManager::loadPlugins()
     Tries to load all the plugins that were previously found when
@@ -545,6 +580,7 @@ void PluginManagerPrivate::addObject(QObject *obj)
         }
 
         allObjects.append(obj);
+        queryCache.clear();
     }
     emit q->objectAdded(obj);
 }
@@ -572,6 +608,20 @@ void PluginManagerPrivate::removeObject(QObject *obj)
     emit q->aboutToRemoveObject(obj);
     QWriteLocker lock(&(q->m_lock));
     allObjects.removeAll(obj);
+    queryCache.clear();
+}
+
+static void preloadLibrary(PluginSpec *spec)
+{
+    spec->d->preloadLibrary();
+}
+
+static void readSpec(PluginSpec *spec)
+{
+    // read() resets the spec
+    const QString fileName = spec->d->filePath;
+
+    spec->d->read(fileName);
 }
 
 /*!
@@ -580,7 +630,17 @@ void PluginManagerPrivate::removeObject(QObject *obj)
  */
 void PluginManagerPrivate::loadPlugins()
 {
+    StartupTrace::Span span("startup", QLatin1String("loadPlugins"));
+    QElapsedTimer timer;
+
+    timer.start();
     QList<PluginSpec *> queue = loadQueue();
+    // the libraries of a level only depend on the levels before, open them in parallel;
+    // the instances are still created in the main thread
+    QList<QList<PluginSpec *> > levels = dependencyLevels(queue);
+    for (int i = 0; i < levels.count(); ++i) {
+        QtConcurrent::blockingMap(levels[i], preloadLibrary);
+    }
     foreach(PluginSpec * spec, queue) {
         loadPlugin(spec, PluginSpec::Loaded);
     }
@@ -594,11 +654,41 @@ void PluginManagerPrivate::loadPlugins()
         emit q->pluginAboutToBeLoaded(plugin);
         loadPlugin(plugin, PluginSpec::Running);
     }
+    foreach(PluginSpec * spec, queue) {
+        qDebug() << "PluginManager -" << spec->name() << "load" << spec->d->loadTime << "ms, initialize"
+                 << spec->d->initializeTime << "ms, extensions" << spec->d->extensionsTime << "ms";
+    }
+    qDebug() << "PluginManager - loaded" << queue.count() << "plugins in" << timer.elapsed() << "ms";
     emit q->pluginsChanged();
     q->m_allPluginsLoaded = true;
     emit q->pluginsLoadEnded();
 }
 
+/*!
+    \fn QList<QList<PluginSpec *> > PluginManagerPrivate::dependencyLevels(const QList<PluginSpec *> &queue) const
+    \internal
+    Groups the load queue by dependency depth, a plugin comes one level after its deepest dependency.
+ */
+QList<QList<PluginSpec *> > PluginManagerPrivate::dependencyLevels(const QList<PluginSpec *> &queue) const
+{
+    QList<QList<PluginSpec *> > levels;
+    QHash<PluginSpec *, int> depth;
+
+    // the queue has the dependencies of a plugin before it
+    foreach(PluginSpec * spec, queue) {
+        int level = 0;
+        foreach(PluginSpec * dep, spec->dependencySpecs()) {
+            level = qMax(level, depth.value(dep, -1) + 1);
+        }
+        depth.insert(spec, level);
+        if (level >= levels.count()) {
+            levels.append(QList<PluginSpec *>());
+        }
+        levels[level].append(spec);
+    }
+    return levels;
+}
+
 /*!
     \fn void PluginManagerPrivate::loadQueue()
     \internal
@@ -725,9 +815,11 @@ void PluginManagerPrivate::readPluginPaths()
     foreach(const QString &specFile, specFiles) {
         PluginSpec *spec = new PluginSpec;
 
-        spec->d->read(specFile);
+        spec->d->filePath = specFile;
         pluginSpecs.append(spec);
     }
+    // the specs are independent of each other until their dependencies are resolved
+    QtConcurrent::blockingMap(pluginSpecs, readSpec);
     resolveDependencies();
     // ensure deterministic plugin load order by sorting
     qSort(pluginSpecs.begin(), pluginSpecs.end(), lessThanByPluginName);
@@ -70,6 +70,14 @@ public:
         QReadLocker lock(&m_lock);
 
         QList<T *> results;
+        QList<void *> cached;
+        const int generation = Aggregation::Aggregate::generation();
+        if (cachedQuery(typeKey<T>(), true, generation, &cached)) {
+            foreach(void * obj, cached) {
+                results << static_cast<T *>(obj);
+            }
+            return results;
+        }
         QList<QObject *> all = allObjects();
         QList<T *> result;
         foreach(QObject * obj, all) {
@@ -78,12 +86,21 @@ public:
                 results += result;
             }
         }
+        foreach(T * obj, results) {
+            cached << static_cast<void *>(obj);
+        }
+        cacheQuery(typeKey<T>(), true, generation, cached);
         return results;
     }
     template <typename T> T *getObject() const
     {
         QReadLocker lock(&m_lock);
 
+        QList<void *> cached;
+        const int generation = Aggregation::Aggregate::generation();
+        if (cachedQuery(typeKey<T>(), false, generation, &cached)) {
+            return cached.isEmpty() ? 0 : static_cast<T *>(cached.first());
+        }
         QList<QObject *> all = allObjects();
         T *result = 0;
         foreach(QObject * obj, all) {
@@ -91,6 +108,10 @@ public:
                 break;
             }
         }
+        if (result) {
+            cached << static_cast<void *>(result);
+        }
+        cacheQuery(typeKey<T>(), false, generation, cached);
         return result;
     }
 
@@ -131,6 +152,18 @@ private:
     mutable QReadWriteLock m_lock;
     bool m_allPluginsLoaded;
 
+    // the address of a static unique to T identifies the type in the query cache
+    template <typename T> static const void *typeKey()
+    {
+        static const char key = 0;
+
+        return &key;
+    }
+    // getObject() and getObjects() results by type, valid while neither the pool
+    // nor an aggregate has changed, must be called with m_lock held
+    bool cachedQuery(const void *type, bool all, int aggregateGeneration, QList<void *> *objects) const;
+    void cacheQuery(const void *type, bool all, int aggregateGeneration, const QList<void *> &objects) const;
+
     friend class Internal::PluginManagerPrivate;
 };
 } // namespace ExtensionSystem
@@ -32,6 +32,9 @@
 #include "pluginspec.h"
 
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
@@ -64,6 +67,16 @@ public:
     QString extension;
     QList<QObject *> allObjects; // ### make this a QList<QPointer<QObject> > > ?
 
+    // getObject() and getObjects() results keyed by type and by whether all matches
+    // were asked for, cleared when the pool changes, stale once an aggregate changes
+    struct CachedQuery {
+        int aggregateGeneration;
+        QList<void *> objects;
+    };
+    QHash<QPair<const void *, bool>, CachedQuery> queryCache;
+    // readers of the pool share m_lock, this one serializes their cache updates
+    QMutex queryCacheLock;
+
     QStringList arguments;
 
     // Look in argument descriptions of the specs for the option.
@@ -77,6 +90,7 @@ private:
     PluginManager *q;
 
     void readPluginPaths();
+    QList<QList<PluginSpec *> > dependencyLevels(const QList<PluginSpec *> &queue) const;
     bool loadQueue(PluginSpec *spec,
                    QList<PluginSpec *> &queue,
                    QList<PluginSpec *> &circularityCheckQueue);
@@ -32,12 +32,15 @@
 #include "iplugin.h"
 #include "iplugin_p.h"
 #include "pluginmanager.h"
+#include "startuptrace.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QRegExp>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QLibrary>
+#include <QtCore/QElapsedTimer>
 #include <QtDebug>
 
 #ifdef Q_OS_LINUX
@@ -384,6 +387,9 @@ PluginSpecPrivate::PluginSpecPrivate(PluginSpec *spec)
     : plugin(0),
     state(PluginSpec::Invalid),
     hasError(false),
+    loadTime(0),
+    initializeTime(0),
+    extensionsTime(0),
     q(spec)
 {}
 
@@ -690,7 +696,10 @@ QRegExp &PluginSpecPrivate::versionRegExp()
  */
 bool PluginSpecPrivate::isValidVersion(const QString &version)
 {
-    return versionRegExp().exactMatch(version);
+    // a copy keeps its own match state, the specs are read in parallel
+    QRegExp reg = versionRegExp();
+
+    return reg.exactMatch(version);
 }
 
 /*!
@@ -770,22 +779,11 @@ bool PluginSpecPrivate::resolveDependencies(const QList<PluginSpec *> &specs)
 }
 
 /*!
-    \fn bool PluginSpecPrivate::loadLibrary()
+    \fn QString PluginSpecPrivate::libraryFileName() const
     \internal
  */
-bool PluginSpecPrivate::loadLibrary()
+QString PluginSpecPrivate::libraryFileName() const
 {
-    if (hasError) {
-        return false;
-    }
-    if (state != PluginSpec::Resolved) {
-        if (state == PluginSpec::Loaded) {
-            return true;
-        }
-        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
-        hasError    = true;
-        return false;
-    }
 #ifdef QT_NO_DEBUG
 
 #ifdef Q_OS_WIN
@@ -808,6 +806,52 @@ bool PluginSpecPrivate::loadLibrary()
 
 #endif
 
+    return libName;
+}
+
+/*!
+    \fn void PluginSpecPrivate::preloadLibrary()
+    \internal
+    Opens the library of the plugin, can be called from any thread. The plugin
+    instance is still created by loadLibrary(), which also reports the errors.
+ */
+void PluginSpecPrivate::preloadLibrary()
+{
+    if (hasError || state != PluginSpec::Resolved) {
+        return;
+    }
+    StartupTrace::Span span("preload", name);
+    QElapsedTimer timer;
+    timer.start();
+
+    // the library stays loaded when the QLibrary is destroyed
+    QLibrary library(libraryFileName());
+    library.load();
+    loadTime = timer.elapsed();
+}
+
+/*!
+    \fn bool PluginSpecPrivate::loadLibrary()
+    \internal
+ */
+bool PluginSpecPrivate::loadLibrary()
+{
+    if (hasError) {
+        return false;
+    }
+    if (state != PluginSpec::Resolved) {
+        if (state == PluginSpec::Loaded) {
+            return true;
+        }
+        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
+        hasError    = true;
+        return false;
+    }
+    StartupTrace::Span span("load", name);
+    QElapsedTimer timer;
+    timer.start();
+
+    QString libName = libraryFileName();
     PluginLoader loader(libName);
     if (!loader.load()) {
         hasError    = true;
@@ -824,6 +868,7 @@ bool PluginSpecPrivate::loadLibrary()
     state  = PluginSpec::Loaded;
     plugin = pluginObject;
     plugin->d->pluginSpec = q;
+    loadTime += timer.elapsed();
     return true;
 }
 
@@ -849,8 +894,14 @@ bool PluginSpecPrivate::initializePlugin()
         hasError    = true;
         return false;
     }
+    StartupTrace::Span span("initialize", name);
+    QElapsedTimer timer;
+    timer.start();
+
     QString err;
-    if (!plugin->initialize(arguments, &err)) {
+    bool initialized = plugin->initialize(arguments, &err);
+    initializeTime = timer.elapsed();
+    if (!initialized) {
         errorString = QCoreApplication::translate("PluginSpec", "Plugin initialization failed: %1").arg(err);
         hasError    = true;
         return false;
@@ -881,7 +932,12 @@ bool PluginSpecPrivate::initializeExtensions()
         hasError    = true;
         return false;
     }
+    StartupTrace::Span span("extensions", name);
+    QElapsedTimer timer;
+    timer.start();
+
     plugin->extensionsInitialized();
+    extensionsTime = timer.elapsed();
     state = PluginSpec::Running;
     return true;
 }
@@ -49,6 +49,7 @@ public:
     bool read(const QString &fileName);
     bool provides(const QString &pluginName, const QString &version) const;
     bool resolveDependencies(const QList<PluginSpec *> &specs);
+    void preloadLibrary();
     bool loadLibrary();
     bool initializePlugin();
     bool initializeExtensions();
@@ -77,6 +78,11 @@ public:
     bool hasError;
     QString errorString;
 
+    // time spent in each startup stage, in ms
+    qint64 loadTime;
+    qint64 initializeTime;
+    qint64 extensionsTime;
+
     static bool isValidVersion(const QString &version);
     static int versionCompare(const QString &version1, const QString &version2);
 
@@ -84,6 +90,7 @@ private:
     PluginSpec *q;
 
     bool reportError(const QString &err);
+    QString libraryFileName() const;
     void readPluginSpec(QXmlStreamReader &reader);
     void readDependencies(QXmlStreamReader &reader);
     void readDependencyEntry(QXmlStreamReader &reader);
@@ -0,0 +1,211 @@
+/**
+ ******************************************************************************
+ *
+ * @file       startuptrace.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Records where the GCS startup time goes
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "startuptrace.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QEvent>
+#include <QtWidgets/QWidget>
+#include <QtDebug>
+
+using namespace ExtensionSystem;
+
+StartupTrace::StartupTrace() :
+    m_fileName(QString::fromLocal8Bit(qgetenv("OPENPILOT_STARTUP_TRACE"))),
+    m_mainWindow(0), m_finished(false)
+{
+    m_clock.start();
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+    }
+}
+
+StartupTrace *StartupTrace::instance()
+{
+    // created by the first span, the paint events are filtered in the GUI thread
+    static StartupTrace *trace = new StartupTrace;
+
+    return trace;
+}
+
+bool StartupTrace::isEnabled()
+{
+    StartupTrace *trace = instance();
+
+    return !trace->m_fileName.isEmpty() && !trace->m_finished;
+}
+
+qint64 StartupTrace::now()
+{
+    return instance()->m_clock.nsecsElapsed() / 1000;
+}
+
+void StartupTrace::record(const char *category, const QString &name, qint64 start, qint64 duration)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    StartupTrace *trace = instance();
+    Event e;
+    e.category = category;
+    e.name     = name;
+    e.start    = start;
+    e.duration = duration;
+    e.thread   = (quintptr)QThread::currentThreadId();
+
+    QMutexLocker locker(&trace->m_lock);
+    trace->m_events.append(e);
+}
+
+StartupTrace::Span::Span(const char *category, const QString &name) :
+    m_category(category), m_name(name), m_start(isEnabled() ? now() : -1)
+{}
+
+StartupTrace::Span::~Span()
+{
+    if (m_start >= 0) {
+        record(m_category, m_name, m_start, now() - m_start);
+    }
+}
+
+void StartupTrace::watchFirstPaint(QWidget *widget, const QString &name)
+{
+    if (!isEnabled() || !widget) {
+        return;
+    }
+    StartupTrace *trace = instance();
+    trace->m_pendingPaints.insert(widget, qMakePair(name, now()));
+    widget->installEventFilter(trace);
+    connect(widget, SIGNAL(destroyed(QObject *)), trace, SLOT(forget(QObject *)));
+}
+
+void StartupTrace::finishOnFirstPaint(QWidget *mainWindow)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    StartupTrace *trace = instance();
+    trace->m_mainWindow = mainWindow;
+    mainWindow->installEventFilter(trace);
+}
+
+bool StartupTrace::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::Paint) {
+        obj->removeEventFilter(this);
+        if (m_pendingPaints.contains(obj)) {
+            QPair<QString, qint64> pending = m_pendingPaints.take(obj);
+            record("paint", pending.first, pending.second, now() - pending.second);
+        }
+        if (obj == m_mainWindow) {
+            record("paint", QLatin1String("MainWindow"), 0, now());
+            // the visible gadgets are painted in the same pass
+            QTimer::singleShot(0, this, SLOT(finish()));
+        }
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void StartupTrace::forget(QObject *obj)
+{
+    m_pendingPaints.remove(obj);
+}
+
+void StartupTrace::finish()
+{
+    if (m_finished) {
+        return;
+    }
+    write();
+    m_finished = true;
+    foreach(QObject * obj, m_pendingPaints.keys()) {
+        obj->removeEventFilter(this);
+        disconnect(obj, 0, this, 0);
+    }
+    m_pendingPaints.clear();
+    m_events.clear();
+}
+
+void StartupTrace::write()
+{
+    QMutexLocker locker(&m_lock);
+
+    QFile json(m_fileName + QLatin1String(".json"));
+
+    if (json.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QTextStream out(&json);
+        out << "{\"traceEvents\":[\n";
+        for (int i = 0; i < m_events.count(); ++i) {
+            const Event &e = m_events.at(i);
+            QString name   = e.name;
+            name.replace(QLatin1Char('\\'), QLatin1String("\\\\")).replace(QLatin1Char('"'), QLatin1String("\\\""));
+            out << "{\"name\":\"" << name << "\",\"cat\":\"" << e.category
+                << "\",\"ph\":\"X\",\"ts\":" << e.start << ",\"dur\":" << e.duration
+                << ",\"pid\":" << QCoreApplication::applicationPid() << ",\"tid\":" << e.thread << "}"
+                << (i + 1 < m_events.count() ? ",\n" : "\n");
+        }
+        out << "],\"displayTimeUnit\":\"ms\"}\n";
+    } else {
+        qWarning() << "StartupTrace - can't write" << json.fileName();
+    }
+
+    // the report lists the categories by total time, then every span by duration
+    QFile txt(m_fileName + QLatin1String(".txt"));
+    if (txt.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QTextStream out(&txt);
+        QMap<QString, qint64> totals;
+        QMultiMap<qint64, int> byDuration;
+        for (int i = 0; i < m_events.count(); ++i) {
+            totals[QLatin1String(m_events.at(i).category)] += m_events.at(i).duration;
+            byDuration.insert(m_events.at(i).duration, i);
+        }
+        out << "GCS startup, main window painted after " << now() / 1000 << " ms\n\n";
+        for (QMap<QString, qint64>::const_iterator it = totals.constBegin(); it != totals.constEnd(); ++it) {
+            out << qSetFieldWidth(12) << left << it.key() << qSetFieldWidth(10) << right
+                << QString::number(it.value() / 1000.0, 'f', 1) << qSetFieldWidth(0) << " ms\n";
+        }
+        out << "\n";
+        QMapIterator<qint64, int> it(byDuration);
+        it.toBack();
+        while (it.hasPrevious()) {
+            it.previous();
+            const Event &e = m_events.at(it.value());
+            out << qSetFieldWidth(10) << right << QString::number(e.duration / 1000.0, 'f', 1)
+                << qSetFieldWidth(0) << " ms  " << qSetFieldWidth(12) << left << e.category
+                << qSetFieldWidth(0) << e.name << "\n";
+        }
+    } else {
+        qWarning() << "StartupTrace - can't write" << txt.fileName();
+    }
+    qDebug() << "StartupTrace - wrote" << m_events.count() << "events to" << m_fileName + QLatin1String(".json");
+}
@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ *
+ * @file       startuptrace.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Records where the GCS startup time goes
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include "extensionsystem_global.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QElapsedTimer>
+
+QT_BEGIN_NAMESPACE
+class QWidget;
+QT_END_NAMESPACE
+
+namespace ExtensionSystem {
+/*
+ * Startup trace, only recorded when the OPENPILOT_STARTUP_TRACE environment variable
+ * names an output file. Once the main window has been painted the first time a
+ * summary is written to <file>.txt and the trace events to <file>.json, which
+ * chrome://tracing and similar viewers open.
+ *
+ * The spans can be recorded from any thread.
+ */
+class EXTENSIONSYSTEM_EXPORT StartupTrace : public QObject {
+    Q_OBJECT
+
+public:
+    // records the time from construction to destruction
+    class EXTENSIONSYSTEM_EXPORT Span {
+public:
+        Span(const char *category, const QString &name);
+        ~Span();
+
+private:
+        const char *m_category;
+        QString m_name;
+        qint64 m_start;
+    };
+
+    static bool isEnabled();
+    // microseconds since the trace started
+    static qint64 now();
+    static void record(const char *category, const QString &name, qint64 start, qint64 duration);
+
+    // records the time from now to the first paint of widget
+    static void watchFirstPaint(QWidget *widget, const QString &name);
+    // writes the files once mainWindow has been painted
+    static void finishOnFirstPaint(QWidget *mainWindow);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event);
+
+private slots:
+    void forget(QObject *obj);
+    void finish();
+
+private:
+    struct Event {
+        const char *category;
+        QString     name;
+        qint64      start;
+        qint64      duration;
+        quintptr    thread;
+    };
+
+    StartupTrace();
+    static StartupTrace *instance();
+    void write();
+
+    QString m_fileName;
+    QElapsedTimer m_clock;
+    QMutex m_lock;
+    QList<Event> m_events;
+    // name and start of the widgets waiting for their first paint
+    QHash<QObject *, QPair<QString, qint64> > m_pendingPaints;
+    QObject *m_mainWindow;
+    bool m_finished;
+};
+} // namespace ExtensionSystem
+
+#endif // STARTUPTRACE_H
@@ -36,9 +36,15 @@ struct diagnostics {
     int     tilesFromMem;
     int     tilesFromNet;
     int     tilesFromDB;
+    int     memCacheMisses;
+    int     decodedCacheHits;
+    int     decodedCacheMisses;
+    int     tilesQueued;
+    int     tilesWritten;
+    qint64  bytesWritten;
     QString toString()
     {
-        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB);
+        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7\nMemCacheMisses:%8\nDecodedHits:%9\nDecodedMisses:%10\nTilesQueued:%11\nTilesWritten:%12\nBytesWritten:%13").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB).arg(memCacheMisses).arg(decodedCacheHits).arg(decodedCacheMisses).arg(tilesQueued).arg(tilesWritten).arg(bytesWritten);
 
         ;
     }
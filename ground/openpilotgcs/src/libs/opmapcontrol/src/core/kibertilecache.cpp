@@ -26,43 +26,124 @@
  */
 #include "kibertilecache.h"
 
-// TODO add readwrite lock
-
 namespace core {
-KiberTileCache::KiberTileCache()
+// QCache costs are int, keep budgets below 2GB
+static int CapacityToCost(int mb)
 {
-    memoryCacheSize = 0;
-    _MemoryCacheCapacity = 22;
+    return qBound(0, mb, 2047) * 1048576;
+}
+
+KiberTileCache::KiberTileCache() : _MemoryCacheCapacity(22), _DecodedCacheCapacity(32), misses(0), decodedHits(0), decodedMisses(0)
+{
+    cachequeue.setMaxCost(CapacityToCost(_MemoryCacheCapacity));
+    decodedqueue.setMaxCost(CapacityToCost(_DecodedCacheCapacity));
 }
 
 void KiberTileCache::setMemoryCacheCapacity(const int &value)
 {
-    kiberCacheLock.lockForWrite();
+    QMutexLocker locker(&mutex);
+
     _MemoryCacheCapacity = value;
-    kiberCacheLock.unlock();
+    cachequeue.setMaxCost(CapacityToCost(value));
 }
 int KiberTileCache::MemoryCacheCapacity()
 {
-    kiberCacheLock.lockForRead();
+    QMutexLocker locker(&mutex);
+
     return _MemoryCacheCapacity;
+}
+double KiberTileCache::MemoryCacheSize()
+{
+    QMutexLocker locker(&mutex);
+
+    return cachequeue.totalCost() / 1048576.0;
+}
+void KiberTileCache::setDecodedCacheCapacity(const int &value)
+{
+    QMutexLocker locker(&mutex);
 
-    kiberCacheLock.unlock();
+    _DecodedCacheCapacity = value;
+    decodedqueue.setMaxCost(CapacityToCost(value));
+}
+int KiberTileCache::DecodedCacheCapacity()
+{
+    QMutexLocker locker(&mutex);
+
+    return _DecodedCacheCapacity;
+}
+double KiberTileCache::DecodedCacheSize()
+{
+    QMutexLocker locker(&mutex);
+
+    return decodedqueue.totalCost() / 1048576.0;
 }
 
 void KiberTileCache::RemoveMemoryOverload()
 {
-    while (MemoryCacheSize() > MemoryCacheCapacity()) {
-        if (cachequeue.count() > 0 && list.count() > 0) {
+    // QCache evicts the least recently used tiles on insert, this only
+    // reapplies the budgets
+    QMutexLocker locker(&mutex);
+
+    cachequeue.setMaxCost(CapacityToCost(_MemoryCacheCapacity));
+    decodedqueue.setMaxCost(CapacityToCost(_DecodedCacheCapacity));
 #ifdef DEBUG_MEMORY_CACHE
-            qDebug() << "Cleaning Memory cache=" << " started with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Cleaning Memory cache=" << " ended with " << cachequeue.count() << " tile " << "ocupying " << cachequeue.totalCost() << " bytes";
 #endif
-            RawTile first = list.dequeue();
-            memoryCacheSize -= cachequeue.value(first).size();
-            cachequeue.remove(first);
-        }
+}
+
+QByteArray KiberTileCache::GetTile(const RawTile &tile)
+{
+    QMutexLocker locker(&mutex);
+    // object() moves the tile to the front of the LRU list
+    QByteArray *pic = cachequeue.object(tile);
+
+    if (!pic) {
+        ++misses;
+        return QByteArray();
     }
+    return *pic;
+}
+void KiberTileCache::AddTile(const RawTile &tile, const QByteArray &pic)
+{
+    QMutexLocker locker(&mutex);
+
+    cachequeue.insert(tile, new QByteArray(pic), pic.size());
 #ifdef DEBUG_MEMORY_CACHE
-    qDebug() << "Cleaning Memory cache=" << " ended with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Current memory=" << cachequeue.totalCost() << " in " << cachequeue.count() << " tiles";
 #endif
 }
+QImage KiberTileCache::GetDecodedTile(const RawTile &tile, const QByteArray &pic)
+{
+    {
+        QMutexLocker locker(&mutex);
+        QImage *img = decodedqueue.object(tile);
+        if (img) {
+            ++decodedHits;
+            return *img;
+        }
+        ++decodedMisses;
+    }
+    // decode without holding the lock, the loader threads must not wait for it
+    QImage img = QImage::fromData(pic);
+    if (img.isNull()) {
+        return img;
+    }
+    // premultiplied ARGB is what the raster paint engine blends fastest
+    if (img.hasAlphaChannel()) {
+        img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    QMutexLocker locker(&mutex);
+    if (_DecodedCacheCapacity > 0) {
+        decodedqueue.insert(tile, new QImage(img), img.byteCount());
+    }
+    return img;
+}
+void KiberTileCache::GetDiagnostics(diagnostics &diag)
+{
+    QMutexLocker locker(&mutex);
+
+    diag.memCacheMisses     = misses;
+    diag.decodedCacheHits   = decodedHits;
+    diag.decodedCacheMisses = decodedMisses;
+}
 }
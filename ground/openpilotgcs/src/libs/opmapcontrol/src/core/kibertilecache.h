@@ -28,29 +28,43 @@
 #define KIBERTILECACHE_H
 
 #include "rawtile.h"
+#include "diagnostics.h"
 #include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
+#include <QCache>
+#include <QImage>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+// Two tier LRU tile cache, the encoded tile data and optionally the decoded
+// images, each limited by a byte budget. Thread safe.
 class KiberTileCache {
 public:
     KiberTileCache();
 
+    // encoded tier budget in MB
     void setMemoryCacheCapacity(const int &value);
     int MemoryCacheCapacity();
-    double MemoryCacheSize()
-    {
-        return memoryCacheSize / 1048576.0;
-    }
+    double MemoryCacheSize();
+    // decoded tier budget in MB, 0 disables it
+    void setDecodedCacheCapacity(const int &value);
+    int DecodedCacheCapacity();
+    double DecodedCacheSize();
     void RemoveMemoryOverload();
-    QReadWriteLock kiberCacheLock;
-    QHash <RawTile, QByteArray> cachequeue;
-    QQueue <RawTile> list;
-    long memoryCacheSize;
+
+    QByteArray GetTile(const RawTile &tile);
+    void AddTile(const RawTile &tile, const QByteArray &pic);
+    // returns the decoded image of pic, from the decoded tier if possible
+    QImage GetDecodedTile(const RawTile &tile, const QByteArray &pic);
+    void GetDiagnostics(diagnostics &diag);
 private:
+    QMutex mutex;
+    QCache<RawTile, QByteArray> cachequeue;
+    QCache<RawTile, QImage> decodedqueue;
     int _MemoryCacheCapacity;
+    int _DecodedCacheCapacity;
+    int misses;
+    int decodedHits;
+    int decodedMisses;
 };
 }
 #endif // KIBERTILECACHE_H
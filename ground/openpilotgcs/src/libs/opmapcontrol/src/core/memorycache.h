@@ -29,8 +29,6 @@
 
 #include "rawtile.h"
 #include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
 #include "kibertilecache.h"
 #include <QDebug>
 #include "debugheader.h"
@@ -42,7 +40,7 @@ public:
     KiberTileCache TilesInMemory;
     QByteArray GetTileFromMemoryCache(const RawTile &tile);
     void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
-    QReadWriteLock kiberCacheLock;
+    QImage GetDecodedTileFromMemoryCache(const RawTile &tile, const QByteArray &pic);
 };
 }
 #endif // MEMORYCACHE_H
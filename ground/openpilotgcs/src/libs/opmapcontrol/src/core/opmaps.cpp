@@ -43,16 +43,20 @@ OPMaps::OPMaps() : RetryLoadTile(2), useMemoryCache(true)
     Language    = LanguageType::PortuguesePortugal;
     LanguageStr = LanguageType().toShortString(Language);
     Cache::Instance();
+    downloader.moveToThread(&downloaderThread);
+    downloaderThread.start();
 }
 
 
 OPMaps::~OPMaps()
 {
     TileDBcacheQueue.wait();
+    downloaderThread.quit();
+    downloaderThread.wait();
 }
 
 
-QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom, int priority, quintptr group)
 {
 #ifdef DEBUG_TIMINGS
     QTime time;
@@ -100,134 +104,10 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
             }
         }
         if (accessmode != AccessMode::CacheOnly) {
-            QEventLoop q;
-            QNetworkReply *reply;
-            QNetworkRequest qheader;
-            QNetworkAccessManager network;
-            QTimer tT;
-            tT.setSingleShot(true);
-            connect(&network, SIGNAL(finished(QNetworkReply *)),
-                    &q, SLOT(quit()));
-            connect(&tT, SIGNAL(timeout()), &q, SLOT(quit()));
-            network.setProxy(Proxy);
-#ifdef DEBUG_GMAPS
-            qDebug() << "Try Tile from the Internet";
-#endif // DEBUG_GMAPS
-#ifdef DEBUG_TIMINGS
-            qDebug() << "opmaps before make image url" << time.elapsed();
-#endif
-            QString url = MakeImageUrl(type, pos, zoom, LanguageStr);
-#ifdef DEBUG_TIMINGS
-            qDebug() << "opmaps after make image url" << time.elapsed();
-#endif // url	"http://vec02.maps.yandex.ru/tiles?l=map&v=2.10.2&x=7&y=5&z=3"	string
-       // "http://map3.pergo.com.tr/tile/02/000/000/007/000/000/002.png"
-            qheader.setUrl(QUrl(url));
-            qheader.setRawHeader("User-Agent", UserAgent);
-            qheader.setRawHeader("Accept", "*/*");
-            switch (type) {
-            case MapType::GoogleMap:
-            case MapType::GoogleSatellite:
-            case MapType::GoogleLabels:
-            case MapType::GoogleTerrain:
-            case MapType::GoogleHybrid:
-            {
-                qheader.setRawHeader("Referrer", "http://maps.google.com/");
-            }
-            break;
-
-            case MapType::GoogleMapChina:
-            case MapType::GoogleSatelliteChina:
-            case MapType::GoogleLabelsChina:
-            case MapType::GoogleTerrainChina:
-            case MapType::GoogleHybridChina:
-            {
-                qheader.setRawHeader("Referrer", "http://ditu.google.cn/");
-            }
-            break;
-
-            case MapType::BingHybrid:
-            case MapType::BingMap:
-            case MapType::BingSatellite:
-            {
-                qheader.setRawHeader("Referrer", "http://www.bing.com/maps/");
-            }
-            break;
-
-            case MapType::YahooHybrid:
-            case MapType::YahooLabels:
-            case MapType::YahooMap:
-            case MapType::YahooSatellite:
-            {
-                qheader.setRawHeader("Referrer", "http://maps.yahoo.com/");
-            }
-            break;
-
-            case MapType::ArcGIS_MapsLT_Map_Labels:
-            case MapType::ArcGIS_MapsLT_Map:
-            case MapType::ArcGIS_MapsLT_OrtoFoto:
-            case MapType::ArcGIS_MapsLT_Map_Hybrid:
-            {
-                qheader.setRawHeader("Referrer", "http://www.maps.lt/map_beta/");
-            }
-            break;
-
-            case MapType::OpenStreetMapSurfer:
-            case MapType::OpenStreetMapSurferTerrain:
-            {
-                qheader.setRawHeader("Referrer", "http://www.mapsurfer.net/");
-            }
-            break;
-
-            case MapType::OpenStreetMap:
-            case MapType::OpenStreetOsm:
-            {
-                qheader.setRawHeader("Referrer", "http://www.openstreetmap.org/");
-            }
-            break;
-
-            case MapType::YandexMapRu:
-            {
-                qheader.setRawHeader("Referrer", "http://maps.yandex.ru/");
-            }
-            break;
-            default:
-                break;
-            }
-            reply = network.get(qheader);
-            tT.start(Timeout);
-            q.exec();
-
-            if (!tT.isActive()) {
-                errorvars.lock();
-                ++diag.timeouts;
-                errorvars.unlock();
-                return ret;
-            }
-            tT.stop();
-            if ((reply->error() != QNetworkReply::NoError)) {
-                errorvars.lock();
-                ++diag.networkerrors;
-                errorvars.unlock();
-                reply->deleteLater();
-                return ret;
-            }
-            ret = reply->readAll();
-            reply->deleteLater(); // TODO can't this be global??
+            ret = GetImageFromServer(type, pos, zoom, priority, group);
             if (ret.isEmpty()) {
-#ifdef DEBUG_GMAPS
-                qDebug() << "Invalid Tile";
-#endif // DEBUG_GMAPS
-                errorvars.lock();
-                ++diag.emptytiles;
-                errorvars.unlock();
                 return ret;
             }
-#ifdef DEBUG_GMAPS
-            qDebug() << "Received Tile from the Internet";
-#endif // DEBUG_GMAPS
-            errorvars.lock();
-            ++diag.tilesFromNet;
-            errorvars.unlock();
             if (useMemoryCache) {
 #ifdef DEBUG_GMAPS
                 qDebug() << "Add Tile to memory cache";
@@ -249,6 +129,149 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
     return ret;
 }
 
+QByteArray OPMaps::GetImageFromServer(const MapType::Types &type, const Point &pos, const int &zoom, int priority, quintptr group)
+{
+#ifdef DEBUG_TIMINGS
+    QTime time;
+    time.restart();
+#endif
+    QByteArray ret;
+
+    QNetworkRequest qheader;
+#ifdef DEBUG_GMAPS
+    qDebug() << "Try Tile from the Internet";
+#endif // DEBUG_GMAPS
+#ifdef DEBUG_TIMINGS
+    qDebug() << "opmaps before make image url" << time.elapsed();
+#endif
+    QString url = MakeImageUrl(type, pos, zoom, LanguageStr);
+#ifdef DEBUG_TIMINGS
+    qDebug() << "opmaps after make image url" << time.elapsed();
+#endif // url	"http://vec02.maps.yandex.ru/tiles?l=map&v=2.10.2&x=7&y=5&z=3"	string
+// "http://map3.pergo.com.tr/tile/02/000/000/007/000/000/002.png"
+    qheader.setUrl(QUrl(url));
+    qheader.setRawHeader("User-Agent", UserAgent);
+    qheader.setRawHeader("Accept", "*/*");
+    switch (type) {
+    case MapType::GoogleMap:
+    case MapType::GoogleSatellite:
+    case MapType::GoogleLabels:
+    case MapType::GoogleTerrain:
+    case MapType::GoogleHybrid:
+    {
+        qheader.setRawHeader("Referrer", "http://maps.google.com/");
+    }
+    break;
+
+    case MapType::GoogleMapChina:
+    case MapType::GoogleSatelliteChina:
+    case MapType::GoogleLabelsChina:
+    case MapType::GoogleTerrainChina:
+    case MapType::GoogleHybridChina:
+    {
+        qheader.setRawHeader("Referrer", "http://ditu.google.cn/");
+    }
+    break;
+
+    case MapType::BingHybrid:
+    case MapType::BingMap:
+    case MapType::BingSatellite:
+    {
+        qheader.setRawHeader("Referrer", "http://www.bing.com/maps/");
+    }
+    break;
+
+    case MapType::YahooHybrid:
+    case MapType::YahooLabels:
+    case MapType::YahooMap:
+    case MapType::YahooSatellite:
+    {
+        qheader.setRawHeader("Referrer", "http://maps.yahoo.com/");
+    }
+    break;
+
+    case MapType::ArcGIS_MapsLT_Map_Labels:
+    case MapType::ArcGIS_MapsLT_Map:
+    case MapType::ArcGIS_MapsLT_OrtoFoto:
+    case MapType::ArcGIS_MapsLT_Map_Hybrid:
+    {
+        qheader.setRawHeader("Referrer", "http://www.maps.lt/map_beta/");
+    }
+    break;
+
+    case MapType::OpenStreetMapSurfer:
+    case MapType::OpenStreetMapSurferTerrain:
+    {
+        qheader.setRawHeader("Referrer", "http://www.mapsurfer.net/");
+    }
+    break;
+
+    case MapType::OpenStreetMap:
+    case MapType::OpenStreetOsm:
+    {
+        qheader.setRawHeader("Referrer", "http://www.openstreetmap.org/");
+    }
+    break;
+
+    case MapType::YandexMapRu:
+    {
+        qheader.setRawHeader("Referrer", "http://maps.yandex.ru/");
+    }
+    break;
+    default:
+        break;
+    }
+    TileDownloader::Status status = downloader.Get(qheader, Proxy, Timeout, priority, group, ret);
+    if (status == TileDownloader::Cancelled) {
+        return ret;
+    }
+    if (status == TileDownloader::Timeout) {
+        errorvars.lock();
+        ++diag.timeouts;
+        errorvars.unlock();
+        return ret;
+    }
+    if (status == TileDownloader::NetworkError) {
+        errorvars.lock();
+        ++diag.networkerrors;
+        errorvars.unlock();
+        return ret;
+    }
+    if (ret.isEmpty()) {
+#ifdef DEBUG_GMAPS
+        qDebug() << "Invalid Tile";
+#endif // DEBUG_GMAPS
+        errorvars.lock();
+        ++diag.emptytiles;
+        errorvars.unlock();
+        return ret;
+    }
+#ifdef DEBUG_GMAPS
+    qDebug() << "Received Tile from the Internet";
+#endif // DEBUG_GMAPS
+    errorvars.lock();
+    ++diag.tilesFromNet;
+    errorvars.unlock();
+    return ret;
+}
+
+bool OPMaps::FetchTileToCache(const MapType::Types &type, const Point &pos, const int &zoom, quintptr group, int &bytes)
+{
+    bytes = 0;
+    if (accessmode == AccessMode::CacheOnly) {
+        return false;
+    }
+    // queued behind every tile the map view is waiting for
+    QByteArray ret = GetImageFromServer(type, pos, zoom, PRECACHE_PRIORITY, group);
+    if (ret.isEmpty()) {
+        return false;
+    }
+    bytes = ret.size();
+    // bypasses the memory cache, pre-seeded tiles should not evict the view
+    TileDBcacheQueue.EnqueueCacheTask(new CacheItemQueue(type, pos, ret, zoom));
+    return true;
+}
+
 bool OPMaps::ExportToGMDB(const QString &file)
 {
     return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb", file);
@@ -265,6 +288,8 @@ diagnostics OPMaps::GetDiagnostics()
     errorvars.lock();
     i = diag;
     errorvars.unlock();
+    TilesInMemory.GetDiagnostics(i);
+    TileDBcacheQueue.GetDiagnostics(i);
     return i;
 }
 }
@@ -40,6 +40,8 @@
 #include "alllayersoftype.h"
 #include "urlfactory.h"
 #include "diagnostics.h"
+#include "tiledownloader.h"
+#include <QThread>
 
 // #include "point.h"
 
@@ -56,7 +58,14 @@ public: ~OPMaps();
     /// </summary>
 
 
-    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    // priority orders pending downloads, lowest first, group is what CancelDownloads() cancels
+    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom, int priority = 0, quintptr group = 0);
+    // downloads a tile straight into the database cache, for pre-seeding
+    bool FetchTileToCache(const MapType::Types &type, const core::Point &pos, const int &zoom, quintptr group, int &bytes);
+    void CancelDownloads(quintptr group)
+    {
+        downloader.Cancel(group);
+    }
     bool UseMemoryCache()
     {
         return useMemoryCache;
@@ -81,15 +90,27 @@ public: ~OPMaps();
     {
         accessmode = mode;
     }
+    void setCacheBatchSize(int const & value)
+    {
+        TileDBcacheQueue.setBatchSize(value);
+    }
+    void setCacheFlushDeadline(int const & value)
+    {
+        TileDBcacheQueue.setFlushDeadline(value);
+    }
     int RetryLoadTile;
     diagnostics GetDiagnostics();
 
 private:
+    static const int PRECACHE_PRIORITY = 1 << 24;
+    QByteArray GetImageFromServer(const MapType::Types &type, const core::Point &pos, const int &zoom, int priority, quintptr group);
     bool useMemoryCache;
     LanguageType::Types Language;
     AccessMode::Types accessmode;
     // PureImageCache ImageCacheLocal;//TODO Criar acesso Get Set
     TileCacheQueue TileDBcacheQueue;
+    QThread downloaderThread;
+    TileDownloader downloader;
     OPMaps();
     OPMaps(OPMaps const &) {}
     OPMaps & operator=(OPMaps const &)
@@ -30,6 +30,8 @@
 // #define DEBUG_PUREIMAGECACHE
 namespace core {
 qlonglong PureImageCache::ConnCounter = 0;
+const int PureImageCache::MaxWriteBatch;
+
 
 PureImageCache::PureImageCache()
 {}
@@ -150,6 +152,13 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     if (query.numRowsAffected() == -1) {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.close();
+        return false;
+    }
+    if (!CreateIndex(db)) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
 #endif // DEBUG_PUREIMAGECACHE
         db.close();
         return false;
@@ -158,6 +167,111 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
     return true;
 }
+bool PureImageCache::CreateIndex(QSqlDatabase &db)
+{
+    // covers the tile lookup, id is the rowid and part of every index entry
+    QSqlQuery query(db);
+
+    return query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+}
+
+PureImageCache::Connection::Connection(const QString &file, qlonglong id)
+    : file(file), name(QString("PureImageCache%1").arg(id)), getTile(0), hasTile(0), putTile(0), putTileData(0), pendingWrites(0)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+
+    db.setDatabaseName(file);
+    // no shared cache, it would make readers fail while a write batch is open
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!db.open()) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "PureImageCache: Unable to open" << file << db.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        return;
+    }
+    // databases created by older versions have no index yet
+    CreateIndex(db);
+
+    QSqlQuery *get = new QSqlQuery(db);
+    get->setForwardOnly(true);
+    get->prepare("SELECT TilesData.Tile FROM Tiles JOIN TilesData ON TilesData.id = Tiles.id WHERE Tiles.X=? AND Tiles.Y=? AND Tiles.Zoom=? AND Tiles.Type=? LIMIT 1");
+    hasTile     = new QSqlQuery(db);
+    hasTile->setForwardOnly(true);
+    hasTile->prepare("SELECT 1 FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=? LIMIT 1");
+    putTile     = new QSqlQuery(db);
+    putTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+    putTileData = new QSqlQuery(db);
+    putTileData->prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+    getTile     = get;
+}
+PureImageCache::Connection::~Connection()
+{
+    Commit();
+    delete getTile;
+    delete hasTile;
+    delete putTile;
+    delete putTileData;
+    QSqlDatabase::database(name, false).close();
+    QSqlDatabase::removeDatabase(name);
+}
+bool PureImageCache::Connection::IsOpen() const
+{
+    return getTile != 0;
+}
+bool PureImageCache::Connection::BeginWrite()
+{
+    if (pendingWrites > 0) {
+        return true;
+    }
+    return QSqlDatabase::database(name, false).transaction();
+}
+void PureImageCache::Connection::Commit()
+{
+    if (pendingWrites == 0) {
+        return;
+    }
+    pendingWrites = 0;
+    QSqlDatabase db = QSqlDatabase::database(name, false);
+    if (!db.commit()) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "PureImageCache: Commit failed" << db.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.rollback();
+    }
+}
+PureImageCache::Connection *PureImageCache::ThreadConnection()
+{
+    // must be called with lock held
+    QString file   = gtilecache + "Data.qmdb";
+    Connection *cn = connections.localData();
+
+    if (cn && cn->file != file) {
+        // cache directory changed, setLocalData deletes the stale connection
+        connections.setLocalData(0);
+        cn = 0;
+    }
+    if (!cn) {
+        Mcounter.lock();
+        qlonglong id = ++ConnCounter;
+        Mcounter.unlock();
+        cn = new Connection(file, id);
+        connections.setLocalData(cn);
+    }
+    if (!cn->IsOpen()) {
+        // retry on the next call
+        connections.setLocalData(0);
+        return 0;
+    }
+    return cn;
+}
+void PureImageCache::Flush()
+{
+    lock.lockForRead();
+    if (connections.hasLocalData() && connections.localData()) {
+        connections.localData()->Commit();
+    }
+    lock.unlock();
+}
 bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
 {
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
@@ -167,119 +281,109 @@ bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Type
 #ifdef DEBUG_PUREIMAGECACHE
     qDebug() << "PutImageToCache Start:"; // <<pos;
 #endif // DEBUG_PUREIMAGECACHE
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
-    {
-        QSqlDatabase cn;
-        cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-        QString db = gtilecache + "Data.qmdb";
-        cn.setDatabaseName(db);
-        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (cn.open()) {
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                query.addBindValue(pos.X());
-                query.addBindValue(pos.Y());
-                query.addBindValue(zoom);
-
-                query.addBindValue((int)type);
-                query.addBindValue(QDateTime::currentDateTime().toString());
-                query.exec();
-            }
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                query.addBindValue(tile);
-                query.exec();
-            }
-            cn.close();
-        }
+    Connection *cn = ThreadConnection();
+    if (!cn || !cn->BeginWrite()) {
+        lock.unlock();
+        return false;
+    }
+    cn->putTile->addBindValue(pos.X());
+    cn->putTile->addBindValue(pos.Y());
+    cn->putTile->addBindValue(zoom);
+    cn->putTile->addBindValue((int)type);
+    cn->putTile->addBindValue(QDateTime::currentDateTime().toString());
+    if (cn->putTile->exec()) {
+        cn->putTileData->addBindValue(tile);
+        cn->putTileData->exec();
+    }
+    // the transaction is open from here on, even if the insert failed
+    if (++cn->pendingWrites >= MaxWriteBatch) {
+        cn->Commit();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
     lock.unlock();
     return true;
 }
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
-    lock.lockForRead();
     QByteArray ar;
+
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return ar;
     }
-    QString dir  = gtilecache;
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
+    lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "Cache dir=" << dir << " Try to GET:" << pos.X() + "," + pos.Y();
+    qDebug() << "Cache dir=" << gtilecache << " Try to GET:" << pos.X() + "," + pos.Y();
 #endif // DEBUG_PUREIMAGECACHE
-
-    {
-        QString db = dir + "Data.qmdb";
-        {
-            QSqlDatabase cn;
-
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int)type));
-                    query.next();
-                    if (query.isValid()) {
-                        ar = query.value(0).toByteArray();
-                    }
-                }
-                cn.close();
-            }
+    Connection *cn = ThreadConnection();
+    if (cn) {
+        cn->getTile->addBindValue(pos.X());
+        cn->getTile->addBindValue(pos.Y());
+        cn->getTile->addBindValue(zoom);
+        cn->getTile->addBindValue((int)type);
+        if (cn->getTile->exec() && cn->getTile->next()) {
+            ar = cn->getTile->value(0).toByteArray();
         }
+        // release the read lock on the database
+        cn->getTile->finish();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
     lock.unlock();
     return ar;
 }
+bool PureImageCache::ImageExistsInCache(MapType::Types type, Point pos, int zoom)
+{
+    bool found = false;
+
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        return found;
+    }
+    lock.lockForRead();
+    Connection *cn = ThreadConnection();
+    if (cn) {
+        cn->hasTile->addBindValue(pos.X());
+        cn->hasTile->addBindValue(pos.Y());
+        cn->hasTile->addBindValue(zoom);
+        cn->hasTile->addBindValue((int)type);
+        found = cn->hasTile->exec() && cn->hasTile->next();
+        cn->hasTile->finish();
+    }
+    lock.unlock();
+    return found;
+}
 void PureImageCache::deleteOlderTiles(int const & days)
 {
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
         return;
     }
     QList<long> add;
-    bool ret    = true;
-    QString dir = gtilecache;
-    {
-        QString db = dir + "Data.qmdb";
-        ret = QFileInfo(db).exists();
-        if (ret) {
-            QSqlDatabase cn;
-            Mcounter.lock();
-            qlonglong id = ++ConnCounter;
-            Mcounter.unlock();
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                    while (query.next()) {
-                        if (QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime()) > days) {
-                            add.append(query.value(0).toLongLong());
-                        }
-                    }
-                    foreach(long i, add) {
-                        query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                    }
+    lock.lockForRead();
+    if (!QFileInfo(gtilecache + "Data.qmdb").exists()) {
+        lock.unlock();
+        return;
+    }
+    Connection *cn = ThreadConnection();
+    if (cn) {
+        cn->Commit();
+        QSqlDatabase db = QSqlDatabase::database(cn->name, false);
+        {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.exec(QString("SELECT id, Date FROM Tiles"));
+            while (query.next()) {
+                if (QDateTime::fromString(query.value(1).toString()).daysTo(QDateTime::currentDateTime()) > days) {
+                    add.append(query.value(0).toLongLong());
                 }
-
-                cn.close();
             }
-            QSqlDatabase::removeDatabase(QString::number(id));
+        }
+        if (!add.isEmpty() && db.transaction()) {
+            QSqlQuery query(db);
+            query.prepare("DELETE FROM Tiles WHERE id = ?");
+            foreach(long i, add) {
+                query.addBindValue((qlonglong)i);
+                query.exec();
+            }
+            db.commit();
         }
     }
+    lock.unlock();
 }
 // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
 bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
@@ -42,6 +42,7 @@
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
 namespace core {
 class PureImageCache {
 public:
@@ -49,14 +50,40 @@ public:
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
+    // index only lookup, does not read the tile data
+    bool ImageExistsInCache(MapType::Types type, core::Point pos, int zoom);
     QString GtileCache();
     void setGtileCache(const QString &value);
     static bool ExportMapDataToDB(QString sourceFile, QString destFile);
     void deleteOlderTiles(int const & days);
+    // commit the write batch of the calling thread
+    void Flush();
+    // writes are committed at the latest after this many tiles, Flush() commits earlier
+    static const int MaxWriteBatch = 256;
 private:
+    // One persistent connection per thread, QSqlDatabase handles can not be shared across threads
+    class Connection {
+public:
+        Connection(const QString &file, qlonglong id);
+        ~Connection();
+        bool IsOpen() const;
+        bool BeginWrite();
+        void Commit();
+        QString file;
+        QString name;
+        QSqlQuery *getTile;
+        QSqlQuery *hasTile;
+        QSqlQuery *putTile;
+        QSqlQuery *putTileData;
+        int pendingWrites;
+    };
+    Connection *ThreadConnection();
+    static bool CreateIndex(QSqlDatabase &db);
+
     QString gtilecache;
     QMutex Mcounter;
     QReadWriteLock lock;
+    QThreadStorage<Connection *> connections;
     static qlonglong ConnCounter;
 };
 }
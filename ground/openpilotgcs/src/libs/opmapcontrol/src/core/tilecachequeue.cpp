@@ -30,39 +30,63 @@
 // #define DEBUG_TILECACHEQUEUE
 
 namespace core {
-TileCacheQueue::TileCacheQueue()
+TileCacheQueue::TileCacheQueue() : running(false), batchSize(64), flushDeadline(500), tilesWritten(0), bytesWritten(0)
 {}
 TileCacheQueue::~TileCacheQueue()
 {
     // QThread::wait(10000);
 }
 
+void TileCacheQueue::setBatchSize(int const & value)
+{
+    QMutexLocker locker(&mutex);
+
+    batchSize = qBound(1, value, PureImageCache::MaxWriteBatch);
+}
+void TileCacheQueue::setFlushDeadline(int const & value)
+{
+    QMutexLocker locker(&mutex);
+
+    flushDeadline = qMax(0, value);
+}
+void TileCacheQueue::GetDiagnostics(diagnostics &diag)
+{
+    QMutexLocker locker(&mutex);
+
+    diag.tilesQueued  = tileCacheQueue.count();
+    diag.tilesWritten = tilesWritten;
+    diag.bytesWritten = bytesWritten;
+}
+
 void TileCacheQueue::EnqueueCacheTask(CacheItemQueue *task)
 {
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "DB Do I EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
-    if (!tileCacheQueue.contains(task)) {
+    mutex.lock();
+    if (tileCacheQueue.contains(task)) {
+        mutex.unlock();
+        return;
+    }
 #ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
+    qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
-        mutex.lock();
-        tileCacheQueue.enqueue(task);
-        mutex.unlock();
-        if (this->isRunning()) {
+    tileCacheQueue.enqueue(task);
+    if (running) {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Wake Thread";
+        qDebug() << "Wake Thread";
 #endif // DEBUG_TILECACHEQUEUE
-            // this->start(QThread::NormalPriority);
-            // waitmutex.lock();
-            waitc.wakeAll();
-            // waitmutex.unlock();
-        } else {
+        waitc.wakeAll();
+        mutex.unlock();
+    } else {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Start Thread";
+        qDebug() << "Start Thread";
 #endif // DEBUG_TILECACHEQUEUE
-            this->start(QThread::NormalPriority);
-        }
+        running = true;
+        mutex.unlock();
+        // the previous run may still be returning after it cleared running
+        wait();
+        this->start(QThread::NormalPriority);
     }
 }
 void TileCacheQueue::run()
@@ -70,41 +94,59 @@ void TileCacheQueue::run()
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "Cache Engine Start";
 #endif // DEBUG_TILECACHEQUEUE
+    // tiles written since the open transaction started
+    int pending = 0;
+    QElapsedTimer batchTimer;
+
+    mutex.lock();
     while (true) {
-        CacheItemQueue *task;
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "Cache";
-#endif // DEBUG_TILECACHEQUEUE
         if (tileCacheQueue.count() > 0) {
-            mutex.lock();
-            task = tileCacheQueue.dequeue();
+            CacheItemQueue *task = tileCacheQueue.dequeue();
             mutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
             qDebug() << "Cache engine Put:" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom());
-            usleep(44);
+            QByteArray img = task->GetImg();
+            bool written   = Cache::Instance()->ImageCache.PutImageToCache(img, task->GetMapType(), task->GetPosition(), task->GetZoom());
             delete task;
+            if (written && pending++ == 0) {
+                batchTimer.start();
+            }
+            mutex.lock();
+            if (written) {
+                ++tilesWritten;
+                bytesWritten += img.size();
+            }
+            if (pending > 0 && (pending >= batchSize || batchTimer.elapsed() >= flushDeadline)) {
+                mutex.unlock();
+                Cache::Instance()->ImageCache.Flush();
+                pending = 0;
+                mutex.lock();
+            }
+        } else if (pending > 0) {
+            // give the open batch until its deadline to fill up, then commit it
+            int tout = flushDeadline - (int)batchTimer.elapsed();
+            if (tout <= 0 || !waitc.wait(&mutex, tout)) {
+                mutex.unlock();
+                Cache::Instance()->ImageCache.Flush();
+                pending = 0;
+                mutex.lock();
+            }
         } else {
+#ifdef DEBUG_TILECACHEQUEUE
             qDebug() << "Cache engine BEGIN WAIT";
-            waitmutex.lock();
+#endif // DEBUG_TILECACHEQUEUE
             int tout = 4000;
-            if (!waitc.wait(&waitmutex, tout)) {
-                waitmutex.unlock();
+            if (!waitc.wait(&mutex, tout) && tileCacheQueue.count() == 0) {
 #ifdef DEBUG_TILECACHEQUEUE
                 qDebug() << "Cache Engine TimeOut";
 #endif // DEBUG_TILECACHEQUEUE
-                mutex.lock();
-                if (tileCacheQueue.count() == 0) {
-                    mutex.unlock();
-                    break;
-                }
-                mutex.unlock();
+                running = false;
+                break;
             }
-            qDebug() << "Cache Engine DID NOT TimeOut";
-            waitmutex.unlock();
         }
     }
+    mutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "Cache Engine Stopped";
 #endif // DEBUG_TILECACHEQUEUE
@@ -34,8 +34,10 @@
 #include <QWaitCondition>
 #include <QObject>
 #include <QMutexLocker>
+#include <QElapsedTimer>
 #include "pureimagecache.h"
 #include "cache.h"
+#include "diagnostics.h"
 
 
 namespace core {
@@ -45,14 +47,23 @@ public:
     TileCacheQueue();
     ~TileCacheQueue();
     void EnqueueCacheTask(CacheItemQueue *task);
+    // tiles written per transaction, capped at PureImageCache::MaxWriteBatch
+    void setBatchSize(int const & value);
+    // longest time in ms a written tile may wait for its transaction to commit
+    void setFlushDeadline(int const & value);
+    void GetDiagnostics(diagnostics &diag);
 
 protected:
     QQueue<CacheItemQueue *> tileCacheQueue;
 private:
     void run();
     QMutex mutex;
-    QMutex waitmutex;
     QWaitCondition waitc;
+    bool running;
+    int batchSize;
+    int flushDeadline;
+    int tilesWritten;
+    qint64 bytesWritten;
 };
 }
 #endif // TILECACHEQUEUE_H
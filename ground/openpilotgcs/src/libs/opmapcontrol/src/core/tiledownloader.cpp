@@ -0,0 +1,189 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tiledownloader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tiledownloader.h"
+#include <QTimer>
+#include <QMetaObject>
+
+namespace core {
+TileDownloader::TileDownloader() : sequence(0), maxConcurrent(6), network(0)
+{}
+
+TileDownloader::Status TileDownloader::Get(const QNetworkRequest &request, const QNetworkProxy &proxy, int timeout, int priority, quintptr group, QByteArray &data)
+{
+    RequestPtr req(new Request);
+
+    req->request     = request;
+    req->request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    req->proxy       = proxy;
+    req->timeout     = timeout;
+    req->priority    = priority;
+    req->group       = group;
+    req->status      = Pending;
+    req->abortReason = Pending;
+
+    mutex.lock();
+    req->sequence = ++sequence;
+    // keep the queue sorted, equal priorities in arrival order
+    int i = queue.count();
+    while (i > 0 && queue.at(i - 1)->priority > priority) {
+        --i;
+    }
+    queue.insert(i, req);
+    mutex.unlock();
+
+    QMetaObject::invokeMethod(this, "Dispatch", Qt::QueuedConnection);
+
+    mutex.lock();
+    while (req->status == Pending) {
+        done.wait(&mutex);
+    }
+    Status status = req->status;
+    data = req->data;
+    mutex.unlock();
+    return status;
+}
+
+void TileDownloader::Cancel(quintptr group)
+{
+    mutex.lock();
+    cancelledUpTo.insert(group, sequence);
+    for (QList<RequestPtr>::iterator it = queue.begin(); it != queue.end();) {
+        if (IsCancelled(*it)) {
+            Complete(*it, Cancelled);
+            it = queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    mutex.unlock();
+    // replies belong to the downloader thread
+    QMetaObject::invokeMethod(this, "AbortCancelled", Qt::QueuedConnection);
+}
+
+void TileDownloader::setMaxConcurrent(int const & value)
+{
+    mutex.lock();
+    maxConcurrent = qMax(1, value);
+    mutex.unlock();
+    QMetaObject::invokeMethod(this, "Dispatch", Qt::QueuedConnection);
+}
+
+bool TileDownloader::IsCancelled(const RequestPtr &req) const
+{
+    return req->sequence <= cancelledUpTo.value(req->group, 0);
+}
+
+void TileDownloader::Complete(const RequestPtr &req, Status status)
+{
+    // must be called with mutex held
+    req->status = status;
+    done.wakeAll();
+}
+
+void TileDownloader::Dispatch()
+{
+    if (!network) {
+        // created here so it lives in the downloader thread
+        network = new QNetworkAccessManager(this);
+    }
+    mutex.lock();
+    while (!queue.isEmpty() && inFlight.count() < maxConcurrent) {
+        RequestPtr req = queue.takeFirst();
+        if (IsCancelled(req)) {
+            Complete(req, Cancelled);
+            continue;
+        }
+        mutex.unlock();
+        if (!(network->proxy() == req->proxy)) {
+            network->setProxy(req->proxy);
+        }
+        QNetworkReply *reply = network->get(req->request);
+        connect(reply, SIGNAL(finished()), this, SLOT(ReplyFinished()));
+        QTimer *timer = new QTimer(reply);
+        timer->setSingleShot(true);
+        connect(timer, SIGNAL(timeout()), this, SLOT(ReplyTimeout()));
+        timer->start(req->timeout);
+        mutex.lock();
+        inFlight.insert(reply, req);
+    }
+    mutex.unlock();
+}
+
+void TileDownloader::AbortCancelled()
+{
+    QList<QNetworkReply *> stale;
+
+    mutex.lock();
+    QHash<QNetworkReply *, RequestPtr>::const_iterator it;
+    for (it = inFlight.constBegin(); it != inFlight.constEnd(); ++it) {
+        if (IsCancelled(it.value())) {
+            it.value()->abortReason = Cancelled;
+            stale.append(it.key());
+        }
+    }
+    mutex.unlock();
+    // abort() emits finished(), which completes the request
+    foreach(QNetworkReply * reply, stale) {
+        reply->abort();
+    }
+}
+
+void TileDownloader::ReplyTimeout()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender()->parent());
+
+    mutex.lock();
+    if (inFlight.contains(reply)) {
+        inFlight.value(reply)->abortReason = Timeout;
+    }
+    mutex.unlock();
+    reply->abort();
+}
+
+void TileDownloader::ReplyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+
+    mutex.lock();
+    RequestPtr req = inFlight.take(reply);
+    if (req) {
+        Status status = req->abortReason;
+        if (status == Pending) {
+            if (reply->error() == QNetworkReply::NoError) {
+                req->data = reply->readAll();
+                status    = Finished;
+            } else {
+                status = NetworkError;
+            }
+        }
+        Complete(req, status);
+    }
+    mutex.unlock();
+    reply->deleteLater();
+    Dispatch();
+}
+}
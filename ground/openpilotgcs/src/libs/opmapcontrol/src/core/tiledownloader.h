@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tiledownloader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEDOWNLOADER_H
+#define TILEDOWNLOADER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include <QHash>
+#include <QSharedPointer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkProxy>
+
+namespace core {
+// One QNetworkAccessManager shared by all tile loaders, living in its own
+// thread, so HTTP connections are kept alive and reused between tiles.
+// Requests are started lowest priority value first and can be cancelled
+// per group.
+class TileDownloader : public QObject {
+    Q_OBJECT
+public:
+    enum Status { Pending, Finished, Timeout, NetworkError, Cancelled };
+
+    TileDownloader();
+    // blocks the caller until the tile arrived, failed or was cancelled
+    Status Get(const QNetworkRequest &request, const QNetworkProxy &proxy, int timeout, int priority, quintptr group, QByteArray &data);
+    // fails every request of group issued so far, queued or in flight
+    void Cancel(quintptr group);
+    void setMaxConcurrent(int const & value);
+
+private slots:
+    void Dispatch();
+    void AbortCancelled();
+    void ReplyFinished();
+    void ReplyTimeout();
+
+private:
+    struct Request {
+        QNetworkRequest request;
+        QNetworkProxy   proxy;
+        int      timeout;
+        int      priority;
+        quintptr group;
+        quint64  sequence;
+        Status   status;
+        Status   abortReason;
+        QByteArray data;
+    };
+    typedef QSharedPointer<Request> RequestPtr;
+    bool IsCancelled(const RequestPtr &req) const;
+    void Complete(const RequestPtr &req, Status status);
+
+    QMutex mutex;
+    QWaitCondition done;
+    QList<RequestPtr> queue; // sorted by priority
+    QHash<QNetworkReply *, RequestPtr> inFlight;
+    QHash<quintptr, quint64> cancelledUpTo;
+    quint64 sequence;
+    int maxConcurrent;
+    QNetworkAccessManager *network;
+};
+}
+#endif // TILEDOWNLOADER_H
@@ -25,6 +25,8 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "core.h"
+#include <algorithm>
+#include <cmath>
 
 #ifdef DEBUG_CORE
 qlonglong internals::Core::debugcounter = 0;
@@ -33,8 +35,43 @@ qlonglong internals::Core::debugcounter = 0;
 using namespace projections;
 
 namespace internals {
+namespace {
+// orders tiles by distance from the viewport center
+struct CenterDistanceLess {
+    core::Point center;
+    CenterDistanceLess(const core::Point &c) : center(c) {}
+    int Distance(const core::Point &p) const
+    {
+        int dx = p.X() - center.X();
+        int dy = p.Y() - center.Y();
+
+        return dx * dx + dy * dy;
+    }
+    bool operator()(const core::Point &a, const core::Point &b) const
+    {
+        return Distance(a) < Distance(b);
+    }
+};
+
+// concurrent prefetch downloads, kept below loaderLimit so visible tiles win
+const int PrefetchThreads     = 2;
+// queued after every visible tile and before pre-seeding
+const int PrefetchPriority    = 1 << 20;
+// seconds of movement the ring should cover, in rings of tiles
+const double PrefetchLookahead = 10;
+const int PrefetchMaxRings    = 3;
+const int PrefetchHintTimeout = 5000; // ms
+const double PrefetchMinSpeed = 1.0; // m/s
+
+int Sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+}
+
 Core::Core() : MouseWheelZooming(false), currentPosition(0, 0), currentPositionPixel(0, 0), LastLocationInBounds(-1, -1), sizeOfMapArea(0, 0)
-    , minOfTiles(0, 0), maxOfTiles(0, 0), zoom(0), isDragging(false), TooltipTextPadding(10, 10), loaderLimit(5), maxzoom(21), runningThreads(0), started(false)
+    , minOfTiles(0, 0), maxOfTiles(0, 0), zoom(0), isDragging(false), TooltipTextPadding(10, 10), loaderLimit(5),
+    prefetchGeneration(0), prefetchLimit(PrefetchThreads), prefetchLastZoom(-1), motionNorth(0), motionEast(0), maxzoom(21), runningThreads(0), started(false)
 {
     mousewheelzoomtype = MouseWheelZoomType::MousePositionAndCenter;
     SetProjection(new MercatorProjection());
@@ -44,6 +81,7 @@ Core::Core() : MouseWheelZooming(false), currentPosition(0, 0), currentPositionP
     dragPoint    = Point(0, 0);
     CanDragMap   = true;
     tilesToload  = 0;
+    cancelGeneration = 0;
     OPMaps::Instance();
 }
 Core::~Core()
@@ -66,9 +104,12 @@ void Core::run()
     bool last = false;
 
     LoadTask task;
+    LoadTask prefetch;
+    int generation;
 
     MtileLoadQueue.lock();
     {
+        generation = cancelGeneration;
         if (tileLoadQueue.count() > 0) {
             task = tileLoadQueue.dequeue();
             {
@@ -77,10 +118,17 @@ void Core::run()
                 qDebug() << "TileLoadQueue: " << tileLoadQueue.count() << " Point:" << task.Pos.ToString() << " ID=" << debug;;
 #endif // DEBUG_CORE
             }
+        } else if (prefetchQueue.count() > 0 && prefetchLimit.tryAcquire()) {
+            prefetch   = prefetchQueue.dequeue();
+            generation = prefetchGeneration;
         }
     }
     MtileLoadQueue.unlock();
 
+    if (prefetch.HasValue()) {
+        RunPrefetch(prefetch, generation);
+    }
+
     if (task.HasValue()) {
         if (loaderLimit.tryAcquire(1, OPMaps::Instance()->Timeout)) {
             MtileToload.lock();
@@ -104,6 +152,8 @@ void Core::run()
 
                         Tile *t = new Tile(task.Zoom, task.Pos);
                         QVector<MapType::Types> layers = OPMaps::Instance()->GetAllLayersOfType(GetMapType());
+                        // downloads closest to the current viewport center go first
+                        int priority = CenterDistanceLess(centerTileXYLocation).Distance(task.Pos);
 
                         foreach(MapType::Types tl, layers) {
                             int retry = 0;
@@ -113,12 +163,12 @@ void Core::run()
 
                                 // tile number inversion(BottomLeft -> TopLeft) for pergo maps
                                 if (tl == MapType::PergoTurkeyMap) {
-                                    img = OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
+                                    img = OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom, priority, (quintptr)this);
                                 } else { // ok
 #ifdef DEBUG_CORE
                                     qDebug() << "start getting image" << " ID=" << debug;
 #endif // DEBUG_CORE
-                                    img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                    img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom, priority, (quintptr)this);
 #ifdef DEBUG_CORE
                                     qDebug() << "Core::run:gotimage size:" << img.count() << " ID=" << debug << " time=" << t.elapsed();
 #endif // DEBUG_CORE
@@ -127,13 +177,15 @@ void Core::run()
                                 if (img.length() != 0) {
                                     Moverlays.lock();
                                     {
-                                        t->Overlays.append(img);
+                                        t->AddOverlay(tl, img);
 #ifdef DEBUG_CORE
                                         qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
                                     }
                                     Moverlays.unlock();
 
+                                    break;
+                                } else if (TaskCancelled(generation)) {
                                     break;
                                 } else if (OPMaps::Instance()->RetryLoadTile > 0) {
 #ifdef DEBUG_CORE
@@ -149,7 +201,8 @@ void Core::run()
                             } while (++retry < OPMaps::Instance()->RetryLoadTile);
                         }
 
-                        if (t->Overlays.count() > 0) {
+                        // a cancelled tile may be missing layers, load it again when it is needed
+                        if (t->Overlays.count() > 0 && !TaskCancelled(generation)) {
                             Matrix.SetTileAt(task.Pos, t);
                             emit OnNeedInvalidation();
 
@@ -173,9 +226,7 @@ void Core::run()
                 {
                     // last buddy cleans stuff ;}
                     if (last) {
-                        OPMaps::Instance()->kiberCacheLock.lockForWrite();
                         OPMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
-                        OPMaps::Instance()->kiberCacheLock.unlock();
 
                         MtileDrawingList.lock();
                         {
@@ -198,6 +249,12 @@ void Core::run()
             loaderLimit.release();
         }
     }
+    // keep the prefetch going while it has free slots
+    MtileLoadQueue.lock();
+    if (prefetchQueue.count() > 0 && prefetchLimit.available() > 0) {
+        ProcessLoadTaskCallback.start(this);
+    }
+    MtileLoadQueue.unlock();
     MrunningThreads.lock();
     --runningThreads;
     MrunningThreads.unlock();
@@ -226,6 +283,7 @@ void Core::SetZoom(const int &value)
             tilesToload = 0;
             MtileToload.unlock();
             Matrix.Clear();
+            CancelPrefetch();
             GoToCurrentPositionOnZoom();
             UpdateBounds();
             keepInBounds();
@@ -539,19 +597,28 @@ void Core::Drag(Point const & pt)
 void Core::CancelAsyncTasks()
 {
     if (started) {
-        ProcessLoadTaskCallback.waitForDone();
         MtileLoadQueue.lock();
         {
             tileLoadQueue.clear();
+            ++cancelGeneration;
             // tilesToload=0;
         }
         MtileLoadQueue.unlock();
+        // release the loaders blocked on downloads before waiting for them
+        OPMaps::Instance()->CancelDownloads((quintptr)this);
+        CancelPrefetch();
+        ProcessLoadTaskCallback.waitForDone();
         MtileToload.lock();
         tilesToload = 0;
         MtileToload.unlock();
-        // ProcessLoadTaskCallback.waitForDone();
     }
 }
+bool Core::TaskCancelled(int generation)
+{
+    QMutexLocker locker(&MtileLoadQueue);
+
+    return generation != cancelGeneration;
+}
 void Core::UpdateBounds()
 {
     MtileDrawingList.lock();
@@ -587,6 +654,153 @@ void Core::UpdateBounds()
     }
     MtileDrawingList.unlock();
     UpdateGroundResolution();
+    QueuePrefetch();
+}
+void Core::SetMotionHint(const double &north, const double &east)
+{
+    QMutexLocker locker(&Mmotion);
+
+    motionNorth = north;
+    motionEast  = east;
+    motionStamp.start();
+}
+void Core::QueuePrefetch()
+{
+    double north;
+    double east;
+    bool fresh;
+
+    Mmotion.lock();
+    north = motionNorth;
+    east  = motionEast;
+    fresh = !motionStamp.isNull() && motionStamp.elapsed() < PrefetchHintTimeout;
+    Mmotion.unlock();
+
+    // direction of the ring in tiles, from the velocity hint or else the last pan
+    int dx    = 0;
+    int dy    = 0;
+    int rings = 1;
+    double speed = sqrt(north * north + east * east);
+    if (fresh && speed > PrefetchMinSpeed) {
+        double rez    = Projection()->GetGroundResolution(Zoom(), CurrentPosition().Lat());
+        double pixels = speed * PrefetchLookahead / rez;
+        rings = qBound(1, (int)ceil(pixels / Projection()->TileSize().Width()), PrefetchMaxRings);
+        // ignore an axis that makes up less than ~22 degrees of the heading
+        if (qAbs(east) > speed * 0.38) {
+            dx = east > 0 ? 1 : -1;
+        }
+        if (qAbs(north) > speed * 0.38) {
+            dy = north > 0 ? -1 : 1;
+        }
+    } else if (prefetchLastZoom == Zoom()) {
+        dx = Sign(centerTileXYLocation.X() - prefetchLastCenter.X());
+        dy = Sign(centerTileXYLocation.Y() - prefetchLastCenter.Y());
+    }
+    prefetchLastCenter = centerTileXYLocation;
+    prefetchLastZoom   = Zoom();
+
+    QList<LoadTask> tasks;
+    int w = sizeOfMapArea.Width();
+    int h = sizeOfMapArea.Height();
+    if (dx != 0 || dy != 0) {
+        QList<Point> ring;
+        for (int i = -w - rings; i <= w + rings; i++) {
+            for (int j = -h - rings; j <= h + rings; j++) {
+                bool aheadX = (dx != 0 && Sign(i) == dx && qAbs(i) > w);
+                bool aheadY = (dy != 0 && Sign(j) == dy && qAbs(j) > h);
+                Point p(centerTileXYLocation.X() + i, centerTileXYLocation.Y() + j);
+                if ((aheadX || aheadY) && p.X() >= minOfTiles.Width() && p.Y() >= minOfTiles.Height() &&
+                    p.X() <= maxOfTiles.Width() && p.Y() <= maxOfTiles.Height()) {
+                    ring.append(p);
+                }
+            }
+        }
+        std::stable_sort(ring.begin(), ring.end(), CenterDistanceLess(centerTileXYLocation));
+        foreach(Point p, ring) {
+            tasks.append(LoadTask(p, Zoom()));
+        }
+    }
+    // the levels a zoom step would show, coarser one first as it is cheap
+    if (Zoom() > 0) {
+        MtileDrawingList.lock();
+        foreach(Point p, tileDrawingList) {
+            LoadTask task(Point(p.X() >> 1, p.Y() >> 1), Zoom() - 1);
+            if (!tasks.contains(task)) {
+                tasks.append(task);
+            }
+        }
+        MtileDrawingList.unlock();
+    }
+    if (Zoom() < MaxZoom()) {
+        for (int i = 0; i < 4; i++) {
+            tasks.append(LoadTask(Point(centerTileXYLocation.X() * 2 + (i & 1), centerTileXYLocation.Y() * 2 + (i >> 1)), Zoom() + 1));
+        }
+    }
+    // tile numbering is projection specific, drop what falls off the other levels
+    for (int i = tasks.count() - 1; i >= 0; i--) {
+        const LoadTask &task = tasks.at(i);
+        if (task.Zoom != Zoom()) {
+            Size min = Projection()->GetTileMatrixMinXY(task.Zoom);
+            Size max = Projection()->GetTileMatrixMaxXY(task.Zoom);
+            if (task.Pos.X() < min.Width() || task.Pos.Y() < min.Height() || task.Pos.X() > max.Width() || task.Pos.Y() > max.Height()) {
+                tasks.removeAt(i);
+            }
+        }
+    }
+
+    MtileLoadQueue.lock();
+    {
+        // panning only drops what is still queued, downloads in flight are still useful
+        prefetchQueue.clear();
+        ++prefetchGeneration;
+        foreach(LoadTask task, tasks) {
+            if (!tileLoadQueue.contains(task)) {
+                prefetchQueue.enqueue(task);
+            }
+        }
+        int threads = qMin(prefetchQueue.count(), prefetchLimit.available());
+        for (int i = 0; i < threads; i++) {
+            ProcessLoadTaskCallback.start(this);
+        }
+    }
+    MtileLoadQueue.unlock();
+}
+void Core::CancelPrefetch()
+{
+    MtileLoadQueue.lock();
+    {
+        prefetchQueue.clear();
+        ++prefetchGeneration;
+    }
+    MtileLoadQueue.unlock();
+    OPMaps::Instance()->CancelDownloads(PrefetchGroup());
+}
+void Core::RunPrefetch(const LoadTask &task, int generation)
+{
+    QVector<MapType::Types> layers = OPMaps::Instance()->GetAllLayersOfType(GetMapType());
+    int priority = PrefetchPriority;
+
+    if (task.Zoom == Zoom()) {
+        priority += CenterDistanceLess(centerTileXYLocation).Distance(task.Pos);
+    } else {
+        priority += 1 << 16;
+    }
+    foreach(MapType::Types tl, layers) {
+        MtileLoadQueue.lock();
+        bool cancelled = (generation != prefetchGeneration);
+        MtileLoadQueue.unlock();
+        if (cancelled) {
+            break;
+        }
+        // only warms the memory and database caches, the matrix is filled once the tile is visible
+        if (tl == MapType::PergoTurkeyMap) {
+            int maxY = Projection()->GetTileMatrixMaxXY(task.Zoom).Height();
+            OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxY - task.Pos.Y()), task.Zoom, priority, PrefetchGroup());
+        } else {
+            OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom, priority, PrefetchGroup());
+        }
+    }
+    prefetchLimit.release();
 }
 void Core::FindTilesAround(QList<Point> &list)
 {
@@ -614,6 +828,8 @@ void Core::FindTilesAround(QList<Point> &list)
             }
         }
     }
+    // load from the viewport center outward
+    std::stable_sort(list.begin(), list.end(), CenterDistanceLess(centerTileXYLocation));
 }
 void Core::UpdateGroundResolution()
 {
@@ -294,6 +294,15 @@ public:
 
     void FindTilesAround(QList<core::Point> &list);
 
+    /**
+     * @brief Ground velocity used to aim the tile prefetch ahead of the
+     *        movement, a hint expires a few seconds after it was set
+     *
+     * @param north velocity in m/s
+     * @param east velocity in m/s
+     */
+    void SetMotionHint(double const & north, double const & east);
+
     void UpdateGroundResolution();
 
     TileMatrix Matrix;
@@ -369,6 +378,27 @@ private:
     QThreadPool ProcessLoadTaskCallback;
     QMutex MtileToload;
     int tilesToload;
+    // bumped by CancelAsyncTasks(), guarded by MtileLoadQueue
+    int cancelGeneration;
+    bool TaskCancelled(int generation);
+
+    // tiles fetched into the caches ahead of the view, guarded by MtileLoadQueue
+    QQueue<LoadTask> prefetchQueue;
+    int prefetchGeneration;
+    QSemaphore prefetchLimit;
+    core::Point prefetchLastCenter;
+    int prefetchLastZoom;
+    QMutex Mmotion;
+    double motionNorth;
+    double motionEast;
+    QTime motionStamp;
+    void QueuePrefetch();
+    void CancelPrefetch();
+    void RunPrefetch(LoadTask const & task, int generation);
+    quintptr PrefetchGroup() const
+    {
+        return (quintptr)&prefetchQueue;
+    }
 
     int maxzoom;
     QMutex MrunningThreads;
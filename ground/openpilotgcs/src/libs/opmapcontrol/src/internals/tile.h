@@ -30,6 +30,7 @@
 #include "QList"
 #include <QImage>
 #include "../core/point.h"
+#include "../core/maptype.h"
 #include <QMutex>
 #include <QDebug>
 #include "debugheader.h"
@@ -66,7 +67,14 @@ public:
     {
         return !(zoom == 0);
     }
+    void AddOverlay(MapType::Types type, const QByteArray &img)
+    {
+        Overlays.append(img);
+        OverlayTypes.append(type);
+    }
     QList<QByteArray> Overlays;
+    // map type of each entry in Overlays, keys the decoded tile cache
+    QList<MapType::Types> OverlayTypes;
 protected:
 
     QMutex mutex;
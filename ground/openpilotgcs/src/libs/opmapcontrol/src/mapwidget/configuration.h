@@ -152,6 +152,17 @@ public:
         core::OPMaps::Instance()->TilesInMemory.setMemoryCacheCapacity(value);
     }
 
+    /**
+     * @brief  Sets the size of the memory for decoded tiles
+     *
+     * @param  value size in Mb to use for decoded tiles, 0 disables the decoded cache
+     * @return
+     */
+    void SetDecodedTileMemorySize(int const & value)
+    {
+        core::OPMaps::Instance()->TilesInMemory.setDecodedCacheCapacity(value);
+    }
+
     /**
      * @brief Sets the location for the SQLite Database used for caching and the geocoding cache files
      *
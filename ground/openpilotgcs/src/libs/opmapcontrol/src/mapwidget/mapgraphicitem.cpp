@@ -317,13 +317,16 @@ void MapGraphicItem::DrawMap2D(QPainter *painter)
                         // render tile
                         // lock(t.Overlays)
                         if (t != 0) {
-                            foreach(QByteArray img, t->Overlays) {
+                            for (int k = 0; k < t->Overlays.count(); ++k) {
+                                const QByteArray &img = t->Overlays.at(k);
                                 if (img.count() != 0) {
                                     if (!found) {
                                         found = true;
                                     }
                                     {
-                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromStream(img));
+                                        // decoded images are cached, repainting the viewport does not decode again
+                                        RawTile key(t->OverlayTypes.at(k), t->GetPos(), t->GetZoom());
+                                        painter->drawImage(QRect(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height()), OPMaps::Instance()->GetDecodedTileFromMemoryCache(key, img));
                                     }
                                 }
                             }
@@ -382,6 +385,18 @@ core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & poi
     }
     return ret;
 }
+QTransform MapGraphicItem::FromPixelToLocalTransform()
+{
+    QTransform t;
+
+    if (MapRenderTransform != 1) {
+        t.translate(-((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2,
+                    -((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2);
+        t.scale(MapRenderTransform, MapRenderTransform);
+    }
+    t.translate(core->GetrenderOffset().X(), core->GetrenderOffset().Y());
+    return t;
+}
 internals::PointLatLng MapGraphicItem::FromLocalToLatLng(int x, int y)
 {
     if (MapRenderTransform != 1) {
@@ -76,6 +76,21 @@ public:
      * @return core::Point Local item point
      */
     core::Point FromLatLngToLocal(internals::PointLatLng const & point);
+    /**
+     * @brief Returns the transform from projection pixel coordinates at
+     *        PixelZoom() to local item coordinates
+     *
+     * Lets items that draw many points project them once per zoom level
+     * instead of calling FromLatLngToLocal on every repaint.
+     */
+    QTransform FromPixelToLocalTransform();
+    /**
+     * @brief Returns the integer zoom level used by the projection
+     */
+    int PixelZoom() const
+    {
+        return core->Zoom();
+    }
     /**
      * @brief Converts from local item coordinates to LatLong point
      *
@@ -52,3 +52,7 @@ void MapRipForm::SetNumberOfTiles(const int &total, const int &actual)
 {
     ui->statuslabel->setText(QString(tr("Downloading tile %1 of %2")).arg(actual).arg(total));
 }
+void MapRipForm::SetThroughput(const double &tilesPerSecond, const double &kBytesPerSecond)
+{
+    ui->ratelabel->setText(QString(tr("%1 tiles/s, %2 kB/s")).arg(tilesPerSecond, 0, 'f', 1).arg(kBytesPerSecond, 0, 'f', 0));
+}
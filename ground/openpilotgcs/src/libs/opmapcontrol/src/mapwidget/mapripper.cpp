@@ -25,25 +25,41 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "mapripper.h"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSettings>
 namespace mapcontrol {
+// parallel downloads, sleep in MapRipper keeps the request rate down
+static const int RIP_WORKERS = 4;
+static const int RIP_RETRIES = 3;
+
+class MapRipWorker : public QRunnable {
+public:
+    MapRipWorker(MapRipper *ripper) : ripper(ripper) {}
+    void run()
+    {
+        ripper->FetchTiles();
+    }
+private:
+    MapRipper *ripper;
+};
+
 MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect) : sleep(100), cancel(false), progressForm(0), core(core), yesToAll(false)
 {
     if (!rect.IsEmpty()) {
-        type    = core->GetMapType();
-        progressForm = new MapRipForm;
-        connect(progressForm, SIGNAL(cancelRequest()), this, SLOT(stopFetching()));
-        area    = rect;
-        zoom    = core->Zoom();
-        maxzoom = core->MaxZoom();
-        points  = core->Projection()->GetAreaTileList(area, zoom, 0);
-        this->start();
-        cancel  = false;
-        progressForm->show();
-        connect(this, SIGNAL(percentageChanged(int)), progressForm, SLOT(SetPercentage(int)));
-        connect(this, SIGNAL(numberOfTilesChanged(int, int)), progressForm, SLOT(SetNumberOfTiles(int, int)));
-        connect(this, SIGNAL(providerChanged(QString, int)), progressForm, SLOT(SetProvider(QString, int)));
-        connect(this, SIGNAL(finished()), this, SLOT(finish()));
-        emit numberOfTilesChanged(0, 0);
+        Start(rect, core->Zoom(), core->MaxZoom(), core->GetMapType());
+    } else
+#ifdef Q_OS_DARWIN
+    { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <COMMAND>+Left mouse click")); }
+#else
+    { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <CTRL>+Left mouse click")); }
+#endif
+}
+MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect, int minZoom, int maxZoom)
+    : sleep(100), cancel(false), progressForm(0), core(core), yesToAll(true)
+{
+    if (!rect.IsEmpty()) {
+        Start(rect, minZoom, maxZoom, core->GetMapType());
     } else
 #ifdef Q_OS_DARWIN
     { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <COMMAND>+Left mouse click")); }
@@ -51,6 +67,32 @@ MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect)
     { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <CTRL>+Left mouse click")); }
 #endif
 }
+MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect, int minZoom, int maxZoom, core::MapType::Types type)
+    : sleep(100), cancel(false), progressForm(0), core(core), yesToAll(true)
+{
+    Start(rect, minZoom, maxZoom, type);
+}
+void MapRipper::Start(const internals::RectLatLng & rect, int minZoom, int maxZoom, core::MapType::Types maptype)
+{
+    type    = maptype;
+    progressForm = new MapRipForm;
+    connect(progressForm, SIGNAL(cancelRequest()), this, SLOT(stopFetching()));
+    area    = rect;
+    tilesFailed = 0;
+    zoom    = minZoom;
+    maxzoom = qMin(maxZoom, core->MaxZoom());
+    points  = core->Projection()->GetAreaTileList(area, zoom, 0);
+    SaveJob();
+    this->start();
+    cancel  = false;
+    progressForm->show();
+    connect(this, SIGNAL(percentageChanged(int)), progressForm, SLOT(SetPercentage(int)));
+    connect(this, SIGNAL(numberOfTilesChanged(int, int)), progressForm, SLOT(SetNumberOfTiles(int, int)));
+    connect(this, SIGNAL(providerChanged(QString, int)), progressForm, SLOT(SetProvider(QString, int)));
+    connect(this, SIGNAL(throughputChanged(double, double)), progressForm, SLOT(SetThroughput(double, double)));
+    connect(this, SIGNAL(finished()), this, SLOT(finish()));
+    emit numberOfTilesChanged(0, 0);
+}
 void MapRipper::finish()
 {
     if (zoom < maxzoom && !cancel) {
@@ -69,18 +111,26 @@ void MapRipper::finish()
         if (ret == QMessageBox::Yes) {
             points.clear();
             points = core->Projection()->GetAreaTileList(area, zoom, 0);
+            SaveJob();
             this->start();
         } else if (ret == QMessageBox::YesAll) {
             yesToAll = true;
             points.clear();
             points   = core->Projection()->GetAreaTileList(area, zoom, 0);
+            SaveJob();
             this->start();
         } else {
+            // declined by the user, nothing left to resume
+            ClearJob();
             progressForm->close();
             delete progressForm;
             this->deleteLater();
         }
     } else {
+        // a cancelled or failed run keeps its job for ResumeUnfinishedJob()
+        if (!cancel && tilesFailed == 0) {
+            ClearJob();
+        }
         yesToAll = false;
         progressForm->close();
         delete progressForm;
@@ -91,51 +141,141 @@ void MapRipper::finish()
 
 void MapRipper::run()
 {
-    int countOk   = 0;
-    bool goodtile = false;
+    mutex.lock();
+    nextPoint   = 0;
+    tilesDone   = 0;
+    bytesDone   = 0;
+    nextRequest = 0;
+    clock.start();
+    mutex.unlock();
+
+    emit providerChanged(core::MapType::StrByType(type), zoom);
+    emit numberOfTilesChanged(points.count(), 0);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(RIP_WORKERS);
+    for (int i = 0; i < RIP_WORKERS; i++) {
+        pool.start(new MapRipWorker(this));
+    }
+    pool.waitForDone();
+}
 
-    // Stuff.Shuffle<Point>(ref list);
+void MapRipper::FetchTiles()
+{
     QVector<core::MapType::Types> types = OPMaps::Instance()->GetAllLayersOfType(type);
     int all = points.count();
-    for (int i = 0; i < all; i++) {
-        emit numberOfTilesChanged(all, i + 1);
-        if (cancel) {
+
+    while (true) {
+        mutex.lock();
+        if (cancel || nextPoint >= all) {
+            mutex.unlock();
             break;
         }
+        core::Point p = points.at(nextPoint++);
+        mutex.unlock();
 
-        core::Point p = points[i];
-        {
-            // qDebug()<<"offline fetching:"<<p.ToString();
-            foreach(core::MapType::Types type, types) {
-                emit providerChanged(core::MapType::StrByType(type), zoom);
-                QByteArray img = OPMaps::Instance()->GetImageFrom(type, p, zoom);
-
-                if (img.length() != 0) {
-                    goodtile = true;
-                    img = NULL;
-                } else {
-                    goodtile = false;
-                }
-            }
-            if (goodtile) {
-                countOk++;
-            } else {
-                i--;
-                QThread::msleep(1000);
+        bool goodtile = true;
+        qint64 bytes  = 0;
+        foreach(core::MapType::Types layer, types) {
+            // resuming, tiles cached by an earlier run are not downloaded again
+            if (Cache::Instance()->ImageCache.ImageExistsInCache(layer, p, zoom)) {
                 continue;
             }
+            bool ok = false;
+            for (int retry = 0; !ok && retry < RIP_RETRIES && !IsCancelled(); retry++) {
+                int size = 0;
+                RateLimit();
+                ok     = OPMaps::Instance()->FetchTileToCache(layer, p, zoom, (quintptr)this, size);
+                bytes += size;
+            }
+            goodtile = goodtile && ok;
+        }
+
+        mutex.lock();
+        int done = ++tilesDone;
+        if (!goodtile && !cancel) {
+            ++tilesFailed;
         }
-        emit percentageChanged((int)((i + 1) * 100 / all)); // , i+1);
-        // worker.ReportProgress((int) ((i+1)*100/all), i+1);
+        bytesDone += bytes;
+        double elapsed = qMax((qint64)1, clock.elapsed()) / 1000.0;
+        double tilesPerSecond  = done / elapsed;
+        double kBytesPerSecond = bytesDone / 1024.0 / elapsed;
+        mutex.unlock();
 
-        QThread::msleep(sleep);
+        emit numberOfTilesChanged(all, done);
+        emit percentageChanged((int)(done * 100 / all));
+        emit throughputChanged(tilesPerSecond, kBytesPerSecond);
     }
 }
 
-void MapRipper::stopFetching()
+void MapRipper::RateLimit()
+{
+    // hands out request slots sleep ms apart, shared by all workers
+    mutex.lock();
+    qint64 now  = clock.elapsed();
+    qint64 slot = qMax(now, nextRequest);
+    nextRequest = slot + sleep;
+    mutex.unlock();
+    if (slot > now) {
+        QThread::msleep(slot - now);
+    }
+}
+
+bool MapRipper::IsCancelled()
 {
     QMutexLocker locker(&mutex);
 
-    cancel = true;
+    return cancel;
+}
+
+void MapRipper::stopFetching()
+{
+    {
+        QMutexLocker locker(&mutex);
+        cancel = true;
+    }
+    // release the workers waiting on downloads
+    OPMaps::Instance()->CancelDownloads((quintptr)this);
+}
+
+QString MapRipper::JobFile()
+{
+    return Cache::Instance()->CacheLocation() + "mapripper.ini";
+}
+void MapRipper::SaveJob()
+{
+    QSettings job(JobFile(), QSettings::IniFormat);
+
+    job.setValue("type", (int)type);
+    job.setValue("lat", area.Lat());
+    job.setValue("lng", area.Lng());
+    job.setValue("widthLng", area.WidthLng());
+    job.setValue("heightLat", area.HeightLat());
+    job.setValue("zoom", zoom);
+    job.setValue("maxZoom", maxzoom);
+}
+void MapRipper::ClearJob()
+{
+    QSettings job(JobFile(), QSettings::IniFormat);
+
+    job.clear();
+}
+bool MapRipper::HasUnfinishedJob()
+{
+    QSettings job(JobFile(), QSettings::IniFormat);
+
+    return job.contains("zoom");
+}
+bool MapRipper::ResumeUnfinishedJob(internals::Core *core)
+{
+    QSettings job(JobFile(), QSettings::IniFormat);
+
+    if (!job.contains("zoom")) {
+        return false;
+    }
+    internals::RectLatLng rect(job.value("lat").toDouble(), job.value("lng").toDouble(),
+                               job.value("widthLng").toDouble(), job.value("heightLat").toDouble());
+    new MapRipper(core, rect, job.value("zoom").toInt(), job.value("maxZoom").toInt(), (core::MapType::Types)job.value("type").toInt());
+    return true;
 }
 }
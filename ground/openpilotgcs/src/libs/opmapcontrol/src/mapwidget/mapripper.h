@@ -28,17 +28,36 @@
 #define MAPRIPPER_H
 
 #include <QThread>
+#include <QElapsedTimer>
 #include "../internals/core.h"
 #include "mapripform.h"
 #include <QObject>
 #include <QMessageBox>
 namespace mapcontrol {
+class MapRipWorker;
 class MapRipper : public QThread {
     Q_OBJECT
+    friend class MapRipWorker;
 public:
+    // rips from the current zoom up to the maximum, asking before each level
     MapRipper(internals::Core *, internals::RectLatLng const &);
+    // rips every zoom level in [minZoom, maxZoom] without asking
+    MapRipper(internals::Core *, internals::RectLatLng const &, int minZoom, int maxZoom);
     void run();
+    // a download that was cancelled or interrupted can be picked up again,
+    // tiles already in the cache are skipped
+    static bool HasUnfinishedJob();
+    static bool ResumeUnfinishedJob(internals::Core *);
 private:
+    MapRipper(internals::Core *, internals::RectLatLng const &, int minZoom, int maxZoom, core::MapType::Types type);
+    void Start(internals::RectLatLng const &, int minZoom, int maxZoom, core::MapType::Types type);
+    void FetchTiles();
+    void RateLimit();
+    bool IsCancelled();
+    void SaveJob();
+    static void ClearJob();
+    static QString JobFile();
+
     QList<core::Point> points;
     int zoom;
     core::MapType::Types type;
@@ -50,11 +69,19 @@ private:
     internals::Core *core;
     bool yesToAll;
     QMutex mutex;
+    // shared by the fetch workers, guarded by mutex
+    int nextPoint;
+    int tilesDone;
+    int tilesFailed;
+    qint64 bytesDone;
+    qint64 nextRequest;
+    QElapsedTimer clock;
 
 signals:
     void percentageChanged(int const & perc);
     void numberOfTilesChanged(int const & total, int const & actual);
     void providerChanged(QString const & prov, int const & zoom);
+    void throughputChanged(double const & tilesPerSecond, double const & kBytesPerSecond);
 
 
 public slots:
@@ -521,6 +521,14 @@ void OPMapWidget::RipMap()
 {
     new MapRipper(core, map->SelectedArea());
 }
+void OPMapWidget::RipMap(int minZoom, int maxZoom)
+{
+    new MapRipper(core, map->SelectedArea(), minZoom, maxZoom);
+}
+bool OPMapWidget::ResumeRipMap()
+{
+    return MapRipper::ResumeUnfinishedJob(core);
+}
 
 void OPMapWidget::setSelectedWP(QList<WayPointItem * >list)
 {
@@ -321,6 +321,16 @@ public:
     {
         map->core->SetCurrentPosition(value);
     }
+    /**
+     * @brief Sets the ground velocity used to prefetch tiles ahead of the UAV
+     *
+     * @param north velocity in m/s
+     * @param east velocity in m/s
+     */
+    void SetMotionHint(double const & north, double const & east)
+    {
+        map->core->SetMotionHint(north, east);
+    }
 
     double ZoomReal()
     {
@@ -656,6 +666,14 @@ public slots:
      * @brief Ripps the current selection to the DB
      */
     void RipMap();
+    /**
+     * @brief Downloads the current selection for every zoom level in [minZoom, maxZoom] to the DB
+     */
+    void RipMap(int minZoom, int maxZoom);
+    /**
+     * @brief Continues an interrupted RipMap, returns false if there is none
+     */
+    bool ResumeRipMap();
     void OnSelectionChanged();
 };
 }
@@ -0,0 +1,270 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      A graphicsItem drawing a whole UAV or GPS trail
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "trailpathitem.h"
+#include <QStyleOptionGraphicsItem>
+
+namespace mapcontrol {
+// raw points collected before the tail is simplified into a chunk
+static const int ChunkPoints = 256;
+static const qreal DotRadius = 2;
+
+TrailPathItem::TrailPathItem(QColor dotColor, QColor lineColor, MapGraphicItem *map) : QGraphicsItem(map), m_map(map), m_dotBrush(dotColor),
+    showdots(true), showline(true), maxpoints(0), tolerance(1.0), cachedzoom(-1), cachedscale(0)
+{
+    m_linePen.setColor(lineColor);
+    m_linePen.setWidth(1);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    Refresh();
+}
+
+QRectF TrailPathItem::boundingRect() const
+{
+    return localbounds;
+}
+
+int TrailPathItem::type() const
+{
+    return Type;
+}
+
+void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    QRectF exposed = option->exposedRect.adjusted(-DotRadius, -DotRadius, DotRadius, DotRadius);
+    QRectF world   = transform.inverted().mapRect(exposed);
+
+    painter->save();
+    foreach(const Chunk &chunk, chunks) {
+        if (chunk.bounds.intersects(world)) {
+            DrawPolygon(painter, chunk.points, exposed);
+        }
+    }
+    if (tail.count() && tail.boundingRect().intersects(world)) {
+        QPolygonF simplified;
+        Simplify(tail, tolerance / cachedscale, simplified);
+        DrawPolygon(painter, simplified, exposed);
+    }
+    painter->restore();
+}
+
+void TrailPathItem::DrawPolygon(QPainter *painter, const QPolygonF &points, const QRectF &exposed)
+{
+    QPolygonF local = transform.map(points);
+
+    if (showline && local.count() > 1) {
+        painter->setPen(m_linePen);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPolyline(local);
+    }
+    if (showdots) {
+        painter->setPen(Qt::black);
+        painter->setBrush(m_dotBrush);
+        foreach(const QPointF &p, local) {
+            if (exposed.contains(p)) {
+                painter->drawEllipse(p, DotRadius, DotRadius);
+            }
+        }
+    }
+}
+
+void TrailPathItem::AddPoint(const internals::PointLatLng &coord)
+{
+    coords.append(coord);
+    if (maxpoints > 0 && coords.count() > maxpoints) {
+        // drop an extra tenth so the rebuild does not happen on every point
+        coords.remove(0, coords.count() - maxpoints + maxpoints / 10);
+        cachedzoom = -1;
+        Refresh();
+        return;
+    }
+    if (cachedzoom >= 0) {
+        core::Point p = m_map->Projection()->FromLatLngToPixel(coord, cachedzoom);
+        AppendProjected(QPointF(p.X(), p.Y()));
+    }
+    Refresh();
+}
+
+void TrailPathItem::Clear()
+{
+    coords.clear();
+    cachedzoom = -1;
+    Refresh();
+}
+
+void TrailPathItem::SetShowDots(const bool &value)
+{
+    showdots = value;
+    setVisible(showdots || showline);
+    update();
+}
+
+void TrailPathItem::SetShowLine(const bool &value)
+{
+    showline = value;
+    setVisible(showdots || showline);
+    update();
+}
+
+void TrailPathItem::SetMaxPoints(const int &value)
+{
+    maxpoints = qMax(0, value);
+    if (maxpoints > 0 && coords.count() > maxpoints) {
+        coords.remove(0, coords.count() - maxpoints);
+    }
+    cachedzoom = -1;
+    Refresh();
+}
+
+void TrailPathItem::SetTolerance(const qreal &value)
+{
+    tolerance  = qMax((qreal)0, value);
+    cachedzoom = -1;
+    Refresh();
+}
+
+void TrailPathItem::Refresh()
+{
+    transform = m_map->FromPixelToLocalTransform();
+    if (cachedzoom != m_map->PixelZoom() || cachedscale != transform.m11()) {
+        Rebuild();
+    }
+    prepareGeometryChange();
+    QRectF world = WorldBounds();
+    if (world.isNull()) {
+        localbounds = QRectF();
+    } else {
+        localbounds = transform.mapRect(world).adjusted(-DotRadius - 1, -DotRadius - 1, DotRadius + 1, DotRadius + 1);
+    }
+    update();
+}
+
+void TrailPathItem::Rebuild()
+{
+    chunks.clear();
+    tail.clear();
+    cachedzoom  = m_map->PixelZoom();
+    cachedscale = transform.m11();
+    foreach(const internals::PointLatLng &coord, coords) {
+        core::Point p = m_map->Projection()->FromLatLngToPixel(coord, cachedzoom);
+
+        AppendProjected(QPointF(p.X(), p.Y()));
+    }
+}
+
+void TrailPathItem::AppendProjected(const QPointF &point)
+{
+    // points landing on the same pixel add nothing at this zoom
+    if (tail.count() && tail.last() == point) {
+        return;
+    }
+    tail.append(point);
+    if (tail.count() >= ChunkPoints) {
+        FreezeTail();
+    }
+}
+
+void TrailPathItem::FreezeTail()
+{
+    Chunk chunk;
+
+    Simplify(tail, tolerance / cachedscale, chunk.points);
+    chunk.bounds = chunk.points.boundingRect();
+    chunks.append(chunk);
+    // keep the last point so the next chunk joins this one
+    QPointF last = tail.last();
+    tail.clear();
+    tail.append(last);
+}
+
+QRectF TrailPathItem::WorldBounds() const
+{
+    QRectF bounds;
+
+    foreach(const Chunk &chunk, chunks) {
+        bounds = bounds.united(chunk.bounds);
+    }
+    if (tail.count()) {
+        bounds = bounds.united(tail.boundingRect());
+    }
+    return bounds;
+}
+
+void TrailPathItem::Simplify(const QPolygonF &in, qreal tolerance, QPolygonF &out)
+{
+    int n = in.count();
+
+    if (n < 3 || tolerance <= 0) {
+        out += in;
+        return;
+    }
+    // iterative Douglas-Peucker, a long straight leg would overflow the stack
+    QVector<bool> keep(n, false);
+    QVector<QPair<int, int> > segments;
+    qreal tolerance2 = tolerance * tolerance;
+
+    keep[0]     = true;
+    keep[n - 1] = true;
+    segments.append(qMakePair(0, n - 1));
+    while (!segments.isEmpty()) {
+        QPair<int, int> segment = segments.last();
+        segments.remove(segments.count() - 1);
+
+        const QPointF &a = in.at(segment.first);
+        const QPointF &b = in.at(segment.second);
+        qreal dx   = b.x() - a.x();
+        qreal dy   = b.y() - a.y();
+        qreal len2 = dx * dx + dy * dy;
+        qreal maxd = 0;
+        int index  = -1;
+        for (int i = segment.first + 1; i < segment.second; ++i) {
+            qreal px = in.at(i).x() - a.x();
+            qreal py = in.at(i).y() - a.y();
+            if (len2 > 0) {
+                qreal t = qBound((qreal)0, (px * dx + py * dy) / len2, (qreal)1);
+                px -= t * dx;
+                py -= t * dy;
+            }
+            qreal d = px * px + py * py;
+            if (d > maxd) {
+                maxd  = d;
+                index = i;
+            }
+        }
+        if (maxd > tolerance2) {
+            keep[index] = true;
+            segments.append(qMakePair(segment.first, index));
+            segments.append(qMakePair(index, segment.second));
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        if (keep[i]) {
+            out.append(in.at(i));
+        }
+    }
+}
+}
@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      A graphicsItem drawing a whole UAV or GPS trail
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPolygonF>
+#include <QTransform>
+#include <QVector>
+#include "../internals/pointlatlng.h"
+#include "mapgraphicitem.h"
+
+namespace mapcontrol {
+/**
+ * @brief A single item holding every point of a trail
+ *
+ * Points are projected once per zoom level and simplified with
+ * Douglas-Peucker into chunks of world pixel coordinates. Panning only
+ * changes the pixel to local transform, and chunks outside the exposed
+ * area are skipped when painting.
+ */
+class TrailPathItem : public QGraphicsItem {
+public:
+    enum { Type = UserType + 10 };
+    TrailPathItem(QColor dotColor, QColor lineColor, MapGraphicItem *map);
+    QRectF boundingRect() const;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    int type() const;
+
+    /**
+     * @brief Appends a point to the trail, dropping the oldest points
+     *        once MaxPoints() is exceeded
+     */
+    void AddPoint(internals::PointLatLng const & coord);
+    /**
+     * @brief Deletes all the trail points
+     */
+    void Clear();
+    /**
+     * @brief Recomputes the cached geometry after the map moved or zoomed
+     */
+    void Refresh();
+
+    void SetShowDots(bool const & value);
+    void SetShowLine(bool const & value);
+
+    /**
+     * @brief Sets the maximum number of points kept, 0 means unlimited
+     */
+    void SetMaxPoints(int const & value);
+    int MaxPoints() const
+    {
+        return maxpoints;
+    }
+    /**
+     * @brief Sets the simplification tolerance in screen pixels, 0 disables it
+     */
+    void SetTolerance(qreal const & value);
+    qreal Tolerance() const
+    {
+        return tolerance;
+    }
+
+private:
+    struct Chunk {
+        QPolygonF points;
+        QRectF    bounds;
+    };
+
+    void Rebuild();
+    void AppendProjected(QPointF const & point);
+    void FreezeTail();
+    QRectF WorldBounds() const;
+    void DrawPolygon(QPainter *painter, QPolygonF const & points, QRectF const & exposed);
+
+    static void Simplify(QPolygonF const & in, qreal tolerance, QPolygonF &out);
+
+    MapGraphicItem *m_map;
+    QBrush m_dotBrush;
+    QPen m_linePen;
+    bool showdots;
+    bool showline;
+    int maxpoints;
+    qreal tolerance;
+
+    QVector<internals::PointLatLng> coords;
+    // geometry below is in projection pixels at cachedzoom
+    QVector<Chunk> chunks;
+    QPolygonF tail;
+    int cachedzoom;
+    qreal cachedscale;
+    QTransform transform;
+    QRectF localbounds;
+};
+}
+#endif // TRAILPATHITEM_H
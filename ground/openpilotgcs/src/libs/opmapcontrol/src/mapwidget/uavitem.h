@@ -38,8 +38,7 @@
 #include "uavtrailtype.h"
 #include <QtSvg/QSvgRenderer>
 #include "opmapwidget.h"
-#include "trailitem.h"
-#include "traillineitem.h"
+#include "trailpathitem.h"
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
@@ -216,6 +215,19 @@ public:
      * @brief Deletes all the trail points
      */
     void DeleteTrail() const;
+    /**
+     * @brief Sets the maximum number of trail points kept, 0 means unlimited
+     *
+     * @param value
+     */
+    void SetTrailLength(int const & value);
+    /**
+     * @brief Sets how far in screen pixels the drawn trail may deviate
+     *        from the recorded points when it is simplified
+     *
+     * @param value
+     */
+    void SetTrailTolerance(qreal const & value);
     /**
      * @brief Returns true if the UAV automaticaly sets WP reached value (changing its color)
      *
@@ -282,9 +294,7 @@ private:
     double ringTime;
     QPixmap pic;
     core::Point localposition;
-    QGraphicsItemGroup *trail;
-    QGraphicsItemGroup *trailLine;
-    internals::PointLatLng lasttrailline;
+    TrailPathItem *trail;
     QTime timer;
     bool showtrail;
     bool showtrailline;
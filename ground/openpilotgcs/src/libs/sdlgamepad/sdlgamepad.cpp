@@ -20,6 +20,7 @@
 
 /**********************************************************************/
 #include "sdlgamepad.h"
+#include <QElapsedTimer>
 
 #include <SDL/SDL.h>
 // #undef main
@@ -90,10 +91,23 @@ bool SDLGamepad::init()
 /**********************************************************************/
 void SDLGamepad::run()
 {
+    QElapsedTimer clock;
+    qint64 nextTick = 0;
+
+    clock.start();
     while (loop) {
+        SDL_JoystickUpdate();
         updateAxes();
         updateButtons();
-        msleep(tick);
+
+        nextTick += tick;
+        qint64 now = clock.elapsed();
+        if (nextTick > now) {
+            msleep(nextTick - now);
+        } else {
+            // fell behind, don't try to catch up with a burst of ticks
+            nextTick = now;
+        }
     }
 }
 
@@ -142,7 +156,6 @@ void SDLGamepad::updateAxes()
 {
     if (priv->gamepad) {
         QListInt16 values;
-        SDL_JoystickUpdate();
 
         for (qint8 i = 0; i < axes; i++) {
             qint16 value = SDL_JoystickGetAxis(priv->gamepad, i);
@@ -154,7 +167,12 @@ void SDLGamepad::updateAxes()
             values.append(value);
         }
 
-        emit axesValues(values);
+        if (values != axesStates) {
+            QElapsedTimer sampleTime;
+            sampleTime.start();
+            axesStates = values;
+            emit axesValues(values, sampleTime.msecsSinceReference());
+        }
     }
 }
 
@@ -162,8 +180,6 @@ void SDLGamepad::updateAxes()
 void SDLGamepad::updateButtons()
 {
     if (priv->gamepad) {
-        SDL_JoystickUpdate();
-
         for (qint8 i = 0; i < buttons; i++) {
             qint16 state = SDL_JoystickGetButton(priv->gamepad, i);
 
@@ -152,7 +152,10 @@ public:
      * does the following:
      * - refresh SDL information
      * - emit signals
-     * - sleep tickrate
+     * - sleep until the next tick
+     *
+     * The ticks are scheduled on a fixed grid, so the sampling rate
+     * does not drift with the time spent in the signal handlers.
      */
     void run();
 
@@ -299,6 +302,8 @@ private:
      */
     QList<qint16> buttonStates;
 
+    QListInt16 axesStates;
+
     /**
      * Variable that holds private members.
      */
@@ -339,14 +344,16 @@ signals:
      * A signal that emitts the current values of the gamepad axes.
      *
      * You can connect to this signal to receive the values of the
-     * gamepad axes. Unlike the button signal, this signal is thrown
-     * with every tick. You will get a QListInt16 containing the value
-     * of every present axis in a QList.
+     * gamepad axes. Like the button signal, this signal is only thrown
+     * on the ticks where at least one axis changed. You will get a
+     * QListInt16 containing the value of every present axis in a QList.
      *
      * @see QListInt16
      * @param values A QListInt16 Type containing all axes values.
+     * @param sampleTime The QElapsedTimer::msecsSinceReference() time
+     * the axes were read at, to measure the input latency.
      */
-    void axesValues(QListInt16 values);
+    void axesValues(QListInt16 values, qint64 sampleTime);
 };
 
 #endif // SDLGAMEPAD_H
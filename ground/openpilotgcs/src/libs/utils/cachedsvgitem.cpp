@@ -24,6 +24,7 @@
 
 #include "cachedsvgitem.h"
 #include <QDebug>
+#include <qmath.h>
 
 #ifndef GL_CLAMP_TO_EDGE
 #define GL_CLAMP_TO_EDGE 0x812F
@@ -33,7 +34,9 @@ CachedSvgItem::CachedSvgItem(QGraphicsItem *parent) :
     QGraphicsSvgItem(parent),
     m_context(0),
     m_texture(0),
-    m_scale(1.0)
+    m_scale(1.0),
+    m_pixmapScaleX(0),
+    m_pixmapScaleY(0)
 {
     setCacheMode(NoCache);
 }
@@ -42,7 +45,9 @@ CachedSvgItem::CachedSvgItem(const QString & fileName, QGraphicsItem *parent) :
     QGraphicsSvgItem(fileName, parent),
     m_context(0),
     m_texture(0),
-    m_scale(1.0)
+    m_scale(1.0),
+    m_pixmapScaleX(0),
+    m_pixmapScaleY(0)
 {
     setCacheMode(NoCache);
 }
@@ -59,8 +64,7 @@ void CachedSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
 {
     if (painter->paintEngine()->type() != QPaintEngine::OpenGL &&
         painter->paintEngine()->type() != QPaintEngine::OpenGL2) {
-        // Fallback to direct painting
-        QGraphicsSvgItem::paint(painter, option, widget);
+        paintPixmap(painter, option);
         return;
     }
 
@@ -157,3 +161,40 @@ void CachedSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
 
     painter->endNativePainting();
 }
+
+void CachedSvgItem::paintPixmap(QPainter *painter, const QStyleOptionGraphicsItem *option)
+{
+    QRectF br = boundingRect();
+    QTransform transform = painter->worldTransform();
+    qreal ratio  = painter->device()->devicePixelRatio();
+    // rotations do not change the lengths, the needles are drawn from the cache
+    qreal scaleX = transform.map(QLineF(0, 0, 1, 0)).length() * ratio;
+    qreal scaleY = transform.map(QLineF(0, 0, 0, 1)).length() * ratio;
+
+    if (m_pixmap.isNull() || !qFuzzyCompare(scaleX, m_pixmapScaleX) || !qFuzzyCompare(scaleY, m_pixmapScaleY) ||
+        br != m_pixmapRect || elementId() != m_pixmapElementId) {
+        QSize size(qCeil(br.width() * scaleX), qCeil(br.height() * scaleY));
+        if (size.isEmpty()) {
+            return;
+        }
+        QPixmap pixmap(size);
+        pixmap.fill(Qt::transparent);
+        {
+            QPainter p(&pixmap);
+            p.setRenderHints(painter->renderHints());
+            p.scale(scaleX, scaleY);
+            p.translate(-br.topLeft());
+            QGraphicsSvgItem::paint(&p, option, 0);
+        }
+        m_pixmap          = pixmap;
+        m_pixmapScaleX    = scaleX;
+        m_pixmapScaleY    = scaleY;
+        m_pixmapRect      = br;
+        m_pixmapElementId = elementId();
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(br, m_pixmap, QRectF(m_pixmap.rect()));
+    painter->restore();
+}
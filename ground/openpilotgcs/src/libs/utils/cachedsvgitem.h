@@ -33,9 +33,9 @@
 
 class QGLContext;
 
-// Cache Svg item as GL Texture.
+// Cache Svg item as GL Texture, or as a pixmap at the device pixel ratio with other paint engines.
 // Texture is regenerated each time item is scaled
-// but it's reused during rotation, unlike DeviceCoordinateCache mode
+// but it's reused during rotation and translation, unlike DeviceCoordinateCache mode
 class QTCREATOR_UTILS_EXPORT CachedSvgItem : public QGraphicsSvgItem {
     Q_OBJECT
 public:
@@ -49,6 +49,15 @@ private:
     QGLContext *m_context;
     GLuint m_texture;
     qreal m_scale;
+
+    // raster cache, rendered again when the scale, element or bounds change
+    QPixmap m_pixmap;
+    qreal m_pixmapScaleX;
+    qreal m_pixmapScaleY;
+    QString m_pixmapElementId;
+    QRectF m_pixmapRect;
+
+    void paintPixmap(QPainter *painter, const QStyleOptionGraphicsItem *option);
 };
 
 #endif // ifndef CACHEDSVGITEM_H
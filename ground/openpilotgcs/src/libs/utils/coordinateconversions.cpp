@@ -31,11 +31,19 @@
 #include <stdint.h>
 #include <QDebug>
 #include <math.h>
+#include <Eigen/Core>
 
 #define RAD2DEG (180.0 / M_PI)
 #define DEG2RAD (M_PI / 180.0)
 
+// WGS-84
+#define WGS84_A  6378137.0
+#define WGS84_E2 (8.1819190842622e-2 * 8.1819190842622e-2)
+
 namespace Utils {
+typedef Eigen::Map<Eigen::Matrix<double, 3, Eigen::Dynamic> > PointsMap;
+typedef Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic> > ConstPointsMap;
+
 CoordinateConversions::CoordinateConversions()
 {}
 
@@ -277,4 +285,107 @@ void CoordinateConversions::R2Quaternion(float const Rbe[3][3], float q[4])
     q[2] = y;
     q[3] = z;
 }
+
+/**
+ * Convert count points from LLA to ECEF coordinates
+ * @param[in] LLA latitude longitude altitude triplets
+ * @param[out] ECEF location triplets in ECEF coordinates
+ */
+void CoordinateConversions::LLA2ECEF(const double *LLA, double *ECEF, int count)
+{
+    for (int i = 0; i < count; i++, LLA += 3, ECEF += 3) {
+        double sinLat = sin(DEG2RAD * LLA[0]);
+        double cosLat = cos(DEG2RAD * LLA[0]);
+        double sinLon = sin(DEG2RAD * LLA[1]);
+        double cosLon = cos(DEG2RAD * LLA[1]);
+        double N = WGS84_A / sqrt(1.0 - WGS84_E2 * sinLat * sinLat);
+
+        ECEF[0] = (N + LLA[2]) * cosLat * cosLon;
+        ECEF[1] = (N + LLA[2]) * cosLat * sinLon;
+        ECEF[2] = ((1 - WGS84_E2) * N + LLA[2]) * sinLat;
+    }
+}
+
+/**
+ * Convert count points from ECEF to LLA coordinates
+ * Closed form solution from H. Vermeille, "Direct transformation from
+ * geocentric coordinates to geodetic coordinates", Journal of Geodesy 2002.
+ * It is exact for points further than about 43 km from the earth center.
+ * @param[in] ECEF location triplets in ECEF coordinates
+ * @param[out] LLA latitude longitude altitude triplets
+ */
+void CoordinateConversions::ECEF2LLA(const double *ECEF, double *LLA, int count)
+{
+    const double e4 = WGS84_E2 * WGS84_E2;
+
+    for (int i = 0; i < count; i++, ECEF += 3, LLA += 3) {
+        double x   = ECEF[0], y = ECEF[1], z = ECEF[2];
+        double xy2 = x * x + y * y;
+        double xy  = sqrt(xy2);
+
+        double p   = xy2 / (WGS84_A * WGS84_A);
+        double q   = (1 - WGS84_E2) * z * z / (WGS84_A * WGS84_A);
+        double r   = (p + q - e4) / 6;
+        double s   = e4 * p * q / (4 * r * r * r);
+        double t   = cbrt(1 + s + sqrt(s * (2 + s)));
+        double u   = r * (1 + t + 1 / t);
+        double v   = sqrt(u * u + e4 * q);
+        double w   = WGS84_E2 * (u + v - q) / (2 * v);
+        double k   = sqrt(u + v + w * w) - w;
+        double D   = k * xy / (k + WGS84_E2);
+        double Dz  = sqrt(D * D + z * z);
+
+        LLA[0] = RAD2DEG * 2 * atan2(z, D + Dz);
+        LLA[1] = RAD2DEG * atan2(y, x);
+        LLA[2] = (k + WGS84_E2 - 1) / k * Dz;
+    }
+}
+
+/**
+ * Convert count points from LLA to NED offsets from a base location
+ * @param[in] LLA latitude longitude altitude triplets
+ * @param[in] BaseECEF ECEF of the base location
+ * @param[in] Rne rotation matrix of the base location, from RneFromLLA()
+ * @param[out] NED offset triplets from the base location (in m)
+ */
+void CoordinateConversions::LLA2Base(const double *LLA, const double BaseECEF[3], const float Rne[3][3], double *NED, int count)
+{
+    Eigen::Matrix3d R;
+    R << Rne[0][0], Rne[0][1], Rne[0][2],
+        Rne[1][0], Rne[1][1], Rne[1][2],
+        Rne[2][0], Rne[2][1], Rne[2][2];
+
+    // The ECEF points are built in place of the NED ones
+    LLA2ECEF(LLA, NED, count);
+    PointsMap points(NED, 3, count);
+    points.colwise() -= Eigen::Vector3d(BaseECEF[0], BaseECEF[1], BaseECEF[2]);
+    points = R * points;
+}
+
+/**
+ * Convert count NED offsets from a base location to LLA coordinates
+ * @param[in] BaseECEF ECEF of the base location (in m)
+ * @param[in] NED offset triplets from the base location (in m)
+ * @param[out] LLA latitude longitude altitude triplets
+ */
+void CoordinateConversions::NED2LLA_HomeECEF(const double BaseECEF[3], const double *NED, double *LLA, int count)
+{
+    double BaseLLA[3];
+    float Rne[3][3];
+
+    ECEF2LLA(BaseECEF, BaseLLA, 1);
+    RneFromLLA(BaseLLA, Rne);
+
+    Eigen::Matrix3d R;
+    R << Rne[0][0], Rne[0][1], Rne[0][2],
+        Rne[1][0], Rne[1][1], Rne[1][2],
+        Rne[2][0], Rne[2][1], Rne[2][2];
+
+    /* P = ECEF + Rne' * NED, built in place of the LLA points */
+    PointsMap points(LLA, 3, count);
+    points.noalias() = R.transpose() * ConstPointsMap(NED, 3, count);
+    points.colwise() += Eigen::Vector3d(BaseECEF[0], BaseECEF[1], BaseECEF[2]);
+
+    ECEF2LLA(LLA, LLA, count);
+}
 }
@@ -49,6 +49,12 @@ public:
     void RPY2Quaternion(const float rpy[3], float q[4]);
     void Quaternion2R(const float q[4], float Rbe[3][3]);
     void R2Quaternion(float const Rbe[3][3], float q[4]);
+
+    // Batch versions, the points are count consecutive triplets
+    void LLA2ECEF(const double *LLA, double *ECEF, int count);
+    void ECEF2LLA(const double *ECEF, double *LLA, int count);
+    void LLA2Base(const double *LLA, const double BaseECEF[3], const float Rne[3][3], double *NED, int count);
+    void NED2LLA_HomeECEF(const double BaseECEF[3], const double *NED, double *LLA, int count);
 };
 }
 
@@ -4,9 +4,14 @@
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    m_lastTimeStamp(0),
-    m_lastPlayed(0),
-    m_timeOffset(0),
+    m_replayData(NULL),
+    m_readPacket(0),
+    m_nextPacket(0),
+    m_readOffset(0),
+    m_bytesQueued(0),
+    m_replayTimeStamp(0),
+    m_replayStart(0),
+    m_replayPaused(false),
     m_playbackSpeed(1.0),
     m_nextTimeStamp(0),
     m_useProvidedTimeStamp(false)
@@ -54,6 +59,13 @@ void LogFile::close()
     if (m_timer.isActive()) {
         m_timer.stop();
     }
+    if (m_replayData && m_replayBuffer.isEmpty()) {
+        m_file.unmap((uchar *)m_replayData);
+    }
+    m_replayData = NULL;
+    m_replayBuffer.clear();
+    m_packetIndex.clear();
+    m_bytesQueued = 0;
     m_file.close();
     QIODevice::close();
 }
@@ -79,86 +91,139 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
     return dataSize;
 }
 
+/**
+ * Read queued replay data. A read never spans more than one logged packet so that
+ * replayTimeStamp() is the time stamp of the data that was just returned.
+ */
 qint64 LogFile::readData(char *data, qint64 maxSize)
 {
     QMutexLocker locker(&m_mutex);
-    qint64 toRead = qMin(maxSize, (qint64)m_dataBuffer.size());
 
-    memcpy(data, m_dataBuffer.data(), toRead);
-    m_dataBuffer.remove(0, toRead);
+    // Skip packets that were fully read
+    while (m_readPacket < m_nextPacket && m_readOffset >= m_packetIndex[m_readPacket].size) {
+        m_readPacket++;
+        m_readOffset = 0;
+    }
+    if (m_readPacket >= m_nextPacket) {
+        return 0;
+    }
+
+    const PacketIndex &packet = m_packetIndex[m_readPacket];
+    qint64 toRead = qMin(maxSize, packet.size - m_readOffset);
+
+    memcpy(data, m_replayData + packet.offset + m_readOffset, toRead);
+    m_readOffset      += toRead;
+    m_bytesQueued     -= toRead;
+    m_replayTimeStamp  = packet.timeStamp;
     return toRead;
 }
 
 qint64 LogFile::bytesAvailable() const
 {
-    return m_dataBuffer.size();
+    return m_bytesQueued;
 }
 
+/**
+ * Queue all the packets that are due at the current replay time and signal them
+ * with a single readyRead(). The replay clock is independent of the timer period,
+ * so high replay speeds only make the batches larger.
+ */
 void LogFile::timerFired()
 {
-    qint64 dataSize;
-
-    if (m_file.bytesAvailable() > 4) {
-        int time;
-        time = m_myTime.elapsed();
-
-        // TODO: going back in time will be a problem
-        while ((m_lastPlayed + ((time - m_timeOffset) * m_playbackSpeed) > m_lastTimeStamp)) {
-            m_lastPlayed += ((time - m_timeOffset) * m_playbackSpeed);
-            if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
-                stopReplay();
-                return;
-            }
-
-            m_file.read((char *)&dataSize, sizeof(dataSize));
-
-            if (dataSize < 1 || dataSize > (1024 * 1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
-
-            if (m_file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
-
-            m_mutex.lock();
-            m_dataBuffer.append(m_file.read(dataSize));
-            m_mutex.unlock();
-
-            emit readyRead();
-
-            if (m_file.bytesAvailable() < (qint64)sizeof(m_lastTimeStamp)) {
-                stopReplay();
-                return;
-            }
-
-            int save = m_lastTimeStamp;
-            m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
-            // some validity checks
-            if (m_lastTimeStamp < save // logfile goes back in time
-                || (m_lastTimeStamp - save) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
-                qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << m_lastTimeStamp << " after " << save << "\n";
-                stopReplay();
-                return;
-            }
-
-            m_timeOffset = time;
-            time = m_myTime.elapsed();
-        }
-    } else {
+    double now = currentReplayTime();
+    bool queued = false;
+
+    m_mutex.lock();
+    while (m_nextPacket < m_packetIndex.size() && m_packetIndex[m_nextPacket].timeStamp <= now) {
+        m_bytesQueued += m_packetIndex[m_nextPacket].size;
+        m_nextPacket++;
+        queued = true;
+    }
+    bool finished = m_nextPacket >= m_packetIndex.size();
+    m_mutex.unlock();
+
+    if (queued) {
+        emit readyRead();
+    }
+    if (finished) {
         stopReplay();
     }
 }
 
+/**
+ * Walk the log once and index the time stamp and location of every packet.
+ * The file is mapped in memory, or read in a single go if mapping fails.
+ * Indexing stops at the first corrupted record, what comes before it can still be replayed.
+ */
+bool LogFile::buildPacketIndex()
+{
+    m_packetIndex.clear();
+    m_replayBuffer.clear();
+    m_replayData = m_file.map(0, m_file.size());
+    if (m_replayData == NULL) {
+        m_replayBuffer = m_file.readAll();
+        m_replayData   = (const uchar *)m_replayBuffer.constData();
+    }
+
+    qint64 fileSize = m_file.size();
+    qint64 offset   = 0;
+    quint32 lastTimeStamp = 0;
+
+    while (offset + (qint64)(sizeof(quint32) + sizeof(qint64)) <= fileSize) {
+        PacketIndex packet;
+        memcpy(&packet.timeStamp, m_replayData + offset, sizeof(packet.timeStamp));
+        memcpy(&packet.size, m_replayData + offset + sizeof(packet.timeStamp), sizeof(packet.size));
+        packet.offset = offset + sizeof(packet.timeStamp) + sizeof(packet.size);
+
+        if (packet.size < 1 || packet.size > (1024 * 1024)) {
+            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << packet.size << "\n";
+            break;
+        }
+        if (packet.offset + packet.size > fileSize) {
+            break;
+        }
+        // some validity checks
+        if ((!m_packetIndex.isEmpty() && packet.timeStamp < lastTimeStamp) // logfile goes back in time
+            || (packet.timeStamp - lastTimeStamp) > (60 * 60 * 1000)) { // gap of more than 60 minutes)
+            qDebug() << "Error: Logfile corrupted! Unlikely timestamp " << packet.timeStamp << " after " << lastTimeStamp << "\n";
+            break;
+        }
+        m_packetIndex.append(packet);
+        lastTimeStamp = packet.timeStamp;
+        offset = packet.offset + packet.size;
+    }
+    return !m_packetIndex.isEmpty();
+}
+
+double LogFile::currentReplayTime() const
+{
+    if (m_replayPaused) {
+        return m_replayStart;
+    }
+    return m_replayStart + m_myTime.elapsed() * m_playbackSpeed;
+}
+
+void LogFile::rebaseReplayClock()
+{
+    m_replayStart = currentReplayTime();
+    m_myTime.restart();
+}
+
 bool LogFile::startReplay()
 {
-    m_dataBuffer.clear();
+    m_readPacket      = 0;
+    m_nextPacket      = 0;
+    m_readOffset      = 0;
+    m_bytesQueued     = 0;
+    m_replayTimeStamp = 0;
+    if (!buildPacketIndex()) {
+        qDebug() << "Error: Logfile is empty or corrupted";
+        return false;
+    }
+    // Start the replay clock at the first packet
+    m_replayStart  = m_packetIndex.first().timeStamp;
+    m_replayPaused = false;
     m_myTime.restart();
-    m_timeOffset = 0;
-    m_lastPlayed = 0;
-    m_file.read((char *)&m_lastTimeStamp, sizeof(m_lastTimeStamp));
     m_timer.setInterval(10);
     m_timer.start();
     emit replayStarted();
@@ -174,11 +239,59 @@ bool LogFile::stopReplay()
 
 void LogFile::pauseReplay()
 {
+    rebaseReplayClock();
+    m_replayPaused = true;
     m_timer.stop();
 }
 
 void LogFile::resumeReplay()
 {
-    m_timeOffset = m_myTime.elapsed();
+    m_replayPaused = false;
+    m_myTime.restart();
     m_timer.start();
 }
+
+void LogFile::setReplaySpeed(double val)
+{
+    rebaseReplayClock();
+    m_playbackSpeed = val;
+    qDebug() << "Playback speed is now" << m_playbackSpeed;
+}
+
+/**
+ * Move the replay to the given time, forward or backward. The first packet at or after
+ * the time stamp is found with a binary search in the packet index.
+ * Data queued but not read yet is dropped.
+ */
+void LogFile::setReplayPosition(quint32 timeStamp)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int first = 0;
+    int last  = m_packetIndex.size();
+
+    while (first < last) {
+        int middle = (first + last) / 2;
+        if (m_packetIndex[middle].timeStamp < timeStamp) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    m_readPacket  = first;
+    m_nextPacket  = first;
+    m_readOffset  = 0;
+    m_bytesQueued = 0;
+    m_replayStart = timeStamp;
+    m_myTime.restart();
+}
+
+quint32 LogFile::replayPosition()
+{
+    return (quint32)currentReplayTime();
+}
+
+quint32 LogFile::replayDuration() const
+{
+    return m_packetIndex.isEmpty() ? 0 : m_packetIndex.last().timeStamp;
+}
@@ -8,6 +8,7 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QFile>
+#include <QVector>
 #include "utils_global.h"
 
 class QTCREATOR_UTILS_EXPORT LogFile : public QIODevice {
@@ -40,14 +41,41 @@ public:
         m_nextTimeStamp = nextTimestamp;
     }
 
-public slots:
-    void setReplaySpeed(double val)
+    // Time stamp (ms since the start of the log) of the packet last made available for reading
+    quint32 replayTimeStamp() const
     {
-        m_playbackSpeed = val;
-        qDebug() << "Playback speed is now" << m_playbackSpeed;
-    };
+        return m_replayTimeStamp;
+    }
+
+    // Replay position and length of the log, in ms since the start of the log
+    quint32 replayPosition();
+    quint32 replayDuration() const;
+
+    // Indexes the whole log so its packets can be read at once, without the
+    // replay timing. The packets stay in the mapped log until close().
+    bool indexPackets()
+    {
+        return buildPacketIndex();
+    }
+    int packetCount() const
+    {
+        return m_packetIndex.size();
+    }
+    quint32 packetTimeStamp(int index) const
+    {
+        return m_packetIndex.at(index).timeStamp;
+    }
+    const uchar *packetData(int index, qint64 *size) const
+    {
+        *size = m_packetIndex.at(index).size;
+        return m_replayData + m_packetIndex.at(index).offset;
+    }
+
+public slots:
+    void setReplaySpeed(double val);
     void pauseReplay();
     void resumeReplay();
+    void setReplayPosition(quint32 timeStamp);
 
 protected slots:
     void timerFired();
@@ -58,18 +86,38 @@ signals:
     void replayFinished();
 
 protected:
-    QByteArray m_dataBuffer;
+    // Location of a packet in the log file, built when the replay starts
+    typedef struct {
+        quint32 timeStamp;
+        qint64  offset;
+        qint64  size;
+    } PacketIndex;
+
     QTimer m_timer;
     QTime m_myTime;
     QFile m_file;
-    qint32 m_lastTimeStamp;
-    qint32 m_lastPlayed;
     QMutex m_mutex;
 
+    // Replay state: the log is mapped in memory and packets are read in place
+    const uchar *m_replayData;
+    QByteArray m_replayBuffer;
+    QVector<PacketIndex> m_packetIndex;
+    // Packets [m_readPacket, m_nextPacket) are queued for reading
+    int m_readPacket;
+    int m_nextPacket;
+    qint64 m_readOffset;
+    qint64 m_bytesQueued;
+    quint32 m_replayTimeStamp;
+    // The replay clock is m_replayStart + elapsed time * speed
+    double m_replayStart;
+    bool m_replayPaused;
 
-    int m_timeOffset;
     double m_playbackSpeed;
 
+    bool buildPacketIndex();
+    double currentReplayTime() const;
+    void rebaseReplayClock();
+
 private:
     quint32 m_nextTimeStamp;
     bool m_useProvidedTimeStamp;
@@ -0,0 +1,16 @@
+# -------------------------------------------------
+# Accuracy and speed of the batch coordinate conversions
+# against the single point ones
+# -------------------------------------------------
+QT -= gui
+TARGET = coordinateconversionstest
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += QTCREATOR_UTILS_LIB
+INCLUDEPATH += ../../.. \
+    ../../../../plugins \
+    ../../../eigen
+SOURCES += main.cpp \
+    ../../coordinateconversions.cpp
+HEADERS += ../../coordinateconversions.h
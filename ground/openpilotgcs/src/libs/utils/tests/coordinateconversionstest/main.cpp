@@ -0,0 +1,137 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @brief      Compares the batch coordinate conversions with the single point
+ *             ones, for accuracy and speed
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <stdlib.h>
+#include "utils/coordinateconversions.h"
+
+#define POINTS 100000
+
+static double uniform(double min, double max)
+{
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream sout(stdout);
+    Utils::CoordinateConversions conv;
+
+    QVector<double> LLA(3 * POINTS), ECEF(3 * POINTS), result(3 * POINTS), NED(3 * POINTS);
+    srand(1);
+    for (int i = 0; i < POINTS; i++) {
+        LLA[3 * i]     = uniform(-89.9, 89.9);
+        LLA[3 * i + 1] = uniform(-180, 180);
+        LLA[3 * i + 2] = uniform(-500, 20000);
+    }
+
+    QElapsedTimer timer;
+    qint64 single, batch;
+
+    // LLA -> ECEF
+    timer.start();
+    for (int i = 0; i < POINTS; i++) {
+        conv.LLA2ECEF(&LLA[3 * i], &result[3 * i]);
+    }
+    single = timer.nsecsElapsed();
+    timer.start();
+    conv.LLA2ECEF(LLA.constData(), ECEF.data(), POINTS);
+    batch  = timer.nsecsElapsed();
+    double maxError = 0;
+    for (int i = 0; i < 3 * POINTS; i++) {
+        maxError = qMax(maxError, qAbs(ECEF[i] - result[i]));
+    }
+    sout << QString("LLA2ECEF:         single %1 ns/point, batch %2 ns/point, max difference %3 m\n")
+        .arg(single / POINTS).arg(batch / POINTS).arg(maxError);
+
+    // ECEF -> LLA, the iterative solution against the closed form one
+    timer.start();
+    for (int i = 0; i < POINTS; i++) {
+        conv.ECEF2LLA(&ECEF[3 * i], &result[3 * i]);
+    }
+    single   = timer.nsecsElapsed();
+    double maxIterativeError = 0;
+    for (int i = 0; i < POINTS; i++) {
+        maxIterativeError = qMax(maxIterativeError, qAbs(result[3 * i] - LLA[3 * i]));
+    }
+    timer.start();
+    conv.ECEF2LLA(ECEF.constData(), result.data(), POINTS);
+    batch    = timer.nsecsElapsed();
+    maxError = 0;
+    double maxAltError = 0;
+    for (int i = 0; i < POINTS; i++) {
+        maxError    = qMax(maxError, qAbs(result[3 * i] - LLA[3 * i]));
+        maxAltError = qMax(maxAltError, qAbs(result[3 * i + 2] - LLA[3 * i + 2]));
+    }
+    sout << QString("ECEF2LLA:         single %1 ns/point, batch %2 ns/point, max latitude error %3 deg (iterative %4 deg), max altitude error %5 m\n")
+        .arg(single / POINTS).arg(batch / POINTS).arg(maxError).arg(maxIterativeError).arg(maxAltError);
+
+    // NED offsets of up to 10 km around a home location and back
+    double homeLLA[3] = { 47.3, 8.5, 450 };
+    double homeECEF[3];
+    float Rne[3][3];
+    conv.LLA2ECEF(homeLLA, homeECEF);
+    conv.RneFromLLA(homeLLA, Rne);
+    for (int i = 0; i < 3 * POINTS; i++) {
+        NED[i] = uniform(-10000, 10000);
+    }
+
+    timer.start();
+    for (int i = 0; i < POINTS; i++) {
+        conv.NED2LLA_HomeECEF(homeECEF, &NED[3 * i], &result[3 * i]);
+    }
+    single = timer.nsecsElapsed();
+    timer.start();
+    conv.NED2LLA_HomeECEF(homeECEF, NED.constData(), LLA.data(), POINTS);
+    batch  = timer.nsecsElapsed();
+    sout << QString("NED2LLA_HomeECEF: single %1 ns/point, batch %2 ns/point\n")
+        .arg(single / POINTS).arg(batch / POINTS);
+
+    timer.start();
+    for (int i = 0; i < POINTS; i++) {
+        float ned[3];
+        conv.LLA2Base(&LLA[3 * i], homeECEF, Rne, ned);
+        result[3 * i]     = ned[0];
+        result[3 * i + 1] = ned[1];
+        result[3 * i + 2] = ned[2];
+    }
+    single   = timer.nsecsElapsed();
+    timer.start();
+    conv.LLA2Base(LLA.constData(), homeECEF, Rne, result.data(), POINTS);
+    batch    = timer.nsecsElapsed();
+    maxError = 0;
+    for (int i = 0; i < 3 * POINTS; i++) {
+        maxError = qMax(maxError, qAbs(result[i] - NED[i]));
+    }
+    sout << QString("LLA2Base:         single %1 ns/point, batch %2 ns/point, round trip error %3 m\n")
+        .arg(single / POINTS).arg(batch / POINTS).arg(maxError);
+
+    return 0;
+}
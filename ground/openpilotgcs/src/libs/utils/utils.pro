@@ -13,6 +13,8 @@ DEFINES += QTCREATOR_UTILS_LIB
 
 include(../../openpilotgcslibrary.pri)
 
+INCLUDEPATH += ../eigen
+
 SOURCES += reloadpromptutils.cpp \
     settingsutils.cpp \
     filesearch.cpp \
@@ -10,6 +10,7 @@ HEADERS += gpsparser.h
 HEADERS += telemetryparser.h
 HEADERS += antennatrackgadget.h
 HEADERS += antennatrackwidget.h
+HEADERS += trackpredictor.h
 HEADERS += antennatrackgadgetfactory.h
 HEADERS += antennatrackgadgetconfiguration.h
 HEADERS += antennatrackgadgetoptionspage.h
@@ -19,6 +20,7 @@ SOURCES += telemetryparser.cpp
 SOURCES += antennatrackgadget.cpp
 SOURCES += antennatrackgadgetfactory.cpp
 SOURCES += antennatrackwidget.cpp
+SOURCES += trackpredictor.cpp
 SOURCES += antennatrackgadgetconfiguration.cpp
 SOURCES += antennatrackgadgetoptionspage.cpp
 OTHER_FILES += AntennaTrack.pluginspec
@@ -1,3 +1,3 @@
 include(../../plugins/uavobjects/uavobjects.pri)
 #include(../../plugins/coreplugin/coreplugin.pri)
-#include(../../libs/utils/utils.pri)
+include(../../libs/utils/utils.pri)
@@ -94,6 +94,8 @@ void AntennaTrackGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 
     connect(parser, SIGNAL(position(double, double, double)), m_widget, SLOT(setPosition(double, double, double)));
     connect(parser, SIGNAL(home(double, double, double)), m_widget, SLOT(setHomePosition(double, double, double)));
+    connect(parser, SIGNAL(velocity(double, double, double)), m_widget, SLOT(setVelocity(double, double, double)));
+    connect(parser, SIGNAL(latency(double)), m_widget, SLOT(setLatency(double)));
     connect(parser, SIGNAL(packet(QString)), m_widget, SLOT(dumpPacket(QString)));
 }
 
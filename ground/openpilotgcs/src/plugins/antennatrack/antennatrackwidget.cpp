@@ -41,8 +41,18 @@ AntennaTrackWidget::AntennaTrackWidget(QWidget *parent) : QWidget(parent)
 {
     setupUi(this);
 
-    azimuth_old   = 0;
-    elevation_old = 0;
+    stepper_old     = 0;
+    servo_old       = -1;
+    azimuth_shown   = -1;
+    elevation_shown = -1;
+
+    // The tracker is driven from its own timer rather than from telemetry
+    // updates, moving along the predicted track between them
+    clock.start();
+    outputTimer.setTimerType(Qt::PreciseTimer);
+    outputTimer.setInterval(1000 / TRACKER_OUTPUT_RATE_HZ);
+    connect(&outputTimer, SIGNAL(timeout()), this, SLOT(updateAntenna()));
+    outputTimer.start();
 }
 
 AntennaTrackWidget::~AntennaTrackWidget()
@@ -92,10 +102,7 @@ void AntennaTrackWidget::setPosition(double lat, double lon, double alt)
     QString str3;
     str3.sprintf("%.2f m", alt);
     coord_value_3->setText(str3);
-    TrackData.Latitude  = lat;
-    TrackData.Longitude = lon;
-    TrackData.Altitude  = alt;
-    calcAntennaPosition();
+    predictor.setFix(lat, lon, alt, clock.elapsed());
 }
 
 void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
@@ -126,87 +133,56 @@ void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
     QString str3;
     str3.sprintf("%.2f m", alt);
     bear_value->setText(str3);
-    TrackData.HomeLatitude  = lat;
-    TrackData.HomeLongitude = lon;
-    TrackData.HomeAltitude  = alt;
-    calcAntennaPosition();
+    predictor.setHome(lat, lon, alt);
 }
 
-void AntennaTrackWidget::calcAntennaPosition(void)
+void AntennaTrackWidget::setVelocity(double north, double east, double down)
+{
+    predictor.setVelocity(north, east, down, clock.elapsed());
+}
+
+void AntennaTrackWidget::setLatency(double seconds)
+{
+    predictor.setLatency(seconds);
+}
+
+void AntennaTrackWidget::updateAntenna()
 {
-    /** http://www.movable-type.co.uk/scripts/latlong.html **/
-    double lat1, lat2, lon1, lon2, a, c, d, x, y, brng;
     double azimuth, elevation;
-    double gcsAlt = TrackData.HomeAltitude; // Home MSL altitude
-    double uavAlt = TrackData.Altitude; // UAV MSL altitude
-    double dAlt   = uavAlt - gcsAlt; // Altitude difference
-
-    // Convert to radians
-    lat1 = TrackData.HomeLatitude * (M_PI / 180); // Home lat
-    lon1 = TrackData.HomeLongitude * (M_PI / 180); // Home lon
-    lat2 = TrackData.Latitude * (M_PI / 180); // UAV lat
-    lon2 = TrackData.Longitude * (M_PI / 180); // UAV lon
-
-    // Bearing
-    /**
-       var y = Math.sin(dLon) * Math.cos(lat2);
-       var x = Math.cos(lat1)*Math.sin(lat2) -
-            Math.sin(lat1)*Math.cos(lat2)*Math.cos(dLon);
-       var brng = Math.atan2(y, x).toDeg();
-     **/
-    y    = sin(lon2 - lon1) * cos(lat2);
-    x    = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(lon2 - lon1);
-    brng = atan2((sin(lon2 - lon1) * cos(lat2)), (cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(lon2 - lon1))) * (180 / M_PI);
-    if (brng < 0) {
-        brng += 360;
-    }
 
-    // bearing to stepper
-    azimuth = brng;
-
-    // Haversine formula for distance
-    /**
-       var R = 6371; // km
-       var dLat = (lat2-lat1).toRad();
-       var dLon = (lon2-lon1).toRad();
-       var a = Math.sin(dLat/2) * Math.sin(dLat/2) +
-            Math.cos(lat1.toRad()) * Math.cos(lat2.toRad()) *
-            Math.sin(dLon/2) * Math.sin(dLon/2);
-       var c = 2 * Math.atan2(Math.sqrt(a), Math.sqrt(1-a));
-       var d = R * c;
-     **/
-    a = sin((lat2 - lat1) / 2) * sin((lat2 - lat1) / 2) +
-        cos(lat1) * cos(lat2) *
-        sin((lon2 - lon1) / 2) * sin((lon2 - lon1) / 2);
-    c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    d = 6371 * 1000 * c;
-
-    // Elevation  v depends servo direction
-    if (d != 0) {
-        elevation = 90 - (atan(dAlt / d) * (180 / M_PI));
-    } else {
-        elevation = 0;
+    if (!predictor.predict(clock.elapsed(), azimuth, elevation)) {
+        return;
     }
-    // ! TODO: sanity check
 
-    QString str3;
-    str3.sprintf("%.0f deg", azimuth);
-    azimuth_value->setText(str3);
-
-    str3.sprintf("%.0f deg", elevation);
-    elevation_value->setText(str3);
+    // Only touch the labels when the shown value changes
+    if (qRound(azimuth) != azimuth_shown) {
+        azimuth_shown = qRound(azimuth);
+        azimuth_value->setText(QString("%1 deg").arg(azimuth_shown));
+    }
+    if (qRound(elevation) != elevation_shown) {
+        elevation_shown = qRound(elevation);
+        elevation_value->setText(QString("%1 deg").arg(elevation_shown));
+    }
 
     // servo value 2000-4000
     int servo   = (int)(2000.0 / 180 * elevation + 2000);
-    int stepper = (int)(400.0 / 360 * (azimuth - azimuth_old));
+    // Stepper moves are relative, keep the absolute count so small moves
+    // between ticks are not lost to rounding
+    int stepper = qRound(TRACKER_STEPS_PER_TURN / 360.0 * azimuth);
 
-    // send azimuth and elevation to tracker hardware
-    str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
-    if (port->isOpen()) {
-        if (azimuth_old != azimuth || elevation != elevation_old) {
-            port->write(str3.toLatin1());
-        }
+    if (!port || !port->isOpen() || (stepper == stepper_old && servo == servo_old)) {
+        return;
+    }
+    // write() only queues the bytes. If the previous command is still
+    // queued, skip this one rather than let stale commands pile up.
+    if (port->bytesToWrite() > 0) {
+        return;
     }
-    azimuth_old   = azimuth;
-    elevation_old = elevation;
+
+    // send azimuth and elevation to tracker hardware
+    char command[64];
+    int length = qsnprintf(command, sizeof(command), "move %d 2000 2000 2000 %d\r", stepper - stepper_old, servo);
+    port->write(command, length);
+    stepper_old = stepper;
+    servo_old   = servo;
 }
@@ -36,17 +36,15 @@
 #include <QtSvg/QGraphicsSvgItem>
 #include <QtSerialPort/QSerialPort>
 #include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "trackpredictor.h"
 
-class Ui_AntennaTrackWidget;
+// Rate at which the tracker is pointed at the predicted position
+#define TRACKER_OUTPUT_RATE_HZ 20
+#define TRACKER_STEPS_PER_TURN 400
 
-typedef struct struct_TrackData {
-    double Latitude;
-    double Longitude;
-    double Altitude;
-    double HomeLatitude;
-    double HomeLongitude;
-    double HomeAltitude;
-} TrackData_t;
+class Ui_AntennaTrackWidget;
 
 class AntennaTrackWidget : public QWidget, public Ui_AntennaTrackWidget {
     Q_OBJECT
@@ -54,19 +52,26 @@ class AntennaTrackWidget : public QWidget, public Ui_AntennaTrackWidget {
 public:
     AntennaTrackWidget(QWidget *parent = 0);
     ~AntennaTrackWidget();
-    TrackData_t TrackData;
     void setPort(QPointer<QSerialPort> portx);
 
 private slots:
     void setPosition(double, double, double);
     void setHomePosition(double, double, double);
+    void setVelocity(double, double, double);
+    void setLatency(double);
     void dumpPacket(const QString &packet);
+    void updateAntenna();
 
 private:
-    void calcAntennaPosition(void);
     QGraphicsSvgItem *marker;
     QPointer<QSerialPort> port;
-    double azimuth_old;
-    double elevation_old;
+    TrackPredictor predictor;
+    QElapsedTimer clock;
+    QTimer outputTimer;
+    // last position sent to the tracker, in its own units
+    int stepper_old;
+    int servo_old;
+    int azimuth_shown;
+    int elevation_shown;
 };
 #endif /* ANTENNATRACKWIDGET_H_ */
@@ -27,6 +27,10 @@
 
 
 #include "telemetryparser.h"
+#include "gpspositionsensor.h"
+#include "homelocation.h"
+#include "velocitystate.h"
+#include "gcstelemetrystats.h"
 #include <math.h>
 #include <QDebug>
 #include <QStringList>
@@ -39,20 +43,11 @@ TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVDataObject *gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSPositionSensor"));
 
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
-    } else {
-        qDebug() << "Error: Object is unknown (GPSPositionSensor).";
-    }
-
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("HomeLocation"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateHome(UAVObject *)));
-    } else {
-        qDebug() << "Error: Object is unknown (HomeLocation).";
-    }
+    connect(GPSPositionSensor::GetInstance(objManager), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
+    connect(HomeLocation::GetInstance(objManager), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateHome(UAVObject *)));
+    connect(VelocityState::GetInstance(objManager), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateVelocity(UAVObject *)));
+    connect(GCSTelemetryStats::GetInstance(objManager), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateStats(UAVObject *)));
 }
 
 TelemetryParser::~TelemetryParser()
@@ -60,23 +55,29 @@ TelemetryParser::~TelemetryParser()
 
 void TelemetryParser::updateHome(UAVObject *object1)
 {
-    double lat = object1->getField(QString("Latitude"))->getDouble();
-    double lon = object1->getField(QString("Longitude"))->getDouble();
-    double alt = object1->getField(QString("Altitude"))->getDouble();
+    HomeLocation::DataFields homeData = static_cast<HomeLocation *>(object1)->getData();
 
-    lat *= 1E-7;
-    lon *= 1E-7;
-    emit home(lat, lon, alt);
+    emit home(homeData.Latitude * 1E-7, homeData.Longitude * 1E-7, homeData.Altitude);
 }
 
 
 void TelemetryParser::updateGPS(UAVObject *object1)
 {
-    double lat = object1->getField(QString("Latitude"))->getDouble();
-    double lon = object1->getField(QString("Longitude"))->getDouble();
-    double alt = object1->getField(QString("Altitude"))->getDouble();
+    GPSPositionSensor::DataFields gpsData = static_cast<GPSPositionSensor *>(object1)->getData();
+
+    emit position(gpsData.Latitude * 1E-7, gpsData.Longitude * 1E-7, gpsData.Altitude);
+}
+
+void TelemetryParser::updateVelocity(UAVObject *object1)
+{
+    VelocityState::DataFields velocityData = static_cast<VelocityState *>(object1)->getData();
+
+    emit velocity(velocityData.North, velocityData.East, velocityData.Down);
+}
+
+void TelemetryParser::updateStats(UAVObject *object1)
+{
+    GCSTelemetryStats::DataFields statsData = static_cast<GCSTelemetryStats *>(object1)->getData();
 
-    lat *= 1E-7;
-    lon *= 1E-7;
-    emit position(lat, lon, alt);
+    emit latency(statsData.TxLatency * 1E-6);
 }
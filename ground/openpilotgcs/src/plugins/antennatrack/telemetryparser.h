@@ -45,6 +45,12 @@ public:
 public slots:
     void updateGPS(UAVObject *object1);
     void updateHome(UAVObject *object1);
+    void updateVelocity(UAVObject *object1);
+    void updateStats(UAVObject *object1);
+
+signals:
+    void velocity(double, double, double); // North, East, Down
+    void latency(double); // Link latency in s
 };
 
 #endif // TELEMETRYPARSER_H
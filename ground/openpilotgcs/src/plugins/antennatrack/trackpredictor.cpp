@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackpredictor.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup AntennaTrackGadgetPlugin Antenna Track Gadget Plugin
+ * @{
+ * @brief Extrapolates the aircraft position between telemetry updates
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "trackpredictor.h"
+#include <math.h>
+
+TrackPredictor::TrackPredictor() :
+    haveHome(false),
+    haveFix(false),
+    fixTime(0),
+    velocityTime(0),
+    latency(0)
+{
+    for (int i = 0; i < 3; i++) {
+        homeECEF[i] = 0;
+        fixLLA[i]   = 0;
+        fixNED[i]   = 0;
+        velocity[i] = 0;
+    }
+}
+
+void TrackPredictor::setHome(double lat, double lon, double alt)
+{
+    double homeLLA[3] = { lat, lon, alt };
+
+    coordinateConversions.LLA2ECEF(homeLLA, homeECEF);
+    coordinateConversions.RneFromLLA(homeLLA, Rne);
+    haveHome = true;
+    updateFixNED();
+}
+
+void TrackPredictor::setFix(double lat, double lon, double alt, qint64 time)
+{
+    fixLLA[0] = lat;
+    fixLLA[1] = lon;
+    fixLLA[2] = alt;
+    fixTime   = time;
+    haveFix   = true;
+    updateFixNED();
+}
+
+void TrackPredictor::setVelocity(double north, double east, double down, qint64 time)
+{
+    velocity[0]  = north;
+    velocity[1]  = east;
+    velocity[2]  = down;
+    velocityTime = time;
+}
+
+void TrackPredictor::setLatency(double seconds)
+{
+    latency = seconds;
+}
+
+void TrackPredictor::updateFixNED()
+{
+    if (!haveHome || !haveFix) {
+        return;
+    }
+
+    double ECEF[3];
+    coordinateConversions.LLA2ECEF(fixLLA, ECEF);
+    double diff[3] = { ECEF[0] - homeECEF[0], ECEF[1] - homeECEF[1], ECEF[2] - homeECEF[2] };
+    for (int i = 0; i < 3; i++) {
+        fixNED[i] = Rne[i][0] * diff[0] + Rne[i][1] * diff[1] + Rne[i][2] * diff[2];
+    }
+}
+
+/**
+ * Antenna direction at the given time
+ * @param[out] azimuth bearing from home in degrees, 0 to 360
+ * @param[out] elevation in degrees from vertical, 90 is the horizon
+ * @returns false while home or the position is still unknown
+ */
+bool TrackPredictor::predict(qint64 time, double &azimuth, double &elevation) const
+{
+    if (!haveHome || !haveFix) {
+        return false;
+    }
+
+    double ned[3] = { fixNED[0], fixNED[1], fixNED[2] };
+    if (time - velocityTime <= TRACK_MAX_PREDICTION_MS) {
+        double dT = (time - fixTime) / 1000.0 + latency;
+        dT = qBound(0.0, dT, TRACK_MAX_PREDICTION_MS / 1000.0);
+        for (int i = 0; i < 3; i++) {
+            ned[i] += velocity[i] * dT;
+        }
+    }
+
+    azimuth = atan2(ned[1], ned[0]) * (180 / M_PI);
+    if (azimuth < 0) {
+        azimuth += 360;
+    }
+    double distance = sqrt(ned[0] * ned[0] + ned[1] * ned[1]);
+    elevation = (distance != 0) ? 90 - atan(-ned[2] / distance) * (180 / M_PI) : 0;
+    return true;
+}
@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackpredictor.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup AntennaTrackGadgetPlugin Antenna Track Gadget Plugin
+ * @{
+ * @brief Extrapolates the aircraft position between telemetry updates
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TRACKPREDICTOR_H
+#define TRACKPREDICTOR_H
+
+#include <QtGlobal>
+#include "utils/coordinateconversions.h"
+
+// Never extrapolate further than this, nor with a velocity older than this
+#define TRACK_MAX_PREDICTION_MS 2000
+
+/**
+ * Keeps the last fix as a NED offset from home and moves it along the last
+ * velocity for the time since the fix was taken. The fix is assumed to be
+ * one link latency older than its arrival.
+ * Times are in ms on any monotonic clock, the same one for all calls.
+ */
+class TrackPredictor {
+public:
+    TrackPredictor();
+
+    void setHome(double lat, double lon, double alt);
+    void setFix(double lat, double lon, double alt, qint64 time);
+    void setVelocity(double north, double east, double down, qint64 time);
+    void setLatency(double seconds);
+
+    bool predict(qint64 time, double &azimuth, double &elevation) const;
+
+private:
+    void updateFixNED();
+
+    Utils::CoordinateConversions coordinateConversions;
+    bool haveHome;
+    bool haveFix;
+    double homeECEF[3];
+    float Rne[3][3];
+    double fixLLA[3];
+    double fixNED[3];
+    qint64 fixTime;
+    double velocity[3];
+    qint64 velocityTime;
+    double latency;
+};
+
+#endif // TRACKPREDICTOR_H
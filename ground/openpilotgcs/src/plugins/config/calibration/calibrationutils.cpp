@@ -356,6 +356,61 @@ void CalibrationUtils::EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *
     }
 }
 
+EllipsoidFitAccumulator::EllipsoidFitAccumulator()
+{
+    clear();
+}
+
+void EllipsoidFitAccumulator::clear()
+{
+    m_dtd.setZero();
+    m_dt1.setZero();
+    m_count = 0;
+}
+
+void EllipsoidFitAccumulator::addSample(float x, float y, float z)
+{
+    // row of the design matrix D of EllipsoidFit(), the sums are kept in double as they grow with the fourth power
+    Vector6d d;
+
+    d << (double)x * x, (double)y * y, (double)z * z, 2.0 * x, 2.0 * y, 2.0 * z;
+    m_dtd.noalias() += d * d.transpose();
+    m_dt1 += d;
+    m_count++;
+}
+
+bool EllipsoidFitAccumulator::fit(float nominalRange, CalibrationUtils::EllipsoidCalibrationResult *result, float *error) const
+{
+    if (m_count < 6) {
+        return false;
+    }
+    Eigen::Matrix<double, 6, 6> dtd = m_dtd;
+    Eigen::Matrix<double, 6, 1> dt1 = m_dt1;
+    Eigen::LDLT<Eigen::Matrix<double, 6, 6> > ldlt(dtd);
+    Eigen::Matrix<double, 6, 1> v   = ldlt.solve(dt1);
+
+    // a negative or NaN coefficient is not an ellipsoid
+    if (!(v.coeff(0) > 0 && v.coeff(1) > 0 && v.coeff(2) > 0)) {
+        return false;
+    }
+    double gam = 1;
+    for (int i = 0; i < 3; i++) {
+        gam += v.coeff(3 + i) * v.coeff(3 + i) / v.coeff(i);
+    }
+    for (int i = 0; i < 3; i++) {
+        result->Scale(i) = nominalRange / sqrt(gam / v.coeff(i));
+        result->Bias(i)  = -v.coeff(3 + i) / v.coeff(i);
+    }
+    result->CalibrationMatrix = result->Scale.asDiagonal();
+
+    if (error) {
+        // |D v - 1|^2 expanded on the normal equations
+        double sse = v.dot(dtd * v) - 2 * v.dot(dt1) + m_count;
+        *error = sqrt(qMax(sse, 0.0) / m_count);
+    }
+    return true;
+}
+
 int CalibrationUtils::SixPointInConstFieldCal(double ConstMag, double x[6], double y[6], double z[6], double S[3], double b[3])
 {
     int i;
@@ -61,5 +61,32 @@ private:
 
     static int LinearEquationsSolve(int nDim, double *pfMatr, double *pfVect, double *pfSolution);
 };
+
+/*
+ * Least squares fit of an ellipsoid along the X, Y and Z axes, as EllipsoidCalibration() with fitAlongXYZ,
+ * built one sample at a time. Each sample updates the normal equations so the samples are not kept and
+ * the fit can be computed at any time.
+ */
+class EllipsoidFitAccumulator {
+public:
+    EllipsoidFitAccumulator();
+    void clear();
+    void addSample(float x, float y, float z);
+    int count() const
+    {
+        return m_count;
+    }
+    // false if the samples do not fit an ellipsoid yet, error is the rms residual of the ellipsoid equation
+    bool fit(float nominalRange, CalibrationUtils::EllipsoidCalibrationResult *result, float *error = 0) const;
+
+private:
+    // not aligned, the accumulator is a member of heap allocated models
+    typedef Eigen::Matrix<double, 6, 6, Eigen::DontAlign> Matrix6d;
+    typedef Eigen::Matrix<double, 6, 1, Eigen::DontAlign> Vector6d;
+
+    Matrix6d m_dtd;
+    Vector6d m_dt1;
+    int m_count;
+};
 }
 #endif // CALIBRATIONUTILS_H
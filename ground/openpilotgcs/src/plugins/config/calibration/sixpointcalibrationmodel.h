@@ -65,6 +65,8 @@ signals:
     void progressChanged(int value);
     void displayVisualHelp(QString elementID);
     void displayInstructions(QString text, WizardModel::MessageType type = WizardModel::Info);
+    // rms residual of the onboard mag fit so far, while the samples are acquired
+    void magFitErrorChanged(float error);
 
 public slots:
     void magStart();
@@ -129,16 +131,12 @@ public:
     QList<double> mag_accum_x;
     QList<double> mag_accum_y;
     QList<double> mag_accum_z;
-    QList<float> mag_fit_x;
-    QList<float> mag_fit_y;
-    QList<float> mag_fit_z;
+    EllipsoidFitAccumulator mag_fit;
 
     QList<double> aux_mag_accum_x;
     QList<double> aux_mag_accum_y;
     QList<double> aux_mag_accum_z;
-    QList<float> aux_mag_fit_x;
-    QList<float> aux_mag_fit_y;
-    QList<float> aux_mag_fit_z;
+    EllipsoidFitAccumulator aux_mag_fit;
 
     // convenience pointers
     RevoCalibration *revoCalibration;
@@ -154,7 +152,8 @@ public:
     void compute();
     void showHelp(QString image);
     UAVObjectManager *getObjectManager();
-    void calcCalibration(QList<float> x, QList<float> y, QList<float> z, double Be_length, float calibrationMatrix[], float bias[]);
+    void calcCalibration(const EllipsoidFitAccumulator &fit, double Be_length, float calibrationMatrix[], float bias[]);
+    void addMagFitSample(float x, float y, float z);
 };
 }
 
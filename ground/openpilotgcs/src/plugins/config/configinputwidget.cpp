@@ -40,6 +40,7 @@
 #include <QUrl>
 #include <QMessageBox>
 #include <utils/stylehelper.h>
+#include <string.h>
 #include <QMessageBox>
 
 #define ACCESS_MIN_MOVE -3
@@ -703,10 +704,11 @@ void ConfigInputWidget::wizardSetUpStep(enum wizardSteps step)
                 manualSettingsData.ChannelMax[i] = manualSettingsData.ChannelNeutral[i];
             }
         }
+        // limits are tracked on every sample, the sticks are only drawn once per frame
         connect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(identifyLimits()));
-        connect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        connect(flightStatusObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        connect(accessoryDesiredObj0, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(manualCommandObj, this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(flightStatusObj, this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(accessoryDesiredObj0, this, SLOT(moveSticks()));
 
         wizardUi->pagesStack->setCurrentWidget(wizardUi->identifyLimitsPage);
     }
@@ -727,14 +729,14 @@ void ConfigInputWidget::wizardSetUpStep(enum wizardSteps step)
                 connect(cb, SIGNAL(toggled(bool)), this, SLOT(invertControls()));
             }
         }
-        connect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(manualCommandObj, this, SLOT(moveSticks()));
         wizardUi->pagesStack->setCurrentWidget(wizardUi->identifyInvertedPage);
         break;
     case wizardFinish:
         dimOtherControls(false);
-        connect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        connect(flightStatusObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        connect(accessoryDesiredObj0, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(manualCommandObj, this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(flightStatusObj, this, SLOT(moveSticks()));
+        getObjectManager()->subscribeFrameUpdates(accessoryDesiredObj0, this, SLOT(moveSticks()));
         wizardUi->pagesStack->setCurrentWidget(wizardUi->finishPage);
         break;
     default:
@@ -787,9 +789,9 @@ void ConfigInputWidget::wizardTearDownStep(enum wizardSteps step)
         break;
     case wizardIdentifyLimits:
         disconnect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(identifyLimits()));
-        disconnect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        disconnect(flightStatusObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        disconnect(accessoryDesiredObj0, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(manualCommandObj, this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(flightStatusObj, this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(accessoryDesiredObj0, this, SLOT(moveSticks()));
         manualSettingsObj->setData(manualSettingsData);
         setTxMovement(nothing);
         break;
@@ -804,14 +806,14 @@ void ConfigInputWidget::wizardTearDownStep(enum wizardSteps step)
             }
         }
         extraWidgets.clear();
-        disconnect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(manualCommandObj, this, SLOT(moveSticks()));
         break;
     case wizardFinish:
         dimOtherControls(false);
         setTxMovement(nothing);
-        disconnect(manualCommandObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        disconnect(flightStatusObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
-        disconnect(accessoryDesiredObj0, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(manualCommandObj, this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(flightStatusObj, this, SLOT(moveSticks()));
+        getObjectManager()->unsubscribeFrameUpdates(accessoryDesiredObj0, this, SLOT(moveSticks()));
         break;
     default:
         Q_ASSERT(0);
@@ -823,7 +825,8 @@ static void fastMdataSingle(UAVDataObject *object, UAVObject::Metadata *savedMda
     *savedMdata = object->getMetadata();
     UAVObject::Metadata mdata = *savedMdata;
     UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_PERIODIC);
-    mdata.flightTelemetryUpdatePeriod = 150;
+    // fast enough for the wizard and the calibration to catch short stick movements
+    mdata.flightTelemetryUpdatePeriod = 50;
     object->setMetadata(mdata);
 }
 
@@ -992,27 +995,36 @@ void ConfigInputWidget::identifyControls()
 
 void ConfigInputWidget::identifyLimits()
 {
+    bool changed = false;
+
     manualCommandData = manualCommandObj->getData();
     for (uint i = 0; i < ManualControlSettings::CHANNELMAX_NUMELEM; ++i) {
         if (manualSettingsData.ChannelMin[i] <= manualSettingsData.ChannelMax[i]) {
             // Non inverted channel
             if (manualSettingsData.ChannelMin[i] > manualCommandData.Channel[i]) {
                 manualSettingsData.ChannelMin[i] = manualCommandData.Channel[i];
+                changed = true;
             }
             if (manualSettingsData.ChannelMax[i] < manualCommandData.Channel[i]) {
                 manualSettingsData.ChannelMax[i] = manualCommandData.Channel[i];
+                changed = true;
             }
         } else {
             // Inverted channel
             if (manualSettingsData.ChannelMax[i] > manualCommandData.Channel[i]) {
                 manualSettingsData.ChannelMax[i] = manualCommandData.Channel[i];
+                changed = true;
             }
             if (manualSettingsData.ChannelMin[i] < manualCommandData.Channel[i]) {
                 manualSettingsData.ChannelMin[i] = manualCommandData.Channel[i];
+                changed = true;
             }
         }
     }
-    manualSettingsObj->setData(manualSettingsData);
+    // only a new limit is worth sending the settings and refreshing their widgets
+    if (changed) {
+        manualSettingsObj->setData(manualSettingsData);
+    }
 }
 void ConfigInputWidget::setMoveFromCommand(int command)
 {
@@ -1567,6 +1579,8 @@ void ConfigInputWidget::updatePositionSlider()
 
 void ConfigInputWidget::updateCalibration()
 {
+    const ManualControlSettings::DataFields previous = manualSettingsData;
+
     manualCommandData = manualCommandObj->getData();
     for (uint i = 0; i < ManualControlSettings::CHANNELMAX_NUMELEM; ++i) {
         if ((!reverse[i] && manualSettingsData.ChannelMin[i] > manualCommandData.Channel[i]) ||
@@ -1584,6 +1598,10 @@ void ConfigInputWidget::updateCalibration()
         }
     }
 
+    // sticks held still give the same limits and neutrals, nothing to send then
+    if (memcmp(&previous, &manualSettingsData, sizeof(previous)) == 0) {
+        return;
+    }
     manualSettingsObj->setData(manualSettingsData);
     manualSettingsObj->updated();
 }
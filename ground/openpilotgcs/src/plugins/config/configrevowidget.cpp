@@ -134,6 +134,7 @@ ConfigRevoWidget::ConfigRevoWidget(QWidget *parent) :
     connect(m_magCalibrationModel, SIGNAL(displayVisualHelp(QString)), this, SLOT(displayVisualHelp(QString)));
     connect(m_magCalibrationModel, SIGNAL(savePositionEnabledChanged(bool)), m_ui->magSavePos, SLOT(setEnabled(bool)));
     connect(m_magCalibrationModel, SIGNAL(progressChanged(int)), m_ui->magProgress, SLOT(setValue(int)));
+    connect(m_magCalibrationModel, SIGNAL(magFitErrorChanged(float)), this, SLOT(displayMagFitError(float)));
     m_ui->magSavePos->setEnabled(false);
 
     // board level calibration
@@ -341,6 +342,12 @@ void ConfigRevoWidget::displayTemperatureRange(float temperatureRange)
     m_ui->temperatureRangeLabel->setText(tr("Sampled range: %1°C").arg(format(temperatureRange)));
 }
 
+void ConfigRevoWidget::displayMagFitError(float error)
+{
+    // live feedback while the board is rotated, the lower the better
+    m_ui->magProgress->setFormat(tr("%p% - fit error %1%").arg(error * 100, 0, 'f', 1));
+}
+
 /**
  * Called by the ConfigTaskWidget parent when RevoCalibration is updated
  * to update the UI
@@ -400,6 +407,7 @@ void ConfigRevoWidget::clearHomeLocation()
 void ConfigRevoWidget::disableAllCalibrations()
 {
     clearInstructions();
+    m_ui->magProgress->setFormat("%p%");
 
     m_ui->accelStart->setEnabled(false);
     m_ui->magStart->setEnabled(false);
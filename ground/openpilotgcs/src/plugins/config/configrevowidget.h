@@ -75,6 +75,7 @@ private slots:
     void displayTemperature(float tempareture);
     void displayTemperatureGradient(float temparetureGradient);
     void displayTemperatureRange(float temparetureRange);
+    void displayMagFitError(float error);
 
     // ! Overriden method from the configTaskWidget to update UI
     virtual void refreshWidgetsValues(UAVObject *object = NULL);
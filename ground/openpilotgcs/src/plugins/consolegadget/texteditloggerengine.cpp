@@ -30,12 +30,19 @@
 #include <QTime>
 #include <QtGui/QTextEdit>
 #include <QtGui/QScrollBar>
+#include <QtGui/QTextCursor>
+#include <QtGui/QTextDocument>
 #include <QObject>
+#include <QTimer>
 
 #define QXT_REQUIRED_LEVELS (QxtLogger::WarningLevel | QxtLogger::ErrorLevel | QxtLogger::CriticalLevel | QxtLogger::FatalLevel)
 
+// Messages are shown at most this often, whatever their rate
+#define FLUSH_PERIOD_MS     40
+
 TextEditLoggerEngine::TextEditLoggerEngine(QTextEdit *textEdit) : m_textEdit(textEdit)
 {
+    m_textEdit->document()->setMaximumBlockCount(MAX_LINES);
 #ifndef QT_NO_DEBUG
     setLogLevelsEnabled(QXT_REQUIRED_LEVELS);
 #else
@@ -111,8 +118,6 @@ void TextEditLoggerEngine::writeToTextEdit(const QString & level, const QList<QV
     if (msgs.isEmpty()) {
         return;
     }
-    QScrollBar *sb = m_textEdit->verticalScrollBar();
-    bool scroll    = sb->value() == sb->maximum();
     QString header = '[' + QTime::currentTime().toString("hh:mm:ss.zzz") + "] [" + level + "] ";
     QString padding;
     QString appendText;
@@ -130,9 +135,45 @@ void TextEditLoggerEngine::writeToTextEdit(const QString & level, const QList<QV
         }
         count++;
     }
-    Q_ASSERT(m_textEdit);
     appendText = QString("<font color=%1>%2</font>").arg(color.name()).arg(appendText);
-    m_textEdit->append(appendText);
+
+    QMutexLocker locker(&m_pendingMutex);
+    m_pending.append(appendText);
+    // only the first message of a batch asks for a flush
+    if (m_pending.count() == 1) {
+        QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+    }
+}
+
+void TextEditLoggerEngine::scheduleFlush()
+{
+    QTimer::singleShot(FLUSH_PERIOD_MS, this, SLOT(flush()));
+}
+
+void TextEditLoggerEngine::flush()
+{
+    m_pendingMutex.lock();
+    QStringList batch = m_pending;
+    m_pending.clear();
+    m_pendingMutex.unlock();
+
+    if (!m_textEdit || batch.isEmpty()) {
+        return;
+    }
+    QScrollBar *sb = m_textEdit->verticalScrollBar();
+    bool scroll    = sb->value() == sb->maximum();
+
+    QTextCursor cursor(m_textEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    // only the most recent lines survive in the view anyway
+    for (int i = qMax(0, batch.count() - MAX_LINES); i < batch.count(); i++) {
+        if (!m_textEdit->document()->isEmpty()) {
+            cursor.insertBlock();
+        }
+        cursor.insertHtml(batch.at(i));
+    }
+    cursor.endEditBlock();
     if (scroll) {
         sb->setValue(sb->maximum());
     }
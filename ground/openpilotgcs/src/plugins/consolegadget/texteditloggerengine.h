@@ -33,10 +33,20 @@
 #include "qxtloggerengine.h"
 #include "qxtglobal.h"
 #include <QtGui/QColor>
+#include <QObject>
+#include <QPointer>
+#include <QMutex>
+#include <QStringList>
 class QTextEdit;
 
-class TextEditLoggerEngine : public QxtLoggerEngine {
+// Messages can be logged from any thread, they are queued and appended to the
+// view in one batch per frame. The view keeps the last MAX_LINES.
+class TextEditLoggerEngine : public QObject, public QxtLoggerEngine {
+    Q_OBJECT
+
 public:
+    static const int MAX_LINES = 5000;
+
     TextEditLoggerEngine(QTextEdit *textEdit);
     ~TextEditLoggerEngine();
 
@@ -47,9 +57,15 @@ public:
 
     bool isInitialized() const;
 
+private slots:
+    void scheduleFlush();
+    void flush();
+
 private:
     virtual void writeToTextEdit(const QString & str_level, const QList<QVariant> &msgs, QColor color = QColor(0, 0, 0));
-    QTextEdit *m_textEdit;
+    QPointer<QTextEdit> m_textEdit;
+    QMutex m_pendingMutex;
+    QStringList m_pending;
 };
 
 #endif // TEXTEDITLOGGERENGINE_H
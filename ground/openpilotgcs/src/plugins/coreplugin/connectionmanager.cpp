@@ -439,6 +439,11 @@ void ConnectionManager::devChanged(IConnection *connection)
     // remove registered devices of this IConnection from the list
     updateConnectionList(connection);
 
+    // the port we lost telemetry on may just have come back, retry now instead of on the next tick
+    if (reconnect->isActive() && m_ioDev && m_connectionDevice.connection == connection) {
+        reconnectSlot();
+    }
+
     updateConnectionDropdown();
 
     qDebug() << "# devices " << m_devList.count();
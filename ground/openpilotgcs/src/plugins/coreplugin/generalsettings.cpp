@@ -47,7 +47,7 @@ GeneralSettings::GeneralSettings() :
     m_saveSettingsOnExit(true),
     m_autoConnect(true),
     m_autoSelect(true),
-    m_useUDPMirror(false),
+    m_telemetryRelay(false),
     m_useExpertMode(false),
     m_dialog(0)
 {}
@@ -123,7 +123,7 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->checkBoxSaveOnExit->setChecked(m_saveSettingsOnExit);
     m_page->checkAutoConnect->setChecked(m_autoConnect);
     m_page->checkAutoSelect->setChecked(m_autoSelect);
-    m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
+    m_page->cbTelemetryRelay->setChecked(m_telemetryRelay);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
     m_page->colorButton->setColor(StyleHelper::baseColor());
 
@@ -141,7 +141,7 @@ void GeneralSettings::apply()
     StyleHelper::setBaseColor(m_page->colorButton->color());
 
     m_saveSettingsOnExit = m_page->checkBoxSaveOnExit->isChecked();
-    m_useUDPMirror  = m_page->cbUseUDPMirror->isChecked();
+    m_telemetryRelay = m_page->cbTelemetryRelay->isChecked();
     m_useExpertMode = m_page->cbExpertMode->isChecked();
     m_autoConnect   = m_page->checkAutoConnect->isChecked();
     m_autoSelect    = m_page->checkAutoSelect->isChecked();
@@ -159,7 +159,7 @@ void GeneralSettings::readSettings(QSettings *qs)
     m_saveSettingsOnExit = qs->value(QLatin1String("SaveSettingsOnExit"), m_saveSettingsOnExit).toBool();
     m_autoConnect   = qs->value(QLatin1String("AutoConnect"), m_autoConnect).toBool();
     m_autoSelect    = qs->value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
-    m_useUDPMirror  = qs->value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
+    m_telemetryRelay = qs->value(QLatin1String("TelemetryRelay"), m_telemetryRelay).toBool();
     m_useExpertMode = qs->value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
     qs->endGroup();
 }
@@ -177,7 +177,7 @@ void GeneralSettings::saveSettings(QSettings *qs)
     qs->setValue(QLatin1String("SaveSettingsOnExit"), m_saveSettingsOnExit);
     qs->setValue(QLatin1String("AutoConnect"), m_autoConnect);
     qs->setValue(QLatin1String("AutoSelect"), m_autoSelect);
-    qs->setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
+    qs->setValue(QLatin1String("TelemetryRelay"), m_telemetryRelay);
     qs->setValue(QLatin1String("ExpertMode"), m_useExpertMode);
     qs->endGroup();
 }
@@ -244,9 +244,9 @@ bool GeneralSettings::autoSelect() const
     return m_autoSelect;
 }
 
-bool GeneralSettings::useUDPMirror() const
+bool GeneralSettings::useTelemetryRelay() const
 {
-    return m_useUDPMirror;
+    return m_telemetryRelay;
 }
 
 bool GeneralSettings::useExpertMode() const
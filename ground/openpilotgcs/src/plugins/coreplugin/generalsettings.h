@@ -56,7 +56,7 @@ public:
     bool saveSettingsOnExit() const;
     bool autoConnect() const;
     bool autoSelect() const;
-    bool useUDPMirror() const;
+    bool useTelemetryRelay() const;
     void readSettings(QSettings *qs);
     void saveSettings(QSettings *qs);
     bool useExpertMode() const;
@@ -77,7 +77,7 @@ private:
     bool m_saveSettingsOnExit;
     bool m_autoConnect;
     bool m_autoSelect;
-    bool m_useUDPMirror;
+    bool m_telemetryRelay;
     bool m_useExpertMode;
     QPointer<QWidget> m_dialog;
     QList<QTextCodec *> m_codecs;
@@ -61,6 +61,7 @@
 
 #include <coreplugin/settingsdatabase.h>
 #include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/startuptrace.h>
 #include "dialogs/iwizard.h"
 #include <utils/pathchooser.h>
 #include <utils/stylehelper.h>
@@ -276,14 +277,21 @@ void MainWindow::extensionsInitialized()
     qs->endGroup();
 
     m_uavGadgetInstanceManager = new UAVGadgetInstanceManager(this);
-    m_uavGadgetInstanceManager->readSettings(qs);
+    {
+        ExtensionSystem::StartupTrace::Span span("workspace", QLatin1String("gadget configurations"));
+        m_uavGadgetInstanceManager->readSettings(qs);
+    }
 
     m_messageManager->init();
-    readSettings(qs);
+    {
+        ExtensionSystem::StartupTrace::Span span("workspace", QLatin1String("workspaces"));
+        readSettings(qs);
+    }
 
     updateContext();
 
     emit m_coreImpl->coreAboutToOpen();
+    ExtensionSystem::StartupTrace::finishOnFirstPaint(this);
     show();
     emit m_coreImpl->coreOpened();
 }
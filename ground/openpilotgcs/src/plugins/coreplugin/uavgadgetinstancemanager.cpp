@@ -36,6 +36,7 @@
 #include "icore.h"
 
 #include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/startuptrace.h>
 #include <QtCore/QStringList>
 #include <QtCore/QSettings>
 #include <QtCore/QDebug>
@@ -265,6 +266,7 @@ IUAVGadget *UAVGadgetInstanceManager::createGadget(QString classId, QWidget *par
     IUAVGadgetFactory *f = factory(classId);
 
     if (f) {
+        ExtensionSystem::StartupTrace::Span span("gadget", classId);
         QList<IUAVGadgetConfiguration *> *configs = configurations(classId);
         IUAVGadget *g = f->createGadget(parent);
         UAVGadgetDecorator *gadget = new UAVGadgetDecorator(g, configs);
@@ -272,6 +274,8 @@ IUAVGadget *UAVGadgetInstanceManager::createGadget(QString classId, QWidget *par
             gadget->loadConfiguration(configs->at(0));
         }
 
+        ExtensionSystem::StartupTrace::watchFirstPaint(gadget->widget(), classId);
+
         m_gadgetInstances.append(gadget);
         connect(this, SIGNAL(configurationAdded(IUAVGadgetConfiguration *)), gadget, SLOT(configurationAdded(IUAVGadgetConfiguration *)));
         connect(this, SIGNAL(configurationChanged(IUAVGadgetConfiguration *)), gadget, SLOT(configurationChanged(IUAVGadgetConfiguration *)));
@@ -1,8 +1,40 @@
 #include "debugengine.h"
 
-debugengine::debugengine()
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+#include <QTextCursor>
+#include <QTextCharFormat>
+#include <QScrollBar>
+#include <QVector>
+
+// Messages are shown at most this often, whatever their rate
+#define FLUSH_PERIOD_MS 40
+
+DebugLogWriter::DebugLogWriter(QFile *file) : m_file(file)
 {
-    mut_lock = new QMutex(QMutex::Recursive);
+    m_file->setParent(this);
+}
+
+DebugLogWriter::~DebugLogWriter()
+{
+    m_file->close();
+}
+
+void DebugLogWriter::write(const QString &lines)
+{
+    m_file->write(lines.toUtf8());
+    m_file->flush();
+}
+
+debugengine::debugengine() : m_pending(0), m_logThread(0), m_logWriter(0)
+{
+    // the instance can first be asked for from any thread, the view is in the GUI one
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+        connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(stopLogging()));
+    }
 }
 
 debugengine *debugengine::getInstance()
@@ -14,31 +46,175 @@ debugengine *debugengine::getInstance()
 
 debugengine::~debugengine()
 {
-    delete mut_lock;
-    mut_lock = NULL;
+    stopLogging();
+
+    Message *message = m_pending.fetchAndStoreAcquire(0);
+    while (message) {
+        Message *next = message->next;
+        delete message;
+        message = next;
+    }
 }
 
 void debugengine::setTextEdit(QTextBrowser *textEdit)
 {
-    QMutexLocker lock(mut_lock);
-
     _textEdit = textEdit;
+    if (_textEdit) {
+        _textEdit->document()->setMaximumBlockCount(MAX_LINES);
+    }
 }
 
-void debugengine::writeMessage(const QString &message)
+void debugengine::writeMessage(const QString &message, const QColor &color)
 {
-    QMutexLocker lock(mut_lock);
+    Message *m = new Message;
+
+    m->text  = message;
+    m->color = color;
+    m->time  = QTime::currentTime();
+
+    m_filterMutex.lock();
+    // a copy only shares the compiled pattern, matching does not hold the lock
+    QRegularExpression filter = m_filter;
+    m_filterMutex.unlock();
+    m->visible = filter.pattern().isEmpty() || filter.match(message).hasMatch();
+
+    Message *head;
+    do {
+        head    = m_pending.load();
+        m->next = head;
+    } while (!m_pending.testAndSetRelease(head, m));
+
+    // only the first message of a batch asks for a flush
+    if (!head) {
+        QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+    }
+}
+
+bool debugengine::setLogFile(const QString &fileName)
+{
+    stopLogging();
+    if (fileName.isEmpty()) {
+        return true;
+    }
 
+    QFile *file = new QFile(fileName);
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Text)) {
+        delete file;
+        return false;
+    }
+    // start with what the view already shows
     if (_textEdit) {
-        _textEdit->append(message);
+        file->write(_textEdit->toPlainText().toUtf8());
+        file->write("\n");
     }
+
+    m_logThread = new QThread(this);
+    m_logWriter = new DebugLogWriter(file);
+    m_logWriter->moveToThread(m_logThread);
+    connect(this, SIGNAL(logLines(QString)), m_logWriter, SLOT(write(QString)));
+    connect(m_logThread, SIGNAL(finished()), m_logWriter, SLOT(deleteLater()));
+    m_logThread->start(QThread::LowestPriority);
+    return true;
 }
 
-void debugengine::setColor(const QColor &c)
+void debugengine::setFilter(const QRegularExpression &filter)
 {
-    QMutexLocker lock(mut_lock);
+    QMutexLocker locker(&m_filterMutex);
+
+    m_filter = filter;
+    m_filter.optimize();
+}
+
+void debugengine::stopLogging()
+{
+    if (!m_logThread) {
+        return;
+    }
+    disconnect(this, SIGNAL(logLines(QString)), m_logWriter, SLOT(write(QString)));
+    // the lines already queued are written before the thread ends
+    m_logThread->quit();
+    m_logThread->wait();
+    delete m_logThread;
+    m_logThread = 0;
+    m_logWriter = 0;
+}
+
+void debugengine::scheduleFlush()
+{
+    QTimer::singleShot(FLUSH_PERIOD_MS, this, SLOT(flush()));
+}
+
+void debugengine::flush()
+{
+    // take the whole list at once, it was built newest first
+    QVector<Message *> batch;
+    for (Message *m = m_pending.fetchAndStoreAcquire(0); m; m = m->next) {
+        batch.append(m);
+    }
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    QString lines;
+    QString timeString;
+    int lastSecond = -1;
+
+    QScrollBar *sb = _textEdit ? _textEdit->verticalScrollBar() : 0;
+    const bool atBottom = sb && sb->value() == sb->maximum();
+    QTextCursor cursor;
+    if (_textEdit) {
+        cursor = QTextCursor(_textEdit->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.beginEditBlock();
+    }
+
+    // only the most recent lines survive in the view anyway, the rejected
+    // messages do not take the room of the shown ones
+    QVector<bool> show(batch.count(), false);
+    int first = -1;
+    for (int i = 0, shown = 0; i < batch.count() && shown < MAX_LINES; ++i) {
+        if (batch.at(i)->visible) {
+            show[i] = true;
+            first   = i;
+            shown++;
+        }
+    }
+    if (m_logThread) {
+        first = batch.count() - 1;
+    }
+
+    for (int i = first; i >= 0; --i) {
+        if (!show.at(i) && !m_logThread) {
+            continue;
+        }
+        const Message *m = batch.at(i);
+        // the text of the time is only built again when the second changes
+        if (m->time.msecsSinceStartOfDay() / 1000 != lastSecond) {
+            lastSecond = m->time.msecsSinceStartOfDay() / 1000;
+            timeString = m->time.toString() + ' ';
+        }
+        const QString line = timeString + m->text;
+        if (_textEdit && show.at(i)) {
+            if (!_textEdit->document()->isEmpty()) {
+                cursor.insertBlock();
+            }
+            QTextCharFormat format;
+            format.setForeground(m->color);
+            cursor.insertText(line, format);
+        }
+        if (m_logThread) {
+            lines.append(line).append('\n');
+        }
+    }
 
     if (_textEdit) {
-        _textEdit->setTextColor(c);
+        cursor.endEditBlock();
+        if (atBottom) {
+            sb->setValue(sb->maximum());
+        }
+    }
+    if (!lines.isEmpty()) {
+        emit logLines(lines);
     }
+    qDeleteAll(batch);
 }
@@ -2,20 +2,73 @@
 #define DEBUGENGINE_H
 #include <QTextBrowser>
 #include <QPointer>
+#include <QAtomicPointer>
+#include <QColor>
+#include <QTime>
 #include <QMutex>
+#include <QRegularExpression>
 
-class debugengine {
+class QFile;
+class QThread;
+
+// Appends the lines it is given to a file, lives in its own thread
+class DebugLogWriter : public QObject {
+    Q_OBJECT
+
+public:
+    DebugLogWriter(QFile *file);
+    ~DebugLogWriter();
+
+public slots:
+    void write(const QString &lines);
+
+private:
+    QFile *m_file;
+};
+
+// Messages can be written from any thread, they are pushed on a lock free list
+// and shown in the view in one batch per frame. The view keeps the last MAX_LINES.
+// The filter is matched by the thread writing the message, the messages it rejects
+// are only left out of the view, the log file gets them all.
+class debugengine : public QObject {
+    Q_OBJECT
 // Add all missing constructor etc... to have singleton
     debugengine();
     ~debugengine();
 public:
+    static const int MAX_LINES = 5000;
+
     static debugengine *getInstance();
     void setTextEdit(QTextBrowser *textEdit);
-    void writeMessage(const QString &message);
-    void setColor(const QColor &c);
-    QMutex *mut_lock;
+    void writeMessage(const QString &message, const QColor &color = Qt::black);
+    // the following messages are also appended to that file, an empty name stops it
+    bool setLogFile(const QString &fileName);
+    // only the messages matching it are shown, all when empty
+    void setFilter(const QRegularExpression &filter);
+
+signals:
+    void logLines(const QString &lines);
+
+private slots:
+    void scheduleFlush();
+    void flush();
+    void stopLogging();
+
 private:
+    struct Message {
+        QString  text;
+        QColor   color;
+        QTime    time;
+        bool     visible;
+        Message *next;
+    };
+
+    QAtomicPointer<Message> m_pending;
     QPointer<QTextBrowser> _textEdit;
+    QThread *m_logThread;
+    QMutex m_filterMutex;
+    QRegularExpression m_filter;
+    DebugLogWriter *m_logWriter;
 };
 
 #endif // DEBUGENGINE_H
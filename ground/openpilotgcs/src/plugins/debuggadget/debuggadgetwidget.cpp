@@ -36,10 +36,6 @@
 #include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
-#include <QScrollBar>
-#include <QTime>
-
-QPointer<QTextBrowser> m_textedit;
 
 void DebugGadgetWidget::customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
@@ -65,15 +61,14 @@ void DebugGadgetWidget::customMessageHandler(QtMsgType type, const QMessageLogCo
         abort();
     }
 
-    debugengine::getInstance()->setTextEdit(m_textedit);
-    debugengine::getInstance()->setColor(color);
-    debugengine::getInstance()->writeMessage(txt);
+    debugengine::getInstance()->writeMessage(txt, color);
 }
 
 DebugGadgetWidget::DebugGadgetWidget(QWidget *parent) : QLabel(parent)
 {
     m_config = new Ui_Form();
     m_config->setupUi(this);
+    debugengine::getInstance()->setTextEdit(m_config->plainTextEdit);
 
     // m_textedit = m_config->plainTextEdit;
     // MyplainTextEdit=m_config->plainTextEdit;
@@ -82,6 +77,7 @@ DebugGadgetWidget::DebugGadgetWidget(QWidget *parent) : QLabel(parent)
     // connect(de, SIGNAL(dbgMsg(QString, QList<QVariant>)), this, SLOT(dbgMsg(QString, QList<QVariant>)));
     // connect(de, SIGNAL(dbgMsgError(QString, QList<QVariant>)), this, SLOT(dbgMsgError(QString, QList<QVariant>)));
     connect(m_config->pushButton, SIGNAL(clicked()), this, SLOT(saveLog()));
+    connect(m_config->filterEdit, SIGNAL(textChanged(QString)), this, SLOT(setFilter(QString)));
 }
 
 DebugGadgetWidget::~DebugGadgetWidget()
@@ -91,24 +87,25 @@ DebugGadgetWidget::~DebugGadgetWidget()
 
 void DebugGadgetWidget::dbgMsg(const QString &level, const QList<QVariant> &msgs)
 {
-    m_config->plainTextEdit->setTextColor(Qt::red);
-
-    m_config->plainTextEdit->append(QString("%2[%0]%1").arg(level).arg(msgs[0].toString()).arg(QTime::currentTime().toString()));
-
-    QScrollBar *sb = m_config->plainTextEdit->verticalScrollBar();
-    sb->setValue(sb->maximum());
+    debugengine::getInstance()->writeMessage(QString("[%0]%1").arg(level).arg(msgs[0].toString()), Qt::red);
 }
 
 void DebugGadgetWidget::dbgMsgError(const QString &level, const QList<QVariant> &msgs)
 {
-    m_config->plainTextEdit->setTextColor(Qt::black);
-
+    debugengine::getInstance()->writeMessage(QString("[%0]%1").arg(level).arg(msgs[0].toString()), Qt::black);
+}
 
-    m_config->plainTextEdit->append(QString("%2[%0]%1").arg(level).arg(msgs[0].toString()).arg(QTime::currentTime().toString()));
+// The following messages are shown only if they match, an invalid pattern shows them all
+void DebugGadgetWidget::setFilter(const QString &pattern)
+{
+    QRegularExpression filter(pattern);
+    bool valid = filter.isValid();
 
-    QScrollBar *sb = m_config->plainTextEdit->verticalScrollBar();
-    sb->setValue(sb->maximum());
+    m_config->filterEdit->setStyleSheet(valid ? QString() : QString("color: red"));
+    debugengine::getInstance()->setFilter(valid ? filter : QRegularExpression());
 }
+
+// Saves what the view shows and keeps appending the following messages to the file
 void DebugGadgetWidget::saveLog()
 {
     QString fileName = QFileDialog::getSaveFileName(0, tr("Save log File As"), "");
@@ -117,11 +114,7 @@ void DebugGadgetWidget::saveLog()
         return;
     }
 
-    QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly) &&
-        (file.write(m_config->plainTextEdit->toHtml().toLatin1()) != -1)) {
-        file.close();
-    } else {
+    if (!debugengine::getInstance()->setLogFile(fileName)) {
         QMessageBox::critical(0,
                               tr("Log Save"),
                               tr("Unable to save log: ") + fileName,
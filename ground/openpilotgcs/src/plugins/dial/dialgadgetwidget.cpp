@@ -28,6 +28,7 @@
 
 #include "dialgadgetwidget.h"
 #include <utils/stylehelper.h>
+#include <utils/cachedsvgitem.h>
 #include <iostream>
 #include <QtOpenGL/QGLWidget>
 #include <QDebug>
@@ -87,25 +88,25 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                                       QString object2, QString nfield2,
                                       QString object3, QString nfield3)
 {
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
     if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
+        objManager->unsubscribeFrameUpdates(obj1, this, SLOT(updateNeedle1(UAVObject *)));
     }
     if (obj2 != NULL) {
-        disconnect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
+        objManager->unsubscribeFrameUpdates(obj2, this, SLOT(updateNeedle2(UAVObject *)));
     }
     if (obj3 != NULL) {
-        disconnect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
+        objManager->unsubscribeFrameUpdates(obj3, this, SLOT(updateNeedle3(UAVObject *)));
     }
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
     // Check validity of arguments first, reject empty args and unknown fields.
     if (!(object1.isEmpty() || nfield1.isEmpty())) {
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
             // qDebug() << "Connected Object 1 (" << object1 << ").";
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle1(UAVObject *)));
+            objManager->subscribeFrameUpdates(obj1, this, SLOT(updateNeedle1(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -125,7 +126,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj2 = dynamic_cast<UAVDataObject *>(objManager->getObject(object2));
         if (obj2 != NULL) {
             // qDebug() << "Connected Object 2 (" << object2 << ").";
-            connect(obj2, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle2(UAVObject *)));
+            objManager->subscribeFrameUpdates(obj2, this, SLOT(updateNeedle2(UAVObject *)));
             if (nfield2.contains("-")) {
                 QStringList fieldSubfield = nfield2.split("-", QString::SkipEmptyParts);
                 field2        = fieldSubfield.at(0);
@@ -145,7 +146,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
         obj3 = dynamic_cast<UAVDataObject *>(objManager->getObject(object3));
         if (obj3 != NULL) {
             // qDebug() << "Connected Object 3 (" << object3 << ").";
-            connect(obj3, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateNeedle3(UAVObject *)));
+            objManager->subscribeFrameUpdates(obj3, this, SLOT(updateNeedle3(UAVObject *)));
             if (nfield3.contains("-")) {
                 QStringList fieldSubfield = nfield3.split("-", QString::SkipEmptyParts);
                 field3        = fieldSubfield.at(0);
@@ -251,14 +252,14 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
     setBackgroundBrush(QBrush(Utils::StyleHelper::baseColor()));
     if (QFile::exists(dfn) && m_renderer->load(dfn) && m_renderer->isValid()) {
         l_scene->clear(); // This also deletes all items contained in the scene.
-        m_background = new QGraphicsSvgItem();
+        m_background = new CachedSvgItem();
         // All other items will be clipped to the shape of the background
         m_background->setFlags(QGraphicsItem::ItemClipsChildrenToShape |
                                QGraphicsItem::ItemClipsToShape);
-        m_foreground = new QGraphicsSvgItem();
-        m_needle1    = new QGraphicsSvgItem();
-        m_needle2    = new QGraphicsSvgItem();
-        m_needle3    = new QGraphicsSvgItem();
+        m_foreground = new CachedSvgItem();
+        m_needle1    = new CachedSvgItem();
+        m_needle2    = new CachedSvgItem();
+        m_needle3    = new CachedSvgItem();
         m_needle1->setParentItem(m_background);
         m_needle2->setParentItem(m_background);
         m_needle3->setParentItem(m_background);
@@ -428,7 +429,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
         qDebug() << "no file: display default background.";
         m_renderer->load(QString(":/dial/images/empty.svg"));
         l_scene->clear(); // This also deletes all items contained in the scene.
-        m_background = new QGraphicsSvgItem();
+        m_background = new CachedSvgItem();
         m_background->setSharedRenderer(m_renderer);
         l_scene->addItem(m_background);
         m_text1   = NULL;
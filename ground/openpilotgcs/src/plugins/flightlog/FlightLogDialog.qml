@@ -24,11 +24,45 @@ Rectangle {
                 anchors.margins: 10
                 anchors.fill: parent
                 visible: true
-                Text {
+                RowLayout {
                     Layout.fillWidth: true
-                    text: "<b>" + qsTr("Log entries") + "</b>"
+                    spacing: 10
+                    Text {
+                        Layout.fillWidth: true
+                        text: "<b>" + qsTr("Log entries") + "</b>"
+                    }
+                    Text {
+                        text: qsTr("Show:")
+                    }
+                    ComboBox {
+                        id: objectFilterCombo
+                        enabled: !logManager.disableControls
+                        model: [qsTr("All entries")].concat(logManager.logEntries.objectNames)
+                        onActivated: logManager.logEntries.setObjectFilter(index > 0 ? logManager.logEntries.objectNames[index - 1] : "")
+                    }
+                    Text {
+                        text: qsTr("Flight:")
+                    }
+                    SpinBox {
+                        id: jumpFlight
+                        minimumValue: 1
+                        maximumValue: logStatus.Flight + 1
+                    }
+                    Button {
+                        text: qsTr("Go")
+                        enabled: !logManager.disableControls && logManager.logEntriesCount > 0
+                        activeFocusOnPress: true
+                        onClicked: {
+                            var row = logManager.logEntries.firstRowOfFlight(jumpFlight.value - 1)
+                            if (row >= 0) {
+                                logTable.positionViewAtRow(row, ListView.Beginning)
+                                logTable.currentRow = row
+                            }
+                        }
+                    }
                 }
                 TableView {
+                    id: logTable
                     Layout.fillWidth: true
                     Layout.fillHeight: true
                     Layout.preferredHeight: 1000;
@@ -147,6 +181,12 @@ Rectangle {
                                 activeFocusOnPress: true
                                 onClicked: logManager.retrieveLogs(flightCombo.currentIndex - 1)
                             }
+                            Button {
+                                text: qsTr("Download to file...")
+                                enabled: !logManager.disableControls && logManager.boardConnected
+                                activeFocusOnPress: true
+                                onClicked: logManager.downloadLogsToOPL(flightCombo.currentIndex - 1)
+                            }
                         }
                         Rectangle {
                             Layout.fillHeight: true
@@ -169,6 +209,18 @@ Rectangle {
                                 activeFocusOnPress: true
                                 onClicked: logManager.exportLogs()
                             }
+                            Button {
+                                enabled: !logManager.disableControls
+                                text: qsTr("Convert log to columns...")
+                                activeFocusOnPress: true
+                                onClicked: logManager.exportLogToColumns()
+                            }
+                            Button {
+                                enabled: !logManager.disableControls
+                                text: qsTr("Load message formats...")
+                                activeFocusOnPress: true
+                                onClicked: logManager.loadFormatTable()
+                            }
                         }
                     }
                 }
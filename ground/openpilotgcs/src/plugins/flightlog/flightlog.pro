@@ -1,7 +1,7 @@
 TEMPLATE = lib 
 TARGET = FlightLog
 
-QT += qml quick
+QT += qml quick concurrent
 
 include(../../openpilotgcsplugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
@@ -10,9 +10,15 @@ include(../../plugins/uavobjectutil/uavobjectutil.pri)
 include(../../plugins/uavtalk/uavtalk.pri)
 
 HEADERS += flightlogplugin.h \
-    flightlogmanager.h
+    flightlogmanager.h \
+    flightlogdownloader.h \
+    flightlogentrymodel.h \
+    flightlogcolumnexporter.h
 SOURCES += flightlogplugin.cpp \
-    flightlogmanager.cpp
+    flightlogmanager.cpp \
+    flightlogdownloader.cpp \
+    flightlogentrymodel.cpp \
+    flightlogcolumnexporter.cpp
 
 OTHER_FILES += Flightlog.pluginspec \
     FlightLogDialog.qml \
@@ -0,0 +1,226 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogcolumnexporter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Converts a .opl log to one raw array per UAVObject field
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "flightlogcolumnexporter.h"
+#include "uavdataobject.h"
+#include <utils/crc.h>
+
+#include <QFile>
+#include <QDir>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrentRun>
+#include <QtEndian>
+#include <QDebug>
+
+// UAVTalk framing, the logs only hold complete object packets as sent by UAVTalk
+static const quint8 SYNC_VAL         = 0x3C;
+static const quint8 TYPE_TIMESTAMPED = 0x80;
+static const quint8 TYPE_OBJ         = 0x20;
+static const quint8 TYPE_OBJ_ACK     = 0x22;
+static const int HEADER_LENGTH       = 10;
+static const int TIMESTAMP_LENGTH    = 2;
+static const int CHECKSUM_LENGTH     = 1;
+
+// a chunk smaller than this is not worth a thread
+static const int MIN_RECORDS_PER_CHUNK = 4096;
+
+FlightLogColumnExporter::FlightLogColumnExporter(UAVObjectManager *objMngr)
+{
+    // the layouts are looked up from the decoding threads, the object manager is not
+    foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
+        UAVObject *obj = instances.first();
+
+        if (obj->isMetaDataObject()) {
+            continue;
+        }
+        ObjectLayout layout;
+        layout.name     = obj->getName();
+        layout.isSingleInstance = obj->isSingleInstance();
+        layout.numBytes = obj->getNumBytes();
+        int offset = 0;
+        foreach(UAVObjectField * field, obj->getFields()) {
+            FieldLayout fieldLayout;
+            fieldLayout.name   = field->getName();
+            fieldLayout.offset = offset;
+            fieldLayout.size   = field->getNumBytes();
+            layout.fields << fieldLayout;
+            offset += fieldLayout.size;
+        }
+        m_layouts.insert(obj->getObjID(), layout);
+    }
+}
+
+bool FlightLogColumnExporter::exportLog(const QString &logFileName, const QString &dirName)
+{
+    QFile file(logFileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = QObject::tr("Could not open %1.").arg(logFileName);
+        return false;
+    }
+
+    QByteArray buffer;
+    const uchar *data = file.map(0, file.size());
+    if (data == NULL) {
+        buffer = file.readAll();
+        data   = (const uchar *)buffer.constData();
+    }
+
+    // the packet boundaries only come from the record headers, walking them is cheap;
+    // the records are then split between the threads
+    QVector<Record> records;
+    qint64 fileSize = file.size();
+    qint64 offset   = 0;
+    while (offset + (qint64)(sizeof(quint32) + sizeof(qint64)) <= fileSize) {
+        Record record;
+        memcpy(&record.timeStamp, data + offset, sizeof(record.timeStamp));
+        memcpy(&record.size, data + offset + sizeof(record.timeStamp), sizeof(record.size));
+        record.offset = offset + sizeof(record.timeStamp) + sizeof(record.size);
+
+        if (record.size < 1 || record.size > (1024 * 1024) || record.offset + record.size > fileSize) {
+            qDebug() << "FlightLogColumnExporter - log corrupted at" << offset << ", the rest is skipped";
+            break;
+        }
+        records << record;
+        offset = record.offset + record.size;
+    }
+
+    int threads = qMax(1, qMin(QThread::idealThreadCount(), records.size() / MIN_RECORDS_PER_CHUNK));
+    QList<QFuture<ColumnSet> > chunks;
+    for (int i = 0; i < threads; ++i) {
+        int first = records.size() * i / threads;
+        int last  = records.size() * (i + 1) / threads;
+        chunks << QtConcurrent::run(this, &FlightLogColumnExporter::decode, data, &records, first, last);
+    }
+
+    // the chunks are appended in log order
+    ColumnSet columns;
+    foreach(QFuture<ColumnSet> chunk, chunks) {
+        ColumnSet part = chunk.result();
+        for (ColumnSet::const_iterator i = part.constBegin(); i != part.constEnd(); ++i) {
+            ColumnSet::iterator merged = columns.find(i.key());
+            if (merged == columns.end()) {
+                columns.insert(i.key(), i.value());
+                continue;
+            }
+            merged->timeStamps.append(i->timeStamps);
+            merged->instances.append(i->instances);
+            for (int n = 0; n < merged->fields.size(); ++n) {
+                merged->fields[n].append(i->fields.at(n));
+            }
+        }
+    }
+
+    if (buffer.isEmpty()) {
+        file.unmap((uchar *)data);
+    }
+    file.close();
+
+    qDebug() << "FlightLogColumnExporter -" << records.size() << "records decoded in" << threads << "threads";
+    return writeColumns(dirName, columns);
+}
+
+FlightLogColumnExporter::ColumnSet FlightLogColumnExporter::decode(const uchar *data, const QVector<Record> *records, int first, int last) const
+{
+    ColumnSet columns;
+
+    for (int r = first; r < last; ++r) {
+        const Record &record = records->at(r);
+        const uchar *packet  = data + record.offset;
+
+        if (record.size < HEADER_LENGTH + CHECKSUM_LENGTH || packet[0] != SYNC_VAL) {
+            continue;
+        }
+        quint8 type = packet[1] & ~TYPE_TIMESTAMPED;
+        if (type != TYPE_OBJ && type != TYPE_OBJ_ACK) {
+            continue;
+        }
+        int length = qFromLittleEndian<quint16>(&packet[2]);
+        if (length + CHECKSUM_LENGTH > record.size || Utils::Crc::updateCRC(0, packet, length) != packet[length]) {
+            continue;
+        }
+        quint32 objId  = qFromLittleEndian<quint32>(&packet[4]);
+        quint16 instId = qFromLittleEndian<quint16>(&packet[8]);
+        QHash<quint32, ObjectLayout>::const_iterator layout = m_layouts.constFind(objId);
+        int payload    = HEADER_LENGTH + ((packet[1] & TYPE_TIMESTAMPED) ? TIMESTAMP_LENGTH : 0);
+        // objects of another version of the definitions cannot be decoded
+        if (layout == m_layouts.constEnd() || length - payload != layout->numBytes) {
+            continue;
+        }
+
+        ColumnSet::iterator object = columns.find(objId);
+        if (object == columns.end()) {
+            object = columns.insert(objId, Columns());
+            object->fields.resize(layout->fields.size());
+        }
+        object->timeStamps.append((const char *)&record.timeStamp, sizeof(record.timeStamp));
+        if (!layout->isSingleInstance) {
+            object->instances.append((const char *)&packet[8], sizeof(instId));
+        }
+        for (int n = 0; n < layout->fields.size(); ++n) {
+            const FieldLayout &field = layout->fields.at(n);
+            object->fields[n].append((const char *)&packet[payload + field.offset], field.size);
+        }
+    }
+    return columns;
+}
+
+bool FlightLogColumnExporter::writeColumns(const QString &dirName, const ColumnSet &columns)
+{
+    QDir dir(dirName);
+
+    for (ColumnSet::const_iterator i = columns.constBegin(); i != columns.constEnd(); ++i) {
+        const ObjectLayout &layout = m_layouts[i.key()];
+        QString objectDir = dir.filePath(layout.name);
+        if (!dir.mkpath(objectDir)) {
+            m_errorString = QObject::tr("Could not create %1.").arg(objectDir);
+            return false;
+        }
+
+        QList<QPair<QString, QByteArray> > files;
+        quint32 objId = qToLittleEndian<quint32>(i.key());
+        files << qMakePair(QString("objid"), QByteArray((const char *)&objId, sizeof(objId)));
+        files << qMakePair(QString("timestamp"), i->timeStamps);
+        if (!layout.isSingleInstance) {
+            files << qMakePair(QString("instance"), i->instances);
+        }
+        for (int n = 0; n < layout.fields.size(); ++n) {
+            files << qMakePair(layout.fields.at(n).name, i->fields.at(n));
+        }
+
+        for (int n = 0; n < files.size(); ++n) {
+            QFile column(QDir(objectDir).filePath(files.at(n).first));
+            if (!column.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+                column.write(files.at(n).second) != files.at(n).second.size()) {
+                m_errorString = QObject::tr("Could not write %1.").arg(column.fileName());
+                return false;
+            }
+            column.close();
+        }
+    }
+    return true;
+}
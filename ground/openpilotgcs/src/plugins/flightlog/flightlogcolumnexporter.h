@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogcolumnexporter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Converts a .opl log to one raw array per UAVObject field
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FLIGHTLOGCOLUMNEXPORTER_H
+#define FLIGHTLOGCOLUMNEXPORTER_H
+
+#include "uavobjectmanager.h"
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+
+// Every object found in the log gets a directory <dir>/<ObjectName> holding
+// objid             the object id the columns were written with (uint32)
+// timestamp         the log time stamp of every row, in ms (uint32)
+// instance          the instance id of every row, multi instance objects only (uint16)
+// <FieldName>       the field elements of every row, as packed by UAVTalk
+// All the values are little endian, a column is loaded without parsing: rows = file size / row size.
+// The loaders generated with the python and matlab UAVObjects do just that.
+class FlightLogColumnExporter {
+public:
+    explicit FlightLogColumnExporter(UAVObjectManager *objMngr);
+
+    // decodes the log in as many threads as there are cores
+    bool exportLog(const QString &logFileName, const QString &dirName);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    struct FieldLayout {
+        QString name;
+        int     offset;
+        int     size;
+    };
+    struct ObjectLayout {
+        QString name;
+        bool    isSingleInstance;
+        int     numBytes;
+        QVector<FieldLayout> fields;
+    };
+    // the columns of one object, for a part of the log or the whole of it
+    struct Columns {
+        QByteArray timeStamps;
+        QByteArray instances;
+        QVector<QByteArray> fields;
+    };
+    typedef QHash<quint32, Columns> ColumnSet;
+
+    struct Record {
+        quint32 timeStamp;
+        qint64  offset;
+        qint64  size;
+    };
+
+    QHash<quint32, ObjectLayout> m_layouts;
+    QString m_errorString;
+
+    ColumnSet decode(const uchar *data, const QVector<Record> *records, int first, int last) const;
+    bool writeColumns(const QString &dirName, const ColumnSet &columns);
+};
+
+#endif // FLIGHTLOGCOLUMNEXPORTER_H
@@ -0,0 +1,256 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogdownloader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Streams the on board log from a worker thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "flightlogdownloader.h"
+#include "uavtalk/uavtalk.h"
+#include "utils/logfile.h"
+
+#include <QDebug>
+
+// log position ordered by flight then entry, as on the board
+static quint32 position(quint16 flight, quint16 entry)
+{
+    return ((quint32)flight << 16) | entry;
+}
+
+FlightLogDownloader::FlightLogDownloader(UAVObjectManager *objMngr) : QObject(0),
+    m_objMngr(objMngr), m_timer(this), m_active(0), m_cancel(0), m_expected(0), m_end(0), m_expectedInstance(0),
+    m_acked(0), m_ackPending(false), m_resend(false), m_retries(0), m_count(0), m_adjustTimestamps(false),
+    m_logFile(NULL), m_logFlight(-1), m_baseTime(0)
+{
+    qRegisterMetaType<DebugLogEntry::DataFields>("DebugLogEntry::DataFields");
+    qRegisterMetaType<QVector<DebugLogEntry::DataFields> >("QVector<DebugLogEntry::DataFields>");
+
+    m_control = DebugLogControl::GetInstance(m_objMngr);
+    Q_ASSERT(m_control);
+    connect(m_control, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(ackCompleted(UAVObject *, bool)));
+
+    // the entries have to be copied while UAVTalk unpacks them, the next one may overwrite the instance
+    foreach(UAVObject * obj, m_objMngr->getObjectInstances(DebugLogEntry::OBJID)) {
+        connect(obj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(entryUnpacked(UAVObject *)), Qt::DirectConnection);
+    }
+    // UAVTalk registers the instances of the window when they are first received, then unpacks them
+    connect(m_objMngr, SIGNAL(newInstance(UAVObject *)), this, SLOT(newInstance(UAVObject *)), Qt::DirectConnection);
+
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+void FlightLogDownloader::download(int startFlight, int endFlight, QString fileName, bool adjustTimestamps)
+{
+    m_expected = position(startFlight, 0);
+    m_end = endFlight < 0xFFFF ? position(endFlight + 1, 0) : 0xFFFFFFFF;
+    m_expectedInstance = 0;
+    m_retries  = 0;
+    m_count    = 0;
+    m_entries.clear();
+    m_fileName = fileName;
+    m_adjustTimestamps = adjustTimestamps;
+    m_logFlight = -1;
+    m_cancel.store(0);
+    m_active.store(1);
+
+    m_resend    = true;
+    sendAck();
+    m_timer.start(TIMEOUT);
+}
+
+void FlightLogDownloader::newInstance(UAVObject *obj)
+{
+    if (obj->getObjID() == DebugLogEntry::OBJID) {
+        connect(obj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(entryUnpacked(UAVObject *)), Qt::DirectConnection);
+    }
+}
+
+void FlightLogDownloader::entryUnpacked(UAVObject *obj)
+{
+    DebugLogEntry *entry = qobject_cast<DebugLogEntry *>(obj);
+
+    // called in the telemetry thread
+    if (m_active.load() && entry) {
+        QMetaObject::invokeMethod(this, "entryReceived", Qt::QueuedConnection,
+                                  Q_ARG(DebugLogEntry::DataFields, entry->getData()), Q_ARG(int, obj->getInstID()));
+    }
+}
+
+void FlightLogDownloader::entryReceived(DebugLogEntry::DataFields entry, int instance)
+{
+    if (!m_active.load()) {
+        return;
+    }
+    if (m_cancel.load()) {
+        finish(false);
+        return;
+    }
+    // an entry out of order follows a lost one, the timeout has the window sent again
+    if (instance != m_expectedInstance) {
+        return;
+    }
+    quint32 pos = position(entry.Flight, entry.Entry);
+    if (entry.Type == DebugLogEntry::TYPE_EMPTY || pos >= m_end) {
+        finish(true);
+        return;
+    }
+    if (pos < m_expected) {
+        return;
+    }
+
+    if (m_fileName.isEmpty()) {
+        m_entries << entry;
+    } else {
+        writeEntry(entry);
+    }
+    m_expected = pos + 1;
+    m_expectedInstance = (instance + 1) % WINDOW;
+    m_retries  = 0;
+    m_timer.start(TIMEOUT);
+    if (++m_count % 100 == 0) {
+        emit progress(m_count);
+    }
+    sendAck();
+}
+
+void FlightLogDownloader::ackCompleted(UAVObject *obj, bool success)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(success);
+
+    m_ackPending = false;
+    // the entries received meanwhile are acknowledged at once
+    if (m_active.load() && (m_acked != m_expected || m_resend)) {
+        sendAck();
+    }
+}
+
+void FlightLogDownloader::timeout()
+{
+    if (m_cancel.load() || ++m_retries > MAX_RETRIES) {
+        qDebug() << "FlightLogDownloader - stream" << (m_cancel.load() ? "cancelled" : "timed out") << "after" << m_count << "entries";
+        finish(false);
+        return;
+    }
+    // the entry expected was lost, repeating its position sends the window again
+    m_resend = true;
+    sendAck();
+}
+
+void FlightLogDownloader::sendAck()
+{
+    // telemetry drops an update while the previous one waits for its ack
+    if (m_ackPending) {
+        return;
+    }
+    DebugLogControl::DataFields fields = m_control->getData();
+    fields.Operation = DebugLogControl::OPERATION_STREAM;
+    fields.Flight    = m_expected >> 16;
+    fields.Entry     = m_expected & 0xFFFF;
+    fields.Window    = WINDOW;
+    fields.Instance  = m_expectedInstance;
+    m_control->setData(fields);
+    m_control->updated();
+
+    m_acked      = m_expected;
+    m_ackPending = true;
+    m_resend     = false;
+}
+
+void FlightLogDownloader::finish(bool success)
+{
+    m_timer.stop();
+    m_active.store(0);
+
+    // stop the stream, it would also end by itself without acknowledgements
+    DebugLogControl::DataFields fields = m_control->getData();
+    fields.Operation = DebugLogControl::OPERATION_NONE;
+    m_control->setData(fields);
+    if (!m_ackPending) {
+        m_control->updated();
+    }
+
+    if (m_logFile) {
+        m_logFile->close();
+        delete m_logFile;
+        m_logFile = NULL;
+    }
+    qDebug() << "FlightLogDownloader - received" << m_count << "entries";
+    emit progress(m_count);
+    if (success && m_fileName.isEmpty()) {
+        emit entriesReceived(m_entries);
+    }
+    m_entries.clear();
+    emit completed(success);
+}
+
+void FlightLogDownloader::writeEntry(const DebugLogEntry::DataFields &entry)
+{
+    if (entry.Type != DebugLogEntry::TYPE_UAVOBJECT && entry.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        return;
+    }
+    // one file per flight
+    if (m_logFlight != entry.Flight) {
+        if (m_logFile) {
+            m_logFile->close();
+            delete m_logFile;
+        }
+        m_logFile = new LogFile;
+        m_logFile->useProvidedTimeStamp(true);
+        m_logFile->setFileName(m_fileName.arg(tr("_flight-%1").arg(entry.Flight + 1)));
+        m_logFile->open(QIODevice::WriteOnly);
+        m_logFlight = entry.Flight;
+        m_baseTime  = m_adjustTimestamps ? entry.FlightTime : 0;
+    }
+
+    writeObject(entry.FlightTime, entry.ObjectID, entry.InstanceID, entry.Data, entry.Size);
+
+    if (entry.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        // the first object is followed by packed entries, each header followed by its object
+        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+        const quint32 data_len   = sizeof(entry.Data);
+        const quint32 header_len = total_len - data_len;
+
+        DebugLogEntry::DataFields fields;
+        quint32 start = entry.Size;
+
+        while (start + header_len + 1 < data_len) {
+            // unused space is 0xFF on the board, the size read there ends the loop
+            memcpy(&fields, &entry.Data[start], header_len);
+            quint32 toread = header_len + fields.Size;
+            if (!(toread + start > data_len)) {
+                writeObject(fields.FlightTime, fields.ObjectID, fields.InstanceID, &entry.Data[start + header_len], fields.Size);
+            }
+            start += toread;
+        }
+    }
+}
+
+void FlightLogDownloader::writeObject(quint32 flightTime, quint32 objId, quint16 instId, const quint8 *data, quint16 size)
+{
+    QByteArray packet = UAVTalk::objectPacket(objId, instId, data, size);
+
+    if (!packet.isEmpty()) {
+        m_logFile->setNextTimeStamp(flightTime - m_baseTime);
+        m_logFile->write(packet);
+    }
+}
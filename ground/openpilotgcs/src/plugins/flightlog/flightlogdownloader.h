@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogdownloader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief Streams the on board log from a worker thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FLIGHTLOGDOWNLOADER_H
+#define FLIGHTLOGDOWNLOADER_H
+
+#include "uavobjectmanager.h"
+#include "debuglogentry.h"
+#include "debuglogcontrol.h"
+
+#include <QObject>
+#include <QVector>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QMetaType>
+
+class LogFile;
+
+Q_DECLARE_METATYPE(DebugLogEntry::DataFields)
+
+// lives in its own thread, the board pushes a window of entries and each DebugLogControl
+// Stream update acknowledges the ones received in order
+class FlightLogDownloader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FlightLogDownloader(UAVObjectManager *objMngr);
+
+    // can be called from any thread
+    void cancel()
+    {
+        m_cancel.store(1);
+    }
+
+public slots:
+    // fileName set: each flight is written to fileName.arg("_flight-N") as it arrives,
+    // empty: the entries are handed over with entriesReceived()
+    void download(int startFlight, int endFlight, QString fileName, bool adjustTimestamps);
+
+signals:
+    void entriesReceived(QVector<DebugLogEntry::DataFields> entries);
+    void progress(int entries);
+    void completed(bool success);
+
+private slots:
+    void newInstance(UAVObject *obj);
+    void entryUnpacked(UAVObject *obj);
+    void entryReceived(DebugLogEntry::DataFields entry, int instance);
+    void ackCompleted(UAVObject *obj, bool success);
+    void timeout();
+
+private:
+    static const int WINDOW      = 8;
+    static const int TIMEOUT     = 500;
+    static const int MAX_RETRIES = 8;
+
+    UAVObjectManager *m_objMngr;
+    DebugLogControl *m_control;
+    QTimer m_timer;
+    // set while downloading, entries are only forwarded to the thread then
+    QAtomicInt m_active;
+    QAtomicInt m_cancel;
+
+    // next position expected, flight in the upper 16 bits, and the instance it comes in
+    quint32 m_expected;
+    quint32 m_end;
+    int m_expectedInstance;
+    quint32 m_acked;
+    bool m_ackPending;
+    bool m_resend;
+    int m_retries;
+    int m_count;
+
+    QVector<DebugLogEntry::DataFields> m_entries;
+    QString m_fileName;
+    bool m_adjustTimestamps;
+    LogFile *m_logFile;
+    int m_logFlight;
+    quint32 m_baseTime;
+
+    void sendAck();
+    void finish(bool success);
+    void writeEntry(const DebugLogEntry::DataFields &entry);
+    void writeObject(quint32 flightTime, quint32 objId, quint16 instId, const quint8 *data, quint16 size);
+};
+
+#endif // FLIGHTLOGDOWNLOADER_H
@@ -0,0 +1,402 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogentrymodel.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief List model of the downloaded log entries, decoded only when displayed
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "flightlogentrymodel.h"
+
+#include <QtAlgorithms>
+#include <QFile>
+#include <string.h>
+
+FlightLogEntryModel::FlightLogEntryModel(UAVObjectManager *objectManager, QObject *parent) :
+    QAbstractListModel(parent), m_objectManager(objectManager), m_filterObjectId(0)
+{}
+
+FlightLogEntryModel::~FlightLogEntryModel()
+{
+    qDeleteAll(m_objects);
+}
+
+int FlightLogEntryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return isFiltered() ? m_rows.count() : m_entries.count();
+}
+
+QVariant FlightLogEntryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    const int i = isFiltered() ? m_rows.at(index.row()) : index.row();
+    const DebugLogEntry::DataFields &e = m_entries.at(i);
+
+    switch (role) {
+    case FlightRole:
+        return e.Flight;
+
+    case FlightTimeRole:
+        return e.FlightTime;
+
+    case TypeRole:
+        return e.Type;
+
+    case LogStringRole:
+        return logString(i);
+
+    case ObjectNameRole:
+    {
+        UAVObject *obj = (e.Type == DebugLogEntry::TYPE_TEXT) ? 0 : m_objectManager->getObject(e.ObjectID);
+        return obj ? obj->getName() : QString();
+    }
+
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> FlightLogEntryModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+
+    roles[FlightRole]     = "Flight";
+    roles[FlightTimeRole] = "FlightTime";
+    roles[TypeRole]       = "Type";
+    roles[LogStringRole]  = "LogString";
+    roles[ObjectNameRole] = "ObjectName";
+    return roles;
+}
+
+void FlightLogEntryModel::clear()
+{
+    beginResetModel();
+    m_entries.clear();
+    m_rows.clear();
+    m_flightStarts.clear();
+    m_objectIds.clear();
+    qDeleteAll(m_objects);
+    m_objects.clear();
+    endResetModel();
+
+    if (!m_objectNames.isEmpty()) {
+        m_objectNames.clear();
+        emit objectNamesChanged();
+    }
+}
+
+void FlightLogEntryModel::append(const QVector<DebugLogEntry::DataFields> &entries)
+{
+    const int firstEntry = m_entries.count();
+    const int firstRow   = rowCount();
+    QSet<quint32> newObjects;
+
+    foreach(const DebugLogEntry::DataFields &entry, entries) {
+        splitEntry(entry, newObjects);
+    }
+
+    int lastRow = firstRow - 1;
+    if (isFiltered()) {
+        for (int i = firstEntry; i < m_entries.count(); ++i) {
+            if (accepts(m_entries.at(i))) {
+                ++lastRow;
+            }
+        }
+    } else {
+        lastRow += m_entries.count() - firstEntry;
+    }
+    if (lastRow >= firstRow) {
+        beginInsertRows(QModelIndex(), firstRow, lastRow);
+        if (isFiltered()) {
+            for (int i = firstEntry; i < m_entries.count(); ++i) {
+                if (accepts(m_entries.at(i))) {
+                    m_rows.append(i);
+                }
+            }
+        }
+        endInsertRows();
+    }
+
+    if (!newObjects.isEmpty()) {
+        foreach(quint32 objId, newObjects) {
+            UAVObject *obj = m_objectManager->getObject(objId);
+            if (obj) {
+                m_objectNames.append(obj->getName());
+            }
+        }
+        m_objectNames.sort();
+        emit objectNamesChanged();
+    }
+}
+
+void FlightLogEntryModel::appendEntry(const DebugLogEntry::DataFields &entry, QSet<quint32> &newObjects)
+{
+    if (!m_flightStarts.contains(entry.Flight)) {
+        m_flightStarts.insert(entry.Flight, m_entries.count());
+    }
+    m_entries.append(entry);
+    if (entry.Type != DebugLogEntry::TYPE_UAVOBJECT && entry.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        return;
+    }
+    if (!m_objectIds.contains(entry.ObjectID)) {
+        m_objectIds.insert(entry.ObjectID);
+        newObjects.insert(entry.ObjectID);
+    }
+}
+
+void FlightLogEntryModel::splitEntry(const DebugLogEntry::DataFields &entry, QSet<quint32> &newObjects)
+{
+    appendEntry(entry, newObjects);
+    if (entry.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        return;
+    }
+
+    const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+    const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+    const quint32 header_len = total_len - data_len;
+
+    DebugLogEntry::DataFields fields;
+    quint32 start = entry.Size;
+
+    // cycle until there is space for another object
+    while (start + header_len + 1 < data_len) {
+        memset(&fields, 0xFF, total_len);
+        memcpy(&fields, &entry.Data[start], header_len);
+        // check wether a packed object is found
+        // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+        // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+        quint32 toread = header_len + fields.Size;
+        if (!(toread + start > data_len)) {
+            memcpy(&fields, &entry.Data[start], toread);
+            appendEntry(fields, newObjects);
+        }
+        start += toread;
+    }
+}
+
+UAVDataObject *FlightLogEntryModel::object(int i) const
+{
+    const DebugLogEntry::DataFields &e = m_entries.at(i);
+
+    if (e.Type != DebugLogEntry::TYPE_UAVOBJECT && e.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        return 0;
+    }
+    const quint64 key = ((quint64)e.ObjectID << 16) | e.InstanceID;
+    UAVDataObject *obj = m_objects.value(key);
+    if (!obj) {
+        UAVDataObject *object = qobject_cast<UAVDataObject *>(m_objectManager->getObject(e.ObjectID, e.InstanceID));
+        if (!object) {
+            // instance unknown to the GCS, decode it with the layout of the first one
+            object = qobject_cast<UAVDataObject *>(m_objectManager->getObject(e.ObjectID));
+        }
+        if (!object) {
+            return 0;
+        }
+        obj = object->clone(e.InstanceID);
+        m_objects.insert(key, obj);
+    }
+    obj->unpack(e.Data);
+    return obj;
+}
+
+QString FlightLogEntryModel::logString(int i) const
+{
+    const DebugLogEntry::DataFields &e = m_entries.at(i);
+
+    if (e.Type == DebugLogEntry::TYPE_TEXT) {
+        return QString::fromLatin1((const char *)e.Data, qstrnlen((const char *)e.Data, sizeof(e.Data)));
+    }
+    if (e.Type == DebugLogEntry::TYPE_TRACE) {
+        // 12 bytes per record, exported as a timeline
+        return tr("%1 trace records").arg(e.Size / 12);
+    }
+    if (e.Type == DebugLogEntry::TYPE_FORMATTED) {
+        QStringList messages;
+        QPair<quint32, QString> message;
+        foreach(message, formattedMessages(i)) {
+            messages << message.second;
+        }
+        return messages.join(" | ");
+    }
+    UAVDataObject *obj = object(i);
+    return obj ? obj->toString().replace("\n", " ").replace("\t", " ") : QString();
+}
+
+bool FlightLogEntryModel::loadFormatTable(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    beginResetModel();
+    m_formatTable = file.readAll();
+    endResetModel();
+    return true;
+}
+
+// Each message is the time (quint32 us), the offset of its format (quint16), the number
+// of arguments (quint8), a padding byte and the arguments (quint32), see pios_debuglog.c
+QList<QPair<quint32, QString> > FlightLogEntryModel::formattedMessages(int i) const
+{
+    const DebugLogEntry::DataFields &e = m_entries.at(i);
+    const int size = qMin((int)e.Size, (int)sizeof(e.Data));
+    QList<QPair<quint32, QString> > messages;
+    int pos = 0;
+
+    while (pos + 8 <= size) {
+        quint32 time;
+        quint16 offset;
+        memcpy(&time, &e.Data[pos], sizeof(time));
+        memcpy(&offset, &e.Data[pos + 4], sizeof(offset));
+        const int argc = e.Data[pos + 6];
+        if (pos + 8 + argc * 4 > size) {
+            break;
+        }
+        quint32 args[sizeof(e.Data) / 4];
+        memcpy(args, &e.Data[pos + 8], argc * 4);
+        messages << qMakePair(time, formatMessage(offset, args, argc));
+        pos += 8 + argc * 4;
+    }
+    return messages;
+}
+
+// printf of the raw argument words, floats are passed as their bits
+QString FlightLogEntryModel::formatMessage(quint16 offset, const quint32 *args, int argc) const
+{
+    if (offset >= m_formatTable.size()) {
+        QStringList words;
+        for (int n = 0; n < argc; ++n) {
+            words << QString::number(args[n], 16);
+        }
+        return tr("format %1 (%2)").arg(offset).arg(words.join(" "));
+    }
+
+    const QByteArray format(m_formatTable.constData() + offset);
+    QString message;
+    int arg = 0;
+    for (int pos = 0; pos < format.size(); ++pos) {
+        if (format.at(pos) != '%') {
+            message += QLatin1Char(format.at(pos));
+            continue;
+        }
+        // flags, width and precision are kept, the length modifiers dropped
+        QByteArray spec("%");
+        while (++pos < format.size() && strchr("-+ #0123456789.", format.at(pos))) {
+            spec += format.at(pos);
+        }
+        while (pos < format.size() && strchr("hlLqjzt", format.at(pos))) {
+            ++pos;
+        }
+        if (pos >= format.size()) {
+            break;
+        }
+        const char conversion = format.at(pos);
+        if (conversion == '%') {
+            message += QLatin1Char('%');
+            continue;
+        }
+        const quint32 word = arg < argc ? args[arg++] : 0;
+        spec += conversion;
+        switch (conversion) {
+        case 'd':
+        case 'i':
+            message += QString().sprintf(spec.constData(), (qint32)word);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        {
+            float value;
+            memcpy(&value, &word, sizeof(value));
+            message += QString().sprintf(spec.constData(), (double)value);
+            break;
+        }
+        case 'p':
+            message += QString("0x%1").arg(word, 8, 16, QLatin1Char('0'));
+            break;
+        case 's':
+            // strings are not logged
+            message += "(string)";
+            break;
+        default:
+            // u, x, X, o and c
+            message += QString().sprintf(spec.constData(), word);
+            break;
+        }
+    }
+    return message;
+}
+
+int FlightLogEntryModel::firstRowOfFlight(int flight) const
+{
+    QMap<quint16, int>::const_iterator it = m_flightStarts.constFind(flight);
+
+    if (it == m_flightStarts.constEnd()) {
+        return -1;
+    }
+    if (!isFiltered()) {
+        return it.value();
+    }
+    // rows are in entry order, the first one at or after the flight start
+    QVector<int>::const_iterator row = qLowerBound(m_rows.constBegin(), m_rows.constEnd(), it.value());
+    if (row == m_rows.constEnd() || m_entries.at(*row).Flight != flight) {
+        return -1;
+    }
+    return row - m_rows.constBegin();
+}
+
+void FlightLogEntryModel::setObjectFilter(const QString &name)
+{
+    if (name == m_objectFilter) {
+        return;
+    }
+    UAVObject *obj = name.isEmpty() ? 0 : m_objectManager->getObject(name);
+
+    beginResetModel();
+    m_objectFilter   = obj ? name : QString();
+    m_filterObjectId = obj ? obj->getObjID() : 0;
+    m_rows.clear();
+    if (isFiltered()) {
+        for (int i = 0; i < m_entries.count(); ++i) {
+            if (accepts(m_entries.at(i))) {
+                m_rows.append(i);
+            }
+        }
+    }
+    endResetModel();
+
+    emit objectFilterChanged(m_objectFilter);
+}
+
+bool FlightLogEntryModel::accepts(const DebugLogEntry::DataFields &entry) const
+{
+    return (entry.Type == DebugLogEntry::TYPE_UAVOBJECT || entry.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) &&
+           entry.ObjectID == m_filterObjectId;
+}
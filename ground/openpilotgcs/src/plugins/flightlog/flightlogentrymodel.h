@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogentrymodel.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup FlightLogPlugin Flight Log Plugin
+ * @{
+ * @brief List model of the downloaded log entries, decoded only when displayed
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FLIGHTLOGENTRYMODEL_H
+#define FLIGHTLOGENTRYMODEL_H
+
+#include "uavobjectmanager.h"
+#include "debuglogentry.h"
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QPair>
+
+// The entries are kept as their packed DataFields, one multiple object entry being split
+// in one row per object. The objects are only unpacked for the rows a view asks for.
+class FlightLogEntryModel : public QAbstractListModel {
+    Q_OBJECT Q_PROPERTY(QString objectFilter READ objectFilter WRITE setObjectFilter NOTIFY objectFilterChanged)
+    Q_PROPERTY(QStringList objectNames READ objectNames NOTIFY objectNamesChanged)
+
+public:
+    enum Roles { FlightRole = Qt::UserRole + 1, FlightTimeRole, TypeRole, LogStringRole, ObjectNameRole };
+
+    explicit FlightLogEntryModel(UAVObjectManager *objectManager, QObject *parent = 0);
+    ~FlightLogEntryModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    void clear();
+    // splits the multiple object entries and appends the rows at once
+    void append(const QVector<DebugLogEntry::DataFields> &entries);
+
+    // all the entries, whatever the filter
+    int entryCount() const
+    {
+        return m_entries.count();
+    }
+    const DebugLogEntry::DataFields &entry(int i) const
+    {
+        return m_entries.at(i);
+    }
+    // the object logged by an entry, valid until the next call
+    UAVDataObject *object(int i) const;
+    QString logString(int i) const;
+
+    // format strings of the deferred messages, as extracted from the firmware
+    bool loadFormatTable(const QString &fileName);
+    // the deferred messages of an entry with their flight time
+    QList<QPair<quint32, QString> > formattedMessages(int i) const;
+
+    QString objectFilter() const
+    {
+        return m_objectFilter;
+    }
+    QStringList objectNames() const
+    {
+        return m_objectNames;
+    }
+
+    // first visible row of a flight, -1 if it has none
+    Q_INVOKABLE int firstRowOfFlight(int flight) const;
+
+public slots:
+    // only the entries of that object are listed, all when empty
+    void setObjectFilter(const QString &name);
+
+signals:
+    void objectFilterChanged(const QString &name);
+    void objectNamesChanged();
+
+private:
+    UAVObjectManager *m_objectManager;
+    QVector<DebugLogEntry::DataFields> m_entries;
+    // entry index of every visible row when filtered
+    QVector<int> m_rows;
+    // first entry of every flight
+    QMap<quint16, int> m_flightStarts;
+    QString m_objectFilter;
+    quint32 m_filterObjectId;
+    QStringList m_objectNames;
+    QSet<quint32> m_objectIds;
+    // one unpacked copy per object instance, reused for every row of that instance
+    mutable QHash<quint64, UAVDataObject *> m_objects;
+    QByteArray m_formatTable;
+
+    bool isFiltered() const
+    {
+        return !m_objectFilter.isEmpty();
+    }
+    bool accepts(const DebugLogEntry::DataFields &entry) const;
+    void appendEntry(const DebugLogEntry::DataFields &entry, QSet<quint32> &newObjects);
+    // appends the entry and then every object packed after the first one
+    void splitEntry(const DebugLogEntry::DataFields &entry, QSet<quint32> &newObjects);
+    QString formatMessage(quint16 offset, const quint32 *args, int argc) const;
+};
+
+#endif // FLIGHTLOGENTRYMODEL_H
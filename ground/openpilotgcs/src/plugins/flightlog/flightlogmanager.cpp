@@ -33,11 +33,13 @@
 #include <QXmlStreamReader>
 #include <QMessageBox>
 #include <QDebug>
+#include <string.h>
 
 #include "debuglogcontrol.h"
 #include "uavobjecthelper.h"
 #include "uavtalk/uavtalk.h"
 #include "utils/logfile.h"
+#include "flightlogcolumnexporter.h"
 #include "uavdataobject.h"
 #include <uavobjectutil/uavobjectutilmanager.h>
 
@@ -69,6 +71,16 @@ FlightLogManager::FlightLogManager(QObject *parent) :
     m_flightLogEntry    = DebugLogEntry::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogEntry);
 
+    m_logEntries = new FlightLogEntryModel(m_objectManager, this);
+
+    m_downloader = new FlightLogDownloader(m_objectManager);
+    m_downloader->moveToThread(&m_downloaderThread);
+    connect(&m_downloaderThread, SIGNAL(finished()), m_downloader, SLOT(deleteLater()));
+    connect(m_downloader, SIGNAL(entriesReceived(QVector<DebugLogEntry::DataFields>)),
+            this, SLOT(logEntriesReceived(QVector<DebugLogEntry::DataFields>)));
+    connect(m_downloader, SIGNAL(completed(bool)), this, SLOT(downloadCompleted(bool)));
+    m_downloaderThread.start();
+
     m_flightLogSettings = DebugLogSettings::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogSettings);
 
@@ -88,40 +100,15 @@ FlightLogManager::FlightLogManager(QObject *parent) :
 
 FlightLogManager::~FlightLogManager()
 {
-    while (!m_logEntries.isEmpty()) {
-        delete m_logEntries.takeFirst();
-    }
+    m_downloader->cancel();
+    m_downloaderThread.quit();
+    m_downloaderThread.wait();
+
     while (!m_uavoEntries.isEmpty()) {
         delete m_uavoEntries.takeFirst();
     }
 }
 
-void addLogEntries(QQmlListProperty<ExtendedDebugLogEntry> *list, ExtendedDebugLogEntry *entry)
-{
-    Q_UNUSED(list);
-    Q_UNUSED(entry);
-}
-
-int countLogEntries(QQmlListProperty<ExtendedDebugLogEntry> *list)
-{
-    return static_cast< QList<ExtendedDebugLogEntry *> *>(list->data)->size();
-}
-
-ExtendedDebugLogEntry *logEntryAt(QQmlListProperty<ExtendedDebugLogEntry> *list, int index)
-{
-    return static_cast< QList<ExtendedDebugLogEntry *> *>(list->data)->at(index);
-}
-
-void clearLogEntries(QQmlListProperty<ExtendedDebugLogEntry> *list)
-{
-    return static_cast< QList<ExtendedDebugLogEntry *> *>(list->data)->clear();
-}
-
-QQmlListProperty<ExtendedDebugLogEntry> FlightLogManager::logEntries()
-{
-    return QQmlListProperty<ExtendedDebugLogEntry>(this, &m_logEntries, &addLogEntries, &countLogEntries, &logEntryAt, &clearLogEntries);
-}
-
 void addUAVOEntries(QQmlListProperty<UAVOLogSettingsWrapper> *list, UAVOLogSettingsWrapper *entry)
 {
     Q_UNUSED(list);
@@ -175,24 +162,37 @@ void FlightLogManager::clearAllLogs()
 
 void FlightLogManager::clearLogList()
 {
-    QList<ExtendedDebugLogEntry *> tmpList(m_logEntries);
-    m_logEntries.clear();
+    m_logEntries->clear();
 
     emit logEntriesChanged();
     setDisableExport(true);
+}
+
+void FlightLogManager::retrieveLogs(int flightToRetrieve)
+{
+    download(flightToRetrieve, QString());
+}
+
+void FlightLogManager::downloadLogsToOPL(int flightToRetrieve)
+{
+    QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
+    QString fileName  = QFileDialog::getSaveFileName(NULL, tr("Save Log Entries"), QDir::homePath(), oplFilter);
 
-    while (!tmpList.isEmpty()) {
-        delete tmpList.takeFirst();
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!fileName.endsWith(".opl")) {
+        fileName.append(".opl");
     }
+    // the downloader adds the flight number to the name
+    fileName.replace(QString(".opl"), QString("%1.opl"));
+    download(flightToRetrieve, fileName);
 }
 
-void FlightLogManager::retrieveLogs(int flightToRetrieve)
+void FlightLogManager::download(int flightToRetrieve, QString fileName)
 {
     setDisableControls(true);
-    QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
 
     clearLogList();
 
@@ -200,68 +200,24 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
     int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
 
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
-    for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int slot     = 0;
-        while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(slot);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
+    // the entries are streamed in the downloader thread, downloadCompleted() is called when done
+    QMetaObject::invokeMethod(m_downloader, "download", Qt::QueuedConnection,
+                              Q_ARG(int, startFlight), Q_ARG(int, endFlight),
+                              Q_ARG(QString, fileName), Q_ARG(bool, m_adjustExportedTimestamps));
+}
 
-                    // Increment to get next entry from flight side
-                    slot++;
-                } else {
-                    // We are done, not more entries on this flight
-                    gotLast = true;
-                }
-            } else {
-                // We failed for some reason
-                break;
-            }
-            if (m_cancelDownload) {
-                break;
-            }
-        }
-        if (m_cancelDownload) {
-            break;
-        }
+void FlightLogManager::logEntriesReceived(QVector<DebugLogEntry::DataFields> entries)
+{
+    if (m_cancelDownload) {
+        return;
     }
+    m_logEntries->append(entries);
+    emit logEntriesChanged();
+}
+
+void FlightLogManager::downloadCompleted(bool success)
+{
+    Q_UNUSED(success);
 
     if (m_cancelDownload) {
         clearLogList();
@@ -269,9 +225,8 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     }
 
     emit logEntriesChanged();
-    setDisableExport(m_logEntries.count() == 0);
+    setDisableExport(m_logEntries->entryCount() == 0);
 
-    QApplication::restoreOverrideCursor();
     setDisableControls(false);
 }
 
@@ -285,13 +240,13 @@ void FlightLogManager::exportToOPL(QString fileName)
     int currentFlight = 0;
     quint32 adjustedBaseTime = 0;
     // Continue until all entries are exported
-    while (currentEntry < m_logEntries.count()) {
+    while (currentEntry < m_logEntries->entryCount()) {
         if (m_adjustExportedTimestamps) {
-            adjustedBaseTime = m_logEntries[currentEntry]->getFlightTime();
+            adjustedBaseTime = m_logEntries->entry(currentEntry).FlightTime;
         }
 
         // Get current flight
-        currentFlight = m_logEntries[currentEntry]->getFlight();
+        currentFlight = m_logEntries->entry(currentEntry).Flight;
 
         LogFile logFile;
         logFile.useProvidedTimeStamp(true);
@@ -302,17 +257,17 @@ void FlightLogManager::exportToOPL(QString fileName)
         UAVTalk uavTalk(&logFile, m_objectManager);
 
         // Export entries until no more available or flight changes
-        while (currentEntry < m_logEntries.count() && m_logEntries[currentEntry]->getFlight() == currentFlight) {
-            ExtendedDebugLogEntry *entry = m_logEntries[currentEntry];
+        while (currentEntry < m_logEntries->entryCount() && m_logEntries->entry(currentEntry).Flight == currentFlight) {
+            const DebugLogEntry::DataFields &entry = m_logEntries->entry(currentEntry);
+            UAVDataObject *object = m_logEntries->object(currentEntry);
 
             // Only log uavobjects
-            if (entry->getType() == ExtendedDebugLogEntry::TYPE_UAVOBJECT || entry->getType() == ExtendedDebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            if (object) {
                 // Set timestamp that should be logged for this entry
-                logFile.setNextTimeStamp(entry->getFlightTime() - adjustedBaseTime);
+                logFile.setNextTimeStamp(entry.FlightTime - adjustedBaseTime);
 
                 // Use UAVTalk to log complete message to file
-                uavTalk.sendObject(entry->uavObject(), false, false);
-                qDebug() << entry->getFlightTime() - adjustedBaseTime << "=" << entry->toStringBrief();
+                uavTalk.sendObject(object, false, false);
             }
             currentEntry++;
         }
@@ -330,12 +285,29 @@ void FlightLogManager::exportToCSV(QString fileName)
         quint32 baseTime = 0;
         quint32 currentFlight = 0;
         csvStream << "Flight" << '\t' << "Flight Time" << '\t' << "Entry" << '\t' << "Data" << '\n';
-        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
-            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
-                currentFlight = entry->getFlight();
-                baseTime = entry->getFlightTime();
+        for (int i = 0; i < m_logEntries->entryCount(); ++i) {
+            const DebugLogEntry::DataFields &entry = m_logEntries->entry(i);
+            if (m_adjustExportedTimestamps && entry.Flight != currentFlight) {
+                currentFlight = entry.Flight;
+                baseTime = entry.FlightTime;
             }
-            entry->toCSV(&csvStream, baseTime);
+            if (entry.Type == DebugLogEntry::TYPE_FORMATTED) {
+                // one line per message, at its own time
+                QPair<quint32, QString> message;
+                foreach(message, m_logEntries->formattedMessages(i)) {
+                    csvStream << QString::number(entry.Flight + 1) << '\t' << QString::number(message.first - baseTime) << '\t'
+                              << QString::number(entry.Entry) << '\t' << message.second << '\n';
+                }
+                continue;
+            }
+            QString data;
+            if (entry.Type == DebugLogEntry::TYPE_TEXT) {
+                data = m_logEntries->logString(i);
+            } else if (UAVDataObject *object = m_logEntries->object(i)) {
+                data = object->toString().replace("\n", "").replace("\t", "");
+            }
+            csvStream << QString::number(entry.Flight + 1) << '\t' << QString::number(entry.FlightTime - baseTime) << '\t'
+                      << QString::number(entry.Entry) << '\t' << data << '\n';
         }
         csvStream.flush();
         csvFile.flush();
@@ -358,12 +330,33 @@ void FlightLogManager::exportToXML(QString fileName)
 
         quint32 baseTime = 0;
         quint32 currentFlight = 0;
-        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
-            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
-                currentFlight = entry->getFlight();
-                baseTime = entry->getFlightTime();
+        for (int i = 0; i < m_logEntries->entryCount(); ++i) {
+            const DebugLogEntry::DataFields &entry = m_logEntries->entry(i);
+            if (m_adjustExportedTimestamps && entry.Flight != currentFlight) {
+                currentFlight = entry.Flight;
+                baseTime = entry.FlightTime;
+            }
+            xmlWriter.writeStartElement("entry");
+            xmlWriter.writeAttribute("flight", QString::number(entry.Flight + 1));
+            xmlWriter.writeAttribute("flighttime", QString::number(entry.FlightTime - baseTime));
+            xmlWriter.writeAttribute("entry", QString::number(entry.Entry));
+            if (entry.Type == DebugLogEntry::TYPE_TEXT) {
+                xmlWriter.writeAttribute("type", "text");
+                xmlWriter.writeTextElement("message", m_logEntries->logString(i));
+            } else if (entry.Type == DebugLogEntry::TYPE_FORMATTED) {
+                xmlWriter.writeAttribute("type", "text");
+                QPair<quint32, QString> message;
+                foreach(message, m_logEntries->formattedMessages(i)) {
+                    xmlWriter.writeStartElement("message");
+                    xmlWriter.writeAttribute("flighttime", QString::number(message.first - baseTime));
+                    xmlWriter.writeCharacters(message.second);
+                    xmlWriter.writeEndElement();
+                }
+            } else if (UAVDataObject *object = m_logEntries->object(i)) {
+                xmlWriter.writeAttribute("type", "uavobject");
+                object->toXML(&xmlWriter);
             }
-            entry->toXML(&xmlWriter, baseTime);
+            xmlWriter.writeEndElement(); // entry
         }
         xmlWriter.writeEndElement();
         xmlWriter.writeEndDocument();
@@ -372,9 +365,122 @@ void FlightLogManager::exportToXML(QString fileName)
     }
 }
 
+// Record saved by the flight side trace buffer, see pios_trace.h
+struct TraceRecord {
+    quint32 time;
+    quint32 data;
+    quint16 sequence;
+    quint8  category;
+    quint8  event;
+};
+
+enum TraceCategory { TRACE_TASK = 0, TRACE_ISR = 1, TRACE_CALLBACK = 2, TRACE_UAVOBJ = 3 };
+enum TraceEvent { TRACE_INSTANT = 0, TRACE_BEGIN = 1, TRACE_END = 2 };
+
+QStringList FlightLogManager::elementNames(QString objectName, QString fieldName)
+{
+    UAVObject *object = m_objectManager->getObject(objectName);
+    UAVObjectField *field = object ? object->getField(fieldName) : 0;
+
+    return field ? field->getElementNames() : QStringList();
+}
+
+// Exports the trace entries in the trace event format of the Chrome and Perfetto
+// timeline viewers, with one process per flight and one thread per category
+void FlightLogManager::exportToTrace(QString fileName)
+{
+    QFile traceFile(fileName);
+
+    if (!traceFile.open(QFile::WriteOnly | QFile::Truncate)) {
+        return;
+    }
+
+    const QStringList taskNames     = elementNames("TaskInfo", "Running");
+    const QStringList callbackNames = elementNames("CallbackInfo", "Running");
+    const char *threadNames[] = { "Tasks", "Interrupts", "Callbacks", "UAVObjects" };
+
+    QTextStream traceStream(&traceFile);
+    QStringList events;
+    quint32 baseTime = 0;
+    int currentFlight = -1;
+    // the task switched in last, and when
+    quint32 taskId    = 0;
+    quint32 taskStart = 0;
+    bool taskRunning  = false;
+
+    for (int i = 0; i < m_logEntries->entryCount(); ++i) {
+        const DebugLogEntry::DataFields &entry = m_logEntries->entry(i);
+        if (entry.Type != DebugLogEntry::TYPE_TRACE) {
+            continue;
+        }
+        const int pid = entry.Flight + 1;
+        if (entry.Flight != currentFlight) {
+            currentFlight = entry.Flight;
+            baseTime    = m_adjustExportedTimestamps ? entry.FlightTime : 0;
+            taskRunning = false;
+            events << QString("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%1,\"args\":{\"name\":\"Flight %1\"}}").arg(pid);
+            for (int t = 0; t < 4; ++t) {
+                events << QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":\"%3\"}}")
+                    .arg(pid).arg(t).arg(threadNames[t]);
+            }
+        }
+
+        const int count = qMin((int)entry.Size, (int)sizeof(entry.Data)) / (int)sizeof(TraceRecord);
+        for (int n = 0; n < count; ++n) {
+            TraceRecord record;
+            memcpy(&record, &entry.Data[n * sizeof(TraceRecord)], sizeof(TraceRecord));
+            const quint32 ts = record.time - baseTime;
+
+            switch (record.category) {
+            case TRACE_TASK:
+                // a task runs until the next one is switched in
+                if (taskRunning) {
+                    QString name = taskId < (quint32)taskNames.count() ? taskNames.at(taskId) : tr("Other");
+                    events << QString("{\"name\":\"%1\",\"ph\":\"X\",\"pid\":%2,\"tid\":%3,\"ts\":%4,\"dur\":%5}")
+                        .arg(name).arg(pid).arg(TRACE_TASK).arg(taskStart - baseTime).arg(record.time - taskStart);
+                }
+                taskId      = record.data;
+                taskStart   = record.time;
+                taskRunning = true;
+                break;
+
+            case TRACE_ISR:
+            case TRACE_CALLBACK:
+            {
+                QString name;
+                if (record.category == TRACE_ISR) {
+                    name = QString("EXTI %1").arg(record.data);
+                } else {
+                    name = record.data < (quint32)callbackNames.count() ? callbackNames.at(record.data) : tr("Callback");
+                }
+                events << QString("{\"name\":\"%1\",\"ph\":\"%2\",\"pid\":%3,\"tid\":%4,\"ts\":%5}")
+                    .arg(name).arg(record.event == TRACE_BEGIN ? "B" : "E").arg(pid).arg(record.category).arg(ts);
+                break;
+            }
+
+            case TRACE_UAVOBJ:
+            {
+                UAVObject *object = m_objectManager->getObject(record.data);
+                QString name = object ? object->getName() : QString("0x%1").arg(record.data, 8, 16, QChar('0'));
+                events << QString("{\"name\":\"%1\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%2,\"tid\":%3,\"ts\":%4}")
+                    .arg(name).arg(pid).arg(TRACE_UAVOBJ).arg(ts);
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+    }
+
+    traceStream << "{\"traceEvents\":[\n" << events.join(",\n") << "\n]}\n";
+    traceStream.flush();
+    traceFile.close();
+}
+
 void FlightLogManager::exportLogs()
 {
-    if (m_logEntries.isEmpty()) {
+    if (m_logEntries->entryCount() == 0) {
         return;
     }
 
@@ -384,11 +490,12 @@ void FlightLogManager::exportLogs()
     QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
     QString csvFilter = tr("Text file %1").arg("(*.csv)");
     QString xmlFilter = tr("XML file %1").arg("(*.xml)");
+    QString traceFilter = tr("Trace timeline file %1").arg("(*.json)");
 
     QString selectedFilter = csvFilter;
 
     QString fileName = QFileDialog::getSaveFileName(NULL, tr("Save Log Entries"), QDir::homePath(),
-                                                    QString("%1;;%2;;%3").arg(oplFilter, csvFilter, xmlFilter), &selectedFilter);
+                                                    QString("%1;;%2;;%3;;%4").arg(oplFilter, csvFilter, xmlFilter, traceFilter), &selectedFilter);
     if (!fileName.isEmpty()) {
         if (selectedFilter == oplFilter) {
             if (!fileName.endsWith(".opl")) {
@@ -405,6 +512,11 @@ void FlightLogManager::exportLogs()
                 fileName.append(".xml");
             }
             exportToXML(fileName);
+        } else if (selectedFilter == traceFilter) {
+            if (!fileName.endsWith(".json")) {
+                fileName.append(".json");
+            }
+            exportToTrace(fileName);
         }
     }
 
@@ -415,6 +527,52 @@ void FlightLogManager::exportLogs()
 void FlightLogManager::cancelExportLogs()
 {
     m_cancelDownload = true;
+    m_downloader->cancel();
+}
+
+void FlightLogManager::exportLogToColumns()
+{
+    QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
+    QString fileName  = QFileDialog::getOpenFileName(NULL, tr("Convert Log File"), QDir::homePath(), oplFilter);
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    setDisableControls(true);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    // log.opl is written to the log_columns directory next to it
+    QString dirName = fileName;
+    if (dirName.endsWith(".opl")) {
+        dirName.chop(4);
+    }
+    dirName.append("_columns");
+
+    FlightLogColumnExporter exporter(m_objectManager);
+    bool success = exporter.exportLog(fileName, dirName);
+
+    QApplication::restoreOverrideCursor();
+    setDisableControls(false);
+
+    if (!success) {
+        QMessageBox::warning(NULL, tr("Log conversion failed."), exporter.errorString(), QMessageBox::Ok);
+    }
+}
+
+// The deferred messages only log the offset of their format, the table is
+// extracted from the firmware by its "formats" make target
+void FlightLogManager::loadFormatTable()
+{
+    QString formatsFilter = tr("Debug log formats %1").arg("(*.debuglogformats)");
+    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Load Message Formats"), QDir::homePath(), formatsFilter);
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!m_logEntries->loadFormatTable(fileName)) {
+        QMessageBox::warning(NULL, tr("Loading the formats failed."), tr("Could not read %1.").arg(fileName), QMessageBox::Ok);
+    }
 }
 
 void FlightLogManager::loadSettings()
@@ -625,70 +783,6 @@ bool FlightLogManager::updateLogWrapper(QString name, int level, int period)
     return false;
 }
 
-ExtendedDebugLogEntry::ExtendedDebugLogEntry() : DebugLogEntry(),
-    m_object(0)
-{}
-
-ExtendedDebugLogEntry::~ExtendedDebugLogEntry()
-{
-    if (m_object) {
-        delete m_object;
-        m_object = 0;
-    }
-}
-
-QString ExtendedDebugLogEntry::getLogString()
-{
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        return QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        return m_object->toString().replace("\n", " ").replace("\t", " ");
-    } else {
-        return "";
-    }
-}
-
-void ExtendedDebugLogEntry::toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime)
-{
-    xmlWriter->writeStartElement("entry");
-    xmlWriter->writeAttribute("flight", QString::number(getFlight() + 1));
-    xmlWriter->writeAttribute("flighttime", QString::number(getFlightTime() - baseTime));
-    xmlWriter->writeAttribute("entry", QString::number(getEntry()));
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        xmlWriter->writeAttribute("type", "text");
-        xmlWriter->writeTextElement("message", QString((const char *)getData().Data));
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        xmlWriter->writeAttribute("type", "uavobject");
-        m_object->toXML(xmlWriter);
-    }
-    xmlWriter->writeEndElement(); // entry
-}
-
-void ExtendedDebugLogEntry::toCSV(QTextStream *csvStream, quint32 baseTime)
-{
-    QString data;
-
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        data = QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        data = m_object->toString().replace("\n", "").replace("\t", "");
-    }
-    *csvStream << QString::number(getFlight() + 1) << '\t' << QString::number(getFlightTime() - baseTime) << '\t' << QString::number(getEntry()) << '\t' << data << '\n';
-}
-
-void ExtendedDebugLogEntry::setData(const DebugLogEntry::DataFields &data, UAVObjectManager *objectManager)
-{
-    DebugLogEntry::setData(data);
-
-    if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        UAVDataObject *object = (UAVDataObject *)objectManager->getObject(getObjectID(), getInstanceID());
-        Q_ASSERT(object);
-        m_object = object->clone(getInstanceID());
-        m_object->unpack(getData().Data);
-    }
-}
-
-
 UAVOLogSettingsWrapper::UAVOLogSettingsWrapper() : QObject()
 {}
 
@@ -35,6 +35,7 @@
 #include <QSemaphore>
 #include <QXmlStreamWriter>
 #include <QTextStream>
+#include <QThread>
 
 #include "uavobjectmanager.h"
 #include "uavobjectutilmanager.h"
@@ -44,6 +45,8 @@
 #include "debuglogcontrol.h"
 #include "objectpersistence.h"
 #include "uavtalk/telemetrymanager.h"
+#include "flightlogdownloader.h"
+#include "flightlogentrymodel.h"
 
 class UAVOLogSettingsWrapper : public QObject {
     Q_OBJECT Q_PROPERTY(UAVDataObject *object READ object NOTIFY objectChanged)
@@ -137,41 +140,11 @@ private:
     bool m_dirty;
 };
 
-class ExtendedDebugLogEntry : public DebugLogEntry {
-    Q_OBJECT Q_PROPERTY(QString LogString READ getLogString WRITE setLogString NOTIFY LogStringUpdated)
-
-public:
-    explicit ExtendedDebugLogEntry();
-    ~ExtendedDebugLogEntry();
-
-    QString getLogString();
-    void toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime);
-    void toCSV(QTextStream *csvStream, quint32 baseTime);
-    UAVDataObject *uavObject()
-    {
-        return m_object;
-    }
-
-    void setData(const DataFields & data, UAVObjectManager *objectManager);
-
-public slots:
-    void setLogString(QString arg)
-    {
-        Q_UNUSED(arg);
-    }
-
-signals:
-    void LogStringUpdated(QString arg);
-
-private:
-    UAVDataObject *m_object;
-};
-
 class FlightLogManager : public QObject {
     Q_OBJECT Q_PROPERTY(DebugLogStatus *flightLogStatus READ flightLogStatus)
     Q_PROPERTY(DebugLogControl * flightLogControl READ flightLogControl)
     Q_PROPERTY(DebugLogSettings * flightLogSettings READ flightLogSettings)
-    Q_PROPERTY(QQmlListProperty<ExtendedDebugLogEntry> logEntries READ logEntries NOTIFY logEntriesChanged)
+    Q_PROPERTY(FlightLogEntryModel * logEntries READ logEntries CONSTANT)
     Q_PROPERTY(QStringList flightEntries READ flightEntries NOTIFY flightEntriesChanged)
     Q_PROPERTY(bool disableControls READ disableControls WRITE setDisableControls NOTIFY disableControlsChanged)
     Q_PROPERTY(bool disableExport READ disableExport WRITE setDisableExport NOTIFY disableExportChanged)
@@ -188,7 +161,10 @@ public:
     explicit FlightLogManager(QObject *parent = 0);
     ~FlightLogManager();
 
-    QQmlListProperty<ExtendedDebugLogEntry> logEntries();
+    FlightLogEntryModel *logEntries() const
+    {
+        return m_logEntries;
+    }
     QQmlListProperty<UAVOLogSettingsWrapper> uavoEntries();
 
     QStringList flightEntries();
@@ -246,7 +222,7 @@ public:
     }
     int logEntriesCount()
     {
-        return m_logEntries.count();
+        return m_logEntries->entryCount();
     }
 signals:
     void logEntriesChanged();
@@ -264,8 +240,11 @@ signals:
 public slots:
     void clearAllLogs();
     void retrieveLogs(int flightToRetrieve = -1);
+    void downloadLogsToOPL(int flightToRetrieve = -1);
     void exportLogs();
     void cancelExportLogs();
+    void exportLogToColumns();
+    void loadFormatTable();
     void loadSettings();
     void saveSettings();
     void resetSettings(bool clear);
@@ -319,6 +298,8 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void logEntriesReceived(QVector<DebugLogEntry::DataFields> entries);
+    void downloadCompleted(bool success);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -330,7 +311,7 @@ private:
     DebugLogSettings *m_flightLogSettings;
     ObjectPersistence *m_objectPersistence;
 
-    QList<ExtendedDebugLogEntry *> m_logEntries;
+    FlightLogEntryModel *m_logEntries;
     QStringList m_flightEntries;
     QStringList m_logSettings;
     QStringList m_logStatuses;
@@ -338,9 +319,15 @@ private:
     QList<UAVOLogSettingsWrapper *> m_uavoEntries;
     QHash<QString, UAVOLogSettingsWrapper *> m_uavoEntriesHash;
 
+    QThread m_downloaderThread;
+    FlightLogDownloader *m_downloader;
+
+    void download(int flightToRetrieve, QString fileName);
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
+    void exportToTrace(QString fileName);
+    QStringList elementNames(QString objectName, QString fieldName);
 
     static const int UAVTALK_TIMEOUT = 4000;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
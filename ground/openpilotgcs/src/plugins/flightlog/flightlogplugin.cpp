@@ -73,7 +73,7 @@ bool FlightLogPlugin::initialize(const QStringList & args, QString *errMsg)
 void FlightLogPlugin::ShowLogManagementDialog()
 {
     if (!m_logDialog) {
-        qmlRegisterType<ExtendedDebugLogEntry>("org.openpilot", 1, 0, "DebugLogEntry");
+        qmlRegisterType<FlightLogEntryModel>();
         qmlRegisterType<UAVOLogSettingsWrapper>("org.openpilot", 1, 0, "UAVOLogSettingsWrapper");
         FlightLogManager *flightLogManager = new FlightLogManager();
         m_logDialog = new QQuickView();
@@ -32,12 +32,14 @@
 #include "uavobject.h"
 #include <QDebug>
 
-#define JOYSTICK_UPDATE_RATE 50
+// joystick latency is logged every this many updates
+#define LATENCY_REPORT_COUNT 250
 
 GCSControlGadget::GCSControlGadget(QString classId, GCSControlGadgetWidget *widget, QWidget *parent, QObject *plugin) :
     IUAVGadget(classId, parent),
     m_widget(widget)
 {
+    manualControlCommand = getManualControlCommand();
     connect(getManualControlCommand(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(manualControlCommandUpdated(UAVObject *)));
     connect(widget, SIGNAL(sticksChanged(double, double, double, double)), this, SLOT(sticksChangedLocally(double, double, double, double)));
     connect(this, SIGNAL(sticksChangedRemotely(double, double, double, double)), widget, SLOT(updateSticks(double, double, double, double)));
@@ -48,11 +50,19 @@ GCSControlGadget::GCSControlGadget(QString classId, GCSControlGadgetWidget *widg
 
     connect(control_sock, SIGNAL(readyRead()), this, SLOT(readUDPCommand()));
 
-    joystickTime.start();
+    sticksPending     = false;
+    pendingSampleTime = 0;
+    measureLatency    = false;
+    latencySum   = 0;
+    latencyMax   = 0;
+    latencyCount = 0;
+    sendTimer.setTimerType(Qt::PreciseTimer);
+    connect(&sendTimer, SIGNAL(timeout()), this, SLOT(sendSticks()));
+
     GCSControlPlugin *pl = dynamic_cast<GCSControlPlugin *>(plugin);
     connect(pl->sdlGamepad, SIGNAL(gamepads(quint8)), this, SLOT(gamepads(quint8)));
     connect(pl->sdlGamepad, SIGNAL(buttonState(ButtonNumber, bool)), this, SLOT(buttonState(ButtonNumber, bool)));
-    connect(pl->sdlGamepad, SIGNAL(axesValues(QListInt16)), this, SLOT(axesValues(QListInt16)));
+    connect(pl->sdlGamepad, SIGNAL(axesValues(QListInt16, qint64)), this, SLOT(axesValues(QListInt16, qint64)));
 }
 
 GCSControlGadget::~GCSControlGadget()
@@ -76,6 +86,9 @@ void GCSControlGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 
     controlsMode = GCSControlConfig->getControlsMode();
 
+    measureLatency = GCSControlConfig->getMeasureLatency();
+    sendTimer.start(qMax(GCSControlConfig->getUpdateRate(), 1));
+
     int i;
     for (i = 0; i < 8; i++) {
         buttonSettings[i].ActionID   = GCSControlConfig->getbuttonSettings(i).ActionID;
@@ -140,11 +153,10 @@ void GCSControlGadget::manualControlCommandUpdated(UAVObject *manualControlComma
  */
 void GCSControlGadget::sticksChangedLocally(double leftX, double leftY, double rightX, double rightY)
 {
-    ManualControlCommand *manualControlCommand = getManualControlCommand();
-    double oldRoll     = manualControlCommand->getField("Roll")->getDouble();
-    double oldPitch    = manualControlCommand->getField("Pitch")->getDouble();
-    double oldYaw      = manualControlCommand->getField("Yaw")->getDouble();
-    double oldThrottle = manualControlCommand->getField("Throttle")->getDouble();
+    // if we are not in local gcs control mode, ignore the joystick input
+    if (((GCSControlGadgetWidget *)m_widget)->getGCSControl() == false || ((GCSControlGadgetWidget *)m_widget)->getUDPControl()) {
+        return;
+    }
 
     double newRoll     = 0.0;
     double newPitch    = 0.0;
@@ -203,12 +215,6 @@ void GCSControlGadget::sticksChangedLocally(double leftX, double leftY, double r
         }
     }
 
-    // if we are not in local gcs control mode, ignore the joystick input
-    if (((GCSControlGadgetWidget *)m_widget)->getGCSControl() == false || ((GCSControlGadgetWidget *)m_widget)->getUDPControl()) {
-        return;
-    }
-
-    // if (newThrottle != oldThrottle) {
     // convert widget's throttle stick range (-1..+1) to ManualControlCommand.Throttle range (0..1)
     newThrottle = (newThrottle + 1.0) / 2.0;
 
@@ -216,28 +222,56 @@ void GCSControlGadget::sticksChangedLocally(double leftX, double leftY, double r
     if (newThrottle <= 0.01) {
         newThrottle = -1;
     }
-    // }
 
-
-    if ((newThrottle != oldThrottle) || (newPitch != oldPitch) || (newYaw != oldYaw) || (newRoll != oldRoll)) {
+    // All the sticks go out in a single update of the object
+    ManualControlCommand::DataFields data = manualControlCommand->getData();
+    if (((float)newThrottle != data.Throttle) || ((float)newPitch != data.Pitch) || ((float)newYaw != data.Yaw) || ((float)newRoll != data.Roll)) {
         if (buttonRollControl == 0) {
-            manualControlCommand->getField("Roll")->setDouble(newRoll);
+            data.Roll = newRoll;
         }
         if (buttonPitchControl == 0) {
-            manualControlCommand->getField("Pitch")->setDouble(newPitch);
+            data.Pitch = newPitch;
         }
         if (buttonYawControl == 0) {
-            manualControlCommand->getField("Yaw")->setDouble(newYaw);
+            data.Yaw = newYaw;
         }
         if (buttonThrottleControl == 0) {
-            manualControlCommand->getField("Throttle")->setDouble(newThrottle);
-            manualControlCommand->getField("Thrust")->setDouble(newThrottle);
+            data.Throttle = newThrottle;
+            data.Thrust   = newThrottle;
         }
-        manualControlCommand->getField("Connected")->setValue("True");
+        data.Connected = ManualControlCommand::CONNECTED_TRUE;
+        manualControlCommand->setData(data);
         manualControlCommand->updated();
     }
 }
 
+/**
+   Send the latest joystick sticks, at most once per update period
+ */
+void GCSControlGadget::sendSticks()
+{
+    if (!sticksPending) {
+        return;
+    }
+    sticksPending = false;
+    sticksChangedLocally(pendingSticks[0], pendingSticks[1], pendingSticks[2], pendingSticks[3]);
+
+    if (measureLatency) {
+        QElapsedTimer now;
+        now.start();
+        qint64 latency = now.msecsSinceReference() - pendingSampleTime;
+        latencySum += latency;
+        latencyMax  = qMax(latencyMax, latency);
+        if (++latencyCount >= LATENCY_REPORT_COUNT) {
+            qDebug() << "GCSControl: joystick to telemetry latency average" << (double)latencySum / latencyCount
+                     << "ms, max" << latencyMax << "ms";
+            latencySum   = 0;
+            latencyMax   = 0;
+            latencyCount = 0;
+        }
+    }
+}
+
 void GCSControlGadget::gamepads(quint8 count)
 {
     Q_UNUSED(count);
@@ -420,7 +454,7 @@ void GCSControlGadget::buttonState(ButtonNumber number, bool pressed)
     // buttonSettings[number].Amount
 }
 
-void GCSControlGadget::axesValues(QListInt16 values)
+void GCSControlGadget::axesValues(QListInt16 values, qint64 sampleTime)
 {
     int chMax = values.length();
 
@@ -458,28 +492,50 @@ void GCSControlGadget::axesValues(QListInt16 values)
     }
 
 
-    if (joystickTime.elapsed() > JOYSTICK_UPDATE_RATE) {
-        joystickTime.restart();
-        // Remap RPYT to left X/Y and right X/Y depending on mode
-        // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
-        // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
-        // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
-        // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
-        switch (controlsMode) {
-        case 1:
-            sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
-            break;
-        case 2:
-            sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
-            break;
-        case 3:
-            sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
-            break;
-        case 4:
-            sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
-            break;
-        }
+    // Remap RPYT to left X/Y and right X/Y depending on mode
+    // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
+    // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
+    // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
+    // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
+    double sticks[4];
+    switch (controlsMode) {
+    case 1:
+        sticks[0] = yValue;
+        sticks[1] = -pValue;
+        sticks[2] = rValue;
+        sticks[3] = -tValue;
+        break;
+    case 2:
+        sticks[0] = yValue;
+        sticks[1] = -tValue;
+        sticks[2] = rValue;
+        sticks[3] = -pValue;
+        break;
+    case 3:
+        sticks[0] = rValue;
+        sticks[1] = -pValue;
+        sticks[2] = yValue;
+        sticks[3] = -tValue;
+        break;
+    case 4:
+        sticks[0] = rValue;
+        sticks[1] = -tValue;
+        sticks[2] = yValue;
+        sticks[3] = -pValue;
+        break;
+    default:
+        return;
+    }
+
+    // Only the latest sticks are kept, they are sent by sendSticks() at the
+    // update rate. The latency is counted from the oldest unsent sample.
+    if (!sticksPending) {
+        pendingSampleTime = sampleTime;
+    }
+    for (int i = 0; i < 4; i++) {
+        pendingSticks[i] = sticks[i] / max;
     }
+    sticksPending = true;
 }
 
 
@@ -32,7 +32,8 @@
 #include "manualcontrolcommand.h"
 #include "gcscontrolgadgetconfiguration.h"
 #include "sdlgamepad/sdlgamepad.h"
-#include <QTime>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "gcscontrolplugin.h"
 #include <QUdpSocket>
 #include <QHostAddress>
@@ -71,7 +72,16 @@ public:
 private:
     ManualControlCommand *getManualControlCommand();
     double constrain(double value);
-    QTime joystickTime;
+    ManualControlCommand *manualControlCommand;
+    // latest joystick sticks not sent yet, left X/Y and right X/Y
+    double pendingSticks[4];
+    bool sticksPending;
+    qint64 pendingSampleTime;
+    QTimer sendTimer;
+    bool measureLatency;
+    qint64 latencySum;
+    qint64 latencyMax;
+    int latencyCount;
     QWidget *m_widget;
     QList<int> m_context;
     UAVObject::Metadata mccInitialData;
@@ -98,7 +108,8 @@ protected slots:
     // signals from joystick
     void gamepads(quint8 count);
     void buttonState(ButtonNumber number, bool pressed);
-    void axesValues(QListInt16 values);
+    void axesValues(QListInt16 values, qint64 sampleTime);
+    void sendSticks();
 };
 
 
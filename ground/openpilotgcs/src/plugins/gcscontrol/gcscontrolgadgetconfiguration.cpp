@@ -36,7 +36,9 @@ GCSControlGadgetConfiguration::GCSControlGadgetConfiguration(QString classId, QS
     rollChannel(-1),
     pitchChannel(-1),
     yawChannel(-1),
-    throttleChannel(-1)
+    throttleChannel(-1),
+    updateRate(GCSCONTROL_DEFAULT_UPDATE_RATE),
+    measureLatency(false)
 {
     int i;
 
@@ -57,6 +59,9 @@ GCSControlGadgetConfiguration::GCSControlGadgetConfiguration(QString classId, QS
         udp_port = qSettings->value("controlPortUDP").toUInt();
         udp_host = QHostAddress(qSettings->value("controlHostUDP").toString());
 
+        updateRate     = qSettings->value("updateRate", GCSCONTROL_DEFAULT_UPDATE_RATE).toInt();
+        measureLatency = qSettings->value("measureLatency", false).toBool();
+
         int i;
         for (i = 0; i < 8; i++) {
             buttonSettings[i].ActionID   = qSettings->value(QString().sprintf("button%dAction", i)).toInt();
@@ -124,6 +129,9 @@ IUAVGadgetConfiguration *GCSControlGadgetConfiguration::clone()
     m->udp_host = udp_host;
     m->udp_port = udp_port;
 
+    m->updateRate     = updateRate;
+    m->measureLatency = measureLatency;
+
     int i;
     for (i = 0; i < 8; i++) {
         m->buttonSettings[i].ActionID   = buttonSettings[i].ActionID;
@@ -151,6 +159,9 @@ void GCSControlGadgetConfiguration::saveConfig(QSettings *settings) const
     settings->setValue("controlPortUDP", QString::number(udp_port));
     settings->setValue("controlHostUDP", udp_host.toString());
 
+    settings->setValue("updateRate", updateRate);
+    settings->setValue("measureLatency", measureLatency);
+
     int i;
     for (i = 0; i < 8; i++) {
         settings->setValue(QString().sprintf("button%dAction", i), buttonSettings[i].ActionID);
@@ -37,6 +37,9 @@ typedef struct {
     double Amount;
 } buttonSettingsStruct;
 
+// 50Hz
+#define GCSCONTROL_DEFAULT_UPDATE_RATE 20
+
 typedef struct {
     int port;
     QHostAddress address;
@@ -86,6 +89,24 @@ public:
     {
         channelReverse[i] = Reverse;
     }
+    // period the joystick sticks are sent at, in ms
+    int getUpdateRate()
+    {
+        return updateRate;
+    }
+    void setUpdateRate(int ms)
+    {
+        updateRate = ms;
+    }
+    // log the time from reading the joystick to sending the sticks
+    bool getMeasureLatency()
+    {
+        return measureLatency;
+    }
+    void setMeasureLatency(bool measure)
+    {
+        measureLatency = measure;
+    }
 
 
     void saveConfig(QSettings *settings) const;
@@ -102,6 +123,8 @@ private:
     bool channelReverse[8];
     int udp_port;
     QHostAddress udp_host;
+    int updateRate;
+    bool measureLatency;
 };
 
 #endif // GCSCONTROLGADGETCONFIGURATION_H
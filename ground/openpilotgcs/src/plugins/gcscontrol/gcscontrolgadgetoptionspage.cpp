@@ -209,7 +209,7 @@ QWidget *GCSControlGadgetOptionsPage::createPage(QWidget *parent)
         chRevList.at(i)->setChecked(qlChRev.at(i));;
     }
 
-    connect(sdlGamepad, SIGNAL(axesValues(QListInt16)), this, SLOT(axesValues(QListInt16)));
+    connect(sdlGamepad, SIGNAL(axesValues(QListInt16, qint64)), this, SLOT(axesValues(QListInt16)));
     connect(sdlGamepad, SIGNAL(buttonState(ButtonNumber, bool)), this, SLOT(buttonState(ButtonNumber, bool)));
     connect(sdlGamepad, SIGNAL(gamepads(quint8)), this, SLOT(gamepads(quint8)));
 
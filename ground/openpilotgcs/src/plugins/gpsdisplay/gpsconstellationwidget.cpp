@@ -64,6 +64,11 @@ GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(
 
     QFontDatabase::addApplicationFont(":/gpsgadget/font/digital-7.ttf");
 
+    dirtySats = 0;
+    redrawTimer.setSingleShot(true);
+    redrawTimer.setInterval(REDRAW_INTERVAL_MS);
+    connect(&redrawTimer, SIGNAL(timeout()), this, SLOT(redraw()));
+
     // Now create 'maxSatellites' satellite icons which we will move around on the map:
     for (int i = 0; i < MAX_SATTELITES; i++) {
         satellites[i][0] = 0;
@@ -112,17 +117,45 @@ void GpsConstellationWidget::resizeEvent(QResizeEvent *event)
 
 void GpsConstellationWidget::updateSat(int index, int prn, int elevation, int azimuth, int snr)
 {
-    if (index >= MAX_SATTELITES) {
+    if (index < 0 || index >= MAX_SATTELITES) {
         // A bit of error checking never hurts.
         return;
     }
 
+    if (satellites[index][0] == prn && satellites[index][1] == elevation &&
+        satellites[index][2] == azimuth && satellites[index][3] == snr) {
+        return;
+    }
+
     // TODO: add range checking
     satellites[index][0] = prn;
     satellites[index][1] = elevation;
     satellites[index][2] = azimuth;
     satellites[index][3] = snr;
 
+    dirtySats |= 1u << index;
+    if (!redrawTimer.isActive()) {
+        redrawTimer.start();
+    }
+}
+
+void GpsConstellationWidget::redraw()
+{
+    for (int index = 0; index < MAX_SATTELITES; index++) {
+        if (dirtySats & (1u << index)) {
+            drawSat(index);
+        }
+    }
+    dirtySats = 0;
+}
+
+void GpsConstellationWidget::drawSat(int index)
+{
+    const int prn       = satellites[index][0];
+    const int elevation = satellites[index][1];
+    const int azimuth   = satellites[index][2];
+    const int snr       = satellites[index][3];
+
     if (prn && elevation >= 0) {
         QPointF opd = polarToCoord(elevation, azimuth);
         opd += QPointF(-satIcons[index]->boundingRect().center().x(),
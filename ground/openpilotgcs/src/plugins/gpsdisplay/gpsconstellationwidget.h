@@ -29,6 +29,7 @@
 #define GPSCONSTELLATIONWIDGET_H_
 
 #include <QGraphicsView>
+#include <QTimer>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 
@@ -45,10 +46,15 @@ public slots:
 
 
 private slots:
+    void redraw();
 
 private:
     static const int MAX_SATTELITES = 16;
+    // satellites are drawn at most once per display frame
+    static const int REDRAW_INTERVAL_MS = 16;
     int satellites[MAX_SATTELITES][4];
+    quint32 dirtySats;
+    QTimer redrawTimer;
     QGraphicsScene *scene;
     QSvgRenderer *renderer;
     QGraphicsSvgItem *world;
@@ -56,6 +62,7 @@ private:
     QGraphicsSimpleTextItem *satTexts[MAX_SATTELITES];
 
     QPointF polarToCoord(int elevation, int azimuth);
+    void drawSat(int index);
 
 protected:
     void showEvent(QShowEvent *event);
@@ -6,6 +6,11 @@ GpsSnrWidget::GpsSnrWidget(QWidget *parent) :
     scene = new QGraphicsScene(this);
     setScene(scene);
 
+    dirtySats = 0;
+    redrawTimer.setSingleShot(true);
+    redrawTimer.setInterval(REDRAW_INTERVAL_MS);
+    connect(&redrawTimer, SIGNAL(timeout()), this, SLOT(redraw()));
+
     // Now create 'maxSatellites' satellite icons which we will move around on the map:
     for (int i = 0; i < MAX_SATTELITES; i++) {
         satellites[i][0] = 0;
@@ -54,18 +59,36 @@ void GpsSnrWidget::resizeEvent(QResizeEvent *event)
 
 void GpsSnrWidget::updateSat(int index, int prn, int elevation, int azimuth, int snr)
 {
-    if (index >= MAX_SATTELITES) {
+    if (index < 0 || index >= MAX_SATTELITES) {
         // A bit of error checking never hurts.
         return;
     }
 
+    if (satellites[index][0] == prn && satellites[index][1] == elevation &&
+        satellites[index][2] == azimuth && satellites[index][3] == snr) {
+        return;
+    }
+
     // TODO: add range checking
     satellites[index][0] = prn;
     satellites[index][1] = elevation;
     satellites[index][2] = azimuth;
     satellites[index][3] = snr;
 
-    drawSat(index);
+    dirtySats |= 1u << index;
+    if (!redrawTimer.isActive()) {
+        redrawTimer.start();
+    }
+}
+
+void GpsSnrWidget::redraw()
+{
+    for (int index = 0; index < MAX_SATTELITES; index++) {
+        if (dirtySats & (1u << index)) {
+            drawSat(index);
+        }
+    }
+    dirtySats = 0;
 }
 
 void GpsSnrWidget::drawSat(int index)
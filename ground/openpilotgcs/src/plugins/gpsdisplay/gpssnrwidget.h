@@ -3,6 +3,7 @@
 
 #include <QGraphicsView>
 #include <QGraphicsRectItem>
+#include <QTimer>
 
 class GpsSnrWidget : public QGraphicsView {
     Q_OBJECT
@@ -15,9 +16,16 @@ signals:
 public slots:
     void updateSat(int index, int prn, int elevation, int azimuth, int snr);
 
+private slots:
+    void redraw();
+
 private:
     static const int MAX_SATTELITES = 16;
+    // satellites are drawn at most once per display frame
+    static const int REDRAW_INTERVAL_MS = 16;
     int satellites[MAX_SATTELITES][4];
+    quint32 dirtySats;
+    QTimer redrawTimer;
     QGraphicsScene *scene;
     QGraphicsRectItem *boxes[MAX_SATTELITES];
     QGraphicsSimpleTextItem *satTexts[MAX_SATTELITES];
@@ -28,6 +28,8 @@
 
 #include "nmeaparser.h"
 #include <iostream>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <QDebug>
 #include <QStringList>
@@ -35,18 +37,15 @@
 #include <QVBoxLayout>
 #include <QPushButton>
 
-// Message Codes
-#define NMEA_NODATA    0       // No data. Packet not available, bad, or not decoded
-#define NMEA_GPGGA     1       // Global Positioning System Fix Data
-#define NMEA_GPVTG     2       // Course over ground and ground speed
-#define NMEA_GPGLL     3       // Geographic position - latitude/longitude
-#define NMEA_GPGSV     4       // GPS satellites in view
-#define NMEA_GPGSA     5       // GPS DOP and active satellites
-#define NMEA_GPRMC     6       // Recommended minimum specific GPS data
-#define NMEA_GPZDA     7       // Time and Date
-#define NMEA_UNKNOWN   0xFF // Packet received but not known
+// UBX message classes and ids decoded by the gadget
+#define UBX_CLASS_NAV     0x01
+#define UBX_ID_NAV_POSLLH 0x02
+#define UBX_ID_NAV_DOP    0x04
+#define UBX_ID_NAV_SOL    0x06
+#define UBX_ID_NAV_VELNED 0x12
+#define UBX_ID_NAV_SVINFO 0x30
 
-#define GPS_TIMEOUT_MS 500
+#define GPS_MAX_SATELLITES 16
 
 // Debugging
 
@@ -55,39 +54,134 @@
 
 #ifdef GPSDEBUG
         #define NMEA_DEBUG_PKT ///< define to enable debug of all NMEA messages
-        #define NMEA_DEBUG_GGA ///< define to enable debug of GGA messages
-        #define NMEA_DEBUG_VTG ///< define to enable debug of VTG messages
-        #define NMEA_DEBUG_RMC ///< define to enable debug of RMC messages
-        #define NMEA_DEBUG_GSA ///< define to enable debug of GSA messages
-        #define NMEA_DEBUG_ZDA ///< define to enable debug of ZDA messages
 #endif
 
+// UBX is little endian
+static inline uint16_t ubxU2(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t ubxU4(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline int32_t ubxI4(const uint8_t *p)
+{
+    return (int32_t)ubxU4(p);
+}
+
 /**
  * Initialize the parser
  */
 NMEAParser::NMEAParser(QObject *parent) : GPSParser(parent)
 {
-    bufferInit(&gpsRxBuffer, (unsigned char *)gpsRxData, 512);
+    gpsRxBuffer.reserve(GPS_RX_BUFFER_SIZE);
+    numUpdates    = 0;
+    numErrors     = 0;
     gpsRxOverflow = 0;
+    memset(&GpsData, 0, sizeof(GpsData));
 }
 
 NMEAParser::~NMEAParser()
 {}
 
+void NMEAParser::processInputStream(char c)
+{
+    processInputStream(&c, 1);
+}
+
 /**
- * Called each time there are data in the input buffer
+ * Called each time there are data in the input buffer. Every complete
+ * sentence or frame in the chunk is processed at once, only a trailing
+ * partial one is kept for the next call.
  */
-void NMEAParser::processInputStream(char c)
+void NMEAParser::processInputStream(const char *data, int length)
 {
-    if (!bufferAddToEnd(&gpsRxBuffer, c)) {
-        // no space in buffer
-        // count overflow
+    gpsRxBuffer.append(data, length);
+    int consumed = parseBuffer(gpsRxBuffer.data(), gpsRxBuffer.size());
+    if (consumed > 0) {
+        gpsRxBuffer.remove(0, consumed);
+    }
+    if (gpsRxBuffer.size() > GPS_RX_BUFFER_SIZE) {
+        // we're logjammed, flush entire buffer
         gpsRxOverflow++;
-        return;
+        gpsRxBuffer.clear();
     }
-    nmeaProcess(&gpsRxBuffer);
 }
 
+/**
+ * Frames NMEA sentences and UBX frames in place
+ * \param[in] data received bytes, NMEA sentences are null terminated in place
+ * \param[in] length number of bytes in data
+ * \return number of bytes consumed, the rest is an incomplete sentence or frame
+ */
+int NMEAParser::parseBuffer(char *data, int length)
+{
+    int pos = 0;
+
+    while (pos < length) {
+        const int available = length - pos;
+        const uint8_t c     = data[pos];
+        if (c == '$') {
+            char *start = data + pos;
+            char *end   = (char *)memchr(start, '\n', qMin(available, NMEA_BUFFERSIZE));
+            if (!end) {
+                if (available < NMEA_BUFFERSIZE) {
+                    // wait for the rest of the sentence
+                    break;
+                }
+                // although NMEA strings should be 80 characters or less,
+                // receive errors can generate erroneous packets. Drop it.
+                pos++;
+                continue;
+            }
+            // null terminate it, dropping <CR><LF>
+            *end = 0;
+            if (end > start && end[-1] == '\r') {
+                end[-1] = 0;
+            }
+            // dump initial '$'
+            nmeaProcess(start + 1);
+            pos += end - start + 1;
+        } else if (c == UBX_SYNC1) {
+            if (available < 2) {
+                break;
+            }
+            if ((uint8_t)data[pos + 1] != UBX_SYNC2) {
+                pos++;
+                continue;
+            }
+            if (available < UBX_HEADER_LENGTH) {
+                break;
+            }
+            const uint8_t *frame = (const uint8_t *)data + pos + 2;
+            const int payloadLength = ubxU2(frame + 2);
+            if (payloadLength > UBX_MAX_PAYLOAD) {
+                // false sync
+                pos++;
+                continue;
+            }
+            if (available < UBX_HEADER_LENGTH + payloadLength + 2) {
+                // wait for the rest of the frame
+                break;
+            }
+            if (ubxProcess(frame, payloadLength)) {
+                pos += UBX_HEADER_LENGTH + payloadLength + 2;
+            } else {
+                pos++;
+            }
+        } else {
+            // skip to the next possible start of a sentence or frame
+            pos++;
+            while (pos < length && data[pos] != '$' && (uint8_t)data[pos] != UBX_SYNC1) {
+                pos++;
+            }
+        }
+    }
+    return pos;
+}
 
 /**
  * Prosesses NMEA sentence checksum
@@ -98,185 +192,105 @@ void NMEAParser::processInputStream(char c)
 char NMEAParser::nmeaChecksum(char *gps_buffer)
 {
     char checksum = 0;
-    char checksum_received = 0;
 
-    for (int x = 0; x < NMEA_BUFFERSIZE; x++) {
-        if (gps_buffer[x] == '*') {
+    for (char *p = gps_buffer; *p; p++) {
+        if (*p == '*') {
             // Parsing received checksum...
-            checksum_received = strtol(&gps_buffer[x + 1], NULL, 16);
-
-            break;
-        } else {
-            // XOR the received data...
-            checksum ^= gps_buffer[x];
-        }
-    }
-    if (checksum == checksum_received) {
-        ++numUpdates;
-        return 1;
-    } else {
-        ++numErrors;
-        return 0;
-    }
-}
-
-void NMEAParser::nmeaTerminateAtChecksum(char *gps_buffer)
-{
-    for (int x = 0; x < NMEA_BUFFERSIZE; x++) {
-        if (gps_buffer[x] == '*') {
-            gps_buffer[x] = 0;
+            if ((char)strtol(p + 1, NULL, 16) == checksum) {
+                ++numUpdates;
+                return 1;
+            }
             break;
         }
+        // XOR the received data...
+        checksum ^= *p;
     }
+    ++numErrors;
+    return 0;
 }
 
 /**
- * Prosesses NMEA sentences
- * \param[in] cBuffer for prosessed nmea sentences
- * \return Message code for found packet
- * \return 0xFF NO packet found
+ * Prosesses a NMEA sentence
+ * \param[in] sentence null terminated sentence without the leading '$',
+ * it is split into fields in place
  */
-uint8_t NMEAParser::nmeaProcess(cBuffer *rxBuffer)
+void NMEAParser::nmeaProcess(char *sentence)
 {
-    uint8_t foundpacket = NMEA_NODATA;
-    uint8_t startFlag   = false;
-    // u08 data;
-    uint16_t i, j;
-
-    // process the receive buffer
-    // go through buffer looking for packets
-    while (rxBuffer->datalength) {
-        // look for a start of NMEA packet
-        if (bufferGetAtIndex(rxBuffer, 0) == '$') {
-            // found start
-            startFlag = true;
-            // when start is found, we leave it intact in the receive buffer
-            // in case the full NMEA string is not completely received.  The
-            // start will be detected in the next nmeaProcess iteration.
-
-            // done looking for start
-            break;
-        } else {
-            bufferGetFromFront(rxBuffer);
-        }
+    // DEBUG
+        #ifdef NMEA_DEBUG_PKT
+    qDebug() << sentence;
+        #endif
+    emit packet(QString(sentence));
+
+    if (!nmeaChecksum(sentence)) {
+        // checksum not valid
+        return;
     }
 
-    // if we detected a start, look for end of packet
-    if (startFlag) {
-        for (i = 1; i < (rxBuffer->datalength) - 1; i++) {
-            // check for end of NMEA packet <CR><LF>
-            if ((bufferGetAtIndex(rxBuffer, i) == '\r') && (bufferGetAtIndex(rxBuffer, i + 1) == '\n')) {
-                // have a packet end
-                // dump initial '$'
-                bufferGetFromFront(rxBuffer);
-                // copy packet to NmeaPacket
-                for (j = 0; j < (i - 1); j++) {
-                    // although NMEA strings should be 80 characters or less,
-                    // receive buffer errors can generate erroneous packets.
-                    // Protect against packet buffer overflow
-                    if (j < (NMEA_BUFFERSIZE - 1)) {
-                        NmeaPacket[j] = bufferGetFromFront(rxBuffer);
-                    } else {
-                        bufferGetFromFront(rxBuffer);
-                    }
-                }
-                // null terminate it
-                if (j < (NMEA_BUFFERSIZE - 1)) {
-                    NmeaPacket[j] = 0;
-                } else {
-                    NmeaPacket[NMEA_BUFFERSIZE - 1] = 0;
-                }
-                // dump <CR><LF> from rxBuffer
-                bufferGetFromFront(rxBuffer);
-                bufferGetFromFront(rxBuffer);
-                // DEBUG
-                                #ifdef NMEA_DEBUG_PKT
-                qDebug() << NmeaPacket;
-                                #endif
-                emit packet(QString(NmeaPacket));
-                // found a packet
-                // done with this processing session
-                foundpacket = NMEA_UNKNOWN;
-                break;
+    // Split into fields, missing trailing fields read as empty
+    const char *fields[NMEA_MAX_FIELDS];
+    int count = 0;
+    fields[count++] = sentence;
+    for (char *p = sentence; *p; p++) {
+        if (*p == ',') {
+            *p = 0;
+            if (count < NMEA_MAX_FIELDS) {
+                fields[count++] = p + 1;
             }
+        } else if (*p == '*') {
+            *p = 0;
+            break;
         }
     }
-
-    if (foundpacket) {
-        // check message type and process appropriately
-        if (!strncmp(NmeaPacket, "GPGGA", 5)) {
-            // process packet of this type
-            nmeaProcessGPGGA(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPGGA;
-        } else if (!strncmp(NmeaPacket, "GPVTG", 5)) {
-            // process packet of this type
-            nmeaProcessGPVTG(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPVTG;
-        } else if (!strncmp(NmeaPacket, "GPGSA", 5)) {
-            // process packet of this type
-            nmeaProcessGPGSA(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPGSA;
-        } else if (!strncmp(NmeaPacket, "GPRMC", 5)) {
-            // process packet of this type
-            nmeaProcessGPRMC(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPRMC;
-        } else if (!strncmp(NmeaPacket, "GPGSV", 5)) {
-            // Process packet of this type
-            nmeaProcessGPGSV(NmeaPacket);
-            // rerpot packet type
-            foundpacket = NMEA_GPGSV;
-        } else if (!strncmp(NmeaPacket, "GPZDA", 5)) {
-            // Process packet of this type
-            nmeaProcessGPZDA(NmeaPacket);
-            // rerpot packet type
-            foundpacket = NMEA_GPZDA;
-        }
-    } else if (rxBuffer->datalength >= rxBuffer->size) {
-        // if we found no packet, and the buffer is full
-        // we're logjammed, flush entire buffer
-        bufferFlush(rxBuffer);
+    for (int i = count; i < NMEA_MAX_FIELDS; i++) {
+        fields[i] = "";
     }
-    return foundpacket;
-}
 
-/**
- * Processes NMEA GSV sentences (satellites in view)
- * \param[in] Buffer for parsed nmea GSV sentence
- */
-void NMEAParser::nmeaProcessGPGSV(char *packet)
-{
-    // start parsing just after "GPGSV,"
     // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    if (!fields[1][0] && !fields[2][0]) {
         return;
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
+    // check message type and process appropriately, any GNSS talker is
+    // accepted for the position and fix but only GPS for the satellites
+    const char *type = fields[0];
+    if (strlen(type) != 5 || type[0] != 'G') {
         return;
     }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
+    if (!strcmp(type + 2, "GGA")) {
+        nmeaProcessGPGGA(fields, count);
+    } else if (!strcmp(type + 2, "VTG")) {
+        nmeaProcessGPVTG(fields, count);
+    } else if (!strcmp(type + 2, "GSA")) {
+        nmeaProcessGPGSA(fields, count);
+    } else if (!strcmp(type + 2, "RMC")) {
+        nmeaProcessGPRMC(fields, count);
+    } else if (!strcmp(type, "GPGSV")) {
+        nmeaProcessGPGSV(fields, count);
+    } else if (!strcmp(type + 2, "ZDA")) {
+        nmeaProcessGPZDA(fields, count);
+    }
+}
 
+/**
+ * Processes NMEA GSV sentences (satellites in view)
+ * \param[in] fields of the nmea GSV sentence
+ */
+void NMEAParser::nmeaProcessGPGSV(const char *const *fields, int count)
+{
     // Officially there should be a max of three sentences (12 sats), some gps receivers do more..
 
-    const int sentence_total = tokenslist.at(1).toInt(); // Number of sentences for full data
-    const int sentence_index = tokenslist.at(2).toInt(); // sentence x of y
+    const int sentence_total = atoi(fields[1]); // Number of sentences for full data
+    const int sentence_index = atoi(fields[2]); // sentence x of y
+
+    int sats = (count - 4) / 4;
 
-    int sats = (tokenslist.size() - 4) / 4;
     for (int sat = 0; sat < sats; sat++) {
         int base          = 4 + sat * 4;
-        const int id      = tokenslist.at(base + 0).toInt(); // Satellite PRN number
-        const int elv     = tokenslist.at(base + 1).toInt(); // Elevation, degrees
-        const int azimuth = tokenslist.at(base + 2).toInt(); // Azimuth, degrees
-        const int sig     = tokenslist.at(base + 3).toInt(); // SNR - higher is better
+        const int id      = atoi(fields[base + 0]); // Satellite PRN number
+        const int elv     = atoi(fields[base + 1]); // Elevation, degrees
+        const int azimuth = atoi(fields[base + 2]); // Azimuth, degrees
+        const int sig     = atoi(fields[base + 3]); // SNR - higher is better
         const int index   = (sentence_index - 1) * 4 + sat;
         emit satellite(index, id, elv, azimuth, sig);
     }
@@ -284,7 +298,7 @@ void NMEAParser::nmeaProcessGPGSV(char *packet)
     if (sentence_index == sentence_total) {
         // Last sentence
         int total_sats = (sentence_index - 1) * 4 + sats;
-        for (int emptySatIndex = total_sats; emptySatIndex < 16; emptySatIndex++) {
+        for (int emptySatIndex = total_sats; emptySatIndex < GPS_MAX_SATELLITES; emptySatIndex++) {
             // Wipe the rest.
             emit satellite(emptySatIndex, 0, 0, 0, 0);
         }
@@ -293,49 +307,37 @@ void NMEAParser::nmeaProcessGPGSV(char *packet)
 
 /**
  * Prosesses NMEA GPGGA sentences
- * \param[in] Buffer for parsed nmea GPGGA sentence
+ * \param[in] fields of the nmea GPGGA sentence
  */
-void NMEAParser::nmeaProcessGPGGA(char *packet)
+void NMEAParser::nmeaProcessGPGGA(const char *const *fields, int count)
 {
-    // start parsing just after "GPGGA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
-
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
+    Q_UNUSED(count);
 
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-    GpsData.GPStime  = tokenslist.at(1).toDouble();
-    GpsData.Latitude = tokenslist.at(2).toDouble();
+    GpsData.GPStime  = strtod(fields[1], NULL);
+    GpsData.Latitude = strtod(fields[2], NULL);
     int deg    = (int)GpsData.Latitude / 100;
     double min = ((GpsData.Latitude) - (deg * 100)) / 60.0;
     GpsData.Latitude = deg + min;
     // next field: N/S indicator
     // correct latitute for N/S
-    if (tokenslist.at(3).contains("S")) {
+    if (fields[3][0] == 'S') {
         GpsData.Latitude = -GpsData.Latitude;
     }
 
-    GpsData.Longitude = tokenslist.at(4).toDouble();
+    GpsData.Longitude = strtod(fields[4], NULL);
     deg = (int)GpsData.Longitude / 100;
     min = ((GpsData.Longitude) - (deg * 100)) / 60.0;
     GpsData.Longitude = deg + min;
     // next field: E/W indicator
     // correct latitute for E/W
-    if (tokenslist.at(5).contains("W")) {
+    if (fields[5][0] == 'W') {
         GpsData.Longitude = -GpsData.Longitude;
     }
 
-    GpsData.SV = tokenslist.at(7).toInt();
+    GpsData.SV = atoi(fields[7]);
 
-    GpsData.Altitude = tokenslist.at(9).toDouble();
-    GpsData.GeoidSeparation = tokenslist.at(11).toDouble();
+    GpsData.Altitude = strtod(fields[9], NULL);
+    GpsData.GeoidSeparation = strtod(fields[11], NULL);
     emit position(GpsData.Latitude, GpsData.Longitude, GpsData.Altitude);
     emit sv(GpsData.SV);
     emit datetime(GpsData.GPSdate, GpsData.GPStime);
@@ -343,29 +345,17 @@ void NMEAParser::nmeaProcessGPGGA(char *packet)
 
 /**
  * Prosesses NMEA GPRMC sentences
- * \param[in] Buffer for parsed nmea GPRMC sentence
+ * \param[in] fields of the nmea GPRMC sentence
  */
-void NMEAParser::nmeaProcessGPRMC(char *packet)
+void NMEAParser::nmeaProcessGPRMC(const char *const *fields, int count)
 {
-    // start parsing just after "GPRMC,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
+    Q_UNUSED(count);
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-    GpsData.GPStime     = tokenslist.at(1).toDouble();
-    GpsData.Groundspeed = tokenslist.at(7).toDouble();
+    GpsData.GPStime     = strtod(fields[1], NULL);
+    GpsData.Groundspeed = strtod(fields[7], NULL);
     GpsData.Groundspeed = GpsData.Groundspeed * 0.51444;
-    GpsData.Heading     = tokenslist.at(8).toDouble();
-    GpsData.GPSdate     = tokenslist.at(9).toDouble();
+    GpsData.Heading     = strtod(fields[8], NULL);
+    GpsData.GPSdate     = strtod(fields[9], NULL);
     emit datetime(GpsData.GPSdate, GpsData.GPStime);
     emit speedheading(GpsData.Groundspeed, GpsData.Heading);
 }
@@ -373,63 +363,36 @@ void NMEAParser::nmeaProcessGPRMC(char *packet)
 
 /**
  * Prosesses NMEA GPVTG sentences
- * \param[in] Buffer for parsed nmea GPVTG sentence
+ * \param[in] fields of the nmea GPVTG sentence
  */
-void NMEAParser::nmeaProcessGPVTG(char *packet)
+void NMEAParser::nmeaProcessGPVTG(const char *const *fields, int count)
 {
-    // start parsing just after "GPVTG,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
+    Q_UNUSED(count);
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
-    GpsData.Heading     = tokenslist.at(1).toDouble();
-    GpsData.Groundspeed = tokenslist.at(7).toDouble();
+    GpsData.Heading     = strtod(fields[1], NULL);
+    GpsData.Groundspeed = strtod(fields[7], NULL);
     GpsData.Groundspeed = GpsData.Groundspeed / 3.6;
     emit speedheading(GpsData.Groundspeed, GpsData.Heading);
 }
 
 /**
  * Prosesses NMEA GPGSA sentences
- * \param[in] Buffer for parsed nmea GPGSA sentence
+ * \param[in] fields of the nmea GPGSA sentence
  */
-void NMEAParser::nmeaProcessGPGSA(char *packet)
+void NMEAParser::nmeaProcessGPGSA(const char *const *fields, int count)
 {
-    // start parsing just after "GPGSA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
-
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
+    Q_UNUSED(count);
 
     // M=Manual, forced to operate in 2D or 3D
     // A=Automatic, 3D/2D
-    QString fixmodeValue = tokenslist.at(1);
-    if (fixmodeValue == "A") {
+    if (fields[1][0] == 'A') {
         emit fixmode(QString("Auto"));
-    } else if (fixmodeValue == "B") {
+    } else if (fields[1][0] == 'B') {
         emit fixmode(QString("Manual"));
     }
 
     // Mode: 1=Fix not available, 2=2D, 3=3D
-    int fixtypeValue = tokenslist.at(2).toInt();
+    int fixtypeValue = atoi(fields[2]);
     if (fixtypeValue == 1) {
         emit fixtype(QString("NoFix"));
     } else if (fixtypeValue == 2) {
@@ -441,9 +404,9 @@ void NMEAParser::nmeaProcessGPGSA(char *packet)
     // 3-14 = IDs of SVs used in position fix (null for unused fields)
     QList<int> svList;
     for (int pos = 0; pos < 12; pos++) {
-        QString sv = tokenslist.at(3 + pos);
-        if (!sv.isEmpty()) {
-            svList.append(sv.toInt());
+        const char *sv = fields[3 + pos];
+        if (sv[0]) {
+            svList.append(atoi(sv));
         }
     }
     emit fixSVs(svList);
@@ -451,37 +414,159 @@ void NMEAParser::nmeaProcessGPGSA(char *packet)
     // 15   = PDOP
     // 16   = HDOP
     // 17   = VDOP
-    GpsData.PDOP = tokenslist.at(15).toDouble();
-    GpsData.HDOP = tokenslist.at(16).toDouble();
-    GpsData.VDOP = tokenslist.at(17).toDouble();
+    GpsData.PDOP = strtod(fields[15], NULL);
+    GpsData.HDOP = strtod(fields[16], NULL);
+    GpsData.VDOP = strtod(fields[17], NULL);
     emit dop(GpsData.HDOP, GpsData.VDOP, GpsData.PDOP);
 }
 
 /**
  * Prosesses NMEA GPZDA sentences
- * \param[in] Buffer for parsed nmea GPZDA sentence
+ * \param[in] fields of the nmea GPZDA sentence
  */
-void NMEAParser::nmeaProcessGPZDA(char *packet)
+void NMEAParser::nmeaProcessGPZDA(const char *const *fields, int count)
 {
-    // start parsing just after "GPZDA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    Q_UNUSED(count);
+
+    GpsData.GPStime = strtod(fields[1], NULL);
+    int day   = atoi(fields[2]);
+    int month = atoi(fields[3]);
+    int year  = atoi(fields[4]);
+    GpsData.GPSdate = day * 10000 + month * 100 + (year - 2000);
+    emit datetime(GpsData.GPSdate, GpsData.GPStime);
+}
+
+/**
+ * Processes a UBX frame
+ * \param[in] frame class, id, length and payload followed by the checksum
+ * \param[in] payloadLength length of the payload
+ * \return false when the checksum is not valid
+ */
+bool NMEAParser::ubxProcess(const uint8_t *frame, int payloadLength)
+{
+    // 8-bit Fletcher checksum over class, id, length and payload
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    for (int i = 0; i < payloadLength + 4; i++) {
+        ck_a += frame[i];
+        ck_b += ck_a;
+    }
+    if (ck_a != frame[payloadLength + 4] || ck_b != frame[payloadLength + 5]) {
+        ++numErrors;
+        return false;
+    }
+    ++numUpdates;
+
+    emit packet(QString("UBX %1 %2, %3 bytes").arg(frame[0], 2, 16, QChar('0'))
+                .arg(frame[1], 2, 16, QChar('0')).arg(payloadLength));
+
+    if (frame[0] != UBX_CLASS_NAV) {
+        return true;
+    }
+    const uint8_t *payload = frame + 4;
+    switch (frame[1]) {
+    case UBX_ID_NAV_POSLLH:
+        ubxProcessNavPosLLH(payload, payloadLength);
+        break;
+    case UBX_ID_NAV_VELNED:
+        ubxProcessNavVelNED(payload, payloadLength);
+        break;
+    case UBX_ID_NAV_SOL:
+        ubxProcessNavSol(payload, payloadLength);
+        break;
+    case UBX_ID_NAV_DOP:
+        ubxProcessNavDOP(payload, payloadLength);
+        break;
+    case UBX_ID_NAV_SVINFO:
+        ubxProcessNavSVInfo(payload, payloadLength);
+        break;
+    }
+    return true;
+}
+
+/**
+ * Processes UBX NAV-POSLLH (geodetic position)
+ */
+void NMEAParser::ubxProcessNavPosLLH(const uint8_t *payload, int length)
+{
+    if (length < 28) {
         return;
     }
+    GpsData.Longitude = ubxI4(payload + 4) * 1e-7;
+    GpsData.Latitude  = ubxI4(payload + 8) * 1e-7;
+    // height above mean sea level, like the GGA altitude
+    GpsData.Altitude  = ubxI4(payload + 16) * 1e-3;
+    GpsData.GeoidSeparation = (ubxI4(payload + 12) - ubxI4(payload + 16)) * 1e-3;
+    emit position(GpsData.Latitude, GpsData.Longitude, GpsData.Altitude);
+}
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
+/**
+ * Processes UBX NAV-VELNED (velocity in NED frame)
+ */
+void NMEAParser::ubxProcessNavVelNED(const uint8_t *payload, int length)
+{
+    if (length < 36) {
         return;
     }
-    nmeaTerminateAtChecksum(packet);
+    GpsData.Groundspeed = ubxU4(payload + 20) * 0.01;
+    GpsData.Heading     = ubxI4(payload + 24) * 1e-5;
+    emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+}
 
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
+/**
+ * Processes UBX NAV-SOL (navigation solution)
+ */
+void NMEAParser::ubxProcessNavSol(const uint8_t *payload, int length)
+{
+    if (length < 52) {
+        return;
+    }
+    const uint8_t gpsFix = payload[10];
+    const bool fixOk     = payload[11] & 0x01;
 
-    GpsData.GPStime = tokenslist.at(1).toDouble();
-    int day   = tokenslist.at(2).toInt();
-    int month = tokenslist.at(3).toInt();
-    int year  = tokenslist.at(4).toInt();
-    GpsData.GPSdate = day * 10000 + month * 100 + (year - 2000);
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
+    if (fixOk && gpsFix == 2) {
+        emit fixtype(QString("Fix2D"));
+    } else if (fixOk && (gpsFix == 3 || gpsFix == 4)) {
+        emit fixtype(QString("Fix3D"));
+    } else {
+        emit fixtype(QString("NoFix"));
+    }
+    GpsData.SV = payload[47];
+    emit sv(GpsData.SV);
+}
+
+/**
+ * Processes UBX NAV-DOP (dilution of precision)
+ */
+void NMEAParser::ubxProcessNavDOP(const uint8_t *payload, int length)
+{
+    if (length < 18) {
+        return;
+    }
+    GpsData.PDOP = ubxU2(payload + 6) * 0.01;
+    GpsData.VDOP = ubxU2(payload + 10) * 0.01;
+    GpsData.HDOP = ubxU2(payload + 12) * 0.01;
+    emit dop(GpsData.HDOP, GpsData.VDOP, GpsData.PDOP);
+}
+
+/**
+ * Processes UBX NAV-SVINFO (satellites in view)
+ */
+void NMEAParser::ubxProcessNavSVInfo(const uint8_t *payload, int length)
+{
+    if (length < 8) {
+        return;
+    }
+    int numCh = qMin((int)payload[4], (length - 8) / 12);
+    int index = 0;
+
+    for (int chan = 0; chan < numCh && index < GPS_MAX_SATELLITES; chan++) {
+        const uint8_t *sv = payload + 8 + chan * 12;
+        emit satellite(index++, sv[1], (int8_t)sv[5], (int16_t)ubxU2(sv + 6), sv[4]);
+    }
+    for (; index < GPS_MAX_SATELLITES; index++) {
+        // Wipe the rest.
+        emit satellite(index, 0, 0, 0, 0);
+    }
 }
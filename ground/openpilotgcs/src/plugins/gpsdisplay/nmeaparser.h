@@ -31,11 +31,21 @@
 #include <QObject>
 #include <QtCore>
 #include <stdint.h>
-#include "buffer.h"
 #include "gpsparser.h"
 
 // constants/macros/typdefs
-#define NMEA_BUFFERSIZE 128
+#define NMEA_BUFFERSIZE    128
+#define NMEA_MAX_FIELDS    24
+
+// u-blox binary protocol framing
+#define UBX_SYNC1          0xB5
+#define UBX_SYNC2          0x62
+#define UBX_HEADER_LENGTH  6
+#define UBX_MAX_PAYLOAD    512
+
+// bytes kept while waiting for the end of a sentence or frame before the
+// receive buffer is considered logjammed and flushed
+#define GPS_RX_BUFFER_SIZE 2048
 
 typedef struct struct_GpsData {
     double Latitude;
@@ -53,6 +63,11 @@ typedef struct struct_GpsData {
     double GPSdate;
 } GpsData_t;
 
+/**
+ * Parser for the raw serial stream of a GPS. u-blox receivers interleave
+ * NMEA sentences and UBX frames on the same port, so both are framed here
+ * from whole chunks of received data.
+ */
 class NMEAParser : public GPSParser {
     Q_OBJECT
 
@@ -60,23 +75,29 @@ public:
     NMEAParser(QObject *parent = 0);
     ~NMEAParser();
     void processInputStream(char c);
-    char *nmeaGetPacketBuffer(void);
+    void processInputStream(const char *data, int length);
     char nmeaChecksum(char *gps_buffer);
-    void nmeaTerminateAtChecksum(char *gps_buffer);
-    uint8_t nmeaProcess(cBuffer *rxBuffer);
-    void nmeaProcessGPGGA(char *packet);
-    void nmeaProcessGPRMC(char *packet);
-    void nmeaProcessGPVTG(char *packet);
-    void nmeaProcessGPGSA(char *packet);
-    void nmeaProcessGPGSV(char *packet);
-    void nmeaProcessGPZDA(char *packet);
+    void nmeaProcess(char *sentence);
+    void nmeaProcessGPGGA(const char *const *fields, int count);
+    void nmeaProcessGPRMC(const char *const *fields, int count);
+    void nmeaProcessGPVTG(const char *const *fields, int count);
+    void nmeaProcessGPGSA(const char *const *fields, int count);
+    void nmeaProcessGPGSV(const char *const *fields, int count);
+    void nmeaProcessGPZDA(const char *const *fields, int count);
+    bool ubxProcess(const uint8_t *frame, int payloadLength);
+    void ubxProcessNavPosLLH(const uint8_t *payload, int length);
+    void ubxProcessNavVelNED(const uint8_t *payload, int length);
+    void ubxProcessNavSol(const uint8_t *payload, int length);
+    void ubxProcessNavDOP(const uint8_t *payload, int length);
+    void ubxProcessNavSVInfo(const uint8_t *payload, int length);
     GpsData_t GpsData;
-    cBuffer gpsRxBuffer;
-    char gpsRxData[512];
-    char NmeaPacket[NMEA_BUFFERSIZE];
+    QByteArray gpsRxBuffer;
     uint32_t numUpdates;
     uint32_t numErrors;
     int32_t gpsRxOverflow;
+
+private:
+    int parseBuffer(char *data, int length);
 };
 
 #endif // NMEAPARSER_H
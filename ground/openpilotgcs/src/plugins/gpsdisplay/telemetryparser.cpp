@@ -39,24 +39,24 @@ TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVDataObject *gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSPositionSensor"));
 
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
+    gpsPosition = GPSPositionSensor::GetInstance(objManager);
+    if (gpsPosition != NULL) {
+        connect(gpsPosition, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
     } else {
         qDebug() << "Error: Object is unknown (GPSPositionSensor).";
     }
 
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSTime"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateTime(UAVObject *)));
+    gpsTime = GPSTime::GetInstance(objManager);
+    if (gpsTime != NULL) {
+        connect(gpsTime, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateTime(UAVObject *)));
     } else {
         qDebug() << "Error: Object is unknown (GPSTime).";
     }
 
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSSatellites"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateSats(UAVObject *)));
+    gpsSatellites = GPSSatellites::GetInstance(objManager);
+    if (gpsSatellites != NULL) {
+        connect(gpsSatellites, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateSats(UAVObject *)));
     }
 }
 
@@ -66,59 +66,48 @@ TelemetryParser::~TelemetryParser()
 
 void TelemetryParser::updateGPS(UAVObject *object1)
 {
-    UAVObjectField *field = object1->getField(QString("Satellites"));
-    emit sv(field->getValue().toInt());
+    Q_UNUSED(object1);
+    static const char *const fixTypes[] = { "NoGPS", "NoFix", "Fix2D", "Fix3D" };
 
-    double lat = object1->getField(QString("Latitude"))->getDouble();
-    double lon = object1->getField(QString("Longitude"))->getDouble();
-    double alt = object1->getField(QString("Altitude"))->getDouble();
+    GPSPositionSensor::DataFields data = gpsPosition->getData();
 
-    lat *= 1E-7;
-    lon *= 1E-7;
-    emit position(lat, lon, alt);
+    emit sv(data.Satellites);
 
-    double hdg  = object1->getField(QString("Heading"))->getDouble();
-    double spd  = object1->getField(QString("Groundspeed"))->getDouble();
-    emit speedheading(spd, hdg);
+    double lat = data.Latitude * 1E-7;
+    double lon = data.Longitude * 1E-7;
+    emit position(lat, lon, data.Altitude);
 
-    QString fix = object1->getField(QString("Status"))->getValue().toString();
-    emit fixtype(fix);
+    emit speedheading(data.Groundspeed, data.Heading);
 
-    double hdop = object1->getField(QString("HDOP"))->getDouble();
-    double vdop = object1->getField(QString("VDOP"))->getDouble();
-    double pdop = object1->getField(QString("PDOP"))->getDouble();
-    emit dop(hdop, vdop, pdop);
+    if (data.Status < sizeof(fixTypes) / sizeof(fixTypes[0])) {
+        emit fixtype(QString(fixTypes[data.Status]));
+    }
+
+    emit dop(data.HDOP, data.VDOP, data.PDOP);
 }
 
 void TelemetryParser::updateTime(UAVObject *object1)
 {
-    double hour   = object1->getField(QString("Hour"))->getDouble();
-    double minute = object1->getField(QString("Minute"))->getDouble();
-    double second = object1->getField(QString("Second"))->getDouble();
-    double time   = second + minute * 100 + hour * 10000;
-    double year   = object1->getField(QString("Year"))->getDouble();
-    double month  = object1->getField(QString("Month"))->getDouble();
-    double day    = object1->getField(QString("Day"))->getDouble();
-    double date   = day + month * 100 + year * 10000;
+    Q_UNUSED(object1);
+    GPSTime::DataFields data = gpsTime->getData();
+
+    double time = data.Second + data.Minute * 100 + data.Hour * 10000;
+    double date = data.Day + data.Month * 100 + data.Year * 10000;
     emit datetime(date, time);
 }
 
 /**
    Updates the satellite constellation.
 
-   Not really optimized for now, we should only send updates for the stas
-   which have changed instead of updating everything... That said, Qt is supposed
-   to be able to optimize redraws anyway.
+   The whole object is read in one go, the widgets only redraw the
+   satellites which have changed.
  */
 void TelemetryParser::updateSats(UAVObject *object1)
 {
-    UAVObjectField *prn       = object1->getField(QString("PRN"));
-    UAVObjectField *elevation = object1->getField(QString("Elevation"));
-    UAVObjectField *azimuth   = object1->getField(QString("Azimuth"));
-    UAVObjectField *snr       = object1->getField(QString("SNR"));
-
-    for (unsigned int i = 0; i < prn->getNumElements(); i++) {
-        emit satellite(i, prn->getValue(i).toInt(), elevation->getValue(i).toInt(),
-                       azimuth->getValue(i).toInt(), snr->getValue(i).toInt());
+    Q_UNUSED(object1);
+    GPSSatellites::DataFields data = gpsSatellites->getData();
+
+    for (unsigned int i = 0; i < GPSSatellites::PRN_NUMELEM; i++) {
+        emit satellite(i, data.PRN[i], data.Elevation[i], data.Azimuth[i], data.SNR[i]);
     }
 }
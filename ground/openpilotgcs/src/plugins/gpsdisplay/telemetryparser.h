@@ -33,6 +33,9 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
+#include "gpspositionsensor.h"
+#include "gpssatellites.h"
+#include "gpstime.h"
 #include "gpsparser.h"
 
 
@@ -47,6 +50,11 @@ public slots:
     void updateGPS(UAVObject *object1);
     void updateTime(UAVObject *object1);
     void updateSats(UAVObject *object1);
+
+private:
+    GPSPositionSensor *gpsPosition;
+    GPSTime *gpsTime;
+    GPSSatellites *gpsSatellites;
 };
 
 #endif // TELEMETRYPARSER_H
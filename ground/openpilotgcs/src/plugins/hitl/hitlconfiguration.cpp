@@ -66,6 +66,8 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
     settings.airspeedStateEnabled = false;
     settings.airspeedStateRate    = 100;
 
+    settings.sensorFrameEnabled   = false;
+
 
     // if a saved configuration exists load it, and overwrite defaults
     if (qSettings != 0) {
@@ -108,6 +110,8 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
 
         settings.airspeedStateEnabled = qSettings->value("airspeedStateEnabled").toBool();
         settings.airspeedStateRate    = qSettings->value("airspeedStateRate").toInt();
+
+        settings.sensorFrameEnabled   = qSettings->value("sensorFrameEnabled").toBool();
     }
 }
 
@@ -159,4 +163,6 @@ void HITLConfiguration::saveConfig(QSettings *qSettings) const
 
     qSettings->setValue("airspeedStateEnabled", settings.airspeedStateEnabled);
     qSettings->setValue("airspeedStateRate", settings.airspeedStateRate);
+
+    qSettings->setValue("sensorFrameEnabled", settings.sensorFrameEnabled);
 }
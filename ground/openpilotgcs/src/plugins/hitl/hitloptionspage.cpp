@@ -113,6 +113,8 @@ QWidget *HITLOptionsPage::createPage(QWidget *parent)
     m_optionsPage->airspeedStateCheckbox->setChecked(config->Settings().airspeedStateEnabled);
     m_optionsPage->airspeedRateSpinbox->setValue(config->Settings().airspeedStateRate);
 
+    m_optionsPage->sensorFrameCheckBox->setChecked(config->Settings().sensorFrameEnabled);
+
     return optionsPageWidget;
 }
 
@@ -162,6 +164,8 @@ void HITLOptionsPage::apply()
     settings.airspeedStateEnabled = m_optionsPage->airspeedStateCheckbox->isChecked();
     settings.airspeedStateRate    = m_optionsPage->airspeedRateSpinbox->value();
 
+    settings.sensorFrameEnabled   = m_optionsPage->sensorFrameCheckBox->isChecked();
+
     // Write settings to file
     config->setSimulatorSettings(settings);
 }
@@ -57,6 +57,10 @@ Simulator::Simulator(const SimulatorSettings & params) :
     simConnectionStatus(false),
     txTimer(NULL),
     simTimer(NULL),
+    sensorStep(0),
+    stepLatencyAvgMs(0),
+    stepLatencyMaxMs(0),
+    stepLatencyCount(0),
     name("")
 {
     // move to thread
@@ -161,6 +165,10 @@ void Simulator::onStart()
     gpsVel = GPSVelocitySensor::GetInstance(objManager);
     telStats      = GCSTelemetryStats::GetInstance(objManager);
     groundTruth   = GroundTruth::GetInstance(objManager);
+    hitlSensors   = HITLSensors::GetInstance(objManager);
+    hitlSensorsAck = HITLSensorsAck::GetInstance(objManager);
+    connect(hitlSensorsAck, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(sensorsAckUpdated(UAVObject *)));
+    stepTimer.start();
 
     // Listen to autopilot connection events
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
@@ -253,40 +261,66 @@ void Simulator::setupObjects()
     setupOutputObject(posHome, 10000); // Hardcoded? Bleh.
 
     if (settings.gpsPositionEnabled) {
-        setupOutputObject(gpsPos, settings.gpsPosRate);
-        setupOutputObject(gpsVel, settings.gpsPosRate);
+        setupSensorObject(gpsPos, settings.gpsPosRate);
+        setupSensorObject(gpsVel, settings.gpsPosRate);
     }
 
     if (settings.groundTruthEnabled) {
-        setupOutputObject(posState, settings.groundTruthRate);
-        setupOutputObject(velState, settings.groundTruthRate);
+        setupSensorObject(posState, settings.groundTruthRate);
+        setupSensorObject(velState, settings.groundTruthRate);
     }
 
     if (settings.attRawEnabled) {
-        setupOutputObject(accelState, settings.attRawRate);
-        setupOutputObject(gyroState, settings.attRawRate);
+        setupSensorObject(accelState, settings.attRawRate);
+        setupSensorObject(gyroState, settings.attRawRate);
     }
 
     if (settings.attStateEnabled && settings.attActHW) {
-        setupOutputObject(accelState, settings.attRawRate);
-        setupOutputObject(gyroState, settings.attRawRate);
+        setupSensorObject(accelState, settings.attRawRate);
+        setupSensorObject(gyroState, settings.attRawRate);
     }
 
     if (settings.attStateEnabled && !settings.attActHW) {
-        setupOutputObject(attState, 20); // Hardcoded? Bleh.
+        setupSensorObject(attState, 20); // Hardcoded? Bleh.
     } else {
         setupWatchedObject(attState, 100); // Hardcoded? Bleh.
     }
     if (settings.airspeedStateEnabled) {
-        setupOutputObject(airspeedState, settings.airspeedStateRate);
+        setupSensorObject(airspeedState, settings.airspeedStateRate);
     }
 
     if (settings.baroSensorEnabled) {
-        setupOutputObject(baroAlt, settings.baroAltRate);
-        setupOutputObject(flightBatt, settings.baroAltRate);
+        setupSensorObject(baroAlt, settings.baroAltRate);
+        setupSensorObject(flightBatt, settings.baroAltRate);
     }
 }
 
+/**
+ * With the sensor frame the object is not sent by itself anymore, the board gets
+ * it from HITLSensors. It stays read only on the board either way.
+ */
+void Simulator::setupSensorObject(UAVObject *obj, quint32 updatePeriod)
+{
+    if (!settings.sensorFrameEnabled) {
+        setupOutputObject(obj, updatePeriod);
+        return;
+    }
+
+    UAVObject::Metadata mdata;
+
+    mdata = obj->getDefaultMetadata();
+
+    UAVObject::SetGcsAccess(mdata, UAVObject::ACCESS_READWRITE);
+    UAVObject::SetGcsTelemetryAcked(mdata, false);
+    UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_MANUAL);
+    mdata.gcsTelemetryUpdatePeriod = 0;
+
+    UAVObject::SetFlightAccess(mdata, UAVObject::ACCESS_READONLY);
+    UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_MANUAL);
+
+    obj->setMetadata(mdata);
+}
+
 
 void Simulator::setupInputObject(UAVObject *obj, quint32 updatePeriod)
 {
@@ -381,6 +415,51 @@ void Simulator::telStatsUpdated(UAVObject *obj)
 }
 
 
+void Simulator::sensorsAckUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    QMap<quint32, qint64>::iterator sent = stepSentNs.find(hitlSensorsAck->getStep());
+    if (sent == stepSentNs.end()) {
+        return;
+    }
+    double latencyMs = (stepTimer.nsecsElapsed() - sent.value()) / 1000000.0;
+    // the steps before were lost or are acknowledged by this one
+    while (stepSentNs.begin() != sent) {
+        stepSentNs.erase(stepSentNs.begin());
+    }
+    stepSentNs.erase(sent);
+
+    stepLatencyAvgMs = stepLatencyCount ? 0.95 * stepLatencyAvgMs + 0.05 * latencyMs : latencyMs;
+    stepLatencyMaxMs = qMax(stepLatencyMaxMs, latencyMs);
+    if (++stepLatencyCount % 500 == 0) {
+        qDebug() << "HITL step latency: average" << stepLatencyAvgMs << "ms, max" << stepLatencyMaxMs << "ms";
+        stepLatencyMaxMs = 0;
+    }
+}
+
+void Simulator::sendSensorFrame(HITLSensors::DataFields &frame)
+{
+    bool updated = false;
+
+    for (quint32 i = 0; i < HITLSensors::UPDATED_NUMELEM; i++) {
+        updated |= (frame.Updated[i] == HITLSensors::UPDATED_TRUE);
+    }
+    if (!updated) {
+        return;
+    }
+
+    frame.Step = ++sensorStep;
+    hitlSensors->setData(frame);
+    hitlSensors->updated();
+
+    // steps never acknowledged, by a board without the frame support, are not kept for ever
+    if (stepSentNs.size() >= 1000) {
+        stepSentNs.erase(stepSentNs.begin());
+    }
+    stepSentNs.insert(frame.Step, stepTimer.nsecsElapsed());
+}
+
 void Simulator::resetInitialHomePosition()
 {
     once = false;
@@ -400,6 +479,10 @@ void Simulator::updateUAVOs(Output2Hardware out)
         memset(&noise, 0, sizeof(Noise));
     }
 
+    // with the sensor frame the objects below are only filled in here, and sent at once at the end
+    HITLSensors::DataFields frame;
+    memset(&frame, 0, sizeof(HITLSensors::DataFields));
+
     /*******************************/
     HomeLocation::DataFields homeData = posHome->getData();
     if (!once) {
@@ -483,7 +566,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
         attStateData.q4 = quat[3];
 
         // Set UAVO
-        attState->setData(attStateData);
+        setAttitude(frame, attStateData);
         /*****************************************/
     } else if (settings.attActCalc) {
         // calculate RPY with code from Attitude module
@@ -604,7 +687,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
         attStateData.q4    = q[3];
 
         // Set UAVO
-        attState->setData(attStateData);
+        setAttitude(frame, attStateData);
         /*****************************************/
     }
 
@@ -643,7 +726,16 @@ void Simulator::updateUAVOs(Output2Hardware out)
             gpsPosData.Satellites      = 10;
             gpsPosData.Status = GPSPositionSensor::STATUS_FIX3D;
 
-            gpsPos->setData(gpsPosData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_GPS] = HITLSensors::UPDATED_TRUE;
+                frame.GPSPosition[HITLSensors::GPSPOSITION_LATITUDE]  = gpsPosData.Latitude;
+                frame.GPSPosition[HITLSensors::GPSPOSITION_LONGITUDE] = gpsPosData.Longitude;
+                frame.GPS[HITLSensors::GPS_ALTITUDE]    = gpsPosData.Altitude;
+                frame.GPS[HITLSensors::GPS_HEADING]     = gpsPosData.Heading;
+                frame.GPS[HITLSensors::GPS_GROUNDSPEED] = gpsPosData.Groundspeed;
+            } else {
+                gpsPos->setData(gpsPosData);
+            }
 
             // Update GPS Velocity.{North,East,Down}
             GPSVelocitySensor::DataFields gpsVelData;
@@ -652,7 +744,13 @@ void Simulator::updateUAVOs(Output2Hardware out)
             gpsVelData.East  = out.velEast + noise.gpsVelData.East;
             gpsVelData.Down  = out.velDown + noise.gpsVelData.Down;
 
-            gpsVel->setData(gpsVelData);
+            if (settings.sensorFrameEnabled) {
+                frame.GPSVelocity[HITLSensors::GPSVELOCITY_NORTH] = gpsVelData.North;
+                frame.GPSVelocity[HITLSensors::GPSVELOCITY_EAST]  = gpsVelData.East;
+                frame.GPSVelocity[HITLSensors::GPSVELOCITY_DOWN]  = gpsVelData.Down;
+            } else {
+                gpsVel->setData(gpsVelData);
+            }
 
             gpsPosTime = gpsPosTime.addMSecs(settings.gpsPosRate);
         }
@@ -667,7 +765,13 @@ void Simulator::updateUAVOs(Output2Hardware out)
             velocityStateData.North = out.velNorth + noise.velocityStateData.North;
             velocityStateData.East  = out.velEast + noise.velocityStateData.East;
             velocityStateData.Down  = out.velDown + noise.velocityStateData.Down;
-            velState->setData(velocityStateData);
+            if (settings.sensorFrameEnabled) {
+                frame.Velocity[HITLSensors::VELOCITY_NORTH] = velocityStateData.North;
+                frame.Velocity[HITLSensors::VELOCITY_EAST]  = velocityStateData.East;
+                frame.Velocity[HITLSensors::VELOCITY_DOWN]  = velocityStateData.Down;
+            } else {
+                velState->setData(velocityStateData);
+            }
 
             // Update PositionState.{Nort,East,Down}
             PositionState::DataFields positionStateData;
@@ -675,7 +779,14 @@ void Simulator::updateUAVOs(Output2Hardware out)
             positionStateData.North = (out.dstN - initN) + noise.positionStateData.North;
             positionStateData.East  = (out.dstE - initE) + noise.positionStateData.East;
             positionStateData.Down  = (out.dstD /*-initD*/) + noise.positionStateData.Down;
-            posState->setData(positionStateData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_POSITION] = HITLSensors::UPDATED_TRUE;
+                frame.Position[HITLSensors::POSITION_NORTH]  = positionStateData.North;
+                frame.Position[HITLSensors::POSITION_EAST]   = positionStateData.East;
+                frame.Position[HITLSensors::POSITION_DOWN]   = positionStateData.Down;
+            } else {
+                posState->setData(positionStateData);
+            }
 
             groundTruthTime = groundTruthTime.addMSecs(settings.groundTruthRate);
         }
@@ -712,7 +823,14 @@ void Simulator::updateUAVOs(Output2Hardware out)
             baroAltData.Altitude    = out.altitude + noise.baroAltData.Altitude;
             baroAltData.Temperature = out.temperature + noise.baroAltData.Temperature;
             baroAltData.Pressure    = out.pressure + noise.baroAltData.Pressure;
-            baroAlt->setData(baroAltData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_BARO]  = HITLSensors::UPDATED_TRUE;
+                frame.Baro[HITLSensors::BARO_ALTITUDE]    = baroAltData.Altitude;
+                frame.Baro[HITLSensors::BARO_TEMPERATURE] = baroAltData.Temperature;
+                frame.Baro[HITLSensors::BARO_PRESSURE]    = baroAltData.Pressure;
+            } else {
+                baroAlt->setData(baroAltData);
+            }
 
             baroAltTime = baroAltTime.addMSecs(settings.baroAltRate);
         }
@@ -727,7 +845,14 @@ void Simulator::updateUAVOs(Output2Hardware out)
             batteryData.Voltage = out.voltage;
             batteryData.Current = out.current;
             batteryData.ConsumedEnergy = out.consumption;
-            flightBatt->setData(batteryData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_BATTERY]     = HITLSensors::UPDATED_TRUE;
+                frame.Battery[HITLSensors::BATTERY_VOLTAGE]     = batteryData.Voltage;
+                frame.Battery[HITLSensors::BATTERY_CURRENT]     = batteryData.Current;
+                frame.Battery[HITLSensors::BATTERY_CONSUMEDENERGY] = batteryData.ConsumedEnergy;
+            } else {
+                flightBatt->setData(batteryData);
+            }
 
             battTime = battTime.addMSecs(settings.baroAltRate);
         }
@@ -743,7 +868,13 @@ void Simulator::updateUAVOs(Output2Hardware out)
             airspeedStateData.TrueAirspeed = out.trueAirspeed + noise.airspeedState.TrueAirspeed;
             // airspeedStateData.alpha=out.angleOfAttack; // to be implemented
             // airspeedStateData.beta=out.angleOfSlip;
-            airspeedState->setData(airspeedStateData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_AIRSPEED]  = HITLSensors::UPDATED_TRUE;
+                frame.Airspeed[HITLSensors::AIRSPEED_CALIBRATED] = airspeedStateData.CalibratedAirspeed;
+                frame.Airspeed[HITLSensors::AIRSPEED_TRUE]    = airspeedStateData.TrueAirspeed;
+            } else {
+                airspeedState->setData(airspeedStateData);
+            }
 
             airspeedStateTime = airspeedStateTime.addMSecs(settings.airspeedStateRate);
         }
@@ -759,7 +890,14 @@ void Simulator::updateUAVOs(Output2Hardware out)
             gyroStateData.x = out.rollRate + noise.gyroStateData.x;
             gyroStateData.y = out.pitchRate + noise.gyroStateData.y;
             gyroStateData.z = out.yawRate + noise.gyroStateData.z;
-            gyroState->setData(gyroStateData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_GYRO] = HITLSensors::UPDATED_TRUE;
+                frame.Gyro[HITLSensors::GYRO_X] = gyroStateData.x;
+                frame.Gyro[HITLSensors::GYRO_Y] = gyroStateData.y;
+                frame.Gyro[HITLSensors::GYRO_Z] = gyroStateData.z;
+            } else {
+                gyroState->setData(gyroStateData);
+            }
 
             // Update accelerometer sensor data
             AccelState::DataFields accelStateData;
@@ -767,11 +905,36 @@ void Simulator::updateUAVOs(Output2Hardware out)
             accelStateData.x = out.accX + noise.accelStateData.x;
             accelStateData.y = out.accY + noise.accelStateData.y;
             accelStateData.z = out.accZ + noise.accelStateData.z;
-            accelState->setData(accelStateData);
+            if (settings.sensorFrameEnabled) {
+                frame.Updated[HITLSensors::UPDATED_ACCEL] = HITLSensors::UPDATED_TRUE;
+                frame.Accel[HITLSensors::ACCEL_X] = accelStateData.x;
+                frame.Accel[HITLSensors::ACCEL_Y] = accelStateData.y;
+                frame.Accel[HITLSensors::ACCEL_Z] = accelStateData.z;
+            } else {
+                accelState->setData(accelStateData);
+            }
 
             attRawTime = attRawTime.addMSecs(settings.attRawRate);
         }
     }
+
+    if (settings.sensorFrameEnabled) {
+        sendSensorFrame(frame);
+    }
+}
+
+void Simulator::setAttitude(HITLSensors::DataFields &frame, const AttitudeState::DataFields &attStateData)
+{
+    if (settings.sensorFrameEnabled) {
+        // the board derives roll, pitch and yaw from the quaternion
+        frame.Updated[HITLSensors::UPDATED_ATTITUDE] = HITLSensors::UPDATED_TRUE;
+        frame.Attitude[HITLSensors::ATTITUDE_Q1]     = attStateData.q1;
+        frame.Attitude[HITLSensors::ATTITUDE_Q2]     = attStateData.q2;
+        frame.Attitude[HITLSensors::ATTITUDE_Q3]     = attStateData.q3;
+        frame.Attitude[HITLSensors::ATTITUDE_Q4]     = attStateData.q4;
+    } else {
+        attState->setData(attStateData);
+    }
 }
 
 /**
@@ -46,6 +46,8 @@
 #include "gpsvelocitysensor.h"
 #include "groundtruth.h"
 #include "gyrostate.h"
+#include "hitlsensors.h"
+#include "hitlsensorsack.h"
 #include "homelocation.h"
 #include "manualcontrolcommand.h"
 #include "positionstate.h"
@@ -58,6 +60,8 @@
 #include <QUdpSocket>
 #include <QTime>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QMap>
 #include <QProcess>
 #include <qmath.h>
 
@@ -151,6 +155,9 @@ typedef struct _CONNECTION {
 
     bool    airspeedStateEnabled;
     quint16 airspeedStateRate;
+
+    // the sensors of a step go out in one HITLSensors object
+    bool    sensorFrameEnabled;
 } SimulatorSettings;
 
 
@@ -297,6 +304,7 @@ private slots:
     void onAutopilotDisconnect();
     void onSimulatorConnectionTimeout();
     void telStatsUpdated(UAVObject *obj);
+    void sensorsAckUpdated(UAVObject *obj);
     Q_INVOKABLE void onDeleteSimulator(void);
 
     virtual void transmitUpdate() = 0;
@@ -335,6 +343,8 @@ protected:
     GCSTelemetryStats *telStats;
     GCSReceiver *gcsReceiver;
     GroundTruth *groundTruth;
+    HITLSensors *hitlSensors;
+    HITLSensorsAck *hitlSensorsAck;
 
     SimulatorSettings settings;
 
@@ -363,6 +373,14 @@ private:
     QTime gcsRcvrTime;
     QTime airspeedStateTime;
 
+    // step latency of the sensor frames, from sending to the board handing them on
+    quint32 sensorStep;
+    QElapsedTimer stepTimer;
+    QMap<quint32, qint64> stepSentNs;
+    double stepLatencyAvgMs;
+    double stepLatencyMaxMs;
+    quint32 stepLatencyCount;
+
     QString name;
     QString simulatorId;
     volatile static bool isStarted;
@@ -371,7 +389,10 @@ private:
     void setupOutputObject(UAVObject *obj, quint32 updatePeriod);
     void setupInputObject(UAVObject *obj, quint32 updatePeriod);
     void setupWatchedObject(UAVObject *obj, quint32 updatePeriod);
+    void setupSensorObject(UAVObject *obj, quint32 updatePeriod);
     void setupObjects();
+    void sendSensorFrame(HITLSensors::DataFields &frame);
+    void setAttitude(HITLSensors::DataFields &frame, const AttitudeState::DataFields &attStateData);
 
     AirParameters airParameters;
 };
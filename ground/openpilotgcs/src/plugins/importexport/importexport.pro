@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = ImportExportGadget
 DEFINES += IMPORTEXPORT_LIBRARY
-QT += xml
+QT += xml concurrent
 include(../../openpilotgcsplugin.pri)
 include(importexport_dependencies.pri)
 HEADERS += importexportplugin.h \
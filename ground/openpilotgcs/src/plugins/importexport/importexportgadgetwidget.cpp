@@ -41,6 +41,14 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QDir>
+#include <QCoreApplication>
+#include <QProgressDialog>
+#include <QScopedPointer>
+
+// for parsing in a worker thread
+#include <QtConcurrentRun>
+#include <QFutureWatcher>
+#include <QEventLoop>
 
 ImportExportGadgetWidget::ImportExportGadgetWidget(QWidget *parent) :
     QWidget(parent),
@@ -168,7 +176,11 @@ void ImportExportGadgetWidget::on_importButton_clicked()
         msgBox.exec();
         return;
     }
-    importConfiguration(file);
+    if (!importConfiguration(file)) {
+        msgBox.setText(tr("Can't parse file ") + QFileInfo(file).absoluteFilePath());
+        msgBox.exec();
+        return;
+    }
 
     // The new configs are added to the old configs. Things are messy now.
     msgBox.setText(tr("The settings have been imported from ") + QFileInfo(file).absoluteFilePath()
@@ -177,27 +189,92 @@ void ImportExportGadgetWidget::on_importButton_clicked()
     emit done();
 }
 
-void ImportExportGadgetWidget::importConfiguration(const QString & fileName)
+// Runs in a worker thread: the whole XML file is parsed here and the
+// settings handed back to the GUI thread, where the plugins read them
+static QSettings *parseConfigurationFile(const QString &fileName)
+{
+    QSettings *qs = new QSettings(fileName, XmlConfig::XmlSettingsFormat);
+
+    qs->allKeys();
+    qs->moveToThread(QCoreApplication::instance()->thread());
+    return qs;
+}
+
+// True when both settings hold the same keys and values under group
+static bool sameGroup(QSettings *a, QSettings *b, const QString &group)
+{
+    a->beginGroup(group);
+    b->beginGroup(group);
+    QStringList keys = a->allKeys();
+    bool same = (keys.count() == b->allKeys().count());
+    for (int i = 0; same && i < keys.count(); ++i) {
+        same = b->contains(keys.at(i)) && a->value(keys.at(i)) == b->value(keys.at(i));
+    }
+    b->endGroup();
+    a->endGroup();
+    return same;
+}
+
+bool ImportExportGadgetWidget::importConfiguration(const QString & fileName)
 {
     bool doGeneral    = ui->checkBoxGeneral->isChecked();
     bool doAllGadgets = ui->checkBoxAllGadgets->isChecked();
     bool doPlugins    = ui->checkBoxPlugins->isChecked();
 
-    QSettings qs(fileName, XmlConfig::XmlSettingsFormat);
+    QList<Core::IConfigurablePlugin *> configurables;
+    if (doPlugins) {
+        configurables = getConfigurables();
+    }
+
+    QProgressDialog progress(tr("Parsing %1...").arg(QFileInfo(fileName).fileName()), QString(),
+                             0, 1 + (doAllGadgets ? 1 : 0) + (doGeneral ? 1 : 0) + configurables.count(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(200);
+    progress.setValue(0);
+
+    // Parse the file, the GUI keeps running meanwhile
+    QFutureWatcher<QSettings *> watcher;
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::run(parseConfigurationFile, fileName));
+    if (!watcher.isFinished()) {
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+    QScopedPointer<QSettings> qs(watcher.result());
+    if (qs->status() != QSettings::NoError) {
+        qWarning() << "Import failed, can't parse" << fileName;
+        return false;
+    }
+    int step = 1;
+    progress.setValue(step);
 
     if (doAllGadgets) {
-        Core::ICore::instance()->uavGadgetInstanceManager()->readSettings(&qs);
+        progress.setLabelText(tr("Applying gadget configurations..."));
+        Core::ICore::instance()->uavGadgetInstanceManager()->readSettings(qs.data());
+        progress.setValue(++step);
     }
     if (doGeneral) {
-        Core::ICore::instance()->readMainSettings(&qs);
+        progress.setLabelText(tr("Applying general settings..."));
+        Core::ICore::instance()->readMainSettings(qs.data());
+        progress.setValue(++step);
     }
-    if (doPlugins) {
-        foreach(Core::IConfigurablePlugin * plugin, getConfigurables()) {
-            Core::ICore::instance()->readSettings(plugin, &qs);
+
+    // Only the plugins whose configuration differs from the current one read it again
+    QSettings *current = Core::ICore::instance()->settings();
+    int applied = 0;
+    foreach(Core::IConfigurablePlugin * plugin, configurables) {
+        QString group = QString("Plugins/") + plugin->metaObject()->className();
+
+        if (!sameGroup(qs.data(), current, group)) {
+            progress.setLabelText(tr("Applying %1...").arg(plugin->metaObject()->className()));
+            Core::ICore::instance()->readSettings(plugin, qs.data());
+            ++applied;
         }
+        progress.setValue(++step);
     }
 
-    qDebug() << "Import ended";
+    qDebug() << "Import ended," << applied << "of" << configurables.count() << "plugin configurations changed";
+    return true;
 }
 
 void ImportExportGadgetWidget::on_helpButton_clicked()
@@ -36,7 +36,7 @@ private:
     Ui::ImportExportGadgetWidget *ui;
     void writeError(const QString &) const;
     void exportConfiguration(const QString & fileName);
-    void importConfiguration(const QString & fileName);
+    bool importConfiguration(const QString & fileName);
     QList<Core::IConfigurablePlugin *> getConfigurables();
 
     QString filename;
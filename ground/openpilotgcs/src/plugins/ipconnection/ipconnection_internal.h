@@ -3,8 +3,14 @@
 
 #include "ipconnectionplugin.h"
 
+#include <QtNetwork/QAbstractSocket>
+
+class QTimer;
+
 // Simple class for creating & destroying a socket in the real-time thread
 // Needed because sockets need to be created in the same thread that they're used
+// The socket is handed out while it is still connecting, and is connected again
+// with an increasing delay whenever the link goes down until it is closed
 class IPConnection : public QObject {
     Q_OBJECT
 
@@ -17,6 +23,21 @@ public slots:
 
     void onOpenDevice(QString HostName, int Port, bool UseTCP);
     void onCloseDevice(QAbstractSocket *ipSocket);
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onError(QAbstractSocket::SocketError error);
+    void reconnect();
+
+private:
+    QAbstractSocket *m_socket;
+    QString m_hostName;
+    int m_port;
+    QTimer *m_reconnectTimer;
+    int m_reconnectDelay;
+
+    void scheduleReconnect();
 };
 
 #endif // IPCONNECTION_INTERNAL_H
@@ -42,6 +42,7 @@
 #include <QtNetwork/QUdpSocket>
 #include <QWaitCondition>
 #include <QMutex>
+#include <QTimer>
 #include <coreplugin/threadmanager.h>
 
 #include <QDebug>
@@ -54,8 +55,20 @@ QWaitCondition closeDeviceWait;
 QMutex ipConMutex;
 QAbstractSocket *ret;
 
-IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
+// Delay before connecting again after the link went down, doubled on every failure
+static const int MIN_RECONNECT_DELAY_MS = 500;
+static const int MAX_RECONNECT_DELAY_MS = 8000;
+// Kernel buffers large enough for the bursts of a SITL running faster than real time
+static const int SOCKET_BUFFER_SIZE     = 256 * 1024;
+
+IPConnection::IPConnection(IPconnectionConnection *connection) : QObject(),
+    m_socket(NULL), m_port(0), m_reconnectDelay(MIN_RECONNECT_DELAY_MS)
 {
+    // created before the move so that it follows this object to the real-time thread
+    m_reconnectTimer = new QTimer(this);
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, SIGNAL(timeout()), this, SLOT(reconnect()));
+
     moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
 
     QObject::connect(connection, SIGNAL(CreateSocket(QString, int, bool)),
@@ -71,36 +84,36 @@ IPConnection::IPConnection(IPconnectionConnection *connection) : QObject()
 
 void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
 {
-    QAbstractSocket *ipSocket;
-    const int Timeout = 5 * 1000;
-
     ipConMutex.lock();
-    if (UseTCP) {
-        ipSocket = new QTcpSocket(this);
-    } else {
-        ipSocket = new QUdpSocket(this);
-    }
 
     // do sanity check on hostname and port...
     if ((HostName.length() == 0) || (Port < 1)) {
         errorMsg = "Please configure Host and Port options before opening the connection";
+        /* BUGBUG TODO - returning null here leads to segfault because some caller still calls disconnect without checking our return value properly
+         * someone needs to debug this, I got lost in the calling chain.*/
+        ret = NULL;
+        openDeviceWait.wakeAll();
+        ipConMutex.unlock();
+        return;
+    }
+
+    if (UseTCP) {
+        m_socket = new QTcpSocket(this);
     } else {
-        // try to connect...
-        ipSocket->connectToHost(HostName, Port);
-
-        // in blocking mode so we wait for the connection to succeed
-        if (ipSocket->waitForConnected(Timeout)) {
-            ret = ipSocket;
-            openDeviceWait.wakeAll();
-            ipConMutex.unlock();
-            return;
-        }
-        // tell user something went wrong
-        errorMsg = ipSocket->errorString();
+        m_socket = new QUdpSocket(this);
     }
-    /* BUGBUG TODO - returning null here leads to segfault because some caller still calls disconnect without checking our return value properly
-     * someone needs to debug this, I got lost in the calling chain.*/
-    ret = NULL;
+    m_hostName = HostName;
+    m_port     = Port;
+    m_reconnectDelay = MIN_RECONNECT_DELAY_MS;
+    connect(m_socket, SIGNAL(connected()), this, SLOT(onConnected()));
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    connect(m_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(onError(QAbstractSocket::SocketError)));
+
+    // the socket is open as soon as the connection is started, anything written
+    // before it is established is buffered, so the GUI does not wait for it
+    m_socket->connectToHost(HostName, Port);
+
+    ret = m_socket;
     openDeviceWait.wakeAll();
     ipConMutex.unlock();
 }
@@ -108,12 +121,58 @@ void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
 void IPConnection::onCloseDevice(QAbstractSocket *ipSocket)
 {
     ipConMutex.lock();
+    if (ipSocket == m_socket) {
+        m_reconnectTimer->stop();
+        m_socket = NULL;
+    }
+    ipSocket->disconnect(this);
     ipSocket->close();
     delete (ipSocket);
     closeDeviceWait.wakeAll();
     ipConMutex.unlock();
 }
 
+void IPConnection::onConnected()
+{
+    m_reconnectDelay = MIN_RECONNECT_DELAY_MS;
+    // the options need the native socket, which only exists from now on
+    if (qobject_cast<QTcpSocket *>(m_socket)) {
+        // telemetry packets are small, do not let Nagle hold them back
+        m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    }
+    m_socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, SOCKET_BUFFER_SIZE);
+    m_socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, SOCKET_BUFFER_SIZE);
+}
+
+void IPConnection::onDisconnected()
+{
+    scheduleReconnect();
+}
+
+void IPConnection::onError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    qDebug() << "IPConnection:" << m_hostName << m_port << m_socket->errorString();
+    scheduleReconnect();
+}
+
+void IPConnection::scheduleReconnect()
+{
+    // error() and disconnected() both come when an established link drops
+    if (!m_socket || m_socket->state() != QAbstractSocket::UnconnectedState || m_reconnectTimer->isActive()) {
+        return;
+    }
+    m_reconnectTimer->start(m_reconnectDelay);
+    m_reconnectDelay = qMin(m_reconnectDelay * 2, MAX_RECONNECT_DELAY_MS);
+}
+
+void IPConnection::reconnect()
+{
+    if (m_socket && m_socket->state() == QAbstractSocket::UnconnectedState) {
+        m_socket->connectToHost(m_hostName, m_port);
+    }
+}
+
 
 IPConnection *connection = 0;
 
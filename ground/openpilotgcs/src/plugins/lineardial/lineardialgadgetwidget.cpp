@@ -27,6 +27,7 @@
 
 #include "lineardialgadgetwidget.h"
 #include <utils/stylehelper.h>
+#include <utils/cachedsvgitem.h>
 #include <QFileDialog>
 #include <QtOpenGL/QGLWidget>
 #include <QDebug>
@@ -77,19 +78,20 @@ void LineardialGadgetWidget::enableOpenGL(bool flag)
  */
 void LineardialGadgetWidget::connectInput(QString object1, QString nfield1)
 {
-    if (obj1 != NULL) {
-        disconnect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
-    }
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
+    if (obj1 != NULL) {
+        objManager->unsubscribeFrameUpdates(obj1, this, SLOT(updateIndex(UAVObject *)));
+    }
+
     // qDebug() << "Lineardial Connect needles - " << object1 << "-"<< nfield1;
 
     // Check validity of arguments first, reject empty args and unknown fields.
     if (!(object1.isEmpty() || nfield1.isEmpty())) {
         obj1 = dynamic_cast<UAVDataObject *>(objManager->getObject(object1));
         if (obj1 != NULL) {
-            connect(obj1, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateIndex(UAVObject *)));
+            objManager->subscribeFrameUpdates(obj1, this, SLOT(updateIndex(UAVObject *)));
             if (nfield1.contains("-")) {
                 QStringList fieldSubfield = nfield1.split("-", QString::SkipEmptyParts);
                 field1        = fieldSubfield.at(0);
@@ -171,7 +173,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
     if (QFile::exists(dfn) && m_renderer->load(dfn) && m_renderer->isValid()) {
         l_scene->clear(); // Beware: clear also deletes all objects
                           // which are currently in the scene
-        background = new QGraphicsSvgItem();
+        background = new CachedSvgItem();
         background->setSharedRenderer(m_renderer);
         background->setElementId("background");
         background->setFlags(QGraphicsItem::ItemClipsChildrenToShape |
@@ -183,15 +185,15 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         if (m_renderer->elementExists("red")) {
             // Order is important: red, then yellow then green
             // overlayed on top of each other
-            red = new QGraphicsSvgItem();
+            red = new CachedSvgItem();
             red->setSharedRenderer(m_renderer);
             red->setElementId("red");
             red->setParentItem(background);
-            yellow = new QGraphicsSvgItem();
+            yellow = new CachedSvgItem();
             yellow->setSharedRenderer(m_renderer);
             yellow->setElementId("yellow");
             yellow->setParentItem(background);
-            green = new QGraphicsSvgItem();
+            green = new CachedSvgItem();
             green->setSharedRenderer(m_renderer);
             green->setElementId("green");
             green->setParentItem(background);
@@ -268,7 +270,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             startY = nRect.y();
             QTransform matrix;
             matrix.translate(startX, startY);
-            index  = new QGraphicsSvgItem();
+            index  = new CachedSvgItem();
             index->setSharedRenderer(m_renderer);
             index->setElementId("needle");
             index->setTransform(matrix, false);
@@ -321,7 +323,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
             qreal startY = textMatrix.mapRect(m_renderer->boundsOnElement("symbol")).y();
             QTransform matrix;
             matrix.translate(startX, startY);
-            fieldSymbol = new QGraphicsSvgItem();
+            fieldSymbol = new CachedSvgItem();
             fieldSymbol->setElementId("symbol");
             fieldSymbol->setSharedRenderer(m_renderer);
             fieldSymbol->setTransform(matrix, false);
@@ -331,7 +333,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         }
 
         if (m_renderer->elementExists("foreground")) {
-            foreground = new QGraphicsSvgItem();
+            foreground = new CachedSvgItem();
             foreground->setSharedRenderer(m_renderer);
             foreground->setElementId("foreground");
             foreground->setParentItem(background);
@@ -351,7 +353,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
         qDebug() << "no file ";
         m_renderer->load(QString(":/lineardial/images/empty.svg"));
         l_scene->clear(); // This also deletes all items contained in the scene.
-        background  = new QGraphicsSvgItem();
+        background  = new CachedSvgItem();
         background->setSharedRenderer(m_renderer);
         l_scene->addItem(background);
         fieldName   = NULL;
@@ -37,7 +37,6 @@
 #include <QFileDialog>
 #include <QList>
 #include <QErrorMessage>
-#include <QWriteLocker>
 
 #include <extensionsystem/pluginmanager.h>
 #include <QKeySequence>
@@ -114,9 +113,54 @@ QString LoggingConnection::shortName()
 }
 
 
+LoggingQueue::LoggingQueue() : m_buffer(new char[SIZE]), m_head(0), m_tail(0)
+{}
+
+LoggingQueue::~LoggingQueue()
+{
+    delete[] m_buffer;
+}
+
+bool LoggingQueue::push(const char *data, int size)
+{
+    quint32 head = m_head.load();
+
+    if (size > SIZE - (int)(head - m_tail.loadAcquire())) {
+        return false;
+    }
+    int offset = head & (SIZE - 1);
+    int first  = qMin(size, SIZE - offset);
+    memcpy(&m_buffer[offset], data, first);
+    memcpy(m_buffer, data + first, size - first);
+    m_head.storeRelease(head + size);
+    return true;
+}
+
+int LoggingQueue::peek(char *data, int size) const
+{
+    quint32 tail = m_tail.load();
+
+    size = qMin(size, (int)(m_head.loadAcquire() - tail));
+    int offset = tail & (SIZE - 1);
+    int first  = qMin(size, SIZE - offset);
+    memcpy(data, &m_buffer[offset], first);
+    memcpy(data + first, m_buffer, size - first);
+    return size;
+}
+
+void LoggingQueue::consume(int size)
+{
+    m_tail.storeRelease(m_tail.load() + size);
+}
+
+
+LoggingThread::LoggingThread() : telemetryManager(NULL), droppedFrames(0)
+{}
+
 LoggingThread::~LoggingThread()
 {
     stopLogging();
+    wait();
 }
 
 /**
@@ -128,94 +172,88 @@ LoggingThread::~LoggingThread()
 bool LoggingThread::openFile(QString file, LoggingPlugin *parent)
 {
     logFile.setFileName(file);
-    logFile.open(QIODevice::WriteOnly);
+    if (!logFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    logTime.start();
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
-    uavTalk = new UAVTalk(&logFile, objManager);
+    telemetryManager = pm->getObject<TelemetryManager>();
+    telemetryManager->addFrameLogger(this);
     connect(parent, SIGNAL(stopLoggingSignal()), this, SLOT(stopLogging()));
 
+    GCSTelemetryStats *gcsStatsObj = GCSTelemetryStats::GetInstance(objManager);
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+    if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
+        qDebug() << "Logging: connected already, ask for all settings";
+        retrieveSettings();
+    } else {
+        qDebug() << "Logging: not connected, do no ask for settings";
+    }
+
     return true;
 };
 
 /**
- * Logs an object update to the file.  Data format is the
+ * Queues a frame for the logging thread. Data format is the
  * timestamp as a 32 bit uint counting ms from start of
  * file writing (flight time will be embedded in stream),
- * then object packet size, then the packed UAVObject.
+ * then frame size, then the UAVTalk frame as on the wire.
  */
-void LoggingThread::objectUpdated(UAVObject *obj)
+void LoggingThread::frame(const quint8 *data, qint32 length)
 {
-    QWriteLocker locker(&lock);
+    char record[sizeof(quint32) + sizeof(qint64) + 512];
+    quint32 timeStamp = logTime.elapsed();
+    qint64 size = length;
 
-    if (!uavTalk->sendObject(obj, false, false)) {
-        qDebug() << "Error logging " << obj->getName();
+    if (length > (qint32)(sizeof(record) - sizeof(timeStamp) - sizeof(size))) {
+        return;
+    }
+    memcpy(record, &timeStamp, sizeof(timeStamp));
+    memcpy(record + sizeof(timeStamp), &size, sizeof(size));
+    memcpy(record + sizeof(timeStamp) + sizeof(size), data, length);
+    if (!frameQueue.push(record, sizeof(timeStamp) + sizeof(size) + length)) {
+        droppedFrames.fetchAndAddRelaxed(1);
     }
 };
 
 /**
- * Connect signals from all the objects updates to the write routine then
- * run event loop
+ * Write the queued frames until logging is stopped
  */
 void LoggingThread::run()
 {
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QByteArray block(WRITE_SIZE, 0);
+    bool stopping = false;
 
-    QList< QList<UAVObject *> > list;
-    list = objManager->getObjects();
-    QList< QList<UAVObject *> >::const_iterator i;
-    QList<UAVObject *>::const_iterator j;
-    int objects = 0;
-
-    for (i = list.constBegin(); i != list.constEnd(); ++i) {
-        for (j = (*i).constBegin(); j != (*i).constEnd(); ++j) {
-            connect(*j, SIGNAL(objectUpdated(UAVObject *)), (LoggingThread *)this, SLOT(objectUpdated(UAVObject *)));
-            objects++;
-            // qDebug() << "Detected " << j[0];
-        }
-    }
+    while (!stopping) {
+        // the frames queued until the logger was detached are still written after the stop request
+        stopping = stopRequest.tryAcquire(1, WRITE_PERIOD);
 
-    GCSTelemetryStats *gcsStatsObj = GCSTelemetryStats::GetInstance(objManager);
-    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
-    if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
-        qDebug() << "Logging: connected already, ask for all settings";
-        retrieveSettings();
-    } else {
-        qDebug() << "Logging: not connected, do no ask for settings";
+        int size;
+        while ((size = frameQueue.peek(block.data(), block.size())) > 0) {
+            logFile.write(block.constData(), size);
+            frameQueue.consume(size);
+        }
     }
 
-
-    exec();
+    logFile.close();
+    qDebug() << "File closed," << droppedFrames.load() << "frames dropped";
 }
 
 
 /**
- * Pass this command to the correct thread then close the file
+ * Detach from telemetry and let the thread write what is left and close the file
  */
 void LoggingThread::stopLogging()
 {
-    QWriteLocker locker(&lock);
-
-    // Disconnect all objects we registered with:
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
-    QList< QList<UAVObject *> > list;
-    list = objManager->getObjects();
-    QList< QList<UAVObject *> >::const_iterator i;
-    QList<UAVObject *>::const_iterator j;
-
-    for (i = list.constBegin(); i != list.constEnd(); ++i) {
-        for (j = (*i).constBegin(); j != (*i).constEnd(); ++j) {
-            disconnect(*j, SIGNAL(objectUpdated(UAVObject *)), (LoggingThread *)this, SLOT(objectUpdated(UAVObject *)));
-        }
+    if (telemetryManager) {
+        // no frame is queued anymore once this returns
+        telemetryManager->removeFrameLogger(this);
+        telemetryManager = NULL;
+        stopRequest.release();
     }
-
-    logFile.close();
-    qDebug() << "File closed";
-    quit();
 }
 
 /**
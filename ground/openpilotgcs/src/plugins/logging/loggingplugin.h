@@ -35,11 +35,15 @@
 #include "uavobjectmanager.h"
 #include "gcstelemetrystats.h"
 #include <uavtalk/uavtalk.h>
+#include <uavtalk/telemetrymanager.h>
 #include <utils/logfile.h>
 
 #include <QThread>
 #include <QQueue>
-#include <QReadWriteLock>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QAtomicInteger>
 
 class LoggingPlugin;
 class LoggingGadgetFactory;
@@ -87,15 +91,52 @@ protected:
 };
 
 
-class LoggingThread : public QThread {
+/**
+ *   Single producer single consumer byte queue between UAVTalk and the logging
+ *   thread. Only the producer moves the head and only the consumer the tail,
+ *   so neither side needs a lock. The indices run freely and wrap with
+ *   unsigned arithmetic.
+ */
+class LoggingQueue {
+public:
+    // must be a power of two
+    static const int SIZE = 1 << 20;
+
+    LoggingQueue();
+    ~LoggingQueue();
+
+    /** Producer side: queue all of data or nothing if there is not enough room */
+    bool push(const char *data, int size);
+
+    /** Consumer side: copy up to size bytes without removing them */
+    int peek(char *data, int size) const;
+
+    /** Consumer side: remove size bytes, after a peek() that returned at least that much */
+    void consume(int size);
+
+private:
+    char *m_buffer;
+    QAtomicInteger<quint32> m_head;
+    QAtomicInteger<quint32> m_tail;
+};
+
+/**
+ *   Writes the frames the telemetry UAVTalk sends and receives to the log.
+ *   UAVTalk only queues them, this thread writes what was queued in large
+ *   blocks a few times a second.
+ */
+class LoggingThread : public QThread, public UAVTalkFrameLogger {
     Q_OBJECT
 public:
+    LoggingThread();
     virtual ~LoggingThread();
 
     bool openFile(QString file, LoggingPlugin *parent);
 
+    // UAVTalkFrameLogger, called by UAVTalk with its lock held
+    void frame(const quint8 *data, qint32 length);
+
 private slots:
-    void objectUpdated(UAVObject *obj);
     void transactionCompleted(UAVObject *obj, bool success);
 
 public slots:
@@ -103,11 +144,18 @@ public slots:
 
 protected:
     void run();
-    QReadWriteLock lock;
-    LogFile logFile;
-    UAVTalk *uavTalk;
+    QFile logFile;
 
 private:
+    static const int WRITE_PERIOD = 100;
+    static const int WRITE_SIZE   = 64 * 1024;
+
+    TelemetryManager *telemetryManager;
+    QElapsedTimer logTime;
+    LoggingQueue frameQueue;
+    QSemaphore stopRequest;
+    QAtomicInteger<quint32> droppedFrames;
+
     QQueue<UAVDataObject *> queue;
 
     void retrieveSettings();
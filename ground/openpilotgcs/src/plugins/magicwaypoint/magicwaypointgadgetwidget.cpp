@@ -46,9 +46,14 @@ MagicWaypointGadgetWidget::MagicWaypointGadgetWidget(QWidget *parent) : QLabel(p
     m_magicwaypoint = new Ui_MagicWaypoint();
     m_magicwaypoint->setupUi(this);
 
-    // Connect object updated event from UAVObject to also update check boxes
-    connect(getPathDesired(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(positionStateChanged(UAVObject *)));
-    connect(getPositionState(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(positionStateChanged(UAVObject *)));
+    m_pathDesired   = getPathDesired();
+    m_positionState = getPositionState();
+    m_scale = 1.0;
+
+    // Follow the objects, at most once per frame however fast they are sent
+    UAVObjectManager *objManager = ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+    objManager->subscribeFrameUpdates(m_pathDesired, this, SLOT(pathDesiredChanged(UAVObject *)));
+    objManager->subscribeFrameUpdates(m_positionState, this, SLOT(positionStateChanged(UAVObject *)));
 
     // Connect updates from the position widget to this widget
     connect(m_magicwaypoint->widgetPosition, SIGNAL(positionClicked(double, double)), this, SLOT(positionSelected(double, double)));
@@ -98,9 +103,9 @@ PositionState *MagicWaypointGadgetWidget::getPositionState()
  */
 void MagicWaypointGadgetWidget::scaleChanged(int scale)
 {
-    Q_UNUSED(scale);
-    pathDesiredChanged(getPathDesired());
-    positionStateChanged(getPositionState());
+    m_scale = scale;
+    pathDesiredChanged(m_pathDesired);
+    positionStateChanged(m_positionState);
 }
 
 /**
@@ -108,11 +113,10 @@ void MagicWaypointGadgetWidget::scaleChanged(int scale)
  */
 void MagicWaypointGadgetWidget::positionStateChanged(UAVObject *)
 {
-    PositionState::DataFields positionState = getPositionState()->getData();
-    double scale = m_magicwaypoint->horizontalSliderScale->value();
+    PositionState::DataFields positionState = m_positionState->getData();
 
-    emit positionStateObjectChanged(positionState.North / scale,
-                                    positionState.East / scale);
+    emit positionStateObjectChanged(positionState.North / m_scale,
+                                    positionState.East / m_scale);
 }
 
 /**
@@ -120,11 +124,10 @@ void MagicWaypointGadgetWidget::positionStateChanged(UAVObject *)
  */
 void MagicWaypointGadgetWidget::pathDesiredChanged(UAVObject *)
 {
-    PathDesired::DataFields pathDesired = getPathDesired()->getData();
-    double scale = m_magicwaypoint->horizontalSliderScale->value();
+    PathDesired::DataFields pathDesired = m_pathDesired->getData();
 
-    emit positionDesiredObjectChanged(pathDesired.End[PathDesired::END_NORTH] / scale,
-                                      pathDesired.End[PathDesired::END_EAST] / scale);
+    emit positionDesiredObjectChanged(pathDesired.End[PathDesired::END_NORTH] / m_scale,
+                                      pathDesired.End[PathDesired::END_EAST] / m_scale);
 }
 
 /**
@@ -132,14 +135,12 @@ void MagicWaypointGadgetWidget::pathDesiredChanged(UAVObject *)
  */
 void MagicWaypointGadgetWidget::positionSelected(double north, double east)
 {
-    double scale = m_magicwaypoint->horizontalSliderScale->value();
-
-    PathDesired::DataFields pathDesired = getPathDesired()->getData();
+    PathDesired::DataFields pathDesired = m_pathDesired->getData();
 
-    pathDesired.End[PathDesired::END_NORTH] = north * scale;
-    pathDesired.End[PathDesired::END_EAST]  = east * scale;
+    pathDesired.End[PathDesired::END_NORTH] = north * m_scale;
+    pathDesired.End[PathDesired::END_EAST]  = east * m_scale;
     pathDesired.Mode = PathDesired::MODE_FLYENDPOINT;
-    getPathDesired()->setData(pathDesired);
+    m_pathDesired->setData(pathDesired);
 }
 
 /**
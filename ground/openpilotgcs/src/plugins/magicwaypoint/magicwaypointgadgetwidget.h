@@ -55,6 +55,10 @@ private:
     PathDesired *getPathDesired();
     PositionState *getPositionState();
     Ui_MagicWaypoint *m_magicwaypoint;
+    PathDesired *m_pathDesired;
+    PositionState *m_positionState;
+    // meters per unit of the position field, from the scale slider
+    double m_scale;
 };
 
 #endif /* MagicWaypointGADGETWIDGET_H_ */
@@ -71,6 +71,10 @@ PositionField::PositionField(QWidget *parent) :
     l_scene->addItem(m_positiondesired);
     l_scene->addItem(m_positionactual);
     l_scene->setSceneRect(m_background->boundingRect());
+
+    m_halfScene     = l_scene->sceneRect().size() / 2;
+    m_desiredCenter = m_positiondesired->boundingRect().center();
+    m_actualCenter  = m_positionactual->boundingRect().center();
 }
 
 PositionField::~PositionField()
@@ -81,20 +85,28 @@ PositionField::~PositionField()
  */
 void PositionField::updateDesiredIndicator(double north, double east)
 {
-    QRectF sceneSize = scene()->sceneRect();
-
-    m_positiondesired->setPos(
-        (east + 1) / 2 * sceneSize.width() - m_positiondesired->boundingRect().width() / 2,
-        (-north + 1) / 2 * sceneSize.height() - m_positiondesired->boundingRect().height() / 2);
+    moveIndicator(m_positiondesired, m_desiredCenter, north, east);
 }
 
 void PositionField::updateActualIndicator(double north, double east)
 {
-    QRectF sceneSize = scene()->sceneRect();
+    moveIndicator(m_positionactual, m_actualCenter, north, east);
+}
 
-    m_positionactual->setPos(
-        (east + 1) / 2 * sceneSize.width() - m_positionactual->boundingRect().width() / 2,
-        (-north + 1) / 2 * sceneSize.height() - m_positionactual->boundingRect().height() / 2);
+/**
+ * @brief Moves an indicator unless it would not move by a whole pixel on screen
+ */
+void PositionField::moveIndicator(QGraphicsSvgItem *indicator, const QPointF &center, double north, double east)
+{
+    QPointF pos((east + 1) * m_halfScene.width() - center.x(),
+                (-north + 1) * m_halfScene.height() - center.y());
+    // the view only scales the scene, see resizeEvent()
+    QPointF moved = transform().map(pos - indicator->pos()) - QPointF(transform().dx(), transform().dy());
+
+    if (qAbs(moved.x()) < 0.5 && qAbs(moved.y()) < 0.5) {
+        return;
+    }
+    indicator->setPos(pos);
 }
 
 /**
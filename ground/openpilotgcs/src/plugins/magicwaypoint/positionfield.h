@@ -64,6 +64,12 @@ private:
     QGraphicsSvgItem *m_background;
     QGraphicsSvgItem *m_positiondesired;
     QGraphicsSvgItem *m_positionactual;
+    // the scene and the indicators have a fixed size, half of it is kept
+    QSizeF m_halfScene;
+    QPointF m_desiredCenter;
+    QPointF m_actualCenter;
+
+    void moveIndicator(QGraphicsSvgItem *indicator, const QPointF &center, double north, double east);
 };
 
 #endif // POSITIONFIELD_H
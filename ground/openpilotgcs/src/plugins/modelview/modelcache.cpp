@@ -0,0 +1,177 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modelcache.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ModelViewPlugin ModelView Plugin
+ * @{
+ * @brief Binary cache of the meshes of the loaded 3D models
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "modelcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+
+#include "glc_factory.h"
+#include "geometry/glc_bsrep.h"
+#include "geometry/glc_mesh.h"
+#include "sceneGraph/glc_structoccurence.h"
+#include "sceneGraph/glc_structreference.h"
+#include "utils/pathutils.h"
+
+// "OPMC"
+#define MODELCACHE_MAGIC   0x4F504D43
+#define MODELCACHE_VERSION 1
+
+ModelCache::ModelCache()
+    : m_cachePath(Utils::PathUtils().GetStoragePath() + "modelcache" + QDir::separator())
+{}
+
+GLC_World ModelCache::load(QFile &file)
+{
+    const QString cacheFile = cacheFileName(file);
+
+    if (!cacheFile.isEmpty()) {
+        GLC_3DRep rep;
+        if (read(cacheFile, rep)) {
+            GLC_World world;
+            world.rootOccurence()->addChild(new GLC_StructOccurence(new GLC_3DRep(rep)));
+            return world;
+        }
+    }
+
+    GLC_World world = GLC_Factory::instance()->createWorldFromFile(file);
+
+    if (!cacheFile.isEmpty() && !write(cacheFile, world)) {
+        qDebug() << "ModelCache: could not cache" << file.fileName();
+    }
+    return world;
+}
+
+/**
+ * The cache file is named after the hash of the model content, so an edited
+ * or replaced model never matches a stale entry. Models in the resources are
+ * small and are not cached.
+ */
+QString ModelCache::cacheFileName(QFile &file) const
+{
+    if (file.fileName().startsWith(':')) {
+        return QString();
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    file.close();
+
+    return m_cachePath + QString(hash.result().toHex()) + ".bin";
+}
+
+bool ModelCache::read(const QString &cacheFileName, GLC_3DRep &rep) const
+{
+    QFile file(cacheFileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // Map the cache instead of reading it, the meshes are deserialized
+    // straight from the page cache
+    const qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    QByteArray bytes;
+    if (data) {
+        bytes = QByteArray::fromRawData(reinterpret_cast<const char *>(data), size);
+    } else {
+        bytes = file.readAll();
+    }
+
+    bool ok = false;
+    {
+        QDataStream stream(bytes);
+        stream.setVersion(QDataStream::Qt_4_6);
+        stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+        quint32 magic, version, repVersion;
+        stream >> magic >> version >> repVersion;
+        if (magic == MODELCACHE_MAGIC && version == MODELCACHE_VERSION && repVersion == GLC_BSRep::version()) {
+            stream >> rep;
+            ok = (stream.status() == QDataStream::Ok) && !rep.isEmpty();
+        }
+    }
+
+    if (data) {
+        file.unmap(data);
+    }
+    return ok;
+}
+
+/**
+ * All meshes of the world are flattened into one representation, with the
+ * placement of their occurence applied to the vertices. The model view only
+ * moves the root occurence so nothing is lost.
+ */
+bool ModelCache::write(const QString &cacheFileName, const GLC_World &world) const
+{
+    GLC_3DRep rep;
+
+    foreach(GLC_StructOccurence * occurence, world.listOfOccurence()) {
+        if (!occurence->hasRepresentation()) {
+            continue;
+        }
+        GLC_3DRep *occurenceRep = dynamic_cast<GLC_3DRep *>(occurence->structReference()->representationHandle());
+        if (!occurenceRep) {
+            return false;
+        }
+        const GLC_Matrix4x4 matrix = occurence->absoluteMatrix();
+        for (int i = 0; i < occurenceRep->numberOfBody(); i++) {
+            GLC_Mesh *mesh = dynamic_cast<GLC_Mesh *>(occurenceRep->geomAt(i));
+            if (!mesh) {
+                // only meshes are cached
+                return false;
+            }
+            GLC_Mesh *copy = new GLC_Mesh(*mesh);
+            copy->transformVertice(matrix);
+            rep.addGeom(copy);
+        }
+    }
+    if (rep.isEmpty() || !QDir().mkpath(m_cachePath)) {
+        return false;
+    }
+
+    // Written to a temporary file and renamed, a reader never sees half a cache
+    QSaveFile file(cacheFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << (quint32)MODELCACHE_MAGIC << (quint32)MODELCACHE_VERSION << GLC_BSRep::version();
+    stream << rep;
+
+    return (stream.status() == QDataStream::Ok) && file.commit();
+}
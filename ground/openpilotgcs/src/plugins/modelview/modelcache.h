@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ *
+ * @file       modelcache.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ModelViewPlugin ModelView Plugin
+ * @{
+ * @brief Binary cache of the meshes of the loaded 3D models
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MODELCACHE_H_
+#define MODELCACHE_H_
+
+#include <QFile>
+#include <QString>
+
+#include "geometry/glc_3drep.h"
+#include "sceneGraph/glc_world.h"
+
+/**
+ * Parsing a 3ds/obj/3dxml model and building its meshes takes a noticeable
+ * time on every load. The meshes of a model are stored once in the cache,
+ * already transformed and ready for the vertex buffers, under the hash of
+ * the model file. When the file content changes the hash changes and the
+ * model is parsed again.
+ */
+class ModelCache {
+public:
+    ModelCache();
+
+    // Return the world of the given model file, from the cache when possible
+    GLC_World load(QFile &file);
+
+private:
+    QString m_cachePath;
+
+    QString cacheFileName(QFile &file) const;
+    bool read(const QString &cacheFileName, GLC_3DRep &rep) const;
+    bool write(const QString &cacheFileName, const GLC_World &world) const;
+};
+
+#endif // MODELCACHE_H_
@@ -11,13 +11,15 @@ HEADERS += modelviewplugin.h \
     modelviewgadget.h \
     modelviewgadgetwidget.h \
     modelviewgadgetfactory.h \
-    modelviewgadgetoptionspage.h
+    modelviewgadgetoptionspage.h \
+    modelcache.h
 SOURCES += modelviewplugin.cpp \
     modelviewgadgetconfiguration.cpp \
     modelviewgadget.cpp \
     modelviewgadgetfactory.cpp \
     modelviewgadgetwidget.cpp \
-    modelviewgadgetoptionspage.cpp
+    modelviewgadgetoptionspage.cpp \
+    modelcache.cpp
 OTHER_FILES += ModelViewGadget.pluginspec
 FORMS += modelviewoptionspage.ui
 
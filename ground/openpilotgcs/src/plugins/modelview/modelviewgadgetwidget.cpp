@@ -44,10 +44,13 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
     , m_GlView()
     , m_MoverController()
     , m_ModelBoundingBox()
-    , m_MotionTimer()
+    , m_ModelCache()
     , acFilename()
     , bgFilename()
     , vboEnable(false)
+    , glInitialized(false)
+    , frameTime(0)
+    , frameCount(0)
 {
     connect(&m_GlView, SIGNAL(updateOpenGL()), this, SLOT(updateGL()));
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
@@ -66,10 +69,9 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
     CreateScene();
     // Get required UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    attState = AttitudeState::GetInstance(objManager);
-
-    connect(&m_MotionTimer, SIGNAL(timeout()), this, SLOT(updateAttitude()));
+    objManager = pm->getObject<UAVObjectManager>();
+    attState   = AttitudeState::GetInstance(objManager);
+    memset(&lastAttitude, 0, sizeof(lastAttitude));
 }
 
 ModelViewGadgetWidget::~ModelViewGadgetWidget()
@@ -99,13 +101,27 @@ void ModelViewGadgetWidget::setBgFilename(QString bgf)
 void ModelViewGadgetWidget::setVboEnable(bool eVbo)
 {
     vboEnable = eVbo;
-    m_World.collection()->setVboUsage(vboEnable);
+    applyVboUsage();
+}
+
+void ModelViewGadgetWidget::applyVboUsage()
+{
+    // the scene is static, only the model matrix changes, its geometry is uploaded once
+    if (glInitialized) {
+        makeCurrent();
+        m_World.collection()->setVboUsage(vboEnable);
+    }
 }
 
 //// Public funcitons ////
 void ModelViewGadgetWidget::reloadScene()
 {
     CreateScene();
+    // the new model has to be rotated even if the attitude does not change
+    memset(&lastAttitude, 0, sizeof(lastAttitude));
+    if (glInitialized) {
+        updateAttitude();
+    }
 }
 
 //// Private functions ////
@@ -126,12 +142,16 @@ void ModelViewGadgetWidget::initializeGL()
     // Enable antialiasing
     glEnable(GL_MULTISAMPLE);
 
-    m_MotionTimer.start(100);
+    glInitialized = true;
+    applyVboUsage();
+    // repaint once per display frame at most, whatever the telemetry rate
+    objManager->subscribeFrameUpdates(attState, this, SLOT(updateAttitude()));
     setFocusPolicy(Qt::StrongFocus); // keyboard capture for camera switching
 }
 
 void ModelViewGadgetWidget::paintGL()
 {
+    frameTimer.start();
     try {
         // Clear screen
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -167,6 +187,9 @@ void ModelViewGadgetWidget::paintGL()
     } catch(GLC_Exception &e) {
         qDebug() << e.what();
     }
+    // time taken to submit the frame, the GPU work itself is not waited for
+    double elapsed = frameTimer.nsecsElapsed() / 1000000.0;
+    frameTime = frameCount++ ? frameTime * 0.9 + elapsed * 0.1 : elapsed;
 }
 
 void ModelViewGadgetWidget::resizeGL(int width, int height)
@@ -200,9 +223,10 @@ void ModelViewGadgetWidget::CreateScene()
     try {
         if (QFile::exists(acFilename)) {
             QFile aircraft(acFilename);
-            m_World = GLC_Factory::instance()->createWorldFromFile(aircraft);
+            m_World = m_ModelCache.load(aircraft);
             m_ModelBoundingBox = m_World.boundingBox();
             m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
+            applyVboUsage();
         } else {
             qDebug("ModelView: aircraft file not found.");
         }
@@ -229,7 +253,6 @@ void ModelViewGadgetWidget::mousePressEvent(QMouseEvent *e)
 
     switch (e->button()) {
     case (Qt::LeftButton):
-        m_MotionTimer.stop();
         m_MoverController.setActiveMover(GLC_MoverController::TurnTable, userInput);
         updateGL();
         break;
@@ -238,6 +261,7 @@ void ModelViewGadgetWidget::mousePressEvent(QMouseEvent *e)
                vboEnable ? "yes" : "no",
                GLC_State::vboSupported() ? "yes" : "no",
                GLC_State::vboUsed() ? "yes" : "no");
+        printf("Frame time: %.2f ms over %u frames\n", frameTime, frameCount);
         printf("Renderer - %s \n", (char *)glGetString(GL_RENDERER));
         printf("Extensions - %s\n", (char *)glGetString(GL_EXTENSIONS));
         break;
@@ -264,7 +288,6 @@ void ModelViewGadgetWidget::mouseReleaseEvent(QMouseEvent *)
         return;
     }
     m_MoverController.setNoMover();
-    m_MotionTimer.start();
     updateGL();
 }
 
@@ -323,6 +346,14 @@ void ModelViewGadgetWidget::keyPressEvent(QKeyEvent *e) // switch between camera
 void ModelViewGadgetWidget::updateAttitude()
 {
     AttitudeState::DataFields data  = attState->getData(); // get attitude data
+
+    // the camera is being moved, or there is nothing new to draw
+    if (m_MoverController.hasActiveMover() ||
+        (data.q1 == lastAttitude.q1 && data.q2 == lastAttitude.q2 && data.q3 == lastAttitude.q3 && data.q4 == lastAttitude.q4)) {
+        return;
+    }
+    lastAttitude = data;
+
     GLC_StructOccurence *rootObject = m_World.rootOccurence(); // get the full 3D model
     double x = data.q3;
     double y = data.q2;
@@ -29,7 +29,7 @@
 #define MODELVIEWGADGETWIDGET_H_
 
 #include <QGLWidget>
-#include <QTimer>
+#include <QElapsedTimer>
 
 #include "glc_factory.h"
 #include "viewport/glc_viewport.h"
@@ -37,6 +37,7 @@
 #include "shading/glc_light.h"
 #include "sceneGraph/glc_world.h"
 #include "glc_exception.h"
+#include "modelcache.h"
 
 #include "uavobjectmanager.h"
 #include "attitudestate.h"
@@ -82,14 +83,24 @@ private:
     GLC_Viewport m_GlView;
     GLC_MoverController m_MoverController;
     GLC_BoundingBox m_ModelBoundingBox;
-    // ! The timer used for motion
-    QTimer m_MotionTimer;
+    ModelCache m_ModelCache;
 
     QString acFilename;
     QString bgFilename;
     bool vboEnable;
+    // the VBOs are created in the GL context, once it is initialized
+    bool glInitialized;
 
+    UAVObjectManager *objManager;
     AttitudeState *attState;
+    AttitudeState::DataFields lastAttitude;
+
+    // average time spent in paintGL(), in ms
+    QElapsedTimer frameTimer;
+    double frameTime;
+    quint32 frameCount;
+
+    void applyVboUsage();
 };
 
 #endif /* MODELVIEWGADGETWIDGET_H_ */
@@ -28,6 +28,7 @@
 // Qt headers
 #include <QtCore/QDataStream>
 #include <QFile>
+#include <string.h>
 
 // GCS headers
 #include "extensionsystem/pluginmanager.h"
@@ -49,6 +50,12 @@ NotificationItem::NotificationItem(QObject *parent)
     , isNowPlaying(0)
     , _isPlayed(false)
     , _currentUpdatePlayed(false)
+    , _object(NULL)
+    , _field(NULL)
+    , _fieldOffset(0)
+    , _fieldSize(0)
+    , _value(0)
+    , _lastCondition(false)
     , _timer(NULL)
     , _expireTimer(NULL)
     , _soundCollectionPath("")
@@ -438,6 +445,58 @@ QString NotificationItem::getSoundCaption(QString fileName)
     return fileName;
 }
 
+bool NotificationItem::compile()
+{
+    _object = NULL;
+    _field  = NULL;
+    _lastBytes.clear();
+    _lastCondition = false;
+
+    UAVDataObject *obj = getUAVObject();
+    if (!obj) {
+        return false;
+    }
+    UAVObjectField *field = obj->getField(getObjectField());
+    if (!field || field->getName().isEmpty() || !field->getNumElements()) {
+        return false;
+    }
+    // the sequence only depends on the settings, it is resolved once here
+    if (toSoundList().isEmpty()) {
+        return false;
+    }
+
+    // rules look at the first element only
+    _fieldOffset = field->getDataOffset();
+    _fieldSize   = field->getNumBytes() / field->getNumElements();
+    if (UAVObjectField::ENUM == field->getType()) {
+        // enum fields are compared by option index, -1 never matches
+        _value = -1;
+        QStringList options = field->getOptions();
+        for (int i = 0; i < options.size(); i++) {
+            if (!QString::compare(options.at(i), singleValue().toString(), Qt::CaseInsensitive)) {
+                _value = i;
+                break;
+            }
+        }
+    } else {
+        _value = singleValue().toDouble();
+    }
+    _object = obj;
+    _field  = field;
+    return true;
+}
+
+bool NotificationItem::fieldChanged(const quint8 *snapshot)
+{
+    const char *bytes = reinterpret_cast<const char *>(snapshot + _fieldOffset);
+
+    if (_lastBytes.size() == (int)_fieldSize && !memcmp(_lastBytes.constData(), bytes, _fieldSize)) {
+        return false;
+    }
+    _lastBytes = QByteArray(bytes, _fieldSize);
+    return true;
+}
+
 UAVObjectField *NotificationItem::getUAVObjectField()
 {
     return getUAVObject()->getField(getObjectField());
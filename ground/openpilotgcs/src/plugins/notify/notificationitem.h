@@ -33,6 +33,7 @@
 #include "qsettings.h"
 #include <qstringlist.h>
 #include <QTimer>
+#include <QByteArray>
 
 using namespace Core;
 
@@ -184,6 +185,45 @@ public:
     UAVDataObject *getUAVObject(void);
     UAVObjectField *getUAVObjectField(void);
 
+    /**
+     * Resolve the rule against its object once, so updates are checked on
+     * the raw object data: watched field, its offset and size, the threshold
+     * as a number or enum index, and the sound files to play.
+     *
+     * @return false if the object or field is unknown or a sound is missing
+     */
+    bool compile();
+
+    UAVDataObject *compiledObject() const
+    {
+        return _object;
+    }
+    UAVObjectField *compiledField() const
+    {
+        return _field;
+    }
+    double compiledValue() const
+    {
+        return _value;
+    }
+
+    /**
+     * Compare the bytes of the watched field in an object snapshot with those
+     * seen by the previous call
+     *
+     * @return true if they changed, or on the first call after compile()
+     */
+    bool fieldChanged(const quint8 *snapshot);
+
+    bool lastCondition() const
+    {
+        return _lastCondition;
+    }
+    void setLastCondition(bool value)
+    {
+        _lastCondition = value;
+    }
+
     void serialize(QDataStream & stream);
     void deserialize(QDataStream & stream);
 
@@ -244,6 +284,15 @@ private:
 
     bool _currentUpdatePlayed;
 
+    // ! rule resolved by compile()
+    UAVDataObject *_object;
+    UAVObjectField *_field;
+    quint32 _fieldOffset;
+    quint32 _fieldSize;
+    double _value;
+    QByteArray _lastBytes;
+    bool _lastCondition;
+
     QTimer *_timer;
 
     // ! time from putting notification in queue till moment when notification became out-of-date
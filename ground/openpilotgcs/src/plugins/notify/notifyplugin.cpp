@@ -48,6 +48,7 @@ static const QString VERSION = "1.0.0";
 SoundNotifyPlugin::SoundNotifyPlugin()
 {
     phonon.mo = NULL;
+    playlist  = NULL;
 }
 
 SoundNotifyPlugin::~SoundNotifyPlugin()
@@ -184,16 +185,15 @@ void SoundNotifyPlugin::connectNotifications()
     if (phonon.mo != NULL) {
         delete phonon.mo;
         phonon.mo = NULL;
+        playlist  = NULL;
     }
 
     if (!enableSound) {
         return;
     }
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
     lstNotifiedUAVObjects.clear();
+    _objectNotifications.clear();
     _pendingNotifications.clear();
     _notificationList.append(_toRemoveNotifications);
     _toRemoveNotifications.clear();
@@ -206,23 +206,21 @@ void SoundNotifyPlugin::connectNotifications()
         if (notify->mute()) {
             continue;
         }
-        // check is all sounds presented for notification,
+        // check is all sounds presented for notification and the field is known,
         // if not - we must not subscribe to it at all
-        if (notify->toSoundList().isEmpty()) {
+        if (!notify->compile()) {
+            qNotifyDebug() << "Error: rule cannot be used (" << notify->getDataObject() << notify->getObjectField() << ").";
             continue;
         }
 
-        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(notify->getDataObject()));
-        if (obj != NULL) {
-            if (!lstNotifiedUAVObjects.contains(obj)) {
-                lstNotifiedUAVObjects.append(obj);
+        UAVDataObject *obj = notify->compiledObject();
+        _objectNotifications[obj].append(notify);
+        if (!lstNotifiedUAVObjects.contains(obj)) {
+            lstNotifiedUAVObjects.append(obj);
 
-                connect(obj, SIGNAL(objectUpdated(UAVObject *)),
-                        this, SLOT(on_arrived_Notification(UAVObject *)),
-                        Qt::QueuedConnection);
-            }
-        } else {
-            qNotifyDebug() << "Error: Object is unknown (" << notify->getDataObject() << ").";
+            connect(obj, SIGNAL(objectUpdated(UAVObject *)),
+                    this, SLOT(on_arrived_Notification(UAVObject *)),
+                    Qt::QueuedConnection);
         }
     }
 
@@ -232,18 +230,24 @@ void SoundNotifyPlugin::connectNotifications()
     // set notification message to current event
     phonon.mo = new QMediaPlayer;
     phonon.firstPlay = true;
+    playlist = new QMediaPlaylist(phonon.mo);
+    phonon.mo->setPlaylist(playlist);
     connect(phonon.mo, SIGNAL(stateChanged(QMediaPlayer::State)),
             this, SLOT(stateChanged(QMediaPlayer::State)));
 }
 
 void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
 {
-    foreach(NotificationItem * ntf, _notificationList) {
-        if (object->getName() != ntf->getDataObject()) {
-            continue;
-        }
+    QList<NotificationItem *> rules = _objectNotifications.value(object);
 
+    if (rules.isEmpty()) {
+        return;
+    }
+    // one snapshot of the object serves all its rules
+    _snapshot.resize(object->getNumBytes());
+    object->getDataSnapshot(reinterpret_cast<quint8 *>(_snapshot.data()));
 
+    foreach(NotificationItem * ntf, rules) {
         // skip duplicate notifications
         if (_nowPlayingNotification == ntf) {
             continue;
@@ -262,16 +266,8 @@ void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
             continue;
         }
 
-        qNotifyDebug() << QString("new notification: | %1 | %2 | val1: %3 | val2: %4")
-            .arg(ntf->getDataObject())
-            .arg(ntf->getObjectField())
-            .arg(ntf->singleValue().toString())
-            .arg(ntf->valueRange2());
-
-        checkNotificationRule(ntf, object);
+        checkNotificationRule(ntf, reinterpret_cast<const quint8 *>(_snapshot.constData()));
     }
-    connect(object, SIGNAL(objectUpdated(UAVObject *)),
-            this, SLOT(on_arrived_Notification(UAVObject *)), Qt::UniqueConnection);
 }
 
 
@@ -295,11 +291,11 @@ void SoundNotifyPlugin::on_timerRepeated_Notification()
         .arg(notification->getObjectField())
         .arg(notification->toString());
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVObject *object = objManager->getObject(notification->getDataObject());
+    UAVObject *object = notification->compiledObject();
     if (object) {
-        checkNotificationRule(notification, object);
+        _snapshot.resize(object->getNumBytes());
+        object->getDataSnapshot(reinterpret_cast<quint8 *>(_snapshot.data()));
+        checkNotificationRule(notification, reinterpret_cast<const quint8 *>(_snapshot.constData()));
     }
 }
 
@@ -354,23 +350,6 @@ void SoundNotifyPlugin::stateChanged(QMediaPlayer::State newstate)
     }
 }
 
-bool checkRange(QString fieldValue, QString enumValue, QStringList /* values */, int direction)
-{
-    bool ret = false;
-
-    switch (direction) {
-    case NotifyPluginOptionsPage::equal:
-        ret = !QString::compare(enumValue, fieldValue, Qt::CaseInsensitive) ? true : false;
-        break;
-
-    default:
-        ret = true;
-        break;
-    }
-    ;
-    return ret;
-}
-
 bool checkRange(double fieldValue, double min, double max, int direction)
 {
     bool ret = false;
@@ -398,47 +377,42 @@ bool checkRange(double fieldValue, double min, double max, int direction)
     return ret;
 }
 
-void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UAVObject *object)
+/**
+ * Evaluate a compiled rule on a snapshot of its object, the field is only
+ * decoded again when its bytes changed since the previous evaluation
+ */
+bool SoundNotifyPlugin::evaluateRule(NotificationItem *notification, const quint8 *snapshot)
 {
-    if (notification->getDataObject() != object->getName() || object->getField(notification->getObjectField()) == NULL) {
-        return;
-    }
-    bool condition = false;
-
-    if (notification->mute()) {
-        return;
+    if (!notification->fieldChanged(snapshot)) {
+        return notification->lastCondition();
     }
 
-    int direction         = notification->getCondition();
-    QString fieldName     = notification->getObjectField();
-    UAVObjectField *field = object->getField(fieldName);
+    UAVObjectField *field = notification->compiledField();
+    int direction = notification->getCondition();
+    bool condition;
 
-    if (field->getName().isEmpty()) {
-        return;
-    }
-
-    QVariant value = field->getValue();
     if (UAVObjectField::ENUM == field->getType()) {
-        qNotifyDebug() << "Check range ENUM" << value.toString() << "|" << notification->singleValue().toString() << "|" << field->getOptions() << "|" <<
-            direction << checkRange(value.toString(),
-                                    notification->singleValue().toString(),
-                                    field->getOptions(),
-                                    direction);;
-        condition = checkRange(value.toString(),
-                               notification->singleValue().toString(),
-                               field->getOptions(),
-                               direction);
+        // only equality is defined for enums, other directions always match
+        condition = (direction != NotifyPluginOptionsPage::equal) ||
+                    (field->getInt(0, snapshot) == (qint64)notification->compiledValue());
     } else {
-        qNotifyDebug() << "Check range VAL" << value.toString() << "|" << notification->singleValue().toString() << "|" << field->getOptions() << "|" <<
-            direction << checkRange(value.toDouble(),
-                                    notification->singleValue().toDouble(),
-                                    notification->valueRange2(),
-                                    direction);
-        condition = checkRange(value.toDouble(),
-                               notification->singleValue().toDouble(),
+        condition = checkRange(field->getDouble(0, snapshot),
+                               notification->compiledValue(),
                                notification->valueRange2(),
                                direction);
     }
+    qNotifyDebug() << "Check rule" << notification->getDataObject() << notification->getObjectField() << direction << condition;
+
+    notification->setLastCondition(condition);
+    return condition;
+}
+
+void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, const quint8 *snapshot)
+{
+    if (notification->mute() || !notification->compiledField()) {
+        return;
+    }
+    bool condition = evaluateRule(notification, snapshot);
 
     notification->_isPlayed = condition;
     // if condition has been changed, and already in false state
@@ -471,7 +445,6 @@ void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UA
 
 bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
 {
-    playlist = new QMediaPlaylist;
     if (!notification) {
         return false;
     }
@@ -491,6 +464,7 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
 
         if (notification->retryValue() == NotificationItem::repeatOnce) {
             _toRemoveNotifications.append(_notificationList.takeAt(_notificationList.indexOf(notification)));
+            _objectNotifications[notification->compiledObject()].removeOne(notification);
         } else if (notification->retryValue() == NotificationItem::repeatOncePerUpdate) {
             notification->setCurrentUpdatePlayed(true);
         } else {
@@ -520,11 +494,12 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
         }
         phonon.mo->stop();
         qNotifyDebug() << "play: " << notification->toString();
-        foreach(QString item, notification->toSoundList()) {
+        // the sequence was resolved when the rule was compiled, the playlist is reused
+        playlist->clear();
+        foreach(QString item, notification->getMessageSequence()) {
             playlist->addMedia(QUrl::fromLocalFile(item));
         }
         qNotifyDebug() << "begin play";
-        phonon.mo->setPlaylist(playlist);
         phonon.mo->play();
         qNotifyDebug() << "end play";
         phonon.firstPlay = false; // On Linux, you sometimes have to nudge Phonon to play 1 time before
@@ -34,6 +34,7 @@
 #include "notificationitem.h"
 
 #include <QSettings>
+#include <QHash>
 #include <QMediaPlaylist>
 #include <QMediaPlayer>
 
@@ -83,7 +84,8 @@ private:
     Q_DISABLE_COPY(SoundNotifyPlugin)
 
     bool playNotification(NotificationItem *notification);
-    void checkNotificationRule(NotificationItem *notification, UAVObject *object);
+    void checkNotificationRule(NotificationItem *notification, const quint8 *snapshot);
+    bool evaluateRule(NotificationItem *notification, const quint8 *snapshot);
 
 private slots:
 
@@ -101,6 +103,10 @@ private:
     bool enableSound;
 
     QList<UAVDataObject *> lstNotifiedUAVObjects;
+    // ! compiled rules of each watched object, in the order of _notificationList
+    QHash<UAVObject *, QList<NotificationItem *> > _objectNotifications;
+    // ! buffer for the object data the rules are evaluated on
+    QByteArray _snapshot;
     QList<NotificationItem *> _notificationList;
     QList<NotificationItem *> _pendingNotifications;
     QList<NotificationItem *> _toRemoveNotifications;
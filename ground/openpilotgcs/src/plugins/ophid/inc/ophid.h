@@ -46,6 +46,8 @@ class RawHIDWriteThread;
  */
 class OPHID_EXPORT RawHID : public QIODevice {
     Q_OBJECT
+    // mean time in us the USB stack takes to accept a report, read by the telemetry statistics
+    Q_PROPERTY(quint32 txLatency READ txLatency)
 
     friend class RawHIDReadThread;
     friend class RawHIDWriteThread;
@@ -59,6 +61,8 @@ public:
     virtual void close();
     virtual bool isSequential() const;
 
+    quint32 txLatency() const;
+
 signals:
     void closed();
 
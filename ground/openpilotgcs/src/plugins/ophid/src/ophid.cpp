@@ -32,7 +32,9 @@
 #include <QtGlobal>
 #include <QList>
 #include <QMutexLocker>
-#include <QWaitCondition>
+#include <QSemaphore>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
 
 class IConnection;
 
@@ -43,6 +45,70 @@ static const int READ_SIZE     = 64;
 static const int WRITE_TIMEOUT = 1000;
 static const int WRITE_SIZE    = 64;
 
+// capacity of the read and write queues, must be a power of two
+static const int QUEUE_SIZE    = 1 << 16;
+
+
+// *********************************************************************************
+
+/**
+ *   Single producer single consumer byte queue between a HID thread and the
+ *   QIODevice API. Only the producer moves the head and only the consumer the
+ *   tail, so neither side needs a lock. The indices run freely and wrap with
+ *   unsigned arithmetic.
+ */
+class RawHIDQueue {
+public:
+    RawHIDQueue() : m_head(0), m_tail(0)
+    {}
+
+    /** Bytes queued, may be called from either side */
+    int used() const
+    {
+        return m_head.loadAcquire() - m_tail.loadAcquire();
+    }
+
+    /** Producer side: queue all of data or nothing if there is not enough room */
+    bool push(const char *data, int size)
+    {
+        quint32 head = m_head.load();
+
+        if (size > QUEUE_SIZE - (int)(head - m_tail.loadAcquire())) {
+            return false;
+        }
+        int offset = head & (QUEUE_SIZE - 1);
+        int first  = qMin(size, QUEUE_SIZE - offset);
+        memcpy(&m_buffer[offset], data, first);
+        memcpy(m_buffer, data + first, size - first);
+        m_head.storeRelease(head + size);
+        return true;
+    }
+
+    /** Consumer side: copy up to size bytes without removing them */
+    int peek(char *data, int size) const
+    {
+        quint32 tail = m_tail.load();
+
+        size = qMin(size, (int)(m_head.loadAcquire() - tail));
+        int offset = tail & (QUEUE_SIZE - 1);
+        int first  = qMin(size, QUEUE_SIZE - offset);
+        memcpy(data, &m_buffer[offset], first);
+        memcpy(data + first, m_buffer, size - first);
+        return size;
+    }
+
+    /** Consumer side: remove size bytes, after a peek() that returned at least that much */
+    void consume(int size)
+    {
+        m_tail.storeRelease(m_tail.load() + size);
+    }
+
+private:
+    char m_buffer[QUEUE_SIZE];
+    QAtomicInteger<quint32> m_head;
+    QAtomicInteger<quint32> m_tail;
+};
+
 
 // *********************************************************************************
 
@@ -69,12 +135,8 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
-
-    /** A mutex to protect read buffer */
-    QMutex m_readBufMtx;
+    /** Filled by this thread, drained by RawHID::readData() */
+    RawHIDQueue m_readBuffer;
 
     RawHID *m_hid;
 
@@ -101,6 +163,9 @@ public:
     /** Return the number of bytes buffered */
     qint64 getBytesToWrite();
 
+    /** Return the mean time taken to send one report, in us */
+    quint32 getSendLatency();
+
 public slots:
     void terminate()
     {
@@ -110,15 +175,14 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    /** Filled by RawHID::writeData(), drained by this thread */
+    RawHIDQueue m_writeBuffer;
 
-    /** A mutex to protect read buffer */
-    QMutex m_writeBufMtx;
+    /** Synchronize task with data arival, released once per push */
+    QSemaphore m_newDataToWrite;
 
-    /** Synchronize task with data arival */
-    QWaitCondition m_newDataToWrite;
+    /** Running mean of the send time of a report in us */
+    QAtomicInteger<quint32> m_sendLatency;
 
     RawHID *m_hid;
 
@@ -169,10 +233,12 @@ void RawHIDReadThread::run()
         int ret = hiddev->receive(hidno, buffer, READ_SIZE, READ_TIMEOUT);
 
         if (ret > 0) { // read some data
-            QMutexLocker lock(&m_readBufMtx);
             // Note: Preprocess the USB packets in this OS independent code
             // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append(&buffer[2], buffer[1]);
+            int size = qBound(0, (int)buffer[1], READ_SIZE - 2);
+            if (!m_readBuffer.push(&buffer[2], size)) {
+                qDebug() << "RawHIDReadThread: read queue full, report dropped";
+            }
 
             emit m_hid->readyRead();
         } else if (ret == 0) { // nothing read
@@ -188,27 +254,22 @@ void RawHIDReadThread::run()
 
 int RawHIDReadThread::getReadData(char *data, int size)
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    size = qMin(size, m_readBuffer.size());
-
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
+    size = m_readBuffer.peek(data, size);
+    m_readBuffer.consume(size);
 
     return size;
 }
 
 qint64 RawHIDReadThread::getBytesAvailable()
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    return m_readBuffer.size();
+    return m_readBuffer.used();
 }
 
 // *********************************************************************************
 
 RawHIDWriteThread::RawHIDWriteThread(RawHID *hid)
-    : m_hid(hid),
+    : m_sendLatency(0),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -225,66 +286,71 @@ RawHIDWriteThread::~RawHIDWriteThread()
 
 void RawHIDWriteThread::run()
 {
+    QElapsedTimer timer;
+
     while (m_running) {
-        char buffer[WRITE_SIZE] = { 0 };
-        int size;
-
-        {
-            QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            while (size <= 0) {
-                // wait on new data to write condition, the timeout
-                // enable the thread to shutdown properly
-                m_newDataToWrite.wait(&m_writeBufMtx, 200);
-                if (!m_running) {
-                    return;
-                }
-
-                size = m_writeBuffer.size();
-            }
+        // wait on new data to write, the timeout
+        // enable the thread to shutdown properly
+        if (!m_newDataToWrite.tryAcquire(1, 200)) {
+            continue;
+        }
+        // every push released the semaphore, this wakeup sends them all
+        m_newDataToWrite.tryAcquire(m_newDataToWrite.available());
+
+        // send reports until the queue is empty, the data stays queued
+        // until it is sent to know how much was sent
+        while (m_running && m_writeBuffer.used() > 0) {
+            char buffer[WRITE_SIZE] = { 0 };
 
             // NOTE: data size is limited to 2 bytes less than the
             // usb packet size (64 bytes for interrupt) to make room
             // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
+            int size = m_writeBuffer.peek(&buffer[2], WRITE_SIZE - 2);
             buffer[1] = size; // valid data length
             buffer[0] = 2; // reportID
-        }
-
-        // must hold lock through the send to know how much was sent
-        int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
-
-        if (ret > 0) {
-            // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
 
-            emit m_hid->bytesWritten(ret - 2);
-        } else if (ret < 0) { // < 0 => error
-            // TODO! make proper error handling, this only quick hack for unplug freeze
-            m_running = false;
-            qDebug() << "Error writing to device (" << ret << ")";
-        } else {
-            qDebug() << "No data written to device ??";
+            timer.start();
+            int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
+            quint32 elapsed = timer.nsecsElapsed() / 1000;
+
+            if (ret > 0) {
+                // only remove the size actually written to the device
+                m_writeBuffer.consume(size);
+                m_sendLatency.storeRelease((m_sendLatency.loadAcquire() * 7 + elapsed) / 8);
+
+                emit m_hid->bytesWritten(ret - 2);
+            } else if (ret < 0) { // < 0 => error
+                // TODO! make proper error handling, this only quick hack for unplug freeze
+                m_running = false;
+                qDebug() << "Error writing to device (" << ret << ")";
+            } else {
+                qDebug() << "No data written to device ??";
+                break;
+            }
         }
     }
 }
 
 int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 {
-    QMutexLocker lock(&m_writeBufMtx);
-
-    m_writeBuffer.append(data, size);
-    m_newDataToWrite.wakeOne(); // signal that new data arrived
+    // whole packets only, a truncated one would just be dropped by the receiver
+    if (!m_writeBuffer.push(data, size)) {
+        qDebug() << "RawHIDWriteThread: write queue full," << size << "bytes dropped";
+        return 0;
+    }
+    m_newDataToWrite.release(); // signal that new data arrived
 
     return size;
 }
 
 qint64 RawHIDWriteThread::getBytesToWrite()
 {
-    // QMutexLocker lock(&m_writeBufMtx);
-    return m_writeBuffer.size();
+    return m_writeBuffer.used();
+}
+
+quint32 RawHIDWriteThread::getSendLatency()
+{
+    return m_sendLatency.loadAcquire();
 }
 
 // *********************************************************************************
@@ -473,6 +539,17 @@ qint64 RawHID::bytesToWrite() const
     return m_writeThread->getBytesToWrite() + QIODevice::bytesToWrite();
 }
 
+quint32 RawHID::txLatency() const
+{
+    QMutexLocker locker(m_mutex);
+
+    if (!m_writeThread) {
+        return 0;
+    }
+
+    return m_writeThread->getSendLatency();
+}
+
 qint64 RawHID::readData(char *data, qint64 maxSize)
 {
     QMutexLocker locker(m_mutex);
@@ -124,10 +124,12 @@ int opHID_hidapi::enumerate(struct hid_device_info * *current_device_pptr, int *
  *
  * \param[in] vid USB vendor id of the device to open (-1 for any).
  * \param[in] pid USB product id of the device to open (-1 for any).
+ * \param[in] serial USB serial number of the device to open, empty for the first one found.
+ *            Only used when both vid and pid are given.
  * \return Number of opened device.
  * \retval 0 or 1.
  */
-int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
+int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage, const QString &serial)
 {
     int devices_found = false;
     struct hid_device_info *current_device_ptr    = NULL;
@@ -152,7 +154,12 @@ int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
 
     // If caller knows which one to look for open it right away
     if (vid != 0 && pid != 0) {
-        handle = hid_open(vid, pid, NULL);
+        if (serial.isEmpty()) {
+            handle = hid_open(vid, pid, NULL);
+        } else {
+            std::wstring wserial = serial.toStdWString();
+            handle = hid_open(vid, pid, wserial.c_str());
+        }
 
         if (!handle) {
             OPHID_ERROR("Unable to open device.");
@@ -27,9 +27,11 @@
 #include "modeluavoproxy.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjecthelper.h"
+#include "telemetrymanager.h"
 
 #include <QProgressDialog>
 #include <math.h>
+#include <string.h>
 
 ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObject(parent), myModel(model)
 {
@@ -39,60 +41,76 @@ ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObjec
 
     objMngr = pm->getObject<UAVObjectManager>();
     Q_ASSERT(objMngr != NULL);
+
+    // compiling and sending hundreds of waypoints must not block the GUI
+    qRegisterMetaType<PathPlanRows>("PathPlanRows");
+    uploader = new PathPlanUploader(objMngr);
+    uploader->moveToThread(&uploaderThread);
+    connect(&uploaderThread, SIGNAL(finished()), uploader, SLOT(deleteLater()));
+    connect(uploader, SIGNAL(progress(int, int)), this, SLOT(onUploadProgress(int, int)));
+    connect(uploader, SIGNAL(completed(bool)), this, SLOT(onUploadCompleted(bool)));
+    uploaderThread.start();
+
+    // the board may have lost its plan, send everything next time
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    if (telMngr) {
+        connect(telMngr, SIGNAL(disconnected()), uploader, SLOT(invalidate()));
+    }
 }
 
-void ModelUavoProxy::sendPathPlan()
+ModelUavoProxy::~ModelUavoProxy()
 {
-    modelToObjects();
-
-    PathPlan *pathPlan      = PathPlan::GetInstance(objMngr);
-
-    const int waypointCount = pathPlan->getWaypointCount();
-    const int actionCount   = pathPlan->getPathActionCount();
+    // a send in progress gives up after the UAVTalk timeout of the current object
+    uploaderThread.quit();
+    uploaderThread.wait();
+}
 
-    QProgressDialog progress(tr("Sending the path plan to the board... "), "", 0, 1 + waypointCount + actionCount);
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setCancelButton(NULL);
-    progress.show();
+void ModelUavoProxy::sendPathPlan()
+{
+    if (uploadProgress) {
+        return;
+    }
 
-    UAVObjectUpdaterHelper updateHelper;
+    // the model belongs to the GUI thread, hand a copy of its rows to the uploader
+    PathPlanRows rows;
+    int waypointCount = myModel->rowCount();
+    rows.waypoints.resize(waypointCount);
+    rows.actions.resize(waypointCount);
+    for (int i = 0; i < waypointCount; ++i) {
+        memset(&rows.waypoints[i], 0, sizeof(Waypoint::DataFields));
+        memset(&rows.actions[i], 0, sizeof(PathAction::DataFields));
+        modelToWaypoint(i, rows.waypoints[i]);
+        modelToPathAction(i, rows.actions[i]);
+    }
 
-    // send PathPlan
-    bool success = (updateHelper.doObjectAndWait(pathPlan) == UAVObjectUpdaterHelper::SUCCESS);
-    progress.setValue(1);
+    uploadProgress = new QProgressDialog(tr("Sending the path plan to the board... "), "", 0, 0);
+    uploadProgress->setAttribute(Qt::WA_DeleteOnClose);
+    uploadProgress->setWindowModality(Qt::WindowModal);
+    uploadProgress->setCancelButton(NULL);
+    uploadProgress->show();
 
-    if (success) {
-        // send Waypoint instances
-        qDebug() << "sending" << waypointCount << "waypoints";
-        for (int i = 0; i < waypointCount; ++i) {
-            Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(waypoint) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
-    }
+    QMetaObject::invokeMethod(uploader, "send", Qt::QueuedConnection, Q_ARG(PathPlanRows, rows));
+}
 
-    if (success) {
-        // send PathAction instances
-        qDebug() << "sending" << actionCount << "path actions";
-        for (int i = 0; i < actionCount; ++i) {
-            PathAction *action = PathAction::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(action) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
+void ModelUavoProxy::onUploadProgress(int done, int total)
+{
+    if (uploadProgress) {
+        uploadProgress->setMaximum(total);
+        uploadProgress->setValue(done);
     }
+    emit sendPathPlanProgress(done, total);
+}
 
+void ModelUavoProxy::onUploadCompleted(bool success)
+{
     qDebug() << "ModelUavoProxy::pathPlanSent - completed" << success;
+    if (uploadProgress) {
+        uploadProgress->close();
+    }
     if (!success) {
         QMessageBox::critical(NULL, tr("Sending Path Plan Failed!"), tr("Failed to send the path plan to the board."));
     }
-
-    progress.close();
+    emit sendPathPlanCompleted(success);
 }
 
 void ModelUavoProxy::receivePathPlan()
@@ -155,6 +173,7 @@ void ModelUavoProxy::receivePathPlan()
     qDebug() << "ModelUavoProxy::pathPlanReceived - completed" << success;
     if (success) {
         objectsToModel();
+        QMetaObject::invokeMethod(uploader, "markObjectsSent", Qt::QueuedConnection);
     } else {
         QMessageBox::critical(NULL, tr("Receiving Path Plan Failed!"), tr("Failed to receive the path plan from the board."));
     }
@@ -162,177 +181,6 @@ void ModelUavoProxy::receivePathPlan()
     progress.close();
 }
 
-// update waypoint and path actions UAV objects
-//
-// waypoints are unique and each waypoint has an entry in the UAV waypoint list
-//
-// a path action can be referenced by multiple waypoints
-// waypoints reference path action by their index in the UAV path action list
-// the compression of path actions happens here.
-// (compression consists in keeping only one instance of similar path actions)
-//
-// the UAV waypoint list and path action list are probably not empty, so we try to reuse existing instances
-bool ModelUavoProxy::modelToObjects()
-{
-    qDebug() << "ModelUAVProxy::modelToObjects";
-
-    // track number of path actions
-    int actionCount   = 0;
-
-    // iterate over waypoints
-    int waypointCount = myModel->rowCount();
-    for (int i = 0; i < waypointCount; ++i) {
-        // Path Actions
-
-        // create action to use as a search criteria
-        // this object does not need to be deleted as it will either be added to the managed list or deleted later
-        PathAction *action = new PathAction;
-
-        // get model data
-        PathAction::DataFields actionData = action->getData();
-        modelToPathAction(i, actionData);
-
-        // see if that path action has already been added in this run
-        PathAction *foundAction = findPathAction(actionData, actionCount);
-        // TODO this test needs a consistency check as it is unsafe.
-        // if the find method is buggy and returns false positives then the flight plan sent to the uav is broken!
-        // the find method should do a "binary" compare instead of a field by field compare
-        // if a field is added everywhere and not in the compare method then you can start having false positives
-        if (!foundAction) {
-            // create or reuse an action instance
-            action = createPathAction(actionCount, action);
-            actionCount++;
-
-            // update UAVObject
-            action->setData(actionData);
-        } else {
-            action->deleteLater();
-            action = foundAction;
-            qDebug() << "ModelUAVProxy::modelToObjects - found action instance :" << action->getInstID();
-        }
-
-        // Waypoints
-
-        // create or reuse a waypoint instance
-        Waypoint *waypoint = createWaypoint(i, NULL);
-        Q_ASSERT(waypoint);
-
-        // get model data
-        Waypoint::DataFields waypointData = waypoint->getData();
-        modelToWaypoint(i, waypointData);
-
-        // connect waypoint to path action
-        waypointData.Action = action->getInstID();
-
-        // update UAVObject
-        waypoint->setData(waypointData);
-    }
-
-    // Put "safe" values in unused waypoint and path action objects
-    if (waypointCount < objMngr->getNumInstances(Waypoint::OBJID)) {
-        for (int i = waypointCount; i < objMngr->getNumInstances(Waypoint::OBJID); ++i) {
-            // TODO
-        }
-    }
-    if (actionCount < objMngr->getNumInstances(PathAction::OBJID)) {
-        for (int i = actionCount; i < objMngr->getNumInstances(PathAction::OBJID); ++i) {
-            // TODO
-        }
-    }
-
-    // Update PathPlan
-    PathPlan *pathPlan = PathPlan::GetInstance(objMngr);
-    PathPlan::DataFields pathPlanData = pathPlan->getData();
-
-    pathPlanData.WaypointCount   = waypointCount;
-    pathPlanData.PathActionCount = actionCount;
-    pathPlanData.Crc = computePathPlanCrc(waypointCount, actionCount);
-
-    pathPlan->setData(pathPlanData);
-
-    return true;
-}
-
-Waypoint *ModelUavoProxy::createWaypoint(int index, Waypoint *newWaypoint)
-{
-    Waypoint *waypoint = NULL;
-    int count = objMngr->getNumInstances(Waypoint::OBJID);
-
-    if (index < count) {
-        // reuse object
-        qDebug() << "ModelUAVProxy::createWaypoint - reused waypoint instance :" << index << "/" << count;
-        waypoint = Waypoint::GetInstance(objMngr, index);
-        if (newWaypoint) {
-            newWaypoint->deleteLater();
-        }
-    } else if (index < count + 1) {
-        // create "next" object
-        qDebug() << "ModelUAVProxy::createWaypoint - created waypoint instance :" << index;
-        // TODO is there a limit to the number of wp?
-        waypoint = newWaypoint ? newWaypoint : new Waypoint;
-        waypoint->initialize(index, waypoint->getMetaObject());
-        objMngr->registerObject(waypoint);
-    } else {
-        // we can only create the "next" object
-        // TODO fail in a clean way :(
-    }
-    return waypoint;
-}
-
-PathAction *ModelUavoProxy::createPathAction(int index, PathAction *newAction)
-{
-    PathAction *action = NULL;
-    int count = objMngr->getNumInstances(PathAction::OBJID);
-
-    if (index < count) {
-        // reuse object
-        qDebug() << "ModelUAVProxy::createPathAction - reused action instance :" << index << "/" << count;
-        action = PathAction::GetInstance(objMngr, index);
-        if (newAction) {
-            newAction->deleteLater();
-        }
-    } else if (index < count + 1) {
-        // create "next" object
-        qDebug() << "ModelUAVProxy::createPathAction - created action instance :" << index;
-        // TODO is there a limit to the number of path actions?
-        action = newAction ? newAction : new PathAction;
-        action->initialize(index, action->getMetaObject());
-        objMngr->registerObject(action);
-    } else {
-        // we can only create the "next" object
-        // TODO fail in a clean way :(
-    }
-    return action;
-}
-
-PathAction *ModelUavoProxy::findPathAction(const PathAction::DataFields &actionData, int actionCount)
-{
-    int instancesCount = objMngr->getNumInstances(PathAction::OBJID);
-    int count = actionCount <= instancesCount ? actionCount : instancesCount;
-
-    for (int i = 0; i < count; ++i) {
-        PathAction *action = PathAction::GetInstance(objMngr, i);
-        Q_ASSERT(action);
-        if (!action) {
-            continue;
-        }
-        PathAction::DataFields fields = action->getData();
-        if (fields.Command == actionData.Command
-            && fields.ConditionParameters[0] == actionData.ConditionParameters[0]
-            && fields.ConditionParameters[1] == actionData.ConditionParameters[1]
-            && fields.ConditionParameters[2] == actionData.ConditionParameters[2]
-            && fields.EndCondition == actionData.EndCondition
-            && fields.ErrorDestination == actionData.ErrorDestination
-            && fields.JumpDestination == actionData.JumpDestination && fields.Mode == actionData.Mode
-            && fields.ModeParameters[0] == actionData.ModeParameters[0]
-            && fields.ModeParameters[1] == actionData.ModeParameters[1]
-            && fields.ModeParameters[2] == actionData.ModeParameters[2]) {
-            return action;
-        }
-    }
-    return NULL;
-}
-
 bool ModelUavoProxy::objectsToModel()
 {
     // build model from uav objects
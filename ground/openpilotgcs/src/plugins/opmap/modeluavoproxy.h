@@ -28,35 +28,45 @@
 #define MODELUAVOPROXY_H
 
 #include "flightdatamodel.h"
+#include "pathplanuploader.h"
 
 #include "pathplan.h"
 #include "pathaction.h"
 #include "waypoint.h"
 
 #include <QObject>
+#include <QThread>
+#include <QPointer>
+#include <QProgressDialog>
 
 class ModelUavoProxy : public QObject {
     Q_OBJECT
 
 public:
     explicit ModelUavoProxy(QObject *parent, flightDataModel *model);
+    ~ModelUavoProxy();
 
 public slots:
     void sendPathPlan();
     void receivePathPlan();
 
+signals:
+    void sendPathPlanProgress(int done, int total);
+    void sendPathPlanCompleted(bool success);
+
+private slots:
+    void onUploadProgress(int done, int total);
+    void onUploadCompleted(bool success);
+
 private:
     UAVObjectManager *objMngr;
     flightDataModel *myModel;
+    QThread uploaderThread;
+    PathPlanUploader *uploader;
+    QPointer<QProgressDialog> uploadProgress;
 
-    bool modelToObjects();
     bool objectsToModel();
 
-    Waypoint *createWaypoint(int index, Waypoint *newWaypoint);
-    PathAction *createPathAction(int index, PathAction *newAction);
-
-    PathAction *findPathAction(const PathAction::DataFields & actionFields, int actionCount);
-
     void modelToWaypoint(int i, Waypoint::DataFields &data);
     void modelToPathAction(int i, PathAction::DataFields &data);
 
@@ -27,6 +27,8 @@ HEADERS += opmapplugin.h \
     widgetdelegates.h \
     pathplanner.h \
     modeluavoproxy.h \
+    pathplanuploader.h \
+    trackexporter.h \
     homeeditor.h
 
 SOURCES += opmapplugin.cpp \
@@ -43,6 +45,8 @@ SOURCES += opmapplugin.cpp \
     widgetdelegates.cpp \
     pathplanner.cpp \
     modeluavoproxy.cpp \
+    pathplanuploader.cpp \
+    trackexporter.cpp \
     homeeditor.cpp
 
 OTHER_FILES += OPMapGadget.pluginspec
@@ -43,7 +43,9 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(QString classId, QSettings *q
     m_uavSymbol(QString::fromUtf8(":/uavs/images/mapquad.png")),
     m_maxUpdateRate(2000), // ms
     m_settings(qSettings),
-    m_opacity(1)
+    m_opacity(1),
+    m_trailLength(10000), // points
+    m_trailTolerance(1.0) // screen pixels
 {
     // if a saved configuration exists load it
     if (qSettings != 0) {
@@ -61,6 +63,15 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(QString classId, QSettings *q
 
         m_opacity = qSettings->value("overlayOpacity", 1).toReal();
 
+        m_trailLength    = qSettings->value("trailLength", m_trailLength).toInt();
+        if (m_trailLength < 0 || m_trailLength > 1000000) {
+            m_trailLength = 10000;
+        }
+        m_trailTolerance = qSettings->value("trailTolerance", m_trailTolerance).toReal();
+        if (m_trailTolerance < 0 || m_trailTolerance > 10) {
+            m_trailTolerance = 1.0;
+        }
+
         if (!mapProvider.isEmpty()) {
             m_mapProvider = mapProvider;
         }
@@ -102,6 +113,8 @@ IUAVGadgetConfiguration *OPMapGadgetConfiguration::clone()
     m->m_uavSymbol = m_uavSymbol;
     m->m_maxUpdateRate     = m_maxUpdateRate;
     m->m_opacity = m_opacity;
+    m->m_trailLength       = m_trailLength;
+    m->m_trailTolerance    = m_trailTolerance;
 
     return m;
 }
@@ -122,6 +135,8 @@ void OPMapGadgetConfiguration::saveConfig() const
     m_settings->setValue("cacheLocation", Utils::PathUtils().RemoveStoragePath(m_cacheLocation));
     m_settings->setValue("maxUpdateRate", m_maxUpdateRate);
     m_settings->setValue("overlayOpacity", m_opacity);
+    m_settings->setValue("trailLength", m_trailLength);
+    m_settings->setValue("trailTolerance", m_trailTolerance);
 }
 void OPMapGadgetConfiguration::saveConfig(QSettings *qSettings) const
 {
@@ -137,6 +152,8 @@ void OPMapGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("cacheLocation", Utils::PathUtils().RemoveStoragePath(m_cacheLocation));
     qSettings->setValue("maxUpdateRate", m_maxUpdateRate);
     qSettings->setValue("overlayOpacity", m_opacity);
+    qSettings->setValue("trailLength", m_trailLength);
+    qSettings->setValue("trailTolerance", m_trailTolerance);
 }
 void OPMapGadgetConfiguration::setCacheLocation(QString cacheLocation)
 {
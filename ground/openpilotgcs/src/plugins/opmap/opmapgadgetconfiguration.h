@@ -46,6 +46,8 @@ class OPMapGadgetConfiguration : public IUAVGadgetConfiguration {
     Q_PROPERTY(QString uavSymbol READ uavSymbol WRITE setUavSymbol)
     Q_PROPERTY(int maxUpdateRate READ maxUpdateRate WRITE setMaxUpdateRate)
     Q_PROPERTY(qreal overlayOpacity READ opacity WRITE setOpacity)
+    Q_PROPERTY(int trailLength READ trailLength WRITE setTrailLength)
+    Q_PROPERTY(qreal trailTolerance READ trailTolerance WRITE setTrailTolerance)
 
 public:
     explicit OPMapGadgetConfiguration(QString classId, QSettings *qSettings = 0, QObject *parent = 0);
@@ -101,6 +103,14 @@ public:
     {
         return m_opacity;
     }
+    int trailLength() const
+    {
+        return m_trailLength;
+    }
+    qreal trailTolerance() const
+    {
+        return m_trailTolerance;
+    }
     void saveConfig() const;
 public slots:
     void setMapProvider(QString provider)
@@ -148,6 +158,14 @@ public slots:
     {
         m_maxUpdateRate = update_rate;
     }
+    void setTrailLength(int length)
+    {
+        m_trailLength = length;
+    }
+    void setTrailTolerance(qreal tolerance)
+    {
+        m_trailTolerance = tolerance;
+    }
 
 private:
     QString m_mapProvider;
@@ -163,6 +181,8 @@ private:
     int m_maxUpdateRate;
     QSettings *m_settings;
     qreal m_opacity;
+    int m_trailLength;
+    qreal m_trailTolerance;
 };
 
 #endif // OPMAP_GADGETCONFIGURATION_H
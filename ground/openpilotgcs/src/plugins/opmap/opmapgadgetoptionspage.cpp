@@ -83,6 +83,9 @@ QWidget *OPMapGadgetOptionsPage::createPage(QWidget *parent)
     m_page->latitudeSpinBox->setValue(m_config->latitude());
     m_page->longitudeSpinBox->setValue(m_config->longitude());
 
+    m_page->trailLengthSpinBox->setValue(m_config->trailLength());
+    m_page->trailToleranceSpinBox->setValue(m_config->trailTolerance());
+
     m_page->checkBoxUseOpenGL->setChecked(m_config->useOpenGL());
     m_page->checkBoxShowTileGridLines->setChecked(m_config->showTileGridLines());
 
@@ -138,6 +141,8 @@ void OPMapGadgetOptionsPage::apply()
     m_config->setCacheLocation(m_page->lineEditCacheLocation->path());
     m_config->setUavSymbol(m_page->uavSymbolComboBox->itemData(m_page->uavSymbolComboBox->currentIndex()).toString());
     m_config->setMaxUpdateRate(m_page->maxUpdateRateComboBox->itemData(m_page->maxUpdateRateComboBox->currentIndex()).toInt());
+    m_config->setTrailLength(m_page->trailLengthSpinBox->value());
+    m_config->setTrailTolerance(m_page->trailToleranceSpinBox->value());
 }
 
 void OPMapGadgetOptionsPage::finish()
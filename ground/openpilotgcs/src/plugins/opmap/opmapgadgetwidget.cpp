@@ -39,6 +39,9 @@
 #include <QDir>
 #include <QFile>
 #include <QDateTime>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
 
 #include <math.h>
 
@@ -493,6 +496,9 @@ void OPMapGadgetWidget::contextMenuEvent(QContextMenuEvent *event)
 
     uav_menu.addAction(clearUAVtrailAct);
 
+    uav_menu.addAction(recordTrackAct);
+    uav_menu.addAction(convertLogToTrackAct);
+
     // UAV section
     uav_menu.addSection(tr("UAV"));
 
@@ -633,6 +639,7 @@ void OPMapGadgetWidget::updatePosition()
     m_map->UAV->SetNED(NED);
     m_map->UAV->SetCAS(airspeedStateData.CalibratedAirspeed);
     m_map->UAV->SetGroundspeed(vNED, m_maxUpdateRate);
+    m_map->SetMotionHint(vNED[0], vNED[1]);
 
     // Convert angular velocities into a rotationg rate around the world-frame yaw axis. This is found by simply taking the dot product of the angular Euler-rate matrix with the angular rates.
     float psiRate_dps = 0 * gyroStateData.z + sin(attitudeStateData.Roll * deg_to_rad) / cos(attitudeStateData.Pitch * deg_to_rad) * gyroStateData.y + cos(attitudeStateData.Roll * deg_to_rad) / cos(attitudeStateData.Pitch * deg_to_rad) * gyroStateData.z;
@@ -1117,6 +1124,28 @@ void OPMapGadgetWidget::setOverlayOpacity(qreal value)
     overlayOpacityAct.at(value * 10)->setChecked(true);
 }
 
+void OPMapGadgetWidget::setTrailLength(int length)
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+    m_map->UAV->SetTrailLength(length);
+    if (m_map->GPS) {
+        m_map->GPS->SetTrailLength(length);
+    }
+}
+
+void OPMapGadgetWidget::setTrailTolerance(qreal tolerance)
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+    m_map->UAV->SetTrailTolerance(tolerance);
+    if (m_map->GPS) {
+        m_map->GPS->SetTrailTolerance(tolerance);
+    }
+}
+
 void OPMapGadgetWidget::setHomePosition(QPointF pos)
 {
     if (!m_widget || !m_map) {
@@ -1564,6 +1593,16 @@ void OPMapGadgetWidget::createActions()
     clearUAVtrailAct->setStatusTip(tr("Clear the UAV trail"));
     connect(clearUAVtrailAct, SIGNAL(triggered()), this, SLOT(onClearUAVtrailAct_triggered()));
 
+    recordTrackAct = new QAction(tr("Record UAV track to KML/GPX..."), this);
+    recordTrackAct->setStatusTip(tr("Write the UAV track to a KML or GPX file as it flies"));
+    recordTrackAct->setCheckable(true);
+    recordTrackAct->setChecked(false);
+    connect(recordTrackAct, SIGNAL(toggled(bool)), this, SLOT(onRecordTrackAct_toggled(bool)));
+
+    convertLogToTrackAct = new QAction(tr("Convert log to KML/GPX..."), this);
+    convertLogToTrackAct->setStatusTip(tr("Write the UAV track of a log file to a KML or GPX file"));
+    connect(convertLogToTrackAct, SIGNAL(triggered()), this, SLOT(onConvertLogToTrackAct_triggered()));
+
     uavTrailTimeActGroup = new QActionGroup(this);
     connect(uavTrailTimeActGroup, SIGNAL(triggered(QAction *)), this, SLOT(onUAVTrailTimeActGroup_triggered(QAction *)));
     uavTrailTimeAct.clear();
@@ -1602,7 +1641,29 @@ void OPMapGadgetWidget::onReloadAct_triggered()
 
 void OPMapGadgetWidget::onRipAct_triggered()
 {
-    m_map->RipMap();
+    if (!m_widget || !m_map) {
+        return;
+    }
+
+    if (mapcontrol::MapRipper::HasUnfinishedJob()) {
+        QMessageBox msgBox;
+        msgBox.setText(tr("A previous map download did not complete."));
+        msgBox.setInformativeText(tr("Resume it? Tiles already downloaded are skipped."));
+        msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+        if (msgBox.exec() == QMessageBox::Yes && m_map->ResumeRipMap()) {
+            return;
+        }
+    }
+
+    int minZoom = (int)m_map->ZoomReal();
+    bool ok;
+    int maxZoom = QInputDialog::getInt(this, tr("Rip map"),
+                                       tr("Download the selected area from zoom %1 up to zoom:").arg(minZoom),
+                                       qMin(minZoom + 3, m_map->MaxZoom()), minZoom, m_map->MaxZoom(), 1, &ok);
+    if (!ok) {
+        return;
+    }
+    m_map->RipMap(minZoom, maxZoom);
 }
 
 void OPMapGadgetWidget::onCopyMouseLatLonToClipAct_triggered()
@@ -1850,6 +1911,72 @@ void OPMapGadgetWidget::onClearUAVtrailAct_triggered()
     }
 }
 
+void OPMapGadgetWidget::onRecordTrackAct_toggled(bool record)
+{
+    if (!obm) {
+        return;
+    }
+    if (!m_trackExporter) {
+        m_trackExporter = new TrackExporter(obm, this);
+    }
+
+    if (!record) {
+        m_trackExporter->stop();
+        return;
+    }
+
+    QString kmlFilter = tr("Google Earth %1").arg("(*.kml)");
+    QString gpxFilter = tr("GPS Exchange %1").arg("(*.gpx)");
+    QString selectedFilter = kmlFilter;
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Record UAV Track"), QDir::homePath(),
+                                                    QString("%1;;%2").arg(kmlFilter, gpxFilter), &selectedFilter);
+    if (!fileName.isEmpty() && !fileName.endsWith(".kml") && !fileName.endsWith(".gpx")) {
+        fileName.append(selectedFilter == gpxFilter ? ".gpx" : ".kml");
+    }
+    if (fileName.isEmpty() || !m_trackExporter->start(fileName)) {
+        if (!fileName.isEmpty()) {
+            QMessageBox::warning(this, tr("Track recording failed."), m_trackExporter->errorString(), QMessageBox::Ok);
+        }
+        recordTrackAct->blockSignals(true);
+        recordTrackAct->setChecked(false);
+        recordTrackAct->blockSignals(false);
+    }
+}
+
+void OPMapGadgetWidget::onConvertLogToTrackAct_triggered()
+{
+    if (!obm) {
+        return;
+    }
+
+    QString logFileName = QFileDialog::getOpenFileName(this, tr("Convert Log File"), QDir::homePath(),
+                                                       tr("OpenPilot Log file %1").arg("(*.opl)"));
+    if (logFileName.isEmpty()) {
+        return;
+    }
+    QString kmlFilter = tr("Google Earth %1").arg("(*.kml)");
+    QString gpxFilter = tr("GPS Exchange %1").arg("(*.gpx)");
+    QString selectedFilter = kmlFilter;
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save UAV Track"), QFileInfo(logFileName).absolutePath(),
+                                                    QString("%1;;%2").arg(kmlFilter, gpxFilter), &selectedFilter);
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!fileName.endsWith(".kml") && !fileName.endsWith(".gpx")) {
+        fileName.append(selectedFilter == gpxFilter ? ".gpx" : ".kml");
+    }
+
+    // a separate exporter, so a live recording goes on
+    TrackExporter exporter(obm);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool success = exporter.convertLog(logFileName, fileName);
+    QApplication::restoreOverrideCursor();
+
+    if (!success) {
+        QMessageBox::warning(this, tr("Log conversion failed."), exporter.errorString(), QMessageBox::Ok);
+    }
+}
+
 void OPMapGadgetWidget::onUAVTrailTimeActGroup_triggered(QAction *action)
 {
     if (!m_widget || !m_map || !action) {
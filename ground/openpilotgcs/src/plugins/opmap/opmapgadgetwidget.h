@@ -35,6 +35,7 @@
 #include "pathplanner.h"
 #include "modelmapproxy.h"
 #include "modeluavoproxy.h"
+#include "trackexporter.h"
 
 #include <QWidget>
 #include <QMenu>
@@ -113,6 +114,8 @@ public:
     void setMaxUpdateRate(int update_rate);
     void setHomePosition(QPointF pos);
     void setOverlayOpacity(qreal value);
+    void setTrailLength(int length);
+    void setTrailTolerance(qreal tolerance);
     bool getGPSPositionSensor(double &latitude, double &longitude, double &altitude);
 signals:
     void defaultLocationAndZoomChanged(double lng, double lat, double zoom);
@@ -202,6 +205,8 @@ private slots:
     void onSafeAreaActGroup_triggered(QAction *action);
     void onUAVTrailTypeActGroup_triggered(QAction *action);
     void onClearUAVtrailAct_triggered();
+    void onRecordTrackAct_toggled(bool record);
+    void onConvertLogToTrackAct_triggered();
     void onUAVTrailTimeActGroup_triggered(QAction *action);
     void onUAVTrailDistanceActGroup_triggered(QAction *action);
     void onMaxUpdateRateActGroup_triggered(QAction *action);
@@ -234,6 +239,7 @@ private:
     QStandardItemModel wayPoint_treeView_model;
     mapcontrol::WayPointItem *m_mouse_waypoint;
     QPointer<ModelUavoProxy> UAVProxy;
+    QPointer<TrackExporter> m_trackExporter;
     QMutex m_map_mutex;
     bool m_telemetry_connected;
     QAction *reloadAct;
@@ -273,6 +279,8 @@ private:
     QActionGroup *uavTrailTypeActGroup;
     QList<QAction *> uavTrailTypeAct;
     QAction *clearUAVtrailAct;
+    QAction *recordTrackAct;
+    QAction *convertLogToTrackAct;
     QActionGroup *uavTrailTimeActGroup;
     QAction *showTrailLineAct;
     QAction *showTrailAct;
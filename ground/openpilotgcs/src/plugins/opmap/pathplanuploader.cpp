@@ -0,0 +1,250 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pathplanuploader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief Compiles and sends the path plan from a worker thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "pathplanuploader.h"
+#include "uavobjecthelper.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <QDebug>
+
+template<typename T>
+static QByteArray packFields(const T &fields)
+{
+    // DataFields are packed structs, so equal bytes mean equal objects
+    return QByteArray((const char *)&fields, sizeof(T));
+}
+
+PathPlanUploader::PathPlanUploader(UAVObjectManager *objMngr) : QObject(0), objMngr(objMngr), waitLoop(NULL), acked(0), failed(false)
+{}
+
+void PathPlanUploader::send(PathPlanRows rows)
+{
+    // compress path actions, waypoints sharing an identical action reference a single instance
+    QHash<QByteArray, int> actionIndex;
+    QVector<PathAction::DataFields> actions;
+    const int waypointCount = rows.waypoints.count();
+
+    for (int i = 0; i < waypointCount; ++i) {
+        QByteArray key = packFields(rows.actions.at(i));
+        int index = actionIndex.value(key, -1);
+        if (index < 0) {
+            index = actions.count();
+            actionIndex.insert(key, index);
+            actions.append(rows.actions.at(i));
+        }
+        rows.waypoints[i].Action = index;
+    }
+    const int actionCount = actions.count();
+
+    // update the objects and collect the instances whose content the board does not have
+    QList<UAVObject *> changed;
+    for (int i = 0; i < waypointCount; ++i) {
+        Waypoint *waypoint = waypointInstance(i);
+        if (!waypoint) {
+            emit completed(false);
+            return;
+        }
+        waypoint->setData(rows.waypoints.at(i));
+        if (sentWaypoints.value(i) != packFields(rows.waypoints.at(i))) {
+            changed.append(waypoint);
+        }
+    }
+    for (int i = 0; i < actionCount; ++i) {
+        PathAction *action = actionInstance(i);
+        if (!action) {
+            emit completed(false);
+            return;
+        }
+        action->setData(actions.at(i));
+        if (sentActions.value(i) != packFields(actions.at(i))) {
+            changed.append(action);
+        }
+    }
+
+    PathPlan *pathPlan = PathPlan::GetInstance(objMngr);
+    PathPlan::DataFields pathPlanData = pathPlan->getData();
+    pathPlanData.WaypointCount   = waypointCount;
+    pathPlanData.PathActionCount = actionCount;
+    pathPlanData.Crc = computePathPlanCrc(waypointCount, actionCount);
+    pathPlan->setData(pathPlanData);
+
+    qDebug() << "PathPlanUploader::send -" << changed.count() << "of" << waypointCount + actionCount << "instances changed";
+
+    const int total = 1 + changed.count();
+
+    // the instances are streamed first, the plan header goes last so the board checks the
+    // counts and the CRC of the whole mission once everything has arrived
+    bool success = sendPipelined(changed, total);
+    if (success) {
+        UAVObjectUpdaterHelper updateHelper;
+        success = (updateHelper.doObjectAndWait(pathPlan) == UAVObjectUpdaterHelper::SUCCESS);
+        emit progress(total, total);
+    }
+
+    qDebug() << "PathPlanUploader::send - completed" << success;
+    emit completed(success);
+}
+
+/**
+ * Send acked updates of the objects with up to PIPELINE_DEPTH of them waiting for their ack.
+ * Telemetry runs one transaction per object instance, so they retry independently.
+ */
+bool PathPlanUploader::sendPipelined(const QList<UAVObject *> &objects, int total)
+{
+    // created here so it belongs to the uploader thread
+    QEventLoop eventLoop;
+    QTimer timeoutTimer;
+
+    timeoutTimer.setSingleShot(true);
+    connect(&timeoutTimer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+    waitLoop = &eventLoop;
+
+    inFlight.clear();
+    acked    = 0;
+    failed   = false;
+    int next = 0;
+    while (!failed && (next < objects.count() || !inFlight.isEmpty())) {
+        while (next < objects.count() && inFlight.count() < PIPELINE_DEPTH) {
+            UAVObject *obj = objects.at(next++);
+            inFlight.insert(obj);
+            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+            obj->updated();
+        }
+        const int ackedBefore = acked;
+        timeoutTimer.start(TRANSACTION_TIMEOUT_MS);
+        eventLoop.exec();
+        timeoutTimer.stop();
+        emit progress(1 + acked, total);
+        if (acked == ackedBefore && !failed) {
+            qWarning() << "PathPlanUploader::send - timed out waiting for" << inFlight.count() << "acks";
+            failed = true;
+        }
+    }
+
+    foreach(UAVObject * obj, inFlight) {
+        disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    }
+    inFlight.clear();
+    waitLoop = NULL;
+    return !failed;
+}
+
+void PathPlanUploader::transactionCompleted(UAVObject *obj, bool success)
+{
+    if (!inFlight.remove(obj)) {
+        return;
+    }
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    if (success) {
+        ++acked;
+        if (obj->getObjID() == Waypoint::OBJID) {
+            sentWaypoints.insert(obj->getInstID(), packFields(static_cast<Waypoint *>(obj)->getData()));
+        } else {
+            sentActions.insert(obj->getInstID(), packFields(static_cast<PathAction *>(obj)->getData()));
+        }
+    } else {
+        failed = true;
+    }
+    waitLoop->quit();
+}
+
+void PathPlanUploader::invalidate()
+{
+    sentWaypoints.clear();
+    sentActions.clear();
+}
+
+void PathPlanUploader::markObjectsSent()
+{
+    invalidate();
+
+    PathPlan::DataFields pathPlanData = PathPlan::GetInstance(objMngr)->getData();
+    for (int i = 0; i < pathPlanData.WaypointCount; ++i) {
+        Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
+        if (waypoint) {
+            sentWaypoints.insert(i, packFields(waypoint->getData()));
+        }
+    }
+    for (int i = 0; i < pathPlanData.PathActionCount; ++i) {
+        PathAction *action = PathAction::GetInstance(objMngr, i);
+        if (action) {
+            sentActions.insert(i, packFields(action->getData()));
+        }
+    }
+}
+
+Waypoint *PathPlanUploader::waypointInstance(int index)
+{
+    int count = objMngr->getNumInstances(Waypoint::OBJID);
+
+    if (index < count) {
+        return Waypoint::GetInstance(objMngr, index);
+    }
+    // instances are only ever added at the end
+    Q_ASSERT(index == count);
+    Waypoint *waypoint = new Waypoint;
+    waypoint->initialize(index, waypoint->getMetaObject());
+    // managed objects belong to the GUI thread, this one would die with the worker
+    waypoint->moveToThread(QCoreApplication::instance()->thread());
+    if (!objMngr->registerObject(waypoint)) {
+        return NULL;
+    }
+    return waypoint;
+}
+
+PathAction *PathPlanUploader::actionInstance(int index)
+{
+    int count = objMngr->getNumInstances(PathAction::OBJID);
+
+    if (index < count) {
+        return PathAction::GetInstance(objMngr, index);
+    }
+    Q_ASSERT(index == count);
+    PathAction *action = new PathAction;
+    action->initialize(index, action->getMetaObject());
+    action->moveToThread(QCoreApplication::instance()->thread());
+    if (!objMngr->registerObject(action)) {
+        return NULL;
+    }
+    return action;
+}
+
+quint8 PathPlanUploader::computePathPlanCrc(int waypointCount, int actionCount)
+{
+    quint8 crc = 0;
+
+    for (int i = 0; i < waypointCount; ++i) {
+        Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
+        crc = waypoint->updateCRC(crc);
+    }
+    for (int i = 0; i < actionCount; ++i) {
+        PathAction *action = PathAction::GetInstance(objMngr, i);
+        crc = action->updateCRC(crc);
+    }
+    return crc;
+}
@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pathplanuploader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief Compiles and sends the path plan from a worker thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PATHPLANUPLOADER_H
+#define PATHPLANUPLOADER_H
+
+#include "uavobjectmanager.h"
+#include "pathplan.h"
+#include "pathaction.h"
+#include "waypoint.h"
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QMetaType>
+#include <QSet>
+
+class QEventLoop;
+
+// snapshot of the flight data model, one action per waypoint before compression
+struct PathPlanRows {
+    QVector<Waypoint::DataFields> waypoints;
+    QVector<PathAction::DataFields> actions;
+};
+Q_DECLARE_METATYPE(PathPlanRows)
+
+// lives in its own thread, UAVObjectUpdaterHelper waits on acks in that thread's event loop
+class PathPlanUploader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PathPlanUploader(UAVObjectManager *objMngr);
+
+public slots:
+    // compiles the rows into Waypoint and PathAction instances and sends the ones the board does not have yet
+    void send(PathPlanRows rows);
+    // the board state is unknown, e.g. after a reconnect, the next send updates every instance
+    void invalidate();
+    // the objects hold what was just received from the board
+    void markObjectsSent();
+
+private slots:
+    void transactionCompleted(UAVObject *obj, bool success);
+
+signals:
+    void progress(int done, int total);
+    void completed(bool success);
+
+private:
+    // acked updates waiting at once, well below the telemetry event queue size
+    static const int PIPELINE_DEPTH = 8;
+    // longest wait for any of them, 3 UAVTalk tries of 250ms and a margin
+    static const int TRANSACTION_TIMEOUT_MS = 800;
+
+    UAVObjectManager *objMngr;
+    QEventLoop *waitLoop;
+    QSet<UAVObject *> inFlight;
+    int acked;
+    bool failed;
+    // packed DataFields last acknowledged by the board, by instance id
+    QHash<quint32, QByteArray> sentWaypoints;
+    QHash<quint32, QByteArray> sentActions;
+
+    Waypoint *waypointInstance(int index);
+    PathAction *actionInstance(int index);
+    bool sendPipelined(const QList<UAVObject *> &objects, int total);
+    quint8 computePathPlanCrc(int waypointCount, int actionCount);
+};
+
+#endif // PATHPLANUPLOADER_H
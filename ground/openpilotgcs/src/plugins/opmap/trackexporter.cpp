@@ -0,0 +1,406 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackexporter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief Writes the UAV track to KML or GPX, live or from a log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "trackexporter.h"
+#include "positionstate.h"
+#include "homelocation.h"
+#include "gpspositionsensor.h"
+#include <utils/logfile.h>
+#include <utils/crc.h>
+
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QtEndian>
+#include <QDebug>
+#include <math.h>
+#include <string.h>
+
+// UAVTalk framing, see FlightLogColumnExporter
+static const quint8 SYNC_VAL         = 0x3C;
+static const quint8 TYPE_TIMESTAMPED = 0x80;
+static const quint8 TYPE_OBJ         = 0x20;
+static const quint8 TYPE_OBJ_ACK     = 0x22;
+static const int HEADER_LENGTH       = 10;
+static const int TIMESTAMP_LENGTH    = 2;
+
+static const char KML_TAIL[] = "</coordinates></LineString></Placemark></Document></kml>\n";
+static const char GPX_TAIL[] = "</trkseg></trk></gpx>\n";
+
+TrackExporter::TrackExporter(UAVObjectManager *objMngr, QObject *parent) :
+    QObject(parent),
+    m_objMngr(objMngr),
+    m_format(KML),
+    m_tailOffset(0),
+    m_absoluteTime(true),
+    m_homeSet(false),
+    m_lastTime(0),
+    m_havePoint(false)
+{
+    m_flushTimer.setInterval(TRACK_FLUSH_INTERVAL_S * 1000);
+    connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+TrackExporter::~TrackExporter()
+{
+    stop();
+}
+
+bool TrackExporter::open(const QString &fileName, bool absoluteTime)
+{
+    m_format = fileName.endsWith(".gpx", Qt::CaseInsensitive) ? GPX : KML;
+    m_absoluteTime = absoluteTime;
+    m_homeSet   = false;
+    m_havePoint = false;
+    m_points.clear();
+    m_times.clear();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_errorString = tr("Could not open %1.").arg(fileName);
+        return false;
+    }
+    QByteArray head = header(QFileInfo(fileName).completeBaseName());
+    m_tailOffset = head.size();
+    if (m_file.write(head) != head.size() || m_file.write(tail()) != (qint64)strlen(tail())) {
+        m_errorString = tr("Could not write %1.").arg(fileName);
+        m_file.close();
+        return false;
+    }
+    m_file.flush();
+    return true;
+}
+
+bool TrackExporter::start(const QString &fileName)
+{
+    stop();
+    if (!open(fileName, true)) {
+        return false;
+    }
+    if (m_format == KML && !writeNetworkLink(fileName)) {
+        m_file.close();
+        return false;
+    }
+
+    HomeLocation *home = HomeLocation::GetInstance(m_objMngr);
+    homeUpdated(home);
+    connect(home, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(homeUpdated(UAVObject *)));
+    connect(PositionState::GetInstance(m_objMngr), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(positionUpdated(UAVObject *)));
+    connect(GPSPositionSensor::GetInstance(m_objMngr), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(gpsUpdated(UAVObject *)));
+    m_flushTimer.start();
+    return true;
+}
+
+void TrackExporter::stop()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    m_flushTimer.stop();
+    disconnect(HomeLocation::GetInstance(m_objMngr), 0, this, 0);
+    disconnect(PositionState::GetInstance(m_objMngr), 0, this, 0);
+    disconnect(GPSPositionSensor::GetInstance(m_objMngr), 0, this, 0);
+    flush();
+    m_file.close();
+}
+
+void TrackExporter::homeUpdated(UAVObject *obj)
+{
+    HomeLocation::DataFields homeData = static_cast<HomeLocation *>(obj)->getData();
+
+    if (homeData.Set == HomeLocation::SET_TRUE) {
+        setHome(homeData.Latitude, homeData.Longitude, homeData.Altitude);
+    } else {
+        m_homeSet = false;
+    }
+}
+
+void TrackExporter::positionUpdated(UAVObject *obj)
+{
+    if (!m_homeSet) {
+        return;
+    }
+    PositionState::DataFields positionData = static_cast<PositionState *>(obj)->getData();
+    double NED[3] = { positionData.North, positionData.East, positionData.Down };
+    addNED(NED, QDateTime::currentMSecsSinceEpoch());
+}
+
+void TrackExporter::gpsUpdated(UAVObject *obj)
+{
+    GPSPositionSensor::DataFields gpsData = static_cast<GPSPositionSensor *>(obj)->getData();
+
+    if (m_homeSet || gpsData.Status < GPSPositionSensor::STATUS_FIX2D) {
+        return;
+    }
+    double LLA[3] = { gpsData.Latitude * 1e-7, gpsData.Longitude * 1e-7, gpsData.Altitude };
+    addLLA(LLA, QDateTime::currentMSecsSinceEpoch());
+}
+
+void TrackExporter::setHome(qint32 latitude, qint32 longitude, float altitude)
+{
+    double LLA[3] = { latitude * 1e-7, longitude * 1e-7, altitude };
+
+    m_conversions.LLA2ECEF(LLA, m_homeECEF);
+    m_conversions.RneFromLLA(LLA, m_Rne);
+    m_homeSet = true;
+}
+
+void TrackExporter::addNED(const double NED[3], qint64 time)
+{
+    double ECEF[3];
+
+    // ECEF = home + Rne' * NED
+    for (int i = 0; i < 3; i++) {
+        ECEF[i] = m_homeECEF[i] + m_Rne[0][i] * NED[0] + m_Rne[1][i] * NED[1] + m_Rne[2][i] * NED[2];
+    }
+    addECEF(ECEF, time);
+}
+
+void TrackExporter::addLLA(const double LLA[3], qint64 time)
+{
+    double ECEF[3];
+
+    m_conversions.LLA2ECEF(LLA, ECEF, 1);
+    addECEF(ECEF, time);
+}
+
+void TrackExporter::addECEF(const double ECEF[3], qint64 time)
+{
+    if (m_havePoint) {
+        double dx = ECEF[0] - m_lastPoint[0];
+        double dy = ECEF[1] - m_lastPoint[1];
+        double dz = ECEF[2] - m_lastPoint[2];
+        if (time - m_lastTime < TRACK_MIN_INTERVAL_MS
+            || dx * dx + dy * dy + dz * dz < TRACK_MIN_DISTANCE_M * TRACK_MIN_DISTANCE_M) {
+            return;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        m_lastPoint[i] = ECEF[i];
+        m_points << ECEF[i];
+    }
+    m_times << time;
+    m_lastTime  = time;
+    m_havePoint = true;
+}
+
+bool TrackExporter::flush()
+{
+    if (!m_file.isOpen() || m_times.isEmpty()) {
+        return true;
+    }
+
+    int count = m_times.size();
+    QVector<double> LLA(3 * count);
+    m_conversions.ECEF2LLA(m_points.constData(), LLA.data(), count);
+
+    QByteArray buffer;
+    buffer.reserve(count * 96 + (int)strlen(tail()));
+    char line[160];
+    for (int i = 0; i < count; i++) {
+        const double *p = &LLA[3 * i];
+        int length;
+        if (m_format == KML) {
+            length = qsnprintf(line, sizeof(line), "%.7f,%.7f,%.2f\n", p[1], p[0], p[2]);
+        } else if (m_absoluteTime) {
+            QByteArray time = QDateTime::fromMSecsSinceEpoch(m_times.at(i)).toUTC().toString(Qt::ISODate).toLatin1();
+            length = qsnprintf(line, sizeof(line), "<trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.2f</ele><time>%s</time></trkpt>\n",
+                               p[0], p[1], p[2], time.constData());
+        } else {
+            length = qsnprintf(line, sizeof(line), "<trkpt lat=\"%.7f\" lon=\"%.7f\"><ele>%.2f</ele></trkpt>\n", p[0], p[1], p[2]);
+        }
+        buffer.append(line, length);
+    }
+    qint64 pointsSize = buffer.size();
+    buffer.append(tail());
+    m_points.clear();
+    m_times.clear();
+
+    if (!m_file.seek(m_tailOffset) || m_file.write(buffer) != buffer.size() || !m_file.flush()) {
+        m_errorString = tr("Could not write %1.").arg(m_file.fileName());
+        qDebug() << "TrackExporter -" << m_errorString;
+        return false;
+    }
+    m_tailOffset += pointsSize;
+    return true;
+}
+
+QByteArray TrackExporter::header(const QString &name) const
+{
+    QByteArray escaped = name.toHtmlEscaped().toUtf8();
+
+    if (m_format == KML) {
+        return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+               "<Document><name>" + escaped + "</name>\n"
+               "<Placemark><name>" + escaped + "</name>\n"
+               "<LineString><altitudeMode>absolute</altitudeMode><coordinates>\n";
+    }
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<gpx version=\"1.1\" creator=\"OpenPilot GCS\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+           "<trk><name>" + escaped + "</name><trkseg>\n";
+}
+
+const char *TrackExporter::tail() const
+{
+    return (m_format == KML) ? KML_TAIL : GPX_TAIL;
+}
+
+// track.kml gets a track_link.kml to open in Google Earth, which reloads the track periodically
+bool TrackExporter::writeNetworkLink(const QString &fileName)
+{
+    QFileInfo info(fileName);
+    QFile link(info.dir().filePath(info.completeBaseName() + "_link.kml"));
+    QByteArray name = info.completeBaseName().toHtmlEscaped().toUtf8();
+    QByteArray href = info.fileName().toHtmlEscaped().toUtf8();
+
+    QByteArray data = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+                      "<NetworkLink><name>" + name + "</name>\n"
+                      "<Link><href>" + href + "</href><refreshMode>onInterval</refreshMode>"
+                      "<refreshInterval>" + QByteArray::number(TRACK_FLUSH_INTERVAL_S) + "</refreshInterval></Link>\n"
+                      "</NetworkLink></kml>\n";
+    if (!link.open(QIODevice::WriteOnly | QIODevice::Truncate) || link.write(data) != data.size()) {
+        m_errorString = tr("Could not write %1.").arg(link.fileName());
+        return false;
+    }
+    return true;
+}
+
+// offset of a field in the packed object data
+static int fieldOffset(UAVObject *obj, const QString &name)
+{
+    int offset = 0;
+
+    foreach(UAVObjectField * field, obj->getFields()) {
+        if (field->getName() == name) {
+            return offset;
+        }
+        offset += field->getNumBytes();
+    }
+    return -1;
+}
+
+template<typename T> static T fieldValue(const uchar *data, int offset)
+{
+    T value;
+
+    memcpy(&value, data + offset, sizeof(value));
+    return value;
+}
+
+bool TrackExporter::convertLog(const QString &logFileName, const QString &fileName)
+{
+    stop();
+
+    LogFile log;
+    log.setFileName(logFileName);
+    if (!log.open(QIODevice::ReadOnly)) {
+        m_errorString = tr("Could not open %1.").arg(logFileName);
+        return false;
+    }
+    if (!log.indexPackets()) {
+        m_errorString = tr("%1 holds no log data.").arg(logFileName);
+        log.close();
+        return false;
+    }
+    if (!open(fileName, false)) {
+        log.close();
+        return false;
+    }
+
+    UAVObject *home     = HomeLocation::GetInstance(m_objMngr);
+    UAVObject *position = PositionState::GetInstance(m_objMngr);
+    UAVObject *gps = GPSPositionSensor::GetInstance(m_objMngr);
+    const int homeSet   = fieldOffset(home, "Set");
+    const int homeLat   = fieldOffset(home, "Latitude");
+    const int homeLon   = fieldOffset(home, "Longitude");
+    const int homeAlt   = fieldOffset(home, "Altitude");
+    const int posNorth  = fieldOffset(position, "North");
+    const int posEast   = fieldOffset(position, "East");
+    const int posDown   = fieldOffset(position, "Down");
+    const int gpsStatus = fieldOffset(gps, "Status");
+    const int gpsLat    = fieldOffset(gps, "Latitude");
+    const int gpsLon    = fieldOffset(gps, "Longitude");
+    const int gpsAlt    = fieldOffset(gps, "Altitude");
+
+    for (int i = 0; i < log.packetCount(); i++) {
+        qint64 size;
+        const uchar *packet = log.packetData(i, &size);
+
+        if (size < HEADER_LENGTH + 1 || packet[0] != SYNC_VAL) {
+            continue;
+        }
+        quint8 type = packet[1] & ~TYPE_TIMESTAMPED;
+        if (type != TYPE_OBJ && type != TYPE_OBJ_ACK) {
+            continue;
+        }
+        int length = qFromLittleEndian<quint16>(&packet[2]);
+        if (length + 1 > size) {
+            continue;
+        }
+        quint32 objId = qFromLittleEndian<quint32>(&packet[4]);
+        int payload   = HEADER_LENGTH + ((packet[1] & TYPE_TIMESTAMPED) ? TIMESTAMP_LENGTH : 0);
+        const uchar *data = packet + payload;
+        UAVObject *obj;
+        if (objId == HomeLocation::OBJID) {
+            obj = home;
+        } else if (objId == PositionState::OBJID) {
+            obj = position;
+        } else if (objId == GPSPositionSensor::OBJID) {
+            obj = gps;
+        } else {
+            continue;
+        }
+        // objects of another version of the definitions cannot be decoded
+        if (length - payload != (int)obj->getNumBytes() || Utils::Crc::updateCRC(0, packet, length) != packet[length]) {
+            continue;
+        }
+
+        qint64 time = log.packetTimeStamp(i);
+        if (obj == home) {
+            if (data[homeSet] == HomeLocation::SET_TRUE) {
+                setHome(fieldValue<qint32>(data, homeLat), fieldValue<qint32>(data, homeLon), fieldValue<float>(data, homeAlt));
+            } else {
+                m_homeSet = false;
+            }
+        } else if (obj == position) {
+            if (m_homeSet) {
+                double NED[3] = { fieldValue<float>(data, posNorth), fieldValue<float>(data, posEast), fieldValue<float>(data, posDown) };
+                addNED(NED, time);
+            }
+        } else if (!m_homeSet && data[gpsStatus] >= GPSPositionSensor::STATUS_FIX2D) {
+            double LLA[3] = { fieldValue<qint32>(data, gpsLat) * 1e-7, fieldValue<qint32>(data, gpsLon) * 1e-7, fieldValue<float>(data, gpsAlt) };
+            addLLA(LLA, time);
+        }
+    }
+    log.close();
+
+    bool success = flush();
+    m_file.close();
+    return success;
+}
@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trackexporter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief Writes the UAV track to KML or GPX, live or from a log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TRACKEXPORTER_H
+#define TRACKEXPORTER_H
+
+#include "uavobjectmanager.h"
+#include "utils/coordinateconversions.h"
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QVector>
+#include <QByteArray>
+
+// Points closer than this in distance and time to the last written one are dropped
+#define TRACK_MIN_DISTANCE_M   1.0
+#define TRACK_MIN_INTERVAL_MS  200
+// The live track is written, and Google Earth reloads it, this often
+#define TRACK_FLUSH_INTERVAL_S 2
+
+/**
+ * The track document is kept valid on disk at all times: the new points are
+ * written over its closing tags, which are written again after them. Nothing
+ * before them is ever rewritten.
+ * The points come from PositionState while the home location is set, from
+ * GPSPositionSensor otherwise. They are held in ECEF and converted to LLA in
+ * one batch when written.
+ */
+class TrackExporter : public QObject {
+    Q_OBJECT
+
+public:
+    enum Format { KML, GPX };
+
+    explicit TrackExporter(UAVObjectManager *objMngr, QObject *parent = 0);
+    ~TrackExporter();
+
+    // the format follows the file extension, .gpx or .kml
+    bool start(const QString &fileName);
+    void stop();
+    bool isRecording() const
+    {
+        return m_file.isOpen();
+    }
+
+    // converts the whole log at once
+    bool convertLog(const QString &logFileName, const QString &fileName);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private slots:
+    void positionUpdated(UAVObject *obj);
+    void gpsUpdated(UAVObject *obj);
+    void homeUpdated(UAVObject *obj);
+    bool flush();
+
+private:
+    UAVObjectManager *m_objMngr;
+    Utils::CoordinateConversions m_conversions;
+    Format m_format;
+    QFile m_file;
+    QTimer m_flushTimer;
+    QString m_errorString;
+    // where the closing tags start
+    qint64 m_tailOffset;
+    // points are absolute times in ms since the epoch, or log times without a date
+    bool m_absoluteTime;
+
+    bool m_homeSet;
+    double m_homeECEF[3];
+    float m_Rne[3][3];
+
+    // ECEF points and their times not written yet
+    QVector<double> m_points;
+    QVector<qint64> m_times;
+    double m_lastPoint[3];
+    qint64 m_lastTime;
+    bool m_havePoint;
+
+    bool open(const QString &fileName, bool absoluteTime);
+    void setHome(qint32 latitude, qint32 longitude, float altitude);
+    void addNED(const double NED[3], qint64 time);
+    void addLLA(const double LLA[3], qint64 time);
+    void addECEF(const double ECEF[3], qint64 time);
+    QByteArray header(const QString &name) const;
+    const char *tail() const;
+    bool writeNetworkLink(const QString &fileName);
+};
+
+#endif // TRACKEXPORTER_H
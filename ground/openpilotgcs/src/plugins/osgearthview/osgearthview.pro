@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = OsgEarthviewGadget
 
-QT += opengl
+QT += opengl concurrent
 include(../../openpilotgcsplugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(osgearthview_dependencies.pri)
@@ -15,6 +15,7 @@ HEADERS += osgearthviewwidget.h
 HEADERS += osgearthviewgadgetfactory.h
 HEADERS += osgearthviewgadgetconfiguration.h
 HEADERS += osgearthviewgadgetoptionspage.h
+HEADERS += terrainprefetcher.h
 
 SOURCES += osgearthviewplugin.cpp \
     osgviewerwidget.cpp
@@ -23,6 +24,7 @@ SOURCES += osgearthviewwidget.cpp
 SOURCES += osgearthviewgadgetfactory.cpp
 SOURCES += osgearthviewgadgetconfiguration.cpp
 SOURCES += osgearthviewgadgetoptionspage.cpp
+SOURCES += terrainprefetcher.cpp
 
 FORMS += osgearthviewgadgetoptionspage.ui \
     osgearthview.ui
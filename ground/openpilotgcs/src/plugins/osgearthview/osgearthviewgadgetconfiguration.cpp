@@ -31,11 +31,17 @@
  *
  */
 OsgEarthviewGadgetConfiguration::OsgEarthviewGadgetConfiguration(QString classId, QSettings *qSettings, QObject *parent) :
-    IUAVGadgetConfiguration(classId, parent)
+    IUAVGadgetConfiguration(classId, parent),
+    m_pagerThreads(2),
+    m_prefetchTime(30),
+    m_cacheSize(500)
 {
-    Q_UNUSED(qSettings);
     // if a saved configuration exists load it
-    if (qSettings != 0) {}
+    if (qSettings != 0) {
+        m_pagerThreads = qSettings->value("pagerThreads", 2).toInt();
+        m_prefetchTime = qSettings->value("prefetchTime", 30).toInt();
+        m_cacheSize    = qSettings->value("cacheSize", 500).toInt();
+    }
 }
 
 /**
@@ -46,6 +52,9 @@ IUAVGadgetConfiguration *OsgEarthviewGadgetConfiguration::clone()
 {
     OsgEarthviewGadgetConfiguration *m = new OsgEarthviewGadgetConfiguration(this->classId());
 
+    m->m_pagerThreads = m_pagerThreads;
+    m->m_prefetchTime = m_prefetchTime;
+    m->m_cacheSize    = m_cacheSize;
     return m;
 }
 
@@ -53,4 +62,9 @@ IUAVGadgetConfiguration *OsgEarthviewGadgetConfiguration::clone()
  * Saves a configuration.
  *
  */
-void OsgEarthviewGadgetConfiguration::saveConfig(QSettings *qSettings) const {}
+void OsgEarthviewGadgetConfiguration::saveConfig(QSettings *qSettings) const
+{
+    qSettings->setValue("pagerThreads", m_pagerThreads);
+    qSettings->setValue("prefetchTime", m_prefetchTime);
+    qSettings->setValue("cacheSize", m_cacheSize);
+}
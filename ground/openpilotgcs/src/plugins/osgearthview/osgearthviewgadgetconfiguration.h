@@ -39,7 +39,38 @@ public:
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
 
+    // threads of the terrain database pager, used when the view is created
+    int pagerThreads() const
+    {
+        return m_pagerThreads;
+    }
+    void setPagerThreads(int threads)
+    {
+        m_pagerThreads = threads;
+    }
+    // seconds of flight ahead of the aircraft the terrain is fetched for, 0 disables the prefetch
+    int prefetchTime() const
+    {
+        return m_prefetchTime;
+    }
+    void setPrefetchTime(int seconds)
+    {
+        m_prefetchTime = seconds;
+    }
+    // size limit of the terrain tile cache on disk, in MB
+    int cacheSize() const
+    {
+        return m_cacheSize;
+    }
+    void setCacheSize(int megabytes)
+    {
+        m_cacheSize = megabytes;
+    }
+
 private:
+    int m_pagerThreads;
+    int m_prefetchTime;
+    int m_cacheSize;
 };
 
 #endif // OSGEARTHVIEWGADGETCONFIGURATION_H
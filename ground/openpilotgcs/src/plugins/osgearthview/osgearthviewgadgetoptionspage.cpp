@@ -49,6 +49,10 @@ QWidget *OsgEarthviewGadgetOptionsPage::createPage(QWidget *parent)
     // main layout
     options_page->setupUi(optionsPageWidget);
 
+    options_page->pagerThreads->setValue(m_config->pagerThreads());
+    options_page->prefetchTime->setValue(m_config->prefetchTime());
+    options_page->cacheSize->setValue(m_config->cacheSize());
+
     return optionsPageWidget;
 }
 
@@ -59,7 +63,11 @@ QWidget *OsgEarthviewGadgetOptionsPage::createPage(QWidget *parent)
  *
  */
 void OsgEarthviewGadgetOptionsPage::apply()
-{}
+{
+    m_config->setPagerThreads(options_page->pagerThreads->value());
+    m_config->setPrefetchTime(options_page->prefetchTime->value());
+    m_config->setCacheSize(options_page->cacheSize->value());
+}
 
 
 void OsgEarthviewGadgetOptionsPage::finish()
@@ -114,6 +114,12 @@ OsgEarthviewWidget::OsgEarthviewWidget(QWidget *parent) : QWidget(parent)
 OsgEarthviewWidget::~OsgEarthviewWidget()
 {}
 
+void OsgEarthviewWidget::setConfiguration(OsgEarthviewGadgetConfiguration *config)
+{
+    m_widget->widget->setPagerThreads(config->pagerThreads());
+    m_widget->widget->setPrefetch(config->prefetchTime(), config->cacheSize());
+}
+
 void OsgEarthviewWidget::paintEvent(QPaintEvent *event)
 {}
 
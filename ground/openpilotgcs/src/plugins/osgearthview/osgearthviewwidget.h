@@ -90,6 +90,8 @@ public:
     OsgEarthviewWidget(QWidget *parent = 0);
     ~OsgEarthviewWidget();
 
+    void setConfiguration(OsgEarthviewGadgetConfiguration *config);
+
 public slots:
 
 protected: /* Protected methods */
@@ -114,6 +114,8 @@ OsgViewerWidget::OsgViewerWidget(QWidget *parent) : QWidget(parent)
     if (!mapNode) {
         qDebug() << "Uhoh";
     }
+    TerrainPrefetcher::setupCache(mapNode->getMap());
+    prefetcher = new TerrainPrefetcher(mapNode->getMap(), this);
 
     root->addChild(earth);
 
@@ -142,9 +144,25 @@ OsgViewerWidget::OsgViewerWidget(QWidget *parent) : QWidget(parent)
 OsgViewerWidget::~OsgViewerWidget()
 {}
 
+void OsgViewerWidget::setPagerThreads(int threads)
+{
+    // the pager threads cannot change once they run, the new views get the hint
+    osg::DisplaySettings::instance()->setNumOfDatabaseThreadsHint(threads);
+    osgDB::DatabasePager *pager = view->getDatabasePager();
+    if (!pager->isRunning()) {
+        pager->setUpThreads(threads, 1);
+    }
+}
+
+void OsgViewerWidget::setPrefetch(int lookAhead, int cacheSize)
+{
+    prefetcher->setCacheSize(cacheSize);
+    prefetcher->setLookAhead(lookAhead);
+}
+
 QWidget *OsgViewerWidget::createViewWidget(osg::Camera *camera, osg::Node *scene)
 {
-    osgViewer::View *view = new osgViewer::View;
+    view = new osgViewer::View;
 
     view->setCamera(camera);
 
@@ -29,6 +29,7 @@
 #include <QWidget>
 
 #include "osgearthviewgadgetconfiguration.h"
+#include "terrainprefetcher.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
@@ -87,6 +88,10 @@ class OsgViewerWidget : public QWidget, public osgViewer::CompositeViewer {
 public:
     explicit OsgViewerWidget(QWidget *parent = 0);
     ~OsgViewerWidget();
+
+    void setPagerThreads(int threads);
+    void setPrefetch(int lookAhead, int cacheSize);
+
 signals:
 
 public slots:
@@ -105,6 +110,8 @@ protected:
 
 private: /* Private variables */
     QTimer _timer;
+    osgViewer::View *view;
+    TerrainPrefetcher *prefetcher;
     EarthManipulator *manip;
     osgEarth::Util::ObjectLocatorNode *uavPos;
     osg::MatrixTransform *uavAttitudeAndScale;
@@ -0,0 +1,199 @@
+/********************************************************************************
+ * @file       terrainprefetcher.cpp
+ * @author     The OpenPilot Team Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OsgEarthview Plugin
+ * @{
+ * @brief Fetches the terrain ahead of the UAV
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "terrainprefetcher.h"
+
+#include "extensionsystem/pluginmanager.h"
+#include "uavobjectmanager.h"
+#include "utils/pathutils.h"
+#include "utils/coordinateconversions.h"
+#include "homelocation.h"
+#include "positionstate.h"
+#include "velocitystate.h"
+#include "pathdesired.h"
+#include "waypoint.h"
+#include "waypointactive.h"
+
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFile>
+#include <QVector3D>
+#include <QtConcurrentRun>
+#include <QDebug>
+
+#include <osgEarth/CacheSeed>
+#include <osgEarthDrivers/cache_filesystem/FileSystemCache>
+
+// half the side of the area seeded around each point, in degrees
+static const double POINT_EXTENT = 0.02;
+
+TerrainPrefetcher::TerrainPrefetcher(osgEarth::Map *map, QObject *parent) : QObject(parent),
+    m_map(map), m_lookAhead(0), m_cacheBytes(0)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+
+    m_objMngr = pm->getObject<UAVObjectManager>();
+    Q_ASSERT(m_objMngr);
+
+    m_timer.setInterval(UPDATE_INTERVAL);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(update()));
+}
+
+TerrainPrefetcher::~TerrainPrefetcher()
+{
+    // the seeding holds a reference to the map, let it return
+    m_watcher.waitForFinished();
+}
+
+void TerrainPrefetcher::setLookAhead(int seconds)
+{
+    m_lookAhead = seconds;
+    if (m_lookAhead > 0) {
+        m_timer.start();
+    } else {
+        m_timer.stop();
+    }
+}
+
+void TerrainPrefetcher::setCacheSize(int megabytes)
+{
+    m_cacheBytes = (qint64)megabytes * 1024 * 1024;
+}
+
+QString TerrainPrefetcher::cachePath()
+{
+    return Utils::PathUtils().GetStoragePath() + "osgearth/cache";
+}
+
+void TerrainPrefetcher::setupCache(osgEarth::Map *map)
+{
+    osgEarth::Drivers::FileSystemCacheOptions cacheOptions;
+
+    cacheOptions.rootPath() = cachePath().toStdString();
+    map->setCache(osgEarth::CacheFactory::create(cacheOptions));
+}
+
+static bool writtenBefore(const QFileInfo &a, const QFileInfo &b)
+{
+    return a.lastModified() < b.lastModified();
+}
+
+void TerrainPrefetcher::pruneCache(const QString &path, qint64 maxBytes)
+{
+    QList<QFileInfo> files;
+    qint64 total = 0;
+
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        files << it.fileInfo();
+        total += it.fileInfo().size();
+    }
+    if (total <= maxBytes) {
+        return;
+    }
+
+    qSort(files.begin(), files.end(), writtenBefore);
+    foreach(const QFileInfo &file, files) {
+        if (total <= maxBytes) {
+            break;
+        }
+        if (QFile::remove(file.filePath())) {
+            total -= file.size();
+        }
+    }
+}
+
+void TerrainPrefetcher::update()
+{
+    // the previous route is still being fetched
+    if (m_watcher.isRunning()) {
+        return;
+    }
+    QList<QPointF> points = routeAhead();
+    if (!points.isEmpty()) {
+        m_watcher.setFuture(QtConcurrent::run(seed, m_map, points, m_cacheBytes));
+    }
+}
+
+QList<QPointF> TerrainPrefetcher::routeAhead()
+{
+    QList<QPointF> points;
+
+    HomeLocation::DataFields homeLocation = HomeLocation::GetInstance(m_objMngr)->getData();
+    if (homeLocation.Set != HomeLocation::SET_TRUE) {
+        return points;
+    }
+    double homeLLA[3] = { homeLocation.Latitude / 10.0e6, homeLocation.Longitude / 10.0e6, homeLocation.Altitude };
+    QList<QVector3D> route;
+
+    // where the current velocity leads
+    PositionState::DataFields positionState = PositionState::GetInstance(m_objMngr)->getData();
+    VelocityState::DataFields velocityState = VelocityState::GetInstance(m_objMngr)->getData();
+    QVector3D position(positionState.North, positionState.East, positionState.Down);
+    QVector3D velocity(velocityState.North, velocityState.East, velocityState.Down);
+    for (int i = 1; i <= 4; ++i) {
+        route << position + velocity * (m_lookAhead * i / 4.0);
+    }
+
+    // the end of the current leg and the waypoints after it
+    PathDesired::DataFields pathDesired = PathDesired::GetInstance(m_objMngr)->getData();
+    route << QVector3D(pathDesired.End[PathDesired::END_NORTH], pathDesired.End[PathDesired::END_EAST],
+                       pathDesired.End[PathDesired::END_DOWN]);
+
+    int active = WaypointActive::GetInstance(m_objMngr)->getData().Index;
+    int count  = m_objMngr->getNumInstances(Waypoint::OBJID);
+    for (int i = qMax(active, 0); i < count && i < active + MAX_WAYPOINTS; ++i) {
+        Waypoint::DataFields waypoint = Waypoint::GetInstance(m_objMngr, i)->getData();
+        route << QVector3D(waypoint.Position[Waypoint::POSITION_NORTH], waypoint.Position[Waypoint::POSITION_EAST],
+                           waypoint.Position[Waypoint::POSITION_DOWN]);
+    }
+
+    foreach(const QVector3D &ned, route) {
+        double NED[3] = { ned.x(), ned.y(), ned.z() };
+        double LLA[3];
+        Utils::CoordinateConversions().NED2LLA_HomeLLA(homeLLA, NED, LLA);
+        points << QPointF(LLA[1], LLA[0]);
+    }
+    return points;
+}
+
+void TerrainPrefetcher::seed(osg::ref_ptr<osgEarth::Map> map, QList<QPointF> points, qint64 cacheBytes)
+{
+    const osgEarth::SpatialReference *srs = map->getProfile()->getSRS()->getGeographicSRS();
+    osgEarth::CacheSeed seeder;
+
+    seeder.setMinLevel(0);
+    seeder.setMaxLevel(SEED_LEVEL);
+    foreach(const QPointF &point, points) {
+        seeder.addExtent(osgEarth::GeoExtent(srs, point.x() - POINT_EXTENT, point.y() - POINT_EXTENT,
+                                             point.x() + POINT_EXTENT, point.y() + POINT_EXTENT));
+    }
+    seeder.seed(map.get());
+
+    if (cacheBytes > 0) {
+        pruneCache(cachePath(), cacheBytes);
+    }
+}
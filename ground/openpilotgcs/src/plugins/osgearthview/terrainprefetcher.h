@@ -0,0 +1,80 @@
+/********************************************************************************
+ * @file       terrainprefetcher.h
+ * @author     The OpenPilot Team Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OsgEarthview Plugin
+ * @{
+ * @brief Fetches the terrain ahead of the UAV
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TERRAINPREFETCHER_H
+#define TERRAINPREFETCHER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QList>
+#include <QPointF>
+
+#include <osg/ref_ptr>
+#include <osgEarth/Map>
+
+class UAVObjectManager;
+
+// Seeds the terrain cache along the route ahead of the UAV, where the velocity leads within the
+// look ahead time and the waypoints left to fly. The tiles are read in a worker thread, so the
+// database pager finds them in the disk cache when the camera gets there.
+class TerrainPrefetcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TerrainPrefetcher(osgEarth::Map *map, QObject *parent = 0);
+    ~TerrainPrefetcher();
+
+    // 0 stops the prefetch
+    void setLookAhead(int seconds);
+    void setCacheSize(int megabytes);
+
+    // The tile cache on disk, shared with the PFD terrain
+    static QString cachePath();
+    static void setupCache(osgEarth::Map *map);
+    // Removes the least recently written tiles until the cache fits maxBytes
+    static void pruneCache(const QString &path, qint64 maxBytes);
+
+private slots:
+    void update();
+
+private:
+    static const int UPDATE_INTERVAL = 2000; // ms
+    static const int MAX_WAYPOINTS   = 8;
+    static const int SEED_LEVEL = 14;
+
+    osg::ref_ptr<osgEarth::Map> m_map;
+    UAVObjectManager *m_objMngr;
+    QTimer m_timer;
+    QFutureWatcher<void> m_watcher;
+    int m_lookAhead;
+    qint64 m_cacheBytes;
+
+    // longitude, latitude in degrees
+    QList<QPointF> routeAhead();
+    static void seed(osg::ref_ptr<osgEarth::Map> map, QList<QPointF> points, qint64 cacheBytes);
+};
+
+#endif // TERRAINPREFETCHER_H
@@ -121,6 +121,7 @@ void PathActionEditorTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
     TreeItem *item;
     QString name = QString::number(obj->getInstID());
     item = new InstanceTreeItem(obj, name);
+    m_instanceItems.insert(obj, item);
     connect(item, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
     parent->appendChild(item);
     foreach(UAVObjectField * field, obj->getFields()) {
@@ -399,12 +400,10 @@ void PathActionEditorTreeModel::updateHighlight(TreeItem *item)
 void PathActionEditorTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
-    if (obj->getName().compare("Waypoint") == 0) {
-        m_waypointsTree->update();
-        // emit dataChanged(index(m_waypointsTree), index(m_waypointsTree));
-    } else if (obj->getName().compare("PathAction") == 0) {
-        m_pathactionsTree->update();
-        // emit dataChanged(index(m_pathactionsTree), index(m_pathactionsTree));
+    // only the updated instance, a mission upload updates every instance once
+    TreeItem *item = m_instanceItems.value(obj);
+    if (item) {
+        item->update();
     }
 }
 
@@ -31,6 +31,7 @@
 #include "treeitem.h"
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
+#include <QtCore/QHash>
 #include <QColor>
 
 class TopTreeItem;
@@ -96,6 +97,7 @@ private:
     TreeItem *m_rootItem;
     TopTreeItem *m_pathactionsTree;
     TopTreeItem *m_waypointsTree;
+    QHash<UAVObject *, TreeItem *> m_instanceItems;
     QColor m_recentlyUpdatedColor;
     QColor m_manuallyChangedColor;
 };
@@ -36,6 +36,7 @@
 #include <osgEarthUtil/EarthManipulator>
 #include <osgEarthUtil/ObjectPlacer>
 #include <osgEarth/Map>
+#include <osgEarthDrivers/cache_filesystem/FileSystemCache>
 
 #include <QtCore/qtimer.h>
 
@@ -186,6 +187,7 @@ void OsgEarthItem::setLatitude(double arg)
     // not sure qFuzzyCompare is accurate enough for geo coordinates
     if (m_latitude != arg) {
         m_latitude = arg;
+        updateFrame();
         emit latitudeChanged(arg);
     }
 }
@@ -194,6 +196,7 @@ void OsgEarthItem::setLongitude(double arg)
 {
     if (m_longitude != arg) {
         m_longitude = arg;
+        updateFrame();
         emit longitudeChanged(arg);
     }
 }
@@ -202,6 +205,7 @@ void OsgEarthItem::setAltitude(double arg)
 {
     if (!qFuzzyCompare(m_altitude, arg)) {
         m_altitude = arg;
+        updateFrame();
         emit altitudeChanged(arg);
     }
 }
@@ -284,6 +288,11 @@ void OsgEarthItemRenderer::initScene()
     osgEarth::MapNode *mapNode = osgEarth::MapNode::findMapNode(m_model.get());
     if (!mapNode) {
         qWarning() << Q_FUNC_INFO << sceneFile << " doesn't look like an osgEarth file";
+    } else {
+        // the tile cache the Earth view prefetches into
+        osgEarth::Drivers::FileSystemCacheOptions cacheOptions;
+        cacheOptions.rootPath() = (Utils::PathUtils().GetStoragePath() + "osgearth/cache").toStdString();
+        mapNode->getMap()->setCache(osgEarth::CacheFactory::create(cacheOptions));
     }
 
     m_gw     = new osgViewer::GraphicsWindowEmbedded(0, 0, w, h);
@@ -87,6 +87,8 @@ PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent) :
 
         if (object) {
             engine()->rootContext()->setContextProperty(objectName, object);
+            // the bindings only need the latest values once per display frame
+            objManager->subscribeFramePropertyNotifications(object);
         } else {
             qWarning() << "Failed to load object" << objectName;
         }
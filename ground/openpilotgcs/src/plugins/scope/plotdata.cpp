@@ -30,13 +30,152 @@
 #include <math.h>
 #include <QDebug>
 
+PlotSeriesData::PlotSeriesData(bool indexed, int maxSize) :
+    m_indexed(indexed), m_maxSize(maxSize), m_head(0), m_count(0),
+    m_displayWidth(0), m_envelopeValid(false)
+{
+    m_samples.resize(maxSize > 0 ? maxSize : 64);
+}
+
+size_t PlotSeriesData::size() const
+{
+    if (useEnvelope()) {
+        updateEnvelope();
+        return m_envelope.size();
+    }
+    return m_count;
+}
+
+QPointF PlotSeriesData::sample(size_t i) const
+{
+    if (useEnvelope()) {
+        updateEnvelope();
+        return m_envelope.at(i);
+    }
+    return rawSample(i);
+}
+
+QPointF PlotSeriesData::rawSample(int i) const
+{
+    const QPointF &point = m_samples.at((m_head + i) % m_samples.size());
+
+    return m_indexed ? QPointF(i, point.y()) : point;
+}
+
+QRectF PlotSeriesData::boundingRect() const
+{
+    // Cached until the next change of the samples
+    if (d_boundingRect.width() < 0.0) {
+        d_boundingRect = qwtBoundingRect(*this);
+    }
+    return d_boundingRect;
+}
+
+/**
+ * Set the width of the plot canvas. When there are more than two samples
+ * per pixel the curve is drawn from a min/max envelope of the samples, which
+ * looks the same but is much cheaper to paint.
+ * A width of 0 disables the decimation.
+ */
+void PlotSeriesData::setDisplayWidth(int pixels)
+{
+    if (pixels != m_displayWidth) {
+        m_displayWidth = pixels;
+        invalidate();
+    }
+}
+
+void PlotSeriesData::updateEnvelope() const
+{
+    if (m_envelopeValid) {
+        return;
+    }
+    m_envelope.clear();
+    m_envelope.reserve(2 * m_displayWidth);
+
+    // Keep the lowest and highest sample of each bucket, in the order they were received
+    for (int bucket = 0; bucket < m_displayWidth; bucket++) {
+        int first = (int)((qint64)bucket * m_count / m_displayWidth);
+        int last  = (int)((qint64)(bucket + 1) * m_count / m_displayWidth);
+        if (first >= last) {
+            continue;
+        }
+        int minIndex = first;
+        int maxIndex = first;
+        for (int i = first + 1; i < last; i++) {
+            double y = m_samples.at((m_head + i) % m_samples.size()).y();
+            if (y < m_samples.at((m_head + minIndex) % m_samples.size()).y()) {
+                minIndex = i;
+            }
+            if (y > m_samples.at((m_head + maxIndex) % m_samples.size()).y()) {
+                maxIndex = i;
+            }
+        }
+        m_envelope.append(rawSample(qMin(minIndex, maxIndex)));
+        if (minIndex != maxIndex) {
+            m_envelope.append(rawSample(qMax(minIndex, maxIndex)));
+        }
+    }
+    m_envelopeValid = true;
+}
+
+void PlotSeriesData::invalidate()
+{
+    m_envelopeValid = false;
+    d_boundingRect  = QRectF(0.0, 0.0, -1.0, -1.0);
+}
+
+void PlotSeriesData::append(double x, double y)
+{
+    if (m_count == m_samples.size()) {
+        if (m_maxSize > 0) {
+            // Full, overwrite the oldest sample
+            m_head = (m_head + 1) % m_samples.size();
+            m_count--;
+        } else {
+            grow();
+        }
+    }
+    m_samples[(m_head + m_count) % m_samples.size()] = QPointF(x, y);
+    m_count++;
+    invalidate();
+}
+
+void PlotSeriesData::removeFirst()
+{
+    if (m_count > 0) {
+        m_head = (m_head + 1) % m_samples.size();
+        m_count--;
+        invalidate();
+    }
+}
+
+void PlotSeriesData::clear()
+{
+    m_head  = 0;
+    m_count = 0;
+    invalidate();
+}
+
+void PlotSeriesData::grow()
+{
+    // Double the capacity and unwrap the samples to the start of the new buffer
+    QVector<QPointF> samples(m_samples.size() * 2);
+
+    for (int i = 0; i < m_count; i++) {
+        samples[i] = m_samples.at((m_head + i) % m_samples.size());
+    }
+    m_samples = samples;
+    m_head    = 0;
+}
+
 PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
                    int scaleOrderFactor, int meanSamples, QString mathFunction,
                    double plotDataSize, QPen pen, bool antialiased) :
     m_scalePower(scaleOrderFactor), m_meanSamples(meanSamples),
     m_meanSum(0.0f), m_mathFunction(mathFunction), m_correctionSum(0.0f),
     m_correctionCount(0), m_plotDataSize(plotDataSize),
-    m_object(object), m_field(field), m_element(element),
+    m_plotSeries(NULL), m_object(object), m_field(field), m_element(element),
     m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
 {
     if (m_field->getNumElements() > 1) {
@@ -62,7 +201,6 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     }
 
     m_plotCurve->setPen(m_pen);
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
     m_isEnumPlot = m_field->getType() == UAVObjectField::ENUM;
 }
 
@@ -77,6 +215,13 @@ PlotData::~PlotData()
     delete m_plotCurve;
 }
 
+void PlotData::setPlotSeries(PlotSeriesData *series)
+{
+    // The curve takes ownership of the series
+    m_plotSeries = series;
+    m_plotCurve->setData(m_plotSeries);
+}
+
 bool PlotData::isVisible() const
 {
     return m_plotCurve->isVisible();
@@ -90,7 +235,12 @@ void PlotData::setVisible(bool visible)
 
 void PlotData::updatePlotData()
 {
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    // Decimate the curve to the canvas width
+    if (m_plotCurve->plot()) {
+        m_plotSeries->setDisplayWidth(m_plotCurve->plot()->canvas()->width());
+    }
+    // The curve reads the series in place, just let it know the samples changed
+    m_plotCurve->itemChanged();
 }
 
 void PlotData::clear()
@@ -98,8 +248,8 @@ void PlotData::clear()
     m_meanSum = 0.0f;
     m_correctionSum   = 0.0f;
     m_correctionCount = 0;
-    m_xDataEntries.clear();
-    m_yDataEntries.clear();
+    m_yDataHistory.clear();
+    m_plotSeries->clear();
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
@@ -113,7 +263,7 @@ void PlotData::clear()
 bool PlotData::hasData() const
 {
     if (!m_isEnumPlot) {
-        return !m_xDataEntries.isEmpty();
+        return !m_plotSeries->isEmpty();
     } else {
         return !m_enumMarkerList.isEmpty();
     }
@@ -122,7 +272,7 @@ bool PlotData::hasData() const
 QString PlotData::lastDataAsString()
 {
     if (!m_isEnumPlot) {
-        return QString().sprintf("%3.10g", m_yDataEntries.last());
+        return QString().sprintf("%3.10g", m_plotSeries->lastY());
     } else {
         return m_enumMarkerList.last()->title().text();
     }
@@ -142,7 +292,7 @@ void PlotData::visibilityChanged(QwtPlotItem *item)
     }
 }
 
-void PlotData::calcMathFunction(double currentValue)
+double PlotData::calcMathFunction(double currentValue)
 {
     // Put the new value at the back
     m_yDataHistory.append(currentValue);
@@ -169,10 +319,9 @@ void PlotData::calcMathFunction(double currentValue)
         for (int i = 0; i < m_yDataHistory.size(); i++) {
             stdSum += pow(m_yDataHistory.at(i) - boxcarAvg, 2) / (m_meanSamples - 1);
         }
-        m_yDataEntries.append(sqrt(stdSum));
-    } else {
-        m_yDataEntries.append(boxcarAvg);
+        return sqrt(stdSum);
     }
+    return boxcarAvg;
 }
 
 QwtPlotMarker *PlotData::createMarker(QString value)
@@ -207,22 +356,16 @@ bool SequentialPlotData::append(UAVObject *obj)
 
     if (m_object == obj && m_field) {
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+            double currentValue = m_field->getDouble(m_element) * pow(10, m_scalePower);
 
             // Perform scope math, if necessary
             if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
+                currentValue = calcMathFunction(currentValue);
             }
 
-            if (m_yDataEntries.size() > m_plotDataSize) {
-                // If new data overflows the window, remove old data...
-                m_yDataEntries.pop_front();
-            } else {
-                // ...otherwise, add a new y point at position xData
-                m_xDataEntries.insert(m_xDataEntries.size(), m_xDataEntries.size());
-            }
+            // The series is bounded to the window size and drops the oldest point when full,
+            // x is the position of the point in the window
+            m_plotSeries->append(0, currentValue);
             return true;
         } else {
             // Enum markers
@@ -250,22 +393,22 @@ bool ChronoPlotData::append(UAVObject *obj)
     }
 
     if (m_object == obj && m_field) {
-        // Get the field of interest
-        // THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-        QDateTime NOW = QDateTime::currentDateTime();
-
-        double xValue = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+        // Plot against the time the update was sent or recorded, this keeps the
+        // samples correctly spaced during a log replay at any speed
+        qint64 timestamp = obj->getTimestamp();
+        if (timestamp == 0) {
+            timestamp = QDateTime::currentMSecsSinceEpoch();
+        }
+        double xValue = timestamp / 1000.0;
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
+            double currentValue = m_field->getDouble(m_element) * pow(10, m_scalePower);
 
             // Perform scope math, if necessary
             if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
+                currentValue = calcMathFunction(currentValue);
             }
 
-            m_xDataEntries.append(xValue);
+            m_plotSeries->append(xValue, currentValue);
         } else {
             // Enum markers
             QString value = m_field->getValue(m_element).toString();
@@ -289,10 +432,9 @@ bool ChronoPlotData::append(UAVObject *obj)
 
 void ChronoPlotData::removeStaleData()
 {
-    while (!m_xDataEntries.isEmpty() &&
-           (m_xDataEntries.last() - m_xDataEntries.first()) > m_plotDataSize) {
-        m_yDataEntries.pop_front();
-        m_xDataEntries.pop_front();
+    while (!m_plotSeries->isEmpty() &&
+           (m_plotSeries->lastX() - m_plotSeries->firstX()) > m_plotDataSize) {
+        m_plotSeries->removeFirst();
     }
     while (!m_enumMarkerList.isEmpty() &&
            (m_enumMarkerList.last()->xValue() - m_enumMarkerList.first()->xValue()) > m_plotDataSize) {
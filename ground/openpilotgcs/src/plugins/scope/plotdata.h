@@ -35,6 +35,7 @@
 #include "qwt/src/qwt_plot_curve.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
+#include "qwt/src/qwt_series_data.h"
 #include <qwt/src/qwt_plot_marker.h>
 
 #include <QTimer>
@@ -47,6 +48,67 @@
  */
 enum PlotType { SequentialPlot, ChronoPlot };
 
+/*!
+   \brief Circular buffer of curve samples that is handed to the QwtPlotCurve as is.
+
+   Appending and evicting samples is O(1) and nothing is copied when the curve is redrawn.
+   When the buffer is bounded the oldest sample is overwritten once it is full, otherwise
+   it grows as needed and the owner is expected to evict stale samples.
+   In indexed mode only the y values are stored and the x value of a sample is its position.
+ */
+class PlotSeriesData : public QwtSeriesData<QPointF> {
+public:
+    PlotSeriesData(bool indexed, int maxSize = 0);
+
+    size_t size() const;
+    QPointF sample(size_t i) const;
+    QRectF boundingRect() const;
+
+    bool isEmpty() const
+    {
+        return m_count == 0;
+    }
+    double firstX() const
+    {
+        return rawSample(0).x();
+    }
+    double lastX() const
+    {
+        return rawSample(m_count - 1).x();
+    }
+    double lastY() const
+    {
+        return rawSample(m_count - 1).y();
+    }
+
+    void append(double x, double y);
+    void removeFirst();
+    void clear();
+
+    void setDisplayWidth(int pixels);
+
+private:
+    bool m_indexed;
+    int m_maxSize;
+    int m_head;
+    int m_count;
+    QVector<QPointF> m_samples;
+
+    // Min/max envelope shown instead of the samples when there are more samples than pixels
+    int m_displayWidth;
+    mutable bool m_envelopeValid;
+    mutable QVector<QPointF> m_envelope;
+
+    QPointF rawSample(int i) const;
+    bool useEnvelope() const
+    {
+        return m_displayWidth > 0 && m_count > 2 * m_displayWidth;
+    }
+    void updateEnvelope() const;
+    void invalidate();
+    void grow();
+};
+
 /*!
    \brief Base class that keeps the data for each curve in the plot.
  */
@@ -113,8 +175,8 @@ protected:
     int m_correctionCount;
     double m_plotDataSize;
 
-    QVector<double> m_xDataEntries;
-    QVector<double> m_yDataEntries;
+    // Owned by m_plotCurve
+    PlotSeriesData *m_plotSeries;
     QVector<double> m_yDataHistory;
 
     UAVObject *m_object;
@@ -127,7 +189,8 @@ protected:
     bool m_isVisible;
     QPen m_pen;
     bool m_isEnumPlot;
-    virtual void calcMathFunction(double currentValue);
+    virtual double calcMathFunction(double currentValue);
+    void setPlotSeries(PlotSeriesData *series);
     QwtPlotMarker *createMarker(QString value);
 };
 
@@ -142,7 +205,11 @@ public:
                        int scaleFactor, int meanSamples, QString mathFunction,
                        double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
-                   mathFunction, plotDataSize, pen, antialiased) {}
+                   mathFunction, plotDataSize, pen, antialiased)
+    {
+        // Fixed number of points, x is the position in the window
+        setPlotSeries(new PlotSeriesData(true, qMax((int)plotDataSize, 1)));
+    }
     ~SequentialPlotData() {}
 
     bool append(UAVObject *obj);
@@ -164,7 +231,10 @@ public:
                    double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
                    mathFunction, plotDataSize, pen, antialiased)
-    {}
+    {
+        // Number of points depends on the update rate, stale points are evicted by time
+        setPlotSeries(new PlotSeriesData(false));
+    }
     ~ChronoPlotData() {}
 
     bool append(UAVObject *obj);
@@ -14,6 +14,7 @@ HEADERS += \
     scopegadgetconfiguration.h \
     scopegadget.h \
     scopegadgetwidget.h \
+    scopelogwriter.h \
     scopegadgetfactory.h
 
 SOURCES += \
@@ -23,7 +24,8 @@ SOURCES += \
     scopegadgetconfiguration.cpp \
     scopegadget.cpp \
     scopegadgetfactory.cpp \
-    scopegadgetwidget.cpp
+    scopegadgetwidget.cpp \
+    scopelogwriter.cpp
 
 OTHER_FILES += ScopeGadget.pluginspec
 
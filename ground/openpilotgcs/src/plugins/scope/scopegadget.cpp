@@ -84,6 +84,7 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     widget->setLoggingEnabled(sgConfig->getLoggingEnabled());
     widget->setLoggingNewFileOnConnect(sgConfig->getLoggingNewFileOnConnect());
     widget->setLoggingPath(sgConfig->getLoggingPath());
+    widget->setLoggingBinary(sgConfig->getLoggingBinary());
 
     widget->csvLoggingStop();
     widget->csvLoggingSetName(sgConfig->name());
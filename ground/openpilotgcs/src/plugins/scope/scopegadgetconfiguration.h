@@ -114,6 +114,10 @@ public:
     {
         return m_loggingPath;
     }
+    bool getLoggingBinary()
+    {
+        return m_loggingBinary;
+    }
     void setLoggingEnabled(bool value)
     {
         m_loggingEnabled = value;
@@ -126,6 +130,10 @@ public:
     {
         m_loggingPath = value;
     }
+    void setLoggingBinary(bool value)
+    {
+        m_loggingBinary = value;
+    }
 
 private:
 
@@ -145,6 +153,7 @@ private:
     bool m_loggingEnabled;
     bool m_loggingNewFileOnConnect;
     QString m_loggingPath;
+    bool m_loggingBinary;
 };
 
 #endif // SCOPEGADGETCONFIGURATION_H
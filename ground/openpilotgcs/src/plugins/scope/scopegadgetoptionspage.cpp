@@ -133,6 +133,7 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->LoggingPath->setPath(m_config->getLoggingPath());
     options_page->LoggingConnect->setChecked(m_config->getLoggingNewFileOnConnect());
     options_page->LoggingEnable->setChecked(m_config->getLoggingEnabled());
+    options_page->LoggingBinary->setChecked(m_config->getLoggingBinary());
     connect(options_page->LoggingEnable, SIGNAL(clicked()), this, SLOT(on_loggingEnable_clicked()));
     on_loggingEnable_clicked();
 
@@ -313,6 +314,7 @@ void ScopeGadgetOptionsPage::apply()
     m_config->setLoggingPath(options_page->LoggingPath->path());
     m_config->setLoggingNewFileOnConnect(options_page->LoggingConnect->isChecked());
     m_config->setLoggingEnabled(options_page->LoggingEnable->isChecked());
+    m_config->setLoggingBinary(options_page->LoggingBinary->isChecked());
 }
 
 /*!
@@ -407,6 +409,7 @@ void ScopeGadgetOptionsPage::on_loggingEnable_clicked()
 
     options_page->LoggingPath->setEnabled(en);
     options_page->LoggingConnect->setEnabled(en);
+    options_page->LoggingBinary->setEnabled(en);
     options_page->LoggingLabel->setEnabled(en);
 }
 
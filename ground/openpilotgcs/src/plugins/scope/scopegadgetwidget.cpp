@@ -60,14 +60,14 @@
 
 ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     m_csvLoggingStarted(false), m_csvLoggingEnabled(false),
-    m_csvLoggingHeaderSaved(false), m_csvLoggingDataSaved(false),
-    m_csvLoggingNameSet(false), m_csvLoggingDataValid(false),
-    m_csvLoggingDataUpdated(false), m_csvLoggingConnected(false),
-    m_csvLoggingNewFileOnConnect(false),
+    m_csvLoggingNameSet(false), m_csvLoggingConnected(false),
+    m_csvLoggingNewFileOnConnect(false), m_csvLoggingBinary(false),
     m_csvLoggingStartTime(QDateTime::currentDateTime()),
     m_csvLoggingPath("./csvlogging/"),
     m_plotLegend(NULL)
 {
+    m_lastObjectTimestamp = 0;
+
     setMouseTracking(true);
 
     QwtPlotCanvas *plotCanvas = dynamic_cast<QwtPlotCanvas *>(canvas());
@@ -83,6 +83,8 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     replotTimer = new QTimer(this);
     connect(replotTimer, SIGNAL(timeout()), this, SLOT(replotNewData()));
 
+    m_logWriter = new ScopeLogWriter(this);
+
     // Listen to telemetry connection/disconnection events, no point in
     // running the scopes if we are not connected and not replaying logs.
     // Also listen to disconnect actions from the user
@@ -106,6 +108,8 @@ ScopeGadgetWidget::~ScopeGadgetWidget()
         replotTimer = NULL;
     }
 
+    csvLoggingStop();
+
     // Get the object to de-monitor
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
@@ -385,6 +389,7 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
 
     // Keep the curve details for later
     m_curvesData.insert(plotData->plotName(), plotData);
+    m_curvesByObject.insert(object, plotData);
 
     // Link to the new signal data only if this UAVObject has not been connected yet
     if (!m_connectedUAVObjects.contains(object->getName())) {
@@ -399,12 +404,19 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
 
 void ScopeGadgetWidget::uavObjectReceived(UAVObject *obj)
 {
-    foreach(PlotData * plotData, m_curvesData.values()) {
-        if (plotData->append(obj)) {
-            m_csvLoggingDataUpdated = 1;
+    QMultiHash<UAVObject *, PlotData *>::const_iterator it = m_curvesByObject.constFind(obj);
+
+    m_lastObjectTimestamp = obj->getTimestamp();
+
+    qint64 logTime = m_lastObjectTimestamp > 0 ? m_lastObjectTimestamp : QDateTime::currentMSecsSinceEpoch();
+    for (; it != m_curvesByObject.constEnd() && it.key() == obj; ++it) {
+        PlotData *plotData = it.value();
+        plotData->append(obj);
+        if (m_csvLoggingStarted) {
+            // the raw value, the formatting is left to the writer thread
+            m_logWriter->record(m_logColumns.value(plotData), logTime, plotData->field()->getDouble(plotData->element()));
         }
     }
-    csvLoggingAddData();
 }
 
 void ScopeGadgetWidget::replotNewData()
@@ -419,15 +431,12 @@ void ScopeGadgetWidget::replotNewData()
         plotData->updatePlotData();
     }
 
-    QDateTime NOW = QDateTime::currentDateTime();
-    double toTime = NOW.toTime_t();
-    toTime += NOW.time().msec() / 1000.0;
+    // Follow the time of the received updates rather than the wall clock
+    double toTime = (m_lastObjectTimestamp > 0 ? m_lastObjectTimestamp : QDateTime::currentMSecsSinceEpoch()) / 1000.0;
     if (m_plotType == ChronoPlot) {
         setAxisScale(QwtPlot::xBottom, toTime - m_plotDataSize, toTime);
     }
 
-    csvLoggingInsertData();
-
     replot();
 }
 
@@ -438,6 +447,8 @@ void ScopeGadgetWidget::clearCurvePlots()
     }
 
     m_curvesData.clear();
+    m_curvesByObject.clear();
+    m_logColumns.clear();
 }
 
 void ScopeGadgetWidget::saveState(QSettings *qSettings)
@@ -475,39 +486,49 @@ void ScopeGadgetWidget::restoreState(QSettings *qSettings)
     }
 }
 
-/*
-   int csvLoggingEnable;
-   int csvLoggingHeaderSaved;
-   int csvLoggingDataSaved;
-   QString csvLoggingPath;
-   QFile csvLoggingFile;
- */
 int ScopeGadgetWidget::csvLoggingStart()
 {
     if (!m_csvLoggingStarted) {
         if (m_csvLoggingEnabled) {
             if ((!m_csvLoggingNewFileOnConnect) || (m_csvLoggingNewFileOnConnect && m_csvLoggingConnected)) {
                 QDateTime NOW = QDateTime::currentDateTime();
-                m_csvLoggingStartTime   = NOW;
-                m_csvLoggingHeaderSaved = 0;
-                m_csvLoggingDataSaved   = 0;
-                m_csvLoggingBuffer.clear();
+                m_csvLoggingStartTime = NOW;
                 QDir PathCheck(m_csvLoggingPath);
                 if (!PathCheck.exists()) {
                     PathCheck.mkpath("./");
                 }
 
+                QString extension = m_csvLoggingBinary ? "opscope" : "csv";
+                QString fileName;
                 if (m_csvLoggingNameSet) {
-                    m_csvLoggingFile.setFileName(QString("%1/%2_%3_%4.csv").arg(m_csvLoggingPath).arg(m_csvLoggingName).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")));
+                    fileName = QString("%1/%2_%3_%4.%5").arg(m_csvLoggingPath).arg(m_csvLoggingName).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")).arg(extension);
                 } else {
-                    m_csvLoggingFile.setFileName(QString("%1/Log_%2_%3.csv").arg(m_csvLoggingPath).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")));
+                    fileName = QString("%1/Log_%2_%3.%4").arg(m_csvLoggingPath).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")).arg(extension);
                 }
-                QDir FileCheck(m_csvLoggingFile.fileName());
-                if (FileCheck.exists()) {
-                    m_csvLoggingFile.setFileName("");
-                } else {
+                if (QFile::exists(fileName)) {
+                    return 0;
+                }
+
+                QVector<ScopeLogWriter::Column> columns;
+                m_logColumns.clear();
+                foreach(PlotData * plotData, m_curvesData.values()) {
+                    ScopeLogWriter::Column column;
+                    column.name = plotData->object()->getName() + "." + plotData->field()->getName();
+                    if (!plotData->elementName().isEmpty()) {
+                        column.name += "." + plotData->elementName();
+                    }
+                    if (plotData->field()->getType() == UAVObjectField::ENUM) {
+                        column.options = plotData->field()->getOptions();
+                    }
+                    m_logColumns.insert(plotData, columns.size());
+                    columns.append(column);
+                }
+
+                if (m_logWriter->open(fileName, m_csvLoggingBinary ? ScopeLogWriter::BinaryFormat : ScopeLogWriter::CsvFormat,
+                                      columns, NOW.toMSecsSinceEpoch())) {
                     m_csvLoggingStarted = 1;
-                    csvLoggingInsertHeader();
+                } else {
+                    qDebug() << "Unable to open " << fileName << " for csv logging";
                 }
             }
         }
@@ -519,94 +540,7 @@ int ScopeGadgetWidget::csvLoggingStart()
 int ScopeGadgetWidget::csvLoggingStop()
 {
     m_csvLoggingStarted = 0;
-
-    return 0;
-}
-
-int ScopeGadgetWidget::csvLoggingInsertHeader()
-{
-    if (!m_csvLoggingStarted) {
-        return -1;
-    }
-    if (m_csvLoggingHeaderSaved) {
-        return -2;
-    }
-    if (m_csvLoggingDataSaved) {
-        return -3;
-    }
-
-    m_csvLoggingHeaderSaved = 1;
-    if (m_csvLoggingFile.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
-        qDebug() << "Unable to open " << m_csvLoggingFile.fileName() << " for csv logging Header";
-    } else {
-        QTextStream ts(&m_csvLoggingFile);
-        ts << "date" << ", " << "Time" << ", " << "Sec since start" << ", " << "Connected" << ", " << "Data changed";
-
-        foreach(PlotData * plotData2, m_curvesData.values()) {
-            ts << ", ";
-            ts << plotData2->objectName();
-            ts << "." << plotData2->field()->getName();
-            if (!plotData2->elementName().isEmpty()) {
-                ts << "." << plotData2->elementName();
-            }
-        }
-        ts << endl;
-        m_csvLoggingFile.close();
-    }
-    return 0;
-}
-
-int ScopeGadgetWidget::csvLoggingAddData()
-{
-    if (!m_csvLoggingStarted) {
-        return -1;
-    }
-    m_csvLoggingDataValid = false;
-    QDateTime NOW = QDateTime::currentDateTime();
-    QString tempString;
-
-    QTextStream ss(&tempString);
-    ss << NOW.toString("yyyy-MM-dd") << ", " << NOW.toString("hh:mm:ss.z") << ", ";
-
-#if QT_VERSION >= 0x040700
-    ss << (NOW.toMSecsSinceEpoch() - m_csvLoggingStartTime.toMSecsSinceEpoch()) / 1000.00;
-#else
-    ss << (NOW.toTime_t() - m_csvLoggingStartTime.toTime_t());
-#endif
-    ss << ", " << m_csvLoggingConnected << ", " << m_csvLoggingDataUpdated;
-    m_csvLoggingDataUpdated = false;
-
-    foreach(PlotData * plotData2, m_curvesData.values()) {
-        ss << ", ";
-        if (plotData2->hasData()) {
-            ss << plotData2->lastDataAsString();
-            m_csvLoggingDataValid = true;
-        }
-    }
-    ss << endl;
-    if (m_csvLoggingDataValid) {
-        QTextStream ts(&m_csvLoggingBuffer);
-        ts << tempString;
-    }
-
-    return 0;
-}
-
-int ScopeGadgetWidget::csvLoggingInsertData()
-{
-    if (!m_csvLoggingStarted) {
-        return -1;
-    }
-    m_csvLoggingDataSaved = 1;
-
-    if (m_csvLoggingFile.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
-        qDebug() << "Unable to open " << m_csvLoggingFile.fileName() << " for csv logging Data";
-    } else {
-        QTextStream ts(&m_csvLoggingFile);
-        ts << m_csvLoggingBuffer;
-        m_csvLoggingFile.close();
-    }
-    m_csvLoggingBuffer.clear();
+    m_logWriter->close();
 
     return 0;
 }
@@ -627,8 +561,7 @@ void ScopeGadgetWidget::csvLoggingConnect()
 
 void ScopeGadgetWidget::csvLoggingDisconnect()
 {
-    m_csvLoggingHeaderSaved = 0;
-    m_csvLoggingConnected   = 0;
+    m_csvLoggingConnected = 0;
     if (m_csvLoggingNewFileOnConnect) {
         csvLoggingStop();
     }
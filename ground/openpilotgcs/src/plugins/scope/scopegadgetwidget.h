@@ -29,6 +29,7 @@
 #define SCOPEGADGETWIDGET_H_
 
 #include "plotdata.h"
+#include "scopelogwriter.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_legend.h"
@@ -41,6 +42,8 @@
 #include <QTime>
 #include <QVector>
 #include <QMutex>
+#include <QMultiHash>
+#include <QHash>
 
 class QSettings;
 
@@ -118,6 +121,10 @@ public:
     {
         m_csvLoggingPath = value;
     }
+    void setLoggingBinary(bool value)
+    {
+        m_csvLoggingBinary = value;
+    }
 signals:
     void visibilityChanged(QwtPlotItem *item);
 
@@ -153,33 +160,33 @@ private:
     int m_refreshInterval;
     QList<QString> m_connectedUAVObjects;
     QMap<QString, PlotData *> m_curvesData;
+    // Curves fed by each UAVObject, so that an update only reaches the curves bound to it
+    QMultiHash<UAVObject *, PlotData *> m_curvesByObject;
+    // Time stamp (ms since the epoch) of the last update received
+    qint64 m_lastObjectTimestamp;
 
     QTimer *replotTimer;
 
     bool m_csvLoggingStarted;
     bool m_csvLoggingEnabled;
-    bool m_csvLoggingHeaderSaved;
-    bool m_csvLoggingDataSaved;
     bool m_csvLoggingNameSet;
-    bool m_csvLoggingDataValid;
-    bool m_csvLoggingDataUpdated;
     bool m_csvLoggingConnected;
     bool m_csvLoggingNewFileOnConnect;
+    bool m_csvLoggingBinary;
 
     QDateTime m_csvLoggingStartTime;
 
     QString m_csvLoggingName;
     QString m_csvLoggingPath;
-    QString m_csvLoggingBuffer;
-    QFile m_csvLoggingFile;
+
+    // The samples are logged as they are received and written by the writer thread
+    ScopeLogWriter *m_logWriter;
+    // Log column of every curve
+    QHash<PlotData *, int> m_logColumns;
 
     QMutex m_mutex;
     QwtLegend *m_plotLegend;
 
-    int csvLoggingInsertHeader();
-    int csvLoggingAddData();
-    int csvLoggingInsertData();
-
     void deleteLegend();
     void addLegend();
 };
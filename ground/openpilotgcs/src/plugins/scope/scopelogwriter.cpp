@@ -0,0 +1,195 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopelogwriter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief Writes the samples of the scope curves to a file from its own thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "scopelogwriter.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QtEndian>
+#include <string.h>
+
+ScopeLogWriter::ScopeLogWriter(QObject *parent) : QThread(parent),
+    m_samples(new Sample[QUEUE_SIZE]), m_head(0), m_tail(0), m_dropped(0),
+    m_format(CsvFormat), m_startTime(0), m_rowTime(0), m_rowEmpty(true)
+{}
+
+ScopeLogWriter::~ScopeLogWriter()
+{
+    close();
+    delete[] m_samples;
+}
+
+bool ScopeLogWriter::open(const QString &fileName, Format format, const QVector<Column> &columns, qint64 startTime)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    m_format    = format;
+    m_columns   = columns;
+    m_startTime = startTime;
+    m_rowValues.fill(0, columns.size());
+    m_rowSet.fill(false, columns.size());
+    m_rowEmpty  = true;
+    m_head.store(0);
+    m_tail.store(0);
+    m_dropped.store(0);
+
+    writeHeader();
+    start(QThread::LowPriority);
+    return true;
+}
+
+void ScopeLogWriter::close()
+{
+    if (isRunning()) {
+        // nothing is recorded anymore, the thread writes what is left
+        m_stopRequest.release();
+        wait();
+    }
+}
+
+void ScopeLogWriter::record(int column, qint64 time, double value)
+{
+    quint32 head = m_head.load();
+
+    if (head - m_tail.loadAcquire() >= (quint32)QUEUE_SIZE) {
+        m_dropped.fetchAndAddRelaxed(1);
+        return;
+    }
+    Sample &sample = m_samples[head & (QUEUE_SIZE - 1)];
+    sample.time   = time;
+    sample.value  = value;
+    sample.column = column;
+    m_head.storeRelease(head + 1);
+}
+
+void ScopeLogWriter::run()
+{
+    QByteArray out;
+    bool stopping = false;
+
+    out.reserve(WRITE_SIZE + 1024);
+    while (!stopping) {
+        stopping = m_stopRequest.tryAcquire(1, WRITE_PERIOD);
+
+        quint32 head = m_head.loadAcquire();
+        quint32 tail = m_tail.load();
+        while (tail != head) {
+            appendSample(out, m_samples[tail & (QUEUE_SIZE - 1)]);
+            m_tail.storeRelease(++tail);
+            if (out.size() >= WRITE_SIZE) {
+                m_file.write(out);
+                out.clear();
+            }
+        }
+        if (stopping) {
+            appendRow(out);
+        }
+        if (!out.isEmpty()) {
+            m_file.write(out);
+            out.clear();
+        }
+        // the samples of a crash are not lost with the buffers of the file
+        m_file.flush();
+    }
+
+    m_file.close();
+    if (m_dropped.load()) {
+        qDebug() << "Scope log closed," << m_dropped.load() << "samples dropped";
+    }
+}
+
+void ScopeLogWriter::writeHeader()
+{
+    if (m_format == BinaryFormat) {
+        QDataStream ds(&m_file);
+        ds.setByteOrder(QDataStream::LittleEndian);
+        ds.writeRawData("OPSCOPE", 7);
+        ds << (quint8)1 << m_startTime << (quint16)m_columns.size();
+        foreach(const Column &column, m_columns) {
+            ds << column.name << column.options;
+        }
+    } else {
+        QByteArray header("Time, Sec since start");
+        foreach(const Column &column, m_columns) {
+            header += ", " + column.name.toUtf8();
+        }
+        m_file.write(header + "\n");
+    }
+}
+
+void ScopeLogWriter::appendSample(QByteArray &out, const Sample &sample)
+{
+    if (sample.column >= m_columns.size()) {
+        return;
+    }
+    if (m_format == BinaryFormat) {
+        char record[18];
+        qToLittleEndian<qint64>(sample.time, (uchar *)record);
+        qToLittleEndian<quint16>(sample.column, (uchar *)record + 8);
+        quint64 value;
+        memcpy(&value, &sample.value, sizeof(value));
+        qToLittleEndian<quint64>(value, (uchar *)record + 10);
+        out.append(record, sizeof(record));
+        return;
+    }
+    // the curves of one object update share its time and end up in the same row
+    if (!m_rowEmpty && (sample.time != m_rowTime || m_rowSet.at(sample.column))) {
+        appendRow(out);
+    }
+    m_rowTime = sample.time;
+    m_rowValues[sample.column] = sample.value;
+    m_rowSet[sample.column]    = true;
+    m_rowEmpty = false;
+}
+
+void ScopeLogWriter::appendRow(QByteArray &out)
+{
+    if (m_rowEmpty) {
+        return;
+    }
+    out += QByteArray::number(m_rowTime) + ", " + QByteArray::number((m_rowTime - m_startTime) / 1000.0, 'f', 3);
+    for (int i = 0; i < m_columns.size(); i++) {
+        out += ", ";
+        if (!m_rowSet.at(i)) {
+            continue;
+        }
+        const QStringList &options = m_columns.at(i).options;
+        int index = (int)m_rowValues.at(i);
+        if (options.isEmpty()) {
+            out += QByteArray::number(m_rowValues.at(i), 'g', 10);
+        } else if (index >= 0 && index < options.size()) {
+            out += options.at(index).toUtf8();
+        }
+        m_rowSet[i] = false;
+    }
+    out += "\n";
+    m_rowEmpty = true;
+}
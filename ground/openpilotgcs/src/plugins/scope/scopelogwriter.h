@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopelogwriter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief Writes the samples of the scope curves to a file from its own thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCOPELOGWRITER_H
+#define SCOPELOGWRITER_H
+
+#include <QThread>
+#include <QFile>
+#include <QSemaphore>
+#include <QAtomicInteger>
+#include <QStringList>
+#include <QVector>
+
+/**
+ *   Logs the raw value of every update of the scope curves. The samples are queued
+ *   as they are received, without any formatting, and the thread formats and writes
+ *   them a few times a second.
+ *
+ *   The csv file has one row per update time, with the columns of the curves not
+ *   updated at that time left empty. Enum values are written as their option name.
+ *
+ *   The binary file, little endian, is the magic "OPSCOPE" and a version byte (1),
+ *   the start time (qint64, ms since the epoch) and the number of columns (quint16),
+ *   then the name (QString) and enum options (QStringList) of every column as
+ *   serialized by QDataStream. It is followed by 18 byte samples: the time (qint64,
+ *   ms since the epoch), the column (quint16) and the value (double).
+ */
+class ScopeLogWriter : public QThread {
+    Q_OBJECT
+public:
+    enum Format { CsvFormat, BinaryFormat };
+
+    struct Column {
+        QString name;
+        // option names of an enum field, empty otherwise
+        QStringList options;
+    };
+
+    ScopeLogWriter(QObject *parent = 0);
+    ~ScopeLogWriter();
+
+    /** Creates the file, writes its header and starts the thread */
+    bool open(const QString &fileName, Format format, const QVector<Column> &columns, qint64 startTime);
+
+    /** Writes the samples left and closes the file */
+    void close();
+
+    bool isOpen() const
+    {
+        return m_file.isOpen();
+    }
+
+    /** Producer side, called by the thread receiving the updates. It never blocks, the sample is dropped when the queue is full. */
+    void record(int column, qint64 time, double value);
+
+protected:
+    void run();
+
+private:
+    // must be a power of two
+    static const int QUEUE_SIZE   = 1 << 16;
+    static const int WRITE_PERIOD = 200;
+    static const int WRITE_SIZE   = 64 * 1024;
+
+    struct Sample {
+        qint64 time;
+        double value;
+        quint16 column;
+    };
+
+    // Single producer single consumer queue, only the producer moves the head and
+    // only the consumer the tail. The indices run freely and wrap with unsigned arithmetic.
+    Sample *m_samples;
+    QAtomicInteger<quint32> m_head;
+    QAtomicInteger<quint32> m_tail;
+    QAtomicInteger<quint32> m_dropped;
+
+    QFile m_file;
+    Format m_format;
+    QVector<Column> m_columns;
+    qint64 m_startTime;
+    QSemaphore m_stopRequest;
+
+    // csv row being built, written when a sample of a later time or of a column already set arrives
+    qint64 m_rowTime;
+    QVector<double> m_rowValues;
+    QVector<bool> m_rowSet;
+    bool m_rowEmpty;
+
+    void writeHeader();
+    void appendSample(QByteArray &out, const Sample &sample);
+    void appendRow(QByteArray &out);
+};
+
+#endif // SCOPELOGWRITER_H
@@ -5,11 +5,22 @@ include(serial_dependencies.pri)
 QT += serialport
 HEADERS += serialplugin.h \
             serialpluginconfiguration.h \
-            serialpluginoptionspage.h
+            serialpluginoptionspage.h \
+            serialportwatcher.h
 SOURCES += serialplugin.cpp \
             serialpluginconfiguration.cpp \
-            serialpluginoptionspage.cpp
+            serialpluginoptionspage.cpp \
+            serialportwatcher.cpp
 FORMS += \ 
     serialpluginoptions.ui
 RESOURCES += 
 OTHER_FILES += Serial.pluginspec
+
+macx {
+    LIBS += -framework CoreFoundation \
+            -framework IOKit
+}
+
+linux {
+    LIBS += -ludev
+}
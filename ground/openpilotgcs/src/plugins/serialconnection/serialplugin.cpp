@@ -36,43 +36,9 @@
 #include <QDebug>
 
 
-SerialEnumerationThread::SerialEnumerationThread(SerialConnection *serial)
-    : m_serial(serial), m_running(false)
-{}
-
-void SerialEnumerationThread::run()
-{
-    m_running = true;
-    QList <Core::IConnection::device> devices = m_serial->availableDevices();
-    while (m_running) {
-        if (!m_serial->deviceOpened()) {
-            QList <Core::IConnection::device> newDev = m_serial->availableDevices();
-            if (devices != newDev) {
-                devices = newDev;
-                emit enumerationChanged();
-            }
-        }
-        // update available devices every two seconds (doesn't need more)
-        msleep(2000);
-    }
-}
-
-void SerialEnumerationThread::stop()
-{
-    if (!m_running) {
-        return;
-    }
-    m_running = false;
-    // wait for the thread to terminate
-    if (wait(2100) == false) {
-        qDebug() << "Cannot terminate SerialEnumerationThread";
-    }
-}
-
 SerialConnection::SerialConnection() :
     serialHandle(NULL),
     enablePolling(true),
-    m_enumerateThread(this),
     m_deviceOpened(false)
 {
     m_config = new SerialPluginConfiguration("Serial Telemetry", NULL, this);
@@ -80,34 +46,23 @@ SerialConnection::SerialConnection() :
 
     m_optionspage = new SerialPluginOptionsPage(m_config, this);
 
-
-    // Experimental: enable polling on all OS'es since there
-    // were reports that autodetect does not work on XP amongst
-    // others.
-
-    // #ifdef Q_OS_WIN
-////I'm cheating a little bit here:
-////Knowing if the device enumeration really changed is a bit complicated
-////so I just signal it whenever we have a device event...
-// QMainWindow *mw = Core::ICore::instance()->mainWindow();
-// QObject::connect(mw, SIGNAL(deviceChange()),
-// this, SLOT(onEnumerationChanged()));
-// #else
-    // Other OSes do not send such signals:
-    QObject::connect(&m_enumerateThread, SIGNAL(enumerationChanged()),
+    // the port list is only enumerated again when the OS reports a device change
+    m_devices = availableDevices();
+    QObject::connect(&m_watcher, SIGNAL(portsChanged()),
                      this, SLOT(onEnumerationChanged()));
-    m_enumerateThread.start();
-// #endif
 }
 
 SerialConnection::~SerialConnection()
-{
-    m_enumerateThread.stop();
-}
+{}
 
 void SerialConnection::onEnumerationChanged()
 {
-    if (enablePolling) {
+    if (!enablePolling) {
+        return;
+    }
+    QList <Core::IConnection::device> devices = availableDevices();
+    if (devices != m_devices) {
+        m_devices = devices;
         emit availableDevChanged(this);
     }
 }
@@ -218,6 +173,8 @@ void SerialConnection::suspendPolling()
 void SerialConnection::resumePolling()
 {
     enablePolling = true;
+    // ports may have come and gone while suspended
+    onEnumerationChanged();
 }
 
 SerialPlugin::SerialPlugin() : m_connection(0)
@@ -35,35 +35,10 @@
 #include <extensionsystem/iplugin.h>
 #include "serialpluginconfiguration.h"
 #include "serialpluginoptionspage.h"
-#include <QThread>
+#include "serialportwatcher.h"
 
 class IConnection;
 class QSerialPortInfo;
-class SerialConnection;
-
-/**
- *   Helper thread to check on new serial port connection/disconnection
- *   Some operating systems do not send device insertion events so
- *   for those we have to poll
- */
-// class SERIAL_EXPORT SerialEnumerationThread : public QThread
-class SerialEnumerationThread : public QThread {
-    Q_OBJECT
-public:
-    SerialEnumerationThread(SerialConnection *serial);
-
-    virtual void run();
-
-    void stop();
-
-signals:
-    void enumerationChanged();
-
-protected:
-    SerialConnection *m_serial;
-    bool m_running;
-};
-
 
 /**
  *   Define a connection via the IConnection interface
@@ -113,7 +88,8 @@ protected slots:
     void onEnumerationChanged();
 
 protected:
-    SerialEnumerationThread m_enumerateThread;
+    SerialPortWatcher m_watcher;
+    QList <Core::IConnection::device> m_devices;
     bool m_deviceOpened;
 };
 
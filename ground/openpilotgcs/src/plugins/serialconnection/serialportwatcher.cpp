@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ *
+ * @file       serialportwatcher.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SerialPlugin Serial Connection Plugin
+ * @{
+ * @brief Notifies serial port arrival and removal from the OS hotplug events
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "serialportwatcher.h"
+
+#include <coreplugin/icore.h>
+#include <QMainWindow>
+#include <QDebug>
+
+#if defined(Q_OS_MAC)
+#include <IOKit/serial/IOSerialKeys.h>
+#elif defined(Q_OS_UNIX)
+#include <libudev.h>
+#include <QSocketNotifier>
+#endif
+
+// events of one plug in are coalesced over this time
+#define SETTLE_MS 50
+// only used when the OS notifications are not available
+#define POLL_MS   2000
+
+SerialPortWatcher::SerialPortWatcher(QObject *parent) : QObject(parent)
+{
+    bool notifications = false;
+
+    m_settle.setSingleShot(true);
+    m_settle.setInterval(SETTLE_MS);
+    connect(&m_settle, SIGNAL(timeout()), this, SIGNAL(portsChanged()));
+    connect(&m_poll, SIGNAL(timeout()), this, SIGNAL(portsChanged()));
+
+#if defined(Q_OS_MAC)
+    m_addedIterator   = 0;
+    m_removedIterator = 0;
+    m_notifyPort = IONotificationPortCreate(kIOMasterPortDefault);
+    if (m_notifyPort) {
+        CFRunLoopAddSource(CFRunLoopGetMain(), IONotificationPortGetRunLoopSource(m_notifyPort), kCFRunLoopDefaultMode);
+        // each call consumes a reference of the matching dictionary
+        kern_return_t added = IOServiceAddMatchingNotification(m_notifyPort, kIOFirstMatchNotification,
+                                                               IOServiceMatching(kIOSerialBSDServiceValue),
+                                                               deviceCallback, this, &m_addedIterator);
+        kern_return_t removed = IOServiceAddMatchingNotification(m_notifyPort, kIOTerminatedNotification,
+                                                                 IOServiceMatching(kIOSerialBSDServiceValue),
+                                                                 deviceCallback, this, &m_removedIterator);
+        if (added == KERN_SUCCESS && removed == KERN_SUCCESS) {
+            // the iterators must be drained to arm the notifications
+            deviceCallback(this, m_addedIterator);
+            deviceCallback(this, m_removedIterator);
+            notifications = true;
+        }
+    }
+#elif defined(Q_OS_UNIX)
+    m_notifier = NULL;
+    m_monitor  = NULL;
+    m_udev     = udev_new();
+    if (m_udev) {
+        m_monitor = udev_monitor_new_from_netlink(m_udev, "udev");
+    }
+    if (m_monitor) {
+        udev_monitor_filter_add_match_subsystem_devtype(m_monitor, "tty", NULL);
+        if (udev_monitor_enable_receiving(m_monitor) == 0) {
+            m_notifier = new QSocketNotifier(udev_monitor_get_fd(m_monitor), QSocketNotifier::Read, this);
+            connect(m_notifier, SIGNAL(activated(int)), this, SLOT(onUdevEvent()));
+            notifications = true;
+        }
+    }
+#elif defined(Q_OS_WIN)
+    // the main window forwards WM_DEVICECHANGE, which Windows broadcasts for serial ports
+    QMainWindow *mw = Core::ICore::instance()->mainWindow();
+    if (mw) {
+        connect(mw, SIGNAL(deviceChange()), this, SLOT(onDeviceEvent()));
+        notifications = true;
+    }
+#endif
+
+    if (!notifications) {
+        qDebug() << "SerialPortWatcher: no hotplug notifications, polling serial ports";
+        m_poll.start(POLL_MS);
+    }
+}
+
+SerialPortWatcher::~SerialPortWatcher()
+{
+#if defined(Q_OS_MAC)
+    if (m_addedIterator) {
+        IOObjectRelease(m_addedIterator);
+    }
+    if (m_removedIterator) {
+        IOObjectRelease(m_removedIterator);
+    }
+    if (m_notifyPort) {
+        IONotificationPortDestroy(m_notifyPort);
+    }
+#elif defined(Q_OS_UNIX)
+    delete m_notifier;
+    if (m_monitor) {
+        udev_monitor_unref(m_monitor);
+    }
+    if (m_udev) {
+        udev_unref(m_udev);
+    }
+#endif
+}
+
+void SerialPortWatcher::onDeviceEvent()
+{
+    m_settle.start();
+}
+
+#if defined(Q_OS_MAC)
+void SerialPortWatcher::deviceCallback(void *context, io_iterator_t iterator)
+{
+    io_object_t service;
+    bool any = false;
+
+    while ((service = IOIteratorNext(iterator))) {
+        IOObjectRelease(service);
+        any = true;
+    }
+    if (any) {
+        static_cast<SerialPortWatcher *>(context)->onDeviceEvent();
+    }
+}
+#endif
+
+void SerialPortWatcher::onUdevEvent()
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    struct udev_device *dev = udev_monitor_receive_device(m_monitor);
+
+    if (dev) {
+        udev_device_unref(dev);
+        onDeviceEvent();
+    }
+#endif
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ *
+ * @file       serialportwatcher.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup SerialPlugin Serial Connection Plugin
+ * @{
+ * @brief Notifies serial port arrival and removal from the OS hotplug events
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SERIALPORTWATCHER_H
+#define SERIALPORTWATCHER_H
+
+#include <QObject>
+#include <QTimer>
+
+#if defined(Q_OS_MAC)
+#include <IOKit/IOKitLib.h>
+#elif defined(Q_OS_UNIX)
+struct udev;
+struct udev_monitor;
+class QSocketNotifier;
+#endif
+
+/**
+ *   Watches for serial ports being added or removed, using udev on Linux,
+ *   IOKit notifications on OS X and WM_DEVICECHANGE on Windows.
+ *   Events are coalesced, a single plug in raises several of them.
+ *   If the OS notifications cannot be set up it falls back to polling.
+ */
+class SerialPortWatcher : public QObject {
+    Q_OBJECT
+public:
+    explicit SerialPortWatcher(QObject *parent = 0);
+    ~SerialPortWatcher();
+
+signals:
+    // the set of serial ports may have changed
+    void portsChanged();
+
+private slots:
+    void onDeviceEvent();
+    void onUdevEvent();
+
+private:
+    QTimer m_settle;
+    QTimer m_poll;
+
+#if defined(Q_OS_MAC)
+    static void deviceCallback(void *context, io_iterator_t iterator);
+    IONotificationPortRef m_notifyPort;
+    io_iterator_t m_addedIterator;
+    io_iterator_t m_removedIterator;
+#elif defined(Q_OS_UNIX)
+    struct udev *m_udev;
+    struct udev_monitor *m_monitor;
+    QSocketNotifier *m_notifier;
+#endif
+};
+
+#endif // SERIALPORTWATCHER_H
@@ -47,7 +47,7 @@
 
 VehicleConfigurationHelper::VehicleConfigurationHelper(VehicleConfigurationSource *configSource)
     : m_configSource(configSource), m_uavoManager(0),
-    m_transactionOK(false), m_transactionTimeout(false), m_currentTransactionObjectID(-1),
+    m_transactionOK(false), m_transactionTimeout(false),
     m_progress(0)
 {
     Q_ASSERT(m_configSource);
@@ -60,13 +60,11 @@ bool VehicleConfigurationHelper::setupVehicle(bool save)
 {
     m_progress = 0;
     clearModifiedObjects();
+    snapshotBoardState();
+    // the reset values are only sent if the configuration below does not replace them
     resetVehicleConfig();
     resetGUIData();
-    if (!saveChangesToController(save)) {
-        return false;
-    }
 
-    m_progress = 0;
     applyHardwareConfiguration();
     applyVehicleConfiguration();
     applyActuatorConfiguration();
@@ -90,6 +88,7 @@ bool VehicleConfigurationHelper::setupHardwareSettings(bool save)
 {
     m_progress = 0;
     clearModifiedObjects();
+    snapshotBoardState();
     applyHardwareConfiguration();
     applyManualControlDefaults();
 
@@ -125,6 +124,27 @@ void VehicleConfigurationHelper::clearModifiedObjects()
     m_modifiedObjects.clear();
 }
 
+QByteArray VehicleConfigurationHelper::packedData(UAVDataObject *object)
+{
+    QByteArray data(object->getNumBytes(), 0);
+
+    object->pack((quint8 *)data.data());
+    return data;
+}
+
+void VehicleConfigurationHelper::snapshotBoardState()
+{
+    // the settings were all read from the board when it connected
+    m_boardState.clear();
+    foreach(QList<UAVDataObject *> instances, m_uavoManager->getDataObjects()) {
+        foreach(UAVDataObject * object, instances) {
+            if (object->isSettingsObject()) {
+                m_boardState.insert(object, packedData(object));
+            }
+        }
+    }
+}
+
 void VehicleConfigurationHelper::applyHardwareConfiguration()
 {
     HwSettings *hwSettings = HwSettings::GetInstance(m_uavoManager);
@@ -885,86 +905,92 @@ void VehicleConfigurationHelper::applyTemplateSettings()
 bool VehicleConfigurationHelper::saveChangesToController(bool save)
 {
     qDebug() << "Saving modified objects to controller. " << m_modifiedObjects.count() << " objects in found.";
-    const int OUTER_TIMEOUT = 3000 * 20; // 10 seconds timeout for saving all objects
-    const int INNER_TIMEOUT = 2000; // 1 second timeout on every save attempt
+    const int OUTER_TIMEOUT = 3000 * 20; // 60 seconds timeout for saving all objects
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Q_ASSERT(pm);
     UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
     Q_ASSERT(utilMngr);
 
+    // every object once, in the order it was first modified
+    QList<UAVDataObject *> objects;
+    QList<UAVDataObject *> changed;
+    QHash<UAVDataObject *, QString> descriptions;
+    for (int i = 0; i < m_modifiedObjects.count(); i++) {
+        UAVDataObject *obj = m_modifiedObjects.at(i)->first;
+        if (objects.contains(obj)) {
+            continue;
+        }
+        descriptions.insert(obj, m_modifiedObjects.at(i)->second);
+        if (UAVObject::GetGcsAccess(obj->getMetadata()) == UAVObject::ACCESS_READONLY || !obj->isSettingsObject()) {
+            qDebug() << "Trying to save a UAVDataObject that is read only or is not a settings object.";
+            continue;
+        }
+        objects << obj;
+        if (!m_boardState.contains(obj) || m_boardState.value(obj) != packedData(obj)) {
+            changed << obj;
+        }
+    }
+    qDebug() << changed.count() << "of" << objects.count() << "objects differ from the board.";
+
     QTimer outerTimeoutTimer;
     outerTimeoutTimer.setSingleShot(true);
 
-    QTimer innerTimeoutTimer;
-    innerTimeoutTimer.setSingleShot(true);
-
     connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(uAVOTransactionCompleted(int, bool)));
-    connect(&innerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
     connect(&outerTimeoutTimer, SIGNAL(timeout()), this, SLOT(saveChangesTimeout()));
 
+    m_transactionOK      = true;
+    m_transactionTimeout = false;
+    m_pendingUpdates.clear();
+    m_pendingSaves.clear();
     outerTimeoutTimer.start(OUTER_TIMEOUT);
-    for (int i = 0; i < m_modifiedObjects.count(); i++) {
-        QPair<UAVDataObject *, QString> *objPair = m_modifiedObjects.at(i);
-        m_transactionOK = false;
-        UAVDataObject *obj     = objPair->first;
-        QString objDescription = objPair->second;
-        if (UAVObject::GetGcsAccess(obj->getMetadata()) != UAVObject::ACCESS_READONLY && obj->isSettingsObject()) {
-            emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, objDescription);
-
-            m_currentTransactionObjectID = obj->getObjID();
-
-            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
-            while (!m_transactionOK && !m_transactionTimeout) {
-                // Allow the transaction to take some time
-                innerTimeoutTimer.start(INNER_TIMEOUT);
-
-                // Set object updated
-                obj->updated();
-                if (!m_transactionOK) {
-                    m_eventLoop.exec();
-                }
-                innerTimeoutTimer.stop();
-            }
-            disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
-            if (m_transactionOK) {
-                qDebug() << "Object " << obj->getName() << " was successfully updated.";
-                if (save) {
-                    m_transactionOK = false;
-                    m_currentTransactionObjectID = obj->getObjID();
-                    // Try to save until success or timeout
-                    while (!m_transactionOK && !m_transactionTimeout) {
-                        // Allow the transaction to take some time
-                        innerTimeoutTimer.start(INNER_TIMEOUT);
-
-                        // Persist object in controller
-                        utilMngr->saveObjectToSD(obj);
-                        if (!m_transactionOK) {
-                            m_eventLoop.exec();
-                        }
-                        innerTimeoutTimer.stop();
-                    }
-                    m_currentTransactionObjectID = -1;
-                }
-            }
 
-            if (!m_transactionOK) {
-                qDebug() << "Transaction timed out when trying to save: " << obj->getName();
-            } else {
-                qDebug() << "Object " << obj->getName() << " was successfully saved.";
-            }
-        } else {
-            qDebug() << "Trying to save a UAVDataObject that is read only or is not a settings object.";
+    // the changed objects are sent with several acks in flight, a failed update is sent again
+    for (int i = 0; i < changed.count() && !m_transactionTimeout; i++) {
+        UAVDataObject *obj = changed.at(i);
+        while (m_pendingUpdates.count() >= PIPELINE_DEPTH && !m_transactionTimeout) {
+            m_eventLoop.exec();
         }
         if (m_transactionTimeout) {
-            qDebug() << "Transaction timed out when trying to save " << m_modifiedObjects.count() << " objects.";
             break;
         }
+        emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, descriptions.value(obj));
+        m_pendingUpdates.insert(obj);
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
+        obj->updated();
+    }
+    while (!m_pendingUpdates.isEmpty() && !m_transactionTimeout) {
+        m_eventLoop.exec();
+    }
+    foreach(UAVObject * obj, m_pendingUpdates) {
+        disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
     }
 
+    if (save && !m_transactionTimeout) {
+        // queued at once, the util manager persists them with as few requests as the list allows
+        foreach(UAVDataObject * obj, objects) {
+            m_pendingSaves.insert(obj->getObjID(), obj);
+        }
+        foreach(UAVDataObject * obj, objects) {
+            utilMngr->saveObjectToSD(obj);
+        }
+        while (!m_pendingSaves.isEmpty() && !m_transactionTimeout) {
+            m_eventLoop.exec();
+        }
+    }
+
+    if (m_transactionTimeout) {
+        qDebug() << "Transaction timed out when trying to save " << m_modifiedObjects.count() << " objects.";
+    } else {
+        // what was sent is now the board state
+        foreach(UAVDataObject * obj, changed) {
+            m_boardState.insert(obj, packedData(obj));
+        }
+    }
+    m_transactionOK = !m_transactionTimeout;
+
     outerTimeoutTimer.stop();
     disconnect(&outerTimeoutTimer, SIGNAL(timeout()), this, SLOT(saveChangesTimeout()));
-    disconnect(&innerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
     disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(uAVOTransactionCompleted(int, bool)));
 
     qDebug() << "Finished saving modified objects to controller. Success = " << m_transactionOK;
@@ -974,16 +1000,35 @@ bool VehicleConfigurationHelper::saveChangesToController(bool save)
 
 void VehicleConfigurationHelper::uAVOTransactionCompleted(int oid, bool success)
 {
-    if (oid == m_currentTransactionObjectID) {
-        m_transactionOK = success;
+    UAVObject *obj = m_pendingSaves.value(oid);
+
+    if (!obj) {
+        return;
+    }
+    if (success) {
+        qDebug() << "Object " << obj->getName() << " was successfully saved.";
+        m_pendingSaves.remove(oid);
         m_eventLoop.quit();
+    } else {
+        // try to save until success or timeout
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        pm->getObject<UAVObjectUtilManager>()->saveObjectToSD(obj);
     }
 }
 
 void VehicleConfigurationHelper::uAVOTransactionCompleted(UAVObject *object, bool success)
 {
-    if (object) {
-        uAVOTransactionCompleted(object->getObjID(), success);
+    if (!object || !m_pendingUpdates.contains(object)) {
+        return;
+    }
+    if (success) {
+        qDebug() << "Object " << object->getName() << " was successfully updated.";
+        disconnect(object, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
+        m_pendingUpdates.remove(object);
+        m_eventLoop.quit();
+    } else {
+        // try to update until success or timeout
+        object->updated();
     }
 }
 
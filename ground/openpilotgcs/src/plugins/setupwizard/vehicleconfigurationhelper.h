@@ -30,6 +30,9 @@
 
 #include <QList>
 #include <QPair>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
 #include "vehicleconfigurationsource.h"
 #include "uavobjectmanager.h"
 #include "systemsettings.h"
@@ -98,11 +101,20 @@ private:
     GUIConfigDataUnion getGUIConfigData();
     void applyMultiGUISettings(SystemSettings::AirframeTypeOptions airframe, GUIConfigDataUnion guiConfig);
 
+    // packed settings as the board holds them, only differing objects are sent
+    QHash<UAVDataObject *, QByteArray> m_boardState;
+    static QByteArray packedData(UAVDataObject *object);
+    void snapshotBoardState();
+
+    // acked updates waiting at once, below the telemetry event queue size
+    static const int PIPELINE_DEPTH = 8;
+
     bool saveChangesToController(bool save);
     QEventLoop m_eventLoop;
     bool m_transactionOK;
     bool m_transactionTimeout;
-    int m_currentTransactionObjectID;
+    QSet<UAVObject *> m_pendingUpdates;
+    QHash<int, UAVObject *> m_pendingSaves;
     int m_progress;
 
     void resetVehicleConfig();
@@ -1,6 +1,7 @@
 TEMPLATE = lib
 TARGET = SystemHealthGadget
 QT += svg
+QT += opengl
 include(../../openpilotgcsplugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(systemhealth_dependencies.pri)
@@ -29,6 +29,7 @@
 #include "systemhealthgadgetwidget.h"
 
 #include "utils/stylehelper.h"
+#include "utils/cachedsvgitem.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include <uavtalk/telemetrymanager.h>
@@ -47,9 +48,9 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
 
 
     m_renderer = new QSvgRenderer();
-    background = new QGraphicsSvgItem();
-    foreground = new QGraphicsSvgItem();
-    nolink     = new QGraphicsSvgItem();
+    background = new CachedSvgItem();
+    foreground = new CachedSvgItem();
+    nolink     = new CachedSvgItem();
     missingElements = new QStringList();
     paint();
 
@@ -58,7 +59,7 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
     SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
+    objManager->subscribeFrameUpdates(obj, this, SLOT(updateAlarms(UAVObject *)));
 
     // Listen to autopilot connection events
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
@@ -86,56 +87,95 @@ void SystemHealthGadgetWidget::onAutopilotDisconnect()
 
 void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
 {
-    // This code does not know anything about alarms beforehand, and
-    // I found no efficient way to locate items inside the scene by
-    // name, so it's just as simple to reset the scene:
-    // And add the one with the right name.
-    QGraphicsScene *m_scene = scene();
-
-    foreach(QGraphicsItem * item, background->childItems()) {
-        m_scene->removeItem(item);
-        delete item; // removeItem does _not_ delete the item.
+    // This code does not know anything about alarms beforehand, the indicator
+    // of each alarm state is created the first time it is needed. The alarms
+    // are compared with the ones last shown, only the indicators of the elements
+    // whose state changed are shown or hidden, so only their area is painted again.
+    QByteArray data(systemAlarm->getNumBytes(), 0);
+
+    systemAlarm->getDataSnapshot((quint8 *)data.data());
+    if (data == renderedAlarms) {
+        return;
     }
+    const bool renderAll = renderedAlarms.size() != data.size();
+    const quint8 *current  = (const quint8 *)data.constData();
+    const quint8 *previous = (const quint8 *)renderedAlarms.constData();
 
-    QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
-
-    QString alarm = systemAlarm->getName();
-    foreach(UAVObjectField * field, systemAlarm->getFields()) {
+    QList<UAVObjectField *> fields = systemAlarm->getFields();
+    for (int f = 0; f < fields.count(); ++f) {
+        UAVObjectField *field = fields.at(f);
         for (uint i = 0; i < field->getNumElements(); ++i) {
-            QString element = field->getElementNames()[i];
-            QString value   = field->getValue(i).toString();
-            if (!missingElements->contains(element)) {
-                if (m_renderer->elementExists(element)) {
-                    QString element2 = element + "-" + value;
-                    if (!missingElements->contains(element2)) {
-                        if (m_renderer->elementExists(element2)) {
-                            // element2 is in global coordinates
-                            // transform its matrix into the coordinates of background
-                            QMatrix blockMatrix   = backgroundMatrix * m_renderer->matrixForElement(element2);
-                            // use this composed projection to get the position in background coordinates
-                            QRectF rectProjected  = blockMatrix.mapRect(m_renderer->boundsOnElement(element2));
-
-                            QGraphicsSvgItem *ind = new QGraphicsSvgItem();
-                            ind->setSharedRenderer(m_renderer);
-                            ind->setElementId(element2);
-                            ind->setParentItem(background);
-                            QTransform matrix;
-                            matrix.translate(rectProjected.x(), rectProjected.y());
-                            ind->setTransform(matrix, false);
-                        } else {
-                            if (value.compare("Uninitialised") != 0) {
-                                missingElements->append(element2);
-                                qDebug() << "Warning: element " << element2 << " not found in SVG.";
-                            }
-                        }
-                    }
-                } else {
-                    missingElements->append(element);
-                    qDebug() << "Warning: Element " << element << " not found in SVG.";
-                }
+            const qint64 value = field->getInt(i, current);
+            if (!renderAll && value == field->getInt(i, previous)) {
+                continue;
             }
+            const int key = (f << 16) | i;
+            // the text of the state, as getValue() gives it
+            QString state = (field->getType() == UAVObjectField::ENUM) ?
+                            field->getOptions().value((int)value, field->getOptions().value(0)) : QString::number(value);
+            QGraphicsSvgItem *ind = indicatorFor(field->getElementNames().at(i), state);
+            QGraphicsSvgItem *old = shownIndicators.value(key);
+            if (old == ind) {
+                continue;
+            }
+            if (old) {
+                old->setVisible(false);
+            }
+            if (ind) {
+                ind->setVisible(true);
+                shownIndicators.insert(key, ind);
+            } else {
+                shownIndicators.remove(key);
+            }
+        }
+    }
+    renderedAlarms = data;
+}
+
+/**
+ * The indicator of an alarm element in a given state, created the first time.
+ * Null when the svg has none, the missing elements are remembered.
+ */
+QGraphicsSvgItem *SystemHealthGadgetWidget::indicatorFor(const QString &element, const QString &value)
+{
+    if (missingElements->contains(element)) {
+        return 0;
+    }
+    if (!m_renderer->elementExists(element)) {
+        missingElements->append(element);
+        qDebug() << "Warning: Element " << element << " not found in SVG.";
+        return 0;
+    }
+    QString element2 = element + "-" + value;
+    QGraphicsSvgItem *ind = indicators.value(element2);
+    if (ind || missingElements->contains(element2)) {
+        return ind;
+    }
+    if (!m_renderer->elementExists(element2)) {
+        if (value.compare("Uninitialised") != 0) {
+            missingElements->append(element2);
+            qDebug() << "Warning: element " << element2 << " not found in SVG.";
         }
+        return 0;
     }
+
+    // element2 is in global coordinates
+    // transform its matrix into the coordinates of background
+    QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
+    QMatrix blockMatrix = backgroundMatrix * m_renderer->matrixForElement(element2);
+    // use this composed projection to get the position in background coordinates
+    QRectF rectProjected = blockMatrix.mapRect(m_renderer->boundsOnElement(element2));
+
+    ind = new CachedSvgItem();
+    ind->setSharedRenderer(m_renderer);
+    ind->setElementId(element2);
+    ind->setParentItem(background);
+    ind->setVisible(false);
+    QTransform matrix;
+    matrix.translate(rectProjected.x(), rectProjected.y());
+    ind->setTransform(matrix, false);
+    indicators.insert(element2, ind);
+    return ind;
 }
 
 SystemHealthGadgetWidget::~SystemHealthGadgetWidget()
@@ -148,6 +188,11 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
 {
     // Clear the list of elements not found on svg
     missingElements->clear();
+    // and the indicators of the previous file
+    qDeleteAll(indicators);
+    indicators.clear();
+    shownIndicators.clear();
+    renderedAlarms.clear();
     setBackgroundBrush(QBrush(Utils::StyleHelper::baseColor()));
     if (QFile::exists(dfn)) {
         m_renderer->load(dfn);
@@ -233,12 +278,14 @@ void SystemHealthGadgetWidget::mousePressEvent(QMouseEvent *event)
                     // would always call showAllAlarmDescriptions...
                     haveAlarmItem = true;
                     QString itemId = clickedItem->elementId();
+                    // the cpu alarm also lists where the time goes
+                    QString extraText = itemId.startsWith("CPUOverload") ? cpuUsageDescription() : QString();
                     if (itemId.contains("OK")) {
                         // No alarm set for this item
-                        showAlarmDescriptionForItemId("AlarmOK", event->globalPos());
+                        showAlarmDescriptionForItemId("AlarmOK", event->globalPos(), extraText);
                     } else {
                         // Warning, error or critical alarm
-                        showAlarmDescriptionForItemId(itemId, event->globalPos());
+                        showAlarmDescriptionForItemId(itemId, event->globalPos(), extraText);
                     }
                 } else if (!haveAlarmItem) {
                     // Clicked foreground or background
@@ -249,14 +296,14 @@ void SystemHealthGadgetWidget::mousePressEvent(QMouseEvent *event)
     }
 }
 
-void SystemHealthGadgetWidget::showAlarmDescriptionForItemId(const QString itemId, const QPoint & location)
+void SystemHealthGadgetWidget::showAlarmDescriptionForItemId(const QString itemId, const QPoint & location, const QString &extraText)
 {
     QFile alarmDescription(":/systemhealth/html/" + itemId + ".html");
 
     if (alarmDescription.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream textStream(&alarmDescription);
         textStream.setCodec("UTF-8");
-        QWhatsThis::showText(location, textStream.readAll());
+        QWhatsThis::showText(location, textStream.readAll() + extraText);
     }
 }
 
@@ -271,7 +318,7 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint & location)
         foreach(QGraphicsItem * curItem, graphicsScene->items()) {
             QGraphicsSvgItem *curSvgItem = dynamic_cast<QGraphicsSvgItem *>(curItem);
 
-            if (curSvgItem && (curSvgItem != foreground) && (curSvgItem != background)) {
+            if (curSvgItem && curSvgItem->isVisible() && (curSvgItem != foreground) && (curSvgItem != background)) {
                 QString elementId = curSvgItem->elementId();
                 if (!elementId.contains("OK")) {
                     // Found an alarm, get its corresponding alarm html file contents
@@ -282,6 +329,9 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint & location)
                         textStream.setCodec("UTF-8");
                         alarmsText.append(textStream.readAll());
                     }
+                    if (elementId.startsWith("CPUOverload")) {
+                        alarmsText.append(cpuUsageDescription());
+                    }
                 }
             }
         }
@@ -292,3 +342,51 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint & location)
         }
     }
 }
+
+/**
+ * Html table of the cpu time, longest run and context switches of the running
+ * tasks and callbacks, as last reported in TaskInfo and CallbackInfo
+ */
+QString SystemHealthGadgetWidget::cpuUsageDescription() const
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    UAVObject *taskInfo     = objManager->getObject(QString("TaskInfo"));
+    UAVObject *callbackInfo = objManager->getObject(QString("CallbackInfo"));
+
+    if (!taskInfo || !callbackInfo) {
+        return QString();
+    }
+
+    QString text("<h2>CPU usage</h2><table><tr><th align=\"left\">Task</th><th>CPU %</th><th>Max run (us)</th><th>Switches</th></tr>");
+    UAVObjectField *running  = taskInfo->getField("Running");
+    UAVObjectField *cpuTime  = taskInfo->getField("RunningTime");
+    UAVObjectField *maxRun   = taskInfo->getField("MaxRunTime");
+    UAVObjectField *switches = taskInfo->getField("ContextSwitches");
+    for (uint i = 0; i < running->getNumElements(); ++i) {
+        if (running->getValue(i).toString() == "True") {
+            text.append(QString("<tr><td>%1</td><td align=\"right\">%2</td><td align=\"right\">%3</td><td align=\"right\">%4</td></tr>")
+                        .arg(running->getElementNames().at(i))
+                        .arg(cpuTime->getValue(i).toUInt())
+                        .arg(maxRun->getValue(i).toUInt())
+                        .arg(switches->getValue(i).toUInt()));
+        }
+    }
+
+    text.append("<tr><th align=\"left\">Callback</th><th>CPU %</th><th>Max run (us)</th><th>Max latency (us)</th></tr>");
+    running = callbackInfo->getField("Running");
+    cpuTime = callbackInfo->getField("CPUTime");
+    maxRun  = callbackInfo->getField("MaxRunTime");
+    UAVObjectField *latency = callbackInfo->getField("MaxLatency");
+    for (uint i = 0; i < running->getNumElements(); ++i) {
+        if (running->getValue(i).toString() == "True") {
+            text.append(QString("<tr><td>%1</td><td align=\"right\">%2</td><td align=\"right\">%3</td><td align=\"right\">%4</td></tr>")
+                        .arg(running->getElementNames().at(i))
+                        .arg(cpuTime->getValue(i).toUInt())
+                        .arg(maxRun->getValue(i).toUInt())
+                        .arg(latency->getValue(i).toUInt()));
+        }
+    }
+    text.append("</table>");
+    return text;
+}
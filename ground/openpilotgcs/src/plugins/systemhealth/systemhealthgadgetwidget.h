@@ -38,6 +38,8 @@
 
 #include <QFile>
 #include <QTimer>
+#include <QHash>
+#include <QSet>
 
 class SystemHealthGadgetWidget : public QGraphicsView {
     Q_OBJECT
@@ -65,10 +67,18 @@ private:
     QGraphicsSvgItem *foreground;
     QGraphicsSvgItem *nolink;
     QStringList *missingElements;
+    // alarm indicators by element id, created once and shown while the alarm is in that state
+    QHash<QString, QGraphicsSvgItem *> indicators;
+    // indicator shown for each alarm element, keyed by field index << 16 | element index
+    QHash<int, QGraphicsSvgItem *> shownIndicators;
+    // raw SystemAlarms data the indicators were last updated from
+    QByteArray renderedAlarms;
     // Simple flag to skip rendering if the
     bool fgenabled; // layer does not exist.
 
-    void showAlarmDescriptionForItemId(const QString itemId, const QPoint & location);
+    void showAlarmDescriptionForItemId(const QString itemId, const QPoint & location, const QString &extraText = QString());
     void showAllAlarmDescriptions(const QPoint &location);
+    QString cpuUsageDescription() const;
+    QGraphicsSvgItem *indicatorFor(const QString &element, const QString &value);
 };
 #endif /* SYSTEMHEALTHGADGETWIDGET_H_ */
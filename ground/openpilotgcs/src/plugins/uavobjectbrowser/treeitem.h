@@ -283,12 +283,12 @@ class ObjectTreeItem : public TreeItem {
     Q_OBJECT
 public:
     ObjectTreeItem(const QList<QVariant> &data, UAVObject *object, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(object)
+        TreeItem(data, parent), m_obj(object), m_fieldsCreated(false)
     {
         setDescription(m_obj->getDescription());
     }
     ObjectTreeItem(const QVariant &data, UAVObject *object, TreeItem *parent = 0) :
-        TreeItem(data, parent), m_obj(object)
+        TreeItem(data, parent), m_obj(object), m_fieldsCreated(false)
     {
         setDescription(m_obj->getDescription());
     }
@@ -300,9 +300,19 @@ public:
     {
         return !m_obj->isSettingsObject() || m_obj->isKnown();
     }
+    // field items are only created once the item is expanded
+    inline bool fieldsCreated() const
+    {
+        return m_fieldsCreated;
+    }
+    inline void setFieldsCreated(bool created)
+    {
+        m_fieldsCreated = created;
+    }
 
 private:
     UAVObject *m_obj;
+    bool m_fieldsCreated;
 };
 
 class MetaObjectTreeItem : public ObjectTreeItem {
@@ -37,6 +37,9 @@
 #include <QtCore/QSignalMapper>
 #include <QtCore/QDebug>
 
+// objects streaming at high rates are repainted at most this often
+static const int UpdateInterval = 100; // ms
+
 UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool useScientificNotation) :
     QAbstractItemModel(parent),
     m_useScientificFloatNotation(useScientificNotation),
@@ -53,6 +56,10 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
 
     // Create highlight manager, let it run every 300 ms.
     m_highlightManager = new HighLightManager(300);
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(UpdateInterval);
+    connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(flushUpdates()));
     connect(objManager, SIGNAL(newObject(UAVObject *)), this, SLOT(newObject(UAVObject *)));
     connect(objManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newObject(UAVObject *)));
 
@@ -155,14 +162,8 @@ MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeIt
 
     meta->setHighlightManager(m_highlightManager);
     connect(meta, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
-    foreach(UAVObjectField * field, obj->getFields()) {
-        if (field->getNumElements() > 1) {
-            addArrayField(field, meta);
-        } else {
-            addSingleField(0, field, meta);
-        }
-    }
     parent->appendChild(meta);
+    m_objectItems.insert(obj, meta);
     return meta;
 }
 
@@ -170,19 +171,27 @@ void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
     connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(highlightUpdatedObject(UAVObject *)));
     connect(obj, SIGNAL(isKnownChanged(UAVObject *, bool)), this, SLOT(isKnownChanged(UAVObject *, bool)));
-    TreeItem *item;
     if (obj->isSingleInstance()) {
-        item = parent;
         DataObjectTreeItem *objectItem = static_cast<DataObjectTreeItem *>(parent);
         connect(objectItem, SIGNAL(updateIsKnown(TreeItem *)), this, SLOT(updateIsKnown(TreeItem *)));
+        m_objectItems.insert(obj, objectItem);
     } else {
+        // fields live in the instance items, the object item only groups them
+        static_cast<DataObjectTreeItem *>(parent)->setFieldsCreated(true);
         QString name = tr("Instance") + " " + QString::number(obj->getInstID());
-        item = new InstanceTreeItem(obj, name);
+        InstanceTreeItem *item = new InstanceTreeItem(obj, name);
         item->setHighlightManager(m_highlightManager);
         connect(item, SIGNAL(updateHighlight(TreeItem *)), this, SLOT(updateHighlight(TreeItem *)));
         connect(item, SIGNAL(updateIsKnown(TreeItem *)), this, SLOT(updateIsKnown(TreeItem *)));
         parent->appendChild(item);
+        m_objectItems.insert(obj, item);
     }
+}
+
+void UAVObjectTreeModel::addFields(UAVObject *obj, TreeItem *parent)
+{
+    TreeItem *item = parent;
+
     foreach(UAVObjectField * field, obj->getFields()) {
         if (field->getNumElements() > 1) {
             addArrayField(field, item);
@@ -286,18 +295,7 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
     if (item->parent() == 0) {
         return QModelIndex();
     }
-
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem *>(childIndex.internalPointer());
-        if (child == item) {
-            return childIndex;
-        }
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    return createIndex(item->row(), 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -342,6 +340,47 @@ int UAVObjectTreeModel::columnCount(const QModelIndex &parent) const
     }
 }
 
+ObjectTreeItem *UAVObjectTreeModel::lazyItem(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.column() > 0) {
+        return 0;
+    }
+    ObjectTreeItem *item = dynamic_cast<ObjectTreeItem *>(static_cast<TreeItem *>(index.internalPointer()));
+    return (item && !item->fieldsCreated()) ? item : 0;
+}
+
+bool UAVObjectTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (lazyItem(parent)) {
+        return true;
+    }
+    return rowCount(parent) > 0;
+}
+
+bool UAVObjectTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    return lazyItem(parent) != 0;
+}
+
+void UAVObjectTreeModel::fetchMore(const QModelIndex &parent)
+{
+    ObjectTreeItem *item = lazyItem(parent);
+
+    if (!item) {
+        return;
+    }
+    int first = item->childCount();
+    int count = item->object()->getFields().count();
+    if (count > 0) {
+        beginInsertRows(parent, first, first + count - 1);
+        addFields(item->object(), item);
+        item->setFieldsCreated(true);
+        endInsertRows();
+    } else {
+        item->setFieldsCreated(true);
+    }
+}
+
 QList<QModelIndex> UAVObjectTreeModel::getMetaDataIndexes()
 {
     QList<QModelIndex> metaIndexes;
@@ -449,53 +488,68 @@ void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
     Q_ASSERT(obj);
     ObjectTreeItem *item = findObjectTreeItem(obj);
     Q_ASSERT(item);
-    if (!m_onlyHilightChangedValues) {
-        item->setHighlight(true);
-    }
-    item->update();
-    if (!m_onlyHilightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+    if (item) {
+        m_updatedObjects.insert(item);
+        scheduleUpdate();
     }
 }
 
 ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(object);
-    UAVMetaObject *metaObject = qobject_cast<UAVMetaObject *>(object);
-
-    Q_ASSERT(dataObject || metaObject);
-    if (dataObject) {
-        return findDataObjectTreeItem(dataObject);
-    } else {
-        return findMetaObjectTreeItem(metaObject);
-    }
-    return 0;
+    return m_objectItems.value(object, 0);
 }
 
-DataObjectTreeItem *UAVObjectTreeModel::findDataObjectTreeItem(UAVDataObject *obj)
+void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    TopTreeItem *root = obj->isSettingsObject() ? m_settingsTree : m_nonSettingsTree;
-
-    return root->findDataObjectTreeItemByObjectId(obj->getObjID());
+    m_changedItems.insert(item);
+    scheduleUpdate();
 }
 
-MetaObjectTreeItem *UAVObjectTreeModel::findMetaObjectTreeItem(UAVMetaObject *obj)
+void UAVObjectTreeModel::scheduleUpdate()
 {
-    UAVDataObject *dataObject = qobject_cast<UAVDataObject *>(obj->getParentObject());
-
-    Q_ASSERT(dataObject);
-    TopTreeItem *root = dataObject->isSettingsObject() ? m_settingsTree : m_nonSettingsTree;
-    return root->findMetaObjectTreeItemByObjectId(obj->getObjID());
+    if (!m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
 }
 
-void UAVObjectTreeModel::updateHighlight(TreeItem *item)
+void UAVObjectTreeModel::flushUpdates()
 {
-    QModelIndex itemIndex = index(item);
+    QSet<ObjectTreeItem *> updated = m_updatedObjects;
+
+    m_updatedObjects.clear();
+    foreach(ObjectTreeItem * item, updated) {
+        // a collapsed object has no field items to tell whether its values changed
+        if (!m_onlyHilightChangedValues || !item->fieldsCreated()) {
+            item->setHighlight(true);
+            m_changedItems.insert(item);
+        }
+        item->update();
+    }
 
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::DATA_COLUMN));
+    // one dataChanged per parent item, covering all its changed rows
+    QHash<TreeItem *, QPair<int, int> > ranges;
+    foreach(TreeItem * item, m_changedItems) {
+        TreeItem *parent = item->parent();
+        if (!parent) {
+            continue;
+        }
+        int row = item->row();
+        if (ranges.contains(parent)) {
+            QPair<int, int> &range = ranges[parent];
+            range.first  = qMin(range.first, row);
+            range.second = qMax(range.second, row);
+        } else {
+            ranges.insert(parent, qMakePair(row, row));
+        }
+    }
+    m_changedItems.clear();
+
+    QHash<TreeItem *, QPair<int, int> >::const_iterator i;
+    for (i = ranges.constBegin(); i != ranges.constEnd(); ++i) {
+        QModelIndex parentIndex = index(i.key());
+        emit dataChanged(index(i.value().first, 0, parentIndex),
+                         index(i.value().second, m_rootItem->columnCount() - 1, parentIndex));
+    }
 }
 
 void UAVObjectTreeModel::updateIsKnown(TreeItem *item)
@@ -32,6 +32,8 @@
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QColor>
 
 class TopTreeItem;
@@ -61,6 +63,9 @@ public:
     QModelIndex parent(const QModelIndex &index) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
 
     void setUnknowObjectColor(QColor color)
     {
@@ -96,6 +101,7 @@ private slots:
     void updateIsKnown(TreeItem *item);
     void highlightUpdatedObject(UAVObject *obj);
     void isKnownChanged(UAVObject *object, bool isKnown);
+    void flushUpdates();
 
 private:
     void setupModelData(UAVObjectManager *objManager);
@@ -105,13 +111,14 @@ private:
     void addArrayField(UAVObjectField *field, TreeItem *parent);
     void addSingleField(int index, UAVObjectField *field, TreeItem *parent);
     void addInstance(UAVObject *obj, TreeItem *parent);
+    void addFields(UAVObject *obj, TreeItem *parent);
+    ObjectTreeItem *lazyItem(const QModelIndex &index) const;
+    void scheduleUpdate();
 
     TreeItem *createCategoryItems(QStringList categoryPath, TreeItem *root);
 
     QString updateMode(quint8 updateMode);
     ObjectTreeItem *findObjectTreeItem(UAVObject *obj);
-    DataObjectTreeItem *findDataObjectTreeItem(UAVDataObject *obj);
-    MetaObjectTreeItem *findMetaObjectTreeItem(UAVMetaObject *obj);
 
     TreeItem *m_rootItem;
     TopTreeItem *m_settingsTree;
@@ -126,6 +133,13 @@ private:
 
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
+
+    // the item showing each object, data instance or meta object
+    QHash<UAVObject *, ObjectTreeItem *> m_objectItems;
+    // updates and highlight changes waiting for the next flushUpdates()
+    QSet<ObjectTreeItem *> m_updatedObjects;
+    QSet<TreeItem *> m_changedItems;
+    QTimer *m_updateTimer;
 };
 
 #endif // UAVOBJECTTREEMODEL_H
@@ -0,0 +1,18 @@
+# Field access throughput of the GCS UAVObjects, run against the built plugin.
+# "make benchmark" writes the results to tst_uavobjectbenchmark.xml.
+QT += testlib widgets
+TEMPLATE = app
+TARGET = tst_uavobjectbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../../../../openpilotgcs.pri)
+include(../../uavobjects.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot
+
+SOURCES += tst_uavobjectbenchmark.cpp
+
+benchmark.commands = ./$$TARGET -o $${TARGET}.xml,xml
+benchmark.depends  = $$TARGET
+QMAKE_EXTRA_TARGETS += benchmark
@@ -0,0 +1,253 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavobjectbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief Throughput of the field accessors and of pack/unpack
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavobjectmanager.h"
+#include "attitudestate.h"
+#include "waypoint.h"
+
+#include <QtTest/QtTest>
+#include <QThread>
+
+// Unpacks the object in a loop, the other side of the contended benchmark.
+// Every unpack queues a notification to the main thread, so it is throttled.
+class UnpackThread : public QThread {
+public:
+    UnpackThread(UAVObject *obj) : m_obj(obj), m_stop(0) {}
+
+    void stop()
+    {
+        m_stop.store(1);
+        wait();
+    }
+
+protected:
+    void run()
+    {
+        QByteArray buffer(m_obj->getNumBytes(), 0);
+
+        m_obj->pack((quint8 *)buffer.data());
+        while (!m_stop.load()) {
+            m_obj->unpack((const quint8 *)buffer.constData());
+            usleep(10);
+        }
+    }
+
+private:
+    UAVObject *m_obj;
+    QAtomicInt m_stop;
+};
+
+class tst_UAVObjectBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void getValue();
+    void getDouble();
+    void setValue();
+    void propertyGetter();
+    void propertySetter();
+    void packUnpack();
+    void waypointInstances();
+    void reservedInstances();
+    void getDoubleContended();
+    void getObjectById();
+    void getObjectByName();
+
+private:
+    UAVObjectManager *m_objMngr;
+    AttitudeState *m_attitude;
+    Waypoint *m_waypoint;
+};
+
+void tst_UAVObjectBenchmark::initTestCase()
+{
+    m_objMngr  = new UAVObjectManager();
+    m_attitude = new AttitudeState();
+    m_waypoint = new Waypoint();
+    m_objMngr->registerObject(m_attitude);
+    m_objMngr->registerObject(m_waypoint);
+    for (quint32 n = 1; n < 100; ++n) {
+        m_objMngr->registerObject(m_waypoint->clone(n));
+    }
+}
+
+void tst_UAVObjectBenchmark::cleanupTestCase()
+{
+    delete m_objMngr;
+}
+
+void tst_UAVObjectBenchmark::getValue()
+{
+    UAVObjectField *field = m_attitude->getField("Roll");
+    double sum = 0.0;
+
+    QBENCHMARK {
+        sum += field->getValue().toDouble();
+    }
+    Q_UNUSED(sum);
+}
+
+void tst_UAVObjectBenchmark::getDouble()
+{
+    UAVObjectField *field = m_attitude->getField("Roll");
+    double sum = 0.0;
+
+    QBENCHMARK {
+        sum += field->getDouble();
+    }
+    Q_UNUSED(sum);
+}
+
+void tst_UAVObjectBenchmark::setValue()
+{
+    UAVObjectField *field = m_attitude->getField("Roll");
+    int n = 0;
+
+    QBENCHMARK {
+        field->setValue(++n);
+    }
+    QCOMPARE(field->getDouble(), (double)(float)n);
+}
+
+void tst_UAVObjectBenchmark::propertyGetter()
+{
+    float sum = 0.0f;
+
+    QBENCHMARK {
+        sum += m_attitude->getRoll();
+    }
+    Q_UNUSED(sum);
+}
+
+void tst_UAVObjectBenchmark::propertySetter()
+{
+    int n = 0;
+
+    QBENCHMARK {
+        m_attitude->setRoll(++n);
+    }
+    QCOMPARE(m_attitude->getRoll(), (float)n);
+}
+
+void tst_UAVObjectBenchmark::packUnpack()
+{
+    QByteArray buffer(m_attitude->getNumBytes(), 0);
+
+    QBENCHMARK {
+        m_attitude->pack((quint8 *)buffer.data());
+        m_attitude->unpack((const quint8 *)buffer.constData());
+    }
+}
+
+void tst_UAVObjectBenchmark::waypointInstances()
+{
+    QList<UAVObject *> instances = m_objMngr->getObjectInstances(Waypoint::OBJID);
+    double sum = 0.0;
+
+    QCOMPARE(instances.count(), 100);
+    QBENCHMARK {
+        foreach(UAVObject * obj, instances) {
+            UAVObjectField *field = obj->getField("Position");
+            for (quint32 n = 0; n < field->getNumElements(); ++n) {
+                sum += field->getDouble(n);
+            }
+        }
+    }
+    Q_UNUSED(sum);
+}
+
+void tst_UAVObjectBenchmark::reservedInstances()
+{
+    UAVObjectManager objMngr;
+    Waypoint *waypoint = new Waypoint();
+
+    objMngr.registerObject(waypoint);
+    // registering the last instance reserves all the ones before
+    QBENCHMARK_ONCE {
+        objMngr.registerObject(waypoint->clone(999));
+    }
+    QCOMPARE(objMngr.getNumInstances(Waypoint::OBJID), 1000);
+
+    Waypoint::DataFields data;
+    QVERIFY(objMngr.getInstanceData(Waypoint::OBJID, 500, (quint8 *)&data));
+    data.Position[0] = 10.0f;
+    QVERIFY(objMngr.setInstanceData(Waypoint::OBJID, 500, (const quint8 *)&data));
+
+    Waypoint *instance = Waypoint::GetInstance(&objMngr, 500);
+    QVERIFY(instance);
+    QCOMPARE(instance->getInstID(), (quint32)500);
+    QCOMPARE(instance->getData().Position[0], 10.0f);
+    QCOMPARE(objMngr.getObjectInstances(Waypoint::OBJID).count(), 1000);
+}
+
+void tst_UAVObjectBenchmark::getDoubleContended()
+{
+    UAVObjectField *field = m_attitude->getField("Roll");
+    UnpackThread writer(m_attitude);
+    double sum = 0.0;
+
+    writer.start();
+    QBENCHMARK {
+        sum += field->getDouble();
+    }
+    writer.stop();
+    Q_UNUSED(sum);
+}
+
+void tst_UAVObjectBenchmark::getObjectById()
+{
+    UAVObject *obj = 0;
+    quint32 n = 0;
+
+    // the lookup UAVTalk does for every received frame
+    QBENCHMARK {
+        obj = m_objMngr->getObject(Waypoint::OBJID, ++n % 100);
+    }
+    QVERIFY(obj);
+}
+
+void tst_UAVObjectBenchmark::getObjectByName()
+{
+    const QString name("AttitudeState");
+    UAVObject *obj = 0;
+
+    QBENCHMARK {
+        obj = m_objMngr->getObject(name);
+    }
+    QCOMPARE(obj, (UAVObject *)m_attitude);
+}
+
+QTEST_MAIN(tst_UAVObjectBenchmark)
+
+#include "tst_uavobjectbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
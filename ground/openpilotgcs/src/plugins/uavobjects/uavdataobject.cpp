@@ -42,7 +42,7 @@ UAVDataObject::UAVDataObject(quint32 objID, bool isSingleInst, bool isSettings,
  */
 void UAVDataObject::initialize(quint32 instID, UAVMetaObject *metaObject)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     this->m_metaObject = metaObject;
     UAVObject::initialize(instID);
@@ -53,7 +53,7 @@ void UAVDataObject::initialize(quint32 instID, UAVMetaObject *metaObject)
  */
 void UAVDataObject::initialize(UAVMetaObject *metaObject)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     this->m_metaObject = metaObject;
 }
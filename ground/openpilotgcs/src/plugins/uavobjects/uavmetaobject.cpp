@@ -91,9 +91,9 @@ UAVObject::Metadata UAVMetaObject::getDefaultMetadata()
  */
 void UAVMetaObject::setData(const Metadata & mdata)
 {
-    QMutexLocker locker(mutex);
-
+    mutex.lock();
     parentMetadata = mdata;
+    mutex.unlock();
     emit objectUpdatedAuto(this); // trigger object updated event
     emit objectUpdated(this);
 }
@@ -103,7 +103,7 @@ void UAVMetaObject::setData(const Metadata & mdata)
  */
 UAVObject::Metadata UAVMetaObject::getData()
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     return parentMetadata;
 }
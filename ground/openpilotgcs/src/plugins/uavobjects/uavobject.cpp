@@ -54,7 +54,7 @@ using namespace Utils;
  * @param isSingleInst True if this object can only have a single instance
  * @param name Object name
  */
-UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
+UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name) : mutex(QMutex::Recursive)
 {
     this->objID        = objID;
     this->instID       = 0;
@@ -62,8 +62,8 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->name         = name;
     this->data         = 0;
     this->numBytes     = 0;
-    this->mutex        = new QMutex(QMutex::Recursive);
     m_isKnown = false;
+    m_timestamp = 0;
 }
 
 /**
@@ -71,7 +71,7 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
  */
 void UAVObject::initialize(quint32 instID)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     this->instID = instID;
 }
@@ -84,7 +84,7 @@ void UAVObject::initialize(quint32 instID)
  */
 void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     this->numBytes = numBytes;
     this->data     = data;
@@ -226,7 +226,7 @@ void UAVObject::updatedAll()
  */
 void UAVObject::lock()
 {
-    mutex->lock();
+    mutex.lock();
 }
 
 /**
@@ -234,7 +234,7 @@ void UAVObject::lock()
  */
 void UAVObject::lock(int timeoutMs)
 {
-    mutex->tryLock(timeoutMs);
+    mutex.tryLock(timeoutMs);
 }
 
 /**
@@ -242,7 +242,7 @@ void UAVObject::lock(int timeoutMs)
  */
 void UAVObject::unlock()
 {
-    mutex->unlock();
+    mutex.unlock();
 }
 
 /**
@@ -250,7 +250,7 @@ void UAVObject::unlock()
  */
 QMutex *UAVObject::getMutex()
 {
-    return mutex;
+    return &mutex;
 }
 
 /**
@@ -258,7 +258,7 @@ QMutex *UAVObject::getMutex()
  */
 qint32 UAVObject::getNumFields()
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     return fields.count();
 }
@@ -268,7 +268,7 @@ qint32 UAVObject::getNumFields()
  */
 QList<UAVObjectField *> UAVObject::getFields()
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     return fields;
 }
@@ -279,7 +279,7 @@ QList<UAVObjectField *> UAVObject::getFields()
  */
 UAVObjectField *UAVObject::getField(const QString & name)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     // Look for field
     for (int n = 0; n < fields.length(); ++n) {
@@ -299,7 +299,7 @@ UAVObjectField *UAVObject::getField(const QString & name)
  */
 qint32 UAVObject::pack(quint8 *dataOut)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
     qint32 offset = 0;
 
     for (int n = 0; n < fields.length(); ++n) {
@@ -315,26 +315,41 @@ qint32 UAVObject::pack(quint8 *dataOut)
  */
 qint32 UAVObject::unpack(const quint8 *dataIn)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
     qint32 offset = 0;
 
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->unpack(&dataIn[offset]);
         offset += fields[n]->getNumBytes();
     }
+    // the slots run without the lock held
+    locker.unlock();
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
 
     return numBytes;
 }
 
+/**
+ * Copy the raw object data buffer in a single operation under the object lock.
+ * The snapshot can then be read with the snapshot accessors of UAVObjectField
+ * without taking the lock again for every field.
+ * \param[out] dataOut Buffer of at least getNumBytes() bytes
+ */
+void UAVObject::getDataSnapshot(quint8 *dataOut)
+{
+    QMutexLocker locker(&mutex);
+
+    memcpy(dataOut, data, numBytes);
+}
+
 /**
  * Update a CRC with the object data
  * @returns The updated CRC
  */
 quint8 UAVObject::updateCRC(quint8 crc)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     // crc = Crc::updateCRC(crc, (quint8 *) &objID, sizeof(objID));
     // crc = Crc::updateCRC(crc, (quint8 *) &instID, sizeof(instID));
@@ -352,7 +367,7 @@ quint8 UAVObject::updateCRC(quint8 crc)
  */
 bool UAVObject::save()
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     // Open file
     QFile file(name + ".uavobj");
@@ -379,7 +394,7 @@ bool UAVObject::save()
  */
 bool UAVObject::save(QFile & file)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
     quint8 buffer[numBytes];
     quint8 tmpId[4];
 
@@ -416,7 +431,7 @@ bool UAVObject::save(QFile & file)
  */
 bool UAVObject::load()
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     // Open file
     QFile file(name + ".uavobj");
@@ -443,7 +458,7 @@ bool UAVObject::load()
  */
 bool UAVObject::load(QFile & file)
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
     quint8 buffer[numBytes];
     quint8 tmpId[4];
 
@@ -606,7 +621,7 @@ void UAVObject::emitNewInstance(UAVObject *obj)
 
 bool UAVObject::isKnown() const
 {
-    QMutexLocker locker(mutex);
+    QMutexLocker locker(&mutex);
 
     return m_isKnown;
 }
@@ -623,6 +638,25 @@ void UAVObject::setIsKnown(bool isKnown)
     }
 }
 
+/**
+ * Time at which the last update of this object was received from the telemetry stream,
+ * in ms since the epoch. This is the time the packet was sent (if the packet carried a timestamp)
+ * or recorded (during a log replay), 0 if the object was never received.
+ */
+qint64 UAVObject::getTimestamp() const
+{
+    QMutexLocker locker(&mutex);
+
+    return m_timestamp;
+}
+
+void UAVObject::setTimestamp(qint64 timestamp)
+{
+    QMutexLocker locker(&mutex);
+
+    m_timestamp = timestamp;
+}
+
 bool UAVObject::isSettingsObject()
 {
     return false;
@@ -114,6 +114,7 @@ public:
     quint32 getNumBytes();
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
+    void getDataSnapshot(quint8 *dataOut);
     quint8 updateCRC(quint8 crc = 0);
     bool save();
     bool save(QFile & file);
@@ -145,6 +146,9 @@ public:
     bool isKnown() const;
     void setIsKnown(bool isKnown);
 
+    qint64 getTimestamp() const;
+    void setTimestamp(qint64 timestamp);
+
     virtual bool isSettingsObject();
     virtual bool isDataObject();
     virtual bool isMetaDataObject();
@@ -191,7 +195,9 @@ protected:
     QString description;
     QString category;
     quint32 numBytes;
-    QMutex *mutex;
+    // held inline rather than allocated, recursive because the field accessors
+    // and the signals emitted under it call back into the object
+    mutable QMutex mutex;
     quint8 *data;
     QList<UAVObjectField *> fields;
 
@@ -201,6 +207,7 @@ protected:
 
 private:
     bool m_isKnown;
+    qint64 m_timestamp;
 
 private slots:
     void fieldUpdated(UAVObjectField *field);
@@ -29,6 +29,8 @@
 #include <QtEndian>
 #include <QDebug>
 #include <QtWidgets>
+#include <QHash>
+#include <QMutex>
 
 UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString &limits)
 {
@@ -47,54 +49,93 @@ UAVObjectField::UAVObjectField(const QString & name, const QString & description
     constructorInitialize(name, description, units, type, elementNames, options, limits);
 }
 
+UAVObjectField::UAVObjectField(const Info & info, const char *context)
+{
+    // the instance only owns its position in the object data
+    desc   = descriptor(info, context);
+    offset = 0;
+    data   = NULL;
+    obj    = NULL;
+}
+
+/**
+ * Descriptor built from an Info the first time it is seen, it is kept as long as the
+ * Info tables, which are static data of the object types.
+ */
+QSharedPointer<UAVObjectField::Descriptor> UAVObjectField::descriptor(const Info & info, const char *context)
+{
+    static QMutex mutex;
+    static QHash<const Info *, QSharedPointer<Descriptor> > descriptors;
+
+    QMutexLocker locker(&mutex);
+    QSharedPointer<Descriptor> shared = descriptors.value(&info);
+
+    if (!shared) {
+        QStringList elementNames;
+        QStringList options;
+        for (quint32 n = 0; n < info.numElements; ++n) {
+            elementNames.append(QString::fromUtf8(info.elementNames[n]));
+        }
+        for (quint32 n = 0; n < info.numOptions; ++n) {
+            options.append(QString::fromUtf8(info.options[n]));
+        }
+        UAVObjectField field(QString::fromUtf8(info.name), QCoreApplication::translate(context, info.description),
+                             QString::fromUtf8(info.units), info.type, elementNames, options, QString::fromUtf8(info.limits));
+        shared = field.desc;
+        descriptors.insert(&info, shared);
+    }
+    return shared;
+}
+
 void UAVObjectField::constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
     // Copy params
-    this->name         = name;
-    this->description  = description;
-    this->units        = units;
-    this->type         = type;
-    this->options      = options;
-    this->numElements  = elementNames.length();
-    this->offset       = 0;
-    this->data         = NULL;
-    this->obj = NULL;
-    this->elementNames = elementNames;
+    desc = QSharedPointer<Descriptor>(new Descriptor);
+    desc->name         = name;
+    desc->description  = description;
+    desc->units        = units;
+    desc->type         = type;
+    desc->options      = options;
+    desc->numElements  = elementNames.length();
+    desc->elementNames = elementNames;
+    this->offset = 0;
+    this->data   = NULL;
+    this->obj    = NULL;
     // Set field size
     switch (type) {
     case INT8:
-        numBytesPerElement = sizeof(qint8);
+        desc->numBytesPerElement = sizeof(qint8);
         break;
     case INT16:
-        numBytesPerElement = sizeof(qint16);
+        desc->numBytesPerElement = sizeof(qint16);
         break;
     case INT32:
-        numBytesPerElement = sizeof(qint32);
+        desc->numBytesPerElement = sizeof(qint32);
         break;
     case UINT8:
-        numBytesPerElement = sizeof(quint8);
+        desc->numBytesPerElement = sizeof(quint8);
         break;
     case UINT16:
-        numBytesPerElement = sizeof(quint16);
+        desc->numBytesPerElement = sizeof(quint16);
         break;
     case UINT32:
-        numBytesPerElement = sizeof(quint32);
+        desc->numBytesPerElement = sizeof(quint32);
         break;
     case FLOAT32:
-        numBytesPerElement = sizeof(quint32);
+        desc->numBytesPerElement = sizeof(quint32);
         break;
     case ENUM:
-        numBytesPerElement = sizeof(quint8);
+        desc->numBytesPerElement = sizeof(quint8);
         break;
     case BITFIELD:
-        numBytesPerElement = sizeof(quint8);
-        this->options = QStringList() << tr("0") << tr("1");
+        desc->numBytesPerElement = sizeof(quint8);
+        desc->options = QStringList() << tr("0") << tr("1");
         break;
     case STRING:
-        numBytesPerElement = sizeof(quint8);
+        desc->numBytesPerElement = sizeof(quint8);
         break;
     default:
-        numBytesPerElement = 0;
+        desc->numBytesPerElement = 0;
     }
     limitsInitialize(limits);
 }
@@ -134,7 +175,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
             QStringList valuesPerElement = _str.split(":");
             LimitStruct lstruc;
             bool startFlag    = valuesPerElement.at(0).startsWith("%");
-            bool maxIndexFlag = (int)(index) < (int)numElements;
+            bool maxIndexFlag = (int)(index) < (int)desc->numElements;
             bool elemNumberSizeFlag = valuesPerElement.at(0).size() == 3;
             bool aux;
             valuesPerElement.at(0).mid(1, 4).toInt(&aux, 16);
@@ -156,13 +197,13 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                 } else if (valuesPerElement.at(0).right(2) == "SM") {
                     lstruc.type = SMALLER;
                 } else {
-                    qDebug() << "limits parsing failed (invalid property) on UAVObjectField" << name;
+                    qDebug() << "limits parsing failed (invalid property) on UAVObjectField" << desc->name;
                 }
                 valuesPerElement.removeAt(0);
                 foreach(QString _value, valuesPerElement) {
                     QString value = _value.trimmed();
 
-                    switch (type) {
+                    switch (desc->type) {
                     case UINT8:
                     case UINT16:
                     case UINT32:
@@ -190,15 +231,15 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                 limitList.append(lstruc);
             } else {
                 if (!valuesPerElement.at(0).isEmpty() && !startFlag) {
-                    qDebug() << "limits parsing failed (property doesn't start with %) on UAVObjectField" << name;
+                    qDebug() << "limits parsing failed (property doesn't start with %) on UAVObjectField" << desc->name;
                 } else if (!maxIndexFlag) {
-                    qDebug() << "limits parsing failed (index>numelements) on UAVObjectField" << name << "index" << index << "numElements" << numElements;
+                    qDebug() << "limits parsing failed (index>numelements) on UAVObjectField" << desc->name << "index" << index << "numElements" << desc->numElements;
                 } else if (!elemNumberSizeFlag || !b4) {
-                    qDebug() << "limits parsing failed limit not starting with %XX or %YYYYXX where XX is the limit type and YYYY is the board type on UAVObjectField" << name;
+                    qDebug() << "limits parsing failed limit not starting with %XX or %YYYYXX where XX is the limit type and YYYY is the board type on UAVObjectField" << desc->name;
                 }
             }
         }
-        elementLimits.insert(index, limitList);
+        desc->elementLimits.insert(index, limitList);
         ++index;
     }
     // foreach(QList<LimitStruct> limitList, elementLimits) {
@@ -212,17 +253,17 @@ void UAVObjectField::limitsInitialize(const QString &limits)
 }
 bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!desc->elementLimits.keys().contains(index)) {
         return true;
     }
 
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, desc->elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
         switch (struc.type) {
         case EQUAL:
-            switch (type) {
+            switch (desc->type) {
             case INT8:
             case INT16:
             case INT32:
@@ -270,7 +311,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
             }
             break;
         case NOT_EQUAL:
-            switch (type) {
+            switch (desc->type) {
             case INT8:
             case INT16:
             case INT32:
@@ -319,13 +360,13 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
             break;
         case BETWEEN:
             if (struc.values.length() < 2) {
-                qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << name;
+                qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << desc->name;
                 return true;
             }
             if (struc.values.length() > 2) {
-                qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field" << name;
+                qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field" << desc->name;
             }
-            switch (type) {
+            switch (desc->type) {
             case INT8:
             case INT16:
             case INT32:
@@ -346,7 +387,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()) && options.indexOf(var.toString()) <= options.indexOf(struc.values.at(1).toString()))) {
+                if (!(desc->options.indexOf(var.toString()) >= desc->options.indexOf(struc.values.at(0).toString()) && desc->options.indexOf(var.toString()) <= desc->options.indexOf(struc.values.at(1).toString()))) {
                     return false;
                 }
                 return true;
@@ -369,13 +410,13 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
             break;
         case BIGGER:
             if (struc.values.length() < 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with less than 1 value, aborting; field:" << name;
+                qDebug() << __FUNCTION__ << "BIGGER limit with less than 1 value, aborting; field:" << desc->name;
                 return true;
             }
             if (struc.values.length() > 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with more than 1 value, using first; field" << name;
+                qDebug() << __FUNCTION__ << "BIGGER limit with more than 1 value, using first; field" << desc->name;
             }
-            switch (type) {
+            switch (desc->type) {
             case INT8:
             case INT16:
             case INT32:
@@ -396,7 +437,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()))) {
+                if (!(desc->options.indexOf(var.toString()) >= desc->options.indexOf(struc.values.at(0).toString()))) {
                     return false;
                 }
                 return true;
@@ -418,7 +459,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
             }
             break;
         case SMALLER:
-            switch (type) {
+            switch (desc->type) {
             case INT8:
             case INT16:
             case INT32:
@@ -439,7 +480,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) <= options.indexOf(struc.values.at(0).toString()))) {
+                if (!(desc->options.indexOf(var.toString()) <= desc->options.indexOf(struc.values.at(0).toString()))) {
                     return false;
                 }
                 return true;
@@ -470,8 +511,8 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 {
     QString limitString;
 
-    if (elementLimits.keys().contains(index)) {
-        foreach(LimitStruct struc, elementLimits.value(index)) {
+    if (desc->elementLimits.keys().contains(index)) {
+        foreach(LimitStruct struc, desc->elementLimits.value(index)) {
             if ((struc.board != board) && board != 0 && struc.board != 0) {
                 continue;
             }
@@ -520,10 +561,10 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!desc->elementLimits.keys().contains(index)) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, desc->elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
@@ -547,10 +588,10 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!desc->elementLimits.keys().contains(index)) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, desc->elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             return QVariant();
         }
@@ -582,12 +623,12 @@ void UAVObjectField::initialize(quint8 *data, quint32 dataOffset, UAVObject *obj
 
 UAVObjectField::FieldType UAVObjectField::getType()
 {
-    return type;
+    return desc->type;
 }
 
 QString UAVObjectField::getTypeAsString()
 {
-    switch (type) {
+    switch (desc->type) {
     case UAVObjectField::INT8:
         return "int8";
 
@@ -625,7 +666,7 @@ QString UAVObjectField::getTypeAsString()
 
 QStringList UAVObjectField::getElementNames()
 {
-    return elementNames;
+    return desc->elementNames;
 }
 
 UAVObject *UAVObjectField::getObject()
@@ -637,39 +678,39 @@ void UAVObjectField::clear()
 {
     QMutexLocker locker(obj->getMutex());
 
-    switch (type) {
+    switch (desc->type) {
     case BITFIELD:
-        memset(&data[offset], 0, numBytesPerElement * ((quint32)(1 + (numElements - 1) / 8)));
+        memset(&data[offset], 0, desc->numBytesPerElement * ((quint32)(1 + (desc->numElements - 1) / 8)));
         break;
     default:
-        memset(&data[offset], 0, numBytesPerElement * numElements);
+        memset(&data[offset], 0, desc->numBytesPerElement * desc->numElements);
         break;
     }
 }
 
 QString UAVObjectField::getName()
 {
-    return name;
+    return desc->name;
 }
 
 QString UAVObjectField::getDescription()
 {
-    return description;
+    return desc->description;
 }
 
 QString UAVObjectField::getUnits()
 {
-    return units;
+    return desc->units;
 }
 
 QStringList UAVObjectField::getOptions()
 {
-    return options;
+    return desc->options;
 }
 
 quint32 UAVObjectField::getNumElements()
 {
-    return numElements;
+    return desc->numElements;
 }
 
 quint32 UAVObjectField::getDataOffset()
@@ -679,13 +720,13 @@ quint32 UAVObjectField::getDataOffset()
 
 quint32 UAVObjectField::getNumBytes()
 {
-    switch (type) {
+    switch (desc->type) {
     case BITFIELD:
-        return numBytesPerElement * ((quint32)(1 + (numElements - 1) / 8));
+        return desc->numBytesPerElement * ((quint32)(1 + (desc->numElements - 1) / 8));
 
         break;
     default:
-        return numBytesPerElement * numElements;
+        return desc->numBytesPerElement * desc->numElements;
 
         break;
     }
@@ -695,11 +736,13 @@ QString UAVObjectField::toString()
 {
     QString sout;
 
-    sout.append(QString("%1: [ ").arg(name));
-    for (unsigned int n = 0; n < numElements; ++n) {
-        sout.append(QString("%1 ").arg(getDouble(n)));
+    sout.append(QString("%1: [ ").arg(desc->name));
+    QMutexLocker locker(obj->getMutex());
+    for (unsigned int n = 0; n < desc->numElements; ++n) {
+        sout.append(QString("%1 ").arg(readDouble(data, n)));
     }
-    sout.append(QString("] %1\n").arg(units));
+    locker.unlock();
+    sout.append(QString("] %1\n").arg(desc->units));
     return sout;
 }
 
@@ -711,7 +754,7 @@ void UAVObjectField::toXML(QXmlStreamWriter *xmlWriter)
     if (!getUnits().isEmpty()) {
         xmlWriter->writeAttribute("unit", getUnits());
     }
-    for (unsigned int n = 0; n < numElements; ++n) {
+    for (unsigned int n = 0; n < desc->numElements; ++n) {
         xmlWriter->writeStartElement("value");
         if (getElementNames().size() > 1) {
             xmlWriter->writeAttribute("name", getElementNames().at(n));
@@ -744,7 +787,7 @@ void UAVObjectField::toJson(QJsonObject &jsonObject)
     jsonObject["type"] = getTypeAsString();
     jsonObject["unit"] = getUnits();
     QJsonArray values;
-    for (unsigned int n = 0; n < numElements; ++n) {
+    for (unsigned int n = 0; n < desc->numElements; ++n) {
         QJsonObject value;
         value["name"]  = getElementNames().at(n);
         value["value"] = QJsonValue::fromVariant(getValue(n));
@@ -768,65 +811,63 @@ void UAVObjectField::fromJson(const QJsonObject &jsonObject)
 
 qint32 UAVObjectField::pack(quint8 *dataOut)
 {
-    QMutexLocker locker(obj->getMutex());
-
     // Pack each element in output buffer
-    switch (type) {
+    switch (desc->type) {
     case INT8:
-        memcpy(dataOut, &data[offset], numElements);
+        memcpy(dataOut, &data[offset], desc->numElements);
         break;
     case INT16:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             qint16 value;
-            memcpy(&value, &data[offset + numBytesPerElement * index], numBytesPerElement);
-            qToLittleEndian<qint16>(value, &dataOut[numBytesPerElement * index]);
+            memcpy(&value, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
+            qToLittleEndian<qint16>(value, &dataOut[desc->numBytesPerElement * index]);
         }
         break;
     case INT32:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             qint32 value;
-            memcpy(&value, &data[offset + numBytesPerElement * index], numBytesPerElement);
-            qToLittleEndian<qint32>(value, &dataOut[numBytesPerElement * index]);
+            memcpy(&value, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
+            qToLittleEndian<qint32>(value, &dataOut[desc->numBytesPerElement * index]);
         }
         break;
     case UINT8:
-        for (quint32 index = 0; index < numElements; ++index) {
-            dataOut[numBytesPerElement * index] = data[offset + numBytesPerElement * index];
+        for (quint32 index = 0; index < desc->numElements; ++index) {
+            dataOut[desc->numBytesPerElement * index] = data[offset + desc->numBytesPerElement * index];
         }
         break;
     case UINT16:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             quint16 value;
-            memcpy(&value, &data[offset + numBytesPerElement * index], numBytesPerElement);
-            qToLittleEndian<quint16>(value, &dataOut[numBytesPerElement * index]);
+            memcpy(&value, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
+            qToLittleEndian<quint16>(value, &dataOut[desc->numBytesPerElement * index]);
         }
         break;
     case UINT32:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             quint32 value;
-            memcpy(&value, &data[offset + numBytesPerElement * index], numBytesPerElement);
-            qToLittleEndian<quint32>(value, &dataOut[numBytesPerElement * index]);
+            memcpy(&value, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
+            qToLittleEndian<quint32>(value, &dataOut[desc->numBytesPerElement * index]);
         }
         break;
     case FLOAT32:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             quint32 value;
-            memcpy(&value, &data[offset + numBytesPerElement * index], numBytesPerElement);
-            qToLittleEndian<quint32>(value, &dataOut[numBytesPerElement * index]);
+            memcpy(&value, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
+            qToLittleEndian<quint32>(value, &dataOut[desc->numBytesPerElement * index]);
         }
         break;
     case ENUM:
-        for (quint32 index = 0; index < numElements; ++index) {
-            dataOut[numBytesPerElement * index] = data[offset + numBytesPerElement * index];
+        for (quint32 index = 0; index < desc->numElements; ++index) {
+            dataOut[desc->numBytesPerElement * index] = data[offset + desc->numBytesPerElement * index];
         }
         break;
     case BITFIELD:
-        for (quint32 index = 0; index < (quint32)(1 + (numElements - 1) / 8); ++index) {
-            dataOut[numBytesPerElement * index] = data[offset + numBytesPerElement * index];
+        for (quint32 index = 0; index < (quint32)(1 + (desc->numElements - 1) / 8); ++index) {
+            dataOut[desc->numBytesPerElement * index] = data[offset + desc->numBytesPerElement * index];
         }
         break;
     case STRING:
-        memcpy(dataOut, &data[offset], numElements);
+        memcpy(dataOut, &data[offset], desc->numElements);
         break;
     }
     // Done
@@ -835,65 +876,63 @@ qint32 UAVObjectField::pack(quint8 *dataOut)
 
 qint32 UAVObjectField::unpack(const quint8 *dataIn)
 {
-    QMutexLocker locker(obj->getMutex());
-
     // Unpack each element from input buffer
-    switch (type) {
+    switch (desc->type) {
     case INT8:
-        memcpy(&data[offset], dataIn, numElements);
+        memcpy(&data[offset], dataIn, desc->numElements);
         break;
     case INT16:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             qint16 value;
-            value = qFromLittleEndian<qint16>(&dataIn[numBytesPerElement * index]);
-            memcpy(&data[offset + numBytesPerElement * index], &value, numBytesPerElement);
+            value = qFromLittleEndian<qint16>(&dataIn[desc->numBytesPerElement * index]);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &value, desc->numBytesPerElement);
         }
         break;
     case INT32:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             qint32 value;
-            value = qFromLittleEndian<qint32>(&dataIn[numBytesPerElement * index]);
-            memcpy(&data[offset + numBytesPerElement * index], &value, numBytesPerElement);
+            value = qFromLittleEndian<qint32>(&dataIn[desc->numBytesPerElement * index]);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &value, desc->numBytesPerElement);
         }
         break;
     case UINT8:
-        for (quint32 index = 0; index < numElements; ++index) {
-            data[offset + numBytesPerElement * index] = dataIn[numBytesPerElement * index];
+        for (quint32 index = 0; index < desc->numElements; ++index) {
+            data[offset + desc->numBytesPerElement * index] = dataIn[desc->numBytesPerElement * index];
         }
         break;
     case UINT16:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             quint16 value;
-            value = qFromLittleEndian<quint16>(&dataIn[numBytesPerElement * index]);
-            memcpy(&data[offset + numBytesPerElement * index], &value, numBytesPerElement);
+            value = qFromLittleEndian<quint16>(&dataIn[desc->numBytesPerElement * index]);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &value, desc->numBytesPerElement);
         }
         break;
     case UINT32:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             quint32 value;
-            value = qFromLittleEndian<quint32>(&dataIn[numBytesPerElement * index]);
-            memcpy(&data[offset + numBytesPerElement * index], &value, numBytesPerElement);
+            value = qFromLittleEndian<quint32>(&dataIn[desc->numBytesPerElement * index]);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &value, desc->numBytesPerElement);
         }
         break;
     case FLOAT32:
-        for (quint32 index = 0; index < numElements; ++index) {
+        for (quint32 index = 0; index < desc->numElements; ++index) {
             quint32 value;
-            value = qFromLittleEndian<quint32>(&dataIn[numBytesPerElement * index]);
-            memcpy(&data[offset + numBytesPerElement * index], &value, numBytesPerElement);
+            value = qFromLittleEndian<quint32>(&dataIn[desc->numBytesPerElement * index]);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &value, desc->numBytesPerElement);
         }
         break;
     case ENUM:
-        for (quint32 index = 0; index < numElements; ++index) {
-            data[offset + numBytesPerElement * index] = dataIn[numBytesPerElement * index];
+        for (quint32 index = 0; index < desc->numElements; ++index) {
+            data[offset + desc->numBytesPerElement * index] = dataIn[desc->numBytesPerElement * index];
         }
         break;
     case BITFIELD:
-        for (quint32 index = 0; index < (quint32)(1 + (numElements - 1) / 8); ++index) {
-            data[offset + numBytesPerElement * index] = dataIn[numBytesPerElement * index];
+        for (quint32 index = 0; index < (quint32)(1 + (desc->numElements - 1) / 8); ++index) {
+            data[offset + desc->numBytesPerElement * index] = dataIn[desc->numBytesPerElement * index];
         }
         break;
     case STRING:
-        memcpy(&data[offset], dataIn, numElements);
+        memcpy(&data[offset], dataIn, desc->numElements);
         break;
     }
     // Done
@@ -902,7 +941,7 @@ qint32 UAVObjectField::unpack(const quint8 *dataIn)
 
 bool UAVObjectField::isNumeric()
 {
-    switch (type) {
+    switch (desc->type) {
     case INT8:
     case INT16:
     case INT32:
@@ -921,7 +960,7 @@ bool UAVObjectField::isNumeric()
 
 bool UAVObjectField::isInteger()
 {
-    switch (type) {
+    switch (desc->type) {
     case INT8:
     case INT16:
     case INT32:
@@ -938,7 +977,7 @@ bool UAVObjectField::isInteger()
 
 bool UAVObjectField::isText()
 {
-    switch (type) {
+    switch (desc->type) {
     case ENUM:
     case STRING:
         return true;
@@ -954,15 +993,15 @@ QVariant UAVObjectField::getValue(quint32 index)
     QMutexLocker locker(obj->getMutex());
 
     // Check that index is not out of bounds
-    if (index >= numElements) {
+    if (index >= desc->numElements) {
         return QVariant();
     }
     // Get value
-    switch (type) {
+    switch (desc->type) {
     case INT8:
     {
         qint8 tmpint8;
-        memcpy(&tmpint8, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpint8, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpint8);
 
         break;
@@ -970,7 +1009,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     case INT16:
     {
         qint16 tmpint16;
-        memcpy(&tmpint16, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpint16, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpint16);
 
         break;
@@ -978,7 +1017,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     case INT32:
     {
         qint32 tmpint32;
-        memcpy(&tmpint32, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpint32, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpint32);
 
         break;
@@ -986,7 +1025,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     case UINT8:
     {
         quint8 tmpuint8;
-        memcpy(&tmpuint8, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpuint8, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpuint8);
 
         break;
@@ -994,7 +1033,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     case UINT16:
     {
         quint16 tmpuint16;
-        memcpy(&tmpuint16, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpuint16, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpuint16);
 
         break;
@@ -1002,7 +1041,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     case UINT32:
     {
         quint32 tmpuint32;
-        memcpy(&tmpuint32, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpuint32, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpuint32);
 
         break;
@@ -1010,7 +1049,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     case FLOAT32:
     {
         float tmpfloat;
-        memcpy(&tmpfloat, &data[offset + numBytesPerElement * index], numBytesPerElement);
+        memcpy(&tmpfloat, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
         return QVariant(tmpfloat);
 
         break;
@@ -1018,19 +1057,19 @@ QVariant UAVObjectField::getValue(quint32 index)
     case ENUM:
     {
         quint8 tmpenum;
-        memcpy(&tmpenum, &data[offset + numBytesPerElement * index], numBytesPerElement);
-        if (tmpenum >= options.length()) {
-            qDebug() << "Invalid value for" << name;
+        memcpy(&tmpenum, &data[offset + desc->numBytesPerElement * index], desc->numBytesPerElement);
+        if (tmpenum >= desc->options.length()) {
+            qDebug() << "Invalid value for" << desc->name;
             tmpenum = 0;
         }
-        return QVariant(options[tmpenum]);
+        return QVariant(desc->options[tmpenum]);
 
         break;
     }
     case BITFIELD:
     {
         quint8 tmpbitfield;
-        memcpy(&tmpbitfield, &data[offset + numBytesPerElement * ((quint32)(index / 8))], numBytesPerElement);
+        memcpy(&tmpbitfield, &data[offset + desc->numBytesPerElement * ((quint32)(index / 8))], desc->numBytesPerElement);
         tmpbitfield = (tmpbitfield >> (index % 8)) & 1;
         return QVariant(tmpbitfield);
 
@@ -1038,7 +1077,7 @@ QVariant UAVObjectField::getValue(quint32 index)
     }
     case STRING:
     {
-        data[offset + numElements - 1] = '\0';
+        data[offset + desc->numElements - 1] = '\0';
         QString str((char *)&data[offset]);
         return QVariant(str);
 
@@ -1051,17 +1090,15 @@ QVariant UAVObjectField::getValue(quint32 index)
 
 bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
 {
-    QMutexLocker locker(obj->getMutex());
-
     // Check that index is not out of bounds
-    if (index >= numElements) {
+    if (index >= desc->numElements) {
         return false;
     }
     // Get metadata
     UAVObject::Metadata mdata = obj->getMetadata();
     // Update value if the access mode permits
     if (UAVObject::GetFlightAccess(mdata) == UAVObject::ACCESS_READWRITE) {
-        switch (type) {
+        switch (desc->type) {
         case INT8:
         case INT16:
         case INT32:
@@ -1076,13 +1113,13 @@ bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
             break;
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = desc->options.indexOf(value.toString());
             return (tmpenum < 0) ? false : true;
 
             break;
         }
         default:
-            qDebug() << "checkValue: other types" << type;
+            qDebug() << "checkValue: other types" << desc->type;
             Q_ASSERT(0); // To catch any programming errors where we tried to test invalid values
             break;
         }
@@ -1092,75 +1129,74 @@ bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
 
 void UAVObjectField::setValue(const QVariant & value, quint32 index)
 {
-    QMutexLocker locker(obj->getMutex());
-
     // Check that index is not out of bounds
-    if (index >= numElements) {
+    if (index >= desc->numElements) {
         return;
     }
-    // Get metadata
+    // Get metadata, it has its own lock
     UAVObject::Metadata mdata = obj->getMetadata();
     // Update value if the access mode permits
     if (UAVObject::GetGcsAccess(mdata) == UAVObject::ACCESS_READWRITE) {
-        switch (type) {
+        QMutexLocker locker(obj->getMutex());
+        switch (desc->type) {
         case INT8:
         {
             qint8 tmpint8 = value.toInt();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpint8, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpint8, desc->numBytesPerElement);
             break;
         }
         case INT16:
         {
             qint16 tmpint16 = value.toInt();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpint16, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpint16, desc->numBytesPerElement);
             break;
         }
         case INT32:
         {
             qint32 tmpint32 = value.toInt();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpint32, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpint32, desc->numBytesPerElement);
             break;
         }
         case UINT8:
         {
             quint8 tmpuint8 = value.toUInt();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpuint8, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpuint8, desc->numBytesPerElement);
             break;
         }
         case UINT16:
         {
             quint16 tmpuint16 = value.toUInt();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpuint16, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpuint16, desc->numBytesPerElement);
             break;
         }
         case UINT32:
         {
             quint32 tmpuint32 = value.toUInt();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpuint32, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpuint32, desc->numBytesPerElement);
             break;
         }
         case FLOAT32:
         {
             float tmpfloat = value.toFloat();
-            memcpy(&data[offset + numBytesPerElement * index], &tmpfloat, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpfloat, desc->numBytesPerElement);
             break;
         }
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = desc->options.indexOf(value.toString());
             // Default to 0 on invalid values.
             if (tmpenum < 0) {
                 tmpenum = 0;
             }
-            memcpy(&data[offset + numBytesPerElement * index], &tmpenum, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * index], &tmpenum, desc->numBytesPerElement);
             break;
         }
         case BITFIELD:
         {
             quint8 tmpbitfield;
-            memcpy(&tmpbitfield, &data[offset + numBytesPerElement * ((quint32)(index / 8))], numBytesPerElement);
+            memcpy(&tmpbitfield, &data[offset + desc->numBytesPerElement * ((quint32)(index / 8))], desc->numBytesPerElement);
             tmpbitfield = (tmpbitfield & ~(1 << (index % 8))) | ((value.toUInt() != 0 ? 1 : 0) << (index % 8));
-            memcpy(&data[offset + numBytesPerElement * ((quint32)(index / 8))], &tmpbitfield, numBytesPerElement);
+            memcpy(&data[offset + desc->numBytesPerElement * ((quint32)(index / 8))], &tmpbitfield, desc->numBytesPerElement);
             break;
         }
         case STRING:
@@ -1168,7 +1204,7 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
             QString str = value.toString();
             QByteArray barray = str.toLatin1();
             quint32 index;
-            for (index = 0; index < (quint32)barray.length() && index < (numElements - 1); ++index) {
+            for (index = 0; index < (quint32)barray.length() && index < (desc->numElements - 1); ++index) {
                 data[offset + index] = barray[index];
             }
             barray[index] = '\0';
@@ -1178,9 +1214,135 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
     }
 }
 
+/**
+ * Get an element as a double without going through a QVariant.
+ * Enum and string fields are converted from their text representation, as getValue().toDouble() does.
+ */
 double UAVObjectField::getDouble(quint32 index)
 {
-    return getValue(index).toDouble();
+    QMutexLocker locker(obj->getMutex());
+
+    return readDouble(data, index);
+}
+
+/**
+ * Same as getDouble() but reads from a buffer filled by UAVObject::getDataSnapshot(),
+ * no lock is taken.
+ */
+double UAVObjectField::getDouble(quint32 index, const quint8 *snapshot)
+{
+    return readDouble(snapshot, index);
+}
+
+/**
+ * Get an element as an integer without going through a QVariant.
+ * Enum fields return the index of the option, float fields are truncated.
+ */
+qint64 UAVObjectField::getInt(quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    return readInt(data, index);
+}
+
+/**
+ * Same as getInt() but reads from a buffer filled by UAVObject::getDataSnapshot(),
+ * no lock is taken.
+ */
+qint64 UAVObjectField::getInt(quint32 index, const quint8 *snapshot)
+{
+    return readInt(snapshot, index);
+}
+
+/**
+ * Helper for the typed accessors, decodes an element from an object data buffer.
+ * The caller is responsible for the locking.
+ */
+double UAVObjectField::readDouble(const quint8 *buffer, quint32 index)
+{
+    // Check that index is not out of bounds
+    if (index >= desc->numElements) {
+        return 0.0;
+    }
+    const quint8 *element = &buffer[offset + desc->numBytesPerElement * index];
+    switch (desc->type) {
+    case FLOAT32:
+    {
+        float tmpfloat;
+        memcpy(&tmpfloat, element, sizeof(tmpfloat));
+        return tmpfloat;
+    }
+    case ENUM:
+    {
+        quint8 tmpenum = *element;
+        if (tmpenum >= desc->options.length()) {
+            return 0.0;
+        }
+        return desc->options[tmpenum].toDouble();
+    }
+    case STRING:
+    {
+        QByteArray str((const char *)&buffer[offset], desc->numElements);
+        return QString(str.constData()).toDouble();
+    }
+    default:
+        return (double)readInt(buffer, index);
+    }
+}
+
+/**
+ * Helper for the typed accessors, decodes an element from an object data buffer.
+ * The caller is responsible for the locking.
+ */
+qint64 UAVObjectField::readInt(const quint8 *buffer, quint32 index)
+{
+    // Check that index is not out of bounds
+    if (index >= desc->numElements) {
+        return 0;
+    }
+    const quint8 *element = &buffer[offset + desc->numBytesPerElement * index];
+    switch (desc->type) {
+    case INT8:
+        return *(const qint8 *)element;
+
+    case INT16:
+    {
+        qint16 tmpint16;
+        memcpy(&tmpint16, element, sizeof(tmpint16));
+        return tmpint16;
+    }
+    case INT32:
+    {
+        qint32 tmpint32;
+        memcpy(&tmpint32, element, sizeof(tmpint32));
+        return tmpint32;
+    }
+    case UINT8:
+    case ENUM:
+        return *element;
+
+    case UINT16:
+    {
+        quint16 tmpuint16;
+        memcpy(&tmpuint16, element, sizeof(tmpuint16));
+        return tmpuint16;
+    }
+    case UINT32:
+    {
+        quint32 tmpuint32;
+        memcpy(&tmpuint32, element, sizeof(tmpuint32));
+        return tmpuint32;
+    }
+    case FLOAT32:
+        return (qint64)readDouble(buffer, index);
+
+    case BITFIELD:
+        return (buffer[offset + desc->numBytesPerElement * (index / 8)] >> (index % 8)) & 1;
+
+    case STRING:
+        return (qint64)readDouble(buffer, index);
+    }
+    return 0;
 }
 
 void UAVObjectField::setDouble(double value, quint32 index)
@@ -34,6 +34,7 @@
 #include <QVariant>
 #include <QList>
 #include <QMap>
+#include <QSharedPointer>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include <QJsonObject>
@@ -51,7 +52,21 @@ public:
         QList<QVariant> values;
         int board;
     } LimitStruct;
+    // static description of a field as emitted by the generator, shared by all the instances of an object type
+    typedef struct {
+        const char *name;
+        const char *description;
+        const char *units;
+        FieldType type;
+        quint32 numElements;
+        const char *const *elementNames;
+        quint32 numOptions;
+        const char *const *options;
+        const char *limits;
+    } Info;
 
+    // the descriptor is built once per Info and shared, description is translated in context
+    UAVObjectField(const Info & info, const char *context);
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
@@ -64,12 +79,16 @@ public:
     quint32 getNumElements();
     QStringList getElementNames();
     QStringList getOptions();
+    // the caller holds the object lock, as UAVObject::pack() and unpack() do
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
     QVariant getValue(quint32 index = 0);
     bool checkValue(const QVariant & data, quint32 index = 0);
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
+    double getDouble(quint32 index, const quint8 *snapshot);
+    qint64 getInt(quint32 index = 0);
+    qint64 getInt(quint32 index, const quint8 *snapshot);
     void setDouble(double value, quint32 index = 0);
     quint32 getDataOffset();
     quint32 getNumBytes();
@@ -92,21 +111,29 @@ signals:
     void fieldUpdated(UAVObjectField *field);
 
 protected:
-    QString name;
-    QString description;
-    QString units;
-    FieldType type;
-    QStringList elementNames;
-    QStringList options;
-    quint32 numElements;
-    quint32 numBytesPerElement;
+    // what does not change once the field is built, shared by the fields built from the same Info
+    typedef struct {
+        QString name;
+        QString description;
+        QString units;
+        FieldType type;
+        QStringList elementNames;
+        QStringList options;
+        quint32 numElements;
+        quint32 numBytesPerElement;
+        QMap<quint32, QList<LimitStruct> > elementLimits;
+    } Descriptor;
+    QSharedPointer<Descriptor> desc;
+    // per instance view of the object data
     quint32 offset;
     quint8 *data;
     UAVObject *obj;
-    QMap<quint32, QList<LimitStruct> > elementLimits;
     void clear();
+    double readDouble(const quint8 *buffer, quint32 index);
+    qint64 readInt(const quint8 *buffer, quint32 index);
     void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
     void limitsInitialize(const QString &limits);
+    static QSharedPointer<Descriptor> descriptor(const Info & info, const char *context);
 };
 
 #endif // UAVOBJECTFIELD_H
@@ -28,6 +28,8 @@
 #include "uavobjectmanager.h"
 
 #include <QtWidgetsDepends>
+#include <QTimer>
+#include <string.h>
 
 /**
  * Constructor
@@ -35,6 +37,10 @@
 UAVObjectManager::UAVObjectManager()
 {
     mutex = new QMutex(QMutex::Recursive);
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setInterval(FRAME_INTERVAL);
+    connect(frameTimer, SIGNAL(timeout()), this, SLOT(frameTick()));
 }
 
 UAVObjectManager::~UAVObjectManager()
@@ -53,54 +59,54 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     QMutexLocker locker(mutex);
 
     // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID()) {
-            // Check if this is a single instance object, if yes we can not add a new instance
-            if (obj->isSingleInstance()) {
-                return false;
-            }
-            // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
-            // There is a single metaobject for all object instances of this type, so no need to create a new one
-            // Get object type metaobject from existing instance
-            UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (refObj == NULL) {
-                return false;
-            }
-            UAVMetaObject *mobj = refObj->getMetaObject();
-            // If the instance ID is specified and not at the default value (0) then we need to make sure
-            // that there are no gaps in the instance list. If gaps are found then then additional instances
-            // will be created.
-            if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
-                        // Instance conflict, do not add
-                        return false;
-                    }
-                }
-                // Check if there are any gaps between the requested instance ID and the ones in the list,
-                // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
-                    UAVDataObject *cobj = obj->clone(instidx);
-                    cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    getObject(cobj->getObjID())->emitNewInstance(cobj);
-                    emit newInstance(cobj);
+    int objidx = findObjectIndex(NULL, obj->getObjID());
+
+    if (objidx >= 0) {
+        // Check if this is a single instance object, if yes we can not add a new instance
+        if (obj->isSingleInstance()) {
+            return false;
+        }
+        // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
+        // There is a single metaobject for all object instances of this type, so no need to create a new one
+        // Get object type metaobject from existing instance
+        UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+        if (refObj == NULL) {
+            return false;
+        }
+        UAVMetaObject *mobj = refObj->getMetaObject();
+        // If the instance ID is specified and not at the default value (0) then we need to make sure
+        // that there are no gaps in the instance list. If gaps are found then then additional instances
+        // will be created.
+        if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
+            // Instances are kept in the list at the index of their instance ID
+            if (obj->getInstID() < (quint32)objects[objidx].length()) {
+                if (objects[objidx][obj->getInstID()] != NULL) {
+                    // Instance conflict, do not add
+                    return false;
                 }
-                // Finally, initialize the actual object instance
+                // The instance was only reserved, obj becomes its object
                 obj->initialize(mobj);
-            } else if (obj->getInstID() == 0) {
-                // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
-            } else {
-                return false;
+                objects[objidx][obj->getInstID()] = obj;
+                objects[objidx][0]->emitNewInstance(obj);
+                emit newInstance(obj);
+                return true;
             }
-            // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            getObject(obj->getObjID())->emitNewInstance(obj);
-            emit newInstance(obj);
-            return true;
+            // Any gap between the requested instance ID and the ones in the list is
+            // filled with reserved instances, their objects are created on first use.
+            appendInstances(objidx, obj->getInstID());
+            // Finally, initialize the actual object instance
+            obj->initialize(mobj);
+        } else if (obj->getInstID() == 0) {
+            // Assign the next available ID and initialize the object instance
+            obj->initialize(objects[objidx].length(), mobj);
+        } else {
+            return false;
         }
+        // Add the actual object instance in the list
+        objects[objidx].append(obj);
+        objects[objidx][0]->emitNewInstance(obj);
+        emit newInstance(obj);
+        return true;
     }
     // If this point is reached then this is the first time this object type (ID) is added in the list
     // create a new list of the instances, add in the object collection and create the object's metaobject
@@ -122,9 +128,153 @@ void UAVObjectManager::addObject(UAVObject *obj)
     QList<UAVObject *> list;
     list.append(obj);
     objects.append(list);
+    // Index the new object type by ID and by name
+    objectIndexById.insert(obj->getObjID(), objects.length() - 1);
+    objectIndexByName.insert(obj->getName(), objects.length() - 1);
     emit newObject(obj);
 }
 
+/**
+ * Reserve instances up to numInstances, set to the default values. Only their
+ * data is stored until an object is asked for, see instance().
+ */
+void UAVObjectManager::appendInstances(int objidx, quint32 numInstances)
+{
+    UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+    const int size = refObj->getNumBytes();
+
+    if (numInstances <= (quint32)objects[objidx].length()) {
+        return;
+    }
+    UAVDataObject *defaultObj = refObj->dirtyClone();
+    QByteArray defaults(size, 0);
+    defaultObj->pack((quint8 *)defaults.data());
+    delete defaultObj;
+
+    QByteArray &data = instanceData[objidx];
+    data.resize(numInstances * size);
+    for (quint32 instId = objects[objidx].length(); instId < numInstances; ++instId) {
+        memcpy(data.data() + instId * size, defaults.constData(), size);
+        objects[objidx].append(NULL);
+    }
+}
+
+/**
+ * Get an instance, its object is created from the stored data if it was only reserved.
+ * The newInstance() signals are emitted then.
+ */
+UAVObject *UAVObjectManager::instance(int objidx, quint32 instId)
+{
+    UAVObject *obj = objects[objidx][instId];
+
+    if (obj == NULL) {
+        UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+        UAVDataObject *cobj   = refObj->clone(instId);
+        cobj->unpack((const quint8 *)instanceData[objidx].constData() + instId * cobj->getNumBytes());
+        objects[objidx][instId] = cobj;
+        objects[objidx][0]->emitNewInstance(cobj);
+        emit newInstance(cobj);
+        obj = cobj;
+    }
+    return obj;
+}
+
+/**
+ * Create the objects of all the reserved instances of an object type.
+ */
+void UAVObjectManager::createInstances(int objidx)
+{
+    if (!instanceData.contains(objidx)) {
+        return;
+    }
+    for (int instidx = 1; instidx < objects[objidx].length(); ++instidx) {
+        instance(objidx, instidx);
+    }
+    instanceData.remove(objidx);
+}
+
+/**
+ * Reserve the instances of a multi instance object up to numInstances. No object is
+ * created for the new instances until one is asked for, getInstanceData() and
+ * setInstanceData() access their data meanwhile.
+ * @returns false if the object is unknown or single instance
+ */
+bool UAVObjectManager::reserveInstances(quint32 objId, quint32 numInstances)
+{
+    QMutexLocker locker(mutex);
+
+    int objidx = findObjectIndex(NULL, objId);
+
+    if (objidx < 0 || numInstances > MAX_INSTANCES) {
+        return false;
+    }
+    UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+    if (refObj == NULL || refObj->isSingleInstance()) {
+        return false;
+    }
+    appendInstances(objidx, numInstances);
+    return true;
+}
+
+/**
+ * Get the packed data of an instance, without creating its object if it has none.
+ */
+bool UAVObjectManager::getInstanceData(quint32 objId, quint32 instId, quint8 *dataOut)
+{
+    QMutexLocker locker(mutex);
+
+    int objidx = findObjectIndex(NULL, objId);
+
+    if (objidx < 0 || instId >= (quint32)objects[objidx].length()) {
+        return false;
+    }
+    UAVObject *obj = objects[objidx][instId];
+    if (obj == NULL) {
+        const int size = objects[objidx][0]->getNumBytes();
+        memcpy(dataOut, instanceData[objidx].constData() + instId * size, size);
+    } else {
+        obj->pack(dataOut);
+    }
+    return true;
+}
+
+/**
+ * Set the packed data of an instance. An instance without object only has its data
+ * stored, nothing can be connected to it so no update is signalled. Otherwise the
+ * object is unpacked as usual.
+ */
+bool UAVObjectManager::setInstanceData(quint32 objId, quint32 instId, const quint8 *dataIn)
+{
+    QMutexLocker locker(mutex);
+
+    int objidx = findObjectIndex(NULL, objId);
+
+    if (objidx < 0 || instId >= (quint32)objects[objidx].length()) {
+        return false;
+    }
+    UAVObject *obj = objects[objidx][instId];
+    if (obj == NULL) {
+        const int size = objects[objidx][0]->getNumBytes();
+        memcpy(instanceData[objidx].data() + instId * size, dataIn, size);
+    } else {
+        obj->unpack(dataIn);
+    }
+    return true;
+}
+
+/**
+ * Helper function to find the position of an object type in the object list.
+ * The lookup is done by name if one is given, otherwise by object ID.
+ * @returns The index in the object list or -1 if the object type is not registered
+ */
+int UAVObjectManager::findObjectIndex(const QString *name, quint32 objId) const
+{
+    if (name != NULL) {
+        return objectIndexByName.value(*name, -1);
+    }
+    return objectIndexById.value(objId, -1);
+}
+
 /**
  * Get all objects. A two dimentional QList is returned. Objects are grouped by
  * instances of the same object type.
@@ -133,6 +283,9 @@ QList< QList<UAVObject *> > UAVObjectManager::getObjects()
 {
     QMutexLocker locker(mutex);
 
+    foreach(int objidx, instanceData.keys()) {
+        createInstances(objidx);
+    }
     return objects;
 }
 
@@ -145,6 +298,10 @@ QList< QList<UAVDataObject *> > UAVObjectManager::getDataObjects()
 
     QList< QList<UAVDataObject *> > dObjects;
 
+    foreach(int objidx, instanceData.keys()) {
+        createInstances(objidx);
+    }
+
     // Go through objects and copy to new list when types match
     for (int objidx = 0; objidx < objects.length(); ++objidx) {
         if (objects[objidx].length() > 0) {
@@ -227,19 +384,11 @@ UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
-                    }
-                }
-            }
-        }
+    // Look up the object type, instances are kept at the index of their instance ID
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0 && instId < (quint32)objects[objidx].length()) {
+        return instance(objidx, instId);
     }
     // qWarning("UAVObjectManager::getObject: Object not found.  Probably a bug or mismatched GCS/flight versions.");
     // If this point is reached then the requested object could not be found
@@ -269,14 +418,12 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, qui
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
-            }
-        }
+    // Look up the object type
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        createInstances(objidx);
+        return objects[objidx];
     }
     // If this point is reached then the requested object could not be found
     return QList<UAVObject *>();
@@ -356,6 +503,75 @@ void UAVObjectManager::fromJson(const QJsonObject &jsonObject, QList<UAVObject *
     }
 }
 
+/**
+ * Subscribe to the coalesced updates of an object. However many times the object is updated
+ * during a display frame, the slot is called once at the end of it, so a display repaints at
+ * most at the frame rate whatever the telemetry rate.
+ * \param[in] obj The object to follow
+ * \param[in] receiver The object owning the slot
+ * \param[in] slot A SLOT() taking a UAVObject pointer
+ */
+void UAVObjectManager::subscribeFrameUpdates(UAVObject *obj, const QObject *receiver, const char *slot)
+{
+    Q_ASSERT(obj);
+    UAVObjectFrameNotifier *notifier = frameNotifiers.value(obj);
+    if (!notifier) {
+        notifier = new UAVObjectFrameNotifier(obj, this);
+        frameNotifiers.insert(obj, notifier);
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(frameObjectUpdated(UAVObject *)));
+    }
+    connect(notifier, SIGNAL(frameUpdated(UAVObject *)), receiver, slot, Qt::UniqueConnection);
+}
+
+/**
+ * Stop the coalesced updates of an object, for all the slots of the receiver if slot is null.
+ */
+void UAVObjectManager::unsubscribeFrameUpdates(UAVObject *obj, const QObject *receiver, const char *slot)
+{
+    UAVObjectFrameNotifier *notifier = frameNotifiers.value(obj);
+
+    if (notifier) {
+        disconnect(notifier, SIGNAL(frameUpdated(UAVObject *)), receiver, slot);
+    }
+}
+
+/**
+ * Emit the property notifications of an object once per display frame instead of on every
+ * update. A QML scene exporting the object then evaluates the bindings of the changed
+ * fields at most once per frame, whatever the telemetry rate.
+ * \param[in] obj The object exported to QML
+ */
+void UAVObjectManager::subscribeFramePropertyNotifications(UAVObject *obj)
+{
+    disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), obj, SLOT(emitNotifications()));
+    subscribeFrameUpdates(obj, obj, SLOT(emitNotifications()));
+}
+
+void UAVObjectManager::frameObjectUpdated(UAVObject *obj)
+{
+    UAVObjectFrameNotifier *notifier = frameNotifiers.value(obj);
+
+    if (!notifier || notifier->dirty || !notifier->hasSubscribers()) {
+        return;
+    }
+    notifier->dirty = true;
+    pendingFrameNotifiers.append(notifier);
+    if (!frameTimer->isActive()) {
+        frameTimer->start();
+    }
+}
+
+void UAVObjectManager::frameTick()
+{
+    // Updates arriving from the slots are delivered on the next frame
+    QList<UAVObjectFrameNotifier *> pending = pendingFrameNotifiers;
+
+    pendingFrameNotifiers.clear();
+    foreach(UAVObjectFrameNotifier * notifier, pending) {
+        notifier->notify();
+    }
+}
+
 /**
  * Helper function for public getNumInstances
  */
@@ -363,14 +579,11 @@ qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
-            }
-        }
+    // Look up the object type
+    int objidx = findObjectIndex(name, objId);
+
+    if (objidx >= 0) {
+        return objects[objidx].length();
     }
     // If this point is reached then the requested object could not be found
     return -1;
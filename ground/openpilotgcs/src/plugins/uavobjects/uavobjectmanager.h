@@ -33,10 +33,37 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include <QList>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QJsonObject>
 
+class QTimer;
+
+// Forwards the updates of one object to the frame subscribers, see UAVObjectManager::subscribeFrameUpdates()
+class UAVObjectFrameNotifier : public QObject {
+    Q_OBJECT
+
+public:
+    UAVObjectFrameNotifier(UAVObject *obj, QObject *parent) : QObject(parent), object(obj), dirty(false) {}
+
+    bool hasSubscribers() const
+    {
+        return receivers(SIGNAL(frameUpdated(UAVObject *))) > 0;
+    }
+    void notify()
+    {
+        dirty = false;
+        emit frameUpdated(object);
+    }
+
+    UAVObject *object;
+    bool dirty;
+
+signals:
+    void frameUpdated(UAVObject *obj);
+};
+
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
     Q_OBJECT
 
@@ -55,23 +82,53 @@ public:
     QList<UAVObject *> getObjectInstances(quint32 objId);
     qint32 getNumInstances(const QString & name);
     qint32 getNumInstances(quint32 objId);
+    bool reserveInstances(quint32 objId, quint32 numInstances);
+    bool getInstanceData(quint32 objId, quint32 instId, quint8 *dataOut);
+    bool setInstanceData(quint32 objId, quint32 instId, const quint8 *dataIn);
 
     void toJson(QJsonObject &jsonObject, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
     void toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport);
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
     void fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects = NULL);
 
+    // Coalesced updates for displays, the slot(UAVObject *) of the receiver is called at most
+    // once per display frame with the latest data of obj. GUI thread only.
+    void subscribeFrameUpdates(UAVObject *obj, const QObject *receiver, const char *slot);
+    void unsubscribeFrameUpdates(UAVObject *obj, const QObject *receiver, const char *slot = 0);
+    // The property notifications of obj, used by the QML bindings, follow the frame updates
+    void subscribeFramePropertyNotifications(UAVObject *obj);
+
 signals:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
 
+private slots:
+    void frameObjectUpdated(UAVObject *obj);
+    void frameTick();
+
 private:
     static const quint32 MAX_INSTANCES = 1000;
+    static const int FRAME_INTERVAL    = 16; // ms
+
+    // Frame update notifiers by object, and the ones having updates pending
+    QHash<UAVObject *, UAVObjectFrameNotifier *> frameNotifiers;
+    QList<UAVObjectFrameNotifier *> pendingFrameNotifiers;
+    QTimer *frameTimer;
 
     QList< QList<UAVObject *> > objects;
+    // Position of each object type in the objects list, by object ID and by name
+    QHash<quint32, int> objectIndexById;
+    QHash<QString, int> objectIndexByName;
+    // Packed data of the instances no object was created for yet, these have a null entry in
+    // the instance list. One buffer per object type, the data of an instance at instId * size.
+    QHash<int, QByteArray> instanceData;
     QMutex *mutex;
 
     void addObject(UAVObject *obj);
+    void appendInstances(int objidx, quint32 numInstances);
+    UAVObject *instance(int objidx, quint32 instId);
+    void createInstances(int objidx);
+    int findObjectIndex(const QString *name, quint32 objId) const;
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
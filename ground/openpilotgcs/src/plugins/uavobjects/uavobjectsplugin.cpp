@@ -27,6 +27,10 @@
  */
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
+#include <extensionsystem/startuptrace.h>
+
+#include <QElapsedTimer>
+#include <QDebug>
 
 UAVObjectsPlugin::UAVObjectsPlugin()
 {}
@@ -44,7 +48,13 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString *errorS
 
     addAutoReleasedObject(objMngr);
     // Initialize UAVObjects
-    UAVObjectsInitialize(objMngr);
+    QElapsedTimer timer;
+    timer.start();
+    {
+        ExtensionSystem::StartupTrace::Span span("objects", QLatin1String("UAVObjectsInitialize"));
+        UAVObjectsInitialize(objMngr);
+    }
+    qDebug() << "UAVObjectsPlugin - registered" << objMngr->getObjects().count() << "objects in" << timer.elapsed() << "ms";
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
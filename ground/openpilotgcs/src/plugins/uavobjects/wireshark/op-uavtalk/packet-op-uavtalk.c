@@ -31,109 +31,559 @@
 #include <epan/packet.h>
 #include <epan/prefs.h>
 #include <epan/ptvcursor.h> /* ptvcursor_* */
+#include <epan/conversation.h>
+#include <epan/emem.h>
+#include <epan/expert.h>
+#include <epan/tap.h>
+#include <epan/stats_tree.h>
 
 #include <glib.h>
 #include <string.h>
 
-static guint global_op_uavtalk_port = 9000;
+static guint global_op_uavtalk_port     = 9000;
+static guint global_op_uavtalk_tcp_port = 9000;
+static gboolean global_op_uavtalk_hid   = FALSE;
 
 static int proto_op_uavtalk = -1;
+static int op_uavtalk_tap   = -1;
 
-static gint ett_op_uavtalk  = -1;
+static gint ett_op_uavtalk        = -1;
+static gint ett_op_uavtalk_record = -1;
 
 static dissector_handle_t data_handle;
 static dissector_table_t uavtalk_subdissector_table;
 
-static int hf_op_uavtalk_sync    = -1;
-static int hf_op_uavtalk_version = -1;
-static int hf_op_uavtalk_type    = -1;
-static int hf_op_uavtalk_len     = -1;
-static int hf_op_uavtalk_objid   = -1;
-static int hf_op_uavtalk_crc8    = -1;
-
-#define UAVTALK_SYNC_VAL 0x3C
+static int hf_op_uavtalk_sync          = -1;
+static int hf_op_uavtalk_version       = -1;
+static int hf_op_uavtalk_type          = -1;
+static int hf_op_uavtalk_timestamped   = -1;
+static int hf_op_uavtalk_len           = -1;
+static int hf_op_uavtalk_objid         = -1;
+static int hf_op_uavtalk_instid        = -1;
+static int hf_op_uavtalk_timestamp     = -1;
+static int hf_op_uavtalk_crc8          = -1;
+static int hf_op_uavtalk_crc8_bad      = -1;
+static int hf_op_uavtalk_record        = -1;
+static int hf_op_uavtalk_record_len    = -1;
+static int hf_op_uavtalk_prev_update   = -1;
+static int hf_op_uavtalk_update_delta  = -1;
+static int hf_op_uavtalk_response_in   = -1;
+static int hf_op_uavtalk_response_time = -1;
+static int hf_op_uavtalk_request_in    = -1;
+static int hf_op_uavtalk_reassembled   = -1;
+static int hf_op_uavtalk_continued     = -1;
+
+#define UAVTALK_SYNC_VAL        0x3C
+#define UAVTALK_TYPE_MASK       0x07
+#define UAVTALK_VERSION_MASK    0x78
+#define UAVTALK_VERSION         0x20
+#define UAVTALK_TIMESTAMPED     0x80
+
+#define UAVTALK_TYPE_OBJ        0
+#define UAVTALK_TYPE_OBJ_REQ    1
+#define UAVTALK_TYPE_OBJ_ACK    2
+#define UAVTALK_TYPE_ACK        3
+#define UAVTALK_TYPE_NACK       4
+#define UAVTALK_TYPE_BUNDLE     5
+#define UAVTALK_TYPE_OBJ_DELTA  6
 
 static const value_string uavtalk_packet_types[] = {
-    { 0, "TxObj"      },
-    { 1, "GetObj"     },
-    { 2, "SetObjAckd" },
-    { 3, "Ack"        },
-    { 4, "Nack"       },
-    { 0, NULL         }
+    { UAVTALK_TYPE_OBJ,       "TxObj"      },
+    { UAVTALK_TYPE_OBJ_REQ,   "GetObj"     },
+    { UAVTALK_TYPE_OBJ_ACK,   "SetObjAckd" },
+    { UAVTALK_TYPE_ACK,       "Ack"        },
+    { UAVTALK_TYPE_NACK,      "Nack"       },
+    { UAVTALK_TYPE_BUNDLE,    "Bundle"     },
+    { UAVTALK_TYPE_OBJ_DELTA, "TxObjDelta" },
+    { 0,                      NULL         }
 };
 
 void proto_reg_handoff_op_uavtalk(void);
 
-#define UAVTALK_HEADER_SIZE  8
-#define UAVTALK_TRAILER_SIZE 1
-static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+/* sync(1), type(1), len(2), objid(4), instid(2) and the optional timestamp(2) */
+#define UAVTALK_HEADER_SIZE        10
+#define UAVTALK_TIMESTAMP_SIZE     2
+#define UAVTALK_TRAILER_SIZE       1
+/* Larger than any UAVObject, anything longer is taken as a false sync */
+#define UAVTALK_MAX_FRAME_SIZE     2048
+/* objid(4), instid(2), length(1) */
+#define UAVTALK_BUNDLE_RECORD_SIZE 7
+
+/* OpenPilot HID reports: report id(1), length(1), data */
+#define UAVTALK_HID_HEADER_SIZE    2
+#define USB_CLASS_HID              0x03
+
+/*
+ * A UAVTalk frame completed by a packet.
+ *
+ * The frames are cut out of the byte stream of each direction during the first pass, so
+ * they are found whether the link split them across TCP segments, UDP datagrams or USB
+ * HID reports. Their timing is computed at the same time, in capture order, and kept
+ * with them for the later passes.
+ */
+typedef struct _uavtalk_frame_t {
+    guint8   *data;
+    guint16  length;
+    gint     offset;          /* Offset of the frame in the packet, -1 when it spans packets */
+    guint32  num;             /* Packet completing the frame */
+    nstime_t ts;
+
+    guint32  prev_update;     /* Previous update of the same instance in the same direction */
+    gdouble  update_delta;    /* ms */
+    guint32  response_in;     /* Ack, Nack or object answering this request */
+    guint32  request_in;      /* Request answered by this frame */
+    gdouble  response_time;   /* ms */
+
+    struct _uavtalk_frame_t *next;
+} uavtalk_frame_t;
+
+typedef struct _uavtalk_packet_t {
+    uavtalk_frame_t *frames;
+    guint32 continued;        /* Bytes of the packet held for a frame completed later */
+    guint32 reassembled_in;
+
+    struct _uavtalk_packet_t *next_pending;
+} uavtalk_packet_t;
+
+typedef struct {
+    guint8  buf[UAVTALK_MAX_FRAME_SIZE + UAVTALK_TRAILER_SIZE];
+    guint16 len;
+    uavtalk_packet_t *pending; /* Packets holding bytes of the frame in the buffer */
+    emem_tree_t *last_update;  /* Last update frame per (objid, instid) */
+    emem_tree_t *requests;     /* Last request frame per (objid, instid) */
+} uavtalk_stream_t;
+
+typedef struct {
+    address src;
+    guint32 srcport;
+    uavtalk_stream_t *stream[2];
+} uavtalk_conv_t;
+
+/* Information handed to the tap for each frame, and for each record of a bundle */
+typedef struct {
+    guint8  type;
+    guint32 objid;
+    guint16 instid;
+    guint32 length;
+} uavtalk_tap_info_t;
+
+static guint8 uavtalk_crc8(const guint8 *data, guint length)
 {
-    gint offset   = 0;
+    guint8 crc = 0;
 
-    guint8 packet_type = tvb_get_guint8(tvb, 1) & 0x7;
-    guint32 objid = tvb_get_letohl(tvb, 4);
-    guint32 payload_length  = tvb_get_letohs(tvb, 2) - UAVTALK_HEADER_SIZE - UAVTALK_TRAILER_SIZE;
-    guint32 reported_length = tvb_reported_length(tvb);
+    while (length--) {
+        int bit;
+        crc ^= *data++;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (guint8)((crc << 1) ^ 0x07) : (guint8)(crc << 1);
+        }
+    }
+    return crc;
+}
 
-    col_set_str(pinfo->cinfo, COL_PROTOCOL, "UAVTALK");
-    /* Clear out stuff in the info column */
-    col_clear(pinfo->cinfo, COL_INFO);
+static guint16 uavtalk_header_size(guint8 type_byte)
+{
+    return UAVTALK_HEADER_SIZE + ((type_byte & UAVTALK_TIMESTAMPED) ? UAVTALK_TIMESTAMP_SIZE : 0);
+}
+
+/* Streams of the conversation of the packet, in its direction and in the reverse one */
+static uavtalk_stream_t *uavtalk_get_stream(packet_info *pinfo, gboolean reverse)
+{
+    conversation_t *conversation = find_or_create_conversation(pinfo);
+    uavtalk_conv_t *conv = (uavtalk_conv_t *)conversation_get_proto_data(conversation, proto_op_uavtalk);
+    int dir;
+
+    if (!conv) {
+        conv = se_alloc0(sizeof(uavtalk_conv_t));
+        SE_COPY_ADDRESS(&conv->src, &pinfo->src);
+        conv->srcport = pinfo->srcport;
+        conversation_add_proto_data(conversation, proto_op_uavtalk, conv);
+    }
+
+    dir = (ADDRESSES_EQUAL(&conv->src, &pinfo->src) && conv->srcport == pinfo->srcport) ? 0 : 1;
+    if (reverse) {
+        dir = !dir;
+    }
+    if (!conv->stream[dir]) {
+        conv->stream[dir] = se_alloc0(sizeof(uavtalk_stream_t));
+        conv->stream[dir]->last_update = se_tree_create_non_persistent(EMEM_TREE_TYPE_RED_BLACK, "uavtalk_last_update");
+        conv->stream[dir]->requests    = se_tree_create_non_persistent(EMEM_TREE_TYPE_RED_BLACK, "uavtalk_requests");
+    }
+    return conv->stream[dir];
+}
+
+/* First pass: link the frame to the previous update of the same instance and to its request */
+static void uavtalk_track_frame(packet_info *pinfo, uavtalk_stream_t *stream, uavtalk_frame_t *frame)
+{
+    guint8 type = frame->data[1] & UAVTALK_TYPE_MASK;
+    guint32 id[2];
+    emem_tree_key_t key[] = {
+        { 2, id   },
+        { 0, NULL }
+    };
+
+    id[0] = pletohl(&frame->data[4]);
+    id[1] = pletohs(&frame->data[8]);
+
+    if (type == UAVTALK_TYPE_OBJ || type == UAVTALK_TYPE_OBJ_ACK || type == UAVTALK_TYPE_OBJ_DELTA) {
+        uavtalk_frame_t *prev = (uavtalk_frame_t *)se_tree_lookup32_array(stream->last_update, key);
+        if (prev) {
+            nstime_t delta;
+            nstime_delta(&delta, &frame->ts, &prev->ts);
+            frame->prev_update  = prev->num;
+            frame->update_delta = nstime_to_msec(&delta);
+        }
+        se_tree_insert32_array(stream->last_update, key, frame);
+    }
+
+    if (type == UAVTALK_TYPE_OBJ_REQ || type == UAVTALK_TYPE_OBJ_ACK) {
+        se_tree_insert32_array(stream->requests, key, frame);
+    }
 
-    col_append_fstr(pinfo->cinfo, COL_INFO, "%s: 0x%08x", val_to_str_const(packet_type, uavtalk_packet_types, ""), objid);
+    if (type == UAVTALK_TYPE_ACK || type == UAVTALK_TYPE_NACK || type == UAVTALK_TYPE_OBJ) {
+        uavtalk_stream_t *reverse = uavtalk_get_stream(pinfo, TRUE);
+        uavtalk_frame_t *request  = (uavtalk_frame_t *)se_tree_lookup32_array(reverse->requests, key);
+
+        if (request && !request->response_in) {
+            guint8 request_type = request->data[1] & UAVTALK_TYPE_MASK;
+            /* Objects and nacks answer object requests, acks and nacks answer acked updates */
+            if ((request_type == UAVTALK_TYPE_OBJ_REQ && type != UAVTALK_TYPE_ACK) ||
+                (request_type == UAVTALK_TYPE_OBJ_ACK && type != UAVTALK_TYPE_OBJ)) {
+                nstime_t delta;
+                nstime_delta(&delta, &frame->ts, &request->ts);
+                request->response_in   = frame->num;
+                request->response_time = nstime_to_msec(&delta);
+                frame->request_in      = request->num;
+                frame->response_time   = request->response_time;
+            }
+        }
+    }
+}
+
+/*
+ * First pass: append the bytes of the packet to the stream of its direction and cut the
+ * complete frames out of it. A sync byte followed by a header that cannot start a frame
+ * is dropped and the hunt resumes right after it, like the UAVTalk receivers do.
+ */
+static uavtalk_packet_t *uavtalk_reassemble(tvbuff_t *tvb, gint start, packet_info *pinfo)
+{
+    uavtalk_stream_t *stream = uavtalk_get_stream(pinfo, FALSE);
+    uavtalk_packet_t *packet = se_alloc0(sizeof(uavtalk_packet_t));
+    uavtalk_frame_t **tail   = &packet->frames;
+    gint end    = start + tvb_length_remaining(tvb, start);
+    gint offset = start;
+    gint frame_start = -1; /* Offset of the buffered frame in this packet, -1 when it began earlier */
+
+    while (offset < end) {
+        guint16 frame_len;
+        guint16 copy;
+
+        if (stream->len == 0) {
+            frame_start = tvb_find_guint8(tvb, offset, end - offset, UAVTALK_SYNC_VAL);
+            if (frame_start < 0) {
+                break;
+            }
+            offset = frame_start;
+            stream->pending = NULL;
+        }
+
+        /* Complete the header first, then the frame it announces */
+        frame_len = (stream->len >= 4) ? pletohs(&stream->buf[2]) + UAVTALK_TRAILER_SIZE : 4;
+        copy = (guint16)MIN(frame_len - stream->len, end - offset);
+        tvb_memcpy(tvb, &stream->buf[stream->len], offset, copy);
+        stream->len += copy;
+        offset += copy;
+
+        if (stream->len == 4) {
+            guint16 announced = pletohs(&stream->buf[2]);
+            if ((stream->buf[1] & UAVTALK_VERSION_MASK) != UAVTALK_VERSION ||
+                announced < uavtalk_header_size(stream->buf[1]) ||
+                announced > UAVTALK_MAX_FRAME_SIZE) {
+                offset = (frame_start >= 0) ? frame_start + 1 : start;
+                stream->len = 0;
+            }
+        } else if (stream->len == frame_len) {
+            uavtalk_frame_t *frame = se_alloc0(sizeof(uavtalk_frame_t));
+            uavtalk_packet_t *waiting;
+
+            frame->data   = se_memdup(stream->buf, stream->len);
+            frame->length = stream->len;
+            frame->offset = frame_start;
+            frame->num    = pinfo->fd->num;
+            frame->ts     = pinfo->fd->abs_ts;
+            uavtalk_track_frame(pinfo, stream, frame);
+
+            *tail = frame;
+            tail  = &frame->next;
+
+            for (waiting = stream->pending; waiting; waiting = waiting->next_pending) {
+                waiting->reassembled_in = pinfo->fd->num;
+            }
+            stream->pending = NULL;
+            stream->len     = 0;
+        }
+    }
+
+    if (stream->len > 0) {
+        /* The end of the packet starts or continues a frame completed by a later packet */
+        packet->continued    = (frame_start >= 0) ? (guint32)(end - frame_start) : (guint32)(end - start);
+        packet->next_pending = stream->pending;
+        stream->pending      = packet;
+    }
+
+    return packet;
+}
+
+static void uavtalk_tap_frame(packet_info *pinfo, guint8 type, guint32 objid, guint16 instid, guint32 length)
+{
+    uavtalk_tap_info_t *info = ep_alloc(sizeof(uavtalk_tap_info_t));
+
+    info->type   = type;
+    info->objid  = objid;
+    info->instid = instid;
+    info->length = length;
+    tap_queue_packet(op_uavtalk_tap, pinfo, info);
+}
+
+static void uavtalk_dissect_object(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 objid)
+{
+    /* Call any registered subdissector for this objid */
+    if (!dissector_try_uint(uavtalk_subdissector_table, objid, tvb, pinfo, tree)) {
+        /* No subdissector registered, use the default data dissector */
+        call_dissector(data_handle, tvb, pinfo, tree);
+    }
+}
+
+static void uavtalk_dissect_bundle(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gint offset, gint end)
+{
+    while (offset + UAVTALK_BUNDLE_RECORD_SIZE <= end) {
+        guint32 objid  = tvb_get_letohl(tvb, offset);
+        guint16 instid = tvb_get_letohs(tvb, offset + 4);
+        guint8 length  = tvb_get_guint8(tvb, offset + 6);
+        proto_tree *record_tree = NULL;
+
+        if (tree) {
+            proto_item *ti = proto_tree_add_item(tree, hf_op_uavtalk_record, tvb, offset,
+                                                 UAVTALK_BUNDLE_RECORD_SIZE + length, ENC_NA);
+            record_tree = proto_item_add_subtree(ti, ett_op_uavtalk_record);
+            proto_tree_add_item(record_tree, hf_op_uavtalk_objid, tvb, offset, 4, ENC_LITTLE_ENDIAN);
+            proto_tree_add_item(record_tree, hf_op_uavtalk_instid, tvb, offset + 4, 2, ENC_LITTLE_ENDIAN);
+            proto_tree_add_item(record_tree, hf_op_uavtalk_record_len, tvb, offset + 6, 1, ENC_LITTLE_ENDIAN);
+        }
+        offset += UAVTALK_BUNDLE_RECORD_SIZE;
+        if (offset + length > end) {
+            break;
+        }
+
+        uavtalk_dissect_object(tvb_new_subset(tvb, offset, length, length), pinfo, record_tree, objid);
+        uavtalk_tap_frame(pinfo, UAVTALK_TYPE_OBJ, objid, instid, UAVTALK_BUNDLE_RECORD_SIZE + length);
+        offset += length;
+    }
+}
+
+static void uavtalk_dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, uavtalk_frame_t *frame)
+{
+    guint8 type_byte = tvb_get_guint8(tvb, 1);
+    guint8 packet_type = type_byte & UAVTALK_TYPE_MASK;
+    guint16 header_len = uavtalk_header_size(type_byte);
+    guint16 frame_len  = tvb_get_letohs(tvb, 2);
+    guint32 objid      = tvb_get_letohl(tvb, 4);
+    guint16 instid     = tvb_get_letohs(tvb, 8);
+    guint8 crc         = tvb_get_guint8(tvb, frame_len);
+    guint8 computed    = uavtalk_crc8(tvb_get_ptr(tvb, 0, frame_len), frame_len);
+    tvbuff_t *next_tvb = tvb_new_subset(tvb, header_len, frame_len - header_len, frame_len - header_len);
+    proto_tree *op_uavtalk_tree = NULL;
+
+    col_append_sep_fstr(pinfo->cinfo, COL_INFO, ", ", "%s: 0x%08x", val_to_str_const(packet_type, uavtalk_packet_types, ""), objid);
     if (objid & 0x1) {
         col_append_str(pinfo->cinfo, COL_INFO, "(META)");
     }
 
-
     if (tree) { /* we are being asked for details */
-        proto_tree *op_uavtalk_tree = NULL;
         ptvcursor_t *cursor;
         proto_item *ti = NULL;
 
-        /* Add a top-level entry to the dissector tree for this protocol */
+        /* Add an entry to the dissector tree for each frame of the packet */
         ti = proto_tree_add_item(tree, proto_op_uavtalk, tvb, 0, -1, ENC_NA);
 
-        /* Create a subtree to contain the dissection of this protocol */
+        /* Create a subtree to contain the dissection of this frame */
         op_uavtalk_tree = proto_item_add_subtree(ti, ett_op_uavtalk);
 
-        /* Dissect the packet and populate the subtree */
+        /* Dissect the header and populate the subtree */
         cursor = ptvcursor_new(op_uavtalk_tree, tvb, 0);
 
-        /* Populate the fields in this protocol */
         ptvcursor_add(cursor, hf_op_uavtalk_sync, 1, ENC_LITTLE_ENDIAN);
+        ptvcursor_add_no_advance(cursor, hf_op_uavtalk_timestamped, 1, ENC_LITTLE_ENDIAN);
         ptvcursor_add_no_advance(cursor, hf_op_uavtalk_version, 1, ENC_LITTLE_ENDIAN);
         ptvcursor_add(cursor, hf_op_uavtalk_type, 1, ENC_LITTLE_ENDIAN);
         ptvcursor_add(cursor, hf_op_uavtalk_len, 2, ENC_LITTLE_ENDIAN);
         ptvcursor_add(cursor, hf_op_uavtalk_objid, 4, ENC_LITTLE_ENDIAN);
-
-        offset = ptvcursor_current_offset(cursor);
+        ptvcursor_add(cursor, hf_op_uavtalk_instid, 2, ENC_LITTLE_ENDIAN);
+        if (type_byte & UAVTALK_TIMESTAMPED) {
+            ptvcursor_add(cursor, hf_op_uavtalk_timestamp, 2, ENC_LITTLE_ENDIAN);
+        }
 
         ptvcursor_free(cursor);
 
-        proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_crc8, tvb, reported_length - UAVTALK_TRAILER_SIZE, UAVTALK_TRAILER_SIZE, ENC_LITTLE_ENDIAN);
+        ti = proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_crc8, tvb, frame_len, UAVTALK_TRAILER_SIZE, ENC_LITTLE_ENDIAN);
+        if (crc != computed) {
+            proto_item_append_text(ti, " [incorrect, should be 0x%02x]", computed);
+            ti = proto_tree_add_boolean(op_uavtalk_tree, hf_op_uavtalk_crc8_bad, tvb, frame_len, UAVTALK_TRAILER_SIZE, TRUE);
+            PROTO_ITEM_SET_GENERATED(ti);
+            expert_add_info_format(pinfo, ti, PI_CHECKSUM, PI_WARN, "Bad UAVTalk checksum");
+        }
+
+        /* Frame timing, computed on the first pass */
+        if (frame->prev_update) {
+            ti = proto_tree_add_uint(op_uavtalk_tree, hf_op_uavtalk_prev_update, tvb, 0, 0, frame->prev_update);
+            PROTO_ITEM_SET_GENERATED(ti);
+            ti = proto_tree_add_double(op_uavtalk_tree, hf_op_uavtalk_update_delta, tvb, 0, 0, frame->update_delta);
+            PROTO_ITEM_SET_GENERATED(ti);
+        }
+        if (frame->response_in) {
+            ti = proto_tree_add_uint(op_uavtalk_tree, hf_op_uavtalk_response_in, tvb, 0, 0, frame->response_in);
+            PROTO_ITEM_SET_GENERATED(ti);
+        }
+        if (frame->request_in) {
+            ti = proto_tree_add_uint(op_uavtalk_tree, hf_op_uavtalk_request_in, tvb, 0, 0, frame->request_in);
+            PROTO_ITEM_SET_GENERATED(ti);
+        }
+        if (frame->response_in || frame->request_in) {
+            ti = proto_tree_add_double(op_uavtalk_tree, hf_op_uavtalk_response_time, tvb, 0, 0, frame->response_time);
+            PROTO_ITEM_SET_GENERATED(ti);
+        }
+    }
+
+    if (packet_type == UAVTALK_TYPE_BUNDLE) {
+        /* Object ID is zero for bundles, each record holds one object update */
+        uavtalk_tap_frame(pinfo, packet_type, objid, instid, header_len + UAVTALK_TRAILER_SIZE);
+        uavtalk_dissect_bundle(tvb, pinfo, op_uavtalk_tree, header_len, frame_len);
+        return;
+    }
+
+    uavtalk_tap_frame(pinfo, packet_type, objid, instid, frame_len + UAVTALK_TRAILER_SIZE);
+
+    /* Check if we have an embedded objid to decode */
+    if (packet_type == UAVTALK_TYPE_OBJ || packet_type == UAVTALK_TYPE_OBJ_ACK) {
+        uavtalk_dissect_object(next_tvb, pinfo, tree, objid);
     } else {
-        offset = UAVTALK_HEADER_SIZE;
+        /* Render any remaining data, delta encoded updates included, as raw bytes */
+        call_dissector(data_handle, next_tvb, pinfo, tree);
     }
+}
 
-    {
-        tvbuff_t *next_tvb = tvb_new_subset(tvb, offset,
-                                            reported_length - UAVTALK_HEADER_SIZE - UAVTALK_TRAILER_SIZE,
-                                            payload_length);
+static int dissect_op_uavtalk_stream(tvbuff_t *tvb, gint start, packet_info *pinfo, proto_tree *tree)
+{
+    uavtalk_packet_t *packet = (uavtalk_packet_t *)p_get_proto_data(pinfo->fd, proto_op_uavtalk);
+    uavtalk_frame_t *frame;
 
-        /* Check if we have an embedded objid to decode */
-        if ((packet_type == 0) || (packet_type == 2)) {
-            /* Call any registered subdissector for this objid */
-            if (!dissector_try_uint(uavtalk_subdissector_table, objid, next_tvb, pinfo, tree)) {
-                /* No subdissector registered, use the default data dissector */
-                call_dissector(data_handle, next_tvb, pinfo, tree);
-            }
+    if (!packet) {
+        if (pinfo->fd->flags.visited) {
+            /* Not seen on the first pass, nothing can be said about the stream */
+            return 0;
+        }
+        packet = uavtalk_reassemble(tvb, start, pinfo);
+        p_add_proto_data(pinfo->fd, proto_op_uavtalk, packet);
+    }
+
+    col_set_str(pinfo->cinfo, COL_PROTOCOL, "UAVTALK");
+    /* Clear out stuff in the info column */
+    col_clear(pinfo->cinfo, COL_INFO);
+
+    for (frame = packet->frames; frame; frame = frame->next) {
+        tvbuff_t *frame_tvb;
+
+        if (frame->offset >= 0) {
+            frame_tvb = tvb_new_subset(tvb, frame->offset, frame->length, frame->length);
         } else {
-            /* Render any remaining data as raw bytes */
-            call_dissector(data_handle, next_tvb, pinfo, tree);
+            frame_tvb = tvb_new_child_real_data(tvb, frame->data, frame->length, frame->length);
+            add_new_data_source(pinfo, frame_tvb, "Reassembled UAVTalk");
         }
+        uavtalk_dissect_frame(frame_tvb, pinfo, tree, frame);
+    }
+
+    if (packet->continued) {
+        if (!packet->frames) {
+            col_append_str(pinfo->cinfo, COL_INFO, "[UAVTalk frame segment]");
+        }
+        if (tree) {
+            proto_item *ti = proto_tree_add_uint(tree, hf_op_uavtalk_continued, tvb, 0, 0, packet->continued);
+            PROTO_ITEM_SET_GENERATED(ti);
+            if (packet->reassembled_in) {
+                ti = proto_tree_add_uint(tree, hf_op_uavtalk_reassembled, tvb, 0, 0, packet->reassembled_in);
+                PROTO_ITEM_SET_GENERATED(ti);
+            }
+        }
+    }
+
+    return tvb_length(tvb);
+}
+
+static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    return dissect_op_uavtalk_stream(tvb, 0, pinfo, tree);
+}
+
+static int dissect_op_uavtalk_hid(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    guint8 length;
+
+    if (tvb_length(tvb) < UAVTALK_HID_HEADER_SIZE) {
+        return 0;
+    }
+    length = tvb_get_guint8(tvb, 1);
+    if (length > tvb_length(tvb) - UAVTALK_HID_HEADER_SIZE) {
+        return 0;
+    }
+
+    /* Only the bytes announced by the report belong to the stream */
+    dissect_op_uavtalk_stream(tvb_new_subset(tvb, 0, UAVTALK_HID_HEADER_SIZE + length, UAVTALK_HID_HEADER_SIZE + length),
+                              UAVTALK_HID_HEADER_SIZE, pinfo, tree);
+    return tvb_length(tvb);
+}
+
+/*
+ * Statistics/UAVTalk: frames by type, then updates and bytes by object. The rate column
+ * of the bytes nodes gives the bandwidth of each object in bytes per millisecond.
+ */
+static const gchar *st_str_types   = "Frames by type";
+static const gchar *st_str_updates = "Frames by object";
+static const gchar *st_str_bytes   = "Bytes by object";
+static int st_node_types   = -1;
+static int st_node_updates = -1;
+static int st_node_bytes   = -1;
+
+static void uavtalk_stats_tree_init(stats_tree *st)
+{
+    st_node_types   = stats_tree_create_node(st, st_str_types, 0, TRUE);
+    st_node_updates = stats_tree_create_node(st, st_str_updates, 0, TRUE);
+    st_node_bytes   = stats_tree_create_node(st, st_str_bytes, 0, TRUE);
+}
+
+static int uavtalk_stats_tree_packet(stats_tree *st, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *p)
+{
+    const uavtalk_tap_info_t *info = (const uavtalk_tap_info_t *)p;
+    dissector_handle_t handle = dissector_get_uint_handle(uavtalk_subdissector_table, info->objid & ~0x1);
+    gchar *name;
+
+    if (info->type == UAVTALK_TYPE_BUNDLE) {
+        name = ep_strdup("Bundle headers");
+    } else if (handle) {
+        name = ep_strdup_printf("%s%s", dissector_handle_get_short_name(handle), (info->objid & 0x1) ? " (meta)" : "");
+    } else {
+        name = ep_strdup_printf("0x%08x", info->objid);
     }
 
-    return UAVTALK_HEADER_SIZE + UAVTALK_TRAILER_SIZE;
+    tick_stat_node(st, st_str_types, 0, FALSE);
+    tick_stat_node(st, val_to_str_const(info->type, uavtalk_packet_types, "Unknown"), st_node_types, FALSE);
+
+    tick_stat_node(st, st_str_updates, 0, FALSE);
+    tick_stat_node(st, name, st_node_updates, FALSE);
+
+    increase_stat_node(st, st_str_bytes, 0, FALSE, info->length);
+    increase_stat_node(st, name, st_node_bytes, FALSE, info->length);
+
+    return 1;
 }
 
 void proto_register_op_uavtalk(void)
@@ -145,13 +595,17 @@ void proto_register_op_uavtalk(void)
             { "Sync Byte",           "uavtalk.sync",   FT_UINT8,
             BASE_HEX, NULL, 0x0, NULL, HFILL }
         },
+        { &hf_op_uavtalk_timestamped,
+            { "Timestamped",         "uavtalk.timestamped", FT_BOOLEAN,
+            8, NULL, UAVTALK_TIMESTAMPED, NULL, HFILL }
+        },
         { &hf_op_uavtalk_version,
             { "Version",             "uavtalk.ver",    FT_UINT8,
-            BASE_DEC, NULL, 0xf8, NULL, HFILL }
+            BASE_HEX, NULL, UAVTALK_VERSION_MASK, NULL, HFILL }
         },
         { &hf_op_uavtalk_type,
             { "Type",                "uavtalk.type",   FT_UINT8,
-            BASE_HEX, VALS(uavtalk_packet_types), 0x07, NULL, HFILL }
+            BASE_HEX, VALS(uavtalk_packet_types), UAVTALK_TYPE_MASK, NULL, HFILL }
         },
         { &hf_op_uavtalk_len,
             { "Length",              "uavtalk.len",    FT_UINT16,
@@ -161,16 +615,65 @@ void proto_register_op_uavtalk(void)
             { "ObjID",               "uavtalk.objid",  FT_UINT32,
             BASE_HEX, NULL, 0x0, NULL, HFILL }
         },
+        { &hf_op_uavtalk_instid,
+            { "InstID",              "uavtalk.instid", FT_UINT16,
+            BASE_DEC, NULL, 0x0, NULL, HFILL }
+        },
+        { &hf_op_uavtalk_timestamp,
+            { "Timestamp",           "uavtalk.timestamp", FT_UINT16,
+            BASE_DEC, NULL, 0x0, "Board time in ms, modulo 65536", HFILL }
+        },
         { &hf_op_uavtalk_crc8,
             { "Crc8",                "uavtalk.crc8",   FT_UINT8,
             BASE_HEX, NULL, 0x0, NULL, HFILL }
         },
+        { &hf_op_uavtalk_crc8_bad,
+            { "Bad Crc8",            "uavtalk.crc8_bad", FT_BOOLEAN,
+            BASE_NONE, NULL, 0x0, NULL, HFILL }
+        },
+        { &hf_op_uavtalk_record,
+            { "Bundle Record",       "uavtalk.record", FT_NONE,
+            BASE_NONE, NULL, 0x0, NULL, HFILL }
+        },
+        { &hf_op_uavtalk_record_len,
+            { "Record Length",       "uavtalk.record.len", FT_UINT8,
+            BASE_DEC, NULL, 0x0, NULL, HFILL }
+        },
+        { &hf_op_uavtalk_prev_update,
+            { "Previous Update In",  "uavtalk.prev_update_in", FT_FRAMENUM,
+            BASE_NONE, NULL, 0x0, "Previous update of this instance in this direction", HFILL }
+        },
+        { &hf_op_uavtalk_update_delta,
+            { "Update Period (ms)",  "uavtalk.update_delta", FT_DOUBLE,
+            BASE_NONE, NULL, 0x0, "Time since the previous update of this instance", HFILL }
+        },
+        { &hf_op_uavtalk_response_in,
+            { "Response In",         "uavtalk.response_in", FT_FRAMENUM,
+            BASE_NONE, NULL, 0x0, NULL, HFILL }
+        },
+        { &hf_op_uavtalk_request_in,
+            { "Request In",          "uavtalk.request_in", FT_FRAMENUM,
+            BASE_NONE, NULL, 0x0, NULL, HFILL }
+        },
+        { &hf_op_uavtalk_response_time,
+            { "Response Time (ms)",  "uavtalk.response_time", FT_DOUBLE,
+            BASE_NONE, NULL, 0x0, "Time between the request and its answer", HFILL }
+        },
+        { &hf_op_uavtalk_continued,
+            { "Segment Bytes",       "uavtalk.segment_len", FT_UINT32,
+            BASE_DEC, NULL, 0x0, "Bytes of a frame completed by a later packet", HFILL }
+        },
+        { &hf_op_uavtalk_reassembled,
+            { "Reassembled In",      "uavtalk.reassembled_in", FT_FRAMENUM,
+            BASE_NONE, NULL, 0x0, NULL, HFILL }
+        },
     };
 
 /* Setup protocol subtree array */
 
     static gint *ett[] = {
-        &ett_op_uavtalk
+        &ett_op_uavtalk,
+        &ett_op_uavtalk_record
     };
 
     proto_op_uavtalk = proto_register_protocol("OpenPilot UAVTalk Protocol",
@@ -183,23 +686,63 @@ void proto_register_op_uavtalk(void)
     proto_register_subtree_array(ett, array_length(ett));
     proto_register_field_array(proto_op_uavtalk, hf, array_length(hf));
 
+    op_uavtalk_tap = register_tap("uavtalk");
+
     op_uavtalk_module = prefs_register_protocol(proto_op_uavtalk, proto_reg_handoff_op_uavtalk);
 
     prefs_register_uint_preference(op_uavtalk_module, "udp.port", "UAVTALK UDP port",
                                    "UAVTALK port (default 9000)", 10, &global_op_uavtalk_port);
+    prefs_register_uint_preference(op_uavtalk_module, "tcp.port", "UAVTALK TCP port",
+                                   "UAVTALK port (default 9000)", 10, &global_op_uavtalk_tcp_port);
+    prefs_register_bool_preference(op_uavtalk_module, "usb.hid", "Dissect USB HID interrupt transfers",
+                                   "Decode every USB HID interrupt transfer as OpenPilot HID reports",
+                                   &global_op_uavtalk_hid);
 }
 
 void proto_reg_handoff_op_uavtalk(void)
 {
+    static gboolean initialized = FALSE;
     static dissector_handle_t op_uavtalk_handle;
+    static dissector_handle_t op_uavtalk_hid_handle;
+    static guint udp_port;
+    static guint tcp_port;
+    static gboolean hid;
+
+    if (!initialized) {
+        op_uavtalk_handle     = new_create_dissector_handle(dissect_op_uavtalk, proto_op_uavtalk);
+        op_uavtalk_hid_handle = new_create_dissector_handle(dissect_op_uavtalk_hid, proto_op_uavtalk);
+        dissector_add_handle("udp.port", op_uavtalk_handle); /* for "decode as" */
+        dissector_add_handle("tcp.port", op_uavtalk_handle);
+
+        /* Lookup the default dissector for raw data */
+        data_handle = find_dissector("data");
+
+        stats_tree_register("uavtalk", "uavtalk", "UAVTalk", 0,
+                            uavtalk_stats_tree_packet, uavtalk_stats_tree_init, NULL);
+        initialized = TRUE;
+    } else {
+        if (udp_port != 0) {
+            dissector_delete_uint("udp.port", udp_port, op_uavtalk_handle);
+        }
+        if (tcp_port != 0) {
+            dissector_delete_uint("tcp.port", tcp_port, op_uavtalk_handle);
+        }
+        if (hid) {
+            dissector_delete_uint("usb.interrupt", USB_CLASS_HID, op_uavtalk_hid_handle);
+        }
+    }
 
-    op_uavtalk_handle = new_create_dissector_handle(dissect_op_uavtalk, proto_op_uavtalk);
-    dissector_add_handle("udp.port", op_uavtalk_handle); /* for "decode as" */
+    udp_port = global_op_uavtalk_port;
+    tcp_port = global_op_uavtalk_tcp_port;
+    hid = global_op_uavtalk_hid;
 
-    if (global_op_uavtalk_port != 0) {
-        dissector_add_uint("udp.port", global_op_uavtalk_port, op_uavtalk_handle);
+    if (udp_port != 0) {
+        dissector_add_uint("udp.port", udp_port, op_uavtalk_handle);
+    }
+    if (tcp_port != 0) {
+        dissector_add_uint("tcp.port", tcp_port, op_uavtalk_handle);
+    }
+    if (hid) {
+        dissector_add_uint("usb.interrupt", USB_CLASS_HID, op_uavtalk_hid_handle);
     }
-
-    /* Lookup the default dissector for raw data */
-    data_handle = find_dissector("data");
 }
@@ -38,6 +38,7 @@
 
 #include "firmwareiapobj.h"
 #include "homelocation.h"
+#include "oplinksettings.h"
 #include "gpspositionsensor.h"
 
 // ******************************
@@ -47,6 +48,7 @@ UAVObjectUtilManager::UAVObjectUtilManager()
 {
     mutex     = new QMutex(QMutex::Recursive);
     saveState = IDLE;
+    saveCount = 0;
     failureTimer.stop();
     failureTimer.setSingleShot(true);
     failureTimer.setInterval(1000);
@@ -88,6 +90,14 @@ UAVObjectManager *UAVObjectUtilManager::getObjectManager()
 // SD card saving
 //
 
+/*
+   The radio modem saves its own settings and only knows single object requests
+ */
+static bool savedInList(UAVObject *obj)
+{
+    return obj->getObjID() != OPLinkSettings::OBJID;
+}
+
 /*
    Add a new object to save in the queue
  */
@@ -113,20 +123,34 @@ void UAVObjectUtilManager::saveNextObject()
 
     Q_ASSERT(saveState == IDLE);
 
-    // Get next object from the queue
+    // The objects queued while the previous request was pending are saved by one request,
+    // the board writes them all before it replies
     UAVObject *obj = queue.head();
-    qDebug() << "Send save object request to board " << obj->getName();
+    saveCount = 1;
+    if (savedInList(obj)) {
+        while (saveCount < queue.length() && saveCount < (int)ObjectPersistence::LISTOBJECTID_NUMELEM &&
+               savedInList(queue.at(saveCount))) {
+            ++saveCount;
+        }
+    }
+    qDebug() << "Send save object request to board " << obj->getName() << "and" << saveCount - 1 << "more";
 
     ObjectPersistence *objper = dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
     connect(objper, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
     connect(objper, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectPersistenceUpdated(UAVObject *)));
     saveState = AWAITING_ACK;
     if (obj != NULL) {
-        ObjectPersistence::DataFields data;
+        ObjectPersistence::DataFields data = objper->getData();
         data.Operation  = ObjectPersistence::OPERATION_SAVE;
-        data.Selection  = ObjectPersistence::SELECTION_SINGLEOBJECT;
+        data.Selection  = saveCount > 1 ? ObjectPersistence::SELECTION_OBJECTLIST : ObjectPersistence::SELECTION_SINGLEOBJECT;
         data.ObjectID   = obj->getObjID();
         data.InstanceID = obj->getInstID();
+        data.ListCount  = saveCount;
+        data.ListFailed = 0;
+        for (int i = 0; i < saveCount; ++i) {
+            data.ListObjectID[i]   = queue.at(i)->getObjID();
+            data.ListInstanceID[i] = queue.at(i)->getInstID();
+        }
         objper->setData(data);
         objper->updated();
     }
@@ -158,16 +182,13 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj,
         // the queue:
         saveState = AWAITING_COMPLETED;
         disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(objectPersistenceTransactionCompleted(UAVObject *, bool)));
-        failureTimer.start(2000); // Create a timeout
+        failureTimer.start(1000 + 1000 * saveCount); // Create a timeout, each object takes a flash write
     } else {
         // Can be caused by timeout errors on sending.  Forget it and send next.
         qDebug() << "objectPersistenceTranscationCompleted (error)";
         UAVObject *obj = getObjectManager()->getObject(ObjectPersistence::NAME);
         obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it failed anyway.
-        saveState = IDLE;
-        emit saveCompleted(obj->getField("ObjectID")->getValue().toInt(), false);
-        saveNextObject();
+        saveFinished(0xFF); // They failed anyway.
     }
 }
 
@@ -185,16 +206,28 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
         ObjectPersistence *objectPersistence = ObjectPersistence::GetInstance(getObjectManager());
         Q_ASSERT(objectPersistence);
 
-        UAVObject *obj = queue.dequeue(); // We can now remove the object, it failed anyway.
-        Q_ASSERT(obj);
-
         objectPersistence->disconnect(this);
 
-        saveState = IDLE;
-        emit saveCompleted(obj->getObjID(), false);
+        saveFinished(0xFF); // They failed anyway.
+    }
+}
+
+/**
+ * @brief Removes the objects of the last request from the queue and requests the next ones be saved.
+ * @param[in] failed Bit n set when the n-th object of the request was not saved
+ */
+void UAVObjectUtilManager::saveFinished(quint8 failed)
+{
+    int count = saveCount;
 
-        saveNextObject();
+    saveCount = 0;
+    saveState = IDLE;
+    for (int i = 0; i < count && !queue.isEmpty(); ++i) {
+        UAVObject *obj = queue.dequeue();
+        emit saveCompleted(obj->getObjID(), !(failed & (1 << i)));
     }
+
+    saveNextObject();
 }
 
 
@@ -223,11 +256,12 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
         }
 
         obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it's done.
-        saveState = IDLE;
-
-        emit saveCompleted(objectPersistence.ObjectID, true);
-        saveNextObject();
+        // We can now remove the objects, they're done.
+        if (objectPersistence.Selection == ObjectPersistence::SELECTION_OBJECTLIST) {
+            saveFinished(objectPersistence.ListFailed);
+        } else {
+            saveFinished(0);
+        }
     }
 }
 
@@ -76,8 +76,11 @@ signals:
 private:
     QMutex *mutex;
     QQueue<UAVObject *> queue;
+    // Objects at the head of the queue the pending request saves
+    int saveCount;
     enum { IDLE, AWAITING_ACK, AWAITING_COMPLETED } saveState;
     void saveNextObject();
+    void saveFinished(quint8 failed);
     QTimer failureTimer;
 
     ExtensionSystem::PluginManager *pm;
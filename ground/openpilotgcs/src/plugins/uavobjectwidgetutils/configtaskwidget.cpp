@@ -134,7 +134,10 @@ void ConfigTaskWidget::doAddWidgetBinding(QString objectName, QString fieldName,
         Q_ASSERT(object);
         m_updatedObjects.insert(object, true);
         connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
-        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+        // the widgets are refreshed at most once per display frame
+        getObjectManager()->subscribeFrameUpdates(object, this, SLOT(refreshWidgetsValues(UAVObject *)));
+        // the new widget is set on the next refresh
+        m_refreshedData.remove(object);
     }
 
     if (!fieldName.isEmpty() && object) {
@@ -293,19 +296,52 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
 
     bool dirtyBack = isDirty();
     emit refreshWidgetsValuesRequested();
-    QList<WidgetBinding *> bindings = obj == NULL ? m_widgetBindingsPerObject.values() : m_widgetBindingsPerObject.values(obj);
-    foreach(WidgetBinding * binding, bindings) {
-        if (binding->field() != NULL && binding->widget() != NULL) {
-            if (binding->isEnabled()) {
-                setWidgetFromField(binding->widget(), binding->field(), binding);
-            } else {
-                binding->updateValueFromObjectField();
-            }
+    if (obj == NULL) {
+        foreach(UAVObject * object, m_widgetBindingsPerObject.uniqueKeys()) {
+            refreshObjectBindings(object, true);
         }
+    } else {
+        refreshObjectBindings(obj, false);
     }
     setDirty(dirtyBack);
 }
 
+/*
+   Sets the widgets bound to obj from its fields, unless all is set only the
+   bindings whose bytes changed since the last refresh are set again
+ */
+void ConfigTaskWidget::refreshObjectBindings(UAVObject *obj, bool all)
+{
+    if (obj == NULL) {
+        return;
+    }
+    QByteArray data(obj->getNumBytes(), 0);
+    obj->pack((quint8 *)data.data());
+
+    QByteArray previous = all ? QByteArray() : m_refreshedData.value(obj);
+    bool compare = (previous.size() == data.size());
+
+    foreach(WidgetBinding * binding, m_widgetBindingsPerObject.values(obj)) {
+        UAVObjectField *field = binding->field();
+        if (field == NULL || binding->widget() == NULL) {
+            continue;
+        }
+        if (compare) {
+            int size   = field->getNumBytes() / field->getNumElements();
+            int offset = field->getDataOffset() + binding->index() * size;
+            if (memcmp(previous.constData() + offset, data.constData() + offset, size) == 0) {
+                continue;
+            }
+        }
+        if (binding->isEnabled()) {
+            setWidgetFromField(binding->widget(), field, binding);
+        } else {
+            binding->updateValueFromObjectField();
+        }
+    }
+    m_refreshedData.insert(obj, data);
+}
+
 void ConfigTaskWidget::updateObjectsFromWidgets()
 {
     emit updateObjectsFromWidgetsRequested();
@@ -476,7 +512,7 @@ void ConfigTaskWidget::disableObjectUpdates()
     m_isWidgetUpdatesAllowed = false;
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
         if (binding->object()) {
-            disconnect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)));
+            getObjectManager()->unsubscribeFrameUpdates(binding->object(), this, SLOT(refreshWidgetsValues(UAVObject *)));
         }
     }
 }
@@ -486,7 +522,7 @@ void ConfigTaskWidget::enableObjectUpdates()
     m_isWidgetUpdatesAllowed = true;
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
         if (binding->object()) {
-            connect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+            getObjectManager()->subscribeFrameUpdates(binding->object(), this, SLOT(refreshWidgetsValues(UAVObject *)));
         }
     }
 }
@@ -217,6 +217,8 @@ private:
     UAVObjectUtilManager *m_objectUtilManager;
     SmartSaveButton *m_saveButton;
     QHash<UAVObject *, bool> m_updatedObjects;
+    // Data of each object the bound widgets were last refreshed from
+    QHash<UAVObject *, QByteArray> m_refreshedData;
     QHash<QPushButton *, QString> m_helpButtons;
     QList<QPushButton *> m_reloadButtons;
     bool m_isDirty;
@@ -224,6 +226,7 @@ private:
     QTimer *m_realtimeUpdateTimer;
 
     bool setWidgetFromField(QWidget *widget, UAVObjectField *field, WidgetBinding *binding);
+    void refreshObjectBindings(UAVObject *obj, bool all);
 
     QVariant getVariantFromWidget(QWidget *widget, WidgetBinding *binding);
     bool setWidgetFromVariant(QWidget *widget, QVariant value, WidgetBinding *binding);
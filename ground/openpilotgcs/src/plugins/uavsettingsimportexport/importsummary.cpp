@@ -66,7 +66,7 @@ void ImportSummaryDialog::openHelp()
    Adds a new line about a UAVObject along with its status
    (whether it got saved OK or not)
  */
-void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool status)
+void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool status, bool checked)
 {
     ui->importSummaryList->setRowCount(ui->importSummaryList->rowCount() + 1);
     int row = ui->importSummaryList->rowCount() - 1;
@@ -81,7 +81,7 @@ void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool stat
     ui->importSummaryList->item(row, 2)->setFlags(!Qt::ItemIsEditable);
 
     if (status) {
-        box->setChecked(true);
+        box->setChecked(checked);
     } else {
         box->setChecked(false);
         box->setEnabled(false);
@@ -91,6 +91,15 @@ void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool stat
     this->showEvent(NULL);
 }
 
+/*
+   Shows how long reading the file and applying it to the objects took, in ms
+ */
+void ImportSummaryDialog::setImportTimes(qint64 parseTime, qint64 applyTime)
+{
+    importTimes = tr("Parsed in %1 ms, applied in %2 ms").arg(parseTime).arg(applyTime);
+    ui->label->setText(tr("UAV Settings import summary") + " - " + importTimes);
+}
+
 /*
    Saves every checked UAVObjet in the list to Flash
  */
@@ -114,6 +123,7 @@ void ImportSummaryDialog::doTheSaving()
     }
     ui->progressBar->setMaximum(itemCount + 1);
     ui->progressBar->setValue(1);
+    saveTimer.start();
     for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
         QString uavObjectName = ui->importSummaryList->item(i, 1)->text();
         QCheckBox *box = dynamic_cast<QCheckBox *>(ui->importSummaryList->cellWidget(i, 0));
@@ -133,6 +143,8 @@ void ImportSummaryDialog::updateSaveCompletion()
 {
     ui->progressBar->setValue(ui->progressBar->value() + 1);
     if (ui->progressBar->value() == ui->progressBar->maximum()) {
+        ui->label->setText(tr("UAV Settings import summary") + " - " + importTimes +
+                           tr(", saved in %1 ms").arg(saveTimer.elapsed()));
         ui->saveToFlash->setEnabled(true);
         ui->closeButton->setEnabled(true);
     }
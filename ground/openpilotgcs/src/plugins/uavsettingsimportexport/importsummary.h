@@ -31,6 +31,7 @@
 #include <QCheckBox>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QElapsedTimer>
 #include "ui_importsummarydialog.h"
 #include "uavdataobject.h"
 #include "uavobjectmanager.h"
@@ -48,7 +49,9 @@ class ImportSummaryDialog : public QDialog {
 public:
     ImportSummaryDialog(QWidget *parent = 0);
     ~ImportSummaryDialog();
-    void addLine(QString objectName, QString text, bool status);
+    // checked false leaves the object out of the saving, status false does not allow it
+    void addLine(QString objectName, QString text, bool status, bool checked = true);
+    void setImportTimes(qint64 parseTime, qint64 applyTime);
 
 protected:
     void showEvent(QShowEvent *event);
@@ -56,6 +59,8 @@ protected:
 
 private:
     Ui::ImportSummaryDialog *ui;
+    QString importTimes;
+    QElapsedTimer saveTimer;
 
 public slots:
     void updateSaveCompletion();
@@ -1,6 +1,6 @@
 
 TEMPLATE = lib
-QT += xml
+QT += xml concurrent
 
 TARGET = UAVSettingsImportExport
 DEFINES += UAVSETTINGSIMPORTEXPORT_LIBRARY
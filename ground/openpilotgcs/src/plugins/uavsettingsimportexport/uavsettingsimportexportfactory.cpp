@@ -47,6 +47,12 @@
 // for XML object
 #include <QDomDocument>
 
+// for parsing in a worker thread
+#include <QtConcurrentRun>
+#include <QFutureWatcher>
+#include <QEventLoop>
+#include <QElapsedTimer>
+
 // for file dialog and error messages
 #include <QFileDialog>
 #include <QMessageBox>
@@ -90,6 +96,63 @@ UAVSettingsImportExportFactory::UAVSettingsImportExportFactory(QObject *parent)
     connect(cmd->action(), SIGNAL(triggered(bool)), this, SLOT(exportUAVData()));
 }
 
+// A settings object read from an import file, the plain values are
+// parsed in a worker thread and only applied to the objects afterwards
+struct ImportedField {
+    QString name;
+    QString values;
+};
+
+struct ImportedObject {
+    QString name;
+    uint id;
+    QList<ImportedField> fields;
+};
+
+struct ImportedSettings {
+    enum { Ok, ParseError, NoSettings } status;
+    QList<ImportedObject> objects;
+};
+
+static ImportedSettings parseSettingsFile(const QString &fileName)
+{
+    ImportedSettings settings;
+    QFile file(fileName);
+    QDomDocument doc("UAVObjects");
+
+    file.open(QFile::ReadOnly | QFile::Text);
+    if (!doc.setContent(file.readAll())) {
+        settings.status = ImportedSettings::ParseError;
+        return settings;
+    }
+    file.close();
+
+    // find the root of settings subtree
+    QDomElement root = doc.documentElement();
+    if (root.tagName() == "uavobjects") {
+        root = root.firstChildElement("settings");
+    }
+    if (root.isNull() || (root.tagName() != "settings")) {
+        settings.status = ImportedSettings::NoSettings;
+        return settings;
+    }
+
+    for (QDomElement e = root.firstChildElement("object"); !e.isNull(); e = e.nextSiblingElement("object")) {
+        ImportedObject object;
+        object.name = e.attribute("name");
+        object.id   = e.attribute("id").toUInt(NULL, 16);
+        for (QDomElement f = e.firstChildElement("field"); !f.isNull(); f = f.nextSiblingElement("field")) {
+            ImportedField field;
+            field.name   = f.attribute("name");
+            field.values = f.attribute("values");
+            object.fields << field;
+        }
+        settings.objects << object;
+    }
+    settings.status = ImportedSettings::Ok;
+    return settings;
+}
+
 // Slot called by the menu manager on user action
 void UAVSettingsImportExportFactory::importUAVSettings()
 {
@@ -102,11 +165,21 @@ void UAVSettingsImportExportFactory::importUAVSettings()
         return;
     }
 
-    // Now open the file
-    QFile file(fileName);
-    QDomDocument doc("UAVObjects");
-    file.open(QFile::ReadOnly | QFile::Text);
-    if (!doc.setContent(file.readAll())) {
+    // Now parse the file, the GUI keeps running meanwhile
+    QElapsedTimer timer;
+    timer.start();
+
+    QFutureWatcher<ImportedSettings> watcher;
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::run(parseSettingsFile, fileName));
+    if (!watcher.isFinished()) {
+        loop.exec(QEventLoop::ExcludeUserInputEvents);
+    }
+    ImportedSettings settings = watcher.result();
+    qint64 parseTime = timer.restart();
+
+    if (settings.status == ImportedSettings::ParseError) {
         QMessageBox msgBox;
         msgBox.setText(tr("File Parsing Failed."));
         msgBox.setInformativeText(tr("This file is not a correct XML file"));
@@ -114,17 +187,11 @@ void UAVSettingsImportExportFactory::importUAVSettings()
         msgBox.exec();
         return;
     }
-    file.close();
 
-    // find the root of settings subtree
     emit importAboutToBegin();
     qDebug() << "Import about to begin";
 
-    QDomElement root = doc.documentElement();
-    if (root.tagName() == "uavobjects") {
-        root = root.firstChildElement("settings");
-    }
-    if (root.isNull() || (root.tagName() != "settings")) {
+    if (settings.status == ImportedSettings::NoSettings) {
         QMessageBox msgBox;
         msgBox.setText(tr("Wrong file contents"));
         msgBox.setInformativeText(tr("This file does not contain correct UAVSettings"));
@@ -141,75 +208,77 @@ void UAVSettingsImportExportFactory::importUAVSettings()
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     swui.show();
 
-    QDomNode node = root.firstChild();
-    while (!node.isNull()) {
-        QDomElement e = node.toElement();
-        if (e.tagName() == "object") {
-            // - Read each object
-            QString uavObjectName = e.attribute("name");
-            uint uavObjectID = e.attribute("id").toUInt(NULL, 16);
-
-            // Sanity Check:
-            UAVObject *obj   = objManager->getObject(uavObjectName);
-            if (obj == NULL) {
-                // This object is unknown!
-                qDebug() << "Object unknown:" << uavObjectName << uavObjectID;
-                swui.addLine(uavObjectName, "Error (Object unknown)", false);
-            } else {
-                // - Update each field
-                // - Issue and "updated" command
-                bool error     = false;
-                bool setError  = false;
-                QDomNode field = node.firstChild();
-                while (!field.isNull()) {
-                    QDomElement f = field.toElement();
-                    if (f.tagName() == "field") {
-                        UAVObjectField *uavfield = obj->getField(f.attribute("name"));
-                        if (uavfield) {
-                            QStringList list = f.attribute("values").split(",");
-                            if (list.length() == 1) {
-                                if (false == uavfield->checkValue(f.attribute("values"))) {
-                                    qDebug() << "checkValue returned false on: " << uavObjectName << f.attribute("values");
-                                    setError = true;
-                                } else {
-                                    uavfield->setValue(f.attribute("values"));
-                                }
-                            } else {
-                                // This is an enum:
-                                int i = 0;
-                                QStringList list = f.attribute("values").split(",");
-                                foreach(QString element, list) {
-                                    if (false == uavfield->checkValue(element, i)) {
-                                        qDebug() << "checkValue(list) returned false on: " << uavObjectName << list;
-                                        setError = true;
-                                    } else {
-                                        uavfield->setValue(element, i);
-                                    }
-                                    i++;
-                                }
-                            }
+    foreach(const ImportedObject &object, settings.objects) {
+        // Sanity Check:
+        UAVObject *obj = objManager->getObject(object.name);
+
+        if (obj == NULL) {
+            // This object is unknown!
+            qDebug() << "Object unknown:" << object.name << object.id;
+            swui.addLine(object.name, "Error (Object unknown)", false);
+            continue;
+        }
+
+        // The current data, only the objects the import changes are sent to the board
+        QByteArray before(obj->getNumBytes(), 0);
+        obj->pack((quint8 *)before.data());
+
+        // - Update each field
+        bool error    = false;
+        bool setError = false;
+        foreach(const ImportedField &field, object.fields) {
+            UAVObjectField *uavfield = obj->getField(field.name);
+
+            if (uavfield) {
+                QStringList list = field.values.split(",");
+                if (list.length() == 1) {
+                    if (false == uavfield->checkValue(field.values)) {
+                        qDebug() << "checkValue returned false on: " << object.name << field.values;
+                        setError = true;
+                    } else {
+                        uavfield->setValue(field.values);
+                    }
+                } else {
+                    // This is an enum:
+                    int i = 0;
+                    foreach(QString element, list) {
+                        if (false == uavfield->checkValue(element, i)) {
+                            qDebug() << "checkValue(list) returned false on: " << object.name << list;
+                            setError = true;
                         } else {
-                            error = true;
+                            uavfield->setValue(element, i);
                         }
+                        i++;
                     }
-                    field = field.nextSibling();
-                }
-                obj->updated();
-
-                if (error) {
-                    swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
-                } else if (uavObjectID != obj->getObjID()) {
-                    qDebug() << "Mismatch for Object " << uavObjectName << uavObjectID << " - " << obj->getObjID();
-                    swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
-                } else if (setError) {
-                    swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
-                } else {
-                    swui.addLine(uavObjectName, "OK", true);
                 }
+            } else {
+                error = true;
             }
         }
-        node = node.nextSibling();
+
+        QByteArray after(obj->getNumBytes(), 0);
+        obj->pack((quint8 *)after.data());
+        bool changed = (after != before);
+
+        // - Issue and "updated" command
+        if (changed) {
+            obj->updated();
+        }
+
+        if (error) {
+            swui.addLine(object.name, "Warning (Object field unknown)", true, changed);
+        } else if (object.id != obj->getObjID()) {
+            qDebug() << "Mismatch for Object " << object.name << object.id << " - " << obj->getObjID();
+            swui.addLine(object.name, "Warning (ObjectID mismatch)", true, changed);
+        } else if (setError) {
+            swui.addLine(object.name, "Warning (Objects field value(s) invalid)", false);
+        } else if (!changed) {
+            swui.addLine(object.name, "OK (Unchanged)", true, false);
+        } else {
+            swui.addLine(object.name, "OK", true);
+        }
     }
+    swui.setImportTimes(parseTime, timer.elapsed());
     qDebug() << "End import";
     swui.exec();
 }
@@ -28,9 +28,11 @@
 #include "telemetry.h"
 #include "oplinksettings.h"
 #include "objectpersistence.h"
-#include <QTime>
+#include "manualcontrolcommand.h"
+#include "gcsreceiver.h"
 #include <QtGlobal>
 #include <stdlib.h>
+#include <algorithm>
 #include <QDebug>
 
 /**
@@ -40,6 +42,15 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
 {
     mutex = new QMutex(QMutex::Recursive);
 
+    // The periodic timer is restarted as objects get scheduled
+    periodicTime.start();
+    periodicUpdates     = 0;
+    periodicJitterSumMs = 0;
+    periodicJitterMaxMs = 0;
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
+
     // Register all objects in the list
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
@@ -63,15 +74,20 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
     // Get GCS stats object
     gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
 
-    // Setup and start the periodic timer
-    timeToNextUpdateMs = 0;
-    updateTimer = new QTimer(this);
-    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
-    updateTimer->start(1000);
+    // Start the periodic timer
+    startPeriodicTimer();
 
     // Setup and start the stats timer
     txErrors  = 0;
     txRetries = 0;
+
+    // No rate limit until the link asks for one
+    txRateLimit = 0;
+    txTokens    = 0;
+    txTokenTimer.start();
+    txRateTimer = new QTimer(this);
+    txRateTimer->setSingleShot(true);
+    connect(txRateTimer, SIGNAL(timeout()), this, SLOT(txTokensAvailable()));
 }
 
 Telemetry::~Telemetry()
@@ -103,35 +119,75 @@ void Telemetry::registerObject(UAVObject *obj)
 void Telemetry::addObject(UAVObject *obj)
 {
     // Check if object type is already in the list
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            // Object type (not instance!) is already in the list, do nothing
-            return;
-        }
+    if (objIndex.contains(obj->getObjID())) {
+        // Object type (not instance!) is already in the list, do nothing
+        return;
     }
 
     // If this point is reached, then the object type is new, let's add it
     ObjectTimeInfo timeInfo;
     timeInfo.obj = obj;
-    timeInfo.timeToNextUpdateMs = 0;
-    timeInfo.updatePeriodMs     = 0;
+    timeInfo.nextUpdateMs   = 0;
+    timeInfo.updatePeriodMs = 0;
+    timeInfo.generation     = 0;
+    objIndex.insert(obj->getObjID(), objList.length());
     objList.append(timeInfo);
 }
 
 /**
- * Update the object's timers
+ * Update the object's timers, it is only rescheduled if the period changes
  */
 void Telemetry::setUpdatePeriod(UAVObject *obj, qint32 periodMs)
 {
     // Find object type (not instance!) and update its period
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            objList[n].updatePeriodMs     = periodMs;
-            objList[n].timeToNextUpdateMs = quint32((float)periodMs * (float)qrand() / (float)RAND_MAX); // avoid bunching of updates
-        }
+    QHash<quint32, int>::const_iterator it = objIndex.constFind(obj->getObjID());
+
+    if (it == objIndex.constEnd() || objList[it.value()].updatePeriodMs == periodMs) {
+        return;
+    }
+    ObjectTimeInfo &timeInfo = objList[it.value()];
+    timeInfo.updatePeriodMs  = periodMs;
+    // the heap entry of the previous period is left there and ignored
+    ++timeInfo.generation;
+    if (periodMs > 0) {
+        // avoid bunching of updates
+        schedulePeriodicUpdate(it.value(), periodicTime.elapsed() + qint64((float)periodMs * (float)qrand() / (float)RAND_MAX));
+        startPeriodicTimer();
+    }
+}
+
+void Telemetry::schedulePeriodicUpdate(int index, qint64 dueMs)
+{
+    PeriodicEntry entry;
+
+    objList[index].nextUpdateMs = dueMs;
+    entry.dueMs      = dueMs;
+    entry.index      = index;
+    entry.generation = objList[index].generation;
+    periodicHeap.append(entry);
+    std::push_heap(periodicHeap.begin(), periodicHeap.end(), laterPeriodicEntry);
+}
+
+/**
+ * (Re)start the timer for the earliest periodic update
+ */
+void Telemetry::startPeriodicTimer()
+{
+    qint32 delay = MAX_UPDATE_PERIOD_MS;
+
+    if (!periodicHeap.isEmpty()) {
+        delay = qBound((qint64)MIN_UPDATE_PERIOD_MS, periodicHeap.first().dueMs - periodicTime.elapsed(), (qint64)MAX_UPDATE_PERIOD_MS);
+    }
+    if (!updateTimer->isActive() || updateTimer->remainingTime() > delay) {
+        updateTimer->start(delay);
     }
 }
 
+bool Telemetry::laterPeriodicEntry(const PeriodicEntry &a, const PeriodicEntry &b)
+{
+    return a.dueMs > b.dueMs;
+}
+
 /**
  * Connect to all instances of an object depending on the event mask specified
  */
@@ -350,17 +406,13 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
     objInfo.event = event;
     objInfo.allInstances = allInstances;
     if (priority) {
-        if (objPriorityQueue.length() < MAX_QUEUE_SIZE) {
-            objPriorityQueue.enqueue(objInfo);
-        } else {
+        if (!enqueueObject(objPriorityQueue, objInfo)) {
             ++txErrors;
             qWarning().nospace() << "Telemetry - !!! priority event queue is full, event lost " << obj->toStringBrief();
             obj->emitTransactionCompleted(false);
         }
     } else {
-        if (objQueue.length() < MAX_QUEUE_SIZE) {
-            objQueue.enqueue(objInfo);
-        } else {
+        if (!enqueueObject(objQueue, objInfo)) {
             ++txErrors;
             qWarning().nospace() << "Telemetry - !!! event queue is full, event lost " << obj->toStringBrief();
             obj->emitTransactionCompleted(false);
@@ -372,26 +424,167 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
 }
 
 /**
- * Process events from the object queue
+ * Push an event into a queue. The data is packed when the object is sent, so an event
+ * already queued for the same object instance sends the latest data and the new one is dropped.
+ * \return false if the queue is full
+ */
+bool Telemetry::enqueueObject(QQueue<ObjectQueueInfo> &queue, const ObjectQueueInfo &objInfo)
+{
+    foreach(const ObjectQueueInfo &queued, queue) {
+        if (queued.obj == objInfo.obj && queued.event == objInfo.event && queued.allInstances == objInfo.allInstances) {
+            return true;
+        }
+    }
+    if (queue.length() >= MAX_QUEUE_SIZE) {
+        return false;
+    }
+    queue.enqueue(objInfo);
+    return true;
+}
+
+/**
+ * Process events from the object queues until they are empty or only hold events that have to wait
  */
 void Telemetry::processObjectQueue()
 {
-    // Get object information from queue (first the priority and then the regular queue)
     ObjectQueueInfo objInfo;
 
-    if (!objPriorityQueue.isEmpty()) {
-        objInfo = objPriorityQueue.dequeue();
-    } else if (!objQueue.isEmpty()) {
-        objInfo = objQueue.dequeue();
-    } else {
-        return;
+    while (dequeueObject(objInfo)) {
+        processObjectEvent(objInfo);
+    }
+}
+
+/**
+ * Get the next event to process: first the priority and then the regular queue, then the events
+ * whose object transaction has completed and last the rate limited updates the link has room for.
+ * \return false if no event can be processed now
+ */
+bool Telemetry::dequeueObject(ObjectQueueInfo &objInfo)
+{
+    while (!objPriorityQueue.isEmpty() || !objQueue.isEmpty()) {
+        objInfo = !objPriorityQueue.isEmpty() ? objPriorityQueue.dequeue() : objQueue.dequeue();
+        if (!isRateLimited(objInfo)) {
+            // acked transactions and requests are never held back, but leave less room to the updates
+            takeTxTokens(txSize(objInfo), true);
+            return true;
+        }
+        if (objThrottledQueue.isEmpty() && takeTxTokens(txSize(objInfo), false)) {
+            return true;
+        }
+        if (!enqueueObject(objThrottledQueue, objInfo)) {
+            ++txErrors;
+            qWarning().nospace() << "Telemetry - !!! rate limited event queue is full, event lost " << objInfo.obj->toStringBrief();
+            objInfo.obj->emitTransactionCompleted(false);
+        }
+    }
+
+    for (int n = 0; n < objBlocked.length(); ++n) {
+        if (!findTransaction(objBlocked[n].obj)) {
+            objInfo = objBlocked.takeAt(n);
+            return true;
+        }
+    }
+
+    if (!objThrottledQueue.isEmpty()) {
+        qint32 bytes = txSize(objThrottledQueue.head());
+        if (takeTxTokens(bytes, false)) {
+            objInfo = objThrottledQueue.dequeue();
+            return true;
+        }
+        // come back once the bucket holds enough for the next update
+        if (!txRateTimer->isActive()) {
+            txRateTimer->start((int)((bytes * 1000LL - txTokens) / txRateLimit) + 1);
+        }
+    }
+    return false;
+}
+
+/**
+ * Whether the event is an unacked object update, the traffic the rate limit applies to
+ */
+bool Telemetry::isRateLimited(const ObjectQueueInfo &objInfo)
+{
+    const quint32 objId = objInfo.obj->getObjID();
+    // the link statistics and the control inputs are never held back
+    if (txRateLimit == 0 || objId == GCSTelemetryStats::OBJID ||
+        objId == ManualControlCommand::OBJID || objId == GCSReceiver::OBJID) {
+        return false;
+    }
+    if (objInfo.event != EV_UPDATED && objInfo.event != EV_UPDATED_MANUAL && objInfo.event != EV_UPDATED_PERIODIC) {
+        return false;
+    }
+    UAVObject::Metadata metadata = objInfo.obj->getMetadata();
+    if (objInfo.event == EV_UPDATED_PERIODIC && UAVObject::GetGcsTelemetryUpdateMode(metadata) == UAVObject::UPDATEMODE_THROTTLED) {
+        // nothing is sent for it
+        return false;
+    }
+    return !UAVObject::GetGcsTelemetryAcked(metadata);
+}
+
+/**
+ * Approximate number of bytes sent for an event
+ */
+qint32 Telemetry::txSize(const ObjectQueueInfo &objInfo)
+{
+    if (objInfo.event == EV_UNPACKED) {
+        return 0;
+    } else if (objInfo.event == EV_UPDATE_REQ) {
+        return TX_HEADER_BYTES;
+    }
+    qint32 instances = objInfo.allInstances ? objMngr->getNumInstances(objInfo.obj->getObjID()) : 1;
+    return TX_HEADER_BYTES + instances * objInfo.obj->getNumBytes();
+}
+
+/**
+ * Token bucket of the rate limit, refilled at txRateLimit bytes per second
+ * \param force take the tokens even if the bucket does not hold them
+ * \return true if the bytes can be sent now
+ */
+bool Telemetry::takeTxTokens(qint32 bytes, bool force)
+{
+    if (txRateLimit == 0) {
+        return true;
     }
+    qint64 cost = bytes * 1000LL;
+    // a burst may not exceed TX_BURST_MS, any single packet has to fit though
+    qint64 maxTokens = qMax((qint64)txRateLimit * TX_BURST_MS, cost);
+    txTokens = qMin(txTokens + txTokenTimer.restart() * txRateLimit, maxTokens);
+    if (!force && txTokens < cost) {
+        return false;
+    }
+    txTokens = qMax(txTokens - cost, -maxTokens);
+    return true;
+}
+
+void Telemetry::setTxRateLimit(quint32 bytesPerSecond)
+{
+    QMutexLocker locker(mutex);
 
+    txRateLimit = bytesPerSecond;
+    txTokens    = (qint64)txRateLimit * TX_BURST_MS;
+    txTokenTimer.restart();
+    // without a limit anymore, the held back updates go now
+    processObjectQueue();
+}
+
+void Telemetry::txTokensAvailable()
+{
+    QMutexLocker locker(mutex);
+
+    processObjectQueue();
+}
+
+/**
+ * Process an event from the object queues
+ */
+void Telemetry::processObjectEvent(const ObjectQueueInfo &objInfo)
+{
     // Check if a connection has been established, only process GCSTelemetryStats updates
     // (used to establish the connection)
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
     if (gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
         objQueue.clear();
+        objThrottledQueue.clear();
         if ((objInfo.obj->getObjID() != GCSTelemetryStats::OBJID) &&
             (objInfo.obj->getObjID() != OPLinkSettings::OBJID) &&
             (objInfo.obj->getObjID() != ObjectPersistence::OBJID)) {
@@ -410,12 +603,17 @@ void Telemetry::processObjectQueue()
         // If a single instance transaction is running, then starting an "all instance" transaction is not allowed
         // TODO make the above logic a reality...
         if (findTransaction(objInfo.obj)) {
-            qWarning().nospace() << "Telemetry - !!! Making request for an object " << objInfo.obj->toStringBrief() << " for which a request is already in progress";
-            // objInfo.obj->emitTransactionCompleted(false);
+            // processed again once the transaction completes, a single time for repeated events
+            foreach(const ObjectQueueInfo &blocked, objBlocked) {
+                if (blocked.obj == objInfo.obj && blocked.event == objInfo.event && blocked.allInstances == objInfo.allInstances) {
+                    return;
+                }
+            }
+            objBlocked.append(objInfo);
             return;
         }
         UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
-        ObjectTransactionInfo *transInfo = new ObjectTransactionInfo(this);
+        ObjectTransactionInfo *transInfo = transPool.isEmpty() ? new ObjectTransactionInfo(this) : transPool.takeLast();
         transInfo->obj   = objInfo.obj;
         transInfo->allInstances = objInfo.allInstances;
         transInfo->retriesRemaining = MAX_RETRIES;
@@ -438,70 +636,42 @@ void Telemetry::processObjectQueue()
     } else if (updateMode != UAVObject::UPDATEMODE_THROTTLED) {
         updateObject(objInfo.obj, objInfo.event);
     }
-
-    // The fact we received an unpacked event does not mean that
-    // we do not have additional objects still in the queue,
-    // so we have to reschedule queue processing to make sure they are not
-    // stuck:
-    if (objInfo.event == EV_UNPACKED) {
-        processObjectQueue();
-    }
 }
 
 /**
- * Check is any objects are pending for periodic updates
- * TODO: Clean-up
+ * Send the periodic updates that are due, they are taken from the top of the heap
+ * so the objects without periodic updates or not due yet are not visited.
  */
 void Telemetry::processPeriodicUpdates()
 {
     QMutexLocker locker(mutex);
 
-    // Stop timer
-    updateTimer->stop();
-
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update (will be used for setting timeToNextUpdateMs)
-    qint32 minDelay  = MAX_UPDATE_PERIOD_MS;
-    ObjectTimeInfo *objinfo;
-    qint32 elapsedMs = 0;
-    QTime time;
-    qint32 offset;
-    bool allInstances;
-    for (int n = 0; n < objList.length(); ++n) {
-        objinfo = &objList[n];
-        // If object is configured for periodic updates
-        if (objinfo->updatePeriodMs > 0) {
-            objinfo->timeToNextUpdateMs -= timeToNextUpdateMs;
-            // Check if time for the next update
-            if (objinfo->timeToNextUpdateMs <= 0) {
-                // Reset timer
-                offset = (-objinfo->timeToNextUpdateMs) % objinfo->updatePeriodMs;
-                objinfo->timeToNextUpdateMs = objinfo->updatePeriodMs - offset;
-                // Send object
-                time.start();
-                allInstances = !objinfo->obj->isSingleInstance();
-                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, allInstances, false);
-                elapsedMs    = time.elapsed();
-                // Update timeToNextUpdateMs with the elapsed delay of sending the object;
-                timeToNextUpdateMs += elapsedMs;
-            }
-            // Update minimum delay
-            if (objinfo->timeToNextUpdateMs < minDelay) {
-                minDelay = objinfo->timeToNextUpdateMs;
-            }
+    qint64 timeNow = periodicTime.elapsed();
+
+    while (!periodicHeap.isEmpty() && periodicHeap.first().dueMs <= timeNow) {
+        std::pop_heap(periodicHeap.begin(), periodicHeap.end(), laterPeriodicEntry);
+        PeriodicEntry entry = periodicHeap.takeLast();
+        ObjectTimeInfo &timeInfo = objList[entry.index];
+        if (entry.generation != timeInfo.generation) {
+            // rescheduled or unscheduled since
+            continue;
         }
-    }
 
-    // Check if delay for the next update is too short
-    if (minDelay < MIN_UPDATE_PERIOD_MS) {
-        minDelay = MIN_UPDATE_PERIOD_MS;
-    }
+        // Update stats
+        quint32 jitter = timeNow - entry.dueMs;
+        ++periodicUpdates;
+        periodicJitterSumMs += jitter;
+        periodicJitterMaxMs  = qMax(periodicJitterMaxMs, jitter);
 
-    // Done
-    timeToNextUpdateMs = minDelay;
+        // Reschedule before sending, the update may change the period
+        UAVObject *obj = timeInfo.obj;
+        schedulePeriodicUpdate(entry.index, timeNow + timeInfo.updatePeriodMs - (jitter % timeInfo.updatePeriodMs));
+
+        // Send object
+        processObjectUpdates(obj, EV_UPDATED_PERIODIC, !obj->isSingleInstance(), false);
+    }
 
-    // Restart timer
-    updateTimer->start(timeToNextUpdateMs);
+    startPeriodicTimer();
 }
 
 Telemetry::TelemetryStats Telemetry::getStats()
@@ -527,6 +697,13 @@ Telemetry::TelemetryStats Telemetry::getStats()
     stats.rxSyncErrors  = utalkStats.rxSyncErrors;
     stats.rxCrcErrors   = utalkStats.rxCrcErrors;
 
+    stats.txLatency     = utalkStats.txLatency;
+    stats.rxProcessingUs = utalkStats.rxProcessingUs;
+
+    stats.txPeriodicUpdates     = periodicUpdates;
+    stats.txPeriodicJitterAvgMs = periodicUpdates ? periodicJitterSumMs / periodicUpdates : 0;
+    stats.txPeriodicJitterMaxMs = periodicJitterMaxMs;
+
     // Done
     return stats;
 }
@@ -538,6 +715,9 @@ void Telemetry::resetStats()
     utalk->resetStats();
     txErrors  = 0;
     txRetries = 0;
+    periodicUpdates     = 0;
+    periodicJitterSumMs = 0;
+    periodicJitterMaxMs = 0;
 }
 
 void Telemetry::objectUpdatedAuto(UAVObject *obj)
@@ -643,7 +823,10 @@ void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
         // Keep the map even if it is empty
         // There are at most 100 different object IDs...
     }
-    delete trans;
+    // Keep it for the next transaction
+    trans->timer->stop();
+    trans->obj = 0;
+    transPool.append(trans);
 }
 
 void Telemetry::closeAllTransactions()
@@ -36,7 +36,11 @@
 #include <QTimer>
 #include <QQueue>
 #include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
 
+// pooled by Telemetry, an instance is reused for the following transactions once closed
 class ObjectTransactionInfo : public QObject {
     Q_OBJECT
 
@@ -71,6 +75,14 @@ public:
         quint32 rxErrors;
         quint32 rxSyncErrors;
         quint32 rxCrcErrors;
+
+        quint32 txLatency;
+        quint32 rxProcessingUs;
+
+        // lateness of the periodic updates against their schedule
+        quint32 txPeriodicUpdates;
+        quint32 txPeriodicJitterAvgMs;
+        quint32 txPeriodicJitterMaxMs;
     } TelemetryStats;
 
     Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr);
@@ -78,6 +90,9 @@ public:
     TelemetryStats getStats();
     void resetStats();
     void transactionTimeout(ObjectTransactionInfo *info);
+    // limits the unacked object updates to bytesPerSecond so they cannot starve the acked
+    // transactions and the acks on a slow link, 0 for no limit
+    void setTxRateLimit(quint32 bytesPerSecond);
 
 private:
     // Constants
@@ -86,6 +101,9 @@ private:
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
     static const int MAX_QUEUE_SIZE = 20;
+    // the rate limit allows bursts of that long, plus one packet
+    static const int TX_BURST_MS    = 100;
+    static const int TX_HEADER_BYTES = 12;
 
     // Types
     /**
@@ -103,9 +121,16 @@ private:
     typedef struct {
         UAVObject *obj;
         qint32    updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-        qint32    timeToNextUpdateMs; /** Time delay to the next update */
+        qint64    nextUpdateMs; /** Time of the next update on periodicTime */
+        quint32   generation; /** Incremented on each reschedule, the older heap entries are then ignored */
     } ObjectTimeInfo;
 
+    typedef struct {
+        qint64  dueMs;
+        int     index; /** Entry in objList */
+        quint32 generation;
+    } PeriodicEntry;
+
     typedef struct {
         UAVObject *obj;
         EventMask event;
@@ -117,13 +142,29 @@ private:
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
     QList<ObjectTimeInfo> objList;
+    QHash<quint32, int> objIndex;
+    // min-heap on dueMs of the scheduled periodic updates
+    QVector<PeriodicEntry> periodicHeap;
+    QElapsedTimer periodicTime;
+    quint32 periodicUpdates;
+    quint32 periodicJitterSumMs;
+    quint32 periodicJitterMaxMs;
     QQueue<ObjectQueueInfo> objQueue;
     QQueue<ObjectQueueInfo> objPriorityQueue;
+    // updates waiting for the transaction in progress on their object
+    QList<ObjectQueueInfo> objBlocked;
+    // unacked updates waiting for the rate limit
+    QQueue<ObjectQueueInfo> objThrottledQueue;
     QMap<quint32, QMap<quint32, ObjectTransactionInfo *> *> transMap;
+    QList<ObjectTransactionInfo *> transPool;
+    quint32 txRateLimit;
+    // in thousandths of a byte, so that short intervals still add up
+    qint64 txTokens;
+    QElapsedTimer txTokenTimer;
+    QTimer *txRateTimer;
     QMutex *mutex;
     QTimer *updateTimer;
     QTimer *statsTimer;
-    qint32 timeToNextUpdateMs;
     quint32 txErrors;
     quint32 txRetries;
 
@@ -131,12 +172,21 @@ private:
     void registerObject(UAVObject *obj);
     void addObject(UAVObject *obj);
     void setUpdatePeriod(UAVObject *obj, qint32 periodMs);
+    void schedulePeriodicUpdate(int index, qint64 dueMs);
+    void startPeriodicTimer();
+    static bool laterPeriodicEntry(const PeriodicEntry &a, const PeriodicEntry &b);
     void connectToObjectInstances(UAVObject *obj, quint32 eventMask);
     void connectToObject(UAVObject *obj, quint32 eventMask);
     void updateObject(UAVObject *obj, quint32 eventMask);
     void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority);
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
     void processObjectQueue();
+    bool dequeueObject(ObjectQueueInfo &objInfo);
+    void processObjectEvent(const ObjectQueueInfo &objInfo);
+    bool enqueueObject(QQueue<ObjectQueueInfo> &queue, const ObjectQueueInfo &objInfo);
+    bool isRateLimited(const ObjectQueueInfo &objInfo);
+    qint32 txSize(const ObjectQueueInfo &objInfo);
+    bool takeTxTokens(qint32 bytes, bool force);
 
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
     void openTransaction(ObjectTransactionInfo *trans);
@@ -153,6 +203,7 @@ private slots:
     void newInstance(UAVObject *obj);
     void processPeriodicUpdates();
     void transactionCompleted(UAVObject *obj, bool success);
+    void txTokensAvailable();
 };
 
 #endif // TELEMETRY_H
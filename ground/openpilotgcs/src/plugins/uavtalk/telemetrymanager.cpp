@@ -28,16 +28,23 @@
 #include "telemetrymanager.h"
 #include "telemetry.h"
 #include "telemetrymonitor.h"
+#include "telemetryrelay.h"
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
+#include <coreplugin/generalsettings.h>
 
-TelemetryManager::TelemetryManager() : m_connectionState(TELEMETRY_DISCONNECTED)
+#include <QVariant>
+
+TelemetryManager::TelemetryManager(UAVObjectManager *objMngr, QThread *thread) :
+    m_uavobjectManager(objMngr), m_uavTalk(NULL), m_connectionState(TELEMETRY_DISCONNECTED), m_relay(NULL)
 {
-    moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
+    moveToThread(thread ? thread : Core::ICore::instance()->threadManager()->getRealTimeThread());
     // Get UAVObjectManager instance
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    m_uavobjectManager = pm->getObject<UAVObjectManager>();
+    if (!m_uavobjectManager) {
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        m_uavobjectManager = pm->getObject<UAVObjectManager>();
+    }
 
     // connect to start stop signals
     connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
@@ -57,6 +64,28 @@ TelemetryManager::ConnectionState TelemetryManager::connectionState() const
     return m_connectionState;
 }
 
+void TelemetryManager::addFrameLogger(UAVTalkFrameLogger *logger)
+{
+    QMutexLocker locker(&m_frameLoggerLock);
+
+    if (!m_frameLoggers.contains(logger)) {
+        m_frameLoggers.append(logger);
+    }
+    if (m_uavTalk) {
+        m_uavTalk->addFrameLogger(logger);
+    }
+}
+
+void TelemetryManager::removeFrameLogger(UAVTalkFrameLogger *logger)
+{
+    QMutexLocker locker(&m_frameLoggerLock);
+
+    m_frameLoggers.removeAll(logger);
+    if (m_uavTalk) {
+        m_uavTalk->removeFrameLogger(logger);
+    }
+}
+
 void TelemetryManager::start(QIODevice *dev)
 {
     m_connectionState = TELEMETRY_CONNECTING;
@@ -74,29 +103,38 @@ void TelemetryManager::start(QIODevice *dev)
 
 void TelemetryManager::onStart()
 {
+    m_frameLoggerLock.lock();
     m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager);
-    if (false) {
-        // UAVTalk must be thread safe and for that:
-        // 1- all public methods must lock a mutex
-        // 2- the reader thread must lock that mutex too
-        // The reader thread locks the mutex once a packet is read and decoded.
-        // It is assumed that the UAVObjectManager is thread safe
-
-        // Create the reader and move it to the reader thread
-        IODeviceReader *reader = new IODeviceReader(m_uavTalk);
-        reader->moveToThread(&m_telemetryReaderThread);
-        // The reader will be deleted (later) when the thread finishes
-        connect(&m_telemetryReaderThread, &QThread::finished, reader, &QObject::deleteLater);
-        // Connect IO device to reader
-        connect(m_telemetryDevice, SIGNAL(readyRead()), reader, SLOT(read()));
-        // start the reader thread
-        m_telemetryReaderThread.start();
-    } else {
-        // Connect IO device to reader
-        connect(m_telemetryDevice, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
+    foreach(UAVTalkFrameLogger * logger, m_frameLoggers) {
+        m_uavTalk->addFrameLogger(logger);
+    }
+    m_frameLoggerLock.unlock();
+
+    // Serve the link to other GCS instances if asked to
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+    if (settings && settings->useTelemetryRelay()) {
+        m_relay = new TelemetryRelay();
+        if (m_relay->listen()) {
+            m_uavTalk->addFrameLogger(m_relay);
+        } else {
+            delete m_relay;
+            m_relay = NULL;
+        }
     }
+    // The manager lives on its own thread (see the constructor), so reading and decoding the
+    // link, the transaction timeouts and the periodic updates all run there. The gadgets get
+    // the object updates through queued connections, or coalesced per display frame with
+    // UAVObjectManager::subscribeFrameUpdates().
+    connect(m_telemetryDevice, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
 
     m_telemetry = new Telemetry(m_uavTalk, m_uavobjectManager);
+    // A serial link (to a modem or a radio) is also needed for the acks and requests, the unacked
+    // updates get half of it. The property is read so that the plugin does not depend on QtSerialPort.
+    QVariant baudRate = m_telemetryDevice->property("baudRate");
+    if (baudRate.isValid() && baudRate.toInt() > 0) {
+        m_telemetry->setTxRateLimit(baudRate.toInt() / 10 / 2);
+    }
     m_telemetryMonitor = new TelemetryMonitor(m_uavobjectManager, m_telemetry);
 
     connect(m_telemetryMonitor, SIGNAL(connected()), this, SLOT(onConnect()));
@@ -109,11 +147,6 @@ void TelemetryManager::stop()
     m_connectionState = TELEMETRY_DISCONNECTING;
     emit disconnecting();
     emit myStop();
-
-    if (false) {
-        m_telemetryReaderThread.quit();
-        m_telemetryReaderThread.wait();
-    }
 }
 
 void TelemetryManager::onStop()
@@ -121,7 +154,13 @@ void TelemetryManager::onStop()
     m_telemetryMonitor->disconnect(this);
     delete m_telemetryMonitor;
     delete m_telemetry;
+    m_frameLoggerLock.lock();
     delete m_uavTalk;
+    m_uavTalk = NULL;
+    m_frameLoggerLock.unlock();
+    // UAVTalk is gone, nothing calls the relay anymore
+    delete m_relay;
+    m_relay = NULL;
     onDisconnect();
 }
 
@@ -141,11 +180,3 @@ void TelemetryManager::onTelemetryUpdate(double txRate, double rxRate)
 {
     emit telemetryUpdated(txRate, rxRate);
 }
-
-IODeviceReader::IODeviceReader(UAVTalk *uavTalk) : m_uavTalk(uavTalk)
-{}
-
-void IODeviceReader::read()
-{
-    m_uavTalk->processInputStream();
-}
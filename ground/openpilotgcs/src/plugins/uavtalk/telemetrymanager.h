@@ -33,9 +33,11 @@
 #include "uavobjectmanager.h"
 #include <QIODevice>
 #include <QObject>
+#include <QMutex>
 
 class Telemetry;
 class TelemetryMonitor;
+class TelemetryRelay;
 
 class UAVTALK_EXPORT TelemetryManager : public QObject {
     Q_OBJECT
@@ -48,14 +50,24 @@ public:
         TELEMETRY_CONNECTING
     };
 
-    TelemetryManager();
+    // objMngr and thread default to the global object manager and the real time thread
+    TelemetryManager(UAVObjectManager *objMngr = 0, QThread *thread = 0);
     ~TelemetryManager();
 
+    UAVObjectManager *objectManager() const
+    {
+        return m_uavobjectManager;
+    }
+
     void start(QIODevice *dev);
     void stop();
     bool isConnected() const;
     ConnectionState connectionState() const;
 
+    // the logger gets the frames of this connection and of the next ones, until it is removed
+    void addFrameLogger(UAVTalkFrameLogger *logger);
+    void removeFrameLogger(UAVTalkFrameLogger *logger);
+
 signals:
     void connecting();
     void connected();
@@ -79,19 +91,12 @@ private:
     TelemetryMonitor *m_telemetryMonitor;
     QIODevice *m_telemetryDevice;
     ConnectionState m_connectionState;
-    QThread m_telemetryReaderThread;
-};
-
-
-class IODeviceReader : public QObject {
-    Q_OBJECT
-public:
-    IODeviceReader(UAVTalk *uavTalk);
+    TelemetryRelay *m_relay;
 
-    UAVTalk *m_uavTalk;
-
-public slots:
-    void read();
+    // guards m_uavTalk against onStart()/onStop() for addFrameLogger() and removeFrameLogger()
+    QMutex m_frameLoggerLock;
+    QList<UAVTalkFrameLogger *> m_frameLoggers;
 };
 
+
 #endif // TELEMETRYMANAGER_H
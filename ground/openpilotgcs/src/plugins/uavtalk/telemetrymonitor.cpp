@@ -28,6 +28,7 @@
 #include "telemetrymonitor.h"
 #include "coreplugin/connectionmanager.h"
 #include "coreplugin/icore.h"
+#include "utils/crc.h"
 
 /**
  * Constructor
@@ -38,14 +39,20 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
     gcsStatsObj(GCSTelemetryStats::GetInstance(objMngr)),
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
+    objectDataCRCObj(ObjectDataCRC::GetInstance(objMngr)),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
+    retrievalWindow(DEFAULT_RETRIEVAL_WINDOW),
     mutex(new QMutex(QMutex::Recursive)),
     connectionTimer(new QTime())
 {
     // Listen for flight stats updates
     connect(flightStatsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(flightStatsUpdated(UAVObject *)));
 
+    // The board answers a list of objects with the CRCs of their data
+    connect(objectDataCRCObj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(objectDataCRCReceived(UAVObject *)));
+    crcTimer.setSingleShot(true);
+    connect(&crcTimer, SIGNAL(timeout()), this, SLOT(objectDataCRCTimeout()));
+
     // Start update timer
     connect(statsTimer, SIGNAL(timeout()), this, SLOT(processStatsUpdates()));
     statsTimer->start(STATS_CONNECT_PERIOD_MS);
@@ -61,13 +68,32 @@ TelemetryMonitor::~TelemetryMonitor()
     gcsStatsObj->setData(gcsStats);
 }
 
+/**
+ * Set the maximum number of object requests outstanding during object retrieval
+ */
+void TelemetryMonitor::setRetrievalWindow(int window)
+{
+    QMutexLocker locker(mutex);
+
+    retrievalWindow = qMax(1, window);
+}
+
 /**
  * Initiate object retrieval, initialize queue with objects to be retrieved.
+ * Settings are queued first so that the configuration pages become usable as soon as possible,
+ * followed by the metaobjects and the data objects with OnChange update mode.
+ * The data CRCs of the objects are first asked from the board, the objects the GCS already
+ * holds the same data of, from a previous connection, are not retrieved again.
  */
 void TelemetryMonitor::startRetrievingObjects()
 {
     // Clear object queue
     queue.clear();
+    objsPending.clear();
+    crcQueue.clear();
+    crcPending.clear();
+    QList<UAVObject *> metaObjs;
+    QList<UAVObject *> dataObjs;
     // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
     QList< QList<UAVObject *> > objs = objMngr->getObjects();
     for (int n = 0; n < objs.length(); ++n) {
@@ -76,21 +102,130 @@ void TelemetryMonitor::startRetrievingObjects()
         UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
         UAVObject::Metadata mdata = obj->getMetadata();
         if (mobj != NULL) {
-            queue.enqueue(obj);
+            metaObjs.append(obj);
         } else if (dobj != NULL) {
             if (dobj->isSettingsObject()) {
-                queue.enqueue(obj);
-            } else {
+                crcQueue.enqueue(obj);
+            } else if (obj != objectDataCRCObj) {
                 if (UAVObject::GetFlightTelemetryUpdateMode(mdata) == UAVObject::UPDATEMODE_ONCHANGE) {
-                    queue.enqueue(obj);
+                    dataObjs.append(obj);
                 }
             }
         }
     }
+    crcQueue.append(metaObjs);
+    crcQueue.append(dataObjs);
     // Start retrieving
     qDebug() << tr("Starting to retrieve meta and settings objects from the autopilot (%1 objects)")
-        .arg(queue.length());
-    retrieveNextObject();
+        .arg(crcQueue.length());
+    retrievalTimer.start();
+    requestNextObjectDataCRCs();
+    retrieveNextObjects();
+}
+
+/**
+ * Ask the board for the data CRCs of the next objects in the CRC queue
+ */
+void TelemetryMonitor::requestNextObjectDataCRCs()
+{
+    if (crcQueue.isEmpty()) {
+        return;
+    }
+
+    ObjectDataCRC::DataFields fields = objectDataCRCObj->getData();
+    for (quint32 i = 0; i < ObjectDataCRC::OBJECTID_NUMELEM; ++i) {
+        fields.ObjectID[i] = 0;
+        fields.CRC[i]      = 0;
+        if (!crcQueue.isEmpty()) {
+            UAVObject *obj = crcQueue.dequeue();
+            crcPending.append(obj);
+            fields.ObjectID[i] = obj->getObjID();
+        }
+    }
+    objectDataCRCObj->setData(fields);
+    objectDataCRCObj->updated();
+    crcTimer.start(OBJECT_DATA_CRC_TIMEOUT_MS);
+}
+
+/**
+ * Called when the board answers with the CRCs, the objects with a different CRC are queued for retrieval
+ */
+void TelemetryMonitor::objectDataCRCReceived(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+    QMutexLocker locker(mutex);
+
+    if (crcPending.isEmpty()) {
+        return;
+    }
+    crcTimer.stop();
+
+    ObjectDataCRC::DataFields fields = objectDataCRCObj->getData();
+    int skipped = 0;
+    for (int i = 0; i < crcPending.length(); ++i) {
+        UAVObject *pending = crcPending.at(i);
+        // 0 is the answer for an object unknown to the board
+        if (fields.ObjectID[i] == pending->getObjID() && fields.CRC[i] != 0 && fields.CRC[i] == objectDataCRC(pending)) {
+            foreach(UAVObject * instance, objMngr->getObjectInstances(pending->getObjID())) {
+                instance->setIsKnown(true);
+            }
+            ++skipped;
+        } else {
+            queue.enqueue(pending);
+        }
+    }
+    qDebug() << tr("%1 of %2 objects are unchanged on the autopilot").arg(skipped).arg(crcPending.length());
+    crcPending.clear();
+
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+    if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
+        requestNextObjectDataCRCs();
+        retrieveNextObjects();
+    } else {
+        stopRetrievingObjects();
+    }
+}
+
+/**
+ * An autopilot without ObjectDataCRC never answers, all the objects are retrieved then
+ */
+void TelemetryMonitor::objectDataCRCTimeout()
+{
+    QMutexLocker locker(mutex);
+
+    if (!crcPending.isEmpty()) {
+        qDebug() << tr("Timed out waiting for the object data CRCs");
+        retrieveAllObjects();
+    }
+}
+
+/**
+ * Give up comparing CRCs, retrieve every object still to be compared
+ */
+void TelemetryMonitor::retrieveAllObjects()
+{
+    crcTimer.stop();
+    queue.append(crcPending);
+    queue.append(crcQueue);
+    crcPending.clear();
+    crcQueue.clear();
+    retrieveNextObjects();
+}
+
+/**
+ * CRC32 of the data of all the instances of an object, as computed by the board
+ */
+quint32 TelemetryMonitor::objectDataCRC(UAVObject *obj)
+{
+    quint32 crc = 0xFFFFFFFF;
+    QByteArray data;
+
+    foreach(UAVObject * instance, objMngr->getObjectInstances(obj->getObjID())) {
+        data.resize(instance->getNumBytes());
+        instance->pack((quint8 *)data.data());
+        crc = Utils::Crc::updateCRC32(crc, (const quint8 *)data.constData(), data.size());
+    }
+    return crc;
 }
 
 /**
@@ -99,35 +234,60 @@ void TelemetryMonitor::startRetrievingObjects()
 void TelemetryMonitor::stopRetrievingObjects()
 {
     qDebug("Object retrieval has been cancelled");
+    foreach(UAVObject * obj, objsPending) {
+        obj->disconnect(this);
+    }
+    objsPending.clear();
     queue.clear();
+    crcTimer.stop();
+    crcPending.clear();
+    crcQueue.clear();
 }
 
 /**
- * Retrieve the next object in the queue
+ * Request objects from the queue until the retrieval window is full
  */
-void TelemetryMonitor::retrieveNextObject()
+void TelemetryMonitor::retrieveNextObjects()
 {
-    // If queue is empty return
-    if (queue.isEmpty()) {
-        qDebug("Object retrieval completed");
-        if (firmwareIAPObj->getBoardType()) {
-            emit connected();
+    while (!queue.isEmpty() && objsPending.size() < retrievalWindow) {
+        // Get next object from the queue
+        UAVObject *obj = queue.dequeue();
+        // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+
+        // Connect to object
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+
+        // Request update, multi instance objects are retrieved with a single all instances request
+        objsPending.insert(obj);
+        if (obj->isSingleInstance()) {
+            obj->requestUpdate();
         } else {
-            connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
+            obj->requestUpdateAll();
         }
-        return;
     }
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+    // If all the objects have been compared and retrieved we are done
+    if (queue.isEmpty() && objsPending.isEmpty() && crcQueue.isEmpty() && crcPending.isEmpty()) {
+        retrievalCompleted();
+    }
+}
+
+/**
+ * Called once all the objects have been retrieved, reports the connection time
+ */
+void TelemetryMonitor::retrievalCompleted()
+{
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
 
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    gcsStats.ConnectTime = retrievalTimer.elapsed();
+    gcsStatsObj->setData(gcsStats);
+    qDebug() << tr("Object retrieval completed in %1 ms").arg(gcsStats.ConnectTime);
 
-    // Request update
-    obj->requestUpdate();
-    objPending = obj;
+    if (firmwareIAPObj->getBoardType()) {
+        emit connected();
+    } else {
+        connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
+    }
 }
 
 /**
@@ -138,15 +298,14 @@ void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
     Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
+    if (objsPending.remove(obj)) {
         // Disconnect from sending object
         obj->disconnect(this);
-        objPending = NULL;
-        // Process next object if telemetry is still available
+        // Process next objects if telemetry is still available
         GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
 
         if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
-            retrieveNextObject();
+            retrieveNextObjects();
         } else {
             stopRetrievingObjects();
         }
@@ -203,12 +362,15 @@ void TelemetryMonitor::processStatsUpdates()
     gcsStats.TxBytes      += telStats.txBytes;
     gcsStats.TxFailures   += telStats.txErrors;
     gcsStats.TxRetries    += telStats.txRetries;
+    gcsStats.TxLatency     = telStats.txLatency;
 
     gcsStats.RxDataRate    = (float)telStats.rxBytes / ((float)statsTimer->interval() / 1000.0);
     gcsStats.RxBytes      += telStats.rxBytes;
     gcsStats.RxFailures   += telStats.rxErrors;
     gcsStats.RxSyncErrors += telStats.rxSyncErrors;
     gcsStats.RxCrcErrors  += telStats.rxCrcErrors;
+    // share of the time the telemetry thread spent on the received data, kept off the GUI thread
+    gcsStats.RxProcessingLoad = (float)telStats.rxProcessingUs / 10.0f / (float)statsTimer->interval();
 
     // Check for a connection timeout
     bool connectionTimeout;
@@ -221,6 +383,10 @@ void TelemetryMonitor::processStatsUpdates()
         connectionTimeout = false;
     }
 
+    // Let the autopilot know that object updates can be sent in bundles and as deltas
+    gcsStats.Bundling      = GCSTelemetryStats::BUNDLING_TRUE;
+    gcsStats.DeltaEncoding = GCSTelemetryStats::DELTAENCODING_TRUE;
+
     // Update connection state
     int oldStatus = gcsStats.Status;
     if (gcsStats.Status == GCSTelemetryStats::STATUS_DISCONNECTED) {
@@ -30,6 +30,7 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QSet>
 #include <QTimer>
 #include <QTime>
 #include <QMutex>
@@ -39,6 +40,7 @@
 #include "flighttelemetrystats.h"
 #include "firmwareiapobj.h"
 #include "systemstats.h"
+#include "objectdatacrc.h"
 #include "telemetry.h"
 
 class TelemetryMonitor : public QObject {
@@ -48,6 +50,12 @@ public:
     TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel);
     ~TelemetryMonitor();
 
+    int getRetrievalWindow() const
+    {
+        return retrievalWindow;
+    }
+    void setRetrievalWindow(int window);
+
 signals:
     void connected();
     void disconnected();
@@ -59,10 +67,16 @@ public slots:
     void flightStatsUpdated(UAVObject *obj);
     void firmwareIAPUpdated(UAVObject *obj);
 
+private slots:
+    void objectDataCRCReceived(UAVObject *obj);
+    void objectDataCRCTimeout();
+
 private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    static const int DEFAULT_RETRIEVAL_WINDOW = 8;
+    static const int OBJECT_DATA_CRC_TIMEOUT_MS = 1000;
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -70,13 +84,24 @@ private:
     GCSTelemetryStats *gcsStatsObj;
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
+    ObjectDataCRC *objectDataCRCObj;
+    // objects whose board data CRC is still to be compared before they are retrieved
+    QQueue<UAVObject *> crcQueue;
+    QList<UAVObject *> crcPending;
+    QTimer crcTimer;
     QTimer *statsTimer;
-    UAVObject *objPending;
+    QSet<UAVObject *> objsPending;
+    int retrievalWindow;
     QMutex *mutex;
     QTime *connectionTimer;
+    QTime retrievalTimer;
 
     void startRetrievingObjects();
-    void retrieveNextObject();
+    void retrieveNextObjects();
+    void requestNextObjectDataCRCs();
+    void retrieveAllObjects();
+    quint32 objectDataCRC(UAVObject *obj);
+    void retrievalCompleted();
     void stopRetrievingObjects();
 };
 
@@ -0,0 +1,140 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryrelay.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Relays the telemetry frames to other GCS instances
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryrelay.h"
+
+#include <QTcpSocket>
+#include <QDebug>
+
+TelemetryRelay::TelemetryRelay(QObject *parent) : QObject(parent),
+    m_server(this), m_clientCount(0), m_flushQueued(false), m_droppedBytes(0)
+{
+    connect(&m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+TelemetryRelay::~TelemetryRelay()
+{
+    foreach(const Client &client, m_clients) {
+        client.socket->disconnect(this);
+        client.socket->abort();
+        delete client.socket;
+    }
+    if (m_droppedBytes) {
+        qDebug() << "TelemetryRelay - dropped" << m_droppedBytes << "bytes while the relay was busy";
+    }
+}
+
+bool TelemetryRelay::listen(quint16 port)
+{
+    if (!m_server.listen(QHostAddress::Any, port)) {
+        qWarning() << "TelemetryRelay - could not listen on port" << port << ":" << m_server.errorString();
+        return false;
+    }
+    qDebug() << "TelemetryRelay - relaying telemetry on port" << port;
+    return true;
+}
+
+void TelemetryRelay::frame(const quint8 *data, qint32 length)
+{
+    if (m_clientCount.load() == 0) {
+        return;
+    }
+
+    QMutexLocker locker(&m_pendingLock);
+
+    if (m_pending.size() + length > MAX_PENDING_BYTES) {
+        m_droppedBytes += length;
+        return;
+    }
+    m_pending.append((const char *)data, length);
+    // one flush for all the frames queued until it runs
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+void TelemetryRelay::flush()
+{
+    QByteArray frames;
+
+    m_pendingLock.lock();
+    frames.swap(m_pending);
+    m_flushQueued = false;
+    m_pendingLock.unlock();
+
+    for (int i = 0; i < m_clients.count(); ++i) {
+        Client &client = m_clients[i];
+        // the block holds whole frames, skipping it keeps the client stream in sync
+        if (client.socket->bytesToWrite() > MAX_CLIENT_BACKLOG) {
+            client.droppedBytes += frames.size();
+        } else {
+            client.socket->write(frames);
+        }
+    }
+}
+
+void TelemetryRelay::newConnection()
+{
+    while (m_server.hasPendingConnections()) {
+        Client client;
+        client.socket = m_server.nextPendingConnection();
+        client.droppedBytes = 0;
+        client.socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(client.socket, SIGNAL(readyRead()), this, SLOT(clientReadyRead()));
+        connect(client.socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        m_clients.append(client);
+        m_clientCount.store(m_clients.count());
+        qDebug() << "TelemetryRelay - client connected from" << client.socket->peerAddress().toString();
+    }
+}
+
+void TelemetryRelay::clientReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    // the clients are read only, what they send never reaches the link
+    if (socket) {
+        socket->readAll();
+    }
+}
+
+void TelemetryRelay::clientDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    for (int i = 0; i < m_clients.count(); ++i) {
+        if (m_clients.at(i).socket == socket) {
+            qDebug() << "TelemetryRelay - client disconnected from" << socket->peerAddress().toString()
+                     << "," << m_clients.at(i).droppedBytes << "bytes skipped";
+            m_clients.removeAt(i);
+            m_clientCount.store(m_clients.count());
+            socket->deleteLater();
+            break;
+        }
+    }
+}
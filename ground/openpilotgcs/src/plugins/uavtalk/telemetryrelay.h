@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryrelay.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Relays the telemetry frames to other GCS instances
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TELEMETRYRELAY_H
+#define TELEMETRYRELAY_H
+
+#include "uavtalk.h"
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QTcpServer>
+
+class QTcpSocket;
+
+// Serves the object frames of the telemetry link to read only clients, such as other GCS
+// instances with an IP connection to the relay port. frame() queues the frames in the thread
+// UAVTalk runs in, they are written to the clients from the relay thread. A client that does
+// not keep up skips whole frames rather than holding back the link.
+class TelemetryRelay : public QObject, public UAVTalkFrameLogger {
+    Q_OBJECT
+
+public:
+    static const quint16 DEFAULT_PORT = 9000;
+
+    explicit TelemetryRelay(QObject *parent = 0);
+    ~TelemetryRelay();
+
+    bool listen(quint16 port = DEFAULT_PORT);
+
+    // UAVTalkFrameLogger, called by UAVTalk with its lock held
+    void frame(const quint8 *data, qint32 length);
+
+private slots:
+    void newConnection();
+    void clientReadyRead();
+    void clientDisconnected();
+    void flush();
+
+private:
+    // frames waiting for flush(), the newer ones are dropped beyond that
+    static const int MAX_PENDING_BYTES = 256 * 1024;
+    // a client with more than that left to write skips the frames
+    static const int MAX_CLIENT_BACKLOG = 64 * 1024;
+
+    struct Client {
+        QTcpSocket *socket;
+        quint64    droppedBytes;
+    };
+
+    QTcpServer m_server;
+    QList<Client> m_clients;
+    QAtomicInt m_clientCount;
+
+    QMutex m_pendingLock;
+    QByteArray m_pending;
+    bool m_flushQueued;
+    quint64 m_droppedBytes;
+};
+
+#endif // TELEMETRYRELAY_H
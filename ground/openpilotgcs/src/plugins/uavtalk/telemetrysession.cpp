@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrysession.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Telemetry sessions with further vehicles
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetrysession.h"
+#include "uavobjectsinit.h"
+#include <extensionsystem/pluginmanager.h>
+
+#include <QDebug>
+
+TelemetrySession::TelemetrySession(const QString &name, QObject *parent) :
+    QObject(parent),
+    m_name(name)
+{
+    m_objectManager = new UAVObjectManager();
+    UAVObjectsInitialize(m_objectManager);
+
+    m_thread.setObjectName(QString("Telemetry %1").arg(name));
+    m_thread.start(QThread::TimeCriticalPriority);
+    m_telemetryManager = new TelemetryManager(m_objectManager, &m_thread);
+}
+
+TelemetrySession::~TelemetrySession()
+{
+    stop();
+    // the queued stop is handled before the thread loop exits
+    m_thread.quit();
+    m_thread.wait();
+    delete m_telemetryManager;
+    delete m_objectManager;
+}
+
+void TelemetrySession::start(QIODevice *dev)
+{
+    m_telemetryManager->start(dev);
+}
+
+void TelemetrySession::stop()
+{
+    if (m_telemetryManager->connectionState() == TelemetryManager::TELEMETRY_CONNECTING
+        || m_telemetryManager->connectionState() == TelemetryManager::TELEMETRY_CONNECTED) {
+        m_telemetryManager->stop();
+    }
+}
+
+TelemetrySessionManager::TelemetrySessionManager(QObject *parent) : QObject(parent)
+{}
+
+TelemetrySessionManager::~TelemetrySessionManager()
+{
+    while (!m_sessions.isEmpty()) {
+        removeSession(m_sessions.last());
+    }
+}
+
+TelemetrySession *TelemetrySessionManager::createSession(const QString &name)
+{
+    if (name.isEmpty() || session(name)) {
+        qDebug() << "TelemetrySessionManager - invalid or duplicate session name" << name;
+        return NULL;
+    }
+    TelemetrySession *session = new TelemetrySession(name, this);
+    m_sessions.append(session);
+    emit sessionAdded(session);
+    return session;
+}
+
+void TelemetrySessionManager::removeSession(TelemetrySession *session)
+{
+    if (!m_sessions.contains(session)) {
+        return;
+    }
+    emit sessionAboutToBeRemoved(session);
+    m_sessions.removeAll(session);
+    delete session;
+}
+
+TelemetrySession *TelemetrySessionManager::session(const QString &name) const
+{
+    foreach(TelemetrySession * session, m_sessions) {
+        if (session->name() == name) {
+            return session;
+        }
+    }
+    return NULL;
+}
+
+UAVObjectManager *TelemetrySessionManager::objectManager(const QString &sessionName) const
+{
+    if (sessionName.isEmpty()) {
+        return ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+    }
+    TelemetrySession *namedSession = session(sessionName);
+    return namedSession ? namedSession->objectManager() : NULL;
+}
@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrysession.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Telemetry sessions with further vehicles
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TELEMETRYSESSION_H
+#define TELEMETRYSESSION_H
+
+#include "uavtalk_global.h"
+#include "telemetrymanager.h"
+#include "uavobjectmanager.h"
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+
+/**
+ * The telemetry with one more vehicle. The session has its own set of
+ * UAVObjects and its own thread, where the link is read and parsed.
+ * The objects live in the GUI thread like the global ones, their updates
+ * reach the gadgets through queued connections.
+ */
+class UAVTALK_EXPORT TelemetrySession : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TelemetrySession(const QString &name, QObject *parent = 0);
+    ~TelemetrySession();
+
+    QString name() const
+    {
+        return m_name;
+    }
+    UAVObjectManager *objectManager() const
+    {
+        return m_objectManager;
+    }
+    TelemetryManager *telemetryManager() const
+    {
+        return m_telemetryManager;
+    }
+
+    // the device is moved to the session thread, it must stay open until stop()
+    void start(QIODevice *dev);
+    void stop();
+
+private:
+    QString m_name;
+    QThread m_thread;
+    UAVObjectManager *m_objectManager;
+    TelemetryManager *m_telemetryManager;
+};
+
+/**
+ * Registered in the plugin manager. The global UAVObjectManager and the
+ * connection manager link are the default session, the one with an empty name.
+ * A gadget binds to a session by looking its object manager up by name.
+ */
+class UAVTALK_EXPORT TelemetrySessionManager : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TelemetrySessionManager(QObject *parent = 0);
+    ~TelemetrySessionManager();
+
+    TelemetrySession *createSession(const QString &name);
+    void removeSession(TelemetrySession *session);
+
+    QList<TelemetrySession *> sessions() const
+    {
+        return m_sessions;
+    }
+    TelemetrySession *session(const QString &name) const;
+
+    // the object manager of the named session, the global one for an empty name
+    UAVObjectManager *objectManager(const QString &sessionName) const;
+
+signals:
+    void sessionAdded(TelemetrySession *session);
+    void sessionAboutToBeRemoved(TelemetrySession *session);
+
+private:
+    QList<TelemetrySession *> m_sessions;
+};
+
+#endif // TELEMETRYSESSION_H
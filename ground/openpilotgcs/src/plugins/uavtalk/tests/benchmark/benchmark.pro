@@ -0,0 +1,19 @@
+# Decoding and encoding throughput of UAVTalk, run against the built plugins.
+# "make benchmark" writes the results to tst_uavtalkbenchmark.xml,
+# UAVTALK_BENCHMARK_LOG names a recorded telemetry log (.opl) to decode too.
+QT += testlib widgets network
+TEMPLATE = app
+TARGET = tst_uavtalkbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../../../../openpilotgcs.pri)
+include(../../uavtalk.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/OpenPilot
+
+SOURCES += tst_uavtalkbenchmark.cpp
+
+benchmark.commands = ./$$TARGET -o $${TARGET}.xml,xml
+benchmark.depends  = $$TARGET
+QMAKE_EXTRA_TARGETS += benchmark
@@ -0,0 +1,187 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavtalkbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Throughput of the UAVTalk decoder and encoder
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "uavtalk.h"
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QFile>
+
+// The objects a flight controller streams at a high rate, in the proportions of a typical telemetry link
+static const char *const STREAM_OBJECTS[] = {
+    "AttitudeState", "AttitudeState", "AttitudeState", "AttitudeState",
+    "GyroState", "GyroState", "AccelState", "AccelState",
+    "ActuatorDesired", "ActuatorCommand", "ManualControlCommand", "FlightStatus",
+    "PositionState", "VelocityState", "GPSPositionSensor", "SystemStats"
+};
+
+static const int STREAM_FRAMES = 1000;
+
+class tst_UAVTalkBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void decodeStream();
+    void decodeStreamSmallReads();
+    void decodeRecordedLog();
+    void encodeObjects();
+
+private:
+    UAVObjectManager *m_objMngr;
+    QByteArray m_stream;
+
+    // feeds the data to a new UAVTalk in chunks of at most chunkSize bytes, as a device would deliver them
+    static void decode(UAVObjectManager *objMngr, const QByteArray &data, int chunkSize, UAVTalk::ComStats *stats);
+};
+
+void tst_UAVTalkBenchmark::initTestCase()
+{
+    m_objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(m_objMngr);
+
+    // the synthetic stream, the objects of the list in turn with their values changing
+    QByteArray data;
+    for (int n = 0; n < STREAM_FRAMES; ++n) {
+        UAVObject *obj = m_objMngr->getObject(QString(STREAM_OBJECTS[n % (int)(sizeof(STREAM_OBJECTS) / sizeof(STREAM_OBJECTS[0]))]));
+        QVERIFY(obj);
+        data.resize(obj->getNumBytes());
+        for (int i = 0; i < data.size(); ++i) {
+            data[i] = (char)(n + i);
+        }
+        QByteArray packet = UAVTalk::objectPacket(obj->getObjID(), obj->getInstID(), (const quint8 *)data.constData(), data.size());
+        QVERIFY(!packet.isEmpty());
+        m_stream += packet;
+    }
+}
+
+void tst_UAVTalkBenchmark::cleanupTestCase()
+{
+    delete m_objMngr;
+}
+
+void tst_UAVTalkBenchmark::decode(UAVObjectManager *objMngr, const QByteArray &data, int chunkSize, UAVTalk::ComStats *stats)
+{
+    QBuffer device;
+    UAVTalk talk(&device, objMngr);
+
+    device.open(QIODevice::ReadWrite);
+    for (int pos = 0; pos < data.size(); pos += chunkSize) {
+        device.buffer() = data.mid(pos, chunkSize);
+        device.seek(0);
+        // processInputStream() is the slot the device readyRead() is connected to
+        QMetaObject::invokeMethod(&talk, "processInputStream", Qt::DirectConnection);
+    }
+    *stats = talk.getStats();
+}
+
+void tst_UAVTalkBenchmark::decodeStream()
+{
+    UAVTalk::ComStats stats;
+
+    QBENCHMARK {
+        decode(m_objMngr, m_stream, 4096, &stats);
+    }
+    QCOMPARE(stats.rxObjects, (quint32)STREAM_FRAMES);
+    QCOMPARE(stats.rxErrors, (quint32)0);
+}
+
+void tst_UAVTalkBenchmark::decodeStreamSmallReads()
+{
+    UAVTalk::ComStats stats;
+
+    // a serial link delivers a few bytes per read
+    QBENCHMARK {
+        decode(m_objMngr, m_stream, 16, &stats);
+    }
+    QCOMPARE(stats.rxObjects, (quint32)STREAM_FRAMES);
+    QCOMPARE(stats.rxErrors, (quint32)0);
+}
+
+void tst_UAVTalkBenchmark::decodeRecordedLog()
+{
+    QString fileName = QString::fromLocal8Bit(qgetenv("UAVTALK_BENCHMARK_LOG"));
+
+    if (fileName.isEmpty()) {
+        QSKIP("UAVTALK_BENCHMARK_LOG does not name a recorded log");
+    }
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // records of the log file: time stamp (quint32), size (qint64) and the bytes received
+    const int header = sizeof(quint32) + sizeof(qint64);
+    QByteArray log   = file.readAll();
+    QByteArray data;
+    int pos = 0;
+    while (pos + header <= log.size()) {
+        qint64 size;
+        memcpy(&size, log.constData() + pos + sizeof(quint32), sizeof(size));
+        if (size < 0 || size > log.size() - pos - header) {
+            break;
+        }
+        data += log.mid(pos + header, size);
+        pos  += header + size;
+    }
+    QVERIFY(!data.isEmpty());
+
+    UAVTalk::ComStats stats;
+    QBENCHMARK {
+        decode(m_objMngr, data, 4096, &stats);
+    }
+    qDebug() << data.size() << "bytes," << stats.rxObjects << "objects," << stats.rxErrors << "errors";
+}
+
+void tst_UAVTalkBenchmark::encodeObjects()
+{
+    QBuffer device;
+    UAVTalk talk(&device, m_objMngr);
+    QList<UAVObject *> objects;
+
+    for (int n = 0; n < STREAM_FRAMES; ++n) {
+        objects << m_objMngr->getObject(QString(STREAM_OBJECTS[n % (int)(sizeof(STREAM_OBJECTS) / sizeof(STREAM_OBJECTS[0]))]));
+    }
+    device.open(QIODevice::ReadWrite);
+    QBENCHMARK {
+        device.seek(0);
+        foreach(UAVObject * obj, objects) {
+            talk.sendObject(obj, false, false);
+        }
+    }
+    QCOMPARE(talk.getStats().txErrors, (quint32)0);
+}
+
+QTEST_MAIN(tst_UAVTalkBenchmark)
+
+#include "tst_uavtalkbenchmark.moc"
+
+/**
+ * @}
+ * @}
+ */
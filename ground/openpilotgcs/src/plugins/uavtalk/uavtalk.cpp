@@ -25,13 +25,13 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "uavtalk.h"
-#include <extensionsystem/pluginmanager.h>
-#include <coreplugin/generalsettings.h>
 #include <utils/crc.h>
+#include <utils/logfile.h>
 
 #include <QtEndian>
 #include <QDebug>
 #include <QEventLoop>
+#include <QElapsedTimer>
 
 #ifdef VERBOSE_UAVTALK
 // uncomment and adapt the following lines to filter verbose logging to include specific object(s) only
@@ -54,20 +54,16 @@ UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMn
     rxState = STATE_SYNC;
     rxPacketLength = 0;
 
-    memset(&stats, 0, sizeof(ComStats));
+    // When replaying a log, packets are stamped with the time they were recorded
+    rxLogFile = qobject_cast<LogFile *>(iodev);
+    rxClockEpoch   = QDateTime::currentMSecsSinceEpoch();
+    rxClock.start();
+    rxSenderTimeValid = false;
+    rxLastSenderTimestamp = 0;
+    rxSenderTime   = 0;
+    rxObjTimestamp = 0;
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
-    useUDPMirror = settings->useUDPMirror();
-    qDebug() << "USE UDP:::::::::::." << useUDPMirror;
-    if (useUDPMirror) {
-        udpSocketTx = new QUdpSocket(this);
-        udpSocketRx = new QUdpSocket(this);
-        udpSocketTx->bind(9000);
-        udpSocketRx->connectToHost(QHostAddress::LocalHost, 9000);
-        connect(udpSocketTx, SIGNAL(readyRead()), this, SLOT(dummyUDPRead()));
-        connect(udpSocketRx, SIGNAL(readyRead()), this, SLOT(dummyUDPRead()));
-    }
+    memset(&stats, 0, sizeof(ComStats));
 }
 
 UAVTalk::~UAVTalk()
@@ -95,18 +91,10 @@ UAVTalk::ComStats UAVTalk::getStats()
 {
     QMutexLocker locker(&mutex);
 
-    return stats;
-}
+    // devices that measure their latency, like the USB HID one, publish it as a property
+    stats.txLatency = io ? io->property("txLatency").toUInt() : 0;
 
-void UAVTalk::dummyUDPRead()
-{
-    QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
-    QByteArray junk;
-
-    while (socket->hasPendingDatagrams()) {
-        junk.resize(socket->pendingDatagramSize());
-        socket->readDatagram(junk.data(), junk.size());
-    }
+    return stats;
 }
 
 /**
@@ -158,6 +146,50 @@ bool UAVTalk::sendObjectRequest(UAVObject *obj, bool allInstances)
     return objectTransaction(TYPE_OBJ_REQ, obj->getObjID(), instId, obj);
 }
 
+/**
+ * Frame object data without an object instance, e.g. to write a log file.
+ * \param[in] objId Object ID
+ * \param[in] instId Instance ID
+ * \param[in] data Packed object data
+ * \param[in] length Size of the data
+ * \return The complete packet, empty if the data exceeds the max payload length
+ */
+QByteArray UAVTalk::objectPacket(quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    if (length < 0 || length >= MAX_PAYLOAD_LENGTH) {
+        return QByteArray();
+    }
+    QByteArray packet(HEADER_LENGTH + length + CHECKSUM_LENGTH, 0);
+    quint8 *buffer = (quint8 *)packet.data();
+
+    buffer[0] = SYNC_VAL;
+    buffer[1] = TYPE_OBJ;
+    qToLittleEndian<quint16>(HEADER_LENGTH + length, &buffer[2]);
+    qToLittleEndian<quint32>(objId, &buffer[4]);
+    qToLittleEndian<quint16>(instId, &buffer[8]);
+    memcpy(&buffer[HEADER_LENGTH], data, length);
+    buffer[HEADER_LENGTH + length] = Crc::updateCRC(0, buffer, HEADER_LENGTH + length);
+    return packet;
+}
+
+void UAVTalk::addFrameLogger(UAVTalkFrameLogger *logger)
+{
+    // the loggers are called with the lock held
+    QMutexLocker locker(&mutex);
+
+    if (!frameLoggers.contains(logger)) {
+        frameLoggers.append(logger);
+    }
+}
+
+void UAVTalk::removeFrameLogger(UAVTalkFrameLogger *logger)
+{
+    // the lock makes sure the logger is not in use anymore when this returns
+    QMutexLocker locker(&mutex);
+
+    frameLoggers.removeAll(logger);
+}
+
 /**
  * Cancel a pending transaction
  */
@@ -208,33 +240,92 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
+    QElapsedTimer timer;
 
+    timer.start();
     if (io && io->isReadable()) {
         while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
-            } else {
-                // TODOD
+            // Pull everything the device has in one go instead of one byte per read()
+            qint64 ret = io->read((char *)rxChunk, qMin(io->bytesAvailable(), (qint64)RX_CHUNK_SIZE));
+            if (ret <= 0) {
+                break;
             }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
+            processInputBytes(rxChunk, (qint32)ret);
+        }
+    }
+    stats.rxProcessingUs += timer.nsecsElapsed() / 1000;
+}
 
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
-                }
+/**
+ * Process a block of bytes from the telemetry stream.
+ * Payload bytes are consumed as whole spans, header and checksum bytes go through
+ * the byte oriented state machine. Completed packets are handed to receiveObject().
+ * \param[in] data Received bytes
+ * \param[in] length Number of bytes in \a data
+ */
+void UAVTalk::processInputBytes(const quint8 *data, qint32 length)
+{
+    qint32 pos = 0;
+
+    while (pos < length) {
+        if (rxState == STATE_DATA) {
+            // Copy as much of the payload as is available and update the CRC over the span
+            qint32 count = qMin((qint32)(rxLength - rxCount), length - pos);
+            memcpy(&rxBuffer[rxCount], &data[pos], count);
+            rxCS = Crc::updateCRC(rxCS, &data[pos], count);
+            stats.rxBytes  += count;
+            rxPacketLength += count;
+            rxCount += count;
+            pos     += count;
+            if (rxCount >= rxLength) {
+                rxCount = 0;
+                rxState = STATE_CS;
             }
+            continue;
         }
+
+        processInputByte(data[pos++]);
+
+        if (rxState == STATE_COMPLETE) {
+            mutex.lock();
+            if (!frameLoggers.isEmpty()) {
+                logReceivedFrame();
+            }
+            rxObjTimestamp = receiveTimestamp();
+            if (receiveObject(rxType & ~TYPE_TIMESTAMPED, rxObjId, rxInstId, rxBuffer, rxLength)) {
+                stats.rxObjectBytes += rxLength;
+                stats.rxObjects++;
+            } else {
+                // TODO...
+            }
+            mutex.unlock();
+        }
+    }
+}
+
+/**
+ * Hand the frame just received to the loggers, when it carries object data.
+ * The frame is put back together from the fields the state machine parsed.
+ */
+void UAVTalk::logReceivedFrame()
+{
+    quint8 type = rxType & ~TYPE_TIMESTAMPED;
+
+    if (type != TYPE_OBJ && type != TYPE_OBJ_ACK && type != TYPE_BUNDLE && type != TYPE_OBJ_DELTA) {
+        return;
+    }
+    rxFrame[0] = SYNC_VAL;
+    rxFrame[1] = rxType;
+    qToLittleEndian<quint16>(packetSize, &rxFrame[2]);
+    qToLittleEndian<quint32>(rxObjId, &rxFrame[4]);
+    qToLittleEndian<quint16>(rxInstId, &rxFrame[8]);
+    if (rxTimestampLength > 0) {
+        qToLittleEndian<quint16>(rxSenderTimestamp, &rxFrame[HEADER_LENGTH]);
+    }
+    memcpy(&rxFrame[HEADER_LENGTH + rxTimestampLength], rxBuffer, rxLength);
+    rxFrame[packetSize] = rxCSPacket;
+    foreach(UAVTalkFrameLogger * logger, frameLoggers) {
+        logger->frame(rxFrame, packetSize + CHECKSUM_LENGTH);
     }
 }
 
@@ -247,10 +338,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 {
     if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
         rxState = STATE_SYNC;
-
-        if (useUDPMirror) {
-            rxDataArray.clear();
-        }
     }
 
     // Update stats
@@ -259,10 +346,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     // update packet byte count
     rxPacketLength++;
 
-    if (useUDPMirror) {
-        rxDataArray.append(rxbyte);
-    }
-
     // Receive state machine
     switch (rxState) {
     case STATE_SYNC:
@@ -317,7 +400,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         rxCount     = 0;
 
 
-        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + TIMESTAMP_LENGTH + MAX_PAYLOAD_LENGTH) {
             // incorrect packet size
             qWarning() << "UAVTalk - error : incorrect packet size";
             stats.rxErrors++;
@@ -362,7 +445,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
         // Search for object, if not found reset state machine
         {
             UAVObject *rxObj = objMngr->getObject(rxObjId);
-            if (rxObj == NULL && rxType != TYPE_OBJ_REQ) {
+            if (rxObj == NULL && rxType != TYPE_OBJ_REQ && rxType != TYPE_BUNDLE) {
                 qWarning() << "UAVTalk - error : unknown object" << rxObjId;
                 stats.rxErrors++;
                 rxState = STATE_ERROR;
@@ -372,11 +455,13 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             // Determine data length
             if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK) {
                 rxLength = 0;
+                rxTimestampLength = 0;
             } else {
-                if (rxObj) {
+                rxTimestampLength = (rxType & TYPE_TIMESTAMPED) ? TIMESTAMP_LENGTH : 0;
+                if (rxObj && rxType != TYPE_OBJ_DELTA) {
                     rxLength = rxObj->getNumBytes();
                 } else {
-                    rxLength = packetSize - rxPacketLength;
+                    rxLength = packetSize - rxPacketLength - rxTimestampLength;
                 }
             }
 
@@ -390,7 +475,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
 
             // Check the lengths match
-            if ((rxPacketLength + rxLength) != packetSize) {
+            if ((rxPacketLength + rxTimestampLength + rxLength) != packetSize) {
                 // packet error - mismatched packet size
                 qWarning() << "UAVTalk - error : mismatched packet size" << rxObjId;
                 stats.rxErrors++;
@@ -399,6 +484,33 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             }
         }
 
+        // If there is a timestamp get it
+        if (rxTimestampLength > 0) {
+            rxState = STATE_TIMESTAMP;
+            break;
+        }
+
+        // If there is a payload get it, otherwise receive checksum
+        if (rxLength > 0) {
+            rxState = STATE_DATA;
+        } else {
+            rxState = STATE_CS;
+        }
+        break;
+
+    case STATE_TIMESTAMP:
+
+        // Update CRC
+        rxCS = Crc::updateCRC(rxCS, rxbyte);
+
+        rxTmpBuffer[rxCount++] = rxbyte;
+        if (rxCount < rxTimestampLength) {
+            break;
+        }
+        rxCount = 0;
+
+        rxSenderTimestamp = qFromLittleEndian<quint16>(rxTmpBuffer);
+
         // If there is a payload get it, otherwise receive checksum
         if (rxLength > 0) {
             rxState = STATE_DATA;
@@ -456,6 +568,35 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     return true;
 }
 
+/**
+ * Time stamp of the packet that was just received, in ms since the epoch.
+ * During a log replay this is the time the packet was recorded. Otherwise the 16 bit
+ * sender time of timestamped packets is unwrapped and used to get jitter free intervals,
+ * falling back on a monotonic local clock.
+ */
+qint64 UAVTalk::receiveTimestamp()
+{
+    qint64 now;
+
+    if (rxLogFile) {
+        now = rxClockEpoch + rxLogFile->replayTimeStamp();
+    } else {
+        now = rxClockEpoch + rxClock.elapsed();
+    }
+    if (rxTimestampLength == 0) {
+        return now;
+    }
+    if (rxSenderTimeValid) {
+        rxSenderTime += (quint16)(rxSenderTimestamp - rxLastSenderTimestamp);
+    }
+    if (!rxSenderTimeValid || qAbs(rxSenderTime - now) > MAX_SENDER_CLOCK_DRIFT) {
+        rxSenderTime = now;
+        rxSenderTimeValid = true;
+    }
+    rxLastSenderTimestamp = rxSenderTimestamp;
+    return rxSenderTime;
+}
+
 /**
  * Receive an object. This function process objects received through the telemetry stream.
  *
@@ -584,6 +725,29 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
         }
         break;
 
+    case TYPE_OBJ_DELTA:
+        // Only the changed bytes were sent, rebuild the data from the current instance data
+        obj = objMngr->getObject(objId, instId);
+        if (obj != NULL && decodeDelta(obj, data, length, rxDeltaBuffer)) {
+            obj = updateObject(objId, instId, rxDeltaBuffer);
+#ifdef VERBOSE_UAVTALK
+            VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received object delta" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
+#endif
+            if (obj != NULL) {
+                updateAck(TYPE_OBJ, objId, instId, obj);
+            } else {
+                error = true;
+            }
+        } else {
+            error = true;
+        }
+        break;
+
+    case TYPE_BUNDLE:
+        // The instance ID of a bundle holds the number of object records
+        error = !receiveBundle(instId, data, length);
+        break;
+
     default:
         error = true;
     }
@@ -594,6 +758,77 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
     return !error;
 }
 
+/**
+ * Apply a delta encoded update to the current data of an object instance.
+ * The delta is the CRC of the complete data(1), a bitmask of the changed bytes and the changed bytes.
+ * \return Success (true), Failure (false) if the delta is malformed or does not apply to the current data
+ */
+bool UAVTalk::decodeDelta(UAVObject *obj, const quint8 *data, qint32 length, quint8 *dataOut)
+{
+    qint32 numBytes   = obj->getNumBytes();
+    qint32 maskLength = (numBytes + 7) / 8;
+
+    if (numBytes > MAX_PAYLOAD_LENGTH || length < 1 + maskLength) {
+        return false;
+    }
+
+    obj->getDataSnapshot(dataOut);
+
+    const quint8 *mask = &data[1];
+    qint32 pos = 1 + maskLength;
+    for (qint32 n = 0; n < numBytes; ++n) {
+        if (mask[n / 8] & (1 << (n % 8))) {
+            if (pos >= length) {
+                return false;
+            }
+            dataOut[n] = data[pos++];
+        }
+    }
+
+    // A mismatch means an update was lost, wait for the next full update
+    return pos == length && Crc::updateCRC(0, dataOut, numBytes) == data[0];
+}
+
+/**
+ * Unpack the object updates carried by a bundle.
+ * Each record is the object ID(4), instance ID(2) and data length(1) followed by the object data.
+ * Records for unknown objects or with a mismatched length are skipped.
+ * \return Success (true), Failure (false) if the bundle is malformed
+ */
+bool UAVTalk::receiveBundle(quint16 count, quint8 *data, qint32 length)
+{
+    qint32 pos = 0;
+
+    for (int n = 0; n < count; ++n) {
+        if (pos + BUNDLE_RECORD_HEADER_LENGTH > length) {
+            return false;
+        }
+        quint32 objId     = qFromLittleEndian<quint32>(&data[pos]);
+        quint16 instId    = qFromLittleEndian<quint16>(&data[pos + 4]);
+        qint32 dataLength = data[pos + 6];
+        pos += BUNDLE_RECORD_HEADER_LENGTH;
+        if (pos + dataLength > length) {
+            return false;
+        }
+
+        UAVObject *obj = objMngr->getObject(objId);
+        if (obj != NULL && (qint32)obj->getNumBytes() == dataLength) {
+            obj = updateObject(objId, instId, &data[pos]);
+#ifdef VERBOSE_UAVTALK
+            VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received bundled object" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
+#endif
+            if (obj != NULL) {
+                // Bundled objects ack pending OBJ_REQ messages like plain OBJ messages
+                updateAck(TYPE_OBJ, objId, instId, obj);
+            }
+        } else {
+            qWarning() << "UAVTalk - error : skipping unknown or mismatched bundled object" << objId;
+        }
+        pos += dataLength;
+    }
+    return pos == length;
+}
+
 /**
  * Update the data of an object from a byte array (unpack).
  * If the object instance could not be found in the list, then a
@@ -623,10 +858,12 @@ UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
             qWarning() << "UAVTalk - failed to register object " << instObj->toStringBrief();
             return NULL;
         }
+        instObj->setTimestamp(rxObjTimestamp);
         instObj->unpack(data);
         return instObj;
     } else {
         // Unpack data into object instance
+        obj->setTimestamp(rxObjTimestamp);
         obj->unpack(data);
         return obj;
     }
@@ -789,8 +1026,10 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     if (!io.isNull() && io->isWritable()) {
         if (io->bytesToWrite() < TX_BUFFER_SIZE) {
             io->write((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
-            if (useUDPMirror) {
-                udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
+            if (length > 0) {
+                foreach(UAVTalkFrameLogger * logger, frameLoggers) {
+                    logger->frame(txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
+                }
             }
         } else {
             qWarning() << "UAVTalk - error transmitting : io device full";
@@ -896,6 +1135,16 @@ const char *UAVTalk::typeToString(quint8 type)
     case TYPE_NACK:
         return "nack";
 
+        break;
+
+    case TYPE_BUNDLE:
+        return "bundle";
+
+        break;
+
+    case TYPE_OBJ_DELTA:
+        return "object delta";
+
         break;
     }
     return "<error>";
@@ -36,12 +36,23 @@
 #include <QMutexLocker>
 #include <QMap>
 #include <QThread>
-#include <QtNetwork/QUdpSocket>
+#include <QElapsedTimer>
+
+class LogFile;
+
+/**
+ * Gets the object frames UAVTalk sends and receives, as they are on the wire.
+ * frame() is called from the UAVTalk threads with the UAVTalk lock held, it must not block.
+ */
+class UAVTALK_EXPORT UAVTalkFrameLogger {
+public:
+    virtual ~UAVTalkFrameLogger() {}
+    virtual void frame(const quint8 *data, qint32 length) = 0;
+};
 
 class UAVTALK_EXPORT UAVTalk : public QObject {
     Q_OBJECT
 
-    friend class IODeviceReader;
 
 public:
     static const quint16 ALL_INSTANCES = 0xFFFF;
@@ -58,6 +69,12 @@ public:
         quint32 rxErrors;
         quint32 rxSyncErrors;
         quint32 rxCrcErrors;
+
+        // mean time the device takes to accept a write in us, if it measures it
+        quint32 txLatency;
+
+        // time spent reading and decoding the received data, in us
+        quint32 rxProcessingUs;
     } ComStats;
 
     UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr);
@@ -70,12 +87,18 @@ public:
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
 
+    // the packet sendObject() would send for this data, empty if it does not fit in one
+    static QByteArray objectPacket(quint32 objId, quint16 instId, const quint8 *data, int length);
+
+    // may be called from any thread, the logger is not in use anymore once removeFrameLogger() returns
+    void addFrameLogger(UAVTalkFrameLogger *logger);
+    void removeFrameLogger(UAVTalkFrameLogger *logger);
+
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
 
 private slots:
     void processInputStream();
-    void dummyUDPRead();
 
 private:
 
@@ -86,28 +109,42 @@ private:
     } Transaction;
 
     // Constants
-    static const int TYPE_MASK     = 0xF8;
+    static const int TYPE_MASK     = 0x78;
     static const int TYPE_VER      = 0x20;
+    static const int TYPE_TIMESTAMPED = 0x80;
     static const int TYPE_OBJ      = (TYPE_VER | 0x00);
     static const int TYPE_OBJ_REQ  = (TYPE_VER | 0x01);
     static const int TYPE_OBJ_ACK  = (TYPE_VER | 0x02);
     static const int TYPE_ACK      = (TYPE_VER | 0x03);
     static const int TYPE_NACK     = (TYPE_VER | 0x04);
+    static const int TYPE_BUNDLE   = (TYPE_VER | 0x05);
+    static const int TYPE_OBJ_DELTA = (TYPE_VER | 0x06);
+
+    // bundle record header : object ID(4), instance ID(2), length(1)
+    static const int BUNDLE_RECORD_HEADER_LENGTH = 7;
 
     // header : sync(1), type (1), size(2), object ID(4), instance ID(2)
     static const int HEADER_LENGTH = 10;
 
+    // timestamped packets carry the 16 bit sender time (ms) after the header
+    static const int TIMESTAMP_LENGTH = 2;
+
     static const int MAX_PAYLOAD_LENGTH = 256;
 
     static const int CHECKSUM_LENGTH    = 1;
 
-    static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
+    static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + TIMESTAMP_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
+
+    // resynchronize the sender clock when it drifts this much (ms) from the local clock
+    static const int MAX_SENDER_CLOCK_DRIFT = 1000;
 
     static const int TX_BUFFER_SIZE     = 2 * 1024;
 
+    static const int RX_CHUNK_SIZE      = 4 * 1024;
+
     // Types
     typedef enum {
-        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
+        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_TIMESTAMP, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
     } RxStateType;
 
     // Variables
@@ -122,9 +159,17 @@ private:
     QMap<quint32, QMap<quint32, Transaction *> *> transMap;
 
     quint8 rxBuffer[MAX_PACKET_LENGTH];
+    quint8 rxDeltaBuffer[MAX_PAYLOAD_LENGTH];
 
     quint8 txBuffer[MAX_PACKET_LENGTH];
 
+    // Received frame rebuilt for the frame logger
+    quint8 rxFrame[MAX_PACKET_LENGTH];
+    QList<UAVTalkFrameLogger *> frameLoggers;
+
+    // Block read from the IO device, parsed in place
+    quint8 rxChunk[RX_CHUNK_SIZE];
+
     // Variables used by the receive state machine
     // state machine variables
     qint32 rxCount;
@@ -135,21 +180,32 @@ private:
     quint8 rxType;
     quint32 rxObjId;
     quint16 rxInstId;
+    quint16 rxTimestampLength;
+    quint16 rxSenderTimestamp;
     quint16 rxLength;
     quint16 rxPacketLength;
     quint8 rxCSPacket;
     quint8 rxCS;
 
-    bool useUDPMirror;
-    QUdpSocket *udpSocketTx;
-    QUdpSocket *udpSocketRx;
-    QByteArray rxDataArray;
+    // Receive time stamping, in ms since the epoch
+    QElapsedTimer rxClock;
+    qint64 rxClockEpoch;
+    LogFile *rxLogFile;
+    bool rxSenderTimeValid;
+    quint16 rxLastSenderTimestamp;
+    qint64 rxSenderTime;
+    qint64 rxObjTimestamp;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
+    void processInputBytes(const quint8 *data, qint32 length);
     bool processInputByte(quint8 rxbyte);
+    void logReceivedFrame();
+    qint64 receiveTimestamp();
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
+    bool receiveBundle(quint16 count, quint8 *data, qint32 length);
+    bool decodeDelta(UAVObject *obj, const quint8 *data, qint32 length, quint8 *dataOut);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     void updateNack(quint32 objId, quint16 instId, UAVObject *obj);
     bool transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
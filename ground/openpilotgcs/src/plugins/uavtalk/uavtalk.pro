@@ -16,6 +16,8 @@ HEADERS += \
     uavtalkplugin.h \
     telemetrymonitor.h \
     telemetrymanager.h \
+    telemetryrelay.h \
+    telemetrysession.h \
     uavtalk_global.h \
     telemetry.h
 
@@ -24,6 +26,8 @@ SOURCES += \
     uavtalkplugin.cpp \
     telemetrymonitor.cpp \
     telemetrymanager.cpp \
+    telemetryrelay.cpp \
+    telemetrysession.cpp \
     telemetry.cpp
 
 OTHER_FILES += UAVTalk.pluginspec
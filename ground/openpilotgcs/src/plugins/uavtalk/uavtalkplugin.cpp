@@ -53,6 +53,9 @@ bool UAVTalkPlugin::initialize(const QStringList & arguments, QString *errorStri
     telMngr = new TelemetryManager();
     addAutoReleasedObject(telMngr);
 
+    // Further vehicles are talked to through sessions of their own
+    addAutoReleasedObject(new TelemetrySessionManager());
+
     // Connect to connection manager so we get notified when the user connect to his device
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
     QObject::connect(cm, SIGNAL(deviceConnected(QIODevice *)),
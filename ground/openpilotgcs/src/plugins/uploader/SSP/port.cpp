@@ -71,6 +71,11 @@ void port::pfSerialWrite(uint8_t c)
     sport->write(cc, 1);
 }
 
+void port::pfSerialWrite(const uint8_t *buf, uint16_t length)
+{
+    sport->write((const char *)buf, length);
+}
+
 uint32_t port::pfGetTime(void)
 {
     return timer.elapsed();
@@ -111,6 +111,30 @@ static const uint16_t CRC_TABLE[] = {
     0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
 };
 
+// CRC_TABLE[i] followed by one, two and three zero bytes, lets sf_crc16_block()
+// fold four data bytes per table round (slice-by-4)
+static uint16_t CRC_SLICE_TABLE[3][256];
+
+static void sf_init_crc_slices()
+{
+    static bool initialized = false;
+
+    if (initialized) {
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        uint16_t crc = CRC_TABLE[i];
+        for (int k = 0; k < 3; k++) {
+            crc = (crc >> 8) ^ CRC_TABLE[crc & 0x00FF];
+            CRC_SLICE_TABLE[k][i] = crc;
+        }
+    }
+    initialized = true;
+}
+
+// largest packet on the wire: SYNC, then length, seq. no., data and CRC all escaped
+#define MAX_FRAME_LENGTH (1 + 2 * (255 + 3))
+
 /** EXTERNAL DATA **/
 
 /** EXTERNAL FUNCTIONS **/
@@ -407,13 +431,19 @@ uint16_t qssp::ssp_Synchronise()
 void qssp::sf_SendPacket()
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = thisport->txBuf[LENGTH] + 3;
+
+    uint8_t frame[MAX_FRAME_LENGTH];
+    uint16_t frameLen = 0;
 
-    // use the raw serial write function so the SYNC byte does not get 'escaped'
-    thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport->txBuf[x]);
+    // the SYNC byte is not 'escaped', everything after it is. The whole frame
+    // goes out in one write, a write per byte costs a system call each on
+    // an unbuffered port
+    frame[frameLen++] = SYNC;
+    for (uint16_t x = 0; x < packetLen; x++) {
+        frameLen += sf_escape_byte(thisport->txBuf[x], &frame[frameLen]);
     }
+    thisport->pfSerialWrite(frame, frameLen);
     thisport->retryCount++;
 }
 
@@ -438,19 +468,16 @@ void qssp::sf_MakePacket(uint8_t *txBuf, const uint8_t *pdata, uint16_t length,
 {
     uint16_t crc    = 0xffff;
     uint16_t bufPos = 0;
-    uint8_t b;
 
     // add 1 for the seq. number
     txBuf[LENGTH] = length + 1;
     txBuf[SEQNUM] = seqNo;
-    crc    = sf_crc16(crc, seqNo);
-
-    length = length + 2; // add two for the length and seqno bytes which are added before the loop.
-    for (bufPos = 2; bufPos < length; bufPos++) {
-        b   = *pdata++;
-        txBuf[bufPos] = b;
-        crc = sf_crc16(crc, b); // update CRC value
+    if (length > 0) {
+        memcpy(&txBuf[DATA], pdata, length);
     }
+    // the CRC covers the seq. no. and the data
+    crc    = sf_crc16_block(crc, &txBuf[SEQNUM], length + 1);
+    bufPos = length + 2;
     txBuf[bufPos++] = LOWERBYTE(crc);
     txBuf[bufPos]   = UPPERBYTE(crc);
 }
@@ -479,25 +506,27 @@ void qssp::sf_SendAckPacket(uint8_t seqNumber)
 }
 
 /*!
- * \brief   writes a byte out the output channel. Adds escape byte where needed
- * \param   thisport = which port to use
+ * \brief   escapes a byte for the output channel
  * \param	c = byte to send
- * \return  none.
+ * \param	out = where to store the one or two bytes to send
+ * \return  number of bytes stored in out
  *
  * \note
  *
  */
-void qssp::sf_write_byte(uint8_t c)
+uint16_t qssp::sf_escape_byte(uint8_t c, uint8_t *out)
 {
     if (c == SYNC) { // check for SYNC byte
-        thisport->pfSerialWrite(ESC); // since we are not starting a packet we must ESCAPE the SYNCH byte
-        thisport->pfSerialWrite(ESC_SYNC); // now send the escaped synch char
+        out[0] = ESC; // since we are not starting a packet we must ESCAPE the SYNCH byte
+        out[1] = ESC_SYNC; // now send the escaped synch char
+        return 2;
     } else if (c == ESC) { // Check for ESC character
-        thisport->pfSerialWrite(ESC); // if it is, we need to send it twice
-        thisport->pfSerialWrite(ESC);
-    } else {
-        thisport->pfSerialWrite(c); // otherwise write the byte to serial port
+        out[0] = ESC; // if it is, we need to send it twice
+        out[1] = ESC;
+        return 2;
     }
+    out[0] = c; // otherwise send the byte as is
+    return 1;
 }
 
 /************************************************************************************************************
@@ -526,6 +555,32 @@ uint16_t qssp::sf_crc16(uint16_t crc, uint8_t data)
     return (crc >> 8) ^ CRC_TABLE[(crc ^ data) & 0x00FF];
 }
 
+/*!
+ * \brief   calculates the new CRC value for a block of data
+ * \param   crc = current CRC value
+ * \param	data = bytes to add
+ * \param	length = number of bytes
+ * \return  updated CRC value, the same as calling sf_crc16() for each byte
+ *
+ * \note
+ *
+ */
+
+uint16_t qssp::sf_crc16_block(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    while (length >= 4) {
+        crc   ^= MAKEWORD16(data[1], data[0]);
+        crc    = CRC_SLICE_TABLE[2][LOWERBYTE(crc)] ^ CRC_SLICE_TABLE[1][UPPERBYTE(crc)] ^
+                 CRC_SLICE_TABLE[0][data[2]] ^ CRC_TABLE[data[3]];
+        data  += 4;
+        length -= 4;
+    }
+    while (length--) {
+        crc = sf_crc16(crc, *data++);
+    }
+    return crc;
+}
+
 
 /*!
  * \brief   sets the timeout for the given packet
@@ -787,6 +842,7 @@ int16_t qssp::sf_ReceivePacket()
 }
 qssp::qssp(port *info, bool debug) : debug(debug)
 {
+    sf_init_crc_slices();
     thisport = info;
     thisport->maxRetryCount = info->max_retry;
     thisport->timeoutLen    = info->timeoutLen;
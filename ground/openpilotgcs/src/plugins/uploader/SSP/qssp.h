@@ -86,7 +86,8 @@ private:
     /** PRIVATE FUNCTIONS **/
     // static void      sf_SendSynchPacket( Port_t *thisport );
     uint16_t sf_crc16(uint16_t crc, uint8_t data);
-    void        sf_write_byte(uint8_t c);
+    uint16_t sf_crc16_block(uint16_t crc, const uint8_t *data, uint16_t length);
+    uint16_t sf_escape_byte(uint8_t c, uint8_t *out);
     void        sf_SetSendTimeout();
     uint16_t sf_CheckTimeout();
     int16_t     sf_DecodeState(uint8_t c);
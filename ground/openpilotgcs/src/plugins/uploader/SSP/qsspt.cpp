@@ -26,7 +26,7 @@
  */
 #include "qsspt.h"
 
-qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false), debug(debug)
+qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false), sendfinished(false), debug(debug)
 {}
 
 void qsspt::run()
@@ -34,16 +34,22 @@ void qsspt::run()
     while (!endthread) {
         receivestatus = this->ssp_ReceiveProcess();
         sendstatus    = this->ssp_SendProcess();
-        msleep(1);
+        if (sendstatus == SSP_TX_ACKED || sendstatus == SSP_TX_TIMEOUT) {
+            msendwait.lock();
+            sendfinished = true;
+            sendwait.wakeAll();
+            msendwait.unlock();
+        }
         sendbufmutex.lock();
         if (datapending && receivestatus == SSP_TX_IDLE) {
             this->ssp_SendData(mbuf, msize);
             datapending = false;
+        } else if (!datapending && receivestatus != SSP_RX_COMPLETE) {
+            // nothing to do right now, poll the port again in a ms unless
+            // sendData() hands over a packet first
+            datawait.wait(&sendbufmutex, 1);
         }
         sendbufmutex.unlock();
-        if (sendstatus == SSP_TX_ACKED) {
-            sendwait.wakeAll();
-        }
     }
 }
 bool qsspt::sendData(uint8_t *buf, uint16_t size)
@@ -51,13 +57,20 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
     if (datapending) {
         return false;
     }
+    // hold msendwait from before the packet is handed over, so an ack that
+    // arrives quickly cannot be signalled before we wait for it. Giving up
+    // after the retries also ends the wait, instead of sleeping out the 10 s
+    msendwait.lock();
+    sendfinished = false;
     sendbufmutex.lock();
     datapending = true;
     mbuf  = buf;
     msize = size;
+    datawait.wakeAll();
     sendbufmutex.unlock();
-    msendwait.lock();
-    sendwait.wait(&msendwait, 10000);
+    while (!sendfinished && sendwait.wait(&msendwait, 10000)) {
+        ;
+    }
     msendwait.unlock();
     return true;
 }
@@ -49,9 +49,11 @@ private:
     QMutex sendbufmutex;
     bool endthread;
     bool datapending;
+    bool sendfinished;
     uint16_t sendstatus;
     uint16_t receivestatus;
     QWaitCondition sendwait;
+    QWaitCondition datawait;
     QMutex msendwait;
     bool debug;
 };
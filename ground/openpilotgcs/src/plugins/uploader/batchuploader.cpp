@@ -0,0 +1,310 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchuploader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief Flashes every board found in the bootloader at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "batchuploader.h"
+
+#include <coreplugin/icore.h>
+#include <coreplugin/connectionmanager.h>
+
+#include <QFile>
+#include <QFileDialog>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QDebug>
+
+using namespace OP_DFU;
+
+BatchUploader::BatchUploader(QObject *parent) : QObject(parent),
+    m_size(0), m_running(0), m_succeeded(0), m_failed(0)
+{}
+
+BatchUploader::~BatchUploader()
+{
+    clear();
+}
+
+QStringList BatchUploader::bootloaderBoards()
+{
+    QStringList serials;
+
+    foreach(const USBPortInfo &info, USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader)) {
+        // without a serial number the boards cannot be told apart
+        if (!info.serialNumber.isEmpty() && !serials.contains(info.serialNumber)) {
+            serials << info.serialNumber;
+        }
+    }
+    return serials;
+}
+
+bool BatchUploader::start(const QString &filename, bool verify)
+{
+    if (m_running) {
+        return false;
+    }
+    clear();
+    m_succeeded = 0;
+    m_failed    = 0;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit finished(0, 0);
+        return false;
+    }
+    QByteArray firmware = file.readAll();
+    m_size = firmware.size();
+    // packaged firmware ends with its description
+    m_description = filename.endsWith(".opfw") ? firmware.right(100) : QByteArray();
+
+    Core::ICore::instance()->connectionManager()->suspendPolling();
+
+    foreach(const QString &serial, bootloaderBoards()) {
+        int index = m_boards.count();
+        Board board;
+
+        board.serial = serial;
+        board.dfu    = new DFUObject(false, false, serial);
+        m_boards.append(board);
+        emit boardAdded(index, serial);
+
+        DFUObject *dfu = board.dfu;
+        if (!dfu->ready()) {
+            boardDone(index, false, tr("Could not open the board"));
+            continue;
+        }
+        dfu->AbortOperation();
+        if (!dfu->enterDFU(0) || !dfu->findDevices() || dfu->numberOfDevices < 1) {
+            boardDone(index, false, tr("Could not enter DFU mode"));
+            continue;
+        }
+        if (!dfu->devices[0].Writable || m_size > dfu->devices[0].SizeOfCode) {
+            boardDone(index, false, tr("The firmware does not fit this board"));
+            continue;
+        }
+
+        connect(dfu, SIGNAL(progressUpdated(int)), this, SLOT(progressUpdated(int)));
+        connect(dfu, SIGNAL(uploadFinished(OP_DFU::Status)), this, SLOT(uploadFinished(OP_DFU::Status)));
+        m_boards[index].timer.start();
+        if (!dfu->UploadFirmware(filename, verify, 0)) {
+            boardDone(index, false, tr("Could not start upload"));
+            continue;
+        }
+        ++m_running;
+    }
+
+    if (!m_running) {
+        finish();
+        return false;
+    }
+    return true;
+}
+
+void BatchUploader::progressUpdated(int percent)
+{
+    int index = boardIndex(sender());
+
+    if (index < 0) {
+        return;
+    }
+    qint64 elapsed = m_boards.at(index).timer.elapsed();
+    double bytesPerSecond = elapsed > 0 ? (m_size * percent / 100) * 1000.0 / elapsed : 0;
+    emit boardProgress(index, percent, bytesPerSecond);
+}
+
+void BatchUploader::uploadFinished(OP_DFU::Status status)
+{
+    int index = boardIndex(sender());
+
+    if (index < 0) {
+        return;
+    }
+    DFUObject *dfu = m_boards.at(index).dfu;
+    qint64 elapsed = m_boards.at(index).timer.elapsed();
+
+    if (status != OP_DFU::Last_operation_Success) {
+        boardDone(index, false, tr("Upload failed: %1").arg(dfu->StatusToString(status)));
+    } else if (!m_description.isEmpty() && dfu->UploadDescription(m_description) != OP_DFU::Last_operation_Success) {
+        boardDone(index, false, tr("Could not upload the firmware description"));
+    } else {
+        dfu->JumpToApp(false, false);
+        boardDone(index, true, tr("Flashed in %1 s").arg(elapsed / 1000.0, 0, 'f', 1));
+    }
+
+    if (--m_running == 0) {
+        finish();
+    }
+}
+
+int BatchUploader::boardIndex(QObject *dfu) const
+{
+    for (int i = 0; i < m_boards.count(); ++i) {
+        if (m_boards.at(i).dfu == dfu) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BatchUploader::boardDone(int index, bool success, const QString &status)
+{
+    if (success) {
+        ++m_succeeded;
+    } else {
+        ++m_failed;
+    }
+    qDebug() << "BatchUploader - board" << m_boards.at(index).serial << status;
+    emit boardFinished(index, success, status);
+}
+
+void BatchUploader::finish()
+{
+    clear();
+    Core::ICore::instance()->connectionManager()->resumePolling();
+    emit finished(m_succeeded, m_failed);
+}
+
+void BatchUploader::clear()
+{
+    foreach(const Board &board, m_boards) {
+        // uploadFinished is the last thing the thread does, let it return
+        board.dfu->wait();
+        delete board.dfu;
+    }
+    m_boards.clear();
+}
+
+BatchUploadDialog::BatchUploadDialog(QWidget *parent) : QDialog(parent),
+    m_file(new QLineEdit(this)), m_verify(new QCheckBox(tr("Verify"), this)), m_table(new QTableWidget(0, 4, this)),
+    m_startButton(new QPushButton(tr("Flash all boards"), this))
+{
+    setWindowTitle(tr("Flash all boards in the bootloader"));
+
+    QPushButton *browseButton = new QPushButton(tr("Browse..."), this);
+    QHBoxLayout *fileLayout   = new QHBoxLayout;
+    fileLayout->addWidget(new QLabel(tr("Firmware:"), this));
+    fileLayout->addWidget(m_file);
+    fileLayout->addWidget(browseButton);
+    fileLayout->addWidget(m_verify);
+
+    m_verify->setChecked(true);
+    m_table->setHorizontalHeaderLabels(QStringList() << tr("Board") << tr("Progress") << tr("Throughput") << tr("Status"));
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->hide();
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    buttons->addButton(m_startButton, QDialogButtonBox::ActionRole);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(fileLayout);
+    layout->addWidget(m_table);
+    layout->addWidget(buttons);
+    resize(640, 320);
+
+    connect(browseButton, SIGNAL(clicked()), this, SLOT(browse()));
+    connect(m_startButton, SIGNAL(clicked()), this, SLOT(start()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(&m_uploader, SIGNAL(boardAdded(int, QString)), this, SLOT(boardAdded(int, QString)));
+    connect(&m_uploader, SIGNAL(boardProgress(int, int, double)), this, SLOT(boardProgress(int, int, double)));
+    connect(&m_uploader, SIGNAL(boardFinished(int, bool, QString)), this, SLOT(boardFinished(int, bool, QString)));
+    connect(&m_uploader, SIGNAL(finished(int, int)), this, SLOT(finished(int, int)));
+}
+
+void BatchUploadDialog::browse()
+{
+    QString filename = QFileDialog::getOpenFileName(this, tr("Select firmware file"), m_file->text(),
+                                                    tr("Firmware Files (*.opfw *.bin)"));
+
+    if (!filename.isEmpty()) {
+        m_file->setText(filename);
+    }
+}
+
+void BatchUploadDialog::start()
+{
+    if (BatchUploader::bootloaderBoards().isEmpty()) {
+        QMessageBox::information(this, windowTitle(), tr("No board in the bootloader was found."));
+        return;
+    }
+    m_table->setRowCount(0);
+    m_startButton->setEnabled(false);
+    m_file->setEnabled(false);
+    m_verify->setEnabled(false);
+    m_uploader.start(m_file->text(), m_verify->isChecked());
+}
+
+void BatchUploadDialog::boardAdded(int index, QString serial)
+{
+    m_table->insertRow(index);
+    m_table->setItem(index, 0, new QTableWidgetItem(serial));
+    QProgressBar *bar = new QProgressBar(m_table);
+    bar->setRange(0, 100);
+    bar->setValue(0);
+    m_table->setCellWidget(index, 1, bar);
+    m_table->setItem(index, 2, new QTableWidgetItem());
+    m_table->setItem(index, 3, new QTableWidgetItem(tr("Starting")));
+}
+
+void BatchUploadDialog::boardProgress(int index, int percent, double bytesPerSecond)
+{
+    static_cast<QProgressBar *>(m_table->cellWidget(index, 1))->setValue(percent);
+    m_table->item(index, 2)->setText(tr("%1 KB/s").arg(bytesPerSecond / 1024.0, 0, 'f', 1));
+    m_table->item(index, 3)->setText(tr("Uploading"));
+}
+
+void BatchUploadDialog::boardFinished(int index, bool success, QString status)
+{
+    if (success) {
+        static_cast<QProgressBar *>(m_table->cellWidget(index, 1))->setValue(100);
+    }
+    m_table->item(index, 3)->setText(status);
+}
+
+void BatchUploadDialog::finished(int succeeded, int failed)
+{
+    m_startButton->setEnabled(true);
+    m_file->setEnabled(true);
+    m_verify->setEnabled(true);
+    if (!succeeded && !failed) {
+        QMessageBox::warning(this, windowTitle(), tr("Could not open the firmware file."));
+    }
+}
+
+void BatchUploadDialog::reject()
+{
+    // the boards would be left half flashed
+    if (!m_uploader.isRunning()) {
+        QDialog::reject();
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchuploader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief Flashes every board found in the bootloader at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef BATCHUPLOADER_H
+#define BATCHUPLOADER_H
+
+#include "op_dfu.h"
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QDialog>
+
+class QTableWidget;
+class QLineEdit;
+class QCheckBox;
+class QPushButton;
+
+// Every board gets its own DFUObject, the transfers run concurrently in the DFUObject threads.
+// The short transactions before and after a transfer run in the caller thread.
+class BatchUploader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit BatchUploader(QObject *parent = 0);
+    ~BatchUploader();
+
+    // USB serial numbers of the boards currently in the bootloader
+    static QStringList bootloaderBoards();
+
+    // opens every board in the bootloader and starts flashing them, false if no upload could be started
+    bool start(const QString &filename, bool verify);
+    bool isRunning() const
+    {
+        return m_running > 0;
+    }
+
+signals:
+    void boardAdded(int index, QString serial);
+    // bytes per second are averaged since the start of the transfer
+    void boardProgress(int index, int percent, double bytesPerSecond);
+    void boardFinished(int index, bool success, QString status);
+    void finished(int succeeded, int failed);
+
+private slots:
+    void progressUpdated(int percent);
+    void uploadFinished(OP_DFU::Status status);
+
+private:
+    struct Board {
+        QString serial;
+        OP_DFU::DFUObject *dfu;
+        QElapsedTimer timer;
+    };
+    QList<Board> m_boards;
+    QByteArray m_description;
+    qint64 m_size;
+    int m_running;
+    int m_succeeded;
+    int m_failed;
+
+    int boardIndex(QObject *dfu) const;
+    void boardDone(int index, bool success, const QString &status);
+    void finish();
+    void clear();
+};
+
+// per board progress of a BatchUploader run
+class BatchUploadDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit BatchUploadDialog(QWidget *parent = 0);
+
+private slots:
+    void browse();
+    void start();
+    void boardAdded(int index, QString serial);
+    void boardProgress(int index, int percent, double bytesPerSecond);
+    void boardFinished(int index, bool success, QString status);
+    void finished(int succeeded, int failed);
+
+protected:
+    void reject();
+
+private:
+    BatchUploader m_uploader;
+    QLineEdit *m_file;
+    QCheckBox *m_verify;
+    QTableWidget *m_table;
+    QPushButton *m_startButton;
+};
+
+#endif // BATCHUPLOADER_H
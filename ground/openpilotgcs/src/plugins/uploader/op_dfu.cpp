@@ -33,6 +33,21 @@
 
 using namespace OP_DFU;
 
+// in USB mode portname is the serial number of the board to open, all boards when empty
+static QList<USBPortInfo> bootloaderDevices(const QString &serial)
+{
+    QList<USBPortInfo> devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+
+    if (!serial.isEmpty()) {
+        for (int i = devices.length() - 1; i >= 0; --i) {
+            if (devices.at(i).serialNumber != serial) {
+                devices.removeAt(i);
+            }
+        }
+    }
+    return devices;
+}
+
 DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
     debug(_debug), use_serial(_use_serial), mready(true)
 {
@@ -75,9 +90,9 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
         QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
         m_eventloop.exec();
         QList<USBPortInfo> devices;
-        devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+        devices = bootloaderDevices(portname);
         if (devices.length() == 1) {
-            if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0) == 1) {
+            if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0, devices.first().serialNumber) == 1) {
                 mready = true;
                 QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
                 m_eventloop.exec();
@@ -97,11 +112,11 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
                     QTimer::singleShot(2000, &m_eventloop, SLOT(quit()));
                 }
                 m_eventloop.exec();
-                devices = USBMonitor::instance()->availableDevices(0x20a0, -1, -1, USBMonitor::Bootloader);
+                devices = bootloaderDevices(portname);
                 qDebug() << "Devices length: " << devices.length();
                 if (devices.length() == 1) {
                     qDebug() << "Opening device";
-                    if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0) == 1) {
+                    if (hidHandle.open(1, devices.first().vendorID, devices.first().productID, 0, 0, devices.first().serialNumber) == 1) {
                         QTimer::singleShot(200, &m_eventloop, SLOT(quit()));
                         m_eventloop.exec();
                         qDebug() << "OP_DFU detected after delay";
@@ -247,13 +262,16 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
     int packetsize;
     float percentage;
     int laspercentage = 0;
+    // the bootloader does not acknowledge data packets, they are sent back to back
+    // and the device reports sequence or flash errors through the status afterwards
+    char *source = data.data();
     for (qint32 packetcount = 0; packetcount < numberOfPackets; ++packetcount) {
         percentage = (float)(packetcount + 1) / numberOfPackets * 100;
         if (laspercentage != (int)percentage) {
             printProgBar((int)percentage, "UPLOADING");
         }
         laspercentage = (int)percentage;
-        if (packetcount == numberOfPackets) {
+        if (packetcount == numberOfPackets - 1) {
             packetsize = lastPacketCount;
         } else {
             packetsize = 14;
@@ -263,8 +281,7 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
         buf[3]  = packetcount >> 16; // DFU Count
         buf[4]  = packetcount >> 8; // DFU Count
         buf[5]  = packetcount; // DFU Count
-        char *pointer = data.data();
-        pointer = pointer + 4 * 14 * packetcount;
+        char *pointer = source + 4 * 14 * packetcount;
         // qDebug()<<"Packet Number="<<packetcount<<"Data0="<<(int)data[0]<<" Data1="<<(int)data[1]<<" Data0="<<(int)data[2]<<" Data0="<<(int)data[3]<<" buf6="<<(int)buf[6]<<" buf7="<<(int)buf[7]<<" buf8="<<(int)buf[8]<<" buf9="<<(int)buf[9];
         CopyWords(pointer, buf + 6, packetsize * 4);
         // for (int y=0;y<packetsize*4;++y)
@@ -810,21 +827,25 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         }
         return ret;
     }
+    // the bootloader compares the CRC of its flash with the one sent by StartUpload
+    // when the operation ends, success means the firmware is verified
     ret = StatusRequest();
-    if (ret != OP_DFU::Last_operation_Success) {
-        return ret;
-    }
-
-    if (verify) {
+    if (ret == OP_DFU::CRC_Fail && verify) {
+        // only read the firmware back to tell where it differs
         emit operationProgress(QString("Verifying firmware"));
         cout << "Starting code verification\n";
         QByteArray arr2;
         StartDownloadT(&arr2, arr.length(), OP_DFU::FW);
-        if (arr != arr2) {
-            cout << "Verify:FAILED\n";
-            return OP_DFU::abort;
+        for (int x = 0; x < qMin(arr.length(), arr2.length()); ++x) {
+            if (arr.at(x) != arr2.at(x)) {
+                cout << "Verify:FAILED at offset " << x << "\n";
+                break;
+            }
         }
     }
+    if (ret != OP_DFU::Last_operation_Success) {
+        return ret;
+    }
 
     if (debug) {
         qDebug() << "Status=" << ret;
@@ -43,6 +43,7 @@
 #include <QProgressBar>
 #include <QDebug>
 #include "rebootdialog.h"
+#include "batchuploader.h"
 
 #define DFU_DEBUG true
 
@@ -159,6 +160,7 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent) : QWidget(parent)
     connect(m_config->safeBootButton, SIGNAL(clicked()), this, SLOT(systemSafeBoot()));
     connect(m_config->eraseBootButton, SIGNAL(clicked()), this, SLOT(systemEraseBoot()));
     connect(m_config->rescueButton, SIGNAL(clicked()), this, SLOT(systemRescue()));
+    connect(m_config->flashAllButton, SIGNAL(clicked()), this, SLOT(flashAll()));
 
     getSerialPorts();
 
@@ -964,6 +966,30 @@ void UploaderGadgetWidget::systemRescue()
     m_currentIAPStep = IAP_STATE_BOOTLOADER;
 }
 
+/**
+   Flashes one firmware to every board in the bootloader, the boards boot when done
+ */
+void UploaderGadgetWidget::flashAll()
+{
+    // The batch opens every board itself, our DFU object would hold one of them
+    if (m_dfu) {
+        while (m_config->systemElements->count()) {
+            QWidget *qw = m_config->systemElements->widget(0);
+            m_config->systemElements->removeTab(0);
+            delete qw;
+        }
+        delete m_dfu;
+        m_dfu = NULL;
+        m_currentIAPStep = IAP_STATE_READY;
+        bootButtonsSetEnable(false);
+        m_config->rescueButton->setEnabled(true);
+    }
+    Core::ICore::instance()->connectionManager()->disconnectDevice();
+
+    BatchUploadDialog dialog(this);
+    dialog.exec();
+}
+
 void UploaderGadgetWidget::uploadStarted()
 {
     m_config->haltButton->setEnabled(false);
@@ -26,15 +26,17 @@
  */
 #include "uploaderplugin.h"
 #include "uploadergadgetfactory.h"
+#include "batchuploader.h"
 
 #include <extensionsystem/pluginmanager.h>
 
 #include <QStringList>
+#include <QCoreApplication>
+#include <QTimer>
+#include <QTextStream>
 
-UploaderPlugin::UploaderPlugin()
-{
-    // Do nothing
-}
+UploaderPlugin::UploaderPlugin() : m_batch(0)
+{}
 
 UploaderPlugin::~UploaderPlugin()
 {
@@ -43,9 +45,13 @@ UploaderPlugin::~UploaderPlugin()
 
 bool UploaderPlugin::initialize(const QStringList & args, QString *errMsg)
 {
-    Q_UNUSED(args);
     Q_UNUSED(errMsg);
 
+    int index = args.indexOf("-flash-all");
+    if (index >= 0 && index + 1 < args.count()) {
+        m_flashAllFile = args.at(index + 1);
+    }
+
     mf = new UploaderGadgetFactory(this);
     addAutoReleasedObject(mf);
 
@@ -54,7 +60,50 @@ bool UploaderPlugin::initialize(const QStringList & args, QString *errMsg)
 
 void UploaderPlugin::extensionsInitialized()
 {
-    // Do nothing
+    if (!m_flashAllFile.isEmpty()) {
+        // start once the event loop runs, the USB monitor needs it to see the boards
+        QTimer::singleShot(1000, this, SLOT(flashAll()));
+    }
+}
+
+void UploaderPlugin::flashAll()
+{
+    m_batch = new BatchUploader(this);
+    connect(m_batch, SIGNAL(boardAdded(int, QString)), this, SLOT(boardAdded(int, QString)));
+    connect(m_batch, SIGNAL(boardProgress(int, int, double)), this, SLOT(boardProgress(int, int, double)));
+    connect(m_batch, SIGNAL(boardFinished(int, bool, QString)), this, SLOT(boardFinished(int, bool, QString)));
+    connect(m_batch, SIGNAL(finished(int, int)), this, SLOT(flashAllFinished(int, int)));
+
+    QTextStream(stdout) << "Flashing " << m_flashAllFile << " to " << BatchUploader::bootloaderBoards().count() << " board(s)" << endl;
+    m_batch->start(m_flashAllFile, true);
+}
+
+void UploaderPlugin::boardAdded(int index, QString serial)
+{
+    Q_UNUSED(index);
+    m_serials << serial;
+    m_reportedPercent << -1;
+}
+
+void UploaderPlugin::boardProgress(int index, int percent, double bytesPerSecond)
+{
+    // one line per tenth, the boards interleave
+    if (percent / 10 == m_reportedPercent.at(index) / 10) {
+        return;
+    }
+    m_reportedPercent[index] = percent;
+    QTextStream(stdout) << m_serials.at(index) << ": " << percent << "% " << QString::number(bytesPerSecond / 1024.0, 'f', 1) << " KB/s" << endl;
+}
+
+void UploaderPlugin::boardFinished(int index, bool success, QString status)
+{
+    QTextStream(stdout) << m_serials.at(index) << ": " << (success ? "OK " : "FAILED ") << status << endl;
+}
+
+void UploaderPlugin::flashAllFinished(int succeeded, int failed)
+{
+    QTextStream(stdout) << succeeded << " board(s) flashed, " << failed << " failed" << endl;
+    QCoreApplication::exit((succeeded && !failed) ? 0 : 1);
 }
 
 void UploaderPlugin::shutdown()
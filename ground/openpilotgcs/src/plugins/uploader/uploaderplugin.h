@@ -29,9 +29,11 @@
 #define UPLOADERPLUGIN_H
 
 #include <extensionsystem/iplugin.h>
+#include <QStringList>
 #include "uploader_global.h"
 
 class UploaderGadgetFactory;
+class BatchUploader;
 
 class UPLOADER_EXPORT UploaderPlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
@@ -45,8 +47,20 @@ public:
     bool initialize(const QStringList & arguments, QString *errorString);
     void shutdown();
 
+private slots:
+    void flashAll();
+    void boardAdded(int index, QString serial);
+    void boardProgress(int index, int percent, double bytesPerSecond);
+    void boardFinished(int index, bool success, QString status);
+    void flashAllFinished(int succeeded, int failed);
+
 private:
     UploaderGadgetFactory *mf;
+    // set by -flash-all, nothing else is done than flashing the boards
+    QString m_flashAllFile;
+    BatchUploader *m_batch;
+    QStringList m_serials;
+    QList<int> m_reportedPercent;
 };
 
 #endif // UPLOADERPLUGIN_H
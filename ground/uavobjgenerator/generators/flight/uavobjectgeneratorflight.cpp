@@ -44,12 +44,15 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
     flightInitTemplate        = readFile(flightCodePath.absoluteFilePath("uavobjectsinit.c.template"));
     flightInitIncludeTemplate = readFile(flightCodePath.absoluteFilePath("inc/uavobjectsinit.h.template"));
     flightMakeTemplate        = readFile(flightCodePath.absoluteFilePath("Makefile.inc.template"));
+    flightTableTemplate       = readFile(flightCodePath.absoluteFilePath("uavobjecttable.c.template"));
 
-    if (flightCodeTemplate.isNull() || flightIncludeTemplate.isNull() || flightInitTemplate.isNull()) {
+    if (flightCodeTemplate.isNull() || flightIncludeTemplate.isNull() || flightInitTemplate.isNull() ||
+        flightTableTemplate.isNull()) {
         cerr << "Error: Could not open flight template files." << endl;
         return false;
     }
 
+    QMap<quint32, QString> objIds;
     sizeCalc = 0;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
@@ -60,6 +63,7 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         objInc.append("#include \"" + info->namelc + ".h\"\n");
         objFileNames.append(" " + info->namelc);
         objNames.append(" " + info->name);
+        objIds.insert(info->id, info->name);
         if (parser->getNumBytes(objidx) > sizeCalc) {
             sizeCalc = parser->getNumBytes(objidx);
         }
@@ -75,6 +79,21 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser *parser, QString templat
         return false;
     }
 
+    // Write the flight object ID table, QMap iterates in ascending ID order
+    QString objHandles, objIdTable;
+    for (QMap<quint32, QString>::const_iterator it = objIds.constBegin(); it != objIds.constEnd(); ++it) {
+        objHandles.append(QString("extern UAVObjHandle %1Handle() __attribute__((weak));\n").arg(it.value()));
+        objIdTable.append(QString("    { 0x%1, &%2Handle },\n").arg(it.key(), 8, 16, QChar('0')).arg(it.value()));
+    }
+    flightTableTemplate.replace(QString("$(OBJHANDLES)"), objHandles);
+    flightTableTemplate.replace(QString("$(OBJIDTABLE)"), objIdTable);
+    res = writeFileIfDiffrent(flightOutputPath.absolutePath() + "/uavobjecttable.c",
+                              flightTableTemplate);
+    if (!res) {
+        cout << "Error: Could not write flight object ID table file" << endl;
+        return false;
+    }
+
     // Write the flight object initialization header
     flightInitIncludeTemplate.replace(QString("$(SIZECALCULATION)"), QString().setNum(sizeCalc));
     res = writeFileIfDiffrent(flightOutputPath.absolutePath() + "/uavobjectsinit.h",
@@ -119,9 +138,17 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     QString type;
     QString fields;
     QString dataStructures;
+    QString alignmentChecks;
     for (int n = 0; n < info->fields.length(); ++n) {
         // Determine type
         type = fieldTypeStrC[info->fields[n]->type];
+        // The parser sorts the fields by element size, so in the 4 byte aligned object data each field
+        // is aligned to its element size while the data stays packed in the UAVTalk wire order
+        int align = info->fields[n]->numBytes;
+        if (align > 1) {
+            alignmentChecks.append(QString("    PIOS_STATIC_ASSERT(offsetof(%1DataPacked, %2) % %3 == 0);\n")
+                                   .arg(info->name).arg(info->fields[n]->name).arg(align));
+        }
         // Append field
         // Check if it a named set and creates structures accordingly
         if (info->fields[n]->numElements > 1) {
@@ -131,15 +158,19 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
                 for (int f = 0; f < info->fields[n]->elementNames.count(); f++) {
                     structType.append(QString("    %1 %2;\n").arg(type).arg(info->fields[n]->elementNames[f]));
                 }
-                structType.append(QString("}  %1 ;\n").arg(structTypeName));
+                // the packed struct is the member of the object data, the aligned one is used
+                // for copies and pointers so that the compiler knows the elements are aligned
+                structType.append(QString("}  %1Packed ;\n").arg(structTypeName));
+                structType.append(QString("typedef %1Packed __attribute__((aligned(%2))) %1;\n").arg(structTypeName).arg(align));
                 structType.append(QString("typedef struct __attribute__ ((__packed__)) {\n"));
                 structType.append(QString("    %1 array[%2];\n").arg(type).arg(info->fields[n]->elementNames.count()));
-                structType.append(QString("}  %1Array ;\n").arg(structTypeName));
+                structType.append(QString("}  %1ArrayPacked ;\n").arg(structTypeName));
+                structType.append(QString("typedef %1ArrayPacked __attribute__((aligned(%2))) %1Array;\n").arg(structTypeName).arg(align));
                 structType.append(QString("#define %1%2ToArray( var ) UAVObjectFieldToArray( %3, var )\n\n").arg(info->name).arg(info->fields[n]->name).arg(structTypeName));
 
                 dataStructures.append(structType);
 
-                fields.append(QString("    %1 %2;\n").arg(structTypeName)
+                fields.append(QString("    %1Packed %2;\n").arg(structTypeName)
                               .arg(info->fields[n]->name));
             } else {
                 fields.append(QString("    %1 %2[%3];\n").arg(type)
@@ -151,6 +182,15 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     }
     outInclude.replace(QString("$(DATAFIELDS)"), fields);
     outInclude.replace(QString("$(DATASTRUCTURES)"), dataStructures);
+    outCode.replace(QString("$(FIELDALIGNMENTCHECKS)"), alignmentChecks);
+
+    // Replace the $(LOCKLESSGETTERS) tag, high rate objects get a seqlock read path
+    QString locklessGetters;
+    if (info->isHighRate) {
+        locklessGetters.append(QString("static inline int32_t %1GetLockless(%1Data *dataOut) { return UAVObjGetInstanceDataLockless(%1Handle(), 0, dataOut); }\n")
+                               .arg(info->name));
+    }
+    outInclude.replace(QString("$(LOCKLESSGETTERS)"), locklessGetters);
     // Replace the $(DATAFIELDINFO) tag
     QString enums;
     for (int n = 0; n < info->fields.length(); ++n) {
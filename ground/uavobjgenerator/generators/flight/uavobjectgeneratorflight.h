@@ -30,12 +30,13 @@
 #define FLIGHT_CODE_DIR "flight/uavobjects"
 
 #include "../generator_common.h"
+#include <QMap>
 
 class UAVObjectGeneratorFlight {
 public:
     bool generate(UAVObjectParser *gen, QString templatepath, QString outputpath);
     QStringList fieldTypeStrC;
-    QString flightCodeTemplate, flightIncludeTemplate, flightInitTemplate, flightInitIncludeTemplate, flightMakeTemplate;
+    QString flightCodeTemplate, flightIncludeTemplate, flightInitTemplate, flightInitIncludeTemplate, flightMakeTemplate, flightTableTemplate;
     QDir flightCodePath;
     QDir flightOutputPath;
 
@@ -136,7 +136,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
             propertiesImpl  +=
                 QString("%1 %2::get%3(quint32 index) const\n"
                         "{\n"
-                        "   QMutexLocker locker(mutex);\n"
+                        "   QMutexLocker locker(&mutex);\n"
                         "   return data.%3[index];\n"
                         "}\n")
                 .arg(type).arg(info->name).arg(field->name);
@@ -146,10 +146,10 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
             propertiesImpl  +=
                 QString("void %1::set%2(quint32 index, %3 value)\n"
                         "{\n"
-                        "   mutex->lock();\n"
+                        "   mutex.lock();\n"
                         "   bool changed = data.%2[index] != value;\n"
                         "   data.%2[index] = value;\n"
-                        "   mutex->unlock();\n"
+                        "   mutex.unlock();\n"
                         "   if (changed) emit %2Changed(index,value);\n"
                         "}\n\n")
                 .arg(info->name).arg(field->name).arg(type);
@@ -167,7 +167,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                 propertiesImpl  +=
                     QString("%1 %2::get%3_%4() const\n"
                             "{\n"
-                            "   QMutexLocker locker(mutex);\n"
+                            "   QMutexLocker locker(&mutex);\n"
                             "   return data.%3[%5];\n"
                             "}\n")
                     .arg(type).arg(info->name).arg(field->name).arg(elementName).arg(elementIndex);
@@ -177,10 +177,10 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                 propertiesImpl  +=
                     QString("void %1::set%2_%3(%4 value)\n"
                             "{\n"
-                            "   mutex->lock();\n"
+                            "   mutex.lock();\n"
                             "   bool changed = data.%2[%5] != value;\n"
                             "   data.%2[%5] = value;\n"
-                            "   mutex->unlock();\n"
+                            "   mutex.unlock();\n"
                             "   if (changed) emit %2_%3Changed(value);\n"
                             "}\n\n")
                     .arg(info->name).arg(field->name).arg(elementName).arg(type).arg(elementIndex);
@@ -188,8 +188,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                     QString("    void %1_%2Changed(%3 value);\n")
                     .arg(field->name).arg(elementName).arg(type);
                 propertyNotificationsImpl +=
-                    QString("        //if (data.%1[%2] != oldData.%1[%2])\n"
-                            "            emit %1_%3Changed(data.%1[%2]);\n")
+                    QString("    if (current.%1[%2] != notifiedData.%1[%2]) {\n"
+                            "        emit %1_%3Changed(current.%1[%2]);\n"
+                            "    }\n")
                     .arg(field->name).arg(elementIndex).arg(elementName);
             }
         } else {
@@ -201,7 +202,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
             propertiesImpl  +=
                 QString("%1 %2::get%3() const\n"
                         "{\n"
-                        "   QMutexLocker locker(mutex);\n"
+                        "   QMutexLocker locker(&mutex);\n"
                         "   return data.%3;\n"
                         "}\n")
                 .arg(type).arg(info->name).arg(field->name);
@@ -211,10 +212,10 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
             propertiesImpl  +=
                 QString("void %1::set%2(%3 value)\n"
                         "{\n"
-                        "   mutex->lock();\n"
+                        "   mutex.lock();\n"
                         "   bool changed = data.%2 != value;\n"
                         "   data.%2 = value;\n"
-                        "   mutex->unlock();\n"
+                        "   mutex.unlock();\n"
                         "   if (changed) emit %2Changed(value);\n"
                         "}\n\n")
                 .arg(info->name).arg(field->name).arg(type);
@@ -222,8 +223,9 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
                 QString("    void %1Changed(%2 value);\n")
                 .arg(field->name).arg(type);
             propertyNotificationsImpl +=
-                QString("        //if (data.%1 != oldData.%1)\n"
-                        "            emit %1Changed(data.%1);\n")
+                QString("    if (current.%1 != notifiedData.%1) {\n"
+                        "        emit %1Changed(current.%1);\n"
+                        "    }\n")
                 .arg(field->name);
         }
     }
@@ -236,49 +238,37 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *info)
     outCode.replace(QString("$(PROPERTIES_IMPL)"), propertiesImpl);
     outCode.replace(QString("$(NOTIFY_PROPERTIES_CHANGED)"), propertyNotificationsImpl);
 
-    // Replace the $(FIELDSINIT) tag
-    QString finit;
+    // Replace the $(FIELDSINFO) tag, the field descriptions are static tables
+    // the fields are built from, so every instance shares the same strings
+    QString finfo;
+    QString ftable;
     for (int n = 0; n < info->fields.length(); ++n) {
         // Setup element names
         QString varElemName   = info->fields[n]->name + "ElemNames";
-        finit.append(QString("    QStringList %1;\n").arg(varElemName));
         QStringList elemNames = info->fields[n]->elementNames;
-        for (int m = 0; m < elemNames.length(); ++m) {
-            finit.append(QString("    %1.append(\"%2\");\n")
-                         .arg(varElemName)
-                         .arg(elemNames[m]));
-        }
+        finfo.append(QString("static const char *const %1[] = { \"%2\" };\n")
+                     .arg(varElemName)
+                     .arg(elemNames.join("\", \"")));
 
+        QString varOptionName = "NULL";
+        int numOptions = 0;
         // Only for enum types
         if (info->fields[n]->type == FIELDTYPE_ENUM) {
-            QString varOptionName = info->fields[n]->name + "EnumOptions";
-            finit.append(QString("    QStringList %1;\n").arg(varOptionName));
-            QStringList options   = info->fields[n]->options;
-            for (int m = 0; m < options.length(); ++m) {
-                finit.append(QString("    %1.append(\"%2\");\n")
-                             .arg(varOptionName)
-                             .arg(options[m]));
-            }
-            finit.append(QString("    fields.append( new UAVObjectField(QString(\"%1\"), tr(\"%2\"), QString(\"%3\"), UAVObjectField::ENUM, %4, %5, QString(\"%6\")));\n")
-                         .arg(info->fields[n]->name)
-                         .arg(info->fields[n]->description)
-                         .arg(info->fields[n]->units)
-                         .arg(varElemName)
+            varOptionName = info->fields[n]->name + "EnumOptions";
+            numOptions    = info->fields[n]->options.length();
+            finfo.append(QString("static const char *const %1[] = { \"%2\" };\n")
                          .arg(varOptionName)
-                         .arg(info->fields[n]->limitValues));
-        }
-        // For all other types
-        else {
-            finit.append(QString("    fields.append( new UAVObjectField(QString(\"%1\"), tr(\"%2\"), QString(\"%3\"), UAVObjectField::%4, %5, QStringList(), QString(\"%6\")));\n")
-                         .arg(info->fields[n]->name)
-                         .arg(info->fields[n]->description)
-                         .arg(info->fields[n]->units)
-                         .arg(fieldTypeStrCPPClass[info->fields[n]->type])
-                         .arg(varElemName)
-                         .arg(info->fields[n]->limitValues));
+                         .arg(info->fields[n]->options.join("\", \"")));
         }
+        // substituted at once, a description may contain a %
+        ftable.append(QString("    { \"%1\", QT_TRANSLATE_NOOP(\"%2\", \"%3\"), \"%4\", UAVObjectField::%5, %6, %7, %8, %9, ")
+                      .arg(info->fields[n]->name, info->name, info->fields[n]->description, info->fields[n]->units,
+                           fieldTypeStrCPPClass[info->fields[n]->type], QString::number(elemNames.length()), varElemName,
+                           QString::number(numOptions), varOptionName));
+        ftable.append(QString("\"%1\" },\n").arg(info->fields[n]->limitValues));
     }
-    outCode.replace(QString("$(FIELDSINIT)"), finit);
+    finfo.append(QString("static const UAVObjectField::Info FIELDS_INFO[] = {\n%1};\n").arg(ftable));
+    outCode.replace(QString("$(FIELDSINFO)"), finfo);
 
     // Replace the $(DATAFIELDINFO) tag
     QString name;
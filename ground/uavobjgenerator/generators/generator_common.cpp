@@ -75,6 +75,8 @@ void replaceCommonTags(QString & out, ObjectInfo *info)
     // Replace $(ISPRIORITY) tag
     out.replace(QString("$(ISPRIORITY)"), boolTo01String(info->isPriority));
     out.replace(QString("$(ISPRIORITYTF)"), boolToTRUEFALSEString(info->isPriority));
+    // Replace $(ISHIGHRATE) tag
+    out.replace(QString("$(ISHIGHRATE)"), boolTo01String(info->isHighRate));
     // Replace $(GCSACCESS) tag
     value = accessModeStr[info->gcsAccess];
     out.replace(QString("$(GCSACCESS)"), value);
@@ -35,7 +35,7 @@
 #include <iostream>
 
 QString readFile(QString name);
-QString readFile(QString name);
+QString readFile(QString name, bool do_warn);
 bool writeFile(QString name, QString & str);
 bool writeFileIfDiffrent(QString name, QString & str);
 
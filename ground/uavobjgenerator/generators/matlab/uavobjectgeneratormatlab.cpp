@@ -40,8 +40,9 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser *parser, QString templat
     matlabOutputPath.mkpath(matlabOutputPath.absolutePath());
 
     QString matlabCodeTemplate = readFile(matlabTemplatePath.absoluteFilePath("uavobject.m.template"));
+    QString matlabColumnsTemplate = readFile(matlabTemplatePath.absoluteFilePath("uavcolumns.m.template"));
 
-    if (matlabCodeTemplate.isEmpty()) {
+    if (matlabCodeTemplate.isEmpty() || matlabColumnsTemplate.isEmpty()) {
         std::cerr << "Problem reading matlab templates" << endl;
         return false;
     }
@@ -54,12 +55,14 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser *parser, QString templat
 
     matlabCodeTemplate.replace(QString("$(INSTANTIATIONCODE)"), matlabInstantiationCode);
     matlabCodeTemplate.replace(QString("$(SWITCHCODE)"), matlabSwitchCode);
-    matlabCodeTemplate.replace(QString("$(CLEANUPCODE)"), matlabCleanupCode);
     matlabCodeTemplate.replace(QString("$(SAVEOBJECTSCODE)"), matlabSaveObjectsCode);
     matlabCodeTemplate.replace(QString("$(ALLOCATIONCODE)"), matlabAllocationCode);
     matlabCodeTemplate.replace(QString("$(EXPORTCSVCODE)"), matlabExportCsvCode);
 
-    bool res = writeFile(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate);
+    matlabColumnsTemplate.replace(QString("$(COLUMNSCODE)"), matlabColumnsCode);
+
+    bool res = writeFileIfDiffrent(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate) &&
+               writeFileIfDiffrent(matlabOutputPath.absolutePath() + "/OPColumnsLoad.m", matlabColumnsTemplate);
     if (!res) {
         cout << "Error: Could not write output files" << endl;
         return false;
@@ -81,7 +84,6 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     QString objectName(info->name);
     // QString objectTableName(objectName + "Objects");
     QString objectTableName(objectName);
-    QString tableIdxName(objectName.toLower() + "Idx");
     QString objectID(QString().setNum(info->id));
     QString numBytesString = QString("%1").arg(numBytes);
 
@@ -92,8 +94,7 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     QString type;
     QString instantiationFields;
 
-    matlabInstantiationCode.append("\n\t" + tableIdxName + " = 0;\n");
-    matlabInstantiationCode.append("\t" + objectTableName + "=struct('timestamp', 0");
+    matlabInstantiationCode.append("\n\t" + objectTableName + "=struct('timestamp', 0");
     if (!info->isSingleInst) {
         instantiationFields.append(",...\n\t\t 'instanceID', 0");
     }
@@ -112,25 +113,16 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     matlabInstantiationCode.append(instantiationFields);
     matlabInstantiationCode.append("\t" + objectTableName.toUpper() + "_OBJID=" + objectID + ";\n");
     matlabInstantiationCode.append("\t" + objectTableName.toUpper() + "_NUMBYTES=" + numBytesString + ";\n");
-    matlabInstantiationCode.append("\t" + objectName + "FidIdx = [];\n");
-
+    matlabInstantiationCode.append("\tknownObjIDs(end + 1) = " + objectTableName.toUpper() + "_OBJID;\n");
 
-    // ==============================================================//
-    // Generate 'Switch:' code (will replace the $(SWITCHCODE) tag) //
-    // ==============================================================//
-    matlabSwitchCode.append("\t\tcase " + objectTableName.toUpper() + "_OBJID\n");
-    matlabSwitchCode.append("\t\t\t" + tableIdxName + " = " + tableIdxName + " + 1;\n");
-    matlabSwitchCode.append("\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + ") = bufferIdx; %#ok<*AGROW>\n");
-    matlabSwitchCode.append("\t\t\tbufferIdx=bufferIdx + " + objectTableName.toUpper() + "_NUMBYTES+1; %+1 is for CRC\n");
-    matlabSwitchCode.append("\t\t\tif " + tableIdxName + " >= length(" + objectTableName + "FidIdx) %Check to see if pre-allocated memory is exhausted\n");
-    matlabSwitchCode.append("\t\t\t\t" + objectTableName + "FidIdx(" + tableIdxName + "*2) = 0;\n");
-    matlabSwitchCode.append("\t\t\tend\n");
 
-
-    // ============================================================//
-    // Generate 'Cleanup:' code (will replace the $(CLEANUP) tag) //
-    // ============================================================//
-    matlabCleanupCode.append(objectTableName + "FidIdx =" + objectTableName + "FidIdx(1:" + tableIdxName + ");\n");
+    // ======================================================================//
+    // Generate message selection code (will replace the $(SWITCHCODE) tag) //
+    // ======================================================================//
+    // start of the data and of the message for every update of the object
+    matlabSwitchCode.append("objMask = objIDs == " + objectTableName.toUpper() + "_OBJID;\n");
+    matlabSwitchCode.append(objectTableName + "FidIdx = dataIdx(objMask);\n");
+    matlabSwitchCode.append(objectTableName + "SyncIdx = syncIdx(objMask);\n");
 
     // =================================================================//
     // Generate functions code (will replace the $(ALLOCATIONCODE) tag) //
@@ -139,18 +131,18 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
     matlabAllocationCode.append("% " + objectName + " typecasting\n");
     QString allocationFields;
 
-    // Add timestamp
+    // Add timestamp, from the OPL header in front of the message
     allocationFields.append("\t" + objectName + ".timestamp = " +
-                            "double(typecast(buffer(mcolon(" + objectName + "FidIdx "
-                            "- headerLen - oplHeaderLen, " + objectName + "FidIdx + 3 - headerLen - oplHeaderLen)), 'uint32'))';\n");
+                            "double(typecast(buffer(mcolon(" + objectName + "SyncIdx "
+                            "- oplHeaderLen, " + objectName + "SyncIdx + 3 - oplHeaderLen)), 'uint32'))';\n");
 
     int currentIdx = 0;
 
     // Add Instance ID, if necessary
     if (!info->isSingleInst) {
         allocationFields.append("\t" + objectName + ".instanceID = " +
-                                "double(typecast(buffer(mcolon(" + objectName + "FidIdx - 2"
-                                ", " + objectName + "FidIdx - 2 + 1)), 'uint16'))';\n");
+                                "double(typecast(buffer(mcolon(" + objectName + "SyncIdx + 8"
+                                ", " + objectName + "SyncIdx + 8 + 1)), 'uint16'))';\n");
     }
 
     for (int n = 0; n < info->fields.length(); ++n) {
@@ -188,5 +180,19 @@ bool UAVObjectGeneratorMatlab::process_object(ObjectInfo *info, int numBytes)
 // OPLog2csv(ActuatorCommand, 'ActuatorCommand', logfile)
 
 
+    // ======================================================================//
+    // Generate columns loader code (will replace the $(COLUMNSCODE) tag)   //
+    // ======================================================================//
+    matlabColumnsCode.append("\tcase '" + objectName + "'\n");
+    matlabColumnsCode.append("\t\tobjid = " + objectID + ";\n");
+    matlabColumnsCode.append(QString("\t\tsingleinst = %1;\n").arg(info->isSingleInst ? "true" : "false"));
+    matlabColumnsCode.append("\t\tfields = {");
+    for (int n = 0; n < info->fields.length(); ++n) {
+        matlabColumnsCode.append((n ? "; '" : "'") + info->fields[n]->name + "', '" + fieldTypeStrMatlab[info->fields[n]->type] + "', " +
+                                 QString::number(info->fields[n]->numElements));
+    }
+    matlabColumnsCode.append("};\n");
+
+
     return true;
 }
@@ -39,10 +39,10 @@ private:
     bool process_object(ObjectInfo *info, int numBytes);
     QString matlabInstantiationCode;
     QString matlabSwitchCode;
-    QString matlabCleanupCode;
     QString matlabAllocationCode;
     QString matlabSaveObjectsCode;
     QString matlabExportCsvCode;
+    QString matlabColumnsCode;
     QStringList fieldTypeStrMatlab;
     QStringList fieldSizeStrMatlab;
 };
@@ -39,15 +39,58 @@ bool UAVObjectGeneratorPython::generate(UAVObjectParser *parser, QString templat
         return false;
     }
 
+    QString columnsTemplate = readFile(QDir(templatepath + QString("ground/openpilotgcs/src/plugins/uavobjects")).absoluteFilePath("uavcolumns.py.template"));
+    if (columnsTemplate.isEmpty()) {
+        std::cerr << "Problem reading python columns template" << endl;
+        return false;
+    }
+
     // Process each object
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
         process_object(info);
+        process_columns(info);
+    }
+
+    // Loader of the logs converted to columns
+    columnsTemplate.replace(QString("$(OBJECTLAYOUTS)"), pythonColumnsLayouts);
+    columnsTemplate.replace(QString("$(OBJECTFORMATS)"), pythonColumnsFormats);
+    if (!writeFileIfDiffrent(pythonOutputPath.absolutePath() + "/uavcolumns.py", columnsTemplate)) {
+        cout << "Error: Could not write Python output files" << endl;
+        return false;
     }
 
     return true; // if we come here everything should be fine
 }
 
+/**
+ * Generate the column layout of the object for uavcolumns.py
+ */
+void UAVObjectGeneratorPython::process_columns(ObjectInfo *info)
+{
+    // numpy dtypes of the field types, little endian as on the wire
+    static const char *dtypes[] = { "<i1", "<i2", "<i4", "<u1", "<u2", "<u4", "<f4", "<u1" };
+    // and the struct module format characters
+    static const char formats[]  = { 'b', 'h', 'i', 'B', 'H', 'I', 'f', 'B' };
+
+    pythonColumnsLayouts.append(QString("    \"%1\" : (0x%2, %3, (").arg(info->name).arg(QString::number(info->id, 16).toUpper())
+                                .arg(info->isSingleInst ? "True" : "False"));
+    for (int n = 0; n < info->fields.length(); ++n) {
+        pythonColumnsLayouts.append(QString("(\"%1\", \"%2\", %3), ").arg(info->fields[n]->name)
+                                    .arg(dtypes[info->fields[n]->type]).arg(info->fields[n]->numElements));
+    }
+    pythonColumnsLayouts.append(")),\n");
+
+    QString format("<");
+    for (int n = 0; n < info->fields.length(); ++n) {
+        if (info->fields[n]->numElements > 1) {
+            format.append(QString::number(info->fields[n]->numElements));
+        }
+        format.append(formats[info->fields[n]->type]);
+    }
+    pythonColumnsFormats.append(QString("    \"%1\" : struct.Struct(\"%2\"),\n").arg(info->name).arg(format));
+}
+
 /**
  * Generate the python object files
  */
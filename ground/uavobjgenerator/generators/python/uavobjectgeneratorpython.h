@@ -35,10 +35,13 @@ public:
 
 private:
     bool process_object(ObjectInfo *info);
+    void process_columns(ObjectInfo *info);
 
     QString pythonCodeTemplate;
     QDir pythonCodePath;
     QDir pythonOutputPath;
+    QString pythonColumnsLayouts;
+    QString pythonColumnsFormats;
 };
 
 #endif
@@ -27,6 +27,10 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFuture>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -40,8 +44,71 @@
 #define RETURN_ERR_XML   2
 #define RETURN_OK        0
 
+// written into each language output directory, holds the hash of the inputs of the last run
+#define STAMP_FILE       ".uavobjgenerator.stamp"
+
 using namespace std;
 
+/**
+ * one language output, the generator only runs if the hash of its inputs changed
+ */
+struct Language {
+    Language(QString name, QStringList templateDirs, bool enabled) :
+        name(name), templateDirs(templateDirs), enabled(enabled) {}
+
+    QString name;
+    QStringList templateDirs;
+    bool enabled;
+    QByteArray stamp;
+    QFuture<bool> result;
+};
+
+/**
+ * add the name and content of a file to the hash
+ */
+static void hashFile(QCryptographicHash & hash, const QString & path)
+{
+    QFile file(path);
+
+    hash.addData(path.toUtf8());
+    if (file.open(QFile::ReadOnly)) {
+        hash.addData(file.readAll());
+    }
+}
+
+/**
+ * hash of the template files of the language, all language hashes start with the common inputs
+ */
+static QByteArray languageStamp(const QByteArray & commonHash, const QString & templatepath, const Language & lang)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(commonHash);
+    hash.addData(lang.name.toUtf8());
+    foreach(const QString &dir, lang.templateDirs) {
+        QStringList files;
+        QDirIterator it(templatepath + dir, QStringList("*.template"), QDir::Files, QDirIterator::Subdirectories);
+
+        while (it.hasNext()) {
+            files << it.next();
+        }
+        // the iteration order depends on the file system
+        files.sort();
+        foreach(const QString &file, files) {
+            hashFile(hash, file);
+        }
+    }
+    return hash.result().toHex();
+}
+
+template<class Generator>
+static bool runGenerator(UAVObjectParser *parser, QString templatepath, QString outputpath)
+{
+    Generator gen;
+
+    return gen.generate(parser, templatepath, outputpath);
+}
+
 /**
  * print usage info
  */
@@ -58,6 +125,7 @@ void usage()
     cout << "\tIf no language is specified ( and not -none ) -> all are built." << endl;
     cout << "Misc: " << endl;
     cout << "\t-none          build no language - just parse xml's" << endl;
+    cout << "\t-force         build even if the inputs did not change since the last run" << endl;
     cout << "\t-h             this help" << endl;
     cout << "\t-v             verbose" << endl;
     cout << "\tinput_path     path to UAVObject definition (.xml) files." << endl;
@@ -110,6 +178,7 @@ int main(int argc, char *argv[])
     bool do_matlab     = (arguments_stringlist.removeAll("-matlab") > 0);
     bool do_wireshark  = (arguments_stringlist.removeAll("-wireshark") > 0);
     bool do_none       = (arguments_stringlist.removeAll("-none") > 0); //
+    bool do_force      = (arguments_stringlist.removeAll("-force") > 0);
 
     bool do_all        = ((do_gcs || do_flight || do_java || do_python || do_matlab) == false);
     bool do_allObjects = true;
@@ -145,6 +214,48 @@ int main(int argc, char *argv[])
     xmlPath.setNameFilters(filters);
     QFileInfoList xmlList   = xmlPath.entryInfoList();
 
+    // the languages whose inputs are unchanged since the last run are skipped: the hash covers the
+    // generator binary, the arguments, the XML files and the templates of the language
+    QList<Language> languages;
+    languages << Language("flight", QStringList(FLIGHT_CODE_DIR), do_flight || do_all);
+    languages << Language("gcs", QStringList(GCS_CODE_DIR), do_gcs || do_all);
+    languages << Language("java", QStringList(JAVA_TEMPLATE_DIR), do_java || do_all);
+    languages << Language("python", QStringList("flight/modules/FlightPlan/lib") << GCS_CODE_DIR, do_python || do_all);
+    languages << Language("matlab", QStringList(MATLAB_CODE_DIR), do_matlab || do_all);
+    languages << Language("wireshark", QStringList(GCS_CODE_DIR "/wireshark"), do_wireshark || do_all);
+
+    bool upToDate = !do_none;
+    if (upToDate) {
+        QCryptographicHash commonHash(QCryptographicHash::Sha1);
+        hashFile(commonHash, QCoreApplication::applicationFilePath());
+        commonHash.addData(templatepath.toUtf8());
+        commonHash.addData(arguments_stringlist.join(" ").toUtf8());
+        foreach(const QFileInfo &fileinfo, xmlList) {
+            hashFile(commonHash, fileinfo.absoluteFilePath());
+        }
+        QByteArray common = commonHash.result();
+
+        for (int i = 0; i < languages.length(); ++i) {
+            Language &lang = languages[i];
+            if (!lang.enabled) {
+                continue;
+            }
+            lang.stamp = languageStamp(common, templatepath, lang);
+            if (do_force || readFile(outputpath + lang.name + "/" STAMP_FILE, false).toLatin1() != lang.stamp) {
+                upToDate = false;
+            } else {
+                lang.enabled = false;
+                if (verbose) {
+                    cout << lang.name.toStdString() << " code is up to date" << endl;
+                }
+            }
+        }
+    }
+    if (upToDate) {
+        cout << "Done: all generated code is up to date." << endl;
+        return RETURN_OK;
+    }
+
     // Read in each XML file and parse object(s) in them
 
     for (int n = 0; n < xmlList.length(); ++n) {
@@ -209,46 +320,40 @@ int main(int argc, char *argv[])
         return RETURN_OK;
     }
 
-    // generate flight code if wanted
-    if (do_flight | do_all) {
-        cout << "generating flight code" << endl;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser, templatepath, outputpath);
-    }
-
-    // generate gcs code if wanted
-    if (do_gcs | do_all) {
-        cout << "generating gcs code" << endl;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser, templatepath, outputpath);
-    }
-
-    // generate java code if wanted
-    if (do_java | do_all) {
-        cout << "generating java code" << endl;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser, templatepath, outputpath);
-    }
-
-    // generate python code if wanted
-    if (do_python | do_all) {
-        cout << "generating python code" << endl;
-        UAVObjectGeneratorPython pygen;
-        pygen.generate(parser, templatepath, outputpath);
-    }
-
-    // generate matlab code if wanted
-    if (do_matlab | do_all) {
-        cout << "generating matlab code" << endl;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser, templatepath, outputpath);
+    // the generators only read the parsed objects, each language is generated in its own thread
+    for (int i = 0; i < languages.length(); ++i) {
+        Language &lang = languages[i];
+        if (!lang.enabled) {
+            continue;
+        }
+        cout << "generating " << lang.name.toStdString() << " code" << endl;
+        if (lang.name == "flight") {
+            lang.result = QtConcurrent::run(runGenerator<UAVObjectGeneratorFlight>, parser, templatepath, outputpath);
+        } else if (lang.name == "gcs") {
+            lang.result = QtConcurrent::run(runGenerator<UAVObjectGeneratorGCS>, parser, templatepath, outputpath);
+        } else if (lang.name == "java") {
+            lang.result = QtConcurrent::run(runGenerator<UAVObjectGeneratorJava>, parser, templatepath, outputpath);
+        } else if (lang.name == "python") {
+            lang.result = QtConcurrent::run(runGenerator<UAVObjectGeneratorPython>, parser, templatepath, outputpath);
+        } else if (lang.name == "matlab") {
+            lang.result = QtConcurrent::run(runGenerator<UAVObjectGeneratorMatlab>, parser, templatepath, outputpath);
+        } else if (lang.name == "wireshark") {
+            lang.result = QtConcurrent::run(runGenerator<UAVObjectGeneratorWireshark>, parser, templatepath, outputpath);
+        }
     }
 
-    // generate wireshark plugin if wanted
-    if (do_wireshark | do_all) {
-        cout << "generating wireshark code" << endl;
-        UAVObjectGeneratorWireshark wiresharkgen;
-        wiresharkgen.generate(parser, templatepath, outputpath);
+    // a failed language gets no stamp and is generated again by the next run
+    for (int i = 0; i < languages.length(); ++i) {
+        Language &lang = languages[i];
+        if (!lang.enabled) {
+            continue;
+        }
+        if (lang.result.result()) {
+            QString stamp = QString::fromLatin1(lang.stamp);
+            writeFileIfDiffrent(outputpath + lang.name + "/" STAMP_FILE, stamp);
+        } else {
+            QFile::remove(outputpath + lang.name + "/" STAMP_FILE);
+        }
     }
 
     return RETURN_OK;
@@ -652,11 +652,27 @@ QString UAVObjectParser::processObjectAttributes(QDomNode & node, ObjectInfo *in
         }
     }
 
+    // Get highrate attribute
+    attr = attributes.namedItem("highrate");
+    info->isHighRate = false;
+    if (!attr.isNull()) {
+        if (attr.nodeValue().compare(QString("true")) == 0) {
+            info->isHighRate = true;
+        } else if (attr.nodeValue().compare(QString("false")) != 0) {
+            return QString("Object:highrate attribute value is invalid (true|false)");
+        }
+    }
+
     // Settings objects can only have a single instance
     if (info->isSettings && !info->isSingleInst) {
         return QString("Object: Settings objects can not have multiple instances");
     }
 
+    // High rate objects must be single instance data objects
+    if (info->isHighRate && (info->isSettings || !info->isSingleInst)) {
+        return QString("Object: High rate objects must be single instance and not settings");
+    }
+
     // Done
     return QString();
 }
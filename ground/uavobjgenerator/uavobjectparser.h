@@ -86,6 +86,7 @@ typedef struct  {
     bool       isSingleInst;
     bool       isSettings;
     bool       isPriority;
+    bool       isHighRate; /** Flight side lockless reads, single instance data objects only **/
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool       flightTelemetryAcked;
@@ -232,6 +232,7 @@ build: elf hex bin sym
 else
     $(error "$(MSG_FORMATERROR) $(FORMAT)")
 endif
+build: formats
 
 # Generate code for PyMite
 # $(OUTDIR)/pmlib_img.c $(OUTDIR)/pmlib_nat.c $(OUTDIR)/pmlibusr_img.c $(OUTDIR)/pmlibusr_nat.c $(OUTDIR)/pmfeatures.h: $(wildcard $(PYMITELIB)/*.py) $(wildcard $(PYMITEPLAT)/*.py) $(wildcard $(FLIGHTPLANLIB)/*.py) $(wildcard $(FLIGHTPLANS)/*.py)
@@ -278,7 +279,7 @@ $(eval $(call OPFW_TEMPLATE,$(OUTDIR)/$(TARGET).bin,$(BOARD_TYPE),$(BOARD_REVISI
 
 $(OUTDIR)/$(TARGET).bin.o: $(OUTDIR)/$(TARGET).bin
 
-.PHONY: elf lss sym hex bin bino opfw
+.PHONY: elf lss sym hex bin bino opfw formats
 elf: $(OUTDIR)/$(TARGET).elf
 lss: $(OUTDIR)/$(TARGET).lss
 sym: $(OUTDIR)/$(TARGET).sym
@@ -286,6 +287,7 @@ hex: $(OUTDIR)/$(TARGET).hex
 bin: $(OUTDIR)/$(TARGET).bin
 bino: $(OUTDIR)/$(TARGET).bin.o
 opfw: $(OUTDIR)/$(TARGET).opfw
+formats: $(OUTDIR)/$(TARGET).debuglogformats
 
 # Display sizes of sections.
 $(eval $(call SIZE_TEMPLATE, $(OUTDIR)/$(TARGET).elf))
@@ -301,6 +303,7 @@ clean:
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).lss
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).bin.o
 	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).opfw
+	$(V1) $(RM) -f $(OUTDIR)/$(TARGET).debuglogformats
 	$(V1) $(RM) -f $(wildcard $(OUTDIR)/*.c)
 	$(V1) $(RM) -f $(wildcard $(OUTDIR)/*.h)
 	$(V1) $(RM) -f $(ALLOBJ)
@@ -66,6 +66,7 @@ MSG_JTAG_PROGRAM     = $(QUOTE) JTAG-PGM  $(MSG_EXTRA) $(QUOTE)
 MSG_JTAG_WIPE        = $(QUOTE) JTAG-WIPE $(MSG_EXTRA) $(QUOTE)
 MSG_PADDING          = $(QUOTE) PADDING   $(MSG_EXTRA) $(QUOTE)
 MSG_FLASH_IMG        = $(QUOTE) FLASH_IMG $(MSG_EXTRA) $(QUOTE)
+MSG_FORMAT_TABLE     = $(QUOTE) FORMATS   $(MSG_EXTRA) $(QUOTE)
 
 # Function for converting an absolute path to one relative
 # to the top of the source tree.
@@ -94,6 +95,11 @@ gccversion:
 	@$(ECHO) $(MSG_LOAD_FILE) $(call toprel, $@)
 	$(V1) $(OBJCOPY) -O binary $< $@
 
+# Extract the format strings of the deferred debug log messages, for the GCS
+%.debuglogformats: %.elf
+	@$(ECHO) $(MSG_FORMAT_TABLE) $(call toprel, $@)
+	$(V1) $(OBJCOPY) -O binary --only-section=.debuglogformats $< $@
+
 %.bin: %.o
 	@$(ECHO) $(MSG_LOAD_FILE) $(call toprel, $@)
 	$(V1) $(OBJCOPY) -O binary $< $@